@@ -3652,6 +3652,10 @@ typedef enum            // for global options or matrix options
     GxB_GLOBAL_CHUNK = GxB_CHUNK,       // chunk size for small problems.
                         // If <= GxB_DEFAULT, then the default is used.
 
+    GxB_THREAD_NTHREADS = 36,   // max number of threads of the calling thread
+                        // If <= GxB_DEFAULT, then GxB_NTHREADS is used.
+                        // GxB_get (GxB_NTHREADS) reports the effective limit.
+
     GxB_BURBLE = 99,    // diagnostic output (bool *)
 
     //------------------------------------------------------------
@@ -7846,8 +7850,9 @@ typedef struct
 	GrB_Index nvals ;       // Number of none zero values in matrix
 	GrB_Index nnz_idx ;     // Index of current none zero value
 	int64_t p ;             // Number of none zero values in current column
-	int64_t row_idx ;       // Index of current row
+	int64_t row_idx ;       // Index of current vector, a row unless A is hypersparse
 	GrB_Index nrows ;       // Total number of rows in matrix
+	GrB_Index nvec ;        // Number of vectors in matrix
 } GxB_MatrixTupleIter ;
 
 // Create a new matrix iterator
@@ -7888,6 +7893,19 @@ GrB_Info GxB_MatrixTupleIter_next
 	bool *depleted                  // indicate if iterator depleted
 ) ;
 
+// Advance iterator to the next row holding unconsumed entries, exposing them
+// in place: cols and vals point into the matrix's own index and value arrays,
+// valid until the matrix is modified, row and col entries are consumed as one
+GrB_Info GxB_MatrixTupleIter_next_row
+(
+	GxB_MatrixTupleIter *iter,      // iterator to consume
+	GrB_Index *row,                 // optional row index
+	const GrB_Index **cols,         // column indices of the row's entries
+	const void **vals,              // optional values of the row's entries
+	GrB_Index *count,               // number of entries
+	bool *depleted                  // indicate if iterator depleted
+) ;
+
 // Reset iterator
 GrB_Info GxB_MatrixTupleIter_reset
 (
@@ -245,10 +245,28 @@ void GB_Global_nthreads_max_set (int nthreads_max)
     GB_Global.nthreads_max = GB_IMAX (nthreads_max, 1) ;
 }
 
+// max number of threads of the calling thread, overrides the global
+// maximum if > 0, allowing threads sharing a core budget to each use a
+// portion of it
+static _Thread_local int GB_thread_nthreads_max = 0 ;
+
 GB_PUBLIC
 int GB_Global_nthreads_max_get (void)
 { 
-    return (GB_Global.nthreads_max) ;
+    int nthreads_max = GB_thread_nthreads_max ;
+    return ((nthreads_max > 0) ? nthreads_max : GB_Global.nthreads_max) ;
+}
+
+GB_PUBLIC
+void GB_Global_thread_nthreads_max_set (int nthreads_max)
+{ 
+    GB_thread_nthreads_max = GB_IMAX (nthreads_max, 0) ;
+}
+
+GB_PUBLIC
+int GB_Global_thread_nthreads_max_get (void)
+{ 
+    return (GB_thread_nthreads_max) ;
 }
 
 //------------------------------------------------------------------------------
@@ -25,6 +25,8 @@ GB_PUBLIC bool     GB_Global_GrB_init_called_get (void) ;
 
 GB_PUBLIC void     GB_Global_nthreads_max_set (int nthreads_max) ;
 GB_PUBLIC int      GB_Global_nthreads_max_get (void) ;
+GB_PUBLIC void     GB_Global_thread_nthreads_max_set (int nthreads_max) ;
+GB_PUBLIC int      GB_Global_thread_nthreads_max_get (void) ;
 
 GB_PUBLIC int      GB_Global_omp_get_max_threads (void) ;
 
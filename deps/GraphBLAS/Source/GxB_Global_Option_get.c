@@ -103,6 +103,17 @@ GrB_Info GxB_Global_Option_get      // gets the current global option
             }
             break ;
 
+        case GxB_THREAD_NTHREADS :
+
+            {
+                va_start (ap, field) ;
+                int *nthreads_max = va_arg (ap, int *) ;
+                va_end (ap) ;
+                GB_RETURN_IF_NULL (nthreads_max) ;
+                (*nthreads_max) = GB_Global_thread_nthreads_max_get ( ) ;
+            }
+            break ;
+
         //----------------------------------------------------------------------
         // default chunk size
         //----------------------------------------------------------------------
@@ -97,6 +97,17 @@ GrB_Info GxB_Global_Option_set      // set a global default option
             }
             break ;
 
+        case GxB_THREAD_NTHREADS :
+
+            { 
+                va_start (ap, field) ;
+                int nthreads_max_new = va_arg (ap, int) ;
+                va_end (ap) ;
+                // if < 1, then the calling thread uses GxB_NTHREADS
+                GB_Global_thread_nthreads_max_set (nthreads_max_new) ;
+            }
+            break ;
+
         case GxB_GLOBAL_CHUNK :         // same as GxB_CHUNK
 
             { 
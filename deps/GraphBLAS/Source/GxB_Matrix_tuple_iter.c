@@ -13,6 +13,26 @@ static inline void _EmptyIterator
 	iter->nnz_idx = 0;
 }
 
+// Returns the index of the first vector of A holding row i or a later row,
+// vectors map one to one to rows unless A is hypersparse.
+static inline int64_t _VectorIdx
+(
+	const GrB_Matrix A,         // matrix being iterated
+	GrB_Index i                 // row index
+) {
+	if(A->h == NULL) return i;
+
+	// binary search the hyperlist for the first row >= i
+	int64_t left = 0;
+	int64_t right = A->nvec;
+	while(left < right) {
+		int64_t mid = left + (right - left) / 2;
+		if(A->h[mid] < (int64_t)i) left = mid + 1;
+		else right = mid;
+	}
+	return left;
+}
+
 // Create a new iterator
 GrB_Info GxB_MatrixTupleIter_new
 (
@@ -22,18 +42,25 @@ GrB_Info GxB_MatrixTupleIter_new
 	GB_WHERE(A, "GxB_MatrixTupleIter_new (A)") ;
 	GB_RETURN_IF_NULL_OR_FAULTY(A) ;
 
-	// make sure matrix is not bitmap or full
-	GxB_set(A, GxB_SPARSITY_CONTROL, GxB_SPARSE) ;
-
 	GrB_Index nrows;
+	GrB_Index nvals;
 	GrB_Matrix_nrows(&nrows, A) ;
+	// finishes pending work, which might conform A to a different format
+	GrB_Matrix_nvals(&nvals, A) ;
+
+	// make sure matrix is not bitmap or full,
+	// both sparse and hypersparse matrices are iterated as is
+	if(GB_IS_BITMAP(A) || GB_IS_FULL(A)) {
+		GxB_set(A, GxB_SPARSITY_CONTROL, GxB_SPARSE) ;
+	}
 
 	*iter = GB_MALLOC(1, GxB_MatrixTupleIter) ;
-	GrB_Matrix_nvals(&((*iter)->nvals), A) ;
 	(*iter)->A = A ;
+	(*iter)->nvals = nvals ;
 	(*iter)->nnz_idx = 0 ;
 	(*iter)->row_idx = 0 ;
-	(*iter)->nrows = nrows;
+	(*iter)->nrows = nrows ;
+	(*iter)->nvec = A->nvec ;
 	(*iter)->p = A->p[0] ;
 	return (GrB_SUCCESS) ;
 }
@@ -55,9 +82,16 @@ GrB_Info GxB_MatrixTupleIter_iterate_row
 			rowIdx, iter->nrows) ;
 	}
 
-	iter->nvals = iter->A->p[rowIdx + 1];
-	iter->nnz_idx = iter->A->p[rowIdx];
-	iter->row_idx = rowIdx;
+	GrB_Matrix A = iter->A ;
+	int64_t k = _VectorIdx(A, rowIdx) ;
+	// hypersparse matrices hold no vector for empty rows
+	if(k == iter->nvec || (A->h != NULL && A->h[k] != (int64_t)rowIdx)) {
+		return (GrB_SUCCESS) ;
+	}
+
+	iter->nvals = A->p[k + 1];
+	iter->nnz_idx = A->p[k];
+	iter->row_idx = k;
 	iter->p = 0;
 	return (GrB_SUCCESS) ;
 }
@@ -80,8 +114,10 @@ GrB_Info GxB_MatrixTupleIter_jump_to_row
 	}
 
 	GrB_Matrix_nvals(&(iter->nvals), iter->A) ;
-	iter->nnz_idx = iter->A->p[rowIdx] ;
-	iter->row_idx = rowIdx ;
+	iter->nvec = iter->A->nvec ;
+	int64_t k = _VectorIdx(iter->A, rowIdx) ;
+	iter->nnz_idx = iter->A->p[k] ;
+	iter->row_idx = k ;
 	iter->p = 0 ;
 	return (GrB_SUCCESS) ;
 }
@@ -110,9 +146,12 @@ GrB_Info GxB_MatrixTupleIter_iterate_range
 			startRowIdx, endRowIdx ) ;
 	}
 
-	iter->nnz_idx = iter->A->p[startRowIdx] ;
-	iter->row_idx = startRowIdx ;
-	if(endRowIdx < iter->nrows) iter->nvals = iter->A->p[endRowIdx + 1] ;
+	int64_t k = _VectorIdx(iter->A, startRowIdx) ;
+	iter->nnz_idx = iter->A->p[k] ;
+	iter->row_idx = k ;
+	if(endRowIdx < iter->nrows) {
+		iter->nvals = iter->A->p[_VectorIdx(iter->A, endRowIdx + 1)] ;
+	}
 	else GrB_Matrix_nvals(&(iter->nvals), iter->A) ;
 	iter->p = 0 ;
 	return (GrB_SUCCESS) ;
@@ -150,20 +189,21 @@ GrB_Info GxB_MatrixTupleIter_next
 	//--------------------------------------------------------------------------
 
 	const int64_t *Ap = A->p;
-	int64_t i = iter->row_idx;
+	const int64_t *Ah = A->h;
+	int64_t k = iter->row_idx;
 
-	for(; i < iter->nrows; i++) {
-		int64_t p = iter->p + Ap[i];
-		if(p < Ap[i + 1]) {
+	for(; k < iter->nvec; k++) {
+		int64_t p = iter->p + Ap[k];
+		if(p < Ap[k + 1]) {
 			iter->p++;
 			if(row)
-				*row = i;
+				*row = (Ah != NULL) ? Ah[k] : k;
 			break;
 		}
 		iter->p = 0;
 	}
 
-	iter->row_idx = i;
+	iter->row_idx = k;
 
 	iter->nnz_idx++ ;
 
@@ -171,6 +211,53 @@ GrB_Info GxB_MatrixTupleIter_next
 	return (GrB_SUCCESS) ;
 }
 
+// Advance iterator to the next row
+GrB_Info GxB_MatrixTupleIter_next_row
+(
+	GxB_MatrixTupleIter *iter,      // iterator to consume
+	GrB_Index *row,                 // optional output row index
+	const GrB_Index **cols,         // output column indices
+	const void **vals,              // optional output values
+	GrB_Index *count,               // output number of entries
+	bool *depleted                  // indicate if iterator depleted
+) {
+	GB_WHERE1("GxB_MatrixTupleIter_next_row (iter, row, cols, vals, count, depleted)") ;
+	GB_RETURN_IF_NULL(iter) ;
+	GB_RETURN_IF_NULL(cols) ;
+	GB_RETURN_IF_NULL(count) ;
+	GB_RETURN_IF_NULL(depleted) ;
+	GrB_Index nnz_idx = iter->nnz_idx ;
+
+	if(nnz_idx >= iter->nvals) {
+		*depleted = true ;
+		return (GrB_SUCCESS) ;
+	}
+
+	GrB_Matrix A = iter->A ;
+	const int64_t *Ap = A->p;
+	const int64_t *Ah = A->h;
+
+	// skip consumed and empty vectors, the current vector may have been
+	// partially consumed by GxB_MatrixTupleIter_next
+	int64_t k = iter->row_idx;
+	while(k < iter->nvec && Ap[k + 1] <= (int64_t)nnz_idx) k++;
+	ASSERT(k < iter->nvec) ;
+
+	GrB_Index end = GB_IMIN((GrB_Index)Ap[k + 1], iter->nvals) ;
+
+	if(row) *row = (Ah != NULL) ? Ah[k] : k;
+	*cols = (const GrB_Index *)(A->i + nnz_idx) ;
+	if(vals) *vals = (const GB_void *)A->x + nnz_idx * A->type->size ;
+	*count = end - nnz_idx ;
+
+	iter->row_idx = k + 1 ;
+	iter->p = 0 ;
+	iter->nnz_idx = end ;
+
+	*depleted = false ;
+	return (GrB_SUCCESS) ;
+}
+
 // Reset iterator
 GrB_Info GxB_MatrixTupleIter_reset
 (
@@ -200,6 +287,10 @@ GrB_Info GxB_MatrixTupleIter_reuse
 	iter->A = A ;
 	iter->nrows = nrows ;
 	GrB_Matrix_nvals(&iter->nvals, A) ;
+	if(GB_IS_BITMAP(A) || GB_IS_FULL(A)) {
+		GxB_set(A, GxB_SPARSITY_CONTROL, GxB_SPARSE) ;
+	}
+	iter->nvec = A->nvec ;
 	GxB_MatrixTupleIter_reset(iter) ;
 	return (GrB_SUCCESS) ;
 }
@@ -0,0 +1,175 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "bidirectional_bfs.h"
+#include "RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+
+// one side of the search
+typedef struct {
+	GrB_Vector frontier;  // nodes discovered by the last expansion
+	GrB_Vector visited;   // node -> neighbour leading back to the side's root
+	GrB_Index nvals;      // number of nodes in frontier
+} _BFSSide;
+
+static void _BFSSide_Init(_BFSSide *side, GrB_Index n, NodeID root) {
+	GrB_Info res;
+	UNUSED(res);
+
+	res = GrB_Vector_new(&side->frontier, GrB_INT64, n);
+	ASSERT(res == GrB_SUCCESS);
+	res = GrB_Vector_new(&side->visited, GrB_INT64, n);
+	ASSERT(res == GrB_SUCCESS);
+
+	// the root leads back to itself
+	res = GrB_Vector_setElement_INT64(side->frontier, root, root);
+	ASSERT(res == GrB_SUCCESS);
+	res = GrB_Vector_setElement_INT64(side->visited, root, root);
+	ASSERT(res == GrB_SUCCESS);
+	side->nvals = 1;
+}
+
+static void _BFSSide_Free(_BFSSide *side) {
+	GrB_free(&side->frontier);
+	GrB_free(&side->visited);
+}
+
+// advance side a single level
+// ANY_SECONDI tags each reached node with the frontier node it was reached from
+// the complemented structural mask skips previously visited nodes
+static void _BFSSide_Expand(_BFSSide *side, GrB_Matrix push, GrB_Matrix pull,
+		GrB_Index n) {
+	GrB_Info res;
+	UNUSED(res);
+
+	if(push != GrB_NULL) {
+		// frontier' * push
+		res = GrB_vxm(side->frontier, side->visited, GrB_NULL,
+				GxB_ANY_SECONDI_INT64, side->frontier, push, GrB_DESC_RSC);
+	} else {
+		// pull * frontier
+		res = GrB_mxv(side->frontier, side->visited, GrB_NULL,
+				GxB_ANY_SECONDI_INT64, pull, side->frontier, GrB_DESC_RSC);
+	}
+	ASSERT(res == GrB_SUCCESS);
+
+	res = GrB_assign(side->visited, side->frontier, GrB_NULL, side->frontier,
+			GrB_ALL, n, GrB_DESC_S);
+	ASSERT(res == GrB_SUCCESS);
+
+	res = GrB_Vector_nvals(&side->nvals, side->frontier);
+	ASSERT(res == GrB_SUCCESS);
+}
+
+// returns true if side's frontier reached a node visited by other
+// sets meet to such a node
+static bool _BFSSide_Meet(const _BFSSide *side, const _BFSSide *other,
+		GrB_Index n, NodeID *meet) {
+	GrB_Info res;
+	UNUSED(res);
+
+	GrB_Vector common;
+	res = GrB_Vector_new(&common, GrB_INT64, n);
+	ASSERT(res == GrB_SUCCESS);
+	res = GrB_eWiseMult(common, GrB_NULL, GrB_NULL, GrB_FIRST_INT64,
+			side->frontier, other->visited, GrB_NULL);
+	ASSERT(res == GrB_SUCCESS);
+
+	GrB_Index nvals;
+	res = GrB_Vector_nvals(&nvals, common);
+	ASSERT(res == GrB_SUCCESS);
+
+	if(nvals > 0) {
+		// every common node lies on a shortest path, pick the first
+		GrB_Index *I = rm_malloc(sizeof(GrB_Index) * nvals);
+		res = GrB_Vector_extractTuples_INT64(I, NULL, &nvals, common);
+		ASSERT(res == GrB_SUCCESS);
+		*meet = I[0];
+		rm_free(I);
+	}
+
+	GrB_free(&common);
+	return (nvals > 0);
+}
+
+// walk from id back to the side's root, appending each visited node
+static NodeID *_BFSSide_Trace(const _BFSSide *side, NodeID id, NodeID *path) {
+	while(true) {
+		int64_t next;
+		GrB_Info res = GrB_Vector_extractElement_INT64(&next, side->visited, id);
+		ASSERT(res == GrB_SUCCESS);
+		if((NodeID)next == id) break;  // reached root
+		path = array_append(path, next);
+		id = next;
+	}
+	return path;
+}
+
+NodeID *BidirectionalBFS(GrB_Matrix R, GrB_Matrix TR, NodeID src, NodeID dest,
+		uint64_t max_hops) {
+	ASSERT(R != GrB_NULL);
+
+	if(src == dest) {
+		NodeID *path = array_new(NodeID, 1);
+		path = array_append(path, src);
+		return path;
+	}
+
+	GrB_Index n;
+	GrB_Info res = GrB_Matrix_nrows(&n, R);
+	ASSERT(res == GrB_SUCCESS);
+	UNUSED(res);
+
+	_BFSSide fwd;
+	_BFSSide bwd;
+	_BFSSide_Init(&fwd, n, src);
+	_BFSSide_Init(&bwd, n, dest);
+
+	bool found = false;
+	NodeID meet = INVALID_ENTITY_ID;
+	uint64_t hops = 0;
+
+	while(fwd.nvals > 0 && bwd.nvals > 0) {
+		if(max_hops != BIDIRECTIONAL_BFS_UNBOUNDED && hops == max_hops) break;
+		hops++;
+
+		// expand the cheaper side
+		if(fwd.nvals <= bwd.nvals) {
+			_BFSSide_Expand(&fwd, R, GrB_NULL, n);
+			found = _BFSSide_Meet(&fwd, &bwd, n, &meet);
+		} else {
+			// backward search pushes over the transpose when available
+			_BFSSide_Expand(&bwd, TR, R, n);
+			found = _BFSSide_Meet(&bwd, &fwd, n, &meet);
+		}
+
+		if(found) break;
+	}
+
+	NodeID *path = NULL;
+	if(found) {
+		// src ... meet
+		NodeID *prefix = array_new(NodeID, hops + 1);
+		prefix = array_append(prefix, meet);
+		prefix = _BFSSide_Trace(&fwd, meet, prefix);
+
+		path = array_new(NodeID, hops + 1);
+		for(int i = array_len(prefix) - 1; i >= 0; i--) {
+			path = array_append(path, prefix[i]);
+		}
+		array_free(prefix);
+
+		// meet ... dest
+		path = _BFSSide_Trace(&bwd, meet, path);
+		ASSERT(array_len(path) == hops + 1);
+	}
+
+	_BFSSide_Free(&fwd);
+	_BFSSide_Free(&bwd);
+	return path;
+}
+
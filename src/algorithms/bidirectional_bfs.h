@@ -0,0 +1,32 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../graph/entities/node.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// unbounded search depth
+#define BIDIRECTIONAL_BFS_UNBOUNDED 0
+
+/* Bidirectional breadth first search
+ * searches forward from src over R and backward from dest over TR,
+ * expanding the smaller of the two frontiers one level at a time,
+ * the search ends as soon as a newly discovered node has been reached
+ * by the other side as well.
+ *
+ * returns the ids of the nodes along a shortest path from src to dest,
+ * src and dest included, NULL if dest isn't reachable within max_hops edges
+ * the returned array is owned by the caller */
+NodeID *BidirectionalBFS
+(
+	GrB_Matrix R,      // traversed relation matrix
+	GrB_Matrix TR,     // transpose of R, GrB_NULL to pull over R instead
+	NodeID src,        // path source
+	NodeID dest,       // path destination
+	uint64_t max_hops  // maximal path length, BIDIRECTIONAL_BFS_UNBOUNDED for none
+);
+
@@ -0,0 +1,213 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "centrality.h"
+#include "../RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "LAGraph_bfs_pushpull.h"
+
+#define CENTRALITY_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+// accumulate into 'bc' the dependencies of the nodes on
+// paths originating at a batch of 'ns' sources
+static GrB_Info _BetweennessBatch(GrB_Vector bc, GrB_Matrix A,
+		const GrB_Index *sources, GrB_Index ns) {
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Index nvals;
+	GrB_Matrix paths     =  GrB_NULL;  // number of shortest paths from each source
+	GrB_Matrix frontier  =  GrB_NULL;  // paths reaching the current level
+	GrB_Matrix update    =  GrB_NULL;  // 1 + dependency of each node
+	GrB_Matrix W         =  GrB_NULL;  // backtracked dependencies
+	GrB_Vector sum       =  GrB_NULL;  // update summed over sources
+	GrB_Matrix *levels   =  array_new(GrB_Matrix, 8);  // nodes at each level
+
+	CENTRALITY_TRY(GrB_Matrix_nrows(&n, A));
+	CENTRALITY_TRY(GrB_Matrix_new(&paths, GrB_FP64, ns, n));
+	CENTRALITY_TRY(GrB_Matrix_new(&frontier, GrB_FP64, ns, n));
+
+	// paths(i, sources[i]) = 1
+	for(GrB_Index i = 0; i < ns; i++) {
+		CENTRALITY_TRY(GrB_Matrix_setElement_FP64(paths, 1, i, sources[i]));
+	}
+
+	// frontier<!paths> = paths * A
+	CENTRALITY_TRY(GrB_mxm(frontier, paths, GrB_NULL, GxB_PLUS_FIRST_FP64, paths,
+						   A, GrB_DESC_RSC));
+	CENTRALITY_TRY(GrB_Matrix_nvals(&nvals, frontier));
+
+	//--------------------------------------------------------------------------
+	// forward phase, count shortest paths level by level
+	//--------------------------------------------------------------------------
+
+	while(nvals > 0) {
+		// paths += frontier
+		CENTRALITY_TRY(GrB_eWiseAdd(paths, GrB_NULL, GrB_NULL, GrB_PLUS_FP64,
+									paths, frontier, GrB_NULL));
+
+		// record the nodes reached at this level
+		GrB_Matrix level;
+		CENTRALITY_TRY(GrB_Matrix_new(&level, GrB_BOOL, ns, n));
+		levels = array_append(levels, level);
+		CENTRALITY_TRY(GrB_Matrix_apply(level, GrB_NULL, GrB_NULL, GxB_ONE_BOOL,
+										frontier, GrB_NULL));
+
+		// frontier<!paths> = frontier * A
+		CENTRALITY_TRY(GrB_mxm(frontier, paths, GrB_NULL, GxB_PLUS_FIRST_FP64,
+							   frontier, A, GrB_DESC_RSC));
+		CENTRALITY_TRY(GrB_Matrix_nvals(&nvals, frontier));
+	}
+
+	//--------------------------------------------------------------------------
+	// backward phase, accumulate dependencies from the deepest level up
+	//--------------------------------------------------------------------------
+
+	// update = 1
+	CENTRALITY_TRY(GrB_Matrix_new(&update, GrB_FP64, ns, n));
+	CENTRALITY_TRY(GrB_Matrix_assign_FP64(update, GrB_NULL, GrB_NULL, 1, GrB_ALL,
+										  ns, GrB_ALL, n, GrB_NULL));
+	CENTRALITY_TRY(GrB_Matrix_new(&W, GrB_FP64, ns, n));
+
+	uint depth = array_len(levels);
+	for(int i = (int)depth - 1; i > 0; i--) {
+		// W<levels[i]> = update ./ paths
+		CENTRALITY_TRY(GrB_eWiseMult(W, levels[i], GrB_NULL, GrB_DIV_FP64, update,
+									 paths, GrB_DESC_RS));
+		// W<levels[i - 1]> = W * A'
+		CENTRALITY_TRY(GrB_mxm(W, levels[i - 1], GrB_NULL, GxB_PLUS_FIRST_FP64, W,
+							   A, GrB_DESC_RST1));
+		// update += W .* paths
+		CENTRALITY_TRY(GrB_eWiseMult(update, GrB_NULL, GrB_PLUS_FP64,
+									 GrB_TIMES_FP64, W, paths, GrB_NULL));
+	}
+
+	// bc += sum(update) - ns, discarding the initial 1 of each source
+	CENTRALITY_TRY(GrB_Vector_new(&sum, GrB_FP64, n));
+	CENTRALITY_TRY(GrB_Matrix_reduce_BinaryOp(sum, GrB_NULL, GrB_NULL,
+											  GrB_PLUS_FP64, update, GrB_DESC_T0));
+	CENTRALITY_TRY(GrB_Vector_apply_BinaryOp2nd_FP64(sum, GrB_NULL, GrB_NULL,
+													 GrB_MINUS_FP64, sum, (double)ns, GrB_NULL));
+	CENTRALITY_TRY(GrB_eWiseAdd(bc, GrB_NULL, GrB_NULL, GrB_PLUS_FP64, bc, sum,
+								GrB_NULL));
+
+cleanup:
+	for(uint i = 0; i < array_len(levels); i++) GrB_free(levels + i);
+	array_free(levels);
+	GrB_free(&paths);
+	GrB_free(&frontier);
+	GrB_free(&update);
+	GrB_free(&W);
+	GrB_free(&sum);
+	return info;
+}
+
+GrB_Info Betweenness(double **centrality, GrB_Matrix A,
+					 const GrB_Index *sources, GrB_Index source_count) {
+	ASSERT(A != NULL);
+	ASSERT(centrality != NULL);
+	ASSERT(sources != NULL || source_count == 0);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Vector bc = GrB_NULL;   // centrality of each node
+
+	*centrality = NULL;
+	CENTRALITY_TRY(GrB_Matrix_nrows(&n, A));
+
+	// bc = 0, dense
+	CENTRALITY_TRY(GrB_Vector_new(&bc, GrB_FP64, n));
+	CENTRALITY_TRY(GrB_Vector_assign_FP64(bc, GrB_NULL, GrB_NULL, 0, GrB_ALL, n,
+										  GrB_NULL));
+
+	for(GrB_Index i = 0; i < source_count; i += BETWEENNESS_BATCH_SIZE) {
+		GrB_Index ns = source_count - i;
+		if(ns > BETWEENNESS_BATCH_SIZE) ns = BETWEENNESS_BATCH_SIZE;
+		CENTRALITY_TRY(_BetweennessBatch(bc, A, sources + i, ns));
+	}
+
+	double *X = rm_malloc(sizeof(double) * n);
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * n);
+	GrB_Index nvals = n;
+	info = GrB_Vector_extractTuples_FP64(I, X, &nvals, bc);
+	rm_free(I);
+	if(info != GrB_SUCCESS) {
+		rm_free(X);
+		goto cleanup;
+	}
+
+	// bc is dense, tuples are ordered by index
+	ASSERT(nvals == n);
+	*centrality = X;
+
+cleanup:
+	GrB_free(&bc);
+	return info;
+}
+
+GrB_Info Closeness(double **closeness, double **harmonic, GrB_Matrix A,
+				   const GrB_Index *nodes, GrB_Index node_count) {
+	ASSERT(A != NULL);
+	ASSERT(harmonic != NULL);
+	ASSERT(closeness != NULL);
+	ASSERT(nodes != NULL || node_count == 0);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Matrix AT    =  GrB_NULL;  // transposed graph, enables pull steps
+	GrB_Vector v     =  GrB_NULL;  // BFS level of each reached node
+	GrB_Index *I     =  NULL;      // reached nodes
+	int64_t *levels  =  NULL;      // level of each reached node
+	double *cc       =  NULL;      // closeness centrality
+	double *hc       =  NULL;      // harmonic centrality
+
+	*closeness = NULL;
+	*harmonic = NULL;
+	CENTRALITY_TRY(GrB_Matrix_nrows(&n, A));
+
+	CENTRALITY_TRY(GrB_Matrix_new(&AT, GrB_BOOL, n, n));
+	CENTRALITY_TRY(GrB_transpose(AT, GrB_NULL, GrB_NULL, A, GrB_NULL));
+
+	cc = rm_calloc(node_count, sizeof(double));
+	hc = rm_calloc(node_count, sizeof(double));
+	I = rm_malloc(sizeof(GrB_Index) * n);
+	levels = rm_malloc(sizeof(int64_t) * n);
+
+	for(GrB_Index k = 0; k < node_count; k++) {
+		CENTRALITY_TRY(LAGraph_bfs_pushpull(&v, NULL, A, AT, nodes[k], NULL, 0,
+											true));
+
+		// the source is at level 1, a node at level l is at distance l - 1
+		GrB_Index nvals = n;
+		CENTRALITY_TRY(GrB_Vector_extractTuples_INT64(I, levels, &nvals, v));
+		GrB_free(&v);
+
+		double distances = 0;
+		double inverse_distances = 0;
+		for(GrB_Index j = 0; j < nvals; j++) {
+			if(levels[j] <= 1) continue;
+			distances += levels[j] - 1;
+			inverse_distances += 1.0 / (levels[j] - 1);
+		}
+
+		if(distances > 0) cc[k] = (nvals - 1) / distances;
+		if(node_count > 1) hc[k] = inverse_distances / (node_count - 1);
+	}
+
+	*closeness = cc;
+	*harmonic = hc;
+	cc = NULL;
+	hc = NULL;
+
+cleanup:
+	GrB_free(&AT);
+	GrB_free(&v);
+	if(I != NULL) rm_free(I);
+	if(levels != NULL) rm_free(levels);
+	if(cc != NULL) rm_free(cc);
+	if(hc != NULL) rm_free(hc);
+	return info;
+}
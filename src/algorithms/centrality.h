@@ -0,0 +1,50 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// number of sources traversed simultaneously by Betweenness
+#define BETWEENNESS_BATCH_SIZE 64
+
+// computes the betweenness centrality of every node of A, following Brandes:
+// shortest paths are counted by a BFS from each source, then dependencies
+// are accumulated in reverse BFS order
+//
+// BETWEENNESS_BATCH_SIZE sources are traversed at once, the BFS frontier
+// being a matrix holding a row per source
+//
+// only paths originating at 'sources' are considered, to approximate the
+// centrality of a large graph pass a sample of its nodes and scale the
+// result by n / source_count
+//
+// on return centrality[i] holds the centrality of node i
+// the array holds one entry per row of A and is owned by the caller
+GrB_Info Betweenness
+(
+	double **centrality,      // [output] centrality of each node
+	GrB_Matrix A,             // boolean input graph, not modified
+	const GrB_Index *sources, // nodes paths originate at
+	GrB_Index source_count    // number of sources
+);
+
+// computes the closeness and harmonic centrality of 'nodes'
+// by a BFS from each node, distances to unreachable nodes are ignored
+//
+// closeness[k] = (r - 1) / sum(d(nodes[k], v)) over the r nodes reachable
+// from nodes[k], including itself, 0 if no node is reachable
+// harmonic[k] = sum(1 / d(nodes[k], v)) / (node_count - 1)
+//
+// both arrays hold one entry per node and are owned by the caller
+GrB_Info Closeness
+(
+	double **closeness,       // [output] closeness centrality of each node
+	double **harmonic,        // [output] harmonic centrality of each node
+	GrB_Matrix A,             // boolean input graph, not modified
+	const GrB_Index *nodes,   // nodes to compute centrality for
+	GrB_Index node_count      // number of nodes
+);
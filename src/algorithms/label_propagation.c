@@ -0,0 +1,120 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "label_propagation.h"
+#include "../RG.h"
+#include "../config.h"
+#include "../util/qsort.h"
+#include "../util/rmalloc.h"
+
+#define LP_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+#define LABEL_ISLT(a, b) (*(a) < *(b))
+
+// returns the label most common among 'labels', the smallest on ties
+// sorts 'labels' in place
+static GrB_Index _MostCommon(GrB_Index *labels, GrB_Index count) {
+	QSORT(GrB_Index, labels, count, LABEL_ISLT);
+
+	GrB_Index best = labels[0];
+	GrB_Index best_count = 0;
+	GrB_Index run = 0;
+	for(GrB_Index k = 0; k < count; k++) {
+		run = (k > 0 && labels[k] == labels[k - 1]) ? run + 1 : 1;
+		// labels are ascending, strictly greater keeps the smallest on ties
+		if(run > best_count) {
+			best = labels[k];
+			best_count = run;
+		}
+	}
+	return best;
+}
+
+GrB_Info LabelPropagation(GrB_Index **communities, GrB_Matrix S, int itermax,
+						  int *iters) {
+	ASSERT(S != NULL);
+	ASSERT(iters != NULL);
+	ASSERT(communities != NULL);
+
+	GrB_Info info;
+	GrB_Type type;
+	GrB_Index n;
+	GrB_Index ncols;
+	GrB_Index Ap_size;
+	GrB_Index Aj_size;
+	GrB_Index Ax_size;
+	bool jumbled;
+	GrB_Matrix C    =  GrB_NULL;  // exported copy of S
+	GrB_Index *Ap   =  NULL;      // row pointers
+	GrB_Index *Aj   =  NULL;      // neighbors
+	void *Ax        =  NULL;      // unused values
+	GrB_Index *cur  =  NULL;      // community of each node
+	GrB_Index *next =  NULL;      // community of each node in the next round
+
+	*iters = 0;
+	*communities = NULL;
+	LP_TRY(GrB_Matrix_nrows(&n, S));
+	if(n == 0) return GrB_SUCCESS;
+
+	int nthreads;
+	Config_Option_get(Config_OPENMP_NTHREAD, &nthreads);
+	if(nthreads < 1) nthreads = 1;
+
+	// access neighbors directly
+	LP_TRY(GrB_Matrix_dup(&C, S));
+	LP_TRY(GxB_Matrix_export_CSR(&C, &type, &n, &ncols, &Ap, &Aj, &Ax, &Ap_size,
+								 &Aj_size, &Ax_size, &jumbled, GrB_NULL));
+
+	GrB_Index max_degree = 0;
+	for(GrB_Index i = 0; i < n; i++) {
+		GrB_Index degree = Ap[i + 1] - Ap[i];
+		if(degree > max_degree) max_degree = degree;
+	}
+
+	cur  = rm_malloc(sizeof(GrB_Index) * n);
+	next = rm_malloc(sizeof(GrB_Index) * n);
+	for(GrB_Index i = 0; i < n; i++) cur[i] = i;
+
+	bool changed = true;
+	while(changed && *iters < itermax) {
+		(*iters)++;
+		changed = false;
+
+		#pragma omp parallel num_threads(nthreads)
+		{
+			// labels of a node and all of its neighbors
+			GrB_Index *labels = rm_malloc(sizeof(GrB_Index) * (max_degree + 1));
+
+			#pragma omp for schedule(dynamic, 1024) reduction(||:changed)
+			for(GrB_Index i = 0; i < n; i++) {
+				GrB_Index count = 0;
+				labels[count++] = cur[i];
+				for(GrB_Index k = Ap[i]; k < Ap[i + 1]; k++) labels[count++] = cur[Aj[k]];
+
+				next[i] = _MostCommon(labels, count);
+				if(next[i] != cur[i]) changed = true;
+			}
+
+			rm_free(labels);
+		}
+
+		GrB_Index *tmp = cur;
+		cur = next;
+		next = tmp;
+	}
+
+	*communities = cur;
+	cur = NULL;
+
+cleanup:
+	if(C != GrB_NULL) GrB_free(&C);
+	if(Ap != NULL) rm_free(Ap);
+	if(Aj != NULL) rm_free(Aj);
+	if(Ax != NULL) rm_free(Ax);
+	if(cur != NULL) rm_free(cur);
+	if(next != NULL) rm_free(next);
+	return info;
+}
@@ -0,0 +1,28 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// detects communities of the undirected graph S by label propagation
+//
+// every node starts in its own community, then in every round each node
+// joins the community most common among itself and its neighbors,
+// ties are broken in favor of the smallest community
+// rounds are synchronous, making the outcome independent of thread count
+// propagation stops once no node changes community, or after 'itermax' rounds
+//
+// on return communities[i] holds the community of node i, named after
+// one of its members, the array holds one entry per row of S
+// and is owned by the caller
+GrB_Info LabelPropagation
+(
+	GrB_Index **communities,  // [output] community of each node
+	GrB_Matrix S,             // symmetric input graph, not modified
+	int itermax,              // maximum number of rounds
+	int *iters                // [output] number of rounds performed
+);
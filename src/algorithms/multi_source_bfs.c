@@ -0,0 +1,94 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "multi_source_bfs.h"
+#include "../RG.h"
+#include "../util/rmalloc.h"
+
+#define BFS_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+GrB_Info MultiSourceBFS(GrB_Vector *levels, GrB_Vector *parents, GrB_Matrix A,
+		const GrB_Index *sources, GrB_Index source_count, int64_t max_level,
+		GrB_Index level_cap) {
+	ASSERT(A != NULL);
+	ASSERT(levels != NULL);
+	ASSERT(sources != NULL || source_count == 0);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Index nvals;
+	GrB_Vector v   =  GrB_NULL;  // level of each reached node
+	GrB_Vector pi  =  GrB_NULL;  // parent of each reached node
+	GrB_Vector q   =  GrB_NULL;  // frontier, q(i) = i
+	GrB_Index *I   =  NULL;      // frontier nodes
+	uint64_t *X    =  NULL;      // frontier values
+
+	*levels = GrB_NULL;
+	if(parents) *parents = GrB_NULL;
+
+	BFS_TRY(GrB_Matrix_nrows(&n, A));
+	BFS_TRY(GrB_Vector_new(&v, GrB_UINT64, n));
+	BFS_TRY(GrB_Vector_new(&q, GrB_UINT64, n));
+	if(parents) BFS_TRY(GrB_Vector_new(&pi, GrB_UINT64, n));
+
+	I = rm_malloc(sizeof(GrB_Index) * n);
+	X = rm_malloc(sizeof(uint64_t) * n);
+
+	// the frontier starts at the sources, each holds its own ID
+	nvals = 0;
+	for(GrB_Index i = 0; i < source_count; i++) {
+		if(sources[i] >= n) continue;
+		I[nvals] = sources[i];
+		X[nvals] = sources[i];
+		nvals++;
+	}
+	BFS_TRY(GrB_Vector_build_UINT64(q, I, X, nvals, GrB_FIRST_UINT64));
+	BFS_TRY(GrB_Vector_assign_UINT64(v, q, GrB_NULL, 0, GrB_ALL, n, GrB_DESC_S));
+
+	for(int64_t level = 1; max_level <= 0 || level <= max_level; level++) {
+		// q<!v> = q * A, each discovered node holds its smallest parent
+		BFS_TRY(GrB_vxm(q, v, GrB_NULL, GxB_MIN_FIRST_UINT64, q, A,
+						GrB_DESC_RSC));
+		BFS_TRY(GrB_Vector_nvals(&nvals, q));
+		if(nvals == 0) break;
+
+		BFS_TRY(GrB_Vector_extractTuples_UINT64(I, X, &nvals, q));
+
+		// keep the first 'level_cap' discovered nodes
+		if(level_cap > 0 && nvals > level_cap) {
+			nvals = level_cap;
+			BFS_TRY(GrB_Vector_clear(q));
+			BFS_TRY(GrB_Vector_build_UINT64(q, I, X, nvals, GrB_FIRST_UINT64));
+		}
+
+		// pi<q> = q, v<q> = level
+		if(parents) {
+			BFS_TRY(GrB_Vector_assign(pi, q, GrB_NULL, q, GrB_ALL, n, GrB_DESC_S));
+		}
+		BFS_TRY(GrB_Vector_assign_UINT64(v, q, GrB_NULL, level, GrB_ALL, n,
+										 GrB_DESC_S));
+
+		// discovered nodes hold their own ID as they're expanded
+		for(GrB_Index k = 0; k < nvals; k++) X[k] = I[k];
+		BFS_TRY(GrB_Vector_clear(q));
+		BFS_TRY(GrB_Vector_build_UINT64(q, I, X, nvals, GrB_FIRST_UINT64));
+	}
+
+	*levels = v;
+	v = GrB_NULL;
+	if(parents) {
+		*parents = pi;
+		pi = GrB_NULL;
+	}
+
+cleanup:
+	GrB_free(&v);
+	GrB_free(&pi);
+	GrB_free(&q);
+	if(I != NULL) rm_free(I);
+	if(X != NULL) rm_free(X);
+	return info;
+}
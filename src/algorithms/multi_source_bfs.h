@@ -0,0 +1,32 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// level-synchronous BFS traversing A's edges from a set of sources at once
+// each node is assigned the level at which it's first reached from
+// any of the sources, sources are at level 0
+//
+// traversal stops after 'max_level' levels, if 'max_level' is greater than 0
+// if 'level_cap' is greater than 0, at most 'level_cap' nodes are discovered
+// per level, nodes with the smallest IDs are kept, the rest are neither
+// reported nor traversed
+//
+// on return levels(i) holds the level of node i, for every reached node
+// if requested, parents(i) holds the smallest ID among the nodes
+// at the previous level connected to i, for every reached non-source node
+GrB_Info MultiSourceBFS
+(
+	GrB_Vector *levels,       // [output] level of each reached node
+	GrB_Vector *parents,      // [optional output] parent of each reached node
+	GrB_Matrix A,             // input graph, not modified
+	const GrB_Index *sources, // nodes to traverse from
+	GrB_Index source_count,   // number of sources
+	int64_t max_level,        // number of levels to traverse, 0 for all
+	GrB_Index level_cap       // max nodes discovered per level, 0 for all
+);
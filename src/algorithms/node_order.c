@@ -0,0 +1,177 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "node_order.h"
+#include "label_propagation.h"
+#include "../RG.h"
+#include "../util/qsort.h"
+#include "../util/rmalloc.h"
+#include <sys/param.h>
+
+#define ORDER_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+// max number of label propagation rounds of the community ordering
+#define ORDER_COMMUNITY_ITERS 20
+
+// node along its sort key
+typedef struct {
+	GrB_Index key;  // sort key
+	GrB_Index id;   // row of S
+} KeyedNode;
+
+// ascending key, ties broken by ascending row
+#define KEYED_NODE_ISLT(a, b) \
+	((a)->key < (b)->key || ((a)->key == (b)->key && (a)->id < (b)->id))
+
+// sorts nodes by key, writing their rows to 'order'
+static void _SortByKey(GrB_Index *order, KeyedNode *nodes, GrB_Index n) {
+	QSORT(KeyedNode, nodes, n, KEYED_NODE_ISLT);
+	for(GrB_Index i = 0; i < n; i++) order[i] = nodes[i].id;
+}
+
+static void _DegreeOrder(GrB_Index *order, const GrB_Index *Ap, GrB_Index n) {
+	KeyedNode *nodes = rm_malloc(sizeof(KeyedNode) * n);
+	for(GrB_Index i = 0; i < n; i++) {
+		// descending degree
+		nodes[i].key = n - (Ap[i + 1] - Ap[i]);
+		nodes[i].id = i;
+	}
+	_SortByKey(order, nodes, n);
+	rm_free(nodes);
+}
+
+static void _RCMOrder(GrB_Index *order, const GrB_Index *Ap, const GrB_Index *Aj,
+		GrB_Index n) {
+	GrB_Index max_degree = 0;
+	KeyedNode *nodes = rm_malloc(sizeof(KeyedNode) * n);
+	for(GrB_Index i = 0; i < n; i++) {
+		nodes[i].key = Ap[i + 1] - Ap[i];
+		nodes[i].id = i;
+		if(nodes[i].key > max_degree) max_degree = nodes[i].key;
+	}
+
+	// components are entered by their lowest degree node
+	GrB_Index *starts = rm_malloc(sizeof(GrB_Index) * n);
+	_SortByKey(starts, nodes, n);
+
+	bool *visited = rm_calloc(n, sizeof(bool));
+	KeyedNode *neighbors = rm_malloc(sizeof(KeyedNode) * MAX(max_degree, 1));
+
+	// order doubles as the BFS queue
+	GrB_Index tail = 0;
+	for(GrB_Index s = 0; s < n; s++) {
+		GrB_Index start = starts[s];
+		if(visited[start]) continue;
+
+		visited[start] = true;
+		GrB_Index head = tail;
+		order[tail++] = start;
+
+		while(head < tail) {
+			GrB_Index v = order[head++];
+
+			// enqueue unvisited neighbors by ascending degree
+			GrB_Index count = 0;
+			for(GrB_Index k = Ap[v]; k < Ap[v + 1]; k++) {
+				GrB_Index u = Aj[k];
+				if(visited[u]) continue;
+				visited[u] = true;
+				neighbors[count].key = Ap[u + 1] - Ap[u];
+				neighbors[count].id = u;
+				count++;
+			}
+			_SortByKey(order + tail, neighbors, count);
+			tail += count;
+		}
+	}
+	ASSERT(tail == n);
+
+	// reverse the Cuthill-McKee order
+	for(GrB_Index i = 0; i < n / 2; i++) {
+		GrB_Index tmp = order[i];
+		order[i] = order[n - 1 - i];
+		order[n - 1 - i] = tmp;
+	}
+
+	rm_free(nodes);
+	rm_free(starts);
+	rm_free(visited);
+	rm_free(neighbors);
+}
+
+static GrB_Info _CommunityOrder(GrB_Index *order, GrB_Matrix S, GrB_Index n) {
+	int iters;
+	GrB_Info info;
+	GrB_Index *communities = NULL;
+	info = LabelPropagation(&communities, S, ORDER_COMMUNITY_ITERS, &iters);
+	if(info != GrB_SUCCESS) return info;
+
+	// rank communities by their smallest member
+	GrB_Index *rank = rm_malloc(sizeof(GrB_Index) * n);
+	for(GrB_Index i = 0; i < n; i++) rank[i] = n;
+	for(GrB_Index i = 0; i < n; i++) {
+		GrB_Index c = communities[i];
+		if(rank[c] == n) rank[c] = i;
+	}
+
+	KeyedNode *nodes = rm_malloc(sizeof(KeyedNode) * n);
+	for(GrB_Index i = 0; i < n; i++) {
+		nodes[i].key = rank[communities[i]];
+		nodes[i].id = i;
+	}
+	_SortByKey(order, nodes, n);
+
+	rm_free(nodes);
+	rm_free(rank);
+	rm_free(communities);
+	return GrB_SUCCESS;
+}
+
+GrB_Info NodeOrder(GrB_Index **order, GrB_Matrix S, NodeOrderPolicy policy) {
+	ASSERT(S != NULL);
+	ASSERT(order != NULL);
+
+	GrB_Info info;
+	GrB_Type type;
+	GrB_Index n;
+	GrB_Index ncols;
+	GrB_Index Ap_size;
+	GrB_Index Aj_size;
+	GrB_Index Ax_size;
+	bool jumbled;
+	GrB_Matrix C   =  GrB_NULL;  // exported copy of S
+	GrB_Index *Ap  =  NULL;      // row pointers
+	GrB_Index *Aj  =  NULL;      // neighbors
+	void *Ax       =  NULL;      // unused values
+	GrB_Index *o   =  NULL;      // computed order
+
+	*order = NULL;
+	ORDER_TRY(GrB_Matrix_nrows(&n, S));
+	o = rm_malloc(sizeof(GrB_Index) * MAX(n, 1));
+
+	if(policy == NODE_ORDER_COMMUNITY) {
+		ORDER_TRY(_CommunityOrder(o, S, n));
+	} else {
+		// access neighbors directly, sorted by row
+		ORDER_TRY(GrB_Matrix_dup(&C, S));
+		ORDER_TRY(GxB_Matrix_export_CSR(&C, &type, &n, &ncols, &Ap, &Aj, &Ax,
+					&Ap_size, &Aj_size, &Ax_size, &jumbled, GrB_NULL));
+
+		if(policy == NODE_ORDER_DEGREE) _DegreeOrder(o, Ap, n);
+		else _RCMOrder(o, Ap, Aj, n);
+	}
+
+	*order = o;
+	o = NULL;
+
+cleanup:
+	if(C != GrB_NULL) GrB_free(&C);
+	if(Ap != NULL) rm_free(Ap);
+	if(Aj != NULL) rm_free(Aj);
+	if(Ax != NULL) rm_free(Ax);
+	if(o != NULL) rm_free(o);
+	return info;
+}
@@ -0,0 +1,35 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// node orderings, laying out nodes traversed together next to one another
+typedef enum {
+	NODE_ORDER_DEGREE,     // descending degree, hubs first
+	NODE_ORDER_RCM,        // reverse Cuthill-McKee, minimizes the matrix bandwidth
+	NODE_ORDER_COMMUNITY,  // nodes of a community are laid out contiguously
+} NodeOrderPolicy;
+
+// orders the nodes of the undirected graph S by 'policy'
+//
+// every ordering is deterministic, ties are broken in favor of the smallest row
+// degree orders nodes by their number of neighbors, in descending order
+// RCM visits each connected component breadth first, starting at its
+// lowest degree node and visiting neighbors by ascending degree,
+// the visit order is then reversed
+// community orders communities detected by label propagation by their
+// smallest member, nodes of a community retain their relative order
+//
+// on return order[i] holds the row of S laid out at position i,
+// the array holds one entry per row of S and is owned by the caller
+GrB_Info NodeOrder
+(
+	GrB_Index **order,       // [output] rows of S in their new order
+	GrB_Matrix S,            // symmetric input graph, not modified
+	NodeOrderPolicy policy   // ordering to compute
+);
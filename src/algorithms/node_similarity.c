@@ -0,0 +1,145 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "node_similarity.h"
+#include "../RG.h"
+#include "../util/arr.h"
+#include "../util/qsort.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+
+#define SIMILARITY_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+// more similar pairs first, ties ordered by node
+#define PAIR_ISLT(a, b) ((a)->similarity > (b)->similarity ||   \
+		((a)->similarity == (b)->similarity && (a)->dest < (b)->dest))
+
+static inline double _Similarity(SimilarityMetric metric, uint64_t shared,
+		uint64_t di, uint64_t dj) {
+	switch(metric) {
+		case SIMILARITY_JACCARD:
+			return (double)shared / (di + dj - shared);
+		case SIMILARITY_OVERLAP:
+			return (double)shared / ((di < dj) ? di : dj);
+		case SIMILARITY_COSINE:
+			return shared / sqrt((double)di * dj);
+		default:
+			ASSERT(false);
+			return 0;
+	}
+}
+
+GrB_Info NodeSimilarity(SimilarityPair **pairs, GrB_Matrix A,
+		SimilarityMetric metric, GrB_Index top_k, double cutoff) {
+	ASSERT(A != NULL);
+	ASSERT(pairs != NULL);
+
+	GrB_Info info;
+	GrB_Type type;
+	GrB_Index n;
+	GrB_Index nvals;
+	GrB_Index nrows;
+	GrB_Index ncols;
+	GrB_Index Cp_size;
+	GrB_Index Cj_size;
+	GrB_Index Cx_size;
+	bool jumbled;
+	GrB_Vector d       =  GrB_NULL;  // degree of each node
+	GrB_Matrix B       =  GrB_NULL;  // block of rows of A
+	GrB_Matrix C       =  GrB_NULL;  // shared neighbors of block rows
+	GrB_Index *I       =  NULL;      // nodes with neighbors
+	uint64_t *X        =  NULL;      // degrees
+	uint64_t *degree   =  NULL;      // degree of each node
+	GrB_Index *Cp      =  NULL;      // C row pointers
+	GrB_Index *Cj      =  NULL;      // C column indices
+	uint64_t *Cx       =  NULL;      // shared neighbor counts
+	SimilarityPair *row_pairs = NULL;  // pairs of a single row
+	SimilarityPair *result = array_new(SimilarityPair, 0);
+
+	*pairs = NULL;
+	SIMILARITY_TRY(GrB_Matrix_nrows(&n, A));
+
+	// degree[i] = |N(i)|
+	degree = rm_calloc(n, sizeof(uint64_t));
+	I = rm_malloc(sizeof(GrB_Index) * n);
+	X = rm_malloc(sizeof(uint64_t) * n);
+	SIMILARITY_TRY(GrB_Vector_new(&d, GrB_UINT64, n));
+	SIMILARITY_TRY(GrB_Matrix_reduce_BinaryOp(d, GrB_NULL, GrB_NULL,
+											  GrB_PLUS_UINT64, A, GrB_NULL));
+	nvals = n;
+	SIMILARITY_TRY(GrB_Vector_extractTuples_UINT64(I, X, &nvals, d));
+	for(GrB_Index k = 0; k < nvals; k++) degree[I[k]] = X[k];
+
+	row_pairs = array_new(SimilarityPair, 0);
+
+	for(GrB_Index start = 0; start < n; start += NODE_SIMILARITY_BLOCK_SIZE) {
+		GrB_Index end = start + NODE_SIMILARITY_BLOCK_SIZE;
+		if(end > n) end = n;
+
+		// B = A(start:end-1, :)
+		GrB_Index range[2] = {start, end - 1};
+		SIMILARITY_TRY(GrB_Matrix_new(&B, GrB_BOOL, end - start, n));
+		SIMILARITY_TRY(GrB_Matrix_extract(B, GrB_NULL, GrB_NULL, A, range,
+										  GxB_RANGE, GrB_ALL, n, GrB_NULL));
+
+		// C(i, j) = |N(start + i) & N(j)|
+		SIMILARITY_TRY(GrB_Matrix_new(&C, GrB_UINT64, end - start, n));
+		SIMILARITY_TRY(GrB_mxm(C, GrB_NULL, GrB_NULL, GxB_PLUS_PAIR_UINT64, B,
+							   A, GrB_DESC_T1));
+		GrB_free(&B);
+
+		SIMILARITY_TRY(GxB_Matrix_export_CSR(&C, &type, &nrows, &ncols, &Cp, &Cj,
+											 (void **)&Cx, &Cp_size, &Cj_size, &Cx_size, &jumbled,
+											 GrB_NULL));
+
+		for(GrB_Index i = 0; i < nrows; i++) {
+			GrB_Index src = start + i;
+			array_clear(row_pairs);
+
+			for(GrB_Index k = Cp[i]; k < Cp[i + 1]; k++) {
+				GrB_Index dest = Cj[k];
+				if(dest == src) continue;
+
+				double s = _Similarity(metric, Cx[k], degree[src], degree[dest]);
+				if(s < cutoff) continue;
+
+				SimilarityPair pair = {.src = src, .dest = dest, .similarity = s};
+				row_pairs = array_append(row_pairs, pair);
+			}
+
+			uint count = array_len(row_pairs);
+			QSORT(SimilarityPair, row_pairs, count, PAIR_ISLT);
+			if(top_k > 0 && count > top_k) count = top_k;
+			for(uint k = 0; k < count; k++) {
+				result = array_append(result, row_pairs[k]);
+			}
+		}
+
+		rm_free(Cp);
+		rm_free(Cj);
+		rm_free(Cx);
+		Cp = NULL;
+		Cj = NULL;
+		Cx = NULL;
+	}
+
+	*pairs = result;
+	result = NULL;
+
+cleanup:
+	GrB_free(&d);
+	GrB_free(&B);
+	GrB_free(&C);
+	if(I != NULL) rm_free(I);
+	if(X != NULL) rm_free(X);
+	if(Cp != NULL) rm_free(Cp);
+	if(Cj != NULL) rm_free(Cj);
+	if(Cx != NULL) rm_free(Cx);
+	if(degree != NULL) rm_free(degree);
+	if(row_pairs != NULL) array_free(row_pairs);
+	if(result != NULL) array_free(result);
+	return info;
+}
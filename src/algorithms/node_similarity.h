@@ -0,0 +1,46 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// number of rows of A compared against all rows at once
+#define NODE_SIMILARITY_BLOCK_SIZE 4096
+
+typedef enum {
+	SIMILARITY_JACCARD,  // |N(i) & N(j)| / |N(i) | N(j)|
+	SIMILARITY_OVERLAP,  // |N(i) & N(j)| / min(|N(i)|, |N(j)|)
+	SIMILARITY_COSINE,   // |N(i) & N(j)| / sqrt(|N(i)| * |N(j)|)
+} SimilarityMetric;
+
+typedef struct {
+	GrB_Index src;       // compared node
+	GrB_Index dest;      // similar node
+	double similarity;   // similarity of src and dest
+} SimilarityPair;
+
+// computes the similarity of every pair of nodes sharing a neighbor
+// where N(i) is the set of nodes node i is connected to
+//
+// shared neighbor counts are computed by the sparse product A * A'
+// one block of NODE_SIMILARITY_BLOCK_SIZE rows at a time,
+// only pairs sharing at least one neighbor are ever materialized
+//
+// pairs less similar than 'cutoff' are discarded, and only the 'top_k'
+// most similar nodes of each node are kept, if 'top_k' is greater than 0
+//
+// on return 'pairs' holds the retained pairs, ordered by src and
+// by descending similarity, both (i, j) and (j, i) are reported
+// the array is allocated with array_new and owned by the caller
+GrB_Info NodeSimilarity
+(
+	SimilarityPair **pairs,   // [output] similar pairs of nodes
+	GrB_Matrix A,             // boolean input graph, not modified
+	SimilarityMetric metric,  // similarity measure
+	GrB_Index top_k,          // most similar nodes to keep per node, 0 for all
+	double cutoff             // minimal similarity kept
+);
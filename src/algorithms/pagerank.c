@@ -25,8 +25,10 @@
 */
 
 #include "pagerank.h"
+#include "../util/heap.h"
 #include "../util/rmalloc.h"
 #include <assert.h>
+#include <string.h>
 
 //------------------------------------------------------------------------------
 // scalar operators
@@ -57,6 +59,40 @@ int compar(const void *x, const void *y) {
 	}
 }
 
+// heap comparison, the heap keeps its greatest item at the top
+// which under compar is the lowest ranked page
+static int heap_compar(const void *x, const void *y, const void *udata) {
+	return compar(x, y) ;
+}
+
+//------------------------------------------------------------------------------
+// top_k: the k highest ranked pages, sorted in descending order
+//------------------------------------------------------------------------------
+
+// keeps the k highest ranked pages in a bounded heap instead of sorting
+// all n pages, P is reordered and its first k entries are the result
+static void top_k(LAGraph_PageRank *P, GrB_Index n, GrB_Index k) {
+	heap_t *heap = Heap_new(heap_compar, NULL) ;
+	for(GrB_Index i = 0 ; i < n ; i++) {
+		if(Heap_count(heap) < k) {
+			Heap_offer(&heap, P + i) ;
+		} else if(heap_compar(Heap_peek(heap), P + i, NULL) > 0) {
+			Heap_poll(heap) ;
+			Heap_offer(&heap, P + i) ;
+		}
+	}
+
+	// pop from lowest to highest rank
+	LAGraph_PageRank *top = rm_malloc(k * sizeof(LAGraph_PageRank)) ;
+	for(GrB_Index i = k ; i > 0 ; i--) {
+		top [i - 1] = *(LAGraph_PageRank *)Heap_poll(heap) ;
+	}
+	memcpy(P, top, k * sizeof(LAGraph_PageRank)) ;
+
+	rm_free(top) ;
+	Heap_free(heap) ;
+}
+
 //------------------------------------------------------------------------------
 // LAGraph_pagerank: compute the pagerank of all nodes in a graph
 //------------------------------------------------------------------------------
@@ -69,6 +105,23 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 	double tol,                 // stop when norm (r-rnew,2) < tol
 	int *iters                  // number of iterations taken
 ) {
+	GrB_Index count ;
+	return Pagerank_Personalized(Phandle, &count, A, NULL, NULL, 0, itermax,
+			tol, iters) ;
+}
+
+GrB_Info Pagerank_Personalized  // GrB_SUCCESS or error condition
+(
+	LAGraph_PageRank **Phandle, // output: array of LAGraph_PageRank structs
+	GrB_Index *count,           // output: number of entries in Phandle
+	GrB_Matrix A,               // binary input graph, not modified
+	GrB_Vector seeds,           // optional teleport distribution
+	GrB_Vector init,            // optional initial ranking
+	GrB_Index top,              // number of top ranked pages to return, 0 for all
+	int itermax,                // max number of iterations
+	double tol,                 // stop when norm (r-rnew,2) < tol
+	int *iters                  // number of iterations taken
+) {
 
 	//--------------------------------------------------------------------------
 	// initializations
@@ -80,11 +133,14 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 	LAGraph_PageRank *P = NULL ;
 	GrB_BinaryOp op_diff = NULL ;
 	GrB_Index n, nvals, *I = NULL ;
-	GrB_Vector r = NULL, t = NULL, d = NULL ;
+	GrB_Vector r = NULL, t = NULL, d = NULL, p = NULL ;
 	GrB_Matrix C = NULL, D = NULL, T = NULL ;
 
 	assert(Phandle);
+	assert(count);
 	(*Phandle) = NULL ;
+	(*count) = 0 ;
+	(*iters) = 0 ;
 
 	// n = size (A,1) ;         // number of nodes
 	assert(GrB_Matrix_nrows(&n, A) == GrB_SUCCESS) ;
@@ -99,6 +155,32 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 	assert(GrB_Vector_new(&r, GrB_FP32, n) == GrB_SUCCESS) ;
 	assert(GrB_assign(r, NULL, NULL, x, GrB_ALL, n, NULL) == GrB_SUCCESS) ;
 
+	if(init != NULL) {
+		// warm start, r (i) = init (i), nodes missing from init keep 1/n
+		// r = r / sum (r)
+		float isum ;
+		assert(GrB_assign(r, init, NULL, init, GrB_ALL, n, GrB_DESC_S) == GrB_SUCCESS) ;
+		assert(GrB_reduce(&isum, NULL, GxB_PLUS_FP32_MONOID, r, NULL) == GrB_SUCCESS) ;
+		if(isum > 0) {
+			assert(GrB_Vector_assign_FP32(r, NULL, GrB_TIMES_FP32, 1 / isum, GrB_ALL, n, NULL) == GrB_SUCCESS) ;
+		} else {
+			assert(GrB_assign(r, NULL, NULL, x, GrB_ALL, n, NULL) == GrB_SUCCESS) ;
+		}
+	}
+
+	if(seeds != NULL) {
+		// p = (1 - 0.85) * seeds / sum (seeds)
+		float ssum ;
+		assert(GrB_reduce(&ssum, NULL, GxB_PLUS_FP32_MONOID, seeds, NULL) == GrB_SUCCESS) ;
+		if(ssum <= 0) {
+			GrB_free(&r) ;
+			return (GrB_INVALID_VALUE) ;
+		}
+		assert(GrB_Vector_new(&p, GrB_FP32, n) == GrB_SUCCESS) ;
+		assert(GrB_Vector_apply_BinaryOp1st_FP32(p, NULL, NULL, GrB_TIMES_FP32,
+					(one - DAMPING) / ssum, seeds, NULL) == GrB_SUCCESS) ;
+	}
+
 	// d (i) = out deg of node i
 	assert(GrB_Vector_new(&d, GrB_FP32, n) == GrB_SUCCESS) ;
 	assert(GrB_reduce(d, NULL, NULL, GrB_PLUS_FP32, A, NULL) == GrB_SUCCESS) ;
@@ -171,9 +253,15 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 		// using the transpose of A, scaled (dot product)
 		assert(GrB_mxv(t, NULL, NULL, GxB_PLUS_TIMES_FP32, C, r, NULL) == GrB_SUCCESS) ;
 
-		// t += teleport_scalar ;
-		float teleport_scalar = teleport * rsum ;
-		assert(GrB_assign(t, NULL, GrB_PLUS_FP32, teleport_scalar, GrB_ALL, n, NULL) == GrB_SUCCESS) ;
+		if(p == NULL) {
+			// t += teleport_scalar ;
+			float teleport_scalar = teleport * rsum ;
+			assert(GrB_assign(t, NULL, GrB_PLUS_FP32, teleport_scalar, GrB_ALL, n, NULL) == GrB_SUCCESS) ;
+		} else {
+			// t += p * sum (r), teleporting to the seeds only
+			assert(GrB_Vector_apply_BinaryOp1st_FP32(t, NULL, GrB_PLUS_FP32,
+						GrB_TIMES_FP32, rsum, p, NULL) == GrB_SUCCESS) ;
+		}
 		//----------------------------------------------------------------------
 		// rdiff = sum ((r-t).^2)
 		//----------------------------------------------------------------------
@@ -230,14 +318,22 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 		P [k].page = k ;
 	}
 
-	// qsort (P) in descending order
-	qsort(P, n, sizeof(LAGraph_PageRank), compar) ;
+	if(top > 0 && top < n) {
+		// select the top ranked pages without sorting all of them
+		top_k(P, n, top) ;
+		P = rm_realloc(P, top * sizeof(LAGraph_PageRank)) ;
+		n = top ;
+	} else {
+		// qsort (P) in descending order
+		qsort(P, n, sizeof(LAGraph_PageRank), compar) ;
+	}
 
 	//--------------------------------------------------------------------------
 	// return result
 	//--------------------------------------------------------------------------
 
 	(*Phandle) = P ;
+	(*count) = n ;
 
 	// Clean up.
 	rm_free(I) ;
@@ -248,6 +344,7 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 	GrB_free(&r) ;
 	GrB_free(&t) ;
 	GrB_free(&d) ;
+	GrB_free(&p) ;
 	GrB_free(&op_diff) ;
 
 	return (GrB_SUCCESS) ;
@@ -38,3 +38,24 @@ GrB_Info Pagerank               // GrB_SUCCESS or error condition
 	double tol,                 // stop when norm (r-rnew,2) < tol
 	int *iters                  // number of iterations taken
 );
+
+// personalized pagerank
+// if 'seeds' is specified, random jumps land on the nodes of 'seeds'
+// proportionally to their value, otherwise on any node uniformly
+// if 'init' is specified, iterations start from its normalized values,
+// nodes missing from 'init' start at 1/n, close to the final ranking
+// 'init' converges within a few iterations
+// if 'top' is greater than zero, only the 'top' highest ranked pages
+// are returned and the remaining pages are never sorted
+GrB_Info Pagerank_Personalized  // GrB_SUCCESS or error condition
+(
+	LAGraph_PageRank **Phandle, // output: array of LAGraph_PageRank structs
+	GrB_Index *count,           // output: number of entries in Phandle
+	GrB_Matrix A,               // binary input graph, not modified
+	GrB_Vector seeds,           // optional teleport distribution
+	GrB_Vector init,            // optional initial ranking
+	GrB_Index top,              // number of top ranked pages to return, 0 for all
+	int itermax,                // max number of iterations
+	double tol,                 // stop when norm (r-rnew,2) < tol
+	int *iters                  // number of iterations taken
+);
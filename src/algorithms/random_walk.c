@@ -0,0 +1,167 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "random_walk.h"
+#include "../RG.h"
+#include "../config.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include <omp.h>
+
+// splitmix64, a cheap generator whose state is a single word,
+// each walk and each source draws from a state of its own
+static inline uint64_t _Next(uint64_t *state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// sets 'cols' to the neighbors of 'id', read in place from A's row
+static inline GrB_Index _Neighbors(GxB_MatrixTupleIter *it, GrB_Index id,
+		const GrB_Index **cols) {
+	bool depleted = true;
+	GrB_Index count = 0;
+	if(GxB_MatrixTupleIter_iterate_row(it, id) == GrB_SUCCESS) {
+		GxB_MatrixTupleIter_next_row(it, NULL, cols, NULL, &count, &depleted);
+	}
+	return depleted ? 0 : count;
+}
+
+// creates an iterator over A per thread, rows are read concurrently
+static GrB_Info _Iterators(GxB_MatrixTupleIter ***iters, int *nthreads,
+		GrB_Matrix A) {
+	Config_Option_get(Config_OPENMP_NTHREAD, nthreads);
+	if(*nthreads < 1) *nthreads = 1;
+
+	*iters = rm_calloc(*nthreads, sizeof(GxB_MatrixTupleIter *));
+	for(int i = 0; i < *nthreads; i++) {
+		GrB_Info info = GxB_MatrixTupleIter_new(*iters + i, A);
+		if(info != GrB_SUCCESS) return info;
+	}
+	return GrB_SUCCESS;
+}
+
+static void _FreeIterators(GxB_MatrixTupleIter **iters, int nthreads) {
+	for(int i = 0; i < nthreads; i++) {
+		if(iters[i] != NULL) GxB_MatrixTupleIter_free(iters[i]);
+	}
+	rm_free(iters);
+}
+
+GrB_Info RandomWalk(GrB_Index *walks, uint64_t *lengths, const GrB_Index *sources,
+		GrB_Index source_count, uint64_t walk_count, uint64_t length,
+		uint64_t seed, GrB_Matrix A) {
+	ASSERT(A != NULL);
+	ASSERT(walks != NULL);
+	ASSERT(lengths != NULL);
+	ASSERT(sources != NULL || source_count == 0);
+
+	int nthreads;
+	GxB_MatrixTupleIter **iters;
+	GrB_Info info = _Iterators(&iters, &nthreads, A);
+	if(info != GrB_SUCCESS) {
+		_FreeIterators(iters, nthreads);
+		return info;
+	}
+
+	uint64_t total = source_count * walk_count;
+	#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 64)
+	for(uint64_t w = 0; w < total; w++) {
+		GxB_MatrixTupleIter *it = iters[omp_get_thread_num()];
+		GrB_Index *walk = walks + w * (length + 1);
+		uint64_t state = seed ^ (w * 0xD1B54A32D192ED03ULL);
+
+		uint64_t n = 1;
+		walk[0] = sources[w / walk_count];
+		for(; n <= length; n++) {
+			const GrB_Index *cols;
+			GrB_Index count = _Neighbors(it, walk[n - 1], &cols);
+			if(count == 0) break;
+			walk[n] = cols[_Next(&state) % count];
+		}
+		lengths[w] = n;
+	}
+
+	_FreeIterators(iters, nthreads);
+	return GrB_SUCCESS;
+}
+
+// appends up to 'fanout' distinct neighbors of 'parent' to 'samples'
+// picking them by Floyd's algorithm, in time independent of parent's degree
+static NeighborSample *_Sample(GxB_MatrixTupleIter *it, uint64_t *state,
+		NeighborSample *samples, GrB_Index parent, uint64_t hop, uint64_t fanout) {
+	const GrB_Index *cols;
+	GrB_Index count = _Neighbors(it, parent, &cols);
+
+	if(count <= fanout) {
+		for(GrB_Index i = 0; i < count; i++) {
+			NeighborSample s = {.parent = parent, .node = cols[i], .hop = hop};
+			samples = array_append(samples, s);
+		}
+		return samples;
+	}
+
+	// picked neighbors are this call's last 'fanout' samples
+	uint32_t first = array_len(samples);
+	for(GrB_Index j = count - fanout; j < count; j++) {
+		GrB_Index pick = _Next(state) % (j + 1);
+		for(uint32_t k = first; k < array_len(samples); k++) {
+			if(samples[k].node == cols[pick]) {
+				pick = j;
+				break;
+			}
+		}
+		NeighborSample s = {.parent = parent, .node = cols[pick], .hop = hop};
+		samples = array_append(samples, s);
+	}
+	return samples;
+}
+
+GrB_Info SampleNeighbors(NeighborSample ***samples, const GrB_Index *sources,
+		GrB_Index source_count, const uint64_t *fanouts, uint64_t hop_count,
+		uint64_t seed, GrB_Matrix A) {
+	ASSERT(A != NULL);
+	ASSERT(samples != NULL);
+	ASSERT(fanouts != NULL || hop_count == 0);
+	ASSERT(sources != NULL || source_count == 0);
+
+	*samples = NULL;
+
+	int nthreads;
+	GxB_MatrixTupleIter **iters;
+	GrB_Info info = _Iterators(&iters, &nthreads, A);
+	if(info != GrB_SUCCESS) {
+		_FreeIterators(iters, nthreads);
+		return info;
+	}
+
+	*samples = rm_malloc(sizeof(NeighborSample *) * source_count);
+
+	#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 16)
+	for(GrB_Index i = 0; i < source_count; i++) {
+		GxB_MatrixTupleIter *it = iters[omp_get_thread_num()];
+		uint64_t state = seed ^ (i * 0xD1B54A32D192ED03ULL);
+		NeighborSample *s = array_new(NeighborSample, 0);
+
+		// the previous hop's samples are the parents of the current hop
+		if(hop_count > 0) s = _Sample(it, &state, s, sources[i], 1, fanouts[0]);
+		uint32_t begin = 0;
+		for(uint64_t hop = 2; hop <= hop_count; hop++) {
+			uint32_t end = array_len(s);
+			if(begin == end) break;
+			for(uint32_t p = begin; p < end; p++) {
+				s = _Sample(it, &state, s, s[p].node, hop, fanouts[hop - 1]);
+			}
+			begin = end;
+		}
+
+		(*samples)[i] = s;
+	}
+
+	_FreeIterators(iters, nthreads);
+	return GrB_SUCCESS;
+}
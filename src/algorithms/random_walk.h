@@ -0,0 +1,53 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// a node sampled from the neighborhood of a source
+typedef struct {
+	GrB_Index parent;  // node the sample was drawn from
+	GrB_Index node;    // sampled neighbor of parent
+	uint64_t hop;      // distance from the source, starting at 1
+} NeighborSample;
+
+// performs 'walk_count' random walks of up to 'length' hops from each source
+// following the entries of A's rows, each hop picks one of the current node's
+// neighbors uniformly at random, a walk ends early at a node without neighbors
+//
+// walk w starts at sources[w / walk_count], its i-th node is written to
+// walks[w * (length + 1) + i] and its number of nodes to lengths[w]
+// walks are computed in parallel, the same seed reproduces the same walks
+GrB_Info RandomWalk
+(
+	GrB_Index *walks,          // [output] nodes of each walk
+	uint64_t *lengths,         // [output] number of nodes in each walk
+	const GrB_Index *sources,  // walks' starting nodes
+	GrB_Index source_count,    // number of sources
+	uint64_t walk_count,       // number of walks per source
+	uint64_t length,           // maximum number of hops per walk
+	uint64_t seed,             // random seed
+	GrB_Matrix A               // graph walked, row i holds i's neighbors
+);
+
+// samples the neighborhood of each source, at hop h up to fanouts[h - 1]
+// distinct neighbors of every node sampled at hop h - 1 are drawn,
+// the source being hop 0, neighbors are drawn without replacement
+//
+// on return samples[s] is an array (util/arr.h) of the nodes sampled
+// for source s, ordered by hop, samples and its arrays are owned by the caller
+// sources are sampled in parallel, the same seed reproduces the same samples
+GrB_Info SampleNeighbors
+(
+	NeighborSample ***samples,  // [output] samples of each source
+	const GrB_Index *sources,   // nodes whose neighborhood is sampled
+	GrB_Index source_count,     // number of sources
+	const uint64_t *fanouts,    // number of neighbors sampled per node per hop
+	uint64_t hop_count,         // number of hops
+	uint64_t seed,              // random seed
+	GrB_Matrix A                // graph sampled, row i holds i's neighbors
+);
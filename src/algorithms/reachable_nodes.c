@@ -0,0 +1,291 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "reachable_nodes.h"
+#include "RG.h"
+#include "../config.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+#include <string.h>
+#include <sys/param.h>
+
+// Selects the expansion direction, see LAGraph_bfs_pushpull.
+// Pushing multiplies the frontier by the rows of the traversed matrix,
+// pulling computes a dot product for each unvisited node with its column.
+// Returns true if pulling is expected to be cheaper.
+static bool _ReachableNodesCtx_Pull(const ReachableNodesCtx *ctx, GrB_Matrix M,
+		GrB_Index nq, GrB_Index nvisited) {
+	if(nq == 0 || ctx->dim == 0) return false;
+
+	GrB_Index nvals;
+	GrB_Matrix_nvals(&nvals, M);
+
+	// every source traverses its own copy of the graph
+	double n = (double)ctx->src_count * ctx->dim;
+	double d = (double)nvals / ctx->dim;
+	double pushwork = d * nq;
+	double expected = n / (nvisited + 1);
+	double per_dot = MIN(d, expected);
+	double binarysearch = 3 * (1 + log2((double)nq));
+	double pullwork = (n - nvisited) * per_dot * binarysearch;
+	return pushwork > pullwork;
+}
+
+// next<!visited> = frontier * A, or frontier * A' if transpose is set
+// first product replaces next's content, the following ones accumulate
+static void _ReachableNodesCtx_Multiply(ReachableNodesCtx *ctx, GrB_Matrix A,
+		bool transpose, bool pull, bool first) {
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Descriptor desc;
+	if(pull) {
+		desc = (first) ? ctx->pull_replace_desc : ctx->pull_desc;
+	} else if(transpose) {
+		desc = (first) ? GrB_DESC_RSCT1 : GrB_DESC_SCT1;
+	} else {
+		desc = (first) ? GrB_DESC_RSC : GrB_DESC_SC;
+	}
+
+	info = GrB_mxm(ctx->next, ctx->visited, first ? GrB_NULL : GrB_LOR,
+				   GxB_ANY_PAIR_BOOL, ctx->frontier, A, desc);
+	ASSERT(info == GrB_SUCCESS);
+}
+
+// Computes the nodes one hop away from each frontier which weren't visited.
+// Each relation is expanded either by pushing the frontier along its edges or
+// by pulling, evaluating dot products against the relation's transpose,
+// whichever is expected to be cheaper given the frontier's density.
+static void _ReachableNodesCtx_Expand(ReachableNodesCtx *ctx) {
+	GrB_Index nq;
+	GrB_Index nvisited;
+	GrB_Matrix_nvals(&nq, ctx->frontier);
+	GrB_Matrix_nvals(&nvisited, ctx->visited);
+
+	bool maintain_transpose;
+	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
+
+	// first product replaces next's content, the following ones accumulate
+	bool first = true;
+	for(int i = 0; i < ctx->relationCount; i++) {
+		int r = ctx->relationIDs[i];
+		GrB_Matrix M = (r == GRAPH_NO_RELATION) ?
+					   Graph_GetAdjacencyMatrix(ctx->g) :
+					   Graph_GetRelationMatrix(ctx->g, r);
+		bool pull = _ReachableNodesCtx_Pull(ctx, M, nq, nvisited);
+
+		if(ctx->dir != GRAPH_EDGE_DIR_INCOMING) {
+			// pulling outgoing edges requires a transpose,
+			// which isn't computed solely for this purpose
+			GrB_Matrix TM = GrB_NULL;
+			if(pull && (maintain_transpose || r == GRAPH_NO_RELATION)) {
+				TM = Graph_GetCachedTransposedRelationMatrix(ctx->g, r);
+			}
+			if(TM != GrB_NULL) _ReachableNodesCtx_Multiply(ctx, TM, true, true, first);
+			else _ReachableNodesCtx_Multiply(ctx, M, false, false, first);
+			first = false;
+		}
+
+		if(ctx->dir != GRAPH_EDGE_DIR_OUTGOING) {
+			// incoming edges, pull through the matrix or push through its transpose
+			if(pull) {
+				_ReachableNodesCtx_Multiply(ctx, M, true, true, first);
+			} else {
+				GrB_Matrix TM = Graph_GetCachedTransposedRelationMatrix(ctx->g, r);
+				_ReachableNodesCtx_Multiply(ctx, TM, false, false, first);
+			}
+			first = false;
+		}
+	}
+
+	if(first) GrB_Matrix_clear(ctx->next);
+}
+
+// Queues frontier entries for reporting.
+static void _ReachableNodesCtx_CollectFrontier(ReachableNodesCtx *ctx) {
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Index n;
+	info = GrB_Matrix_nvals(&n, ctx->frontier);
+	ASSERT(info == GrB_SUCCESS);
+	if(n > ctx->pending_cap) {
+		ctx->pending_cap = n;
+		ctx->pending_src = rm_realloc(ctx->pending_src, sizeof(GrB_Index) * n);
+		ctx->pending_node = rm_realloc(ctx->pending_node, sizeof(GrB_Index) * n);
+	}
+
+	ctx->pending_idx = 0;
+	ctx->pending_count = n;
+	info = GrB_Matrix_extractTuples_BOOL(ctx->pending_src, ctx->pending_node, NULL,
+										 &ctx->pending_count, ctx->frontier);
+	ASSERT(info == GrB_SUCCESS);
+
+	if(ctx->dsts == NULL) return;
+
+	// retain only entries reaching their source's destination
+	GrB_Index kept = 0;
+	for(GrB_Index i = 0; i < ctx->pending_count; i++) {
+		if(ctx->pending_node[i] != (GrB_Index)ctx->dsts[ctx->pending_src[i]]) continue;
+		ctx->pending_src[kept] = ctx->pending_src[i];
+		ctx->pending_node[kept] = ctx->pending_node[i];
+		kept++;
+	}
+	ctx->pending_count = kept;
+}
+
+ReachableNodesCtx *ReachableNodesCtx_New(Graph *g, int *relationIDs, int relationCount,
+										 GRAPH_EDGE_DIR dir, uint minLen, uint maxLen,
+										 uint batch_cap) {
+	ASSERT(g != NULL && batch_cap > 0);
+	// nodes reachable via longer walks might not be reachable via trails
+	ASSERT(minLen <= 1 && minLen <= maxLen);
+
+	GrB_Info info;
+	UNUSED(info);
+
+	ReachableNodesCtx *ctx = rm_malloc(sizeof(ReachableNodesCtx));
+	ctx->g = g;
+	ctx->relationIDs = relationIDs;
+	ctx->relationCount = relationCount;
+	ctx->dir = dir;
+	ctx->minLen = minLen;
+	ctx->maxLen = maxLen;
+	ctx->depth = maxLen;
+	ctx->batch_cap = batch_cap;
+	ctx->dsts = NULL;
+	ctx->pending_cap = 16;
+	ctx->pending_src = rm_malloc(sizeof(GrB_Index) * ctx->pending_cap);
+	ctx->pending_node = rm_malloc(sizeof(GrB_Index) * ctx->pending_cap);
+	ctx->pending_count = 0;
+	ctx->pending_idx = 0;
+
+	GrB_Index dim = Graph_RequiredMatrixDim(g);
+	ctx->dim = dim;
+	info = GrB_Matrix_new(&ctx->frontier, GrB_BOOL, batch_cap, dim);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_new(&ctx->next, GrB_BOOL, batch_cap, dim);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_new(&ctx->visited, GrB_BOOL, batch_cap, dim);
+	ASSERT(info == GrB_SUCCESS);
+	ctx->src_count = 0;
+
+	// pull steps mask out visited nodes and compute dot products
+	// against a transposed operand
+	GrB_Descriptor *descs[2] = {&ctx->pull_desc, &ctx->pull_replace_desc};
+	for(int i = 0; i < 2; i++) {
+		GrB_Descriptor_new(descs[i]);
+		GrB_Descriptor_set(*descs[i], GrB_MASK, GrB_COMP + GrB_STRUCTURE);
+		GrB_Descriptor_set(*descs[i], GrB_INP1, GrB_TRAN);
+		GrB_Descriptor_set(*descs[i], GxB_AxB_METHOD, GxB_AxB_DOT);
+	}
+	GrB_Descriptor_set(ctx->pull_replace_desc, GrB_OUTP, GrB_REPLACE);
+
+	return ctx;
+}
+
+void ReachableNodesCtx_Reset(ReachableNodesCtx *ctx, const NodeID *srcs, const NodeID *dsts,
+							 uint count) {
+	ASSERT(ctx != NULL && srcs != NULL && count <= ctx->batch_cap);
+
+	GrB_Info info;
+	UNUSED(info);
+
+	ctx->depth = 0;
+	ctx->src_count = count;
+	ctx->pending_idx = 0;
+	ctx->pending_count = 0;
+
+	if(dsts) {
+		if(!ctx->dsts) ctx->dsts = rm_malloc(sizeof(NodeID) * ctx->batch_cap);
+		memcpy(ctx->dsts, dsts, sizeof(NodeID) * count);
+	} else if(ctx->dsts) {
+		rm_free(ctx->dsts);
+		ctx->dsts = NULL;
+	}
+
+	// the graph might have grown since the previous traversal
+	GrB_Index dim = Graph_RequiredMatrixDim(ctx->g);
+	if(dim != ctx->dim) {
+		ctx->dim = dim;
+		info = GxB_Matrix_resize(ctx->frontier, ctx->batch_cap, dim);
+		ASSERT(info == GrB_SUCCESS);
+		info = GxB_Matrix_resize(ctx->next, ctx->batch_cap, dim);
+		ASSERT(info == GrB_SUCCESS);
+		info = GxB_Matrix_resize(ctx->visited, ctx->batch_cap, dim);
+		ASSERT(info == GrB_SUCCESS);
+	}
+
+	info = GrB_Matrix_clear(ctx->frontier);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_clear(ctx->visited);
+	ASSERT(info == GrB_SUCCESS);
+	for(uint i = 0; i < count; i++) {
+		info = GrB_Matrix_setElement_BOOL(ctx->frontier, true, i, srcs[i]);
+		ASSERT(info == GrB_SUCCESS);
+	}
+
+	// source nodes are reported only if they're reachable within minLen hops,
+	// otherwise they may still be discovered by a cycle leading back to them
+	if(ctx->minLen == 0) {
+		info = GrB_Matrix_apply(ctx->visited, GrB_NULL, GrB_NULL, GrB_IDENTITY_BOOL,
+								ctx->frontier, GrB_NULL);
+		ASSERT(info == GrB_SUCCESS);
+		_ReachableNodesCtx_CollectFrontier(ctx);
+	}
+}
+
+bool ReachableNodesCtx_Next(ReachableNodesCtx *ctx, uint *src_idx, NodeID *id) {
+	ASSERT(ctx != NULL && src_idx != NULL && id != NULL);
+
+	GrB_Info info;
+	UNUSED(info);
+
+	while(ctx->pending_idx == ctx->pending_count) {
+		if(ctx->depth >= ctx->maxLen) return false;
+
+		_ReachableNodesCtx_Expand(ctx);
+		ctx->depth++;
+
+		GrB_Index n;
+		info = GrB_Matrix_nvals(&n, ctx->next);
+		ASSERT(info == GrB_SUCCESS);
+		if(n == 0) {
+			// no new nodes discovered, traversal is done
+			ctx->depth = ctx->maxLen;
+			return false;
+		}
+
+		// mark discovered nodes as visited
+		info = GrB_Matrix_assign_BOOL(ctx->visited, ctx->next, GrB_NULL, true, GrB_ALL,
+									  ctx->batch_cap, GrB_ALL, ctx->dim, GrB_DESC_S);
+		ASSERT(info == GrB_SUCCESS);
+
+		GrB_Matrix t = ctx->frontier;
+		ctx->frontier = ctx->next;
+		ctx->next = t;
+
+		if(ctx->depth >= ctx->minLen) _ReachableNodesCtx_CollectFrontier(ctx);
+	}
+
+	*src_idx = ctx->pending_src[ctx->pending_idx];
+	*id = ctx->pending_node[ctx->pending_idx];
+	ctx->pending_idx++;
+	return true;
+}
+
+void ReachableNodesCtx_Free(ReachableNodesCtx *ctx) {
+	if(!ctx) return;
+	GrB_Matrix_free(&ctx->frontier);
+	GrB_Matrix_free(&ctx->next);
+	GrB_Matrix_free(&ctx->visited);
+	GrB_free(&ctx->pull_desc);
+	GrB_free(&ctx->pull_replace_desc);
+	if(ctx->dsts) rm_free(ctx->dsts);
+	rm_free(ctx->pending_src);
+	rm_free(ctx->pending_node);
+	rm_free(ctx);
+}
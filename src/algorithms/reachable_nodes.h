@@ -0,0 +1,80 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+/*
+ * Finds all nodes reachable from each of a batch of source nodes.
+ * Unlike AllPathsCtx, which produces every path, each node reachable
+ * from a source is reported once, at the level in which it is first discovered.
+ * The frontiers of all sources are kept in a single sparse matrix, row i holding
+ * the frontier of source i, levels are computed one at a time by multiplying
+ * the frontier with the traversed relation matrices while masking out every
+ * node visited so far, such that no node is expanded more than once per source.
+ * Each level is either pushed, expanding the frontier's edges, or pulled,
+ * probing the edges of unvisited nodes, depending on the frontier's density.
+ * Nodes are reported lazily, to take advantage of queries specifying LIMIT.
+ * */
+
+#pragma once
+
+#include "../graph/graph.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+typedef struct {
+	Graph *g;                   // Graph to traverse.
+	int *relationIDs;           // Edge type(s) to traverse.
+	int relationCount;          // Length of relationIDs.
+	GRAPH_EDGE_DIR dir;         // Traverse direction.
+	uint minLen;                // Minimum number of hops to a reported node.
+	uint maxLen;                // Maximum number of hops to a reported node.
+	uint depth;                 // Number of hops to the current frontier.
+	uint batch_cap;             // Maximum number of sources traversed at once.
+	uint src_count;             // Number of sources currently traversed.
+	NodeID *dsts;               // Destination node of each source, NULL if unknown.
+	GrB_Index dim;              // Number of columns in matrices.
+	GrB_Matrix frontier;        // Nodes first discovered at current depth, per source.
+	GrB_Matrix next;            // Nodes discovered at the following depth, per source.
+	GrB_Matrix visited;         // Nodes discovered so far, per source.
+	GrB_Descriptor pull_desc;   // Pull step descriptor, accumulates into next.
+	GrB_Descriptor pull_replace_desc;  // Pull step descriptor, replaces next.
+	GrB_Index *pending_src;     // Source index of each frontier entry yet to be reported.
+	GrB_Index *pending_node;    // Node of each frontier entry yet to be reported.
+	GrB_Index pending_count;    // Number of pending entries.
+	GrB_Index pending_idx;      // Next pending entry to report.
+	GrB_Index pending_cap;      // Allocated length of pending arrays.
+} ReachableNodesCtx;
+
+// Create a new reachable nodes context object.
+ReachableNodesCtx *ReachableNodesCtx_New(
+	Graph *g,            // Graph to traverse.
+	int *relationIDs,    // Edge type(s) on which we'll traverse.
+	int relationCount,   // Length of relationIDs.
+	GRAPH_EDGE_DIR dir,  // Traversal direction.
+	uint minLen,         // Reported nodes are at least minLen hops away, at most 1.
+	uint maxLen,         // Reported nodes are at most maxLen hops away.
+	uint batch_cap       // Maximum number of sources traversed at once.
+);
+
+// Restarts traversal from srcs, if dsts isn't NULL
+// only dsts[i] is reported for source i, in case it is reachable.
+void ReachableNodesCtx_Reset(
+	ReachableNodesCtx *ctx,
+	const NodeID *srcs,  // Source nodes.
+	const NodeID *dsts,  // Destination node of each source, optional.
+	uint count           // Number of sources, at most batch_cap.
+);
+
+// Retrieves the next reachable node and the index of the source reaching it,
+// returns false once all reachable nodes have been reported.
+bool ReachableNodesCtx_Next(
+	ReachableNodesCtx *ctx,
+	uint *src_idx,
+	NodeID *id
+);
+
+// Free context object.
+void ReachableNodesCtx_Free(
+	ReachableNodesCtx *ctx
+);
@@ -0,0 +1,100 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "sssp.h"
+#include "../RG.h"
+#include <math.h>
+
+#define SSSP_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+GrB_Info SSSP(GrB_Vector *cost, GrB_Vector *level, GrB_Matrix W, GrB_Index src,
+			  GrB_Index target, double max_cost) {
+	ASSERT(W != NULL);
+	ASSERT(cost != NULL);
+	ASSERT(level != NULL);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Index nvals;
+	GrB_Vector d         =  GrB_NULL;  // cost of cheapest path found so far
+	GrB_Vector lvl       =  GrB_NULL;  // round in which d was last updated
+	GrB_Vector frontier  =  GrB_NULL;  // nodes updated in the last round
+	GrB_Vector t         =  GrB_NULL;  // costs reached by extending the frontier
+	GrB_Vector lt        =  GrB_NULL;  // t entries improving d
+	GrB_Vector fresh     =  GrB_NULL;  // t entries missing from d
+	GrB_Vector changed   =  GrB_NULL;  // nodes updated in this round
+	GxB_Scalar bound     =  GrB_NULL;  // costliest path kept
+
+	SSSP_TRY(GrB_Matrix_nrows(&n, W));
+	SSSP_TRY(GrB_Vector_new(&d, GrB_FP64, n));
+	SSSP_TRY(GrB_Vector_new(&lvl, GrB_UINT64, n));
+	SSSP_TRY(GrB_Vector_new(&frontier, GrB_FP64, n));
+	SSSP_TRY(GrB_Vector_new(&t, GrB_FP64, n));
+	SSSP_TRY(GrB_Vector_new(&lt, GrB_BOOL, n));
+	SSSP_TRY(GrB_Vector_new(&fresh, GrB_BOOL, n));
+	SSSP_TRY(GrB_Vector_new(&changed, GrB_BOOL, n));
+	SSSP_TRY(GxB_Scalar_new(&bound, GrB_FP64));
+
+	SSSP_TRY(GrB_Vector_setElement_FP64(d, 0, src));
+	SSSP_TRY(GrB_Vector_setElement_UINT64(lvl, 0, src));
+	SSSP_TRY(GrB_Vector_setElement_FP64(frontier, 0, src));
+
+	// with non-negative costs a cheapest path visits each node at most once
+	for(GrB_Index round = 1; round < n; round++) {
+		// t[j] = min(frontier[i] + W[i, j])
+		SSSP_TRY(GrB_vxm(t, GrB_NULL, GrB_NULL, GrB_MIN_PLUS_SEMIRING_FP64,
+						 frontier, W, GrB_DESC_R));
+
+		// discard paths costlier than the bound
+		double limit = max_cost;
+		if(target != GxB_INDEX_MAX) {
+			double target_cost;
+			if(GrB_Vector_extractElement_FP64(&target_cost, d, target) == GrB_SUCCESS) {
+				limit = fmin(limit, target_cost);
+			}
+		}
+		if(limit < INFINITY) {
+			SSSP_TRY(GxB_Scalar_setElement_FP64(bound, limit));
+			SSSP_TRY(GxB_Vector_select(t, GrB_NULL, GrB_NULL, GxB_LE_THUNK, t,
+									   bound, GrB_NULL));
+		}
+
+		// changed = (t < d) or t not in d
+		SSSP_TRY(GrB_Vector_apply(fresh, d, GrB_NULL, GxB_ONE_BOOL, t,
+								  GrB_DESC_RSC));
+		SSSP_TRY(GrB_Vector_eWiseMult_BinaryOp(lt, GrB_NULL, GrB_NULL, GrB_LT_FP64,
+											   t, d, GrB_DESC_R));
+		SSSP_TRY(GrB_Vector_eWiseAdd_BinaryOp(changed, GrB_NULL, GrB_NULL, GrB_LOR,
+											  lt, fresh, GrB_DESC_R));
+
+		// next frontier holds the updated nodes
+		SSSP_TRY(GrB_Vector_apply(frontier, changed, GrB_NULL, GrB_IDENTITY_FP64,
+								  t, GrB_DESC_R));
+		SSSP_TRY(GrB_Vector_nvals(&nvals, frontier));
+		if(nvals == 0) break;
+
+		SSSP_TRY(GrB_Vector_assign(d, changed, GrB_NULL, frontier, GrB_ALL, n,
+								   GrB_NULL));
+		SSSP_TRY(GrB_Vector_assign_UINT64(lvl, changed, GrB_NULL, round, GrB_ALL,
+										  n, GrB_NULL));
+	}
+
+	*cost = d;
+	*level = lvl;
+	d = GrB_NULL;
+	lvl = GrB_NULL;
+
+cleanup:
+	GrB_free(&d);
+	GrB_free(&lvl);
+	GrB_free(&frontier);
+	GrB_free(&t);
+	GrB_free(&lt);
+	GrB_free(&fresh);
+	GrB_free(&changed);
+	GrB_free(&bound);
+	return info;
+}
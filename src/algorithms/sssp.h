@@ -0,0 +1,33 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// computes the cost of the cheapest path from 'src' to every reachable node
+// by relaxing the nodes updated in the previous round over the (min, +)
+// semiring, a frontier-driven Bellman-Ford
+//
+// W holds the non-negative cost of each edge, W[i, j] for the edge i->j
+// paths costing more than 'max_cost' are discarded
+// once 'target' is reached, paths costing more than it are discarded too,
+// as they can't lead to a cheaper path to 'target'
+// pass GxB_INDEX_MAX as 'target' to compute costs to all nodes
+//
+// 'cost' maps each reached node to the cost of the cheapest path to it
+// 'level' maps each reached node to the round in which its cost was set,
+// the source being set at round 0, on a cheapest path to node v
+// every node preceding v was set at an earlier round than v
+GrB_Info SSSP
+(
+	GrB_Vector *cost,   // [output] cost of the cheapest path to each node
+	GrB_Vector *level,  // [output] round in which each node's cost was set
+	GrB_Matrix W,       // edge costs
+	GrB_Index src,      // source node
+	GrB_Index target,   // optional target node, GxB_INDEX_MAX if unspecified
+	double max_cost     // maximum path cost
+);
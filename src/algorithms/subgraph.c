@@ -0,0 +1,55 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "subgraph.h"
+#include "../RG.h"
+#include "../util/rmalloc.h"
+
+#define SUBGRAPH_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+GrB_Info Subgraph(GrB_Matrix *S, GrB_Index **mapping, GrB_Matrix A,
+				  GrB_Matrix L) {
+	ASSERT(S != NULL);
+	ASSERT(A != NULL);
+	ASSERT(mapping != NULL);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Matrix R = A;         // A restricted to L
+	GrB_Matrix B = GrB_NULL;  // boolean graph
+	GrB_Index *map = NULL;    // rows of A retained
+
+	*S = GrB_NULL;
+	*mapping = NULL;
+	SUBGRAPH_TRY(GrB_Matrix_nrows(&n, A));
+
+	if(L != GrB_NULL) {
+		// extract the rows and columns of A set on L's diagonal
+		SUBGRAPH_TRY(GrB_Matrix_nvals(&n, L));
+		map = rm_malloc(sizeof(GrB_Index) * n);
+		SUBGRAPH_TRY(GrB_Matrix_extractTuples_BOOL(map, GrB_NULL, GrB_NULL, &n,
+												   L));
+		SUBGRAPH_TRY(GrB_Matrix_new(&R, GrB_BOOL, n, n));
+		SUBGRAPH_TRY(GrB_Matrix_extract(R, GrB_NULL, GrB_NULL, A, map, n, map,
+										n, GrB_NULL));
+	}
+
+	// B = one(R), entries of R might hold values cast to false
+	SUBGRAPH_TRY(GrB_Matrix_new(&B, GrB_BOOL, n, n));
+	SUBGRAPH_TRY(GrB_Matrix_apply(B, GrB_NULL, GrB_NULL, GxB_ONE_BOOL, R,
+								  GrB_NULL));
+
+	*S = B;
+	*mapping = map;
+	B = GrB_NULL;
+	map = NULL;
+
+cleanup:
+	if(R != A) GrB_free(&R);
+	if(B != GrB_NULL) GrB_free(&B);
+	if(map != NULL) rm_free(map);
+	return info;
+}
@@ -0,0 +1,22 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// builds the boolean matrix S holding true for every entry of A
+//
+// if L is specified, S is restricted to the rows and columns of A
+// set on L's diagonal, in which case 'mapping' maps every row of S
+// to a row of A, otherwise S's rows match A's and 'mapping' is set to NULL
+GrB_Info Subgraph
+(
+	GrB_Matrix *S,        // [output] boolean graph
+	GrB_Index **mapping,  // [output] mapping from rows of S to rows of A
+	GrB_Matrix A,         // graph, not modified
+	GrB_Matrix L          // optional diagonal matrix of rows to retain
+);
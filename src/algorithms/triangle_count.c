@@ -0,0 +1,87 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "triangle_count.h"
+#include "../RG.h"
+#include "../util/rmalloc.h"
+
+#define TC_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+GrB_Info TriangleCount(uint64_t **triangles, double **coefficients,
+					   uint64_t *total, GrB_Matrix S) {
+	ASSERT(S != NULL);
+	ASSERT(total != NULL);
+	ASSERT(triangles != NULL);
+	ASSERT(coefficients != NULL);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Index nvals;
+	GrB_Matrix C    =  GrB_NULL;  // common neighbors of adjacent nodes
+	GrB_Vector t    =  GrB_NULL;  // twice the triangles containing each node
+	GrB_Vector d    =  GrB_NULL;  // degree of each node
+	GrB_Index *I    =  NULL;      // extracted indices
+	uint64_t *X     =  NULL;      // extracted values
+	uint64_t *tri   =  NULL;      // triangles containing each node
+	double *coeff   =  NULL;      // local clustering coefficient of each node
+
+	*total = 0;
+	*triangles = NULL;
+	*coefficients = NULL;
+	TC_TRY(GrB_Matrix_nrows(&n, S));
+
+	// C<S> = S * S', computed by masked dot products
+	TC_TRY(GrB_Matrix_new(&C, GrB_UINT64, n, n));
+	TC_TRY(GrB_mxm(C, S, GrB_NULL, GxB_PLUS_PAIR_UINT64, S, S, GrB_DESC_ST1));
+
+	TC_TRY(GrB_Vector_new(&t, GrB_UINT64, n));
+	TC_TRY(GrB_Vector_new(&d, GrB_UINT64, n));
+	TC_TRY(GrB_Matrix_reduce_BinaryOp(t, GrB_NULL, GrB_NULL, GrB_PLUS_UINT64, C,
+									  GrB_NULL));
+	TC_TRY(GrB_Matrix_reduce_BinaryOp(d, GrB_NULL, GrB_NULL, GrB_PLUS_UINT64, S,
+									  GrB_NULL));
+	GrB_free(&C);
+
+	tri   = rm_calloc(n, sizeof(uint64_t));
+	coeff = rm_calloc(n, sizeof(double));
+	I     = rm_malloc(sizeof(GrB_Index) * n);
+	X     = rm_malloc(sizeof(uint64_t) * n);
+
+	// each triangle containing i was counted twice in row i
+	nvals = n;
+	TC_TRY(GrB_Vector_extractTuples_UINT64(I, X, &nvals, t));
+	uint64_t sum = 0;
+	for(GrB_Index k = 0; k < nvals; k++) {
+		tri[I[k]] = X[k] / 2;
+		sum += X[k] / 2;
+	}
+
+	// coefficient = triangles / (d * (d - 1) / 2)
+	nvals = n;
+	TC_TRY(GrB_Vector_extractTuples_UINT64(I, X, &nvals, d));
+	for(GrB_Index k = 0; k < nvals; k++) {
+		uint64_t degree = X[k];
+		if(degree < 2) continue;
+		coeff[I[k]] = (2.0 * tri[I[k]]) / ((double)degree * (degree - 1));
+	}
+
+	// every triangle is counted once by each of its nodes
+	*total = sum / 3;
+	*triangles = tri;
+	*coefficients = coeff;
+	tri = NULL;
+	coeff = NULL;
+
+cleanup:
+	GrB_free(&C);
+	GrB_free(&t);
+	GrB_free(&d);
+	if(I != NULL) rm_free(I);
+	if(X != NULL) rm_free(X);
+	if(tri != NULL) rm_free(tri);
+	if(coeff != NULL) rm_free(coeff);
+	return info;
+}
@@ -0,0 +1,27 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// counts the triangles of the undirected graph S, S must not hold self loops
+//
+// with C<S> = S * S' over the (plus, pair) semiring, C[i, j] is the number
+// of nodes adjacent to both i and j, each triangle containing i accounts
+// for two entries of row i
+//
+// on return triangles[i] holds the number of triangles containing node i
+// and coefficients[i] its local clustering coefficient: the fraction of
+// pairs of i's neighbors which are adjacent, 0 for nodes of degree < 2
+// both arrays hold one entry per row of S and are owned by the caller
+GrB_Info TriangleCount
+(
+	uint64_t **triangles,   // [output] number of triangles containing each node
+	double **coefficients,  // [output] local clustering coefficient of each node
+	uint64_t *total,        // [output] number of triangles in S
+	GrB_Matrix S            // symmetric input graph, not modified
+);
@@ -0,0 +1,43 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "undirected.h"
+#include "subgraph.h"
+#include "../RG.h"
+#include "../util/rmalloc.h"
+
+#define UNDIRECTED_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+GrB_Info Undirected(GrB_Matrix *S, GrB_Index **mapping, GrB_Matrix A,
+					GrB_Matrix L) {
+	ASSERT(S != NULL);
+	ASSERT(A != NULL);
+	ASSERT(mapping != NULL);
+
+	GrB_Info info;
+	GrB_Matrix U = GrB_NULL;  // undirected graph
+	GrB_Index *map = NULL;    // rows of A retained
+
+	*S = GrB_NULL;
+	*mapping = NULL;
+
+	// U = U | U', without self loops
+	UNDIRECTED_TRY(Subgraph(&U, &map, A, L));
+	UNDIRECTED_TRY(GrB_eWiseAdd(U, GrB_NULL, GrB_NULL, GrB_LOR, U, U,
+								GrB_DESC_T1));
+	UNDIRECTED_TRY(GxB_Matrix_select(U, GrB_NULL, GrB_NULL, GxB_OFFDIAG, U,
+									 GrB_NULL, GrB_NULL));
+
+	*S = U;
+	*mapping = map;
+	U = GrB_NULL;
+	map = NULL;
+
+cleanup:
+	if(U != GrB_NULL) GrB_free(&U);
+	if(map != NULL) rm_free(map);
+	return info;
+}
@@ -0,0 +1,23 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// builds the boolean, symmetric matrix S connecting i and j
+// for every entry A[i, j], self loops are discarded
+//
+// if L is specified, S is restricted to the rows and columns of A
+// set on L's diagonal, in which case 'mapping' maps every row of S
+// to a row of A, otherwise S's rows match A's and 'mapping' is set to NULL
+GrB_Info Undirected
+(
+	GrB_Matrix *S,        // [output] undirected graph
+	GrB_Index **mapping,  // [output] mapping from rows of S to rows of A
+	GrB_Matrix A,         // directed graph, not modified
+	GrB_Matrix L          // optional diagonal matrix of rows to retain
+);
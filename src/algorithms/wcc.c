@@ -0,0 +1,113 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "wcc.h"
+#include "../RG.h"
+#include "../config.h"
+#include "../util/rmalloc.h"
+
+#define WCC_TRY(x) { info = (x); if(info != GrB_SUCCESS) goto cleanup; }
+
+// lowers *p to v, safe against concurrent updates
+static inline void _AtomicMin(GrB_Index *p, GrB_Index v) {
+	GrB_Index cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+	while(v < cur) {
+		if(__atomic_compare_exchange_n(p, &cur, v, false, __ATOMIC_RELAXED,
+									   __ATOMIC_RELAXED)) break;
+	}
+}
+
+GrB_Info WCC(GrB_Index **components, GrB_Matrix S) {
+	ASSERT(S != NULL);
+	ASSERT(components != NULL);
+
+	GrB_Info info;
+	GrB_Index n;
+	GrB_Index nvals;
+	GrB_Index *f     =  NULL;      // parent of each node
+	GrB_Index *gp    =  NULL;      // grandparent of each node
+	GrB_Index *I     =  NULL;      // 0..n-1
+	GrB_Index *mI    =  NULL;      // nodes with neighbors
+	GrB_Index *mX    =  NULL;      // smallest grandparent among neighbors
+	GrB_Vector gp_v  =  GrB_NULL;  // grandparents
+	GrB_Vector mngp  =  GrB_NULL;  // smallest grandparent among neighbors
+
+	*components = NULL;
+	WCC_TRY(GrB_Matrix_nrows(&n, S));
+	if(n == 0) return GrB_SUCCESS;
+
+	int nthreads;
+	Config_Option_get(Config_OPENMP_NTHREAD, &nthreads);
+	if(nthreads < 1) nthreads = 1;
+
+	f  = rm_malloc(sizeof(GrB_Index) * n);
+	gp = rm_malloc(sizeof(GrB_Index) * n);
+	I  = rm_malloc(sizeof(GrB_Index) * n);
+	mI = rm_malloc(sizeof(GrB_Index) * n);
+	mX = rm_malloc(sizeof(GrB_Index) * n);
+
+	// every node starts as its own tree
+	for(GrB_Index i = 0; i < n; i++) {
+		f[i]  = i;
+		gp[i] = i;
+		I[i]  = i;
+	}
+
+	WCC_TRY(GrB_Vector_new(&gp_v, GrB_UINT64, n));
+	WCC_TRY(GrB_Vector_new(&mngp, GrB_UINT64, n));
+
+	bool changed = true;
+	while(changed) {
+		// mngp[i] = min(gp[j]) over i's neighbors j
+		WCC_TRY(GrB_Vector_clear(gp_v));
+		WCC_TRY(GrB_Vector_build_UINT64(gp_v, I, gp, n, GrB_FIRST_UINT64));
+		WCC_TRY(GrB_mxv(mngp, GrB_NULL, GrB_NULL, GrB_MIN_SECOND_SEMIRING_UINT64,
+						S, gp_v, GrB_DESC_R));
+		nvals = n;
+		WCC_TRY(GrB_Vector_extractTuples_UINT64(mI, mX, &nvals, mngp));
+
+		// stochastic hooking: f[f[i]] = min(f[f[i]], mngp[i])
+		// aggressive hooking: f[i] = min(f[i], mngp[i])
+		#pragma omp parallel for num_threads(nthreads) schedule(static)
+		for(GrB_Index k = 0; k < nvals; k++) {
+			GrB_Index i = mI[k];
+			GrB_Index parent = __atomic_load_n(f + i, __ATOMIC_RELAXED);
+			_AtomicMin(f + parent, mX[k]);
+			_AtomicMin(f + i, mX[k]);
+		}
+
+		// shortcutting: f[i] = min(f[i], gp[i])
+		#pragma omp parallel for num_threads(nthreads) schedule(static)
+		for(GrB_Index i = 0; i < n; i++) {
+			if(gp[i] < f[i]) f[i] = gp[i];
+		}
+
+		// recompute grandparents, done once they settle
+		changed = false;
+		#pragma omp parallel for num_threads(nthreads) schedule(static) reduction(||:changed)
+		for(GrB_Index i = 0; i < n; i++) {
+			GrB_Index g = f[f[i]];
+			if(g != gp[i]) {
+				gp[i] = g;
+				changed = true;
+			}
+		}
+	}
+
+	// every tree is a star rooted at its smallest node
+	*components = gp;
+	gp = NULL;
+
+cleanup:
+	if(f != NULL) rm_free(f);
+	if(gp != NULL) rm_free(gp);
+	if(I != NULL) rm_free(I);
+	if(mI != NULL) rm_free(mI);
+	if(mX != NULL) rm_free(mX);
+	GrB_free(&gp_v);
+	GrB_free(&mngp);
+	return info;
+}
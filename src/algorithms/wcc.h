@@ -0,0 +1,21 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// computes the connected components of the undirected graph S
+// using FastSV, hooking every tree onto the smallest grandparent
+// among its neighbors, until every node's grandparent settles
+//
+// on return components[i] holds the smallest node in i's component
+// the array holds one entry per row of S and is owned by the caller
+GrB_Info WCC
+(
+	GrB_Index **components,  // [output] component of each node
+	GrB_Matrix S             // symmetric input graph, not modified
+);
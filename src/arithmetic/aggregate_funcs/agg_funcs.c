@@ -5,6 +5,7 @@
 */
 
 #include "agg_funcs.h"
+#include "../../RG.h"
 #include "../../value.h"
 #include "../../errors.h"
 #include "../../util/arr.h"
@@ -12,6 +13,8 @@
 #include "../../util/qsort.h"
 #include "../../util/rmalloc.h"
 #include "../../datatypes/array.h"
+#include "../../util/sketch/hll.h"
+#include "../../util/sketch/tdigest.h"
 #include <math.h>
 #include <float.h>
 
@@ -66,6 +69,22 @@ AggregateResult AGG_SUM(SIValue *argv, int argc) {
 	return AGGREGATE_OK;
 }
 
+void SumMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(SI_TYPE(src->result) == T_NULL) return;
+	if(SI_TYPE(dst->result) == T_NULL) dst->result = SI_DoubleVal(0);
+	dst->result.doubleval += src->result.doubleval;
+}
+
+void SumScale(void *ctx_ptr, double scale) {
+	AggregateCtx *ctx = ctx_ptr;
+	if(SI_TYPE(ctx->result) == T_NULL) return;
+	ctx->result.doubleval *= scale;
+}
+
 //------------------------------------------------------------------------------
 // Avg
 //------------------------------------------------------------------------------
@@ -101,6 +120,25 @@ void AvgFinalize(void *ctx_ptr) {
 	else Aggregate_SetResult(ctx, SI_DoubleVal(0));
 }
 
+void AvgMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(src->private_ctx == NULL) return;
+	if(dst->private_ctx == NULL) {
+		// adopt source state
+		dst->private_ctx = src->private_ctx;
+		src->private_ctx = NULL;
+		return;
+	}
+
+	_agg_AvgCtx *dst_avg = dst->private_ctx;
+	_agg_AvgCtx *src_avg = src->private_ctx;
+	dst_avg->count += src_avg->count;
+	dst_avg->total += src_avg->total;
+}
+
 
 //------------------------------------------------------------------------------
 // Max
@@ -124,6 +162,21 @@ AggregateResult AGG_MAX(SIValue *argv, int argc) {
 	return AGGREGATE_OK;
 }
 
+void MaxMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(SI_TYPE(src->result) == T_NULL) return;
+
+	int compared_null;
+	if((SIValue_Compare(dst->result, src->result, &compared_null) < 0) ||
+	   (compared_null == COMPARED_NULL)) {
+		SIValue_Free(dst->result);
+		dst->result = SI_TransferOwnership(&src->result);
+	}
+}
+
 //------------------------------------------------------------------------------
 // Min
 //------------------------------------------------------------------------------
@@ -146,6 +199,21 @@ AggregateResult AGG_MIN(SIValue *argv, int argc) {
 	return AGGREGATE_OK;
 }
 
+void MinMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(SI_TYPE(src->result) == T_NULL) return;
+
+	int compared_null;
+	if((SIValue_Compare(dst->result, src->result, &compared_null) > 0) ||
+	   (compared_null == COMPARED_NULL)) {
+		SIValue_Free(dst->result);
+		dst->result = SI_TransferOwnership(&src->result);
+	}
+}
+
 //------------------------------------------------------------------------------
 // Count
 //------------------------------------------------------------------------------
@@ -167,6 +235,32 @@ AggregateResult AGG_COUNT(SIValue *argv, int argc) {
 	return AGGREGATE_OK;
 }
 
+void CountMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(SI_TYPE(src->result) == T_NULL) return;
+	if(SI_TYPE(dst->result) == T_NULL) dst->result = SI_LongVal(0);
+	dst->result.longval += src->result.longval;
+}
+
+// extrapolates a count of n sampled records at rate p = 1 / scale
+// reporting the count's relative 95% margin of error, 1.96 * sqrt((1 - p) / n)
+void CountScale(void *ctx_ptr, double scale) {
+	AggregateCtx *ctx = ctx_ptr;
+	if(SI_TYPE(ctx->result) == T_NULL) return;
+
+	int64_t n = ctx->result.longval;
+	ctx->result.longval = llround(n * scale);
+	if(n == 0) return;
+
+	ResultSet *set = QueryCtx_GetResultSet();
+	if(set == NULL) return;
+	double error = 1.96 * sqrt((1 - 1 / scale) / n);
+	if(error > set->stats.sample_error) set->stats.sample_error = error;
+}
+
 //------------------------------------------------------------------------------
 // Precentile
 //------------------------------------------------------------------------------
@@ -257,6 +351,27 @@ void PercContFinalize(void *ctx_ptr) {
 	}
 }
 
+void PercMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(src->private_ctx == NULL) return;
+	if(dst->private_ctx == NULL) {
+		// adopt source state
+		dst->private_ctx = src->private_ctx;
+		src->private_ctx = NULL;
+		return;
+	}
+
+	_agg_PercCtx *dst_perc = dst->private_ctx;
+	_agg_PercCtx *src_perc = src->private_ctx;
+	uint count = array_len(src_perc->values);
+	for(uint i = 0; i < count; i++) {
+		dst_perc->values = array_append(dst_perc->values, src_perc->values[i]);
+	}
+}
+
 void Percentile_Free(void *ctx_ptr) {
 	AggregateCtx *ctx = ctx_ptr;
 	SIValue_Free(ctx->result);
@@ -332,6 +447,28 @@ void StDevPFinalize(void *ctx_ptr) {
 	StDevGenericFinalize(ctx_ptr, 0);
 }
 
+void StDevMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(src->private_ctx == NULL) return;
+	if(dst->private_ctx == NULL) {
+		// adopt source state
+		dst->private_ctx = src->private_ctx;
+		src->private_ctx = NULL;
+		return;
+	}
+
+	_agg_StDevCtx *dst_stdev = dst->private_ctx;
+	_agg_StDevCtx *src_stdev = src->private_ctx;
+	uint count = array_len(src_stdev->values);
+	for(uint i = 0; i < count; i++) {
+		dst_stdev->values = array_append(dst_stdev->values, src_stdev->values[i]);
+	}
+	dst_stdev->total += src_stdev->total;
+}
+
 void StDev_Free(void *ctx_ptr) {
 	AggregateCtx *ctx = ctx_ptr;
 	SIValue_Free(ctx->result);
@@ -366,6 +503,149 @@ AggregateResult AGG_COLLECT(SIValue *argv, int argc) {
 	return AGGREGATE_OK;
 }
 
+void CollectMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(SI_TYPE(src->result) == T_NULL) return;
+	if(SI_TYPE(dst->result) == T_NULL) {
+		dst->result = SI_TransferOwnership(&src->result);
+		return;
+	}
+
+	uint count = SIArray_Length(src->result);
+	for(uint i = 0; i < count; i++) {
+		SIArray_Append(&dst->result, SIArray_Get(src->result, i));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Approximate count distinct
+//------------------------------------------------------------------------------
+
+AggregateResult AGG_APPROX_COUNT_DISTINCT(SIValue *argv, int argc) {
+	AggregateCtx *ctx = argv[1].ptrval;
+	// On the first invocation, initialize the context.
+	if(ctx->private_ctx == NULL) ctx->private_ctx = HLL_New();
+
+	SIValue v = argv[0];
+	if(SI_TYPE(v) == T_NULL) return AGGREGATE_OK;
+
+	HLL_Add(ctx->private_ctx, SIValue_HashCode(v));
+
+	return AGGREGATE_OK;
+}
+
+void ApproxCountDistinctFinalize(void *ctx_ptr) {
+	AggregateCtx *ctx = ctx_ptr;
+	uint64_t count = (ctx->private_ctx) ? HLL_Count(ctx->private_ctx) : 0;
+	Aggregate_SetResult(ctx, SI_LongVal(count));
+}
+
+void ApproxCountDistinctMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+
+	if(src->private_ctx == NULL) return;
+	if(dst->private_ctx == NULL) {
+		// adopt source state
+		dst->private_ctx = src->private_ctx;
+		src->private_ctx = NULL;
+		return;
+	}
+
+	HLL_Merge(dst->private_ctx, src->private_ctx);
+}
+
+void ApproxCountDistinct_Free(void *ctx_ptr) {
+	AggregateCtx *ctx = ctx_ptr;
+	SIValue_Free(ctx->result);
+	if(ctx->hashSet) Set_Free(ctx->hashSet);
+	HLL_Free(ctx->private_ctx);
+	rm_free(ctx);
+}
+
+//------------------------------------------------------------------------------
+// Approximate percentile
+//------------------------------------------------------------------------------
+
+typedef struct {
+	double percentile;
+	TDigest *digest;
+} _agg_ApproxPercCtx;
+
+AggregateResult AGG_APPROX_PERC(SIValue *argv, int argc) {
+	AggregateCtx *ctx = argv[2].ptrval;
+	_agg_ApproxPercCtx *perc_ctx = ctx->private_ctx;
+
+	// On the first invocation, initialize the context.
+	if(perc_ctx == NULL) {
+		ctx->private_ctx = rm_malloc(sizeof(_agg_ApproxPercCtx));
+		perc_ctx = ctx->private_ctx;
+		// The second argument is the requested percentile, which we only
+		// need to apply on the first function invocation.
+		SIValue_ToDouble(&argv[1], &perc_ctx->percentile);
+		perc_ctx->digest = TDigest_New();
+		if(perc_ctx->percentile < 0 || perc_ctx->percentile > 1) {
+			ErrorCtx_SetError("Invalid input - '%f' is not a valid argument, must be a number in the range 0.0 to 1.0",
+							  perc_ctx->percentile);
+		}
+	}
+
+	SIValue v = argv[0];
+	if(SI_TYPE(v) == T_NULL) return AGGREGATE_OK;
+
+	// If we're uniquing inputs, return early if this value has already been seen.
+	if(ctx->hashSet && Set_Add(ctx->hashSet, v) == false) return AGGREGATE_OK;
+
+	TDigest_Add(perc_ctx->digest, SI_GET_NUMERIC(v));
+
+	return AGGREGATE_OK;
+}
+
+void ApproxPercFinalize(void *ctx_ptr) {
+	AggregateCtx *ctx = ctx_ptr;
+	_agg_ApproxPercCtx *perc_ctx = ctx->private_ctx;
+	if(perc_ctx == NULL || TDigest_Count(perc_ctx->digest) == 0) {
+		Aggregate_SetResult(ctx, SI_NullVal());
+		return;
+	}
+
+	double q = TDigest_Quantile(perc_ctx->digest, perc_ctx->percentile);
+	Aggregate_SetResult(ctx, SI_DoubleVal(q));
+}
+
+void ApproxPercMerge(void *dst_ptr, void *src_ptr) {
+	AggregateCtx *dst = dst_ptr;
+	AggregateCtx *src = src_ptr;
+	ASSERT(dst->hashSet == NULL && src->hashSet == NULL);
+
+	if(src->private_ctx == NULL) return;
+	if(dst->private_ctx == NULL) {
+		// adopt source state
+		dst->private_ctx = src->private_ctx;
+		src->private_ctx = NULL;
+		return;
+	}
+
+	_agg_ApproxPercCtx *dst_perc = dst->private_ctx;
+	_agg_ApproxPercCtx *src_perc = src->private_ctx;
+	TDigest_Merge(dst_perc->digest, src_perc->digest);
+}
+
+void ApproxPercentile_Free(void *ctx_ptr) {
+	AggregateCtx *ctx = ctx_ptr;
+	SIValue_Free(ctx->result);
+	if(ctx->hashSet) Set_Free(ctx->hashSet);
+	if(ctx->private_ctx) {
+		_agg_ApproxPercCtx *perc_ctx = ctx->private_ctx;
+		TDigest_Free(perc_ctx->digest);
+		rm_free(ctx->private_ctx);
+	}
+	rm_free(ctx);
+}
+
 //------------------------------------------------------------------------------
 // Function registration
 //------------------------------------------------------------------------------
@@ -384,6 +664,8 @@ void Register_AggFuncs() {
 	types = array_append(types, T_PTR);
 	func_desc = AR_FuncDescNew("sum", AGG_SUM, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Aggregate_Free, Aggregate_Clone);
+	AR_SetMergeRoutine(func_desc, SumMerge);
+	AR_SetScaleRoutine(func_desc, SumScale);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -396,6 +678,7 @@ void Register_AggFuncs() {
 	func_desc = AR_FuncDescNew("avg", AGG_AVG, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Aggregate_Free, Aggregate_Clone);
 	AR_SetFinalizeRoutine(func_desc, AvgFinalize);
+	AR_SetMergeRoutine(func_desc, AvgMerge);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -407,6 +690,7 @@ void Register_AggFuncs() {
 	types = array_append(types, T_PTR);
 	func_desc = AR_FuncDescNew("max", AGG_MAX, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Aggregate_Free, Aggregate_Clone);
+	AR_SetMergeRoutine(func_desc, MaxMerge);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -418,6 +702,7 @@ void Register_AggFuncs() {
 	types = array_append(types, T_PTR);
 	func_desc = AR_FuncDescNew("min", AGG_MIN, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Aggregate_Free, Aggregate_Clone);
+	AR_SetMergeRoutine(func_desc, MinMerge);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -429,6 +714,8 @@ void Register_AggFuncs() {
 	types = array_append(types, T_PTR);
 	func_desc = AR_FuncDescNew("count", AGG_COUNT, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Aggregate_Free, Aggregate_Clone);
+	AR_SetMergeRoutine(func_desc, CountMerge);
+	AR_SetScaleRoutine(func_desc, CountScale);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -442,6 +729,7 @@ void Register_AggFuncs() {
 	func_desc = AR_FuncDescNew("percentileDisc", AGG_PERC, 3, 3, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Percentile_Free, Aggregate_Clone);
 	AR_SetFinalizeRoutine(func_desc, PercDiscFinalize);
+	AR_SetMergeRoutine(func_desc, PercMerge);
 	AR_RegFunc(func_desc);
 
 	types = array_new(SIType, 3);
@@ -451,6 +739,7 @@ void Register_AggFuncs() {
 	func_desc = AR_FuncDescNew("percentileCont", AGG_PERC, 3, 3, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Percentile_Free, Aggregate_Clone);
 	AR_SetFinalizeRoutine(func_desc, PercContFinalize);
+	AR_SetMergeRoutine(func_desc, PercMerge);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -463,6 +752,7 @@ void Register_AggFuncs() {
 	func_desc = AR_FuncDescNew("stDev", AGG_STDEV, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, StDev_Free, Aggregate_Clone);
 	AR_SetFinalizeRoutine(func_desc, StDevFinalize);
+	AR_SetMergeRoutine(func_desc, StDevMerge);
 	AR_RegFunc(func_desc);
 
 	types = array_new(SIType, 2);
@@ -471,6 +761,7 @@ void Register_AggFuncs() {
 	func_desc = AR_FuncDescNew("stDevP", AGG_STDEV, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, StDev_Free, Aggregate_Clone);
 	AR_SetFinalizeRoutine(func_desc, StDevPFinalize);
+	AR_SetMergeRoutine(func_desc, StDevMerge);
 	AR_RegFunc(func_desc);
 
 	//--------------------------------------------------------------------------
@@ -482,6 +773,36 @@ void Register_AggFuncs() {
 	types = array_append(types, T_PTR);
 	func_desc = AR_FuncDescNew("collect", AGG_COLLECT, 2, 2, types, false, true);
 	AR_SetPrivateDataRoutines(func_desc, Aggregate_Free, Aggregate_Clone);
+	AR_SetMergeRoutine(func_desc, CollectMerge);
+	AR_RegFunc(func_desc);
+
+	//--------------------------------------------------------------------------
+	// Approximate count distinct
+	//--------------------------------------------------------------------------
+
+	types = array_new(SIType, 2);
+	types = array_append(types, SI_ALL);
+	types = array_append(types, T_PTR);
+	func_desc = AR_FuncDescNew("approxCountDistinct", AGG_APPROX_COUNT_DISTINCT, 2,
+							   2, types, false, true);
+	AR_SetPrivateDataRoutines(func_desc, ApproxCountDistinct_Free, Aggregate_Clone);
+	AR_SetFinalizeRoutine(func_desc, ApproxCountDistinctFinalize);
+	AR_SetMergeRoutine(func_desc, ApproxCountDistinctMerge);
+	AR_RegFunc(func_desc);
+
+	//--------------------------------------------------------------------------
+	// Approximate percentile
+	//--------------------------------------------------------------------------
+
+	types = array_new(SIType, 3);
+	types = array_append(types, T_NULL | T_INT64 | T_DOUBLE);
+	types = array_append(types, T_NULL | T_INT64 | T_DOUBLE);
+	types = array_append(types, T_PTR);
+	func_desc = AR_FuncDescNew("approxPercentile", AGG_APPROX_PERC, 3, 3, types, false,
+							   true);
+	AR_SetPrivateDataRoutines(func_desc, ApproxPercentile_Free, Aggregate_Clone);
+	AR_SetFinalizeRoutine(func_desc, ApproxPercFinalize);
+	AR_SetMergeRoutine(func_desc, ApproxPercMerge);
 	AR_RegFunc(func_desc);
 }
 
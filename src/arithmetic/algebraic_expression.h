@@ -217,6 +217,15 @@ void AlgebraicExpression_Eval
 	GrB_Matrix res                  // Result output.
 );
 
+// Evaluate expression tree, computing only the entries present in mask.
+// mask is applied structurally, entries outside of it are absent from res.
+void AlgebraicExpression_EvalMasked
+(
+	const AlgebraicExpression *exp, // Root node.
+	GrB_Matrix mask,                // Structural mask, may be NULL.
+	GrB_Matrix res                  // Result output.
+);
+
 // Locates operand based on row,column domain and edge
 // sets 'operand' to if found otherwise set it to NULL
 // sets 'parent' if requested, parent can still be set to NULL
@@ -261,6 +270,15 @@ char *AlgebraicExpression_ToString
 	const AlgebraicExpression *exp  // Root node.
 );
 
+// Return a canonical string representation of expression, identifying
+// operands by their label or relationship type rather than their aliases,
+// such that expressions evaluating the same product share a representation.
+// Returns NULL if the expression can't be represented.
+char *AlgebraicExpression_CanonicalString
+(
+	const AlgebraicExpression *exp  // Root node.
+);
+
 //------------------------------------------------------------------------------
 // AlgebraicExpression optimizations
 //------------------------------------------------------------------------------
@@ -276,3 +276,75 @@ char *AlgebraicExpression_ToString
 	return buff;
 }
 
+
+// appends exp's canonical form to buff, returns false if buff is exhausted
+static bool _AlgebraicExpression_CanonicalString
+(
+	const AlgebraicExpression *exp, // Root node.
+	char *buff,
+	size_t cap
+) {
+	ASSERT(exp);
+	uint child_count;
+	size_t len = strlen(buff);
+	const char *sep = NULL;
+
+	switch(exp->type) {
+	case AL_OPERATION:
+		switch(exp->operation.op) {
+		case AL_EXP_ADD:
+			sep = "+";
+			break;
+		case AL_EXP_MUL:
+			sep = "*";
+			break;
+		case AL_EXP_TRANSPOSE:
+			sep = "";
+			break;
+		default:
+			// powers describe variable length traversals
+			return false;
+		}
+		child_count = AlgebraicExpression_ChildCount(exp);
+		len += snprintf(buff + len, cap - len, "%s(",
+						(exp->operation.op == AL_EXP_TRANSPOSE) ? "T" : "");
+		if(len >= cap) return false;
+		for(uint i = 0; i < child_count; i++) {
+			if(i > 0) {
+				len += snprintf(buff + len, cap - len, "%s", sep);
+				if(len >= cap) return false;
+			}
+			if(!_AlgebraicExpression_CanonicalString(CHILD_AT(exp, i), buff, cap)) return false;
+			len = strlen(buff);
+		}
+		len += snprintf(buff + len, cap - len, ")");
+		break;
+	case AL_OPERAND:
+		// operands are identified by their matrix rather than their aliases
+		if(exp->operand.diagonal) {
+			len += snprintf(buff + len, cap - len, "(:%s)", exp->operand.label);
+		} else if(exp->operand.label) {
+			len += snprintf(buff + len, cap - len, "[:%s]", exp->operand.label);
+		} else {
+			len += snprintf(buff + len, cap - len, "[]");
+		}
+		break;
+	default:
+		ASSERT("Unknown algebraic expression node type" && false);
+		return false;
+	}
+
+	return len < cap;
+}
+
+char *AlgebraicExpression_CanonicalString
+(
+	const AlgebraicExpression *exp  // Root node.
+) {
+	char *buff = rm_calloc(1024, sizeof(char));
+	if(!_AlgebraicExpression_CanonicalString(exp, buff, 1024)) {
+		rm_free(buff);
+		return NULL;
+	}
+	return buff;
+}
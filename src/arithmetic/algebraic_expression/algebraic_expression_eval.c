@@ -127,19 +127,155 @@ static GrB_Matrix _Eval_Add(const AlgebraicExpression *exp, GrB_Matrix res) {
 	return res;
 }
 
-static GrB_Matrix _Eval_Mul(const AlgebraicExpression *exp, GrB_Matrix res) {
+// a multiplication operand, possibly transposed
+typedef struct {
+	GrB_Matrix m;
+	bool transpose;
+} _MulOperand;
+
+// select a descriptor transposing the operands of a multiplication
+// masked multiplications replace their output under a structural mask
+static inline GrB_Descriptor _MulDesc(bool transpose_a, bool transpose_b,
+		bool masked) {
+	if(masked) {
+		if(transpose_a && transpose_b) return GrB_DESC_RST0T1;
+		if(transpose_a) return GrB_DESC_RST0;
+		if(transpose_b) return GrB_DESC_RST1;
+		return GrB_DESC_RS;
+	}
+	if(transpose_a && transpose_b) return GrB_DESC_T0T1;
+	if(transpose_a) return GrB_DESC_T0;
+	if(transpose_b) return GrB_DESC_T1;
+	return GrB_NULL;
+}
+
+// computes the product of operands i..j into res, multiplying sub chains
+// in the order specified by split, see _AlgebraicExpression_MulChainOrder
+// if mask isn't NULL only entries present in mask are computed
+// returns false once the product is known to be empty, res is then empty
+static bool _Eval_MulChain(const _MulOperand *operands, const uint *split,
+		uint n, uint i, uint j, GrB_Matrix mask, GrB_Matrix res) {
+	GrB_Info info;
+	UNUSED(info);
+	GrB_Index nvals;
+	GrB_Matrix inter = GrB_NULL;
+	uint k = split[i * n + j];
+
+	GrB_Matrix A = operands[i].m;
+	bool transpose_a = operands[i].transpose;
+	if(k > i) {
+		if(!_Eval_MulChain(operands, split, n, i, k, GrB_NULL, res)) return false;
+		A = res;
+		transpose_a = false;
+	}
+
+	GrB_Matrix B = operands[j].m;
+	bool transpose_b = operands[j].transpose;
+	if(k + 1 < j) {
+		// operands past the first are square, sized as res's columns
+		GrB_Index dim;
+		GrB_Matrix_ncols(&dim, res);
+		info = GrB_Matrix_new(&inter, GrB_BOOL, dim, dim);
+		ASSERT(info == GrB_SUCCESS);
+		if(!_Eval_MulChain(operands, split, n, k + 1, j, GrB_NULL, inter)) {
+			GrB_Matrix_free(&inter);
+			GrB_Matrix_clear(res);
+			return false;
+		}
+		B = inter;
+		transpose_b = false;
+	}
+
+	info = GrB_mxm(res, mask, GrB_NULL, GxB_ANY_PAIR_BOOL, A, B,
+			_MulDesc(transpose_a, transpose_b, mask != GrB_NULL));
+	ASSERT(info == GrB_SUCCESS);
+	if(inter != GrB_NULL) GrB_Matrix_free(&inter);
+
+	GrB_Matrix_nvals(&nvals, res);
+	return nvals > 0;
+}
+
+// evaluates a multiplication of three or more operands in the order which
+// minimizes its estimated work, e.g. multiplying a selective label matrix
+// at the right end of the chain ahead of the traversal's frontier
+// returns false if the chain doesn't qualify for reordering:
+// operands past the first must be square matrices sized as res's columns
+static bool _Eval_MulReordered(const AlgebraicExpression *exp, GrB_Matrix mask,
+		GrB_Matrix res) {
+	uint n = AlgebraicExpression_ChildCount(exp);
+	if(n < 3) return false;
+
+	GrB_Index dim;
+	GrB_Matrix_ncols(&dim, res);
+
+	_MulOperand operands[n];
+	double rows[n];
+	double cols[n];
+	double nvals[n];
+	for(uint i = 0; i < n; i++) {
+		AlgebraicExpression *child = CHILD_AT(exp, i);
+		bool transpose = false;
+		if(child->type == AL_OPERATION) {
+			ASSERT(child->operation.op == AL_EXP_TRANSPOSE);
+			child = CHILD_AT(child, 0);
+			transpose = true;
+		}
+		GrB_Matrix m = child->operand.matrix;
+		if(m == IDENTITY_MATRIX) return false;
+
+		GrB_Index r;
+		GrB_Index c;
+		GrB_Index v;
+		GrB_Matrix_nrows(&r, m);
+		GrB_Matrix_ncols(&c, m);
+		GrB_Matrix_nvals(&v, m);
+		if(transpose) {
+			GrB_Index t = r;
+			r = c;
+			c = t;
+		}
+		if(c != dim || (i > 0 && r != dim)) return false;
+
+		operands[i] = (_MulOperand) {.m = m, .transpose = transpose};
+		rows[i] = r;
+		cols[i] = c;
+		nvals[i] = v;
+	}
+
+	uint split[n * n];
+	_AlgebraicExpression_MulChainOrder(n, rows, cols, nvals, split);
+	_Eval_MulChain(operands, split, n, 0, n - 1, mask, res);
+	return true;
+}
+
+// evaluates a multiplication, if mask isn't NULL it is applied as
+// a structural mask to the last product, such that entries outside of mask
+// are never computed
+static GrB_Matrix _Eval_Mul(const AlgebraicExpression *exp, GrB_Matrix mask,
+		GrB_Matrix res) {
 	ASSERT(exp &&
 		   AlgebraicExpression_ChildCount(exp) > 1 &&
 		   AlgebraicExpression_OperationCount(exp, AL_EXP_MUL) == 1);
 
+	if(_Eval_MulReordered(exp, mask, res)) return res;
+
 	GrB_Info info;
 	UNUSED(info);
 	GrB_Matrix A;
 	GrB_Matrix B;
 	GrB_Index nvals;
 	GrB_Descriptor desc = GrB_NULL;
+	GrB_Matrix last_mask = GrB_NULL;
 	AlgebraicExpression *left = CHILD_AT(exp, 0);
 	AlgebraicExpression *right = CHILD_AT(exp, 1);
+	uint child_count = AlgebraicExpression_ChildCount(exp);
+
+	if(mask != GrB_NULL) {
+		// replacing the output is a no-op for the unmasked products
+		GrB_Descriptor_new(&desc);
+		GrB_Descriptor_set(desc, GrB_MASK, GrB_STRUCTURE);
+		GrB_Descriptor_set(desc, GrB_OUTP, GrB_REPLACE);
+	}
 
 	if(left->type == AL_OPERATION) {
 		ASSERT(left->operation.op == AL_EXP_TRANSPOSE);
@@ -163,11 +299,13 @@ static GrB_Matrix _Eval_Mul(const AlgebraicExpression *exp, GrB_Matrix res) {
 		// Reset descriptor, as the identity matrix does not need to be transposed.
 		if(desc != GrB_NULL) GrB_Descriptor_set(desc, GrB_INP1, GxB_DEFAULT);
 		// B is the identity matrix, Perform A * I.
-		info = GrB_Matrix_apply(res, GrB_NULL, GrB_NULL, GrB_IDENTITY_BOOL, A, desc);
+		if(child_count == 2) last_mask = mask;
+		info = GrB_Matrix_apply(res, last_mask, GrB_NULL, GrB_IDENTITY_BOOL, A, desc);
 		ASSERT(info == GrB_SUCCESS);
 	} else {
 		// Perform multiplication.
-		info = GrB_mxm(res, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, A, B, desc);
+		if(child_count == 2) last_mask = mask;
+		info = GrB_mxm(res, last_mask, GrB_NULL, GxB_ANY_PAIR_BOOL, A, B, desc);
 		ASSERT(info == GrB_SUCCESS);
 	}
 
@@ -176,7 +314,6 @@ static GrB_Matrix _Eval_Mul(const AlgebraicExpression *exp, GrB_Matrix res) {
 	// Reset descriptor if non-null.
 	if(desc != GrB_NULL) GrB_Descriptor_set(desc, GrB_INP0, GxB_DEFAULT);
 
-	uint child_count = AlgebraicExpression_ChildCount(exp);
 	for(uint i = 2; i < child_count; i++) {
 		// Reset descriptor if non-null.
 		if(desc != GrB_NULL) GrB_Descriptor_set(desc, GrB_INP1, GxB_DEFAULT);
@@ -195,13 +332,21 @@ static GrB_Matrix _Eval_Mul(const AlgebraicExpression *exp, GrB_Matrix res) {
 			// Reset descriptor, as the identity matrix does not need to be transposed.
 			if(desc != GrB_NULL) GrB_Descriptor_set(desc, GrB_INP1, GxB_DEFAULT);
 			// Perform multiplication.
-			info = GrB_mxm(res, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, res, B, desc);
+			if(i == child_count - 1) last_mask = mask;
+			info = GrB_mxm(res, last_mask, GrB_NULL, GxB_ANY_PAIR_BOOL, res, B, desc);
 			ASSERT(info == GrB_SUCCESS);
 		}
 		GrB_Matrix_nvals(&nvals, res);
 		if(nvals == 0) break;
 	}
 
+	if(mask != GrB_NULL && last_mask == GrB_NULL) {
+		// the last product wasn't computed, e.g. a trailing identity operand
+		info = GrB_Matrix_apply(res, mask, GrB_NULL, GrB_IDENTITY_BOOL, res,
+				GrB_DESC_RS);
+		ASSERT(info == GrB_SUCCESS);
+	}
+
 	if(desc != GrB_NULL) GrB_free(&desc);
 
 	return res;
@@ -215,7 +360,7 @@ GrB_Matrix _AlgebraicExpression_Eval(const AlgebraicExpression *exp, GrB_Matrix
 	case AL_OPERATION:
 		switch(exp->operation.op) {
 		case AL_EXP_MUL:
-			res = _Eval_Mul(exp, res);
+			res = _Eval_Mul(exp, GrB_NULL, res);
 			break;
 
 		case AL_EXP_ADD:
@@ -245,3 +390,25 @@ void AlgebraicExpression_Eval(const AlgebraicExpression *exp, GrB_Matrix res) {
 	_AlgebraicExpression_Eval(exp, res);
 }
 
+void AlgebraicExpression_EvalMasked(const AlgebraicExpression *exp,
+		GrB_Matrix mask, GrB_Matrix res) {
+	ASSERT(exp && exp->type == AL_OPERATION);
+
+	if(mask == GrB_NULL) {
+		_AlgebraicExpression_Eval(exp, res);
+		return;
+	}
+
+	if(exp->operation.op == AL_EXP_MUL) {
+		_Eval_Mul(exp, mask, res);
+		return;
+	}
+
+	// mask the result of additions and transpositions once computed
+	_AlgebraicExpression_Eval(exp, res);
+	GrB_Info info = GrB_Matrix_apply(res, mask, GrB_NULL, GrB_IDENTITY_BOOL, res,
+			GrB_DESC_RS);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+}
+
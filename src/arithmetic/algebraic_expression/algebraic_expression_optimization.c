@@ -520,6 +520,59 @@ static void _AlgebraicExpression_ApplyTranspose(AlgebraicExpression *root) {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Multiplication chain ordering
+//------------------------------------------------------------------------------
+
+// Estimates the work of multiplying an r x k matrix holding 'a' entries
+// by a k x c matrix holding 'b' entries, assuming entries are spread uniformly:
+// each of the 'a' entries meets b / k entries of the matching row.
+static inline double _MulWork(double a, double b, double k) {
+	return (k > 0) ? a * b / k : 0;
+}
+
+void _AlgebraicExpression_MulChainOrder
+(
+	uint n,
+	const double *rows,
+	const double *cols,
+	const double *nvals,
+	uint *split
+) {
+	ASSERT(n > 0 && rows && cols && nvals && split);
+
+	// cost[i][j]: least estimated work to compute the product of operands i..j
+	// entries[i][j]: estimated number of entries of that product
+	double cost[n][n];
+	double entries[n][n];
+
+	for(uint i = 0; i < n; i++) {
+		cost[i][i] = 0;
+		entries[i][i] = nvals[i];
+		split[i * n + i] = i;
+	}
+
+	for(uint len = 2; len <= n; len++) {
+		for(uint i = 0; i + len - 1 < n; i++) {
+			uint j = i + len - 1;
+			cost[i][j] = -1;
+			// splitting past the last but one operand multiplies left to right
+			for(uint k = j; k-- > i;) {
+				double work = _MulWork(entries[i][k], entries[k + 1][j], cols[k]);
+				double c = cost[i][k] + cost[k + 1][j] + work;
+				// ties favour the left to right order
+				if(cost[i][j] < 0 || c < cost[i][j]) {
+					cost[i][j] = c;
+					split[i * n + j] = k;
+					// the product can't hold more entries than it has cells
+					double cells = rows[i] * cols[j];
+					entries[i][j] = (work < cells) ? work : cells;
+				}
+			}
+		}
+	}
+}
+
 //------------------------------------------------------------------------------
 // AlgebraicExpression optimizations
 //------------------------------------------------------------------------------
@@ -537,6 +590,8 @@ void AlgebraicExpression_Optimize
 	_AlgebraicExpression_PopulateOperands(*exp, QueryCtx_GetGraphCtx());
 
 	// If we are maintaining transposed matrices, all transpose operations have already been replaced.
+	// Otherwise transposed relations were fetched from the graph's transpose cache,
+	// only operands set ahead of time remain to be transposed.
 	bool maintain_transpose;
 	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
 	if(maintain_transpose == false) {
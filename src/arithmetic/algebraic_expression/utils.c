@@ -280,7 +280,7 @@ static void _AlgebraicExpression_PopulateTransposedOperand(AlgebraicExpression *
 	} else {
 		Schema *s = GraphContext_GetSchema(gc, operand->operand.label, SCHEMA_EDGE);
 		if(!s) m = Graph_GetZeroMatrix(gc->g);
-		else m = Graph_GetTransposedRelationMatrix(gc->g, s->id);
+		else m = Graph_GetCachedTransposedRelationMatrix(gc->g, s->id);
 	}
 	operand->operand.matrix = m;
 }
@@ -292,10 +292,17 @@ void _AlgebraicExpression_PopulateOperands(AlgebraicExpression *root, const Grap
 	switch(root->type) {
 	case AL_OPERATION:
 		child_count = AlgebraicExpression_ChildCount(root);
-		// If we are maintaining transposed matrices, it can be retrieved now.
+		// Transposed matrices are either maintained or cached by the graph,
+		// unfetched operands can be replaced by their transpose now.
 		bool maintain_transpose = false;
 		Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
-		if(root->operation.op == AL_EXP_TRANSPOSE && maintain_transpose) {
+		bool fetch_transpose = maintain_transpose;
+		if(root->operation.op == AL_EXP_TRANSPOSE && !maintain_transpose) {
+			AlgebraicExpression *child = CHILD_AT(root, 0);
+			fetch_transpose = (child->type == AL_OPERAND &&
+							   child->operand.matrix == GrB_NULL);
+		}
+		if(root->operation.op == AL_EXP_TRANSPOSE && fetch_transpose) {
 			ASSERT(child_count == 1 && "Transpose operation had invalid number of children");
 			AlgebraicExpression *child = _AlgebraicExpression_OperationRemoveDest(root);
 			// Fetch the transposed matrix and update the operand.
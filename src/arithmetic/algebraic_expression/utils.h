@@ -110,6 +110,19 @@ AlgebraicExpression *_AlgebraicExpression_GetOperand
 	uint operand_idx                    // Operand position (LTR, zero based).
 );
 
+// Computes the order of multiplying a chain of n operands which minimizes
+// the estimated work, given the dimensions and number of entries of each operand.
+// Operands i..j (i < j) are to be multiplied as the product of i..k by the
+// product of k+1..j, where k = split[i * n + j].
+void _AlgebraicExpression_MulChainOrder
+(
+	uint n,                // Number of operands.
+	const double *rows,    // Number of rows of each operand.
+	const double *cols,    // Number of columns of each operand.
+	const double *nvals,   // Number of entries of each operand.
+	uint *split            // [output] n x n split table.
+);
+
 // Resolves all missing operands, replacing transpose operations with
 // transposed operands if they are available.
 void _AlgebraicExpression_PopulateOperands
@@ -28,6 +28,10 @@
 // return number of child nodes of 'n'
 #define NODE_CHILD_COUNT(n) (n)->op.child_count
 
+// max number of values a constant range() call is reduced into
+// larger ranges are generated on demand by their consumers, e.g. UNWIND
+#define RANGE_REDUCE_MAX_LEN 4096
+
 // return child at position 'idx' of 'n'
 #define NODE_CHILD(n, idx) (n)->op.children[(idx)]
 
@@ -108,6 +112,8 @@ static AR_ExpNode *_AR_EXP_CloneOperand(AR_ExpNode *exp) {
 		clone->operand.type = exp->operand.type;
 		clone->operand.variadic.entity_alias = exp->operand.variadic.entity_alias;
 		clone->operand.variadic.entity_alias_idx = exp->operand.variadic.entity_alias_idx;
+		// the clone's records may follow a different mapping, resolve again
+		clone->operand.variadic.entity_alias_mapping = NULL;
 		break;
 	case AR_EXP_PARAM:
 		clone->operand.type = AR_EXP_PARAM;
@@ -144,6 +150,9 @@ static AR_ExpNode *_AR_EXP_CloneOp(AR_ExpNode *exp) {
 		AR_ExpNode *child = AR_EXP_Clone(exp->op.children[i]);
 		clone->op.children[i] = child;
 	}
+	// the clone shares the compiled shape of the original
+	clone->op.eval = exp->op.eval;
+	clone->op.static_args = exp->op.static_args;
 	return clone;
 }
 
@@ -221,6 +230,26 @@ AR_ExpNode *AR_EXP_NewRecordNode() {
  * e.g. MINUS(X) where X is a constant number will be reduced to
  * a single node with the value -X
  * PLUS(MINUS(A), B) will be reduced to a single constant: B-A. */
+// returns true if 'root' is a range() call over constant arguments
+// which would produce more than RANGE_REDUCE_MAX_LEN values
+static bool _AR_EXP_LargeRange(const AR_ExpNode *root) {
+	if(strcasecmp(root->op.func_name, "range") != 0) return false;
+
+	int64_t args[3] = {0, 0, 1};
+	for(int i = 0; i < root->op.child_count && i < 3; i++) {
+		const AR_ExpNode *child = root->op.children[i];
+		if(!AR_EXP_IsConstant(child)) return false;
+		// invalid arguments are reported by the reduction
+		if(SI_TYPE(child->operand.constant) != T_INT64) return false;
+		args[i] = child->operand.constant.longval;
+	}
+
+	if(args[2] < 1 || args[0] > args[1]) return false;
+	// compare distances, the range length might overflow
+	return (((uint64_t)args[1] - (uint64_t)args[0]) / (uint64_t)args[2] >=
+			RANGE_REDUCE_MAX_LEN);
+}
+
 bool AR_EXP_ReduceToScalar(AR_ExpNode *root, bool reduce_params, SIValue *val) {
 	if(val != NULL) *val = SI_NullVal();
 	if(root->type == AR_EXP_OPERAND) {
@@ -258,6 +287,9 @@ bool AR_EXP_ReduceToScalar(AR_ExpNode *root, bool reduce_params, SIValue *val) {
 		ASSERT(func_desc != NULL);
 		if(!func_desc->reducible) return false;
 
+		// Avoid materializing large ranges.
+		if(_AR_EXP_LargeRange(root)) return false;
+
 		// Evaluate function.
 		SIValue v = AR_EXP_Evaluate(root, NULL);
 		if(val != NULL) *val = v;
@@ -292,8 +324,10 @@ void _AR_EXP_OperandResolveVariables(AR_ExpNode *node, const Record r) {
 	if(!AR_EXP_IsVariadic(node)) return;
 
 	// see if record contains a value for this variadic
-	const char *alias = node->operand.variadic.entity_alias;
-	uint idx = Record_GetEntryIdx(r, alias);
+	uint idx = node->operand.variadic.entity_alias_idx;
+	if(node->operand.variadic.entity_alias_mapping != r->mapping) {
+		idx = Record_GetEntryIdx(r, node->operand.variadic.entity_alias);
+	}
 	ASSERT(idx != INVALID_INDEX);
 	if(!Record_ContainsEntry(r, idx)) return;
 
@@ -324,6 +358,30 @@ void AR_EXP_ResolveVariables(AR_ExpNode *root, const Record r) {
 	AR_EXP_ReduceToScalar(root, true, NULL);
 }
 
+void AR_EXP_ResolveAliases(AR_ExpNode *root, const rax *mapping) {
+	ASSERT(mapping != NULL);
+
+	if(root == NULL) return;
+
+	if(root->type == AR_EXP_OP) {
+		for(uint i = 0; i < root->op.child_count; i++) {
+			AR_EXP_ResolveAliases(root->op.children[i], mapping);
+		}
+		return;
+	}
+
+	if(!AR_EXP_IsVariadic(root)) return;
+
+	const char *alias = root->operand.variadic.entity_alias;
+	void *idx = raxFind((rax *)mapping, (unsigned char *)alias, strlen(alias));
+	// alias is introduced by a different scope, resolve on first evaluation
+	if(idx == raxNotFound) return;
+
+	ASSERT((uint64_t)(intptr_t)idx < raxSize((rax *)mapping));
+	root->operand.variadic.entity_alias_idx = (intptr_t)idx;
+	root->operand.variadic.entity_alias_mapping = mapping;
+}
+
 static bool _AR_EXP_ValidateInvocation(AR_FuncDesc *fdesc, SIValue *argv, uint argc) {
 	SIType actual_type;
 	SIType expected_type = T_NULL;
@@ -449,13 +507,15 @@ static bool _AR_EXP_UpdateEntityIdx(AR_OperandNode *node, const Record r) {
 		return false;
 	} else {
 		node->variadic.entity_alias_idx = entry_alias_idx;
+		node->variadic.entity_alias_mapping = r->mapping;
 		return true;
 	}
 }
 
 static AR_EXP_Result _AR_EXP_EvaluateVariadic(AR_ExpNode *node, const Record r, SIValue *result) {
-	// Make sure entity record index is known.
-	if(node->operand.variadic.entity_alias_idx == IDENTIFIER_NOT_FOUND) {
+	// Make sure entity record index is known,
+	// indices resolved at plan time are valid only for records of their mapping.
+	if(!r || node->operand.variadic.entity_alias_mapping != r->mapping) {
 		if(!_AR_EXP_UpdateEntityIdx(&node->operand, r)) return EVAL_ERR;
 	}
 
@@ -467,6 +527,132 @@ static AR_EXP_Result _AR_EXP_EvaluateVariadic(AR_ExpNode *node, const Record r,
 	return EVAL_OK;
 }
 
+//------------------------------------------------------------------------------
+// Compiled evaluation
+//------------------------------------------------------------------------------
+
+// Type expected by fdesc for its idx argument,
+// the last specified type is repeatable.
+static inline SIType _AR_EXP_ExpectedType(const AR_FuncDesc *fdesc, uint idx) {
+	uint expected_types_count = array_len(fdesc->types);
+	if(expected_types_count == 0) return T_NULL;
+	if(idx >= expected_types_count) idx = expected_types_count - 1;
+	return fdesc->types[idx];
+}
+
+// Evaluates a compiled function call,
+// arguments validated at compile time are shared as is.
+static AR_EXP_Result _AR_EXP_EvaluateCompiledCall(AR_ExpNode *node,
+												  const Record r, SIValue *result) {
+	AR_FuncDesc *fdesc = node->op.f;
+	int child_count = node->op.child_count;
+	uint32_t static_args = node->op.static_args;
+	SIValue sub_trees[child_count];
+	bool param_found = false;
+
+	for(int i = 0; i < child_count; i++) {
+		AR_ExpNode *child = node->op.children[i];
+		if(static_args & (1u << i)) {
+			sub_trees[i] = SI_ShareValue(child->operand.constant);
+			continue;
+		}
+
+		AR_EXP_Result res = _AR_EXP_Evaluate(child, r, sub_trees + i);
+		if(res == EVAL_ERR) {
+			_AR_EXP_FreeResultsArray(sub_trees, i);
+			return res;
+		}
+		param_found |= (res == EVAL_FOUND_PARAM);
+	}
+
+	AR_EXP_Result res = (param_found) ? EVAL_FOUND_PARAM : EVAL_OK;
+
+	// validate arguments computed by this evaluation
+	for(int i = 0; i < child_count; i++) {
+		if(static_args & (1u << i)) continue;
+		SIType expected_type = _AR_EXP_ExpectedType(fdesc, i);
+		if(!(SI_TYPE(sub_trees[i]) & expected_type)) {
+			Error_SITypeMismatch(sub_trees[i], expected_type);
+			res = EVAL_ERR;
+			goto cleanup;
+		}
+	}
+
+	SIValue v = fdesc->func(sub_trees, child_count);
+	if(SIValue_IsNull(v) && ErrorCtx_EncounteredError()) res = EVAL_ERR;
+	if(result) *result = v;
+
+cleanup:
+	_AR_EXP_FreeResultsArray(sub_trees, child_count);
+	return res;
+}
+
+// Evaluates a compiled property access over an alias, alias.prop
+// the entity is read from the record and the only argument validated.
+static AR_EXP_Result _AR_EXP_EvaluateProperty(AR_ExpNode *node,
+											  const Record r, SIValue *result) {
+	SIValue argv[3];
+	AR_FuncDesc *fdesc = node->op.f;
+	AR_ExpNode **children = node->op.children;
+
+	// the alias might have been resolved into a constant
+	if(!AR_EXP_IsVariadic(children[0])) {
+		return _AR_EXP_EvaluateCompiledCall(node, r, result);
+	}
+
+	AR_EXP_Result res = _AR_EXP_EvaluateVariadic(children[0], r, argv);
+	if(res == EVAL_ERR) return res;
+
+	SIType expected_type = _AR_EXP_ExpectedType(fdesc, 0);
+	if(!(SI_TYPE(argv[0]) & expected_type)) {
+		Error_SITypeMismatch(argv[0], expected_type);
+		return EVAL_ERR;
+	}
+
+	argv[1] = children[1]->operand.constant;
+	argv[2] = children[2]->operand.constant;
+
+	SIValue v = fdesc->func(argv, 3);
+	if(SIValue_IsNull(v) && ErrorCtx_EncounteredError()) res = EVAL_ERR;
+	if(result) *result = v;
+	return res;
+}
+
+void AR_EXP_Compile(AR_ExpNode *root) {
+	if(root->type != AR_EXP_OP) return;
+
+	for(int i = 0; i < root->op.child_count; i++) {
+		AR_EXP_Compile(root->op.children[i]);
+	}
+
+	// aggregations are evaluated through AR_EXP_Aggregate
+	// functions with private data are handed it as an additional argument
+	AR_FuncDesc *fdesc = root->op.f;
+	if(fdesc->aggregate || fdesc->privdata != NULL) return;
+
+	// invalid invocations are left for evaluation to report
+	int argc = root->op.child_count;
+	if(argc > 32 || argc < fdesc->min_argc || argc > fdesc->max_argc) return;
+
+	uint32_t static_args = 0;
+	for(int i = 0; i < argc; i++) {
+		AR_ExpNode *child = root->op.children[i];
+		if(!AR_EXP_IsConstant(child)) continue;
+		if(!(SI_TYPE(child->operand.constant) & _AR_EXP_ExpectedType(fdesc, i))) return;
+		static_args |= (1u << i);
+	}
+
+	root->op.static_args = static_args;
+	root->op.eval = _AR_EXP_EvaluateCompiledCall;
+
+	// alias.prop, property name and index are constants
+	if(argc == 3 && static_args == 0x6 &&
+	   AR_EXP_IsVariadic(root->op.children[0]) &&
+	   strcmp(fdesc->name, "property") == 0) {
+		root->op.eval = _AR_EXP_EvaluateProperty;
+	}
+}
+
 static AR_EXP_Result _AR_EXP_EvaluateParam(AR_ExpNode *node, SIValue *result) {
 	rax *params = QueryCtx_GetParams();
 	AR_ExpNode *param_node = raxFind(params, (unsigned char *)node->operand.param_name,
@@ -498,6 +684,7 @@ static AR_EXP_Result _AR_EXP_Evaluate(AR_ExpNode *root, const Record r,
 	AR_EXP_Result res = EVAL_OK;
 	switch(root->type) {
 	case AR_EXP_OP:
+		if(root->op.eval) return root->op.eval(root, r, result);
 		return _AR_EXP_EvaluateFunctionCall(root, r, result);
 	case AR_EXP_OPERAND:
 		switch(root->operand.type) {
@@ -594,6 +781,56 @@ SIValue AR_EXP_Finalize(AR_ExpNode *root, const Record r) {
 	return AR_EXP_Evaluate(root, r);
 }
 
+void AR_EXP_ScaleAggregations(AR_ExpNode *root, double scale) {
+	ASSERT(root != NULL);
+
+	if(AGGREGATION_NODE(root)) {
+		if(!Aggregate_PerformsDistinct(root->op.f->privdata)) {
+			AR_Scale(root->op.f, scale);
+		}
+		return;
+	}
+
+	if(AR_EXP_IsOperation(root)) {
+		for(int i = 0; i < NODE_CHILD_COUNT(root); i++) {
+			AR_EXP_ScaleAggregations(NODE_CHILD(root, i), scale);
+		}
+	}
+}
+
+bool AR_EXP_Mergeable(const AR_ExpNode *root) {
+	if(AGGREGATION_NODE(root)) {
+		// distinct aggregations can't tell which values the other side saw
+		return (root->op.f->merge != NULL &&
+				!Aggregate_PerformsDistinct(root->op.f->privdata));
+	}
+
+	if(AR_EXP_IsOperation(root)) {
+		for(int i = 0; i < NODE_CHILD_COUNT(root); i++) {
+			if(!AR_EXP_Mergeable(NODE_CHILD(root, i))) return false;
+		}
+	}
+
+	return true;
+}
+
+void AR_EXP_Merge(AR_ExpNode *dst, AR_ExpNode *src) {
+	ASSERT(dst != NULL && src != NULL);
+	ASSERT(dst->type == src->type);
+
+	if(AGGREGATION_NODE(dst)) {
+		AR_Merge(dst->op.f, src->op.f);
+		return;
+	}
+
+	if(AR_EXP_IsOperation(dst)) {
+		ASSERT(NODE_CHILD_COUNT(dst) == NODE_CHILD_COUNT(src));
+		for(int i = 0; i < NODE_CHILD_COUNT(dst); i++) {
+			AR_EXP_Merge(NODE_CHILD(dst, i), NODE_CHILD(src, i));
+		}
+	}
+}
+
 void AR_EXP_CollectEntities(AR_ExpNode *root, rax *aliases) {
 	if(AR_EXP_IsOperation(root)) {
 		for(int i = 0; i < root->op.child_count; i ++) {
@@ -735,6 +972,51 @@ void AR_EXP_ToString(const AR_ExpNode *root, char **str) {
 	_AR_EXP_ToString(root, str, &str_size, &bytes_written);
 }
 
+// functions whose value isn't determined by their arguments
+static const char *_nondeterministic_funcs[] = {"rand", "randomUUID", "timestamp"};
+
+bool AR_EXP_Deterministic(const AR_ExpNode *exp) {
+	uint func_count = sizeof(_nondeterministic_funcs) / sizeof(char *);
+	for(uint i = 0; i < func_count; i++) {
+		if(AR_EXP_ContainsFunc(exp, _nondeterministic_funcs[i])) return false;
+	}
+	return true;
+}
+
+static bool _AR_EXP_OperandEqual(const AR_OperandNode *a, const AR_OperandNode *b) {
+	if(a->type != b->type) return false;
+	switch(a->type) {
+	case AR_EXP_CONSTANT:
+		// 1 and 1.0 compare equal, yet are of different types
+		return SI_TYPE(a->constant) == SI_TYPE(b->constant) &&
+			   SIValue_Compare(a->constant, b->constant, NULL) == 0;
+	case AR_EXP_VARIADIC:
+		return strcmp(a->variadic.entity_alias, b->variadic.entity_alias) == 0;
+	case AR_EXP_PARAM:
+		return strcmp(a->param_name, b->param_name) == 0;
+	default:
+		// borrowed records differ from one evaluation to another
+		return false;
+	}
+}
+
+bool AR_EXP_Equal(const AR_ExpNode *a, const AR_ExpNode *b) {
+	ASSERT(a != NULL && b != NULL);
+
+	if(a->type != b->type) return false;
+	if(a->type == AR_EXP_OPERAND) return _AR_EXP_OperandEqual(&a->operand, &b->operand);
+
+	// aggregations accumulate state, private data such as a comprehension's
+	// filter isn't represented by the function's children
+	if(a->op.f != b->op.f) return false;
+	if(a->op.f->aggregate || a->op.f->privdata != NULL) return false;
+	if(a->op.child_count != b->op.child_count) return false;
+	for(int i = 0; i < a->op.child_count; i++) {
+		if(!AR_EXP_Equal(a->op.children[i], b->op.children[i])) return false;
+	}
+	return true;
+}
+
 // Generate a heap-allocated name for an arithmetic expression.
 // This routine is only used to name ORDER BY expressions.
 char *AR_EXP_BuildResolvedName(AR_ExpNode *root) {
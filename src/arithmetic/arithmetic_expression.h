@@ -37,12 +37,20 @@ typedef enum {
 	EVAL_FOUND_PARAM = (1 << 1),
 } AR_EXP_Result;
 
+struct AR_ExpNode;
+
+/* Specialized evaluation routine of a compiled operation node. */
+typedef AR_EXP_Result (*AR_EXP_EvalFunc)(struct AR_ExpNode *node, const Record r,
+										 SIValue *result);
+
 /* Op represents an operation applied to child args. */
 typedef struct {
 	AR_FuncDesc *f;                 // Operation to perform on children
 	const char *func_name;          // Name of function
 	int child_count;                // Number of children
 	struct AR_ExpNode **children;   // Child nodes
+	AR_EXP_EvalFunc eval;           // Compiled evaluation routine, NULL if not compiled
+	uint32_t static_args;           // Bitmap of children validated at compile time
 } AR_OpNode;
 
 // OperandNode represents either constant, parameter, or graph entity
@@ -53,6 +61,7 @@ typedef struct {
 		struct {
 			const char *entity_alias;
 			int entity_alias_idx;
+			const rax *entity_alias_mapping;  // mapping entity_alias_idx resolves against
 		} variadic;
 	};
 	AR_OperandNodeType type;
@@ -99,6 +108,16 @@ bool AR_EXP_ReduceToScalar(AR_ExpNode *root, bool reduce_params, SIValue *val);
 /* Resolve variables to constants */
 void AR_EXP_ResolveVariables(AR_ExpNode *root, const Record r);
 
+/* Resolve every alias referenced by root into its slot within mapping,
+ * such that evaluating root against records of mapping requires no lookups.
+ * aliases missing from mapping are resolved on first evaluation. */
+void AR_EXP_ResolveAliases(AR_ExpNode *root, const rax *mapping);
+
+/* Specialize the evaluation of every operation within the tree,
+ * arity and constant arguments are validated once, such that evaluation
+ * only validates the types of arguments computed per record. */
+void AR_EXP_Compile(AR_ExpNode *root);
+
 /* Evaluate arithmetic expression tree. */
 SIValue AR_EXP_Evaluate(AR_ExpNode *root, const Record r);
 
@@ -109,6 +128,21 @@ void AR_EXP_Aggregate(AR_ExpNode *root, const Record r);
  * and evaluates the expression */
 SIValue AR_EXP_Finalize(AR_ExpNode *root, const Record r);
 
+/* Extrapolate the aggregations within the expression tree,
+ * computed over records sampled at rate 1 / scale, to the entire graph.
+ * Distinct aggregations can't tell how many distinct values were left out
+ * and are not scaled. */
+void AR_EXP_ScaleAggregations(AR_ExpNode *root, double scale);
+
+/* Returns true if the partial states of every aggregation
+ * within the expression tree can be merged. */
+bool AR_EXP_Mergeable(const AR_ExpNode *root);
+
+/* Fold the partial aggregation states of src into dst,
+ * src must be a clone of the same expression tree as dst,
+ * once merged src may only be freed. */
+void AR_EXP_Merge(AR_ExpNode *dst, AR_ExpNode *src);
+
 //------------------------------------------------------------------------------
 // Utility functions
 //------------------------------------------------------------------------------
@@ -153,6 +187,15 @@ bool AR_EXP_IsAttribute(const AR_ExpNode *exp, char **attr);
  * a boolean value and false otherwise. */
 bool AR_EXP_ReturnsBoolean(const AR_ExpNode *exp);
 
+/* Returns true if the expression's value is determined by its operands,
+ * false if it calls a function such as rand(). */
+bool AR_EXP_Deterministic(const AR_ExpNode *exp);
+
+/* Returns true if expressions a and b are structurally identical,
+ * such that both evaluate to the same value given the same record.
+ * Aggregations and functions holding private data are never identical. */
+bool AR_EXP_Equal(const AR_ExpNode *a, const AR_ExpNode *b);
+
 /* Generate a heap-allocated name for an arithmetic expression.
  * This routine is only used to name ORDER BY expressions. */
 char *AR_EXP_BuildResolvedName(AR_ExpNode *root);
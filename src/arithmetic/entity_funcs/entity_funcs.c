@@ -90,8 +90,9 @@ SIValue AR_EXISTS(SIValue *argv, int argc) {
 SIValue _AR_NodeDegree(SIValue *argv, int argc, GRAPH_EDGE_DIR dir) {
 	if(SI_TYPE(argv[0]) == T_NULL) return SI_NullVal();
 	Node *n = (Node *)argv[0].ptrval;
-	Edge *edges = array_new(Edge, 0);
+	NodeID id = ENTITY_GET_ID(n);
 	GraphContext *gc = QueryCtx_GetGraphCtx();
+	uint64_t degree = 0;
 
 	if(argc > 1) {
 		// We're interested in specific relationship type(s).
@@ -103,16 +104,14 @@ SIValue _AR_NodeDegree(SIValue *argv, int argc, GRAPH_EDGE_DIR dir) {
 			if(!s) continue;
 
 			// Accumulate edges.
-			Graph_GetNodeEdges(gc->g, n, dir, s->id, &edges);
+			degree += Graph_NodeDegree(gc->g, id, s->id, dir);
 		}
 	} else {
 		// Get all relations, regardless of their type.
-		Graph_GetNodeEdges(gc->g, n, dir, GRAPH_NO_RELATION, &edges);
+		degree = Graph_NodeDegree(gc->g, id, GRAPH_NO_RELATION, dir);
 	}
 
-	SIValue res = SI_LongVal(array_len(edges));
-	array_free(edges);
-	return res;
+	return SI_LongVal(degree);
 }
 
 /* Returns the number of incoming edges for given node. */
@@ -163,9 +162,20 @@ SIValue AR_PROPERTY(SIValue *argv, int argc) {
 			prop_idx = GraphContext_GetAttributeID(gc, prop_name);
 		}
 
+		// Prefer the columnar layout for labeled nodes when available,
+		// columns are never consulted by a writer while committing.
+		if(SI_TYPE(obj) == T_NODE && prop_idx != ATTRIBUTE_NOTFOUND) {
+			Node *n = (Node *)graph_entity;
+			GraphContext *gc = QueryCtx_GetGraphCtx();
+			if(n->labelID >= 0 && n->entity != NULL && !gc->g->_writelocked) {
+				Schema *s = GraphContext_GetSchemaByID(gc, n->labelID, SCHEMA_NODE);
+				SIValue *value = Schema_GetColumnValue(s, gc->g, prop_idx, ENTITY_GET_ID(n));
+				if(value) return SI_ConstValue(*value);
+			}
+		}
+
 		// Retrieve the property.
-		SIValue *value = GraphEntity_GetProperty(graph_entity, prop_idx);
-		return SI_ConstValue(*value);
+		return GraphEntity_GetProperty(graph_entity, prop_idx);
 	} else {
 		// retrieve map key
 		SIValue key = argv[1];
@@ -24,6 +24,8 @@ AR_FuncDesc *AR_FuncDescNew(const char *name, AR_Func func, uint min_argc, uint
 	desc->bclone = NULL;
 	desc->types = types;
 	desc->finalize = NULL;
+	desc->merge = NULL;
+	desc->scale = NULL;
 	desc->privdata = NULL;
 	desc->min_argc = min_argc;
 	desc->max_argc = max_argc;
@@ -72,6 +74,23 @@ void AR_SetFinalizeRoutine(AR_FuncDesc *func_desc, AR_Func_Finalize finalize) {
 	func_desc->finalize = finalize;
 }
 
+void AR_SetMergeRoutine(AR_FuncDesc *func_desc, AR_Func_Merge merge) {
+	func_desc->merge = merge;
+}
+
+void AR_Merge(AR_FuncDesc *dst, AR_FuncDesc *src) {
+	ASSERT(dst->merge != NULL && dst->merge == src->merge);
+	dst->merge(dst->privdata, src->privdata);
+}
+
+void AR_SetScaleRoutine(AR_FuncDesc *func_desc, AR_Func_Scale scale) {
+	func_desc->scale = scale;
+}
+
+void AR_Scale(AR_FuncDesc *func_desc, double scale) {
+	if(func_desc->scale) func_desc->scale(func_desc->privdata, scale);
+}
+
 void AR_Finalize(AR_FuncDesc *func_desc) {
 	if(func_desc->finalize) func_desc->finalize(func_desc->privdata);
 }
@@ -17,6 +17,12 @@ typedef SIValue(*AR_Func)(SIValue *argv, int argc);
 /* AR_Func_Finalize - Function pointer to a routine for computing an aggregate function's final value. */
 typedef void (*AR_Func_Finalize)(void *ctx);
 
+/* AR_Func_Merge - Function pointer to a routine for folding an aggregate function's partial state into another. */
+typedef void (*AR_Func_Merge)(void *dst, void *src);
+
+/* AR_Func_Scale - Function pointer to a routine for extrapolating an aggregate function's state computed over a sample. */
+typedef void (*AR_Func_Scale)(void *ctx, double scale);
+
 /* AR_Func_Free - Function pointer to a routine for freeing a function's private data. */
 typedef void (*AR_Func_Free)(void *ctx);
 /* AR_Func_Clone - Function pointer to a routine for cloning a function's private data. */
@@ -34,6 +40,8 @@ typedef struct {
 	AR_Func_Free bfree;        // [optional] Function pointer to function cleanup routine.
 	AR_Func_Clone bclone;      // [optional] Function pointer to function clone routine.
 	AR_Func_Finalize finalize; // [optional] Function pointer to routine for finalizing aggregate value.
+	AR_Func_Merge merge;       // [optional] Function pointer to routine for merging partial aggregate states.
+	AR_Func_Scale scale;       // [optional] Function pointer to routine for scaling sampled aggregate states.
 } AR_FuncDesc;
 
 AR_FuncDesc *AR_FuncDescNew(const char *name, AR_Func func, uint min_argc, uint max_argc,
@@ -58,6 +66,20 @@ void AR_SetPrivateDataRoutines(AR_FuncDesc *func_desc, AR_Func_Free bfree, AR_Fu
 /* Set the function pointer for computing an aggregate function's final value. */
 void AR_SetFinalizeRoutine(AR_FuncDesc *func_desc, AR_Func_Finalize finalize);
 
+/* Set the function pointer for merging two partial states of an aggregate function. */
+void AR_SetMergeRoutine(AR_FuncDesc *func_desc, AR_Func_Merge merge);
+
+/* Set the function pointer for scaling an aggregate function's sampled state. */
+void AR_SetScaleRoutine(AR_FuncDesc *func_desc, AR_Func_Scale scale);
+
+/* Scale the aggregate state computed over a sample by 'scale',
+ * a no-op for aggregate functions indifferent to the sample's size. */
+void AR_Scale(AR_FuncDesc *func_desc, double scale);
+
+/* Merge the partial aggregate state of src into dst,
+ * both descriptors must refer to the same aggregate function. */
+void AR_Merge(AR_FuncDesc *dst, AR_FuncDesc *src);
+
 /* Invoke finalize routine for function. */
 void AR_Finalize(AR_FuncDesc *func_desc);
 
@@ -133,8 +133,10 @@ SIValue AR_RANGE(SIValue *argv, int argc) {
 		}
 	}
 
-	SIValue array = SI_Array(1 + (end - start) / interval);
-	for(; start <= end; start += interval) {
+	// integer lists are stored packed
+	uint64_t count = (start <= end) ? 1 + (end - start) / interval : 0;
+	SIValue array = SI_Array(count);
+	for(uint64_t i = 0; i < count; i++, start += interval) {
 		SIArray_Append(&array, SI_LongVal(start));
 	}
 	return array;
@@ -148,9 +150,19 @@ SIValue AR_IN(SIValue *argv, int argc) {
 	ASSERT(SI_TYPE(argv[1]) == T_ARRAY);
 	SIValue lookupValue = argv[0];
 	SIValue lookupList = argv[1];
+	uint arrayLen = SIArray_Length(lookupList);
+
+	// integer lookup in a packed integer list, no nulls to compare against
+	const int64_t *longs = SIArray_Longs(lookupList);
+	if(longs != NULL && SI_TYPE(lookupValue) == T_INT64) {
+		for(uint i = 0; i < arrayLen; i++) {
+			if(longs[i] == lookupValue.longval) return SI_BoolVal(true);
+		}
+		return SI_BoolVal(false);
+	}
+
 	// indicate if there was a null comparison during the array scan
 	bool comparedNull = false;
-	uint arrayLen = SIArray_Length(lookupList);
 	for(uint i = 0; i < arrayLen; i++) {
 		int disjointOrNull = 0;
 		int compareValue = SIValue_Compare(lookupValue, SIArray_Get(lookupList, i), &disjointOrNull);
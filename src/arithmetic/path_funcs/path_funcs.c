@@ -12,7 +12,7 @@
 #include "../../query_ctx.h"
 #include "../../util/rmalloc.h"
 #include "../../datatypes/path/sipath_builder.h"
-#include "../../algorithms/LAGraph_bfs_pushpull.h"
+#include "../../algorithms/bidirectional_bfs.h"
 
 /* Creates a path from a given sequence of graph entities.
  * The first argument is the ast node represents the path.
@@ -112,15 +112,8 @@ SIValue AR_SHORTEST_PATH(SIValue *argv, int argc) {
 	GrB_Info res;
 	UNUSED(res);
 	Edge *edges = NULL;
-	GrB_Vector V = GrB_NULL;  // vector of results
-	GrB_Vector PI = GrB_NULL; // vector backtracking results to their parents
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 
-	/* The BFS algorithm uses a level of 1 to indicate the source node.
-	 * If this value is not zero (unlimited), increment it by 1
-	 * to make level 1 indicate the source's direct neighbors. */
-	int64_t max_level = (ctx->maxHops == EDGE_LENGTH_INF) ? 0 : ctx->maxHops + 1;
-
 	if(ctx->R == GrB_NULL) {
 		// First invocation, initialize unset context members.
 		if(ctx->reltype_count > 0) {
@@ -150,8 +143,7 @@ SIValue AR_SHORTEST_PATH(SIValue *argv, int argc) {
 			ctx->TR = Graph_GetZeroMatrix(gc->g);
 		} else if(ctx->reltype_count == 1) {
 			ctx->R = Graph_GetRelationMatrix(gc->g, ctx->reltypes[0]);
-			if(maintain_transposes) ctx->TR = Graph_GetTransposedRelationMatrix(gc->g, ctx->reltypes[0]);
-			else ctx->TR = GrB_NULL;
+			ctx->TR = Graph_GetCachedTransposedRelationMatrix(gc->g, ctx->reltypes[0]);
 		} else {
 			// We have multiple edge types, combine them into a boolean matrix.
 			ctx->free_matrices = true;
@@ -176,46 +168,35 @@ SIValue AR_SHORTEST_PATH(SIValue *argv, int argc) {
 		}
 	}
 
-	// Invoke the BFS algorithm
-	res = LAGraph_bfs_pushpull(&V, &PI, ctx->R, ctx->TR, src_id,
-							   &dest_id, max_level, true);
-	ASSERT(res == GrB_SUCCESS);
-
-	SIValue p = SI_NullVal();
+	uint64_t max_hops = (ctx->maxHops == EDGE_LENGTH_INF) ?
+		BIDIRECTIONAL_BFS_UNBOUNDED : ctx->maxHops;
 
-	// The length of the path is equal to the level of the destination node
-	GrB_Index path_len;
-	res = GrB_Vector_extractElement(&path_len, V, dest_id);
-	if(res == GrB_NO_VALUE) goto cleanup; // no path found
+	// Search from both endpoints until the two searches meet
+	NodeID *nodes = BidirectionalBFS(ctx->R, ctx->TR, src_id, dest_id, max_hops);
+	if(nodes == NULL) return SI_NullVal(); // no path found
 
-	path_len -= 1; // Convert node count to edge count
+	SIValue p = SI_NullVal();
+	uint path_len = array_len(nodes) - 1; // Convert node count to edge count
 
 	// Only emit a path with no edges if minHops is 0
 	if(path_len == 0 && ctx->minHops != 0) goto cleanup;
 
-	/* Build path in reverse, starting by appending the destination node.
-	 * The path is built in reverse because we have the destination's parent
-	 * in the PI array, and can use this to backtrack until we reach the source. */
 	p = SIPathBuilder_New(path_len);
-	SIPathBuilder_AppendNode(p, SI_Node(destNode));
+	SIPathBuilder_AppendNode(p, SI_Node(srcNode));
 
 	edges = array_new(Edge, 1);
 
-	NodeID id = destNode->id;
 	for(uint i = 0; i < path_len; i ++) {
 		array_clear(edges);
-		GrB_Index parent_id;
-		// Find the parent of the reached node.
-		GrB_Info res = GrB_Vector_extractElement(&parent_id, PI, id);
-		ASSERT(res == GrB_SUCCESS);
-		parent_id --; // Decrement the parent ID by 1 to correct 1-indexing.
+		NodeID src = nodes[i];
+		NodeID dest = nodes[i + 1];
 
-		// Retrieve edges connecting the parent node to the current node.
+		// Retrieve edges connecting the current node to the next one.
 		if(ctx->reltype_count == 0) {
-			Graph_GetEdgesConnectingNodes(gc->g, parent_id, id, GRAPH_NO_RELATION, &edges);
+			Graph_GetEdgesConnectingNodes(gc->g, src, dest, GRAPH_NO_RELATION, &edges);
 		} else {
 			for(uint j = 0; j < ctx->reltype_count; j ++) {
-				Graph_GetEdgesConnectingNodes(gc->g, parent_id, id, ctx->reltypes[j], &edges);
+				Graph_GetEdgesConnectingNodes(gc->g, src, dest, ctx->reltypes[j], &edges);
 				if(array_len(edges) > 0) break;
 			}
 		}
@@ -224,18 +205,17 @@ SIValue AR_SHORTEST_PATH(SIValue *argv, int argc) {
 		SIPathBuilder_AppendEdge(p, SI_Edge(&edges[0]), false);
 
 		// Append the reached node to the path.
-		id = edges[0].srcNodeID;
-		Node n = GE_NEW_NODE();
-		Graph_GetNode(gc->g, id, &n);
-		SIPathBuilder_AppendNode(p, SI_Node(&n));
+		if(i == path_len - 1) {
+			SIPathBuilder_AppendNode(p, SI_Node(destNode));
+		} else {
+			Node n = GE_NEW_NODE();
+			Graph_GetNode(gc->g, dest, &n);
+			SIPathBuilder_AppendNode(p, SI_Node(&n));
+		}
 	}
 
-	// Reverse the path so it starts at the source
-	Path_Reverse(p.ptrval);
-
 cleanup:
-	if(V) GrB_free(&V);
-	if(PI) GrB_free(&PI);
+	array_free(nodes);
 	if(edges) array_free(edges);
 
 	return p;
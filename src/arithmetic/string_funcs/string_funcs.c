@@ -193,18 +193,12 @@ SIValue AR_STARTSWITH(SIValue *argv, int argc) {
 
 	const char *str = argv[0].stringval;
 	const char *sub_string = argv[1].stringval;
-	size_t str_len = strlen(str);
 	size_t sub_string_len = strlen(sub_string);
 
-	// If sub-string is longer then string return quickly.
-	if(sub_string_len > str_len) return SI_BoolVal(false);
-
-	// Compare character by character, see if there's a match.
-	for(int i = 0; i < sub_string_len; i++) {
-		if(str[i] != sub_string[i]) return SI_BoolVal(false);
-	}
-
-	return SI_BoolVal(true);
+	// strncmp stops at the end of a shorter string,
+	// comparing a word at a time rather than a byte at a time.
+	bool match = (strncmp(str, sub_string, sub_string_len) == 0);
+	return SI_BoolVal(match);
 }
 
 /* returns true if argv[0] ends with argv[1]. */
@@ -220,14 +214,10 @@ SIValue AR_ENDSWITH(SIValue *argv, int argc) {
 	// If sub-string is longer then string return quickly.
 	if(sub_string_len > str_len) return SI_BoolVal(false);
 
-	// Advance str to the "end"
-	str += (str_len - sub_string_len);
-	// Compare character by character, see if there's a match.
-	for(int i = 0; i < sub_string_len; i++) {
-		if(str[i] != sub_string[i]) return SI_BoolVal(false);
-	}
-
-	return SI_BoolVal(true);
+	// Compare the tail of str to the sub-string.
+	bool match = (memcmp(str + (str_len - sub_string_len), sub_string,
+				sub_string_len) == 0);
+	return SI_BoolVal(match);
 }
 
 //==============================================================================
@@ -111,7 +111,9 @@ bool AST_ReadOnly(const cypher_astnode_t *root) {
 	   type == CYPHER_AST_DELETE                 ||
 	   type == CYPHER_AST_SET                    ||
 	   type == CYPHER_AST_CREATE_NODE_PROPS_INDEX ||
-	   type == CYPHER_AST_DROP_NODE_PROPS_INDEX) {
+	   type == CYPHER_AST_DROP_NODE_PROPS_INDEX ||
+	   type == CYPHER_AST_CREATE_NODE_PROP_CONSTRAINT ||
+	   type == CYPHER_AST_DROP_NODE_PROP_CONSTRAINT) {
 		return false;
 	}
 	// In case of procedure call which modifies the graph/indices.
@@ -130,6 +132,26 @@ bool AST_ReadOnly(const cypher_astnode_t *root) {
 	return true;
 }
 
+// Functions whose value isn't determined by their arguments.
+static const char *_nondeterministic_funcs[] = {"rand", "randomUUID", "timestamp"};
+
+bool AST_Deterministic(const cypher_astnode_t *root) {
+	if(root == NULL) return true;
+	if(cypher_astnode_type(root) == CYPHER_AST_APPLY_OPERATOR) {
+		const cypher_astnode_t *func = cypher_ast_apply_operator_get_func_name(root);
+		const char *func_name = cypher_ast_function_name_get_value(func);
+		uint func_count = sizeof(_nondeterministic_funcs) / sizeof(char *);
+		for(uint i = 0; i < func_count; i++) {
+			if(strcasecmp(func_name, _nondeterministic_funcs[i]) == 0) return false;
+		}
+	}
+	uint num_children = cypher_astnode_nchildren(root);
+	for(uint i = 0; i < num_children; i ++) {
+		if(!AST_Deterministic(cypher_astnode_get_child(root, i))) return false;
+	}
+	return true;
+}
+
 inline bool AST_ContainsClause(const AST *ast, cypher_astnode_type_t clause) {
 	return AST_GetClause(ast, clause, NULL) != NULL;
 }
@@ -43,6 +43,10 @@ AST_Validation AST_Validate_QueryParams(const cypher_parse_result_t *result);
 // Checks if the parse result represents a read-only query.
 bool AST_ReadOnly(const cypher_astnode_t *root);
 
+// Checks if the query's results are determined by the graph and the query parameters,
+// i.e. the query doesn't call functions such as rand() or timestamp().
+bool AST_Deterministic(const cypher_astnode_t *root);
+
 // Checks to see if AST contains specified clause.
 bool AST_ContainsClause(const AST *ast, cypher_astnode_type_t clause);
 
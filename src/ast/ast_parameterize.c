@@ -0,0 +1,273 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "ast_parameterize.h"
+#include "RG.h"
+#include "../util/rmalloc.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+
+// literals longer than this aren't lifted, e.g. -9223372036854775808
+// can't be expressed as a negated parameter
+#define MAX_LIFTED_DIGITS 18
+
+// clause keywords after which literals are lifted
+static const char *_lift_clauses[] = {
+	"MATCH", "OPTIONAL", "WHERE", "UNWIND", "CREATE", "MERGE", "SET",
+	"DELETE", "DETACH", "REMOVE", "ORDER", "SKIP", "LIMIT", "UNION"
+};
+
+// clause keywords after which literals are kept
+// RETURN and WITH projections are named after their text
+// procedure arguments are validated before parameters are resolved
+static const char *_keep_clauses[] = {
+	"RETURN", "WITH", "CALL", "YIELD"
+};
+
+typedef enum {
+	REGION_OPTIONS,  // CYPHER options prefix, literals are kept
+	REGION_LIFT,     // literals are lifted
+	REGION_KEEP,     // literals are kept
+} _Region;
+
+//------------------------------------------------------------------------------
+// string builder
+//------------------------------------------------------------------------------
+
+typedef struct {
+	char *buf;
+	size_t len;
+	size_t cap;
+} _Builder;
+
+static void _Builder_Append(_Builder *b, const char *s, size_t n) {
+	if(b->len + n + 1 > b->cap) {
+		while(b->len + n + 1 > b->cap) b->cap *= 2;
+		b->buf = rm_realloc(b->buf, b->cap);
+	}
+	memcpy(b->buf + b->len, s, n);
+	b->len += n;
+	b->buf[b->len] = '\0';
+}
+
+static void _Builder_Init(_Builder *b, size_t cap) {
+	b->len = 0;
+	b->cap = cap;
+	b->buf = rm_malloc(cap);
+	b->buf[0] = '\0';
+}
+
+//------------------------------------------------------------------------------
+// lexing
+//------------------------------------------------------------------------------
+
+static inline bool _IsIdentifierChar(char c) {
+	return isalnum((unsigned char)c) || c == '_' || (unsigned char)c >= 0x80;
+}
+
+static inline bool _IsKeyword(const char *s, size_t n, const char **keywords,
+		size_t count) {
+	for(size_t i = 0; i < count; i++) {
+		if(strlen(keywords[i]) == n && strncasecmp(s, keywords[i], n) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// returns the end of the string literal starting at s
+static const char *_SkipString(const char *s) {
+	char quote = *s++;
+	while(*s && *s != quote) {
+		if(*s == '\\' && s[1]) s++;
+		s++;
+	}
+	return (*s) ? s + 1 : s;
+}
+
+// returns the end of the numeric literal starting at s
+static const char *_SkipNumber(const char *s) {
+	if(s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+		s += 2;
+		while(isxdigit((unsigned char)*s)) s++;
+		return s;
+	}
+
+	while(isdigit((unsigned char)*s)) s++;
+	if(s[0] == '.' && isdigit((unsigned char)s[1])) {
+		s++;
+		while(isdigit((unsigned char)*s)) s++;
+	}
+	if(*s == 'e' || *s == 'E') {
+		const char *e = s + 1;
+		if(*e == '+' || *e == '-') e++;
+		if(isdigit((unsigned char)*e)) {
+			s = e;
+			while(isdigit((unsigned char)*s)) s++;
+		}
+	}
+	return s;
+}
+
+char *AST_ParameterizeQuery(const char *query) {
+	ASSERT(query != NULL);
+
+	size_t query_len = strlen(query);
+	_Builder params;
+	_Builder body;
+	_Builder_Init(&params, 64);
+	_Builder_Init(&body, query_len + 64);
+
+	uint lifted = 0;
+	int depth = 0;
+	char prev = '\0';  // last significant character copied to body
+	bool first_token = true;
+	size_t options_offset = 0;  // body offset following a leading CYPHER keyword
+	_Region region = REGION_LIFT;
+	const char *s = query;
+
+	while(*s) {
+		const char *start = s;
+		char c = *s;
+
+		if(isspace((unsigned char)c)) {
+			s++;
+			_Builder_Append(&body, start, 1);
+			continue;
+		}
+
+		// comments
+		if(c == '/' && s[1] == '/') {
+			while(*s && *s != '\n') s++;
+			_Builder_Append(&body, start, s - start);
+			continue;
+		}
+		if(c == '/' && s[1] == '*') {
+			const char *end = strstr(s + 2, "*/");
+			s = (end) ? end + 2 : s + strlen(s);
+			_Builder_Append(&body, start, s - start);
+			continue;
+		}
+
+		if(c == '`') {
+			// escaped identifier
+			s = strchr(s + 1, '`');
+			s = (s) ? s + 1 : start + strlen(start);
+			_Builder_Append(&body, start, s - start);
+			prev = '`';
+			first_token = false;
+			continue;
+		}
+
+		if(c == '$') {
+			// parameter reference
+			s++;
+			while(_IsIdentifierChar(*s)) s++;
+			_Builder_Append(&body, start, s - start);
+			prev = 'a';
+			first_token = false;
+			continue;
+		}
+
+		if(_IsIdentifierChar(c) && !isdigit((unsigned char)c)) {
+			while(_IsIdentifierChar(*s)) s++;
+			size_t n = s - start;
+			_Builder_Append(&body, start, n);
+
+			// property keys, labels and option names are never clause keywords
+			const char *next = s;
+			while(isspace((unsigned char)*next)) next++;
+			bool option_name = (region == REGION_OPTIONS && *next == '=');
+
+			if(depth == 0 && prev != '.' && prev != ':' && !option_name) {
+				if(first_token && n == 6 && strncasecmp(start, "CYPHER", 6) == 0) {
+					region = REGION_OPTIONS;
+					options_offset = body.len;
+				} else if(_IsKeyword(start, n, _lift_clauses,
+							sizeof(_lift_clauses) / sizeof(char *))) {
+					region = REGION_LIFT;
+				} else if(_IsKeyword(start, n, _keep_clauses,
+							sizeof(_keep_clauses) / sizeof(char *))) {
+					region = REGION_KEEP;
+				}
+			}
+
+			first_token = false;
+			prev = 'a';
+			continue;
+		}
+
+		if(c == '*') {
+			// variable length range, e.g. [*1..3], bounds must be literals
+			s++;
+			while(*s && (isdigit((unsigned char)*s) || *s == '.' ||
+						isspace((unsigned char)*s))) s++;
+			_Builder_Append(&body, start, s - start);
+			prev = '*';
+			first_token = false;
+			continue;
+		}
+
+		bool is_string = (c == '\'' || c == '"');
+		bool is_number = isdigit((unsigned char)c);
+		if(is_string || is_number) {
+			s = (is_string) ? _SkipString(s) : _SkipNumber(s);
+			size_t n = s - start;
+
+			bool lift = (region == REGION_LIFT && prev != '.');
+			if(is_number && n > MAX_LIFTED_DIGITS) lift = false;
+			// strings must be terminated
+			if(is_string && (n < 2 || start[n - 1] != c)) lift = false;
+
+			if(lift) {
+				char name[32];
+				int name_len = snprintf(name, sizeof(name), AST_AUTO_PARAM_PREFIX "%u",
+						lifted++);
+				_Builder_Append(&params, name, name_len);
+				_Builder_Append(&params, "=", 1);
+				_Builder_Append(&params, start, n);
+				_Builder_Append(&params, " ", 1);
+				_Builder_Append(&body, "$", 1);
+				_Builder_Append(&body, name, name_len);
+			} else {
+				_Builder_Append(&body, start, n);
+			}
+
+			prev = 'a';
+			first_token = false;
+			continue;
+		}
+
+		// punctuation
+		if(c == '(' || c == '[' || c == '{') depth++;
+		else if((c == ')' || c == ']' || c == '}') && depth > 0) depth--;
+		s++;
+		_Builder_Append(&body, start, 1);
+		prev = c;
+		first_token = false;
+	}
+
+	char *res = NULL;
+	if(lifted > 0) {
+		// extend the query's own CYPHER options if it has any
+		size_t len = strlen("CYPHER ") + params.len + body.len + 1;
+		res = rm_malloc(len);
+		if(options_offset > 0) {
+			snprintf(res, len, "%.*s %s%s", (int)options_offset, body.buf,
+					params.buf, body.buf + options_offset);
+		} else {
+			snprintf(res, len, "CYPHER %s%s", params.buf, body.buf);
+		}
+	}
+
+	rm_free(params.buf);
+	rm_free(body.buf);
+	return res;
+}
+
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+// prefix of parameters introduced by query parameterization
+#define AST_AUTO_PARAM_PREFIX "__lit"
+
+// lifts numeric and string literals within query into parameters
+// such that structurally identical queries map to the same query text
+// e.g.
+// MATCH (n {id: 5}) RETURN n
+// becomes
+// CYPHER __lit0=5 MATCH (n {id: $__lit0}) RETURN n
+//
+// literals which determine a result-set column name (RETURN / WITH
+// projections), procedure arguments and variable-length ranges are kept
+// returns NULL if no literal was lifted, otherwise a newly allocated query
+char *AST_ParameterizeQuery
+(
+	const char *query
+);
+
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "ast_params.h"
+#include "RG.h"
+#include "rax.h"
+#include "../value.h"
+#include "../query_ctx.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../datatypes/map.h"
+#include "../datatypes/array.h"
+#include "../arithmetic/arithmetic_expression.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// max nesting level of lists and maps within a parameter value
+#define MAX_PARAM_DEPTH 64
+
+//------------------------------------------------------------------------------
+// lexing
+//------------------------------------------------------------------------------
+
+static inline bool _IsIdentifierChar(char c) {
+	return isalnum((unsigned char)c) || c == '_' || (unsigned char)c >= 0x80;
+}
+
+static inline bool _IsIdentifierStart(char c) {
+	return _IsIdentifierChar(c) && !isdigit((unsigned char)c);
+}
+
+static inline const char *_SkipSpace(const char *s) {
+	while(isspace((unsigned char)*s)) s++;
+	return s;
+}
+
+// returns true if s starts with keyword 'kw' followed by a non identifier char
+static inline bool _IsKeyword(const char *s, const char *kw) {
+	size_t n = strlen(kw);
+	return (strncasecmp(s, kw, n) == 0 && !_IsIdentifierChar(s[n]));
+}
+
+// returns the end of the identifier starting at s
+static inline const char *_SkipIdentifier(const char *s) {
+	while(_IsIdentifierChar(*s)) s++;
+	return s;
+}
+
+//------------------------------------------------------------------------------
+// values
+//------------------------------------------------------------------------------
+
+static const char *_ParseValue(const char *s, uint depth, SIValue *v);
+
+// parse a quoted string literal, resolving escape sequences
+static const char *_ParseString(const char *s, SIValue *v) {
+	char quote = *s++;
+	const char *end = s;
+	while(*end && *end != quote) {
+		if(*end == '\\' && end[1]) end++;
+		end++;
+	}
+	if(*end != quote) return NULL;
+
+	char *str = rm_malloc(end - s + 1);
+	size_t len = 0;
+	while(s < end) {
+		char c = *s++;
+		if(c == '\\') {
+			switch(*s++) {
+				case '\\': c = '\\'; break;
+				case '\'': c = '\''; break;
+				case '"':  c = '"';  break;
+				case 'b':  c = '\b'; break;
+				case 'f':  c = '\f'; break;
+				case 'n':  c = '\n'; break;
+				case 'r':  c = '\r'; break;
+				case 't':  c = '\t'; break;
+				default:
+					// unicode and unknown escapes are left to the Cypher parser
+					rm_free(str);
+					return NULL;
+			}
+		}
+		str[len++] = c;
+	}
+	str[len] = '\0';
+
+	*v = SI_TransferStringVal(str);
+	return end + 1;
+}
+
+// parse a decimal integer or float literal
+static const char *_ParseNumber(const char *s, SIValue *v) {
+	const char *start = s;
+	if(*s == '-') s++;
+	if(!isdigit((unsigned char)*s)) return NULL;
+	// octal and hexadecimal literals are left to the Cypher parser
+	if(s[0] == '0' && _IsIdentifierChar(s[1])) return NULL;
+
+	bool is_float = false;
+	while(isdigit((unsigned char)*s)) s++;
+	if(s[0] == '.' && isdigit((unsigned char)s[1])) {
+		is_float = true;
+		s++;
+		while(isdigit((unsigned char)*s)) s++;
+	}
+	if(*s == 'e' || *s == 'E') {
+		is_float = true;
+		s++;
+		if(*s == '+' || *s == '-') s++;
+		if(!isdigit((unsigned char)*s)) return NULL;
+		while(isdigit((unsigned char)*s)) s++;
+	}
+	if(_IsIdentifierChar(*s) || *s == '.') return NULL;
+
+	char *end = NULL;
+	errno = 0;
+	if(is_float) {
+		double d = strtod(start, &end);
+		*v = SI_DoubleVal(d);
+	} else {
+		long long l = strtoll(start, &end, 10);
+		*v = SI_LongVal(l);
+	}
+	if(errno == ERANGE || end != s) return NULL;
+	return s;
+}
+
+static const char *_ParseList(const char *s, uint depth, SIValue *v) {
+	SIValue list = SI_Array(0);
+	s = _SkipSpace(s + 1);
+	if(*s == ']') {
+		*v = list;
+		return s + 1;
+	}
+
+	while(true) {
+		SIValue elem;
+		s = _ParseValue(s, depth + 1, &elem);
+		if(s == NULL) goto error;
+		// hand elem over to the list rather than cloning it
+		SIArray_AppendAsOwner(&list, &elem);
+
+		s = _SkipSpace(s);
+		if(*s == ']') break;
+		if(*s != ',') goto error;
+		s = _SkipSpace(s + 1);
+	}
+
+	*v = list;
+	return s + 1;
+
+error:
+	SIValue_Free(list);
+	return NULL;
+}
+
+static const char *_ParseMap(const char *s, uint depth, SIValue *v) {
+	SIValue map = SI_Map(0);
+	s = _SkipSpace(s + 1);
+	if(*s == '}') {
+		*v = map;
+		return s + 1;
+	}
+
+	while(true) {
+		// escaped keys are left to the Cypher parser
+		if(!_IsIdentifierStart(*s)) goto error;
+		const char *key_end = _SkipIdentifier(s);
+		char *key_str = rm_strndup(s, key_end - s);
+
+		s = _SkipSpace(key_end);
+		if(*s != ':') {
+			rm_free(key_str);
+			goto error;
+		}
+
+		SIValue val;
+		s = _ParseValue(_SkipSpace(s + 1), depth + 1, &val);
+		if(s == NULL) {
+			rm_free(key_str);
+			goto error;
+		}
+		// hand key and val over to the map rather than cloning them
+		Map_AddNoClone(&map, SI_TransferStringVal(key_str), val);
+
+		s = _SkipSpace(s);
+		if(*s == '}') break;
+		if(*s != ',') goto error;
+		s = _SkipSpace(s + 1);
+	}
+
+	*v = map;
+	return s + 1;
+
+error:
+	SIValue_Free(map);
+	return NULL;
+}
+
+// parse a literal value starting at s into v
+// returns the end of the literal, NULL if s doesn't start with a literal
+static const char *_ParseValue(const char *s, uint depth, SIValue *v) {
+	if(depth > MAX_PARAM_DEPTH) return NULL;
+
+	char c = *s;
+	if(c == '\'' || c == '"') return _ParseString(s, v);
+	if(c == '-' || isdigit((unsigned char)c)) return _ParseNumber(s, v);
+	if(c == '[') return _ParseList(s, depth, v);
+	if(c == '{') return _ParseMap(s, depth, v);
+
+	if(_IsKeyword(s, "true")) {
+		*v = SI_BoolVal(true);
+		return s + 4;
+	}
+	if(_IsKeyword(s, "false")) {
+		*v = SI_BoolVal(false);
+		return s + 5;
+	}
+	if(_IsKeyword(s, "null")) {
+		*v = SI_NullVal();
+		return s + 4;
+	}
+
+	// expressions are left to the Cypher parser
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// parameters
+//------------------------------------------------------------------------------
+
+static void _FreeParam(void *param) {
+	AR_EXP_Free(param);
+}
+
+bool AST_ParseLiteralParams(const char *query, const char **query_body) {
+	ASSERT(query != NULL);
+	ASSERT(query_body != NULL);
+
+	const char *s = _SkipSpace(query);
+	// without parameters the query is its own body
+	// EXPLAIN and PROFILE options are reported by the Cypher parser
+	if(!_IsKeyword(s, "CYPHER")) {
+		if(!_IsIdentifierStart(*s)) return false;
+		if(_IsKeyword(s, "EXPLAIN") || _IsKeyword(s, "PROFILE")) return false;
+		*query_body = s;
+		return true;
+	}
+
+	// parse name=value pairs into a temporary map
+	// such that no parameter is set if the prefix can't be handled
+	rax *params = raxNew();
+	s += strlen("CYPHER");
+	while(true) {
+		s = _SkipSpace(s);
+		if(!_IsIdentifierStart(*s)) break;
+
+		// an identifier which isn't followed by '=' starts the query body
+		const char *name = s;
+		const char *name_end = _SkipIdentifier(s);
+		const char *eq = _SkipSpace(name_end);
+		if(*eq != '=') break;
+
+		SIValue v;
+		const char *end = _ParseValue(_SkipSpace(eq + 1), 0, &v);
+		if(end == NULL) goto fallback;
+
+		// values must be separated from whatever follows them
+		AR_ExpNode *exp = AR_EXP_NewConstOperandNode(v);
+		if(*end != '\0' && !isspace((unsigned char)*end)) {
+			AR_EXP_Free(exp);
+			goto fallback;
+		}
+
+		// duplicated parameters are reported by the Cypher parser
+		if(!raxTryInsert(params, (unsigned char *)name, name_end - name, exp, NULL)) {
+			AR_EXP_Free(exp);
+			goto fallback;
+		}
+		s = end;
+	}
+
+	// query body must open with a clause keyword
+	if(!_IsIdentifierStart(*s) || _IsKeyword(s, "CYPHER") ||
+	   _IsKeyword(s, "EXPLAIN") || _IsKeyword(s, "PROFILE")) {
+		goto fallback;
+	}
+
+	// hand parameters over to the query context
+	rax *query_params = QueryCtx_GetParams();
+	raxIterator it;
+	raxStart(&it, params);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) {
+		raxInsert(query_params, it.key, it.key_len, it.data, NULL);
+	}
+	raxStop(&it);
+	raxFree(params);
+
+	*query_body = s;
+	return true;
+
+fallback:
+	raxFreeWithCallback(params, _FreeParam);
+	return false;
+}
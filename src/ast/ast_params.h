@@ -0,0 +1,25 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+// parses the CYPHER parameters prefix of 'query' into the query context
+// parameters, bypassing the Cypher parser
+// e.g.
+// CYPHER a=1 b='x' batch=[{id: 1}, {id: 2}] UNWIND $batch AS row ...
+//
+// only literal values are handled: numbers, strings, booleans, null
+// and lists and maps of those
+// sets 'query_body' to the query following the prefix
+// returns false if the prefix can't be handled, in which case
+// no parameter is set and the caller should resort to parse_params
+bool AST_ParseLiteralParams
+(
+	const char *query,       // query string
+	const char **query_body  // [output] query following the parameters
+);
@@ -80,7 +80,7 @@ PropertyMap *PropertyMap_New(GraphContext *gc, const cypher_astnode_t *props) {
 	return map;
 }
 
-static PropertyMap *_PropertyMap_Clone(PropertyMap *map) {
+PropertyMap *PropertyMap_Clone(PropertyMap *map) {
 	PropertyMap *clone = rm_malloc(sizeof(PropertyMap));
 	uint prop_count = map->property_count;
 	clone->keys = rm_malloc(prop_count * sizeof(Attribute_ID));
@@ -111,13 +111,13 @@ EntityUpdateEvalCtx EntityUpdateEvalCtx_Clone(EntityUpdateEvalCtx ctx) {
 
 NodeCreateCtx NodeCreateCtx_Clone(NodeCreateCtx ctx) {
 	NodeCreateCtx clone = ctx;
-	if(ctx.properties) clone.properties = _PropertyMap_Clone(ctx.properties);
+	if(ctx.properties) clone.properties = PropertyMap_Clone(ctx.properties);
 	return clone;
 }
 
 EdgeCreateCtx EdgeCreateCtx_Clone(EdgeCreateCtx ctx) {
 	EdgeCreateCtx clone = ctx;
-	if(ctx.properties) clone.properties = _PropertyMap_Clone(ctx.properties);
+	if(ctx.properties) clone.properties = PropertyMap_Clone(ctx.properties);
 	return clone;
 }
 
@@ -84,6 +84,9 @@ AST_Operator AST_ConvertOperatorNode(const cypher_operator_t *op);
 // Convert a map of properties from the AST into a set of attribute ID keys and AR_ExpNode values.
 PropertyMap *PropertyMap_New(GraphContext *gc, const cypher_astnode_t *props);
 
+// Clone PropertyMap.
+PropertyMap *PropertyMap_Clone(PropertyMap *map);
+
 // Clone EntityUpdateEvalCtx.
 EntityUpdateEvalCtx EntityUpdateEvalCtx_Clone(EntityUpdateEvalCtx ctx);
 
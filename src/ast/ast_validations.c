@@ -1725,8 +1725,10 @@ AST_Validation AST_Validate_Query(const cypher_parse_result_t *result) {
 	const cypher_astnode_t *body = cypher_ast_statement_get_body(root);
 	cypher_astnode_type_t body_type = cypher_astnode_type(body);
 	if(body_type == CYPHER_AST_CREATE_NODE_PROPS_INDEX ||
-	   body_type == CYPHER_AST_DROP_NODE_PROPS_INDEX) {
-		// Index operation; validations are handled elsewhere.
+	   body_type == CYPHER_AST_DROP_NODE_PROPS_INDEX ||
+	   body_type == CYPHER_AST_CREATE_NODE_PROP_CONSTRAINT ||
+	   body_type == CYPHER_AST_DROP_NODE_PROP_CONSTRAINT) {
+		// Index or constraint operation; validations are handled elsewhere.
 		return AST_VALID;
 	}
 
@@ -7,31 +7,17 @@
 #include "bulk_insert.h"
 #include "RG.h"
 #include "../util/arr.h"
+#include "../util/qsort.h"
 #include "../util/rmalloc.h"
 #include "../schema/schema.h"
 #include "../datatypes/array.h"
 
-// The first byte of each property in the binary stream
-// is used to indicate the type of the subsequent SIValue
-typedef enum {
-	BI_NULL = 0,
-	BI_BOOL = 1,
-	BI_DOUBLE = 2,
-	BI_STRING = 3,
-	BI_LONG = 4,
-	BI_ARRAY = 5,
-} TYPE;
-
-// read the header of a data stream to parse its property keys
-// and update schemas
-static Attribute_ID *_BulkInsert_ReadHeader(GraphContext *gc, SchemaType t,
-											const char *data, size_t *data_idx,
-											int *label_id, uint *prop_count) {
-	ASSERT(gc != NULL);
+// read the header of a data stream to parse its entity name and property keys
+static void _BulkInsert_ReadHeader(const char *data, size_t *data_idx,
+								   BulkBlob *blob) {
 	ASSERT(data != NULL);
+	ASSERT(blob != NULL);
 	ASSERT(data_idx != NULL);
-	ASSERT(label_id != NULL);
-	ASSERT(prop_count != NULL);
 
 	/* binary header format:
 	 * - entity name : null-terminated C string
@@ -40,36 +26,26 @@ static Attribute_ID *_BulkInsert_ReadHeader(GraphContext *gc, SchemaType t,
 	 */
 
 	// first sequence is entity name
-	const char *name = data + *data_idx;
-	*data_idx += strlen(name) + 1;
-
-	Schema *schema = GraphContext_GetSchema(gc, name, t);
-	if(schema == NULL) schema = GraphContext_AddSchema(gc, name, t);
-	*label_id = schema->id;
+	blob->name = data + *data_idx;
+	*data_idx += strlen(blob->name) + 1;
 
 	// next 4 bytes are property count
-	*prop_count = *(uint *)&data[*data_idx];
+	uint prop_count = *(uint *)&data[*data_idx];
 	*data_idx += sizeof(unsigned int);
 
-	if(*prop_count == 0) return NULL;
-	Attribute_ID *prop_indices = rm_malloc(*prop_count * sizeof(Attribute_ID));
-
 	// the rest of the line is [char *prop_key] * prop_count
-	for(uint j = 0; j < *prop_count; j ++) {
-		char *prop_key = (char *)data + *data_idx;
+	blob->keys = array_new(const char *, prop_count);
+	for(uint j = 0; j < prop_count; j ++) {
+		const char *prop_key = data + *data_idx;
 		*data_idx += strlen(prop_key) + 1;
-
-		// add properties to schemas
-		prop_indices[j] = GraphContext_FindOrAddAttribute(gc, prop_key);
+		blob->keys = array_append(blob->keys, prop_key);
 	}
-
-	return prop_indices;
 }
 
 // Read an SIValue from the data stream and update the index appropriately
 static SIValue _BulkInsert_ReadProperty(const char *data, size_t *data_idx) {
 	/* Binary property format:
-	 * - property type : 1-byte integer corresponding to TYPE enum
+	 * - property type : 1-byte integer corresponding to BulkPropertyType enum
 	 * - Nothing if type is NULL
 	 * - 1-byte true/false if type is boolean
 	 * - 8-byte double if type is double
@@ -86,7 +62,7 @@ static SIValue _BulkInsert_ReadProperty(const char *data, size_t *data_idx) {
 	const char *s;
 
 	SIValue v = SI_NullVal();
-	TYPE t = data[*data_idx];
+	BulkPropertyType t = data[*data_idx];
 	*data_idx += 1;
 
 	switch(t) {
@@ -138,26 +114,66 @@ static SIValue _BulkInsert_ReadProperty(const char *data, size_t *data_idx) {
 	return v;
 }
 
-static int _BulkInsert_ProcessFile(GraphContext *gc, const char *data,
-								   size_t data_len, SchemaType type) {
+// a decoded edge, sorted by its endpoints
+typedef struct {
+	NodeID src;
+	NodeID dest;
+	EntityProperty *props;
+	int count;
+} _BulkEdge;
+
+#define BULK_EDGE_ISLT(a, b) \
+	((a)->src < (b)->src || ((a)->src == (b)->src && (a)->dest < (b)->dest))
+
+// order a blob's edges by source and destination, such that their connections
+// are merged into the relation matrices without sorting under the write lock
+static void _BulkInsert_SortEdges(BulkBlob *blob) {
+	uint n = array_len(blob->props);
+	NodeID *endpoints = blob->endpoints;
+
+	uint sorted = 1;
+	while(sorted < n) {
+		NodeID *prev = endpoints + (sorted - 1) * 2;
+		NodeID *curr = endpoints + sorted * 2;
+		if(curr[0] < prev[0] || (curr[0] == prev[0] && curr[1] < prev[1])) break;
+		sorted++;
+	}
+	if(sorted >= n) return;
+
+	_BulkEdge *edges = rm_malloc(sizeof(_BulkEdge) * n);
+	for(uint i = 0; i < n; i++) {
+		edges[i].src = endpoints[i * 2];
+		edges[i].dest = endpoints[i * 2 + 1];
+		edges[i].props = blob->props[i];
+		edges[i].count = blob->prop_counts[i];
+	}
+
+	QSORT(_BulkEdge, edges, n, BULK_EDGE_ISLT);
+
+	for(uint i = 0; i < n; i++) {
+		endpoints[i * 2] = edges[i].src;
+		endpoints[i * 2 + 1] = edges[i].dest;
+		blob->props[i] = edges[i].props;
+		blob->prop_counts[i] = edges[i].count;
+	}
+	rm_free(edges);
+}
 
-	int label_id;
-	uint prop_count;
+// decode a single binary blob into its entities' properties
+static void _BulkInsert_ParseBlob(const char *data, size_t data_len,
+								  SchemaType type, BulkBlob *blob) {
 	size_t data_idx = 0;
 
-	// read the CSV file header
-	// and commit all labels and properties it introduces
-	Attribute_ID *prop_indices = _BulkInsert_ReadHeader(gc, type, data,
-			&data_idx, &label_id, &prop_count);
+	blob->type = type;
+	blob->endpoints = (type == SCHEMA_EDGE) ? array_new(NodeID, 0) : NULL;
+	blob->props = array_new(EntityProperty *, 0);
+	blob->prop_counts = array_new(int, 0);
+
+	_BulkInsert_ReadHeader(data, &data_idx, blob);
+	uint prop_count = array_len(blob->keys);
 
 	while(data_idx < data_len) {
-		Node n;
-		Edge e;
-		GraphEntity *ge;
-		if(type == SCHEMA_NODE) {
-			Graph_CreateNode(gc->g, label_id, &n);
-			ge = (GraphEntity *)&n;
-		} else if(type == SCHEMA_EDGE) {
+		if(type == SCHEMA_EDGE) {
 			// next 8 bytes are source ID
 			NodeID src = *(NodeID *)&data[data_idx];
 			data_idx += sizeof(NodeID);
@@ -165,110 +181,224 @@ static int _BulkInsert_ProcessFile(GraphContext *gc, const char *data,
 			NodeID dest = *(NodeID *)&data[data_idx];
 			data_idx += sizeof(NodeID);
 
-			Graph_ConnectNodes(gc->g, src, dest, label_id, &e);
-			ge = (GraphEntity *)&e;
-		} else {
-			ASSERT(false);
+			blob->endpoints = array_append(blob->endpoints, src);
+			blob->endpoints = array_append(blob->endpoints, dest);
 		}
 
-		// process entity attributes
+		// properties are encoded ahead of the entity's creation
+		// identified by their key's position until committed
+		int count = 0;
+		EntityProperty *props = NULL;
+		if(prop_count > 0) props = rm_malloc(prop_count * sizeof(EntityProperty));
 		for(uint i = 0; i < prop_count; i++) {
 			SIValue value = _BulkInsert_ReadProperty(data, &data_idx);
 			// skip invalid attribute values
-			if(!(SI_TYPE(value) & SI_VALID_PROPERTY_VALUE)) continue;
-			GraphEntity_AddProperty(ge, prop_indices[i], value);
+			if(!(SI_TYPE(value) & SI_VALID_PROPERTY_VALUE)) {
+				SIValue_Free(value);
+				continue;
+			}
+			EntityProperty_Set(props + count, i, value);
+			count++;
+		}
+
+		blob->props = array_append(blob->props, props);
+		blob->prop_counts = array_append(blob->prop_counts, count);
+	}
+
+	if(type == SCHEMA_EDGE) _BulkInsert_SortEdges(blob);
+}
+
+static void _BulkInsert_CommitBlob(GraphContext *gc, BulkBlob *blob,
+								   BulkConnections **conns) {
+	SchemaType type = blob->type;
+
+	// commit the label or relationship type and properties the blob introduces
+	Schema *schema = GraphContext_GetSchema(gc, blob->name, type);
+	if(schema == NULL) schema = GraphContext_AddSchema(gc, blob->name, type);
+	int label_id = schema->id;
+	bool indexed = Schema_HasIndices(schema);
+
+	uint prop_count = array_len(blob->keys);
+	Attribute_ID *prop_indices = NULL;
+	if(prop_count > 0) {
+		prop_indices = rm_malloc(prop_count * sizeof(Attribute_ID));
+		for(uint j = 0; j < prop_count; j++) {
+			prop_indices[j] = GraphContext_FindOrAddAttribute(gc, blob->keys[j]);
+		}
+	}
+
+	// nodes are labeled at once, once the blob was processed
+	GrB_Index *node_ids = NULL;
+	if(type == SCHEMA_NODE) node_ids = array_new(GrB_Index, 0);
+
+	uint entity_count = array_len(blob->props);
+	for(uint i = 0; i < entity_count; i++) {
+		Node n;
+		Edge e;
+		GraphEntity *ge;
+		if(type == SCHEMA_NODE) {
+			Graph_CreateNode(gc->g, GRAPH_NO_LABEL, &n);
+			node_ids = array_append(node_ids, n.id);
+			ge = (GraphEntity *)&n;
+		} else if(type == SCHEMA_EDGE) {
+			NodeID src = blob->endpoints[i * 2];
+			NodeID dest = blob->endpoints[i * 2 + 1];
+
+			// connections are formed once all edge blobs were processed
+			Graph_CreateEdge(gc->g, src, dest, label_id, &e);
+			Graph_BufferConnection(conns, &e);
+			ge = (GraphEntity *)&e;
+		} else {
+			ASSERT(false);
 		}
+
+		// hand the entity its decoded properties
+		EntityProperty *props = blob->props[i];
+		int count = blob->prop_counts[i];
+		for(int j = 0; j < count; j++) props[j].id = prop_indices[props[j].id];
+		GraphEntity_AdoptProperties(ge, props, count);
+		blob->props[i] = NULL;
+
+		// appended entities are introduced to existing indices
+		if(!indexed) continue;
+		if(type == SCHEMA_NODE) Schema_AddNodeToIndices(schema, &n);
+		else Schema_AddEdgeToIndices(schema, &e);
+	}
+
+	if(node_ids) {
+		Graph_BulkLabelNodes(gc->g, label_id, node_ids, array_len(node_ids));
+		array_free(node_ids);
 	}
 
 	if(prop_indices) rm_free(prop_indices);
-	return BULK_OK;
 }
 
-static int _BulkInsert_ProcessTokens(GraphContext *gc, int token_count,
+static void _BulkInsert_ParseTokens(BulkBatch *batch, int token_count,
 		RedisModuleString **argv, SchemaType type) {
 	for(int i = 0; i < token_count; i ++) {
 		size_t len;
 		// retrieve a pointer to the next binary stream and record its length
 		const char *data = RedisModule_StringPtrLen(argv[i], &len);
-		int rc = _BulkInsert_ProcessFile(gc, data, len, type);
-		UNUSED(rc);
-		ASSERT(rc == BULK_OK);
+		BulkBlob blob;
+		_BulkInsert_ParseBlob(data, len, type, &blob);
+		batch->blobs = array_append(batch->blobs, blob);
 	}
-
-	return BULK_OK;
 }
 
-int BulkInsert(RedisModuleCtx *ctx, GraphContext *gc, RedisModuleString **argv,
-			   int argc, uint node_count, uint edge_count) {
-
-	ASSERT(ctx != NULL);
-	ASSERT(gc != NULL);
+BulkBatch *BulkInsert_Parse(RedisModuleString **argv, int argc,
+		const char **err) {
+	ASSERT(err != NULL);
 	ASSERT(argv != NULL);
 
 	if(argc < 2) {
-		RedisModule_ReplyWithError(ctx, "Bulk insert format error, \
-				failed to parse bulk insert sections.");
-		return BULK_FAIL;
+		*err = "Bulk insert format error, \
+				failed to parse bulk insert sections.";
+		return NULL;
 	}
 
-	Graph *g = gc->g;
-	int res = BULK_OK;
-
-	// lock graph under write lock
-	// allocate space for new nodes and edges
-	Graph_AcquireWriteLock(g);
-	Graph_AllocateNodes(g, node_count);
-	Graph_AllocateEdges(g, edge_count);
-
 	// read the number of node tokens
 	long long node_token_count;
 	long long relation_token_count;
 
 	if(RedisModule_StringToLongLong(*argv++, &node_token_count)  != REDISMODULE_OK) {
-		RedisModule_ReplyWithError(ctx, "Error parsing number of node \
-				descriptor tokens.");
-		res = BULK_FAIL;
-		goto cleanup;
+		*err = "Error parsing number of node \
+				descriptor tokens.";
+		return NULL;
 	}
 
 	// read the number of relation tokens
 	if(RedisModule_StringToLongLong(*argv++, &relation_token_count)  != REDISMODULE_OK) {
-		RedisModule_ReplyWithError(ctx, "Error parsing number of relation \
-				descriptor tokens.");
-		res = BULK_FAIL;
-		goto cleanup;
+		*err = "Error parsing number of relation \
+				descriptor tokens.";
+		return NULL;
 	}
 
 	argc -= 2;
 
+	BulkBatch *batch = rm_malloc(sizeof(BulkBatch));
+	batch->blobs = array_new(BulkBlob, node_token_count + relation_token_count);
+
 	if(node_token_count > 0) {
 		ASSERT(argc >= node_token_count);
-		// process all node files
-		if(_BulkInsert_ProcessTokens(gc, node_token_count, argv,
-					SCHEMA_NODE) != BULK_OK) {
-			res = BULK_FAIL;
-			goto cleanup;
-		}
+		// decode all node files
+		_BulkInsert_ParseTokens(batch, node_token_count, argv, SCHEMA_NODE);
 		argv += node_token_count;
 		argc -= node_token_count;
 	}
 
 	if(relation_token_count > 0) {
 		ASSERT(argc >= relation_token_count);
-		// Process all relationship files
-		if(_BulkInsert_ProcessTokens(gc, relation_token_count, argv,
-					SCHEMA_EDGE) != BULK_OK) {
-			res = BULK_FAIL;
-			goto cleanup;
-		}
+		// decode all relationship files
+		_BulkInsert_ParseTokens(batch, relation_token_count, argv, SCHEMA_EDGE);
 		argv += relation_token_count;
 		argc -= relation_token_count;
 	}
 
 	ASSERT(argc == 0);
 
-cleanup:
+	return batch;
+}
+
+int BulkInsert_Commit(GraphContext *gc, BulkBatch *batch, uint node_count,
+		uint edge_count) {
+	ASSERT(gc != NULL);
+	ASSERT(batch != NULL);
+
+	Graph *g = gc->g;
+	BulkConnections *conns = NULL;
+
+	// lock graph under write lock
+	// allocate space for new nodes and edges
+	Graph_AcquireWriteLock(g);
+	Graph_AllocateNodes(g, node_count);
+	Graph_AllocateEdges(g, edge_count);
+
+	// node blobs precede edge blobs
+	uint blob_count = array_len(batch->blobs);
+	for(uint i = 0; i < blob_count; i++) {
+		BulkBlob *blob = batch->blobs + i;
+		if(blob->type == SCHEMA_EDGE && conns == NULL) {
+			conns = array_new(BulkConnections, 1);
+		}
+		_BulkInsert_CommitBlob(gc, blob, &conns);
+	}
+
+	if(conns) {
+		Graph_BulkConnect(g, conns);
+		array_free(conns);
+	}
+
+	// fold new entries into the graph's matrices while still holding the
+	// write lock, sparing readers from flushing them
+	Graph_FlushAllPending(g);
+	GraphContext_DropColumns(gc);
+	GraphContext_RefreshStatistics(gc);
 	Graph_ReleaseLock(g);
-	return res;
+	return BULK_OK;
 }
 
+void BulkInsert_FreeBatch(BulkBatch *batch) {
+	ASSERT(batch != NULL);
+
+	uint blob_count = array_len(batch->blobs);
+	for(uint i = 0; i < blob_count; i++) {
+		BulkBlob *blob = batch->blobs + i;
+		// properties which weren't committed are still owned by the blob
+		uint entity_count = array_len(blob->props);
+		for(uint j = 0; j < entity_count; j++) {
+			EntityProperty *props = blob->props[j];
+			if(props == NULL) continue;
+			for(int k = 0; k < blob->prop_counts[j]; k++) {
+				EntityProperty_Free(props + k);
+			}
+			rm_free(props);
+		}
+		array_free(blob->keys);
+		array_free(blob->props);
+		array_free(blob->prop_counts);
+		if(blob->endpoints) array_free(blob->endpoints);
+	}
+
+	array_free(batch->blobs);
+	rm_free(batch);
+}
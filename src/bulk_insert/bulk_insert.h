@@ -14,21 +14,63 @@
 #define BULK_OK 1
 #define BULK_FAIL 0
 
+// The first byte of each property in the binary stream
+// is used to indicate the type of the subsequent SIValue
+typedef enum {
+	BI_NULL = 0,
+	BI_BOOL = 1,
+	BI_DOUBLE = 2,
+	BI_STRING = 3,
+	BI_LONG = 4,
+	BI_ARRAY = 5,
+} BulkPropertyType;
+
 /*
  * Bulk insert performs fast insertion of large amount of data,
  * it's an alternative to Cypher's CREATE query, one should prefer using
  * bulk insert over CREATE queries when constructing a fairly large
- * (thousands of entities) new graph. */
+ * (thousands of entities) new graph.
+ *
+ * A batch is processed in two stages, its binary blobs are first decoded
+ * without accessing the graph, such that a batch can be decoded while its
+ * predecessor is committed, the decoded entities are then committed under
+ * the graph's write lock. */
 
-/* Parse bulk insert format and inserts new entities */
-int BulkInsert(
-	RedisModuleCtx *ctx,        // Redis thread-safe context.
-	GraphContext *gc,           // GraphContext hosting schemas and Graph.
+// entities decoded from a single binary blob
+typedef struct {
+	SchemaType type;          // nodes or edges
+	const char *name;         // label or relationship type
+	const char **keys;        // property keys
+	NodeID *endpoints;        // edges' source and destination, pairwise
+	EntityProperty **props;   // entities' properties, IDs index into keys
+	int *prop_counts;         // number of properties of each entity
+} BulkBlob;
+
+// a decoded bulk insert batch
+typedef struct {
+	BulkBlob *blobs;          // node blobs followed by edge blobs
+} BulkBatch;
+
+/* Decodes the binary blobs of a batch, requires no locks
+ * returns NULL and sets err if the batch is malformed. */
+BulkBatch *BulkInsert_Parse(
 	RedisModuleString **argv,   // Arguments passed to bulk insert command.
 	int argc,                   // Number of elements in argv.
+	const char **err            // [output] Reason the batch is malformed.
+);
+
+/* Inserts a decoded batch's entities into the graph. */
+int BulkInsert_Commit(
+	GraphContext *gc,           // GraphContext hosting schemas and Graph.
+	BulkBatch *batch,           // Decoded batch, its entities are consumed.
 	uint node_count,            // Number of nodes to be created.
 	uint edge_count             // Number of edges to be created.
 );
 
+/* Frees a decoded batch. */
+void BulkInsert_FreeBatch(
+	BulkBatch *batch            // Batch to free.
+);
+
 #endif
 
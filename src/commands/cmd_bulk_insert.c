@@ -7,40 +7,68 @@
 #include "cmd_bulk_insert.h"
 #include "../query_ctx.h"
 #include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../metrics/metrics.h"
 #include "../util/thpool/pools.h"
 #include "../bulk_insert/bulk_insert.h"
+#include <pthread.h>
 
 // bulk-insert context object
 typedef struct {
 	int argc;                      // number of arguments
 	RedisModuleString **argv;      // arguments
 	RedisModuleBlockedClient *bc;  // blocked client
+	uint64_t ticket;               // position among received bulk commands
 } BulkCtx;
 
-// process "BEGIN" token, expected to be present only on first bulk-insert
-// batch, make sure graph key doesn't exists, fails if "BEGIN" token is present
-// and graph key 'graphname' already exists
-static int _Graph_Bulk_Begin(RedisModuleCtx *ctx, RedisModuleString ***argv,
-							  int *argc, RedisModuleString *rs_graph_name, const char *graphname,
-							  bool *begin) {
+// batches are decoded concurrently by the bulk loader threads, yet committed
+// in the order they were received, a client may therefore send its next batch
+// ahead of the current batch's reply, having it decoded while its predecessor
+// is committed
+static pthread_mutex_t _bulk_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _bulk_turn = PTHREAD_COND_INITIALIZER;
+static uint64_t _bulk_received = 0;   // number of received batches
+static uint64_t _bulk_committed = 0;  // number of batches done committing
+
+// wait for all batches received before 'ticket' to commit
+static void _Graph_Bulk_AwaitTurn(uint64_t ticket) {
+	pthread_mutex_lock(&_bulk_lock);
+	while(_bulk_committed != ticket) pthread_cond_wait(&_bulk_turn, &_bulk_lock);
+	pthread_mutex_unlock(&_bulk_lock);
+}
+
+// hand the turn over to the next batch
+static void _Graph_Bulk_EndTurn(void) {
+	pthread_mutex_lock(&_bulk_lock);
+	_bulk_committed++;
+	pthread_cond_broadcast(&_bulk_turn);
+	pthread_mutex_unlock(&_bulk_lock);
+}
+
+// skip "BEGIN" token, expected to be present only on first bulk-insert batch
+static bool _Graph_Bulk_BeginToken(RedisModuleString ***argv, int *argc) {
 	ASSERT(argv != NULL);
 	ASSERT(argc != NULL);
-	ASSERT(begin != NULL);
-	ASSERT(graphname != NULL);
-	ASSERT(rs_graph_name != NULL);
-
-	*begin = false; // default to false
 
 	// do nothing if this is not the first BULK call
-	if(strcmp(RedisModule_StringPtrLen(**argv, 0), "BEGIN")) return BULK_OK;
-
-	// "BEGIN" token present
-	*begin = true;
+	if(*argc == 0 || strcmp(RedisModule_StringPtrLen(**argv, 0), "BEGIN")) {
+		return false;
+	}
 
 	// skip "BEGIN" token
 	(*argv) ++;
 	(*argc) --;
 
+	return true;
+}
+
+// process "BEGIN" token, make sure graph key doesn't exists,
+// fails if graph key 'graphname' already exists
+static int _Graph_Bulk_Begin(RedisModuleCtx *ctx, RedisModuleString *rs_graph_name,
+		const char *graphname) {
+	ASSERT(graphname != NULL);
+	ASSERT(rs_graph_name != NULL);
+
 	// lock GIL, verify that graph does not already exist
 	RedisModuleKey *key = NULL;
 	RedisModule_ThreadSafeContextLock(ctx);
@@ -68,9 +96,13 @@ static void _Graph_BulkInsert(void *args) {
 	ASSERT(args != NULL);
 
 	GraphContext *gc     = NULL;
+	BulkBatch *batch     = NULL;
 	BulkCtx *bulk_ctx    = (BulkCtx *)args;
+	double timer[2];
 	long long node_count = 0;  // number of declared nodes
 	long long edge_count = 0;  // number of declared edges
+	const char *count_err = NULL;  // failed to read declared counts
+	const char *batch_err = NULL;  // malformed batch
 
 	// unpack arguments
 	int argc                      = bulk_ctx->argc;
@@ -78,15 +110,34 @@ static void _Graph_BulkInsert(void *args) {
 	RedisModuleBlockedClient *bc  = bulk_ctx->bc;
 	RedisModuleCtx *ctx           = RedisModule_GetThreadSafeContext(bc);
 
+	simple_tic(timer);
+
 	// get graph name
 	argv += 1; // skip "GRAPH.BULK"
 	RedisModuleString *rs_graph_name = *argv++;
 	const char *graphname = RedisModule_StringPtrLen(rs_graph_name, NULL);
 	argc -= 2; // skip "GRAPH.BULK [GRAPHNAME]"
 
-	bool begin = false;
-	if(_Graph_Bulk_Begin(ctx, &argv, &argc, rs_graph_name, graphname, &begin)
-	   != BULK_OK) goto cleanup;
+	bool begin = _Graph_Bulk_BeginToken(&argv, &argc);
+
+	// read the user-provided counts for nodes and edges in the current query
+	if(argc < 1 || RedisModule_StringToLongLong(*argv++, &node_count) != REDISMODULE_OK) {
+		count_err = "Error parsing node count.";
+	} else if(argc < 2 || RedisModule_StringToLongLong(*argv++, &edge_count) != REDISMODULE_OK) {
+		count_err = "Error parsing relation count.";
+	} else {
+		argc -= 2; // already read node count and edge count
+
+		// decode the batch ahead of preceding batches' commit
+		batch = BulkInsert_Parse(argv, argc, &batch_err);
+	}
+
+	// errors are reported in the order the batch's arguments are validated
+	_Graph_Bulk_AwaitTurn(bulk_ctx->ticket);
+
+	if(begin && _Graph_Bulk_Begin(ctx, rs_graph_name, graphname) != BULK_OK) {
+		goto cleanup;
+	}
 
 	// create key only if "BEGIN" token present
 	RedisModule_ThreadSafeContextLock(ctx);
@@ -100,23 +151,14 @@ static void _Graph_BulkInsert(void *args) {
 	}
 	RedisModule_ThreadSafeContextUnlock(ctx);
 
-	// read the user-provided counts for nodes and edges in the current query
-	if(RedisModule_StringToLongLong(*argv++, &node_count) != REDISMODULE_OK) {
-		RedisModule_ReplyWithError(ctx, "Error parsing node count.");
-		goto cleanup;
-	}
-
-	if(RedisModule_StringToLongLong(*argv++, &edge_count) != REDISMODULE_OK) {
-		RedisModule_ReplyWithError(ctx, "Error parsing relation count.");
+	if(count_err) {
+		RedisModule_ReplyWithError(ctx, count_err);
 		goto cleanup;
 	}
 
-	argc -= 2; // already read node count and edge count
-
-	int rc = BulkInsert(ctx, gc, argv, argc, node_count, edge_count);
-
-	if(rc == BULK_FAIL) {
+	if(batch_err) {
 		// if insertion failed, clean up keyspace and free added entities
+		RedisModule_ReplyWithError(ctx, batch_err);
 		RedisModuleKey *key = NULL;
 
 		RedisModule_ThreadSafeContextLock(ctx);
@@ -131,6 +173,13 @@ static void _Graph_BulkInsert(void *args) {
 		goto cleanup;
 	}
 
+	// inserted properties are interned into the graph's string pool
+	QueryCtx_SetGraphCtx(gc);
+
+	int rc = BulkInsert_Commit(gc, batch, node_count, edge_count);
+	UNUSED(rc);
+	ASSERT(rc == BULK_OK);
+
 	// successful bulk commands should always modify slaves
 	RedisModule_ReplicateVerbatim(ctx);
 
@@ -140,7 +189,12 @@ static void _Graph_BulkInsert(void *args) {
 					   node_count, edge_count);
 	RedisModule_ReplyWithStringBuffer(ctx, reply, len);
 
+	Metrics_RecordLatency(GraphContext_GetMetrics(gc), METRICS_CMD_BULK,
+			simple_toc(timer) * 1000);
+
 cleanup:
+	_Graph_Bulk_EndTurn();
+
 	// restore argc and argv
 	argc = bulk_ctx->argc;
 	argv = bulk_ctx->argv;
@@ -148,6 +202,7 @@ cleanup:
 	// free retained strings
 	for(int i = 0; i < argc; i++) RedisModule_FreeString(ctx, argv[i]);
 
+	if(batch) BulkInsert_FreeBatch(batch);
 	QueryCtx_Free();
 	rm_free(bulk_ctx);
 	if(gc) GraphContext_Release(gc);
@@ -166,6 +221,7 @@ int Graph_BulkInsert(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 	bulk_ctx->bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
 	bulk_ctx->argv = argv;
 	bulk_ctx->argc = argc;
+	bulk_ctx->ticket = _bulk_received++;
 
 	// invoke bulk-insert on a bulk worker thread
 	ThreadPools_AddWorkBulkLoader(_Graph_BulkInsert, bulk_ctx);
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../util/cache/cache.h"
+#include "../graph/graphcontext.h"
+
+// GRAPH.CACHE <graph>
+// replies with the graph's execution plan cache statistics
+int Graph_Cache(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 2) return RedisModule_WrongArity(ctx);
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	CacheStats stats = Cache_GetStats(GraphContext_GetCache(gc));
+	GraphContext_Release(gc);
+
+	RedisModule_ReplyWithArray(ctx, 8);
+	RedisModule_ReplyWithSimpleString(ctx, "size");
+	RedisModule_ReplyWithLongLong(ctx, stats.size);
+	RedisModule_ReplyWithSimpleString(ctx, "capacity");
+	RedisModule_ReplyWithLongLong(ctx, stats.cap);
+	RedisModule_ReplyWithSimpleString(ctx, "hits");
+	RedisModule_ReplyWithLongLong(ctx, stats.hits);
+	RedisModule_ReplyWithSimpleString(ctx, "misses");
+	RedisModule_ReplyWithLongLong(ctx, stats.misses);
+
+	return REDISMODULE_OK;
+}
+
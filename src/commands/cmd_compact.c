@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+
+// compaction context object
+typedef struct {
+	GraphContext *gc;              // graph to compact
+	RedisModuleBlockedClient *bc;  // blocked client
+} CompactCtx;
+
+// defragments the graph's entity storage on the graph's writer thread
+static void _Graph_Compact(void *args) {
+	ASSERT(args != NULL);
+
+	CompactCtx *compact_ctx = (CompactCtx *)args;
+	GraphContext *gc = compact_ctx->gc;
+	RedisModuleBlockedClient *bc = compact_ctx->bc;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(bc);
+
+	// acquiring the write lock invalidates open cursors
+	Graph_WriterEnter(gc->g);
+	Graph_AcquireWriteLock(gc->g);
+	size_t released = Graph_CompactEntities(gc->g);
+	Graph_ReleaseLock(gc->g);
+
+	// compaction determines the order in which deleted IDs are reused,
+	// replicas must compact as well to assign the same IDs
+	// replicated ahead of the next writer's commit, which may reuse them
+	RedisModule_ThreadSafeContextLock(ctx);
+	RedisModule_Replicate(ctx, "GRAPH.COMPACT", "c", gc->graph_name);
+	RedisModule_ThreadSafeContextUnlock(ctx);
+	Graph_WriterLeave(gc->g);
+
+	char reply[1024];
+	int len = snprintf(reply, 1024, "Graph compacted, %zu bytes released", released);
+	RedisModule_ReplyWithStringBuffer(ctx, reply, len);
+
+	GraphContext_Release(gc);
+	rm_free(compact_ctx);
+	RedisModule_FreeThreadSafeContext(ctx);
+	RedisModule_UnblockClient(bc, NULL);
+}
+
+// GRAPH.COMPACT <graph>
+// releases storage held by deleted nodes and relationships
+int Graph_Compact(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 2) return RedisModule_WrongArity(ctx);
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], false, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	CompactCtx *compact_ctx = rm_malloc(sizeof(CompactCtx));
+	compact_ctx->gc = gc;
+	compact_ctx->bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+
+	// serialize compaction with the graph's write queries
+	ThreadPools_AddWorkWriter(_Graph_Compact, compact_ctx, gc->graph_name);
+
+	return REDISMODULE_OK;
+}
@@ -5,6 +5,7 @@
  */
 
 #include "../config.h"
+#include "../util/thpool/pools.h"
 #include <string.h>
 
 void _Config_get_all(RedisModuleCtx *ctx) {
@@ -87,6 +88,12 @@ void _Config_set(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 	RedisModuleString *value = argv[3];
 
 	if(Config_Option_set(config_field, value)) {
+		// resize the reader thread pool right away
+		if(config_field == Config_THREAD_POOL_SIZE) {
+			uint reader_count;
+			Config_Option_get(Config_THREAD_POOL_SIZE, &reader_count);
+			ThreadPools_SetReaderCount(reader_count);
+		}
 		RedisModule_ReplyWithSimpleString(ctx, "OK");
 	} else {
 		RedisModule_ReplyWithError(ctx, "Failed to set config value");
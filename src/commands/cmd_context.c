@@ -7,15 +7,25 @@
 #include "cmd_context.h"
 #include "RG.h"
 #include "../query_ctx.h"
+#include "../util/arr.h"
 #include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
 #include "../util/thpool/pools.h"
 #include "../slow_log/slow_log.h"
+#include <time.h>
 
 /* Array with one entry per worker thread
  * keeps track after currently executing commands
  * initialized at module.c accessed via cmd_* and debug.c */
 CommandCtx **command_ctxs = NULL;
 
+// returns the CPU time consumed by the calling thread, in milliseconds
+static double _ThreadCPUTime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
 CommandCtx *CommandCtx_New
 (
 	RedisModuleCtx *ctx,
@@ -26,15 +36,29 @@ CommandCtx *CommandCtx_New
 	ExecutorThread thread,
 	bool replicated_command,
 	bool compact,
-	long long timeout
+	bool binary,
+	long long timeout,
+	long long cursor_count
 ) {
 	CommandCtx *context = rm_malloc(sizeof(CommandCtx));
 	context->bc = bc;
 	context->ctx = ctx;
 	context->query = NULL;
+	context->batch = NULL;
+	context->statement = NULL;
+	context->params = NULL;
 	context->thread = thread;
+	context->binary = binary;
 	context->compact = compact;
 	context->timeout = timeout;
+	context->cursor_count = cursor_count;
+	context->result_cache = RESULT_CACHE_DEFAULT;
+	context->sample_rate = 1;
+	context->queue_wait = 0;
+	context->quota = false;
+	context->cpu_mark = -1;
+	context->cpu_time = 0;
+	simple_tic(context->queue_timer);
 	context->command_name = NULL;
 	context->graph_ctx = graph_ctx;
 	context->replicated_command = replicated_command;
@@ -54,6 +78,18 @@ CommandCtx *CommandCtx_New
 	return context;
 }
 
+void CommandCtx_SetBatch(CommandCtx *command_ctx, RedisModuleString **queries,
+		int count) {
+	ASSERT(command_ctx != NULL);
+	ASSERT(command_ctx->batch == NULL);
+
+	command_ctx->batch = array_new(char *, count);
+	for(int i = 0; i < count; i++) {
+		const char *q = RedisModule_StringPtrLen(queries[i], NULL);
+		array_append(command_ctx->batch, rm_strdup(q));
+	}
+}
+
 // place given 'ctx' in 'command_ctxs' at position 'tid'
 // representing the current thread
 void CommandCtx_TrackCtx(CommandCtx *ctx) {
@@ -112,6 +148,38 @@ const char *CommandCtx_GetQuery(const CommandCtx *command_ctx) {
 	return command_ctx->query;
 }
 
+void CommandCtx_MarkQueued(CommandCtx *command_ctx) {
+	ASSERT(command_ctx != NULL);
+	simple_tic(command_ctx->queue_timer);
+
+	// CPU time is accounted per thread, up to leaving the thread
+	if(command_ctx->cpu_mark >= 0) {
+		command_ctx->cpu_time += _ThreadCPUTime() - command_ctx->cpu_mark;
+		command_ctx->cpu_mark = -1;
+	}
+}
+
+void CommandCtx_MarkDequeued(CommandCtx *command_ctx) {
+	ASSERT(command_ctx != NULL);
+	command_ctx->queue_wait += simple_toc(command_ctx->queue_timer) * 1000;
+	command_ctx->cpu_mark = _ThreadCPUTime();
+}
+
+void CommandCtx_HoldQuota(CommandCtx *command_ctx) {
+	ASSERT(command_ctx != NULL);
+	ASSERT(!command_ctx->quota);
+
+	// the graph is released after the command it runs, retain it
+	// such that the quota outlives the command
+	GraphContext_Retain(command_ctx->graph_ctx);
+	command_ctx->quota = true;
+}
+
+double CommandCtx_GetQueueWait(const CommandCtx *command_ctx) {
+	ASSERT(command_ctx != NULL);
+	return command_ctx->queue_wait;
+}
+
 void CommandCtx_ThreadSafeContextLock(const CommandCtx *command_ctx) {
 	/* Acquire lock only when working with a blocked client
 	 * otherwise we're running on Redis main thread,
@@ -138,7 +206,23 @@ void CommandCtx_Free(CommandCtx *command_ctx) {
 
 	CommandCtx_UntrackCtx(command_ctx);
 
+	if(command_ctx->quota) {
+		GraphContext *gc = command_ctx->graph_ctx;
+		if(command_ctx->cpu_mark >= 0) {
+			command_ctx->cpu_time += _ThreadCPUTime() - command_ctx->cpu_mark;
+		}
+		QueryQuota_Release(&gc->quota, command_ctx->cpu_time);
+		GraphContext_Release(gc);
+	}
+
 	if(command_ctx->query) rm_free(command_ctx->query);
+	if(command_ctx->statement) PreparedStatement_Release(command_ctx->statement);
+	if(command_ctx->params) PreparedStatement_FreeParams(command_ctx->params);
+	if(command_ctx->batch) {
+		uint count = array_len(command_ctx->batch);
+		for(uint i = 0; i < count; i++) rm_free(command_ctx->batch[i]);
+		array_free(command_ctx->batch);
+	}
 	rm_free(command_ctx->command_name);
 	rm_free(command_ctx);
 }
@@ -8,6 +8,7 @@
 
 #include "cypher-parser.h"
 #include "../redismodule.h"
+#include "prepared_statement.h"
 #include "../graph/graphcontext.h"
 
 // ExecutorThread lists the diffrent types of threads in the system
@@ -17,17 +18,36 @@ typedef enum {
 	EXEC_THREAD_WRITER,  // write only thread
 } ExecutorThread;
 
+// ResultCachePolicy lists the ways a query may use the result cache
+typedef enum {
+	RESULT_CACHE_DEFAULT,  // cached unless RESULT_CACHE_OPT_IN is set
+	RESULT_CACHE_ON,       // cached, issued with the --cache flag
+	RESULT_CACHE_OFF,      // never cached, issued with the --no-cache flag
+} ResultCachePolicy;
+
 /* Query context, used for concurent query processing. */
 typedef struct {
 	char *query;                    // Query string.
+	char **batch;                   // Queries of a batched command, NULL otherwise.
+	PreparedStatement *statement;   // Acquired prepared statement to execute, if any.
+	rax *params;                    // Parameters bound to the prepared statement.
 	RedisModuleCtx *ctx;            // Redis module context.
 	char *command_name;             // Command to execute.
 	GraphContext *graph_ctx;        // Graph context.
 	RedisModuleBlockedClient *bc;   // Blocked client.
 	bool replicated_command;        // Whether this instance was spawned by a replication command.
 	bool compact;                   // Whether this query was issued with the compact flag.
+	bool binary;                    // Whether this query was issued with the binary flag.
 	ExecutorThread thread;          // Which thread executes this command
 	long long timeout;              // The query timeout, if specified.
+	long long cursor_count;         // Rows per cursor batch, 0 if no cursor was requested.
+	ResultCachePolicy result_cache; // Whether the query's reply may be served by the result cache.
+	double sample_rate;             // Fraction of the graph scanned, 1 unless sampled.
+	double queue_timer[2];          // Tracks time spent waiting in a thread pool queue.
+	double queue_wait;              // Total time spent queued, in milliseconds.
+	bool quota;                     // Whether the command was admitted by its graph's quota.
+	double cpu_mark;                // Thread CPU time as the command was picked up, negative while queued.
+	double cpu_time;                // Total CPU time consumed, in milliseconds.
 } CommandCtx;
 
 // Create a new command context.
@@ -41,7 +61,17 @@ CommandCtx *CommandCtx_New
 	ExecutorThread thread,          // Which thread executes this command
 	bool replicated_command,        // Whether this instance was spawned by a replication command.
 	bool compact,                   // Whether this query was issued with the compact flag.
-	long long timeout               // The query timeout, if specified.
+	bool binary,                    // Whether this query was issued with the binary flag.
+	long long timeout,              // The query timeout, if specified.
+	long long cursor_count          // Rows per cursor batch, 0 for no cursor.
+);
+
+// Sets the queries of a batched command, executed one after the other.
+void CommandCtx_SetBatch
+(
+	CommandCtx *command_ctx,        // Command context.
+	RedisModuleString **queries,    // Query strings.
+	int count                       // Number of queries.
 );
 
 // Tracks given 'ctx' such that in case of a crash we will be able to report
@@ -80,6 +110,32 @@ const char *CommandCtx_GetQuery
 	const CommandCtx *command_ctx
 );
 
+// Marks the command as waiting in a thread pool queue.
+void CommandCtx_MarkQueued
+(
+	CommandCtx *command_ctx
+);
+
+// Marks the command as picked up by an executing thread,
+// accumulating the time it spent queued.
+void CommandCtx_MarkDequeued
+(
+	CommandCtx *command_ctx
+);
+
+// Holds the graph's quota the command was admitted by, see QueryQuota_Admit
+// the quota is released once the command is freed, along with the CPU time it consumed.
+void CommandCtx_HoldQuota
+(
+	CommandCtx *command_ctx
+);
+
+// Get total time the command spent queued, in milliseconds.
+double CommandCtx_GetQueueWait
+(
+	const CommandCtx *command_ctx
+);
+
 // Acquire Redis global lock.
 void CommandCtx_ThreadSafeContextLock
 (
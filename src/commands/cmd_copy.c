@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../graph/graphcontext.h"
+#include "../serializers/serializer_io.h"
+#include "../serializers/encoder/encode_graph.h"
+#include "../serializers/decoders/decode_graph.h"
+
+extern RedisModuleType *GraphContextRedisModuleType;
+
+// GRAPH.COPY <src> <dst>
+// copies graph src into the new key dst
+// each of src's keys is encoded into memory under dst's name and decoded
+// right away, the way GRAPH.RESTORE loads a graph, skipping the RDB altogether
+int Graph_Copy(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 3) return RedisModule_WrongArity(ctx);
+
+	const char *dst_name = RedisModule_StringPtrLen(argv[2], NULL);
+
+	GraphContext *src = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if GraphContext is null, key access failed and an error been emitted
+	if(!src) return REDISMODULE_OK;
+
+	RedisModuleKey *key = RedisModule_OpenKey(ctx, argv[2], REDISMODULE_WRITE);
+	if(RedisModule_KeyType(key) != REDISMODULE_KEYTYPE_EMPTY ||
+	   GraphContext_GetRegisteredGraphContext(dst_name) != NULL) {
+		RedisModule_CloseKey(key);
+		GraphContext_Release(src);
+		RedisModule_ReplyWithError(ctx, "ERR Destination graph already exists");
+		return REDISMODULE_OK;
+	}
+
+	EncodeBuffer buf;
+	EncodeBuffer_Init(&buf);
+	SerializerIO encode_io;
+	SerializerIO_FromBuffer(&encode_io, &buf);
+
+	uint64_t key_count = GraphEncodeContext_GetKeyCount(src->encoding_context);
+	for(uint64_t i = 0; i < key_count; i++) {
+		EncodeGraphAs(&encode_io, src, dst_name);
+
+		SerializerIO decode_io;
+		SerializerIO_FromData(&decode_io, buf.data, buf.len);
+		GraphContext *gc = DecodeGraph(&decode_io);
+		// the encoding is produced in-process, it always decodes
+		ASSERT(!SerializerIO_Failed(&decode_io));
+
+		if(i == 0) {
+			// first key of the graph
+			RedisModule_ModuleTypeSetValue(key, GraphContextRedisModuleType, gc);
+			GraphContext_RegisterWithModule(gc);
+		}
+		buf.len = 0;
+	}
+
+	EncodeBuffer_Free(&buf);
+	RedisModule_CloseKey(key);
+	GraphContext_Release(src);
+
+	RedisModule_ReplicateVerbatim(ctx);
+	RedisModule_ReplyWithSimpleString(ctx, "OK");
+	return REDISMODULE_OK;
+}
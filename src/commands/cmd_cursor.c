@@ -0,0 +1,185 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../errors.h"
+#include "cmd_context.h"
+#include "query_cursor.h"
+#include "../query_ctx.h"
+#include "../graph/graph.h"
+#include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../util/thpool/pools.h"
+#include "../metrics/metrics.h"
+
+// arguments of a cursor read job
+typedef struct {
+	CommandCtx *command_ctx;  // command context
+	QueryCursor *cursor;      // acquired cursor
+} CursorReadCtx;
+
+// resumes the cursor's execution plan, replying with its next batch
+static void _Cursor_Read(void *args) {
+	CursorReadCtx   *read_ctx     =  args;
+	CommandCtx      *command_ctx  =  read_ctx->command_ctx;
+	QueryCursor     *cursor       =  read_ctx->cursor;
+	GraphContext    *gc           =  CommandCtx_GetGraphContext(command_ctx);
+	ExecutionPlan   *plan         =  cursor->exec_ctx->plan;
+	rm_free(read_ctx);
+
+	CommandCtx_TrackCtx(command_ctx);
+	CommandCtx_MarkDequeued(command_ctx);
+	QueryCursor_Resume(cursor);
+	QueryCtx_SetGlobalExecutionCtx(command_ctx);
+	QueryCtx_BeginTimer(); // time this batch only
+
+	// reply to the client issuing this read
+	cursor->result_set->ctx = CommandCtx_GetRedisCtx(command_ctx);
+
+	double timer[2];
+	simple_tic(timer);
+	Graph_AcquireReadLock(gc->g);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, simple_toc(timer) * 1000);
+	Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
+
+	bool depleted = true;
+	if(Graph_WriteEpoch(gc->g) != cursor->write_epoch) {
+		// iterators held by the plan might have been invalidated
+		ErrorCtx_SetError("Cursor invalidated by a concurrent write");
+	} else {
+		QueryCtx_BeginExecution();
+		depleted = ExecutionPlan_ExecuteStep(plan, command_ctx->cursor_count);
+		QueryCtx_EndExecution();
+		if(ExecutionPlan_Drained(plan)) {
+			ErrorCtx_SetError("Query timed out");
+			Metrics_QueryTimedOut();
+		}
+	}
+
+	QueryCtx_AddPhaseTime(QUERY_PHASE_QUEUE, CommandCtx_GetQueueWait(command_ctx));
+	simple_tic(timer);
+	ResultSet_ReplyWithCursor(cursor->result_set, (depleted) ? 0 : cursor->id);
+	double reply_time = simple_toc(timer);
+
+	Graph_ReleaseLock(gc->g);
+
+	// the serialized reply doesn't reference the graph
+	// hand it over once the lock is released
+	simple_tic(timer);
+	ResultSet_Flush(cursor->result_set);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_REPLY, (reply_time + simple_toc(timer)) * 1000);
+
+	// log batch to slowlog
+	SlowLog *slowlog = GraphContext_GetSlowLog(gc);
+	SlowLog_Add(slowlog, command_ctx->command_name, command_ctx->query,
+				QueryCtx_GetExecutionTime(), Alloc_GetPeakConsumption(),
+				CommandCtx_GetQueueWait(command_ctx), QueryCtx_GetPhaseTimes(), NULL);
+
+	ErrorCtx_Clear();
+	if(depleted) QueryCursor_Free(cursor);
+	else QueryCursor_Release(cursor);
+
+	GraphContext_Release(gc);
+	CommandCtx_Free(command_ctx);
+}
+
+// GRAPH.CURSOR READ <graph> <cursor_id> [COUNT <count>]
+// GRAPH.CURSOR DEL <graph> <cursor_id>
+int Graph_Cursor(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	if(argc < 4) return RedisModule_WrongArity(ctx);
+
+	const char *subcmd = RedisModule_StringPtrLen(argv[1], NULL);
+	bool read = (strcasecmp(subcmd, "READ") == 0);
+	bool del = (strcasecmp(subcmd, "DEL") == 0);
+	if(!read && !del) {
+		RedisModule_ReplyWithError(ctx, "Unknown cursor sub-command");
+		return REDISMODULE_OK;
+	}
+	if(del && argc != 4) return RedisModule_WrongArity(ctx);
+	if(read && argc != 4 && argc != 6) return RedisModule_WrongArity(ctx);
+
+	long long id;
+	if(RedisModule_StringToLongLong(argv[3], &id) != REDISMODULE_OK || id <= 0) {
+		RedisModule_ReplyWithError(ctx, "Failed to parse cursor id");
+		return REDISMODULE_OK;
+	}
+
+	long long count = 0;
+	if(argc == 6) {
+		const char *arg = RedisModule_StringPtrLen(argv[4], NULL);
+		if(strcasecmp(arg, "COUNT") != 0 ||
+		   RedisModule_StringToLongLong(argv[5], &count) != REDISMODULE_OK ||
+		   count <= 0) {
+			RedisModule_ReplyWithError(ctx, "Failed to parse cursor count value");
+			return REDISMODULE_OK;
+		}
+	}
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[2], true, false);
+	// if GraphContext is null, key access failed and an error been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	QueryCursor *cursor = QueryCursor_Acquire(id);
+	if(cursor != NULL && cursor->gc != gc) {
+		// cursor belongs to a different graph
+		QueryCursor_Release(cursor);
+		cursor = NULL;
+	}
+
+	if(cursor == NULL) {
+		RedisModule_ReplyWithError(ctx, "Cursor not found");
+		GraphContext_Release(gc);
+		return REDISMODULE_OK;
+	}
+
+	if(del) {
+		QueryCursor_Free(cursor);
+		GraphContext_Release(gc);
+		RedisModule_ReplyWithSimpleString(ctx, "OK");
+		return REDISMODULE_OK;
+	}
+
+	if(count == 0) count = cursor->count;
+
+	// reads issued within a LUA script or multi exec block
+	// must run on Redis main thread, similar to queries
+	int flags = RedisModule_GetContextFlags(ctx);
+	ExecutorThread exec_thread = (flags & (REDISMODULE_CTX_FLAGS_MULTI |
+										   REDISMODULE_CTX_FLAGS_LUA  |
+										   REDISMODULE_CTX_FLAGS_LOADING)) ?
+								 EXEC_THREAD_MAIN : EXEC_THREAD_READER;
+
+	CursorReadCtx *read_ctx = rm_malloc(sizeof(CursorReadCtx));
+	read_ctx->cursor = cursor;
+
+	if(exec_thread == EXEC_THREAD_MAIN) {
+		read_ctx->command_ctx = CommandCtx_New(ctx, NULL, argv[0], NULL, gc,
+											   exec_thread, false, false, false, 0, count);
+		read_ctx->command_ctx->query = rm_strdup(cursor->query);
+		_Cursor_Read(read_ctx);
+		return REDISMODULE_OK;
+	}
+
+	// read on a dedicated thread
+	RedisModuleBlockedClient *bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+	CommandCtx *context = CommandCtx_New(NULL, bc, argv[0], NULL, gc,
+										 exec_thread, false, false, false, 0, count);
+	context->query = rm_strdup(cursor->query);
+	read_ctx->command_ctx = context;
+
+	if(ThreadPools_AddWorkReader(_Cursor_Read, read_ctx) == THPOOL_QUEUE_FULL) {
+		// keep the cursor, the client may retry reading it
+		RedisModule_ReplyWithError(ctx, "Max pending queries exceeded");
+		Metrics_QueryRejected();
+		QueryCursor_Release(cursor);
+		GraphContext_Release(gc);
+		CommandCtx_Free(context);
+		rm_free(read_ctx);
+	}
+
+	return REDISMODULE_OK;
+}
+
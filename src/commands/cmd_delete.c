@@ -8,6 +8,7 @@
 #include "../graph/graph.h"
 #include "../graph/graphcontext.h"
 #include "../query_ctx.h"
+#include "../metrics/metrics.h"
 #include "../resultset/resultset.h"
 
 /* Delete graph, removing the key from Redis and
@@ -33,7 +34,9 @@ int Graph_Delete(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 	RedisModule_CloseKey(key);  // Free key handle.
 	GraphContext_Release(gc);   // Decrease graph ref count.
 
+	// the graph is gone, its latency is only tracked globally
 	double t = QueryCtx_GetExecutionTime();
+	Metrics_RecordLatency(NULL, METRICS_CMD_DELETE, t);
 	asprintf(&strElapsed, "Graph removed, internal execution time: %.6f milliseconds", t);
 	RedisModule_ReplyWithStringBuffer(ctx, strElapsed, strlen(strElapsed));
 
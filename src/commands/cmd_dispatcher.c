@@ -8,7 +8,10 @@
 #include "commands.h"
 #include "../config.h"
 #include "cmd_context.h"
+#include "query_cursor.h"
 #include "../util/thpool/pools.h"
+#include "../metrics/metrics.h"
+#include "../module_event_handlers.h"
 
 #define GRAPH_VERSION_MISSING -1
 
@@ -17,13 +20,22 @@ typedef void(*Command_Handler)(void *args);
 
 // Read configuration flags, returning REDIS_MODULE_ERR if flag parsing failed.
 static int _read_flags(RedisModuleString **argv, int argc, bool *compact,
-					   long long *timeout, uint *graph_version, char **errmsg) {
+					   bool *binary, long long *timeout, uint *graph_version, long long *cursor_count,
+					   ResultCachePolicy *result_cache, double *sample_rate, char **errmsg) {
 
 	ASSERT(compact);
+	ASSERT(binary);
 	ASSERT(timeout);
+	ASSERT(cursor_count);
+	ASSERT(result_cache);
+	ASSERT(sample_rate);
 
 	// set defaults
 	*compact = false;  // verbose
+	*binary = false;   // row based
+	*cursor_count = 0; // no cursor
+	*result_cache = RESULT_CACHE_DEFAULT;
+	*sample_rate = 1;  // full scans
 	*graph_version = GRAPH_VERSION_MISSING;
 	Config_Option_get(Config_TIMEOUT, timeout);
 
@@ -41,6 +53,24 @@ static int _read_flags(RedisModuleString **argv, int argc, bool *compact,
 			continue;
 		}
 
+		// binary columnar result-set, compact otherwise
+		if(!strcasecmp(arg, "--binary")) {
+			*compact = true;
+			*binary = true;
+			continue;
+		}
+
+		// serve the reply from the result cache, or keep it out of the cache
+		if(!strcasecmp(arg, "--cache")) {
+			*result_cache = RESULT_CACHE_ON;
+			continue;
+		}
+
+		if(!strcasecmp(arg, "--no-cache")) {
+			*result_cache = RESULT_CACHE_OFF;
+			continue;
+		}
+
 		if(!strcasecmp(arg, "version")) {
 			long long v = GRAPH_VERSION_MISSING;
 			int err = REDISMODULE_ERR;
@@ -59,6 +89,45 @@ static int _read_flags(RedisModuleString **argv, int argc, bool *compact,
 			continue;
 		}
 
+		// stream results through a cursor, optionally specifying batch size
+		if(!strcasecmp(arg, "cursor")) {
+			*cursor_count = QUERY_CURSOR_DEFAULT_COUNT;
+			if(i < argc - 1 &&
+			   !strcasecmp(RedisModule_StringPtrLen(argv[i + 1], NULL), "count")) {
+				int err = REDISMODULE_ERR;
+				i++; // Set the current argument to the count keyword.
+				if(i < argc - 1) {
+					i++; // Set the current argument to the count value.
+					err = RedisModule_StringToLongLong(argv[i], cursor_count);
+				}
+
+				// Emit error on missing, non-positive, or non-numeric count values.
+				if(err != REDISMODULE_OK || *cursor_count <= 0) {
+					asprintf(errmsg, "Failed to parse cursor count value");
+					return REDISMODULE_ERR;
+				}
+			}
+
+			continue;
+		}
+
+		// approximate the query's results by scanning a fraction of the graph
+		if(!strcasecmp(arg, "sample")) {
+			int err = REDISMODULE_ERR;
+			if(i < argc - 1) {
+				i++; // Set the current argument to the sample rate.
+				err = RedisModule_StringToDouble(argv[i], sample_rate);
+			}
+
+			// Emit error on missing, out of range, or non-numeric sample rates.
+			if(err != REDISMODULE_OK || !(*sample_rate > 0 && *sample_rate <= 1)) {
+				asprintf(errmsg, "Failed to parse query sample rate");
+				return REDISMODULE_ERR;
+			}
+
+			continue;
+		}
+
 		// query timeout
 		if(!strcasecmp(arg, "timeout")) {
 			int err = REDISMODULE_ERR;
@@ -99,16 +168,28 @@ static inline bool _validate_command_arity(GRAPH_Commands cmd, int arity) {
 		case CMD_EXPLAIN:
 		case CMD_PROFILE:
 			// Expect a command, graph name, a query, and optional config flags.
-			return arity >= 3 && arity <= 8;
+			return arity >= 3 && arity <= 12;
 		case CMD_SLOWLOG:
 			// Expect just a command and graph name.
 			return arity == 2;
+		case CMD_MULTI_QUERY:
+			// Expect a command, graph name and at least one query.
+			return arity >= 3;
+		case CMD_PREPARE:
+			// Expect a command, graph name and a query.
+			return arity == 3;
 		default:
 			ASSERT("encountered unhandled query type" && false);
 			return false;
 	}
 }
 
+// Return true if the command is admitted by its graph's quotas.
+static inline bool _subject_to_quota(GRAPH_Commands cmd) {
+	return cmd == CMD_QUERY || cmd == CMD_RO_QUERY || cmd == CMD_PROFILE ||
+		   cmd == CMD_MULTI_QUERY;
+}
+
 // Get command handler.
 static Command_Handler get_command_handler(GRAPH_Commands cmd) {
 	switch(cmd) {
@@ -121,6 +202,10 @@ static Command_Handler get_command_handler(GRAPH_Commands cmd) {
 			return Graph_Profile;
 		case CMD_SLOWLOG:
 			return Graph_Slowlog;
+		case CMD_MULTI_QUERY:
+			return Graph_MultiQuery;
+		case CMD_PREPARE:
+			return Graph_Prepare;
 		default:
 			ASSERT(false);
 	}
@@ -134,6 +219,8 @@ static GRAPH_Commands determine_command(const char *cmd_name) {
 	if(strcasecmp(cmd_name, "graph.EXPLAIN")  == 0) return CMD_EXPLAIN;
 	if(strcasecmp(cmd_name, "graph.PROFILE")  == 0) return CMD_PROFILE;
 	if(strcasecmp(cmd_name, "graph.SLOWLOG")  == 0) return CMD_SLOWLOG;
+	if(strcasecmp(cmd_name, "graph.MULTI_QUERY") == 0) return CMD_MULTI_QUERY;
+	if(strcasecmp(cmd_name, "graph.PREPARE")  == 0) return CMD_PREPARE;
 
 	// we shouldn't reach this point
 	ASSERT(false);
@@ -143,8 +230,12 @@ static GRAPH_Commands determine_command(const char *cmd_name) {
 int CommandDispatch(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 	char *errmsg;
 	bool compact;
+	bool binary;
 	uint version;
 	long long timeout;
+	long long cursor_count;
+	double sample_rate;
+	ResultCachePolicy result_cache;
 	CommandCtx *context = NULL;
 
 	RedisModuleString *graph_name = argv[1];
@@ -154,8 +245,13 @@ int CommandDispatch(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 
 	if(_validate_command_arity(cmd, argc) == false) return RedisModule_WrongArity(ctx);
 
+	// each argument of a batch is a query, flags take their defaults
+	bool batch = (cmd == CMD_MULTI_QUERY);
+	if(batch) query = NULL;
+
 	// parse additional arguments
-	int res = _read_flags(argv, argc, &compact, &timeout, &version, &errmsg);
+	int res = _read_flags(argv, (batch) ? 3 : argc, &compact, &binary,
+						  &timeout, &version, &cursor_count, &result_cache, &sample_rate, &errmsg);
 	if(res == REDISMODULE_ERR) {
 		// emit error and exit if argument parsing failed
 		RedisModule_ReplyWithError(ctx, errmsg);
@@ -188,23 +284,49 @@ int CommandDispatch(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 										   REDISMODULE_CTX_FLAGS_LOADING)) ?
 								 EXEC_THREAD_MAIN : EXEC_THREAD_READER;
 
+	// enforce per graph quotas, replicated and loaded commands
+	// already executed on the master and are never rejected
+	bool quota = _subject_to_quota(cmd) && !is_replicated &&
+				 !(flags & REDISMODULE_CTX_FLAGS_LOADING);
+	if(quota) {
+		QuotaResult admission = QueryQuota_Admit(&gc->quota);
+		if(admission != QUOTA_ADMITTED) {
+			RedisModule_ReplyWithError(ctx, QueryQuota_Error(admission));
+			Metrics_QueryRejected();
+			GraphContext_Release(gc);
+			return REDISMODULE_OK;
+		}
+	}
+
+	// writes avoid pages shared with a forked child, e.g. during BGSAVE
+	ModuleEventHandler_UpdateForkState(ctx);
+
 	Command_Handler handler = get_command_handler(cmd);
 	if(exec_thread == EXEC_THREAD_MAIN) {
 		// run query on Redis main thread
 		context = CommandCtx_New(ctx, NULL, argv[0], query, gc, exec_thread,
-								 is_replicated, compact, timeout);
+								 is_replicated, compact, binary, timeout, cursor_count);
+		context->result_cache = result_cache;
+		context->sample_rate = sample_rate;
+		if(batch) CommandCtx_SetBatch(context, argv + 2, argc - 2);
+		if(quota) CommandCtx_HoldQuota(context);
 		handler(context);
 	} else {
 		// run query on a dedicated thread
 		RedisModuleBlockedClient *bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
 		context = CommandCtx_New(NULL, bc, argv[0], query, gc, exec_thread,
-								 is_replicated, compact, timeout);
+								 is_replicated, compact, binary, timeout, cursor_count);
+		context->result_cache = result_cache;
+		context->sample_rate = sample_rate;
+		if(batch) CommandCtx_SetBatch(context, argv + 2, argc - 2);
+		if(quota) CommandCtx_HoldQuota(context);
 
 		if(ThreadPools_AddWorkReader(handler, context) == THPOOL_QUEUE_FULL) {
 			// Report an error once our workers thread pool internal queue
 			// is full, this error usually happens when the server is
 			// under heavy load and is unable to catch up
 			RedisModule_ReplyWithError(ctx, "Max pending queries exceeded");
+			Metrics_QueryRejected();
 			// Release the GraphContext, as we increased its reference count
 			// when retrieving it.
 			GraphContext_Release(gc);
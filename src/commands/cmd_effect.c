@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../errors.h"
+#include "../redismodule.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../effects/effects.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+
+// effects context object
+typedef struct {
+	GraphContext *gc;              // graph to modify
+	RedisModuleString *effects;    // encoded effects
+	RedisModuleBlockedClient *bc;  // blocked client, NULL when applied inline
+} EffectCtx;
+
+// applies effects to the graph and replies, ctx holds the GIL
+static void _Graph_ApplyEffects(RedisModuleCtx *ctx, EffectCtx *effect_ctx) {
+	GraphContext *gc = effect_ctx->gc;
+
+	size_t len;
+	const char *effects = RedisModule_StringPtrLen(effect_ctx->effects, &len);
+
+	// applied entities are interned into the graph's string pool
+	QueryCtx_SetGraphCtx(gc);
+	GraphContext_MarkWriter(ctx, gc);
+
+	Graph_AcquireWriteLock(gc->g);
+	bool applied = Effects_Apply(gc, effects, len);
+	// views fold in the replicated changes
+	if(applied) GraphContext_UpdateViews(gc, effects, len);
+	// columnar attribute copies are out of date
+	GraphContext_DropColumns(gc);
+	Graph_FlushAllPending(gc->g);
+	GraphContext_RefreshStatistics(gc);
+	Graph_ReleaseLock(gc->g);
+
+	if(applied) {
+		// propagate to chained replicas and the AOF
+		RedisModule_ReplicateVerbatim(ctx);
+		RedisModule_ReplyWithSimpleString(ctx, "OK");
+	} else {
+		RedisModule_Log(ctx, "warning", "Failed to apply effects to graph %s: %s",
+						gc->graph_name, ErrorCtx_Get()->error);
+		RedisModule_ReplyWithError(ctx, ErrorCtx_Get()->error);
+		ErrorCtx_Clear();
+	}
+
+	QueryCtx_Free();
+}
+
+// applies effects on the graph's writer thread
+static void _Graph_Effect(void *args) {
+	ASSERT(args != NULL);
+
+	EffectCtx *effect_ctx = (EffectCtx *)args;
+	GraphContext *gc = effect_ctx->gc;
+	RedisModuleBlockedClient *bc = effect_ctx->bc;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(bc);
+
+	Graph_WriterEnter(gc->g);
+	RedisModule_ThreadSafeContextLock(ctx);
+	_Graph_ApplyEffects(ctx, effect_ctx);
+	RedisModule_ThreadSafeContextUnlock(ctx);
+	Graph_WriterLeave(gc->g);
+
+	RedisModule_FreeString(ctx, effect_ctx->effects);
+	GraphContext_Release(gc);
+	rm_free(effect_ctx);
+	RedisModule_FreeThreadSafeContext(ctx);
+	RedisModule_UnblockClient(bc, NULL);
+}
+
+// GRAPH.EFFECT <graph> <effects>
+// applies the changes of a write query, as replicated by its primary
+// see REPLICATE_EFFECTS
+int Graph_Effect(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 3) return RedisModule_WrongArity(ctx);
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], false, true);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	EffectCtx *effect_ctx = rm_malloc(sizeof(EffectCtx));
+	effect_ctx->gc = gc;
+	effect_ctx->effects = argv[2];
+
+	// effects within a MULTI block, a LUA script or loaded from the AOF
+	// are applied on Redis main thread
+	int flags = RedisModule_GetContextFlags(ctx);
+	if(flags & (REDISMODULE_CTX_FLAGS_MULTI |
+				REDISMODULE_CTX_FLAGS_LUA   |
+				REDISMODULE_CTX_FLAGS_LOADING)) {
+		effect_ctx->bc = NULL;
+		_Graph_ApplyEffects(ctx, effect_ctx);
+		GraphContext_Release(gc);
+		rm_free(effect_ctx);
+		return REDISMODULE_OK;
+	}
+
+	RedisModule_RetainString(ctx, argv[2]);
+	effect_ctx->bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+
+	// serialize effects with the graph's write queries
+	ThreadPools_AddWorkWriter(_Graph_Effect, effect_ctx, gc->graph_name);
+
+	return REDISMODULE_OK;
+}
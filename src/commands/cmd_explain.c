@@ -11,6 +11,7 @@
 #include "../index/index.h"
 #include "../util/rmalloc.h"
 #include "../execution_plan/execution_plan.h"
+#include "../execution_plan/plan_estimate.h"
 
 /* Builds an execution plan but does not execute it
  * reports plan back to the client
@@ -55,8 +56,10 @@ void Graph_Explain(void *args) {
 	Graph_AcquireReadLock(gc->g);
 	lock_acquired = true;
 
-	ExecutionPlan_PreparePlan(plan);
+	ExecutionCtx_PreparePlan(exec_ctx);
+	plan = exec_ctx->plan;
 	ExecutionPlan_Init(plan);       // Initialize the plan's ops.
+	ExecutionPlan_Estimate(plan);   // Annotate ops with estimates.
 	ExecutionPlan_Print(plan, ctx); // Print the execution plan.
 
 cleanup:
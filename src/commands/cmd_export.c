@@ -0,0 +1,342 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+#include <stdio.h>
+#include <ctype.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+// size of each export file's write buffer
+#define EXPORT_BUFFER_SIZE (1024 * 1024)
+
+// export context object
+typedef struct {
+	GraphContext *gc;              // graph to export
+	char *dir;                     // directory to write files into
+	uint64_t nodes;                // number of exported nodes
+	uint64_t edges;                // number of exported edges
+	RedisModuleBlockedClient *bc;  // blocked client
+} ExportCtx;
+
+// an export file, holding the nodes of a label or the edges of a relation
+typedef struct {
+	FILE *f;                // file, NULL until the table's first row
+	bool *columns;          // attribute IDs held by the table's entities
+	Attribute_ID *header;   // attribute IDs of the table's columns, ascending
+	const char *name;       // label or relation name, NULL for unlabeled nodes
+	char *buf;              // write buffer
+} ExportTable;
+
+static void _ExportCtx_Free(ExportCtx *ectx) {
+	GraphContext_Release(ectx->gc);
+	rm_free(ectx->dir);
+	rm_free(ectx);
+}
+
+// writes 'len' bytes of 's' as a CSV field, quoted if required
+static void _Export_WriteField(FILE *f, const char *s, size_t len) {
+	if(strcspn(s, ",\"\r\n") == len) {
+		fwrite(s, 1, len, f);
+		return;
+	}
+
+	// quotes within the field are doubled
+	fputc('"', f);
+	const char *end = s + len;
+	while(s < end) {
+		const char *quote = memchr(s, '"', end - s);
+		if(quote == NULL) quote = end;
+		fwrite(s, 1, quote - s, f);
+		if(quote < end) fputs("\"\"", f);
+		s = quote + 1;
+	}
+	fputc('"', f);
+}
+
+static void _Export_WriteValue(FILE *f, SIValue v, char **buf, size_t *buf_len) {
+	switch(SI_TYPE(v)) {
+	case T_STRING:
+		_Export_WriteField(f, v.stringval, strlen(v.stringval));
+		break;
+	case T_INT64:
+		fprintf(f, "%lld", (long long)v.longval);
+		break;
+	case T_DOUBLE:
+		// round-trips the double
+		fprintf(f, "%.17g", v.doubleval);
+		break;
+	case T_BOOL:
+		fputs(v.longval ? "true" : "false", f);
+		break;
+	default: {
+		// arrays, points and temporal values by their string representation
+		size_t written = 0;
+		SIValue_ToString(v, buf, buf_len, &written);
+		_Export_WriteField(f, *buf, written);
+		break;
+	}
+	}
+}
+
+// writes the path of the table's file into 'path', names are percent-encoded
+// such that every label and relation maps to a distinct, valid file name
+static bool _Export_TablePath(char *path, const char *dir, const char *prefix,
+		const char *name) {
+	int n = snprintf(path, PATH_MAX, "%s/%s", dir, prefix);
+	if(name != NULL) {
+		n += snprintf(path + n, PATH_MAX - n, "_");
+		for(const unsigned char *c = (const unsigned char *)name; *c && n < PATH_MAX; c++) {
+			n += (isalnum(*c) || *c == '-' || *c == '_') ?
+				snprintf(path + n, PATH_MAX - n, "%c", *c) :
+				snprintf(path + n, PATH_MAX - n, "%%%02X", *c);
+		}
+	}
+	if(n < PATH_MAX) n += snprintf(path + n, PATH_MAX - n, ".csv");
+	return n < PATH_MAX;
+}
+
+// opens the table's file and writes its header
+static bool _Export_OpenTable(ExportTable *t, GraphContext *gc, const char *dir,
+		const char *prefix, bool edges) {
+	char path[PATH_MAX];
+	if(!_Export_TablePath(path, dir, prefix, t->name)) return false;
+
+	t->f = fopen(path, "w");
+	if(t->f == NULL) return false;
+	t->buf = rm_malloc(EXPORT_BUFFER_SIZE);
+	setvbuf(t->f, t->buf, _IOFBF, EXPORT_BUFFER_SIZE);
+
+	fputs((edges) ? "_id,_src,_dest" : "_id", t->f);
+	uint attr_count = GraphContext_AttributeCount(gc);
+	t->header = array_new(Attribute_ID, 0);
+	for(uint i = 0; i < attr_count; i++) {
+		if(!t->columns[i]) continue;
+		const char *attr = GraphContext_GetAttributeString(gc, i);
+		fputc(',', t->f);
+		_Export_WriteField(t->f, attr, strlen(attr));
+		t->header = array_append(t->header, i);
+	}
+	fputc('\n', t->f);
+
+	return !ferror(t->f);
+}
+
+// writes the entity's attributes, a field per table column
+static void _Export_WriteProperties(FILE *f, const ExportTable *t, const Entity *e,
+		char **buf, size_t *buf_len) {
+	// both columns and properties are sorted by attribute ID
+	int j = 0;
+	uint column_count = array_len(t->header);
+	for(uint i = 0; i < column_count; i++) {
+		fputc(',', f);
+		Attribute_ID attr = t->header[i];
+		while(j < e->prop_count && e->properties[j].id < attr) j++;
+		if(j < e->prop_count && e->properties[j].id == attr) {
+			_Export_WriteValue(f, EntityProperty_Value(e->properties + j), buf, buf_len);
+		}
+	}
+	fputc('\n', f);
+}
+
+static ExportTable *_Export_NewTables(uint count, uint attr_count) {
+	ExportTable *tables = rm_calloc(count, sizeof(ExportTable));
+	for(uint i = 0; i < count; i++) {
+		tables[i].columns = rm_calloc(attr_count + 1, sizeof(bool));
+	}
+	return tables;
+}
+
+// closes the tables' files, returns false if any failed to be written
+static bool _Export_FreeTables(ExportTable *tables, uint count) {
+	bool ok = true;
+	for(uint i = 0; i < count; i++) {
+		ExportTable *t = tables + i;
+		if(t->f != NULL) {
+			ok &= (fclose(t->f) == 0);
+			rm_free(t->buf);
+			array_free(t->header);
+		}
+		rm_free(t->columns);
+	}
+	rm_free(tables);
+	return ok;
+}
+
+// marks the attributes of the scanned entities as their table's columns
+// nodes are assigned to the table of their label, the last table holding
+// unlabeled nodes, edges to the table of their relation
+static void _Export_DiscoverColumns(ExportTable *tables, const Graph *g,
+		uint label_count, bool edges) {
+	uint64_t id;
+	Entity *e;
+	DataBlockIterator *it = (edges) ? Graph_ScanEdges(g) : Graph_ScanNodes(g);
+	while((e = DataBlockIterator_Next(it, &id)) != NULL) {
+		int t;
+		if(edges) {
+			t = ((EdgeRecord *)e)->relationID;
+		} else {
+			t = Graph_GetNodeLabel(g, id);
+			if(t == GRAPH_NO_LABEL) t = label_count;
+		}
+		for(int i = 0; i < e->prop_count; i++) tables[t].columns[e->properties[i].id] = true;
+	}
+	DataBlockIterator_Free(it);
+}
+
+// writes a file per label and relation into 'dir', see GRAPH.EXPORT
+static bool _Export_Write(GraphContext *gc, const char *dir) {
+	Graph *g = gc->g;
+	uint attr_count = GraphContext_AttributeCount(gc);
+	uint label_count = GraphContext_SchemaCount(gc, SCHEMA_NODE);
+	uint relation_count = GraphContext_SchemaCount(gc, SCHEMA_EDGE);
+	bool ok = true;
+	char *buf = rm_malloc(64);
+	size_t buf_len = 64;
+
+	// a table per label, followed by the table of unlabeled nodes
+	ExportTable *nodes = _Export_NewTables(label_count + 1, attr_count);
+	for(uint i = 0; i < label_count; i++) {
+		nodes[i].name = Schema_GetName(GraphContext_GetSchemaByID(gc, i, SCHEMA_NODE));
+	}
+	_Export_DiscoverColumns(nodes, g, label_count, false);
+
+	uint64_t id;
+	Entity *e;
+	DataBlockIterator *it = Graph_ScanNodes(g);
+	while(ok && (e = DataBlockIterator_Next(it, &id)) != NULL) {
+		int label = Graph_GetNodeLabel(g, id);
+		ExportTable *t = nodes + ((label == GRAPH_NO_LABEL) ? label_count : label);
+		if(t->f == NULL) ok = _Export_OpenTable(t, gc, dir, "nodes", false);
+		if(!ok) break;
+		fprintf(t->f, "%llu", (unsigned long long)id);
+		_Export_WriteProperties(t->f, t, e, &buf, &buf_len);
+	}
+	DataBlockIterator_Free(it);
+	ok &= _Export_FreeTables(nodes, label_count + 1);
+
+	// a table per relation, edge records hold their endpoints
+	ExportTable *edges = _Export_NewTables(relation_count, attr_count);
+	for(uint i = 0; i < relation_count; i++) {
+		edges[i].name = Schema_GetName(GraphContext_GetSchemaByID(gc, i, SCHEMA_EDGE));
+	}
+	if(ok) _Export_DiscoverColumns(edges, g, label_count, true);
+
+	it = Graph_ScanEdges(g);
+	while(ok && (e = DataBlockIterator_Next(it, &id)) != NULL) {
+		EdgeRecord *rec = (EdgeRecord *)e;
+		ExportTable *t = edges + rec->relationID;
+		if(t->f == NULL) ok = _Export_OpenTable(t, gc, dir, "edges", true);
+		if(!ok) break;
+		fprintf(t->f, "%llu,%llu,%llu", (unsigned long long)id,
+				(unsigned long long)rec->srcNodeID,
+				(unsigned long long)rec->destNodeID);
+		_Export_WriteProperties(t->f, t, e, &buf, &buf_len);
+	}
+	DataBlockIterator_Free(it);
+	ok &= _Export_FreeTables(edges, relation_count);
+
+	rm_free(buf);
+	return ok;
+}
+
+// fork done handler, replies once the child exits
+static void _Export_Done(int exitcode, int bysignal, void *user_data) {
+	ExportCtx *ectx = user_data;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(ectx->bc);
+
+	if(exitcode != 0 || bysignal != 0) {
+		RedisModule_ReplyWithError(ctx, "ERR Failed to write graph export files");
+	} else {
+		RedisModule_ReplyWithArray(ctx, 4);
+		RedisModule_ReplyWithSimpleString(ctx, "nodes");
+		RedisModule_ReplyWithLongLong(ctx, ectx->nodes);
+		RedisModule_ReplyWithSimpleString(ctx, "edges");
+		RedisModule_ReplyWithLongLong(ctx, ectx->edges);
+	}
+
+	RedisModule_FreeThreadSafeContext(ctx);
+	RedisModule_UnblockClient(ectx->bc, NULL);
+	_ExportCtx_Free(ectx);
+}
+
+// forks under the graph's read lock on a reader thread, the child process
+// writes the graph's snapshot while the server carries on
+static void _Graph_Export(void *args) {
+	ASSERT(args != NULL);
+
+	ExportCtx *ectx = (ExportCtx *)args;
+	Graph *g = ectx->gc->g;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+
+	// the child reads synchronized matrices, which no writer modifies
+	// while the snapshot is taken
+	Graph_AcquireReadLock(g);
+	Graph_ApplyAllPending(g);
+	ectx->nodes = Graph_NodeCount(g);
+	ectx->edges = Graph_EdgeCount(g);
+
+	RedisModule_ThreadSafeContextLock(ctx);
+	int pid = RedisModule_Fork(_Export_Done, ectx);
+	if(pid == 0) {
+		// child process
+		RedisModule_ExitFromChild(_Export_Write(ectx->gc, ectx->dir) ? 0 : 1);
+	}
+	RedisModule_ThreadSafeContextUnlock(ctx);
+	RedisModule_FreeThreadSafeContext(ctx);
+
+	Graph_ReleaseLock(g);
+
+	if(pid == -1) {
+		// Redis runs a single child process at a time
+		ctx = RedisModule_GetThreadSafeContext(ectx->bc);
+		RedisModule_ReplyWithError(ctx,
+				"ERR Failed to fork export process, a child process may be active");
+		RedisModule_FreeThreadSafeContext(ctx);
+		RedisModule_UnblockClient(ectx->bc, NULL);
+		_ExportCtx_Free(ectx);
+	}
+}
+
+// GRAPH.EXPORT <graph> <directory>
+// writes the graph into CSV files within directory,
+// the nodes of each label and the edges of each relation to a file of its own
+int Graph_Export(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 3) return RedisModule_WrongArity(ctx);
+
+	// files are written by the server, into a directory of its file system
+	struct stat st;
+	const char *dir = RedisModule_StringPtrLen(argv[2], NULL);
+	if(stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+		RedisModule_ReplyWithError(ctx, "ERR Export directory doesn't exist");
+		return REDISMODULE_OK;
+	}
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_OK;
+
+	ExportCtx *ectx = rm_malloc(sizeof(ExportCtx));
+	ectx->gc = gc;
+	ectx->dir = rm_strdup(dir);
+	ectx->nodes = 0;
+	ectx->edges = 0;
+	ectx->bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+
+	if(ThreadPools_AddWorkReader(_Graph_Export, ectx) == THPOOL_QUEUE_FULL) {
+		RedisModule_AbortBlock(ectx->bc);
+		RedisModule_ReplyWithError(ctx, "Max pending queries exceeded");
+		_ExportCtx_Free(ectx);
+	}
+
+	return REDISMODULE_OK;
+}
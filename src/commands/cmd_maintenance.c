@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../config.h"
+#include "../redismodule.h"
+#include "../maintenance/maintenance.h"
+#include <string.h>
+
+// GRAPH.MAINTENANCE
+// reports background maintenance activity since the module loaded
+int Graph_Maintenance(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 1) return RedisModule_WrongArity(ctx);
+
+	uint budget;
+	MaintenanceStats stats;
+	Config_Option_get(Config_MAINTENANCE_CPU_BUDGET, &budget);
+	Maintenance_GetStats(&stats);
+
+	RedisModule_ReplyWithArray(ctx, (5 + MAINTENANCE_JOB_COUNT) * 2);
+
+	RedisModule_ReplyWithStringBuffer(ctx, "cpu_budget", 10);
+	RedisModule_ReplyWithLongLong(ctx, budget);
+	RedisModule_ReplyWithStringBuffer(ctx, "active", 6);
+	RedisModule_ReplyWithLongLong(ctx, stats.active);
+
+	// number of runs of each job
+	for(int i = 0; i < MAINTENANCE_JOB_COUNT; i++) {
+		const char *name = Maintenance_JobName(i);
+		RedisModule_ReplyWithStringBuffer(ctx, name, strlen(name));
+		RedisModule_ReplyWithLongLong(ctx, stats.runs[i]);
+	}
+
+	RedisModule_ReplyWithStringBuffer(ctx, "bytes_released", 14);
+	RedisModule_ReplyWithLongLong(ctx, stats.released);
+	RedisModule_ReplyWithStringBuffer(ctx, "deferred", 8);
+	RedisModule_ReplyWithLongLong(ctx, stats.deferred);
+	RedisModule_ReplyWithStringBuffer(ctx, "time_ms", 7);
+	RedisModule_ReplyWithLongLong(ctx, stats.time);
+
+	return REDISMODULE_OK;
+}
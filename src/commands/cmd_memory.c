@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+#include "execution_ctx.h"
+
+// number of top level components reported
+#define MEMORY_COMPONENT_COUNT 14
+
+// memory reporting context object
+typedef struct {
+	GraphContext *gc;              // graph to measure
+	RedisModuleBlockedClient *bc;  // blocked client
+} MemoryCtx;
+
+// returns the number of bytes held by the properties of scanned entities
+static size_t _PropertiesMemoryUsage(DataBlockIterator *it) {
+	size_t usage = 0;
+	Entity *e;
+	while((e = DataBlockIterator_Next(it, NULL)) != NULL) {
+		usage += Entity_PropertiesMemoryUsage(e);
+	}
+	DataBlockIterator_Free(it);
+	return usage;
+}
+
+static void _CacheMemoryUsage(const char *key, void *value, void *pdata) {
+	size_t *usage = pdata;
+	*usage += ExecutionCtx_MemoryUsage(value);
+}
+
+static void _ReplyWithComponent(RedisModuleCtx *ctx, const char *name, size_t usage,
+		size_t *total) {
+	RedisModule_ReplyWithStringBuffer(ctx, name, strlen(name));
+	RedisModule_ReplyWithLongLong(ctx, usage);
+	*total += usage;
+}
+
+// replies with the matrix memory of each schema of type 't'
+static void _ReplyWithMatrices(RedisModuleCtx *ctx, GraphContext *gc, SchemaType t,
+		size_t *total) {
+	uint count = GraphContext_SchemaCount(gc, t);
+	RedisModule_ReplyWithArray(ctx, count * 2);
+	for(uint i = 0; i < count; i++) {
+		Schema *s = GraphContext_GetSchemaByID(gc, i, t);
+		size_t usage = (t == SCHEMA_NODE) ?
+			Graph_LabelMatrixMemoryUsage(gc->g, s->id) :
+			Graph_RelationMatrixMemoryUsage(gc->g, s->id);
+		_ReplyWithComponent(ctx, Schema_GetName(s), usage, total);
+	}
+}
+
+// measures the graph under its read lock on a reader thread
+// entity properties are scanned one by one
+static void _Graph_Memory(void *args) {
+	ASSERT(args != NULL);
+
+	MemoryCtx *memory_ctx = (MemoryCtx *)args;
+	GraphContext *gc = memory_ctx->gc;
+	RedisModuleBlockedClient *bc = memory_ctx->bc;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(bc);
+	Graph *g = gc->g;
+
+	size_t total = 0;
+	size_t indexes = 0;
+	size_t columns = 0;
+	size_t cache = 0;
+
+	Graph_AcquireReadLock(g);
+
+	Schema **schemas[2] = {gc->node_schemas, gc->relation_schemas};
+	for(int i = 0; i < 2; i++) {
+		uint schema_count = array_len(schemas[i]);
+		for(uint j = 0; j < schema_count; j++) {
+			Schema *s = schemas[i][j];
+			if(s->index) indexes += Index_MemoryUsage(s->index);
+			if(s->vectorIdx) indexes += Index_MemoryUsage(s->vectorIdx);
+			columns += Schema_ColumnsMemoryUsage(s);
+		}
+	}
+	Cache_ForEach(GraphContext_GetCache(gc), _CacheMemoryUsage, &cache);
+
+	RedisModule_ReplyWithArray(ctx, (MEMORY_COMPONENT_COUNT + 1) * 2);
+	_ReplyWithComponent(ctx, "nodes", DataBlock_MemoryUsage(g->nodes), &total);
+	_ReplyWithComponent(ctx, "edges", DataBlock_MemoryUsage(g->edges), &total);
+	_ReplyWithComponent(ctx, "node_properties",
+			_PropertiesMemoryUsage(Graph_ScanNodes(g)), &total);
+	_ReplyWithComponent(ctx, "edge_properties",
+			_PropertiesMemoryUsage(Graph_ScanEdges(g)), &total);
+	_ReplyWithComponent(ctx, "string_pool",
+			(gc->string_pool) ? StringPool_MemoryUsage(gc->string_pool) : 0, &total);
+	_ReplyWithComponent(ctx, "value_log",
+			(gc->value_log) ? ValueLog_MappedBytes(gc->value_log) : 0, &total);
+	_ReplyWithComponent(ctx, "property_columns", columns, &total);
+	_ReplyWithComponent(ctx, "indexes", indexes, &total);
+	_ReplyWithComponent(ctx, "cache", cache, &total);
+	_ReplyWithComponent(ctx, "product_cache",
+			ProductCache_MemoryUsage(gc->product_cache), &total);
+	_ReplyWithComponent(ctx, "result_cache",
+			ResultCache_MemoryUsage(gc->result_cache), &total);
+	_ReplyWithComponent(ctx, "adjacency", Graph_AdjacencyMatrixMemoryUsage(g), &total);
+
+	RedisModule_ReplyWithSimpleString(ctx, "labels");
+	_ReplyWithMatrices(ctx, gc, SCHEMA_NODE, &total);
+	RedisModule_ReplyWithSimpleString(ctx, "relations");
+	_ReplyWithMatrices(ctx, gc, SCHEMA_EDGE, &total);
+
+	Graph_ReleaseLock(g);
+
+	RedisModule_ReplyWithSimpleString(ctx, "total");
+	RedisModule_ReplyWithLongLong(ctx, total);
+
+	GraphContext_Release(gc);
+	rm_free(memory_ctx);
+	RedisModule_FreeThreadSafeContext(ctx);
+	RedisModule_UnblockClient(bc, NULL);
+}
+
+// GRAPH.MEMORY <graph>
+// replies with an estimate of the memory held by each of the graph's components
+int Graph_Memory(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 2) return RedisModule_WrongArity(ctx);
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	MemoryCtx *memory_ctx = rm_malloc(sizeof(MemoryCtx));
+	memory_ctx->gc = gc;
+	memory_ctx->bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+
+	if(ThreadPools_AddWorkReader(_Graph_Memory, memory_ctx) == THPOOL_QUEUE_FULL) {
+		RedisModule_AbortBlock(memory_ctx->bc);
+		RedisModule_ReplyWithError(ctx, "Max pending queries exceeded");
+		GraphContext_Release(gc);
+		rm_free(memory_ctx);
+	}
+
+	return REDISMODULE_OK;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "execution_ctx.h"
+#include "../redismodule.h"
+#include "../util/cache/cache.h"
+#include "../graph/graphcontext.h"
+
+typedef struct {
+	RedisModuleCtx *ctx;  // redis module context
+	long count;           // number of replied queries
+} _PlanStatsReplyCtx;
+
+static void _ReplyWithPlanStats(const char *query, void *value, void *pdata) {
+	_PlanStatsReplyCtx *reply = pdata;
+	PlanStats *stats = ExecutionCtx_GetPlanStats((ExecutionCtx *)value);
+	if(stats == NULL) return;
+
+	RedisModule_ReplyWithArray(reply->ctx, 2);
+	RedisModule_ReplyWithStringBuffer(reply->ctx, query, strlen(query));
+	PlanStats_Reply(stats, reply->ctx);
+	reply->count++;
+}
+
+// GRAPH.PLANSTATS <graph>
+// replies with the per-operation statistics of the graph's cached queries
+// gathered from sampled executions, see PLAN_STATS_SAMPLE_RATE
+int Graph_PlanStats(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 2) return RedisModule_WrongArity(ctx);
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	_PlanStatsReplyCtx reply = {.ctx = ctx, .count = 0};
+	RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+	Cache_ForEach(GraphContext_GetCache(gc), _ReplyWithPlanStats, &reply);
+	RedisModule_ReplySetArrayLength(ctx, reply.count);
+
+	GraphContext_Release(gc);
+	return REDISMODULE_OK;
+}
@@ -0,0 +1,155 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../errors.h"
+#include "commands.h"
+#include "../config.h"
+#include "cmd_context.h"
+#include "../query_ctx.h"
+#include "prepared_statement.h"
+#include "../util/thpool/pools.h"
+#include "../metrics/metrics.h"
+
+// GRAPH.PREPARE <graph> <query>
+// replies with a handle executing the query through GRAPH.EXECUTE
+void Graph_Prepare(void *args) {
+	CommandCtx *command_ctx = (CommandCtx *)args;
+	RedisModuleCtx *ctx     = CommandCtx_GetRedisCtx(command_ctx);
+	GraphContext *gc        = CommandCtx_GetGraphContext(command_ctx);
+
+	QueryCtx_SetGlobalExecutionCtx(command_ctx);
+	CommandCtx_TrackCtx(command_ctx);
+	QueryCtx_BeginTimer(); // Start query timing.
+
+	ExecutionCtx *exec_ctx = ExecutionCtx_FromQuery(command_ctx->query);
+
+	// See if there were any query compile time errors
+	if(ErrorCtx_EncounteredError()) {
+		ErrorCtx_EmitException();
+		goto cleanup;
+	}
+	if(exec_ctx->exec_type == EXECUTION_TYPE_INVALID) goto cleanup;
+
+	// executions aren't replicated, as replicas don't hold the statement
+	if(exec_ctx->exec_type != EXECUTION_TYPE_QUERY || !exec_ctx->readonly) {
+		ErrorCtx_SetError("graph.PREPARE is to be executed only on read-only queries");
+		ErrorCtx_EmitException();
+		goto cleanup;
+	}
+
+	// the statement takes ownership over the execution context
+	PreparedStatement *stmt = PreparedStatement_New(gc, exec_ctx,
+			command_ctx->query);
+	exec_ctx = NULL;
+	RedisModule_ReplyWithLongLong(ctx, stmt->id);
+
+cleanup:
+	ExecutionCtx_Free(exec_ctx);
+	GraphContext_Release(gc);
+	CommandCtx_Free(command_ctx);
+	QueryCtx_Free(); // Reset the QueryCtx and free its allocations.
+	ErrorCtx_Clear();
+}
+
+// GRAPH.EXECUTE <graph> <handle> [<name> <value> ...]
+// executes a prepared statement, each value is a binary encoded parameter
+int Graph_Execute(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	if(argc < 3) return RedisModule_WrongArity(ctx);
+
+	long long id;
+	if(RedisModule_StringToLongLong(argv[2], &id) != REDISMODULE_OK || id <= 0) {
+		RedisModule_ReplyWithError(ctx, "Failed to parse prepared statement handle");
+		return REDISMODULE_OK;
+	}
+
+	rax *params = NULL;
+	if(argc > 3) {
+		const char *err = NULL;
+		params = PreparedStatement_DecodeParams(argv + 3, argc - 3, &err);
+		if(params == NULL) {
+			RedisModule_ReplyWithError(ctx, err);
+			return REDISMODULE_OK;
+		}
+	}
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if GraphContext is null, key access failed and an error been emitted
+	if(!gc) {
+		PreparedStatement_FreeParams(params);
+		return REDISMODULE_ERR;
+	}
+
+	PreparedStatement *stmt = PreparedStatement_Acquire(id);
+	if(stmt != NULL && stmt->gc != gc) {
+		// statement belongs to a different graph
+		PreparedStatement_Release(stmt);
+		stmt = NULL;
+	}
+
+	const char *err = NULL;
+	if(stmt == NULL) {
+		err = "Prepared statement not found";
+	} else if(stmt->version != GraphContext_GetVersion(gc)) {
+		// the statement's plan might refer to a modified schema
+		PreparedStatement_Remove(stmt);
+		err = "Prepared statement is out of date, the graph schema was modified";
+	}
+
+	if(err != NULL) {
+		RedisModule_ReplyWithError(ctx, err);
+		PreparedStatement_FreeParams(params);
+		GraphContext_Release(gc);
+		return REDISMODULE_OK;
+	}
+
+	// executions are admitted by the graph's quotas, similar to queries
+	QuotaResult admission = QueryQuota_Admit(&gc->quota);
+	if(admission != QUOTA_ADMITTED) {
+		RedisModule_ReplyWithError(ctx, QueryQuota_Error(admission));
+		Metrics_QueryRejected();
+		PreparedStatement_Release(stmt);
+		PreparedStatement_FreeParams(params);
+		GraphContext_Release(gc);
+		return REDISMODULE_OK;
+	}
+
+	// executions issued within a LUA script or multi exec block
+	// must run on Redis main thread, similar to queries
+	int flags = RedisModule_GetContextFlags(ctx);
+	ExecutorThread exec_thread = (flags & (REDISMODULE_CTX_FLAGS_MULTI |
+										   REDISMODULE_CTX_FLAGS_LUA  |
+										   REDISMODULE_CTX_FLAGS_LOADING)) ?
+								 EXEC_THREAD_MAIN : EXEC_THREAD_READER;
+
+	long long timeout;
+	Config_Option_get(Config_TIMEOUT, &timeout);
+
+	RedisModuleBlockedClient *bc = NULL;
+	if(exec_thread != EXEC_THREAD_MAIN) {
+		bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+	}
+	CommandCtx *context = CommandCtx_New((bc) ? NULL : ctx, bc, argv[0], NULL,
+										 gc, exec_thread, false, false, false, timeout, 0);
+	context->query = rm_strdup(stmt->query);
+	context->statement = stmt;
+	context->params = params;
+	CommandCtx_HoldQuota(context);
+
+	if(exec_thread == EXEC_THREAD_MAIN) {
+		Graph_Query(context);
+	} else if(ThreadPools_AddWorkReader(Graph_Query, context) == THPOOL_QUEUE_FULL) {
+		// Report an error once our workers thread pool internal queue
+		// is full, this error usually happens when the server is
+		// under heavy load and is unable to catch up
+		RedisModule_ReplyWithError(ctx, "Max pending queries exceeded");
+		Metrics_QueryRejected();
+		GraphContext_Release(gc);
+		CommandCtx_Free(context);
+	}
+
+	return REDISMODULE_OK;
+}
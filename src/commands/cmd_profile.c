@@ -11,6 +11,7 @@
 #include "execution_ctx.h"
 #include "../graph/graph.h"
 #include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
 #include "../execution_plan/execution_plan.h"
 
 void Graph_Profile(void *args) {
@@ -22,20 +23,18 @@ void Graph_Profile(void *args) {
 	GraphContext *gc        = CommandCtx_GetGraphContext(command_ctx);
 
 	CommandCtx_TrackCtx(command_ctx);
+	CommandCtx_MarkDequeued(command_ctx);
 	QueryCtx_SetGlobalExecutionCtx(command_ctx);
 
 	QueryCtx_BeginTimer(); // Start query timing.
 
 	/* Retrive the required execution items and information:
-	* 1. AST
-	* 2. Execution plan
-	* 3. Whether these items were cached or not */
-	AST *ast               = NULL;
+	* 1. Execution plan
+	* 2. Whether it was cached or not */
 	ExecutionPlan *plan    = NULL;
 	bool cached            = false;
 	ExecutionCtx *exec_ctx = ExecutionCtx_FromQuery(command_ctx->query);
 
-	ast = exec_ctx->ast;
 	plan = exec_ctx->plan;
 	ExecutionType exec_type = exec_ctx->exec_type;
 
@@ -53,17 +52,23 @@ void Graph_Profile(void *args) {
 		goto cleanup;
 	}
 
-	readonly = AST_ReadOnly(ast->root);
+	readonly = exec_ctx->readonly;
 
 	// Acquire the appropriate lock.
+	double timer[2];
+	simple_tic(timer);
 	if(readonly) {
 		Graph_AcquireReadLock(gc->g);
+		QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, simple_toc(timer) * 1000);
 	} else {
 		Graph_WriterEnter(gc->g);  // Single writer.
+		QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, simple_toc(timer) * 1000);
 		/* If this is a writer query `we need to re-open the graph key with write flag
 		* this notifies Redis that the key is "dirty" any watcher on that key will
 		* be notified. */
+		simple_tic(timer);
 		CommandCtx_ThreadSafeContextLock(command_ctx);
+		QueryCtx_AddPhaseTime(QUERY_PHASE_GIL, simple_toc(timer) * 1000);
 		{
 			GraphContext_MarkWriter(ctx, gc);
 		}
@@ -76,9 +81,13 @@ void Graph_Profile(void *args) {
 	if(cached) ResultSet_CachedExecution(result_set);
 	QueryCtx_SetResultSet(result_set);
 
-	ExecutionPlan_PreparePlan(plan);
+	ExecutionCtx_PreparePlan(exec_ctx);
+	plan = exec_ctx->plan;
+	QueryCtx_BeginExecution();
 	ExecutionPlan_Profile(plan);
+	QueryCtx_EndExecution();
 	QueryCtx_ForceUnlockCommit();
+	QueryCtx_AddPhaseTime(QUERY_PHASE_QUEUE, CommandCtx_GetQueueWait(command_ctx));
 	ExecutionPlan_Print(plan, ctx);
 
 cleanup:
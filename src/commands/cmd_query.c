@@ -10,13 +10,20 @@
 #include "../ast/ast.h"
 #include "../util/arr.h"
 #include "../util/cron.h"
+#include "../config.h"
 #include "../query_ctx.h"
 #include "../graph/graph.h"
 #include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../util/trace.h"
 #include "../util/cache/cache.h"
 #include "../util/thpool/pools.h"
+#include "../metrics/metrics.h"
 #include "../execution_plan/execution_plan.h"
+#include "../execution_plan/plan_estimate.h"
+#include "../execution_plan/execution_plan_build/execution_plan_modify.h"
 #include "execution_ctx.h"
+#include "query_cursor.h"
 
 // GraphQueryCtx stores the allocations required to execute a query.
 typedef struct {
@@ -26,8 +33,19 @@ typedef struct {
 	ExecutionCtx *exec_ctx;   // execution context
 	CommandCtx *command_ctx;  // command context
 	bool readonly_query;      // read only query
+	bool grouped;             // executed within a commit group
+	bool deferred;            // yielded its reader thread to cheaper queries
+	bool snapshot;            // write query reading the graph on its reader thread
+	uint64_t time_slice;      // milliseconds to run before yielding, 0 to run to completion
+	double slice_timer[2];    // time since the query last resumed
+	char *result_key;         // result cache key, NULL if the reply isn't cached
+	uint64_t result_epoch;    // graph write epoch the reply is cached against
+	bool result_hit;          // reply was served by the result cache
 } GraphQueryCtx;
 
+// number of records produced between time slice checks
+#define QUERY_SLICE_RECORDS 1024
+
 static GraphQueryCtx *GraphQueryCtx_New
 (
 	GraphContext *graph_ctx,
@@ -44,40 +62,138 @@ static GraphQueryCtx *GraphQueryCtx_New
 	ctx->query_ctx       =  QueryCtx_GetQueryCtx();
 	ctx->command_ctx     =  command_ctx;
 	ctx->readonly_query  =  readonly_query;
+	ctx->grouped         =  false;
+	ctx->deferred        =  false;
+	ctx->snapshot        =  false;
+	ctx->time_slice      =  0;
+	ctx->result_key      =  NULL;
+	ctx->result_epoch    =  0;
+	ctx->result_hit      =  false;
 
 	return ctx;
 }
 
 void static inline GraphQueryCtx_Free(GraphQueryCtx *ctx) {
 	ASSERT(ctx != NULL);
+	if(ctx->result_key) rm_free(ctx->result_key);
 	rm_free(ctx);
 }
 
+// CREATE CONSTRAINT ON (n:L) ASSERT n.prop IS UNIQUE
+// DROP CONSTRAINT ON (n:L) ASSERT n.prop IS UNIQUE
+static void _constraint_operation(GraphContext *gc, AST *ast, ExecutionType exec_type) {
+	const cypher_astnode_t *constraint_op = ast->root;
+	bool create = (exec_type == EXECUTION_TYPE_INDEX_CREATE);
+
+	// Retrieve strings from AST node
+	const cypher_astnode_t *identifier;
+	const cypher_astnode_t *label_node;
+	const cypher_astnode_t *exp;
+	bool unique;
+	if(create) {
+		identifier = cypher_ast_create_node_prop_constraint_get_identifier(constraint_op);
+		label_node = cypher_ast_create_node_prop_constraint_get_label(constraint_op);
+		exp = cypher_ast_create_node_prop_constraint_get_expression(constraint_op);
+		unique = cypher_ast_create_node_prop_constraint_is_unique(constraint_op);
+	} else {
+		identifier = cypher_ast_drop_node_prop_constraint_get_identifier(constraint_op);
+		label_node = cypher_ast_drop_node_prop_constraint_get_label(constraint_op);
+		exp = cypher_ast_drop_node_prop_constraint_get_expression(constraint_op);
+		unique = cypher_ast_drop_node_prop_constraint_is_unique(constraint_op);
+	}
+
+	if(!unique) {
+		ErrorCtx_SetError("ERR RedisGraph supports only uniqueness constraints.");
+		return;
+	}
+
+	// the constrained expression must be a property of the constrained node
+	const char *alias = cypher_ast_identifier_get_name(identifier);
+	if(cypher_astnode_type(exp) != CYPHER_AST_PROPERTY_OPERATOR ||
+	   cypher_astnode_type(cypher_ast_property_operator_get_expression(exp)) != CYPHER_AST_IDENTIFIER ||
+	   strcmp(alias, cypher_ast_identifier_get_name(
+				  cypher_ast_property_operator_get_expression(exp))) != 0) {
+		ErrorCtx_SetError("ERR Constraint must assert a property of '%s'.", alias);
+		return;
+	}
+
+	const char *label = cypher_ast_label_get_name(label_node);
+	const char *prop = cypher_ast_prop_name_get_value(
+						   cypher_ast_property_operator_get_prop_name(exp));
+
+	QueryCtx_LockForCommit();
+	if(create) {
+		UniqueConstraint *uc = NULL;
+		int res = GraphContext_AddConstraint(&uc, gc, label, prop);
+		if(res != INDEX_OK) {
+			ErrorCtx_SetError("ERR Unable to create constraint on :%s(%s): property is already constrained or holds duplicate values.",
+							  label, prop);
+		}
+	} else {
+		int res = GraphContext_DeleteConstraint(gc, label, prop);
+		if(res != INDEX_OK) {
+			ErrorCtx_SetError("ERR Unable to drop constraint on :%s(%s): no such constraint.",
+							  label, prop);
+		}
+	}
+	QueryCtx_UnlockCommit(NULL);
+}
+
 static void _index_operation(RedisModuleCtx *ctx, GraphContext *gc, AST *ast,
 							 ExecutionType exec_type) {
 	Index *idx = NULL;
 	const cypher_astnode_t *index_op = ast->root;
+	cypher_astnode_type_t root_type = cypher_astnode_type(index_op);
+	if(root_type == CYPHER_AST_CREATE_NODE_PROP_CONSTRAINT ||
+	   root_type == CYPHER_AST_DROP_NODE_PROP_CONSTRAINT) {
+		_constraint_operation(gc, ast, exec_type);
+		return;
+	}
+
 	if(exec_type == EXECUTION_TYPE_INDEX_CREATE) {
 		// Retrieve strings from AST node
 		const char *label = cypher_ast_label_get_name(cypher_ast_create_node_props_index_get_label(
 														  index_op));
-		const char *prop = cypher_ast_prop_name_get_value(cypher_ast_create_node_props_index_get_prop_name(
-															  index_op, 0));
+		uint prop_count = cypher_ast_create_node_props_index_nprops(index_op);
+		const char *props[prop_count];
+		for(uint i = 0; i < prop_count; i++) {
+			props[i] = cypher_ast_prop_name_get_value(
+						   cypher_ast_create_node_props_index_get_prop_name(index_op, i));
+		}
+
+		if(prop_count > COMPOSITE_INDEX_MAX_FIELDS) {
+			ErrorCtx_SetError("ERR Composite index on :%s supports up to %d properties.",
+							  label, COMPOSITE_INDEX_MAX_FIELDS);
+			return;
+		}
+
 		QueryCtx_LockForCommit();
-		if(GraphContext_AddIndex(&idx, gc, label, prop, IDX_EXACT_MATCH) == INDEX_OK) Index_Construct(idx);
+		int res;
+		if(prop_count > 1) {
+			// multiple properties make up a composite, ordered key
+			res = GraphContext_AddCompositeIndex(&idx, gc, label, props, prop_count);
+		} else {
+			res = GraphContext_AddIndex(&idx, gc, label, props[0], IDX_EXACT_MATCH);
+		}
+		// large labels are indexed in the background
+		if(res == INDEX_OK) Index_ConstructAsync(idx);
 		QueryCtx_UnlockCommit(NULL);
 	} else if(exec_type == EXECUTION_TYPE_INDEX_DROP) {
 		// Retrieve strings from AST node
 		const char *label = cypher_ast_label_get_name(cypher_ast_drop_node_props_index_get_label(index_op));
-		const char *prop = cypher_ast_prop_name_get_value(cypher_ast_drop_node_props_index_get_prop_name(
-															  index_op, 0));
+		// dropping a composite index drops each of its properties
+		uint prop_count = cypher_ast_drop_node_props_index_nprops(index_op);
 		QueryCtx_LockForCommit();
-		int res = GraphContext_DeleteIndex(gc, label, prop, IDX_EXACT_MATCH);
-		QueryCtx_UnlockCommit(NULL);
-
-		if(res != INDEX_OK) {
-			ErrorCtx_SetError("ERR Unable to drop index on :%s(%s): no such index.", label, prop);
+		for(uint i = 0; i < prop_count; i++) {
+			const char *prop = cypher_ast_prop_name_get_value(
+								   cypher_ast_drop_node_props_index_get_prop_name(index_op, i));
+			int res = GraphContext_DeleteIndex(gc, label, prop, IDX_EXACT_MATCH);
+			if(res != INDEX_OK) {
+				ErrorCtx_SetError("ERR Unable to drop index on :%s(%s): no such index.", label, prop);
+				break;
+			}
 		}
+		QueryCtx_UnlockCommit(NULL);
 	} else {
 		ErrorCtx_SetError("ERR Encountered unknown query execution type.");
 	}
@@ -91,12 +207,12 @@ static void _index_operation(RedisModuleCtx *ctx, GraphContext *gc, AST *ast,
 void QueryTimedOut(void *pdata) {
 	ASSERT(pdata);
 	ExecutionPlan *plan = (ExecutionPlan *)pdata;
-	ExecutionPlan_Drain(plan);
+	// write queries which began committing run to completion
+	ExecutionPlan_ExpireTimeout(plan);
 
-	/* Timer may have triggered after execution-plan ran to completion
-	 * in which case the original query thread had called ExecutionPlan_Free
-	 * decreasing the plan's ref count, but did not free the execution-plan
-	 * it is our responsibility to call ExecutionPlan_Free
+	/* Timer may have triggered while the original query thread was
+	 * releasing the execution-plan, too late to cancel the timeout,
+	 * in which case it is our responsibility to call ExecutionPlan_Free
 	 *
 	 * In case execution-plan timedout we'll call ExecutionPlan_Free
 	 * to drop plan's ref count. */
@@ -104,16 +220,128 @@ void QueryTimedOut(void *pdata) {
 }
 
 // set timeout for query execution
+// write queries time out up until their first commit, see QueryCtx_LockForCommit
+// the timeout is cancelled once the plan is released
 void Query_SetTimeOut(uint timeout, ExecutionPlan *plan) {
-	// increase execution plan ref count
-	ExecutionPlan_IncreaseRefCount(plan);
-	Cron_AddTask(timeout, QueryTimedOut, plan);
+	ExecutionPlan_ScheduleTimeout(plan, timeout, QueryTimedOut);
+	QueryCtx_SetTimedPlan(plan);
 }
 
 inline static bool _readonly_cmd_mode(CommandCtx *ctx) {
 	return strcasecmp(CommandCtx_GetCommandName(ctx), "graph.RO_QUERY") == 0;
 }
 
+static void _FinalizeQuery(GraphQueryCtx *gq_ctx, ResultSet *result_set,
+		QueryCursor *cursor);
+
+static void _ResumeQuery(void *args);
+
+// instantiate the query's ResultSet, formatted as requested by the command
+static ResultSet *_NewResultSet(GraphQueryCtx *gq_ctx) {
+	CommandCtx *command_ctx = gq_ctx->command_ctx;
+
+	bool compact = command_ctx->compact;
+	ResultSetFormatterType resultset_format = (compact) ? FORMATTER_COMPACT : FORMATTER_VERBOSE;
+	if(command_ctx->binary) resultset_format = FORMATTER_BINARY;
+	ResultSet *result_set = NewResultSet(gq_ctx->rm_ctx, resultset_format);
+	if(gq_ctx->exec_ctx->cached) ResultSet_CachedExecution(result_set); // indicate a cached execution
+	result_set->stats.sample_rate = QueryCtx_GetSampleRate();
+
+	QueryCtx_SetResultSet(result_set);
+	return result_set;
+}
+
+/* _ExecuteConflicted executes a write query anew, after writers committed
+ * in between its read phase and its commit, see QueryCtx_BeginSnapshot.
+ * The aborted execution committed nothing, its plan and records are discarded.
+ * The query holds the graph's writer access, no other writer interleaves. */
+static ResultSet *_ExecuteConflicted(GraphQueryCtx *gq_ctx, ResultSet *result_set) {
+	ExecutionCtx *exec_ctx = gq_ctx->exec_ctx;
+	CommandCtx *command_ctx = gq_ctx->command_ctx;
+
+	ErrorCtx_Clear();
+	ResultSet_Free(result_set);
+	result_set = _NewResultSet(gq_ctx);
+
+	ExecutionCtx_RenewPlan(exec_ctx);
+	ExecutionPlan *plan = exec_ctx->plan;
+	if(command_ctx->timeout != 0) Query_SetTimeOut(command_ctx->timeout, plan);
+	ExecutionCtx_PreparePlan(exec_ctx);
+
+	QueryCtx_BeginExecution();
+	result_set = ExecutionPlan_Execute(plan);
+	QueryCtx_EndExecution();
+
+	return result_set;
+}
+
+/* _ExecuteSlices runs a read query's execution plan, yielding the reader
+ * thread to queued queries once the query ran for longer than its time slice.
+ * The yielding query keeps writers out of the graph, and resumes once the
+ * queued queries had been picked up.
+ * Returns true if the plan is depleted, false if the query yielded. */
+static bool _ExecuteSlices(GraphQueryCtx *gq_ctx) {
+	ExecutionPlan *plan = gq_ctx->exec_ctx->plan;
+	CommandCtx *command_ctx = gq_ctx->command_ctx;
+
+	QueryCtx_BeginExecution();
+	while(!ExecutionPlan_ExecuteStep(plan, QUERY_SLICE_RECORDS)) {
+		double elapsed = simple_toc(gq_ctx->slice_timer) * 1000;
+		if(elapsed < gq_ctx->time_slice || ThreadPools_ReadersQueueSize() == 0) {
+			continue;
+		}
+
+		// yield, clearing this thread data
+		QueryCtx_EndExecution();
+		Graph_SuspendReadLock(gq_ctx->graph_ctx->g);
+		QueryCtx_SuspendAccounting();
+		QueryCtx_RemoveFromTLS();
+		CommandCtx_UntrackCtx(command_ctx);
+		CommandCtx_MarkQueued(command_ctx);
+
+		int res = ThreadPools_DeferWorkReader(_ResumeQuery, gq_ctx);
+		ASSERT(res == 0);
+		return false;
+	}
+	QueryCtx_EndExecution();
+
+	return true;
+}
+
+// resumes a read query which yielded its thread
+static void _ResumeQuery(void *args) {
+	ASSERT(args != NULL);
+
+	GraphQueryCtx  *gq_ctx       =  args;
+	GraphContext   *gc           =  gq_ctx->graph_ctx;
+	ExecutionCtx   *exec_ctx     =  gq_ctx->exec_ctx;
+	CommandCtx     *command_ctx  =  gq_ctx->command_ctx;
+
+	QueryCtx_SetTLS(gq_ctx->query_ctx);
+	QueryCtx_ResumeAccounting();
+	CommandCtx_TrackCtx(command_ctx);
+	CommandCtx_MarkDequeued(command_ctx);
+
+	double lock_timer[2];
+	simple_tic(lock_timer);
+	Graph_ResumeReadLock(gc->g);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, simple_toc(lock_timer) * 1000);
+	Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
+
+	simple_tic(gq_ctx->slice_timer);
+	if(!_ExecuteSlices(gq_ctx)) return;
+
+	// Emit error if query timed out.
+	if(ExecutionPlan_Drained(exec_ctx->plan)) {
+		ErrorCtx_SetError("Query timed out");
+		Metrics_QueryTimedOut();
+	}
+
+	ExecutionCtx_ReleasePlan(exec_ctx);
+
+	_FinalizeQuery(gq_ctx, QueryCtx_GetResultSet(), NULL);
+}
+
 /* _ExecuteQuery accepts a GraphQeuryCtx as an argument
  * it may be called directly by a reader thread or the Redis main thread,
  * or dispatched as a worker thread job. */
@@ -130,35 +358,67 @@ static void _ExecuteQuery(void *args) {
 	AST             *ast          =  exec_ctx->ast;
 	ExecutionPlan   *plan         =  exec_ctx->plan;
 	ExecutionType   exec_type     =  exec_ctx->exec_type;
+	QueryCursor     *cursor       =  NULL;
 
-	// if we have migrated to a writer thread,
+	TRACE_PROBE2(query__start, gc->graph_name, command_ctx->query);
+
+	// if we have migrated to a writer thread or were deferred,
 	// update thread-local storage and track the CommandCtx
-	if(command_ctx->thread == EXEC_THREAD_WRITER) {
+	if(command_ctx->thread == EXEC_THREAD_WRITER || gq_ctx->deferred) {
 		QueryCtx_SetTLS(query_ctx);
+		QueryCtx_ResumeAccounting();
 		CommandCtx_TrackCtx(command_ctx);
+		CommandCtx_MarkDequeued(command_ctx);
 	}
 
 	// instantiate the query ResultSet
-	bool compact = command_ctx->compact;
-	ResultSetFormatterType resultset_format = (compact) ? FORMATTER_COMPACT : FORMATTER_VERBOSE;
-	ResultSet *result_set = NewResultSet(rm_ctx, resultset_format);
-	if(exec_ctx->cached) ResultSet_CachedExecution(result_set); // indicate a cached execution
-
-	QueryCtx_SetResultSet(result_set);
+	ResultSet *result_set = _NewResultSet(gq_ctx);
 
 	// acquire the appropriate lock
+	double lock_timer[2];
+	simple_tic(lock_timer);
 	if(readonly) {
 		Graph_AcquireReadLock(gc->g);
+		QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, simple_toc(lock_timer) * 1000);
 	} else {
 		/* if this is a writer query `we need to re-open the graph key with write flag
 		 * this notifies Redis that the key is "dirty" any watcher on that key will
 		 * be notified */
 		CommandCtx_ThreadSafeContextLock(command_ctx);
+		QueryCtx_AddPhaseTime(QUERY_PHASE_GIL, simple_toc(lock_timer) * 1000);
 		{
 			GraphContext_MarkWriter(rm_ctx, gc);
 		}
 		CommandCtx_ThreadSafeContextUnlock(command_ctx);
-		Graph_WriterEnter(gc->g);  // single writer
+		simple_tic(lock_timer);
+		// a commit group enters the graph as the single writer of its queries
+		if(!gq_ctx->grouped) {
+			if(gq_ctx->snapshot) {
+				// the read phase runs under the read lock, the query enters
+				// the graph as its writer once it commits
+				Graph_AcquireReadLock(gc->g);
+				QueryCtx_BeginSnapshot(Graph_WriteEpoch(gc->g));
+			} else {
+				Graph_WriterEnter(gc->g);  // single writer
+			}
+		}
+		QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, simple_toc(lock_timer) * 1000);
+	}
+
+	// serve the reply from the result cache if it was recorded
+	// against the graph's current write epoch
+	if(gq_ctx->result_key) {
+		uint64_t row_count;
+		gq_ctx->result_epoch = Graph_WriteEpoch(gc->g);
+		gq_ctx->result_hit = ResultCache_Get(gc->result_cache,
+				gq_ctx->result_key, gq_ctx->result_epoch, &result_set->reply,
+				&row_count);
+		if(gq_ctx->result_hit) {
+			// the plan isn't executed, it is freed along with the execution context
+			ResultSet_CachedResult(result_set, row_count);
+			_FinalizeQuery(gq_ctx, result_set, NULL);
+			return;
+		}
 	}
 
 	if(exec_type == EXECUTION_TYPE_QUERY) {  // query operation
@@ -166,33 +426,153 @@ static void _ExecuteQuery(void *args) {
 		// avoid resetting policies between readers and writers
 		Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
 
-		ExecutionPlan_PreparePlan(plan);
-		result_set = ExecutionPlan_Execute(plan);
+		// a reused plan replaced by a fresh copy must be timed anew
+		if(ExecutionCtx_PreparePlan(exec_ctx)) {
+			plan = exec_ctx->plan;
+			if(command_ctx->timeout != 0) {
+				Query_SetTimeOut(command_ctx->timeout, plan);
+			}
+		}
 
-		// Emit error if query timed out.
-		if(ExecutionPlan_Drained(plan)) ErrorCtx_SetError("Query timed out");
+		// sampled executions are aggregated once the plan is released
+		// cursors free their plan instead, their executions aren't sampled
+		if(command_ctx->cursor_count == 0) ExecutionCtx_SamplePlan(exec_ctx);
+
+		if(command_ctx->cursor_count > 0) {
+			// produce the first batch, suspending the plan if it isn't depleted
+			QueryCtx_BeginExecution();
+			ExecutionPlan_Init(plan);
+			bool depleted = ExecutionPlan_ExecuteStep(plan,
+					command_ctx->cursor_count);
+			QueryCtx_EndExecution();
+			if(ExecutionPlan_Drained(plan)) {
+				ErrorCtx_SetError("Query timed out");
+				Metrics_QueryTimedOut();
+			} else if(!depleted) {
+				cursor = QueryCursor_New(gc, exec_ctx, result_set,
+						command_ctx->query, command_ctx->cursor_count);
+			}
+		} else if(gq_ctx->time_slice > 0) {
+			// execute in time slices, the query may resume on another thread
+			ExecutionPlan_Init(plan);
+			simple_tic(gq_ctx->slice_timer);
+			if(!_ExecuteSlices(gq_ctx)) return;
+
+			// Emit error if query timed out.
+			if(ExecutionPlan_Drained(plan)) {
+				ErrorCtx_SetError("Query timed out");
+				Metrics_QueryTimedOut();
+			}
+		} else {
+			QueryCtx_BeginExecution();
+			result_set = ExecutionPlan_Execute(plan);
+			QueryCtx_EndExecution();
+
+			if(gq_ctx->snapshot && QueryCtx_SnapshotConflicted()) {
+				Metrics_WriteConflict();
+				result_set = _ExecuteConflicted(gq_ctx, result_set);
+				plan = exec_ctx->plan;
+			}
+
+			// Emit error if query timed out.
+			if(ExecutionPlan_Drained(plan)) {
+				ErrorCtx_SetError("Query timed out");
+				Metrics_QueryTimedOut();
+			}
+		}
 
-		ExecutionPlan_Free(plan);
-		exec_ctx->plan = NULL;
+		if(cursor == NULL) ExecutionCtx_ReleasePlan(exec_ctx);
 	} else if(exec_type == EXECUTION_TYPE_INDEX_CREATE ||
 			  exec_type == EXECUTION_TYPE_INDEX_DROP) {
+		QueryCtx_BeginExecution();
 		_index_operation(rm_ctx, gc, ast, exec_type);
+		QueryCtx_EndExecution();
 	} else {
 		ASSERT("Unhandled query type" && false);
 	}
 
+	_FinalizeQuery(gq_ctx, result_set, cursor);
+}
+
+// replies to the client and releases the query's resources
+static void _FinalizeQuery
+(
+	GraphQueryCtx *gq_ctx,
+	ResultSet *result_set,
+	QueryCursor *cursor
+) {
+	GraphContext    *gc           =  gq_ctx->graph_ctx;
+	bool            readonly      =  gq_ctx->readonly_query;
+	ExecutionCtx    *exec_ctx     =  gq_ctx->exec_ctx;
+	CommandCtx      *command_ctx  =  gq_ctx->command_ctx;
+
 	QueryCtx_ForceUnlockCommit();
+	QueryCtx_AddPhaseTime(QUERY_PHASE_QUEUE, CommandCtx_GetQueueWait(command_ctx));
 
 	// send result-set back to client
-	ResultSet_Reply(result_set);
+	double reply_timer[2];
+	simple_tic(reply_timer);
+	if(command_ctx->cursor_count > 0) {
+		ResultSet_ReplyWithCursor(result_set, (cursor) ? cursor->id : 0);
+	} else {
+		ResultSet_Reply(result_set);
+	}
+	double reply_time = simple_toc(reply_timer);
+
+	// record the reply while the graph is still locked against writers
+	if(gq_ctx->result_key && !gq_ctx->result_hit && !ErrorCtx_EncounteredError()) {
+		size_t len;
+		const char *reply = ResultSet_RowsReply(result_set, &len);
+		ResultCache_Insert(gc->result_cache, gq_ctx->result_key,
+				gq_ctx->result_epoch, reply, len, ResultSet_RowCount(result_set));
+	}
+
+	// a write query which didn't commit still holds its snapshot's read lock
+	if(readonly || (gq_ctx->snapshot && QueryCtx_InSnapshot())) {
+		Graph_ReleaseLock(gc->g); // release read lock
+	} else if(!gq_ctx->grouped) {
+		Graph_WriterLeave(gc->g);
+	}
 
-	if(readonly) Graph_ReleaseLock(gc->g); // release read lock
-	else Graph_WriterLeave(gc->g);
+	// the serialized reply doesn't reference the graph
+	// hand it over once the lock is released
+	simple_tic(reply_timer);
+	ResultSet_Flush(result_set);
+	reply_time += simple_toc(reply_timer);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_REPLY, reply_time * 1000);
 
 	// log query to slowlog
 	SlowLog *slowlog = GraphContext_GetSlowLog(gc);
 	SlowLog_Add(slowlog, command_ctx->command_name, command_ctx->query,
-				QueryCtx_GetExecutionTime(), NULL);
+				QueryCtx_GetExecutionTime(), Alloc_GetPeakConsumption(),
+				CommandCtx_GetQueueWait(command_ctx), QueryCtx_GetPhaseTimes(), NULL);
+
+	// aggregate query statistics
+	QueryStats *query_stats = GraphContext_GetQueryStats(gc);
+	QueryStats_Add(query_stats, command_ctx->query, QueryCtx_GetExecutionTime(),
+				   ResultSet_RowCount(result_set), exec_ctx->cached,
+				   QueryCtx_GetLockWait());
+
+	// record end to end latency, including time spent in queue
+	MetricsCommand cmd = _readonly_cmd_mode(command_ctx) ?
+		METRICS_CMD_RO_QUERY : METRICS_CMD_QUERY;
+	Metrics_RecordLatency(GraphContext_GetMetrics(gc), cmd,
+			QueryCtx_GetExecutionTime() + CommandCtx_GetQueueWait(command_ctx));
+	Metrics_AddSyncTime(QueryCtx_GetPhaseTime(QUERY_PHASE_SYNC));
+	Metrics_AddGILWaitTime(QueryCtx_GetPhaseTime(QUERY_PHASE_GIL));
+
+	TRACE_PROBE3(query__done, gc->graph_name, command_ctx->query,
+				 (uint64_t)(QueryCtx_GetExecutionTime() * 1000));
+
+	if(cursor) {
+		// the cursor owns the graph, execution, query contexts and result-set
+		// release it before unblocking the client, which may read it right away
+		QueryCursor_Release(cursor);
+		CommandCtx_Free(command_ctx);
+		ErrorCtx_Clear();
+		GraphQueryCtx_Free(gq_ctx);
+		return;
+	}
 
 	// clean up
 	ExecutionCtx_Free(exec_ctx);
@@ -204,6 +584,49 @@ static void _ExecuteQuery(void *args) {
 	GraphQueryCtx_Free(gq_ctx);
 }
 
+/* _DrainWriters executes the write queries queued on a graph,
+ * up to GROUP_COMMIT_SIZE of them back to back as the graph's single writer,
+ * each query locks the GIL and the graph's write lock only to commit. */
+static void _DrainWriters(void *args) {
+	ASSERT(args != NULL);
+
+	GraphContext *gc = args;
+	GraphWriteGroup *wg = &gc->write_group;
+
+	uint64_t group_size;
+	Config_Option_get(Config_GROUP_COMMIT_SIZE, &group_size);
+	if(group_size < 1) group_size = 1;
+	GraphQueryCtx **group = rm_malloc(sizeof(GraphQueryCtx *) * group_size);
+
+	while(true) {
+		// dequeue the next group
+		pthread_mutex_lock(&wg->lock);
+		uint32_t queued = array_len(wg->queued);
+		if(queued == 0) {
+			wg->scheduled = false;
+			pthread_mutex_unlock(&wg->lock);
+			break;
+		}
+		uint32_t n = (queued < group_size) ? queued : group_size;
+		memcpy(group, wg->queued, sizeof(GraphQueryCtx *) * n);
+		memmove(wg->queued, wg->queued + n, sizeof(GraphQueryCtx *) * (queued - n));
+		wg->queued = array_trimm_len(wg->queued, queued - n);
+		pthread_mutex_unlock(&wg->lock);
+
+		// a single writer doesn't benefit from grouping
+		bool grouped = (n > 1);
+		if(grouped) QueryCtx_BeginCommitGroup(gc);
+		for(uint32_t i = 0; i < n; i++) {
+			group[i]->grouped = grouped;
+			_ExecuteQuery(group[i]);
+		}
+		if(grouped) QueryCtx_EndCommitGroup(gc);
+	}
+
+	rm_free(group);
+	GraphContext_Release(gc);
+}
+
 static void _DelegateWriter(GraphQueryCtx *gq_ctx) {
 	ASSERT(gq_ctx != NULL);
 
@@ -214,6 +637,7 @@ static void _DelegateWriter(GraphQueryCtx *gq_ctx) {
 	// write queries will be executed on a dedicated writer thread,
 	// clear this thread data
 	ErrorCtx_Clear();
+	QueryCtx_SuspendAccounting();
 	QueryCtx_RemoveFromTLS();
 
 	// untrack the CommandCtx
@@ -221,24 +645,140 @@ static void _DelegateWriter(GraphQueryCtx *gq_ctx) {
 
 	// update execution thread to writer
 	gq_ctx->command_ctx->thread = EXEC_THREAD_WRITER;
+	CommandCtx_MarkQueued(gq_ctx->command_ctx);
+
+	uint64_t group_size;
+	Config_Option_get(Config_GROUP_COMMIT_SIZE, &group_size);
+	if(group_size <= 1) {
+		// dispatch work to the writer thread
+		int res = ThreadPools_AddWorkWriter(_ExecuteQuery, gq_ctx,
+				gq_ctx->graph_ctx->graph_name);
+		ASSERT(res == 0);
+		return;
+	}
+
+	// queue the query on its graph, writers queued while a group is
+	// pending are committed along with it
+	GraphContext *gc = gq_ctx->graph_ctx;
+	GraphWriteGroup *wg = &gc->write_group;
+	pthread_mutex_lock(&wg->lock);
+	wg->queued = array_append(wg->queued, gq_ctx);
+	bool schedule = !wg->scheduled;
+	wg->scheduled = true;
+	pthread_mutex_unlock(&wg->lock);
+
+	if(schedule) {
+		// the drain job holds its own reference, as queued queries
+		// release theirs as they complete
+		GraphContext_Retain(gc);
+		int res = ThreadPools_AddWorkWriter(_DrainWriters, gc, gc->graph_name);
+		ASSERT(res == 0);
+	}
+}
+
+// returns true if plan is expected to be expensive, exceeding the cost budget
+// or, absent a budget, performing full scans or variable length traversals
+static bool _costly_plan(ExecutionPlan *plan) {
+	// plans are measured against the cost budget when one is set
+	uint64_t budget;
+	Config_Option_get(Config_QUERY_COST_BUDGET, &budget);
+	if(budget > 0) return ExecutionPlan_Estimate(plan) > budget;
+
+	const OPType costly_ops[] = {OPType_ALL_NODE_SCAN, OPType_NODE_BY_LABEL_SCAN,
+								 OPType_CONDITIONAL_VAR_LEN_TRAVERSE,
+								 OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO};
+	return ExecutionPlan_LocateOpMatchingType(plan->root, costly_ops, 4) != NULL;
+}
+
+// yield the reader thread to queued queries, resuming the query
+// once they had been picked up
+static void _DeferReader(GraphQueryCtx *gq_ctx) {
+	ASSERT(gq_ctx != NULL);
 
-	// dispatch work to the writer thread
-	int res = ThreadPools_AddWorkWriter(_ExecuteQuery, gq_ctx);
+	// clear this thread data, the query resumes on another reader
+	ErrorCtx_Clear();
+	QueryCtx_SuspendAccounting();
+	QueryCtx_RemoveFromTLS();
+	CommandCtx_UntrackCtx(gq_ctx->command_ctx);
+
+	gq_ctx->deferred = true;
+	CommandCtx_MarkQueued(gq_ctx->command_ctx);
+
+	int res = ThreadPools_DeferWorkReader(_ExecuteQuery, gq_ctx);
 	ASSERT(res == 0);
 }
 
+// returns true if the read phase of a write query is to run on its reader
+// thread, committing as the graph's writer, see QueryCtx_BeginSnapshot
+// cheap writes are left to the writer thread, committed along with
+// the queued writers, conflicting executions renew their plan from the cache
+static bool _split_writer(CommandCtx *command_ctx, ExecutionCtx *exec_ctx) {
+	bool split;
+	Config_Option_get(Config_SPLIT_WRITE_QUERIES, &split);
+	if(!split || command_ctx->thread != EXEC_THREAD_READER) return false;
+	if(exec_ctx->exec_type != EXECUTION_TYPE_QUERY || exec_ctx->pool == NULL) {
+		return false;
+	}
+	return _costly_plan(exec_ctx->plan);
+}
+
+// returns the result cache key of the query's reply,
+// NULL if its reply mustn't be cached
+static char *_ResultCacheKey(CommandCtx *command_ctx, ExecutionCtx *exec_ctx,
+		bool prepared) {
+	if(!ResultCache_Enabled()) return NULL;
+
+	// prepared statements bind parameters missing from the query string
+	// cursors reply in batches, sampled replies differ between executions
+	if(prepared || command_ctx->cursor_count > 0) return NULL;
+	if(command_ctx->sample_rate < 1) return NULL;
+	if(!exec_ctx->readonly || exec_ctx->exec_type != EXECUTION_TYPE_QUERY) return NULL;
+	if(!exec_ctx->deterministic) return NULL;
+
+	if(command_ctx->result_cache == RESULT_CACHE_OFF) return NULL;
+	if(command_ctx->result_cache == RESULT_CACHE_DEFAULT) {
+		bool opt_in;
+		Config_Option_get(Config_RESULT_CACHE_OPT_IN, &opt_in);
+		if(opt_in) return NULL;
+	}
+
+	// replies differ between formats, the query string includes its parameters
+	char format = (command_ctx->binary) ? 'b' : (command_ctx->compact) ? 'c' : 'v';
+	size_t len = strlen(command_ctx->query);
+	char *key = rm_malloc(len + 2);
+	key[0] = format;
+	memcpy(key + 1, command_ctx->query, len + 1);
+	return key;
+}
+
+// returns an execution context for the command's prepared statement
+// handing the bound parameters over to the query context
+static ExecutionCtx *_BindStatement(CommandCtx *command_ctx) {
+	ExecutionCtx *exec_ctx = PreparedStatement_Bind(command_ctx->statement,
+			command_ctx->params);
+	command_ctx->params = NULL;
+
+	PreparedStatement_Release(command_ctx->statement);
+	command_ctx->statement = NULL;
+	return exec_ctx;
+}
+
 void Graph_Query(void *args) {
 	CommandCtx *command_ctx = (CommandCtx *)args;
 	RedisModuleCtx *ctx     = CommandCtx_GetRedisCtx(command_ctx);
 	GraphContext *gc        = CommandCtx_GetGraphContext(command_ctx);
 
 	CommandCtx_TrackCtx(command_ctx);
+	CommandCtx_MarkDequeued(command_ctx);
 	QueryCtx_SetGlobalExecutionCtx(command_ctx);
 
 	QueryCtx_BeginTimer(); // start query timing
 
 	// parse query parameters and build an execution plan or retrieve it from the cache
-	ExecutionCtx *exec_ctx = ExecutionCtx_FromQuery(command_ctx->query);
+	// prepared statements bind their parameters to the statement's plan instead
+	bool prepared = (command_ctx->statement != NULL);
+	ExecutionCtx *exec_ctx = (command_ctx->statement) ?
+		_BindStatement(command_ctx) : ExecutionCtx_FromQuery(command_ctx->query);
 
 	// if there were any query compile time errors, report them
 	if(ErrorCtx_EncounteredError()) {
@@ -247,7 +787,7 @@ void Graph_Query(void *args) {
 	}
 	if(exec_ctx->exec_type == EXECUTION_TYPE_INVALID) goto cleanup;
 
-	bool readonly = AST_ReadOnly(exec_ctx->ast->root);
+	bool readonly = exec_ctx->readonly;
 
 	// write query executing via GRAPH.RO_QUERY isn't allowed
 	if(!readonly && _readonly_cmd_mode(command_ctx)) {
@@ -256,21 +796,72 @@ void Graph_Query(void *args) {
 		goto cleanup;
 	}
 
+	// cursors suspend read-only queries only
+	if(command_ctx->cursor_count > 0 &&
+	   (!readonly || exec_ctx->exec_type != EXECUTION_TYPE_QUERY)) {
+		ErrorCtx_SetError("CURSOR is supported only for read-only queries");
+		ErrorCtx_EmitException();
+		goto cleanup;
+	}
+
+	// sampled scans approximate the results of read-only queries only
+	if(command_ctx->sample_rate < 1 &&
+	   (!readonly || exec_ctx->exec_type != EXECUTION_TYPE_QUERY)) {
+		ErrorCtx_SetError("SAMPLE is supported only for read-only queries");
+		ErrorCtx_EmitException();
+		goto cleanup;
+	}
+
+	// admission control, while readers are busy a costly read query
+	// is either rejected or deferred behind the queued queries
+	// deferred queries don't count as busy, or they'd keep deferring each other
+	bool admit_later = false;
+	if(readonly && command_ctx->thread == EXEC_THREAD_READER &&
+	   exec_ctx->exec_type == EXECUTION_TYPE_QUERY &&
+	   ThreadPools_ReadersPriorityQueueSize() > 0 && _costly_plan(exec_ctx->plan)) {
+		bool reject;
+		uint64_t budget;
+		Config_Option_get(Config_REJECT_OVER_BUDGET, &reject);
+		Config_Option_get(Config_QUERY_COST_BUDGET, &budget);
+		if(reject && budget > 0) {
+			Metrics_QueryRejected();
+			ErrorCtx_SetError("Query estimated cost exceeds QUERY_COST_BUDGET while the server is busy");
+			ErrorCtx_EmitException();
+			goto cleanup;
+		}
+		admit_later = true;
+	}
+
 	// set the query timeout if one was specified
-	if(command_ctx->timeout != 0) {
-		// disallow timeouts on write operations to avoid leaving the graph in an inconsistent state
-		if(readonly) Query_SetTimeOut(command_ctx->timeout, exec_ctx->plan);
+	if(command_ctx->timeout != 0 && exec_ctx->exec_type == EXECUTION_TYPE_QUERY) {
+		Query_SetTimeOut(command_ctx->timeout, exec_ctx->plan);
 	}
 
 	// populate the container struct for invoking _ExecuteQuery.
 	GraphQueryCtx *gq_ctx = GraphQueryCtx_New(gc, ctx, exec_ctx, command_ctx,
 											  readonly);
+	gq_ctx->result_key = _ResultCacheKey(command_ctx, exec_ctx, prepared);
+
+	// read queries executing on a reader thread may be time sliced
+	if(readonly && command_ctx->thread == EXEC_THREAD_READER) {
+		Config_Option_get(Config_QUERY_TIME_SLICE, &gq_ctx->time_slice);
+	}
 
 	// if 'thread' is redis main thread, continue running
 	// if readonly is true we're executing on a worker thread from
-	// the read-only threadpool
-	if(readonly || command_ctx->thread == EXEC_THREAD_MAIN) _ExecuteQuery(gq_ctx);
-	else _DelegateWriter(gq_ctx);
+	// the read-only threadpool, expensive queries let queued queries
+	// execute ahead of them
+	if(command_ctx->thread == EXEC_THREAD_MAIN) {
+		_ExecuteQuery(gq_ctx);
+	} else if(readonly) {
+		if(admit_later) _DeferReader(gq_ctx);
+		else _ExecuteQuery(gq_ctx);
+	} else if(_split_writer(command_ctx, exec_ctx)) {
+		gq_ctx->snapshot = true;
+		_ExecuteQuery(gq_ctx);
+	} else {
+		_DelegateWriter(gq_ctx);
+	}
 
 	return;
 
@@ -282,3 +873,122 @@ cleanup:
 	QueryCtx_Free(); // Reset the QueryCtx and free its allocations.
 	ErrorCtx_Clear();
 }
+
+// executes a single query of a batch, replying with its result-set or error
+// the caller holds the graph's read lock
+static void _ExecuteBatchQuery(CommandCtx *command_ctx, RedisModuleCtx *ctx,
+		double lock_wait) {
+	GraphContext *gc = CommandCtx_GetGraphContext(command_ctx);
+
+	QueryCtx_SetGlobalExecutionCtx(command_ctx);
+	QueryCtx_BeginTimer(); // start query timing
+	QueryCtx_AddPhaseTime(QUERY_PHASE_LOCK, lock_wait);
+
+	// repeated queries of a batch are resolved by the plan cache
+	ExecutionCtx *exec_ctx = ExecutionCtx_FromQuery(command_ctx->query);
+
+	if(!ErrorCtx_EncounteredError()) {
+		if(exec_ctx->exec_type == EXECUTION_TYPE_INVALID) {
+			ErrorCtx_SetError("Failed to parse query");
+		} else if(!exec_ctx->readonly ||
+				  exec_ctx->exec_type != EXECUTION_TYPE_QUERY) {
+			ErrorCtx_SetError("graph.MULTI_QUERY is to be executed only on read-only queries");
+		}
+	}
+
+	// each query of the batch must reply exactly once
+	if(ErrorCtx_EncounteredError()) {
+		ErrorCtx_EmitException();
+		ExecutionCtx_Free(exec_ctx);
+		QueryCtx_Free();
+		return;
+	}
+
+	bool compact = command_ctx->compact;
+	ResultSetFormatterType resultset_format = (compact) ? FORMATTER_COMPACT : FORMATTER_VERBOSE;
+	ResultSet *result_set = NewResultSet(ctx, resultset_format);
+	if(exec_ctx->cached) ResultSet_CachedExecution(result_set); // indicate a cached execution
+	QueryCtx_SetResultSet(result_set);
+
+	ExecutionCtx_PreparePlan(exec_ctx);
+	ExecutionPlan *plan = exec_ctx->plan;
+	if(command_ctx->timeout != 0) Query_SetTimeOut(command_ctx->timeout, plan);
+	ExecutionCtx_SamplePlan(exec_ctx);
+
+	QueryCtx_BeginExecution();
+	result_set = ExecutionPlan_Execute(plan);
+	QueryCtx_EndExecution();
+
+	// Emit error if query timed out.
+	if(ExecutionPlan_Drained(plan)) {
+		ErrorCtx_SetError("Query timed out");
+		Metrics_QueryTimedOut();
+	}
+
+	ExecutionCtx_ReleasePlan(exec_ctx);
+
+	// errors are replied directly, preceding replies are handed over first
+	double reply_timer[2];
+	simple_tic(reply_timer);
+	ResultSet_Reply(result_set);
+	ResultSet_Flush(result_set);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_REPLY, simple_toc(reply_timer) * 1000);
+
+	// log query to slowlog
+	SlowLog *slowlog = GraphContext_GetSlowLog(gc);
+	SlowLog_Add(slowlog, command_ctx->command_name, command_ctx->query,
+				QueryCtx_GetExecutionTime(), Alloc_GetPeakConsumption(),
+				CommandCtx_GetQueueWait(command_ctx), QueryCtx_GetPhaseTimes(), NULL);
+
+	// aggregate query statistics
+	QueryStats *query_stats = GraphContext_GetQueryStats(gc);
+	QueryStats_Add(query_stats, command_ctx->query, QueryCtx_GetExecutionTime(),
+				   ResultSet_RowCount(result_set), exec_ctx->cached,
+				   QueryCtx_GetLockWait());
+
+	Metrics_RecordLatency(GraphContext_GetMetrics(gc), METRICS_CMD_RO_QUERY,
+			QueryCtx_GetExecutionTime());
+	Metrics_AddSyncTime(QueryCtx_GetPhaseTime(QUERY_PHASE_SYNC));
+	Metrics_AddGILWaitTime(QueryCtx_GetPhaseTime(QUERY_PHASE_GIL));
+
+	ExecutionCtx_Free(exec_ctx);
+	QueryCtx_Free(); // reset the QueryCtx and free its allocations
+	ErrorCtx_Clear();
+	ResultSet_Free(result_set);
+}
+
+/* Graph_MultiQuery executes a batch of read queries within a single job,
+ * under a single acquisition of the graph's read lock,
+ * replying with an array holding each query's result-set or error. */
+void Graph_MultiQuery(void *args) {
+	CommandCtx *command_ctx = (CommandCtx *)args;
+	RedisModuleCtx *ctx     = CommandCtx_GetRedisCtx(command_ctx);
+	GraphContext *gc        = CommandCtx_GetGraphContext(command_ctx);
+
+	ASSERT(command_ctx->batch != NULL);
+	ASSERT(command_ctx->query == NULL);
+
+	CommandCtx_TrackCtx(command_ctx);
+	CommandCtx_MarkDequeued(command_ctx);
+
+	uint count = array_len(command_ctx->batch);
+	RedisModule_ReplyWithArray(ctx, count);
+
+	double lock_timer[2];
+	simple_tic(lock_timer);
+	Graph_AcquireReadLock(gc->g);
+	double lock_wait = simple_toc(lock_timer) * 1000;
+	Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
+
+	for(uint i = 0; i < count; i++) {
+		command_ctx->query = command_ctx->batch[i];
+		// lock acquisition is attributed to the first query
+		_ExecuteBatchQuery(command_ctx, ctx, (i == 0) ? lock_wait : 0);
+	}
+	command_ctx->query = NULL;
+
+	Graph_ReleaseLock(gc->g);
+
+	GraphContext_Release(gc);
+	CommandCtx_Free(command_ctx);
+}
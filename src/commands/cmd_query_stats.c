@@ -0,0 +1,43 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../graph/graphcontext.h"
+#include "../slow_log/query_stats.h"
+
+// GRAPH.QUERYSTATS <graph> [RESET]
+// replies with the graph's per query fingerprint statistics
+// or forgets all of them when RESET is specified
+int Graph_QueryStats(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 2 && argc != 3) return RedisModule_WrongArity(ctx);
+
+	bool reset = false;
+	if(argc == 3) {
+		const char *arg = RedisModule_StringPtrLen(argv[2], NULL);
+		if(strcasecmp(arg, "RESET") != 0) {
+			RedisModule_ReplyWithError(ctx, "Unknown GRAPH.QUERYSTATS subcommand");
+			return REDISMODULE_OK;
+		}
+		reset = true;
+	}
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], true, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	QueryStats *stats = GraphContext_GetQueryStats(gc);
+	if(reset) {
+		QueryStats_Reset(stats);
+		RedisModule_ReplyWithSimpleString(ctx, "OK");
+	} else {
+		QueryStats_Reply(stats, ctx);
+	}
+
+	GraphContext_Release(gc);
+	return REDISMODULE_OK;
+}
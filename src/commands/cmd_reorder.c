@@ -0,0 +1,230 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/undirected.h"
+#include "../algorithms/node_order.h"
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+
+// names of node orderings, indexed by NodeOrderPolicy
+static const char *_policy_names[] = {"DEGREE", "RCM", "COMMUNITY"};
+
+// reorder context object
+typedef struct {
+	GraphContext *gc;              // graph to reorder
+	NodeOrderPolicy policy;        // node ordering
+	bool edges;                    // cluster edges by relation type instead
+	RedisModuleBlockedClient *bc;  // blocked client
+} ReorderCtx;
+
+// computes the graph's live nodes in their new order
+// caller holds the graph read lock
+static GrB_Info _ComputeOrder(Graph *g, NodeOrderPolicy policy, NodeID **order) {
+	GrB_Info info;
+	GrB_Matrix S = GrB_NULL;
+	GrB_Index *mapping = NULL;
+	GrB_Index *rows = NULL;
+
+	*order = NULL;
+	info = Undirected(&S, &mapping, Graph_GetAdjacencyMatrix(g), GrB_NULL);
+	if(info != GrB_SUCCESS) return info;
+
+	info = NodeOrder(&rows, S, policy);
+	GrB_free(&S);
+	if(info != GrB_SUCCESS) return info;
+
+	// IDs of deleted nodes are discarded
+	GrB_Index dim = Graph_RequiredMatrixDim(g);
+	uint64_t node_count = Graph_NodeCount(g);
+	NodeID *o = rm_malloc(sizeof(NodeID) * MAX(node_count, 1));
+
+	uint64_t n = 0;
+	for(GrB_Index i = 0; i < dim; i++) {
+		Node node = GE_NEW_NODE();
+		if(Graph_GetNode(g, rows[i], &node)) o[n++] = rows[i];
+	}
+	ASSERT(n == node_count);
+
+	rm_free(rows);
+	*order = o;
+	return GrB_SUCCESS;
+}
+
+// relabels the graph's nodes by 'order' and rebuilds every structure
+// keyed by node IDs, caller holds the GIL and the graph write lock
+static void _ReorderNodes(GraphContext *gc, const NodeID *order) {
+	Graph_PermuteNodes(gc->g, order);
+
+	// columns and weight matrices are laid out by node ID
+	GraphContext_DropColumns(gc);
+
+	// indices and constraints are keyed by node ID
+	QueryCtx_SetGraphCtx(gc);
+	uint count = array_len(gc->node_schemas);
+	for(uint i = 0; i < count; i++) {
+		Schema *s = gc->node_schemas[i];
+		if(s->index) Index_Construct(s->index);
+		if(s->fulltextIdx) Index_Construct(s->fulltextIdx);
+		if(s->vectorIdx) Index_Construct(s->vectorIdx);
+		Schema_PopulateConstraints(s, gc->g);
+	}
+
+	// relationship indices record their edges' endpoints
+	count = array_len(gc->relation_schemas);
+	for(uint i = 0; i < count; i++) {
+		Schema *s = gc->relation_schemas[i];
+		if(s->index) Index_Construct(s->index);
+	}
+	QueryCtx_Free();
+}
+
+// clusters the graph's edges by relation type and rebuilds every structure
+// keyed by edge IDs, caller holds the GIL and the graph write lock
+static uint64_t _ClusterEdges(GraphContext *gc) {
+	uint64_t relabeled = Graph_ClusterEdges(gc->g);
+
+	// relationship indices are keyed by edge ID
+	QueryCtx_SetGraphCtx(gc);
+	uint count = array_len(gc->relation_schemas);
+	for(uint i = 0; i < count; i++) {
+		Schema *s = gc->relation_schemas[i];
+		if(s->index) Index_Construct(s->index);
+	}
+	QueryCtx_Free();
+
+	return relabeled;
+}
+
+// relabels the graph's edges on the graph's writer thread
+static void _Graph_ReorderEdges(ReorderCtx *reorder_ctx, RedisModuleCtx *ctx) {
+	GraphContext *gc = reorder_ctx->gc;
+
+	// writers maintain indices while holding both locks
+	// acquiring the write lock invalidates open cursors
+	Graph_WriterEnter(gc->g);
+	RedisModule_ThreadSafeContextLock(ctx);
+	Graph_AcquireWriteLock(gc->g);
+	uint64_t relabeled = _ClusterEdges(gc);
+	Graph_ReleaseLock(gc->g);
+
+	// replicas relabel their edges alike, the order is deterministic
+	RedisModule_Replicate(ctx, "GRAPH.REORDER", "cc", gc->graph_name, "EDGES");
+	RedisModule_ThreadSafeContextUnlock(ctx);
+	Graph_WriterLeave(gc->g);
+
+	char reply[1024];
+	int len = snprintf(reply, 1024, "Graph reordered, %" PRIu64 " relationships relabeled",
+			relabeled);
+	RedisModule_ReplyWithStringBuffer(ctx, reply, len);
+}
+
+// relabels the graph's nodes on the graph's writer thread
+static void _Graph_ReorderNodes(ReorderCtx *reorder_ctx, RedisModuleCtx *ctx) {
+	GraphContext *gc = reorder_ctx->gc;
+	NodeOrderPolicy policy = reorder_ctx->policy;
+
+	// as the graph's single writer the graph isn't modified
+	// between computing the order and applying it
+	Graph_WriterEnter(gc->g);
+
+	NodeID *order;
+	Graph_AcquireReadLock(gc->g);
+	GrB_Info info = _ComputeOrder(gc->g, policy, &order);
+	Graph_ReleaseLock(gc->g);
+
+	if(info == GrB_SUCCESS) {
+		uint64_t relabeled = 0;
+		uint64_t node_count = Graph_NodeCount(gc->g);
+		for(uint64_t i = 0; i < node_count; i++) relabeled += (order[i] != i);
+
+		// writers maintain indices while holding both locks
+		// acquiring the write lock invalidates open cursors
+		RedisModule_ThreadSafeContextLock(ctx);
+		Graph_AcquireWriteLock(gc->g);
+		_ReorderNodes(gc, order);
+		Graph_ReleaseLock(gc->g);
+
+		// replicas relabel their nodes alike, the order is deterministic
+		RedisModule_Replicate(ctx, "GRAPH.REORDER", "cc", gc->graph_name,
+				_policy_names[policy]);
+		RedisModule_ThreadSafeContextUnlock(ctx);
+
+		char reply[1024];
+		int len = snprintf(reply, 1024, "Graph reordered, %" PRIu64 " nodes relabeled",
+				relabeled);
+		RedisModule_ReplyWithStringBuffer(ctx, reply, len);
+		rm_free(order);
+	} else {
+		RedisModule_ReplyWithError(ctx, "Failed to compute the graph's node order");
+	}
+
+	Graph_WriterLeave(gc->g);
+}
+
+// reorders the graph on the graph's writer thread
+static void _Graph_Reorder(void *args) {
+	ASSERT(args != NULL);
+
+	ReorderCtx *reorder_ctx = (ReorderCtx *)args;
+	RedisModuleBlockedClient *bc = reorder_ctx->bc;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(bc);
+
+	if(reorder_ctx->edges) _Graph_ReorderEdges(reorder_ctx, ctx);
+	else _Graph_ReorderNodes(reorder_ctx, ctx);
+
+	GraphContext_Release(reorder_ctx->gc);
+	rm_free(reorder_ctx);
+	RedisModule_FreeThreadSafeContext(ctx);
+	RedisModule_UnblockClient(bc, NULL);
+}
+
+// GRAPH.REORDER <graph> [DEGREE | RCM | COMMUNITY | EDGES]
+// relabels the graph's nodes such that nodes traversed together
+// are stored next to one another, or its edges such that the edges
+// of each relation type are stored next to one another
+int Graph_Reorder(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc < 2 || argc > 3) return RedisModule_WrongArity(ctx);
+
+	bool edges = false;
+	NodeOrderPolicy policy = NODE_ORDER_RCM;
+	if(argc == 3 && !strcasecmp(RedisModule_StringPtrLen(argv[2], NULL), "EDGES")) {
+		edges = true;
+	} else if(argc == 3) {
+		const char *name = RedisModule_StringPtrLen(argv[2], NULL);
+		uint policy_count = sizeof(_policy_names) / sizeof(_policy_names[0]);
+		uint i = 0;
+		while(i < policy_count && strcasecmp(name, _policy_names[i]) != 0) i++;
+		if(i == policy_count) {
+			RedisModule_ReplyWithError(ctx,
+					"Unknown node order, expecting DEGREE, RCM, COMMUNITY or EDGES");
+			return REDISMODULE_OK;
+		}
+		policy = i;
+	}
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[1], false, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	ReorderCtx *reorder_ctx = rm_malloc(sizeof(ReorderCtx));
+	reorder_ctx->gc = gc;
+	reorder_ctx->policy = policy;
+	reorder_ctx->edges = edges;
+	reorder_ctx->bc = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+
+	// serialize reordering with the graph's write queries
+	ThreadPools_AddWorkWriter(_Graph_Reorder, reorder_ctx, gc->graph_name);
+
+	return REDISMODULE_OK;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "RG.h"
+#include "../redismodule.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../serializers/serializer_io.h"
+#include "../serializers/encoding_version.h"
+#include "../serializers/decoders/decode_graph.h"
+#include <string.h>
+
+extern RedisModuleType *GraphContextRedisModuleType;
+
+// module event handler functions declarations
+void ModuleEventHandler_DecreaseDecodingGraphsCount(void);
+
+// returns true if payload encodes a key of graph_name
+// the graph's name leads every graph key, following the encoding version
+static bool _Graph_RestorePayloadMatches(const char *payload, size_t len,
+		const char *graph_name) {
+	SerializerIO io;
+	SerializerIO_FromData(&io, payload, len);
+	SerializerIO_LoadUnsigned(&io);
+	char *name = SerializerIO_LoadStringBuffer(&io, NULL);
+	bool match = !SerializerIO_Failed(&io) && strcmp(name, graph_name) == 0;
+	rm_free(name);
+	return match;
+}
+
+// GRAPH.RESTORE <graph> <payload>
+// loads a graph key as encoded by an AOF rewrite
+// a graph is restored by consecutive GRAPH.RESTORE commands, one per graph key
+int Graph_Restore(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc != 3) return RedisModule_WrongArity(ctx);
+
+	size_t len;
+	const char *payload = RedisModule_StringPtrLen(argv[2], &len);
+	const char *graph_name = RedisModule_StringPtrLen(argv[1], NULL);
+
+	// payloads are only restored by the encoding version which produced them
+	SerializerIO version_io;
+	SerializerIO_FromData(&version_io, payload, len);
+	uint64_t encver = SerializerIO_LoadUnsigned(&version_io);
+	if(!SerializerIO_Failed(&version_io) &&
+	   encver != GRAPH_ENCODING_VERSION_LATEST) {
+		RedisModule_ReplyWithError(ctx, "ERR Unsupported graph restore payload version");
+		return REDISMODULE_OK;
+	}
+
+	if(!_Graph_RestorePayloadMatches(payload, len, graph_name)) {
+		RedisModule_ReplyWithError(ctx, "ERR Invalid graph restore payload");
+		return REDISMODULE_OK;
+	}
+
+	RedisModuleKey *key = RedisModule_OpenKey(ctx, argv[1], REDISMODULE_WRITE);
+	bool empty = RedisModule_KeyType(key) == REDISMODULE_KEYTYPE_EMPTY;
+	if(!empty) {
+		if(RedisModule_ModuleTypeGetType(key) != GraphContextRedisModuleType) {
+			RedisModule_CloseKey(key);
+			RedisModule_ReplyWithError(ctx, REDISMODULE_ERRORMSG_WRONGTYPE);
+			return REDISMODULE_OK;
+		}
+		// only a graph which is being restored can be extended
+		GraphContext *gc = RedisModule_ModuleTypeGetValue(key);
+		if(!GraphDecodeContext_GetProcessedKeyCount(gc->decoding_context)) {
+			RedisModule_CloseKey(key);
+			RedisModule_ReplyWithError(ctx, "ERR Graph already exists");
+			return REDISMODULE_OK;
+		}
+	}
+
+	SerializerIO io;
+	SerializerIO_FromData(&io, payload, len);
+	SerializerIO_LoadUnsigned(&io);  // encoding version, validated above
+	GraphContext *gc = DecodeGraph(&io);
+
+	if(empty) {
+		// first key of the graph
+		RedisModule_ModuleTypeSetValue(key, GraphContextRedisModuleType, gc);
+		GraphContext_RegisterWithModule(gc);
+	}
+
+	if(SerializerIO_Failed(&io)) {
+		RedisModule_Log(ctx, "warning", "Failed to restore graph %s", graph_name);
+		// abort decoding, discarding the partially restored graph
+		if(GraphDecodeContext_GetProcessedKeyCount(gc->decoding_context)) {
+			GraphDecodeContext_Reset(gc->decoding_context);
+			QueryCtx_Free();
+			ModuleEventHandler_DecreaseDecodingGraphsCount();
+		}
+		RedisModule_DeleteKey(key);
+		RedisModule_CloseKey(key);
+		RedisModule_ReplyWithError(ctx, "ERR Invalid graph restore payload");
+		return REDISMODULE_OK;
+	}
+
+	RedisModule_CloseKey(key);
+	RedisModule_ReplicateVerbatim(ctx);
+	RedisModule_ReplyWithSimpleString(ctx, "OK");
+	return REDISMODULE_OK;
+}
@@ -0,0 +1,126 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../errors.h"
+#include "../query_ctx.h"
+#include "../redismodule.h"
+#include "../util/arr.h"
+#include "../graph/graphcontext.h"
+#include "../graph/materialized_view.h"
+#include <string.h>
+#include <strings.h>
+
+// GRAPH.VIEW CREATE <graph> <name> <query>
+// returns false if the view couldn't be created
+static bool _View_Create(RedisModuleCtx *ctx, GraphContext *gc,
+		const char *name, const char *query) {
+	const char *err = NULL;
+	MaterializedView *view = MaterializedView_New(gc, name, query, &err);
+	if(view == NULL) {
+		// prefer the parser's error over the generic one
+		if(ErrorCtx_EncounteredError()) err = ErrorCtx_Get()->error;
+		RedisModule_ReplyWithError(ctx, err);
+		return false;
+	}
+
+	GraphContext_AddView(gc, view);
+	RedisModule_ReplyWithSimpleString(ctx, "OK");
+	return true;
+}
+
+// GRAPH.VIEW READ <graph> <name>
+static void _View_Read(RedisModuleCtx *ctx, GraphContext *gc, const char *name) {
+	MaterializedView *view = GraphContext_GetView(gc, name);
+	if(view == NULL) {
+		RedisModule_ReplyWithError(ctx, "Unknown view");
+		return;
+	}
+	MaterializedView_Reply(view, gc, ctx);
+}
+
+// GRAPH.VIEW DROP <graph> <name>
+// returns false if there's no such view
+static bool _View_Drop(RedisModuleCtx *ctx, GraphContext *gc, const char *name) {
+	if(!GraphContext_RemoveView(gc, name)) {
+		RedisModule_ReplyWithError(ctx, "Unknown view");
+		return false;
+	}
+	RedisModule_ReplyWithSimpleString(ctx, "OK");
+	return true;
+}
+
+// GRAPH.VIEW LIST <graph>
+static void _View_List(RedisModuleCtx *ctx, GraphContext *gc) {
+	uint count = array_len(gc->views);
+	RedisModule_ReplyWithArray(ctx, count);
+	for(uint i = 0; i < count; i++) {
+		MaterializedView *view = gc->views[i];
+		RedisModule_ReplyWithArray(ctx, 2);
+		RedisModule_ReplyWithStringBuffer(ctx, view->name, strlen(view->name));
+		RedisModule_ReplyWithStringBuffer(ctx, view->query, strlen(view->query));
+	}
+}
+
+// GRAPH.VIEW CREATE|READ|DROP|LIST <graph> [<name> [<query>]]
+// GRAPH.RO_VIEW READ|LIST <graph> [<name>]
+// maintains named query results, updated as write queries commit
+// views are replicated by their definition and persisted alongside the graph
+int Graph_View(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+	ASSERT(ctx != NULL);
+	if(argc < 3) return RedisModule_WrongArity(ctx);
+
+	const char *cmd = RedisModule_StringPtrLen(argv[0], NULL);
+	const char *subcmd = RedisModule_StringPtrLen(argv[1], NULL);
+	bool readonly = (strcasecmp(cmd, "graph.RO_VIEW") == 0);
+	bool create = (strcasecmp(subcmd, "CREATE") == 0);
+	bool drop = (strcasecmp(subcmd, "DROP") == 0);
+	bool list = (strcasecmp(subcmd, "LIST") == 0);
+	if(!create && !drop && !list && strcasecmp(subcmd, "READ") != 0) {
+		RedisModule_ReplyWithError(ctx, "Unknown subcommand, expected CREATE, READ, DROP or LIST");
+		return REDISMODULE_OK;
+	}
+	if(readonly && (create || drop)) {
+		RedisModule_ReplyWithError(ctx, "graph.RO_VIEW is to be executed only with READ or LIST");
+		return REDISMODULE_OK;
+	}
+	if((list && argc != 3) || (create && argc != 5) ||
+	   (!create && !list && argc != 4)) {
+		return RedisModule_WrongArity(ctx);
+	}
+
+	GraphContext *gc = GraphContext_Retrieve(ctx, argv[2], true, false);
+	// if the GraphContext is null, key access failed and an error has been emitted
+	if(!gc) return REDISMODULE_ERR;
+
+	// views are accessed under the GIL, writers update them while committing
+	// the read lock keeps the graph consistent while a view is scanned
+	Graph_AcquireReadLock(gc->g);
+
+	bool modified = false;
+	const char *name = (list) ? NULL : RedisModule_StringPtrLen(argv[3], NULL);
+	if(create) {
+		modified = _View_Create(ctx, gc, name, RedisModule_StringPtrLen(argv[4], NULL));
+	} else if(drop) {
+		modified = _View_Drop(ctx, gc, name);
+	} else if(list) {
+		_View_List(ctx, gc);
+	} else {
+		_View_Read(ctx, gc, name);
+	}
+
+	Graph_ReleaseLock(gc->g);
+
+	// replicas maintain views of their own, populated from their graph
+	if(modified) RedisModule_ReplicateVerbatim(ctx);
+	GraphContext_Release(gc);
+
+	// parsing a view's query populates the thread's query context
+	QueryCtx_Free();
+	ErrorCtx_Clear();
+
+	return REDISMODULE_OK;
+}
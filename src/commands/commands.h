@@ -22,7 +22,11 @@ typedef enum {
 	CMD_PROFILE        = 6,
 	CMD_BULK_INSERT    = 7,
 	CMD_SLOWLOG        = 8,
-	CMD_LIST           = 9
+	CMD_LIST           = 9,
+	CMD_CACHE          = 10,
+	CMD_CURSOR         = 11,
+	CMD_MULTI_QUERY    = 12,
+	CMD_PREPARE        = 13
 } GRAPH_Commands;
 
 //------------------------------------------------------------------------------
@@ -30,11 +34,27 @@ typedef enum {
 //------------------------------------------------------------------------------
 
 void Graph_Query(void *args);
+void Graph_MultiQuery(void *args);
 void Graph_Slowlog(void *args);
 void Graph_Profile(void *args);
 void Graph_Explain(void *args);
+void Graph_Prepare(void *args);
 int Graph_List(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Cache(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_PlanStats(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_QueryStats(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Memory(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int Graph_Delete(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int Graph_Config(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Cursor(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Compact(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Reorder(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Effect(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Restore(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Copy(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Execute(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_View(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Maintenance(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int Graph_Export(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int CommandDispatch(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 
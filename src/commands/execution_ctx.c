@@ -6,14 +6,190 @@
 
 #include "execution_ctx.h"
 #include "RG.h"
+#include "../config.h"
 #include "../query_ctx.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../errors.h"
+#include "../util/thpool/pools.h"
+#include "../ast/ast_params.h"
+#include "../ast/ast_parameterize.h"
+#include "../execution_plan/plan_estimate.h"
+#include "../execution_plan/plan_feedback.h"
 #include "../execution_plan/execution_plan_clone.h"
+#include <pthread.h>
+
+// max number of executed plans kept for reuse per cached query
+#define EXECUTION_PLAN_POOL_CAP 4
+
+// executed plan, ready to be reused
+typedef struct {
+	ExecutionPlan *plan;        // reset execution plan
+	uint64_t epoch;             // graph write epoch when the plan last executed
+	XXH32_hash_t version;       // graph version when the plan last executed
+	uint generation;            // template generation the plan was cloned from
+} _PooledPlan;
+
+struct ExecutionPlanPool {
+	ExecutionPlan *template;    // cached plan, cloned when no executed plan is available
+	uint generation;            // incremented once the template is replaced
+	bool replanned;             // template was built anew from observed cardinalities
+	_PooledPlan *plans;         // executed plans available for reuse
+	int ref_count;              // number of execution contexts sharing the pool
+	PlanStats *stats;           // statistics of sampled executions
+	size_t memory;              // bytes allocated while building the AST and template
+	pthread_mutex_t lock;       // protects 'plans'
+};
+
+static ExecutionPlanPool *_PlanPool_New(ExecutionPlan *template) {
+	ExecutionPlanPool *pool = rm_malloc(sizeof(ExecutionPlanPool));
+	pool->template   =  template;
+	pool->generation =  0;
+	pool->replanned  =  false;
+	pool->plans      =  array_new(_PooledPlan, EXECUTION_PLAN_POOL_CAP);
+	pool->ref_count  =  1;
+	pool->stats      =  PlanStats_New();
+	pool->memory     =  0;
+	pthread_mutex_init(&pool->lock, NULL);
+
+	// the template outlives the cached execution context while the pool is shared
+	ExecutionPlan_IncreaseRefCount(template);
+	return pool;
+}
+
+static void _PlanPool_Retain(ExecutionPlanPool *pool) {
+	__atomic_fetch_add(&pool->ref_count, 1, __ATOMIC_RELAXED);
+}
+
+static void _PlanPool_Release(ExecutionPlanPool *pool) {
+	if(__atomic_sub_fetch(&pool->ref_count, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+	uint count = array_len(pool->plans);
+	for(uint i = 0; i < count; i++) ExecutionPlan_Free(pool->plans[i].plan);
+	array_free(pool->plans);
+	ExecutionPlan_Free(pool->template);
+	PlanStats_Free(pool->stats);
+	pthread_mutex_destroy(&pool->lock);
+	rm_free(pool);
+}
+
+// clones the pool's template into ctx
+static void _PlanPool_Clone(ExecutionPlanPool *pool, ExecutionCtx *ctx) {
+	// the generation is read first, such that a plan cloned from
+	// a template replaced meanwhile is never handed back to the pool
+	ctx->plan_generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+	ctx->plan = ExecutionPlan_Clone(__atomic_load_n(&pool->template,
+				__ATOMIC_ACQUIRE));
+}
+
+// hands an executed plan to ctx, returns false if none is available
+static bool _PlanPool_Take(ExecutionPlanPool *pool, ExecutionCtx *ctx) {
+	bool taken = false;
+	pthread_mutex_lock(&pool->lock);
+	if(array_len(pool->plans) > 0) {
+		_PooledPlan pooled = array_pop(pool->plans);
+		ctx->plan          =  pooled.plan;
+		ctx->plan_epoch    =  pooled.epoch;
+		ctx->plan_version  =  pooled.version;
+		ctx->plan_generation = pooled.generation;
+		taken = true;
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return taken;
+}
+
+// keeps an executed plan for reuse, returns false if the plan can't be reused
+static bool _PlanPool_Return(ExecutionPlanPool *pool, ExecutionPlan *plan,
+		uint generation) {
+	if(plan == pool->template) return false;
+	if(ErrorCtx_EncounteredError()) return false;
+	// evaluated parameters are replaced by constants within the plan's ops
+	if(raxSize(QueryCtx_GetParams()) > 0) return false;
+	if(!ExecutionPlan_Reusable(plan)) return false;
+
+	// the caller still holds the graph lock
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	_PooledPlan pooled = {
+		.plan     =  plan,
+		.epoch    =  Graph_WriteEpoch(gc->g),
+		.version  =  GraphContext_GetVersion(gc),
+		.generation = generation
+	};
+
+	bool returned = false;
+	pthread_mutex_lock(&pool->lock);
+	// plans cloned from a replaced template are discarded
+	if(generation == pool->generation &&
+	   array_len(pool->plans) < EXECUTION_PLAN_POOL_CAP) {
+		array_append(pool->plans, pooled);
+		returned = true;
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return returned;
+}
+
+// builds the pool's template anew, its planner relying on the cardinalities
+// observed by sampled, once a cached plan's estimates proved to be off
+// a template is replaced at most once, see REPLAN_THRESHOLD
+static void _PlanPool_Replan(ExecutionPlanPool *pool, const ExecutionPlan *sampled) {
+	bool replanned = false;
+	if(!__atomic_compare_exchange_n(&pool->replanned, &replanned, true, false,
+				__ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) return;
+
+	PlanFeedback *feedback = PlanFeedback_Collect(sampled);
+	PlanEstimate_SetFeedback(feedback);
+	ExecutionPlan *plan = NewExecutionPlan();
+	PlanEstimate_SetFeedback(NULL);
+	PlanFeedback_Free(feedback);
+
+	// the query already executed, keep the current template
+	if(ErrorCtx_EncounteredError()) {
+		ErrorCtx_Clear();
+		if(plan != NULL) ExecutionPlan_Free(plan);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	ExecutionPlan *template = pool->template;
+	__atomic_store_n(&pool->template, plan, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&pool->generation, 1, __ATOMIC_RELEASE);
+	_PooledPlan *plans = pool->plans;
+	pool->plans = array_new(_PooledPlan, EXECUTION_PLAN_POOL_CAP);
+	pthread_mutex_unlock(&pool->lock);
+
+	uint count = array_len(plans);
+	for(uint i = 0; i < count; i++) ExecutionPlan_Free(plans[i].plan);
+	array_free(plans);
+	// the replaced template is the cached execution context's own plan,
+	// which keeps it alive for clones which might still be in progress
+	ExecutionPlan_Free(template);
+
+	PlanStats_Replanned(pool->stats);
+}
+
+// returns true if a sampled plan's operations produced
+// REPLAN_THRESHOLD times more or fewer records than estimated
+static bool _ExecutionCtx_Misestimated(const ExecutionCtx *ctx, ExecutionPlan *plan) {
+	uint64_t threshold;
+	Config_Option_get(Config_REPLAN_THRESHOLD, &threshold);
+	if(threshold == 0) return false;
+	if(__atomic_load_n(&ctx->pool->replanned, __ATOMIC_RELAXED)) return false;
+	// the plan is built from the query's AST
+	if(QueryCtx_GetAST() == NULL) return false;
+
+	ExecutionPlan_Estimate(plan);
+	return PlanFeedback_Misestimated(plan, threshold);
+}
 
 static ExecutionType _GetExecutionTypeFromAST(AST *ast) {
 	const cypher_astnode_type_t root_type = cypher_astnode_type(ast->root);
 	if(root_type == CYPHER_AST_QUERY) return EXECUTION_TYPE_QUERY;
 	if(root_type == CYPHER_AST_CREATE_NODE_PROPS_INDEX) return EXECUTION_TYPE_INDEX_CREATE;
 	if(root_type == CYPHER_AST_DROP_NODE_PROPS_INDEX) return EXECUTION_TYPE_INDEX_DROP;
+	// uniqueness constraints are backed by an index, executed as such
+	if(root_type == CYPHER_AST_CREATE_NODE_PROP_CONSTRAINT) return EXECUTION_TYPE_INDEX_CREATE;
+	if(root_type == CYPHER_AST_DROP_NODE_PROP_CONSTRAINT) return EXECUTION_TYPE_INDEX_DROP;
 	ASSERT(false && "Unknown execution type");
 	return 0;
 }
@@ -25,7 +201,13 @@ static ExecutionCtx *_ExecutionCtx_New(AST *ast, ExecutionPlan *plan,
 	exec_ctx->ast       = ast;
 	exec_ctx->plan      = plan;
 	exec_ctx->cached    = false;
+	// walking the AST is avoided on cache hits
+	exec_ctx->readonly  = (ast == NULL || AST_ReadOnly(ast->root));
+	exec_ctx->deterministic = (ast == NULL || AST_Deterministic(ast->root));
 	exec_ctx->exec_type = exec_type;
+	exec_ctx->pool      = NULL;
+	exec_ctx->reused    = false;
+	exec_ctx->plan_generation = 0;
 
 	return exec_ctx;
 }
@@ -37,9 +219,28 @@ ExecutionCtx *ExecutionCtx_Clone(ExecutionCtx *orig) {
 	// set the AST copy in thread local storage
 	QueryCtx_SetAST(execution_ctx->ast);
 
-	execution_ctx->plan      = ExecutionPlan_Clone(orig->plan);
 	execution_ctx->cached    = orig->cached;
+	execution_ctx->readonly  = orig->readonly;
+	execution_ctx->deterministic = orig->deterministic;
 	execution_ctx->exec_type = orig->exec_type;
+	execution_ctx->pool      = orig->pool;
+	execution_ctx->reused    = false;
+
+	// prefer an executed plan over cloning the cached one
+	if(orig->pool) {
+		_PlanPool_Retain(orig->pool);
+		execution_ctx->reused = _PlanPool_Take(orig->pool, execution_ctx);
+	}
+	if(!execution_ctx->reused) {
+		// orig's own plan might be an executed plan taken from the pool,
+		// e.g. a prepared statement's, clone the cached plan instead
+		if(orig->pool) {
+			_PlanPool_Clone(orig->pool, execution_ctx);
+		} else {
+			execution_ctx->plan = ExecutionPlan_Clone(orig->plan);
+			execution_ctx->plan_generation = 0;
+		}
+	}
 
 	return execution_ctx;
 }
@@ -65,51 +266,206 @@ ExecutionCtx *ExecutionCtx_FromQuery(const char *query) {
 
 	ExecutionCtx *ret;
 	const char *query_string;
+	double timer[2];
+	simple_tic(timer);
 
-	// Parse and validate parameters only. Extract query string.
-	// Return invalid execution context if there isn't a parser result.
-	cypher_parse_result_t *params_parse_result = parse_params(query,
-															  &query_string);
+	// lift literals into parameters, such that queries differing
+	// only by their literals share a single cached execution plan
+	char *parameterized = NULL;
+	if(Config_parameterize_queries_get()) {
+		parameterized = AST_ParameterizeQuery(query);
+		if(parameterized) query = parameterized;
+	}
 
-	if(params_parse_result == NULL) {
-		// Parameter parsing failed, return an invalid context.
-		return _ExecutionCtx_New(NULL, NULL, EXECUTION_TYPE_INVALID);
+	// Parse literal parameters directly, resort to the Cypher parser
+	// for parameters it can't handle. Extract query string.
+	// Return invalid execution context if there isn't a parser result.
+	cypher_parse_result_t *params_parse_result = NULL;
+	if(!AST_ParseLiteralParams(query, &query_string)) {
+		params_parse_result = parse_params(query, &query_string);
+		if(params_parse_result == NULL) {
+			// Parameter parsing failed, return an invalid context.
+			if(parameterized) rm_free(parameterized);
+			QueryCtx_AddPhaseTime(QUERY_PHASE_PARSE, simple_toc(timer) * 1000);
+			return _ExecutionCtx_New(NULL, NULL, EXECUTION_TYPE_INVALID);
+		}
 	}
 
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 	Cache *cache = GraphContext_GetCache(gc);
 
 	// Check the cache to see if we already have a cached context for this query.
+	QueryCtx_AddPhaseTime(QUERY_PHASE_PARSE, simple_toc(timer) * 1000);
+	simple_tic(timer);
 	ret = Cache_GetValue(cache, query_string);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_CACHE, simple_toc(timer) * 1000);
 	if(ret) {
 		// Set parameters parse result in the execution ast.
 		AST_SetParamsParseResult(ret->ast, params_parse_result);
 		ret->cached = true;
+		if(parameterized) rm_free(parameterized);
 		return ret;
 	}
 
+	simple_tic(timer);
+	int64_t mem = Alloc_GetConsumption();
+
 	// No cached execution plan, try to parse the query.
 	AST *ast = _ExecutionCtx_ParseAST(query_string, params_parse_result);
 	// If query parsing failed, return an invalid context.
-	if(!ast) return _ExecutionCtx_New(NULL, NULL, EXECUTION_TYPE_INVALID);
-
-	ExecutionType exec_type = _GetExecutionTypeFromAST(ast);
-	// In case of valid query, create execution plan, and cache it and the AST.
-	if(exec_type == EXECUTION_TYPE_QUERY) {
-		ExecutionPlan *plan = NewExecutionPlan();
-		ExecutionCtx *exec_ctx_to_cache = _ExecutionCtx_New(ast, plan,
-															exec_type);
-		ExecutionCtx *exec_ctx_from_cache = Cache_SetGetValue(cache,
-															  query_string, exec_ctx_to_cache);
-		return exec_ctx_from_cache;
+	if(!ast) {
+		ret = _ExecutionCtx_New(NULL, NULL, EXECUTION_TYPE_INVALID);
 	} else {
-		return _ExecutionCtx_New(ast, NULL, exec_type);
+		ExecutionType exec_type = _GetExecutionTypeFromAST(ast);
+		// In case of valid query, create execution plan, and cache it and the AST.
+		if(exec_type == EXECUTION_TYPE_QUERY) {
+			ExecutionPlan *plan = NewExecutionPlan();
+			ExecutionCtx *exec_ctx_to_cache = _ExecutionCtx_New(ast, plan,
+																exec_type);
+			exec_ctx_to_cache->pool = _PlanPool_New(plan);
+			int64_t delta = Alloc_GetConsumption() - mem;
+			exec_ctx_to_cache->pool->memory = (delta > 0) ? delta : 0;
+			ret = Cache_SetGetValue(cache, query_string, exec_ctx_to_cache);
+		} else {
+			ret = _ExecutionCtx_New(ast, NULL, exec_type);
+		}
 	}
+
+	// query_string might point into the parameterized query
+	if(parameterized) rm_free(parameterized);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_PARSE, simple_toc(timer) * 1000);
+	return ret;
+}
+
+// queries to plan into a graph's cache
+typedef struct {
+	GraphContext *gc;   // graph, retained
+	char **queries;     // cache keys, most hit first
+} _CacheWarmUp;
+
+// reader thread task, plans each query without executing it
+static void _ExecutionCtx_WarmCache(void *arg) {
+	_CacheWarmUp *warm_up = arg;
+	GraphContext *gc = warm_up->gc;
+
+	// plan the most hit queries last, such that they're the last to be evicted
+	uint count = array_len(warm_up->queries);
+	for(int i = count - 1; i >= 0; i--) {
+		QueryCtx_SetGraphCtx(gc);
+		ExecutionCtx *exec_ctx = ExecutionCtx_FromQuery(warm_up->queries[i]);
+		ExecutionCtx_Free(exec_ctx);
+		QueryCtx_Free();
+		ErrorCtx_Clear();
+		rm_free(warm_up->queries[i]);
+	}
+
+	array_free(warm_up->queries);
+	GraphContext_Release(gc);
+	rm_free(warm_up);
+}
+
+void ExecutionCtx_WarmCache(GraphContext *gc, char **queries) {
+	ASSERT(gc != NULL);
+	ASSERT(queries != NULL);
+
+	_CacheWarmUp *warm_up = rm_malloc(sizeof(_CacheWarmUp));
+	warm_up->gc = gc;
+	warm_up->queries = queries;
+
+	// the graph might be deleted before the task is picked up
+	GraphContext_Retain(gc);
+	// warming up yields to queries pending execution
+	ThreadPools_DeferWorkReader(_ExecutionCtx_WarmCache, warm_up);
+}
+
+bool ExecutionCtx_PreparePlan(ExecutionCtx *ctx) {
+	ASSERT(ctx != NULL && ctx->plan != NULL);
+
+	double timer[2];
+	simple_tic(timer);
+
+	bool replaced = false;
+	if(ctx->reused) {
+		/* ops of a reused plan hold iterators and matrices
+		 * which are invalidated by modifications to the graph */
+		GraphContext *gc = QueryCtx_GetGraphCtx();
+		if(Graph_WriteEpoch(gc->g) != ctx->plan_epoch ||
+		   GraphContext_GetVersion(gc) != ctx->plan_version) {
+			ExecutionPlan_Free(ctx->plan);
+			_PlanPool_Clone(ctx->pool, ctx);
+			ctx->reused = false;
+			replaced = true;
+		}
+	}
+
+	// reused plans are already prepared
+	if(!ctx->plan->prepared) ExecutionPlan_PreparePlan(ctx->plan);
+	QueryCtx_AddPhaseTime(QUERY_PHASE_CACHE, simple_toc(timer) * 1000);
+	return replaced;
+}
+
+void ExecutionCtx_RenewPlan(ExecutionCtx *ctx) {
+	ASSERT(ctx != NULL && ctx->pool != NULL);
+
+	if(ctx->plan != NULL) ExecutionPlan_Free(ctx->plan);
+	_PlanPool_Clone(ctx->pool, ctx);
+	ctx->reused = false;
+}
+
+void ExecutionCtx_SamplePlan(ExecutionCtx *ctx) {
+	ASSERT(ctx != NULL && ctx->plan != NULL);
+
+	if(ctx->pool == NULL) return;
+	if(PlanStats_ShouldSample(ctx->pool->stats)) {
+		ExecutionPlan_InitSampling(ctx->plan);
+	}
+}
+
+PlanStats *ExecutionCtx_GetPlanStats(const ExecutionCtx *ctx) {
+	ASSERT(ctx != NULL);
+	return (ctx->pool) ? ctx->pool->stats : NULL;
+}
+
+void ExecutionCtx_ReleasePlan(ExecutionCtx *ctx) {
+	ASSERT(ctx != NULL);
+
+	ExecutionPlan *plan = ctx->plan;
+	ctx->plan = NULL;
+	if(plan == NULL) return;
+
+	// an executed plan no longer times out, once cancelled it can be reused
+	ExecutionPlan_CancelTimeout(plan);
+
+	// a drained plan is no longer sampled
+	if(ctx->pool && ExecutionPlan_Sampled(plan) &&
+	   !ErrorCtx_EncounteredError()) {
+		ExecutionPlan_FinalizeSampling(plan);
+		PlanStats_Add(ctx->pool->stats, plan);
+		if(_ExecutionCtx_Misestimated(ctx, plan)) _PlanPool_Replan(ctx->pool, plan);
+	}
+
+	if(ctx->pool && _PlanPool_Return(ctx->pool, plan, ctx->plan_generation)) return;
+	ExecutionPlan_Free(plan);
+}
+
+size_t ExecutionCtx_MemoryUsage(const ExecutionCtx *ctx) {
+	ASSERT(ctx != NULL);
+
+	ExecutionPlanPool *pool = ctx->pool;
+	if(pool == NULL) return 0;
+
+	// pooled plans are clones of the template
+	pthread_mutex_lock(&pool->lock);
+	size_t usage = pool->memory * (1 + array_len(pool->plans));
+	pthread_mutex_unlock(&pool->lock);
+
+	return usage;
 }
 
 void ExecutionCtx_Free(ExecutionCtx *ctx) {
 	if(ctx == NULL) return;
 	if(ctx->plan != NULL) ExecutionPlan_Free(ctx->plan);
+	if(ctx->pool != NULL) _PlanPool_Release(ctx->pool);
 	if(ctx->ast != NULL) AST_Free(ctx->ast);
 
 	rm_free(ctx);
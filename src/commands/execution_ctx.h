@@ -8,6 +8,8 @@
 
 #include "../ast/ast.h"
 #include "../execution_plan/execution_plan.h"
+#include "../execution_plan/plan_stats.h"
+#include "xxhash.h"
 
 /**
  * @brief  Execution type derived from a query
@@ -19,14 +21,26 @@ typedef enum {
 	EXECUTION_TYPE_INDEX_DROP       // Drop index execution.
 } ExecutionType;
 
+/**
+ * @brief  Pool of executed plans, shared by a cached execution context and its copies.
+ */
+typedef struct ExecutionPlanPool ExecutionPlanPool;
+
 /**
  * @brief  A struct for saving execution objects in cache.
  */
 typedef struct {
 	AST *ast;                   // AST
 	bool cached;                // cache hit/miss
+	bool readonly;              // query doesn't modify the graph, resolved once per AST
+	bool deterministic;         // query results are determined by the graph and parameters, resolved once per AST
 	ExecutionPlan *plan;        // execution plan
 	ExecutionType exec_type;    // execution type: query, index create/delete
+	ExecutionPlanPool *pool;    // executed plans of a cached query, NULL if not cached
+	bool reused;                // plan was taken from the pool
+	uint64_t plan_epoch;        // graph write epoch when a reused plan last executed
+	XXH32_hash_t plan_version;  // graph version when a reused plan last executed
+	uint plan_generation;       // generation of the cached plan the plan was cloned from
 } ExecutionCtx;
 
 /**
@@ -43,6 +57,59 @@ ExecutionCtx *ExecutionCtx_FromQuery(const char *query);
  */
 ExecutionCtx *ExecutionCtx_Clone(ExecutionCtx *ctx);
 
+/**
+ * @brief  Plans queries into the graph's cache on a reader thread, without executing them.
+ * @note   Used to warm up the cache of a loaded graph, takes ownership over queries.
+ * @param  *gc: Graph whose cache is populated.
+ * @param  **queries: Array of cache keys, most hit first.
+ */
+void ExecutionCtx_WarmCache(GraphContext *gc, char **queries);
+
+/**
+ * @brief  Prepares the execution plan for execution, must be called under the graph lock.
+ * @note   A reused plan is replaced by a fresh copy if the graph was modified since it last executed.
+ * @param  *ctx: A pointer to ExecutionCTX struct
+ * @retval True if the execution plan was replaced.
+ */
+bool ExecutionCtx_PreparePlan(ExecutionCtx *ctx);
+
+/**
+ * @brief  Replaces the execution plan of a cached query by a fresh copy of the cached plan.
+ * @note   The current plan is discarded along with its execution, e.g. one aborted before committing.
+ * @param  *ctx: A pointer to a cached ExecutionCTX struct
+ */
+void ExecutionCtx_RenewPlan(ExecutionCtx *ctx);
+
+/**
+ * @brief  Samples the execution of a cached query's plan, once every PLAN_STATS_SAMPLE_RATE executions.
+ * @note   Statistics are aggregated once the plan is released, must be called before the plan executes.
+ * @param  *ctx: A pointer to ExecutionCTX struct
+ */
+void ExecutionCtx_SamplePlan(ExecutionCtx *ctx);
+
+/**
+ * @brief  Returns the statistics of a cached query's plan.
+ * @param  *ctx: A pointer to ExecutionCTX struct
+ * @retval Plan statistics, NULL if the query isn't cached.
+ */
+PlanStats *ExecutionCtx_GetPlanStats(const ExecutionCtx *ctx);
+
+/**
+ * @brief  Releases the execution plan of an executed query.
+ * @note   Plans of cached queries are reset and kept for reuse by later hits when possible.
+ * @param  *ctx: A pointer to ExecutionCTX struct
+ */
+void ExecutionCtx_ReleasePlan(ExecutionCtx *ctx);
+
+/**
+ * @brief  Returns an estimate of the number of bytes held by a cached query.
+ * @note   Measured as the memory allocated while building the cached plan,
+ *         times the number of plan copies kept for reuse.
+ * @param  *ctx: A pointer to a cached ExecutionCTX struct
+ * @retval Number of bytes, 0 if the query isn't cached.
+ */
+size_t ExecutionCtx_MemoryUsage(const ExecutionCtx *ctx);
+
 /**
  * @brief  Free an ExecutionCTX struct and its inner fields.
  * @param  *ctx: ExecutionCTX struct
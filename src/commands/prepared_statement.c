@@ -0,0 +1,337 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "prepared_statement.h"
+#include "RG.h"
+#include "../query_ctx.h"
+#include "../util/cron.h"
+#include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../datatypes/array.h"
+#include "../bulk_insert/bulk_insert.h"
+#include "../arithmetic/arithmetic_expression.h"
+#include <pthread.h>
+
+// max nesting level of arrays within a bound parameter
+#define MAX_PARAM_DEPTH 64
+
+static rax *statements = NULL;            // statement id -> statement
+static uint64_t next_statement_id = 1;    // statement handles start at 1
+static pthread_mutex_t statements_mutex;  // guards the registry and ref counts
+
+static void _PreparedStatement_Expire(void *pdata);
+
+static void _ParamFree(void *param) {
+	AR_EXP_Free(param);
+}
+
+static void _PreparedStatement_Free(PreparedStatement *stmt) {
+	// operations might consult the query context while being freed
+	ExecutionCtx_Free(stmt->exec_ctx);
+	PreparedStatement_FreeParams(stmt->params);
+	GraphContext_Release(stmt->gc);
+	rm_free(stmt->query);
+	rm_free(stmt);
+
+	QueryCtx_Free(); // free the QueryCtx used while freeing, detaching it from thread
+}
+
+void PreparedStatement_Init(void) {
+	ASSERT(statements == NULL);
+	statements = raxNew();
+	int res = pthread_mutex_init(&statements_mutex, NULL);
+	ASSERT(res == 0);
+	UNUSED(res);
+}
+
+PreparedStatement *PreparedStatement_New
+(
+	GraphContext *gc,
+	ExecutionCtx *exec_ctx,
+	const char *query
+) {
+	ASSERT(gc != NULL);
+	ASSERT(query != NULL);
+	ASSERT(exec_ctx != NULL && exec_ctx->plan != NULL);
+
+	PreparedStatement *stmt = rm_malloc(sizeof(PreparedStatement));
+
+	stmt->gc         =  gc;
+	stmt->query      =  rm_strdup(query);
+	stmt->removed    =  false;
+	stmt->version    =  GraphContext_GetVersion(gc);
+	stmt->exec_ctx   =  exec_ctx;
+	stmt->ref_count  =  0;
+	stmt->params     =  raxNew();
+	simple_tic(stmt->idle_timer);
+
+	// the statement outlives the preparing query
+	GraphContext_Retain(gc);
+
+	// parameters of the query string, and literals lifted into parameters
+	raxIterator it;
+	raxStart(&it, QueryCtx_GetParams());
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) {
+		raxInsert(stmt->params, it.key, it.key_len, AR_EXP_Clone(it.data), NULL);
+	}
+	raxStop(&it);
+
+	pthread_mutex_lock(&statements_mutex);
+	stmt->id = next_statement_id++;
+	raxInsert(statements, (unsigned char *)&stmt->id, sizeof(stmt->id), stmt,
+			  NULL);
+	pthread_mutex_unlock(&statements_mutex);
+
+	// the statement id is passed by value, as the statement might be gone by then
+	Cron_AddTask(PREPARED_STATEMENT_MAX_IDLE, _PreparedStatement_Expire,
+			(void *)stmt->id);
+
+	return stmt;
+}
+
+PreparedStatement *PreparedStatement_Acquire
+(
+	uint64_t id
+) {
+	PreparedStatement *stmt = NULL;
+
+	pthread_mutex_lock(&statements_mutex);
+	void *v = raxFind(statements, (unsigned char *)&id, sizeof(id));
+	if(v != raxNotFound && !((PreparedStatement *)v)->removed) {
+		stmt = v;
+		stmt->ref_count++;
+		simple_tic(stmt->idle_timer);
+	}
+	pthread_mutex_unlock(&statements_mutex);
+
+	return stmt;
+}
+
+ExecutionCtx *PreparedStatement_Bind
+(
+	PreparedStatement *stmt,
+	rax *params
+) {
+	ASSERT(stmt != NULL && stmt->ref_count > 0);
+
+	// bound parameters are set over the statement's own parameters
+	rax *query_params = QueryCtx_GetParams();
+	raxIterator it;
+	raxStart(&it, stmt->params);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) {
+		raxInsert(query_params, it.key, it.key_len, AR_EXP_Clone(it.data), NULL);
+	}
+	raxStop(&it);
+
+	if(params != NULL) {
+		raxStart(&it, params);
+		raxSeek(&it, "^", NULL, 0);
+		while(raxNext(&it)) {
+			void *old = NULL;
+			raxInsert(query_params, it.key, it.key_len, it.data, &old);
+			if(old != NULL) AR_EXP_Free(old);
+		}
+		raxStop(&it);
+		raxFree(params);
+	}
+
+	// concurrent executions clone the statement's plan, as cache hits do
+	return ExecutionCtx_Clone(stmt->exec_ctx);
+}
+
+void PreparedStatement_Release
+(
+	PreparedStatement *stmt
+) {
+	ASSERT(stmt != NULL);
+
+	// statements are only freed by the cron thread,
+	// as freeing might consult the executing thread's QueryCtx
+	pthread_mutex_lock(&statements_mutex);
+	ASSERT(stmt->ref_count > 0);
+	stmt->ref_count--;
+	pthread_mutex_unlock(&statements_mutex);
+}
+
+void PreparedStatement_Remove
+(
+	PreparedStatement *stmt
+) {
+	ASSERT(stmt != NULL);
+
+	pthread_mutex_lock(&statements_mutex);
+	uint64_t id = stmt->id;
+	stmt->removed = true;
+	pthread_mutex_unlock(&statements_mutex);
+
+	PreparedStatement_Release(stmt);
+	Cron_AddTask(0, _PreparedStatement_Expire, (void *)id);
+}
+
+// cron task, frees the statement if it is removed or wasn't executed
+// since the task was scheduled, reschedules itself otherwise
+static void _PreparedStatement_Expire(void *pdata) {
+	uint64_t id = (uint64_t)pdata;
+	PreparedStatement *stmt = NULL;
+	uint reschedule = 0;
+
+	pthread_mutex_lock(&statements_mutex);
+	void *v = raxFind(statements, (unsigned char *)&id, sizeof(id));
+	if(v != raxNotFound) {
+		PreparedStatement *s = v;
+		// allow a millisecond of slack between the cron and timer clocks
+		double idle = simple_toc(s->idle_timer) * 1000 + 1;
+		bool expired = (s->removed || idle >= PREPARED_STATEMENT_MAX_IDLE);
+		if(expired && s->ref_count == 0) {
+			stmt = s;
+			raxRemove(statements, (unsigned char *)&id, sizeof(id), NULL);
+		} else if(expired) {
+			// wait for executions holding the statement to release it
+			reschedule = 1;
+		} else {
+			reschedule = PREPARED_STATEMENT_MAX_IDLE - idle;
+		}
+	}
+	pthread_mutex_unlock(&statements_mutex);
+
+	if(stmt != NULL) _PreparedStatement_Free(stmt);
+	if(reschedule > 0) Cron_AddTask(reschedule, _PreparedStatement_Expire, pdata);
+}
+
+//------------------------------------------------------------------------------
+// parameter binding
+//------------------------------------------------------------------------------
+
+// decodes a single bulk insert property from 'data'
+// unlike bulk insert blobs, bound parameters are checked against their length
+static bool _DecodeValue(const char *data, size_t len, size_t *idx, uint depth,
+		SIValue *v) {
+	if(*idx >= len || depth > MAX_PARAM_DEPTH) return false;
+
+	BulkPropertyType t = data[*idx];
+	*idx += 1;
+
+	switch(t) {
+		case BI_NULL:
+			*v = SI_NullVal();
+			return true;
+
+		case BI_BOOL:
+			if(len - *idx < 1) return false;
+			*v = SI_BoolVal(data[*idx]);
+			*idx += 1;
+			return true;
+
+		case BI_DOUBLE: {
+			double d;
+			if(len - *idx < sizeof(double)) return false;
+			memcpy(&d, data + *idx, sizeof(double));
+			*idx += sizeof(double);
+			*v = SI_DoubleVal(d);
+			return true;
+		}
+
+		case BI_LONG: {
+			int64_t i;
+			if(len - *idx < sizeof(int64_t)) return false;
+			memcpy(&i, data + *idx, sizeof(int64_t));
+			*idx += sizeof(int64_t);
+			*v = SI_LongVal(i);
+			return true;
+		}
+
+		case BI_STRING: {
+			const char *s = data + *idx;
+			const char *end = memchr(s, '\0', len - *idx);
+			if(end == NULL) return false;
+			*idx += end - s + 1;
+			*v = SI_DuplicateStringVal(s);
+			return true;
+		}
+
+		case BI_ARRAY: {
+			int64_t n;
+			if(len - *idx < sizeof(int64_t)) return false;
+			memcpy(&n, data + *idx, sizeof(int64_t));
+			*idx += sizeof(int64_t);
+			// each element takes at least its type byte
+			if(n < 0 || (uint64_t)n > len - *idx) return false;
+
+			SIValue array = SIArray_New(n);
+			for(int64_t i = 0; i < n; i++) {
+				SIValue elem;
+				if(!_DecodeValue(data, len, idx, depth + 1, &elem)) {
+					SIValue_Free(array);
+					return false;
+				}
+				// hand elem over to the array rather than cloning it
+				SIArray_AppendAsOwner(&array, &elem);
+			}
+			*v = array;
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+rax *PreparedStatement_DecodeParams
+(
+	RedisModuleString **argv,
+	int argc,
+	const char **err
+) {
+	ASSERT(err != NULL);
+
+	if(argc % 2 != 0) {
+		*err = "Expecting a value for each parameter";
+		return NULL;
+	}
+
+	rax *params = raxNew();
+	for(int i = 0; i < argc; i += 2) {
+		size_t name_len;
+		size_t len;
+		const char *name = RedisModule_StringPtrLen(argv[i], &name_len);
+		const char *data = RedisModule_StringPtrLen(argv[i + 1], &len);
+
+		SIValue v;
+		size_t idx = 0;
+		if(!_DecodeValue(data, len, &idx, 0, &v)) {
+			*err = "Failed to decode parameter value";
+			goto error;
+		}
+		if(idx != len) {
+			SIValue_Free(v);
+			*err = "Failed to decode parameter value";
+			goto error;
+		}
+
+		AR_ExpNode *exp = AR_EXP_NewConstOperandNode(v);
+		if(!raxTryInsert(params, (unsigned char *)name, name_len, exp, NULL)) {
+			AR_EXP_Free(exp);
+			*err = "Duplicated parameter";
+			goto error;
+		}
+	}
+
+	return params;
+
+error:
+	PreparedStatement_FreeParams(params);
+	return NULL;
+}
+
+void PreparedStatement_FreeParams
+(
+	rax *params
+) {
+	if(params == NULL) return;
+	raxFreeWithCallback(params, _ParamFree);
+}
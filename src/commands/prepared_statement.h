@@ -0,0 +1,89 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "rax.h"
+#include "execution_ctx.h"
+#include "../redismodule.h"
+#include "../graph/graphcontext.h"
+
+// number of milliseconds an unused prepared statement is kept alive
+#define PREPARED_STATEMENT_MAX_IDLE 3600000
+
+/* A prepared statement holds the AST and execution plan of a read-only query
+ * executed by handle, skipping query parsing and the plan cache lookup
+ * parameters are bound straight into the executing query's parameters
+ * the statement is bound to the graph version it was prepared against,
+ * once the graph schema is modified the statement is discarded. */
+typedef struct {
+	uint64_t id;              // statement handle, reported back to the client
+	char *query;              // query string
+	GraphContext *gc;         // graph the statement was prepared against, retained
+	XXH32_hash_t version;     // graph version when the statement was prepared
+	ExecutionCtx *exec_ctx;   // AST and execution plan
+	rax *params;              // parameters set while preparing, e.g. lifted literals
+	uint ref_count;           // number of executions holding the statement
+	bool removed;             // statement is no longer available for execution
+	double idle_timer[2];     // time since the statement was last executed
+} PreparedStatement;
+
+// initialize the prepared statements registry, called once on module load
+void PreparedStatement_Init(void);
+
+// creates a prepared statement for the query executing on the current thread
+// the statement takes ownership over 'exec_ctx'
+// and copies the parameters set on the thread's QueryCtx
+PreparedStatement *PreparedStatement_New
+(
+	GraphContext *gc,        // graph the query was prepared against
+	ExecutionCtx *exec_ctx,  // AST and execution plan
+	const char *query        // query string
+);
+
+// acquires statement 'id' for execution
+// returns NULL if no such statement exists
+PreparedStatement *PreparedStatement_Acquire
+(
+	uint64_t id  // statement handle
+);
+
+// returns an execution context for the statement, setting the statement's
+// parameters followed by 'params' on the thread's QueryCtx
+// takes ownership over 'params'
+ExecutionCtx *PreparedStatement_Bind
+(
+	PreparedStatement *stmt,  // acquired statement
+	rax *params               // bound parameters, may be NULL
+);
+
+// releases an acquired statement
+void PreparedStatement_Release
+(
+	PreparedStatement *stmt  // acquired statement
+);
+
+// discards an acquired statement, freed once it is no longer executing
+void PreparedStatement_Remove
+(
+	PreparedStatement *stmt  // acquired statement
+);
+
+// decodes 'argc' arguments of <name> <value> pairs into a map of parameters
+// each value is encoded as a bulk insert property, see docs/bulk_spec.md
+// returns NULL and sets 'err' if the arguments can't be decoded
+rax *PreparedStatement_DecodeParams
+(
+	RedisModuleString **argv,  // parameter arguments
+	int argc,                  // number of arguments
+	const char **err           // [output] decoding error
+);
+
+// frees a map of parameters
+void PreparedStatement_FreeParams
+(
+	rax *params  // parameters
+);
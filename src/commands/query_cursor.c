@@ -0,0 +1,150 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "query_cursor.h"
+#include "RG.h"
+#include "rax.h"
+#include "../util/cron.h"
+#include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include <pthread.h>
+
+static rax *cursors = NULL;             // cursor id -> cursor
+static uint64_t next_cursor_id = 1;     // 0 marks an exhausted cursor
+static pthread_mutex_t cursors_mutex;   // guards the registry
+
+static void _QueryCursor_Expire(void *pdata);
+
+static void _QueryCursor_Free(QueryCursor *cursor) {
+	// operations might consult the query context while being freed
+	QueryCtx_SetTLS(cursor->query_ctx);
+
+	ExecutionCtx_Free(cursor->exec_ctx);
+	ResultSet_Free(cursor->result_set);
+	GraphContext_Release(cursor->gc);
+	rm_free(cursor->query);
+	rm_free(cursor);
+
+	QueryCtx_Free(); // free the cursor's QueryCtx, detaching it from thread
+}
+
+void QueryCursor_Init(void) {
+	ASSERT(cursors == NULL);
+	cursors = raxNew();
+	int res = pthread_mutex_init(&cursors_mutex, NULL);
+	ASSERT(res == 0);
+	UNUSED(res);
+}
+
+QueryCursor *QueryCursor_New
+(
+	GraphContext *gc,
+	ExecutionCtx *exec_ctx,
+	ResultSet *result_set,
+	const char *query,
+	uint64_t count
+) {
+	ASSERT(gc != NULL);
+	ASSERT(count > 0);
+	ASSERT(exec_ctx != NULL && exec_ctx->plan != NULL);
+
+	QueryCursor *cursor = rm_malloc(sizeof(QueryCursor));
+
+	cursor->gc           =  gc;
+	cursor->count        =  count;
+	cursor->query        =  rm_strdup(query);
+	cursor->in_use       =  true;
+	cursor->exec_ctx     =  exec_ctx;
+	cursor->query_ctx    =  QueryCtx_GetQueryCtx();
+	cursor->result_set   =  result_set;
+	cursor->write_epoch  =  Graph_WriteEpoch(gc->g);
+
+	pthread_mutex_lock(&cursors_mutex);
+	cursor->id = next_cursor_id++;
+	raxInsert(cursors, (unsigned char *)&cursor->id, sizeof(cursor->id),
+			  cursor, NULL);
+	pthread_mutex_unlock(&cursors_mutex);
+
+	return cursor;
+}
+
+QueryCursor *QueryCursor_Acquire
+(
+	uint64_t id
+) {
+	QueryCursor *cursor = NULL;
+
+	pthread_mutex_lock(&cursors_mutex);
+	void *v = raxFind(cursors, (unsigned char *)&id, sizeof(id));
+	if(v != raxNotFound && !((QueryCursor *)v)->in_use) {
+		cursor = v;
+		cursor->in_use = true;
+	}
+	pthread_mutex_unlock(&cursors_mutex);
+
+	return cursor;
+}
+
+void QueryCursor_Resume
+(
+	QueryCursor *cursor
+) {
+	ASSERT(cursor != NULL && cursor->in_use);
+	QueryCtx_SetTLS(cursor->query_ctx);
+}
+
+void QueryCursor_Release
+(
+	QueryCursor *cursor
+) {
+	ASSERT(cursor != NULL && cursor->in_use);
+
+	QueryCtx_RemoveFromTLS();
+
+	pthread_mutex_lock(&cursors_mutex);
+	uint64_t id = cursor->id;
+	simple_tic(cursor->idle_timer);
+	cursor->in_use = false;
+	pthread_mutex_unlock(&cursors_mutex);
+
+	// the cursor id is passed by value, as the cursor might be gone by then
+	Cron_AddTask(QUERY_CURSOR_MAX_IDLE, _QueryCursor_Expire, (void *)id);
+}
+
+void QueryCursor_Free
+(
+	QueryCursor *cursor
+) {
+	ASSERT(cursor != NULL && cursor->in_use);
+
+	pthread_mutex_lock(&cursors_mutex);
+	raxRemove(cursors, (unsigned char *)&cursor->id, sizeof(cursor->id), NULL);
+	pthread_mutex_unlock(&cursors_mutex);
+
+	_QueryCursor_Free(cursor);
+}
+
+// cron task, frees the cursor if it wasn't read since the task was scheduled
+static void _QueryCursor_Expire(void *pdata) {
+	uint64_t id = (uint64_t)pdata;
+	QueryCursor *cursor = NULL;
+
+	pthread_mutex_lock(&cursors_mutex);
+	void *v = raxFind(cursors, (unsigned char *)&id, sizeof(id));
+	if(v != raxNotFound) {
+		QueryCursor *c = v;
+		// allow a millisecond of slack between the cron and timer clocks
+		double idle = simple_toc(c->idle_timer) * 1000 + 1;
+		if(!c->in_use && idle >= QUERY_CURSOR_MAX_IDLE) {
+			cursor = c;
+			raxRemove(cursors, (unsigned char *)&id, sizeof(id), NULL);
+		}
+	}
+	pthread_mutex_unlock(&cursors_mutex);
+
+	if(cursor != NULL) _QueryCursor_Free(cursor);
+}
+
@@ -0,0 +1,78 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "execution_ctx.h"
+#include "../query_ctx.h"
+#include "../resultset/resultset.h"
+#include "../graph/graphcontext.h"
+
+// default number of rows emitted per cursor batch
+#define QUERY_CURSOR_DEFAULT_COUNT 1000
+
+// number of milliseconds an unread cursor is kept alive
+#define QUERY_CURSOR_MAX_IDLE 300000
+
+/* A query cursor holds a suspended read-only execution plan
+ * whose result-set is streamed back to the client in batches.
+ * the graph's read lock is acquired per batch, as a write committed
+ * in between batches may invalidate the plan's iterators
+ * such a write invalidates the cursor. */
+typedef struct {
+	uint64_t id;              // cursor id, reported back to the client
+	char *query;              // query string
+	uint64_t count;           // default number of rows per batch
+	GraphContext *gc;         // graph being read, retained by the cursor
+	QueryCtx *query_ctx;      // query context, detached from any thread
+	ExecutionCtx *exec_ctx;   // AST and suspended execution plan
+	ResultSet *result_set;    // result-set batches are emitted from
+	uint64_t write_epoch;     // graph write epoch when the last batch was read
+	double idle_timer[2];     // time since the cursor was last released
+	bool in_use;              // cursor is being read from
+} QueryCursor;
+
+// initialize the cursor registry, called once on module load
+void QueryCursor_Init(void);
+
+// creates a cursor over the query executing on the current thread
+// the cursor takes ownership over 'gc', 'exec_ctx', 'result_set'
+// and the thread's QueryCtx, the new cursor is acquired by the caller
+QueryCursor *QueryCursor_New
+(
+	GraphContext *gc,        // graph being read
+	ExecutionCtx *exec_ctx,  // AST and initialized execution plan
+	ResultSet *result_set,   // query result-set
+	const char *query,       // query string
+	uint64_t count           // default number of rows per batch
+);
+
+// acquires cursor 'id' to read its next batch
+// returns NULL if no such cursor exists or if it is already being read
+QueryCursor *QueryCursor_Acquire
+(
+	uint64_t id  // cursor id
+);
+
+// attaches the cursor's QueryCtx to the current thread
+void QueryCursor_Resume
+(
+	QueryCursor *cursor  // acquired cursor
+);
+
+// releases an acquired cursor, detaching its QueryCtx from the current thread
+// the cursor expires unless acquired again within QUERY_CURSOR_MAX_IDLE
+void QueryCursor_Release
+(
+	QueryCursor *cursor  // acquired cursor
+);
+
+// removes an acquired cursor from the registry and frees it
+void QueryCursor_Free
+(
+	QueryCursor *cursor  // acquired cursor
+);
+
@@ -9,6 +9,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <limits.h>
+#include "util/rmalloc.h"
 #include "util/redis_version.h"
 #include "../deps/GraphBLAS/Include/GraphBLAS.h"
 
@@ -24,9 +25,49 @@
 // whether graphs should be deleted asynchronously
 #define ASYNC_DELETE "ASYNC_DELETE"
 
-// config param, number of threads in thread pool
+// config param, number of threads in reader thread pool
 #define THREAD_COUNT "THREAD_COUNT"
 
+// config param, max number of threads the reader thread pool may grow to
+#define MAX_THREAD_COUNT "MAX_THREAD_COUNT"
+
+// config param, min number of threads the reader thread pool autoscaler
+// may shrink to
+#define MIN_THREAD_COUNT "MIN_THREAD_COUNT"
+
+// config param, grow and shrink the reader thread pool by its queue's wait time
+#define THREAD_AUTOSCALE "THREAD_AUTOSCALE"
+
+// config param, percentage of a core background maintenance may use
+#define MAINTENANCE_CPU_BUDGET "MAINTENANCE_CPU_BUDGET"
+
+// config param, maintain the adjacency matrices shared by all relation types
+#define MAINTAIN_ADJACENCY "MAINTAIN_ADJACENCY"
+
+// config param, max memory held by resident graphs, in bytes
+#define GRAPH_MEMORY_BUDGET "GRAPH_MEMORY_BUDGET"
+
+// config param, min length of string property values stored in the value log
+#define VALUE_LOG_THRESHOLD "VALUE_LOG_THRESHOLD"
+
+// config param, max number of queries queued or running against a single graph
+#define GRAPH_MAX_CONCURRENT_QUERIES "GRAPH_MAX_CONCURRENT_QUERIES"
+
+// config param, CPU milliseconds per second the queries of a single graph may consume
+#define GRAPH_CPU_QUOTA "GRAPH_CPU_QUOTA"
+
+// config param, misestimate ratio above which a cached plan is built anew
+#define REPLAN_THRESHOLD "REPLAN_THRESHOLD"
+
+// config param, apply full-text index updates on a background thread
+#define FULLTEXT_ASYNC "FULLTEXT_ASYNC"
+
+// config param, retain the encoding of unmodified entity blocks for snapshots
+#define SNAPSHOT_PACK_CACHE "SNAPSHOT_PACK_CACHE"
+
+// config param, max number of UNION branches executed concurrently
+#define BRANCH_PARALLELISM "BRANCH_PARALLELISM"
+
 // resultset size limit
 #define RESULTSET_SIZE "RESULTSET_SIZE"
 
@@ -42,6 +83,69 @@
 // config param, max number of queued queries
 #define MAX_QUEUED_QUERIES "MAX_QUEUED_QUERIES"
 
+// config param, lift literals into parameters before plan caching
+#define PARAMETERIZE_QUERIES "PARAMETERIZE_QUERIES"
+
+// config param, max memory a single query may allocate, in bytes
+#define QUERY_MEM_CAPACITY "QUERY_MEM_CAPACITY"
+
+// config param, max number of queued write queries committed as a group
+#define GROUP_COMMIT_SIZE "GROUP_COMMIT_SIZE"
+
+// config param, number of writer threads, graphs are sharded across them
+#define WRITER_THREAD_COUNT "WRITER_THREAD_COUNT"
+
+// config param, milliseconds a read query runs before yielding to queued queries
+#define QUERY_TIME_SLICE "QUERY_TIME_SLICE"
+
+// config param, intern string property values in a per-graph pool
+#define INTERN_STRINGS "INTERN_STRINGS"
+
+// config param, compress relation matrices once loaded
+#define FREEZE_RELATIONS "FREEZE_RELATIONS"
+
+// config param, number of entities deleted per commit, 0 for unbounded
+#define DELETE_CHUNK_SIZE "DELETE_CHUNK_SIZE"
+
+// config param, number of nodes indexed per lock window, 0 for unbounded
+#define INDEX_BUILD_CHUNK_SIZE "INDEX_BUILD_CHUNK_SIZE"
+
+// config param, one in every N executions of a cached plan is sampled
+#define PLAN_STATS_SAMPLE_RATE "PLAN_STATS_SAMPLE_RATE"
+
+// report the time spent in each query phase along result-set statistics
+#define REPORT_QUERY_PHASES "REPORT_QUERY_PHASES"
+
+// config param, estimated cost above which read queries are held back
+// while readers are busy, 0 for unlimited
+#define QUERY_COST_BUDGET "QUERY_COST_BUDGET"
+
+// reject rather than defer read queries exceeding the cost budget
+#define REJECT_OVER_BUDGET "REJECT_OVER_BUDGET"
+
+// config param, max memory held by cached traversal products per graph,
+// in bytes, 0 disables caching
+#define PRODUCT_CACHE_CAPACITY "PRODUCT_CACHE_CAPACITY"
+
+// config param, replicate write queries by their effects rather than their text
+#define REPLICATE_EFFECTS "REPLICATE_EFFECTS"
+
+// config param, pin module threads to the CPUs of NUMA nodes
+#define THREAD_AFFINITY "THREAD_AFFINITY"
+
+// config param, interleave module threads' allocations across NUMA nodes
+#define NUMA_INTERLEAVE "NUMA_INTERLEAVE"
+
+// config param, max memory held by cached read-only query replies per graph,
+// in bytes, 0 disables caching
+#define RESULT_CACHE_CAPACITY "RESULT_CACHE_CAPACITY"
+
+// config param, cache replies only of queries issued with the --cache flag
+#define RESULT_CACHE_OPT_IN "RESULT_CACHE_OPT_IN"
+
+// config param, run the read phase of costly write queries on reader threads
+#define SPLIT_WRITE_QUERIES "SPLIT_WRITE_QUERIES"
+
 //------------------------------------------------------------------------------
 // Configuration defaults
 //------------------------------------------------------------------------------
@@ -204,6 +308,372 @@ uint64_t Config_resultset_max_size_get(void) {
 	return config.resultset_size;
 }
 
+//------------------------------------------------------------------------------
+// parameterize queries
+//------------------------------------------------------------------------------
+
+void Config_parameterize_queries_set(bool parameterize_queries) {
+	config.parameterize_queries = parameterize_queries;
+}
+
+bool Config_parameterize_queries_get(void) {
+	return config.parameterize_queries;
+}
+
+//------------------------------------------------------------------------------
+// query memory capacity
+//------------------------------------------------------------------------------
+
+void Config_query_mem_capacity_set(int64_t query_mem_capacity) {
+	if(query_mem_capacity <= 0) query_mem_capacity = QUERY_MEM_CAPACITY_UNLIMITED;
+	config.query_mem_capacity = query_mem_capacity;
+	Alloc_SetMemCapacity(query_mem_capacity);
+}
+
+uint64_t Config_query_mem_capacity_get(void) {
+	return config.query_mem_capacity;
+}
+
+//------------------------------------------------------------------------------
+// group commit size
+//------------------------------------------------------------------------------
+
+void Config_group_commit_size_set(uint64_t group_commit_size) {
+	config.group_commit_size = group_commit_size;
+}
+
+uint64_t Config_group_commit_size_get(void) {
+	return config.group_commit_size;
+}
+
+//------------------------------------------------------------------------------
+// Writer thread count
+//------------------------------------------------------------------------------
+
+void Config_writer_thread_count_set(uint writer_thread_count) {
+	config.writer_thread_count = writer_thread_count;
+}
+
+uint Config_writer_thread_count_get(void) {
+	return config.writer_thread_count;
+}
+
+//------------------------------------------------------------------------------
+// Query time slice
+//------------------------------------------------------------------------------
+
+void Config_query_time_slice_set(uint64_t query_time_slice) {
+	config.query_time_slice = query_time_slice;
+}
+
+uint64_t Config_query_time_slice_get(void) {
+	return config.query_time_slice;
+}
+
+//------------------------------------------------------------------------------
+// intern strings
+//------------------------------------------------------------------------------
+
+void Config_intern_strings_set(bool intern_strings) {
+	config.intern_strings = intern_strings;
+}
+
+bool Config_intern_strings_get(void) {
+	return config.intern_strings;
+}
+
+//------------------------------------------------------------------------------
+// Frozen relations
+//------------------------------------------------------------------------------
+
+void Config_freeze_relations_set(bool freeze_relations) {
+	config.freeze_relations = freeze_relations;
+}
+
+bool Config_freeze_relations_get(void) {
+	return config.freeze_relations;
+}
+
+//------------------------------------------------------------------------------
+// delete chunk size
+//------------------------------------------------------------------------------
+
+void Config_delete_chunk_size_set(uint64_t delete_chunk_size) {
+	config.delete_chunk_size = delete_chunk_size;
+}
+
+uint64_t Config_delete_chunk_size_get(void) {
+	return config.delete_chunk_size;
+}
+
+//------------------------------------------------------------------------------
+// Index construction
+//------------------------------------------------------------------------------
+
+void Config_index_build_chunk_size_set(uint64_t index_build_chunk_size) {
+	config.index_build_chunk_size = index_build_chunk_size;
+}
+
+uint64_t Config_index_build_chunk_size_get(void) {
+	return config.index_build_chunk_size;
+}
+
+//------------------------------------------------------------------------------
+// Plan statistics
+//------------------------------------------------------------------------------
+
+void Config_plan_stats_sample_rate_set(uint64_t plan_stats_sample_rate) {
+	config.plan_stats_sample_rate = plan_stats_sample_rate;
+}
+
+uint64_t Config_plan_stats_sample_rate_get(void) {
+	return config.plan_stats_sample_rate;
+}
+
+//------------------------------------------------------------------------------
+// report query phases
+//------------------------------------------------------------------------------
+
+void Config_report_query_phases_set(bool report_query_phases) {
+	config.report_query_phases = report_query_phases;
+}
+
+bool Config_report_query_phases_get(void) {
+	return config.report_query_phases;
+}
+
+//------------------------------------------------------------------------------
+// admission control
+//------------------------------------------------------------------------------
+
+void Config_query_cost_budget_set(uint64_t query_cost_budget) {
+	config.query_cost_budget = query_cost_budget;
+}
+
+uint64_t Config_query_cost_budget_get(void) {
+	return config.query_cost_budget;
+}
+
+void Config_reject_over_budget_set(bool reject_over_budget) {
+	config.reject_over_budget = reject_over_budget;
+}
+
+bool Config_reject_over_budget_get(void) {
+	return config.reject_over_budget;
+}
+
+//------------------------------------------------------------------------------
+// product cache
+//------------------------------------------------------------------------------
+
+void Config_product_cache_capacity_set(uint64_t product_cache_capacity) {
+	config.product_cache_capacity = product_cache_capacity;
+}
+
+uint64_t Config_product_cache_capacity_get(void) {
+	return config.product_cache_capacity;
+}
+
+//------------------------------------------------------------------------------
+// effects replication
+//------------------------------------------------------------------------------
+
+void Config_replicate_effects_set(bool replicate_effects) {
+	config.replicate_effects = replicate_effects;
+}
+
+bool Config_replicate_effects_get(void) {
+	return config.replicate_effects;
+}
+
+//------------------------------------------------------------------------------
+// thread placement
+//------------------------------------------------------------------------------
+
+void Config_thread_affinity_set(bool thread_affinity) {
+	config.thread_affinity = thread_affinity;
+}
+
+bool Config_thread_affinity_get(void) {
+	return config.thread_affinity;
+}
+
+void Config_numa_interleave_set(bool numa_interleave) {
+	config.numa_interleave = numa_interleave;
+}
+
+bool Config_numa_interleave_get(void) {
+	return config.numa_interleave;
+}
+
+//------------------------------------------------------------------------------
+// result cache
+//------------------------------------------------------------------------------
+
+void Config_result_cache_capacity_set(uint64_t result_cache_capacity) {
+	config.result_cache_capacity = result_cache_capacity;
+}
+
+uint64_t Config_result_cache_capacity_get(void) {
+	return config.result_cache_capacity;
+}
+
+void Config_result_cache_opt_in_set(bool result_cache_opt_in) {
+	config.result_cache_opt_in = result_cache_opt_in;
+}
+
+bool Config_result_cache_opt_in_get(void) {
+	return config.result_cache_opt_in;
+}
+
+void Config_split_write_queries_set(bool split_write_queries) {
+	config.split_write_queries = split_write_queries;
+}
+
+bool Config_split_write_queries_get(void) {
+	return config.split_write_queries;
+}
+
+void Config_max_thread_count_set(uint max_thread_count) {
+	config.max_thread_count = max_thread_count;
+}
+
+uint Config_max_thread_count_get(void) {
+	return config.max_thread_count;
+}
+
+void Config_min_thread_count_set(uint min_thread_count) {
+	config.min_thread_count = min_thread_count;
+}
+
+uint Config_min_thread_count_get(void) {
+	return config.min_thread_count;
+}
+
+void Config_thread_autoscale_set(bool thread_autoscale) {
+	config.thread_autoscale = thread_autoscale;
+}
+
+bool Config_thread_autoscale_get(void) {
+	return config.thread_autoscale;
+}
+
+void Config_maintenance_cpu_budget_set(uint maintenance_cpu_budget) {
+	config.maintenance_cpu_budget = maintenance_cpu_budget;
+}
+
+uint Config_maintenance_cpu_budget_get(void) {
+	return config.maintenance_cpu_budget;
+}
+
+//------------------------------------------------------------------------------
+// Maintain adjacency
+//------------------------------------------------------------------------------
+
+void Config_maintain_adjacency_set(bool maintain) {
+	config.maintain_adjacency = maintain;
+}
+
+bool Config_maintain_adjacency_get(void) {
+	return config.maintain_adjacency;
+}
+
+//------------------------------------------------------------------------------
+// Graph memory budget
+//------------------------------------------------------------------------------
+
+void Config_graph_memory_budget_set(uint64_t graph_memory_budget) {
+	config.graph_memory_budget = graph_memory_budget;
+}
+
+uint64_t Config_graph_memory_budget_get(void) {
+	return config.graph_memory_budget;
+}
+
+//------------------------------------------------------------------------------
+// Value log threshold
+//------------------------------------------------------------------------------
+
+void Config_value_log_threshold_set(uint64_t value_log_threshold) {
+	config.value_log_threshold = value_log_threshold;
+}
+
+uint64_t Config_value_log_threshold_get(void) {
+	return config.value_log_threshold;
+}
+
+//------------------------------------------------------------------------------
+// Graph max concurrent queries
+//------------------------------------------------------------------------------
+
+void Config_graph_max_concurrent_queries_set(uint64_t graph_max_concurrent_queries) {
+	config.graph_max_concurrent_queries = graph_max_concurrent_queries;
+}
+
+uint64_t Config_graph_max_concurrent_queries_get(void) {
+	return config.graph_max_concurrent_queries;
+}
+
+//------------------------------------------------------------------------------
+// Graph CPU quota
+//------------------------------------------------------------------------------
+
+void Config_graph_cpu_quota_set(uint64_t graph_cpu_quota) {
+	config.graph_cpu_quota = graph_cpu_quota;
+}
+
+uint64_t Config_graph_cpu_quota_get(void) {
+	return config.graph_cpu_quota;
+}
+
+//------------------------------------------------------------------------------
+// Re-plan threshold
+//------------------------------------------------------------------------------
+
+void Config_replan_threshold_set(uint64_t replan_threshold) {
+	config.replan_threshold = replan_threshold;
+}
+
+uint64_t Config_replan_threshold_get(void) {
+	return config.replan_threshold;
+}
+
+//------------------------------------------------------------------------------
+// Asynchronous full-text index updates
+//------------------------------------------------------------------------------
+
+void Config_fulltext_async_set(bool fulltext_async) {
+	config.fulltext_async = fulltext_async;
+}
+
+bool Config_fulltext_async_get(void) {
+	return config.fulltext_async;
+}
+
+//------------------------------------------------------------------------------
+// Snapshot pack cache
+//------------------------------------------------------------------------------
+
+void Config_snapshot_pack_cache_set(bool snapshot_pack_cache) {
+	config.snapshot_pack_cache = snapshot_pack_cache;
+}
+
+bool Config_snapshot_pack_cache_get(void) {
+	return config.snapshot_pack_cache;
+}
+
+//------------------------------------------------------------------------------
+// Branch parallelism
+//------------------------------------------------------------------------------
+
+void Config_branch_parallelism_set(uint branch_parallelism) {
+	config.branch_parallelism = branch_parallelism;
+}
+
+uint Config_branch_parallelism_get(void) {
+	return config.branch_parallelism;
+}
+
 bool Config_Contains_field(const char *field_str, Config_Option_Field *field) {
 	ASSERT(field_str != NULL);
 
@@ -225,6 +695,72 @@ bool Config_Contains_field(const char *field_str, Config_Option_Field *field) {
 		f = Config_RESULTSET_MAX_SIZE;
 	} else if (!(strcasecmp(field_str, MAX_QUEUED_QUERIES))) {
 		f = Config_MAX_QUEUED_QUERIES;
+	} else if(!strcasecmp(field_str, PARAMETERIZE_QUERIES)) {
+		f = Config_PARAMETERIZE_QUERIES;
+	} else if(!strcasecmp(field_str, QUERY_MEM_CAPACITY)) {
+		f = Config_QUERY_MEM_CAPACITY;
+	} else if(!strcasecmp(field_str, GROUP_COMMIT_SIZE)) {
+		f = Config_GROUP_COMMIT_SIZE;
+	} else if(!strcasecmp(field_str, WRITER_THREAD_COUNT)) {
+		f = Config_WRITER_THREAD_COUNT;
+	} else if(!strcasecmp(field_str, QUERY_TIME_SLICE)) {
+		f = Config_QUERY_TIME_SLICE;
+	} else if(!strcasecmp(field_str, INTERN_STRINGS)) {
+		f = Config_INTERN_STRINGS;
+	} else if(!strcasecmp(field_str, FREEZE_RELATIONS)) {
+		f = Config_FREEZE_RELATIONS;
+	} else if(!strcasecmp(field_str, DELETE_CHUNK_SIZE)) {
+		f = Config_DELETE_CHUNK_SIZE;
+	} else if(!strcasecmp(field_str, INDEX_BUILD_CHUNK_SIZE)) {
+		f = Config_INDEX_BUILD_CHUNK_SIZE;
+	} else if(!strcasecmp(field_str, PLAN_STATS_SAMPLE_RATE)) {
+		f = Config_PLAN_STATS_SAMPLE_RATE;
+	} else if(!strcasecmp(field_str, REPORT_QUERY_PHASES)) {
+		f = Config_REPORT_QUERY_PHASES;
+	} else if(!strcasecmp(field_str, QUERY_COST_BUDGET)) {
+		f = Config_QUERY_COST_BUDGET;
+	} else if(!strcasecmp(field_str, REJECT_OVER_BUDGET)) {
+		f = Config_REJECT_OVER_BUDGET;
+	} else if(!strcasecmp(field_str, PRODUCT_CACHE_CAPACITY)) {
+		f = Config_PRODUCT_CACHE_CAPACITY;
+	} else if(!strcasecmp(field_str, REPLICATE_EFFECTS)) {
+		f = Config_REPLICATE_EFFECTS;
+	} else if(!strcasecmp(field_str, THREAD_AFFINITY)) {
+		f = Config_THREAD_AFFINITY;
+	} else if(!strcasecmp(field_str, NUMA_INTERLEAVE)) {
+		f = Config_NUMA_INTERLEAVE;
+	} else if(!strcasecmp(field_str, RESULT_CACHE_CAPACITY)) {
+		f = Config_RESULT_CACHE_CAPACITY;
+	} else if(!strcasecmp(field_str, RESULT_CACHE_OPT_IN)) {
+		f = Config_RESULT_CACHE_OPT_IN;
+	} else if(!strcasecmp(field_str, SPLIT_WRITE_QUERIES)) {
+		f = Config_SPLIT_WRITE_QUERIES;
+	} else if(!strcasecmp(field_str, MAX_THREAD_COUNT)) {
+		f = Config_MAX_THREAD_COUNT;
+	} else if(!strcasecmp(field_str, MIN_THREAD_COUNT)) {
+		f = Config_MIN_THREAD_COUNT;
+	} else if(!strcasecmp(field_str, THREAD_AUTOSCALE)) {
+		f = Config_THREAD_AUTOSCALE;
+	} else if(!strcasecmp(field_str, MAINTENANCE_CPU_BUDGET)) {
+		f = Config_MAINTENANCE_CPU_BUDGET;
+	} else if(!strcasecmp(field_str, MAINTAIN_ADJACENCY)) {
+		f = Config_MAINTAIN_ADJACENCY;
+	} else if(!strcasecmp(field_str, GRAPH_MEMORY_BUDGET)) {
+		f = Config_GRAPH_MEMORY_BUDGET;
+	} else if(!strcasecmp(field_str, VALUE_LOG_THRESHOLD)) {
+		f = Config_VALUE_LOG_THRESHOLD;
+	} else if(!strcasecmp(field_str, GRAPH_MAX_CONCURRENT_QUERIES)) {
+		f = Config_GRAPH_MAX_CONCURRENT_QUERIES;
+	} else if(!strcasecmp(field_str, GRAPH_CPU_QUOTA)) {
+		f = Config_GRAPH_CPU_QUOTA;
+	} else if(!strcasecmp(field_str, REPLAN_THRESHOLD)) {
+		f = Config_REPLAN_THRESHOLD;
+	} else if(!strcasecmp(field_str, FULLTEXT_ASYNC)) {
+		f = Config_FULLTEXT_ASYNC;
+	} else if(!strcasecmp(field_str, SNAPSHOT_PACK_CACHE)) {
+		f = Config_SNAPSHOT_PACK_CACHE;
+	} else if(!strcasecmp(field_str, BRANCH_PARALLELISM)) {
+		f = Config_BRANCH_PARALLELISM;
 	} else {
 		return false;
 	}
@@ -269,22 +805,154 @@ const char *Config_Field_name(Config_Option_Field field) {
 			name = ASYNC_DELETE;
 			break;
 
-        //----------------------------------------------------------------------
-        // invalid option
-        //----------------------------------------------------------------------
+		case Config_PARAMETERIZE_QUERIES:
+			name = PARAMETERIZE_QUERIES;
+			break;
 
-        default :
-			ASSERT("invalid option field" && false);
-            break;
-    }
+		case Config_QUERY_MEM_CAPACITY:
+			name = QUERY_MEM_CAPACITY;
+			break;
 
-	return name;
-}
+		case Config_GROUP_COMMIT_SIZE:
+			name = GROUP_COMMIT_SIZE;
+			break;
 
-// initialize every module-level configuration to its default value
-void _Config_SetToDefaults(void) {
-	// the thread pool's default size is equal to the system's number of cores
-	int CPUCount = sysconf(_SC_NPROCESSORS_ONLN);
+		case Config_WRITER_THREAD_COUNT:
+			name = WRITER_THREAD_COUNT;
+			break;
+
+		case Config_QUERY_TIME_SLICE:
+			name = QUERY_TIME_SLICE;
+			break;
+
+		case Config_INTERN_STRINGS:
+			name = INTERN_STRINGS;
+			break;
+
+		case Config_FREEZE_RELATIONS:
+			name = FREEZE_RELATIONS;
+			break;
+
+		case Config_DELETE_CHUNK_SIZE:
+			name = DELETE_CHUNK_SIZE;
+			break;
+
+		case Config_INDEX_BUILD_CHUNK_SIZE:
+			name = INDEX_BUILD_CHUNK_SIZE;
+			break;
+
+		case Config_PLAN_STATS_SAMPLE_RATE:
+			name = PLAN_STATS_SAMPLE_RATE;
+			break;
+
+		case Config_REPORT_QUERY_PHASES:
+			name = REPORT_QUERY_PHASES;
+			break;
+
+		case Config_QUERY_COST_BUDGET:
+			name = QUERY_COST_BUDGET;
+			break;
+
+		case Config_REJECT_OVER_BUDGET:
+			name = REJECT_OVER_BUDGET;
+			break;
+
+		case Config_PRODUCT_CACHE_CAPACITY:
+			name = PRODUCT_CACHE_CAPACITY;
+			break;
+
+		case Config_REPLICATE_EFFECTS:
+			name = REPLICATE_EFFECTS;
+			break;
+
+		case Config_THREAD_AFFINITY:
+			name = THREAD_AFFINITY;
+			break;
+
+		case Config_NUMA_INTERLEAVE:
+			name = NUMA_INTERLEAVE;
+			break;
+
+		case Config_RESULT_CACHE_CAPACITY:
+			name = RESULT_CACHE_CAPACITY;
+			break;
+
+		case Config_RESULT_CACHE_OPT_IN:
+			name = RESULT_CACHE_OPT_IN;
+			break;
+
+		case Config_SPLIT_WRITE_QUERIES:
+			name = SPLIT_WRITE_QUERIES;
+			break;
+
+		case Config_MAX_THREAD_COUNT:
+			name = MAX_THREAD_COUNT;
+			break;
+
+		case Config_MIN_THREAD_COUNT:
+			name = MIN_THREAD_COUNT;
+			break;
+
+		case Config_THREAD_AUTOSCALE:
+			name = THREAD_AUTOSCALE;
+			break;
+
+		case Config_MAINTENANCE_CPU_BUDGET:
+			name = MAINTENANCE_CPU_BUDGET;
+			break;
+
+		case Config_MAINTAIN_ADJACENCY:
+			name = MAINTAIN_ADJACENCY;
+			break;
+
+		case Config_GRAPH_MEMORY_BUDGET:
+			name = GRAPH_MEMORY_BUDGET;
+			break;
+
+		case Config_VALUE_LOG_THRESHOLD:
+			name = VALUE_LOG_THRESHOLD;
+			break;
+
+		case Config_GRAPH_MAX_CONCURRENT_QUERIES:
+			name = GRAPH_MAX_CONCURRENT_QUERIES;
+			break;
+
+		case Config_GRAPH_CPU_QUOTA:
+			name = GRAPH_CPU_QUOTA;
+			break;
+
+		case Config_REPLAN_THRESHOLD:
+			name = REPLAN_THRESHOLD;
+			break;
+
+		case Config_FULLTEXT_ASYNC:
+			name = FULLTEXT_ASYNC;
+			break;
+
+		case Config_SNAPSHOT_PACK_CACHE:
+			name = SNAPSHOT_PACK_CACHE;
+			break;
+
+		case Config_BRANCH_PARALLELISM:
+			name = BRANCH_PARALLELISM;
+			break;
+
+        //----------------------------------------------------------------------
+        // invalid option
+        //----------------------------------------------------------------------
+
+        default :
+			ASSERT("invalid option field" && false);
+            break;
+    }
+
+	return name;
+}
+
+// initialize every module-level configuration to its default value
+void _Config_SetToDefaults(void) {
+	// the thread pool's default size is equal to the system's number of cores
+	int CPUCount = sysconf(_SC_NPROCESSORS_ONLN);
 	config.thread_pool_size = (CPUCount != -1) ? CPUCount : 1;
 
 	// use the GraphBLAS-defined number of OpenMP threads by default
@@ -315,6 +983,94 @@ void _Config_SetToDefaults(void) {
 
 	// no limit on number of queued queries by default
 	config.max_queued_queries = QUEUED_QUERIES_UNLIMITED;
+
+	// lift literals into parameters before plan caching
+	config.parameterize_queries = false;
+
+	// max memory a single query may allocate, in bytes
+	config.query_mem_capacity = QUERY_MEM_CAPACITY_UNLIMITED;
+
+	// max number of queued write queries committed as a group
+	config.group_commit_size = 1;
+
+	// number of writer threads, graphs are sharded across them
+	config.writer_thread_count = 1;
+
+	// milliseconds a read query runs before yielding to queued queries
+	config.query_time_slice = 0;
+
+	// intern string property values in a per-graph pool
+	config.intern_strings = false;
+
+	// compress relation matrices once loaded
+	config.freeze_relations = false;
+
+	// number of entities deleted per commit, 0 for unbounded
+	config.delete_chunk_size = 0;
+
+	// number of nodes indexed per lock window, 0 for unbounded
+	config.index_build_chunk_size = 100000;
+
+	// one in every 100 executions of a cached plan is sampled
+	config.plan_stats_sample_rate = 100;
+
+	// query phases aren't reported by default
+	config.report_query_phases = false;
+
+	// queries aren't held back by their estimated cost by default
+	config.query_cost_budget = 0;
+	config.reject_over_budget = false;
+
+	// traversal products aren't cached by default
+	config.product_cache_capacity = 0;
+
+	// write queries are replicated by their text by default
+	config.replicate_effects = false;
+
+	// threads are placed by the OS, allocating on their first-touch node
+	config.thread_affinity = false;
+	config.numa_interleave = false;
+
+	// replies aren't cached
+	config.result_cache_capacity = 0;
+	config.result_cache_opt_in = false;
+
+	// write queries execute entirely on the writer thread
+	config.split_write_queries = false;
+
+	// the reader thread pool is bound by THREAD_COUNT unless specified
+	// otherwise, see Config_Init
+	config.max_thread_count = 0;
+	config.min_thread_count = 1;
+	config.thread_autoscale = false;
+
+	// background maintenance uses up to a tenth of a core
+	config.maintenance_cpu_budget = 10;
+
+	// maintain adjacency matrices
+	config.maintain_adjacency = true;
+
+	// graphs are never evicted
+	config.graph_memory_budget = 0;
+
+	// string properties are kept in memory
+	config.value_log_threshold = 0;
+
+	// graphs aren't subject to quotas
+	config.graph_max_concurrent_queries = 0;
+	config.graph_cpu_quota = 0;
+
+	// cached plans are never re-planned
+	config.replan_threshold = 0;
+
+	// full-text indices are updated within the writer's commit
+	config.fulltext_async = false;
+
+	// snapshots encode every entity
+	config.snapshot_pack_cache = false;
+
+	// up to 4 UNION branches are executed concurrently
+	config.branch_parallelism = 4;
 }
 
 int Config_Init(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
@@ -355,6 +1111,15 @@ int Config_Init(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 		}
 	}
 
+	// the reader thread pool can't grow beyond its initial size by default
+	if(config.max_thread_count == 0) {
+		config.max_thread_count = config.thread_pool_size;
+	} else if(config.max_thread_count < config.thread_pool_size) {
+		RedisModule_Log(ctx, "warning",
+				"%s must be at least %s", MAX_THREAD_COUNT, THREAD_COUNT);
+		return REDISMODULE_ERR;
+	}
+
 	return REDISMODULE_OK;
 }
 
@@ -424,6 +1189,9 @@ bool Config_Option_set(Config_Option_Field field, RedisModuleString *val) {
 			{
 				long long pool_nthreads;
 				if(!_Config_ParsePositiveInteger(val, &pool_nthreads)) return false;
+				// the pool can't be resized beyond MAX_THREAD_COUNT
+				if(config.max_thread_count != 0 &&
+				   pool_nthreads > config.max_thread_count) return false;
 
 				Config_thread_pool_size_set(pool_nthreads);
 			}
@@ -481,155 +1249,1006 @@ bool Config_Option_set(Config_Option_Field field, RedisModuleString *val) {
 			}
 			break;
 
-	    //----------------------------------------------------------------------
-	    // invalid option
-	    //----------------------------------------------------------------------
+		//----------------------------------------------------------------------
+		// parameterize queries
+		//----------------------------------------------------------------------
 
-        default : 
-			return false;
-    }
+		case Config_PARAMETERIZE_QUERIES:
+			{
+				bool parameterize_queries;
+				if(!_Config_ParseYesNo(val, &parameterize_queries)) return false;
 
-	return true;
-}
+				Config_parameterize_queries_set(parameterize_queries);
+			}
+			break;
 
-bool Config_Option_get(Config_Option_Field field, ...) {
+		//----------------------------------------------------------------------
+		// query memory capacity
+		//----------------------------------------------------------------------
 
-	//--------------------------------------------------------------------------
-	// get the option
-	//--------------------------------------------------------------------------
+		case Config_QUERY_MEM_CAPACITY:
+			{
+				long long query_mem_capacity;
+				if(!_Config_ParseInteger(val, &query_mem_capacity)) return false;
 
-	va_list ap;
+				Config_query_mem_capacity_set(query_mem_capacity);
+			}
+			break;
 
-	switch (field)
-	{
-		case Config_MAX_QUEUED_QUERIES:
+		//----------------------------------------------------------------------
+		// group commit size
+		//----------------------------------------------------------------------
+
+		case Config_GROUP_COMMIT_SIZE:
 			{
+				long long group_commit_size;
+				if(!_Config_ParsePositiveInteger(val, &group_commit_size)) return false;
 
-				va_start(ap, field);
-				uint64_t *max_queued_queries = va_arg(ap, uint64_t*);
-				va_end(ap);
+				Config_group_commit_size_set(group_commit_size);
+			}
+			break;
 
-				ASSERT(max_queued_queries != NULL);
-				(*max_queued_queries) = Config_max_queued_queries_get();
+		//----------------------------------------------------------------------
+		// Writer thread count
+		//----------------------------------------------------------------------
+
+		case Config_WRITER_THREAD_COUNT:
+			{
+				long long writer_thread_count;
+				if(!_Config_ParsePositiveInteger(val, &writer_thread_count)) return false;
+
+				Config_writer_thread_count_set(writer_thread_count);
 			}
 			break;
+
 		//----------------------------------------------------------------------
-		// timeout
+		// Query time slice
 		//----------------------------------------------------------------------
 
-		case Config_TIMEOUT:
+		case Config_QUERY_TIME_SLICE:
 			{
-				va_start(ap, field);
-				uint64_t *timeout = va_arg(ap, uint64_t*);
-				va_end(ap);
+				long long query_time_slice;
+				if(!_Config_ParsePositiveInteger(val, &query_time_slice)) return false;
 
-				ASSERT(timeout != NULL);
-				(*timeout) = Config_timeout_get();
+				Config_query_time_slice_set(query_time_slice);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// cache size
+		// intern strings
 		//----------------------------------------------------------------------
 
-		case Config_CACHE_SIZE:
+		case Config_INTERN_STRINGS:
 			{
-				va_start(ap, field);
-				uint64_t *cache_size = va_arg(ap, uint64_t*);
-				va_end(ap);
+				bool intern_strings;
+				if(!_Config_ParseYesNo(val, &intern_strings)) return false;
 
-				ASSERT(cache_size != NULL);
-				(*cache_size) = Config_cache_size_get();
+				Config_intern_strings_set(intern_strings);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// OpenMP thread count
+		// Frozen relations
 		//----------------------------------------------------------------------
 
-		case Config_OPENMP_NTHREAD:
+		case Config_FREEZE_RELATIONS:
 			{
-				va_start(ap, field);
-				uint *omp_nthreads = va_arg(ap, uint*);
-				va_end(ap);
+				bool freeze_relations;
+				if(!_Config_ParseYesNo(val, &freeze_relations)) return false;
 
-				ASSERT(omp_nthreads != NULL);
-				(*omp_nthreads) = Config_OMP_thread_count_get();
+				Config_freeze_relations_set(freeze_relations);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// thread-pool size
+		// delete chunk size
 		//----------------------------------------------------------------------
 
-		case Config_THREAD_POOL_SIZE:
+		case Config_DELETE_CHUNK_SIZE:
 			{
-				va_start(ap, field);
-				uint *pool_nthreads = va_arg(ap, uint*);
-				va_end(ap);
+				long long delete_chunk_size;
+				if(!_Config_ParsePositiveInteger(val, &delete_chunk_size)) return false;
 
-				ASSERT(pool_nthreads != NULL);
-				(*pool_nthreads) = Config_thread_pool_size_get();
+				Config_delete_chunk_size_set(delete_chunk_size);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// result-set size
+		// Index construction
 		//----------------------------------------------------------------------
 
-		case Config_RESULTSET_MAX_SIZE:
+		case Config_INDEX_BUILD_CHUNK_SIZE:
 			{
-				va_start(ap, field);
-				uint64_t *resultset_max_size = va_arg(ap, uint64_t*);
-				va_end(ap);
+				long long index_build_chunk_size;
+				if(!_Config_ParsePositiveInteger(val, &index_build_chunk_size)) return false;
 
-				ASSERT(resultset_max_size != NULL);
-				(*resultset_max_size) = Config_resultset_max_size_get();
+				Config_index_build_chunk_size_set(index_build_chunk_size);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// maintain transpose
+		// Plan statistics
 		//----------------------------------------------------------------------
 
-		case Config_MAINTAIN_TRANSPOSE:
+		case Config_PLAN_STATS_SAMPLE_RATE:
 			{
-				va_start(ap, field);
-				bool *maintain_transpose = va_arg(ap, bool*);
-				va_end(ap);
+				// 0 disables sampling
+				long long plan_stats_sample_rate;
+				if(!_Config_ParseInteger(val, &plan_stats_sample_rate)) return false;
+				if(plan_stats_sample_rate < 0) return false;
 
-				ASSERT(maintain_transpose != NULL);
-				(*maintain_transpose) = Config_maintain_transpose_get();
+				Config_plan_stats_sample_rate_set(plan_stats_sample_rate);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// virtual key entity count
+		// report query phases
 		//----------------------------------------------------------------------
 
-		case Config_VKEY_MAX_ENTITY_COUNT:
+		case Config_REPORT_QUERY_PHASES:
 			{
-				va_start(ap, field);
-				uint64_t *vkey_max_entity_count = va_arg(ap, uint64_t*);
-				va_end(ap);
+				bool report_query_phases;
+				if(!_Config_ParseYesNo(val, &report_query_phases)) return false;
 
-				ASSERT(vkey_max_entity_count != NULL);
-				(*vkey_max_entity_count) = Config_virtual_key_entity_count_get();
+				Config_report_query_phases_set(report_query_phases);
 			}
 			break;
 
 		//----------------------------------------------------------------------
-		// async deleteion
+		// admission control
 		//----------------------------------------------------------------------
 
-		case Config_ASYNC_DELETE:
+		case Config_QUERY_COST_BUDGET:
 			{
-				va_start(ap, field);
-				bool *async_delete = va_arg(ap, bool*);
-				va_end(ap);
+				// 0 for unlimited
+				long long query_cost_budget;
+				if(!_Config_ParseInteger(val, &query_cost_budget)) return false;
+				if(query_cost_budget < 0) return false;
 
-				ASSERT(async_delete != NULL);
-				(*async_delete) = Config_async_delete_get();
+				Config_query_cost_budget_set(query_cost_budget);
+			}
+			break;
+
+		case Config_REJECT_OVER_BUDGET:
+			{
+				bool reject_over_budget;
+				if(!_Config_ParseYesNo(val, &reject_over_budget)) return false;
+
+				Config_reject_over_budget_set(reject_over_budget);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// product cache
+		//----------------------------------------------------------------------
+
+		case Config_PRODUCT_CACHE_CAPACITY:
+			{
+				// 0 disables caching
+				long long product_cache_capacity;
+				if(!_Config_ParseInteger(val, &product_cache_capacity)) return false;
+				if(product_cache_capacity < 0) return false;
+
+				Config_product_cache_capacity_set(product_cache_capacity);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// effects replication
+		//----------------------------------------------------------------------
+
+		case Config_REPLICATE_EFFECTS:
+			{
+				bool replicate_effects;
+				if(!_Config_ParseYesNo(val, &replicate_effects)) return false;
+
+				Config_replicate_effects_set(replicate_effects);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// thread placement
+		//----------------------------------------------------------------------
+
+		case Config_THREAD_AFFINITY:
+			{
+				bool thread_affinity;
+				if(!_Config_ParseYesNo(val, &thread_affinity)) return false;
+
+				Config_thread_affinity_set(thread_affinity);
+			}
+			break;
+
+		case Config_NUMA_INTERLEAVE:
+			{
+				bool numa_interleave;
+				if(!_Config_ParseYesNo(val, &numa_interleave)) return false;
+
+				Config_numa_interleave_set(numa_interleave);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// result cache
+		//----------------------------------------------------------------------
+
+		case Config_RESULT_CACHE_CAPACITY:
+			{
+				// 0 disables caching
+				long long result_cache_capacity;
+				if(!_Config_ParseInteger(val, &result_cache_capacity)) return false;
+				if(result_cache_capacity < 0) return false;
+
+				Config_result_cache_capacity_set(result_cache_capacity);
+			}
+			break;
+
+		case Config_RESULT_CACHE_OPT_IN:
+			{
+				bool result_cache_opt_in;
+				if(!_Config_ParseYesNo(val, &result_cache_opt_in)) return false;
+
+				Config_result_cache_opt_in_set(result_cache_opt_in);
+			}
+			break;
+
+		case Config_SPLIT_WRITE_QUERIES:
+			{
+				bool split_write_queries;
+				if(!_Config_ParseYesNo(val, &split_write_queries)) return false;
+
+				Config_split_write_queries_set(split_write_queries);
+			}
+			break;
+
+		case Config_MAX_THREAD_COUNT:
+			{
+				long long max_thread_count;
+				if(!_Config_ParsePositiveInteger(val, &max_thread_count)) return false;
+
+				Config_max_thread_count_set(max_thread_count);
+			}
+			break;
+
+		case Config_MIN_THREAD_COUNT:
+			{
+				long long min_thread_count;
+				if(!_Config_ParsePositiveInteger(val, &min_thread_count)) return false;
+
+				Config_min_thread_count_set(min_thread_count);
+			}
+			break;
+
+		case Config_THREAD_AUTOSCALE:
+			{
+				bool thread_autoscale;
+				if(!_Config_ParseYesNo(val, &thread_autoscale)) return false;
+
+				Config_thread_autoscale_set(thread_autoscale);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// background maintenance
+		//----------------------------------------------------------------------
+
+		case Config_MAINTENANCE_CPU_BUDGET:
+			{
+				// percentage of a core, 0 disables maintenance
+				long long maintenance_cpu_budget;
+				if(!_Config_ParseInteger(val, &maintenance_cpu_budget)) return false;
+				if(maintenance_cpu_budget < 0 || maintenance_cpu_budget > 100) return false;
+
+				Config_maintenance_cpu_budget_set(maintenance_cpu_budget);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// maintain adjacency
+		//----------------------------------------------------------------------
+
+		case Config_MAINTAIN_ADJACENCY:
+			{
+				bool maintain_adjacency;
+				if(!_Config_ParseYesNo(val, &maintain_adjacency)) return false;
+
+				Config_maintain_adjacency_set(maintain_adjacency);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// graph memory budget
+		//----------------------------------------------------------------------
+
+		case Config_GRAPH_MEMORY_BUDGET:
+			{
+				// bytes, 0 disables eviction
+				long long graph_memory_budget;
+				if(!_Config_ParseInteger(val, &graph_memory_budget)) return false;
+				if(graph_memory_budget < 0) return false;
+
+				Config_graph_memory_budget_set(graph_memory_budget);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// value log threshold
+		//----------------------------------------------------------------------
+
+		case Config_VALUE_LOG_THRESHOLD:
+			{
+				// bytes, 0 disables the value log
+				long long value_log_threshold;
+				if(!_Config_ParseInteger(val, &value_log_threshold)) return false;
+				if(value_log_threshold < 0) return false;
+
+				Config_value_log_threshold_set(value_log_threshold);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// graph max concurrent queries
+		//----------------------------------------------------------------------
+
+		case Config_GRAPH_MAX_CONCURRENT_QUERIES:
+			{
+				// queries per graph, 0 for unlimited
+				long long graph_max_concurrent_queries;
+				if(!_Config_ParseInteger(val, &graph_max_concurrent_queries)) return false;
+				if(graph_max_concurrent_queries < 0) return false;
+
+				Config_graph_max_concurrent_queries_set(graph_max_concurrent_queries);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// graph CPU quota
+		//----------------------------------------------------------------------
+
+		case Config_GRAPH_CPU_QUOTA:
+			{
+				// milliseconds per second, 0 for unlimited
+				long long graph_cpu_quota;
+				if(!_Config_ParseInteger(val, &graph_cpu_quota)) return false;
+				if(graph_cpu_quota < 0) return false;
+
+				Config_graph_cpu_quota_set(graph_cpu_quota);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// re-plan threshold
+		//----------------------------------------------------------------------
+
+		case Config_REPLAN_THRESHOLD:
+			{
+				// misestimate ratio, 0 disables re-planning
+				// a ratio of 1 would consider every estimate wrong
+				long long replan_threshold;
+				if(!_Config_ParseInteger(val, &replan_threshold)) return false;
+				if(replan_threshold < 0 || replan_threshold == 1) return false;
+
+				Config_replan_threshold_set(replan_threshold);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// asynchronous full-text index updates
+		//----------------------------------------------------------------------
+
+		case Config_FULLTEXT_ASYNC:
+			{
+				bool fulltext_async;
+				if(!_Config_ParseYesNo(val, &fulltext_async)) return false;
+
+				Config_fulltext_async_set(fulltext_async);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// snapshot pack cache
+		//----------------------------------------------------------------------
+
+		case Config_SNAPSHOT_PACK_CACHE:
+			{
+				bool snapshot_pack_cache;
+				if(!_Config_ParseYesNo(val, &snapshot_pack_cache)) return false;
+
+				Config_snapshot_pack_cache_set(snapshot_pack_cache);
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// branch parallelism
+		//----------------------------------------------------------------------
+
+		case Config_BRANCH_PARALLELISM:
+			{
+				// 1 executes branches sequentially
+				long long branch_parallelism;
+				if(!_Config_ParseInteger(val, &branch_parallelism)) return false;
+				if(branch_parallelism < 1 || branch_parallelism > UINT_MAX) return false;
+
+				Config_branch_parallelism_set(branch_parallelism);
+			}
+			break;
+
+	    //----------------------------------------------------------------------
+	    // invalid option
+	    //----------------------------------------------------------------------
+
+        default : 
+			return false;
+    }
+
+	return true;
+}
+
+bool Config_Option_get(Config_Option_Field field, ...) {
+
+	//--------------------------------------------------------------------------
+	// get the option
+	//--------------------------------------------------------------------------
+
+	va_list ap;
+
+	switch (field)
+	{
+		case Config_MAX_QUEUED_QUERIES:
+			{
+
+				va_start(ap, field);
+				uint64_t *max_queued_queries = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(max_queued_queries != NULL);
+				(*max_queued_queries) = Config_max_queued_queries_get();
+			}
+			break;
+		//----------------------------------------------------------------------
+		// timeout
+		//----------------------------------------------------------------------
+
+		case Config_TIMEOUT:
+			{
+				va_start(ap, field);
+				uint64_t *timeout = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(timeout != NULL);
+				(*timeout) = Config_timeout_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// cache size
+		//----------------------------------------------------------------------
+
+		case Config_CACHE_SIZE:
+			{
+				va_start(ap, field);
+				uint64_t *cache_size = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(cache_size != NULL);
+				(*cache_size) = Config_cache_size_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// OpenMP thread count
+		//----------------------------------------------------------------------
+
+		case Config_OPENMP_NTHREAD:
+			{
+				va_start(ap, field);
+				uint *omp_nthreads = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(omp_nthreads != NULL);
+				(*omp_nthreads) = Config_OMP_thread_count_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// thread-pool size
+		//----------------------------------------------------------------------
+
+		case Config_THREAD_POOL_SIZE:
+			{
+				va_start(ap, field);
+				uint *pool_nthreads = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(pool_nthreads != NULL);
+				(*pool_nthreads) = Config_thread_pool_size_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// result-set size
+		//----------------------------------------------------------------------
+
+		case Config_RESULTSET_MAX_SIZE:
+			{
+				va_start(ap, field);
+				uint64_t *resultset_max_size = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(resultset_max_size != NULL);
+				(*resultset_max_size) = Config_resultset_max_size_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// maintain transpose
+		//----------------------------------------------------------------------
+
+		case Config_MAINTAIN_TRANSPOSE:
+			{
+				va_start(ap, field);
+				bool *maintain_transpose = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(maintain_transpose != NULL);
+				(*maintain_transpose) = Config_maintain_transpose_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// virtual key entity count
+		//----------------------------------------------------------------------
+
+		case Config_VKEY_MAX_ENTITY_COUNT:
+			{
+				va_start(ap, field);
+				uint64_t *vkey_max_entity_count = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(vkey_max_entity_count != NULL);
+				(*vkey_max_entity_count) = Config_virtual_key_entity_count_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// async deleteion
+		//----------------------------------------------------------------------
+
+		case Config_ASYNC_DELETE:
+			{
+				va_start(ap, field);
+				bool *async_delete = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(async_delete != NULL);
+				(*async_delete) = Config_async_delete_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// parameterize queries
+		//----------------------------------------------------------------------
+
+		case Config_PARAMETERIZE_QUERIES:
+			{
+				va_start(ap, field);
+				bool *parameterize_queries = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(parameterize_queries != NULL);
+				(*parameterize_queries) = Config_parameterize_queries_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// query memory capacity
+		//----------------------------------------------------------------------
+
+		case Config_QUERY_MEM_CAPACITY:
+			{
+				va_start(ap, field);
+				uint64_t *query_mem_capacity = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(query_mem_capacity != NULL);
+				(*query_mem_capacity) = Config_query_mem_capacity_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// group commit size
+		//----------------------------------------------------------------------
+
+		case Config_GROUP_COMMIT_SIZE:
+			{
+				va_start(ap, field);
+				uint64_t *group_commit_size = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(group_commit_size != NULL);
+				(*group_commit_size) = Config_group_commit_size_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// Writer thread count
+		//----------------------------------------------------------------------
+
+		case Config_WRITER_THREAD_COUNT:
+			{
+				va_start(ap, field);
+				uint *writer_thread_count = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(writer_thread_count != NULL);
+				(*writer_thread_count) = Config_writer_thread_count_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// Query time slice
+		//----------------------------------------------------------------------
+
+		case Config_QUERY_TIME_SLICE:
+			{
+				va_start(ap, field);
+				uint64_t *query_time_slice = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(query_time_slice != NULL);
+				(*query_time_slice) = Config_query_time_slice_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// intern strings
+		//----------------------------------------------------------------------
+
+		case Config_INTERN_STRINGS:
+			{
+				va_start(ap, field);
+				bool *intern_strings = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(intern_strings != NULL);
+				(*intern_strings) = Config_intern_strings_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// Frozen relations
+		//----------------------------------------------------------------------
+
+		case Config_FREEZE_RELATIONS:
+			{
+				va_start(ap, field);
+				bool *freeze_relations = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(freeze_relations != NULL);
+				(*freeze_relations) = Config_freeze_relations_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// delete chunk size
+		//----------------------------------------------------------------------
+
+		case Config_DELETE_CHUNK_SIZE:
+			{
+				va_start(ap, field);
+				uint64_t *delete_chunk_size = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(delete_chunk_size != NULL);
+				(*delete_chunk_size) = Config_delete_chunk_size_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// Index construction
+		//----------------------------------------------------------------------
+
+		case Config_INDEX_BUILD_CHUNK_SIZE:
+			{
+				va_start(ap, field);
+				uint64_t *index_build_chunk_size = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(index_build_chunk_size != NULL);
+				(*index_build_chunk_size) = Config_index_build_chunk_size_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// Plan statistics
+		//----------------------------------------------------------------------
+
+		case Config_PLAN_STATS_SAMPLE_RATE:
+			{
+				va_start(ap, field);
+				uint64_t *plan_stats_sample_rate = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(plan_stats_sample_rate != NULL);
+				(*plan_stats_sample_rate) = Config_plan_stats_sample_rate_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// report query phases
+		//----------------------------------------------------------------------
+
+		case Config_REPORT_QUERY_PHASES:
+			{
+				va_start(ap, field);
+				bool *report_query_phases = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(report_query_phases != NULL);
+				(*report_query_phases) = Config_report_query_phases_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// admission control
+		//----------------------------------------------------------------------
+
+		case Config_QUERY_COST_BUDGET:
+			{
+				va_start(ap, field);
+				uint64_t *query_cost_budget = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(query_cost_budget != NULL);
+				(*query_cost_budget) = Config_query_cost_budget_get();
+			}
+			break;
+
+		case Config_REJECT_OVER_BUDGET:
+			{
+				va_start(ap, field);
+				bool *reject_over_budget = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(reject_over_budget != NULL);
+				(*reject_over_budget) = Config_reject_over_budget_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// product cache
+		//----------------------------------------------------------------------
+
+		case Config_PRODUCT_CACHE_CAPACITY:
+			{
+				va_start(ap, field);
+				uint64_t *product_cache_capacity = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(product_cache_capacity != NULL);
+				(*product_cache_capacity) = Config_product_cache_capacity_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// effects replication
+		//----------------------------------------------------------------------
+
+		case Config_REPLICATE_EFFECTS:
+			{
+				va_start(ap, field);
+				bool *replicate_effects = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(replicate_effects != NULL);
+				(*replicate_effects) = Config_replicate_effects_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// thread placement
+		//----------------------------------------------------------------------
+
+		case Config_THREAD_AFFINITY:
+			{
+				va_start(ap, field);
+				bool *thread_affinity = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(thread_affinity != NULL);
+				(*thread_affinity) = Config_thread_affinity_get();
+			}
+			break;
+
+		case Config_NUMA_INTERLEAVE:
+			{
+				va_start(ap, field);
+				bool *numa_interleave = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(numa_interleave != NULL);
+				(*numa_interleave) = Config_numa_interleave_get();
+			}
+			break;
+
+		//----------------------------------------------------------------------
+		// result cache
+		//----------------------------------------------------------------------
+
+		case Config_RESULT_CACHE_CAPACITY:
+			{
+				va_start(ap, field);
+				uint64_t *result_cache_capacity = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(result_cache_capacity != NULL);
+				(*result_cache_capacity) = Config_result_cache_capacity_get();
+			}
+			break;
+
+		case Config_RESULT_CACHE_OPT_IN:
+			{
+				va_start(ap, field);
+				bool *result_cache_opt_in = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(result_cache_opt_in != NULL);
+				(*result_cache_opt_in) = Config_result_cache_opt_in_get();
+			}
+			break;
+
+		case Config_SPLIT_WRITE_QUERIES:
+			{
+				va_start(ap, field);
+				bool *split_write_queries = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(split_write_queries != NULL);
+				(*split_write_queries) = Config_split_write_queries_get();
+			}
+			break;
+
+		case Config_MAX_THREAD_COUNT:
+			{
+				va_start(ap, field);
+				uint *max_thread_count = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(max_thread_count != NULL);
+				(*max_thread_count) = Config_max_thread_count_get();
+			}
+			break;
+
+		case Config_MIN_THREAD_COUNT:
+			{
+				va_start(ap, field);
+				uint *min_thread_count = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(min_thread_count != NULL);
+				(*min_thread_count) = Config_min_thread_count_get();
+			}
+			break;
+
+		case Config_THREAD_AUTOSCALE:
+			{
+				va_start(ap, field);
+				bool *thread_autoscale = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(thread_autoscale != NULL);
+				(*thread_autoscale) = Config_thread_autoscale_get();
+			}
+			break;
+
+		case Config_MAINTENANCE_CPU_BUDGET:
+			{
+				va_start(ap, field);
+				uint *maintenance_cpu_budget = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(maintenance_cpu_budget != NULL);
+				(*maintenance_cpu_budget) = Config_maintenance_cpu_budget_get();
+			}
+			break;
+
+		case Config_MAINTAIN_ADJACENCY:
+			{
+				va_start(ap, field);
+				bool *maintain_adjacency = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(maintain_adjacency != NULL);
+				(*maintain_adjacency) = Config_maintain_adjacency_get();
+			}
+			break;
+
+		case Config_GRAPH_MEMORY_BUDGET:
+			{
+				va_start(ap, field);
+				uint64_t *graph_memory_budget = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(graph_memory_budget != NULL);
+				(*graph_memory_budget) = Config_graph_memory_budget_get();
+			}
+			break;
+
+		case Config_VALUE_LOG_THRESHOLD:
+			{
+				va_start(ap, field);
+				uint64_t *value_log_threshold = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(value_log_threshold != NULL);
+				(*value_log_threshold) = Config_value_log_threshold_get();
+			}
+			break;
+
+		case Config_GRAPH_MAX_CONCURRENT_QUERIES:
+			{
+				va_start(ap, field);
+				uint64_t *graph_max_concurrent_queries = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(graph_max_concurrent_queries != NULL);
+				(*graph_max_concurrent_queries) = Config_graph_max_concurrent_queries_get();
+			}
+			break;
+
+		case Config_GRAPH_CPU_QUOTA:
+			{
+				va_start(ap, field);
+				uint64_t *graph_cpu_quota = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(graph_cpu_quota != NULL);
+				(*graph_cpu_quota) = Config_graph_cpu_quota_get();
+			}
+			break;
+
+		case Config_REPLAN_THRESHOLD:
+			{
+				va_start(ap, field);
+				uint64_t *replan_threshold = va_arg(ap, uint64_t*);
+				va_end(ap);
+
+				ASSERT(replan_threshold != NULL);
+				(*replan_threshold) = Config_replan_threshold_get();
+			}
+			break;
+
+		case Config_FULLTEXT_ASYNC:
+			{
+				va_start(ap, field);
+				bool *fulltext_async = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(fulltext_async != NULL);
+				(*fulltext_async) = Config_fulltext_async_get();
+			}
+			break;
+
+		case Config_SNAPSHOT_PACK_CACHE:
+			{
+				va_start(ap, field);
+				bool *snapshot_pack_cache = va_arg(ap, bool*);
+				va_end(ap);
+
+				ASSERT(snapshot_pack_cache != NULL);
+				(*snapshot_pack_cache) = Config_snapshot_pack_cache_get();
+			}
+			break;
+
+		case Config_BRANCH_PARALLELISM:
+			{
+				va_start(ap, field);
+				uint *branch_parallelism = va_arg(ap, uint*);
+				va_end(ap);
+
+				ASSERT(branch_parallelism != NULL);
+				(*branch_parallelism) = Config_branch_parallelism_get();
 			}
 			break;
 
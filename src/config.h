@@ -12,18 +12,52 @@
 #define RESULTSET_SIZE_UNLIMITED    UINT64_MAX
 #define CONFIG_TIMEOUT_NO_TIMEOUT   0
 #define VKEY_ENTITY_COUNT_UNLIMITED UINT64_MAX
+#define QUERY_MEM_CAPACITY_UNLIMITED 0
 
 typedef enum {
 	Config_TIMEOUT                  = 0,  // timeout value for queries
 	Config_CACHE_SIZE               = 1,  // number of entries in cache
 	Config_ASYNC_DELETE             = 2,  // delete graph asynchronously
 	Config_OPENMP_NTHREAD           = 3,  // max number of OpenMP threads to use
-	Config_THREAD_POOL_SIZE         = 4,  // number of threads in thread pool
+	Config_THREAD_POOL_SIZE         = 4,  // number of threads in reader thread pool
 	Config_RESULTSET_MAX_SIZE       = 5,  // max number of records in result-set
 	Config_MAINTAIN_TRANSPOSE       = 6,  // maintain transpose matrices
 	Config_VKEY_MAX_ENTITY_COUNT    = 7,  // max number of elements in vkey
 	Config_MAX_QUEUED_QUERIES       = 8,  // max number of queued queries
-	Config_END_MARKER               = 9
+	Config_PARAMETERIZE_QUERIES     = 9,  // lift literals into parameters before plan caching
+	Config_QUERY_MEM_CAPACITY       = 10, // max memory a single query may allocate, in bytes
+	Config_GROUP_COMMIT_SIZE        = 11, // max number of queued write queries committed as a group
+	Config_WRITER_THREAD_COUNT      = 12, // number of writer threads, graphs are sharded across them
+	Config_QUERY_TIME_SLICE         = 13, // milliseconds a read query runs before yielding to queued queries
+	Config_INTERN_STRINGS           = 14, // intern string property values in a per-graph pool
+	Config_FREEZE_RELATIONS         = 15, // compress relation matrices once loaded
+	Config_DELETE_CHUNK_SIZE        = 16, // number of entities deleted per commit, 0 for unbounded
+	Config_INDEX_BUILD_CHUNK_SIZE   = 17, // number of nodes indexed per lock window, 0 for unbounded
+	Config_PLAN_STATS_SAMPLE_RATE   = 18, // one in every N executions of a cached plan is sampled, 0 disables sampling
+	Config_REPORT_QUERY_PHASES      = 19, // report the time spent in each query phase along result-set statistics
+	Config_QUERY_COST_BUDGET        = 20, // estimated cost above which read queries are held back while readers are busy, 0 for unlimited
+	Config_REJECT_OVER_BUDGET       = 21, // reject rather than defer read queries exceeding the cost budget
+	Config_PRODUCT_CACHE_CAPACITY   = 22, // max memory held by cached traversal products per graph, in bytes, 0 disables caching
+	Config_REPLICATE_EFFECTS        = 23, // replicate write queries by their effects rather than their text
+	Config_THREAD_AFFINITY          = 24, // pin module threads to the CPUs of NUMA nodes
+	Config_NUMA_INTERLEAVE          = 25, // interleave module threads' allocations across NUMA nodes
+	Config_RESULT_CACHE_CAPACITY    = 26, // max memory held by cached read-only query replies per graph, in bytes, 0 disables caching
+	Config_RESULT_CACHE_OPT_IN      = 27, // cache replies only of queries issued with the --cache flag
+	Config_SPLIT_WRITE_QUERIES      = 28, // run the read phase of costly write queries on reader threads
+	Config_MAX_THREAD_COUNT         = 29, // max number of threads the reader thread pool may grow to
+	Config_MIN_THREAD_COUNT         = 30, // min number of threads the reader thread pool autoscaler may shrink to
+	Config_THREAD_AUTOSCALE         = 31, // grow and shrink the reader thread pool by its queue's wait time
+	Config_MAINTENANCE_CPU_BUDGET   = 32, // percentage of a core background maintenance may use, 0 disables maintenance
+	Config_MAINTAIN_ADJACENCY       = 33, // maintain the adjacency matrices shared by all relation types
+	Config_GRAPH_MEMORY_BUDGET      = 34, // max memory held by resident graphs, in bytes, least recently used graphs are evicted to disk, 0 disables eviction
+	Config_VALUE_LOG_THRESHOLD      = 35, // min length of string property values stored in the per-graph value log, in bytes, 0 disables the log
+	Config_GRAPH_MAX_CONCURRENT_QUERIES = 36, // max number of queries queued or running against a single graph, 0 for unlimited
+	Config_GRAPH_CPU_QUOTA          = 37, // CPU milliseconds per second the queries of a single graph may consume, 0 for unlimited
+	Config_REPLAN_THRESHOLD         = 38, // ratio between actual and estimated records of a sampled plan's operation above which the cached plan is built anew, 0 disables re-planning
+	Config_FULLTEXT_ASYNC           = 39, // apply full-text index updates on a background thread rather than within the writer's commit
+	Config_SNAPSHOT_PACK_CACHE      = 40, // retain the encoding of unmodified entity blocks, reused by snapshots
+	Config_BRANCH_PARALLELISM       = 41, // max number of UNION branches of a read query executed concurrently, 1 executes branches sequentially
+	Config_END_MARKER               = 42
 } Config_Option_Field;
 
 // configuration object
@@ -37,15 +71,74 @@ typedef struct {
 	uint64_t vkey_entity_count;        // The limit of number of entities encoded at once for each RDB key.
 	bool maintain_transposed_matrices; // If true, maintain a transposed version of each relationship matrix.
 	uint64_t max_queued_queries;       // max number of queued queries
+	bool parameterize_queries;         // Lift literals into parameters before plan caching.
+	uint64_t query_mem_capacity;       // Max memory a single query may allocate, in bytes.
+	uint64_t group_commit_size;        // Max number of queued write queries committed as a group.
+	uint writer_thread_count;          // Number of writer threads, graphs are sharded across them.
+	uint64_t query_time_slice;         // Milliseconds a read query runs before yielding to queued queries.
+	bool intern_strings;               // Intern string property values in a per-graph pool.
+	bool freeze_relations;             // Compress relation matrices once loaded.
+	uint64_t delete_chunk_size;        // Number of entities deleted per commit, 0 for unbounded.
+	uint64_t index_build_chunk_size;   // Number of nodes indexed per lock window, 0 for unbounded.
+	uint64_t plan_stats_sample_rate;   // One in every N executions of a cached plan is sampled, 0 disables sampling.
+	bool report_query_phases;          // Report the time spent in each query phase along result-set statistics.
+	uint64_t query_cost_budget;        // Estimated cost above which read queries are held back while readers are busy, 0 for unlimited.
+	bool reject_over_budget;           // Reject rather than defer read queries exceeding the cost budget.
+	uint64_t product_cache_capacity;   // Max memory held by cached traversal products per graph, in bytes.
+	bool replicate_effects;            // Replicate write queries by their effects rather than their text.
+	bool thread_affinity;              // Pin module threads to the CPUs of NUMA nodes.
+	bool numa_interleave;              // Interleave module threads' allocations across NUMA nodes.
+	uint64_t result_cache_capacity;    // Max memory held by cached read-only query replies per graph, in bytes.
+	bool result_cache_opt_in;          // Cache replies only of queries issued with the --cache flag.
+	bool split_write_queries;          // Run the read phase of costly write queries on reader threads.
+	uint max_thread_count;             // Max number of threads the reader thread pool may grow to.
+	uint min_thread_count;             // Min number of threads the reader thread pool autoscaler may shrink to.
+	bool thread_autoscale;             // Grow and shrink the reader thread pool by its queue's wait time.
+	uint maintenance_cpu_budget;       // Percentage of a core background maintenance may use, 0 disables maintenance.
+	bool maintain_adjacency;           // If false, adjacency matrices are computed from relation matrices on demand.
+	uint64_t graph_memory_budget;      // Max memory held by resident graphs, in bytes, 0 disables eviction.
+	uint64_t value_log_threshold;      // Min length of string property values stored in the value log, 0 disables the log.
+	uint64_t graph_max_concurrent_queries; // Max number of queries queued or running against a single graph, 0 for unlimited.
+	uint64_t graph_cpu_quota;          // CPU milliseconds per second the queries of a single graph may consume, 0 for unlimited.
+	uint64_t replan_threshold;         // Misestimate ratio above which a cached plan is built anew, 0 disables re-planning.
+	bool fulltext_async;               // Apply full-text index updates on a background thread.
+	bool snapshot_pack_cache;          // Retain the encoding of unmodified entity blocks for snapshots.
+	uint branch_parallelism;           // Max number of UNION branches of a read query executed concurrently.
 } RG_Config;
 
 // Run-time configurable fields
-#define RUNTIME_CONFIG_COUNT 3
+#define RUNTIME_CONFIG_COUNT 29
 static const Config_Option_Field RUNTIME_CONFIGS[] =
 {
 	Config_RESULTSET_MAX_SIZE,
 	Config_TIMEOUT,
-	Config_MAX_QUEUED_QUERIES
+	Config_MAX_QUEUED_QUERIES,
+	Config_PARAMETERIZE_QUERIES,
+	Config_QUERY_MEM_CAPACITY,
+	Config_GROUP_COMMIT_SIZE,
+	Config_QUERY_TIME_SLICE,
+	Config_DELETE_CHUNK_SIZE,
+	Config_INDEX_BUILD_CHUNK_SIZE,
+	Config_PLAN_STATS_SAMPLE_RATE,
+	Config_REPORT_QUERY_PHASES,
+	Config_QUERY_COST_BUDGET,
+	Config_REJECT_OVER_BUDGET,
+	Config_PRODUCT_CACHE_CAPACITY,
+	Config_REPLICATE_EFFECTS,
+	Config_RESULT_CACHE_CAPACITY,
+	Config_RESULT_CACHE_OPT_IN,
+	Config_SPLIT_WRITE_QUERIES,
+	Config_THREAD_POOL_SIZE,
+	Config_MIN_THREAD_COUNT,
+	Config_THREAD_AUTOSCALE,
+	Config_MAINTENANCE_CPU_BUDGET,
+	Config_GRAPH_MEMORY_BUDGET,
+	Config_GRAPH_MAX_CONCURRENT_QUERIES,
+	Config_GRAPH_CPU_QUOTA,
+	Config_REPLAN_THRESHOLD,
+	Config_FULLTEXT_ASYNC,
+	Config_SNAPSHOT_PACK_CACHE,
+	Config_BRANCH_PARALLELISM
 };
 
 // Set module-level configurations to defaults or to user arguments where provided.
@@ -63,3 +156,6 @@ bool Config_Option_set(Config_Option_Field field, RedisModuleString *val);
 
 bool Config_Option_get(Config_Option_Field field, ...);
 
+// returns true if query literals are lifted into parameters before plan caching
+bool Config_parameterize_queries_get(void);
+
@@ -5,39 +5,172 @@
 */
 
 #include "array.h"
+#include "RG.h"
 #include "../util/arr.h"
+#include "../util/rmalloc.h"
 #include <limits.h>
+#include <string.h>
 #include "xxhash.h"
 
+// element representation
+typedef enum {
+	SIARRAY_UNTYPED = 0,  // no elements yet, decided by the first appended
+	SIARRAY_VALUES,       // SIValue per element
+	SIARRAY_LONGS,        // packed int64_t, all elements are integers
+	SIARRAY_DOUBLES,      // packed double, all elements are floats
+} SIArrayKind;
+
+// list storage, elements follow the header in a single allocation
+// lists holding a single numeric type are packed,
+// taking half the memory of an SIValue per element
+// a packed list is expanded into SIValues once a value of
+// another type is appended to it
+typedef struct SIArray {
+	uint32_t len;      // number of elements
+	uint32_t cap;      // number of elements the buffer can hold
+	SIArrayKind kind;  // element representation
+	int64_t buf[];     // elements
+} SIArray;
+
+static inline size_t _ElemSize(SIArrayKind kind) {
+	return (kind == SIARRAY_VALUES) ? sizeof(SIValue) : sizeof(int64_t);
+}
+
+static inline SIValue *_Values(const SIArray *a) {
+	return (SIValue *)a->buf;
+}
+
+static inline double *_Doubles(const SIArray *a) {
+	return (double *)a->buf;
+}
+
+static inline SIArray *_Alloc(SIArray *a, SIArrayKind kind, uint32_t cap) {
+	size_t size = sizeof(SIArray) + _ElemSize(kind) * cap;
+	a = (a == NULL) ? rm_malloc(size) : rm_realloc(a, size);
+	a->cap = cap;
+	a->kind = kind;
+	return a;
+}
+
+// makes room for n additional elements
+static inline void _Reserve(SIValue *siarray, uint32_t n) {
+	SIArray *a = siarray->array;
+	if(a->len + n <= a->cap) return;
+	uint32_t cap = MAX(a->cap * 2, a->len + n);
+	siarray->array = _Alloc(a, a->kind, cap);
+}
+
+// expands a packed list into SIValues
+static void _Unpack(SIValue *siarray) {
+	SIArray *a = siarray->array;
+	SIArrayKind kind = a->kind;
+	if(kind == SIARRAY_VALUES) return;
+
+	a = _Alloc(a, SIARRAY_VALUES, a->cap);
+	siarray->array = a;
+
+	// expand from last to first, an SIValue spans
+	// the packed element at its position and the one after it
+	SIValue *values = _Values(a);
+	for(int64_t i = (int64_t)a->len - 1; i >= 0; i--) {
+		if(kind == SIARRAY_LONGS) values[i] = SI_LongVal(a->buf[i]);
+		else values[i] = SI_DoubleVal(_Doubles(a)[i]);
+	}
+}
+
+// sets the list representation for an appended value
+// returns true if the value is to be stored packed
+static inline bool _Pack(SIValue *siarray, SIValue value) {
+	SIArray *a = siarray->array;
+	SIType t = SI_TYPE(value);
+
+	if(a->kind == SIARRAY_UNTYPED) {
+		if(t == T_INT64) a->kind = SIARRAY_LONGS;
+		else if(t == T_DOUBLE) a->kind = SIARRAY_DOUBLES;
+		else siarray->array = _Alloc(a, SIARRAY_VALUES, a->cap);
+	}
+
+	a = siarray->array;
+	if(a->kind == SIARRAY_LONGS && t == T_INT64) return true;
+	if(a->kind == SIARRAY_DOUBLES && t == T_DOUBLE) return true;
+	_Unpack(siarray);
+	return false;
+}
+
 SIValue SIArray_New(uint32_t initialCapacity) {
 	SIValue siarray;
-	siarray.array = array_new(SIValue, initialCapacity);
+	siarray.array = _Alloc(NULL, SIARRAY_UNTYPED, initialCapacity);
+	siarray.array->len = 0;
 	siarray.type = T_ARRAY;
 	siarray.allocation = M_SELF;
 	return siarray;
 }
 
+// appends a value the list takes ownership of
+static void _Append(SIValue *siarray, SIValue value) {
+	bool packed = _Pack(siarray, value);
+	_Reserve(siarray, 1);
+
+	SIArray *a = siarray->array;
+	if(!packed) _Values(a)[a->len] = value;
+	else if(a->kind == SIARRAY_LONGS) a->buf[a->len] = value.longval;
+	else _Doubles(a)[a->len] = value.doubleval;
+	a->len++;
+}
+
 void SIArray_Append(SIValue *siarray, SIValue value) {
 	// clone and persist incase of pointer values
-	SIValue clone = SI_CloneValue(value);
-	// append
-	siarray->array = array_append(siarray->array, clone);
+	_Append(siarray, SI_CloneValue(value));
+}
 
+void SIArray_AppendAsOwner(SIValue *siarray, SIValue *value) {
+	_Append(siarray, *value);
+	// the array is now responsible for the value
+	SIValue_MakeVolatile(value);
 }
 
 SIValue SIArray_Get(SIValue siarray, uint32_t index) {
 	// check index
-	if(index >= SIArray_Length(siarray)) return SI_NullVal();
-	return SI_ShareValue(siarray.array[index]);
+	const SIArray *a = siarray.array;
+	if(index >= a->len) return SI_NullVal();
+
+	switch(a->kind) {
+	case SIARRAY_LONGS:
+		return SI_LongVal(a->buf[index]);
+	case SIARRAY_DOUBLES:
+		return SI_DoubleVal(_Doubles(a)[index]);
+	default:
+		return SI_ShareValue(_Values(a)[index]);
+	}
 }
 
 uint32_t SIArray_Length(SIValue siarray) {
-	return array_len(siarray.array);
+	return siarray.array->len;
+}
+
+const int64_t *SIArray_Longs(SIValue siarray) {
+	const SIArray *a = siarray.array;
+	return (a->kind == SIARRAY_LONGS) ? a->buf : NULL;
+}
+
+const double *SIArray_Doubles(SIValue siarray) {
+	const SIArray *a = siarray.array;
+	return (a->kind == SIARRAY_DOUBLES) ? _Doubles(a) : NULL;
 }
 
 SIValue SIArray_Clone(SIValue siarray) {
-	uint arrayLen = SIArray_Length(siarray);
+	const SIArray *a = siarray.array;
+	uint arrayLen = a->len;
 	SIValue newArray = SIArray_New(arrayLen);
+
+	if(a->kind == SIARRAY_LONGS || a->kind == SIARRAY_DOUBLES) {
+		// packed elements are copied as is
+		newArray.array->kind = a->kind;
+		newArray.array->len = arrayLen;
+		memcpy(newArray.array->buf, a->buf, sizeof(int64_t) * arrayLen);
+		return newArray;
+	}
+
 	for(uint i = 0; i < arrayLen; i++) {
 		SIArray_Append(&newArray, SIArray_Get(siarray, i));
 	}
@@ -79,18 +212,32 @@ XXH64_hash_t SIArray_HashCode(SIValue siarray) {
 	XXH64_hash_t hashCode = XXH64(&t, sizeof(t), 0);
 	uint arrayLen = SIArray_Length(siarray);
 	for(uint i = 0; i < arrayLen; i++) {
-		SIValue value = siarray.array[i];
+		SIValue value = SIArray_Get(siarray, i);
 		hashCode = 31 * hashCode + SIValue_HashCode(value);
 	}
 	return hashCode;
 }
 
-void SIArray_Free(SIValue siarray) {
-	uint arrayLen = SIArray_Length(siarray);
-	for(uint i = 0; i < arrayLen; i++) {
-		SIValue value = siarray.array[i];
-		SIValue_Free(value);
+size_t SIArray_MemoryUsage(SIValue siarray) {
+	const SIArray *a = siarray.array;
+	size_t usage = sizeof(SIArray) + _ElemSize(a->kind) * a->cap;
+	if(a->kind != SIARRAY_VALUES) return usage;
+
+	const SIValue *values = _Values(a);
+	for(uint32_t i = 0; i < a->len; i++) {
+		SIValue v = values[i];
+		if(v.allocation != M_SELF) continue;
+		if(SI_TYPE(v) == T_STRING) usage += strlen(v.stringval) + 1;
+		else if(SI_TYPE(v) == T_ARRAY) usage += SIArray_MemoryUsage(v);
 	}
-	array_free(siarray.array);
+	return usage;
 }
 
+void SIArray_Free(SIValue siarray) {
+	SIArray *a = siarray.array;
+	if(a->kind == SIARRAY_VALUES) {
+		SIValue *values = _Values(a);
+		for(uint i = 0; i < a->len; i++) SIValue_Free(values[i]);
+	}
+	rm_free(a);
+}
@@ -16,6 +16,14 @@ SIValue SIArray_New(u_int32_t initialCapacity);
   */
 void SIArray_Append(SIValue *siarray, SIValue value);
 
+/**
+  * @brief  Appends a value to a given array, the array takes ownership of the value
+  * @note   value is marked volatile, such that freeing it is a NOP
+  * @param  siarray: pointer to array
+  * @param  value: new value
+  */
+void SIArray_AppendAsOwner(SIValue *siarray, SIValue *value);
+
 /**
   * @brief  Returns a volatile copy of the SIValue from an array in a given index
   * @note   If index is out of bound, SI_NullVal is returned
@@ -34,6 +42,22 @@ SIValue SIArray_Get(SIValue siarray, u_int32_t index);
   */
 u_int32_t SIArray_Length(SIValue siarray);
 
+/**
+  * @brief  Returns the array elements if all of them are integers
+  * @note   Lists holding a single numeric type are stored packed,
+  *         such that their elements can be scanned without SIValue access
+  * @param  siarray:
+  * @retval Array of SIArray_Length integers, NULL if the array isn't packed integers
+  */
+const int64_t *SIArray_Longs(SIValue siarray);
+
+/**
+  * @brief  Returns the array elements if all of them are floats
+  * @param  siarray:
+  * @retval Array of SIArray_Length doubles, NULL if the array isn't packed floats
+  */
+const double *SIArray_Doubles(SIValue siarray);
+
 /**
   * @brief  Returns a copy of the array
   * @note   The caller needs to free the array
@@ -58,6 +82,14 @@ void SIArray_ToString(SIValue list, char **buf, size_t *bufferLen, size_t *bytes
  */
 XXH64_hash_t SIArray_HashCode(SIValue siarray);
 
+/**
+  * @brief  Returns the number of bytes allocated by the array
+  * @note   Includes heap allocated elements owned by the array
+  * @param  siarray:
+  * @retval Allocated bytes
+  */
+size_t SIArray_MemoryUsage(SIValue siarray);
+
 /**
   * @brief  delete an array
   * @param  siarray:
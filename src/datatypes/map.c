@@ -10,6 +10,7 @@
 #include "../util/strcmp.h"
 #include "../util/rmalloc.h"
 #include "../util/strutil.h"
+#include <string.h>
 
 static inline Pair Pair_New(SIValue key, SIValue val) {
 	ASSERT(SI_TYPE(key) & T_STRING);
@@ -23,6 +24,26 @@ static void Pair_Free(Pair p) {
 	SIValue_Free(p.val);
 }
 
+#define KEY_ISLT(a,b) (strcmp(a->key.stringval, b->key.stringval) < 0)
+
+// returns true if map pairs are kept sorted by key
+static inline bool _Map_Sorted(uint key_count) {
+	return key_count >= MAP_SORTED_MIN_KEYS;
+}
+
+// returns the position of the first pair whose key isn't less than 'key'
+// out of the first 'n' pairs of the map, which must be sorted
+static uint _Map_LowerBound(Map m, uint n, const char *key) {
+	uint lo = 0;
+	uint hi = n;
+	while(lo < hi) {
+		uint mid = lo + (hi - lo) / 2;
+		if(strcmp(m[mid].key.stringval, key) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
 static int Map_KeyIdx(SIValue map, SIValue key) {
 	ASSERT(SI_TYPE(map) & T_MAP);
 	ASSERT(SI_TYPE(key) & T_STRING);
@@ -30,6 +51,13 @@ static int Map_KeyIdx(SIValue map, SIValue key) {
 	Map m = map.map;
 	uint n = array_len(m);
 
+	// binary search large maps
+	if(_Map_Sorted(n)) {
+		uint i = _Map_LowerBound(m, n, key.stringval);
+		if(i < n && RG_STRCMP(m[i].key.stringval, key.stringval) == 0) return i;
+		return -1;
+	}
+
 	// search for key in map
 	for(uint i = 0; i < n; i++) {
 		Pair pair = m[i];
@@ -64,14 +92,44 @@ SIValue Map_Clone
 	uint key_count = Map_KeyCount(map);
 	SIValue clone = Map_New(key_count);
 
+	// keys are unique, pairs are copied in order
 	for(uint i = 0; i < key_count; i++) {
 		Pair p = map.map[i];
-		Map_Add(&clone, p.key, p.val);
+		clone.map = array_append(clone.map, Pair_New(p.key, p.val));
 	}
 
 	return clone;
 }
 
+// adds pair to map, replacing any pair under the same key
+static void _Map_AddPair
+(
+	SIValue *map,
+	Pair pair
+) {
+	// remove key if already existed
+	Map_Remove(*map, pair.key);
+
+	Map m = map->map;
+	uint n = array_len(m);
+
+	// add pair to the end of map
+	m = array_append(m, pair);
+	map->map = m;
+
+	if(n + 1 == MAP_SORTED_MIN_KEYS) {
+		// map grew large, switch to sorted layout
+		QSORT(Pair, m, n + 1, KEY_ISLT);
+	} else if(_Map_Sorted(n)) {
+		// shift greater keys to make room for pair
+		uint i = _Map_LowerBound(m, n, pair.key.stringval);
+		if(i < n) {
+			memmove(m + i + 1, m + i, sizeof(Pair) * (n - i));
+			m[i] = pair;
+		}
+	}
+}
+
 // adds key/value to map
 void Map_Add
 (
@@ -82,14 +140,22 @@ void Map_Add
 	ASSERT(SI_TYPE(*map) & T_MAP);
 	ASSERT(SI_TYPE(key) & T_STRING);
 
-	// remove key if already existed
-	Map_Remove(*map, key);
-
 	// create a new pair
-	Pair pair = Pair_New(key, value);
+	_Map_AddPair(map, Pair_New(key, value));
+}
 
-	// add pair to the end of map
-	map->map = array_append(map->map, pair);
+void Map_AddNoClone
+(
+	SIValue *map,
+	SIValue key,
+	SIValue value
+) {
+	ASSERT(SI_TYPE(*map) & T_MAP);
+	ASSERT(SI_TYPE(key) & T_STRING);
+
+	_Map_AddPair(map, (Pair) {
+		.key = key, .val = value
+	});
 }
 
 // removes key from map
@@ -109,12 +175,17 @@ void Map_Remove
 	// key missing from map
 	if(idx == -1) return;
 
-	// override removed key with last pair
 	Pair_Free(m[idx]);
 	uint last_idx = array_len(m) - 1;
-	m[idx] = m[last_idx];
 
-	// replace pair at 'idx' with last pair
+	if(_Map_Sorted(last_idx + 1)) {
+		// shift greater keys over removed pair, maintaining order
+		memmove(m + idx, m + idx + 1, sizeof(Pair) * (last_idx - idx));
+	} else {
+		// override removed key with last pair
+		m[idx] = m[last_idx];
+	}
+
 	array_pop(m);
 }
 
@@ -179,7 +250,6 @@ SIValue *Map_Keys
 	return keys;
 }
 
-#define KEY_ISLT(a,b) (strcmp(a->key.stringval, b->key.stringval) < 0)
 int Map_Compare
 (
 	SIValue mapA,
@@ -11,13 +11,18 @@
  * map, array, node, edge, path, date, string, bool, numeric and NULL
  *
  * this implimantaion of map, uses SIValue for the stored values
- * and keeps the keys sorted for quick lookup.
  *
  * the underline structure of map is an array of key/value pairs
- * [ (key/value), (key/value), ... (key/value) ] */
+ * [ (key/value), (key/value), ... (key/value) ]
+ *
+ * small maps are scanned linearly, maps holding MAP_SORTED_MIN_KEYS keys
+ * or more keep their pairs sorted by key and are binary searched */
 
 #include "../value.h"
 
+// minimal number of keys for a map to be kept sorted
+#define MAP_SORTED_MIN_KEYS 16
+
 typedef struct Pair {
 	SIValue key;  // key associated with value
 	SIValue val;  // value stored under key
@@ -45,6 +50,14 @@ void Map_Add
 	SIValue value  // value to add under key
 );
 
+// adds key/value to map, map takes ownership of both key and value
+void Map_AddNoClone
+(
+	SIValue *map,  // map to add element to
+	SIValue key,   // key under which value is added
+	SIValue value  // value to add under key
+);
+
 // removes key from map
 void Map_Remove
 (
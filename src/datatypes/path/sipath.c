@@ -9,66 +9,160 @@
 #include "../../util/rmalloc.h"
 #include "../../util/arr.h"
 #include "../array.h"
+#include "../../query_ctx.h"
 
-SIValue SIPath_New(Path *p) {
-	SIValue path;
-	path.ptrval = Path_Clone(p);
-	path.type = T_PATH;
-	path.allocation = M_SELF;
+// entity of nodes and edges deleted after the path was built
+static Entity _deleted_entity = {0};
+
+static SIPath *_SIPath_Alloc(uint node_count, uint edge_count) {
+	SIPath *path = rm_malloc(sizeof(SIPath));
+	path->nodes = array_new(NodeID, node_count);
+	path->edges = array_new(SIPathEdge, edge_count);
+	path->node_cache = NULL;
+	path->edge_cache = NULL;
 	return path;
 }
 
+// retrieves node 'id' from the graph
+static inline Node _SIPath_MaterializeNode(const Graph *g, NodeID id) {
+	Node n = GE_NEW_LABELED_NODE(NULL, GRAPH_UNKNOWN_LABEL);
+	if(!Graph_GetNode(g, id, &n)) n.entity = &_deleted_entity;
+	return n;
+}
+
+// retrieves edge 'pe' from the graph
+static inline Edge _SIPath_MaterializeEdge(const Graph *g, const SIPathEdge *pe) {
+	Edge e = {0};
+	if(!Graph_GetEdge(g, pe->id, &e)) e.entity = &_deleted_entity;
+	e.relationID = pe->relationID;
+	e.srcNodeID = pe->src;
+	e.destNodeID = pe->dest;
+	return e;
+}
+
+// materializes all path nodes, such that references to them remain valid
+// for as long as the path lives
+static void _SIPath_MaterializeNodes(SIPath *path) {
+	if(path->node_cache != NULL) return;
+
+	const Graph *g = QueryCtx_GetGraph();
+	uint count = array_len(path->nodes);
+	path->node_cache = array_new(Node, count);
+	for(uint i = 0; i < count; i++) {
+		array_append(path->node_cache, _SIPath_MaterializeNode(g, path->nodes[i]));
+	}
+}
+
+// materializes all path edges, see _SIPath_MaterializeNodes
+static void _SIPath_MaterializeEdges(SIPath *path) {
+	if(path->edge_cache != NULL) return;
+
+	const Graph *g = QueryCtx_GetGraph();
+	uint count = array_len(path->edges);
+	path->edge_cache = array_new(Edge, count);
+	for(uint i = 0; i < count; i++) {
+		array_append(path->edge_cache, _SIPath_MaterializeEdge(g, path->edges + i));
+	}
+}
+
+SIValue SIPath_New(Path *p) {
+	uint node_count = Path_NodeCount(p);
+	uint edge_count = Path_EdgeCount(p);
+	SIPath *path = _SIPath_Alloc(node_count, edge_count);
+
+	for(uint i = 0; i < node_count; i++) {
+		array_append(path->nodes, ENTITY_GET_ID(Path_GetNode(p, i)));
+	}
+	for(uint i = 0; i < edge_count; i++) {
+		Edge *e = Path_GetEdge(p, i);
+		SIPathEdge pe = {
+			.id = ENTITY_GET_ID(e),
+			.src = Edge_GetSrcNodeID(e),
+			.dest = Edge_GetDestNodeID(e),
+			.relationID = Edge_GetRelationID(e)
+		};
+		array_append(path->edges, pe);
+	}
+
+	SIValue v;
+	v.ptrval = path;
+	v.type = T_PATH;
+	v.allocation = M_SELF;
+	return v;
+}
+
 SIValue SIPath_Clone(SIValue p) {
-	return SIPath_New((Path *)p.ptrval);
+	// copy IDs only, nodes and edges are materialized by the clone if accessed
+	SIPath *path = (SIPath *)p.ptrval;
+	SIPath *clone = rm_malloc(sizeof(SIPath));
+	array_clone(clone->nodes, path->nodes);
+	array_clone(clone->edges, path->edges);
+	clone->node_cache = NULL;
+	clone->edge_cache = NULL;
+
+	SIValue v;
+	v.ptrval = clone;
+	v.type = T_PATH;
+	v.allocation = M_SELF;
+	return v;
 }
 
 SIValue SIPath_ToList(SIValue p) {
+	SIPath *path = (SIPath *)p.ptrval;
+	const Graph *g = QueryCtx_GetGraph();
 	size_t nodeCount = SIPath_NodeCount(p);
 	size_t edgeCount = SIPath_Length(p);
 	SIValue array = SI_Array(nodeCount + edgeCount);
+	// list members are clones, materialize into temporaries
 	for(size_t i = 0; i < nodeCount - 1 ; i++) {
-		SIValue node = SIPath_GetNode(p, i);
-		SIArray_Append(&array, node);
-		SIValue edge = SIPath_GetRelationship(p, i);
-		SIArray_Append(&array, edge);
+		Node node = _SIPath_MaterializeNode(g, path->nodes[i]);
+		SIArray_Append(&array, SI_Node(&node));
+		Edge edge = _SIPath_MaterializeEdge(g, path->edges + i);
+		SIArray_Append(&array, SI_Edge(&edge));
 	}
 	if(nodeCount > 0) {
-		SIValue node = SIPath_GetNode(p, nodeCount - 1);
-		SIArray_Append(&array, node);
+		Node node = _SIPath_MaterializeNode(g, path->nodes[nodeCount - 1]);
+		SIArray_Append(&array, SI_Node(&node));
 	}
 	return array;
 }
 
 SIValue SIPath_Relationships(SIValue p) {
-	Path *path = (Path *) p.ptrval;
-	uint edgeCount = Path_EdgeCount(path);
+	SIPath *path = (SIPath *)p.ptrval;
+	const Graph *g = QueryCtx_GetGraph();
+	uint edgeCount = array_len(path->edges);
 	SIValue array = SIArray_New(edgeCount);
 	for(uint i = 0; i < edgeCount; i++) {
-		SIArray_Append(&array, SI_Edge(Path_GetEdge(path, i)));
+		Edge edge = _SIPath_MaterializeEdge(g, path->edges + i);
+		SIArray_Append(&array, SI_Edge(&edge));
 	}
 	return array;
 }
 
 SIValue SIPath_GetRelationship(SIValue p, size_t i) {
 	ASSERT(i < SIPath_Length(p));
-	Path *path = (Path *) p.ptrval;
-	return SI_Edge(Path_GetEdge(path, i));
+	SIPath *path = (SIPath *)p.ptrval;
+	_SIPath_MaterializeEdges(path);
+	return SI_Edge(path->edge_cache + i);
 }
 
 SIValue SIPath_Nodes(SIValue p) {
-	Path *path = (Path *) p.ptrval;
-	uint nodeCount = Path_NodeCount(path);
+	SIPath *path = (SIPath *)p.ptrval;
+	const Graph *g = QueryCtx_GetGraph();
+	uint nodeCount = array_len(path->nodes);
 	SIValue array = SIArray_New(nodeCount);
 	for(uint i = 0; i < nodeCount; i++) {
-		SIArray_Append(&array, SI_Node(Path_GetNode(path, i)));
+		Node node = _SIPath_MaterializeNode(g, path->nodes[i]);
+		SIArray_Append(&array, SI_Node(&node));
 	}
 	return array;
 }
 
 SIValue SIPath_GetNode(SIValue p, size_t i) {
 	ASSERT(i < SIPath_NodeCount(p));
-	Path *path = (Path *) p.ptrval;
-	return SI_Node(Path_GetNode(path, i));
+	SIPath *path = (SIPath *)p.ptrval;
+	_SIPath_MaterializeNodes(path);
+	return SI_Node(path->node_cache + i);
 }
 
 SIValue SIPath_Head(SIValue p) {
@@ -80,39 +174,56 @@ SIValue SIPath_Last(SIValue p) {
 }
 
 size_t SIPath_Length(SIValue p) {
-	Path *path = (Path *) p.ptrval;
-	return Path_Len(path);
+	SIPath *path = (SIPath *)p.ptrval;
+	return array_len(path->edges);
 }
 
 size_t SIPath_NodeCount(SIValue p) {
-	Path *path = (Path *) p.ptrval;
-	return Path_NodeCount(path);
+	SIPath *path = (SIPath *)p.ptrval;
+	return array_len(path->nodes);
 }
 
 size_t SIPath_EdgeCount(SIValue p) {
-	Path *path = (Path *) p.ptrval;
-	return Path_EdgeCount(path);
+	SIPath *path = (SIPath *)p.ptrval;
+	return array_len(path->edges);
+}
+
+// node and edge values are hashed, compared and printed by ID
+// stubs holding the ID only spare retrieving them from the graph
+static inline Node _SIPath_NodeStub(const SIPath *path, size_t i) {
+	Node n = GE_NEW_NODE();
+	n.id = path->nodes[i];
+	return n;
+}
+
+static inline Edge _SIPath_EdgeStub(const SIPath *path, size_t i) {
+	Edge e = {0};
+	e.id = path->edges[i].id;
+	return e;
 }
 
 XXH64_hash_t SIPath_HashCode(SIValue p) {
+	SIPath *path = (SIPath *)p.ptrval;
 	SIType t = SI_TYPE(p);
 	XXH64_hash_t hashCode = XXH64(&t, sizeof(t), 0);
+
 	size_t nodeCount = SIPath_NodeCount(p);
 	for(size_t i = 0; i < nodeCount - 1 ; i++) {
-		SIValue node = SIPath_GetNode(p, i);
-		hashCode = 31 * hashCode + SIValue_HashCode(node);
-		SIValue edge = SIPath_GetRelationship(p, i);
-		hashCode = 31 * hashCode + SIValue_HashCode(edge);
+		Node node = _SIPath_NodeStub(path, i);
+		hashCode = 31 * hashCode + SIValue_HashCode(SI_Node(&node));
+		Edge edge = _SIPath_EdgeStub(path, i);
+		hashCode = 31 * hashCode + SIValue_HashCode(SI_Edge(&edge));
 	}
 	// Handle last node.
 	if(nodeCount > 0) {
-		SIValue node = SIPath_GetNode(p, nodeCount - 1);
-		hashCode = 31 * hashCode + SIValue_HashCode(node);
+		Node node = _SIPath_NodeStub(path, nodeCount - 1);
+		hashCode = 31 * hashCode + SIValue_HashCode(SI_Node(&node));
 	}
 	return hashCode;
 }
 
 void SIPath_ToString(SIValue p, char **buf, size_t *bufferLen, size_t *bytesWritten) {
+	SIPath *path = (SIPath *)p.ptrval;
 	// 64 is defiend arbitrarily.
 	if(*bufferLen - *bytesWritten < 64) {
 		*bufferLen += 64;
@@ -124,58 +235,58 @@ void SIPath_ToString(SIValue p, char **buf, size_t *bufferLen, size_t *bytesWrit
 	size_t nodeCount = SIPath_NodeCount(p);
 	for(size_t i = 0; i < nodeCount - 1; i ++) {
 		// write the next value
-		SIValue node = SIPath_GetNode(p, i);
-		SIValue_ToString(node, buf, bufferLen, bytesWritten);
+		Node node = _SIPath_NodeStub(path, i);
+		SIValue_ToString(SI_Node(&node), buf, bufferLen, bytesWritten);
 		* bytesWritten += snprintf(*buf + *bytesWritten, *bufferLen, ", ");
-		SIValue edge = SIPath_GetRelationship(p, i);
-		SIValue_ToString(edge, buf, bufferLen, bytesWritten);
+		Edge edge = _SIPath_EdgeStub(path, i);
+		SIValue_ToString(SI_Edge(&edge), buf, bufferLen, bytesWritten);
 		* bytesWritten += snprintf(*buf + *bytesWritten, *bufferLen, ", ");
 	}
 	// Handle last node.
 	if(nodeCount > 0) {
-		SIValue node = SIPath_GetNode(p, nodeCount - 1);
-		SIValue_ToString(node, buf, bufferLen, bytesWritten);
+		Node node = _SIPath_NodeStub(path, nodeCount - 1);
+		SIValue_ToString(SI_Node(&node), buf, bufferLen, bytesWritten);
 	}
 
 	if(*bufferLen - *bytesWritten < 2) {
 		*bufferLen += 2;
 		*buf = rm_realloc(*buf, sizeof(char) * *bufferLen);
 	}
+
 	// close array with "]"
 	*bytesWritten += snprintf(*buf + *bytesWritten, *bufferLen, "]");
 }
 
 int SIPath_Compare(SIValue p1, SIValue p2) {
-
+	SIPath *path1 = (SIPath *)p1.ptrval;
+	SIPath *path2 = (SIPath *)p2.ptrval;
 	size_t p1NodeCount = SIPath_NodeCount(p1);
 	size_t p2NodeCount = SIPath_NodeCount(p2);
 	// Get minimal length
 	size_t nodeCount = p1NodeCount <= p2NodeCount ? p1NodeCount : p2NodeCount;
-	int res = 0;
+	// Nodes and edges are compared by ID.
 	for(size_t i = 0; i < nodeCount - 1 ; i++) {
-		SIValue p1node = SIPath_GetNode(p1, i);
-		SIValue p2node = SIPath_GetNode(p2, i);
-		res = SIValue_Compare(p1node, p2node, NULL);
-		if(res) return res;
-		SIValue p1edge = SIPath_GetRelationship(p1, i);
-		SIValue p2edge = SIPath_GetRelationship(p2, i);
-		res = SIValue_Compare(p1edge, p2edge, NULL);
-		if(res) return res;
+		if(path1->nodes[i] != path2->nodes[i]) {
+			return path1->nodes[i] - path2->nodes[i];
+		}
+		if(path1->edges[i].id != path2->edges[i].id) {
+			return path1->edges[i].id - path2->edges[i].id;
+		}
 	}
 	// Handle last node.
-	if(nodeCount > 0) {
-		SIValue p1node = SIPath_GetNode(p1, nodeCount - 1);
-		SIValue p2node = SIPath_GetNode(p2, nodeCount - 1);
-		res = SIValue_Compare(p1node, p2node, NULL);
-		if(res) return res;
+	if(nodeCount > 0 && path1->nodes[nodeCount - 1] != path2->nodes[nodeCount - 1]) {
+		return path1->nodes[nodeCount - 1] - path2->nodes[nodeCount - 1];
 	}
 	return p1NodeCount - p2NodeCount;
 }
 
 void SIPath_Free(SIValue p) {
 	if(p.allocation == M_SELF) {
-		Path *path = (Path *) p.ptrval;
-		Path_Free(path);
+		SIPath *path = (SIPath *)p.ptrval;
+		array_free(path->nodes);
+		array_free(path->edges);
+		if(path->node_cache) array_free(path->node_cache);
+		if(path->edge_cache) array_free(path->edge_cache);
+		rm_free(path);
 	}
 }
-
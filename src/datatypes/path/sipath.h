@@ -11,6 +11,25 @@
 #include "../../graph/entities/qg_edge.h"
 #include <stdlib.h>
 
+// edge of a path value
+typedef struct {
+	EdgeID id;       // edge ID
+	NodeID src;      // source node ID
+	NodeID dest;     // destination node ID
+	int relationID;  // relationship type ID
+} SIPathEdge;
+
+// path value representation
+// a path value holds entity IDs only, such that cloning a path, which happens
+// whenever a record is cloned or projected, copies a couple of ID arrays
+// nodes and edges are retrieved from the graph when first accessed
+typedef struct {
+	NodeID *nodes;      // IDs of the nodes in the path
+	SIPathEdge *edges;  // edges in the path
+	Node *node_cache;   // materialized nodes, NULL until a node is accessed
+	Edge *edge_cache;   // materialized edges, NULL until an edge is accessed
+} SIPath;
+
 /**
  * @brief  Creates a new SIPath out of path struct.
  * @param  p: Path struct pointer.
@@ -95,6 +114,13 @@ size_t SIPath_Length(SIValue p);
  */
 size_t SIPath_NodeCount(SIValue p);
 
+/**
+ * @brief  Returns the number or edges in the path.
+ * @param  p: SIPath
+ * @retval Number or edges in the path.
+ */
+size_t SIPath_EdgeCount(SIValue p);
+
 /**
  * @brief  Returns 64 bit hash code of the path.
  * @param  p: SIPath.
@@ -7,87 +7,99 @@
 #include "sipath_builder.h"
 #include "../../RG.h"
 #include "../../util/rmalloc.h"
+#include "../../util/arr.h"
 
 /**
- * @brief  Reverse the direction of an edge.
- * @note   A new copy of the edge is created, in order not to invalidate any data in the original edge
- *         in case it required elsewhere.
- * @param  *e: Pointer to the original edge.
- * @retval New edge with inverse direction.
+ * @brief  Appends an edge to the path, reversing its direction if needed.
+ * @note   The path holds edge IDs only, reversing an edge does not modify the
+ *         edge value it originated from, which might be projected from the record.
+ * @param  *path: Path.
+ * @param  edge: Edge to append.
+ * @param  RTLEdge: Indicates if the edge is incoming or outgoing edge (RTL in query).
  */
-static Edge _Edge_ReverseDirection(Edge *e) {
-	Edge edge = *e;
-	edge.srcNodeID = e->destNodeID;
-	edge.destNodeID = e->srcNodeID;
-	return edge;
-}
+static void _SIPathBuilder_AppendEdge(SIPath *path, SIPathEdge edge, bool RTLEdge) {
+	ASSERT(array_len(path->nodes) > 0);
+	// Path is built before any of its entities is accessed.
+	ASSERT(path->node_cache == NULL && path->edge_cache == NULL);
+
+	// The edge should connect nodes[edge_count] to nodes[edge_count+1]
+	uint edge_count = array_len(path->edges);
+	NodeID nId = path->nodes[edge_count];
+	// Validate source node is in the right place.
+	ASSERT(nId == edge.src || nId == edge.dest);
 
-static void _SIPath_Reverse(SIValue p) {
-	Path *path = (Path *) p.ptrval;
-	Path_Reverse(path);
+	/* Reverse direction if needed. A direction change is needed if the last node in the path, reading
+	 * RTL is the source node in the edge, and the edge direction in the query is LTR.
+	 * path =[(a)]
+	 * e = (a)->(b)
+	 * Query: MATCH p=(a)<-[]-(b)
+	 * e direction needs to be change. */
+	if(RTLEdge && nId == edge.src) {
+		edge.src = edge.dest;
+		edge.dest = nId;
+	}
+	array_append(path->edges, edge);
 }
 
 SIValue SIPathBuilder_New(uint entity_count) {
+	SIPath *p = rm_malloc(sizeof(SIPath));
+	p->nodes = array_new(NodeID, entity_count / 2 + 1);
+	p->edges = array_new(SIPathEdge, entity_count / 2);
+	p->node_cache = NULL;
+	p->edge_cache = NULL;
+
 	SIValue path;
-	path.ptrval = Path_New(entity_count / 2);
+	path.ptrval = p;
 	path.type = T_PATH;
 	path.allocation = M_SELF;
 	return path;
 }
 
 void SIPathBuilder_AppendNode(SIValue p, SIValue n) {
-	Path *path = (Path *) p.ptrval;
+	SIPath *path = (SIPath *) p.ptrval;
 	Node *node = (Node *) n.ptrval;
-	Path_AppendNode(path, *node);
+	array_append(path->nodes, ENTITY_GET_ID(node));
 }
 
 void SIPathBuilder_AppendEdge(SIValue p, SIValue e, bool RTLEdge) {
-	Path *path = (Path *) p.ptrval;
+	SIPath *path = (SIPath *) p.ptrval;
 	Edge *edge = (Edge *) e.ptrval;
-	ASSERT(Path_NodeCount(path) > 0);
-	// The edge should connect nodes[edge_count] to nodes[edge_count+1]
-	uint edge_count = Path_EdgeCount(path);
-	Node *n = Path_GetNode(path, edge_count);
-	EntityID nId = ENTITY_GET_ID(n);
-	// Validate source node is in the right place.
-	ASSERT(nId == edge->srcNodeID || nId == edge->destNodeID);
-	/* Reverse direction if needed. A direction change is needed if the last node in the path, reading
-	 * RTL is the source node in the edge, and the edge direction in the query is LTR.
-	 * path =[(a)]
-	 * e = (a)->(b)
-	 * Query: MATCH p=(a)<-[]-(b)
-	 * e direction needs to be change. */
-
-	Edge edge_to_append = (RTLEdge && nId == edge->srcNodeID) ? _Edge_ReverseDirection(edge) : *edge;
-	Path_AppendEdge(path, edge_to_append);
+	SIPathEdge pe = {
+		.id = ENTITY_GET_ID(edge),
+		.src = Edge_GetSrcNodeID(edge),
+		.dest = Edge_GetDestNodeID(edge),
+		.relationID = Edge_GetRelationID(edge)
+	};
+	_SIPathBuilder_AppendEdge(path, pe, RTLEdge);
 }
 
-void SIPathBuilder_AppendPath(SIValue path, SIValue new_path, bool RTLEdge) {
-	uint path_node_count = SIPath_NodeCount(path);
+void SIPathBuilder_AppendPath(SIValue p, SIValue other, bool RTLEdge) {
+	SIPath *path = (SIPath *) p.ptrval;
+	SIPath *new_path = (SIPath *) other.ptrval;
+	uint path_node_count = array_len(path->nodes);
 	ASSERT(path_node_count > 0);
-	// No need to append empty paths.
-	uint new_path_node_count = SIPath_NodeCount(new_path);
 
+	// No need to append empty paths.
+	uint new_path_node_count = array_len(new_path->nodes);
 	if(new_path_node_count <= 1) return;
 
-	SIValue last_LTR_node = SIPath_GetNode(path, path_node_count - 1);
-	EntityID last_LTR_node_id = ENTITY_GET_ID((Node *)last_LTR_node.ptrval);
-	SIValue new_path_node_0 = SIPath_Head(new_path);
-	EntityID new_path_node_0_id = ENTITY_GET_ID((Node *)new_path_node_0.ptrval);
-	SIValue new_path_last_node = SIPath_Last(new_path);
-	EntityID new_path_last_node_id = ENTITY_GET_ID((Node *)new_path_last_node.ptrval);
+	NodeID last_LTR_node_id = path->nodes[path_node_count - 1];
+	NodeID new_path_node_0_id = new_path->nodes[0];
+	NodeID new_path_last_node_id = new_path->nodes[new_path_node_count - 1];
+
 	// Validate current last LTR node is in either edges of the path.
 	ASSERT(last_LTR_node_id == new_path_node_0_id || last_LTR_node_id == new_path_last_node_id);
-	int new_path_edge_count = SIPath_Length(new_path);
-
-	// Check if path needs to be rverse inserated or not.
-	if(last_LTR_node_id == new_path_last_node_id) _SIPath_Reverse(new_path);
 
-	for(uint i = 0; i < new_path_edge_count - 1; i++) {
-		SIPathBuilder_AppendEdge(path, SIPath_GetRelationship(new_path, i), RTLEdge);
+	int new_path_edge_count = array_len(new_path->edges);
+	// Check if path needs to be reverse inserted or not,
+	// the appended path is read backwards rather than being reversed.
+	bool reverse = (last_LTR_node_id == new_path_last_node_id);
+	for(uint i = 0; i < new_path_edge_count; i++) {
+		uint edge_idx = reverse ? new_path_edge_count - 1 - i : i;
+		_SIPathBuilder_AppendEdge(path, new_path->edges[edge_idx], RTLEdge);
 		// Insert only nodes which are not the last and the first, since they will be added by append node specifically.
-		SIPathBuilder_AppendNode(path, SIPath_GetNode(new_path, i + 1));
-
+		if(i == new_path_edge_count - 1) break;
+		uint node_idx = reverse ? new_path_node_count - 2 - i : i + 1;
+		array_append(path->nodes, new_path->nodes[node_idx]);
 	}
-	SIPathBuilder_AppendEdge(path, SIPath_GetRelationship(new_path, new_path_edge_count - 1), RTLEdge);
 }
@@ -14,12 +14,11 @@
  * 1. Create new empty path.
  * 2. Append node (a).
  * 3. Append path. All variable length traversal results, when part of path building sequence, are path themsevles.
- *    Note that the intermidiate path order might be reversed, during path building, to comply to the query.
- *    Since intermidate path are not projected, they can be mutable.
+ *    Note that the intermidiate path might be read in reverse order, during path building, to comply to the query.
  * 4. Append node (b).
  * 5. Append edge. Note: If the edge value source and destination are reversed to the query pattern,
- *    a copy of the edge will be added to the path, with the source and destination swapped. This is due to
- *    SIEdge value is immutable, since it might be projected from the record.
+ *    the edge IDs are added to the path with the source and destination swapped. The SIEdge value
+ *    itself is not modified, since it might be projected from the record.
  * 6. Append node (c). */
 
 /**
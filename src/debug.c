@@ -11,6 +11,7 @@
 #include "RG.h"
 #include "util/thpool/pools.h"
 #include "commands/cmd_context.h"
+#include "metrics/metrics.h"
 
 extern CommandCtx **command_ctxs;
 
@@ -38,8 +39,11 @@ static void logCommands(void) {
 }
 
 void InfoFunc(RedisModuleInfoCtx *ctx, int for_crash_report) {
-	// make sure information is requested for crash report
-	if(!for_crash_report) return;
+	// regular INFO requests report metrics
+	if(!for_crash_report) {
+		Metrics_Info(ctx);
+		return;
+	}
 
 	// pause all working threads
 	// NOTE: pausing is not an atomic action;
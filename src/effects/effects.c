@@ -0,0 +1,711 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "effects.h"
+#include "RG.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../datatypes/array.h"
+#include "../datatypes/point.h"
+#include "../index/index_batch.h"
+#include "../execution_plan/ops/shared/create_functions.h"
+#include <string.h>
+
+// version of the effects encoding, leading every effects blob
+#define EFFECTS_VERSION 1
+
+// initial effects buffer capacity, in bytes
+#define EFFECTS_BUFFER_CAP 256
+
+typedef enum {
+	EFFECT_CREATE_NODES = 1,  // nodes created by a single commit
+	EFFECT_CREATE_EDGES = 2,  // edges created by a single commit
+	EFFECT_SET_PROPERTY = 3,  // attribute set or removed
+	EFFECT_DELETE = 4,        // nodes and edges deleted at once
+} EffectType;
+
+typedef enum {
+	EFFECT_VALUE_NULL = 0,
+	EFFECT_VALUE_BOOL = 1,
+	EFFECT_VALUE_DOUBLE = 2,
+	EFFECT_VALUE_STRING = 3,
+	EFFECT_VALUE_LONG = 4,
+	EFFECT_VALUE_ARRAY = 5,
+	EFFECT_VALUE_POINT = 6,
+} EffectValueType;
+
+//------------------------------------------------------------------------------
+// Encoding
+//------------------------------------------------------------------------------
+
+static void _Write(EffectsBuffer *buf, const void *src, size_t n) {
+	if(buf->len + n > buf->cap) {
+		buf->cap = MAX(MAX(buf->cap * 2, EFFECTS_BUFFER_CAP), buf->len + n);
+		buf->data = rm_realloc(buf->data, buf->cap);
+	}
+	memcpy(buf->data + buf->len, src, n);
+	buf->len += n;
+}
+
+static inline void _WriteU8(EffectsBuffer *buf, uint8_t v) {
+	_Write(buf, &v, sizeof(v));
+}
+
+static inline void _WriteU32(EffectsBuffer *buf, uint32_t v) {
+	_Write(buf, &v, sizeof(v));
+}
+
+static inline void _WriteU64(EffectsBuffer *buf, uint64_t v) {
+	_Write(buf, &v, sizeof(v));
+}
+
+// strings are length prefixed, the length accounts for the NULL terminator
+static void _WriteString(EffectsBuffer *buf, const char *s) {
+	uint32_t len = strlen(s) + 1;
+	_WriteU32(buf, len);
+	_Write(buf, s, len);
+}
+
+static void _WriteValue(EffectsBuffer *buf, SIValue v) {
+	switch(SI_TYPE(v)) {
+		case T_BOOL:
+			_WriteU8(buf, EFFECT_VALUE_BOOL);
+			_WriteU8(buf, v.longval != 0);
+			break;
+		case T_DOUBLE:
+			_WriteU8(buf, EFFECT_VALUE_DOUBLE);
+			_Write(buf, &v.doubleval, sizeof(double));
+			break;
+		case T_INT64:
+			_WriteU8(buf, EFFECT_VALUE_LONG);
+			_WriteU64(buf, v.longval);
+			break;
+		case T_STRING:
+			_WriteU8(buf, EFFECT_VALUE_STRING);
+			_WriteString(buf, v.stringval);
+			break;
+		case T_ARRAY: {
+			uint32_t len = SIArray_Length(v);
+			_WriteU8(buf, EFFECT_VALUE_ARRAY);
+			_WriteU32(buf, len);
+			for(uint32_t i = 0; i < len; i++) _WriteValue(buf, SIArray_Get(v, i));
+			break;
+		}
+		case T_POINT: {
+			float lat = Point_lat(v);
+			float lon = Point_lon(v);
+			_WriteU8(buf, EFFECT_VALUE_POINT);
+			_Write(buf, &lat, sizeof(float));
+			_Write(buf, &lon, sizeof(float));
+			break;
+		}
+		default:
+			// temporal values are never stored as attributes
+			ASSERT(SIValue_IsNull(v));
+			_WriteU8(buf, EFFECT_VALUE_NULL);
+			break;
+	}
+}
+
+static void _WriteProperties(EffectsBuffer *buf, GraphContext *gc, const GraphEntity *ge) {
+	int count = ENTITY_PROP_COUNT(ge);
+	_WriteU32(buf, count);
+	for(int i = 0; i < count; i++) {
+		const EntityProperty *p = ENTITY_PROPS(ge) + i;
+		_WriteString(buf, GraphContext_GetAttributeString(gc, p->id));
+		_WriteValue(buf, EntityProperty_Value(p));
+	}
+}
+
+static void _WriteEdgeRef(EffectsBuffer *buf, GraphContext *gc, const Edge *e) {
+	int relation_id = Edge_GetRelationID(e);
+	if(relation_id < 0) relation_id = Graph_GetEdgeRelation(gc->g, (Edge *)e);
+	Schema *s = GraphContext_GetSchemaByID(gc, relation_id, SCHEMA_EDGE);
+	ASSERT(s != NULL);
+
+	_WriteU64(buf, ENTITY_GET_ID(e));
+	_WriteU64(buf, Edge_GetSrcNodeID(e));
+	_WriteU64(buf, Edge_GetDestNodeID(e));
+	_WriteString(buf, Schema_GetName(s));
+}
+
+// every effect opens with its type, the blob opens with the encoding version
+static void _BeginEffect(EffectsBuffer *buf, EffectType t) {
+	if(buf->len == 0) _WriteU8(buf, EFFECTS_VERSION);
+	_WriteU8(buf, t);
+	buf->count++;
+}
+
+void EffectsBuffer_AddCreateNodes(EffectsBuffer *buf, GraphContext *gc, Node **nodes,
+								  uint count) {
+	ASSERT(buf != NULL && gc != NULL);
+	if(count == 0) return;
+
+	_BeginEffect(buf, EFFECT_CREATE_NODES);
+	_WriteU32(buf, count);
+	for(uint i = 0; i < count; i++) {
+		Node *n = nodes[i];
+		_WriteU64(buf, ENTITY_GET_ID(n));
+		_WriteString(buf, n->label ? n->label : "");
+		_WriteProperties(buf, gc, (GraphEntity *)n);
+	}
+}
+
+void EffectsBuffer_AddCreateEdges(EffectsBuffer *buf, GraphContext *gc, Edge **edges,
+								  uint count) {
+	ASSERT(buf != NULL && gc != NULL);
+	if(count == 0) return;
+
+	_BeginEffect(buf, EFFECT_CREATE_EDGES);
+	_WriteU32(buf, count);
+	for(uint i = 0; i < count; i++) {
+		Edge *e = edges[i];
+		_WriteEdgeRef(buf, gc, e);
+		_WriteProperties(buf, gc, (GraphEntity *)e);
+	}
+}
+
+void EffectsBuffer_AddSetProperty(EffectsBuffer *buf, GraphContext *gc, GraphEntityType t,
+								  const GraphEntity *ge, Attribute_ID attr, SIValue v) {
+	ASSERT(buf != NULL && gc != NULL && ge != NULL);
+	ASSERT(t == GETYPE_NODE || t == GETYPE_EDGE);
+
+	_BeginEffect(buf, EFFECT_SET_PROPERTY);
+	_WriteU8(buf, t);
+	if(t == GETYPE_NODE) _WriteU64(buf, ENTITY_GET_ID(ge));
+	else _WriteEdgeRef(buf, gc, (const Edge *)ge);
+	_WriteString(buf, GraphContext_GetAttributeString(gc, attr));
+	_WriteValue(buf, v);
+}
+
+void EffectsBuffer_AddDelete(EffectsBuffer *buf, GraphContext *gc, const Node *nodes,
+							 uint node_count, const Edge *edges, uint edge_count) {
+	ASSERT(buf != NULL && gc != NULL);
+	if(node_count == 0 && edge_count == 0) return;
+
+	_BeginEffect(buf, EFFECT_DELETE);
+	_WriteU32(buf, node_count);
+	for(uint i = 0; i < node_count; i++) _WriteU64(buf, ENTITY_GET_ID(nodes + i));
+	_WriteU32(buf, edge_count);
+	for(uint i = 0; i < edge_count; i++) _WriteEdgeRef(buf, gc, edges + i);
+}
+
+void EffectsBuffer_Reset(EffectsBuffer *buf) {
+	ASSERT(buf != NULL);
+	buf->len = 0;
+	buf->count = 0;
+}
+
+void EffectsBuffer_Free(EffectsBuffer *buf) {
+	ASSERT(buf != NULL);
+	rm_free(buf->data);
+	buf->data = NULL;
+	buf->len = 0;
+	buf->cap = 0;
+	buf->count = 0;
+}
+
+//------------------------------------------------------------------------------
+// Decoding
+//------------------------------------------------------------------------------
+
+typedef struct {
+	const char *data;  // Encoded effects.
+	size_t len;        // Number of bytes.
+	size_t pos;        // Read position.
+	bool malformed;    // Set once a read overflows the effects.
+} _EffectsReader;
+
+static bool _Read(_EffectsReader *r, void *dest, size_t n) {
+	if(r->malformed || r->len - r->pos < n) {
+		r->malformed = true;
+		memset(dest, 0, n);
+		return false;
+	}
+	memcpy(dest, r->data + r->pos, n);
+	r->pos += n;
+	return true;
+}
+
+static inline uint8_t _ReadU8(_EffectsReader *r) {
+	uint8_t v;
+	_Read(r, &v, sizeof(v));
+	return v;
+}
+
+static inline uint32_t _ReadU32(_EffectsReader *r) {
+	uint32_t v;
+	_Read(r, &v, sizeof(v));
+	return v;
+}
+
+static inline uint64_t _ReadU64(_EffectsReader *r) {
+	uint64_t v;
+	_Read(r, &v, sizeof(v));
+	return v;
+}
+
+// returns a string within the effects, "" if malformed
+static const char *_ReadString(_EffectsReader *r) {
+	uint32_t len = _ReadU32(r);
+	if(r->malformed || len == 0 || r->len - r->pos < len ||
+	   r->data[r->pos + len - 1] != '\0') {
+		r->malformed = true;
+		return "";
+	}
+	const char *s = r->data + r->pos;
+	r->pos += len;
+	return s;
+}
+
+// decoded strings are shared with the effects, the caller frees the value
+static SIValue _ReadValue(_EffectsReader *r) {
+	SIValue v = SI_NullVal();
+	switch(_ReadU8(r)) {
+		case EFFECT_VALUE_NULL:
+			break;
+		case EFFECT_VALUE_BOOL:
+			v = SI_BoolVal(_ReadU8(r));
+			break;
+		case EFFECT_VALUE_DOUBLE: {
+			double d;
+			_Read(r, &d, sizeof(double));
+			v = SI_DoubleVal(d);
+			break;
+		}
+		case EFFECT_VALUE_LONG:
+			v = SI_LongVal((int64_t)_ReadU64(r));
+			break;
+		case EFFECT_VALUE_STRING:
+			v = SI_ConstStringVal((char *)_ReadString(r));
+			break;
+		case EFFECT_VALUE_ARRAY: {
+			uint32_t len = _ReadU32(r);
+			// don't trust the length for the initial capacity
+			v = SIArray_New(MIN(len, 64));
+			for(uint32_t i = 0; i < len && !r->malformed; i++) {
+				SIValue elem = _ReadValue(r);
+				SIArray_Append(&v, elem);
+				SIValue_Free(elem);
+			}
+			break;
+		}
+		case EFFECT_VALUE_POINT: {
+			float lat;
+			float lon;
+			_Read(r, &lat, sizeof(float));
+			_Read(r, &lon, sizeof(float));
+			v = SI_Point(lat, lon);
+			break;
+		}
+		default:
+			r->malformed = true;
+			break;
+	}
+	return v;
+}
+
+static void _ReadProperties(_EffectsReader *r, GraphContext *gc, GraphEntity *ge) {
+	uint32_t count = _ReadU32(r);
+	for(uint32_t i = 0; i < count && !r->malformed; i++) {
+		const char *attr = _ReadString(r);
+		SIValue v = _ReadValue(r);
+		if(!r->malformed && !SIValue_IsNull(v)) {
+			Attribute_ID attr_id = GraphContext_FindOrAddAttribute(gc, attr);
+			GraphEntity_AddProperty(ge, attr_id, v);
+		}
+		SIValue_Free(v);
+	}
+}
+
+// number of node slots, deleted nodes included
+static inline uint64_t _NodeSlots(const Graph *g) {
+	return Graph_NodeCount(g) + Graph_DeletedNodeCount(g);
+}
+
+static inline uint64_t _EdgeSlots(const Graph *g) {
+	return Graph_EdgeCount(g) + Graph_DeletedEdgeCount(g);
+}
+
+// resolves an edge reference, e->entity is NULL if the edge doesn't exist
+static void _ReadEdgeRef(_EffectsReader *r, GraphContext *gc, Edge *e, bool create) {
+	EdgeID id = _ReadU64(r);
+	NodeID src = _ReadU64(r);
+	NodeID dest = _ReadU64(r);
+	const char *relation = _ReadString(r);
+
+	e->entity = NULL;
+	e->id = id;
+	e->src = NULL;
+	e->dest = NULL;
+	e->srcNodeID = src;
+	e->destNodeID = dest;
+	e->relationship = NULL;
+	e->relationID = GRAPH_NO_RELATION;
+	if(r->malformed) return;
+
+	Schema *s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
+	if(s == NULL && create) s = GraphContext_AddSchema(gc, relation, SCHEMA_EDGE);
+	if(s == NULL) return;
+
+	e->relationship = Schema_GetName(s);
+	e->relationID = s->id;
+	if(!create && id < _EdgeSlots(gc->g)) Graph_GetEdge(gc->g, id, e);
+}
+
+static bool _Diverged(EntityID expected, EntityID actual) {
+	if(expected == actual) return false;
+	ErrorCtx_SetError("Effects diverge from the graph, expected entity ID %llu, got %llu",
+					  (unsigned long long)expected, (unsigned long long)actual);
+	return true;
+}
+
+// mirrors _CommitNodes, large creations are labeled at once
+static bool _ApplyCreateNodes(_EffectsReader *r, GraphContext *gc, IndexBatch *batch) {
+	bool ok = true;
+	Graph *g = gc->g;
+	uint32_t count = _ReadU32(r);
+	if(r->malformed) return false;
+
+	Graph_SetMatrixPolicy(g, RESIZE_TO_CAPACITY);
+	Graph_AllocateNodes(g, count);
+
+	GrB_Index **labeled = NULL;
+	bool bulk = count >= BULK_COMMIT_THRESHOLD;
+	if(bulk) labeled = array_new(GrB_Index *, Graph_LabelTypeCount(g));
+
+	for(uint32_t i = 0; i < count && ok; i++) {
+		NodeID id = _ReadU64(r);
+		const char *label = _ReadString(r);
+		if(r->malformed) break;
+
+		Schema *s = NULL;
+		int label_id = GRAPH_NO_LABEL;
+		if(label[0] != '\0') {
+			s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+			if(s == NULL) s = GraphContext_AddSchema(gc, label, SCHEMA_NODE);
+			label_id = s->id;
+		}
+
+		Node n = GE_NEW_NODE();
+		if(bulk && label_id != GRAPH_NO_LABEL) {
+			Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+			while(array_len(labeled) <= (uint)label_id) array_append(labeled, NULL);
+			if(labeled[label_id] == NULL) labeled[label_id] = array_new(GrB_Index, count);
+			array_append(labeled[label_id], ENTITY_GET_ID(&n));
+		} else {
+			Graph_CreateNode(g, label_id, &n);
+		}
+
+		ok = !_Diverged(id, ENTITY_GET_ID(&n));
+		_ReadProperties(r, gc, (GraphEntity *)&n);
+
+		if(s && Schema_HasIndices(s)) IndexBatch_AddNode(batch, s->id, ENTITY_GET_ID(&n));
+	}
+
+	if(bulk) {
+		uint label_count = array_len(labeled);
+		for(uint l = 0; l < label_count; l++) {
+			if(labeled[l] == NULL) continue;
+			Graph_BulkLabelNodes(g, l, labeled[l], array_len(labeled[l]));
+			array_free(labeled[l]);
+		}
+		array_free(labeled);
+	}
+
+	Graph_SetMatrixPolicy(g, SYNC_AND_MINIMIZE_SPACE);
+	return ok && !r->malformed;
+}
+
+// mirrors _CommitEdges, large creations form their connections at once
+static bool _ApplyCreateEdges(_EffectsReader *r, GraphContext *gc) {
+	bool ok = true;
+	Graph *g = gc->g;
+	uint32_t count = _ReadU32(r);
+	if(r->malformed) return false;
+
+	Graph_AllocateEdges(g, count);
+
+	BulkConnections *conns = NULL;
+	if(count >= BULK_COMMIT_THRESHOLD) conns = array_new(BulkConnections, 1);
+
+	uint64_t node_slots = _NodeSlots(g);
+	Edge *created = array_new(Edge, MIN(count, BULK_COMMIT_THRESHOLD));
+
+	for(uint32_t i = 0; i < count && ok; i++) {
+		Edge ref;
+		_ReadEdgeRef(r, gc, &ref, true);
+		if(r->malformed) break;
+
+		NodeID src = ref.srcNodeID;
+		NodeID dest = ref.destNodeID;
+		if(src >= node_slots || dest >= node_slots ||
+		   !Graph_GetNode(g, src, &(Node){0}) || !Graph_GetNode(g, dest, &(Node){0})) {
+			ErrorCtx_SetError("Effects diverge from the graph, missing edge endpoint");
+			ok = false;
+			break;
+		}
+
+		Edge e;
+		if(conns) {
+			Graph_CreateEdge(g, src, dest, ref.relationID, &e);
+			Graph_BufferConnection(&conns, &e);
+		} else {
+			Graph_ConnectNodes(g, src, dest, ref.relationID, &e);
+		}
+
+		ok = !_Diverged(ENTITY_GET_ID(&ref), ENTITY_GET_ID(&e));
+		_ReadProperties(r, gc, (GraphEntity *)&e);
+		array_append(created, e);
+	}
+
+	if(conns) {
+		Graph_BulkConnect(g, conns);
+		array_free(conns);
+	}
+
+	// index edges once they're connected
+	uint created_count = array_len(created);
+	for(uint i = 0; i < created_count; i++) {
+		Edge *e = created + i;
+		Schema *s = GraphContext_GetSchemaByID(gc, e->relationID, SCHEMA_EDGE);
+		if(Schema_HasIndices(s)) Schema_AddEdgeToIndices(s, e);
+	}
+	array_free(created);
+
+	return ok && !r->malformed;
+}
+
+// mirrors the SET semantics of the update operations
+static bool _ApplySetProperty(_EffectsReader *r, GraphContext *gc, IndexBatch *batch) {
+	Graph *g = gc->g;
+	Node n = GE_NEW_NODE();
+	Edge e;
+	GraphEntity *ge;
+
+	uint8_t t = _ReadU8(r);
+	if(t == GETYPE_NODE) {
+		NodeID id = _ReadU64(r);
+		n.entity = NULL;
+		if(!r->malformed && id < _NodeSlots(g)) Graph_GetNode(g, id, &n);
+		ge = (GraphEntity *)&n;
+	} else if(t == GETYPE_EDGE) {
+		_ReadEdgeRef(r, gc, &e, false);
+		ge = (GraphEntity *)&e;
+	} else {
+		return false;
+	}
+
+	const char *attr = _ReadString(r);
+	SIValue v = _ReadValue(r);
+	if(r->malformed) {
+		SIValue_Free(v);
+		return false;
+	}
+	if(ge->entity == NULL) {
+		SIValue_Free(v);
+		ErrorCtx_SetError("Effects diverge from the graph, updated entity is missing");
+		return false;
+	}
+
+	Attribute_ID attr_id = GraphContext_FindOrAddAttribute(gc, attr);
+	SIValue current = GraphEntity_GetProperty(ge, attr_id);
+	bool changed;
+	if(SIValue_IsNull(current)) changed = GraphEntity_AddProperty(ge, attr_id, v);
+	else changed = GraphEntity_SetProperty(ge, attr_id, v);
+	SIValue_Free(v);
+
+	if(changed) {
+		Graph_MarkEntityModified(g, t, ENTITY_GET_ID(ge));
+		if(t == GETYPE_NODE) {
+			int label_id = Graph_GetNodeLabel(g, ENTITY_GET_ID(&n));
+			Schema *s = (label_id == GRAPH_NO_LABEL) ? NULL :
+						GraphContext_GetSchemaByID(gc, label_id, SCHEMA_NODE);
+			if(s && Schema_HasIndices(s)) IndexBatch_AddNode(batch, label_id, ENTITY_GET_ID(&n));
+		} else {
+			Schema *s = GraphContext_GetSchemaByID(gc, e.relationID, SCHEMA_EDGE);
+			if(Schema_HasIndices(s)) Schema_AddEdgeToIndices(s, &e);
+		}
+	}
+
+	return true;
+}
+
+// mirrors _DeleteChunk
+static bool _ApplyDelete(_EffectsReader *r, GraphContext *gc, IndexBatch *batch) {
+	Graph *g = gc->g;
+	uint64_t node_slots = _NodeSlots(g);
+
+	uint32_t node_count = _ReadU32(r);
+	Node *nodes = array_new(Node, MIN(node_count, BULK_COMMIT_THRESHOLD));
+	for(uint32_t i = 0; i < node_count && !r->malformed; i++) {
+		NodeID id = _ReadU64(r);
+		Node n = GE_NEW_NODE();
+		// nodes already deleted are skipped, as they are on the primary
+		if(id < node_slots && Graph_GetNode(g, id, &n)) array_append(nodes, n);
+	}
+
+	uint32_t edge_count = _ReadU32(r);
+	Edge *edges = array_new(Edge, MIN(edge_count, BULK_COMMIT_THRESHOLD));
+	for(uint32_t i = 0; i < edge_count && !r->malformed; i++) {
+		Edge e;
+		_ReadEdgeRef(r, gc, &e, false);
+		if(e.entity != NULL) array_append(edges, e);
+	}
+
+	if(!r->malformed) {
+		node_count = array_len(nodes);
+		edge_count = array_len(edges);
+		if(GraphContext_HasIndices(gc)) {
+			for(uint i = 0; i < node_count; i++) {
+				int label_id = NODE_GET_LABEL_ID(nodes + i, g);
+				if(label_id == GRAPH_NO_LABEL) continue;
+				Schema *s = GraphContext_GetSchemaByID(gc, label_id, SCHEMA_NODE);
+				if(s && Schema_HasIndices(s)) {
+					IndexBatch_RemoveNode(batch, label_id, ENTITY_GET_ID(nodes + i));
+				}
+			}
+			for(uint i = 0; i < edge_count; i++) {
+				GraphContext_DeleteEdgeFromIndices(gc, edges + i);
+			}
+		}
+
+		uint node_deleted;
+		uint edge_deleted;
+		Graph_BulkDelete(g, nodes, node_count, edges, edge_count, &node_deleted,
+						 &edge_deleted);
+		IndexBatch_Apply(batch, gc);
+	}
+
+	array_free(nodes);
+	array_free(edges);
+	return !r->malformed;
+}
+
+bool Effects_Apply(GraphContext *gc, const char *data, size_t len) {
+	ASSERT(gc != NULL && data != NULL);
+
+	_EffectsReader r = {.data = data, .len = len, .pos = 0, .malformed = false};
+	if(_ReadU8(&r) != EFFECTS_VERSION) {
+		ErrorCtx_SetError("Unsupported effects version");
+		return false;
+	}
+
+	bool ok = true;
+	IndexBatch batch = {0};
+	while(ok && r.pos < r.len) {
+		switch(_ReadU8(&r)) {
+			case EFFECT_CREATE_NODES:
+				ok = _ApplyCreateNodes(&r, gc, &batch);
+				break;
+			case EFFECT_CREATE_EDGES:
+				ok = _ApplyCreateEdges(&r, gc);
+				break;
+			case EFFECT_SET_PROPERTY:
+				ok = _ApplySetProperty(&r, gc, &batch);
+				break;
+			case EFFECT_DELETE:
+				// deleted nodes are first indexed by their pending updates
+				IndexBatch_Apply(&batch, gc);
+				ok = _ApplyDelete(&r, gc, &batch);
+				break;
+			default:
+				ok = false;
+				break;
+		}
+	}
+
+	IndexBatch_Apply(&batch, gc);
+	IndexBatch_Free(&batch);
+
+	if(!ok && !ErrorCtx_EncounteredError()) ErrorCtx_SetError("Malformed effects");
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Node visiting
+//------------------------------------------------------------------------------
+
+// skips an edge reference, see _WriteEdgeRef
+static void _SkipEdgeRef(_EffectsReader *r) {
+	_ReadU64(r);
+	_ReadU64(r);
+	_ReadU64(r);
+	_ReadString(r);
+}
+
+// skips an attribute name and its value
+static void _SkipProperty(_EffectsReader *r) {
+	_ReadString(r);
+	SIValue v = _ReadValue(r);
+	SIValue_Free(v);
+}
+
+static void _SkipProperties(_EffectsReader *r) {
+	uint32_t count = _ReadU32(r);
+	for(uint32_t i = 0; i < count && !r->malformed; i++) _SkipProperty(r);
+}
+
+bool Effects_VisitNodes(const char *data, size_t len, EffectsNodeVisitor visit,
+						void *pdata) {
+	ASSERT(data != NULL && visit != NULL);
+
+	_EffectsReader r = {.data = data, .len = len, .pos = 0, .malformed = false};
+	if(_ReadU8(&r) != EFFECTS_VERSION) return false;
+
+	while(!r.malformed && r.pos < r.len) {
+		switch(_ReadU8(&r)) {
+			case EFFECT_CREATE_NODES: {
+				uint32_t count = _ReadU32(&r);
+				for(uint32_t i = 0; i < count && !r.malformed; i++) {
+					NodeID id = _ReadU64(&r);
+					_ReadString(&r);
+					_SkipProperties(&r);
+					if(!r.malformed) visit(id, pdata);
+				}
+				break;
+			}
+			case EFFECT_CREATE_EDGES: {
+				uint32_t count = _ReadU32(&r);
+				for(uint32_t i = 0; i < count && !r.malformed; i++) {
+					_SkipEdgeRef(&r);
+					_SkipProperties(&r);
+				}
+				break;
+			}
+			case EFFECT_SET_PROPERTY: {
+				uint8_t t = _ReadU8(&r);
+				if(t == GETYPE_NODE) {
+					NodeID id = _ReadU64(&r);
+					_SkipProperty(&r);
+					if(!r.malformed) visit(id, pdata);
+				} else {
+					_SkipEdgeRef(&r);
+					_SkipProperty(&r);
+				}
+				break;
+			}
+			case EFFECT_DELETE: {
+				uint32_t node_count = _ReadU32(&r);
+				for(uint32_t i = 0; i < node_count && !r.malformed; i++) {
+					NodeID id = _ReadU64(&r);
+					if(!r.malformed) visit(id, pdata);
+				}
+				uint32_t edge_count = _ReadU32(&r);
+				for(uint32_t i = 0; i < edge_count && !r.malformed; i++) {
+					_SkipEdgeRef(&r);
+				}
+				break;
+			}
+			default:
+				r.malformed = true;
+				break;
+		}
+	}
+
+	return !r.malformed;
+}
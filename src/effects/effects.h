@@ -0,0 +1,104 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../value.h"
+#include "../graph/graphcontext.h"
+#include "../graph/entities/node.h"
+#include "../graph/entities/edge.h"
+
+// Effects are a compact binary log of the changes a write query performed,
+// replicated by GRAPH.EFFECT in place of the query itself, such that replicas
+// apply changes without planning or matching.
+//
+// Labels, relationship types and attributes are referred to by name,
+// entities by ID. Replicas allocate entity IDs in the same order as their
+// primary, created entities' IDs are verified as effects are applied.
+
+// effects recorded by a query, a zeroed buffer is empty
+typedef struct {
+	char *data;   // Encoded effects, NULL until the first effect.
+	size_t len;   // Number of bytes in use.
+	size_t cap;   // Allocated bytes.
+	uint count;   // Number of effects encoded.
+} EffectsBuffer;
+
+// records the creation of count nodes, once they were committed
+void EffectsBuffer_AddCreateNodes
+(
+	EffectsBuffer *buf,  // effects buffer
+	GraphContext *gc,    // graph context
+	Node **nodes,        // created nodes
+	uint count           // number of nodes
+);
+
+// records the creation of count edges, once they were committed
+void EffectsBuffer_AddCreateEdges
+(
+	EffectsBuffer *buf,  // effects buffer
+	GraphContext *gc,    // graph context
+	Edge **edges,        // created edges
+	uint count           // number of edges
+);
+
+// records attribute attr of ge being set to v, a NULL value removes attr
+void EffectsBuffer_AddSetProperty
+(
+	EffectsBuffer *buf,    // effects buffer
+	GraphContext *gc,      // graph context
+	GraphEntityType t,     // entity type
+	const GraphEntity *ge, // updated entity, an Edge for edges
+	Attribute_ID attr,     // attribute
+	SIValue v              // new value
+);
+
+// records the deletion of nodes and edges, see Graph_BulkDelete
+void EffectsBuffer_AddDelete
+(
+	EffectsBuffer *buf,  // effects buffer
+	GraphContext *gc,    // graph context
+	const Node *nodes,   // deleted nodes
+	uint node_count,     // number of nodes
+	const Edge *edges,   // deleted edges
+	uint edge_count      // number of edges
+);
+
+// discards recorded effects, the buffer retains its allocation
+void EffectsBuffer_Reset
+(
+	EffectsBuffer *buf
+);
+
+// free effects buffer internals
+void EffectsBuffer_Free
+(
+	EffectsBuffer *buf
+);
+
+// applies encoded effects to gc, caller holds the graph write lock
+// returns false and sets an error if the effects are malformed or
+// diverge from the graph
+bool Effects_Apply
+(
+	GraphContext *gc,  // graph context
+	const char *data,  // encoded effects
+	size_t len         // number of bytes
+);
+
+// invoked for every node created, updated or deleted by encoded effects
+typedef void (*EffectsNodeVisitor)(NodeID id, void *pdata);
+
+// visits the IDs of the nodes modified by encoded effects, in order,
+// a node is visited once per effect modifying it
+// returns false if the effects are malformed
+bool Effects_VisitNodes
+(
+	const char *data,            // encoded effects
+	size_t len,                  // number of bytes
+	EffectsNodeVisitor visit,    // visitor
+	void *pdata                  // visitor's private data
+);
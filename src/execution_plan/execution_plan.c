@@ -10,8 +10,11 @@
 #include "../errors.h"
 #include "../util/arr.h"
 #include "../query_ctx.h"
+#include "../util/tsc.h"
+#include "../util/trace.h"
 #include "../util/rmalloc.h"
 #include "./optimizations/optimizer.h"
+#include "plan_estimate.h"
 #include "../ast/ast_build_filter_tree.h"
 #include "execution_plan_build/execution_plan_construct.h"
 #include "execution_plan_build/execution_plan_modify.h"
@@ -303,10 +306,73 @@ ExecutionPlan *NewExecutionPlan(void) {
 	return plan;
 }
 
+// Mapping of the records produced by op.
+static const rax *_ExecutionPlan_OutputMapping(const OpBase *op) {
+	switch(op->type) {
+	case OPType_FILTER:
+	case OPType_SORT:
+	case OPType_SKIP:
+	case OPType_LIMIT:
+		// records are passed through as produced by the child
+		if(op->childCount > 0) return _ExecutionPlan_OutputMapping(op->children[0]);
+		break;
+	default:
+		break;
+	}
+	return op->plan->record_map;
+}
+
+// Resolve aliases referenced by each op's expressions into record slots
+// and compile the expressions, sparing evaluation of per-record alias lookups
+// and validations of arguments known at plan time.
+static void _ExecutionPlan_PrepareExpressions(OpBase *op) {
+	for(int i = 0; i < op->childCount; i++) {
+		_ExecutionPlan_PrepareExpressions(op->children[i]);
+	}
+
+	// expressions are evaluated against records produced by the child,
+	// or against records of op's own segment when it is a tap
+	const rax *mapping = (op->childCount > 0) ?
+		_ExecutionPlan_OutputMapping(op->children[0]) : op->plan->record_map;
+	if(mapping == NULL) return;
+
+	switch(op->type) {
+	case OPType_FILTER: {
+		OpFilter *filter = (OpFilter *)op;
+		FilterTree_ResolveAliases(filter->filterTree, mapping);
+		FilterTree_Compile(filter->filterTree);
+		break;
+	}
+	case OPType_PROJECT: {
+		OpProject *project = (OpProject *)op;
+		for(uint i = 0; i < project->exp_count; i++) {
+			AR_EXP_ResolveAliases(project->exps[i], mapping);
+			AR_EXP_Compile(project->exps[i]);
+		}
+		break;
+	}
+	case OPType_AGGREGATE: {
+		OpAggregate *aggregate = (OpAggregate *)op;
+		for(uint i = 0; i < aggregate->key_count; i++) {
+			AR_EXP_ResolveAliases(aggregate->key_exps[i], mapping);
+			AR_EXP_Compile(aggregate->key_exps[i]);
+		}
+		for(uint i = 0; i < aggregate->aggregate_count; i++) {
+			AR_EXP_ResolveAliases(aggregate->aggregate_exps[i], mapping);
+			AR_EXP_Compile(aggregate->aggregate_exps[i]);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
 void ExecutionPlan_PreparePlan(ExecutionPlan *plan) {
 	// Plan should be prepared only once.
 	ASSERT(!plan->prepared);
 	optimizePlan(plan);
+	_ExecutionPlan_PrepareExpressions(plan->root);
 	QueryCtx_SetLastWriter(_ExecutionPlan_FindLastWriter(plan->root));
 	plan->prepared = true;
 }
@@ -317,19 +383,15 @@ inline rax *ExecutionPlan_GetMappings(const ExecutionPlan *plan) {
 }
 
 Record ExecutionPlan_BorrowRecord(ExecutionPlan *plan) {
-	rax *mapping = ExecutionPlan_GetMappings(plan);
 	ASSERT(plan->record_pool);
 
-	// Get a Record from the pool and set its owner and mapping.
-	Record r = ObjectPool_NewItem(plan->record_pool);
-	r->owner = plan;
-	r->mapping = mapping;
-	return r;
+	// Get a Record from the pool, its mapping is the pool's.
+	return RecordPool_Borrow(plan->record_pool, plan);
 }
 
 void ExecutionPlan_ReturnRecord(ExecutionPlan *plan, Record r) {
 	ASSERT(plan && r);
-	ObjectPool_DeleteItem(plan->record_pool, r);
+	RecordPool_Return(plan->record_pool, r);
 }
 
 //------------------------------------------------------------------------------
@@ -338,13 +400,8 @@ void ExecutionPlan_ReturnRecord(ExecutionPlan *plan, Record r) {
 
 static inline void _ExecutionPlan_InitRecordPool(ExecutionPlan *plan) {
 	if(plan->record_pool) return;
-	/* Initialize record pool.
-	 * Determine Record size to inform ObjectPool allocation. */
-	uint entries_count = raxSize(plan->record_map);
-	uint rec_size = sizeof(_Record) + (sizeof(Entry) * entries_count);
-
-	// Create a data block with initial capacity of 256 records.
-	plan->record_pool = ObjectPool_New(256, rec_size, (fpDestructor)Record_FreeEntries);
+	// Initialize record pool, all records are sized from the record mapping.
+	plan->record_pool = RecordPool_New(plan->record_map);
 }
 
 static void _ExecutionPlanInit(OpBase *root) {
@@ -352,6 +409,7 @@ static void _ExecutionPlanInit(OpBase *root) {
 	_ExecutionPlan_InitRecordPool((ExecutionPlan *)root->plan);
 
 	// Initialize the operation if necessary.
+	TRACE_PROBE1(op__init, root->name);
 	if(root->init) root->init(root);
 
 	// Continue initializing downstream operations.
@@ -361,7 +419,9 @@ static void _ExecutionPlanInit(OpBase *root) {
 }
 
 void ExecutionPlan_Init(ExecutionPlan *plan) {
-	_ExecutionPlanInit(plan->root);
+	if(plan->initialized) OpBase_PropagateReset(plan->root);
+	else _ExecutionPlanInit(plan->root);
+	plan->initialized = true;
 }
 
 ResultSet *ExecutionPlan_Execute(ExecutionPlan *plan) {
@@ -376,13 +436,40 @@ ResultSet *ExecutionPlan_Execute(ExecutionPlan *plan) {
 
 	ExecutionPlan_Init(plan);
 
-	Record r = NULL;
-	// Execute the root operation and free the processed Record until the data stream is depleted.
-	while((r = OpBase_Consume(plan->root)) != NULL) ExecutionPlan_ReturnRecord(r->owner, r);
+	uint n = 0;
+	Record batch[OP_BATCH_CAP];
+	// Execute the root operation and free the processed Records until the data stream is depleted.
+	while((n = OpBase_ConsumeBatch(plan->root, batch, OP_BATCH_CAP)) > 0) {
+		for(uint i = 0; i < n; i++) ExecutionPlan_ReturnRecord(batch[i]->owner, batch[i]);
+	}
 
 	return QueryCtx_GetResultSet();
 }
 
+bool ExecutionPlan_ExecuteStep(ExecutionPlan *plan, uint64_t limit) {
+	ASSERT(plan->prepared)
+	ASSERT(limit > 0);
+
+	// run-time errors abort the step, leaving the plan depleted
+	int encountered_error = SET_EXCEPTION_HANDLER();
+	if(encountered_error) return true;
+
+	uint n = 0;
+	uint64_t produced = 0;
+	Record batch[OP_BATCH_CAP];
+	while(produced < limit) {
+		uint64_t remaining = limit - produced;
+		uint cap = (remaining < OP_BATCH_CAP) ? remaining : OP_BATCH_CAP;
+		n = OpBase_ConsumeBatch(plan->root, batch, cap);
+		if(n == 0) return true;
+
+		for(uint i = 0; i < n; i++) ExecutionPlan_ReturnRecord(batch[i]->owner, batch[i]);
+		produced += n;
+	}
+
+	return false;
+}
+
 //------------------------------------------------------------------------------
 // Execution plan draining
 //------------------------------------------------------------------------------
@@ -402,6 +489,7 @@ bool ExecutionPlan_Drained(ExecutionPlan *plan) {
 
 static void _ExecutionPlan_Drain(OpBase *root) {
 	root->consume = deplete_consume;
+	root->consume_batch = NULL;
 	for(int i = 0; i < root->childCount; i++) {
 		_ExecutionPlan_Drain(root->children[i]);
 	}
@@ -414,6 +502,108 @@ void ExecutionPlan_Drain(ExecutionPlan *plan) {
 	_ExecutionPlan_Drain(plan->root);
 }
 
+//------------------------------------------------------------------------------
+// Execution plan timeout
+//------------------------------------------------------------------------------
+
+// a write query may time out up until its first commit, from which point on
+// it runs to completion, the timer and the committing thread race over the
+// timeout state such that either the plan is drained or it commits
+
+void ExecutionPlan_ArmTimeout(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+	__atomic_store_n(&plan->timeout_state, PLAN_TIMEOUT_ARMED, __ATOMIC_RELEASE);
+}
+
+bool ExecutionPlan_ExpireTimeout(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+	PlanTimeoutState expected = PLAN_TIMEOUT_ARMED;
+	if(!__atomic_compare_exchange_n(&plan->timeout_state, &expected,
+				PLAN_TIMEOUT_EXPIRED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+	ExecutionPlan_Drain(plan);
+	return true;
+}
+
+bool ExecutionPlan_DisarmTimeout(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+	PlanTimeoutState expected = PLAN_TIMEOUT_ARMED;
+	if(__atomic_compare_exchange_n(&plan->timeout_state, &expected,
+				PLAN_TIMEOUT_DISARMED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return true;
+	}
+	return expected != PLAN_TIMEOUT_EXPIRED;
+}
+
+void ExecutionPlan_ScheduleTimeout(ExecutionPlan *plan, uint ms, CronTaskCB cb) {
+	ASSERT(plan != NULL && plan->timeout_task == NULL);
+	ExecutionPlan_IncreaseRefCount(plan);
+	ExecutionPlan_ArmTimeout(plan);
+	plan->timeout_task = Cron_AddAbortableTask(ms, cb, plan);
+}
+
+void ExecutionPlan_CancelTimeout(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+
+	// the plan's owner and the timeout task itself race over the handle
+	CronTaskHandle task = __atomic_exchange_n(&plan->timeout_task, NULL,
+			__ATOMIC_ACQ_REL);
+	if(task == NULL) return;
+
+	// an aborted timeout never runs, release its reference on its behalf
+	if(Cron_AbortTask(task)) {
+		__atomic_sub_fetch(&plan->ref_count, 1, __ATOMIC_RELAXED);
+		__atomic_store_n(&plan->timeout_state, PLAN_TIMEOUT_NONE, __ATOMIC_RELEASE);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Execution plan reuse
+//------------------------------------------------------------------------------
+
+// operations whose reset restores the state their init had established
+static bool _ExecutionPlan_OpReusable(const OpBase *op) {
+	// profiled operations had their consume function replaced
+	if(op->stats != NULL) return false;
+
+	switch(op->type) {
+	case OPType_ALL_NODE_SCAN:
+	case OPType_NODE_BY_LABEL_SCAN:
+	case OPType_CONDITIONAL_TRAVERSE:
+	case OPType_EXPAND_INTO:
+	case OPType_FILTER:
+	case OPType_AGGREGATE:
+	case OPType_SORT:
+	case OPType_SKIP:
+	case OPType_LIMIT:
+	case OPType_RESULTS:
+		break;
+	case OPType_PROJECT:
+		// a project without a child emits a single record
+		if(op->childCount == 0) return false;
+		break;
+	default:
+		return false;
+	}
+
+	for(int i = 0; i < op->childCount; i++) {
+		if(!_ExecutionPlan_OpReusable(op->children[i])) return false;
+	}
+	return true;
+}
+
+bool ExecutionPlan_Reusable(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+
+	if(!plan->initialized) return false;
+	if(ExecutionPlan_Drained(plan)) return false;
+	// a pending timeout still refers to the plan
+	if(__atomic_load_n(&plan->ref_count, __ATOMIC_RELAXED) != 0) return false;
+
+	return _ExecutionPlan_OpReusable(plan->root);
+}
+
 //------------------------------------------------------------------------------
 // Execution plan ref count
 //------------------------------------------------------------------------------
@@ -432,17 +622,15 @@ int ExecutionPlan_DecRefCount(ExecutionPlan *plan) {
 // Execution plan profiling
 //------------------------------------------------------------------------------
 
-static void _ExecutionPlan_InitProfiling(OpBase *root) {
+static void _ExecutionPlan_InitProfiling(OpBase *root, fpConsume profile) {
 	root->profile = root->consume;
-	root->consume = OpBase_Profile;
-	root->stats = rm_malloc(sizeof(OpStats));
-	root->stats->profileExecTime = 0;
-	root->stats->profileRecordCount = 0;
+	root->consume = profile;
+	root->stats = rm_calloc(1, sizeof(OpStats));
 
 	if(root->childCount) {
 		for(int i = 0; i < root->childCount; i++) {
 			OpBase *child = root->children[i];
-			_ExecutionPlan_InitProfiling(child);
+			_ExecutionPlan_InitProfiling(child, profile);
 		}
 	}
 }
@@ -459,12 +647,39 @@ static void _ExecutionPlan_FinalizeProfiling(OpBase *root) {
 }
 
 ResultSet *ExecutionPlan_Profile(ExecutionPlan *plan) {
-	_ExecutionPlan_InitProfiling(plan->root);
+	// estimate ahead of execution, for estimates to be reported alongside actuals
+	ExecutionPlan_Estimate(plan);
+	_ExecutionPlan_InitProfiling(plan->root, OpBase_Profile);
 	ResultSet *rs = ExecutionPlan_Execute(plan);
 	_ExecutionPlan_FinalizeProfiling(plan->root);
 	return rs;
 }
 
+static void _ExecutionPlan_FinalizeSampling(OpBase *root) {
+	for(int i = 0; i < root->childCount; i++) {
+		OpBase *child = root->children[i];
+		root->stats->sampleTicks -= child->stats->sampleTicks;
+		root->stats->sampleMemory -= child->stats->sampleMemory;
+		_ExecutionPlan_FinalizeSampling(child);
+	}
+	root->stats->profileExecTime = TSC_ToMs(root->stats->sampleTicks);
+}
+
+void ExecutionPlan_InitSampling(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+	_ExecutionPlan_InitProfiling(plan->root, OpBase_Sample);
+}
+
+bool ExecutionPlan_Sampled(const ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+	return plan->root->consume == OpBase_Sample;
+}
+
+void ExecutionPlan_FinalizeSampling(ExecutionPlan *plan) {
+	ASSERT(ExecutionPlan_Sampled(plan));
+	_ExecutionPlan_FinalizeSampling(plan->root);
+}
+
 //------------------------------------------------------------------------------
 // Execution plan free functions
 //------------------------------------------------------------------------------
@@ -480,7 +695,7 @@ static void _ExecutionPlan_FreeInternals(ExecutionPlan *plan) {
 
 	QueryGraph_Free(plan->query_graph);
 	if(plan->record_map) raxFree(plan->record_map);
-	if(plan->record_pool) ObjectPool_Free(plan->record_pool);
+	if(plan->record_pool) RecordPool_Free(plan->record_pool);
 	if(plan->ast_segment) AST_Free(plan->ast_segment);
 	rm_free(plan);
 }
@@ -492,20 +707,30 @@ static ExecutionPlan *_ExecutionPlan_FreeOpTree(OpBase *op) {
 	ExecutionPlan *prev_child_plan = NULL;
 	// Store a reference to the current plan.
 	ExecutionPlan *current_plan = (ExecutionPlan *)op->plan;
+	// In most cases all children will share the same plan, but if they don't
+	// (for an operation like UNION) then collect each of the children's plans.
+	ExecutionPlan **child_plans = NULL;
 	for(uint i = 0; i < op->childCount; i ++) {
 		child_plan = _ExecutionPlan_FreeOpTree(op->children[i]);
-		// In most cases all children will share the same plan, but if they don't
-		// (for an operation like UNION) then free the now-obsolete previous child plan.
 		if(prev_child_plan != child_plan) {
-			_ExecutionPlan_FreeInternals(prev_child_plan);
+			if(prev_child_plan != NULL) {
+				if(child_plans == NULL) child_plans = array_new(ExecutionPlan *, op->childCount);
+				child_plans = array_append(child_plans, prev_child_plan);
+			}
 			prev_child_plan = child_plan;
 		}
 	}
 
-	// Free this op.
+	// Free this op, ahead of its children's plans as it may still hold
+	// records borrowed from them.
 	OpBase_Free(op);
 
 	// Free each ExecutionPlan segment once all ops associated with it have been freed.
+	if(child_plans != NULL) {
+		uint child_plan_count = array_len(child_plans);
+		for(uint i = 0; i < child_plan_count; i ++) _ExecutionPlan_FreeInternals(child_plans[i]);
+		array_free(child_plans);
+	}
 	if(current_plan != child_plan) _ExecutionPlan_FreeInternals(child_plan);
 
 	return current_plan;
@@ -513,6 +738,7 @@ static ExecutionPlan *_ExecutionPlan_FreeOpTree(OpBase *op) {
 
 void ExecutionPlan_Free(ExecutionPlan *plan) {
 	if(plan == NULL) return;
+	ExecutionPlan_CancelTimeout(plan);
 	if(ExecutionPlan_DecRefCount(plan) >= 0) return;
 
 	// Free all ops and ExecutionPlan segments.
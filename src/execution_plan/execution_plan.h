@@ -10,19 +10,31 @@
 #include "../graph/graph.h"
 #include "../resultset/resultset.h"
 #include "../filter_tree/filter_tree.h"
-#include "../util/object_pool/object_pool.h"
+#include "record_pool.h"
+#include "../util/cron.h"
 
 typedef struct ExecutionPlan ExecutionPlan;
 
+// state of a plan's timeout, see ExecutionPlan_ArmTimeout
+typedef enum {
+	PLAN_TIMEOUT_NONE = 0,  // No timeout was set.
+	PLAN_TIMEOUT_ARMED,     // Timeout pending.
+	PLAN_TIMEOUT_EXPIRED,   // Timeout expired, the plan is drained.
+	PLAN_TIMEOUT_DISARMED,  // The plan commits its changes, it can't time out.
+} PlanTimeoutState;
+
 struct ExecutionPlan {
 	OpBase *root;                       // Root operation of overall ExecutionPlan.
 	AST *ast_segment;                   // The segment which the current ExecutionPlan segment is built from.
 	rax *record_map;                    // Mapping between identifiers and record indices.
 	QueryGraph *query_graph;            // QueryGraph representing all graph entities in this segment.
 	QueryGraph **connected_components;  // Array of all connected components in this segment.
-	ObjectPool *record_pool;
+	RecordPool *record_pool;            // Slab of records sized from record_map.
 	bool prepared;                      // Indicates if the execution plan is ready for execute.
+	bool initialized;                   // Indicates if the plan's operations were initialized.
 	int ref_count;                      // Number of active references.
+	PlanTimeoutState timeout_state;     // State of the plan's timeout.
+	CronTaskHandle timeout_task;        // Pending timeout task, NULL if none.
 };
 
 /* Creates a new execution plan from AST */
@@ -53,21 +65,60 @@ void ExecutionPlan_ReturnRecord(ExecutionPlan *plan, Record r);
 /* Prints execution plan. */
 void ExecutionPlan_Print(const ExecutionPlan *plan, RedisModuleCtx *ctx);
 
-/* Initialize all operations in an ExecutionPlan. */
+/* Initialize all operations in an ExecutionPlan,
+ * operations of a previously executed plan are reset instead. */
 void ExecutionPlan_Init(ExecutionPlan *plan);
 
 /* Executes plan */
 ResultSet *ExecutionPlan_Execute(ExecutionPlan *plan);
 
+/* Resumes an initialized plan until it produced 'limit' records or was depleted,
+ * returns true once the plan is depleted or a run-time error was encountered. */
+bool ExecutionPlan_ExecuteStep(ExecutionPlan *plan, uint64_t limit);
+
 /* Checks if execution plan been drained */
 bool ExecutionPlan_Drained(ExecutionPlan *plan);
 
 /* Drains execution plan */
 void ExecutionPlan_Drain(ExecutionPlan *plan);
 
+/* Marks the plan as timed, called once a timeout is scheduled for it. */
+void ExecutionPlan_ArmTimeout(ExecutionPlan *plan);
+
+/* Expires the plan's timeout, draining the plan.
+ * Returns false if the plan had begun committing changes, in which case
+ * the plan isn't drained. */
+bool ExecutionPlan_ExpireTimeout(ExecutionPlan *plan);
+
+/* Disarms the plan's timeout, called before the plan commits changes.
+ * Returns false if the timeout had already expired. */
+bool ExecutionPlan_DisarmTimeout(ExecutionPlan *plan);
+
+/* Schedules the plan's timeout 'ms' milliseconds from now, the timeout task
+ * holds a reference to the plan up until it runs or is cancelled. */
+void ExecutionPlan_ScheduleTimeout(ExecutionPlan *plan, uint ms, CronTaskCB cb);
+
+/* Cancels the plan's pending timeout, releasing the reference it held.
+ * Called once the plan executed, NOP if the timeout already ran. */
+void ExecutionPlan_CancelTimeout(ExecutionPlan *plan);
+
 /* Profile executes plan */
 ResultSet *ExecutionPlan_Profile(ExecutionPlan *plan);
 
+/* Collect per-operation statistics while the plan executes,
+ * a sampled plan can't be reused once executed. */
+void ExecutionPlan_InitSampling(ExecutionPlan *plan);
+
+/* Returns true if the plan collects per-operation statistics. */
+bool ExecutionPlan_Sampled(const ExecutionPlan *plan);
+
+/* Compute each operation's own statistics once a sampled plan executed,
+ * excluding the statistics of its children. */
+void ExecutionPlan_FinalizeSampling(ExecutionPlan *plan);
+
+/* Checks if an executed plan can be reset and executed again. */
+bool ExecutionPlan_Reusable(ExecutionPlan *plan);
+
 /* Increase execution plan reference count */
 void ExecutionPlan_IncreaseRefCount(ExecutionPlan *plan);
 
@@ -26,6 +26,36 @@ static void _buildMergeCreateStream(ExecutionPlan *plan, AST_MergeContext *merge
 	}
 }
 
+/* Bound records of a MERGE over a single node with a fixed label and an inline
+ * property map, e.g. UNWIND $rows AS row MERGE (n:L {id: row.id}), are matched
+ * by the node's key in a single pass rather than running the Match stream per record.
+ * Without bound records, the key is utilized once a uniqueness constraint covers it. */
+static bool _MergeBatchable(const cypher_astnode_t *path, const AST_MergeContext *merge_ctx,
+							const char **arguments) {
+	if(array_len(merge_ctx->edges_to_merge) != 0) return false;
+	if(array_len(merge_ctx->nodes_to_merge) != 1) return false;
+	if(cypher_ast_pattern_path_nelements(path) != 1) return false;
+
+	const cypher_astnode_t *ast_node = cypher_ast_pattern_path_get_element(path, 0);
+	if(cypher_ast_node_pattern_nlabels(ast_node) != 1) return false;
+
+	const NodeCreateCtx *n = merge_ctx->nodes_to_merge;
+	if(n->properties == NULL || n->properties->property_count == 0) return false;
+
+	// key expressions must be resolvable from the bound records alone
+	bool batchable = true;
+	rax *aliases = raxNew();
+	for(int i = 0; i < n->properties->property_count; i++) {
+		AR_EXP_CollectEntities(n->properties->values[i], aliases);
+	}
+	if(raxFind(aliases, (unsigned char *)n->alias, strlen(n->alias)) != raxNotFound) {
+		batchable = false;
+	}
+	raxFree(aliases);
+
+	return batchable;
+}
+
 void buildMergeOp(ExecutionPlan *plan, AST *ast, const cypher_astnode_t *clause, GraphContext *gc) {
 	/*
 	 * A MERGE clause provides a single path that must exist or be created.
@@ -82,6 +112,10 @@ void buildMergeOp(ExecutionPlan *plan, AST *ast, const cypher_astnode_t *clause,
 	OpBase *match_stream = ExecutionPlan_BuildOpsFromPath(plan, arguments, path);
 	ExecutionPlan_AddOp(plan->root, match_stream); // Add Match stream to Merge op.
 
+	if(_MergeBatchable(path, &merge_ctx, arguments)) {
+		Merge_SetBatchKey(merge_op, merge_ctx.nodes_to_merge);
+	}
+
 	// Build the Create stream as a Merge child.
 	_buildMergeCreateStream(plan, &merge_ctx, arguments);
 
@@ -7,6 +7,8 @@
 #include "execution_plan.h"
 #include "../RG.h"
 #include "./ops/ops.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
 
 void _ExecutionPlan_Print(const OpBase *op, RedisModuleCtx *ctx, char *buffer, int buffer_len,
 						  int ident, int *op_count) {
@@ -18,6 +20,12 @@ void _ExecutionPlan_Print(const OpBase *op, RedisModuleCtx *ctx, char *buffer, i
 	int bytes_written = snprintf(buffer, buffer_len, "%*s", ident, "");
 	bytes_written += OpBase_ToString(op, buffer + bytes_written, buffer_len - bytes_written);
 
+	// A profiled plan reports its peak memory consumption along its root.
+	if(ident == 0 && op->stats) {
+		bytes_written += snprintf(buffer + bytes_written, buffer_len - bytes_written,
+								  ", Peak memory: %" PRId64 " bytes", Alloc_GetPeakConsumption());
+	}
+
 	RedisModule_ReplyWithStringBuffer(ctx, buffer, bytes_written);
 
 	// Recurse over child operations.
@@ -37,6 +45,14 @@ void ExecutionPlan_Print(const ExecutionPlan *plan, RedisModuleCtx *ctx) {
 	RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
 	_ExecutionPlan_Print(plan->root, ctx, buffer, 1024, 0, &op_count);
 
+	// a profiled plan trails its operations with the query's phases
+	if(plan->root->stats) {
+		int bytes_written = snprintf(buffer, 1024, "Query phases | ");
+		bytes_written += QueryCtx_PhasesToString(buffer + bytes_written, 1024 - bytes_written);
+		RedisModule_ReplyWithStringBuffer(ctx, buffer, bytes_written);
+		op_count++;
+	}
+
 	RedisModule_ReplySetArrayLength(ctx, op_count);
 }
 
@@ -6,8 +6,12 @@
 
 #include "op.h"
 #include "RG.h"
+#include "../../errors.h"
 #include "../../util/rmalloc.h"
+#include "../../util/tsc.h"
 #include "../../util/simple_timer.h"
+#include "../../util/trace.h"
+#include <limits.h>
 
 /* Forward declarations */
 Record ExecutionPlan_BorrowRecord(struct ExecutionPlan *plan);
@@ -27,8 +31,11 @@ void OpBase_Init(OpBase *op, OPType type, const char *name, fpInit init, fpConsu
 	op->children = NULL;
 	op->parent = NULL;
 	op->stats = NULL;
+	op->estimate.records = -1;
+	op->estimate.cost = 0;
 	op->op_initialized = false;
 	op->modifies = NULL;
+	op->limit_hint = UINT_MAX;
 	op->writer = writer;
 
 	// Function pointers.
@@ -39,12 +46,43 @@ void OpBase_Init(OpBase *op, OPType type, const char *name, fpInit init, fpConsu
 	op->clone = clone;
 	op->free = free;
 	op->profile = NULL;
+	op->consume_batch = NULL;
 }
 
 inline Record OpBase_Consume(OpBase *op) {
+	// abort queries holding more memory than allowed
+	// consumption is counted by the thread executing the query, carried along
+	// as the query migrates, memory the query allocated and another thread
+	// frees remains counted against it, e.g. records released by the main thread
+	if(Alloc_CapacityExceeded()) {
+		ErrorCtx_RaiseRuntimeException("Query's mem consumption exceeded capacity");
+	}
 	return op->consume(op);
 }
 
+uint OpBase_ConsumeBatch(OpBase *op, Record *batch, uint cap) {
+	ASSERT(batch != NULL);
+	ASSERT(cap > 0);
+	cap = OpBase_BatchSize(op, cap);
+
+	// profiled operations are consumed one record at a time
+	// such that their statistics remain accurate
+	fpConsumeBatch consume_batch = op->consume_batch;
+	uint n = 0;
+	if(consume_batch != NULL && op->stats == NULL) {
+		n = consume_batch(op, batch, cap);
+	} else {
+		while(n < cap) {
+			Record r = OpBase_Consume(op);
+			if(r == NULL) break;
+			batch[n++] = r;
+		}
+	}
+
+	TRACE_PROBE3(op__consume__batch, op->name, n, cap);
+	return n;
+}
+
 int OpBase_Modifies(OpBase *op, const char *alias) {
 	if(!op->modifies) op->modifies = array_new(const char *, 1);
 	op->modifies = array_append(op->modifies, alias);
@@ -102,6 +140,13 @@ static int _OpBase_StatsToString(const OpBase *op, char *buff, uint buff_len) {
 					op->stats->profileExecTime);
 }
 
+static int _OpBase_EstimateToString(const OpBase *op, char *buff, uint buff_len) {
+	return snprintf(buff, buff_len,
+					" | Estimated records: %.1f, Cost: %.1f%%",
+					op->estimate.records,
+					op->estimate.cost);
+}
+
 int OpBase_ToString(const OpBase *op, char *buff, uint buff_len) {
 	int bytes_written = 0;
 
@@ -114,6 +159,12 @@ int OpBase_ToString(const OpBase *op, char *buff, uint buff_len) {
 											   buff_len - bytes_written);
 	}
 
+	if(op->estimate.records >= 0 && (uint)bytes_written < buff_len) {
+		bytes_written += _OpBase_EstimateToString(op,
+												  buff + bytes_written,
+												  buff_len - bytes_written);
+	}
+
 	return bytes_written;
 }
 
@@ -128,6 +179,17 @@ Record OpBase_Profile(OpBase *op) {
 	return r;
 }
 
+Record OpBase_Sample(OpBase *op) {
+	// cheaper than OpBase_Profile's timer, as sampling runs unsolicited
+	int64_t mem = Alloc_GetConsumption();
+	uint64_t start = TSC_Now();
+	Record r = op->profile(op);
+	op->stats->sampleTicks += TSC_Now() - start;
+	op->stats->sampleMemory += Alloc_GetConsumption() - mem;
+	if(r) op->stats->profileRecordCount++;
+	return r;
+}
+
 bool OpBase_IsWriter(OpBase *op) {
 	return op->writer;
 }
@@ -138,6 +200,12 @@ void OpBase_UpdateConsume(OpBase *op, fpConsume consume) {
 	 * otherwise update consume function. */
 	if(op->profile != NULL) op->profile = consume;
 	else op->consume = consume;
+	op->consume_batch = NULL;
+}
+
+void OpBase_UpdateConsumeBatch(OpBase *op, fpConsumeBatch consume_batch) {
+	ASSERT(op != NULL);
+	op->consume_batch = consume_batch;
 }
 
 inline Record OpBase_CreateRecord(const OpBase *op) {
@@ -150,13 +218,21 @@ Record OpBase_CloneRecord(Record r) {
 	return clone;
 }
 
+Record OpBase_ShareRecord(Record r) {
+	Record shared = ExecutionPlan_BorrowRecord((struct ExecutionPlan *)r->owner);
+	Record_Share(r, shared);
+	return shared;
+}
+
 inline void OpBase_DeleteRecord(Record r) {
 	ExecutionPlan_ReturnRecord(r->owner, r);
 }
 
 OpBase *OpBase_Clone(const struct ExecutionPlan *plan, const OpBase *op) {
-	if(op->clone) return op->clone(plan, op);
-	return NULL;
+	if(op->clone == NULL) return NULL;
+	OpBase *clone = op->clone(plan, op);
+	if(clone) clone->limit_hint = op->limit_hint;
+	return clone;
 }
 
 void OpBase_Free(OpBase *op) {
@@ -20,12 +20,16 @@ typedef enum {
 	OPType_ALL_NODE_SCAN,
 	OPType_NODE_BY_LABEL_SCAN,
 	OPType_INDEX_SCAN,
+	OPType_EDGE_INDEX_SCAN,
+	OPType_EDGE_BY_TYPE_SCAN,
+	OPType_EDGE_BY_ID_SEEK,
 	OPType_NODE_BY_ID_SEEK,
 	OPType_NODE_BY_LABEL_AND_ID_SCAN,
 	OPType_EXPAND_INTO,
 	OPType_CONDITIONAL_TRAVERSE,
 	OPType_CONDITIONAL_VAR_LEN_TRAVERSE,
 	OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO,
+	OPType_EXPAND_INTERSECT,
 	OPType_RESULTS,
 	OPType_PROJECT,
 	OPType_AGGREGATE,
@@ -63,6 +67,9 @@ typedef enum {
 // Macro for checking whether an operation is an Apply variant.
 #define OP_IS_APPLY(op) ((op)->type == OPType_OR_APPLY_MULTIPLEXER || (op)->type == OPType_AND_APPLY_MULTIPLEXER || (op)->type == OPType_SEMI_APPLY || (op)->type == OPType_ANTI_SEMI_APPLY)
 
+// Maximum number of records moved by a single batch consume call.
+#define OP_BATCH_CAP 64
+
 #define PROJECT_OP_COUNT 2
 static const OPType PROJECT_OPS[] = {OPType_PROJECT, OPType_AGGREGATE};
 
@@ -84,6 +91,7 @@ struct ExecutionPlan;
 typedef void (*fpFree)(struct OpBase *);
 typedef OpResult(*fpInit)(struct OpBase *);
 typedef Record(*fpConsume)(struct OpBase *);
+typedef uint(*fpConsumeBatch)(struct OpBase *, Record *, uint);
 typedef OpResult(*fpReset)(struct OpBase *);
 typedef int (*fpToString)(const struct OpBase *, char *, uint);
 typedef struct OpBase *(*fpClone)(const struct ExecutionPlan *, const struct OpBase *);
@@ -92,8 +100,16 @@ typedef struct OpBase *(*fpClone)(const struct ExecutionPlan *, const struct OpB
 typedef struct {
 	int profileRecordCount;     // Number of records generated.
 	double profileExecTime;     // Operation total execution time in ms.
+	uint64_t sampleTicks;       // Sampled execution time, in TSC ticks.
+	int64_t sampleMemory;       // Bytes allocated by a sampled execution.
 }  OpStats;
 
+// Execution plan operation estimates, see ExecutionPlan_Estimate.
+typedef struct {
+	double records;             // Number of records expected, negative if unestimated.
+	double cost;                // Share of the plan's estimated cost, in percent.
+} OpEstimate;
+
 struct OpBase {
 	OPType type;                // Type of operation.
 	fpInit init;                // Called once before execution.
@@ -102,6 +118,7 @@ struct OpBase {
 	fpClone clone;              // Operation clone.
 	fpConsume consume;          // Produce next record.
 	fpConsume profile;          // Profiled version of consume.
+	fpConsumeBatch consume_batch; // Produce a block of records, NULL if unsupported.
 	fpToString toString;        // Operation string representation.
 	const char *name;           // Operation name.
 	int childCount;             // Number of children.
@@ -109,8 +126,10 @@ struct OpBase {
 	struct OpBase **children;   // Child operations.
 	const char **modifies;      // List of entities this op modifies.
 	OpStats *stats;             // Profiling statistics.
+	OpEstimate estimate;        // Planner estimates.
 	struct OpBase *parent;      // Parent operations.
 	const struct ExecutionPlan *plan; // ExecutionPlan this operation is part of.
+	uint limit_hint;            // Max records required from this op, UINT_MAX if unknown, see applyLimit.
 	bool writer;             // Indicates this is a writer operation.
 };
 typedef struct OpBase OpBase;
@@ -122,6 +141,20 @@ void OpBase_Init(OpBase *op, OPType type, const char *name, fpInit init, fpConsu
 void OpBase_Free(OpBase *op);       // Free op.
 Record OpBase_Consume(OpBase *op);  // Consume op.
 Record OpBase_Profile(OpBase *op);  // Profile op.
+Record OpBase_Sample(OpBase *op);   // Sample op, see ExecutionPlan_InitSampling.
+
+/* Consume up to cap records from op into batch, cap is bounded by op's limit hint.
+ * Returns the number of records produced, 0 once op is depleted.
+ * Operations lacking a native batch implementation, or being profiled,
+ * fall back to repeated calls to OpBase_Consume. */
+uint OpBase_ConsumeBatch(OpBase *op, Record *batch, uint cap);
+
+/* Returns the number of records an op should accumulate before processing them
+ * as a batch, at most cap, fewer if op's consumer requires fewer records. */
+static inline uint OpBase_BatchSize(const OpBase *op, uint cap) {
+	if(op->limit_hint == 0 || op->limit_hint >= cap) return cap;
+	return op->limit_hint;
+}
 
 int OpBase_ToString(const OpBase *op, char *buff, uint buff_len);
 
@@ -146,14 +179,22 @@ void OpBase_PropagateReset(OpBase *op); // Sends reset request to each operation
 bool OpBase_IsWriter(OpBase *op);
 
 // Update operation consume function.
+// this clears the operation batch consume function,
+// as it is no longer guaranteed to mirror consume.
 void OpBase_UpdateConsume(OpBase *op, fpConsume consume);
 
+// Update operation batch consume function.
+void OpBase_UpdateConsumeBatch(OpBase *op, fpConsumeBatch consume_batch);
+
 // Creates a new record that will be populated during execution.
 Record OpBase_CreateRecord(const OpBase *op);
 
 // Clones given record.
 Record OpBase_CloneRecord(Record r);
 
+// Creates a record sharing the entries of the given record, in constant time.
+Record OpBase_ShareRecord(Record r);
+
 // Release record.
 void OpBase_DeleteRecord(Record r);
 
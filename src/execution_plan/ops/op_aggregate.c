@@ -11,9 +11,13 @@
 #include "../../query_ctx.h"
 #include "../../util/rmalloc.h"
 #include "../../grouping/group.h"
+#include "shared/scan_sample.h"
 
 /* Forward declarations. */
+static OpResult AggregateInit(OpBase *opBase);
 static Record AggregateConsume(OpBase *opBase);
+static Record AggregateSortedConsume(OpBase *opBase);
+static uint AggregateConsumeBatch(OpBase *opBase, Record *batch, uint cap);
 static OpResult AggregateReset(OpBase *opBase);
 static OpBase *AggregateClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void AggregateFree(OpBase *opBase);
@@ -84,40 +88,16 @@ static void _ComputeGroupKey(OpAggregate *op, Record r) {
 	}
 }
 
-static void _ComputeGroupKeyStr(OpAggregate *op, char **key) {
-	if(op->key_count == 0) {
-		*key = rm_strdup("SINGLE_GROUP");
-		return;
-	}
-
-	// Determine required size for group key string representation.
-	size_t key_len = SIValue_StringJoinLen(op->group_keys, op->key_count, ",");
-	*key = rm_malloc(sizeof(char) * key_len);
-	size_t bytesWritten = 0;
-	SIValue_StringJoin(op->group_keys, op->key_count, ",", key, &key_len, &bytesWritten);
-}
-
 /* Retrieves group under which given record belongs to,
  * creates group if one doesn't exists. */
 static Group *_GetGroup(OpAggregate *op, Record r) {
-	char *group_key_str = NULL;
 	bool free_key_exps = true;
 	// Construct group key.
 	_ComputeGroupKey(op, r);
 
-	// First group created.
-	if(!op->group) {
-		op->group = _CreateGroup(op, r);
-		Group_KeyStr(op->group, &group_key_str);
-		CacheGroupAdd(op->groups, group_key_str, op->group);
-		// Key expressions are owned by the new group and don't need to be freed.
-		free_key_exps = false;
-		goto cleanup;
-	}
-
 	// Evaluate non-aggregated fields, see if they match
 	// the last accessed group.
-	bool reuseLastAccessedGroup = true;
+	bool reuseLastAccessedGroup = (op->group != NULL);
 	for(uint i = 0; reuseLastAccessedGroup && i < op->key_count; i++) {
 		reuseLastAccessedGroup = (SIValue_Compare(op->group->keys[i], op->group_keys[i], NULL) == 0);
 	}
@@ -125,13 +105,13 @@ static Group *_GetGroup(OpAggregate *op, Record r) {
 	// See if we can reuse last accessed group.
 	if(reuseLastAccessedGroup) goto cleanup;
 
-	// Can't reuse last accessed group, lookup group by identifier key.
-	_ComputeGroupKeyStr(op, &group_key_str);
-	op->group = CacheGroupGet(op->groups, group_key_str);
+	// Can't reuse last accessed group, lookup group by key hash.
+	XXH64_hash_t hash = CacheGroupHash(op->group_keys, op->key_count);
+	op->group = CacheGroupGet(op->groups, hash, op->group_keys, op->key_count);
 	if(!op->group) {
 		// Group does not exists, create it.
 		op->group = _CreateGroup(op, r);
-		CacheGroupAdd(op->groups, group_key_str, op->group);
+		CacheGroupAdd(op->groups, hash, op->group);
 		// Key expressions are owned by the new group and don't need to be freed.
 		free_key_exps = false;
 	}
@@ -143,7 +123,6 @@ cleanup:
 			SIValue_Free(op->group_keys[i]);
 		}
 	}
-	if(group_key_str) rm_free(group_key_str);
 	return op->group;
 }
 
@@ -162,21 +141,42 @@ static void _aggregateRecord(OpAggregate *op, Record r) {
 	OpBase_DeleteRecord(r);
 }
 
-/* Returns a record populated with group data. */
-static Record _handoff(OpAggregate *op) {
-	char *key;
-	Group *group;
-	if(!CacheGroupIterNext(op->group_iter, &key, &group)) return NULL;
+/* Aggregate the first n pending records, one at a time.
+ * Records yet to be aggregated are released by AggregateFree
+ * should an aggregation raise an error. */
+static void _aggregatePending(OpAggregate *op, uint n) {
+	op->pending_count = n;
+	for(op->pending_idx = 0; op->pending_idx < n; op->pending_idx++) {
+		_aggregateRecord(op, op->pending[op->pending_idx]);
+	}
+	op->pending_idx = 0;
+	op->pending_count = 0;
+}
 
+/* Aggregate the first n pending records, in parallel when possible. */
+static void _aggregateBuffer(OpAggregate *op, uint n) {
+	if(n >= PARALLEL_AGGREGATE_MIN_RECORDS &&
+	   ParallelAggregate_Apply(op->parallel, op->pending, n)) {
+		for(uint i = 0; i < n; i++) OpBase_DeleteRecord(op->pending[i]);
+		op->pending_count = 0;
+		return;
+	}
+
+	_aggregatePending(op, n);
+}
+
+/* Returns a record populated with group data,
+ * if 'transfer' is set the record takes ownership of the group's keys. */
+static Record _groupRecord(OpAggregate *op, Group *group, bool transfer) {
 	Record r = OpBase_CreateRecord((OpBase *)op);
 
 	// Add all projected keys to the Record.
 	for(uint i = 0; i < op->key_count; i++) {
 		int rec_idx = op->record_offsets[i];
 		// Non-aggregated expression.
-		SIValue res = group->keys[i];
-		// Key values are shared with the Record, as they'll be freed with the group cache.
-		res = SI_ShareValue(res);
+		// Cached key values are shared with the Record, as they'll be freed with the group cache.
+		SIValue res = (transfer) ? SI_TransferOwnership(&group->keys[i]) :
+			SI_ShareValue(group->keys[i]);
 		Record_Add(r, rec_idx, res);
 	}
 
@@ -185,6 +185,8 @@ static Record _handoff(OpAggregate *op) {
 		int rec_idx = op->record_offsets[i + op->key_count];
 		AR_ExpNode *exp = group->aggregationFunctions[i];
 
+		// extrapolate aggregations computed over a sample
+		if(op->scale != 1) AR_EXP_ScaleAggregations(exp, op->scale);
 		SIValue res = AR_EXP_Finalize(exp, r);
 		Record_AddScalar(r, rec_idx, res);
 	}
@@ -192,13 +194,27 @@ static Record _handoff(OpAggregate *op) {
 	return r;
 }
 
+/* Returns a record populated with the next cached group's data. */
+static Record _handoff(OpAggregate *op) {
+	Group *group;
+	if(!CacheGroupIterNext(op->group_iter, &group)) return NULL;
+	return _groupRecord(op, group, false);
+}
+
 OpBase *NewAggregateOp(const ExecutionPlan *plan, AR_ExpNode **exps, bool should_cache_records) {
 	OpAggregate *op = rm_malloc(sizeof(OpAggregate));
 	op->group = NULL;
 	op->group_iter = NULL;
 	op->group_keys = NULL;
 	op->groups = CacheGroupNew();
+	op->parallel = NULL;
+	op->pending = NULL;
+	op->pending_idx = 0;
+	op->pending_count = 0;
 	op->should_cache_records = should_cache_records;
+	op->sorted = false;
+	op->depleted = false;
+	op->scale = 1;
 
 	// Migrate each expression to the keys array or the aggregations array as appropriate.
 	_migrate_expressions(op, exps);
@@ -207,8 +223,15 @@ OpBase *NewAggregateOp(const ExecutionPlan *plan, AR_ExpNode **exps, bool should
 	// Allocate memory for group keys if we have any non-aggregate expressions.
 	if(op->key_count) op->group_keys = rm_malloc(op->key_count * sizeof(SIValue));
 
-	OpBase_Init((OpBase *)op, OPType_AGGREGATE, "Aggregate", NULL, AggregateConsume,
+	// Groups referencing a cached record must be built by this thread.
+	if(!should_cache_records) {
+		op->parallel = ParallelAggregate_New(op->key_exps, op->key_count,
+				op->aggregate_exps, op->aggregate_count);
+	}
+
+	OpBase_Init((OpBase *)op, OPType_AGGREGATE, "Aggregate", AggregateInit, AggregateConsume,
 				AggregateReset, NULL, AggregateClone, AggregateFree, false, plan);
+	OpBase_UpdateConsumeBatch((OpBase *)op, AggregateConsumeBatch);
 
 	// The projected record will associate values with their resolved name
 	// to ensure that space is allocated for each entry.
@@ -227,6 +250,19 @@ OpBase *NewAggregateOp(const ExecutionPlan *plan, AR_ExpNode **exps, bool should
 	return (OpBase *)op;
 }
 
+void AggregateOp_SetSortedInput(OpAggregate *op) {
+	ASSERT(op != NULL);
+	ASSERT(op->key_count > 0);
+	op->sorted = true;
+	OpBase_UpdateConsume((OpBase *)op, AggregateSortedConsume);
+}
+
+static OpResult AggregateInit(OpBase *opBase) {
+	OpAggregate *op = (OpAggregate *)opBase;
+	op->scale = 1 / ScanSample_Rate(opBase);
+	return OP_OK;
+}
+
 static Record AggregateConsume(OpBase *opBase) {
 	OpAggregate *op = (OpAggregate *)opBase;
 	if(op->group_iter) return _handoff(op);
@@ -237,15 +273,99 @@ static Record AggregateConsume(OpBase *opBase) {
 		 * Create a 'fake' record. */
 		r = OpBase_CreateRecord(opBase);
 		_aggregateRecord(op, r);
+	} else if(op->parallel == NULL) {
+		// drain child a block at a time
+		// child records are held by the operation until aggregated
+		// such that they can be released if evaluation raises an error
+		uint n;
+		OpBase *child = op->op.children[0];
+		if(op->pending == NULL) op->pending = rm_malloc(sizeof(Record) * OP_BATCH_CAP);
+		while((n = OpBase_ConsumeBatch(child, op->pending, OP_BATCH_CAP))) {
+			_aggregatePending(op, n);
+		}
 	} else {
+		// buffer input, aggregating each full buffer in parallel
+		uint n;
 		OpBase *child = op->op.children[0];
-		while((r = OpBase_Consume(child))) _aggregateRecord(op, r);
+		if(op->pending == NULL) {
+			op->pending = rm_malloc(sizeof(Record) *
+					(PARALLEL_AGGREGATE_MIN_RECORDS + OP_BATCH_CAP));
+		}
+		while((n = OpBase_ConsumeBatch(child, op->pending + op->pending_count,
+						OP_BATCH_CAP))) {
+			op->pending_count += n;
+			if(op->pending_count >= PARALLEL_AGGREGATE_MIN_RECORDS) {
+				_aggregateBuffer(op, op->pending_count);
+			}
+		}
+		_aggregateBuffer(op, op->pending_count);
+
+		// fold per-thread partial groups into the group cache
+		ParallelAggregate_Merge(op->parallel, op->groups);
 	}
 
 	op->group_iter = CacheGroupIter(op->groups);
 	return _handoff(op);
 }
 
+static Record AggregateSortedConsume(OpBase *opBase) {
+	OpAggregate *op = (OpAggregate *)opBase;
+	OpBase *child = op->op.children[0];
+
+	Record r;
+	while(!op->depleted && (r = OpBase_Consume(child))) {
+		_ComputeGroupKey(op, r);
+
+		// records of the current group are consecutive
+		bool same_group = (op->group != NULL);
+		for(uint i = 0; same_group && i < op->key_count; i++) {
+			same_group = (SIValue_Compare(op->group->keys[i], op->group_keys[i], NULL) == 0);
+		}
+
+		Record emitted = NULL;
+		if(same_group) {
+			for(uint i = 0; i < op->key_count; i++) SIValue_Free(op->group_keys[i]);
+		} else {
+			// key changed, the current group is complete
+			if(op->group != NULL) {
+				emitted = _groupRecord(op, op->group, true);
+				FreeGroup(op->group);
+			}
+			// key values are owned by the new group
+			_CreateGroup(op, r);
+		}
+
+		for(uint i = 0; i < op->aggregate_count; i++) {
+			AR_EXP_Aggregate(op->group->aggregationFunctions[i], r);
+		}
+		OpBase_DeleteRecord(r);
+
+		if(emitted != NULL) return emitted;
+	}
+
+	// child depleted, emit the last group
+	op->depleted = true;
+	if(op->group == NULL) return NULL;
+
+	Record emitted = _groupRecord(op, op->group, true);
+	FreeGroup(op->group);
+	op->group = NULL;
+	return emitted;
+}
+
+static uint AggregateConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	OpAggregate *op = (OpAggregate *)opBase;
+
+	// first call aggregates the entire input
+	Record r = AggregateConsume(opBase);
+	if(r == NULL) return 0;
+
+	uint n = 0;
+	batch[n++] = r;
+	while(n < cap && (r = _handoff(op))) batch[n++] = r;
+	return n;
+}
+
 static OpResult AggregateReset(OpBase *opBase) {
 	OpAggregate *op = (OpAggregate *)opBase;
 
@@ -257,7 +377,12 @@ static OpResult AggregateReset(OpBase *opBase) {
 		op->group_iter = NULL;
 	}
 
+	// in sorted mode the current group isn't cached
+	if(op->sorted) FreeGroup(op->group);
 	op->group = NULL;
+	op->depleted = false;
+	// a reused plan may be executed by a query sampling at another rate
+	op->scale = 1 / ScanSample_Rate(opBase);
 
 	return OP_OK;
 }
@@ -272,7 +397,10 @@ static OpBase *AggregateClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	for(uint i = 0; i < key_count; i++) exps = array_append(exps, AR_EXP_Clone(op->key_exps[i]));
 	for(uint i = 0; i < aggregate_count; i++)
 		exps = array_append(exps, AR_EXP_Clone(op->aggregate_exps[i]));
-	return NewAggregateOp(plan, exps, op->should_cache_records);
+	OpAggregate *clone = (OpAggregate *)NewAggregateOp(plan, exps,
+			op->should_cache_records);
+	if(op->sorted) AggregateOp_SetSortedInput(clone);
+	return (OpBase *)clone;
 }
 
 static void AggregateFree(OpBase *opBase) {
@@ -306,6 +434,21 @@ static void AggregateFree(OpBase *opBase) {
 		op->groups = NULL;
 	}
 
+	if(op->sorted && op->group) FreeGroup(op->group);
+
+	if(op->parallel) {
+		ParallelAggregate_Free(op->parallel);
+		op->parallel = NULL;
+	}
+
+	if(op->pending) {
+		for(uint i = op->pending_idx; i < op->pending_count; i++) {
+			OpBase_DeleteRecord(op->pending[i]);
+		}
+		rm_free(op->pending);
+		op->pending = NULL;
+	}
+
 	if(op->record_offsets) {
 		array_free(op->record_offsets);
 		op->record_offsets = NULL;
@@ -10,6 +10,7 @@
 #include "../execution_plan.h"
 #include "../../redismodule.h"
 #include "../../graph/query_graph.h"
+#include "shared/parallel_aggregate.h"
 #include "../../grouping/group_cache.h"
 #include "../../arithmetic/arithmetic_expression.h"
 
@@ -18,14 +19,25 @@ typedef struct {
 	uint *record_offsets;               /* Record IDs for key and aggregate exps. */
 	AR_ExpNode **key_exps;              /* Array of expressions used to calculate the group key. */
 	AR_ExpNode **aggregate_exps;        /* Array of expressions that aggregate data for each key. */
-	rax *groups;                        /* Map of all groups built by this operation. */
+	CacheGroup *groups;                 /* Map of all groups built by this operation. */
 	Group *group;                       /* Last accessed group. */
 	SIValue *group_keys;                /* Array of values that represent a key associated with a Group of aggregations. */
 	CacheGroupIterator *group_iter;     /* Iterator for walking all groups. */
+	ParallelAggregate *parallel;        /* Per-thread partial aggregation, NULL if not applicable. */
+	Record *pending;                    /* Child records awaiting aggregation. */
+	uint pending_idx;                   /* Next pending record to aggregate. */
+	uint pending_count;                 /* Number of pending records. */
 	uint key_count;                     /* Number of key expressions. */
 	uint aggregate_count;               /* Number of aggregating expressions. */
 	bool should_cache_records;          /* Records should be cached if we're sorting after aggregation. */
+	bool sorted;                        /* Input is grouped by key, each group is emitted once its key changes. */
+	bool depleted;                      /* Child is depleted, sorted mode. */
+	double scale;                       /* Aggregations are scaled by the inverse of their input's sample rate. */
 } OpAggregate;
 
 OpBase *NewAggregateOp(const ExecutionPlan *plan, AR_ExpNode **exps, bool should_cache_records);
 
+/* Records sharing a key reach the aggregation consecutively,
+ * groups are emitted as soon as the key changes, holding a single group at a time. */
+void AggregateOp_SetSortedInput(OpAggregate *op);
+
@@ -12,6 +12,8 @@
 static OpResult AllNodeScanInit(OpBase *opBase);
 static Record AllNodeScanConsume(OpBase *opBase);
 static Record AllNodeScanConsumeFromChild(OpBase *opBase);
+static uint AllNodeScanConsumeBatch(OpBase *opBase, Record *batch, uint cap);
+static Record AllNodeScanConsumePrefiltered(OpBase *opBase);
 static OpResult AllNodeScanReset(OpBase *opBase);
 static OpBase *AllNodeScanClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void AllNodeScanFree(OpBase *opBase);
@@ -25,6 +27,8 @@ OpBase *NewAllNodeScanOp(const ExecutionPlan *plan, const char *alias) {
 	op->iter = NULL;
 	op->alias = alias;
 	op->child_record = NULL;
+	op->prefilter = NULL;
+	op->sample = NULL;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_ALL_NODE_SCAN, "All Node Scan", AllNodeScanInit,
@@ -36,11 +40,30 @@ OpBase *NewAllNodeScanOp(const ExecutionPlan *plan, const char *alias) {
 
 static OpResult AllNodeScanInit(OpBase *opBase) {
 	AllNodeScan *op = (AllNodeScan *)opBase;
-	if(opBase->childCount > 0) OpBase_UpdateConsume(opBase, AllNodeScanConsumeFromChild);
-	else op->iter = Graph_ScanNodes(QueryCtx_GetGraph());
+	if(opBase->childCount > 0) {
+		OpBase_UpdateConsume(opBase, AllNodeScanConsumeFromChild);
+	} else {
+		Graph *g = QueryCtx_GetGraph();
+		op->iter = Graph_ScanNodes(g);
+		op->sample = ScanSample_New(opBase);
+		op->prefilter = ScanPrefilter_New(opBase, op->alias, Graph_NodeCount(g));
+		if(op->prefilter) OpBase_UpdateConsume(opBase, AllNodeScanConsumePrefiltered);
+		else OpBase_UpdateConsumeBatch(opBase, AllNodeScanConsumeBatch);
+	}
 	return OP_OK;
 }
 
+// returns the next scanned node, skipping blocks left out of the sample
+static inline Entity *_NextNode(AllNodeScan *op, NodeID *id) {
+	Entity *e;
+	while((e = DataBlockIterator_Next(op->iter, id)) != NULL && op->sample) {
+		uint64_t pos = *id;
+		if(ScanSample_Seek(op->sample, &pos, op->iter->_end_pos) && pos == *id) break;
+		DataBlockIterator_Seek(op->iter, pos);
+	}
+	return e;
+}
+
 static Record AllNodeScanConsumeFromChild(OpBase *opBase) {
 	AllNodeScan *op = (AllNodeScan *)opBase;
 
@@ -80,7 +103,7 @@ static Record AllNodeScanConsume(OpBase *opBase) {
 	AllNodeScan *op = (AllNodeScan *)opBase;
 
 	Node n = GE_NEW_NODE();
-	n.entity = (Entity *)DataBlockIterator_Next(op->iter, &n.id);
+	n.entity = _NextNode(op, &n.id);
 	if(n.entity == NULL) return NULL;
 
 	Record r = OpBase_CreateRecord((OpBase *)op);
@@ -89,9 +112,63 @@ static Record AllNodeScanConsume(OpBase *opBase) {
 	return r;
 }
 
+static uint AllNodeScanConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	AllNodeScan *op = (AllNodeScan *)opBase;
+
+	uint n = 0;
+	while(n < cap) {
+		Node node = GE_NEW_NODE();
+		node.entity = _NextNode(op, &node.id);
+		if(node.entity == NULL) break;
+
+		Record r = OpBase_CreateRecord(opBase);
+		Record_AddNode(r, op->nodeRecIdx, node);
+		batch[n++] = r;
+	}
+
+	return n;
+}
+
+// fill the prefilter window with the next block of nodes and evaluate it
+// returns false once all nodes were scanned
+static bool _FillWindow(AllNodeScan *op) {
+	ScanPrefilter *pf = op->prefilter;
+	pf->window_len = 0;
+	while(pf->window_len < pf->window_cap) {
+		Node *n = pf->window + pf->window_len;
+		*n = GE_NEW_NODE();
+		n->entity = _NextNode(op, &n->id);
+		if(n->entity == NULL) break;
+		pf->window_len++;
+	}
+
+	if(pf->window_len == 0) return false;
+	ScanPrefilter_Apply(pf);
+	return true;
+}
+
+static Record AllNodeScanConsumePrefiltered(OpBase *opBase) {
+	AllNodeScan *op = (AllNodeScan *)opBase;
+
+	Node *n;
+	while((n = ScanPrefilter_Next(op->prefilter)) == NULL) {
+		if(!_FillWindow(op)) return NULL;
+	}
+
+	Record r = OpBase_CreateRecord(opBase);
+	Record_AddNode(r, op->nodeRecIdx, *n);
+
+	return r;
+}
+
 static OpResult AllNodeScanReset(OpBase *op) {
 	AllNodeScan *allNodeScan = (AllNodeScan *)op;
 	if(allNodeScan->iter) DataBlockIterator_Reset(allNodeScan->iter);
+	if(allNodeScan->prefilter) ScanPrefilter_Reset(allNodeScan->prefilter);
+	// a reused plan may be executed by a query sampling at another rate
+	if(allNodeScan->sample) ScanSample_Free(allNodeScan->sample);
+	allNodeScan->sample = NULL;
+	if(op->childCount == 0) allNodeScan->sample = ScanSample_New(op);
 	return OP_OK;
 }
 
@@ -111,5 +188,15 @@ static void AllNodeScanFree(OpBase *ctx) {
 		OpBase_DeleteRecord(op->child_record);
 		op->child_record = NULL;
 	}
+
+	if(op->prefilter) {
+		ScanPrefilter_Free(op->prefilter);
+		op->prefilter = NULL;
+	}
+
+	if(op->sample) {
+		ScanSample_Free(op->sample);
+		op->sample = NULL;
+	}
 }
 
@@ -11,6 +11,8 @@
 #include "../../graph/graph.h"
 #include "../../graph/query_graph.h"
 #include "../../graph/entities/node.h"
+#include "shared/scan_sample.h"
+#include "shared/scan_prefilter.h"
 #include "../../util/datablock/datablock_iterator.h"
 
 /* AllNodesScan
@@ -21,6 +23,8 @@ typedef struct {
 	uint nodeRecIdx;
 	DataBlockIterator *iter;
 	Record child_record;        /* The Record this op acts on if it is not a tap. */
+	ScanPrefilter *prefilter;   /* Parallel evaluation of the parent filter, if any. */
+	ScanSample *sample;         /* Blocks scanned by a sampled query, NULL if unsampled. */
 } AllNodeScan;
 
 OpBase *NewAllNodeScanOp(const ExecutionPlan *plan, const char *alias);
@@ -54,7 +54,7 @@ static Record ApplyConsume(OpBase *opBase) {
 			if(!op->r) return NULL; // Bound branch and this op are depleted.
 
 			// Successfully pulled a new Record, propagate to the top of the RHS branch.
-			Argument_AddRecord(op->op_arg, OpBase_CloneRecord(op->r));
+			Argument_AddRecord(op->op_arg, OpBase_ShareRecord(op->r));
 		}
 
 		// Pull a Record from the RHS branch.
@@ -70,8 +70,8 @@ static Record ApplyConsume(OpBase *opBase) {
 			continue;
 		}
 
-		// Clone the bound Record and merge the RHS Record into it.
-		Record r = OpBase_CloneRecord(op->r);
+		// Share the bound Record and merge the RHS Record into it.
+		Record r = OpBase_ShareRecord(op->r);
 		Record_Merge(r, rhs_record);
 		// Delete the RHS record, as it has been merged into r.
 		OpBase_DeleteRecord(rhs_record);
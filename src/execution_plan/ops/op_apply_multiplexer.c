@@ -17,7 +17,7 @@ static void OpApplyMultiplexerFree(OpBase *opBase);
 
 static Record _pullFromBranchStream(OpApplyMultiplexer *op, int branch_index) {
 	// Propegate record to the top of the match stream.
-	Argument_AddRecord(op->branch_arguments[branch_index - 1], OpBase_CloneRecord(op->r));
+	Argument_AddRecord(op->branch_arguments[branch_index - 1], OpBase_ShareRecord(op->r));
 	return OpBase_Consume(op->op.children[branch_index]);
 }
 
@@ -6,6 +6,8 @@
 
 #include "op_cartesian_product.h"
 #include "RG.h"
+#include "../../util/arr.h"
+#include "../execution_plan_build/execution_plan_modify.h"
 
 /* Forward declarations. */
 static OpResult CartesianProductInit(OpBase *opBase);
@@ -18,6 +20,9 @@ OpBase *NewCartesianProductOp(const ExecutionPlan *plan) {
 	CartesianProduct *op = rm_malloc(sizeof(CartesianProduct));
 	op->init = true;
 	op->r = NULL;
+	op->buffers = NULL;
+	op->buffer_count = 0;
+	op->buffered_bytes = 0;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_CARTESIAN_PRODUCT, "Cartesian Product", CartesianProductInit,
@@ -26,89 +31,197 @@ OpBase *NewCartesianProductOp(const ExecutionPlan *plan) {
 	return (OpBase *)op;
 }
 
-static void _ResetStreams(CartesianProduct *cp, int streamIdx) {
-	// Reset each child stream, Reset propagates upwards.
-	for(int i = 0; i < streamIdx; i++) OpBase_PropagateReset(cp->op.children[i]);
+// Returns true if branch i is served from its buffer.
+static inline bool _Buffered(const CartesianProduct *op, uint i) {
+	return i < op->buffer_count && !op->buffers[i].streamed;
 }
 
-static int _PullFromStreams(CartesianProduct *op) {
-	for(int i = 1; i < op->op.childCount; i++) {
-		OpBase *child = op->op.children[i];
-		Record childRecord = OpBase_Consume(child);
-
-		if(childRecord) {
-			Record_TransferEntries(&op->r, childRecord);
-			OpBase_DeleteRecord(childRecord);
-			/* Managed to get new data
-			 * Reset streams [0-i] */
-			_ResetStreams(op, i);
-
-			// Pull from resetted streams.
-			for(int j = 0; j < i; j++) {
-				child = op->op.children[j];
-				childRecord = OpBase_Consume(child);
-				if(childRecord) {
-					Record_TransferEntries(&op->r, childRecord);
-					OpBase_DeleteRecord(childRecord);
-				} else {
-					return 0;
-				}
-			}
-			// Ready to continue.
-			return 1;
+// Drops all materialized records of a buffer.
+static void _Buffer_Clear(CartesianProduct *op, CartesianProductBuffer *b) {
+	uint64_t n = array_len(b->entries);
+	for(uint64_t i = 0; i < n; i++) {
+		if(b->entries[i].type == REC_TYPE_SCALAR) SIValue_Free(b->entries[i].value.s);
+	}
+	op->buffered_bytes -= n * sizeof(Entry);
+	array_clear(b->entries);
+	array_clear(b->idx);
+	b->stride = 0;
+	b->count = 0;
+	b->ready = false;
+}
+
+// Appends the entries set by 'r' to the buffer, taking ownership of its scalars.
+// Returns false if 'r' does not set the entries set by previous records.
+static bool _Buffer_Append(CartesianProductBuffer *b, Record r) {
+	uint len = Record_length(r);
+	if(b->count == 0) {
+		for(uint i = 0; i < len; i++) {
+			if(Record_GetType(r, i) != REC_TYPE_UNKNOWN) array_append(b->idx, i);
+		}
+		b->stride = array_len(b->idx);
+	}
+
+	uint set = 0;
+	for(uint i = 0; i < len; i++) set += (Record_GetType(r, i) != REC_TYPE_UNKNOWN);
+	if(set != b->stride) return false;
+	for(uint i = 0; i < b->stride; i++) {
+		if(Record_GetType(r, b->idx[i]) == REC_TYPE_UNKNOWN) return false;
+	}
+
+	for(uint i = 0; i < b->stride; i++) {
+		Entry *re = Record_GetEntry(r, b->idx[i]);
+		Entry e = *re;
+		if(e.type == REC_TYPE_SCALAR) {
+			// the buffer outlives the record and whatever its volatile values
+			// refer to, own a copy of those and take over the record's allocations
+			SIValue_Persist(&e.value.s);
+			SIValue_MakeVolatile(&re->value.s);
 		}
+		array_append(b->entries, e);
+	}
+	b->count++;
+	return true;
+}
+
+// Consumes branch i entirely into its buffer. If the branch has to be
+// re-executed instead, the branch is reset and marked as streamed.
+static void _Materialize(CartesianProduct *op, uint i) {
+	CartesianProductBuffer *b = op->buffers + i;
+	OpBase *child = op->op.children[i];
+
+	Record r;
+	while((r = OpBase_Consume(child))) {
+		bool appended = _Buffer_Append(b, r);
+		OpBase_DeleteRecord(r);
+		if(appended) op->buffered_bytes += b->stride * sizeof(Entry);
+		if(!appended || op->buffered_bytes > CARTESIAN_PRODUCT_BUFFER_CAP) {
+			// fall back to re-executing the branch
+			_Buffer_Clear(op, b);
+			b->streamed = true;
+			OpBase_PropagateReset(child);
+			return;
+		}
+	}
+	b->ready = true;
+}
+
+// Moves branch i to its next record, returns false if the branch is depleted.
+static bool _Advance(CartesianProduct *op, uint i) {
+	if(_Buffered(op, i)) {
+		CartesianProductBuffer *b = op->buffers + i;
+		if(b->cursor < b->count) b->cursor++;
+		return b->cursor < b->count;
+	}
+
+	Record childRecord = OpBase_Consume(op->op.children[i]);
+	if(!childRecord) return false;
+	Record_TransferEntries(&op->r, childRecord);
+	OpBase_DeleteRecord(childRecord);
+	return true;
+}
+
+// Moves branch i back to its first record, returns false if the branch is empty.
+static bool _Rewind(CartesianProduct *op, uint i) {
+	if(_Buffered(op, i)) {
+		CartesianProductBuffer *b = op->buffers + i;
+		b->cursor = 0;
+		return b->count > 0;
 	}
 
-	/* If we're here, then we didn't manged to get new data.
-	 * Last stream depleted. */
-	return 0;
+	// Reset child stream, Reset propagates upwards.
+	OpBase_PropagateReset(op->op.children[i]);
+	return _Advance(op, i);
+}
+
+// Produces a record out of the current record of each branch.
+static Record _Emit(CartesianProduct *op) {
+	Record r = OpBase_CloneRecord(op->r);
+	for(uint i = 0; i < op->buffer_count; i++) {
+		if(!_Buffered(op, i)) continue;
+		CartesianProductBuffer *b = op->buffers + i;
+		Entry *entries = b->entries + b->cursor * b->stride;
+		for(uint j = 0; j < b->stride; j++) {
+			Entry *e = entries + j;
+			switch(e->type) {
+			case REC_TYPE_NODE:
+				Record_AddNode(r, b->idx[j], e->value.n);
+				break;
+			case REC_TYPE_EDGE:
+				Record_AddEdge(r, b->idx[j], e->value.e);
+				break;
+			default:
+				// buffers are freed on reset, emitted records own their values
+				Record_AddScalar(r, b->idx[j], SI_CloneValue(e->value.s));
+				break;
+			}
+		}
+	}
+	return r;
 }
 
 static OpResult CartesianProductInit(OpBase *opBase) {
 	CartesianProduct *op = (CartesianProduct *)opBase;
 	op->r = OpBase_CreateRecord((OpBase *)op);
+
+	// the last branch is consumed once, it is never buffered
+	ASSERT(op->op.childCount > 0);
+	uint count = op->op.childCount - 1;
+	op->buffers = rm_calloc(count, sizeof(CartesianProductBuffer));
+	op->buffer_count = count;
+	for(uint i = 0; i < count; i++) {
+		CartesianProductBuffer *b = op->buffers + i;
+		b->entries = array_new(Entry, 0);
+		b->idx = array_new(uint, 0);
+		// branches fed by an argument are materialized anew for every input
+		b->correlated = (ExecutionPlan_LocateOp(op->op.children[i], OPType_ARGUMENT) != NULL);
+	}
 	return OP_OK;
 }
 
 static Record CartesianProductConsume(OpBase *opBase) {
 	CartesianProduct *op = (CartesianProduct *)opBase;
-	OpBase *child;
-	Record childRecord;
+	uint count = op->op.childCount;
 
 	if(op->init) {
 		op->init = false;
 
-		for(int i = 0; i < op->op.childCount; i++) {
-			child = op->op.children[i];
-			childRecord = OpBase_Consume(child);
-			if(!childRecord) return NULL;
-			Record_TransferEntries(&op->r, childRecord);
-			OpBase_DeleteRecord(childRecord);
+		// Pull from the last stream first,
+		// sparing the materialization of the others if it is empty.
+		if(!_Advance(op, count - 1)) return NULL;
+
+		for(uint i = 0; i < op->buffer_count; i++) {
+			CartesianProductBuffer *b = op->buffers + i;
+			if(!b->streamed && !b->ready) _Materialize(op, i);
+			if(_Buffered(op, i)) {
+				if(!_Rewind(op, i)) return NULL;
+			} else if(!_Advance(op, i)) {
+				return NULL;
+			}
 		}
-		return OpBase_CloneRecord(op->r);
+		return _Emit(op);
 	}
 
-	// Pull from first stream.
-	child = op->op.children[0];
-	childRecord = OpBase_Consume(child);
-
-	if(childRecord) {
-		// Managed to get data from first stream.
-		Record_TransferEntries(&op->r, childRecord);
-		OpBase_DeleteRecord(childRecord);
-	} else {
-		// Failed to get data from first stream,
-		// try pulling other streams for data.
-		if(!_PullFromStreams(op)) return NULL;
+	// Advance the first branch which is not depleted,
+	// and rewind all branches before it.
+	uint i = 0;
+	while(i < count && !_Advance(op, i)) i++;
+	if(i == count) return NULL;
+	for(uint j = 0; j < i; j++) {
+		if(!_Rewind(op, j)) return NULL;
 	}
 
-	// Pass down a clone of record.
-	return OpBase_CloneRecord(op->r);
+	return _Emit(op);
 }
 
 static OpResult CartesianProductReset(OpBase *opBase) {
 	CartesianProduct *op = (CartesianProduct *)opBase;
 	op->init = true;
+
+	// Buffers of uncorrelated branches remain valid.
+	for(uint i = 0; i < op->buffer_count; i++) {
+		CartesianProductBuffer *b = op->buffers + i;
+		if(b->correlated) _Buffer_Clear(op, b);
+	}
 	return OP_OK;
 }
 
@@ -123,5 +236,16 @@ static void CartesianProductFree(OpBase *opBase) {
 		OpBase_DeleteRecord(op->r);
 		op->r = NULL;
 	}
-}
 
+	if(op->buffers) {
+		for(uint i = 0; i < op->buffer_count; i++) {
+			CartesianProductBuffer *b = op->buffers + i;
+			_Buffer_Clear(op, b);
+			array_free(b->entries);
+			array_free(b->idx);
+		}
+		rm_free(op->buffers);
+		op->buffers = NULL;
+		op->buffer_count = 0;
+	}
+}
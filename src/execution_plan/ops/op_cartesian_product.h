@@ -9,11 +9,35 @@
 #include "op.h"
 #include "../execution_plan.h"
 
-/* Cartesian product AKA Join. */
+// max memory, in bytes, held by the buffers of a single cartesian product
+#define CARTESIAN_PRODUCT_BUFFER_CAP (16 * 1024 * 1024)
+
+// records of a cartesian product branch, materialized once
+// rather than re-executing the branch for every combination of the
+// branches following it, only the entries set by the branch are kept
+typedef struct {
+	Entry *entries;    // materialized entries, 'stride' per record
+	uint *idx;         // record position of each of the 'stride' entries
+	uint stride;       // number of entries set by each branch record
+	uint64_t count;    // number of materialized records
+	uint64_t cursor;   // current record
+	bool ready;        // buffer holds all of the branch records
+	bool correlated;   // branch depends on input records, rebuilt on reset
+	bool streamed;     // branch is re-executed rather than materialized
+} CartesianProductBuffer;
+
+/* Cartesian product AKA Join.
+ * Branch i is iterated once per combination of branches [i+1, n),
+ * all branches but the last are materialized the first time they're consumed.
+ * A branch exceeding CARTESIAN_PRODUCT_BUFFER_CAP, or whose records do not
+ * set a consistent set of entries, is re-executed instead. */
 typedef struct {
 	OpBase op;
-	Record r;
+	Record r;                         // current record of re-executed branches
 	bool init;
+	CartesianProductBuffer *buffers;  // buffer of each branch but the last
+	uint buffer_count;                // number of buffers
+	size_t buffered_bytes;            // memory held by buffers
 } CartesianProduct;
 
 OpBase *NewCartesianProductOp(const ExecutionPlan *plan);
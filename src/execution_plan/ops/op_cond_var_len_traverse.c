@@ -13,6 +13,9 @@
 #include "../../algorithms/all_paths.h"
 #include "../../query_ctx.h"
 
+// number of source records traversed at once when only reachable nodes are required
+#define REACH_BATCH_SIZE 256
+
 /* Forward declarations. */
 static Record CondVarLenTraverseConsume(OpBase *opBase);
 static OpResult CondVarLenTraverseReset(OpBase *opBase);
@@ -78,6 +81,13 @@ void CondVarLenTraverseOp_ExpandInto(CondVarLenTraverse *op) {
 	op->op.name = "Conditional Variable Length Traverse (Expand Into)";
 }
 
+void CondVarLenTraverseOp_ReachOnly(CondVarLenTraverse *op) {
+	ASSERT(op != NULL);
+	ASSERT(op->edgesIdx < 0 && op->ft == NULL);
+	op->reachOnly = true;
+	if(!op->records) op->records = rm_calloc(REACH_BATCH_SIZE, sizeof(Record));
+}
+
 inline void CondVarLenTraverseOp_SetFilter(CondVarLenTraverse *op,
 										   FT_FilterNode *ft) {
 	ASSERT(op != NULL);
@@ -98,6 +108,10 @@ OpBase *NewCondVarLenTraverseOp(const ExecutionPlan *plan, Graph *g, AlgebraicEx
 	op->ft = NULL;
 	op->expandInto = false;
 	op->allPathsCtx = NULL;
+	op->reachOnly = false;
+	op->reachCtx = NULL;
+	op->records = NULL;
+	op->record_count = 0;
 	op->edgeRelationTypes = NULL;
 
 	OpBase_Init((OpBase *)op, OPType_CONDITIONAL_VAR_LEN_TRAVERSE,
@@ -117,11 +131,88 @@ OpBase *NewCondVarLenTraverseOp(const ExecutionPlan *plan, Graph *g, AlgebraicEx
 	return (OpBase *)op;
 }
 
+// Releases the batch of source records.
+static void _ReachableNodesClearBatch(CondVarLenTraverse *op) {
+	for(uint i = 0; i < op->record_count; i++) OpBase_DeleteRecord(op->records[i]);
+	op->record_count = 0;
+}
+
+// Produces a record for every node reachable from each source node,
+// source records are accumulated and traversed as a batch.
+static Record _ReachableNodesConsume(CondVarLenTraverse *op) {
+	uint src_idx;
+	NodeID id;
+	OpBase *child = op->op.children[0];
+
+	while(!op->reachCtx || !ReachableNodesCtx_Next(op->reachCtx, &src_idx, &id)) {
+		_ReachableNodesClearBatch(op);
+
+		NodeID srcs[REACH_BATCH_SIZE];
+		NodeID dsts[REACH_BATCH_SIZE];
+
+		// Ask child operations for data, no more than required by our consumer.
+		uint batch_size = OpBase_BatchSize((OpBase *)op, REACH_BATCH_SIZE);
+		while(op->record_count < batch_size) {
+			Record childRecord = OpBase_Consume(child);
+			// If the Record is NULL, the child has been depleted.
+			if(!childRecord) break;
+
+			/* The child Record may not contain the source node in scenarios like
+			 * a failed OPTIONAL MATCH. In this case, delete the Record and try again. */
+			Node *srcNode = Record_GetNode(childRecord, op->srcNodeIdx);
+			Node *destNode = op->expandInto ? Record_GetNode(childRecord, op->destNodeIdx) : NULL;
+			if(srcNode == NULL || (op->expandInto && destNode == NULL)) {
+				OpBase_DeleteRecord(childRecord);
+				continue;
+			}
+
+			srcs[op->record_count] = ENTITY_GET_ID(srcNode);
+			if(destNode) dsts[op->record_count] = ENTITY_GET_ID(destNode);
+
+			// Records are retained while the child produces the rest of the batch.
+			Record_PersistScalars(childRecord);
+			op->records[op->record_count++] = childRecord;
+		}
+
+		// No data.
+		if(op->record_count == 0) return NULL;
+
+		if(!op->edgeRelationTypes) {
+			_setupTraversedRelations(op);
+			if(op->edgeRelationCount == 0 && op->minHops > 0) {
+				_ReachableNodesClearBatch(op);
+				return NULL;
+			}
+		}
+
+		if(!op->reachCtx) {
+			op->reachCtx = ReachableNodesCtx_New(op->g, op->edgeRelationTypes,
+												 op->edgeRelationCount, op->traverseDir,
+												 op->minHops, op->maxHops, REACH_BATCH_SIZE);
+		}
+		ReachableNodesCtx_Reset(op->reachCtx, srcs, op->expandInto ? dsts : NULL,
+								op->record_count);
+	}
+
+	Record r = OpBase_CloneRecord(op->records[src_idx]);
+
+	// add destination node to record
+	if(!op->expandInto) {
+		Node dest = GE_NEW_NODE();
+		Graph_GetNode(op->g, id, &dest);
+		Record_AddNode(r, op->destNodeIdx, dest);
+	}
+
+	return r;
+}
+
 static Record CondVarLenTraverseConsume(OpBase *opBase) {
 	CondVarLenTraverse  *op     =  (CondVarLenTraverse *)opBase;
 	Path                *p      =  NULL;
 	OpBase              *child  =  op->op.children[0];
 
+	if(op->reachOnly) return _ReachableNodesConsume(op);
+
 	while(!(p = AllPathsCtx_NextPath(op->allPathsCtx))) {
 		Record childRecord = OpBase_Consume(child);
 		if(!childRecord) return NULL;
@@ -183,6 +274,9 @@ static OpResult CondVarLenTraverseReset(OpBase *ctx) {
 	}
 	AllPathsCtx_Free(op->allPathsCtx);
 	op->allPathsCtx = NULL;
+	ReachableNodesCtx_Free(op->reachCtx);
+	op->reachCtx = NULL;
+	_ReachableNodesClearBatch(op);
 	return OP_OK;
 }
 
@@ -191,6 +285,7 @@ static OpBase *CondVarLenTraverseClone(const ExecutionPlan *plan, const OpBase *
 	CondVarLenTraverse *op = (CondVarLenTraverse *) opBase;
 	OpBase *op_clone = NewCondVarLenTraverseOp(plan, QueryCtx_GetGraph(),
 											   AlgebraicExpression_Clone(op->ae));
+	if(op->reachOnly) CondVarLenTraverseOp_ReachOnly((CondVarLenTraverse *)op_clone);
 	return op_clone;
 }
 
@@ -217,6 +312,17 @@ static void CondVarLenTraverseFree(OpBase *ctx) {
 		op->allPathsCtx = NULL;
 	}
 
+	if(op->reachCtx) {
+		ReachableNodesCtx_Free(op->reachCtx);
+		op->reachCtx = NULL;
+	}
+
+	if(op->records) {
+		_ReachableNodesClearBatch(op);
+		rm_free(op->records);
+		op->records = NULL;
+	}
+
 	if(op->ft) {
 		FilterTree_Free(op->ft);
 		op->ft = NULL;
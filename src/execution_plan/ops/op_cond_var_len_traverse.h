@@ -28,6 +28,10 @@ typedef struct {
 	int edgeRelationCount;          /* Length of edgeRelationTypes. */
 	int *edgeRelationTypes;         /* Relation(s) we're traversing. */
 	AllPathsCtx *allPathsCtx;
+	bool reachOnly;                 /* Only distinct reachable nodes are required, not paths. */
+	ReachableNodesCtx *reachCtx;    /* Computes reachable nodes, used when reachOnly is set. */
+	Record *records;                /* Batch of source records traversed by reachCtx. */
+	uint record_count;              /* Number of records in batch. */
 	GRAPH_EDGE_DIR traverseDir;     /* Traverse direction. */
 } CondVarLenTraverse;
 
@@ -37,6 +41,11 @@ OpBase *NewCondVarLenTraverseOp(const ExecutionPlan *plan, Graph *g, AlgebraicEx
  * to Expand Into Conditional Variable Length Traverse */
 void CondVarLenTraverseOp_ExpandInto(CondVarLenTraverse *op);
 
+/* Report each node reachable from the source node once,
+ * rather than once per path leading to it.
+ * Applicable only when neither the paths nor their multiplicity are required. */
+void CondVarLenTraverseOp_ReachOnly(CondVarLenTraverse *op);
+
 // Set the FilterTree pointer of a CondVarLenTraverse operation.
 void CondVarLenTraverseOp_SetFilter(CondVarLenTraverse *op, FT_FilterNode *ft);
 
@@ -6,11 +6,18 @@
 
 #include "op_conditional_traverse.h"
 #include "RG.h"
+#include "op_filter.h"
 #include "shared/print_functions.h"
 #include "../../query_ctx.h"
+#include "../../arithmetic/arithmetic_op.h"
+#include <math.h>
 
 // default number of records to accumulate before traversing
 #define BATCH_SIZE 16
+// max number of records to accumulate before traversing
+#define MAX_BATCH_SIZE 1024
+// desired number of connections discovered by a single traversal
+#define BATCH_TARGET_OUTPUT 4096
 
 /* Forward declarations. */
 static OpResult CondTraverseInit(OpBase *opBase);
@@ -20,7 +27,36 @@ static OpBase *CondTraverseClone(const ExecutionPlan *plan, const OpBase *opBase
 static void CondTraverseFree(OpBase *opBase);
 
 static int CondTraverseToString(const OpBase *ctx, char *buf, uint buf_len) {
-	return TraversalToString(ctx, buf, buf_len, ((const OpCondTraverse *)ctx)->ae);
+	const OpCondTraverse *op = (const OpCondTraverse *)ctx;
+	int offset = TraversalToString(ctx, buf, buf_len, op->ae);
+	// report the batch size picked at runtime when profiling
+	if(ctx->stats) {
+		offset += snprintf(buf + offset, buf_len - offset, " | Batch size: %u",
+						   op->batch_size);
+		if(op->W != GrB_NULL) {
+			offset += snprintf(buf + offset, buf_len - offset, " | Weight filtered");
+		}
+	}
+	return offset;
+}
+
+/* Adjust the number of records accumulated before each traversal
+ * according to the last traversal's output density.
+ * Sparse outputs (e.g. 1-hop lookups) double the batch size, such that
+ * the cost of evaluating the expression is shared by more records,
+ * dense outputs (large fan-out) halve it, keeping M small. */
+static void _tune_batch_size(OpCondTraverse *op) {
+	// child ran out of data before the batch was filled, nothing to learn
+	if(op->record_count < op->batch_size) return;
+
+	GrB_Index nvals = 0;
+	GrB_Matrix_nvals(&nvals, op->M);
+
+	if(nvals < BATCH_TARGET_OUTPUT / 2) {
+		op->batch_size = MIN(op->batch_size * 2, op->record_cap);
+	} else if(nvals > BATCH_TARGET_OUTPUT * 2) {
+		op->batch_size = MAX(op->batch_size / 2, 1);
+	}
 }
 
 static void _populate_filter_matrix(OpCondTraverse *op) {
@@ -34,6 +70,193 @@ static void _populate_filter_matrix(OpCondTraverse *op) {
 	}
 }
 
+// returns true if op or any operation beneath it is a writer
+static bool _has_writer(const OpBase *op) {
+	if(op->writer) return true;
+	for(int i = 0; i < op->childCount; i++) {
+		if(_has_writer(op->children[i])) return true;
+	}
+	return false;
+}
+
+// returns the single operand of 'edge', NULL if there are several
+static AlgebraicExpression *_edge_operand(AlgebraicExpression *root,
+		const char *edge, uint *count) {
+	if(root->type == AL_OPERAND) {
+		if(root->operand.edge == NULL || strcmp(root->operand.edge, edge) != 0) {
+			return NULL;
+		}
+		(*count)++;
+		return root;
+	}
+
+	AlgebraicExpression *operand = NULL;
+	uint child_count = AlgebraicExpression_ChildCount(root);
+	for(uint i = 0; i < child_count; i++) {
+		AlgebraicExpression *o = _edge_operand(root->operation.children[i], edge, count);
+		if(o != NULL) operand = o;
+	}
+	return (*count == 1) ? operand : NULL;
+}
+
+// narrows S by each comparison of the form alias.attr <op> constant
+// conjoined in the filter tree, returns true if any comparison applied
+static bool _select_weights(const FT_FilterNode *root, const char *alias,
+		GraphContext *gc, const WeightMatrix *w, GrB_Matrix *S) {
+	if(root->t == FT_N_COND) {
+		// either side of a conjunction is a necessary condition
+		if(root->cond.op != OP_AND) return false;
+		bool l = _select_weights(root->cond.left, alias, gc, w, S);
+		bool r = _select_weights(root->cond.right, alias, gc, w, S);
+		return l || r;
+	}
+	if(root->t != FT_N_PRED) return false;
+
+	// normalize: attribute lookup on the left, value on the right
+	char *attr = NULL;
+	AR_ExpNode *val = NULL;
+	AST_Operator op = root->pred.op;
+	const AR_ExpNode *lhs = root->pred.lhs;
+	const AR_ExpNode *rhs = root->pred.rhs;
+	if(AR_EXP_IsAttribute(lhs, &attr) && AR_EXP_IsVariadic(lhs->op.children[0]) &&
+	   strcmp(lhs->op.children[0]->operand.variadic.entity_alias, alias) == 0) {
+		val = root->pred.rhs;
+	} else if(AR_EXP_IsAttribute(rhs, &attr) && AR_EXP_IsVariadic(rhs->op.children[0]) &&
+			  strcmp(rhs->op.children[0]->operand.variadic.entity_alias, alias) == 0) {
+		val = root->pred.lhs;
+		op = ArithmeticOp_ReverseOp(op);
+	} else {
+		return false;
+	}
+
+	if(GraphContext_GetAttributeID(gc, attr) != w->attr) return false;
+	if(!AR_EXP_IsConstant(val) && !AR_EXP_IsParameter(val)) return false;
+
+	SIValue v = AR_EXP_Evaluate(val, NULL);
+	if(!(SI_TYPE(v) & SI_NUMERIC)) return false;
+	double constant = SI_GET_NUMERIC(v);
+	if(isnan(constant)) return false;
+
+	GxB_SelectOp select;
+	switch(op) {
+	case OP_EQUAL:
+		select = GxB_EQ_THUNK;
+		break;
+	case OP_LT:
+		select = GxB_LT_THUNK;
+		break;
+	case OP_LE:
+		select = GxB_LE_THUNK;
+		break;
+	case OP_GT:
+		select = GxB_GT_THUNK;
+		break;
+	case OP_GE:
+		select = GxB_GE_THUNK;
+		break;
+	default:
+		return false;
+	}
+	return WeightMatrix_Select(w, select, constant, S);
+}
+
+// evaluates the parent filter's comparisons on the traversed edge's
+// promoted attribute within GraphBLAS, replacing the relation matrix
+// operand by the pairs connected by at least one edge which may pass them
+// the filter remains in place, evaluating each collected edge
+static void _apply_weight_filter(OpCondTraverse *op) {
+	const OpBase *parent = op->op.parent;
+	if(op->edge_ctx == NULL || parent == NULL || parent->type != OPType_FILTER) {
+		return;
+	}
+
+	// a single relationship type, traversed in a single direction
+	EdgeTraverseCtx *edge_ctx = op->edge_ctx;
+	if(array_len(edge_ctx->edgeRelationTypes) != 1) return;
+	int relation = edge_ctx->edgeRelationTypes[0];
+	if(relation == GRAPH_NO_RELATION) return;
+	if(edge_ctx->direction == GRAPH_EDGE_DIR_BOTH) return;
+
+	// queries modifying the graph might invalidate the selection mid-traversal
+	const OpBase *root = (const OpBase *)op;
+	while(root->parent) root = root->parent;
+	if(_has_writer(root)) return;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchemaByID(gc, relation, SCHEMA_EDGE);
+	if(s == NULL) return;
+	const WeightMatrix *w = Schema_GetWeights(s, op->graph);
+	if(w == NULL) return;
+
+	// the edge operand must still refer to the relation matrix
+	uint count = 0;
+	const char *edge = AlgebraicExpression_Edge(op->ae);
+	AlgebraicExpression *operand = _edge_operand(op->ae, edge, &count);
+	if(operand == NULL || operand->operand.bfree || operand->operand.diagonal) return;
+	GrB_Matrix R = operand->operand.matrix;
+	if(R != GrB_NULL && R != Graph_GetRelationMatrix(op->graph, relation)) return;
+
+	const FT_FilterNode *tree = ((const OpFilter *)parent)->filterTree;
+	if(!_select_weights(tree, edge, gc, w, &op->W)) {
+		if(op->W != GrB_NULL) GrB_Matrix_free(&op->W);
+		op->W = GrB_NULL;
+		return;
+	}
+
+	operand->operand.matrix = op->W;
+}
+
+// prepares the expression's product, excluding F, for caching across queries
+// expressions of a single operand aren't cached, as no product is computed
+static void _prepare_product(OpCondTraverse *op) {
+	if(!ProductCache_Enabled() || op->ae->type != AL_OPERATION) return;
+	// filtered products are specific to the query's constants
+	if(op->W != GrB_NULL) return;
+
+	op->product_key = AlgebraicExpression_CanonicalString(op->ae);
+	if(op->product_key == NULL) return;
+
+	op->product = AlgebraicExpression_Clone(op->ae);
+	AlgebraicExpression_Optimize(&op->product);
+	if(op->product->type != AL_OPERATION) {
+		AlgebraicExpression_Free(op->product);
+		rm_free(op->product_key);
+		op->product = NULL;
+		op->product_key = NULL;
+	}
+}
+
+// evaluates M = F * P, where P is the expression's product excluding F
+// shared across queries through the graph's product cache
+// returns false if the product isn't cached
+static bool _eval_cached_product(OpCondTraverse *op) {
+	if(op->product == NULL) return false;
+	// the graph is modified while write locked,
+	// products computed by writers aren't shared
+	if(op->graph->_writelocked) return false;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	uint64_t version = Graph_WriteEpoch(op->graph);
+	ProductCacheEntry *entry = ProductCache_Acquire(gc->product_cache,
+			op->product_key, version);
+
+	if(entry == NULL) {
+		GrB_Matrix P;
+		GrB_Index dim = Graph_RequiredMatrixDim(op->graph);
+		GrB_Matrix_new(&P, GrB_BOOL, dim, dim);
+		AlgebraicExpression_Eval(op->product, P);
+		entry = ProductCache_Insert(gc->product_cache, op->product_key, version, P);
+	}
+
+	GrB_Info info = GrB_mxm(op->M, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, op->F,
+			ProductCacheEntry_Matrix(entry), GrB_NULL);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	ProductCache_Release(gc->product_cache, entry);
+	return true;
+}
+
 /* Evaluate algebraic expression:
  * prepends filter matrix as the left most operand
  * perform multiplications
@@ -50,6 +273,9 @@ void _traverse(OpCondTraverse *op) {
 		GrB_Matrix_new(&op->F, GrB_BOOL, op->record_cap, required_dim);
 		GxB_set(op->M, GxB_SPARSITY_CONTROL, GxB_SPARSE);
 
+		_apply_weight_filter(op);
+		_prepare_product(op);
+
 		// Prepend the filter matrix to algebraic expression as the leftmost operand.
 		AlgebraicExpression_MultiplyToTheLeft(&op->ae, op->F);
 
@@ -61,13 +287,18 @@ void _traverse(OpCondTraverse *op) {
 	_populate_filter_matrix(op);
 
 	// Evaluate expression.
-	AlgebraicExpression_Eval(op->ae, op->M);
+	if(!_eval_cached_product(op)) AlgebraicExpression_Eval(op->ae, op->M);
 
 	if(op->iter == NULL) GxB_MatrixTupleIter_new(&op->iter, op->M);
 	else GxB_MatrixTupleIter_reuse(op->iter, op->M);
+	op->col_count = 0;
+	op->col_idx = 0;
 
 	// Clear filter matrix.
 	GrB_Matrix_clear(op->F);
+
+	// Pick the number of records to accumulate for the next traversal.
+	_tune_batch_size(op);
 }
 
 OpBase *NewCondTraverseOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae) {
@@ -76,13 +307,21 @@ OpBase *NewCondTraverseOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpressi
 	op->ae = ae;
 	op->r = NULL;
 	op->iter = NULL;
+	op->row = 0;
+	op->cols = NULL;
+	op->col_count = 0;
+	op->col_idx = 0;
 	op->F = GrB_NULL;
 	op->M = GrB_NULL;
+	op->product = NULL;
+	op->product_key = NULL;
 	op->records = NULL;
 	op->record_count = 0;
 	op->edge_ctx = NULL;
+	op->W = GrB_NULL;
 	op->dest_label = NULL;
-	op->record_cap = BATCH_SIZE;
+	op->batch_size = BATCH_SIZE;
+	op->record_cap = MAX_BATCH_SIZE;
 	op->dest_label_id = GRAPH_NO_LABEL;
 
 	// Set our Op operations
@@ -117,9 +356,11 @@ static OpResult CondTraverseInit(OpBase *opBase) {
 	OpCondTraverse *op = (OpCondTraverse *)opBase;
 	// Create 'records' with this Init function as 'record_cap'
 	// might be set during optimization time (applyLimit)
-	// If cap greater than BATCH_SIZE is specified,
-	// use BATCH_SIZE as the value.
-	if(op->record_cap > BATCH_SIZE) op->record_cap = BATCH_SIZE;
+	// If cap greater than MAX_BATCH_SIZE is specified,
+	// use MAX_BATCH_SIZE as the value.
+	// The batch size grows and shrinks within [1, record_cap] at runtime.
+	if(op->record_cap > MAX_BATCH_SIZE) op->record_cap = MAX_BATCH_SIZE;
+	if(op->batch_size > op->record_cap) op->batch_size = op->record_cap;
 	op->records = rm_calloc(op->record_cap, sizeof(Record));
 	return OP_OK;
 }
@@ -135,15 +376,19 @@ static Record CondTraverseConsume(OpBase *opBase) {
 	 * Otherwise, try to get a new pair of source and destination nodes. */
 	if(op->edge_ctx && Traverse_SetEdge(op->edge_ctx, op->r)) return OpBase_CloneRecord(op->r);
 
-	bool depleted = true;
-	NodeID src_id = INVALID_ENTITY_ID;
-	NodeID dest_id = INVALID_ENTITY_ID;
-
 	while(true) {
-		if(op->iter) GxB_MatrixTupleIter_next(op->iter, &src_id, &dest_id, &depleted);
-
-		// Managed to get a tuple, break.
-		if(!depleted) break;
+		// Columns left in the current row, break.
+		if(op->col_idx < op->col_count) break;
+
+		// Move on to the next row, consuming its columns in place.
+		bool depleted = true;
+		if(op->iter) {
+			op->col_idx = 0;
+			GxB_MatrixTupleIter_next_row(op->iter, &op->row, &op->cols, NULL,
+					&op->col_count, &depleted);
+		}
+		if(!depleted) continue;
+		op->col_count = 0;
 
 		/* Run out of tuples, try to get new data.
 		 * Free old records. */
@@ -151,7 +396,7 @@ static Record CondTraverseConsume(OpBase *opBase) {
 		for(uint i = 0; i < op->record_count; i++) OpBase_DeleteRecord(op->records[i]);
 
 		// Ask child operations for data.
-		for(op->record_count = 0; op->record_count < op->record_cap; op->record_count++) {
+		for(op->record_count = 0; op->record_count < op->batch_size; op->record_count++) {
 			Record childRecord = OpBase_Consume(child);
 			// If the Record is NULL, the child has been depleted.
 			if(!childRecord) break;
@@ -174,8 +419,13 @@ static Record CondTraverseConsume(OpBase *opBase) {
 		_traverse(op);
 	}
 
+	NodeID dest_id = op->cols[op->col_idx++];
+	if(op->col_idx + DATABLOCK_PREFETCH_DISTANCE < op->col_count) {
+		Graph_PrefetchNode(op->graph, op->cols[op->col_idx + DATABLOCK_PREFETCH_DISTANCE]);
+	}
+
 	/* Get node from current column. */
-	op->r = op->records[src_id];
+	op->r = op->records[op->row];
 	/* Populate the destination node and add it to the Record.
 	 * Note that if the node's label is unknown, this will correctly
 	 * create an unlabeled node. */
@@ -209,6 +459,8 @@ static OpResult CondTraverseReset(OpBase *ctx) {
 		GxB_MatrixTupleIter_free(op->iter);
 		op->iter = NULL;
 	}
+	op->col_count = 0;
+	op->col_idx = 0;
 	if(op->F != GrB_NULL) GrB_Matrix_clear(op->F);
 	return OP_OK;
 }
@@ -237,11 +489,27 @@ static void CondTraverseFree(OpBase *ctx) {
 		op->M = GrB_NULL;
 	}
 
+	// W is referenced by the expression but owned by the operation
 	if(op->ae) {
 		AlgebraicExpression_Free(op->ae);
 		op->ae = NULL;
 	}
 
+	if(op->W != GrB_NULL) {
+		GrB_Matrix_free(&op->W);
+		op->W = GrB_NULL;
+	}
+
+	if(op->product) {
+		AlgebraicExpression_Free(op->product);
+		op->product = NULL;
+	}
+
+	if(op->product_key) {
+		rm_free(op->product_key);
+		op->product_key = NULL;
+	}
+
 	if(op->edge_ctx) {
 		Traverse_FreeEdgeCtx(op->edge_ctx);
 		op->edge_ctx = NULL;
@@ -19,14 +19,22 @@ typedef struct {
 	AlgebraicExpression *ae;
 	GrB_Matrix F;               // Filter matrix.
 	GrB_Matrix M;               // Algebraic expression result.
+	AlgebraicExpression *product;  // Expression without F, cached across queries, may be NULL.
+	char *product_key;          // Canonical form of product, keys the graph's product cache.
 	NodeID dest_label_id;       // ID of destination node label if known.
 	const char *dest_label;     // Label of destination node if known.
 	EdgeTraverseCtx *edge_ctx;  // Edge collection data if the edge needs to be set.
+	GrB_Matrix W;               // Pairs with an edge which may pass the parent filter, NULL if unused.
 	GxB_MatrixTupleIter *iter;  // Iterator over M.
+	GrB_Index row;              // Row of M currently consumed, indexes records.
+	const GrB_Index *cols;      // Columns of the current row, within M.
+	GrB_Index col_count;        // Number of columns in the current row.
+	GrB_Index col_idx;          // Next column to consume.
 	int srcNodeIdx;             // Source node index into record.
 	int destNodeIdx;            // Destination node index into record.
 	uint record_count;          // Number of held records.
 	uint record_cap;            // Max number of records to process.
+	uint batch_size;            // Current number of records to accumulate.
 	Record *records;            // Array of records.
 	Record r;                   // Currently selected record.
 } OpCondTraverse;
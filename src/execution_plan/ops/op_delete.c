@@ -7,7 +7,10 @@
 #include "./op_delete.h"
 #include "../../errors.h"
 #include "../../util/arr.h"
+#include "../../util/qsort.h"
+#include "../../config.h"
 #include "../../query_ctx.h"
+#include "../../index/index_batch.h"
 #include "../../arithmetic/arithmetic_expression.h"
 
 /* Forward declarations. */
@@ -16,10 +19,82 @@ static OpResult DeleteInit(OpBase *opBase);
 static OpBase *DeleteClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void DeleteFree(OpBase *opBase);
 
-void _DeleteEntities(OpDelete *op) {
-	Graph *g = op->gc->g;
+#define ENTITY_ISLT_BY_ID(a, b) (ENTITY_GET_ID((a)) < ENTITY_GET_ID((b)))
+
+// Sorts nodes by ID and drops duplicates, returns the number of unique nodes.
+static uint _DedupeNodes(Node *nodes, uint count) {
+	if(count == 0) return 0;
+	QSORT(Node, nodes, count, ENTITY_ISLT_BY_ID);
+	uint unique = 1;
+	for(uint i = 1; i < count; i++) {
+		if(ENTITY_GET_ID(nodes + i) == ENTITY_GET_ID(nodes + unique - 1)) continue;
+		nodes[unique++] = nodes[i];
+	}
+	return unique;
+}
+
+// Sorts edges by ID and drops duplicates, returns the number of unique edges.
+static uint _DedupeEdges(Edge *edges, uint count) {
+	if(count == 0) return 0;
+	QSORT(Edge, edges, count, ENTITY_ISLT_BY_ID);
+	uint unique = 1;
+	for(uint i = 1; i < count; i++) {
+		if(ENTITY_GET_ID(edges + i) == ENTITY_GET_ID(edges + unique - 1)) continue;
+		edges[unique++] = edges[i];
+	}
+	return unique;
+}
+
+/* Requests the removal of an indexed node from its label's indices. */
+static void _RemoveNodeFromIndices(GraphContext *gc, IndexBatch *batch, Node *n) {
+	// Node will have a label string if one was specified in the query MATCH clause
+	Schema *s = (n->label) ? GraphContext_GetSchema(gc, n->label, SCHEMA_NODE) : NULL;
+	if(s == NULL) {
+		int label_id = NODE_GET_LABEL_ID(n, gc->g);
+		// Do nothing if node had no label
+		if(label_id == GRAPH_NO_LABEL) return;
+		s = GraphContext_GetSchemaByID(gc, label_id, SCHEMA_NODE);
+	}
+	if(s && Schema_HasIndices(s)) IndexBatch_RemoveNode(batch, s->id, ENTITY_GET_ID(n));
+}
+
+/* Deletes a chunk of entities, statistics are updated per chunk
+ * as they determine whether a chunk's changes are committed. */
+static void _DeleteChunk(OpDelete *op, Node *nodes, uint node_count, Edge *edges,
+						 uint edge_count) {
 	uint node_deleted = 0;
 	uint relationships_deleted = 0;
+	IndexBatch *batch = QueryCtx_GetIndexBatch();
+
+	if(GraphContext_HasIndices(op->gc)) {
+		/* Removed nodes are collected per label and removed from each
+		 * index at once, once the chunk is deleted, see IndexBatch_Apply. */
+		for(uint i = 0; i < node_count; i++) {
+			_RemoveNodeFromIndices(op->gc, batch, nodes + i);
+		}
+		/* Edges removed along with their endpoints are left in relationship
+		 * indices, index scans validate edges against the graph. */
+		for(uint i = 0; i < edge_count; i++) {
+			GraphContext_DeleteEdgeFromIndices(op->gc, edges + i);
+		}
+	}
+
+	// Record the deletion for replication, while edges are still resolvable.
+	EffectsBuffer *effects = QueryCtx_GetEffects();
+	if(effects) EffectsBuffer_AddDelete(effects, op->gc, nodes, node_count, edges, edge_count);
+
+	Graph_BulkDelete(op->gc->g, nodes, node_count, edges, edge_count, &node_deleted,
+					 &relationships_deleted);
+	IndexBatch_Apply(batch, op->gc);
+
+	if(op->stats) {
+		op->stats->nodes_deleted += node_deleted;
+		op->stats->relationships_deleted += relationships_deleted;
+	}
+}
+
+void _DeleteEntities(OpDelete *op) {
+	Graph *g = op->gc->g;
 	uint node_count = array_len(op->deleted_nodes);
 	uint edge_count = array_len(op->deleted_edges);
 
@@ -27,21 +102,47 @@ void _DeleteEntities(OpDelete *op) {
 	if((node_count + edge_count) == 0) goto cleanup;
 
 	/* Lock everything. */
-	QueryCtx_LockForCommit();
+	if(!QueryCtx_LockForCommit()) goto cleanup;
 
-	if(GraphContext_HasIndices(op->gc)) {
-		for(int i = 0; i < node_count; i++) {
-			Node *n = op->deleted_nodes + i;
-			GraphContext_DeleteNodeFromIndices(op->gc, n);
+	uint64_t chunk_size;
+	Config_Option_get(Config_DELETE_CHUNK_SIZE, &chunk_size);
+
+	if(chunk_size == 0 || node_count + edge_count <= chunk_size) {
+		_DeleteChunk(op, op->deleted_nodes, node_count, op->deleted_edges, edge_count);
+		goto cleanup;
+	}
+
+	/* Delete in chunks, committing each chunk and releasing the locks
+	 * in between, such that readers aren't blocked for the entire deletion.
+	 * As chunks must not overlap, drop duplicates up front. */
+	node_count = _DedupeNodes(op->deleted_nodes, node_count);
+	edge_count = _DedupeEdges(op->deleted_edges, edge_count);
+
+	bool locked = true;
+	for(uint i = 0; i < node_count && locked; i += chunk_size) {
+		uint n = (node_count - i < chunk_size) ? node_count - i : chunk_size;
+		// Yield before every chunk but the first.
+		if(i > 0) locked = QueryCtx_YieldCommit();
+		if(locked) {
+			_DeleteChunk(op, op->deleted_nodes + i, n, NULL, 0);
 		}
 	}
 
-	Graph_BulkDelete(g, op->deleted_nodes, node_count, op->deleted_edges,
-					 edge_count, &node_deleted, &relationships_deleted);
+	// Drop edges which were removed along with their endpoints.
+	uint remaining = 0;
+	for(uint i = 0; i < edge_count && locked; i++) {
+		Edge *e = op->deleted_edges + i;
+		if(!DataBlock_GetItem(g->nodes, Edge_GetSrcNodeID(e)) ||
+		   !DataBlock_GetItem(g->nodes, Edge_GetDestNodeID(e))) continue;
+		op->deleted_edges[remaining++] = *e;
+	}
 
-	if(op->stats) {
-		op->stats->nodes_deleted += node_deleted;
-		op->stats->relationships_deleted += relationships_deleted;
+	for(uint i = 0; i < remaining && locked; i += chunk_size) {
+		uint n = (remaining - i < chunk_size) ? remaining - i : chunk_size;
+		if(i > 0 || node_count > 0) locked = QueryCtx_YieldCommit();
+		if(locked) {
+			_DeleteChunk(op, NULL, 0, op->deleted_edges + i, n);
+		}
 	}
 
 cleanup:
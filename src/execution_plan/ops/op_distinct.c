@@ -5,8 +5,11 @@
 */
 
 #include "op_distinct.h"
-#include "xxhash.h"
 #include "../../util/arr.h"
+#include "../../util/rmalloc.h"
+
+// initial number of fingerprint slots
+#define DISTINCT_INITIAL_CAPACITY 64
 
 /* Forward declarations. */
 static Record DistinctConsume(OpBase *opBase);
@@ -15,7 +18,13 @@ static void DistinctFree(OpBase *opBase);
 
 OpBase *NewDistinctOp(const ExecutionPlan *plan) {
 	OpDistinct *op = rm_malloc(sizeof(OpDistinct));
-	op->found = raxNew();
+	op->slots = NULL;
+	op->capacity = 0;
+	op->count = 0;
+	op->found_zero = false;
+	op->sorted = false;
+	op->has_last = false;
+	op->last = 0;
 
 	OpBase_Init((OpBase *)op, OPType_DISTINCT, "Distinct", NULL, DistinctConsume,
 				NULL, NULL, DistinctClone, DistinctFree, false, plan);
@@ -23,6 +32,57 @@ OpBase *NewDistinctOp(const ExecutionPlan *plan) {
 	return (OpBase *)op;
 }
 
+void DistinctOp_SetSortedInput(OpDistinct *op) {
+	ASSERT(op != NULL);
+	op->sorted = true;
+}
+
+// place fingerprint 'h' in the first free slot of its probe sequence
+static inline void _PlaceFingerprint(uint64_t *slots, uint64_t mask, uint64_t h) {
+	uint64_t i = h & mask;
+	while(slots[i] != 0) i = (i + 1) & mask;
+	slots[i] = h;
+}
+
+// double the number of slots, rehashing all fingerprints
+static void _GrowTable(OpDistinct *op) {
+	uint64_t capacity = (op->capacity == 0) ? DISTINCT_INITIAL_CAPACITY :
+						op->capacity * 2;
+	uint64_t *slots = rm_calloc(capacity, sizeof(uint64_t));
+	uint64_t mask = capacity - 1;
+
+	for(uint64_t i = 0; i < op->capacity; i++) {
+		if(op->slots[i] != 0) _PlaceFingerprint(slots, mask, op->slots[i]);
+	}
+
+	if(op->slots) rm_free(op->slots);
+	op->slots = slots;
+	op->capacity = capacity;
+}
+
+// records fingerprint 'h', returns false if it was already seen
+static bool _InsertFingerprint(OpDistinct *op, uint64_t h) {
+	if(h == 0) {
+		if(op->found_zero) return false;
+		op->found_zero = true;
+		return true;
+	}
+
+	// keep load factor under 3/4, probe sequences stay short
+	if((op->count + 1) * 4 > op->capacity * 3) _GrowTable(op);
+
+	uint64_t mask = op->capacity - 1;
+	uint64_t i = h & mask;
+	while(op->slots[i] != 0) {
+		if(op->slots[i] == h) return false;
+		i = (i + 1) & mask;
+	}
+
+	op->slots[i] = h;
+	op->count++;
+	return true;
+}
+
 static Record DistinctConsume(OpBase *opBase) {
 	OpDistinct *self = (OpDistinct *)opBase;
 	OpBase *child = self->op.children[0];
@@ -31,8 +91,17 @@ static Record DistinctConsume(OpBase *opBase) {
 		Record r = OpBase_Consume(child);
 		if(!r) return NULL;
 
-		unsigned long long const hash = Record_Hash64(r);
-		int is_new = raxInsert(self->found, (unsigned char *) &hash, sizeof(hash), NULL, NULL);
+		uint64_t const hash = Record_Hash64(r);
+		bool is_new;
+		if(self->sorted) {
+			// duplicates are adjacent, compare with the previous record only
+			is_new = (!self->has_last || self->last != hash);
+			self->last = hash;
+			self->has_last = true;
+		} else {
+			is_new = _InsertFingerprint(self, hash);
+		}
+
 		if(is_new) return r;
 		OpBase_DeleteRecord(r);
 	}
@@ -40,14 +109,16 @@ static Record DistinctConsume(OpBase *opBase) {
 
 static inline OpBase *DistinctClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	ASSERT(opBase->type == OPType_DISTINCT);
-	return NewDistinctOp(plan);
+	const OpDistinct *op = (const OpDistinct *)opBase;
+	OpDistinct *clone = (OpDistinct *)NewDistinctOp(plan);
+	clone->sorted = op->sorted;
+	return (OpBase *)clone;
 }
 
 static void DistinctFree(OpBase *ctx) {
 	OpDistinct *op = (OpDistinct *)ctx;
-	if(op->found) {
-		raxFree(op->found);
-		op->found = NULL;
+	if(op->slots) {
+		rm_free(op->slots);
+		op->slots = NULL;
 	}
 }
-
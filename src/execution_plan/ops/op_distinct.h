@@ -7,12 +7,21 @@
 #pragma once
 
 #include "op.h"
-#include "rax.h"
 #include "../execution_plan.h"
 
 typedef struct {
 	OpBase op;
-	rax *found;
+	uint64_t *slots;     // open addressing table of record fingerprints, 0 marks an empty slot
+	uint64_t capacity;   // number of slots, power of 2
+	uint64_t count;      // number of fingerprints in slots
+	bool found_zero;     // fingerprint 0 was seen, can't be stored in slots
+	bool sorted;         // input is ordered by the distinct keys, duplicates are adjacent
+	bool has_last;       // a record was already emitted in sorted mode
+	uint64_t last;       // fingerprint of the last record emitted in sorted mode
 } OpDistinct;
 
 OpBase *NewDistinctOp(const ExecutionPlan *plan);
+
+// mark distinct's input as ordered by all of its keys
+// such that each record is only compared with its predecessor
+void DistinctOp_SetSortedInput(OpDistinct *op);
@@ -0,0 +1,169 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "op_edge_by_id_seek.h"
+#include "RG.h"
+#include "shared/print_functions.h"
+#include "../../util/arr.h"
+
+/* Forward declarations. */
+static OpResult EdgeByIdSeekInit(OpBase *opBase);
+static Record EdgeByIdSeekConsume(OpBase *opBase);
+static OpResult EdgeByIdSeekReset(OpBase *opBase);
+static OpBase *EdgeByIdSeekClone(const ExecutionPlan *plan, const OpBase *opBase);
+static void EdgeByIdSeekFree(OpBase *opBase);
+
+static inline int EdgeByIdSeekToString(const OpBase *ctx, char *buf, uint buf_len) {
+	return TraversalToString(ctx, buf, buf_len, ((OpEdgeByIdSeek *)ctx)->ae);
+}
+
+// returns the label required of 'n', GRAPH_NO_LABEL if unconstrained
+static inline int _RequiredLabel(const QGNode *n) {
+	return (n->label != NULL) ? n->labelID : GRAPH_NO_LABEL;
+}
+
+OpBase *NewEdgeByIdSeekOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae,
+		EdgeID *ids) {
+	ASSERT(ids != NULL);
+	const char *edge = AlgebraicExpression_Edge(ae);
+	ASSERT(edge != NULL);
+	QGEdge *e = QueryGraph_GetEdgeByAlias(plan->query_graph, edge);
+	ASSERT(e != NULL);
+
+	OpEdgeByIdSeek *op = rm_malloc(sizeof(OpEdgeByIdSeek));
+	op->g = g;
+	op->ae = ae;
+	op->ids = ids;
+	op->id_pos = 0;
+	op->relation_ids = NULL;
+	if(array_len(e->reltypeIDs) > 0) array_clone(op->relation_ids, e->reltypeIDs);
+	op->src_label_id = _RequiredLabel(e->src);
+	op->dest_label_id = _RequiredLabel(e->dest);
+	op->src_labels = GrB_NULL;
+	op->dest_labels = GrB_NULL;
+	op->depleted = false;
+
+	// Set our Op operations
+	OpBase_Init((OpBase *)op, OPType_EDGE_BY_ID_SEEK, "Edge By Id Seek",
+				EdgeByIdSeekInit, EdgeByIdSeekConsume, EdgeByIdSeekReset,
+				EdgeByIdSeekToString, EdgeByIdSeekClone, EdgeByIdSeekFree,
+				false, plan);
+
+	op->srcRecIdx = OpBase_Modifies((OpBase *)op, e->src->alias);
+	op->destRecIdx = OpBase_Modifies((OpBase *)op, e->dest->alias);
+	op->edgeRecIdx = OpBase_Modifies((OpBase *)op, edge);
+
+	return (OpBase *)op;
+}
+
+static OpResult EdgeByIdSeekInit(OpBase *opBase) {
+	OpEdgeByIdSeek *op = (OpEdgeByIdSeek *)opBase;
+
+	// required labels which don't exist can't be matched
+	if(op->src_label_id == GRAPH_UNKNOWN_LABEL ||
+	   op->dest_label_id == GRAPH_UNKNOWN_LABEL) {
+		op->depleted = true;
+		return OP_OK;
+	}
+
+	if(op->src_label_id != GRAPH_NO_LABEL) {
+		op->src_labels = Graph_GetLabelMatrix(op->g, op->src_label_id);
+	}
+	if(op->dest_label_id != GRAPH_NO_LABEL) {
+		op->dest_labels = Graph_GetLabelMatrix(op->g, op->dest_label_id);
+	}
+
+	return OP_OK;
+}
+
+// returns true if node 'id' carries the required label
+static bool _HasLabel(NodeID id, GrB_Matrix labels) {
+	if(labels == GrB_NULL) return true;
+
+	bool x = false;
+	GrB_Info res = GrB_Matrix_extractElement_BOOL(&x, labels, id, id);
+	return (res == GrB_SUCCESS && x);
+}
+
+// returns true if edge 'e' is of an accepted relationship type
+static bool _HasRelation(const OpEdgeByIdSeek *op, const Edge *e) {
+	if(op->relation_ids == NULL) return true;
+
+	int relation_id = Edge_GetRelationID(e);
+	uint count = array_len(op->relation_ids);
+	for(uint i = 0; i < count; i++) {
+		if(op->relation_ids[i] == relation_id) return true;
+	}
+	return false;
+}
+
+static Record EdgeByIdSeekConsume(OpBase *opBase) {
+	OpEdgeByIdSeek *op = (OpEdgeByIdSeek *)opBase;
+	if(op->depleted) return NULL;
+
+	// IDs beyond the edge storage were never assigned
+	uint64_t edge_slots = Graph_EdgeCount(op->g) + Graph_DeletedEdgeCount(op->g);
+	uint count = array_len(op->ids);
+
+	while(op->id_pos < count) {
+		Edge e = {0};
+		EdgeID id = op->ids[op->id_pos++];
+		if(id >= edge_slots) break;
+
+		// the edge's record holds its endpoints and relationship type
+		if(!Graph_GetEdge(op->g, id, &e)) continue;
+		if(!_HasRelation(op, &e)) continue;
+		if(!_HasLabel(Edge_GetSrcNodeID(&e), op->src_labels)) continue;
+		if(!_HasLabel(Edge_GetDestNodeID(&e), op->dest_labels)) continue;
+
+		Node src = GE_NEW_NODE();
+		Node dest = GE_NEW_NODE();
+		Graph_GetNode(op->g, Edge_GetSrcNodeID(&e), &src);
+		Graph_GetNode(op->g, Edge_GetDestNodeID(&e), &dest);
+
+		Record r = OpBase_CreateRecord((OpBase *)op);
+		Record_AddNode(r, op->srcRecIdx, src);
+		Record_AddNode(r, op->destRecIdx, dest);
+		Record_AddEdge(r, op->edgeRecIdx, e);
+		return r;
+	}
+
+	op->id_pos = count;
+	return NULL;
+}
+
+static OpResult EdgeByIdSeekReset(OpBase *opBase) {
+	OpEdgeByIdSeek *op = (OpEdgeByIdSeek *)opBase;
+	op->id_pos = 0;
+	return OP_OK;
+}
+
+static OpBase *EdgeByIdSeekClone(const ExecutionPlan *plan, const OpBase *opBase) {
+	ASSERT(opBase->type == OPType_EDGE_BY_ID_SEEK);
+	const OpEdgeByIdSeek *op = (const OpEdgeByIdSeek *)opBase;
+	EdgeID *ids;
+	array_clone(ids, op->ids);
+	return NewEdgeByIdSeekOp(plan, op->g, AlgebraicExpression_Clone(op->ae), ids);
+}
+
+static void EdgeByIdSeekFree(OpBase *opBase) {
+	OpEdgeByIdSeek *op = (OpEdgeByIdSeek *)opBase;
+
+	if(op->ae) {
+		AlgebraicExpression_Free(op->ae);
+		op->ae = NULL;
+	}
+
+	if(op->ids) {
+		array_free(op->ids);
+		op->ids = NULL;
+	}
+
+	if(op->relation_ids) {
+		array_free(op->relation_ids);
+		op->relation_ids = NULL;
+	}
+}
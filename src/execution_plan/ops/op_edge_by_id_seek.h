@@ -0,0 +1,40 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "op.h"
+#include "../execution_plan.h"
+#include "../../graph/graph.h"
+#include "../../arithmetic/algebraic_expression.h"
+
+/* EdgeByIdSeek resolves a single hop pattern (a)-[e]->(b)
+ * constrained by the ID of its edge, e.g. WHERE id(e) = 5
+ * each listed edge is fetched by ID, binding the edge along with
+ * the endpoints held by its record, rather than scanning every node
+ * and traversing its edges. */
+typedef struct {
+	OpBase op;
+	Graph *g;
+	AlgebraicExpression *ae;  // Replaced traversal, describes the resolved pattern.
+	EdgeID *ids;              // Sorted distinct edge IDs to fetch.
+	uint id_pos;              // Position of the next listed ID to fetch.
+	int *relation_ids;        // Accepted relationship types, NULL if unconstrained.
+	int src_label_id;         // Required source label, GRAPH_NO_LABEL if unconstrained.
+	int dest_label_id;        // Required destination label, GRAPH_NO_LABEL if unconstrained.
+	GrB_Matrix src_labels;    // Source label matrix, if label is required.
+	GrB_Matrix dest_labels;   // Destination label matrix, if label is required.
+	int srcRecIdx;            // Source node position within record.
+	int destRecIdx;           // Destination node position within record.
+	int edgeRecIdx;           // Edge position within record.
+	bool depleted;            // Pattern can't be matched.
+} OpEdgeByIdSeek;
+
+/* Creates a new EdgeByIdSeek operation,
+ * replacing the traversal 'ae' of a single, directed edge,
+ * takes ownership of 'ae' and of 'ids', which must be sorted and distinct. */
+OpBase *NewEdgeByIdSeekOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae,
+		EdgeID *ids);
@@ -0,0 +1,192 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "op_edge_by_type_scan.h"
+#include "RG.h"
+#include "shared/print_functions.h"
+
+/* Forward declarations. */
+static OpResult EdgeByTypeScanInit(OpBase *opBase);
+static Record EdgeByTypeScanConsume(OpBase *opBase);
+static OpResult EdgeByTypeScanReset(OpBase *opBase);
+static OpBase *EdgeByTypeScanClone(const ExecutionPlan *plan, const OpBase *opBase);
+static void EdgeByTypeScanFree(OpBase *opBase);
+
+static inline int EdgeByTypeScanToString(const OpBase *ctx, char *buf, uint buf_len) {
+	return TraversalToString(ctx, buf, buf_len, ((OpEdgeByTypeScan *)ctx)->ae);
+}
+
+// returns the label required of 'n', GRAPH_NO_LABEL if unconstrained
+static inline int _RequiredLabel(const QGNode *n) {
+	return (n->label != NULL) ? n->labelID : GRAPH_NO_LABEL;
+}
+
+OpBase *NewEdgeByTypeScanOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae) {
+	const char *edge = AlgebraicExpression_Edge(ae);
+	ASSERT(edge != NULL);
+	QGEdge *e = QueryGraph_GetEdgeByAlias(plan->query_graph, edge);
+	ASSERT(e != NULL && array_len(e->reltypeIDs) == 1);
+
+	OpEdgeByTypeScan *op = rm_malloc(sizeof(OpEdgeByTypeScan));
+	op->g = g;
+	op->ae = ae;
+	op->relation_id = e->reltypeIDs[0];
+	op->src_label_id = _RequiredLabel(e->src);
+	op->dest_label_id = _RequiredLabel(e->dest);
+	op->src_labels = GrB_NULL;
+	op->dest_labels = GrB_NULL;
+	op->src = GE_NEW_NODE();
+	op->dest = GE_NEW_NODE();
+	op->edges = array_new(Edge, 1);
+	op->edge_pos = 0;
+	op->depleted = false;
+	op->iter = NULL;
+	op->src_id = INVALID_ENTITY_ID;
+	op->cols = NULL;
+	op->col_count = 0;
+	op->col_idx = 0;
+	op->sample = NULL;
+
+	// Set our Op operations
+	OpBase_Init((OpBase *)op, OPType_EDGE_BY_TYPE_SCAN, "Edge By Type Scan",
+				EdgeByTypeScanInit, EdgeByTypeScanConsume, EdgeByTypeScanReset,
+				EdgeByTypeScanToString, EdgeByTypeScanClone, EdgeByTypeScanFree,
+				false, plan);
+
+	op->srcRecIdx = OpBase_Modifies((OpBase *)op, e->src->alias);
+	op->destRecIdx = OpBase_Modifies((OpBase *)op, e->dest->alias);
+	op->edgeRecIdx = OpBase_Modifies((OpBase *)op, edge);
+
+	return (OpBase *)op;
+}
+
+static OpResult EdgeByTypeScanInit(OpBase *opBase) {
+	OpEdgeByTypeScan *op = (OpEdgeByTypeScan *)opBase;
+
+	// required labels which don't exist can't be matched
+	if(op->src_label_id == GRAPH_UNKNOWN_LABEL ||
+	   op->dest_label_id == GRAPH_UNKNOWN_LABEL) {
+		op->depleted = true;
+		return OP_OK;
+	}
+
+	if(op->src_label_id != GRAPH_NO_LABEL) {
+		op->src_labels = Graph_GetLabelMatrix(op->g, op->src_label_id);
+	}
+	if(op->dest_label_id != GRAPH_NO_LABEL) {
+		op->dest_labels = Graph_GetLabelMatrix(op->g, op->dest_label_id);
+	}
+
+	op->sample = ScanSample_New(opBase);
+	return OP_OK;
+}
+
+// returns true if node 'id' carries the required label
+static bool _HasLabel(NodeID id, GrB_Matrix labels) {
+	if(labels == GrB_NULL) return true;
+
+	bool x = false;
+	GrB_Info res = GrB_Matrix_extractElement_BOOL(&x, labels, id, id);
+	return (res == GrB_SUCCESS && x);
+}
+
+static Record EdgeByTypeScanConsume(OpBase *opBase) {
+	OpEdgeByTypeScan *op = (OpEdgeByTypeScan *)opBase;
+	if(op->depleted) return NULL;
+
+	if(op->iter == NULL) {
+		GrB_Matrix relation = Graph_GetRelationMatrix(op->g, op->relation_id);
+		GxB_MatrixTupleIter_new(&op->iter, relation);
+	}
+
+	// advance to the next connected pair of nodes matching the pattern
+	while(op->edge_pos >= array_len(op->edges)) {
+		// consume the relation a row at a time, the source's label is tested once
+		if(op->col_idx >= op->col_count) {
+			op->col_idx = 0;
+			GxB_MatrixTupleIter_next_row(op->iter, &op->src_id, &op->cols, NULL,
+					&op->col_count, &op->depleted);
+			if(op->depleted) return NULL;
+			if(op->sample) {
+				// skip the rows of sources left out of the sample
+				uint64_t pos = op->src_id;
+				if(!ScanSample_Seek(op->sample, &pos, Graph_RequiredMatrixDim(op->g))) {
+					op->depleted = true;
+					return NULL;
+				}
+				if(pos != op->src_id) {
+					GxB_MatrixTupleIter_iterate_range(op->iter, pos, UINT64_MAX);
+					op->col_count = 0;
+					continue;
+				}
+			}
+			if(!_HasLabel(op->src_id, op->src_labels)) op->col_count = 0;
+			continue;
+		}
+
+		NodeID dest_id = op->cols[op->col_idx++];
+		if(!_HasLabel(dest_id, op->dest_labels)) continue;
+
+		array_clear(op->edges);
+		op->edge_pos = 0;
+		Graph_GetEdgesConnectingNodes(op->g, op->src_id, dest_id, op->relation_id, &op->edges);
+		Graph_GetNode(op->g, op->src_id, &op->src);
+		Graph_GetNode(op->g, dest_id, &op->dest);
+	}
+
+	Record r = OpBase_CreateRecord((OpBase *)op);
+	Record_AddNode(r, op->srcRecIdx, op->src);
+	Record_AddNode(r, op->destRecIdx, op->dest);
+	Record_AddEdge(r, op->edgeRecIdx, op->edges[op->edge_pos++]);
+	return r;
+}
+
+static OpResult EdgeByTypeScanReset(OpBase *opBase) {
+	OpEdgeByTypeScan *op = (OpEdgeByTypeScan *)opBase;
+	op->edge_pos = 0;
+	op->col_count = 0;
+	op->col_idx = 0;
+	op->depleted = false;
+	array_clear(op->edges);
+	if(op->iter) {
+		GxB_MatrixTupleIter_free(op->iter);
+		op->iter = NULL;
+	}
+	// a reused plan may be executed by a query sampling at another rate
+	if(op->sample) ScanSample_Free(op->sample);
+	op->sample = ScanSample_New(opBase);
+	return OP_OK;
+}
+
+static OpBase *EdgeByTypeScanClone(const ExecutionPlan *plan, const OpBase *opBase) {
+	ASSERT(opBase->type == OPType_EDGE_BY_TYPE_SCAN);
+	const OpEdgeByTypeScan *op = (const OpEdgeByTypeScan *)opBase;
+	return NewEdgeByTypeScanOp(plan, op->g, AlgebraicExpression_Clone(op->ae));
+}
+
+static void EdgeByTypeScanFree(OpBase *opBase) {
+	OpEdgeByTypeScan *op = (OpEdgeByTypeScan *)opBase;
+
+	if(op->ae) {
+		AlgebraicExpression_Free(op->ae);
+		op->ae = NULL;
+	}
+
+	if(op->edges) {
+		array_free(op->edges);
+		op->edges = NULL;
+	}
+
+	if(op->iter) {
+		GxB_MatrixTupleIter_free(op->iter);
+		op->iter = NULL;
+	}
+
+	if(op->sample) {
+		ScanSample_Free(op->sample);
+		op->sample = NULL;
+	}
+}
@@ -0,0 +1,47 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "op.h"
+#include "shared/scan_sample.h"
+#include "../execution_plan.h"
+#include "../../graph/graph.h"
+#include "../../arithmetic/algebraic_expression.h"
+
+/* EdgeByTypeScan resolves a single hop pattern (a)-[e:R]->(b)
+ * whose source isn't constrained by a label, by iterating over the tuples
+ * of R's relation matrix, binding each edge along with its endpoints,
+ * rather than scanning every node and traversing its row of R. */
+typedef struct {
+	OpBase op;
+	Graph *g;
+	AlgebraicExpression *ae;  // Replaced traversal, describes the resolved pattern.
+	int relation_id;          // Relationship type ID.
+	int src_label_id;         // Required source label, GRAPH_NO_LABEL if unconstrained.
+	int dest_label_id;        // Required destination label, GRAPH_NO_LABEL if unconstrained.
+	GrB_Matrix src_labels;    // Source label matrix, if label is required.
+	GrB_Matrix dest_labels;   // Destination label matrix, if label is required.
+	int srcRecIdx;            // Source node position within record.
+	int destRecIdx;           // Destination node position within record.
+	int edgeRecIdx;           // Edge position within record.
+	Node src;                 // Source of the current pair.
+	Node dest;                // Destination of the current pair.
+	Edge *edges;              // Edges connecting the current pair.
+	uint edge_pos;            // Next edge to report.
+	bool depleted;            // Relation was fully scanned.
+	GxB_MatrixTupleIter *iter;  // Iterator over the relation matrix.
+	NodeID src_id;              // Source of the current row.
+	const GrB_Index *cols;      // Destinations of the current row, within the relation matrix.
+	GrB_Index col_count;        // Number of destinations in the current row.
+	GrB_Index col_idx;          // Next destination to consume.
+	ScanSample *sample;         // Source blocks scanned by a sampled query, NULL if unsampled.
+} OpEdgeByTypeScan;
+
+/* Creates a new EdgeByTypeScan operation,
+ * replacing the traversal 'ae' of a single, single typed, directed edge,
+ * takes ownership of 'ae'. */
+OpBase *NewEdgeByTypeScanOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae);
@@ -0,0 +1,233 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "op_edge_index_scan.h"
+#include "RG.h"
+#include "../../query_ctx.h"
+#include "shared/print_functions.h"
+
+/* Forward declarations. */
+static OpResult EdgeIndexScanInit(OpBase *opBase);
+static Record EdgeIndexScanConsume(OpBase *opBase);
+static OpResult EdgeIndexScanReset(OpBase *opBase);
+static OpBase *EdgeIndexScanClone(const ExecutionPlan *plan, const OpBase *opBase);
+static void EdgeIndexScanFree(OpBase *opBase);
+
+static inline int EdgeIndexScanToString(const OpBase *ctx, char *buf, uint buf_len) {
+	return TraversalToString(ctx, buf, buf_len, ((OpEdgeIndexScan *)ctx)->ae);
+}
+
+// returns the label required of 'n', GRAPH_NO_LABEL if unconstrained
+static inline int _RequiredLabel(const QGNode *n) {
+	return (n->label != NULL) ? n->labelID : GRAPH_NO_LABEL;
+}
+
+OpBase *NewEdgeIndexScanOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae,
+						   Attribute_ID attribute, const NumericRange *bounds) {
+	const char *edge = AlgebraicExpression_Edge(ae);
+	ASSERT(edge != NULL);
+	QGEdge *e = QueryGraph_GetEdgeByAlias(plan->query_graph, edge);
+	ASSERT(e != NULL && array_len(e->reltypeIDs) == 1);
+
+	OpEdgeIndexScan *op = rm_malloc(sizeof(OpEdgeIndexScan));
+	op->g = g;
+	op->ae = ae;
+	op->attribute = attribute;
+	op->bounds = *bounds;
+	op->relation_id = e->reltypeIDs[0];
+	op->src_label_id = _RequiredLabel(e->src);
+	op->dest_label_id = _RequiredLabel(e->dest);
+	op->src_labels = GrB_NULL;
+	op->dest_labels = GrB_NULL;
+	op->idx = NULL;
+	op->ids = NULL;
+	op->pos = 0;
+	op->edges = array_new(Edge, 1);
+	op->edge_pos = 0;
+	op->scan_relation = false;
+	op->iter = NULL;
+
+	// Set our Op operations
+	OpBase_Init((OpBase *)op, OPType_EDGE_INDEX_SCAN, "Edge Index Scan", EdgeIndexScanInit,
+				EdgeIndexScanConsume, EdgeIndexScanReset, EdgeIndexScanToString,
+				EdgeIndexScanClone, EdgeIndexScanFree, false, plan);
+
+	op->srcRecIdx = OpBase_Modifies((OpBase *)op, e->src->alias);
+	op->destRecIdx = OpBase_Modifies((OpBase *)op, e->dest->alias);
+	op->edgeRecIdx = OpBase_Modifies((OpBase *)op, edge);
+
+	return (OpBase *)op;
+}
+
+static OpResult EdgeIndexScanInit(OpBase *opBase) {
+	OpEdgeIndexScan *op = (OpEdgeIndexScan *)opBase;
+
+	// required labels which don't exist can't be matched
+	if(op->src_label_id == GRAPH_UNKNOWN_LABEL ||
+	   op->dest_label_id == GRAPH_UNKNOWN_LABEL) {
+		op->ids = array_new(EdgeID, 0);
+		return OP_OK;
+	}
+
+	if(op->src_label_id != GRAPH_NO_LABEL) {
+		op->src_labels = Graph_GetLabelMatrix(op->g, op->src_label_id);
+	}
+	if(op->dest_label_id != GRAPH_NO_LABEL) {
+		op->dest_labels = Graph_GetLabelMatrix(op->g, op->dest_label_id);
+	}
+
+	// resolve the index at execution time
+	// as it might have been modified since the plan was built
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchemaByID(gc, op->relation_id, SCHEMA_EDGE);
+	op->idx = Schema_GetIndex(s, &op->attribute, IDX_EXACT_MATCH);
+	RangeIndex *range = (op->idx) ? Index_GetRangeIndex(op->idx, op->attribute) : NULL;
+
+	if(range != NULL) {
+		op->ids = RangeIndex_Query(range, &op->bounds);
+	} else {
+		// index was dropped, fall back to scanning the relation
+		op->scan_relation = true;
+	}
+
+	return OP_OK;
+}
+
+// returns true if node 'id' exists and carries the required label
+static bool _ValidateNode(const OpEdgeIndexScan *op, NodeID id, GrB_Matrix labels,
+						  Node *n) {
+	if(id >= Graph_RequiredMatrixDim(op->g)) return false;
+	if(!Graph_GetNode(op->g, id, n)) return false;
+	if(labels == GrB_NULL) return true;
+
+	bool x = false;
+	GrB_Info res = GrB_Matrix_extractElement_BOOL(&x, labels, id, id);
+	return (res == GrB_SUCCESS && x);
+}
+
+// locate indexed edge 'id', returns false if the edge no longer
+// connects its indexed endpoints or if they don't match the pattern
+static bool _LocateEdge(OpEdgeIndexScan *op, EdgeID id, Node *src, Node *dest,
+						Edge *e) {
+	NodeID src_id;
+	NodeID dest_id;
+	if(!Index_GetEdgeEndpoints(op->idx, id, &src_id, &dest_id)) return false;
+	if(!_ValidateNode(op, src_id, op->src_labels, src)) return false;
+	if(!_ValidateNode(op, dest_id, op->dest_labels, dest)) return false;
+
+	// the edge ID might have been reused since it was indexed
+	// make sure edge still connects src to dest
+	array_clear(op->edges);
+	Graph_GetEdgesConnectingNodes(op->g, src_id, dest_id, op->relation_id, &op->edges);
+	uint edge_count = array_len(op->edges);
+	for(uint i = 0; i < edge_count; i++) {
+		if(ENTITY_GET_ID(op->edges + i) == id) {
+			*e = op->edges[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static Record _BuildRecord(OpEdgeIndexScan *op, Node *src, Node *dest, Edge *e) {
+	Record r = OpBase_CreateRecord((OpBase *)op);
+	Record_AddNode(r, op->srcRecIdx, *src);
+	Record_AddNode(r, op->destRecIdx, *dest);
+	Record_AddEdge(r, op->edgeRecIdx, *e);
+	return r;
+}
+
+// reports every edge of the relation, used once the index was dropped
+static Record _ScanRelation(OpEdgeIndexScan *op) {
+	Node src = GE_NEW_NODE();
+	Node dest = GE_NEW_NODE();
+
+	if(op->iter == NULL) {
+		GrB_Matrix relation = Graph_GetRelationMatrix(op->g, op->relation_id);
+		GxB_MatrixTupleIter_new(&op->iter, relation);
+	}
+
+	while(true) {
+		while(op->edge_pos < array_len(op->edges)) {
+			Edge *e = op->edges + op->edge_pos++;
+			if(!_ValidateNode(op, Edge_GetSrcNodeID(e), op->src_labels, &src)) continue;
+			if(!_ValidateNode(op, Edge_GetDestNodeID(e), op->dest_labels, &dest)) continue;
+			return _BuildRecord(op, &src, &dest, e);
+		}
+
+		// advance to the next connected pair of nodes
+		NodeID src_id;
+		NodeID dest_id;
+		bool depleted = false;
+		GxB_MatrixTupleIter_next(op->iter, &src_id, &dest_id, &depleted);
+		if(depleted) return NULL;
+
+		array_clear(op->edges);
+		op->edge_pos = 0;
+		Graph_GetEdgesConnectingNodes(op->g, src_id, dest_id, op->relation_id, &op->edges);
+	}
+}
+
+static Record EdgeIndexScanConsume(OpBase *opBase) {
+	OpEdgeIndexScan *op = (OpEdgeIndexScan *)opBase;
+	if(op->scan_relation) return _ScanRelation(op);
+
+	Node src = GE_NEW_NODE();
+	Node dest = GE_NEW_NODE();
+	Edge e;
+
+	uint64_t count = array_len(op->ids);
+	while(op->pos < count) {
+		EdgeID id = op->ids[op->pos++];
+		if(_LocateEdge(op, id, &src, &dest, &e)) return _BuildRecord(op, &src, &dest, &e);
+	}
+
+	return NULL;
+}
+
+static OpResult EdgeIndexScanReset(OpBase *opBase) {
+	OpEdgeIndexScan *op = (OpEdgeIndexScan *)opBase;
+	op->pos = 0;
+	op->edge_pos = 0;
+	array_clear(op->edges);
+	if(op->iter) {
+		GxB_MatrixTupleIter_free(op->iter);
+		op->iter = NULL;
+	}
+	return OP_OK;
+}
+
+static OpBase *EdgeIndexScanClone(const ExecutionPlan *plan, const OpBase *opBase) {
+	ASSERT(opBase->type == OPType_EDGE_INDEX_SCAN);
+	const OpEdgeIndexScan *op = (const OpEdgeIndexScan *)opBase;
+	return NewEdgeIndexScanOp(plan, op->g, AlgebraicExpression_Clone(op->ae), op->attribute,
+							  &op->bounds);
+}
+
+static void EdgeIndexScanFree(OpBase *opBase) {
+	OpEdgeIndexScan *op = (OpEdgeIndexScan *)opBase;
+
+	if(op->ae) {
+		AlgebraicExpression_Free(op->ae);
+		op->ae = NULL;
+	}
+
+	if(op->ids) {
+		array_free(op->ids);
+		op->ids = NULL;
+	}
+
+	if(op->edges) {
+		array_free(op->edges);
+		op->edges = NULL;
+	}
+
+	if(op->iter) {
+		GxB_MatrixTupleIter_free(op->iter);
+		op->iter = NULL;
+	}
+}
@@ -0,0 +1,49 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "op.h"
+#include "../execution_plan.h"
+#include "../../graph/graph.h"
+#include "../../index/index.h"
+#include "../../arithmetic/algebraic_expression.h"
+
+/* EdgeIndexScan resolves a single hop pattern (a)-[e:R]->(b)
+ * by querying the numeric range index of an indexed relationship attribute,
+ * binding each matching edge along with its endpoints.
+ * Edges deleted along with their endpoints linger in the index,
+ * as such every reported edge is validated against the relation matrix.
+ * The filter resolved by the index is retained above this op,
+ * if the index is dropped after the plan was built, every edge is reported. */
+typedef struct {
+	OpBase op;
+	Graph *g;
+	AlgebraicExpression *ae;  // Replaced traversal, describes the resolved pattern.
+	Attribute_ID attribute;   // Indexed attribute.
+	NumericRange bounds;      // Range to scan.
+	int relation_id;          // Relationship type ID.
+	int src_label_id;         // Required source label, GRAPH_NO_LABEL if unconstrained.
+	int dest_label_id;        // Required destination label, GRAPH_NO_LABEL if unconstrained.
+	GrB_Matrix src_labels;    // Source label matrix, if label is required.
+	GrB_Matrix dest_labels;   // Destination label matrix, if label is required.
+	int srcRecIdx;            // Source node position within record.
+	int destRecIdx;           // Destination node position within record.
+	int edgeRecIdx;           // Edge position within record.
+	Index *idx;               // Relationship index, resolved once executed.
+	EdgeID *ids;              // Edges within range, ascending.
+	uint64_t pos;             // Position of next edge to inspect.
+	Edge *edges;              // Edges connecting the current endpoints.
+	uint edge_pos;            // Next edge to report, relation scan only.
+	bool scan_relation;       // Index is missing, scan the entire relation.
+	GxB_MatrixTupleIter *iter;  // Iterator over the relation matrix, relation scan only.
+} OpEdgeIndexScan;
+
+/* Creates a new EdgeIndexScan operation,
+ * replacing the traversal 'ae' of a single, single typed, directed edge,
+ * reporting edges whose 'attribute' lies within 'bounds', takes ownership of 'ae'. */
+OpBase *NewEdgeIndexScanOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae,
+						   Attribute_ID attribute, const NumericRange *bounds);
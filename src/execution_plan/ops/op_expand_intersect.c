@@ -0,0 +1,268 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "op_expand_intersect.h"
+#include "RG.h"
+#include "shared/print_functions.h"
+#include "../../util/strcmp.h"
+#include "../../query_ctx.h"
+
+// default number of records to accumulate before intersecting
+#define BATCH_SIZE 64
+
+/* Forward declarations. */
+static OpResult ExpandIntersectInit(OpBase *opBase);
+static Record ExpandIntersectConsume(OpBase *opBase);
+static OpResult ExpandIntersectReset(OpBase *opBase);
+static OpBase *ExpandIntersectClone(const ExecutionPlan *plan, const OpBase *opBase);
+static void ExpandIntersectFree(OpBase *opBase);
+
+// String representation of operation.
+static inline int ExpandIntersectToString(const OpBase *ctx, char *buf, uint buf_len) {
+	const OpExpandIntersect *op = (const OpExpandIntersect *)ctx;
+	return IntersectionToString(ctx, buf, buf_len, op->ae, op->into_ae);
+}
+
+static void _populate_filter_matrices(OpExpandIntersect *op) {
+	for(uint i = 0; i < op->record_count; i++) {
+		Record r = op->records[i];
+		/* Update filter matrices, set row i at the position of each bound node
+		 * F[i, srcId] = true, G[i, otherId] = true. */
+		Node *src = Record_GetNode(r, op->srcNodeIdx);
+		Node *other = Record_GetNode(r, op->otherNodeIdx);
+		GrB_Matrix_setElement_BOOL(op->F, true, i, ENTITY_GET_ID(src));
+		GrB_Matrix_setElement_BOOL(op->G, true, i, ENTITY_GET_ID(other));
+	}
+}
+
+/* Evaluate both neighbourhoods of the current batch:
+ * M[i, j] is set if node j is reachable from record i's first bound node,
+ * N[i, j] is set if node j is connected to record i's second bound node,
+ * intersecting both leaves M[i, j] set only for nodes closing the cycle. */
+static void _intersect(OpExpandIntersect *op) {
+	// If op->F is null, this is the first time we are intersecting.
+	if(op->F == GrB_NULL) {
+		/* Create filter and result matrices.
+		 * make sure M's format is SPARSE, required by the matrix iterator */
+		size_t required_dim = Graph_RequiredMatrixDim(op->graph);
+		GrB_Matrix_new(&op->M, GrB_BOOL, op->record_cap, required_dim);
+		GrB_Matrix_new(&op->N, GrB_BOOL, op->record_cap, required_dim);
+		GrB_Matrix_new(&op->F, GrB_BOOL, op->record_cap, required_dim);
+		GrB_Matrix_new(&op->G, GrB_BOOL, op->record_cap, required_dim);
+		GxB_set(op->M, GxB_SPARSITY_CONTROL, GxB_SPARSE);
+
+		// Prepend the filter matrices to the expressions as their leftmost operands.
+		AlgebraicExpression_MultiplyToTheLeft(&op->ae, op->F);
+		AlgebraicExpression_Optimize(&op->ae);
+
+		// Root expression at the second bound node.
+		op->bound_ae = AlgebraicExpression_Clone(op->into_ae);
+		if(op->transpose) AlgebraicExpression_Transpose(&op->bound_ae);
+		AlgebraicExpression_MultiplyToTheLeft(&op->bound_ae, op->G);
+		AlgebraicExpression_Optimize(&op->bound_ae);
+	}
+
+	// Populate filter matrices.
+	_populate_filter_matrices(op);
+
+	// Evaluate both expressions and intersect them.
+	AlgebraicExpression_Eval(op->ae, op->M);
+	AlgebraicExpression_Eval(op->bound_ae, op->N);
+	GrB_Info info = GrB_Matrix_eWiseMult_BinaryOp(op->M, GrB_NULL, GrB_NULL, GrB_LAND, op->M,
+												 op->N, GrB_NULL);
+	UNUSED(info);
+	ASSERT(info == GrB_SUCCESS);
+
+	if(op->iter == NULL) GxB_MatrixTupleIter_new(&op->iter, op->M);
+	else GxB_MatrixTupleIter_reuse(op->iter, op->M);
+
+	// Clear filter matrices.
+	GrB_Matrix_clear(op->F);
+	GrB_Matrix_clear(op->G);
+}
+
+OpBase *NewExpandIntersectOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae,
+							 AlgebraicExpression *into_ae) {
+	OpExpandIntersect *op = rm_malloc(sizeof(OpExpandIntersect));
+	op->graph = g;
+	op->ae = ae;
+	op->into_ae = into_ae;
+	op->bound_ae = NULL;
+	op->iter = NULL;
+	op->F = GrB_NULL;
+	op->G = GrB_NULL;
+	op->M = GrB_NULL;
+	op->N = GrB_NULL;
+	op->records = NULL;
+	op->record_count = 0;
+	op->record_cap = BATCH_SIZE;
+
+	// Set our Op operations
+	OpBase_Init((OpBase *)op, OPType_EXPAND_INTERSECT, "Expand Intersect", ExpandIntersectInit,
+				ExpandIntersectConsume, ExpandIntersectReset, ExpandIntersectToString,
+				ExpandIntersectClone, ExpandIntersectFree, false, plan);
+
+	const char *dest = AlgebraicExpression_Destination(ae);
+	const char *into_src = AlgebraicExpression_Source(into_ae);
+	const char *into_dest = AlgebraicExpression_Destination(into_ae);
+	op->transpose = (RG_STRCMP(into_src, dest) == 0);
+	const char *other = (op->transpose) ? into_dest : into_src;
+	ASSERT(RG_STRCMP(op->transpose ? into_src : into_dest, dest) == 0);
+
+	bool aware;
+	UNUSED(aware);
+	aware = OpBase_Aware((OpBase *)op, AlgebraicExpression_Source(ae), &op->srcNodeIdx);
+	ASSERT(aware);
+	aware = OpBase_Aware((OpBase *)op, other, &op->otherNodeIdx);
+	ASSERT(aware);
+
+	op->destNodeIdx = OpBase_Modifies((OpBase *)op, dest);
+	// Check the QueryGraph node and retrieve label data if possible.
+	QGNode *dest_node = QueryGraph_GetNodeByAlias(plan->query_graph, dest);
+	op->dest_label = dest_node->label;
+	op->dest_label_id = dest_node->labelID;
+
+	return (OpBase *)op;
+}
+
+static OpResult ExpandIntersectInit(OpBase *opBase) {
+	OpExpandIntersect *op = (OpExpandIntersect *)opBase;
+	// Create 'records' with this Init function as 'record_cap'
+	// might be set during optimization time (applyLimit)
+	// If cap greater than BATCH_SIZE is specified,
+	// use BATCH_SIZE as the value.
+	if(op->record_cap > BATCH_SIZE) op->record_cap = BATCH_SIZE;
+	op->records = rm_calloc(op->record_cap, sizeof(Record));
+	return OP_OK;
+}
+
+/* Each call to ExpandIntersectConsume emits a Record containing
+ * a node which closes the cycle for one of the accumulated records.
+ * Returns NULL once all batches have been intersected. */
+static Record ExpandIntersectConsume(OpBase *opBase) {
+	OpExpandIntersect *op = (OpExpandIntersect *)opBase;
+	OpBase *child = op->op.children[0];
+
+	bool depleted = true;
+	NodeID row = INVALID_ENTITY_ID;
+	NodeID dest_id = INVALID_ENTITY_ID;
+
+	while(true) {
+		if(op->iter) GxB_MatrixTupleIter_next(op->iter, &row, &dest_id, &depleted);
+
+		// Managed to get a tuple, break.
+		if(!depleted) break;
+
+		/* Run out of tuples, try to get new data.
+		 * Free old records. */
+		for(uint i = 0; i < op->record_count; i++) OpBase_DeleteRecord(op->records[i]);
+
+		// Ask child operations for data.
+		for(op->record_count = 0; op->record_count < op->record_cap; op->record_count++) {
+			Record childRecord = OpBase_Consume(child);
+			// If the Record is NULL, the child has been depleted.
+			if(!childRecord) break;
+			if(!Record_GetNode(childRecord, op->srcNodeIdx) ||
+			   !Record_GetNode(childRecord, op->otherNodeIdx)) {
+				/* The child Record may not contain the bound nodes in scenarios like
+				 * a failed OPTIONAL MATCH. In this case, delete the Record and try again. */
+				OpBase_DeleteRecord(childRecord);
+				op->record_count--;
+				continue;
+			}
+
+			// Store received record.
+			Record_PersistScalars(childRecord);
+			op->records[op->record_count] = childRecord;
+		}
+
+		// No data.
+		if(op->record_count == 0) return NULL;
+
+		_intersect(op);
+	}
+
+	/* Populate the destination node and add it to a copy of the Record.
+	 * Note that if the node's label is unknown, this will correctly
+	 * create an unlabeled node. */
+	Record r = OpBase_CloneRecord(op->records[row]);
+	Node destNode = GE_NEW_LABELED_NODE(op->dest_label, op->dest_label_id);
+	Graph_GetNode(op->graph, dest_id, &destNode);
+	Record_AddNode(r, op->destNodeIdx, destNode);
+	return r;
+}
+
+static OpResult ExpandIntersectReset(OpBase *ctx) {
+	OpExpandIntersect *op = (OpExpandIntersect *)ctx;
+
+	for(uint i = 0; i < op->record_count; i++) OpBase_DeleteRecord(op->records[i]);
+	op->record_count = 0;
+
+	if(op->iter) {
+		GxB_MatrixTupleIter_free(op->iter);
+		op->iter = NULL;
+	}
+	if(op->F != GrB_NULL) GrB_Matrix_clear(op->F);
+	if(op->G != GrB_NULL) GrB_Matrix_clear(op->G);
+	return OP_OK;
+}
+
+static inline OpBase *ExpandIntersectClone(const ExecutionPlan *plan, const OpBase *opBase) {
+	ASSERT(opBase->type == OPType_EXPAND_INTERSECT);
+	OpExpandIntersect *op = (OpExpandIntersect *)opBase;
+	return NewExpandIntersectOp(plan, QueryCtx_GetGraph(), AlgebraicExpression_Clone(op->ae),
+								AlgebraicExpression_Clone(op->into_ae));
+}
+
+/* Frees ExpandIntersect */
+static void ExpandIntersectFree(OpBase *ctx) {
+	OpExpandIntersect *op = (OpExpandIntersect *)ctx;
+	if(op->iter) {
+		GxB_MatrixTupleIter_free(op->iter);
+		op->iter = NULL;
+	}
+
+	if(op->F != GrB_NULL) {
+		GrB_Matrix_free(&op->F);
+		op->F = GrB_NULL;
+	}
+
+	if(op->G != GrB_NULL) {
+		GrB_Matrix_free(&op->G);
+		op->G = GrB_NULL;
+	}
+
+	if(op->M != GrB_NULL) {
+		GrB_Matrix_free(&op->M);
+		op->M = GrB_NULL;
+	}
+
+	if(op->N != GrB_NULL) {
+		GrB_Matrix_free(&op->N);
+		op->N = GrB_NULL;
+	}
+
+	if(op->ae) {
+		AlgebraicExpression_Free(op->ae);
+		op->ae = NULL;
+	}
+
+	if(op->into_ae) {
+		AlgebraicExpression_Free(op->into_ae);
+		op->into_ae = NULL;
+	}
+
+	if(op->bound_ae) {
+		AlgebraicExpression_Free(op->bound_ae);
+		op->bound_ae = NULL;
+	}
+
+	if(op->records) {
+		for(uint i = 0; i < op->record_count; i++) OpBase_DeleteRecord(op->records[i]);
+		rm_free(op->records);
+		op->records = NULL;
+	}
+}
@@ -0,0 +1,51 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "op.h"
+#include "../execution_plan.h"
+#include "../../graph/graph.h"
+#include "../../arithmetic/algebraic_expression.h"
+#include "../../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+/* ExpandIntersect closes a cycle by binding a node reachable from two
+ * already bound nodes, e.g. for the triangle (a)->(b)->(c)->(a),
+ * once both 'a' and 'b' are bound, 'c' is the intersection of b's outgoing
+ * and a's incoming neighbours.
+ * Rather than traversing from 'b' and filtering each discovered 'c' by
+ * probing for a connection to 'a' (Conditional Traverse + Expand Into),
+ * both neighbourhoods are computed for a batch of records and intersected,
+ * such that partial matches which do not close the cycle
+ * are never materialized as records. */
+typedef struct {
+	OpBase op;
+	Graph *graph;
+	AlgebraicExpression *ae;        // Traversal from the first bound node to the new node.
+	AlgebraicExpression *into_ae;   // Expression connecting the new node with the second bound node.
+	AlgebraicExpression *bound_ae;  // into_ae rooted at the second bound node, used for evaluation.
+	bool transpose;                 // into_ae's source is the new node.
+	GrB_Matrix F;                   // Filter matrix of the first bound node.
+	GrB_Matrix G;                   // Filter matrix of the second bound node.
+	GrB_Matrix M;                   // Intersection of both neighbourhoods.
+	GrB_Matrix N;                   // Neighbourhood of the second bound node.
+	GxB_MatrixTupleIter *iter;      // Iterator over M.
+	NodeID dest_label_id;           // ID of destination node label if known.
+	const char *dest_label;         // Label of destination node if known.
+	int srcNodeIdx;                 // First bound node index into record.
+	int otherNodeIdx;               // Second bound node index into record.
+	int destNodeIdx;                // New node index into record.
+	uint record_count;              // Number of held records.
+	uint record_cap;                // Max number of records to process.
+	Record *records;                // Array of records.
+} OpExpandIntersect;
+
+/* Creates a new ExpandIntersect operation,
+ * ae traverses from a bound node to the newly bound node,
+ * into_ae connects the newly bound node with another bound node,
+ * in either direction. */
+OpBase *NewExpandIntersectOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae,
+							 AlgebraicExpression *into_ae);
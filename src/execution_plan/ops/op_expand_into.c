@@ -31,14 +31,20 @@ static void _populate_filter_matrix(OpExpandInto *op) {
 		Node *n = Record_GetNode(r, op->srcNodeIdx);
 		NodeID srcId = ENTITY_GET_ID(n);
 		GrB_Matrix_setElement_BOOL(op->F, true, i, srcId);
+
+		/* Only M[i, destId] is inspected once evaluated,
+		 * mask[i, destId] = true. */
+		n = Record_GetNode(r, op->destNodeIdx);
+		NodeID destId = ENTITY_GET_ID(n);
+		GrB_Matrix_setElement_BOOL(op->mask, true, i, destId);
 	}
 }
 
 /* Evaluate algebraic expression:
  * appends filter matrix as the left most operand
- * perform multiplications.
- * removed filter matrix from original expression
- * clears filter matrix. */
+ * perform multiplications, masked by the records' destinations
+ * such that connections to other nodes are never computed.
+ * clears filter and mask matrices. */
 static void _traverse(OpExpandInto *op) {
 	// If op->F is null, this is the first time we are traversing.
 	if(op->F == GrB_NULL) {
@@ -46,6 +52,7 @@ static void _traverse(OpExpandInto *op) {
 		size_t required_dim = Graph_RequiredMatrixDim(op->graph);
 		GrB_Matrix_new(&op->M, GrB_BOOL, op->record_cap, required_dim);
 		GrB_Matrix_new(&op->F, GrB_BOOL, op->record_cap, required_dim);
+		GrB_Matrix_new(&op->mask, GrB_BOOL, op->record_cap, required_dim);
 
 		// Prepend the filter matrix to algebraic expression as the leftmost operand.
 		AlgebraicExpression_MultiplyToTheLeft(&op->ae, op->F);
@@ -58,10 +65,11 @@ static void _traverse(OpExpandInto *op) {
 	_populate_filter_matrix(op);
 
 	// Evaluate expression.
-	AlgebraicExpression_Eval(op->ae, op->M);
+	AlgebraicExpression_EvalMasked(op->ae, op->mask, op->M);
 
-	// Clear filter matrix.
+	// Clear filter and mask matrices.
 	GrB_Matrix_clear(op->F);
+	GrB_Matrix_clear(op->mask);
 }
 
 OpBase *NewExpandIntoOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression *ae) {
@@ -71,6 +79,7 @@ OpBase *NewExpandIntoOp(const ExecutionPlan *plan, Graph *g, AlgebraicExpression
 	op->r = NULL;
 	op->F = GrB_NULL;
 	op->M = GrB_NULL;
+	op->mask = GrB_NULL;
 	op->records = NULL;
 	op->record_cap = BATCH_SIZE;
 	op->record_count = 0;
@@ -208,6 +217,7 @@ static OpResult ExpandIntoReset(OpBase *ctx) {
 
 	if(op->edge_ctx) Traverse_ResetEdgeCtx(op->edge_ctx);
 	if(op->F != GrB_NULL) GrB_Matrix_clear(op->F);
+	if(op->mask != GrB_NULL) GrB_Matrix_clear(op->mask);
 	return OP_OK;
 }
 
@@ -230,6 +240,11 @@ static void ExpandIntoFree(OpBase *ctx) {
 		op->M = GrB_NULL;
 	}
 
+	if(op->mask != GrB_NULL) {
+		GrB_Matrix_free(&op->mask);
+		op->mask = GrB_NULL;
+	}
+
 	if(op->ae) {
 		AlgebraicExpression_Free(op->ae);
 		op->ae = NULL;
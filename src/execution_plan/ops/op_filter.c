@@ -9,16 +9,20 @@
 
 /* Forward declarations. */
 static Record FilterConsume(OpBase *opBase);
+static uint FilterConsumeBatch(OpBase *opBase, Record *batch, uint cap);
 static OpBase *FilterClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void FilterFree(OpBase *opBase);
 
 OpBase *NewFilterOp(const ExecutionPlan *plan, FT_FilterNode *filterTree) {
 	OpFilter *op = rm_malloc(sizeof(OpFilter));
 	op->filterTree = filterTree;
+	op->pending = NULL;
+	op->pending_count = 0;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_FILTER, "Filter", NULL, FilterConsume,
 				NULL, NULL, FilterClone, FilterFree, false, plan);
+	OpBase_UpdateConsumeBatch((OpBase *)op, FilterConsumeBatch);
 
 	return (OpBase *)op;
 }
@@ -42,6 +46,38 @@ static Record FilterConsume(OpBase *opBase) {
 	return r;
 }
 
+/* FilterConsumeBatch pulls a block of records from child
+ * and compacts the ones passing the filter tree to the front of the batch.
+ * returns 0 only once child is depleted. */
+static uint FilterConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	OpFilter *filter = (OpFilter *)opBase;
+	OpBase *child = filter->op.children[0];
+
+	// child records are held by the operation until filtered
+	// such that they can be released if evaluation raises an error
+	if(filter->pending == NULL) filter->pending = rm_malloc(sizeof(Record) * OP_BATCH_CAP);
+	if(cap > OP_BATCH_CAP) cap = OP_BATCH_CAP;
+
+	uint passed = 0;
+	while(passed == 0) {
+		uint n = OpBase_ConsumeBatch(child, filter->pending, cap);
+		if(n == 0) break;
+
+		filter->pending_count = n;
+		uint64_t selection = FilterTree_applyFiltersBatch(filter->filterTree,
+				filter->pending, n);
+		filter->pending_count = 0;
+
+		for(uint i = 0; i < n; i++) {
+			Record r = filter->pending[i];
+			if(selection & (1ULL << i)) batch[passed++] = r;
+			else OpBase_DeleteRecord(r);
+		}
+	}
+
+	return passed;
+}
+
 static inline OpBase *FilterClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	ASSERT(opBase->type == OPType_FILTER);
 	OpFilter *op = (OpFilter *)opBase;
@@ -55,5 +91,13 @@ static void FilterFree(OpBase *ctx) {
 		FilterTree_Free(filter->filterTree);
 		filter->filterTree = NULL;
 	}
+
+	if(filter->pending) {
+		for(uint i = 0; i < filter->pending_count; i++) {
+			OpBase_DeleteRecord(filter->pending[i]);
+		}
+		rm_free(filter->pending);
+		filter->pending = NULL;
+	}
 }
 
@@ -15,6 +15,8 @@
 typedef struct {
 	OpBase op;
 	FT_FilterNode *filterTree;
+	Record *pending;     // Child records awaiting filtering by the batch path.
+	uint pending_count;  // Number of pending records.
 } OpFilter;
 
 /* Creates a new Filter operation */
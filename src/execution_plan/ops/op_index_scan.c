@@ -6,13 +6,26 @@
 
 #include "op_index_scan.h"
 #include "../../query_ctx.h"
+#include "../../util/arr.h"
+#include "../../util/qsort.h"
 #include "shared/print_functions.h"
 #include "../../filter_tree/ft_to_rsq.h"
+#include <math.h>
+#include <string.h>
+
+// number of input records to accumulate before looking them up
+#define LOOKUP_BATCH_SIZE 64
+
+// maximum number of nodes queried at once by an ordered range scan
+#define ORDERED_PAGE_SIZE 1024
 
 // forward declarations
 static OpResult IndexScanInit(OpBase *opBase);
 static Record IndexScanConsume(OpBase *opBase);
 static Record IndexScanConsumeFromChild(OpBase *opBase);
+static Record IndexRangeScanConsume(OpBase *opBase);
+static Record IndexRangeScanConsumeFromChild(OpBase *opBase);
+static Record IndexLookupScanConsume(OpBase *opBase);
 static OpResult IndexScanReset(OpBase *opBase);
 static void IndexScanFree(OpBase *opBase);
 
@@ -38,6 +51,22 @@ OpBase *NewIndexScanOp(const ExecutionPlan *plan, Graph *g, NodeScanCtx n,
 	op->child_record         =  NULL;
 	op->unresolved_filters   =  NULL;
 	op->rebuild_index_query  =  false;
+	op->range                =  NULL;
+	op->runtime_bounds       =  false;
+	op->range_fallback       =  false;
+	op->range_ids            =  NULL;
+	op->range_pos            =  0;
+	op->ordered              =  false;
+	op->descending           =  false;
+	op->range_depleted       =  false;
+	op->composite            =  NULL;
+	op->composite_prefix_len =  0;
+	op->composite_has_range  =  false;
+	op->lookup_exp           =  NULL;
+	op->lookup_records       =  NULL;
+	op->lookup_record_count  =  0;
+	op->lookup_matches       =  NULL;
+	op->lookup_pos           =  0;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_INDEX_SCAN, "Index Scan", IndexScanInit, IndexScanConsume,
@@ -47,10 +76,121 @@ OpBase *NewIndexScanOp(const ExecutionPlan *plan, Graph *g, NodeScanCtx n,
 	return (OpBase *)op;
 }
 
+OpBase *NewIndexRangeScanOp(const ExecutionPlan *plan, Graph *g,
+		NodeScanCtx n, RSIndex *idx, RangeIndex *range,
+		const NumericRange *bounds, FT_FilterNode *filter) {
+	ASSERT(range != NULL);
+
+	IndexScan *op = (IndexScan *)NewIndexScanOp(plan, g, n, idx, filter);
+	op->range           =  range;
+	op->runtime_bounds  =  (bounds == NULL);
+	if(bounds != NULL) op->range_bounds = *bounds;
+
+	return (OpBase *)op;
+}
+
+OpBase *NewIndexCompositeScanOp(const ExecutionPlan *plan, Graph *g,
+		NodeScanCtx n, RSIndex *idx, CompositeIndex *composite,
+		const double *prefix, uint prefix_len, const NumericRange *bounds,
+		FT_FilterNode *filter) {
+	ASSERT(composite != NULL);
+	ASSERT(prefix_len + (bounds != NULL) <= composite->key_count);
+
+	IndexScan *op = (IndexScan *)NewIndexScanOp(plan, g, n, idx, filter);
+	op->composite             =  composite;
+	op->composite_prefix_len  =  prefix_len;
+	op->composite_has_range   =  (bounds != NULL);
+	if(prefix_len > 0) {
+		memcpy(op->composite_prefix, prefix, sizeof(double) * prefix_len);
+	}
+	if(bounds != NULL) op->range_bounds = *bounds;
+
+	return (OpBase *)op;
+}
+
+int IndexScan_OrderedCompositeKey(const IndexScan *op) {
+	ASSERT(op != NULL);
+	if(op->composite == NULL) return -1;
+	// nodes sharing the prefix are ordered by the following key
+	if(op->composite_prefix_len == op->composite->key_count) return -1;
+	return op->composite_prefix_len;
+}
+
+void IndexScan_SetOrder(IndexScan *op, bool descending) {
+	ASSERT(op != NULL);
+	ASSERT(op->range != NULL && op->lookup_exp == NULL);
+	op->ordered = true;
+	op->descending = descending;
+}
+
+OpBase *NewIndexLookupScanOp(const ExecutionPlan *plan, Graph *g,
+		NodeScanCtx n, RSIndex *idx, RangeIndex *range,
+		AR_ExpNode *lookup_exp, FT_FilterNode *filter) {
+	ASSERT(range      != NULL);
+	ASSERT(lookup_exp != NULL);
+
+	IndexScan *op = (IndexScan *)NewIndexScanOp(plan, g, n, idx, filter);
+	op->range       =  range;
+	op->lookup_exp  =  lookup_exp;
+
+	return (OpBase *)op;
+}
+
+// returns true if op is resolved by a native range or composite index
+// rather than by RediSearch
+static inline bool _ScansRange(const IndexScan *op) {
+	return (op->range != NULL && !op->range_fallback) || op->composite != NULL;
+}
+
+// tightens range by each of filter's constraints, evaluating their bounds
+// filter is a conjunction of n.v OP exp predicates, where exp is entity free
+// returns false if a bound isn't numeric, such bounds are resolved by RediSearch
+static bool _EvaluateRangeBounds(FT_FilterNode *filter, NumericRange *range) {
+	if(filter->t == FT_N_COND) {
+		ASSERT(filter->cond.op == OP_AND);
+		return (_EvaluateRangeBounds(filter->cond.left, range) &&
+				_EvaluateRangeBounds(filter->cond.right, range));
+	}
+
+	ASSERT(filter->t == FT_N_PRED);
+	// only numeric values are part of the range index
+	SIValue v = AR_EXP_Evaluate(filter->pred.rhs, NULL);
+	bool numeric = (SI_TYPE(v) & SI_NUMERIC);
+	if(numeric && !isnan(SI_GET_NUMERIC(v))) {
+		NumericRange_TightenRange(range, filter->pred.op, SI_GET_NUMERIC(v));
+	} else if(numeric) {
+		range->valid = false;
+	}
+	SIValue_Free(v);
+	return numeric;
+}
+
 static OpResult IndexScanInit(OpBase *opBase) {
 	IndexScan *op = (IndexScan *)opBase;
 
-	if(opBase->childCount > 0) {
+	// bounds relying on runtime values are evaluated once per query
+	op->range_fallback = false;
+	if(op->runtime_bounds) {
+		NumericRange range = {.min = -INFINITY, .max = INFINITY,
+			.include_min = false, .include_max = false, .valid = true};
+		op->range_fallback = !_EvaluateRangeBounds(op->filter, &range);
+		op->range_bounds = range;
+	}
+
+	if(op->lookup_exp != NULL) {
+		// lookup value is resolved against each input record
+		ASSERT(opBase->childCount > 0);
+		op->lookup_records = rm_malloc(sizeof(Record) * LOOKUP_BATCH_SIZE);
+		op->lookup_matches = array_new(IndexLookupMatch, LOOKUP_BATCH_SIZE);
+		OpBase_UpdateConsume(opBase, IndexLookupScanConsume);
+	} else if(_ScansRange(op)) {
+		// range bounds are constant, no need to rebuild per input record
+		if(opBase->childCount > 0) {
+			OpBase_UpdateConsume(opBase, IndexRangeScanConsumeFromChild);
+		} else {
+			OpBase_UpdateConsume(opBase, IndexRangeScanConsume);
+		}
+	} else if(opBase->childCount > 0) {
 		// find out how many different entities are refered to 
 		// within the filter tree, if number of entities equals 1
 		// (current node being scanned) there's no need to re-build the index
@@ -172,7 +312,6 @@ pull_index:
 			// first call to consume, create query and iterator
 			RSQNode *rs_query_node = FilterTreeToQueryNode(&op->unresolved_filters, op->filter, op->idx);
 			ASSERT(rs_query_node != NULL);
-			ASSERT(op->unresolved_filters == NULL);
 			op->iter = RediSearch_GetResultsIterator(rs_query_node, op->idx);
 		} else {
 			// reset existing iterator
@@ -189,28 +328,215 @@ static Record IndexScanConsume(OpBase *opBase) {
 
 	// create iterator on first call
 	if(op->iter == NULL) {
+		// unresolved filters, e.g. distance, are applied to index results
 		RSQNode *rs_query_node = FilterTreeToQueryNode(&op->unresolved_filters,
 				op->filter, op->idx);
-		ASSERT(op->unresolved_filters == NULL);
 
 		op->iter = RediSearch_GetResultsIterator(rs_query_node, op->idx);
 	}
 
-	const EntityID *nodeId = RediSearch_ResultsIteratorNext(op->iter, op->idx,
-			NULL);
-	if(!nodeId) return NULL;
+	const EntityID *nodeId;
+	while((nodeId = RediSearch_ResultsIteratorNext(op->iter, op->idx, NULL))
+			!= NULL) {
+		// populate the Record with the actual node
+		Record r = OpBase_CreateRecord((OpBase *)op);
+		_UpdateRecord(op, r, *nodeId);
+		if(_PassUnresolvedFilters(op, r)) return r;
+		OpBase_DeleteRecord(r);
+	}
+
+	return NULL;
+}
+
+// query range index once, reported ids are sorted
+// such that nodes are fetched in storage order
+// composite index ids are reported in key order
+static inline void _QueryRangeIndex(IndexScan *op) {
+	if(op->range_ids != NULL) return;
+	if(op->composite != NULL) {
+		const NumericRange *bounds = (op->composite_has_range) ?
+			&op->range_bounds : NULL;
+		op->range_ids = CompositeIndex_Query(op->composite,
+				op->composite_prefix, op->composite_prefix_len, bounds);
+	} else {
+		if(op->ordered) {
+			// input records replay the range, query it at once
+			uint64_t page = (op->op.childCount > 0) ? UINT64_MAX :
+				OpBase_BatchSize((OpBase *)op, ORDERED_PAGE_SIZE);
+			op->range_ids = RangeIndex_QueryOrdered(op->range,
+					&op->range_bounds, op->descending, NULL, page);
+			op->range_depleted = (array_len(op->range_ids) < page);
+		} else {
+			op->range_ids = RangeIndex_Query(op->range, &op->range_bounds);
+		}
+	}
+	op->range_pos = 0;
+}
+
+// query the page of ordered range index nodes following the current one
+// returns false if there are no further nodes
+static bool _QueryNextPage(IndexScan *op) {
+	if(!op->ordered || op->range_depleted) return false;
+
+	uint count = array_len(op->range_ids);
+	ASSERT(count > 0);
+	NodeID last = op->range_ids[count - 1];
+	array_free(op->range_ids);
+
+	op->range_ids = RangeIndex_QueryOrdered(op->range, &op->range_bounds,
+			op->descending, &last, ORDERED_PAGE_SIZE);
+	op->range_depleted = (array_len(op->range_ids) < ORDERED_PAGE_SIZE);
+	op->range_pos = 0;
+	return array_len(op->range_ids) > 0;
+}
+
+static Record IndexRangeScanConsume(OpBase *opBase) {
+	IndexScan *op = (IndexScan *)opBase;
+
+	_QueryRangeIndex(op);
+	if(op->range_pos == array_len(op->range_ids)) {
+		if(!_QueryNextPage(op)) return NULL;
+	}
 
 	// populate the Record with the actual node
 	Record r = OpBase_CreateRecord((OpBase *)op);
-	_UpdateRecord(op, r, *nodeId);
+	_UpdateRecord(op, r, op->range_ids[op->range_pos++]);
 
 	return r;
 }
 
+static Record IndexRangeScanConsumeFromChild(OpBase *opBase) {
+	IndexScan *op = (IndexScan *)opBase;
+
+	_QueryRangeIndex(op);
+	uint id_count = array_len(op->range_ids);
+
+	while(op->child_record == NULL || op->range_pos == id_count) {
+		// free input record
+		if(op->child_record != NULL) {
+			OpBase_DeleteRecord(op->child_record);
+			op->child_record = NULL;
+		}
+
+		op->child_record = OpBase_Consume(op->op.children[0]);
+		if(op->child_record == NULL) return NULL; // depleted
+
+		// rescan range for each input record
+		op->range_pos = 0;
+	}
+
+	_UpdateRecord(op, op->child_record, op->range_ids[op->range_pos++]);
+	// clone the held Record, as it will be freed upstream
+	return OpBase_CloneRecord(op->child_record);
+}
+
+// a looked up value and the input record it was evaluated against
+typedef struct {
+	double key;
+	uint rec;
+} LookupKey;
+
+#define KEY_ISLT(a, b) ((a)->key < (b)->key)
+#define MATCH_ISLT(a, b) \
+	((a)->id < (b)->id || ((a)->id == (b)->id && (a)->rec < (b)->rec))
+
+static void _ClearLookupBatch(IndexScan *op) {
+	for(uint i = 0; i < op->lookup_record_count; i++) {
+		OpBase_DeleteRecord(op->lookup_records[i]);
+	}
+	op->lookup_record_count = 0;
+	op->lookup_pos = 0;
+	if(op->lookup_matches != NULL) array_clear(op->lookup_matches);
+}
+
+// pulls a batch of input records and looks up each distinct value once
+// matches are sorted by node id, such that nodes are fetched in storage order
+// returns false once child is depleted
+static bool _LookupBatch(IndexScan *op) {
+	OpBase *child = op->op.children[0];
+	LookupKey keys[LOOKUP_BATCH_SIZE];
+
+	_ClearLookupBatch(op);
+
+	uint batch_size = OpBase_BatchSize((OpBase *)op, LOOKUP_BATCH_SIZE);
+	while(op->lookup_record_count < batch_size) {
+		Record r = OpBase_Consume(child);
+		if(r == NULL) break; // child depleted
+
+		// only numeric values are part of the range index
+		// any other value can't be equal to an indexed value
+		SIValue v = AR_EXP_Evaluate(op->lookup_exp, r);
+		bool numeric = (SI_TYPE(v) & SI_NUMERIC) && !isnan(SI_GET_NUMERIC(v));
+		double key = numeric ? SI_GET_NUMERIC(v) : 0;
+		SIValue_Free(v);
+		if(!numeric) {
+			OpBase_DeleteRecord(r);
+			continue;
+		}
+
+		// record is held while subsequent ones are pulled
+		Record_PersistScalars(r);
+		keys[op->lookup_record_count].key = key;
+		keys[op->lookup_record_count].rec = op->lookup_record_count;
+		op->lookup_records[op->lookup_record_count++] = r;
+	}
+
+	if(op->lookup_record_count == 0) return false;
+
+	// group records by value, query each distinct value once
+	QSORT(LookupKey, keys, op->lookup_record_count, KEY_ISLT);
+
+	uint i = 0;
+	while(i < op->lookup_record_count) {
+		uint j = i + 1;
+		while(j < op->lookup_record_count && keys[j].key == keys[i].key) j++;
+
+		NumericRange bounds = {.min = keys[i].key, .max = keys[i].key,
+			.include_min = true, .include_max = true, .valid = true};
+		NodeID *ids = RangeIndex_Query(op->range, &bounds);
+		uint id_count = array_len(ids);
+		for(uint k = 0; k < id_count; k++) {
+			for(uint l = i; l < j; l++) {
+				IndexLookupMatch m = {.id = ids[k], .rec = keys[l].rec};
+				array_append(op->lookup_matches, m);
+			}
+		}
+		array_free(ids);
+		i = j;
+	}
+
+	uint match_count = array_len(op->lookup_matches);
+	QSORT(IndexLookupMatch, op->lookup_matches, match_count, MATCH_ISLT);
+
+	return true;
+}
+
+static Record IndexLookupScanConsume(OpBase *opBase) {
+	IndexScan *op = (IndexScan *)opBase;
+
+	// batches might not yield any match, keep pulling
+	while(op->lookup_pos == array_len(op->lookup_matches)) {
+		if(!_LookupBatch(op)) return NULL; // depleted
+	}
+
+	IndexLookupMatch m = op->lookup_matches[op->lookup_pos++];
+	Record r = OpBase_CloneRecord(op->lookup_records[m.rec]);
+	_UpdateRecord(op, r, m.id);
+	return r;
+}
+
 static OpResult IndexScanReset(OpBase *opBase) {
 	IndexScan *op = (IndexScan *)opBase;
 
-	if(op->rebuild_index_query) {
+	if(op->lookup_exp != NULL) {
+		_ClearLookupBatch(op);
+	} else if(_ScansRange(op)) {
+		// index might have changed, requery on next call to consume
+		array_free(op->range_ids);
+		op->range_ids = NULL;
+		op->range_pos = 0;
+		op->range_depleted = false;
+	} else if(op->rebuild_index_query) {
 		RediSearch_ResultsIteratorFree(op->iter);
 		op->iter = NULL;
 	} else {
@@ -236,6 +562,22 @@ static void IndexScanFree(OpBase *opBase) {
 		op->child_record = NULL;
 	}
 
+	if(op->range_ids) {
+		array_free(op->range_ids);
+		op->range_ids = NULL;
+	}
+
+	if(op->lookup_records) {
+		_ClearLookupBatch(op);
+		rm_free(op->lookup_records);
+		op->lookup_records = NULL;
+	}
+
+	if(op->lookup_matches) {
+		array_free(op->lookup_matches);
+		op->lookup_matches = NULL;
+	}
+
 	if(op->filter) {
 		FilterTree_Free(op->filter);
 		op->filter = NULL;
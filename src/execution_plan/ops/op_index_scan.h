@@ -13,6 +13,12 @@
 #include "shared/scan_functions.h"
 #include "redisearch_api.h"
 
+// a node matched by an index lookup and the input record it was looked up for
+typedef struct {
+	NodeID id;   // matched node
+	uint rec;    // position of input record within the current batch
+} IndexLookupMatch;
+
 typedef struct {
 	OpBase op;
 	Graph *g;
@@ -24,9 +30,63 @@ typedef struct {
 	FT_FilterNode *filter;              // filter from which to compose index query
 	FT_FilterNode *unresolved_filters;  // subset of filter, contains filters that couldn't be resolved by index
 	Record child_record;                // the Record this op acts on if it is not a tap
+	RangeIndex *range;                  // native range index, bypasses RediSearch if set
+	NumericRange range_bounds;          // range to scan
+	bool runtime_bounds;                // range_bounds are evaluated from filter on each query
+	bool range_fallback;                // runtime bounds aren't numeric, RediSearch resolves filter
+	CompositeIndex *composite;          // native composite index, bypasses RediSearch if set
+	double composite_prefix[COMPOSITE_INDEX_MAX_FIELDS];  // leading composite key values
+	uint composite_prefix_len;          // number of leading composite key values
+	bool composite_has_range;           // range_bounds constrains the key following the prefix
+	NodeID *range_ids;                  // ids within range, ascending
+	uint range_pos;                     // position of next id to report
+	bool ordered;                       // report range index nodes in key order
+	bool descending;                    // key order is descending
+	bool range_depleted;                // every node within range was queried
+	AR_ExpNode *lookup_exp;             // runtime value looked up in range index, owned by filter
+	Record *lookup_records;             // batch of input records
+	uint lookup_record_count;           // number of records in batch
+	IndexLookupMatch *lookup_matches;   // matches of current batch, ascending by node id
+	uint lookup_pos;                    // position of next match to report
 } IndexScan;
 
 // creates a new IndexScan operation
 OpBase *NewIndexScanOp(const ExecutionPlan *plan, Graph *g, NodeScanCtx n,
 		RSIndex *idx, FT_FilterNode *filter);
 
+// creates a new IndexScan operation which scans a numeric range index
+// 'filter' must be fully resolved by 'bounds'
+// if 'bounds' is NULL they're evaluated from 'filter' once per query
+// as its constraints rely on values known only at runtime, e.g. timestamp()
+// should a bound evaluate to a non numeric value 'filter' is left to RediSearch
+OpBase *NewIndexRangeScanOp(const ExecutionPlan *plan, Graph *g,
+		NodeScanCtx n, RSIndex *idx, RangeIndex *range,
+		const NumericRange *bounds, FT_FilterNode *filter);
+
+// creates a new IndexScan operation which scans a composite index
+// reporting nodes whose leading 'prefix_len' keys equal 'prefix'
+// and, if 'bounds' is specified, whose next key lies within 'bounds'
+// nodes are reported in key order
+// 'filter' must be fully resolved by 'prefix' and 'bounds'
+OpBase *NewIndexCompositeScanOp(const ExecutionPlan *plan, Graph *g,
+		NodeScanCtx n, RSIndex *idx, CompositeIndex *composite,
+		const double *prefix, uint prefix_len, const NumericRange *bounds,
+		FT_FilterNode *filter);
+
+// returns the composite key column reported in order by 'op'
+// -1 if op doesn't report nodes in the order of an attribute
+int IndexScan_OrderedCompositeKey(const IndexScan *op);
+
+// report nodes of a range index scan in the order of the indexed attribute
+// ascending or descending, nodes are queried in pages sized by the op's
+// limit hint, such that only the required prefix of the range is visited
+void IndexScan_SetOrder(IndexScan *op, bool descending);
+
+// creates a new IndexScan operation which joins its input records
+// with the nodes whose indexed attribute equals 'lookup_exp'
+// 'filter' must be a single equality predicate with 'lookup_exp' as its
+// right hand side, evaluated against each input record
+OpBase *NewIndexLookupScanOp(const ExecutionPlan *plan, Graph *g,
+		NodeScanCtx n, RSIndex *idx, RangeIndex *range,
+		AR_ExpNode *lookup_exp, FT_FilterNode *filter);
+
@@ -6,35 +6,257 @@
 
 #include "op_join.h"
 #include "RG.h"
+#include "../../errors.h"
+#include "../../config.h"
 #include "../../query_ctx.h"
+#include "../../util/arr.h"
+#include "../../util/rmalloc.h"
+#include "../../util/thpool/pools.h"
+#include <string.h>
+#include <pthread.h>
 
 /* Forward declarations. */
 static Record JoinConsume(OpBase *opBase);
 static OpResult JoinReset(OpBase *opBase);
 static OpResult JoinInit(OpBase *opBase);
 static OpBase *JoinClone(const ExecutionPlan *plan, const OpBase *opBase);
+static void JoinFree(OpBase *opBase);
+
+// streams executed concurrently, shared by the query's thread
+// and the reader tasks helping it
+typedef struct {
+	OpBase **streams;         // Streams to execute.
+	Record **buffers;         // Records produced by each stream.
+	char **errors;            // Error raised by each stream, if any.
+	int64_t *memory;          // Bytes allocated by reader tasks for each stream.
+	QueryCtx *query_ctx;      // Query's context, shared with reader tasks.
+	uint count;               // Number of streams.
+	uint next;                // Next stream to execute.
+	uint pending;             // Number of streams yet to be executed.
+	uint ref_count;           // Query's thread and each queued task.
+	pthread_mutex_t mutex;    // Guards pending.
+	pthread_cond_t done;      // Signaled once all streams have been executed.
+} JoinStreams;
 
 OpBase *NewJoinOp(const ExecutionPlan *plan) {
 	OpJoin *op = rm_malloc(sizeof(OpJoin));
 	op->stream = NULL;
+	op->parallel = false;
+	op->buffers = NULL;
+	op->bufferIdx = 0;
 
 	// Set our Op operations
-	OpBase_Init((OpBase *)op, OPType_JOIN, "Join", JoinInit, JoinConsume, NULL, NULL, JoinClone, NULL,
-				false, plan);
+	OpBase_Init((OpBase *)op, OPType_JOIN, "Join", JoinInit, JoinConsume, JoinReset, NULL, JoinClone,
+				JoinFree, false, plan);
 
 	return (OpBase *)op;
 }
 
+// streams may execute on reader threads unless they modify the graph
+// or call procedures, which are not safe to execute concurrently
+static bool _Join_Parallelizable(const OpBase *op) {
+	if(op->writer || op->type == OPType_PROC_CALL) return false;
+	for(int i = 0; i < op->childCount; i++) {
+		if(!_Join_Parallelizable(op->children[i])) return false;
+	}
+	return true;
+}
+
 static OpResult JoinInit(OpBase *opBase) {
 	OpJoin *op = (OpJoin *)opBase;
 	// Start pulling from first stream.
 	op->streamIdx = 0;
 	op->stream = op->op.children[op->streamIdx];
+
+	// profiled streams are executed sequentially, such that
+	// each operation's execution time remains accurate
+	uint parallelism;
+	Config_Option_get(Config_BRANCH_PARALLELISM, &parallelism);
+	op->parallel = parallelism > 1 && op->op.childCount > 1 && op->op.stats == NULL;
+	for(int i = 0; op->parallel && i < op->op.childCount; i++) {
+		op->parallel = _Join_Parallelizable(op->op.children[i]);
+	}
+
 	return OP_OK;
 }
 
+//------------------------------------------------------------------------------
+// Concurrent stream execution
+//------------------------------------------------------------------------------
+
+static void _JoinStreams_Release(JoinStreams *s) {
+	if(__atomic_sub_fetch(&s->ref_count, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+	pthread_mutex_destroy(&s->mutex);
+	pthread_cond_destroy(&s->done);
+	rm_free(s->buffers);
+	rm_free(s->errors);
+	rm_free(s->memory);
+	rm_free(s);
+}
+
+// buffers stream i's records, the error it raised is handed over
+// to the query's thread, which raises it once all streams have been executed
+static void _Join_ExecuteStream(JoinStreams *s, uint i) {
+	ErrorCtx *ctx = ErrorCtx_Get();
+
+	// the query's thread restores its own exception handler
+	jmp_buf outer;
+	bool nested = (ctx->breakpoint != NULL);
+	if(nested) memcpy(outer, *ctx->breakpoint, sizeof(jmp_buf));
+
+	s->buffers[i] = array_new(Record, 32);
+	if(SET_EXCEPTION_HANDLER() == 0) {
+		Record r;
+		while((r = OpBase_Consume(s->streams[i]))) {
+			s->buffers[i] = array_append(s->buffers[i], r);
+		}
+	}
+
+	s->errors[i] = ctx->error;
+	ctx->error = NULL;
+
+	if(nested) {
+		memcpy(*ctx->breakpoint, outer, sizeof(jmp_buf));
+	} else {
+		ErrorCtx_Clear();
+	}
+}
+
+static void _Join_CompleteStream(JoinStreams *s) {
+	pthread_mutex_lock(&s->mutex);
+	if(--s->pending == 0) pthread_cond_signal(&s->done);
+	pthread_mutex_unlock(&s->mutex);
+}
+
+// reader task, executes streams until none is left
+static void _Join_StreamsTask(void *arg) {
+	JoinStreams *s = arg;
+
+	uint i;
+	while((i = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED)) < s->count) {
+		QueryCtx_SetTLS(s->query_ctx);
+		int64_t mem = Alloc_GetConsumption();
+		_Join_ExecuteStream(s, i);
+		// records are freed by the query's thread, which accounts for them
+		s->memory[i] = Alloc_GetConsumption() - mem;
+		QueryCtx_RemoveFromTLS();
+		_Join_CompleteStream(s);
+	}
+
+	_JoinStreams_Release(s);
+}
+
+// releases the buffered records yet to be emitted
+static void _Join_ReleaseBuffers(OpJoin *op) {
+	if(op->buffers == NULL) return;
+
+	for(int i = 0; i < op->op.childCount; i++) {
+		Record *buffer = op->buffers[i];
+		if(buffer == NULL) continue;
+
+		uint count = array_len(buffer);
+		uint first = 0;
+		if(i < op->streamIdx) first = count;
+		else if(i == op->streamIdx) first = op->bufferIdx;
+		for(uint j = first; j < count; j++) OpBase_DeleteRecord(buffer[j]);
+		array_free(buffer);
+	}
+
+	rm_free(op->buffers);
+	op->buffers = NULL;
+}
+
+// executes all streams, up to BRANCH_PARALLELISM of them concurrently
+// the query's thread executes streams as well, such that it never waits
+// on a task still queued behind other queries
+static void _Join_ExecuteStreams(OpJoin *op) {
+	uint count = op->op.childCount;
+
+	JoinStreams *s = rm_calloc(1, sizeof(JoinStreams));
+	s->streams = op->op.children;
+	s->buffers = rm_calloc(count, sizeof(Record *));
+	s->errors = rm_calloc(count, sizeof(char *));
+	s->memory = rm_calloc(count, sizeof(int64_t));
+	s->query_ctx = QueryCtx_GetQueryCtx();
+	s->count = count;
+	s->pending = count;
+	s->ref_count = 1;
+	pthread_mutex_init(&s->mutex, NULL);
+	pthread_cond_init(&s->done, NULL);
+
+	// parameters are lazily set up, do so ahead of the tasks
+	QueryCtx_GetParams();
+
+	uint parallelism;
+	Config_Option_get(Config_BRANCH_PARALLELISM, &parallelism);
+	uint tasks = ((parallelism < count) ? parallelism : count) - 1;
+	for(uint i = 0; i < tasks; i++) {
+		__atomic_add_fetch(&s->ref_count, 1, __ATOMIC_RELAXED);
+		if(ThreadPools_AddWorkReader(_Join_StreamsTask, s) == THPOOL_QUEUE_FULL) {
+			__atomic_sub_fetch(&s->ref_count, 1, __ATOMIC_RELAXED);
+			break;
+		}
+	}
+
+	uint i;
+	while((i = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED)) < count) {
+		_Join_ExecuteStream(s, i);
+		_Join_CompleteStream(s);
+	}
+
+	pthread_mutex_lock(&s->mutex);
+	while(s->pending > 0) pthread_cond_wait(&s->done, &s->mutex);
+	pthread_mutex_unlock(&s->mutex);
+
+	op->buffers = s->buffers;
+	s->buffers = NULL;
+	op->bufferIdx = 0;
+
+	char *error = NULL;
+	for(i = 0; i < count; i++) {
+		Alloc_AddConsumption(s->memory[i]);
+		if(s->errors[i] == NULL) continue;
+		if(error == NULL) error = s->errors[i];
+		else free(s->errors[i]);
+	}
+	_JoinStreams_Release(s);
+
+	if(error != NULL) {
+		_Join_ReleaseBuffers(op);
+		ErrorCtx_SetError("%s", error);
+		free(error);
+		ErrorCtx_RaiseRuntimeException(NULL);
+	}
+}
+
+// emits the buffered records of each stream, in the streams' order
+static Record _JoinConsumeBuffered(OpJoin *op) {
+	if(op->buffers == NULL) _Join_ExecuteStreams(op);
+
+	while(op->streamIdx < op->op.childCount) {
+		Record *buffer = op->buffers[op->streamIdx];
+		if(op->bufferIdx < array_len(buffer)) {
+			Record r = buffer[op->bufferIdx];
+			// Switched streams, update the ResultSet column map to match the new record mapping.
+			if(op->bufferIdx == 0 && op->streamIdx > 0) {
+				ResultSet_MapProjection(QueryCtx_GetResultSet(), r);
+			}
+			op->bufferIdx++;
+			return r;
+		}
+
+		op->streamIdx++;
+		op->bufferIdx = 0;
+	}
+
+	return NULL;
+}
+
 static Record JoinConsume(OpBase *opBase) {
 	OpJoin *op = (OpJoin *)opBase;
+	if(op->parallel) return _JoinConsumeBuffered(op);
+
 	Record r = NULL;
 
 	bool update_column_map = false;
@@ -65,7 +287,9 @@ static Record JoinConsume(OpBase *opBase) {
 
 static OpResult JoinReset(OpBase *opBase) {
 	OpJoin *op = (OpJoin *)opBase;
+	_Join_ReleaseBuffers(op);
 	op->streamIdx = 0;
+	op->bufferIdx = 0;
 	op->stream = op->op.children[op->streamIdx];
 	return OP_OK;
 }
@@ -75,3 +299,7 @@ static inline OpBase *JoinClone(const ExecutionPlan *plan, const OpBase *opBase)
 	return NewJoinOp(plan);
 }
 
+static void JoinFree(OpBase *opBase) {
+	OpJoin *op = (OpJoin *)opBase;
+	_Join_ReleaseBuffers(op);
+}
@@ -13,6 +13,9 @@ typedef struct {
 	OpBase op;
     OpBase *stream;     // Current stream to pull from.
     int streamIdx;      // Current stream index.
+    bool parallel;      // Streams are executed concurrently, their records buffered.
+    Record **buffers;   // Records of each stream, once executed concurrently.
+    uint bufferIdx;     // Next record of the current stream's buffer.
 } OpJoin;
 
 OpBase *NewJoinOp(const ExecutionPlan *plan);
@@ -11,6 +11,7 @@
 
 /* Forward declarations. */
 static Record LimitConsume(OpBase *opBase);
+static uint LimitConsumeBatch(OpBase *opBase, Record *batch, uint cap);
 static OpResult LimitReset(OpBase *opBase);
 static void LimitFree(OpBase *opBase);
 static OpBase *LimitClone(const ExecutionPlan *plan, const OpBase *opBase);
@@ -51,6 +52,7 @@ OpBase *NewLimitOp(const ExecutionPlan *plan, AR_ExpNode *limit_exp) {
 	// set operations
 	OpBase_Init((OpBase *)op, OPType_LIMIT, "Limit", NULL, LimitConsume, LimitReset, NULL,
 				LimitClone, LimitFree, false, plan);
+	OpBase_UpdateConsumeBatch((OpBase *)op, LimitConsumeBatch);
 
 	return (OpBase *)op;
 }
@@ -67,6 +69,21 @@ static Record LimitConsume(OpBase *opBase) {
 	return OpBase_Consume(child);
 }
 
+/* Limit batch consume operation
+ * requests no more than the remaining number of records from child */
+static uint LimitConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	OpLimit *op = (OpLimit *)opBase;
+
+	// Have we reached our limit?
+	if(op->consumed >= op->limit) return 0;
+	if(cap > op->limit - op->consumed) cap = op->limit - op->consumed;
+
+	OpBase *child = op->op.children[0];
+	uint n = OpBase_ConsumeBatch(child, batch, cap);
+	op->consumed += n;
+	return n;
+}
+
 static OpResult LimitReset(OpBase *ctx) {
 	OpLimit *limit = (OpLimit *)ctx;
 	limit->consumed = 0;
@@ -10,6 +10,8 @@
 #include "op_merge_create.h"
 #include "../../query_ctx.h"
 #include "../../schema/schema.h"
+#include "../../util/qsort.h"
+#include "../../index/index_batch.h"
 #include "../../arithmetic/arithmetic_expression.h"
 #include "../execution_plan_build/execution_plan_modify.h"
 
@@ -22,19 +24,42 @@ static void MergeFree(OpBase *opBase);
 //------------------------------------------------------------------------------
 // ON MATCH / ON CREATE logic
 //------------------------------------------------------------------------------
-// Perform necessary index updates.
-static void _UpdateIndices(GraphContext *gc, Node *n) {
+// Request necessary index updates, applied once all updates are performed.
+static void _UpdateIndices(GraphContext *gc, IndexBatch *batch, Node *n) {
 	int label_id = Graph_GetNodeLabel(gc->g, ENTITY_GET_ID(n));
 	if(label_id == GRAPH_NO_LABEL) return; // Unlabeled node, no need to update.
 
 	Schema *s = GraphContext_GetSchemaByID(gc, label_id, SCHEMA_NODE);
 	if(!Schema_HasIndices(s)) return; // No indices, no need to update.
 
-	Schema_AddNodeToIndices(s, n);
+	IndexBatch_AddNode(batch, label_id, ENTITY_GET_ID(n));
+}
+
+// Returns false if setting 'v' on node 'n' violates a uniqueness constraint,
+// values set by earlier updates of the same batch are tracked by 'claims'.
+static bool _ConstraintAccepts(GraphContext *gc, Node *n, Attribute_ID attr,
+							   SIValue v, rax **claims) {
+	int label_id = Graph_GetNodeLabel(gc->g, ENTITY_GET_ID(n));
+	if(label_id == GRAPH_NO_LABEL) return true;
+
+	Schema *s = GraphContext_GetSchemaByID(gc, label_id, SCHEMA_NODE);
+	UniqueConstraint *uc = Schema_GetConstraint(s, attr);
+	if(uc == NULL) return true;
+
+	// a node may keep its own value
+	if(UniqueConstraint_Lookup(uc, v) == ENTITY_GET_ID(n)) return true;
+
+	if(*claims == NULL) *claims = raxNew();
+	if(UniqueConstraint_Claim(uc, *claims, v)) return true;
+
+	ErrorCtx_SetError("Node(s) with label :%s and property '%s' violate a uniqueness constraint",
+					  Schema_GetName(s), GraphContext_GetAttributeString(gc, attr));
+	return false;
 }
 
 // Update the appropriate property on a graph entity.
-static int _UpdateProperty(Record r, GraphEntity *ge, EntityUpdateEvalCtx *update_ctx) {
+static int _UpdateProperty(Record r, GraphEntity *ge, GraphEntityType t,
+						   EntityUpdateEvalCtx *update_ctx, rax **claims) {
 	int res = 1;
 	SIValue new_value = AR_EXP_Evaluate(update_ctx->exp, r);
 
@@ -46,20 +71,40 @@ static int _UpdateProperty(Record r, GraphEntity *ge, EntityUpdateEvalCtx *updat
 		goto cleanup;
 	}
 
+	// Reject values held by another node under a uniqueness constraint.
+	if(t == GETYPE_NODE && !_ConstraintAccepts(QueryCtx_GetGraphCtx(), (Node *)ge,
+			update_ctx->attribute_id, new_value, claims)) {
+		res = 0;
+		if(*claims) raxFree(*claims);
+		*claims = NULL;
+		ErrorCtx_RaiseRuntimeException(NULL);
+		goto cleanup;
+	}
+
 	// Try to get current property value.
-	SIValue *old_value = GraphEntity_GetProperty(ge, update_ctx->attribute_id);
+	SIValue old_value = GraphEntity_GetProperty(ge, update_ctx->attribute_id);
 
-	if(old_value == PROPERTY_NOTFOUND) {
+	bool changed;
+	if(SI_TYPE(old_value) == T_NULL) {
 		// Adding a new property; do nothing if its value is NULL.
 		if(SI_TYPE(new_value) == T_NULL) {
 			res = 0;
 			goto cleanup;
 		}
 		// Add new property.
-		GraphEntity_AddProperty(ge, update_ctx->attribute_id, new_value);
+		changed = GraphEntity_AddProperty(ge, update_ctx->attribute_id, new_value);
 	} else {
 		// Update property.
-		GraphEntity_SetProperty(ge, update_ctx->attribute_id, new_value);
+		changed = GraphEntity_SetProperty(ge, update_ctx->attribute_id, new_value);
+	}
+
+	if(changed) Graph_MarkEntityModified(QueryCtx_GetGraph(), t, ENTITY_GET_ID(ge));
+
+	// Record the update for replication.
+	EffectsBuffer *effects = QueryCtx_GetEffects();
+	if(effects && changed) {
+		EffectsBuffer_AddSetProperty(effects, QueryCtx_GetGraphCtx(), t, ge,
+									 update_ctx->attribute_id, new_value);
 	}
 
 cleanup:
@@ -74,6 +119,8 @@ static void _UpdateProperties(ResultSetStatistics *stats, EntityUpdateEvalCtx *u
 	uint update_count = array_len(updates);
 	uint failed_updates = 0;
 	GraphContext *gc = QueryCtx_GetGraphCtx();
+	IndexBatch *batch = QueryCtx_GetIndexBatch();
+	rax *claims = NULL;  // Constrained values set so far.
 	// Lock everything.
 	QueryCtx_LockForCommit();
 
@@ -92,14 +139,20 @@ static void _UpdateProperties(ResultSetStatistics *stats, EntityUpdateEvalCtx *u
 
 			GraphEntity *ge = Record_GetGraphEntity(r, update_ctx->record_idx);
 
-			int res = _UpdateProperty(r, ge, update_ctx); // Update the entity.
+			GraphEntityType ge_type = (t == REC_TYPE_NODE) ? GETYPE_NODE : GETYPE_EDGE;
+			int res = _UpdateProperty(r, ge, ge_type, update_ctx, &claims); // Update the entity.
 			if(res == 0) {
 				failed_updates++;
 				continue;
 			}
-			if(t == REC_TYPE_NODE) _UpdateIndices(gc, (Node *)ge); // Update indices if necessary.
+			if(t == REC_TYPE_NODE) _UpdateIndices(gc, batch, (Node *)ge); // Update indices if necessary.
 		}
 	}
+
+	if(claims) raxFree(claims);
+
+	// nodes updated by multiple records are reindexed once
+	IndexBatch_Apply(batch, gc);
 	if(stats) stats->properties_set += (update_count * record_count) - failed_updates;
 }
 
@@ -110,6 +163,366 @@ static inline Record _pullFromStream(OpBase *branch) {
 	return OpBase_Consume(branch);
 }
 
+// Transfer an unmatched LHS record to the Create stream.
+static void _CreatePattern(OpMerge *op, Record lhs_record) {
+	/* Transfer the LHS record to the Create stream to build once we finish reading.
+	 * We don't need to clone the record, as it won't be accessed again outside that stream,
+	 * but we must make sure its elements are access-safe, as the input stream will be freed
+	 * before entities are created. */
+	if(lhs_record) {
+		Record_PersistScalars(lhs_record);
+		Argument_AddRecord(op->create_argument_tap, lhs_record);
+	}
+	Record r = _pullFromStream(op->create_stream);
+	UNUSED(r);
+	ASSERT(r == NULL); // Don't expect returned records
+}
+
+//------------------------------------------------------------------------------
+// Batch matching
+//------------------------------------------------------------------------------
+#define NO_RECORD UINT_MAX
+#define NODE_ID_ISLT(a, b) (*(a) < *(b))
+#define DOUBLE_ISLT(a, b) (*(a) < *(b))
+
+// Bound records of a single batch, chained by the hash of their key.
+typedef struct {
+	uint key_count;                  // Number of key attributes.
+	const Attribute_ID *attributes;  // Key attributes.
+	SIValue *keys;                   // key_count key values per record.
+	rax *heads;                      // Key hash to the last record holding it.
+	uint *next;                      // Previous record in chain, NO_RECORD if none.
+	NodeID **matches;                // Matched node IDs per record, NULL if unmatched.
+	XXH64_state_t *hash_state;       // Reusable hash state.
+	SIValue *node_keys;              // Scratch buffer for a node's key values.
+} MergeBatch;
+
+static XXH64_hash_t _HashKey(MergeBatch *batch, const SIValue *key) {
+	XXH_errorcode res = XXH64_reset(batch->hash_state, 0);
+	UNUSED(res);
+	ASSERT(res != XXH_ERROR);
+	for(uint i = 0; i < batch->key_count; i++) {
+		XXH64_hash_t value_hash = SIValue_HashCode(key[i]);
+		res = XXH64_update(batch->hash_state, &value_hash, sizeof(value_hash));
+		ASSERT(res != XXH_ERROR);
+	}
+	return XXH64_digest(batch->hash_state);
+}
+
+static bool _KeysEqual(const MergeBatch *batch, const SIValue *a, const SIValue *b) {
+	for(uint i = 0; i < batch->key_count; i++) {
+		int disjointOrNull = 0;
+		int cmp = SIValue_Compare(a[i], b[i], &disjointOrNull);
+		if(disjointOrNull == COMPARED_NULL || disjointOrNull == DISJOINT) return false;
+		if(cmp != 0) return false;
+	}
+	return true;
+}
+
+// Evaluate the key of every bound record, returns false if a key can't be
+// hashed, in which case the batch is resolved record by record.
+static bool _MergeBatch_Init(MergeBatch *batch, const MergeBatchKey *bk, Record *records,
+							 uint record_count) {
+	uint key_count = bk->properties->property_count;
+	batch->key_count = key_count;
+	batch->attributes = bk->properties->keys;
+	batch->keys = rm_malloc(sizeof(SIValue) * record_count * key_count);
+
+	for(uint i = 0; i < record_count; i++) {
+		for(uint j = 0; j < key_count; j++) {
+			SIValue v = AR_EXP_Evaluate(bk->properties->values[j], records[i]);
+			batch->keys[i * key_count + j] = v;
+			if(!(SI_TYPE(v) & SI_INDEXABLE)) {
+				// NULL keys never match, other types aren't compared by hash
+				for(uint k = 0; k <= i * key_count + j; k++) SIValue_Free(batch->keys[k]);
+				rm_free(batch->keys);
+				batch->keys = NULL;
+				return false;
+			}
+		}
+	}
+
+	batch->heads = raxNew();
+	batch->next = rm_malloc(sizeof(uint) * record_count);
+	batch->matches = rm_calloc(record_count, sizeof(NodeID *));
+	batch->hash_state = XXH64_createState();
+	batch->node_keys = rm_malloc(sizeof(SIValue) * key_count);
+
+	for(uint i = 0; i < record_count; i++) {
+		XXH64_hash_t hash = _HashKey(batch, batch->keys + i * key_count);
+		void *prev = NULL;
+		void *head = (void *)(uintptr_t)i;
+		if(raxInsert(batch->heads, (unsigned char *)&hash, sizeof(hash), head, &prev)) {
+			batch->next[i] = NO_RECORD;
+		} else {
+			batch->next[i] = (uint)(uintptr_t)prev;
+		}
+	}
+
+	return true;
+}
+
+// Match node 'n' against every bound record holding its key.
+static void _MergeBatch_MatchNode(MergeBatch *batch, const Node *n) {
+	GraphEntity_GetProperties((GraphEntity *)n, batch->attributes, batch->key_count,
+							  batch->node_keys);
+	for(uint i = 0; i < batch->key_count; i++) {
+		if(!(SI_TYPE(batch->node_keys[i]) & SI_INDEXABLE)) return;
+	}
+
+	XXH64_hash_t hash = _HashKey(batch, batch->node_keys);
+	void *head = raxFind(batch->heads, (unsigned char *)&hash, sizeof(hash));
+	if(head == raxNotFound) return;
+
+	for(uint i = (uint)(uintptr_t)head; i != NO_RECORD; i = batch->next[i]) {
+		if(!_KeysEqual(batch, batch->node_keys, batch->keys + i * batch->key_count)) continue;
+		if(batch->matches[i] == NULL) batch->matches[i] = array_new(NodeID, 1);
+		batch->matches[i] = array_append(batch->matches[i], ENTITY_GET_ID(n));
+	}
+}
+
+// Match every node of the label in a single scan.
+static void _MergeBatch_ScanLabel(MergeBatch *batch, Graph *g, int label_id) {
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, Graph_GetLabelMatrix(g, label_id));
+
+	NodeID id;
+	bool depleted = false;
+	while(true) {
+		GxB_MatrixTupleIter_next(iter, NULL, &id, &depleted);
+		if(depleted) break;
+		Node n = GE_NEW_NODE();
+		Graph_GetNode(g, id, &n);
+		_MergeBatch_MatchNode(batch, &n);
+	}
+
+	GxB_MatrixTupleIter_free(iter);
+}
+
+// Match the nodes indexed under the distinct values of key 'key_idx'.
+static void _MergeBatch_ProbeIndex(MergeBatch *batch, Graph *g, int label_id,
+								   const RangeIndex *range, uint key_idx, uint record_count) {
+	double *values = array_new(double, record_count);
+	for(uint i = 0; i < record_count; i++) {
+		SIValue v = batch->keys[i * batch->key_count + key_idx];
+		values = array_append(values, SI_GET_NUMERIC(v));
+	}
+	QSORT(double, values, record_count, DOUBLE_ISLT);
+
+	NodeID *candidates = array_new(NodeID, record_count);
+	for(uint i = 0; i < record_count; i++) {
+		if(i > 0 && values[i] == values[i - 1]) continue;
+		NumericRange bounds = {.min = values[i], .max = values[i], .include_min = true,
+							   .include_max = true, .valid = true};
+		NodeID *ids = RangeIndex_Query(range, &bounds);
+		uint id_count = array_len(ids);
+		for(uint j = 0; j < id_count; j++) candidates = array_append(candidates, ids[j]);
+		array_free(ids);
+	}
+	array_free(values);
+
+	// report each candidate once, in ascending ID order
+	uint candidate_count = array_len(candidates);
+	QSORT(NodeID, candidates, candidate_count, NODE_ID_ISLT);
+
+	GrB_Matrix labels = Graph_GetLabelMatrix(g, label_id);
+	for(uint i = 0; i < candidate_count; i++) {
+		NodeID id = candidates[i];
+		if(i > 0 && id == candidates[i - 1]) continue;
+		if(id >= Graph_RequiredMatrixDim(g)) continue;
+
+		bool x = false;
+		GrB_Info res = GrB_Matrix_extractElement_BOOL(&x, labels, id, id);
+		if(res != GrB_SUCCESS || !x) continue;
+
+		Node n = GE_NEW_NODE();
+		if(!Graph_GetNode(g, id, &n)) continue;
+		_MergeBatch_MatchNode(batch, &n);
+	}
+	array_free(candidates);
+}
+
+// Match the nodes holding the distinct values of constrained key 'key_idx',
+// each value is resolved by a single constraint lookup.
+static void _MergeBatch_ProbeConstraint(MergeBatch *batch, Graph *g,
+										const UniqueConstraint *uc, uint key_idx,
+										uint record_count) {
+	NodeID *candidates = array_new(NodeID, record_count);
+	for(uint i = 0; i < record_count; i++) {
+		SIValue v = batch->keys[i * batch->key_count + key_idx];
+		NodeID id = UniqueConstraint_Lookup(uc, v);
+		if(id != INVALID_ENTITY_ID) candidates = array_append(candidates, id);
+	}
+
+	// report each candidate once, in ascending ID order
+	uint candidate_count = array_len(candidates);
+	QSORT(NodeID, candidates, candidate_count, NODE_ID_ISLT);
+
+	for(uint i = 0; i < candidate_count; i++) {
+		NodeID id = candidates[i];
+		if(i > 0 && id == candidates[i - 1]) continue;
+
+		Node n = GE_NEW_NODE();
+		if(!Graph_GetNode(g, id, &n)) continue;
+		_MergeBatch_MatchNode(batch, &n);
+	}
+	array_free(candidates);
+}
+
+// Locate a uniqueness constraint on one of the key's attributes,
+// returns NULL if none of the key attributes is constrained.
+static UniqueConstraint *_MergeBatch_KeyConstraint(const MergeBatchKey *bk, Schema **s,
+												   uint *key_idx) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	*s = GraphContext_GetSchema(gc, bk->label, SCHEMA_NODE);
+	if(*s == NULL || (*s)->constraints == NULL) return NULL;
+
+	for(uint i = 0; i < bk->properties->property_count; i++) {
+		UniqueConstraint *uc = Schema_GetConstraint(*s, bk->properties->keys[i]);
+		if(uc == NULL) continue;
+		*key_idx = i;
+		return uc;
+	}
+	return NULL;
+}
+
+static void _MergeBatch_Free(MergeBatch *batch, uint record_count) {
+	uint value_count = record_count * batch->key_count;
+	for(uint i = 0; i < value_count; i++) SIValue_Free(batch->keys[i]);
+	rm_free(batch->keys);
+	for(uint i = 0; i < record_count; i++) {
+		if(batch->matches[i]) array_free(batch->matches[i]);
+	}
+	rm_free(batch->matches);
+	rm_free(batch->next);
+	rm_free(batch->node_keys);
+	raxFree(batch->heads);
+	XXH64_freeState(batch->hash_state);
+}
+
+// Resolve the key's existing nodes, returns false if the batch is better
+// matched record by record, i.e. an index the Match stream utilizes
+// can't be probed by all keys.
+static bool _MergeBatch_Resolve(MergeBatch *batch, const MergeBatchKey *bk,
+								uint record_count) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchema(gc, bk->label, SCHEMA_NODE);
+	if(s == NULL) return true; // Missing label, nothing to match.
+
+	bool indexed = false;
+	for(uint i = 0; i < batch->key_count; i++) {
+		Attribute_ID attr = batch->attributes[i];
+		Index *idx = Schema_GetIndex(s, &attr, IDX_EXACT_MATCH);
+		if(idx == NULL || !Index_Enabled(idx)) continue;
+		indexed = true;
+
+		// range indices hold numeric keys only
+		RangeIndex *range = Index_GetRangeIndex(idx, attr);
+		if(range == NULL) continue;
+		bool numeric = true;
+		for(uint j = 0; j < record_count && numeric; j++) {
+			numeric = SI_TYPE(batch->keys[j * batch->key_count + i]) & SI_NUMERIC;
+		}
+		if(!numeric) continue;
+
+		_MergeBatch_ProbeIndex(batch, gc->g, s->id, range, i, record_count);
+		return true;
+	}
+
+	if(indexed) return false;
+
+	_MergeBatch_ScanLabel(batch, gc->g, s->id);
+	return true;
+}
+
+/* Match all bound records at once by the batch key, emitting a record for every
+ * matched node and transferring unmatched records to the Create stream.
+ * A key holding a constrained attribute is resolved by constraint lookups,
+ * with or without bound records, skipping the Match stream altogether.
+ * Returns false if the bound records should be matched one by one. */
+static bool _BatchMerge(OpMerge *op, uint *match_count, bool *must_create_records) {
+	MergeBatchKey *bk = op->batch_key;
+	if(bk == NULL) return false;
+
+	Schema *s = NULL;
+	uint key_idx = 0;
+	bool constrained = (_MergeBatch_KeyConstraint(bk, &s, &key_idx) != NULL);
+	bool bound = (op->input_records != NULL);
+	if(bound && array_len(op->input_records) == 0) return false;
+	if(!constrained &&
+	   (!bound || array_len(op->input_records) < MERGE_BATCH_MIN_RECORDS)) {
+		return false;
+	}
+
+	// Without bound variables the key is evaluated once, over an empty record.
+	if(!bound) {
+		op->input_records = array_new(Record, 1);
+		op->input_records = array_append(op->input_records,
+										 OpBase_CreateRecord((OpBase *)op));
+	}
+	uint record_count = array_len(op->input_records);
+
+	MergeBatch batch;
+	if(!_MergeBatch_Init(&batch, bk, op->input_records, record_count)) {
+		if(!bound) {
+			OpBase_DeleteRecord(array_pop(op->input_records));
+			array_free(op->input_records);
+			op->input_records = NULL;
+		}
+		return false;
+	}
+
+	Graph *g = QueryCtx_GetGraph();
+	if(constrained) {
+		/* Probe the constraint under the commit lock, such that writers merging
+		 * the same key observe one another's creations.
+		 * Free the read streams first, as either might hold an index read lock. */
+		if(op->bound_variable_stream) OpBase_PropagateFree(op->bound_variable_stream);
+		OpBase_PropagateFree(op->match_stream);
+		QueryCtx_LockForCommit();
+
+		// The constraint might have been dropped while the lock was acquired.
+		UniqueConstraint *uc = _MergeBatch_KeyConstraint(bk, &s, &key_idx);
+		if(uc) _MergeBatch_ProbeConstraint(&batch, g, uc, key_idx, record_count);
+		else _MergeBatch_ScanLabel(&batch, g, s->id);
+	} else if(!_MergeBatch_Resolve(&batch, bk, record_count)) {
+		_MergeBatch_Free(&batch, record_count);
+		return false;
+	}
+
+	// Consume bound records in the order the Match stream would.
+	for(int i = record_count - 1; i >= 0; i--) {
+		Record lhs_record = op->input_records[i];
+		NodeID *matches = batch.matches[i];
+		if(matches == NULL) {
+			if(bound) {
+				_CreatePattern(op, lhs_record);
+			} else {
+				// The Create stream isn't populated by an Argument tap.
+				OpBase_DeleteRecord(lhs_record);
+				_CreatePattern(op, NULL);
+			}
+			*must_create_records = true;
+			continue;
+		}
+
+		uint n_matches = array_len(matches);
+		for(uint j = 0; j < n_matches; j++) {
+			Record r = OpBase_CloneRecord(lhs_record);
+			Node n = GE_NEW_LABELED_NODE(bk->label, Graph_GetNodeLabel(g, matches[j]));
+			Graph_GetNode(g, matches[j], &n);
+			Record_AddNode(r, bk->node_idx, n);
+			op->output_records = array_append(op->output_records, r);
+		}
+		*match_count += n_matches;
+		OpBase_DeleteRecord(lhs_record);
+	}
+	array_clear(op->input_records);
+
+	_MergeBatch_Free(&batch, record_count);
+	return true;
+}
+
 OpBase *NewMergeOp(const ExecutionPlan *plan, EntityUpdateEvalCtx *on_match,
 				   EntityUpdateEvalCtx *on_create) {
 
@@ -117,6 +530,7 @@ OpBase *NewMergeOp(const ExecutionPlan *plan, EntityUpdateEvalCtx *on_match,
 	 * as with other multi-stream operators (see CartesianProduct and ValueHashJoin). */
 	OpMerge *op = rm_calloc(1, sizeof(OpMerge));
 	op->stats = NULL;
+	op->batch_key = NULL;
 	op->on_match = on_match;
 	op->on_create = on_create;
 	// Set our Op operations
@@ -142,6 +556,19 @@ OpBase *NewMergeOp(const ExecutionPlan *plan, EntityUpdateEvalCtx *on_match,
 	return (OpBase *)op;
 }
 
+void Merge_SetBatchKey(OpBase *opBase, const NodeCreateCtx *n) {
+	ASSERT(opBase->type == OPType_MERGE);
+	ASSERT(n->label != NULL && n->properties != NULL);
+	OpMerge *op = (OpMerge *)opBase;
+	ASSERT(op->batch_key == NULL);
+
+	op->batch_key = rm_malloc(sizeof(MergeBatchKey));
+	op->batch_key->alias = n->alias;
+	op->batch_key->label = n->label;
+	op->batch_key->properties = PropertyMap_Clone(n->properties);
+	op->batch_key->node_idx = OpBase_Modifies(opBase, n->alias);
+}
+
 // Modification of ExecutionPlan_LocateOp that only follows LHS child.
 // Otherwise, the assumptions of Merge_SetStreams fail in MERGE..MERGE queries.
 // Match and Create streams are always guaranteed to not branch (have any ops with multiple children).
@@ -254,8 +681,9 @@ static Record MergeConsume(OpBase *opBase) {
 	}
 
 	bool must_create_records = false;
-	bool reading_matches = true;
 	uint match_count = 0;
+	// Batch mode: resolve all bound records at once.
+	bool reading_matches = !_BatchMerge(op, &match_count, &must_create_records);
 	// Match mode: attempt to resolve the pattern for every record from the bound variable
 	// stream, or once if we have no bound variables.
 	while(reading_matches) {
@@ -286,18 +714,8 @@ static Record MergeConsume(OpBase *opBase) {
 		}
 
 		if(should_create_pattern) {
-			/* Transfer the LHS record to the Create stream to build once we finish reading.
-			 * We don't need to clone the record, as it won't be accessed again outside that stream,
-			 * but we must make sure its elements are access-safe, as the input stream will be freed
-			 * before entities are created. */
-			if(lhs_record) {
-				Record_PersistScalars(lhs_record);
-				Argument_AddRecord(op->create_argument_tap, lhs_record);
-				lhs_record = NULL;
-			}
-			Record r = _pullFromStream(op->create_stream);
-			UNUSED(r);
-			ASSERT(r == NULL); // Don't expect returned records
+			_CreatePattern(op, lhs_record);
+			lhs_record = NULL;
 			must_create_records = true;
 		}
 
@@ -345,7 +763,13 @@ static OpBase *MergeClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	EntityUpdateEvalCtx *on_create;
 	array_clone_with_cb(on_match, op->on_match, EntityUpdateEvalCtx_Clone);
 	array_clone_with_cb(on_create, op->on_create, EntityUpdateEvalCtx_Clone);
-	return NewMergeOp(plan, on_match, on_create);
+	OpBase *clone = NewMergeOp(plan, on_match, on_create);
+	if(op->batch_key) {
+		NodeCreateCtx n = {.alias = op->batch_key->alias, .label = op->batch_key->label,
+						   .properties = op->batch_key->properties};
+		Merge_SetBatchKey(clone, &n);
+	}
+	return clone;
 }
 
 static void MergeFree(OpBase *opBase) {
@@ -385,5 +809,11 @@ static void MergeFree(OpBase *opBase) {
 		array_free(op->on_create);
 		op->on_create = NULL;
 	}
+
+	if(op->batch_key) {
+		PropertyMap_Free(op->batch_key->properties);
+		rm_free(op->batch_key);
+		op->batch_key = NULL;
+	}
 }
 
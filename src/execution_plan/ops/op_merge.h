@@ -9,8 +9,22 @@
 #include "op.h"
 #include "op_argument.h"
 #include "../execution_plan.h"
+#include "../../ast/ast_shared.h"
 #include "../../resultset/resultset_statistics.h"
 
+// minimal number of bound records resolved as a single batch
+#define MERGE_BATCH_MIN_RECORDS 2
+
+/* Identifying key of a single node pattern MERGE (n:L {k: exp, ...}),
+ * evaluated for every bound record and matched against the graph
+ * for the entire set of bound records at once. */
+typedef struct {
+	const char *alias;        // Merged node alias.
+	const char *label;        // Merged node label.
+	int node_idx;             // Record offset of the merged node.
+	PropertyMap *properties;  // Key attributes and their expressions.
+} MergeBatchKey;
+
 /* The Merge operation accepts exactly one path in the query and attempts to match it.
  * If the path is not found, it will be created, making new instances of every path variable
  * not bound in an earlier clause in the query. */
@@ -26,7 +40,11 @@ typedef struct {
 	EntityUpdateEvalCtx *on_match;    // Updates to be performed on a successful match.
 	EntityUpdateEvalCtx *on_create;   // Updates to be performed on creation.
 	ResultSetStatistics *stats;       // Required for tracking statistics updates in ON MATCH.
+	MergeBatchKey *batch_key;         // Optional, key by which bound records are matched in bulk.
 } OpMerge;
 
 OpBase *NewMergeOp(const ExecutionPlan *plan, EntityUpdateEvalCtx *on_match,
 				   EntityUpdateEvalCtx *on_create);
+
+// Match bound records in bulk by the identifying key of node pattern 'n'.
+void Merge_SetBatchKey(OpBase *op, const NodeCreateCtx *n);
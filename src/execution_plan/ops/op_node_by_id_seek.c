@@ -8,6 +8,7 @@
 #include "RG.h"
 #include "shared/print_functions.h"
 #include "../../query_ctx.h"
+#include "../../util/arr.h"
 
 /* Forward declarations. */
 static OpResult NodeByIdSeekInit(OpBase *opBase);
@@ -43,6 +44,8 @@ OpBase *NewNodeByIdSeekOp(const ExecutionPlan *plan, const char *alias, Unsigned
 	op->maxId = id_range->include_max ? id_range->max : id_range->max - 1;
 
 	op->currentId = op->minId;
+	op->ids = NULL;
+	op->idIdx = 0;
 
 	OpBase_Init((OpBase *)op, OPType_NODE_BY_ID_SEEK, "NodeByIdSeek", NodeByIdSeekInit,
 				NodeByIdSeekConsume, NodeByIdSeekReset, NodeByIdSeekToString, NodeByIdSeekClone, NodeByIdSeekFree,
@@ -53,16 +56,62 @@ OpBase *NewNodeByIdSeekOp(const ExecutionPlan *plan, const char *alias, Unsigned
 	return (OpBase *)op;
 }
 
+OpBase *NewNodeByIdListSeekOp(const ExecutionPlan *plan, const char *alias, NodeID *ids) {
+	ASSERT(ids != NULL);
+
+	UnsignedRange range;
+	uint count = array_len(ids);
+	range.min = (count > 0) ? ids[0] : 1;
+	range.max = (count > 0) ? ids[count - 1] : 0;
+	range.include_min = true;
+	range.include_max = true;
+
+	NodeByIdSeek *op = (NodeByIdSeek *)NewNodeByIdSeekOp(plan, alias, &range);
+	op->ids = ids;
+	return (OpBase *)op;
+}
+
+// Prefetches the storage of the first listed IDs.
+static inline void _PrefetchHead(NodeByIdSeek *op) {
+	uint64_t count = MIN(array_len(op->ids), ID_SEEK_PREFETCH_DISTANCE);
+	for(uint64_t i = 0; i < count; i++) Graph_PrefetchNode(op->g, op->ids[i]);
+}
+
 static OpResult NodeByIdSeekInit(OpBase *opBase) {
 	ASSERT(opBase->type == OPType_NODE_BY_ID_SEEK);
 	NodeByIdSeek *op = (NodeByIdSeek *)opBase;
 	// The largest possible entity ID is the same as Graph_RequiredMatrixDim.
 	op->maxId = MIN(Graph_RequiredMatrixDim(op->g) - 1, op->maxId);
+	if(op->ids) {
+		// Discard listed IDs beyond the graph, such that every listed ID is addressable.
+		uint count = array_len(op->ids);
+		while(count > 0 && op->ids[count - 1] > op->maxId) count--;
+		op->ids = array_trimm_len(op->ids, count);
+		_PrefetchHead(op);
+	}
 	if(opBase->childCount > 0) OpBase_UpdateConsume(opBase, NodeByIdSeekConsumeFromChild);
 	return OP_OK;
 }
 
+// Fetches the next listed node, IDs are visited in ascending order
+// while the storage of the IDs ahead is prefetched.
+static inline Node _SeekNextListedNode(NodeByIdSeek *op) {
+	Node n = GE_NEW_NODE();
+	uint64_t count = array_len(op->ids);
+
+	while(op->idIdx < count) {
+		uint64_t ahead = op->idIdx + ID_SEEK_PREFETCH_DISTANCE;
+		if(ahead < count) Graph_PrefetchNode(op->g, op->ids[ahead]);
+		NodeID id = op->ids[op->idIdx++];
+		if(Graph_GetNode(op->g, id, &n)) break;
+	}
+
+	return n;
+}
+
 static inline Node _SeekNextNode(NodeByIdSeek *op) {
+	if(op->ids) return _SeekNextListedNode(op);
+
 	Node n = GE_NEW_NODE();
 
 	/* As long as we're within range bounds
@@ -128,12 +177,20 @@ static Record NodeByIdSeekConsume(OpBase *opBase) {
 static OpResult NodeByIdSeekReset(OpBase *ctx) {
 	NodeByIdSeek *op = (NodeByIdSeek *)ctx;
 	op->currentId = op->minId;
+	op->idIdx = 0;
+	if(op->ids) _PrefetchHead(op);
 	return OP_OK;
 }
 
 static OpBase *NodeByIdSeekClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	ASSERT(opBase->type == OPType_NODE_BY_ID_SEEK);
 	NodeByIdSeek *op = (NodeByIdSeek *)opBase;
+	if(op->ids) {
+		NodeID *ids;
+		array_clone(ids, op->ids);
+		return NewNodeByIdListSeekOp(plan, op->alias, ids);
+	}
+
 	UnsignedRange range;
 	range.min = op->minId;
 	range.max = op->maxId;
@@ -154,5 +211,9 @@ static void NodeByIdSeekFree(OpBase *opBase) {
 		OpBase_DeleteRecord(op->child_record);
 		op->child_record = NULL;
 	}
+	if(op->ids) {
+		array_free(op->ids);
+		op->ids = NULL;
+	}
 }
 
@@ -13,7 +13,11 @@
 
 #define ID_RANGE_UNBOUND -1
 
-/* Node by ID seek locates an entity by its ID */
+// Number of listed IDs the seek prefetches ahead of the ID being fetched.
+#define ID_SEEK_PREFETCH_DISTANCE 8
+
+/* Node by ID seek locates an entity by its ID,
+ * either every ID within a range, or each ID of a list. */
 typedef struct {
 	OpBase op;
 	Graph *g;               // Graph object.
@@ -22,8 +26,14 @@ typedef struct {
 	NodeID currentId;       // Current ID fetched.
 	NodeID minId;           // Min ID to fetch.
 	NodeID maxId;           // Max ID to fetch.
+	NodeID *ids;            // Sorted distinct IDs to fetch, NULL when seeking a range.
+	uint64_t idIdx;         // Position of the next listed ID to fetch.
 	int nodeRecIdx;         // Position of entity within record.
 } NodeByIdSeek;
 
 OpBase *NewNodeByIdSeekOp(const ExecutionPlan *plan, const char *alias, UnsignedRange *id_range);
 
+/* Creates a seek over a list of IDs, the op takes ownership of 'ids',
+ * which must be sorted and distinct. */
+OpBase *NewNodeByIdListSeekOp(const ExecutionPlan *plan, const char *alias, NodeID *ids);
+
@@ -14,6 +14,8 @@
 static OpResult NodeByLabelScanInit(OpBase *opBase);
 static Record NodeByLabelScanConsume(OpBase *opBase);
 static Record NodeByLabelScanConsumeFromChild(OpBase *opBase);
+static uint NodeByLabelScanConsumeBatch(OpBase *opBase, Record *batch, uint cap);
+static Record NodeByLabelScanConsumePrefiltered(OpBase *opBase);
 static Record NodeByLabelScanNoOp(OpBase *opBase);
 static OpResult NodeByLabelScanReset(OpBase *opBase);
 static OpBase *NodeByLabelScanClone(const ExecutionPlan *plan, const OpBase *opBase);
@@ -31,6 +33,8 @@ OpBase *NewNodeByLabelScanOp(const ExecutionPlan *plan, NodeScanCtx n) {
 	op->n = n;
 	op->iter = NULL;
 	op->child_record = NULL;
+	op->prefilter = NULL;
+	op->sample = NULL;
 	// Defaults to [0...UINT64_MAX].
 	op->id_range = UnsignedRange_New();
 
@@ -89,6 +93,14 @@ static OpResult NodeByLabelScanInit(OpBase *opBase) {
 		return OP_OK;
 	}
 
+	op->sample = ScanSample_New(opBase);
+
+	// large label scans evaluate their parent filter in parallel
+	size_t node_count = Graph_LabeledNodeCount(gc->g, schema->id);
+	op->prefilter = ScanPrefilter_New(opBase, op->n.alias, node_count);
+	if(op->prefilter) OpBase_UpdateConsume(opBase, NodeByLabelScanConsumePrefiltered);
+	else OpBase_UpdateConsumeBatch(opBase, NodeByLabelScanConsumeBatch);
+
 	return OP_OK;
 }
 
@@ -105,6 +117,24 @@ static inline void _ResetIterator(NodeByLabelScan *op) {
 	GxB_MatrixTupleIter_iterate_range(op->iter, minId, maxId);
 }
 
+// sets 'id' to the next scanned node, skipping blocks left out of the sample
+// returns false once the label was scanned
+static inline bool _NextNodeID(NodeByLabelScan *op, GrB_Index *id) {
+	bool depleted = false;
+	GxB_MatrixTupleIter_next(op->iter, NULL, id, &depleted);
+	while(!depleted && op->sample) {
+		uint64_t pos = *id;
+		if(!ScanSample_Seek(op->sample, &pos, Graph_RequiredMatrixDim(op->g))) return false;
+		if(pos == *id) break;
+
+		NodeID maxId = op->id_range->include_max ? op->id_range->max : op->id_range->max - 1;
+		if(pos > maxId) return false;
+		GxB_MatrixTupleIter_iterate_range(op->iter, pos, maxId);
+		GxB_MatrixTupleIter_next(op->iter, NULL, id, &depleted);
+	}
+	return !depleted;
+}
+
 static Record NodeByLabelScanConsumeFromChild(OpBase *opBase) {
 	NodeByLabelScan *op = (NodeByLabelScan *)opBase;
 
@@ -153,9 +183,7 @@ static Record NodeByLabelScanConsume(OpBase *opBase) {
 	NodeByLabelScan *op = (NodeByLabelScan *)opBase;
 
 	GrB_Index nodeId;
-	bool depleted = false;
-	GxB_MatrixTupleIter_next(op->iter, NULL, &nodeId, &depleted);
-	if(depleted) return NULL;
+	if(!_NextNodeID(op, &nodeId)) return NULL;
 
 	Record r = OpBase_CreateRecord((OpBase *)op);
 
@@ -165,6 +193,56 @@ static Record NodeByLabelScanConsume(OpBase *opBase) {
 	return r;
 }
 
+static uint NodeByLabelScanConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	NodeByLabelScan *op = (NodeByLabelScan *)opBase;
+
+	uint n = 0;
+	while(n < cap) {
+		GrB_Index nodeId;
+		if(!_NextNodeID(op, &nodeId)) break;
+
+		Record r = OpBase_CreateRecord(opBase);
+		_UpdateRecord(op, r, nodeId);
+		batch[n++] = r;
+	}
+
+	return n;
+}
+
+// fill the prefilter window with the next block of labeled nodes
+// and evaluate it, returns false once the label was scanned
+static bool _FillWindow(NodeByLabelScan *op) {
+	ScanPrefilter *pf = op->prefilter;
+	pf->window_len = 0;
+	while(pf->window_len < pf->window_cap) {
+		GrB_Index nodeId;
+		if(!_NextNodeID(op, &nodeId)) break;
+
+		Node *n = pf->window + pf->window_len;
+		*n = GE_NEW_LABELED_NODE(op->n.label, op->n.label_id);
+		Graph_GetNode(op->g, nodeId, n);
+		pf->window_len++;
+	}
+
+	if(pf->window_len == 0) return false;
+	ScanPrefilter_Apply(pf);
+	return true;
+}
+
+static Record NodeByLabelScanConsumePrefiltered(OpBase *opBase) {
+	NodeByLabelScan *op = (NodeByLabelScan *)opBase;
+
+	Node *n;
+	while((n = ScanPrefilter_Next(op->prefilter)) == NULL) {
+		if(!_FillWindow(op)) return NULL;
+	}
+
+	Record r = OpBase_CreateRecord(opBase);
+	Record_AddNode(r, op->nodeRecIdx, *n);
+
+	return r;
+}
+
 /* This function is invoked when the op has no children and no valid label is requested (either no label, or non existing label).
  * The op simply needs to return NULL */
 static Record NodeByLabelScanNoOp(OpBase *opBase) {
@@ -177,7 +255,12 @@ static OpResult NodeByLabelScanReset(OpBase *ctx) {
 		OpBase_DeleteRecord(op->child_record); // Free old record.
 		op->child_record = NULL;
 	}
+	if(op->prefilter) ScanPrefilter_Reset(op->prefilter);
 	_ResetIterator(op);
+	// a reused plan may be executed by a query sampling at another rate
+	if(op->sample) ScanSample_Free(op->sample);
+	op->sample = NULL;
+	if(op->iter && ctx->childCount == 0) op->sample = ScanSample_New(ctx);
 	return OP_OK;
 }
 
@@ -205,5 +288,15 @@ static void NodeByLabelScanFree(OpBase *op) {
 		UnsignedRange_Free(nodeByLabelScan->id_range);
 		nodeByLabelScan->id_range = NULL;
 	}
+
+	if(nodeByLabelScan->prefilter) {
+		ScanPrefilter_Free(nodeByLabelScan->prefilter);
+		nodeByLabelScan->prefilter = NULL;
+	}
+
+	if(nodeByLabelScan->sample) {
+		ScanSample_Free(nodeByLabelScan->sample);
+		nodeByLabelScan->sample = NULL;
+	}
 }
 
@@ -8,6 +8,8 @@
 
 #include "op.h"
 #include "shared/scan_functions.h"
+#include "shared/scan_sample.h"
+#include "shared/scan_prefilter.h"
 #include "../execution_plan.h"
 #include "../../graph/graph.h"
 #include "../../graph/entities/node.h"
@@ -24,6 +26,8 @@ typedef struct {
 	UnsignedRange *id_range;    /* ID range to iterate over. */
 	GxB_MatrixTupleIter *iter;
 	Record child_record;        /* The Record this op acts on if it is not a tap. */
+	ScanPrefilter *prefilter;   /* Parallel evaluation of the parent filter, if any. */
+	ScanSample *sample;         /* Blocks scanned by a sampled query, NULL if unsampled. */
 } NodeByLabelScan;
 
 /* Creates a new NodeByLabelScan operation */
@@ -45,7 +45,66 @@ static void _construct_output_mappings(OpProcCall *op, SIValue *outputs) {
 	}
 }
 
+static void _construct_batch_output_mappings(OpProcCall *op) {
+	// Map procedure output columns to record indices.
+	uint n = array_len(op->output);
+	uint m = Procedure_OutputCount(op->procedure);
+	op->yield_map = rm_malloc(sizeof(OutputMap) * n);
+
+	for(uint i = 0; i < n; i++) {
+		const char *output = op->output[i];
+		uint j = 0;
+		for(; j < m; j++) {
+			if(strcmp(output, Procedure_GetOutput(op->procedure, j)) == 0) {
+				int idx;
+				bool aware = OpBase_Aware((OpBase *)op, output, &idx);
+				UNUSED(aware);
+				ASSERT(aware == true);
+				op->yield_map[i].proc_out_idx = j;
+				op->yield_map[i].rec_idx = idx;
+				break;
+			}
+		}
+		// Make sure output was mapped.
+		ASSERT(j < m);
+	}
+}
+
+// yields the next row of the procedure's current block of rows
+// producing a new block once the current one is consumed
+static Record _yield_batch(OpProcCall *op) {
+	if(op->batch == NULL || op->batch_row == op->batch->count) {
+		op->batch = Proc_StepBatch(op->procedure);
+		op->batch_row = 0;
+		if(op->batch == NULL) return NULL;
+	}
+
+	if(!op->yield_map) _construct_batch_output_mappings(op);
+
+	uint row = op->batch_row++;
+	Record clone = OpBase_CloneRecord(op->r);
+	for(uint i = 0; i < array_len(op->output); i++) {
+		int idx = op->yield_map[i].rec_idx;
+		const ProcedureColumn *col = op->batch->columns + op->yield_map[i].proc_out_idx;
+		switch(col->type) {
+			case PROCEDURE_COLUMN_NODE:
+				Record_AddNode(clone, idx, col->nodes[row]);
+				break;
+			case PROCEDURE_COLUMN_DOUBLE:
+				Record_AddScalar(clone, idx, SI_DoubleVal(col->doubles[row]));
+				break;
+			default:
+				Record_Add(clone, idx, col->values[row]);
+				break;
+		}
+	}
+
+	return clone;
+}
+
 static Record _yield(OpProcCall *op) {
+	if(Procedure_SupportsBatch(op->procedure)) return _yield_batch(op);
+
 	SIValue *outputs = Proc_Step(op->procedure);
 	if(outputs == NULL) return NULL;
 
@@ -83,6 +142,9 @@ OpBase *NewProcCallOp(const ExecutionPlan *plan, const char *proc_name, AR_ExpNo
 	op->r = NULL;
 	op->yield_map = NULL;
 	op->first_call = true;
+	op->batch = NULL;
+	op->batch_row = 0;
+	op->limit = UNLIMITED;
 	op->arg_exps = arg_exps;
 	op->proc_name = proc_name;
 	op->yield_exps = yield_exps;
@@ -142,11 +204,15 @@ static Record ProcCallConsume(OpBase *opBase) {
 		 * TODO: replace with Proc_Reset */
 		Proc_Free(op->procedure);
 		op->procedure = Proc_Get(op->proc_name);
+		op->batch = NULL;
+		// an invocation isn't expected to produce more rows than the query needs
+		Procedure_SetLimitHint(op->procedure, op->limit);
 
-		// at the moment the only two procedures that can modify the graph are:
+		// at the moment the procedures that can modify the graph are:
 		// proc_fulltext_create_index
 		// proc_fulltext_drop_index
-		// both perform the modification once invoked without returning any
+		// proc_write_back (algorithm write variants)
+		// all perform the modification once invoked without returning any
 		// additional data (consume/step) function
 		// this is why acquiring the write lock as we do below works
 		// we will have to revisit this logic once new "write" procedures are
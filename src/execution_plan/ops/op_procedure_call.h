@@ -13,7 +13,8 @@
 
 /* Maps procedure output to record index.
  * yield element I is mapped to procedure output J
- * which will be stored within Record at position K. */
+ * which will be stored within Record at position K.
+ * For batched procedures J is the output's column. */
 typedef struct {
 	uint proc_out_idx;  // Index into procedure output.
 	uint rec_idx;       // Index into record.
@@ -32,6 +33,9 @@ typedef struct {
 	ProcedureCtx *procedure;    // Procedure to call.
 	OutputMap *yield_map;       // Maps between yield to procedure output and record idx.
     bool first_call;            // Indicate first call.
+	const ProcedureBatch *batch;  // Current block of rows, batched procedures only.
+	uint batch_row;               // Next row to yield out of the current block.
+	uint limit;                   // Rows required by the query, see applyLimit.
 } OpProcCall;
 
 OpBase *NewProcCallOp(
@@ -13,53 +13,73 @@
 
 /* Forward declarations. */
 static Record ProjectConsume(OpBase *opBase);
+static uint ProjectConsumeBatch(OpBase *opBase, Record *batch, uint cap);
 static OpBase *ProjectClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void ProjectFree(OpBase *opBase);
 
+// returns the index of an expression projected before exps[idx]
+// which is identical to it, -1 if there's none
+// e.g. RETURN n.a + n.b AS s ORDER BY n.a + n.b
+// evaluates n.a + n.b once, copying its value to the sort key
+static int _SharedExpression(const OpProject *op, uint idx) {
+	const AR_ExpNode *exp = op->exps[idx];
+	// projecting variables and constants is as cheap as copying them
+	if(!AR_EXP_IsOperation(exp)) return -1;
+	// rand() AS a, rand() AS b differ
+	if(!AR_EXP_Deterministic(exp)) return -1;
+
+	for(uint i = 0; i < idx; i++) {
+		if(op->shared[i] == -1 && AR_EXP_Equal(op->exps[i], exp)) return i;
+	}
+	return -1;
+}
+
 OpBase *NewProjectOp(const ExecutionPlan *plan, AR_ExpNode **exps) {
 	OpProject *op = rm_malloc(sizeof(OpProject));
 	op->exps = exps;
 	op->singleResponse = false;
 	op->exp_count = array_len(exps);
 	op->record_offsets = array_new(uint, op->exp_count);
+	op->shared = array_new(int, op->exp_count);
 	op->r = NULL;
 	op->projection = NULL;
+	op->pending = NULL;
+	op->pending_idx = 0;
+	op->pending_count = 0;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_PROJECT, "Project", NULL, ProjectConsume,
 				NULL, NULL, ProjectClone, ProjectFree, false, plan);
+	OpBase_UpdateConsumeBatch((OpBase *)op, ProjectConsumeBatch);
 
 	for(uint i = 0; i < op->exp_count; i ++) {
 		// The projected record will associate values with their resolved name
 		// to ensure that space is allocated for each entry.
 		int record_idx = OpBase_Modifies((OpBase *)op, op->exps[i]->resolved_name);
 		op->record_offsets = array_append(op->record_offsets, record_idx);
+		op->shared = array_append(op->shared, _SharedExpression(op, i));
 	}
 
 	return (OpBase *)op;
 }
 
-static Record ProjectConsume(OpBase *opBase) {
-	OpProject *op = (OpProject *)opBase;
-
-	if(op->op.childCount) {
-		OpBase *child = op->op.children[0];
-		op->r = OpBase_Consume(child);
-		if(!op->r) return NULL;
-	} else {
-		// QUERY: RETURN 1+2
-		// Return a single record followed by NULL on the second call.
-		if(op->singleResponse) return NULL;
-		op->singleResponse = true;
-		op->r = OpBase_CreateRecord(opBase);
-	}
-
-	op->projection = OpBase_CreateRecord(opBase);
+// Project op->r into a newly created record, consuming op->r.
+static Record _Project(OpProject *op) {
+	op->projection = OpBase_CreateRecord((OpBase *)op);
 
 	for(uint i = 0; i < op->exp_count; i++) {
+		int rec_idx = op->record_offsets[i];
+		int shared = op->shared[i];
+		if(shared != -1) {
+			// copy the value of an identical expression rather than evaluating it
+			SIValue v = Record_Get(op->projection, op->record_offsets[shared]);
+			if(!(v.type & SI_GRAPHENTITY)) v = SI_CloneValue(v);
+			Record_Add(op->projection, rec_idx, v);
+			continue;
+		}
+
 		AR_ExpNode *exp = op->exps[i];
 		SIValue v = AR_EXP_Evaluate(exp, op->r);
-		int rec_idx = op->record_offsets[i];
 		/* Persisting a value is only necessary here if 'v' refers to a scalar held in Record 'r'.
 		 * Graph entities don't need to be persisted here as Record_Add will copy them internally.
 		 * The RETURN projection here requires persistence:
@@ -82,6 +102,55 @@ static Record ProjectConsume(OpBase *opBase) {
 	return projection;
 }
 
+static Record ProjectConsume(OpBase *opBase) {
+	OpProject *op = (OpProject *)opBase;
+
+	if(op->op.childCount) {
+		OpBase *child = op->op.children[0];
+		op->r = OpBase_Consume(child);
+		if(!op->r) return NULL;
+	} else {
+		// QUERY: RETURN 1+2
+		// Return a single record followed by NULL on the second call.
+		if(op->singleResponse) return NULL;
+		op->singleResponse = true;
+		op->r = OpBase_CreateRecord(opBase);
+	}
+
+	return _Project(op);
+}
+
+static uint ProjectConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	OpProject *op = (OpProject *)opBase;
+
+	// no child, a single record is produced
+	if(op->op.childCount == 0) {
+		Record r = ProjectConsume(opBase);
+		if(r == NULL) return 0;
+		batch[0] = r;
+		return 1;
+	}
+
+	// child records are held by the operation until projected
+	// such that they can be released if evaluation raises an error
+	if(op->pending == NULL) op->pending = rm_malloc(sizeof(Record) * OP_BATCH_CAP);
+	if(cap > OP_BATCH_CAP) cap = OP_BATCH_CAP;
+
+	OpBase *child = op->op.children[0];
+	op->pending_idx = 0;
+	op->pending_count = OpBase_ConsumeBatch(child, op->pending, cap);
+
+	uint n = op->pending_count;
+	for(uint i = 0; i < n; i++) {
+		op->r = op->pending[i];
+		op->pending_idx = i + 1;
+		batch[i] = _Project(op);
+	}
+
+	op->pending_count = 0;
+	return n;
+}
+
 static OpBase *ProjectClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	ASSERT(opBase->type == OPType_PROJECT);
 	OpProject *op = (OpProject *)opBase;
@@ -104,6 +173,11 @@ static void ProjectFree(OpBase *ctx) {
 		op->record_offsets = NULL;
 	}
 
+	if(op->shared) {
+		array_free(op->shared);
+		op->shared = NULL;
+	}
+
 	if(op->r) {
 		OpBase_DeleteRecord(op->r);
 		op->r = NULL;
@@ -113,5 +187,13 @@ static void ProjectFree(OpBase *ctx) {
 		OpBase_DeleteRecord(op->projection);
 		op->projection = NULL;
 	}
+
+	if(op->pending) {
+		for(uint i = op->pending_idx; i < op->pending_count; i++) {
+			OpBase_DeleteRecord(op->pending[i]);
+		}
+		rm_free(op->pending);
+		op->pending = NULL;
+	}
 }
 
@@ -16,8 +16,12 @@ typedef struct {
 	Record projection;              // Record projected by this operation (stored to free if we encounter an error).
 	AR_ExpNode **exps;              // Projected expressions (including order exps).
 	uint *record_offsets;           // Record IDs corresponding to each projection (including order exps).
+	int *shared;                    // Index of an identical expression projected earlier, -1 if none.
 	bool singleResponse;            // When no child operations, return NULL after a first response.
 	uint exp_count;                 // Number of projected expressions.
+	Record *pending;                // Child records awaiting projection by the batch path.
+	uint pending_idx;               // Next pending record to project.
+	uint pending_count;             // Number of pending records.
 } OpProject;
 
 OpBase *NewProjectOp(const ExecutionPlan *plan, AR_ExpNode **exps);
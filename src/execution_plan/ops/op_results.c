@@ -13,7 +13,9 @@
 
 /* Forward declarations. */
 static Record ResultsConsume(OpBase *opBase);
+static uint ResultsConsumeBatch(OpBase *opBase, Record *batch, uint cap);
 static OpResult ResultsInit(OpBase *opBase);
+static OpResult ResultsReset(OpBase *opBase);
 static OpBase *ResultsClone(const ExecutionPlan *plan, const OpBase *opBase);
 
 OpBase *NewResultsOp(const ExecutionPlan *plan) {
@@ -21,7 +23,8 @@ OpBase *NewResultsOp(const ExecutionPlan *plan) {
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_RESULTS, "Results", ResultsInit, ResultsConsume,
-				NULL, NULL, ResultsClone, NULL, false, plan);
+				ResultsReset, NULL, ResultsClone, NULL, false, plan);
+	OpBase_UpdateConsumeBatch((OpBase *)op, ResultsConsumeBatch);
 
 	return (OpBase *)op;
 }
@@ -33,6 +36,11 @@ static OpResult ResultsInit(OpBase *opBase) {
 	return OP_OK;
 }
 
+// a reused plan populates the result-set of the query executing it
+static OpResult ResultsReset(OpBase *opBase) {
+	return ResultsInit(opBase);
+}
+
 /* Results consume operation
  * called each time a new result record is required */
 static Record ResultsConsume(OpBase *opBase) {
@@ -52,6 +60,24 @@ static Record ResultsConsume(OpBase *opBase) {
 	return r;
 }
 
+/* Results batch consume operation
+ * appends a block of child records to the result set */
+static uint ResultsConsumeBatch(OpBase *opBase, Record *batch, uint cap) {
+	Results *op = (Results *)opBase;
+
+	// enforce result-set size limit
+	if(op->result_set_size_limit == 0) return 0;
+	if(cap > op->result_set_size_limit) cap = op->result_set_size_limit;
+
+	OpBase *child = op->op.children[0];
+	uint n = OpBase_ConsumeBatch(child, batch, cap);
+	op->result_set_size_limit -= n;
+
+	// append to final result set
+	for(uint i = 0; i < n; i++) ResultSet_AddRecord(op->result_set, batch[i]);
+	return n;
+}
+
 static inline OpBase *ResultsClone(const ExecutionPlan *plan, const OpBase *opBase) {
 	ASSERT(opBase->type == OPType_RESULTS);
 	return NewResultsOp(plan);
@@ -5,9 +5,22 @@
  */
 
 #include "op_semi_apply.h"
+#include "op_expand_into.h"
+#include "op_expand_intersect.h"
+#include "op_conditional_traverse.h"
+#include "op_cond_var_len_traverse.h"
+#include "../../util/arr.h"
+#include "../../query_ctx.h"
+#include "../../util/rmalloc.h"
 #include "../execution_plan.h"
 #include "../execution_plan_build/execution_plan_modify.h"
 
+// Max number of match branch outcomes to cache.
+#define CACHE_CAP 65536
+
+// Number of match branch evaluations after which the branch is decorrelated.
+#define SEMI_JOIN_THRESHOLD 64
+
 // Forward declarations.
 static OpResult SemiApplyInit(OpBase *opBase);
 static Record SemiApplyConsume(OpBase *opBase);
@@ -16,14 +29,345 @@ static OpResult SemiApplyReset(OpBase *opBase);
 static OpBase *SemiApplyClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void SemiApplyFree(OpBase *opBase);
 
-static inline Record _pullFromMatchStream(OpSemiApply *op) {
-	return OpBase_Consume(op->match_branch);
+static inline void _AddExpressionReferences(AlgebraicExpression *ae, rax *refs) {
+	const char *src = AlgebraicExpression_Source(ae);
+	const char *dest = AlgebraicExpression_Destination(ae);
+	const char *edge = AlgebraicExpression_Edge(ae);
+	raxTryInsert(refs, (unsigned char *)src, strlen(src), NULL, NULL);
+	raxTryInsert(refs, (unsigned char *)dest, strlen(dest), NULL, NULL);
+	if(edge) raxTryInsert(refs, (unsigned char *)edge, strlen(edge), NULL, NULL);
+}
+
+static inline void _AddFilterReferences(const FT_FilterNode *ft, rax *refs) {
+	rax *filtered = FilterTree_CollectModified(ft);
+	raxIterator it;
+	raxStart(&it, filtered);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) raxTryInsert(refs, it.key, it.key_len, NULL, NULL);
+	raxStop(&it);
+	raxFree(filtered);
+}
+
+/* Collects the aliases referenced by the match branch rooted at op,
+ * returns false if the branch contains an operation whose references
+ * are not accounted for. */
+static bool _CollectBranchReferences(const OpBase *op, rax *refs) {
+	switch(op->type) {
+	case OPType_ARGUMENT:
+	case OPType_ALL_NODE_SCAN:
+	case OPType_NODE_BY_LABEL_SCAN:
+		break;
+	case OPType_FILTER:
+		_AddFilterReferences(((const OpFilter *)op)->filterTree, refs);
+		break;
+	case OPType_CONDITIONAL_TRAVERSE:
+		_AddExpressionReferences(((const OpCondTraverse *)op)->ae, refs);
+		break;
+	case OPType_EXPAND_INTO:
+		_AddExpressionReferences(((const OpExpandInto *)op)->ae, refs);
+		break;
+	case OPType_EXPAND_INTERSECT:
+		_AddExpressionReferences(((const OpExpandIntersect *)op)->ae, refs);
+		_AddExpressionReferences(((const OpExpandIntersect *)op)->into_ae, refs);
+		break;
+	case OPType_CONDITIONAL_VAR_LEN_TRAVERSE:
+	case OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO: {
+		const CondVarLenTraverse *t = (const CondVarLenTraverse *)op;
+		_AddExpressionReferences(t->ae, refs);
+		if(t->ft) _AddFilterReferences(t->ft, refs);
+		break;
+	}
+	default:
+		return false;
+	}
+
+	for(int i = 0; i < op->childCount; i++) {
+		if(!_CollectBranchReferences(op->children[i], refs)) return false;
+	}
+	return true;
+}
+
+/* Determine the record positions of the bound entities
+ * the match branch depends on, which make up the cache key. */
+static void _SetCacheKey(OpSemiApply *op) {
+	rax *refs = raxNew();
+	if(_CollectBranchReferences(op->match_branch, refs)) {
+		op->key_idx = array_new(uint, 1);
+		const OpBase *arg = (const OpBase *)op->op_arg;
+		uint bound_count = array_len(arg->modifies);
+		for(uint i = 0; i < bound_count; i++) {
+			const char *alias = arg->modifies[i];
+			if(raxFind(refs, (unsigned char *)alias, strlen(alias)) == raxNotFound) continue;
+			int idx;
+			bool aware = OpBase_Aware((OpBase *)op, alias, &idx);
+			UNUSED(aware);
+			ASSERT(aware);
+			op->key_idx = array_append(op->key_idx, idx);
+		}
+		op->cache = raxNew();
+	}
+	raxFree(refs);
+}
+
+/* A match branch consisting of an expand-into over a single matrix
+ * is answered by checking the matrix entry connecting both entities. */
+static void _SetDirectCheck(OpSemiApply *op) {
+	OpBase *branch = op->match_branch;
+	if(branch->type != OPType_EXPAND_INTO || branch->childCount != 1 ||
+	   branch->children[0] != (OpBase *)op->op_arg) return;
+
+	AlgebraicExpression *ae = AlgebraicExpression_Clone(((OpExpandInto *)branch)->ae);
+	AlgebraicExpression_Optimize(&ae);
+	if(ae->type != AL_OPERAND || ae->operand.diagonal) {
+		AlgebraicExpression_Free(ae);
+		return;
+	}
+
+	bool aware;
+	UNUSED(aware);
+	aware = OpBase_Aware((OpBase *)op, ae->operand.src, &op->src_idx);
+	ASSERT(aware);
+	aware = OpBase_Aware((OpBase *)op, ae->operand.dest, &op->dest_idx);
+	ASSERT(aware);
+	op->ae = ae;
+}
+
+// Returns true if both entities of r are connected by the checked matrix.
+static bool _DirectCheck(OpSemiApply *op, Record r) {
+	Node *src = Record_GetNode(r, op->src_idx);
+	Node *dest = Record_GetNode(r, op->dest_idx);
+	// Expand-into discards records missing either entity.
+	if(!src || !dest) return false;
+
+	bool x;
+	GrB_Info res = GrB_Matrix_extractElement_BOOL(&x, op->ae->operand.matrix,
+												  ENTITY_GET_ID(src), ENTITY_GET_ID(dest));
+	return (res == GrB_SUCCESS);
+}
+
+// Returns the number of operands of ae which aren't diagonal.
+static uint _RelationOperandCount(const AlgebraicExpression *ae) {
+	if(ae->type == AL_OPERAND) return !ae->operand.diagonal;
+
+	uint count = 0;
+	uint child_count = AlgebraicExpression_ChildCount(ae);
+	for(uint i = 0; i < child_count; i++) {
+		count += _RelationOperandCount(ae->operation.children[i]);
+	}
+	return count;
+}
+
+/* A match branch made of a traversal from a bound node followed by
+ * filters referring to nothing but the traversed node can be evaluated
+ * once for all bound nodes, e.g. (u)-[:BOUGHT]->(:Product {cat: $c}) */
+static void _SetSemiJoin(OpSemiApply *op) {
+	OpBase *branch = op->match_branch;
+	OpFilter **filters = array_new(OpFilter *, 1);
+	while(branch->type == OPType_FILTER && branch->childCount == 1) {
+		filters = array_append(filters, (OpFilter *)branch);
+		branch = branch->children[0];
+	}
+
+	if(branch->type != OPType_CONDITIONAL_TRAVERSE || branch->childCount != 1 ||
+	   branch->children[0] != (OpBase *)op->op_arg) goto cleanup;
+
+	OpCondTraverse *traverse = (OpCondTraverse *)branch;
+	const char *dest = AlgebraicExpression_Destination(traverse->ae);
+	uint filter_count = array_len(filters);
+	for(uint i = 0; i < filter_count; i++) {
+		rax *refs = FilterTree_CollectModified(filters[i]->filterTree);
+		bool own = (raxSize(refs) == 0 || (raxSize(refs) == 1 &&
+					raxFind(refs, (unsigned char *)dest, strlen(dest)) != raxNotFound));
+		raxFree(refs);
+		if(!own) goto cleanup;
+	}
+
+	// Products of relation matrices may be far denser than the graph itself.
+	AlgebraicExpression *ae = AlgebraicExpression_Clone(traverse->ae);
+	AlgebraicExpression_Optimize(&ae);
+	if(_RelationOperandCount(ae) > 1) {
+		AlgebraicExpression_Free(ae);
+		goto cleanup;
+	}
+
+	op->join_ae = ae;
+	op->join_filters = filters;
+	op->join_src_idx = traverse->srcNodeIdx;
+	op->join_dest_idx = traverse->destNodeIdx;
+	op->join_label = traverse->dest_label;
+	op->join_label_id = traverse->dest_label_id;
+	return;
+
+cleanup:
+	array_free(filters);
+}
+
+/* Evaluates the match branch for all bound nodes at once,
+ * collecting the nodes for which it produces data. */
+static void _BuildSemiJoin(OpSemiApply *op) {
+	Graph *g = QueryCtx_GetGraph();
+	GrB_Index dim = Graph_RequiredMatrixDim(g);
+
+	GrB_Matrix M;
+	GrB_Matrix_new(&M, GrB_BOOL, dim, dim);
+	AlgebraicExpression_Eval(op->join_ae, M);
+	GrB_Vector_new(&op->matches, GrB_BOOL, dim);
+
+	uint filter_count = array_len(op->join_filters);
+	if(filter_count == 0) {
+		// A bound node matches if it reaches any node.
+		GrB_Matrix_reduce_Monoid(op->matches, GrB_NULL, GrB_NULL,
+				GxB_LOR_BOOL_MONOID, M, GrB_NULL);
+		GrB_Matrix_free(&M);
+		return;
+	}
+
+	// Evaluate the filters once for every reachable node.
+	GrB_Index n;
+	GrB_Vector reachable;
+	GrB_Vector passing;
+	GrB_Vector_new(&reachable, GrB_BOOL, dim);
+	GrB_Vector_new(&passing, GrB_BOOL, dim);
+	GrB_Matrix_reduce_Monoid(reachable, GrB_NULL, GrB_NULL,
+			GxB_LOR_BOOL_MONOID, M, GrB_DESC_T0);
+	GrB_Vector_nvals(&n, reachable);
+
+	GrB_Index *ids = rm_malloc(sizeof(GrB_Index) * (n + 1));
+	GrB_Vector_extractTuples_BOOL(ids, NULL, &n, reachable);
+
+	Record r = OpBase_CreateRecord((OpBase *)op);
+	for(GrB_Index i = 0; i < n; i++) {
+		GrB_Index ahead = i + DATABLOCK_PREFETCH_DISTANCE;
+		if(ahead < n) Graph_PrefetchNode(g, ids[ahead]);
+
+		Node node = GE_NEW_LABELED_NODE(op->join_label, op->join_label_id);
+		Graph_GetNode(g, ids[i], &node);
+		Record_AddNode(r, op->join_dest_idx, node);
+
+		bool pass = true;
+		for(uint j = 0; j < filter_count && pass; j++) {
+			pass = (FilterTree_applyFilters(op->join_filters[j]->filterTree, r) ==
+					FILTER_PASS);
+		}
+		if(pass) GrB_Vector_setElement_BOOL(passing, true, ids[i]);
+	}
+	OpBase_DeleteRecord(r);
+	rm_free(ids);
+
+	// A bound node matches if it reaches a node passing the filters.
+	GrB_mxv(op->matches, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, M, passing,
+			GrB_NULL);
+
+	GrB_Vector_free(&passing);
+	GrB_Vector_free(&reachable);
+	GrB_Matrix_free(&M);
+}
+
+// Returns true if the bound node of r is among the semi join matches.
+static bool _SemiJoinCheck(OpSemiApply *op, Record r) {
+	Node *n = Record_GetNode(r, op->join_src_idx);
+	// Traversals discard records missing their source.
+	if(n == NULL) return false;
+
+	bool x;
+	GrB_Info res = GrB_Vector_extractElement_BOOL(&x, op->matches, ENTITY_GET_ID(n));
+	return (res == GrB_SUCCESS);
+}
+
+/* Builds r's cache key into key, returns the key's length in bytes,
+ * 0 if r can not be cached. */
+static size_t _CacheKey(const OpSemiApply *op, Record r, EntityID *key) {
+	uint key_len = array_len(op->key_idx);
+	for(uint i = 0; i < key_len; i++) {
+		uint idx = op->key_idx[i];
+		switch(Record_GetType(r, idx)) {
+		case REC_TYPE_NODE:
+			key[i] = ENTITY_GET_ID(Record_GetNode(r, idx));
+			break;
+		case REC_TYPE_EDGE:
+			key[i] = ENTITY_GET_ID(Record_GetEdge(r, idx));
+			break;
+		default:
+			// Only graph entities are identified by their IDs.
+			return 0;
+		}
+	}
+	// Pad key, such that a match branch independent of r still yields a key.
+	key[key_len] = 0;
+	return sizeof(EntityID) * (key_len + 1);
+}
+
+/* Returns true if the match branch produces data given record r,
+ * consulting and updating the cache when possible. */
+static bool _MatchBranchProduces(OpSemiApply *op, Record r) {
+	/* Inspect the match branch once the first record arrives,
+	 * as matrices are only retrieved once preceding eager operations
+	 * have committed their changes. */
+	if(!op->inspected) {
+		// Prefer a direct matrix lookup, otherwise try caching match branch outcomes.
+		_SetDirectCheck(op);
+		if(!op->ae) _SetSemiJoin(op);
+		if(!op->ae) _SetCacheKey(op);
+		op->inspected = true;
+	}
+
+	if(op->ae) return _DirectCheck(op, r);
+	if(op->matches) return _SemiJoinCheck(op, r);
+	if(op->join_ae && op->evaluations >= SEMI_JOIN_THRESHOLD) {
+		_BuildSemiJoin(op);
+		return _SemiJoinCheck(op, r);
+	}
+
+	size_t key_size = 0;
+	uint key_len = (op->key_idx) ? array_len(op->key_idx) : 0;
+	EntityID key[key_len + 1];
+	if(op->cache) {
+		key_size = _CacheKey(op, r, key);
+		if(key_size) {
+			void *outcome = raxFind(op->cache, (unsigned char *)key, key_size);
+			if(outcome != raxNotFound) return (outcome != NULL);
+		}
+	}
+
+	op->evaluations++;
+
+	// Propagate Record to the top of the Match stream.
+	// (Must share the Record, as it will be freed in the Match stream.)
+	if(op->op_arg) Argument_AddRecord(op->op_arg, OpBase_ShareRecord(r));
+	Record rhs_record = OpBase_Consume(op->match_branch);
+	// Reset the match branch to maintain parity with the bound branch.
+	OpBase_PropagateReset(op->match_branch);
+
+	bool produced = (rhs_record != NULL);
+	if(rhs_record) OpBase_DeleteRecord(rhs_record);
+
+	// Cache outcome, a NULL value marks a branch which produced no data.
+	if(key_size && op->cache_size < CACHE_CAP) {
+		raxInsert(op->cache, (unsigned char *)key, key_size, produced ? op : NULL, NULL);
+		op->cache_size++;
+	}
+	return produced;
 }
 
 OpBase *NewSemiApplyOp(const ExecutionPlan *plan, bool anti) {
 	OpSemiApply *op = rm_malloc(sizeof(OpSemiApply));
 	op->r = NULL;
+	op->ae = NULL;
+	op->cache = NULL;
+	op->src_idx = 0;
+	op->dest_idx = 0;
 	op->op_arg = NULL;
+	op->key_idx = NULL;
+	op->cache_size = 0;
+	op->inspected = false;
+	op->join_ae = NULL;
+	op->join_filters = NULL;
+	op->join_src_idx = 0;
+	op->join_dest_idx = 0;
+	op->join_label = NULL;
+	op->join_label_id = GRAPH_NO_LABEL;
+	op->matches = GrB_NULL;
+	op->evaluations = 0;
 	op->bound_branch = NULL;
 	op->match_branch = NULL;
 	// Set our Op operations
@@ -62,16 +406,9 @@ static Record SemiApplyConsume(OpBase *opBase) {
 		// Try to get a record from bound stream.
 		op->r = OpBase_Consume(op->bound_branch);
 		if(!op->r) return NULL; // Depleted.
-		// Propagate Record to the top of the Match stream.
-		if(op->op_arg) Argument_AddRecord(op->op_arg, OpBase_CloneRecord(op->r));
-
-		Record rhs_record = _pullFromMatchStream(op);
-		// Reset the match branch to maintain parity with the bound branch.
-		OpBase_PropagateReset(op->match_branch);
-		if(rhs_record) {
-			/* Successfully retrieved a Record from the match stream,
-			 * free it and return the bound Record. */
-			OpBase_DeleteRecord(rhs_record);
+
+		if(_MatchBranchProduces(op, op->r)) {
+			// The match stream produced data, return the bound Record.
 			Record r = op->r;
 			op->r = NULL;   // Null to avoid double free.
 			return r;
@@ -91,25 +428,14 @@ static Record AntiSemiApplyConsume(OpBase *opBase) {
 		op->r = OpBase_Consume(op->bound_branch);
 		if(!op->r) return NULL; // Depleted.
 
-		// Propagate record to the top of the Match stream.
-		// (Must clone the Record, as it will be freed in the Match stream.)
-		if(op->op_arg) Argument_AddRecord(op->op_arg, OpBase_CloneRecord(op->r));
-		/* Try to pull data from the right stream,
-		 * returning the bound stream record if unsuccessful. */
-		Record rhs_record = _pullFromMatchStream(op);
-		// Reset the match branch to maintain parity with the bound branch.
-		OpBase_PropagateReset(op->match_branch);
-		if(rhs_record) {
-			/* Successfully retrieved a Record from the match stream,
-			 * free it and pull again from the bound stream. */
-			OpBase_DeleteRecord(rhs_record);
-			OpBase_DeleteRecord(op->r);
-		} else {
+		if(!_MatchBranchProduces(op, op->r)) {
 			// Right stream returned NULL, return left handside record.
 			Record r = op->r;
 			op->r = NULL;   // Null to avoid double free.
 			return r;
 		}
+		// The match stream produced data, pull again from the bound stream.
+		OpBase_DeleteRecord(op->r);
 	}
 }
 
@@ -119,6 +445,16 @@ static OpResult SemiApplyReset(OpBase *opBase) {
 		OpBase_DeleteRecord(op->r);
 		op->r = NULL;
 	}
+
+	// Cached outcomes may not hold once the graph is modified.
+	if(op->cache) {
+		raxFree(op->cache);
+		op->cache = raxNew();
+		op->cache_size = 0;
+	}
+	if(op->matches) GrB_Vector_free(&op->matches);
+	op->matches = GrB_NULL;
+	op->evaluations = 0;
 	return OP_OK;
 }
 
@@ -135,5 +471,34 @@ static void SemiApplyFree(OpBase *opBase) {
 		OpBase_DeleteRecord(op->r);
 		op->r = NULL;
 	}
-}
 
+	if(op->ae) {
+		AlgebraicExpression_Free(op->ae);
+		op->ae = NULL;
+	}
+
+	if(op->key_idx) {
+		array_free(op->key_idx);
+		op->key_idx = NULL;
+	}
+
+	if(op->cache) {
+		raxFree(op->cache);
+		op->cache = NULL;
+	}
+
+	if(op->join_ae) {
+		AlgebraicExpression_Free(op->join_ae);
+		op->join_ae = NULL;
+	}
+
+	if(op->join_filters) {
+		array_free(op->join_filters);
+		op->join_filters = NULL;
+	}
+
+	if(op->matches) {
+		GrB_Vector_free(&op->matches);
+		op->matches = GrB_NULL;
+	}
+}
@@ -7,8 +7,10 @@
 #pragma once
 
 #include "op.h"
+#include "op_filter.h"
 #include "op_argument.h"
 #include "../execution_plan.h"
+#include "../../arithmetic/algebraic_expression.h"
 
 /* SemiApply operation tests for the presence of a pattern
  * Normal Semi Apply: Starts by pulling on the main execution plan branch,
@@ -18,7 +20,17 @@
  * Anti Semi Apply: Starts by pulling on the main execution plan branch,
  * for each record received it tries to get a record from the match branch
  * if no data is produced the main execution plan branch record is passed onward
- * otherwise it will try to fetch a new data point from the main execution plan branch. */
+ * otherwise it will try to fetch a new data point from the main execution plan branch.
+ *
+ * When the match branch only depends on bound graph entities,
+ * its outcome is cached per combination of their IDs, such that
+ * bound records sharing these entities evaluate the branch once.
+ * A match branch made of a single expand-into over one matrix
+ * is replaced by a lookup of the matrix entry connecting both entities.
+ * A match branch made of a traversal from a bound node followed by filters
+ * over the traversed node is decorrelated once it was evaluated for enough
+ * bound records: the branch is evaluated a single time for all nodes,
+ * the matching bound nodes are then looked up per record. */
 
 typedef struct OpSemiApply {
 	OpBase op;
@@ -26,6 +38,21 @@ typedef struct OpSemiApply {
 	OpBase *bound_branch;           // Bound branch root;
 	OpBase *match_branch;           // Match branch root;
 	Argument *op_arg;               // Match branch tap.
+	AlgebraicExpression *ae;        // Expression holding the matrix checked in place of the match branch.
+	int src_idx;                    // Record position of the checked matrix row.
+	int dest_idx;                   // Record position of the checked matrix column.
+	uint *key_idx;                  // Record positions the match branch depends on, NULL if not cacheable.
+	rax *cache;                     // Match branch outcome per key.
+	uint64_t cache_size;            // Number of cached outcomes.
+	bool inspected;                 // Match branch was inspected for a lookup or caching.
+	AlgebraicExpression *join_ae;   // Match branch traversal, evaluated once for all bound nodes.
+	OpFilter **join_filters;        // Match branch filters over the traversed node.
+	int join_src_idx;               // Record position of the bound node.
+	int join_dest_idx;              // Record position of the traversed node.
+	const char *join_label;         // Label of the traversed node if known.
+	int join_label_id;              // ID of the traversed node label if known.
+	GrB_Vector matches;             // Bound nodes for which the match branch produces data.
+	uint64_t evaluations;           // Number of match branch evaluations.
 } OpSemiApply;
 
 OpBase *NewSemiApplyOp(const ExecutionPlan *plan, bool anti);
@@ -11,6 +11,24 @@
 #include "../../util/qsort.h"
 #include "../../util/rmalloc.h"
 #include "../../query_ctx.h"
+#include "../../ast/ast_build_op_contexts.h"
+#include <math.h>
+#include <string.h>
+
+// buffers of at least this many records are radix sorted
+#define RADIX_SORT_THRESHOLD 1024
+
+// number of type ranks, one per SIType bit
+#define TYPE_RANK_COUNT 32
+
+// a buffered record and an order preserving abbreviation of its first sort key
+// entries are sorted by (rank, key), ties are resolved by comparing records
+typedef struct {
+	uint64_t key;   // abbreviated sort value
+	uint8_t rank;   // sort value type rank
+	bool exact;     // key fully represents the sort value
+	Record r;       // buffered record
+} SortEntry;
 
 /* Forward declarations. */
 static OpResult SortInit(OpBase *opBase);
@@ -34,13 +52,6 @@ static int _record_compare(Record a, Record b, const OpSort *op) {
 	return 0;
 }
 
-// Quicksort function to compare two records on a subset of fields.
-// Returns true if a is less than b.
-static bool _record_islt(Record a, Record b, const OpSort *op) {
-	return _record_compare(a, b, op) >
-		   0; // Return true if the current left element is less than the right.
-}
-
 // Compares two heap record nodes.
 static int _heap_elem_compare(const void *A, const void *B, const void *udata) {
 	OpSort *op = (OpSort *)udata;
@@ -49,6 +60,175 @@ static int _heap_elem_compare(const void *A, const void *B, const void *udata) {
 	return _record_compare(aRec, bRec, op);
 }
 
+//------------------------------------------------------------------------------
+// Sort key abbreviation
+//------------------------------------------------------------------------------
+
+// maps a double to an unsigned integer with the same ordering
+static inline uint64_t _DoubleKey(double d, bool *exact) {
+	if(isnan(d)) {
+		*exact = false;
+		return UINT64_MAX;
+	}
+
+	if(d == 0) d = 0;  // -0.0 equals 0.0
+	uint64_t bits;
+	memcpy(&bits, &d, sizeof(bits));
+	return (bits & ((uint64_t)1 << 63)) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+// abbreviate 'v' into an order preserving key
+// values of different types are ordered by their type rank
+static void _AbbreviateKey(SIValue v, SortEntry *e) {
+	SIType t = SI_TYPE(v);
+	e->exact = true;
+	e->key = 0;
+	// integers and doubles are compared against one another
+	e->rank = __builtin_ctz((t & SI_NUMERIC) ? T_INT64 : t);
+
+	switch(t) {
+	case T_INT64:
+		// doubles represent integers up to 2^53 exactly
+		e->exact = (v.longval <= (1LL << 53) && v.longval >= -(1LL << 53));
+		e->key = _DoubleKey((double)v.longval, &e->exact);
+		break;
+	case T_DOUBLE:
+		e->key = _DoubleKey(v.doubleval, &e->exact);
+		break;
+	case T_BOOL:
+		e->key = v.longval;
+		break;
+	case T_STRING: {
+		// big-endian prefix, ordered like strcmp
+		const unsigned char *str = (const unsigned char *)v.stringval;
+		uint i = 0;
+		for(; i < sizeof(uint64_t) && str[i] != '\0'; i++) {
+			e->key |= (uint64_t)str[i] << (8 * (sizeof(uint64_t) - 1 - i));
+		}
+		e->exact = (str[i] == '\0');
+		break;
+	}
+	case T_NODE:
+	case T_EDGE:
+		e->key = ENTITY_GET_ID((GraphEntity *)v.ptrval);
+		break;
+	case T_NULL:
+		break;
+	default:
+		// compared by value
+		e->exact = false;
+		break;
+	}
+}
+
+// compares two sort entries, records are compared only if keys are tied
+static inline int _entry_compare(const SortEntry *a, const SortEntry *b,
+		const OpSort *op) {
+	if(a->rank != b->rank) return (a->rank < b->rank) ? -1 : 1;
+	if(a->key != b->key) return (a->key < b->key) ? -1 : 1;
+	if(a->exact && b->exact && array_len(op->record_offsets) == 1) return 0;
+	return _record_compare(a->r, b->r, op);
+}
+
+#define ENTRY_SORT(a, b) (_entry_compare((a), (b), op) < 0)
+
+// LSD radix sort of entries by (rank, key), stable
+static void _RadixSort(SortEntry *entries, SortEntry *tmp, uint n) {
+	// histogram every key byte and the rank in a single pass
+	uint64_t hist[8][256] = {{0}};
+	uint64_t rank_hist[TYPE_RANK_COUNT] = {0};
+	for(uint i = 0; i < n; i++) {
+		uint64_t k = entries[i].key;
+		for(uint b = 0; b < 8; b++) hist[b][(k >> (8 * b)) & 0xFF]++;
+		rank_hist[entries[i].rank]++;
+	}
+
+	SortEntry *src = entries;
+	SortEntry *dst = tmp;
+	uint64_t offsets[256];
+
+	for(uint b = 0; b < 8; b++) {
+		// skip passes in which all keys share the same byte
+		uint64_t k = (src[0].key >> (8 * b)) & 0xFF;
+		if(hist[b][k] == n) continue;
+
+		uint64_t sum = 0;
+		for(uint i = 0; i < 256; i++) {
+			offsets[i] = sum;
+			sum += hist[b][i];
+		}
+		for(uint i = 0; i < n; i++) {
+			dst[offsets[(src[i].key >> (8 * b)) & 0xFF]++] = src[i];
+		}
+
+		SortEntry *swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	// final pass by rank, unless all values share the same type
+	if(rank_hist[src[0].rank] != n) {
+		uint64_t sum = 0;
+		for(uint i = 0; i < TYPE_RANK_COUNT; i++) {
+			offsets[i] = sum;
+			sum += rank_hist[i];
+		}
+		for(uint i = 0; i < n; i++) dst[offsets[src[i].rank]++] = src[i];
+
+		SortEntry *swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if(src != entries) memcpy(entries, src, sizeof(SortEntry) * n);
+}
+
+// sorts buffered records
+// sort keys are extracted into a compact array which is sorted
+// without dereferencing records, records are compared only to break ties
+static void _SortBuffer(OpSort *op) {
+	uint n = array_len(op->buffer);
+	if(n < 2) return;
+
+	bool desc = (op->directions[0] == DIR_DESC);
+	uint first_offset = op->record_offsets[0];
+	SortEntry *entries = rm_malloc(sizeof(SortEntry) * n);
+
+	for(uint i = 0; i < n; i++) {
+		SortEntry *e = entries + i;
+		e->r = op->buffer[i];
+		_AbbreviateKey(Record_Get(e->r, first_offset), e);
+		if(desc) {
+			e->key = ~e->key;
+			e->rank = TYPE_RANK_COUNT - 1 - e->rank;
+		}
+	}
+
+	if(n >= RADIX_SORT_THRESHOLD) {
+		SortEntry *tmp = rm_malloc(sizeof(SortEntry) * n);
+		_RadixSort(entries, tmp, n);
+		rm_free(tmp);
+
+		// order runs of tied keys by comparing records
+		uint run_start = 0;
+		for(uint i = 1; i <= n; i++) {
+			if(i < n && entries[i].rank == entries[run_start].rank &&
+					entries[i].key == entries[run_start].key) continue;
+			uint run_len = i - run_start;
+			if(run_len > 1) {
+				QSORT(SortEntry, entries + run_start, run_len, ENTRY_SORT);
+			}
+			run_start = i;
+		}
+	} else {
+		QSORT(SortEntry, entries, n, ENTRY_SORT);
+	}
+
+	// permute records, records are handed off from the end of the buffer
+	for(uint i = 0; i < n; i++) op->buffer[n - 1 - i] = entries[i].r;
+	rm_free(entries);
+}
+
 static void _accumulate(OpSort *op, Record r) {
 	if(op->limit == UNLIMITED) {
 		/* Not using a heap and there's room for record. */
@@ -120,11 +300,6 @@ static OpResult SortInit(OpBase *opBase) {
 	return OP_OK;
 }
 
-/* `op` is an actual variable in the caller function. Using it in a
- * macro like this is rather ugly, but the macro passed to QSORT must
- * accept only 2 arguments. */
-#define RECORD_SORT(a, b) (_record_islt((*a), (*b), op))
-
 static Record SortConsume(OpBase *opBase) {
 	OpSort *op = (OpSort *)opBase;
 	Record r = _handoff(op);
@@ -141,7 +316,7 @@ static Record SortConsume(OpBase *opBase) {
 	if(!newData) return NULL;
 
 	if(op->buffer) {
-		QSORT(Record, op->buffer, array_len(op->buffer), RECORD_SORT);
+		_SortBuffer(op);
 	} else {
 		// Heap, responses need to be reversed.
 		int records_count = Heap_count(op->heap);
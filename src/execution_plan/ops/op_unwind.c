@@ -10,6 +10,7 @@
 #include "../../datatypes/array.h"
 #include "../../arithmetic/arithmetic_expression.h"
 #include "limits.h"
+#include <strings.h>
 
 #define INDEX_NOT_SET UINT_MAX
 
@@ -27,6 +28,8 @@ OpBase *NewUnwindOp(const ExecutionPlan *plan, AR_ExpNode *exp) {
 	op->list = SI_NullVal();
 	op->currentRecord = NULL;
 	op->listIdx = INDEX_NOT_SET;
+	op->range = false;
+	op->range_pending = false;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_UNWIND, "Unwind", UnwindInit, UnwindConsume,
@@ -36,10 +39,47 @@ OpBase *NewUnwindOp(const ExecutionPlan *plan, AR_ExpNode *exp) {
 	return (OpBase *)op;
 }
 
+// returns true if 'exp' is a call to range()
+static inline bool _isRangeCall(const AR_ExpNode *exp) {
+	return (exp->type == AR_EXP_OP &&
+			strcasecmp(exp->op.func_name, "range") == 0 &&
+			(exp->op.child_count == 2 || exp->op.child_count == 3));
+}
+
+/* Evaluate the bounds of a range() list expression, such that its values
+ * are generated one at a time rather than materialized as an array.
+ * Returns false if the arguments are invalid, in which case the caller
+ * evaluates the expression as a whole to report the error. */
+static bool _initRange(OpUnwind *op) {
+	int64_t args[3] = {0, 0, 1};
+	uint argc = op->exp->op.child_count;
+	for(uint i = 0; i < argc; i++) {
+		SIValue v = AR_EXP_Evaluate(op->exp->op.children[i], op->currentRecord);
+		if(SI_TYPE(v) != T_INT64) {
+			SIValue_Free(v);
+			return false;
+		}
+		args[i] = v.longval;
+	}
+	if(args[2] < 1) return false;
+
+	op->range = true;
+	op->range_start = args[0];
+	op->range_next = args[0];
+	op->range_end = args[1];
+	op->range_step = args[2];
+	op->range_pending = (args[0] <= args[1]);
+	return true;
+}
+
 /* Evaluate list expression, raise runtime exception
  * if expression did not returned a list type value. */
 static void _initList(OpUnwind *op) {
 	op->list = SI_NullVal(); // Null-set the list value to avoid memory errors if evaluation fails.
+	op->range = false;
+	op->range_pending = false;
+	if(_isRangeCall(op->exp) && _initRange(op)) return;
+
 	SIValue new_list = AR_EXP_Evaluate(op->exp, op->currentRecord);
 	if(SI_TYPE(new_list) != T_ARRAY) {
 		Error_SITypeMismatch(new_list, T_ARRAY);
@@ -67,13 +107,45 @@ static OpResult UnwindInit(OpBase *opBase) {
 	return OP_OK;
 }
 
+// emit the next value of a generated range, NULL once the range is depleted
+static Record _handoffRange(OpUnwind *op) {
+	if(!op->range_pending) return NULL;
+
+	int64_t v = op->range_next;
+	// compare distances, 'range_next + range_step' might overflow
+	bool last = ((uint64_t)op->range_end - (uint64_t)v < (uint64_t)op->range_step);
+	if(last) op->range_pending = false;
+	else op->range_next += op->range_step;
+
+	Record r;
+	if(op->op.childCount > 0 && last) {
+		// last value of a child record's range, hand off the record itself
+		r = op->currentRecord;
+		op->currentRecord = NULL;
+	} else {
+		r = OpBase_CloneRecord(op->currentRecord);
+	}
+	Record_AddScalar(r, op->unwindRecIdx, SI_LongVal(v));
+	return r;
+}
+
 /* Try to generate a new value to return
  * NULL will be returned if dynamic list is not evaluted (listIdx = INDEX_NOT_SET)
  * or in case where the current list is fully consumed. */
 Record _handoff(OpUnwind *op) {
+	if(op->range) return _handoffRange(op);
+
 	// If there is a new value ready, return it.
-	if(op->listIdx < SIArray_Length(op->list)) {
-		Record r = OpBase_CloneRecord(op->currentRecord);
+	uint list_len = SIArray_Length(op->list);
+	if(op->listIdx < list_len) {
+		Record r;
+		if(op->op.childCount > 0 && op->listIdx == list_len - 1) {
+			// last value of a child record's list, hand off the record itself
+			r = op->currentRecord;
+			op->currentRecord = NULL;
+		} else {
+			r = OpBase_CloneRecord(op->currentRecord);
+		}
 		Record_Add(r, op->unwindRecIdx, SIArray_Get(op->list, op->listIdx));
 		op->listIdx++;
 		return r;
@@ -95,7 +167,7 @@ static Record UnwindConsume(OpBase *opBase) {
 	// Did we managed to get new data?
 	if((r = OpBase_Consume(child))) {
 		// Free current record to accommodate new record.
-		OpBase_DeleteRecord(op->currentRecord);
+		if(op->currentRecord) OpBase_DeleteRecord(op->currentRecord);
 		op->currentRecord = r;
 		// Free old list.
 		SIValue_Free(op->list);
@@ -110,10 +182,18 @@ static Record UnwindConsume(OpBase *opBase) {
 
 static OpResult UnwindReset(OpBase *ctx) {
 	OpUnwind *op = (OpUnwind *)ctx;
-	// Static should reset index to 0.
-	if(op->op.childCount == 0) op->listIdx = 0;
-	// Dynamic should set index to UINT_MAX, to force refetching of data.
-	else op->listIdx = INDEX_NOT_SET;
+	if(op->op.childCount == 0) {
+		// Static should reset index to 0.
+		op->listIdx = 0;
+		if(op->range) {
+			op->range_next = op->range_start;
+			op->range_pending = (op->range_start <= op->range_end);
+		}
+	} else {
+		// Dynamic should set index to UINT_MAX, to force refetching of data.
+		op->listIdx = INDEX_NOT_SET;
+		op->range_pending = false;
+	}
 	return OP_OK;
 }
 
@@ -19,6 +19,12 @@ typedef struct {
 	uint listIdx;         // Current list index.
 	int unwindRecIdx;     // Update record at this index.
 	Record currentRecord; // record to clone and add a value extracted from the list.
+	bool range;           // values are generated by the range() call 'exp' rather than listed.
+	bool range_pending;   // generated range has values left.
+	int64_t range_start;  // first generated value.
+	int64_t range_next;   // next generated value.
+	int64_t range_end;    // inclusive bound of generated values.
+	int64_t range_step;   // positive distance between generated values.
 } OpUnwind;
 
 /* Creates a new Unwind operation */
@@ -11,6 +11,7 @@
 #include "../../util/arr.h"
 #include "../../util/qsort.h"
 #include "../../util/rmalloc.h"
+#include "../../index/index_batch.h"
 #include "../../arithmetic/arithmetic_expression.h"
 
 /* Forward declarations. */
@@ -20,50 +21,92 @@ static OpResult UpdateReset(OpBase *opBase);
 static OpBase *UpdateClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void UpdateFree(OpBase *opBase);
 
-static bool _UpdateEntity(GraphEntity *ge, PendingUpdateCtx *update) {
-	bool           res       =  false;
+// Returns true if setting 'b' over 'a' changes an attribute's value.
+static bool _ValueChanges(SIValue a, SIValue b) {
+	bool a_null = SIValue_IsNull(a);
+	bool b_null = SIValue_IsNull(b);
+	if(a_null || b_null) return a_null != b_null;
+	return SIValue_Compare(a, b, NULL) != 0;
+}
+
+static void _PendingUpdate_Free(PendingUpdateCtx *update) {
+	if(!update->pending) return;
+	SIValue_Free(update->new_value);
+	if(update->superseded) SIValue_Free(update->first_value);
+	update->pending = false;
+}
+
+/* Apply the latest pending value of an attribute.
+ * Returns the number of attribute changes performed by the superseded
+ * sequence of updates, as if each of them was applied in turn. */
+static uint _UpdateEntity(OpUpdate *op, GraphEntity *ge, GraphEntityType t,
+						  PendingUpdateCtx *update) {
+	uint          changes    =  0;
 	Attribute_ID  attr_id    =  update->attr_id;
 	SIValue       new_value  =  update->new_value;
 
-	// If this entity has been deleted, perform no updates and return early.
-	if(GraphEntity_IsDeleted(ge)) goto cleanup;
+	// If no value was set or this entity has been deleted,
+	// perform no updates and return early.
+	if(!update->pending ||
+	   Graph_EntityIsDeleted(op->gc->g, t, ENTITY_GET_ID(ge))) goto cleanup;
 
 	// Try to get current property value.
-	SIValue *old_value = GraphEntity_GetProperty(ge, attr_id);
+	SIValue old_value = GraphEntity_GetProperty(ge, attr_id);
+	changes = _ValueChanges(old_value, update->first_value) + update->changes;
 
-	if(old_value == PROPERTY_NOTFOUND) {
+	// Record the update for replication, prior to releasing the old value.
+	EffectsBuffer *effects = QueryCtx_GetEffects();
+	if(effects && _ValueChanges(old_value, new_value)) {
+		EffectsBuffer_AddSetProperty(effects, op->gc, t, ge, attr_id, new_value);
+	}
+
+	if(SI_TYPE(old_value) == T_NULL) {
 		// Adding a new property; do nothing if its value is NULL.
 		if(SI_TYPE(new_value) != T_NULL) {
-			res = GraphEntity_AddProperty(ge, attr_id, new_value);
+			GraphEntity_AddProperty(ge, attr_id, new_value);
 		}
 	} else {
 		// Update property.
-		res = GraphEntity_SetProperty(ge, attr_id, new_value);
+		GraphEntity_SetProperty(ge, attr_id, new_value);
 	}
+	Graph_MarkEntityModified(op->gc->g, t, ENTITY_GET_ID(ge));
 
 cleanup:
-	SIValue_Free(new_value);
-	return res;
+	_PendingUpdate_Free(update);
+	return changes;
 }
 
 /* Set a property on an edge. For non-NULL values, the property
  * will be added or updated if it is already present.
  * For NULL values, the property will be deleted if present
  * and nothing will be done otherwise.
- * Returns 1 if a property was set or deleted. */
-static int _UpdateEdge(OpUpdate *op, PendingUpdateCtx *updates,
+ * Returns the number of properties set or deleted. */
+static int _UpdateEdge(OpUpdate *op, PendingEntity *entity, PendingUpdateCtx *updates,
 					   uint update_count) {
 	/* Retrieve GraphEntity:
 	 * Due to Record freeing we can't maintain the original pointer to
 	 * GraphEntity object, but only a pointer to an Entity object, to use the
 	 * GraphEntity_Get, GraphEntity_Add functions we'll use a place holder to
 	 * hold our entity. */
-	int attributes_set = 0;
-	GraphEntity *ge = (GraphEntity *)&updates->e;
+	int          attributes_set  =  0;
+	bool         update_index    =  false;
+	Edge         *edge           =  &entity->e;
+	GraphEntity  *ge             =  (GraphEntity *)edge;
 
 	for(uint i = 0; i < update_count; i++) {
 		PendingUpdateCtx *update = updates + i;
-		attributes_set += (int)_UpdateEntity(ge, update);
+		uint changes = _UpdateEntity(op, ge, GETYPE_EDGE, update);
+		if(changes > 0) {
+			attributes_set += changes;
+			update_index |= update->update_index;
+		}
+	}
+
+	// Update relationship index if indexed fields have been modified.
+	if(update_index) {
+		int relation_id = Edge_GetRelationID(edge);
+		Schema *s = GraphContext_GetSchemaByID(op->gc, relation_id, SCHEMA_EDGE);
+		Schema_AddEdgeToIndices(s, edge);
 	}
 
 	return attributes_set;
@@ -74,9 +117,9 @@ static int _UpdateEdge(OpUpdate *op, PendingUpdateCtx *updates,
  * For NULL values, the property will be deleted if present
  * and nothing will be done otherwise.
  * Relevant indexes will be updated if required.
- * Returns 1 if a property was set or deleted.  */
-static int _UpdateNode(OpUpdate *op, PendingUpdateCtx *updates,
-					   uint update_count) {
+ * Returns the number of properties set or deleted. */
+static int _UpdateNode(OpUpdate *op, PendingEntity *entity, PendingUpdateCtx *updates,
+					   uint update_count, IndexBatch *batch) {
 	/* Retrieve GraphEntity:
 	 * Due to Record freeing we can't maintain the original pointer to
 	 * GraphEntity object, but only a pointer to an Entity object, to use the
@@ -84,57 +127,124 @@ static int _UpdateNode(OpUpdate *op, PendingUpdateCtx *updates,
 	 * hold our entity. */
 	int          attributes_set  =  0;
 	bool         update_index    =  false;
-	Node         *node           =  &updates->n;
+	Node         *node           =  &entity->n;
 	GraphEntity  *ge             =  (GraphEntity*)node;
 
 	for(uint i = 0; i < update_count; i++) {
 		PendingUpdateCtx *update = updates + i;
-		if(_UpdateEntity(ge, update)) {
-			attributes_set++;
+		uint changes = _UpdateEntity(op, ge, GETYPE_NODE, update);
+		if(changes > 0) {
+			attributes_set += changes;
 			// Do we need to update an index for this property?
 			update_index |= update->update_index;
 		}
 	}
 
 	// Update index for node entities if indexed fields have been modified.
-	if(update_index) {
-		int label_id = node->labelID;
-		Schema *s = GraphContext_GetSchemaByID(op->gc, label_id, SCHEMA_NODE);
-		// Introduce updated entity to index.
-		Schema_AddNodeToIndices(s, node);
-	}
+	// Reindexing is deferred until all updates are applied.
+	if(update_index) IndexBatch_AddNode(batch, node->labelID, ENTITY_GET_ID(node));
 
 	return attributes_set;
 }
 
-static void _CommitEntityUpdates(OpUpdate *op, EntityUpdateCtx *ctx) {
+// Order pending entities by type and ID, such that entities are visited
+// in the order they are laid out within the graph's DataBlocks.
+#define PENDING_ENTITY_ISLT(a, b) \
+	((a)->entity_type < (b)->entity_type || ((a)->entity_type == (b)->entity_type && \
+	ENTITY_GET_ID(&(a)->n) < ENTITY_GET_ID(&(b)->n)))
+
+static void _CommitEntityUpdates(OpUpdate *op, EntityUpdateCtx *ctx,
+								 IndexBatch *batch) {
 	uint properties_set = 0;
 	uint updates_per_entity = array_len(ctx->exps);
-	// Total_updates = updates_per_entity * number of entities being updated.
-	uint total_updates = array_len(ctx->updates);
+	uint entity_count = array_len(ctx->entities);
+
+	QSORT(PendingEntity, ctx->entities, entity_count, PENDING_ENTITY_ISLT);
 
 	/* For each iteration of this loop, perform all updates
-	 * enqueued for a single entity. */
-	for(uint i = 0; i < total_updates; i += updates_per_entity) {
+	 * pending for a single entity. */
+	for(uint i = 0; i < entity_count; i++) {
+		PendingEntity *entity = ctx->entities + i;
 		// Set a pointer to the first update context for this entity.
-		PendingUpdateCtx *update_ctx = ctx->updates + i;
-		if(update_ctx->entity_type == GETYPE_NODE) {
-			properties_set += _UpdateNode(op, update_ctx, updates_per_entity);
+		PendingUpdateCtx *update_ctx = ctx->updates + entity->updates;
+		if(entity->entity_type == GETYPE_NODE) {
+			properties_set += _UpdateNode(op, entity, update_ctx, updates_per_entity, batch);
 		} else {
-			properties_set += _UpdateEdge(op, update_ctx, updates_per_entity);
+			properties_set += _UpdateEdge(op, entity, update_ctx, updates_per_entity);
 		}
 	}
 
+	// All pending updates were applied.
+	array_clear(ctx->entities);
+	array_clear(ctx->updates);
+	raxFree(ctx->lookup);
+	ctx->lookup = raxNew();
+
 	if(op->stats) op->stats->properties_set += properties_set;
 }
 
+/* Returns false if a pending update sets a value which another node of its
+ * label holds, or which another pending update sets, under a uniqueness
+ * constraint. Values are checked prior to any update, such that swapping
+ * constrained values between nodes within a single SET is rejected. */
+static bool _EnforceConstraints(OpUpdate *op) {
+	GraphContext *gc = op->gc;
+	rax *claims = NULL;
+	bool valid = true;
+
+	uint ctx_count = array_len(op->update_ctxs);
+	for(uint i = 0; i < ctx_count && valid; i++) {
+		EntityUpdateCtx *ctx = op->update_ctxs + i;
+		uint updates_per_entity = array_len(ctx->exps);
+		uint entity_count = array_len(ctx->entities);
+		for(uint j = 0; j < entity_count && valid; j++) {
+			PendingEntity *entity = ctx->entities + j;
+			if(entity->entity_type != GETYPE_NODE) continue;
+
+			Node *n = &entity->n;
+			int label_id = NODE_GET_LABEL_ID(n, gc->g);
+			if(label_id == GRAPH_NO_LABEL) continue;
+			Schema *s = GraphContext_GetSchemaByID(gc, label_id, SCHEMA_NODE);
+			if(s->constraints == NULL) continue;
+
+			PendingUpdateCtx *updates = ctx->updates + entity->updates;
+			for(uint k = 0; k < updates_per_entity && valid; k++) {
+				PendingUpdateCtx *update = updates + k;
+				if(!update->pending) continue;
+				UniqueConstraint *uc = Schema_GetConstraint(s, update->attr_id);
+				if(uc == NULL) continue;
+
+				// a node may keep its own value
+				SIValue v = update->new_value;
+				if(UniqueConstraint_Lookup(uc, v) == ENTITY_GET_ID(n)) continue;
+
+				if(claims == NULL) claims = raxNew();
+				valid = UniqueConstraint_Claim(uc, claims, v);
+				if(!valid) {
+					ErrorCtx_SetError("Node(s) with label :%s and property '%s' violate a uniqueness constraint",
+									  Schema_GetName(s),
+									  GraphContext_GetAttributeString(gc, uc->attribute));
+				}
+			}
+		}
+	}
+
+	if(claims) raxFree(claims);
+	return valid;
+}
+
 // Commits delayed updates.
 static void _CommitUpdates(OpUpdate *op) {
+	IndexBatch *batch = QueryCtx_GetIndexBatch();
+
 	uint entity_count = array_len(op->update_ctxs);
 	for(uint i = 0; i < entity_count; i++) {
 		EntityUpdateCtx *entity_ctx = &op->update_ctxs[i];
-		_CommitEntityUpdates(op, entity_ctx);
+		_CommitEntityUpdates(op, entity_ctx, batch);
 	}
+
+	// reindex each updated node once
+	IndexBatch_Apply(batch, op->gc);
 }
 
 static Record _handoff(OpUpdate *op) {
@@ -166,6 +276,8 @@ static void _groupUpdateExps(OpUpdate *op, EntityUpdateEvalCtx *update_ctxs) {
 			EntityUpdateCtx new_ctx = { .alias = current->alias,
 										.record_idx = current->record_idx,
 										.updates = array_new(PendingUpdateCtx, 1),
+										.entities = array_new(PendingEntity, 1),
+										.lookup = raxNew(),
 										.exps = array_new(EntityUpdateEvalCtx, 1),
 									  };
 
@@ -214,6 +326,32 @@ static OpResult UpdateInit(OpBase *opBase) {
 	return OP_OK;
 }
 
+/* Returns the pending updates of 'entity', one per update expression.
+ * An entity updated for the first time is introduced with no values set. */
+static PendingUpdateCtx *_PendingUpdates(EntityUpdateCtx *ctx, GraphEntity *entity,
+										 GraphEntityType type) {
+	unsigned char key[sizeof(EntityID) + 1];
+	key[0] = (unsigned char)type;
+	EntityID id = ENTITY_GET_ID(entity);
+	memcpy(key + 1, &id, sizeof(EntityID));
+
+	void *pos = raxFind(ctx->lookup, key, sizeof(key));
+	if(pos != raxNotFound) return ctx->updates + ctx->entities[(uintptr_t)pos].updates;
+
+	uint exp_count = array_len(ctx->exps);
+	PendingEntity pending = {.entity_type = type, .updates = array_len(ctx->updates)};
+	if(type == GETYPE_NODE) pending.n = *((Node *)entity);
+	else pending.e = *((Edge *)entity);
+
+	raxInsert(ctx->lookup, key, sizeof(key), (void *)(uintptr_t)array_len(ctx->entities), NULL);
+	ctx->entities = array_append(ctx->entities, pending);
+
+	PendingUpdateCtx unset = {.pending = false};
+	for(uint i = 0; i < exp_count; i++) ctx->updates = array_append(ctx->updates, unset);
+
+	return ctx->updates + pending.updates;
+}
+
 static void _EvalEntityUpdates(EntityUpdateCtx *ctx, GraphContext *gc,
 							   Record r) {
 	Schema *s         = NULL;
@@ -258,9 +396,11 @@ static void _EvalEntityUpdates(EntityUpdateCtx *ctx, GraphContext *gc,
 		}
 	}
 
+	// Locate the entity's pending updates, introducing them on first update.
+	PendingUpdateCtx *updates = _PendingUpdates(ctx, entity, type);
+
 	uint exp_count = array_len(ctx->exps);
 	for(uint i = 0; i < exp_count; i++) {
-		bool update_index = false;
 		EntityUpdateEvalCtx *update_ctx = ctx->exps + i;
 		SIValue new_value = AR_EXP_Evaluate(update_ctx->exp, r);
 
@@ -272,6 +412,16 @@ static void _EvalEntityUpdates(EntityUpdateCtx *ctx, GraphContext *gc,
 			break;
 		}
 
+		PendingUpdateCtx *update = updates + i;
+		if(update->pending) {
+			// Supersede the previous update, last update wins.
+			if(_ValueChanges(update->new_value, new_value)) update->changes++;
+			if(update->superseded) SIValue_Free(update->new_value);
+			update->new_value = new_value;
+			update->superseded = true;
+			continue;
+		}
+
 		/* Retrieve the ID of the attribute being updated.
 		 * It is important that this is stored in a variable rather than referring to
 		 * the update_ctx because if we swap an indexed property context to the first position
@@ -279,31 +429,34 @@ static void _EvalEntityUpdates(EntityUpdateCtx *ctx, GraphContext *gc,
 		Attribute_ID attr_id = update_ctx->attribute_id;
 		/* Determine whether we must update the index for this set of updates.
 		 * If at least one property being updated is indexed, each node will be reindexed. */
+		bool update_index = false;
 		if(node_update && label) {
-			// If the (label:attribute) combination has an index, take note.
+			// If the (label:attribute) combination has an index or a constraint, take note.
 			update_index = GraphContext_GetIndex(gc, label, &attr_id, IDX_ANY) != NULL;
+			if(!update_index) {
+				Schema *ls = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+				update_index = (ls != NULL && Schema_GetConstraint(ls, attr_id) != NULL);
+			}
+		} else if(edge_update) {
+			// If the (relationship:attribute) combination has an index, take note.
+			int relation_id = Edge_GetRelationID((Edge *)entity);
+			if(relation_id >= 0) {
+				s = GraphContext_GetSchemaByID(gc, relation_id, SCHEMA_EDGE);
+				update_index = Schema_GetIndex(s, &attr_id, IDX_EXACT_MATCH) != NULL;
+			}
 		}
 
-		PendingUpdateCtx update = {
-			.entity_type   =  type,
+		*update = (PendingUpdateCtx) {
 			.new_value     =  new_value,
-			.update_index  =  update_index,
+			.first_value   =  new_value,
+			.changes       =  0,
 			.attr_id       =  attr_id,
+			.update_index  =  update_index,
+			.superseded    =  false,
+			.pending       =  true,
 		};
-
-		if(edge_update) {
-			// Add the edge to the update context.
-			update.e = *((Edge *)entity);
-		} else {
-			// Add the node to the update context.
-			update.n = *((Node *)entity);
-		}
-
-		// Enqueue the current update.
-		ctx->updates = array_append(ctx->updates, update);
 	}
 }
-
 static Record UpdateConsume(OpBase *opBase) {
 	OpUpdate *op = (OpUpdate *)opBase;
 	OpBase *child = op->op.children[0];
@@ -331,6 +484,8 @@ static Record UpdateConsume(OpBase *opBase) {
 
 	// Lock everything.
 	QueryCtx_LockForCommit();
+	// Uniqueness constraints are checked once no other writer can interleave.
+	if(!_EnforceConstraints(op)) ErrorCtx_RaiseRuntimeException(NULL);
 	_CommitUpdates(op);
 	// Release lock.
 	QueryCtx_UnlockCommit(opBase);
@@ -386,7 +541,14 @@ static void _UpdateContexts_Free(EntityUpdateCtx *contexts) {
 			}
 			array_free(update_ctx.exps);
 		}
-		if(update_ctx.updates) array_free(update_ctx.updates);
+		if(update_ctx.updates) {
+			// Free values of updates which were never committed.
+			uint update_count = array_len(update_ctx.updates);
+			for(uint j = 0; j < update_count; j++) _PendingUpdate_Free(update_ctx.updates + j);
+			array_free(update_ctx.updates);
+		}
+		if(update_ctx.entities) array_free(update_ctx.entities);
+		if(update_ctx.lookup) raxFree(update_ctx.lookup);
 	}
 }
 
@@ -14,23 +14,35 @@
 #include "../../arithmetic/arithmetic_expression.h"
 #include "../../ast/ast_build_op_contexts.h"
 
-// Context grouping a set of updates to perform on a single entity.
+// Entity awaiting updates, shared by all of its pending updates.
 typedef struct {
 	union {
 		Node n;
 		Edge e;
 	};                              // Updated entity.
 	GraphEntityType entity_type;    // Type of updated entity.
-	bool update_index;              // Does index effected by update.
-	SIValue new_value;              // Constant value to set.
+	uint updates;                   // Offset of the entity's pending updates.
+} PendingEntity;
+
+// Latest value pending for a single entity attribute,
+// superseding all earlier updates of the attribute.
+typedef struct {
+	SIValue new_value;              // Latest value to set.
+	SIValue first_value;            // Value set by the first update.
+	uint changes;                   // Value changes among updates following the first.
 	Attribute_ID attr_id;           // Id of attribute to update.
+	bool update_index;              // Does index effected by update.
+	bool superseded;                // Has the first update been superseded.
+	bool pending;                   // Has a value been set.
 } PendingUpdateCtx;
 
 typedef struct {
 	int record_idx;             // Record offset this entity is stored at.
 	const char *alias;          // Updated entity alias.
 	EntityUpdateEvalCtx *exps;  // Update expressions converted from the AST.
-	PendingUpdateCtx *updates;  // List of pending updates for this op to commit.
+	PendingEntity *entities;    // Entities pending updates.
+	PendingUpdateCtx *updates;  // Pending updates, one per expression for each entity.
+	rax *lookup;                // Maps an updated entity to its position in entities.
 } EntityUpdateCtx;
 
 typedef struct {
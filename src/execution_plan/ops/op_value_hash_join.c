@@ -8,7 +8,6 @@
 #include "../../value.h"
 #include "../../util/arr.h"
 #include "../../util/rmalloc.h"
-#include "../../util/qsort.h"
 
 /* Forward declarations. */
 static OpResult ValueHashJoinInit(OpBase *opBase);
@@ -17,155 +16,146 @@ static OpResult ValueHashJoinReset(OpBase *opBase);
 static OpBase *ValueHashJoinClone(const ExecutionPlan *plan, const OpBase *opBase);
 static void ValueHashJoinFree(OpBase *opBase);
 
-/* Determins order between two records by inspecting
- * element stored at postion idx. */
-static bool _record_islt(Record l, Record r, uint idx) {
-	SIValue lv = Record_Get(l, idx);
-	SIValue rv = Record_Get(r, idx);
-	return SIValue_Compare(lv, rv, NULL) < 0;
-}
-
-/* `idx` is an actual variable in the caller function.
- * Using it in a macro like this is rather ugly,
- * but the macro passed to QSORT must accept only 2 arguments. */
-#define RECORD_SORT_ON_ENTRY(a, b) (_record_islt((*a), (*b), idx))
-
-// Performs binary search, returns the leftmost index of a match.
-static bool _binarySearchLeftmost(uint *idx, Record *array, uint array_len,
-								  int join_key_idx, SIValue v) {
-	ASSERT(idx != NULL);
-
-	SIValue x;
-	uint pos = 0;
-	uint left = 0;
-	uint right = array_len;
-
-	while(left < right) {
-		pos = (right + left) / 2;
-		x = Record_Get(array[pos], join_key_idx);
-		if(SIValue_Compare(x, v, NULL) < 0) left = pos + 1;
-		else right = pos;
+// Marks the end of a bucket's chain.
+#define NO_ENTRY UINT32_MAX
+
+/* Pulls from both streams in turns until one of them is depleted,
+ * the depleted stream is cached as the build side,
+ * records pulled from the other stream are kept for probing. */
+static void _pick_build_side(OpValueHashJoin *op, Record **build_records) {
+	Record *records[2] = {array_new(Record, 32), array_new(Record, 32)};
+
+	int build_child = -1;
+	while(build_child == -1) {
+		for(int i = 0; i < 2; i++) {
+			OpBase *child = op->op.children[i];
+			Record r = OpBase_Consume(child);
+			if(!r) {
+				build_child = i;
+				break;
+			}
+			// Records are held while the other stream is consumed.
+			Record_PersistScalars(r);
+			records[i] = array_append(records[i], r);
+		}
 	}
 
-	// Make sure value was found.
-	*idx = left;
-
-	if(left == array_len) return false;
-
-	x = Record_Get(array[*idx], join_key_idx);
-	// Return false if the value wasn't found or evaluated to NULL.
-	int disjointOrNull = 0;
-	return (SIValue_Compare(x, v, &disjointOrNull) == 0 &&
-			disjointOrNull != COMPARED_NULL);
+	op->probe_child = !build_child;
+	op->probe_exp = (build_child == 0) ? op->rhs_exp : op->lhs_exp;
+	op->probe_records = records[op->probe_child];
+	*build_records = records[build_child];
 }
 
-// Performs binary search, returns the rightmost index of a match.
-// assuming 'v' exists in 'array'
-static bool _binarySearchRightmost(uint *idx, Record *array, uint array_len, int join_key_idx,
-								   SIValue v) {
-	ASSERT(idx != NULL);
-
-	SIValue x;
-	uint pos = 0;
-	uint left = 0;
-	uint right = array_len;
-
-	while(left < right) {
-		pos = (right + left) / 2;
-		x = Record_Get(array[pos], join_key_idx);
-		if(SIValue_Compare(v, x, NULL) < 0) right = pos;
-		else left = pos + 1;
-	}
+/* Caches the build side records, hashed on their joined value. */
+static void _build(OpValueHashJoin *op) {
+	ASSERT(op->build_records == NULL);
 
-	*idx = right - 1;
-	return true;
-}
+	Record *records;
+	_pick_build_side(op, &records);
+	AR_ExpNode *build_exp = (op->probe_child == 1) ? op->lhs_exp : op->rhs_exp;
 
-/* Retrive the next intersecting record
- * if such exists, otherwise returns NULL. */
-static Record _get_intersecting_record(OpValueHashJoin *op) {
-	// No more intersecting records.
-	if(op->intersect_idx == -1 ||
-	   op->number_of_intersections == 0) return NULL;
+	uint count = array_len(records);
+	op->build_records = array_new(Record, count);
+	op->build_hashes = array_new(uint64_t, count);
+	for(uint i = 0; i < count; i++) {
+		Record r = records[i];
+		// Evaluate joined expression.
+		SIValue v = AR_EXP_Evaluate(build_exp, r);
 
-	Record cr = op->cached_records[op->intersect_idx];
+		// If the joined value is NULL, it cannot be compared to other values - skip this record.
+		if(SIValue_IsNull(v)) {
+			OpBase_DeleteRecord(r);
+			continue;
+		}
 
-	// Update intersection trackers.
-	op->intersect_idx++;
-	op->number_of_intersections--;
+		// Add joined value to record.
+		Record_AddScalar(r, op->join_value_rec_idx, v);
+		Record_PersistScalars(r);
 
-	return cr;
+		op->build_records = array_append(op->build_records, r);
+		v = Record_Get(r, op->join_value_rec_idx);
+		op->build_hashes = array_append(op->build_hashes, SIValue_HashCode(v));
+	}
+	array_free(records);
+
+	// Chain entries into a power of two number of buckets.
+	count = array_len(op->build_records);
+	uint64_t bucket_count = 1;
+	while(bucket_count < count) bucket_count <<= 1;
+	op->bucket_mask = bucket_count - 1;
+	op->buckets = rm_malloc(sizeof(uint32_t) * bucket_count);
+	op->chain = rm_malloc(sizeof(uint32_t) * MAX(count, 1));
+	for(uint64_t i = 0; i < bucket_count; i++) op->buckets[i] = NO_ENTRY;
+
+	// Insert in reverse, such that each chain lists its entries in arrival order.
+	for(uint i = count; i > 0; i--) {
+		uint32_t entry = i - 1;
+		uint64_t bucket = op->build_hashes[entry] & op->bucket_mask;
+		op->chain[entry] = op->buckets[bucket];
+		op->buckets[bucket] = entry;
+	}
 }
 
-/* Look up first intersecting cached record CR position.
- * Returns false if no intersecting record is found. */
-static bool _set_intersection_idx(OpValueHashJoin *op, SIValue v) {
-	op->intersect_idx = -1;
-	op->number_of_intersections = 0;
-	uint record_count = array_len(op->cached_records);
-
-	uint leftmost_idx = 0;
-	uint rightmost_idx = 0;
-
-	if(!_binarySearchLeftmost(&leftmost_idx, op->cached_records,
-							  array_len(op->cached_records), op->join_value_rec_idx, v)) {
-		return false;
+/* Retrive the next build side record matching the current probe record
+ * merged with it, if such exists, otherwise returns NULL. */
+static Record _next_match(OpValueHashJoin *op) {
+	while(op->probe_cursor != NO_ENTRY) {
+		uint32_t entry = op->probe_cursor;
+		op->probe_cursor = op->chain[entry];
+		if(op->build_hashes[entry] != op->probe_hash) continue;
+
+		Record l = op->build_records[entry];
+		SIValue x = Record_Get(l, op->join_value_rec_idx);
+		int disjointOrNull = 0;
+		if(SIValue_Compare(x, op->probe_value, &disjointOrNull) != 0 ||
+		   disjointOrNull == COMPARED_NULL) continue;
+
+		// Clone cached record before merging probe side.
+		Record c = OpBase_CloneRecord(l);
+		Record_Merge(c, op->probe_rec);
+		return c;
 	}
-
-	/* Value was found
-	 * idx points to the first intersecting record.
-	 * update number_of_intersections to count how many
-	 * records share the same value. */
-	op->intersect_idx = leftmost_idx;
-
-	/* Count how many records share the same node.
-	 * reduce search space by truncating left bound */
-	bool found = _binarySearchRightmost(&rightmost_idx, op->cached_records +
-								  leftmost_idx, record_count - leftmost_idx,
-								  op->join_value_rec_idx, v);
-	UNUSED(found);
-	ASSERT(found == true);
-
-	// Compensate index.
-	rightmost_idx += leftmost_idx;
-	// +1 consider rightmost_idx == leftmost_idx.
-	op->number_of_intersections = rightmost_idx - leftmost_idx + 1;
-	ASSERT(op->number_of_intersections > 0);
-
-	return true;
+	return NULL;
 }
 
-/* Sorts cached records by joined value. */
-void _sort_cached_records(OpValueHashJoin *op) {
-	uint idx = op->join_value_rec_idx;
-	QSORT(Record, op->cached_records,
-		  array_len(op->cached_records), RECORD_SORT_ON_ENTRY);
+// Discard current probe side record.
+static void _release_probe_record(OpValueHashJoin *op) {
+	if(!op->probe_rec) return;
+	SIValue_Free(op->probe_value);
+	OpBase_DeleteRecord(op->probe_rec);
+	op->probe_rec = NULL;
+	op->probe_cursor = NO_ENTRY;
 }
 
-/* Caches all records coming from left branch. */
-void _cache_records(OpValueHashJoin *op) {
-	ASSERT(op->cached_records == NULL);
-
-	OpBase *left_child = op->op.children[0];
-	op->cached_records = array_new(Record, 32);
-
-	Record r = left_child->consume(left_child);
-	if(!r) return;
-
-	// As long as there's data coming in from left branch.
-	do {
-		// Evaluate joined expression.
-		SIValue v = AR_EXP_Evaluate(op->lhs_exp, r);
-
-		// If the joined value is NULL, it cannot be compared to other values - skip this record.
-		if(SIValue_IsNull(v)) continue;
+// Free build and probe side state.
+static void _release(OpValueHashJoin *op) {
+	_release_probe_record(op);
+
+	if(op->build_records) {
+		uint record_count = array_len(op->build_records);
+		for(uint i = 0; i < record_count; i++) OpBase_DeleteRecord(op->build_records[i]);
+		array_free(op->build_records);
+		array_free(op->build_hashes);
+		rm_free(op->chain);
+		rm_free(op->buckets);
+		op->build_records = NULL;
+		op->build_hashes = NULL;
+		op->chain = NULL;
+		op->buckets = NULL;
+	}
 
-		// Add joined value to record.
-		Record_AddScalar(r, op->join_value_rec_idx, v);
+	if(op->probe_records) {
+		uint record_count = array_len(op->probe_records);
+		for(uint i = op->probe_record_idx; i < record_count; i++) {
+			OpBase_DeleteRecord(op->probe_records[i]);
+		}
+		array_free(op->probe_records);
+		op->probe_records = NULL;
+	}
 
-		// Cache the record.
-		op->cached_records = array_append(op->cached_records, r);
-	} while((r = left_child->consume(left_child)));
+	op->probe_record_idx = 0;
+	op->probe_child = -1;
+	op->probe_exp = NULL;
 }
 
 /* String representation of operation */
@@ -198,12 +188,21 @@ static int ValueHashJoinToString(const OpBase *ctx, char *buff, uint buff_len) {
 /* Creates a new valueHashJoin operation */
 OpBase *NewValueHashJoin(const ExecutionPlan *plan, AR_ExpNode *lhs_exp, AR_ExpNode *rhs_exp) {
 	OpValueHashJoin *op = rm_malloc(sizeof(OpValueHashJoin));
-	op->rhs_rec = NULL;
 	op->lhs_exp = lhs_exp;
 	op->rhs_exp = rhs_exp;
-	op->intersect_idx = -1;
-	op->cached_records = NULL;
-	op->number_of_intersections = 0;
+	op->probe_exp = NULL;
+	op->probe_child = -1;
+	op->probe_rec = NULL;
+	op->probe_value = SI_NullVal();
+	op->probe_hash = 0;
+	op->probe_cursor = NO_ENTRY;
+	op->probe_records = NULL;
+	op->probe_record_idx = 0;
+	op->build_records = NULL;
+	op->build_hashes = NULL;
+	op->chain = NULL;
+	op->buckets = NULL;
+	op->bucket_mask = 0;
 
 	// Set our Op operations
 	OpBase_Init((OpBase *)op, OPType_VALUE_HASH_JOIN, "Value Hash Join", ValueHashJoinInit,
@@ -220,93 +219,56 @@ static OpResult ValueHashJoinInit(OpBase *ctx) {
 }
 
 /* Produce a record by joining
- * records coming from the left and right hand side
+ * records coming from the build and probe sides
  * of this operation. */
 static Record ValueHashJoinConsume(OpBase *opBase) {
 	OpValueHashJoin *op = (OpValueHashJoin *)opBase;
-	OpBase *right_child = op->op.children[1];
 
-	// Eager, pull from left branch until depleted.
-	if(op->cached_records == NULL) {
-		_cache_records(op);
-		// Sort cache on intersect node ID.
-		_sort_cached_records(op);
-	}
+	// Eager, pull until one of the streams is depleted.
+	if(op->build_records == NULL) _build(op);
+
+	// Nothing to join with.
+	if(array_len(op->build_records) == 0) return NULL;
 
 	/* Try to produce a record:
-	 * given a right hand side record R,
+	 * given a probe side record R,
 	 * evaluate V = exp on R,
 	 * see if there are any cached records
 	 * which V evaluated to V:
-	 * X in cached_records and X[idx] = V
+	 * X in build_records and X[idx] = V
 	 * return merged record:
 	 * X merged with R. */
 
-	Record l;
-	if(op->number_of_intersections > 0) {
-		while((l = _get_intersecting_record(op))) {
-			// Clone cached record before merging rhs.
-			Record c = OpBase_CloneRecord(l);
-			Record_Merge(c, op->rhs_rec);
-			return c;
-		}
-	}
-
-	/* If we're here there are no more
-	 * left hand side records which intersect with R
-	 * discard R. */
-	if(op->rhs_rec) OpBase_DeleteRecord(op->rhs_rec);
-
-	/* Try to get new right hand side record
-	 * which intersect with a left hand side record. */
 	while(true) {
-		// Pull from right branch.
-		op->rhs_rec = right_child->consume(right_child);
-		if(!op->rhs_rec) return NULL;
-
-		// Get value on which we're intersecting.
-		SIValue v = AR_EXP_Evaluate(op->rhs_exp, op->rhs_rec);
-
-		bool found_intersection = _set_intersection_idx(op, v);
-		SIValue_Free(v);
-		// No intersection, discard R.
-		if(!found_intersection) {
-			OpBase_DeleteRecord(op->rhs_rec);
-			continue;
+		if(op->probe_rec) {
+			Record c = _next_match(op);
+			if(c) return c;
+			/* If we're here there are no more
+			 * build side records which intersect with R
+			 * discard R. */
+			_release_probe_record(op);
 		}
 
-		// Found atleast one intersecting record.
-		l = _get_intersecting_record(op);
-
-		// Clone cached record before merging rhs.
-		Record c = OpBase_CloneRecord(l);
-		Record_Merge(c, op->rhs_rec);
+		// Prefer probe records buffered while picking the build side.
+		Record r;
+		if(op->probe_record_idx < array_len(op->probe_records)) {
+			r = op->probe_records[op->probe_record_idx++];
+		} else {
+			r = OpBase_Consume(op->op.children[op->probe_child]);
+			if(!r) return NULL;
+		}
 
-		return c;
+		// Get value on which we're intersecting.
+		op->probe_rec = r;
+		op->probe_value = AR_EXP_Evaluate(op->probe_exp, r);
+		op->probe_hash = SIValue_HashCode(op->probe_value);
+		op->probe_cursor = op->buckets[op->probe_hash & op->bucket_mask];
 	}
 }
 
 static OpResult ValueHashJoinReset(OpBase *ctx) {
 	OpValueHashJoin *op = (OpValueHashJoin *)ctx;
-	op->intersect_idx = -1;
-	op->number_of_intersections = 0;
-
-	// Clear cached records.
-	if(op->rhs_rec) {
-		OpBase_DeleteRecord(op->rhs_rec);
-		op->rhs_rec = NULL;
-	}
-
-	if(op->cached_records) {
-		uint record_count = array_len(op->cached_records);
-		for(uint i = 0; i < record_count; i++) {
-			Record r = op->cached_records[i];
-			OpBase_DeleteRecord(r);
-		}
-		array_free(op->cached_records);
-		op->cached_records = NULL;
-	}
-
+	_release(op);
 	return OP_OK;
 }
 
@@ -320,20 +282,7 @@ static inline OpBase *ValueHashJoinClone(const ExecutionPlan *plan, const OpBase
 static void ValueHashJoinFree(OpBase *ctx) {
 	OpValueHashJoin *op = (OpValueHashJoin *)ctx;
 	// Free cached records.
-	if(op->rhs_rec) {
-		OpBase_DeleteRecord(op->rhs_rec);
-		op->rhs_rec = NULL;
-	}
-
-	if(op->cached_records) {
-		uint record_count = array_len(op->cached_records);
-		for(uint i = 0; i < record_count; i++) {
-			Record r = op->cached_records[i];
-			OpBase_DeleteRecord(r);
-		}
-		array_free(op->cached_records);
-		op->cached_records = NULL;
-	}
+	_release(op);
 
 	if(op->lhs_exp) {
 		AR_EXP_Free(op->lhs_exp);
@@ -345,4 +294,3 @@ static void ValueHashJoinFree(OpBase *ctx) {
 		op->rhs_exp = NULL;
 	}
 }
-
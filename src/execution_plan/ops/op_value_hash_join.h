@@ -10,15 +10,30 @@
 #include "../execution_plan.h"
 #include "../../arithmetic/arithmetic_expression.h"
 
+/* ValueHashJoin joins two streams on the value of an expression.
+ * Both streams are pulled in turns until one of them is depleted,
+ * the depleted stream being the smaller one, it becomes the build side:
+ * its records are hashed on their join value into a chained hash table,
+ * the records pulled from the other, probe side, are buffered and probed
+ * first, followed by the remainder of the probe stream. */
 typedef struct {
 	OpBase op;
-	Record rhs_rec;                     // Right hand side record.
 	AR_ExpNode *lhs_exp;                // Left hand side expression to join on.
 	AR_ExpNode *rhs_exp;                // Right hand side expression to join on.
-	int64_t intersect_idx;              // Current intersection, < number_of_intersections
-	Record *cached_records;             // Cached left hand side records.
+	AR_ExpNode *probe_exp;              // Expression evaluated on probe side records.
+	int probe_child;                    // Index of probe side child, -1 until build side is set.
+	Record probe_rec;                   // Current probe side record.
+	SIValue probe_value;                // Join value of current probe side record.
+	uint64_t probe_hash;                // Hash of probe_value.
+	uint32_t probe_cursor;              // Next build side entry to inspect.
+	Record *probe_records;              // Probe side records pulled while picking the build side.
+	uint probe_record_idx;              // Next buffered probe side record.
+	Record *build_records;              // Build side records, holding their join value.
+	uint64_t *build_hashes;             // Hash of each build side record's join value.
+	uint32_t *chain;                    // Next entry within the same bucket.
+	uint32_t *buckets;                  // First entry of each bucket.
+	uint64_t bucket_mask;               // Number of buckets - 1.
 	uint join_value_rec_idx;            // position on joined expression within record.
-	int64_t number_of_intersections;    // Number of intersections located.
 } OpValueHashJoin;
 
 /* Creates a new ValueHashJoin operation */
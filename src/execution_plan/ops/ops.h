@@ -14,6 +14,9 @@
 #include "op_filter.h"
 #include "op_node_by_label_scan.h"
 #include "op_index_scan.h"
+#include "op_edge_index_scan.h"
+#include "op_edge_by_type_scan.h"
+#include "op_edge_by_id_seek.h"
 #include "op_update.h"
 #include "op_conditional_traverse.h"
 #include "op_cartesian_product.h"
@@ -27,6 +30,7 @@
 #include "op_skip.h"
 #include "op_limit.h"
 #include "op_expand_into.h"
+#include "op_expand_intersect.h"
 #include "op_node_by_id_seek.h"
 #include "op_procedure_call.h"
 #include "op_value_hash_join.h"
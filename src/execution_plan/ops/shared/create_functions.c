@@ -8,21 +8,91 @@
 #include "RG.h"
 #include "../../../errors.h"
 #include "../../../query_ctx.h"
+#include "../../../index/index_batch.h"
+
+// Attribute set of a pending entity, built ahead of commit.
+typedef struct _PreparedProperties {
+	EntityProperty *properties;  // Entity attributes.
+	int count;                   // Number of attributes.
+} _PreparedProperties;
+
+/* Build the attribute sets of pending entities.
+ * Runs before the graph is locked for commit, such that readers are only blocked
+ * while prepared entities are linked into the graph. */
+static _PreparedProperties *_PrepareProperties(ResultSetStatistics *stats,
+											   PendingProperties **pending, uint entity_count) {
+	_PreparedProperties *prepared = rm_malloc(sizeof(_PreparedProperties) * entity_count);
+
+	for(uint i = 0; i < entity_count; i++) {
+		PendingProperties *props = pending[i];
+		prepared[i].properties = NULL;
+		prepared[i].count = 0;
+		if(props == NULL || props->property_count == 0) continue;
+
+		EntityProperty *properties = rm_malloc(sizeof(EntityProperty) * props->property_count);
+		int count = 0;
+		for(int j = 0; j < props->property_count; j++) {
+			// NULL values are not stored.
+			if(SIValue_IsNull(props->values[j])) continue;
+			EntityProperty_Set(properties + count, props->attr_keys[j],
+							   SI_ShareValue(props->values[j]));
+			count++;
+		}
 
-// Add properties to the GraphEntity.
-static inline void _AddProperties(ResultSetStatistics *stats, GraphEntity *ge,
-								  PendingProperties *props) {
-	int failed_updates = 0;
-	for(int i = 0; i < props->property_count; i++) {
-		bool updated = GraphEntity_AddProperty(ge, props->attr_keys[i], props->values[i]);
-		if(!updated) failed_updates++;
+		prepared[i].properties = properties;
+		prepared[i].count = count;
+		stats->properties_set += count;
 	}
 
-	if(stats) stats->properties_set += props->property_count - failed_updates;
+	return prepared;
+}
+
+static void _FreePreparedProperties(_PreparedProperties *prepared, uint entity_count) {
+	if(prepared == NULL) return;
+	for(uint i = 0; i < entity_count; i++) {
+		for(int j = 0; j < prepared[i].count; j++) {
+			EntityProperty_Free(prepared[i].properties + j);
+		}
+		if(prepared[i].properties) rm_free(prepared[i].properties);
+	}
+	rm_free(prepared);
+}
+
+/* Returns false if a pending node holds a value which is already held by
+ * another node of its label, or by another pending node, under a uniqueness
+ * constraint. Checked under the commit lock, before the graph is modified. */
+static bool _EnforceConstraints(PendingCreations *pending) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	rax *claims = NULL;
+	bool valid = true;
+
+	uint node_count = array_len(pending->created_nodes);
+	for(uint i = 0; i < node_count && valid; i++) {
+		Node *n = pending->created_nodes[i];
+		PendingProperties *props = pending->node_properties[i];
+		if(n->label == NULL || props == NULL) continue;
+
+		Schema *s = GraphContext_GetSchema(gc, n->label, SCHEMA_NODE);
+		if(s == NULL || s->constraints == NULL) continue;
+
+		if(claims == NULL) claims = raxNew();
+		for(int j = 0; j < props->property_count && valid; j++) {
+			UniqueConstraint *uc = Schema_GetConstraint(s, props->attr_keys[j]);
+			if(uc == NULL) continue;
+			valid = UniqueConstraint_Claim(uc, claims, props->values[j]);
+			if(!valid) {
+				ErrorCtx_SetError("Node(s) with label :%s and property '%s' violate a uniqueness constraint",
+								  n->label, GraphContext_GetAttributeString(gc, uc->attribute));
+			}
+		}
+	}
+
+	if(claims) raxFree(claims);
+	return valid;
 }
 
 /* Commit insertions. */
-static void _CommitNodes(PendingCreations *pending) {
+static void _CommitNodes(PendingCreations *pending, _PreparedProperties *properties) {
 	Node *n;
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 	Graph *g = gc->g;
@@ -47,6 +117,13 @@ static void _CommitNodes(PendingCreations *pending) {
 	uint node_count = array_len(pending->created_nodes);
 	Graph_AllocateNodes(g, node_count);
 
+	IndexBatch *batch = QueryCtx_GetIndexBatch();
+
+	// Large creations collect node IDs per label and label them at once.
+	GrB_Index **labeled = NULL;
+	bool bulk = node_count >= BULK_COMMIT_THRESHOLD;
+	if(bulk) labeled = rm_calloc(Graph_LabelTypeCount(g), sizeof(GrB_Index *));
+
 	for(uint i = 0; i < node_count; i++) {
 		n = pending->created_nodes[i];
 		Schema *s = NULL;
@@ -61,16 +138,34 @@ static void _CommitNodes(PendingCreations *pending) {
 		}
 
 		// Introduce node into graph.
-		Graph_CreateNode(g, labelID, n);
+		if(bulk && labelID != GRAPH_NO_LABEL) {
+			Graph_CreateNode(g, GRAPH_NO_LABEL, n);
+			if(labeled[labelID] == NULL) labeled[labelID] = array_new(GrB_Index, node_count);
+			labeled[labelID] = array_append(labeled[labelID], ENTITY_GET_ID(n));
+		} else {
+			Graph_CreateNode(g, labelID, n);
+		}
 
-		if(pending->node_properties[i]) _AddProperties(pending->stats, (GraphEntity *)n,
-														   pending->node_properties[i]);
+		GraphEntity_AdoptProperties((GraphEntity *)n, properties[i].properties, properties[i].count);
 
-		if(s && Schema_HasIndices(s)) Schema_AddNodeToIndices(s, n);
+		if(s && Schema_HasIndices(s)) IndexBatch_AddNode(batch, s->id, ENTITY_GET_ID(n));
 	}
+
+	if(bulk) {
+		int label_count = Graph_LabelTypeCount(g);
+		for(int l = 0; l < label_count; l++) {
+			if(labeled[l] == NULL) continue;
+			Graph_BulkLabelNodes(g, l, labeled[l], array_len(labeled[l]));
+			array_free(labeled[l]);
+		}
+		rm_free(labeled);
+	}
+
+	// index created nodes at once
+	IndexBatch_Apply(batch, gc);
 }
 
-static void _CommitEdges(PendingCreations *pending) {
+static void _CommitEdges(PendingCreations *pending, _PreparedProperties *properties) {
 	Edge *e;
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 	Graph *g = gc->g;
@@ -94,6 +189,10 @@ static void _CommitEdges(PendingCreations *pending) {
 	uint edge_count = array_len(pending->created_edges);
 	Graph_AllocateEdges(g, edge_count);
 
+	// Large creations buffer connections and form them per relation type at once.
+	BulkConnections *conns = NULL;
+	if(edge_count >= BULK_COMMIT_THRESHOLD) conns = array_new(BulkConnections, 1);
+
 	for(uint i = 0; i < edge_count; i++) {
 		e = pending->created_edges[i];
 		NodeID srcNodeID;
@@ -112,11 +211,27 @@ static void _CommitEdges(PendingCreations *pending) {
 		ASSERT(schema); // All schemas have been created in the edge blueprint loop or earlier.
 		int relation_id = schema->id;
 
-		int nodes_created = Graph_ConnectNodes(g, srcNodeID, destNodeID, relation_id, e);
-		ASSERT(nodes_created == 1);
+		if(conns) {
+			Graph_CreateEdge(g, srcNodeID, destNodeID, relation_id, e);
+			Graph_BufferConnection(&conns, e);
+		} else {
+			int nodes_created = Graph_ConnectNodes(g, srcNodeID, destNodeID, relation_id, e);
+			ASSERT(nodes_created == 1);
+		}
 
-		if(pending->edge_properties[i]) _AddProperties(pending->stats, (GraphEntity *)e,
-														   pending->edge_properties[i]);
+		GraphEntity_AdoptProperties((GraphEntity *)e, properties[i].properties, properties[i].count);
+	}
+
+	if(conns) {
+		Graph_BulkConnect(g, conns);
+		array_free(conns);
+	}
+
+	// Index edges once they're connected.
+	for(uint i = 0; i < edge_count; i++) {
+		e = pending->created_edges[i];
+		Schema *schema = GraphContext_GetSchemaByID(gc, e->relationID, SCHEMA_EDGE);
+		if(Schema_HasIndices(schema)) Schema_AddEdgeToIndices(schema, e);
 	}
 }
 
@@ -130,6 +245,10 @@ PendingCreations NewPendingCreationsContainer(NodeCreateCtx *nodes, EdgeCreateCt
 	pending.node_properties = array_new(PendingProperties *, 0);
 	pending.edge_properties = array_new(PendingProperties *, 0);
 	pending.stats = NULL;
+	pending.prepared_nodes = NULL;
+	pending.prepared_edges = NULL;
+	pending.prepared_node_count = 0;
+	pending.prepared_edge_count = 0;
 
 	return pending;
 }
@@ -140,23 +259,56 @@ void CommitNewEntities(OpBase *op, PendingCreations *pending) {
 	uint node_count = array_len(pending->created_nodes);
 	uint edge_count = array_len(pending->created_edges);
 	if(!pending->stats) pending->stats = QueryCtx_GetResultSetStatistics();
+
+	// Build attribute sets before acquiring the lock.
+	_PreparedProperties *node_props = _PrepareProperties(pending->stats,
+														 pending->node_properties, node_count);
+	_PreparedProperties *edge_props = _PrepareProperties(pending->stats,
+														 pending->edge_properties, edge_count);
+	// Owned by the container up until they're committed.
+	pending->prepared_nodes = node_props;
+	pending->prepared_edges = edge_props;
+	pending->prepared_node_count = node_count;
+	pending->prepared_edge_count = edge_count;
+
 	// Lock everything.
 	QueryCtx_LockForCommit();
 
+	// Uniqueness constraints are checked once no other writer can interleave.
+	if(node_count > 0 && !_EnforceConstraints(pending)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return;
+	}
+	pending->prepared_nodes = NULL;
+	pending->prepared_edges = NULL;
+
 	/* Set sync policy to resize to capacity only for node introduction
 	 * as only node creation can have an effect on matrix dimensions. */
 	Graph_SetMatrixPolicy(g, RESIZE_TO_CAPACITY);
-	if(node_count > 0) _CommitNodes(pending);
+	if(node_count > 0) _CommitNodes(pending, node_props);
 
-	/* Reset sync policy to minimum space to avoid further matrix resize:
-	 * From capacity to actual node count.
+	/* Reset sync policy to minimum space, matrices were resized to fit
+	 * the nodes reserved by _CommitNodes, which are all created by now.
 	 * Recall that edge creation/deletion doesn't have an effect on matrix dimensions. */
 	Graph_SetMatrixPolicy(g, SYNC_AND_MINIMIZE_SPACE);
-	if(edge_count > 0) _CommitEdges(pending);
+	if(edge_count > 0) _CommitEdges(pending, edge_props);
+
+	// Record committed entities for replication.
+	EffectsBuffer *effects = QueryCtx_GetEffects();
+	if(effects) {
+		GraphContext *gc = QueryCtx_GetGraphCtx();
+		EffectsBuffer_AddCreateNodes(effects, gc, pending->created_nodes, node_count);
+		EffectsBuffer_AddCreateEdges(effects, gc, pending->created_edges, edge_count);
+	}
+
 	// Release lock.
 	pending->stats->nodes_created += node_count;
 	pending->stats->relationships_created += edge_count;
 	QueryCtx_UnlockCommit(op);
+
+	// Attribute arrays are owned by the committed entities.
+	rm_free(node_props);
+	rm_free(edge_props);
 }
 
 // Resolve the properties specified in the query into constant values.
@@ -209,6 +361,12 @@ void PendingPropertiesFree(PendingProperties *props) {
 
 // Free all data associated with a completed create operation.
 void PendingCreationsFree(PendingCreations *pending) {
+	// Attribute sets of an aborted commit.
+	_FreePreparedProperties(pending->prepared_nodes, pending->prepared_node_count);
+	_FreePreparedProperties(pending->prepared_edges, pending->prepared_edge_count);
+	pending->prepared_nodes = NULL;
+	pending->prepared_edges = NULL;
+
 	if(pending->nodes_to_create) {
 		uint nodes_to_create_count = array_len(pending->nodes_to_create);
 		for(uint i = 0; i < nodes_to_create_count; i ++) {
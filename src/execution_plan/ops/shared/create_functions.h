@@ -10,6 +10,10 @@
 #include "../../../ast/ast_shared.h"
 #include "../../../resultset/resultset_statistics.h"
 
+// Creations of at least this many entities form their matrix entries
+// using a single matrix build per label and relation type.
+#define BULK_COMMIT_THRESHOLD 1024
+
 // Container struct for properties to be added to a new graph entity
 typedef struct {
 	const Attribute_ID *attr_keys; // IDs of property keys to be added.
@@ -27,6 +31,13 @@ typedef struct {
 	Node **created_nodes;
 	Edge **created_edges;
 	ResultSetStatistics *stats;
+
+	// Attribute sets built ahead of commit, released along with the container
+	// if the commit is aborted, e.g. by a timeout or a conflicting writer.
+	struct _PreparedProperties *prepared_nodes;
+	struct _PreparedProperties *prepared_edges;
+	uint prepared_node_count;
+	uint prepared_edge_count;
 } PendingCreations;
 
 // Initialize all variables for storing pending creations.
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "parallel_aggregate.h"
+#include "RG.h"
+#include "../../../config.h"
+#include "../../../query_ctx.h"
+#include "../../../util/arr.h"
+#include "../../../util/rmalloc.h"
+#include "../../../graph/entities/graph_entity.h"
+#include <omp.h>
+#include <strings.h>
+
+// a value extracted from a record without the arithmetic expression engine
+typedef struct {
+	const char *alias;      // referenced record entry
+	int rec_idx;            // record position of alias, INVALID_INDEX if unresolved
+	const char *attr_name;  // accessed attribute, NULL if the entry itself is used
+	Attribute_ID attr;      // accessed attribute id
+	SIType types;           // accepted value types
+	bool retained;          // value is kept beyond the lifetime of its record
+} _Operand;
+
+// partial groups built by a single thread
+typedef struct {
+	CacheGroup *groups;  // partial groups
+	Group *last;         // last accessed partial group
+} _Partial;
+
+struct ParallelAggregate {
+	_Operand *operands;           // key operands followed by aggregated arguments
+	uint operand_count;           // number of operands
+	uint key_count;               // number of key operands
+	uint aggregate_count;         // number of aggregated arguments
+	AR_ExpNode **aggregate_exps;  // aggregating expression templates
+	_Partial *partials;           // partial groups of each thread
+	SIValue *values;              // extracted values, operand_count per record
+	uint values_cap;              // number of records values can hold
+	uint nthreads;                // number of aggregating threads
+};
+
+static bool _Operand_Init(_Operand *o, const AR_ExpNode *exp) {
+	o->alias      =  NULL;
+	o->rec_idx    =  INVALID_INDEX;
+	o->attr_name  =  NULL;
+	o->attr       =  ATTRIBUTE_NOTFOUND;
+	o->types      =  SI_ALL;
+	o->retained   =  false;
+
+	if(AR_EXP_IsVariadic(exp)) {
+		o->alias = exp->operand.variadic.entity_alias;
+		return true;
+	}
+
+	char *attr;
+	if(AR_EXP_IsAttribute(exp, &attr) && AR_EXP_IsVariadic(exp->op.children[0])) {
+		o->alias = exp->op.children[0]->operand.variadic.entity_alias;
+		o->attr_name = attr;
+		return true;
+	}
+
+	return false;
+}
+
+// resolve record positions and attribute ids, runs on the query thread
+static bool _ResolveOperands(ParallelAggregate *pa, Record r) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	for(uint i = 0; i < pa->operand_count; i++) {
+		_Operand *o = pa->operands + i;
+		if(o->rec_idx == INVALID_INDEX) {
+			o->rec_idx = Record_GetEntryIdx(r, o->alias);
+			if(o->rec_idx == INVALID_INDEX) return false;
+		}
+		// attributes may be introduced while the input is consumed
+		if(o->attr_name != NULL && o->attr == ATTRIBUTE_NOTFOUND) {
+			o->attr = GraphContext_GetAttributeID(gc, o->attr_name);
+		}
+	}
+	return true;
+}
+
+// extracts operand's value from record
+// returns false if the value must be computed by the expression engine
+static bool _Extract(const _Operand *o, Record r, SIValue *v) {
+	SIValue entry = SI_ShareValue(Record_Get(r, o->rec_idx));
+
+	if(o->attr_name == NULL) {
+		// values referencing record memory must not outlive the record
+		if(o->retained && !(SI_TYPE(entry) & (SI_NUMERIC | T_BOOL | T_NULL))) {
+			return false;
+		}
+		*v = entry;
+	} else if(SI_TYPE(entry) == T_NULL) {
+		*v = SI_NullVal();
+	} else if(SI_TYPE(entry) & SI_GRAPHENTITY) {
+		GraphEntity *e = entry.ptrval;
+		// entities pending creation have no attributes to read
+		if(e->entity == NULL) return false;
+		*v = GraphEntity_GetProperty(e, o->attr);
+	} else {
+		// e.g. map access
+		return false;
+	}
+
+	return (SI_TYPE(*v) & o->types);
+}
+
+static Group *_NewPartialGroup(ParallelAggregate *pa, const SIValue *keys) {
+	SIValue *group_keys = rm_malloc(sizeof(SIValue) * pa->key_count);
+	for(uint i = 0; i < pa->key_count; i++) {
+		group_keys[i] = keys[i];
+		SIValue_Persist(group_keys + i);
+	}
+
+	AR_ExpNode **agg_exps = rm_malloc(sizeof(AR_ExpNode *) * pa->aggregate_count);
+	for(uint i = 0; i < pa->aggregate_count; i++) {
+		agg_exps[i] = AR_EXP_Clone(pa->aggregate_exps[i]);
+	}
+
+	return NewGroup(group_keys, pa->key_count, agg_exps, pa->aggregate_count, NULL);
+}
+
+static void _AggregateRow(ParallelAggregate *pa, _Partial *p, const SIValue *row) {
+	const SIValue *keys = row;
+	const SIValue *args = row + pa->key_count;
+
+	// see if the last accessed group can be reused
+	Group *g = p->last;
+	bool reuse = (g != NULL);
+	for(uint i = 0; reuse && i < pa->key_count; i++) {
+		reuse = (SIValue_Compare(g->keys[i], keys[i], NULL) == 0);
+	}
+
+	if(!reuse) {
+		XXH64_hash_t hash = CacheGroupHash(keys, pa->key_count);
+		g = CacheGroupGet(p->groups, hash, keys, pa->key_count);
+		if(g == NULL) {
+			g = _NewPartialGroup(pa, keys);
+			CacheGroupAdd(p->groups, hash, g);
+		}
+		p->last = g;
+	}
+
+	// invoke aggregate functions directly, arguments have been validated
+	for(uint i = 0; i < pa->aggregate_count; i++) {
+		AR_FuncDesc *f = g->aggregationFunctions[i]->op.f;
+		SIValue argv[2] = {args[i], SI_PtrVal(f->privdata)};
+		f->func(argv, 2);
+	}
+}
+
+ParallelAggregate *ParallelAggregate_New(AR_ExpNode **key_exps, uint key_count,
+		AR_ExpNode **aggregate_exps, uint aggregate_count) {
+	uint nthreads;
+	Config_Option_get(Config_OPENMP_NTHREAD, &nthreads);
+	if(nthreads < 2) return NULL;
+
+	uint operand_count = key_count + aggregate_count;
+	_Operand *operands = rm_malloc(sizeof(_Operand) * operand_count);
+
+	for(uint i = 0; i < key_count; i++) {
+		if(!_Operand_Init(operands + i, key_exps[i])) goto fail;
+	}
+
+	for(uint i = 0; i < aggregate_count; i++) {
+		// only single argument aggregations at the root of the expression
+		const AR_ExpNode *exp = aggregate_exps[i];
+		if(!AR_EXP_IsOperation(exp) || !exp->op.f->aggregate) goto fail;
+		if(exp->op.child_count != 1 || !AR_EXP_Mergeable(exp)) goto fail;
+
+		_Operand *o = operands + key_count + i;
+		if(!_Operand_Init(o, exp->op.children[0])) goto fail;
+		o->types = exp->op.f->types[0];
+		// min and max keep a reference to their current result
+		o->retained = (strcasecmp(exp->op.f->name, "min") == 0 ||
+				strcasecmp(exp->op.f->name, "max") == 0);
+	}
+
+	ParallelAggregate *pa = rm_malloc(sizeof(ParallelAggregate));
+	pa->operands         =  operands;
+	pa->operand_count    =  operand_count;
+	pa->key_count        =  key_count;
+	pa->aggregate_count  =  aggregate_count;
+	pa->aggregate_exps   =  aggregate_exps;
+	pa->nthreads         =  nthreads;
+	pa->values           =  NULL;
+	pa->values_cap       =  0;
+	pa->partials         =  rm_malloc(sizeof(_Partial) * nthreads);
+
+	for(uint i = 0; i < nthreads; i++) {
+		pa->partials[i].groups = CacheGroupNew();
+		pa->partials[i].last = NULL;
+	}
+
+	return pa;
+
+fail:
+	rm_free(operands);
+	return NULL;
+}
+
+bool ParallelAggregate_Apply(ParallelAggregate *pa, Record *records, uint n) {
+	ASSERT(pa != NULL && records != NULL);
+
+	if(n == 0) return true;
+	if(!_ResolveOperands(pa, records[0])) return false;
+
+	if(n > pa->values_cap) {
+		pa->values_cap = n;
+		pa->values = rm_realloc(pa->values,
+				sizeof(SIValue) * pa->operand_count * (size_t)n);
+	}
+
+	//--------------------------------------------------------------------------
+	// extract and validate values
+	//--------------------------------------------------------------------------
+
+	int count = n;
+	bool valid = true;
+	uint operand_count = pa->operand_count;
+
+	#pragma omp parallel for num_threads(pa->nthreads) schedule(static) reduction(&&:valid)
+	for(int i = 0; i < count; i++) {
+		SIValue *row = pa->values + (size_t)i * operand_count;
+		for(uint j = 0; j < operand_count; j++) {
+			if(!_Extract(pa->operands + j, records[i], row + j)) valid = false;
+		}
+	}
+
+	// leave it to the expression engine to report errors
+	if(!valid) return false;
+
+	//--------------------------------------------------------------------------
+	// aggregate
+	//--------------------------------------------------------------------------
+
+	// each thread aggregates a contiguous range of records
+	#pragma omp parallel num_threads(pa->nthreads)
+	{
+		uint tid = omp_get_thread_num();
+		uint team = omp_get_num_threads();
+		uint begin = ((uint64_t)n * tid) / team;
+		uint end = ((uint64_t)n * (tid + 1)) / team;
+		_Partial *p = pa->partials + tid;
+
+		for(uint i = begin; i < end; i++) {
+			_AggregateRow(pa, p, pa->values + (size_t)i * operand_count);
+		}
+	}
+
+	return true;
+}
+
+void ParallelAggregate_Merge(ParallelAggregate *pa, CacheGroup *groups) {
+	ASSERT(pa != NULL && groups != NULL);
+
+	for(uint t = 0; t < pa->nthreads; t++) {
+		_Partial *p = pa->partials + t;
+		uint count = CacheGroupCount(p->groups);
+
+		for(uint i = 0; i < count; i++) {
+			Group *g = p->groups->groups[i];
+			XXH64_hash_t hash = CacheGroupHash(g->keys, g->key_count);
+			Group *dst = CacheGroupGet(groups, hash, g->keys, g->key_count);
+			if(dst == NULL) {
+				// hand partial group over as is
+				CacheGroupAdd(groups, hash, g);
+				continue;
+			}
+
+			for(uint j = 0; j < pa->aggregate_count; j++) {
+				AR_EXP_Merge(dst->aggregationFunctions[j], g->aggregationFunctions[j]);
+			}
+			FreeGroup(g);
+		}
+
+		// partial groups have been handed over or freed
+		array_clear(p->groups->groups);
+		FreeGroupCache(p->groups);
+		p->groups = CacheGroupNew();
+		p->last = NULL;
+	}
+}
+
+void ParallelAggregate_Free(ParallelAggregate *pa) {
+	if(pa == NULL) return;
+
+	for(uint i = 0; i < pa->nthreads; i++) FreeGroupCache(pa->partials[i].groups);
+	rm_free(pa->partials);
+	rm_free(pa->operands);
+	if(pa->values) rm_free(pa->values);
+	rm_free(pa);
+}
+
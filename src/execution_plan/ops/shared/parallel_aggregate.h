@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include "../../record.h"
+#include "../../../grouping/group_cache.h"
+#include "../../../arithmetic/arithmetic_expression.h"
+
+// minimal number of buffered records for which aggregation runs in parallel
+#define PARALLEL_AGGREGATE_MIN_RECORDS 16384
+
+/* Parallel aggregate
+ * when every grouping key and aggregated argument is either a projected
+ * variable or an attribute of one, buffered records are split between
+ * OpenMP threads, each thread aggregating its share into partial groups
+ * of its own. once the input is depleted the partial groups are merged
+ * into the operation's group cache through the aggregate functions'
+ * merge routines.
+ *
+ * value extraction doesn't use the arithmetic expression engine, making
+ * it safe to run off the query thread. a batch holding values the
+ * parallel path can't account for, e.g. a map attribute access or an
+ * argument of a mismatched type, is rejected as a whole and left for the
+ * caller to aggregate sequentially, such that errors are still raised on
+ * the query thread. */
+
+typedef struct ParallelAggregate ParallelAggregate;
+
+// create a parallel aggregate for the given key and aggregate expressions
+// returns NULL if any expression can't be evaluated off the query thread
+ParallelAggregate *ParallelAggregate_New
+(
+	AR_ExpNode **key_exps,        // group key expressions
+	uint key_count,               // number of key expressions
+	AR_ExpNode **aggregate_exps,  // aggregating expressions
+	uint aggregate_count          // number of aggregating expressions
+);
+
+// aggregate records into per-thread partial groups
+// returns false if nothing was aggregated, in which case
+// the caller is expected to aggregate the records itself
+// records are not freed
+bool ParallelAggregate_Apply
+(
+	ParallelAggregate *pa,  // parallel aggregate
+	Record *records,        // records to aggregate
+	uint n                  // number of records
+);
+
+// merge all partial groups into groups
+// partial groups are consumed
+void ParallelAggregate_Merge
+(
+	ParallelAggregate *pa,  // parallel aggregate
+	CacheGroup *groups      // groups to merge into
+);
+
+// free parallel aggregate
+void ParallelAggregate_Free
+(
+	ParallelAggregate *pa
+);
+
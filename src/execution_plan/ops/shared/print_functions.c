@@ -16,14 +16,10 @@ static inline int _NodeToString(char *buf, uint buf_len, const char *alias, cons
 	return offset;
 }
 
-int TraversalToString(const OpBase *op, char *buf, uint buf_len, AlgebraicExpression *ae) {
+// Print the pattern traversed by ae, e.g. (a)-[e:R]->(b).
+static int _PatternToString(const OpBase *op, char *buf, uint buf_len,
+		AlgebraicExpression *ae) {
 	int offset = 0;
-	if(!ae) {
-		offset += snprintf(buf, buf_len, "%s", op->name);
-		return offset;
-	}
-
-	offset += snprintf(buf, buf_len, "%s | ", op->name);
 	// This edge should be printed right-to-left if the edge matrix is transposed.
 	const char *edge = AlgebraicExpression_Edge(ae);
 	bool transpose = (edge && AlgebraicExpression_Transposed(ae));
@@ -52,6 +48,27 @@ int TraversalToString(const OpBase *op, char *buf, uint buf_len, AlgebraicExpres
 	return offset;
 }
 
+int TraversalToString(const OpBase *op, char *buf, uint buf_len, AlgebraicExpression *ae) {
+	int offset = 0;
+	if(!ae) {
+		offset += snprintf(buf, buf_len, "%s", op->name);
+		return offset;
+	}
+
+	offset += snprintf(buf, buf_len, "%s | ", op->name);
+	offset += _PatternToString(op, buf + offset, buf_len - offset, ae);
+	return offset;
+}
+
+int IntersectionToString(const OpBase *op, char *buf, uint buf_len,
+		AlgebraicExpression *a, AlgebraicExpression *b) {
+	int offset = snprintf(buf, buf_len, "%s | ", op->name);
+	offset += _PatternToString(op, buf + offset, buf_len - offset, a);
+	offset += snprintf(buf + offset, buf_len - offset, ", ");
+	offset += _PatternToString(op, buf + offset, buf_len - offset, b);
+	return offset;
+}
+
 int ScanToString(const OpBase *op, char *buf, uint buf_len, const char *alias, const char *label) {
 	int offset = snprintf(buf, buf_len, "%s | ", op->name);
 	buf += offset;
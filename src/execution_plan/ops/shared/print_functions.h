@@ -11,5 +11,9 @@
 
 int TraversalToString(const OpBase *op, char *buf, uint buf_len, AlgebraicExpression *ae);
 
+// Print both patterns whose destinations are intersected, e.g. (a)->(c), (b)->(c).
+int IntersectionToString(const OpBase *op, char *buf, uint buf_len,
+		AlgebraicExpression *a, AlgebraicExpression *b);
+
 int ScanToString(const OpBase *op, char *buf, uint buf_len, const char *alias, const char *label);
 
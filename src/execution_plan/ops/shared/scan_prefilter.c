@@ -0,0 +1,217 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "scan_prefilter.h"
+#include "RG.h"
+#include "../op_filter.h"
+#include "../../../config.h"
+#include "../../../query_ctx.h"
+#include "../../../arithmetic/arithmetic_op.h"
+#include "../../../util/rmalloc.h"
+
+struct ScanPredicate {
+	AST_Operator op;        // OP_AND, OP_OR or a comparison operator
+	Attribute_ID attr;      // compared attribute
+	SIValue v;              // value attribute is compared against
+	ScanPredicate *left;    // left operand of OP_AND / OP_OR
+	ScanPredicate *right;   // right operand of OP_AND / OP_OR
+};
+
+static void _ScanPredicate_Free(ScanPredicate *p) {
+	if(p == NULL) return;
+	_ScanPredicate_Free(p->left);
+	_ScanPredicate_Free(p->right);
+	SIValue_Free(p->v);
+	rm_free(p);
+}
+
+static ScanPredicate *_ScanPredicate_NewCondition(AST_Operator op,
+		ScanPredicate *left, ScanPredicate *right) {
+	ScanPredicate *p = rm_malloc(sizeof(ScanPredicate));
+	p->op     =  op;
+	p->attr   =  ATTRIBUTE_NOTFOUND;
+	p->v      =  SI_NullVal();
+	p->left   =  left;
+	p->right  =  right;
+	return p;
+}
+
+// returns true if exp is an attribute lookup on alias
+// sets attr to the accessed attribute name
+static bool _AttributeOf(const AR_ExpNode *exp, const char *alias, char **attr) {
+	if(!AR_EXP_IsAttribute(exp, attr)) return false;
+	const AR_ExpNode *entity = exp->op.children[0];
+	if(!AR_EXP_IsVariadic(entity)) return false;
+	return strcmp(entity->operand.variadic.entity_alias, alias) == 0;
+}
+
+static bool _ComparisonOp(AST_Operator op) {
+	return (op == OP_EQUAL || op == OP_NEQUAL || op == OP_LT ||
+			op == OP_LE || op == OP_GT || op == OP_GE);
+}
+
+// build a predicate tree which is a necessary condition of filter tree root
+// returns NULL if no such condition can be derived
+static ScanPredicate *_BuildPredicate(const FT_FilterNode *root,
+		const char *alias, GraphContext *gc) {
+	switch(root->t) {
+	case FT_N_COND: {
+		ScanPredicate *l = _BuildPredicate(root->cond.left, alias, gc);
+		ScanPredicate *r = _BuildPredicate(root->cond.right, alias, gc);
+		if(root->cond.op == OP_AND) {
+			// either side of a conjunction is a necessary condition
+			if(l == NULL) return r;
+			if(r == NULL) return l;
+			return _ScanPredicate_NewCondition(OP_AND, l, r);
+		}
+		if(root->cond.op == OP_OR && l != NULL && r != NULL) {
+			return _ScanPredicate_NewCondition(OP_OR, l, r);
+		}
+		_ScanPredicate_Free(l);
+		_ScanPredicate_Free(r);
+		return NULL;
+	}
+	case FT_N_PRED: {
+		AST_Operator op = root->pred.op;
+		if(!_ComparisonOp(op)) return NULL;
+
+		// normalize: attribute lookup on the left, value on the right
+		char *attr = NULL;
+		AR_ExpNode *val = NULL;
+		if(_AttributeOf(root->pred.lhs, alias, &attr)) {
+			val = root->pred.rhs;
+		} else if(_AttributeOf(root->pred.rhs, alias, &attr)) {
+			val = root->pred.lhs;
+			op = ArithmeticOp_ReverseOp(op);
+		} else {
+			return NULL;
+		}
+
+		if(!AR_EXP_IsConstant(val) && !AR_EXP_IsParameter(val)) return NULL;
+
+		ScanPredicate *p = _ScanPredicate_NewCondition(op, NULL, NULL);
+		p->attr = GraphContext_GetAttributeID(gc, attr);
+		p->v = SI_CloneValue(AR_EXP_Evaluate(val, NULL));
+		return p;
+	}
+	default:
+		return NULL;
+	}
+}
+
+// mirrors the comparison semantics of FilterTree_applyFilters
+static bool _Compare(SIValue a, SIValue b, AST_Operator op) {
+	int disjointOrNull = 0;
+	int rel = SIValue_Compare(a, b, &disjointOrNull);
+	if(disjointOrNull == COMPARED_NULL) return false;
+	if(disjointOrNull == DISJOINT) return (op == OP_NEQUAL);
+
+	switch(op) {
+	case OP_EQUAL:
+		return rel == 0;
+	case OP_NEQUAL:
+		return rel != 0;
+	case OP_GT:
+		return rel > 0;
+	case OP_GE:
+		return rel >= 0;
+	case OP_LT:
+		return rel < 0;
+	case OP_LE:
+		return rel <= 0;
+	default:
+		ASSERT(false);
+		return false;
+	}
+}
+
+static bool _Eval(const ScanPredicate *p, const Node *n) {
+	switch(p->op) {
+	case OP_AND:
+		return _Eval(p->left, n) && _Eval(p->right, n);
+	case OP_OR:
+		return _Eval(p->left, n) || _Eval(p->right, n);
+	default: {
+		SIValue v = GraphEntity_GetProperty((const GraphEntity *)n, p->attr);
+		if(SI_TYPE(v) == T_NULL) return false;
+		return _Compare(v, p->v, p->op);
+	}
+	}
+}
+
+ScanPrefilter *ScanPrefilter_New(const OpBase *scan, const char *alias,
+		size_t node_count) {
+	ASSERT(scan != NULL);
+	ASSERT(alias != NULL);
+
+	uint nthreads;
+	Config_Option_get(Config_OPENMP_NTHREAD, &nthreads);
+	if(nthreads < 2) return NULL;
+	if(node_count < PARALLEL_SCAN_MIN_NODES) return NULL;
+
+	const OpBase *parent = scan->parent;
+	if(parent == NULL || parent->type != OPType_FILTER) return NULL;
+
+	const FT_FilterNode *tree = ((const OpFilter *)parent)->filterTree;
+	ScanPredicate *pred = _BuildPredicate(tree, alias, QueryCtx_GetGraphCtx());
+	if(pred == NULL) return NULL;
+
+	ScanPrefilter *pf = rm_malloc(sizeof(ScanPrefilter));
+	pf->pred        =  pred;
+	pf->nthreads    =  nthreads;
+	pf->window_cap  =  nthreads * PARALLEL_SCAN_CHUNK;
+	pf->window_len  =  0;
+	pf->window_idx  =  0;
+	pf->window      =  rm_malloc(sizeof(Node) * pf->window_cap);
+	pf->pass        =  rm_malloc(sizeof(bool) * pf->window_cap);
+
+	return pf;
+}
+
+void ScanPrefilter_Apply(ScanPrefilter *pf) {
+	ASSERT(pf != NULL);
+
+	const ScanPredicate *pred = pf->pred;
+	const Node *window = pf->window;
+	bool *pass = pf->pass;
+	int n = pf->window_len;
+	pf->window_idx = 0;
+
+	// small windows are not worth waking up the thread team
+	if(n <= PARALLEL_SCAN_CHUNK) {
+		for(int i = 0; i < n; i++) pass[i] = _Eval(pred, window + i);
+		return;
+	}
+
+	#pragma omp parallel for num_threads(pf->nthreads) schedule(static, PARALLEL_SCAN_CHUNK)
+	for(int i = 0; i < n; i++) pass[i] = _Eval(pred, window + i);
+}
+
+Node *ScanPrefilter_Next(ScanPrefilter *pf) {
+	ASSERT(pf != NULL);
+
+	while(pf->window_idx < pf->window_len) {
+		uint i = pf->window_idx++;
+		if(pf->pass[i]) return pf->window + i;
+	}
+
+	return NULL;
+}
+
+void ScanPrefilter_Reset(ScanPrefilter *pf) {
+	ASSERT(pf != NULL);
+	pf->window_len = 0;
+	pf->window_idx = 0;
+}
+
+void ScanPrefilter_Free(ScanPrefilter *pf) {
+	if(pf == NULL) return;
+	_ScanPredicate_Free(pf->pred);
+	rm_free(pf->window);
+	rm_free(pf->pass);
+	rm_free(pf);
+}
+
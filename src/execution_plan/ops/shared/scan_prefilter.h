@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include "../op.h"
+#include "../../../graph/graph.h"
+#include "../../../graph/entities/node.h"
+
+// minimal number of scanned nodes for which a scan runs in parallel
+#define PARALLEL_SCAN_MIN_NODES 65536
+
+// number of candidate nodes each thread evaluates per window
+#define PARALLEL_SCAN_CHUNK 4096
+
+/* Scan prefilter
+ * when a scan is followed by a filter which compares attributes of the
+ * scanned node against constants or parameters, the scan evaluates these
+ * comparisons itself over windows of candidate nodes, splitting each
+ * window between OpenMP threads.
+ *
+ * evaluation doesn't use the arithmetic expression engine and is free of
+ * side effects, allocations and errors, making it safe to run off the
+ * query thread. nodes that pass the prefilter are still handed to the
+ * filter operation, such that the prefilter only needs to be a necessary
+ * condition of the filter tree. */
+
+typedef struct ScanPredicate ScanPredicate;
+
+typedef struct {
+	ScanPredicate *pred;  // predicate tree
+	Node *window;         // candidate nodes
+	bool *pass;           // candidate passed prefilter
+	uint window_cap;      // window capacity
+	uint window_len;      // number of candidates in window
+	uint window_idx;      // next candidate to inspect
+	uint nthreads;        // number of threads evaluating the window
+} ScanPrefilter;
+
+// create a prefilter for a scan operation over alias
+// returns NULL if the scan's parent isn't a filter with applicable
+// predicates, or if the scanned population is too small to benefit
+ScanPrefilter *ScanPrefilter_New
+(
+	const OpBase *scan,    // scan operation
+	const char *alias,     // scanned alias
+	size_t node_count      // number of nodes to be scanned
+);
+
+// evaluate prefilter over the first window_len nodes of the window
+void ScanPrefilter_Apply
+(
+	ScanPrefilter *pf
+);
+
+// returns the next candidate within the window which passes the prefilter
+// NULL once the window is exhausted
+Node *ScanPrefilter_Next
+(
+	ScanPrefilter *pf
+);
+
+// discard window content
+void ScanPrefilter_Reset
+(
+	ScanPrefilter *pf
+);
+
+// free prefilter
+void ScanPrefilter_Free
+(
+	ScanPrefilter *pf
+);
+
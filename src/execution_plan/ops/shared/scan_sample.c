@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "scan_sample.h"
+#include "RG.h"
+#include "../../../query_ctx.h"
+#include "../../../util/rmalloc.h"
+
+// splitmix64 finalizer, maps a block to its pseudo random hash
+static inline uint64_t _Hash(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+static inline bool _SampledScan(const OpBase *op) {
+	return (op->type == OPType_ALL_NODE_SCAN ||
+			op->type == OPType_NODE_BY_LABEL_SCAN ||
+			op->type == OPType_NODE_BY_LABEL_AND_ID_SCAN ||
+			op->type == OPType_EDGE_BY_TYPE_SCAN);
+}
+
+// returns true if 'op' is the leftmost tap of its plan
+// each branch of a UNION is driven by a scan of its own
+static bool _DrivingScan(const OpBase *op) {
+	if(op->childCount > 0 || !_SampledScan(op)) return false;
+
+	const OpBase *child = op;
+	const OpBase *parent = op->parent;
+	while(parent != NULL && parent->type != OPType_JOIN) {
+		if(parent->children[0] != child) return false;
+		child = parent;
+		parent = parent->parent;
+	}
+	return true;
+}
+
+ScanSample *ScanSample_New(const OpBase *scan) {
+	ASSERT(scan != NULL);
+
+	double rate = QueryCtx_GetSampleRate();
+	if(rate >= 1 || !_DrivingScan(scan)) return NULL;
+
+	ScanSample *sample = rm_malloc(sizeof(ScanSample));
+	sample->seed = QueryCtx_GetSampleSeed();
+	sample->threshold = (uint64_t)(rate * (double)UINT64_MAX);
+	return sample;
+}
+
+bool ScanSample_Seek(const ScanSample *sample, uint64_t *id, uint64_t end) {
+	ASSERT(sample != NULL && id != NULL);
+
+	uint64_t block = *id / SCAN_SAMPLE_BLOCK;
+	uint64_t last = (end + SCAN_SAMPLE_BLOCK - 1) / SCAN_SAMPLE_BLOCK;
+	if(_Hash(sample->seed ^ block) < sample->threshold) return *id < end;
+
+	// skip to the first sampled block
+	for(block++; block < last; block++) {
+		if(_Hash(sample->seed ^ block) < sample->threshold) {
+			*id = block * SCAN_SAMPLE_BLOCK;
+			return true;
+		}
+	}
+
+	*id = end;
+	return false;
+}
+
+double ScanSample_Rate(const OpBase *op) {
+	ASSERT(op != NULL);
+
+	double rate = QueryCtx_GetSampleRate();
+	if(rate >= 1 || op->childCount == 0) return 1;
+
+	// records past an aggregation, a limit or a distinct
+	// are no longer sampled at the scan's rate
+	const OpBase *leaf = op->children[0];
+	while(true) {
+		if(leaf->type == OPType_AGGREGATE || leaf->type == OPType_DISTINCT ||
+		   leaf->type == OPType_LIMIT || leaf->type == OPType_SKIP) {
+			return 1;
+		}
+		if(leaf->childCount == 0) break;
+		leaf = leaf->children[0];
+	}
+
+	return _DrivingScan(leaf) ? rate : 1;
+}
+
+void ScanSample_Free(ScanSample *sample) {
+	ASSERT(sample != NULL);
+	rm_free(sample);
+}
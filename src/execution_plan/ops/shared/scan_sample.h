@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include "../op.h"
+
+// number of consecutive entity IDs sampled or skipped together
+#define SCAN_SAMPLE_BLOCK 1024
+
+/* Scan sample
+ * a query issued with a sample rate reads a random fraction of the graph:
+ * its driving scan, the leftmost tap of its plan, only reads blocks of
+ * SCAN_SAMPLE_BLOCK consecutive IDs drawn by the query, skipping over the
+ * others altogether, all other scans read the entire graph.
+ *
+ * every record derived from the driving scan is thus sampled at the same rate,
+ * aggregations scale their counts and sums accordingly. */
+
+typedef struct {
+	uint64_t seed;       // query's sampling seed
+	uint64_t threshold;  // blocks whose hash is below threshold are read
+} ScanSample;
+
+// create a sample for scan operation 'scan'
+// returns NULL unless the query samples the graph and 'scan' is its driving scan
+ScanSample *ScanSample_New
+(
+	const OpBase *scan  // scan operation
+);
+
+// advances 'id' to the first ID at or past it within a sampled block
+// returns false if there is none below 'end'
+bool ScanSample_Seek
+(
+	const ScanSample *sample,
+	uint64_t *id,   // [input/output] ID to advance
+	uint64_t end    // upper bound, exclusive
+);
+
+// returns the rate at which the records 'op' consumes from its first child
+// were sampled, 1 unless they derive from a sampled scan
+double ScanSample_Rate
+(
+	const OpBase *op
+);
+
+// free sample
+void ScanSample_Free
+(
+	ScanSample *sample
+);
@@ -16,7 +16,7 @@
 
 /* applyJoin will try to locate situations where two disjoint
  * streams can be joined on a key attribute, in which case the
- * runtime complaxity is reduced from O(n^2) to O(nlogn + 2n)
+ * runtime complaxity is reduced from O(n^2) to O(2n)
  * consider MATCH (a), (b) where a.v = b.v RETURN a,b
  * prior to this optimization a and b will be combined via a
  * cartesian product O(n^2) because a and b are related,
@@ -75,9 +75,10 @@ static OpBase *_build_hash_join_op(const ExecutionPlan *plan, OpBase *left_branc
 								   OpBase *right_branch, AR_ExpNode *lhs_join_exp, AR_ExpNode *rhs_join_exp) {
 	OpBase *value_hash_join;
 
-	/* The Value Hash Join will cache its left-hand stream. To reduce the cache size,
-	 * prefer to cache the stream which will produce the smallest number of records.
-	 * Our current heuristic for this is to prefer a stream which contains a filter operation. */
+	/* The Value Hash Join caches whichever stream depletes first, pulling from
+	 * both streams in turns, starting with its left-hand stream.
+	 * Prefer to start with the stream which will produce the smallest number of records,
+	 * our current heuristic for this is to prefer a stream which contains a filter operation. */
 	bool left_branch_filtered = (ExecutionPlan_LocateOp(left_branch, OPType_FILTER) != NULL);
 	bool right_branch_filtered = (ExecutionPlan_LocateOp(right_branch, OPType_FILTER) != NULL);
 	if(!left_branch_filtered && right_branch_filtered) {
@@ -6,19 +6,36 @@
 
 #include "../ops/op.h"
 #include "../ops/op_sort.h"
+#include "../ops/op_skip.h"
 #include "../ops/op_limit.h"
 #include "../ops/op_expand_into.h"
+#include "../ops/op_procedure_call.h"
 #include "../ops/op_conditional_traverse.h"
+#include "../ops/op_expand_intersect.h"
 
 /* applyLimit will traverse the given execution plan looking for Limit operations.
  * Once one is found, all relevant child operations (e.g. Sort) will be
  * notified about the current limit value.
  * This is beneficial as a number of different optimizations can be applied
- * once a limit is known. */
+ * once a limit is known.
+ *
+ * Every operation is also handed the number of records required from it
+ * as a limit hint, allowing batching operations to stop accumulating input
+ * once enough records have been gathered, see OpBase_BatchSize. */
 
-static void notify_limit(OpBase *op, uint limit) {
+// returns a + b, UNLIMITED if either is UNLIMITED or the sum overflows
+static inline uint _Add(uint a, uint b) {
+	if(a == UNLIMITED || b >= UNLIMITED - a) return UNLIMITED;
+	return a + b;
+}
+
+// 'skip' is the number of records skipped above 'op' and below the last limit
+static void notify_limit(OpBase *op, uint limit, uint skip) {
 	OPType t = op->type;
 
+	// skipped records are required as well
+	op->limit_hint = _Add(limit, skip);
+
 	switch(t) {
 		// reset limit on eager operation
 		case OPType_MERGE:
@@ -27,30 +44,51 @@ static void notify_limit(OpBase *op, uint limit) {
 		case OPType_DELETE:
 		case OPType_AGGREGATE:
 			limit = UNLIMITED;
+			skip = 0;
 			break;
 		case OPType_LIMIT:
 			// update limit
 			limit = ((OpLimit *)op)->limit;
+			skip = 0;
+			break;
+		case OPType_SKIP:
+			skip = _Add(skip, ((OpSkip *)op)->skip);
 			break;
 		case OPType_SORT:
+			// sort accounts for its skip by itself
 			((OpSort *)op)->limit = limit;
+			// sort consumes its entire input
+			limit = UNLIMITED;
+			skip = 0;
 			break;
 		case OPType_EXPAND_INTO:
-			((OpExpandInto *)op)->record_cap = limit;
+			((OpExpandInto *)op)->record_cap = _Add(limit, skip);
 			break;
 		case OPType_CONDITIONAL_TRAVERSE:
-			((OpCondTraverse *)op)->record_cap = limit;
+			((OpCondTraverse *)op)->record_cap = _Add(limit, skip);
+			break;
+		case OPType_EXPAND_INTERSECT:
+			((OpExpandIntersect *)op)->record_cap = _Add(limit, skip);
+			break;
+		case OPType_PROC_CALL:
+			((OpProcCall *)op)->limit = _Add(limit, skip);
 			break;
 		default:
 			break;
 	}
 
 	for(uint i = 0; i < op->childCount; i++) {
-		notify_limit(op->children[i], limit);
+		OpBase *child = op->children[i];
+		if(i > 0 && (t == OPType_SEMI_APPLY || t == OPType_ANTI_SEMI_APPLY)) {
+			// a single match suffices to resolve a semi apply branch
+			notify_limit(child, 1, 0);
+		} else {
+			notify_limit(child, limit, skip);
+		}
 	}
 }
 
 void applyLimit(ExecutionPlan *plan) {
-	notify_limit(plan->root, UNLIMITED);
+	notify_limit(plan->root, UNLIMITED, 0);
 }
 
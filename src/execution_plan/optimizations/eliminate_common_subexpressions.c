@@ -0,0 +1,146 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../../util/arr.h"
+#include "../ops/op_filter.h"
+#include "../ops/op_project.h"
+#include "../../filter_tree/filter_tree.h"
+
+/* A filter following a projection may repeat an expression the projection
+ * already evaluated, e.g.
+ * WITH n, n.a + n.b AS s WHERE n.a + n.b > 10 RETURN s
+ *
+ * The filter reads the projected value instead of evaluating it again:
+ * Filter (s > 10) <- Project (n, n.a + n.b AS s)
+ * Identical expressions within a single projection are evaluated once
+ * by the projection itself, see NewProjectOp. */
+
+// returns true if every entity exp refers to is projected as itself
+static bool _passedThrough(const OpProject *project, AR_ExpNode *exp) {
+	bool passed = true;
+	rax *entities = raxNew();
+	AR_EXP_CollectEntities(exp, entities);
+
+	raxIterator it;
+	raxStart(&it, entities);
+	raxSeek(&it, "^", NULL, 0);
+	while(passed && raxNext(&it)) {
+		passed = false;
+		for(uint i = 0; i < project->exp_count && !passed; i++) {
+			const AR_ExpNode *projected = project->exps[i];
+			const char *name = projected->resolved_name;
+			passed = AR_EXP_IsVariadic(projected) &&
+					 strlen(name) == it.key_len &&
+					 strncmp(name, (const char *)it.key, it.key_len) == 0 &&
+					 strcmp(projected->operand.variadic.entity_alias, name) == 0;
+		}
+	}
+	raxStop(&it);
+	raxFree(entities);
+
+	return passed;
+}
+
+// collects the projected expressions a following filter may read
+static AR_ExpNode **_sharedExpressions(const OpProject *project) {
+	AR_ExpNode **shared = array_new(AR_ExpNode *, 0);
+
+	for(uint i = 0; i < project->exp_count; i++) {
+		AR_ExpNode *exp = project->exps[i];
+		if(!AR_EXP_IsOperation(exp)) continue;
+		if(!AR_EXP_Deterministic(exp)) continue;
+
+		// the filter's variables must refer to the projection's inputs
+		if(!_passedThrough(project, exp)) continue;
+
+		shared = array_append(shared, exp);
+	}
+
+	return shared;
+}
+
+// replaces subexpressions of *root identical to a shared expression
+// with a read of its projected value
+static void _rewriteExpression(AR_ExpNode **root, AR_ExpNode **shared) {
+	AR_ExpNode *exp = *root;
+	if(!AR_EXP_IsOperation(exp)) return;
+
+	uint count = array_len(shared);
+	for(uint i = 0; i < count; i++) {
+		if(!AR_EXP_Equal(shared[i], exp)) continue;
+		AR_ExpNode *read = AR_EXP_NewVariableOperandNode(shared[i]->resolved_name);
+		read->resolved_name = exp->resolved_name;
+		AR_EXP_Free(exp);
+		*root = read;
+		return;
+	}
+
+	for(int i = 0; i < exp->op.child_count; i++) {
+		_rewriteExpression(exp->op.children + i, shared);
+	}
+}
+
+static void _rewriteFilter(FT_FilterNode *root, AR_ExpNode **shared) {
+	switch(root->t) {
+	case FT_N_EXP:
+		_rewriteExpression(&root->exp.exp, shared);
+		break;
+	case FT_N_PRED:
+		_rewriteExpression(&root->pred.lhs, shared);
+		_rewriteExpression(&root->pred.rhs, shared);
+		break;
+	case FT_N_COND:
+		_rewriteFilter(root->cond.left, shared);
+		if(root->cond.right) _rewriteFilter(root->cond.right, shared);
+		break;
+	default:
+		ASSERT(false);
+		break;
+	}
+}
+
+// returns the projection whose records reach filter unaltered, NULL if none
+static OpProject *_filteredProjection(const OpFilter *filter) {
+	const OpBase *op = filter->op.children[0];
+	while(op->childCount == 1) {
+		switch(op->type) {
+		case OPType_FILTER:
+		case OPType_SORT:
+		case OPType_SKIP:
+		case OPType_LIMIT:
+		case OPType_DISTINCT:
+			op = op->children[0];
+			continue;
+		default:
+			break;
+		}
+		break;
+	}
+	return (op->type == OPType_PROJECT) ? (OpProject *)op : NULL;
+}
+
+static void _eliminateCommonSubexpressions(OpBase *op) {
+	if(op == NULL) return;
+
+	if(op->type == OPType_FILTER && op->childCount == 1) {
+		OpFilter *filter = (OpFilter *)op;
+		OpProject *project = _filteredProjection(filter);
+		if(project != NULL) {
+			AR_ExpNode **shared = _sharedExpressions(project);
+			if(array_len(shared) > 0) _rewriteFilter(filter->filterTree, shared);
+			array_free(shared);
+		}
+	}
+
+	for(int i = 0; i < op->childCount; i++) {
+		_eliminateCommonSubexpressions(op->children[i]);
+	}
+}
+
+void eliminateCommonSubexpressions(ExecutionPlan *plan) {
+	_eliminateCommonSubexpressions(plan->root);
+}
@@ -0,0 +1,75 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../../util/arr.h"
+#include "../../util/strcmp.h"
+#include "../ops/op_expand_into.h"
+#include "../ops/op_expand_intersect.h"
+#include "../ops/op_conditional_traverse.h"
+#include "../execution_plan_build/execution_plan_modify.h"
+
+/* Intersect traversals searches for cycle closing patterns,
+ * where a traversal binds a new node which is immediately checked
+ * for a connection with another, already bound node.
+ *
+ * Consider the following query, execution plan:
+ * MATCH (a)-[:X]->(b)-[:Y]->(c)-[:Z]->(a) RETURN a,b,c
+ * SCAN (a)
+ * TRAVERSE-1 (a)-[:X]->(b)
+ * TRAVERSE-2 (b)-[:Y]->(c)
+ * EXPAND-INTO (c)-[:Z]->(a)
+ * TRAVERSE-2 produces a record for every path a->b->c, most of which
+ * are later discarded by EXPAND-INTO, the cycle closing 'c' nodes are
+ * the intersection of b's Y neighbours and a's incoming Z neighbours,
+ * TRAVERSE-2 and EXPAND-INTO are replaced by a single EXPAND-INTERSECT op
+ * computing this intersection from both sides. */
+
+static void _intersectTraversal(ExecutionPlan *plan, OpExpandInto *expand_into) {
+	OpBase *child = expand_into->op.children[0];
+	if(child->type != OPType_CONDITIONAL_TRAVERSE) return;
+
+	OpCondTraverse *traverse = (OpCondTraverse *)child;
+	// Both ops must be part of the same plan segment.
+	if(traverse->op.plan != expand_into->op.plan) return;
+	// Edges are not collected by the intersection.
+	if(traverse->edge_ctx || expand_into->edge_ctx) return;
+
+	AlgebraicExpression *ae = traverse->ae;
+	AlgebraicExpression *into_ae = expand_into->ae;
+	const char *src = AlgebraicExpression_Source(ae);
+	const char *dest = AlgebraicExpression_Destination(ae);
+	const char *into_src = AlgebraicExpression_Source(into_ae);
+	const char *into_dest = AlgebraicExpression_Destination(into_ae);
+
+	// Label filtering traversals do not bind new nodes.
+	if(!RG_STRCMP(src, dest)) return;
+	// Self loops on the new node are not cycle closing.
+	if(!RG_STRCMP(into_src, into_dest)) return;
+	// Expand-into must involve the node bound by the traversal.
+	if(RG_STRCMP(into_src, dest) && RG_STRCMP(into_dest, dest)) return;
+
+	const ExecutionPlan *op_plan = traverse->op.plan;
+	OpBase *intersect = NewExpandIntersectOp(op_plan, traverse->graph, ae, into_ae);
+
+	// Set expressions to NULL to avoid early free.
+	traverse->ae = NULL;
+	expand_into->ae = NULL;
+
+	ExecutionPlan_RemoveOp(plan, (OpBase *)traverse);
+	OpBase_Free((OpBase *)traverse);
+	ExecutionPlan_ReplaceOp(plan, (OpBase *)expand_into, intersect);
+	OpBase_Free((OpBase *)expand_into);
+}
+
+void intersectTraversals(ExecutionPlan *plan) {
+	OpBase **expand_intos = ExecutionPlan_CollectOps(plan->root, OPType_EXPAND_INTO);
+	uint count = array_len(expand_intos);
+	for(uint i = 0; i < count; i++) {
+		_intersectTraversal(plan, (OpExpandInto *)expand_intos[i]);
+	}
+	array_free(expand_intos);
+}
@@ -0,0 +1,142 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../../util/arr.h"
+#include "../ops/op_sort.h"
+#include "../ops/op_project.h"
+#include "../execution_plan_build/execution_plan_modify.h"
+
+/* A sorted and limited RETURN projects every returned attribute of every
+ * record reaching the sort, while only a handful of records survive it.
+ * e.g. MATCH (n) RETURN n.name, n.bio ORDER BY n.age LIMIT 10
+ *
+ * Attributes which aren't sort keys are fetched once records were sorted
+ * and limited, records reaching the sort carry the entity holding them:
+ * Results <- Project (n.name, n.bio) <- Limit <- Sort <- Project (n, n.age) */
+
+// returns the entity whose attribute 'exp' fetches, NULL if exp isn't
+// an attribute of an entity, as in n.name
+static const char *_attributeEntity(const AR_ExpNode *exp) {
+	if(!AR_EXP_IsAttribute(exp, NULL)) return NULL;
+	const AR_ExpNode *entity = exp->op.children[0];
+	if(!AR_EXP_IsVariadic(entity)) return NULL;
+	return entity->operand.variadic.entity_alias;
+}
+
+// returns true if 'name' is referenced by one of exps, other than exps[skip]
+static bool _referenced(AR_ExpNode **exps, uint skip, const char *name) {
+	bool found = false;
+	rax *aliases = raxNew();
+	uint count = array_len(exps);
+	for(uint i = 0; i < count; i++) {
+		if(i != skip) AR_EXP_CollectEntities(exps[i], aliases);
+	}
+	found = raxFind(aliases, (unsigned char *)name, strlen(name)) != raxNotFound;
+	raxFree(aliases);
+	return found;
+}
+
+// returns the index of the expression projected as 'name', -1 if missing
+static int _projectedAs(AR_ExpNode **exps, const char *name) {
+	uint count = array_len(exps);
+	for(uint i = 0; i < count; i++) {
+		if(strcmp(exps[i]->resolved_name, name) == 0) return i;
+	}
+	return -1;
+}
+
+// returns true if 'exp' can be evaluated once records were sorted
+static bool _deferrable(const OpProject *project, const OpSort *sort, uint idx) {
+	AR_ExpNode *exp = project->exps[idx];
+	const char *entity = _attributeEntity(exp);
+	if(entity == NULL) return false;
+
+	// sort keys are required by the sort
+	if(_projectedAs(sort->exps, exp->resolved_name) != -1) return false;
+	// so are projections other expressions refer to
+	if(_referenced(project->exps, idx, exp->resolved_name)) return false;
+
+	// the entity must reach the sort as itself, not shadowed by a projection
+	int entity_idx = _projectedAs(project->exps, entity);
+	if(entity_idx == -1) return true;
+	const AR_ExpNode *projected = project->exps[entity_idx];
+	return AR_EXP_IsVariadic(projected) &&
+		   strcmp(projected->operand.variadic.entity_alias, entity) == 0;
+}
+
+// returns the sort beneath a limited RETURN, NULL if there's none
+static OpSort *_limitedSort(const OpBase *results) {
+	bool limited = false;
+	const OpBase *op = results->children[0];
+	while(op->type == OPType_LIMIT || op->type == OPType_SKIP) {
+		limited |= (op->type == OPType_LIMIT);
+		op = op->children[0];
+	}
+	if(!limited || op->type != OPType_SORT) return NULL;
+	return (OpSort *)op;
+}
+
+void lateMaterialization(ExecutionPlan *plan) {
+	OpBase *results = plan->root;
+	if(results == NULL || results->type != OPType_RESULTS) return;
+	if(results->childCount != 1) return;
+
+	OpSort *sort = _limitedSort(results);
+	if(sort == NULL) return;
+
+	OpBase *op = sort->op.children[0];
+	if(op->type != OPType_PROJECT || op->childCount != 1) return;
+	OpProject *project = (OpProject *)op;
+
+	uint exp_count = project->exp_count;
+	bool *deferred = rm_malloc(sizeof(bool) * exp_count);
+	uint deferred_count = 0;
+	for(uint i = 0; i < exp_count; i++) {
+		deferred[i] = _deferrable(project, sort, i);
+		deferred_count += deferred[i];
+	}
+
+	if(deferred_count == 0) {
+		rm_free(deferred);
+		return;
+	}
+
+	// the sort's projection evaluates every other expression
+	// and carries the entities of deferred attributes
+	// the final projection forwards sorted values and fetches deferred ones
+	AR_ExpNode **eager = array_new(AR_ExpNode *, exp_count);
+	AR_ExpNode **late = array_new(AR_ExpNode *, exp_count);
+	for(uint i = 0; i < exp_count; i++) {
+		AR_ExpNode *exp = project->exps[i];
+		if(deferred[i]) {
+			late = array_append(late, AR_EXP_Clone(exp));
+			continue;
+		}
+
+		eager = array_append(eager, AR_EXP_Clone(exp));
+		AR_ExpNode *forward = AR_EXP_NewVariableOperandNode(exp->resolved_name);
+		forward->resolved_name = exp->resolved_name;
+		late = array_append(late, forward);
+	}
+
+	for(uint i = 0; i < exp_count; i++) {
+		if(!deferred[i]) continue;
+		const char *entity = _attributeEntity(project->exps[i]);
+		if(_projectedAs(eager, entity) != -1) continue;
+		AR_ExpNode *carry = AR_EXP_NewVariableOperandNode(entity);
+		carry->resolved_name = entity;
+		eager = array_append(eager, carry);
+	}
+	rm_free(deferred);
+
+	OpBase *sorted_projection = NewProjectOp(op->plan, eager);
+	ExecutionPlan_ReplaceOp(plan, op, sorted_projection);
+	OpBase_Free(op);
+
+	OpBase *late_projection = NewProjectOp(results->plan, late);
+	ExecutionPlan_PushBelow(results->children[0], late_projection);
+}
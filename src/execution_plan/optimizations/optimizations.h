@@ -27,9 +27,16 @@ void filterVariableLengthEdges(ExecutionPlan *plan);
 void reduceCartesianProductStreamCount(ExecutionPlan *plan);
 void applyJoin(ExecutionPlan *plan);
 void reduceFilters(ExecutionPlan *plan);
+void eliminateCommonSubexpressions(ExecutionPlan *plan);
+void reorderFilters(ExecutionPlan *plan);
 void reduceTraversal(ExecutionPlan *plan);
+void intersectTraversals(ExecutionPlan *plan);
 void reduceDistinct(ExecutionPlan *plan);
+void reduceVariableLengthPaths(ExecutionPlan *plan);
 void reduceCount(ExecutionPlan *plan);
+void reduceEdgeScans(ExecutionPlan *plan);
+void streamAggregates(ExecutionPlan *plan);
+void lateMaterialization(ExecutionPlan *plan);
 void applyLimit(ExecutionPlan *plan);
 void applySkip(ExecutionPlan *plan);
 
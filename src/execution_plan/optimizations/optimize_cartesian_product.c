@@ -94,6 +94,71 @@ static OpBase **_find_entities_solving_branches(rax *entities, OpBase *cp) {
 	return solving_branches;
 }
 
+// Tests to see if given filter can act as a join condition, see applyJoin.
+static inline bool _join_filter(const FT_FilterNode *f) {
+	return (f->t == FT_N_PRED && f->pred.op == OP_EQUAL);
+}
+
+// Finds the cartesian product's children resolving the entities referenced by 'exp'.
+static OpBase **_find_exp_solving_branches(AR_ExpNode *exp, OpBase *cp) {
+	rax *entities = raxNew();
+	AR_EXP_CollectEntities(exp, entities);
+	OpBase **branches = _find_entities_solving_branches(entities, cp);
+	raxFree(entities);
+	return branches;
+}
+
+// Moves 'branches' of the cartesian product into a nested cartesian product.
+static void _nest_branches(OpBase *cp, OpBase **branches) {
+	uint branch_count = array_len(branches);
+	if(branch_count < 2) return;
+
+	OpBase *nested_cp = NewCartesianProductOp(cp->plan);
+	for(uint i = 0; i < branch_count; i++) {
+		ExecutionPlan_DetachOp(branches[i]);
+		ExecutionPlan_AddOp(nested_cp, branches[i]);
+	}
+	ExecutionPlan_AddOp(cp, nested_cp);
+}
+
+/* Prefer a hash join over filtering the cartesian product output.
+ * An equality filter can only be turned into a join by applyJoin if each of its
+ * sides is resolved by a single branch, consider:
+ * MATCH (a), (b), (c) WHERE a.v + b.v = c.v RETURN a, b, c
+ * when the sides of the filter are resolved by disjoint groups of branches,
+ * each group is nested in a cartesian product of its own, here a and b,
+ * such that the cartesian product can later be replaced with a join. */
+static void _prepare_join(OpBase *cp, OpFilter *filter_op) {
+	FT_FilterNode *f = filter_op->filterTree;
+	if(!_join_filter(f)) return;
+
+	OpBase **lhs_branches = _find_exp_solving_branches(f->pred.lhs, cp);
+	if(lhs_branches == NULL) return;
+	OpBase **rhs_branches = _find_exp_solving_branches(f->pred.rhs, cp);
+	if(rhs_branches == NULL) {
+		array_free(lhs_branches);
+		return;
+	}
+
+	// Make sure no branch resolves both sides.
+	bool disjoint = true;
+	uint lhs_count = array_len(lhs_branches);
+	uint rhs_count = array_len(rhs_branches);
+	for(uint i = 0; i < lhs_count && disjoint; i++) {
+		for(uint j = 0; j < rhs_count && disjoint; j++) {
+			disjoint = (lhs_branches[i] != rhs_branches[j]);
+		}
+	}
+
+	if(disjoint) {
+		_nest_branches(cp, lhs_branches);
+		_nest_branches(cp, rhs_branches);
+	}
+
+	array_free(lhs_branches);
+	array_free(rhs_branches);
+}
+
 static void _optimize_cartesian_product(ExecutionPlan *plan, OpBase *cp) {
 	// Retrieve all filter operations located upstream from the Cartesian Product.
 	FilterCtx *filter_ctx_arr = _locate_filters_and_entities(cp);
@@ -113,6 +178,7 @@ static void _optimize_cartesian_product(ExecutionPlan *plan, OpBase *cp) {
 		// In case this filter is solved by the entire cartesian product, it does not need to be repositioned.
 		if(solving_branch_count == cp->childCount) {
 			array_free(solving_branches);
+			_prepare_join(cp, filter_op);
 			continue;
 		}
 
@@ -138,6 +204,7 @@ static void _optimize_cartesian_product(ExecutionPlan *plan, OpBase *cp) {
 			ExecutionPlan_AddOp(new_cp, solving_branch);
 		}
 		array_free(solving_branches);
+		_prepare_join(new_cp, filter_op);
 
 		if(cp->childCount == 0) {
 			// The entire Cartesian Product can be removed.
@@ -38,15 +38,36 @@ void optimizePlan(ExecutionPlan *plan) {
 	// Try to reduce a number of filters into a single filter op.
 	reduceFilters(plan);
 
+	// Read projected values rather than evaluating them again within filters.
+	eliminateCommonSubexpressions(plan);
+
+	// Order filter conditions by their estimated cost and selectivity.
+	reorderFilters(plan);
+
 	// Reduce traversals where both src and dest nodes are already resolved into an expand into operation.
 	reduceTraversal(plan);
 
+	// Intersect neighbourhoods of bound nodes rather than traversing and expanding into, closing cycles.
+	intersectTraversals(plan);
+
 	// Try to reduce distinct if it follows aggregation.
 	reduceDistinct(plan);
 
+	// Compute reachable nodes rather than paths when only distinct nodes are required.
+	reduceVariableLengthPaths(plan);
+
 	// Try to reduce execution plan incase it perform node or edge counting.
 	reduceCount(plan);
 
+	// Scan the tuples of a relation rather than every node, seeding a traversal.
+	reduceEdgeScans(plan);
+
+	// Emit aggregated groups as soon as they're complete when input is grouped by key.
+	streamAggregates(plan);
+
+	// Fetch returned attributes once records were sorted and limited.
+	lateMaterialization(plan);
+
 	// Let operations know about specified limit(s)
 	applyLimit(plan);
 
@@ -7,16 +7,144 @@
 #include "../ops/ops.h"
 #include "../../util/arr.h"
 #include "../../query_ctx.h"
+#include "../../index/index.h"
+#include "../../datatypes/array.h"
+#include "../../filter_tree/filter_tree.h"
 #include "../../arithmetic/aggregate_funcs/agg_funcs.h"
 #include "../execution_plan_build/execution_plan_modify.h"
 
-static GrB_UnaryOp countMultipleEdges = NULL;
-
 /* The reduceCount optimization will look for execution plan
  * performing solely node counting: total number of nodes in the graph,
  * total number of nodes with a specific label.
  * In which case we can avoid performing both SCAN* and AGGREGATE
- * operations by simply returning Graph_NodeCount or Graph_LabeledNodeCount. */
+ * operations by simply returning Graph_NodeCount or Graph_LabeledNodeCount.
+ *
+ * Additional aggregations answerable from the graph's metadata
+ * are reduced in the same manner:
+ * count grouped by labels(n) or type(r), from per label and relation counts
+ * min and max of an indexed attribute, from the attribute's range index
+ * count grouped by a traversal's source node, from the node's degree. */
+
+// alias of the row produced by the Unwind op introduced by _ProjectRows
+#define METADATA_ROW "__metadata_row"
+
+// returns true if a label scan isn't constrained to an ID range
+static bool _UnboundedLabelScan(const NodeByLabelScan *op) {
+	const UnsignedRange *r = op->id_range;
+	return (r->min == 0 && r->include_min && r->max == UINT64_MAX && r->include_max);
+}
+
+// remove and free the chain of ops below Results
+// each op in the chain is expected to have at most a single child
+static void _ReplaceAggregation(ExecutionPlan *plan, OpResult *opResult,
+								OpBase *replacement) {
+	OpBase *op = ((OpBase *)opResult)->children[0];
+	while(op != NULL) {
+		ASSERT(op->childCount <= 1);
+		OpBase *child = (op->childCount == 1) ? op->children[0] : NULL;
+		ExecutionPlan_RemoveOp(plan, op);
+		OpBase_Free(op);
+		op = child;
+	}
+
+	ExecutionPlan_AddOp((OpBase *)opResult, replacement);
+}
+
+// replace the aggregation with a projection of a single constant value
+static void _ProjectValue(ExecutionPlan *plan, OpResult *opResult,
+						  OpAggregate *opAggregate, SIValue v) {
+	AR_ExpNode *exp = AR_EXP_NewConstOperandNode(v);
+	// The new expression must be aliased to populate the Record.
+	exp->resolved_name = opAggregate->aggregate_exps[0]->resolved_name;
+	AR_ExpNode **exps = array_new(AR_ExpNode *, 1);
+	exps = array_append(exps, exp);
+
+	OpBase *opProject = NewProjectOp(opAggregate->op.plan, exps);
+	_ReplaceAggregation(plan, opResult, opProject);
+}
+
+// replace a grouping aggregation with "Unwind -> Project"
+// each element of 'rows' is an array holding a group key followed by its value
+static void _ProjectRows(ExecutionPlan *plan, OpResult *opResult,
+						 OpAggregate *opAggregate, SIValue rows) {
+	ASSERT(opAggregate->key_count == 1 && opAggregate->aggregate_count == 1);
+	const ExecutionPlan *op_plan = opAggregate->op.plan;
+
+	AR_ExpNode *list = AR_EXP_NewConstOperandNode(rows);
+	list->resolved_name = METADATA_ROW;
+	OpBase *opUnwind = NewUnwindOp(op_plan, list);
+
+	// project each column of the row under the aggregation's aliases
+	const char *names[2] = {
+		opAggregate->key_exps[0]->resolved_name,
+		opAggregate->aggregate_exps[0]->resolved_name
+	};
+	AR_ExpNode **exps = array_new(AR_ExpNode *, 2);
+	for(int i = 0; i < 2; i++) {
+		AR_ExpNode *exp = AR_EXP_NewOpNode("subscript", 2);
+		exp->op.children[0] = AR_EXP_NewVariableOperandNode(METADATA_ROW);
+		exp->op.children[1] = AR_EXP_NewConstOperandNode(SI_LongVal(i));
+		exp->resolved_name = names[i];
+		exps = array_append(exps, exp);
+	}
+
+	OpBase *opProject = NewProjectOp(op_plan, exps);
+	ExecutionPlan_AddOp(opProject, opUnwind);
+	_ReplaceAggregation(plan, opResult, opProject);
+}
+
+// append the row [key, count] to 'rows'
+static void _AppendGroup(SIValue *rows, const char *key, uint64_t count) {
+	SIValue row = SIArray_New(2);
+	SIArray_Append(&row, SI_ConstStringVal((char *)key));
+	SIArray_Append(&row, SI_LongVal(count));
+	SIArray_Append(rows, row);
+	SIValue_Free(row);
+}
+
+// returns true if 'exp' is a non distinct count of every record
+// e.g. count(*) or count(n) where 'n' is a bound entity
+static bool _CountsRecords(const AR_ExpNode *exp) {
+	if(exp->type != AR_EXP_OP ||
+	   exp->op.f->aggregate != true ||
+	   strcasecmp(exp->op.func_name, "count") ||
+	   Aggregate_PerformsDistinct(exp->op.f->privdata)) return false;
+
+	if(exp->op.child_count != 1) return false;
+
+	AR_ExpNode *arg = exp->op.children[0];
+	if(AR_EXP_IsVariadic(arg)) return true;
+	return (AR_EXP_IsConstant(arg) && !SIValue_IsNull(arg->operand.constant));
+}
+
+// returns true if 'exp' applies 'func' to the entity 'alias'
+static bool _AppliesToAlias(const AR_ExpNode *exp, const char *func,
+							const char *alias) {
+	if(exp->type != AR_EXP_OP || strcasecmp(exp->op.func_name, func)) return false;
+	if(exp->op.child_count != 1) return false;
+
+	AR_ExpNode *arg = exp->op.children[0];
+	return (AR_EXP_IsVariadic(arg) &&
+			strcmp(arg->operand.variadic.entity_alias, alias) == 0);
+}
+
+// matches "Aggregate -> Results", where aggregate computes a single
+// aggregation, grouped by 'key_count' keys
+static bool _identifyAggregation(OpBase *root, uint key_count,
+								 OpResult **opResult, OpAggregate **opAggregate) {
+	if(root->type != OPType_RESULTS || root->childCount != 1) return false;
+	OpBase *op = root->children[0];
+	if(op->type != OPType_AGGREGATE || op->childCount != 1) return false;
+
+	OpAggregate *aggregate = (OpAggregate *)op;
+	if(aggregate->aggregate_count != 1 || aggregate->key_count != key_count) {
+		return false;
+	}
+
+	*opResult = (OpResult *)root;
+	*opAggregate = aggregate;
+	return true;
+}
 
 static int _identifyResultAndAggregateOps(OpBase *root, OpResult **opResult,
 										  OpAggregate **opAggregate) {
@@ -72,13 +200,15 @@ static int _identifyNodeCountPattern(OpBase *root, OpResult **opResult, OpAggreg
 	*opScan = op;
 	if(op->type == OPType_NODE_BY_LABEL_SCAN) {
 		NodeByLabelScan *labelScan = (NodeByLabelScan *)op;
+		// label scan restricted to an id range can't be answered by label count
+		if(!_UnboundedLabelScan(labelScan)) return 0;
 		*label = labelScan->n.label;
 	}
 
 	return 1;
 }
 
-bool _reduceNodeCount(ExecutionPlan *plan) {
+static bool _reduceNodeCount(ExecutionPlan *plan) {
 	/* We'll only modify execution plan if it is structured as follows:
 	 * "Scan -> Aggregate -> Results" */
 	const char *label;
@@ -105,23 +235,8 @@ bool _reduceNodeCount(ExecutionPlan *plan) {
 		nodeCount = SI_LongVal(Graph_NodeCount(gc->g));
 	}
 
-	// Construct a constant expression, used by a new projection operation
-	AR_ExpNode *exp = AR_EXP_NewConstOperandNode(nodeCount);
-	// The new expression must be aliased to populate the Record.
-	exp->resolved_name = opAggregate->aggregate_exps[0]->resolved_name;
-	AR_ExpNode **exps = array_new(AR_ExpNode *, 1);
-	exps = array_append(exps, exp);
-
-	OpBase *opProject = NewProjectOp(opAggregate->op.plan, exps);
-
 	// New execution plan: "Project -> Results"
-	ExecutionPlan_RemoveOp(plan, opScan);
-	OpBase_Free(opScan);
-
-	ExecutionPlan_RemoveOp(plan, (OpBase *)opAggregate);
-	OpBase_Free((OpBase *)opAggregate);
-
-	ExecutionPlan_AddOp((OpBase *)opResult, opProject);
+	_ProjectValue(plan, opResult, opAggregate, nodeCount);
 	return true;
 }
 
@@ -149,54 +264,7 @@ static bool _identifyEdgeCountPattern(OpBase *root, OpResult **opResult, OpAggre
 	return true;
 }
 
-void _countEdges(void *z, const void *x) {
-	uint64_t *entry = (uint64_t *) x;
-	if(SINGLE_EDGE(*entry)) {
-		*(uint64_t *)z = 1;
-	} else {
-		// Multiple edges
-		EdgeID *ids = (EdgeID *)(*entry);
-		*(uint64_t *)z = array_len(ids);
-	}
-}
-
-uint64_t _countRelationshipEdges(GrB_Matrix M) {
-	// Create Unary operation only once.
-	if(!countMultipleEdges) {
-		GrB_UnaryOp_new(&countMultipleEdges, _countEdges, GrB_UINT64, GrB_UINT64);
-	}
-
-	/* TODO: to avoid this entire process keep track if
-	 * M contains multiple edges between two given nodes
-	 * if there are no multiple edges,
-	 * i.e. `a` is connected to `b` with multiple edges of type R
-	 * then all we need to do is return M's nnz.
-	 * Otherwise create a new matrix A, where A[i,j] = x
-	 * where x is the number of edges in M[i,j]
-	 * then reduce A using the plus (sum) monoid. */
-
-	GrB_Index nrows;
-	GrB_Index ncols;
-	GrB_Matrix_nrows(&nrows, M);
-	GrB_Matrix_ncols(&ncols, M);
-
-	GrB_Matrix A;
-	GrB_Matrix_new(&A, GrB_UINT64, nrows, ncols);
-
-	// A[i,j] = # of edges in M[i,j].
-	GrB_Matrix_apply(A, GrB_NULL, GrB_NULL,
-					 countMultipleEdges, M, GrB_NULL);
-
-	uint64_t edges = 0;
-	// Sum(A)
-	GrB_Matrix_reduce_UINT64(&edges, GrB_NULL,
-							 GxB_PLUS_UINT64_MONOID, A, GrB_NULL);
-
-	GrB_free(&A);
-	return edges;
-}
-
-void _reduceEdgeCount(ExecutionPlan *plan) {
+static bool _reduceEdgeCount(ExecutionPlan *plan) {
 	/* We'll only modify execution plan if it is structured as follows:
 	 * "Full Scan -> Conditional Traverse -> Aggregate -> Results" */
 	OpBase *opScan;
@@ -207,7 +275,7 @@ void _reduceEdgeCount(ExecutionPlan *plan) {
 	/* See if execution-plan matches the pattern:
 	 * "Full Scan -> Conditional Traverse -> Aggregate -> Results".
 	 * if that's not the case, simply return without making any modifications. */
-	if(!_identifyEdgeCountPattern(plan->root, &opResult, &opAggregate, &opTraverse, &opScan)) return;
+	if(!_identifyEdgeCountPattern(plan->root, &opResult, &opAggregate, &opTraverse, &opScan)) return false;
 
 	/* User is trying to count edges (either in total or of specific types) in the graph.
 	 * Optimize by skipping Scan, Traverse and Aggregate. */
@@ -217,7 +285,7 @@ void _reduceEdgeCount(ExecutionPlan *plan) {
 	// If type is specified, count only labeled entities.
 	OpCondTraverse *condTraverse = (OpCondTraverse *)opTraverse;
 	// The traversal op doesn't contain information about the traversed edge, cannot apply optimization.
-	if(!condTraverse->edge_ctx) return;
+	if(!condTraverse->edge_ctx) return false;
 
 	uint edgeRelationCount = array_len(condTraverse->edge_ctx->edgeRelationTypes);
 
@@ -233,40 +301,292 @@ void _reduceEdgeCount(ExecutionPlan *plan) {
 				// No change to current count, -[:none_existing]->
 				break;
 			default:
-				edges += _countRelationshipEdges(Graph_GetRelationMatrix(g, relType));
+				edges += Graph_RelationEdgeTotal(g, relType);
 		}
 	}
 	edgeCount = SI_LongVal(edges);
 
-	/* Construct a constant expression, used by a new
-	 * projection operation. */
-	AR_ExpNode *exp = AR_EXP_NewConstOperandNode(edgeCount);
-	// The new expression must be aliased to populate the Record.
-	exp->resolved_name = opAggregate->aggregate_exps[0]->resolved_name;
-	AR_ExpNode **exps = array_new(AR_ExpNode *, 1);
-	exps = array_append(exps, exp);
+	// New execution plan: "Project -> Results"
+	_ProjectValue(plan, opResult, opAggregate, edgeCount);
+	return true;
+}
 
-	OpBase *opProject = NewProjectOp(opAggregate->op.plan, exps);
+/* Count grouped by label:
+ * "Scan -> Aggregate(labels(n), count) -> Results"
+ * answered by the number of nodes carrying each label. */
+static bool _reduceLabelGroupCount(ExecutionPlan *plan) {
+	OpResult *opResult;
+	OpAggregate *opAggregate;
+	if(!_identifyAggregation(plan->root, 1, &opResult, &opAggregate)) return false;
+	if(!_CountsRecords(opAggregate->aggregate_exps[0])) return false;
+
+	OpBase *op = ((OpBase *)opAggregate)->children[0];
+	if(op->childCount != 0) return false;
+
+	const char *alias;
+	const NodeByLabelScan *labelScan = NULL;
+	if(op->type == OPType_ALL_NODE_SCAN) {
+		alias = ((AllNodeScan *)op)->alias;
+	} else if(op->type == OPType_NODE_BY_LABEL_SCAN) {
+		labelScan = (NodeByLabelScan *)op;
+		if(!_UnboundedLabelScan(labelScan)) return false;
+		alias = labelScan->n.alias;
+	} else {
+		return false;
+	}
+
+	if(!_AppliesToAlias(opAggregate->key_exps[0], "labels", alias)) return false;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Graph *g = gc->g;
+	SIValue rows = SIArray_New(1);
+
+	if(labelScan != NULL) {
+		// a single group, the scanned label
+		Schema *s = GraphContext_GetSchema(gc, labelScan->n.label, SCHEMA_NODE);
+		uint64_t count = (s) ? Graph_LabeledNodeCount(g, s->id) : 0;
+		if(count > 0) _AppendGroup(&rows, s->name, count);
+	} else {
+		// a group per label, unlabeled nodes are grouped under an empty label
+		uint64_t labeled = 0;
+		int label_count = Graph_LabelTypeCount(g);
+		for(int i = 0; i < label_count; i++) {
+			uint64_t count = Graph_LabeledNodeCount(g, i);
+			if(count == 0) continue;
+			labeled += count;
+			Schema *s = GraphContext_GetSchemaByID(gc, i, SCHEMA_NODE);
+			_AppendGroup(&rows, s->name, count);
+		}
+
+		uint64_t unlabeled = Graph_NodeCount(g) - labeled;
+		if(unlabeled > 0) _AppendGroup(&rows, "", unlabeled);
+	}
+
+	// New execution plan: "Unwind -> Project -> Results"
+	_ProjectRows(plan, opResult, opAggregate, rows);
+	return true;
+}
+
+/* Count grouped by relationship type:
+ * "Full Scan -> Conditional Traverse -> Aggregate(type(r), count) -> Results"
+ * answered by the number of edges of each relationship type. */
+static bool _reduceTypeGroupCount(ExecutionPlan *plan) {
+	OpResult *opResult;
+	OpAggregate *opAggregate;
+	if(!_identifyAggregation(plan->root, 1, &opResult, &opAggregate)) return false;
+	if(!_CountsRecords(opAggregate->aggregate_exps[0])) return false;
+
+	OpBase *op = ((OpBase *)opAggregate)->children[0];
+	if(op->type != OPType_CONDITIONAL_TRAVERSE || op->childCount != 1) return false;
+	OpCondTraverse *condTraverse = (OpCondTraverse *)op;
+
+	// only a full node scan can be converted, see _identifyEdgeCountPattern
+	OpBase *opScan = op->children[0];
+	if(opScan->type != OPType_ALL_NODE_SCAN || opScan->childCount != 0) return false;
+
+	// every edge must be reported exactly once
+	// a traversal filtering its destination or traversing in both directions
+	// reports a different number of edges
+	EdgeTraverseCtx *edge_ctx = condTraverse->edge_ctx;
+	if(edge_ctx == NULL || edge_ctx->direction == GRAPH_EDGE_DIR_BOTH) return false;
+	if(AlgebraicExpression_OperandCount(condTraverse->ae) != 1) return false;
+
+	const char *edge = AlgebraicExpression_Edge(condTraverse->ae);
+	if(edge == NULL) return false;
+	if(!_AppliesToAlias(opAggregate->key_exps[0], "type", edge)) return false;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Graph *g = gc->g;
+	SIValue rows = SIArray_New(1);
+
+	uint relation_count = array_len(edge_ctx->edgeRelationTypes);
+	for(uint i = 0; i < relation_count; i++) {
+		int rel = edge_ctx->edgeRelationTypes[i];
+		if(rel == GRAPH_UNKNOWN_RELATION) continue;
+
+		// -[]-> groups by every relationship type
+		int first = rel;
+		int last = rel + 1;
+		if(rel == GRAPH_NO_RELATION) {
+			first = 0;
+			last = Graph_RelationTypeCount(g);
+		}
+
+		for(int r = first; r < last; r++) {
+			uint64_t count = Graph_RelationEdgeTotal(g, r);
+			if(count == 0) continue;
+			Schema *s = GraphContext_GetSchemaByID(gc, r, SCHEMA_EDGE);
+			_AppendGroup(&rows, s->name, count);
+		}
+	}
+
+	// New execution plan: "Unwind -> Project -> Results"
+	_ProjectRows(plan, opResult, opAggregate, rows);
+	return true;
+}
+
+/* Minimum or maximum of an indexed attribute:
+ * "Label Scan -> Aggregate(min(n.v) or max(n.v)) -> Results"
+ * answered by the extreme entries of the attribute's range index. */
+static bool _reduceIndexedExtreme(ExecutionPlan *plan) {
+	OpResult *opResult;
+	OpAggregate *opAggregate;
+	if(!_identifyAggregation(plan->root, 0, &opResult, &opAggregate)) return false;
+
+	AR_ExpNode *exp = opAggregate->aggregate_exps[0];
+	if(exp->type != AR_EXP_OP || exp->op.f->aggregate != true) return false;
+	bool max = (strcasecmp(exp->op.func_name, "max") == 0);
+	if(!max && strcasecmp(exp->op.func_name, "min") != 0) return false;
+	if(exp->op.child_count != 1) return false;
+
+	OpBase *op = ((OpBase *)opAggregate)->children[0];
+	if(op->type != OPType_NODE_BY_LABEL_SCAN || op->childCount != 0) return false;
+	NodeByLabelScan *labelScan = (NodeByLabelScan *)op;
+	if(!_UnboundedLabelScan(labelScan)) return false;
+
+	// aggregated value must be an attribute of the scanned node
+	char *attr;
+	AR_ExpNode *arg = exp->op.children[0];
+	if(!AR_EXP_IsAttribute(arg, &attr)) return false;
+	AR_ExpNode *entity = arg->op.children[0];
+	if(!AR_EXP_IsVariadic(entity) ||
+	   strcmp(entity->operand.variadic.entity_alias, labelScan->n.alias)) {
+		return false;
+	}
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchema(gc, labelScan->n.label, SCHEMA_NODE);
+	if(s == NULL) return false;
+	Attribute_ID attr_id = GraphContext_GetAttributeID(gc, attr);
+	if(attr_id == ATTRIBUTE_NOTFOUND) return false;
+
+	Index *idx = Schema_GetIndex(s, &attr_id, IDX_EXACT_MATCH);
+	if(idx == NULL || !Index_Enabled(idx)) return false;
+	RangeIndex *range = Index_GetRangeIndex(idx, attr_id);
+
+	// the index must cover every value of the attribute
+	if(range == NULL || RangeIndex_ExcludedCount(range) != 0) return false;
+
+	// read the value from the node itself, preserving its type
+	SIValue v = SI_NullVal();
+	NodeID id;
+	if(RangeIndex_Extreme(range, max, &id)) {
+		Node n = GE_NEW_NODE();
+		if(!Graph_GetNode(gc->g, id, &n)) return false;
+		v = SI_CloneValue(GraphEntity_GetProperty((GraphEntity *)&n, attr_id));
+	}
 
 	// New execution plan: "Project -> Results"
-	ExecutionPlan_RemoveOp(plan, opScan);
-	OpBase_Free(opScan);
+	_ProjectValue(plan, opResult, opAggregate, v);
+	return true;
+}
+
+// returns outdegree(alias, relation) or indegree(alias, relation)
+static AR_ExpNode *_DegreeExp(const char *alias, const char *relation,
+							  GRAPH_EDGE_DIR dir) {
+	const char *func = (dir == GRAPH_EDGE_DIR_OUTGOING) ? "outdegree" : "indegree";
+	AR_ExpNode *exp = AR_EXP_NewOpNode(func, 2);
+	exp->op.children[0] = AR_EXP_NewVariableOperandNode(alias);
+	exp->op.children[1] = AR_EXP_NewConstOperandNode(SI_DuplicateStringVal(relation));
+	return exp;
+}
 
-	ExecutionPlan_RemoveOp(plan, (OpBase *)opTraverse);
-	OpBase_Free(opTraverse);
+/* Count grouped by a traversal's source node:
+ * "Scan -> Conditional Traverse -> Aggregate(n, count)"
+ * becomes "Scan -> Filter(degree(n) > 0) -> Project(n, degree(n))"
+ * where degree(n) is the number of edges of the traversed relationship type,
+ * read from the graph's per node degrees rather than traversing every edge. */
+static bool _reduceDegreeAggregation(ExecutionPlan *plan, OpAggregate *opAggregate) {
+	OpBase *parent = opAggregate->op.parent;
+	if(parent == NULL || opAggregate->op.childCount != 1) return false;
+	if(opAggregate->key_count != 1 || opAggregate->aggregate_count != 1) return false;
+	if(!_CountsRecords(opAggregate->aggregate_exps[0])) return false;
+
+	AR_ExpNode *key = opAggregate->key_exps[0];
+	if(!AR_EXP_IsVariadic(key)) return false;
+	const char *alias = key->operand.variadic.entity_alias;
+
+	OpBase *op = opAggregate->op.children[0];
+	if(op->type != OPType_CONDITIONAL_TRAVERSE || op->childCount != 1) return false;
+	OpCondTraverse *condTraverse = (OpCondTraverse *)op;
+
+	// traversal from the grouped node over a single unfiltered relation matrix
+	AlgebraicExpression *ae = condTraverse->ae;
+	if(AlgebraicExpression_OperandCount(ae) != 1) return false;
+	if(strcmp(AlgebraicExpression_Source(ae), alias) != 0) return false;
+	const char *edge = AlgebraicExpression_Edge(ae);
+	if(edge == NULL) return false;
+
+	QGEdge *e = QueryGraph_GetEdgeByAlias(op->plan->query_graph, edge);
+	if(e == NULL || e->bidirectional || array_len(e->reltypeIDs) != 1) return false;
+	int relation = e->reltypeIDs[0];
+	if(relation < 0) return false;
+
+	GRAPH_EDGE_DIR dir;
+	if(strcmp(e->src->alias, alias) == 0) dir = GRAPH_EDGE_DIR_OUTGOING;
+	else if(strcmp(e->dest->alias, alias) == 0) dir = GRAPH_EDGE_DIR_INCOMING;
+	else return false;
+
+	// without an edge context the traversal reports each connected pair once
+	// matching the node's degree only if no pair is connected by multiple edges
+	Graph *g = QueryCtx_GetGraph();
+	if(condTraverse->edge_ctx == NULL &&
+	   Graph_RelationEdgeTotal(g, relation) != Graph_RelationEdgeCount(g, relation)) {
+		return false;
+	}
 
-	ExecutionPlan_RemoveOp(plan, (OpBase *)opAggregate);
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	const char *name = GraphContext_GetSchemaByID(gc, relation, SCHEMA_EDGE)->name;
+
+	// nodes without edges don't form a group
+	FT_FilterNode *filter = FilterTree_CreatePredicateFilter(OP_GT,
+			_DegreeExp(alias, name, dir), AR_EXP_NewConstOperandNode(SI_LongVal(0)));
+	OpBase *opFilter = NewFilterOp(op->plan, filter);
+
+	AR_ExpNode **exps = array_new(AR_ExpNode *, 2);
+	AR_ExpNode *node = AR_EXP_NewVariableOperandNode(alias);
+	node->resolved_name = key->resolved_name;
+	exps = array_append(exps, node);
+	AR_ExpNode *degree = _DegreeExp(alias, name, dir);
+	degree->resolved_name = opAggregate->aggregate_exps[0]->resolved_name;
+	exps = array_append(exps, degree);
+	OpBase *opProject = NewProjectOp(opAggregate->op.plan, exps);
+
+	// New execution plan: "Scan -> Filter -> Project"
+	ExecutionPlan_PushBelow(op->children[0], opFilter);
+	ExecutionPlan_RemoveOp(plan, op);
+	OpBase_Free(op);
+	ExecutionPlan_ReplaceOp(plan, (OpBase *)opAggregate, opProject);
 	OpBase_Free((OpBase *)opAggregate);
+	return true;
+}
 
-	ExecutionPlan_AddOp((OpBase *)opResult, opProject);
+static bool _reduceDegreeCount(ExecutionPlan *plan) {
+	bool reduced = false;
+	OpBase **aggregates = ExecutionPlan_CollectOps(plan->root, OPType_AGGREGATE);
+	uint count = array_len(aggregates);
+	for(uint i = 0; i < count; i++) {
+		reduced |= _reduceDegreeAggregation(plan, (OpAggregate *)aggregates[i]);
+	}
+	array_free(aggregates);
+	return reduced;
 }
 
 void reduceCount(ExecutionPlan *plan) {
-	/* both _reduceNodeCount and _reduceEdgeCount should count nodes or edges, respectively,
-	 * out of the same execution plan.
-	 * If node count optimization was unable to execute,
-	 * meaning that the execution plan does not hold any node count pattern,
-	 * then edge count will be tried to be executed upon the same execution plan */
-	if(!_reduceNodeCount(plan)) _reduceEdgeCount(plan);
+	/* Each rule reduces a distinct aggregation pattern
+	 * out of the same execution plan, rules are tried in order
+	 * until one of them modifies the plan. */
+	static bool (*rules[])(ExecutionPlan *) = {
+		_reduceNodeCount,
+		_reduceEdgeCount,
+		_reduceLabelGroupCount,
+		_reduceTypeGroupCount,
+		_reduceIndexedExtreme,
+		_reduceDegreeCount,
+	};
+
+	uint rule_count = sizeof(rules) / sizeof(rules[0]);
+	for(uint i = 0; i < rule_count; i++) {
+		if(rules[i](plan)) return;
+	}
 }
-
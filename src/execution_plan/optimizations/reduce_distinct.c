@@ -7,12 +7,62 @@
 #include "RG.h"
 #include "../execution_plan.h"
 #include "../execution_plan_build/execution_plan_modify.h"
+#include "../ops/op_sort.h"
+#include "../ops/op_project.h"
+#include "../ops/op_distinct.h"
 
 /* A distinct operation following an aggregation operation
  * is unnecessary, as aggregation groups are guaranteed to be unique.
  * this optimization will try to look for an aggregation operation
  * followed by a distinct operation, in which case we can omit distinct
- * from the execution plan. */
+ * from the execution plan.
+ *
+ * A distinct operation projecting the leading keys of an earlier sort
+ * receives its duplicates adjacently, in which case it only compares
+ * each record with its predecessor rather than tracking every record seen. */
+
+// returns true if 'project' only forwards the first keys of 'sort'
+static bool _projectsSortKeys(const OpProject *project, const OpSort *sort) {
+	uint exp_count = array_len(project->exps);
+	if(exp_count == 0 || exp_count > array_len(sort->exps)) return false;
+
+	for(uint i = 0; i < exp_count; i++) {
+		const AR_ExpNode *exp = project->exps[i];
+		if(!AR_EXP_IsVariadic(exp)) return false;
+
+		// projected alias must be one of the leading sort keys
+		const char *alias = exp->operand.variadic.entity_alias;
+		bool found = false;
+		for(uint j = 0; j < exp_count && !found; j++) {
+			found = (strcmp(alias, sort->exps[j]->resolved_name) == 0);
+		}
+		if(!found) return false;
+
+		// each sort key is projected once
+		for(uint j = 0; j < i; j++) {
+			if(strcmp(alias, project->exps[j]->operand.variadic.entity_alias) == 0) return false;
+		}
+	}
+
+	return true;
+}
+
+// returns true if records reach 'distinct' ordered by all of its keys
+static bool _sortedInput(const OpBase *distinct) {
+	const OpBase *op = distinct->children[0];
+	if(op->type != OPType_PROJECT || op->childCount != 1) return false;
+	const OpProject *project = (const OpProject *)op;
+
+	// filters, skip and limit maintain the order of their input
+	op = op->children[0];
+	while(op->type == OPType_FILTER || op->type == OPType_SKIP ||
+		  op->type == OPType_LIMIT) {
+		op = op->children[0];
+	}
+	if(op->type != OPType_SORT) return false;
+
+	return _projectsSortKeys(project, (const OpSort *)op);
+}
 
 void reduceDistinct(ExecutionPlan *plan) {
 	// Look for Distinct operations.
@@ -26,6 +76,8 @@ void reduceDistinct(ExecutionPlan *plan) {
 			// as its results will inherently be unique.
 			ExecutionPlan_RemoveOp(plan, distinct);
 			OpBase_Free(distinct);
+		} else if(_sortedInput(distinct)) {
+			DistinctOp_SetSortedInput((OpDistinct *)distinct);
 		}
 	}
 
@@ -8,6 +8,7 @@
 #include "../ops/op_filter.h"
 #include "../ops/op_node_by_label_scan.h"
 #include "../ops/op_conditional_traverse.h"
+#include "../ops/op_edge_by_type_scan.h"
 #include "../../util/arr.h"
 #include "../../query_ctx.h"
 #include "../execution_plan_build/execution_plan_modify.h"
@@ -65,3 +66,52 @@ void reduceScans(ExecutionPlan *plan) {
 	array_free(scans);
 }
 
+
+// replace a scan of every node followed by a traversal of a single relationship
+// type with an EdgeByTypeScan, visiting connected pairs only
+// e.g. MATCH (a)-[e:R]->(b) RETURN e
+static void _reduceEdgeScan(ExecutionPlan *plan, OpCondTraverse *traverse) {
+	// edges must be reported, as EdgeByTypeScan binds each of them
+	if(traverse->edge_ctx == NULL) return;
+	if(traverse->op.childCount != 1) return;
+
+	// traversal must be seeded by a tap scan of every node
+	OpBase *scan = traverse->op.children[0];
+	if(scan->type != OPType_ALL_NODE_SCAN || scan->childCount != 0) return;
+
+	// single typed, directed, single hop edge
+	AlgebraicExpression *ae = traverse->ae;
+	const char *edge = AlgebraicExpression_Edge(ae);
+	QGEdge *e = QueryGraph_GetEdgeByAlias(plan->query_graph, edge);
+	if(e == NULL || e->bidirectional || QGEdge_VariableLength(e)) return;
+	if(array_len(e->reltypeIDs) != 1 || e->reltypeIDs[0] < 0) return;
+	if(e->src == e->dest) return;
+
+	// the traversal must resolve exactly the edge endpoints
+	const char *src = AlgebraicExpression_Source(ae);
+	const char *dest = AlgebraicExpression_Destination(ae);
+	bool forward = (strcmp(src, e->src->alias) == 0 &&
+			strcmp(dest, e->dest->alias) == 0);
+	bool backward = (strcmp(src, e->dest->alias) == 0 &&
+			strcmp(dest, e->src->alias) == 0);
+	if(!forward && !backward) return;
+
+	// the edge scan takes ownership of the traversal's expression
+	traverse->ae = NULL;
+	OpBase *edge_scan = NewEdgeByTypeScanOp(plan, traverse->graph, ae);
+
+	ExecutionPlan_RemoveOp(plan, scan);
+	OpBase_Free(scan);
+	ExecutionPlan_ReplaceOp(plan, (OpBase *)traverse, edge_scan);
+	OpBase_Free((OpBase *)traverse);
+}
+
+void reduceEdgeScans(ExecutionPlan *plan) {
+	OpBase **traversals = ExecutionPlan_CollectOps(plan->root,
+			OPType_CONDITIONAL_TRAVERSE);
+	uint traversal_count = array_len(traversals);
+	for(uint i = 0; i < traversal_count; i++) {
+		_reduceEdgeScan(plan, (OpCondTraverse *)traversals[i]);
+	}
+	array_free(traversals);
+}
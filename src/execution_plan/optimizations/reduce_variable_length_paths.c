@@ -0,0 +1,83 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../ops/op_cond_var_len_traverse.h"
+#include "../execution_plan_build/execution_plan_modify.h"
+
+/* A variable length traversal produces a record for every path leading from
+ * its source node to a destination node, as such a destination node reachable
+ * via multiple paths is produced multiple times.
+ * When neither the path nor the number of records produced per destination
+ * are observed, e.g. MATCH (a)-[*1..5]->(b) RETURN DISTINCT b,
+ * the traversal is reduced to computing the set of reachable nodes.
+ * Paths are relationship unique, a node reachable by a walk of k hops
+ * is also reachable by a path of at most k hops; this doesn't hold for
+ * a lower bound on the number of hops, as such the reduction only applies
+ * to traversals with a minimum of at most one hop. */
+
+// Returns true if the records produced by op are consumed with set semantics,
+// such that the number of duplicate records is irrelevant.
+static bool _MultiplicityIrrelevant(const OpBase *op) {
+	const OpBase *child = op;
+	const OpBase *parent = op->parent;
+
+	while(parent) {
+		switch(parent->type) {
+			case OPType_DISTINCT:
+				return true;
+			case OPType_SEMI_APPLY:
+			case OPType_ANTI_SEMI_APPLY:
+			case OPType_OR_APPLY_MULTIPLEXER:
+			case OPType_AND_APPLY_MULTIPLEXER:
+				// non bound branches are only checked for the existence of a record
+				return (parent->children[0] != child);
+			case OPType_FILTER:
+			case OPType_PROJECT:
+			case OPType_SORT:
+			case OPType_CONDITIONAL_TRAVERSE:
+			case OPType_EXPAND_INTO:
+			case OPType_EXPAND_INTERSECT:
+			case OPType_CONDITIONAL_VAR_LEN_TRAVERSE:
+			case OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO:
+			case OPType_CARTESIAN_PRODUCT:
+				// the set of distinct records produced is unaffected by duplicates
+				break;
+			default:
+				return false;
+		}
+		child = parent;
+		parent = parent->parent;
+	}
+
+	return false;
+}
+
+void reduceVariableLengthPaths(ExecutionPlan *plan) {
+	const OPType types[] = {OPType_CONDITIONAL_VAR_LEN_TRAVERSE,
+							OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO
+						   };
+	OpBase **ops = ExecutionPlan_CollectOpsMatchingType(plan->root, types, 2);
+
+	for(uint i = 0; i < array_len(ops); i++) {
+		CondVarLenTraverse *op = (CondVarLenTraverse *)ops[i];
+
+		// the traversed path is referenced
+		if(op->edgesIdx >= 0) continue;
+		// edges are filtered individually
+		if(op->ft != NULL) continue;
+
+		QGEdge *e = QueryGraph_GetEdgeByAlias(op->op.plan->query_graph,
+											  AlgebraicExpression_Edge(op->ae));
+		if(e->minHops > 1) continue;
+
+		if(!_MultiplicityIrrelevant((OpBase *)op)) continue;
+
+		CondVarLenTraverseOp_ReachOnly(op);
+	}
+
+	array_free(ops);
+}
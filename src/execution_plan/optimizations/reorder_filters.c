@@ -0,0 +1,32 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "../ops/op_filter.h"
+#include "../../filter_tree/filter_tree.h"
+
+/* The reorder filters optimizer scans an execution plan for filter operations
+ * and reorders the operands of their AND/OR chains, such that cheap and
+ * decisive operands are evaluated first, e.g.
+ * WHERE contains(n.bio, 'x') AND n.age > 30
+ * evaluates n.age > 30 first, sparing the contains call for every record
+ * it rejects. */
+
+static void _reorderFilters(OpBase *op) {
+	if(op == NULL) return;
+
+	if(op->type == OPType_FILTER) {
+		OpFilter *filter = (OpFilter *)op;
+		FilterTree_Reorder(filter->filterTree);
+	}
+
+	for(int i = 0; i < op->childCount; i++) {
+		_reorderFilters(op->children[i]);
+	}
+}
+
+void reorderFilters(ExecutionPlan *plan) {
+	_reorderFilters(plan->root);
+}
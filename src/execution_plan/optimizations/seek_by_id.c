@@ -5,11 +5,16 @@
  */
 
 #include "../../util/arr.h"
+#include "../../util/qsort.h"
+#include "../../datatypes/array.h"
+#include "../../filter_tree/filter_tree_utils.h"
 #include "../ops/op_filter.h"
 #include "../ops/op_index_scan.h"
 #include "../ops/op_all_node_scan.h"
 #include "../ops/op_node_by_id_seek.h"
 #include "../ops/op_node_by_label_scan.h"
+#include "../ops/op_edge_by_id_seek.h"
+#include "../ops/op_conditional_traverse.h"
 #include "../../util/range/numeric_range.h"
 #include "../../arithmetic/arithmetic_op.h"
 #include "../execution_plan_build/execution_plan_modify.h"
@@ -17,7 +22,12 @@
 /* The seek by ID optimization searches for a SCAN operation on which
  * a filter of the form ID(n) = X is applied in which case
  * both the SCAN and FILTER operations can be reduced into a single
- * NODE_BY_ID_SEEK operation. */
+ * NODE_BY_ID_SEEK operation.
+ * A filter of the form ID(n) IN [X, Y, ...] reduces an all node scan
+ * into a NODE_BY_ID_SEEK retrieving the listed IDs only.
+ * Likewise a filter of the form ID(e) = X or ID(e) IN [X, Y, ...]
+ * applied to a single hop traversal seeded by an all node scan reduces
+ * both into an EDGE_BY_ID_SEEK, resolving each edge by its record. */
 
 static bool _idFilter(FT_FilterNode *f, AST_Operator *rel, EntityID *id, bool *reverse) {
 	if(f->t != FT_N_PRED) return false;
@@ -57,13 +67,97 @@ static bool _idFilter(FT_FilterNode *f, AST_Operator *rel, EntityID *id, bool *r
 	return true;
 }
 
+/* Checks if 'f' is of the form ID(alias) IN list, where list reduces to
+ * a constant, e.g. a literal or a parameter.
+ * On success 'ids' is set to the sorted distinct listed IDs,
+ * NULL and negative elements are ignored as they can never match. */
+static bool _idListFilter(FT_FilterNode *f, const char *alias, NodeID **ids) {
+	if(!isInFilter(f)) return false;
+
+	AR_OpNode *in = &f->exp.exp->op;
+	AR_ExpNode *lhs = in->children[0];
+	AR_ExpNode *rhs = in->children[1];
+
+	// Make sure applied function is ID over the scanned entity.
+	if(lhs->type != AR_EXP_OP) return false;
+	if(strcasecmp(lhs->op.func_name, "id")) return false;
+	AR_ExpNode *entity = lhs->op.children[0];
+	if(entity->type != AR_EXP_OPERAND) return false;
+	if(entity->operand.type != AR_EXP_VARIADIC) return false;
+	if(strcmp(entity->operand.variadic.entity_alias, alias)) return false;
+
+	// Make sure ID is looked up in a constant list of integers.
+	SIValue list;
+	if(!AR_EXP_ReduceToScalar(rhs, true, &list)) return false;
+	if(SI_TYPE(list) != T_ARRAY) return false;
+
+	uint len = SIArray_Length(list);
+	for(uint i = 0; i < len; i++) {
+		SIValue v = SIArray_Get(list, i);
+		if(SI_TYPE(v) == T_NULL) continue;
+		if(SI_TYPE(v) != T_INT64) return false;
+	}
+
+	NodeID *arr = array_new(NodeID, len);
+	for(uint i = 0; i < len; i++) {
+		SIValue v = SIArray_Get(list, i);
+		if(SI_TYPE(v) != T_INT64 || v.longval < 0) continue;
+		array_append(arr, v.longval);
+	}
+
+	// Sort and remove duplicates.
+	uint count = array_len(arr);
+	if(count > 1) {
+#define ID_ISLT(a, b) (*(a) < *(b))
+		QSORT(NodeID, arr, count, ID_ISLT);
+#undef ID_ISLT
+		uint j = 0;
+		for(uint i = 1; i < count; i++) {
+			if(arr[i] != arr[j]) arr[++j] = arr[i];
+		}
+		arr = array_trimm_len(arr, j + 1);
+	}
+
+	*ids = arr;
+	return true;
+}
+
+// Retains in 'ids' the IDs which are also in 'other', both arrays are sorted.
+static void _intersectIds(NodeID **ids, NodeID *other) {
+	NodeID *arr = *ids;
+	uint j = 0;
+	uint k = 0;
+	uint count = array_len(arr);
+	uint other_count = array_len(other);
+	for(uint i = 0; i < count && k < other_count; i++) {
+		while(k < other_count && other[k] < arr[i]) k++;
+		if(k < other_count && other[k] == arr[i]) arr[j++] = arr[i];
+	}
+	*ids = array_trimm_len(arr, j);
+}
+
+// Retains in 'ids' the IDs which are within 'range'.
+static void _filterIdsByRange(NodeID **ids, const UnsignedRange *range) {
+	NodeID *arr = *ids;
+	uint j = 0;
+	uint count = array_len(arr);
+	for(uint i = 0; i < count; i++) {
+		if(UnsignedRange_ContainsValue(range, arr[i])) arr[j++] = arr[i];
+	}
+	*ids = array_trimm_len(arr, j);
+}
+
 static void _UseIdOptimization(ExecutionPlan *plan, OpBase *scan_op) {
 	/* See if there's a filter of the form
 	 * ID(n) op X
 	 * where X is a constant and op in [EQ, GE, LE, GT, LT] */
 	OpBase *parent = scan_op->parent;
 	OpBase *grandparent;
+	NodeID *ids = NULL;
 	UnsignedRange *id_range = NULL;
+	bool label_scan = (scan_op->type == OPType_NODE_BY_LABEL_SCAN);
+	const char *alias = label_scan ? ((NodeByLabelScan *)scan_op)->n.alias :
+						((AllNodeScan *)scan_op)->alias;
 	while(parent && parent->type == OPType_FILTER) {
 		grandparent = parent->parent; // Track the next op to visit in case we free parent.
 		OpFilter *filter = (OpFilter *)parent;
@@ -72,7 +166,22 @@ static void _UseIdOptimization(ExecutionPlan *plan, OpBase *scan_op) {
 		AST_Operator op;
 		EntityID id;
 		bool reverse;
-		if(_idFilter(f, &op, &id, &reverse)) {
+		NodeID *listed;
+		if(_idListFilter(f, alias, &listed)) {
+			if(ids) {
+				_intersectIds(&ids, listed);
+				array_free(listed);
+			} else {
+				ids = listed;
+			}
+
+			/* A label scan is only bounded by the listed IDs,
+			 * the filter is kept to discard the IDs in between. */
+			if(!label_scan) {
+				ExecutionPlan_RemoveOp(plan, (OpBase *)filter);
+				OpBase_Free((OpBase *)filter);
+			}
+		} else if(_idFilter(f, &op, &id, &reverse)) {
 			if(!id_range) id_range = UnsignedRange_New();
 			if(reverse) op = ArithmeticOp_ReverseOp(op);
 			UnsignedRange_TightenRange(id_range, op, id);
@@ -84,6 +193,29 @@ static void _UseIdOptimization(ExecutionPlan *plan, OpBase *scan_op) {
 		// Advance.
 		parent = grandparent;
 	}
+	if(ids) {
+		if(id_range) _filterIdsByRange(&ids, id_range);
+
+		if(label_scan) {
+			// Bound the label scan by the smallest and largest listed IDs.
+			uint count = array_len(ids);
+			if(count > 0) {
+				if(!id_range) id_range = UnsignedRange_New();
+				UnsignedRange_TightenRange(id_range, OP_GE, ids[0]);
+				UnsignedRange_TightenRange(id_range, OP_LE, ids[count - 1]);
+			}
+			array_free(ids);
+		} else {
+			OpBase *opNodeByIdSeek = NewNodeByIdListSeekOp(scan_op->plan, alias, ids);
+
+			// Managed to reduce!
+			ExecutionPlan_ReplaceOp(plan, scan_op, opNodeByIdSeek);
+			OpBase_Free(scan_op);
+			if(id_range) UnsignedRange_Free(id_range);
+			return;
+		}
+	}
+
 	if(id_range) {
 		/* Don't replace label scan, but set it to have range query.
 		 * Issue 818 https://github.com/RedisGraph/RedisGraph/issues/818
@@ -93,7 +225,6 @@ static void _UseIdOptimization(ExecutionPlan *plan, OpBase *scan_op) {
 			NodeByLabelScan *label_scan = (NodeByLabelScan *) scan_op;
 			NodeByLabelScanOp_SetIDRange(label_scan, id_range);
 		} else {
-			const char *alias = ((AllNodeScan *)scan_op)->alias;
 			OpBase *opNodeByIdSeek = NewNodeByIdSeekOp(scan_op->plan, alias, id_range);
 
 			// Managed to reduce!
@@ -104,6 +235,97 @@ static void _UseIdOptimization(ExecutionPlan *plan, OpBase *scan_op) {
 	}
 }
 
+// returns true if 'exp' is of the form ID(alias)
+static bool _idOf(const AR_ExpNode *exp, const char *alias) {
+	if(exp->type != AR_EXP_OP) return false;
+	if(strcasecmp(exp->op.func_name, "id")) return false;
+	const AR_ExpNode *entity = exp->op.children[0];
+	return entity->type == AR_EXP_OPERAND &&
+		   entity->operand.type == AR_EXP_VARIADIC &&
+		   strcmp(entity->operand.variadic.entity_alias, alias) == 0;
+}
+
+/* Checks if 'f' is of the form ID(alias) = X or ID(alias) IN list,
+ * where X and list reduce to constants.
+ * On success 'ids' is set to the sorted distinct IDs 'f' accepts. */
+static bool _idEqualityFilter(FT_FilterNode *f, const char *alias, EntityID **ids) {
+	if(_idListFilter(f, alias, ids)) return true;
+	if(f->t != FT_N_PRED || f->pred.op != OP_EQUAL) return false;
+
+	AR_ExpNode *expr;
+	if(_idOf(f->pred.lhs, alias)) expr = f->pred.rhs;
+	else if(_idOf(f->pred.rhs, alias)) expr = f->pred.lhs;
+	else return false;
+
+	// Make sure ID is compared to a constant int64.
+	SIValue val;
+	if(!AR_EXP_ReduceToScalar(expr, true, &val)) return false;
+	if(SI_TYPE(val) != T_INT64) return false;
+
+	EntityID *arr = array_new(EntityID, 1);
+	if(val.longval >= 0) array_append(arr, val.longval);
+	*ids = arr;
+	return true;
+}
+
+static void _UseEdgeIdOptimization(ExecutionPlan *plan, OpCondTraverse *traverse) {
+	// the traversal must bind its edge, seeded by a tap scan of every node
+	if(traverse->edge_ctx == NULL) return;
+	if(traverse->op.childCount != 1) return;
+	OpBase *scan = traverse->op.children[0];
+	if(scan->type != OPType_ALL_NODE_SCAN || scan->childCount != 0) return;
+
+	// single directed, single hop edge
+	AlgebraicExpression *ae = traverse->ae;
+	const char *edge = AlgebraicExpression_Edge(ae);
+	if(edge == NULL) return;
+	QGEdge *e = QueryGraph_GetEdgeByAlias(traverse->op.plan->query_graph, edge);
+	if(e == NULL || e->bidirectional || QGEdge_VariableLength(e)) return;
+	if(e->src == e->dest) return;
+
+	// the traversal must resolve exactly the edge endpoints
+	const char *src = AlgebraicExpression_Source(ae);
+	const char *dest = AlgebraicExpression_Destination(ae);
+	bool forward = (strcmp(src, e->src->alias) == 0 &&
+			strcmp(dest, e->dest->alias) == 0);
+	bool backward = (strcmp(src, e->dest->alias) == 0 &&
+			strcmp(dest, e->src->alias) == 0);
+	if(!forward && !backward) return;
+
+	// see if the edge is filtered by ID(e) = X or ID(e) IN [X, Y, ...]
+	EdgeID *ids = NULL;
+	OpBase *parent = traverse->op.parent;
+	while(parent && parent->type == OPType_FILTER) {
+		OpBase *grandparent = parent->parent;
+		OpFilter *filter = (OpFilter *)parent;
+
+		EdgeID *listed;
+		if(_idEqualityFilter(filter->filterTree, edge, &listed)) {
+			if(ids) {
+				_intersectIds(&ids, listed);
+				array_free(listed);
+			} else {
+				ids = listed;
+			}
+
+			// the seek fetches accepted IDs only
+			ExecutionPlan_RemoveOp(plan, parent);
+			OpBase_Free(parent);
+		}
+		parent = grandparent;
+	}
+	if(ids == NULL) return;
+
+	// the seek takes ownership of the traversal's expression
+	traverse->ae = NULL;
+	OpBase *seek = NewEdgeByIdSeekOp(traverse->op.plan, traverse->graph, ae, ids);
+
+	ExecutionPlan_RemoveOp(plan, scan);
+	OpBase_Free(scan);
+	ExecutionPlan_ReplaceOp(plan, (OpBase *)traverse, seek);
+	OpBase_Free((OpBase *)traverse);
+}
+
 void seekByID(ExecutionPlan *plan) {
 	ASSERT(plan != NULL);
 
@@ -115,5 +337,13 @@ void seekByID(ExecutionPlan *plan) {
 	}
 
 	array_free(scan_ops);
+
+	OpBase **traversals = ExecutionPlan_CollectOps(plan->root,
+			OPType_CONDITIONAL_TRAVERSE);
+	for(int i = 0; i < array_len(traversals); i++) {
+		_UseEdgeIdOptimization(plan, (OpCondTraverse *)traversals[i]);
+	}
+
+	array_free(traversals);
 }
 
@@ -0,0 +1,160 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "../../util/arr.h"
+#include "../../query_ctx.h"
+#include "../ops/op_aggregate.h"
+#include "../ops/op_index_scan.h"
+#include "../ops/op_all_node_scan.h"
+#include "../ops/op_node_by_id_seek.h"
+#include "../ops/op_node_by_label_scan.h"
+#include "../execution_plan_build/execution_plan_modify.h"
+
+/* An aggregation whose input reaches it grouped by its keys
+ * doesn't need to hash every group until its input is depleted,
+ * it emits each group as soon as the key changes.
+ *
+ * A tap scan reports each node once, operations which expand each of their
+ * input records into consecutive output records, such as traversals,
+ * maintain that grouping. As such, records are grouped by the scanned node
+ * as well as by any value of the node, e.g. MATCH (n)-[]->(m) RETURN n, count(m)
+ *
+ * Range index scans report nodes in the order of the indexed attribute,
+ * records are then grouped by that attribute as well. */
+
+// returns the alias of the node scanned by 'op', NULL if op isn't a tap scan
+static const char *_scannedAlias(const OpBase *op) {
+	if(op->childCount != 0) return NULL;
+
+	switch(op->type) {
+	case OPType_ALL_NODE_SCAN:
+		return ((const AllNodeScan *)op)->alias;
+	case OPType_NODE_BY_LABEL_SCAN:
+	case OPType_NODE_BY_LABEL_AND_ID_SCAN:
+		return ((const NodeByLabelScan *)op)->n.alias;
+	case OPType_NODE_BY_ID_SEEK:
+		return ((const NodeByIdSeek *)op)->alias;
+	case OPType_INDEX_SCAN:
+		return ((const IndexScan *)op)->n.alias;
+	default:
+		return NULL;
+	}
+}
+
+// returns the scan feeding 'aggregate' through operations
+// which keep the records of each scanned node consecutive
+static OpBase *_groupingScan(const OpAggregate *aggregate) {
+	OpBase *op = aggregate->op.children[0];
+	while(op->childCount == 1 &&
+		  (op->type == OPType_FILTER ||
+		   op->type == OPType_CONDITIONAL_TRAVERSE ||
+		   op->type == OPType_EXPAND_INTO)) {
+		op = op->children[0];
+	}
+	return (_scannedAlias(op) != NULL) ? op : NULL;
+}
+
+// returns true if 'exp' is either 'alias' or id(alias)
+static bool _identifiesEntity(const AR_ExpNode *exp, const char *alias) {
+	if(exp->type == AR_EXP_OP) {
+		if(strcasecmp(exp->op.func_name, "id") != 0) return false;
+		if(exp->op.child_count != 1) return false;
+		exp = exp->op.children[0];
+	}
+	return (AR_EXP_IsVariadic(exp) &&
+			strcmp(exp->operand.variadic.entity_alias, alias) == 0);
+}
+
+// returns true if 'exp' only depends on entity 'alias'
+static bool _dependsOn(AR_ExpNode *exp, const char *alias) {
+	rax *entities = raxNew();
+	AR_EXP_CollectEntities(exp, entities);
+	bool match = (raxSize(entities) == 1 && raxFind(entities,
+				(unsigned char *)alias, strlen(alias)) != raxNotFound);
+	raxFree(entities);
+	return match;
+}
+
+// returns true if aggregate's keys are all determined by the scanned node
+static bool _groupedByNode(const OpAggregate *aggregate, const char *alias) {
+	bool identified = false;
+	for(uint i = 0; i < aggregate->key_count; i++) {
+		AR_ExpNode *exp = aggregate->key_exps[i];
+		if(_identifiesEntity(exp, alias)) identified = true;
+		else if(!_dependsOn(exp, alias)) return false;
+	}
+	return identified;
+}
+
+// returns true if aggregate's only key is the attribute indexed by 'scan'
+// range index scans are set to report nodes in that attribute's order
+static bool _groupedByIndexOrder(const OpAggregate *aggregate,
+		IndexScan *scan) {
+	if(aggregate->key_count != 1) return false;
+
+	char *attr = NULL;
+	AR_ExpNode *exp = aggregate->key_exps[0];
+	if(!AR_EXP_IsAttribute(exp, &attr)) return false;
+	if(!_dependsOn(exp, scan->n.alias)) return false;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Attribute_ID attr_id = GraphContext_GetAttributeID(gc, attr);
+	if(attr_id == ATTRIBUTE_NOTFOUND) return false;
+
+	int key = IndexScan_OrderedCompositeKey(scan);
+	if(key != -1) return scan->composite->attributes[key] == attr_id;
+
+	// runtime bounds might fall back to RediSearch, which is unordered
+	if(scan->range == NULL || scan->lookup_exp != NULL || scan->runtime_bounds) {
+		return false;
+	}
+	Index *idx = GraphContext_GetIndex(gc, scan->n.label, NULL, IDX_EXACT_MATCH);
+	if(idx == NULL || Index_GetRangeIndex(idx, attr_id) != scan->range) {
+		return false;
+	}
+
+	// an already ordered scan groups equal keys in either direction
+	if(!scan->ordered) IndexScan_SetOrder(scan, false);
+	return true;
+}
+
+// returns true if an operation above 'op' modifies the graph
+// such operations expect to run once their input is depleted
+static bool _followedByWriter(const OpBase *op) {
+	for(op = op->parent; op != NULL; op = op->parent) {
+		for(uint i = 0; i < EAGER_OP_COUNT; i++) {
+			if(op->type != OPType_AGGREGATE && op->type == EAGER_OPERATIONS[i]) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void streamAggregates(ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+
+	OpBase **aggregates = ExecutionPlan_CollectOps(plan->root, OPType_AGGREGATE);
+	uint count = array_len(aggregates);
+
+	for(uint i = 0; i < count; i++) {
+		OpAggregate *aggregate = (OpAggregate *)aggregates[i];
+		if(aggregate->key_count == 0 || aggregate->op.childCount != 1) continue;
+		if(_followedByWriter((OpBase *)aggregate)) continue;
+
+		OpBase *scan = _groupingScan(aggregate);
+		if(scan == NULL) continue;
+
+		bool grouped = _groupedByNode(aggregate, _scannedAlias(scan));
+		if(!grouped && scan->type == OPType_INDEX_SCAN) {
+			grouped = _groupedByIndexOrder(aggregate, (IndexScan *)scan);
+		}
+		if(grouped) AggregateOp_SetSortedInput(aggregate);
+	}
+
+	array_free(aggregates);
+}
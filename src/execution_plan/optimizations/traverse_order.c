@@ -5,244 +5,371 @@
 */
 
 #include "../../config.h"
+#include "../../query_ctx.h"
 #include "../../util/arr.h"
 #include "../../util/strcmp.h"
 #include "../../util/rmalloc.h"
 #include "../../filter_tree/filter_tree.h"
 #include "../../arithmetic/algebraic_expression.h"
-
-#define T 1           // Transpose penalty.
-#define L 2 * T       // Label score.
-#define F 4 * T       // Filter score.
-#define B 8 * F       // Bound variable bonus.
-
-typedef AlgebraicExpression **Arrangement;
-
-// create arrangement
-static inline Arrangement _Arrangement_New(uint size) {
-	return rm_malloc(sizeof(AlgebraicExpression *) * size);
+#include "../plan_estimate.h"
+#include <float.h>
+
+// Orders traversal expressions by estimated cost.
+// The cost of an arrangement is the number of records produced by each of
+// its steps, estimated from label and relationship-type entity counts,
+// with a small penalty for each matrix transpose it requires.
+//
+// Arrangements of up to MAX_DP_EXPRESSIONS expressions are searched
+// exhaustively via dynamic programming over subsets of expressions,
+// larger sets are ordered greedily, extending each candidate opening
+// expression with the cheapest connected expression at every step.
+
+#define MAX_DP_EXPRESSIONS 12    // Larger sets are ordered greedily.
+#define TRANSPOSE_PENALTY 1.0    // Cost of transposing a single operand.
+
+typedef struct {
+	const char *alias;  // Node alias.
+	double scan;        // Number of entities scanned when starting at node.
+	double input;       // Number of scanned entities passing node's filters.
+	double sel;         // Fraction of entities passing node's filters.
+	double domain;      // Number of nodes node may resolve to.
+} _PlanNode;
+
+typedef struct {
+	AlgebraicExpression *exp;  // Expression.
+	uint src;                  // Index of source node.
+	uint dest;                 // Index of destination node.
+	double density;            // Fraction of node pairs connected by expression.
+	uint transposes;           // Number of transposes within expression.
+	uint operands;             // Number of operands within expression.
+	bool entry;                // Expression may open the arrangement.
+} _PlanExp;
+
+typedef struct {
+	PlanEstimateCtx est;   // Graph statistics.
+	bool transpose_free;   // Transposed matrices are maintained.
+	_PlanNode *nodes;      // Nodes referenced by expressions.
+	uint node_count_plan;  // Number of nodes referenced by expressions.
+	_PlanExp *exps;        // Expressions to order.
+	uint exp_count;        // Number of expressions to order.
+} _Planner;
+
+static inline double _Max(double a, double b) {
+	return (a > b) ? a : b;
 }
 
-// clone arrangement
-static inline Arrangement _Arrangement_Clone(const Arrangement arrangement, uint size) {
-	ASSERT(arrangement != NULL);
-	Arrangement clone = _Arrangement_New(size);
-	memcpy(clone, arrangement, sizeof(AlgebraicExpression *) * size);
-	return clone;
+static inline double _Min(double a, double b) {
+	return (a < b) ? a : b;
 }
 
-// print arrangement
-static inline void _Arrangement_Print(Arrangement arrangement, uint size) {
-	printf("Arrangement_Print\n");
-	for(uint i = 0; i < size; i++) {
-		AlgebraicExpression *exp = arrangement[i];
-		printf("%d, src: %s, dest: %s\n", i, AlgebraicExpression_Source(exp),
-			   AlgebraicExpression_Destination(exp));
+//------------------------------------------------------------------------------
+// planner
+//------------------------------------------------------------------------------
+
+// returns the index of the node aliased alias, introducing it if missing
+static uint _Planner_NodeIdx(_Planner *p, const char *alias,
+							 rax *filtered_entities, rax *bound_vars) {
+	for(uint i = 0; i < p->node_count_plan; i++) {
+		if(!RG_STRCMP(p->nodes[i].alias, alias)) return i;
 	}
-}
 
-// free arrangement
-static inline void _Arrangement_Free(Arrangement arrangement) {
-	ASSERT(arrangement != NULL);
-	rm_free(arrangement);
-}
+	_PlanNode *node = p->nodes + p->node_count_plan;
+	size_t len = strlen(alias);
+	node->alias = alias;
+
+	if(bound_vars &&
+	   raxFind(bound_vars, (unsigned char *)alias, len) != raxNotFound) {
+		// bound nodes are resolved by previous operations
+		node->scan   = 1;
+		node->input  = 1;
+		node->sel    = 1;
+		node->domain = 1;
+	} else {
+		QGNode *n = QueryGraph_GetNodeByAlias(p->est.qg, alias);
+		bool filtered = raxFind(filtered_entities, (unsigned char *)alias,
+								len) != raxNotFound;
+		double sel = PlanEstimate_FilterSelectivity(&p->est, alias, filtered);
+		// labels are accounted for by the expressions' diagonal operands
+		node->scan   = PlanEstimate_LabelCardinality(&p->est, (n) ? n->label : NULL);
+		node->input  = node->scan * sel;
+		node->sel    = sel;
+		node->domain = p->est.node_count * sel;
+	}
 
-// computes x!
-static inline unsigned long _factorial(uint x) {
-	unsigned long res = 1;
-	for(int i = 2; i <= x; i++) res *= i;
-	return res;
+	return p->node_count_plan++;
 }
 
-// swaps exps[i] with exps[j]
-static inline void _swap(Arrangement exps, uint i, uint  j) {
-	AlgebraicExpression *temp;
-	temp = exps[i];
-	exps[i] = exps[j];
-	exps[j] = temp;
-}
+static void _Planner_Init(_Planner *p, QueryGraph *qg, AlgebraicExpression **exps,
+						  uint exp_count, rax *filtered_entities, rax *bound_vars) {
+	bool maintain_transpose = false;
+	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
 
-// computes all permutations of set exps
-static inline void _permute(Arrangement set, int l, int r, Arrangement **permutations) {
-	int i;
-	if(l == r) {
-		Arrangement permutation = _Arrangement_Clone(set, r + 1);
-		*permutations = array_append(*permutations, permutation);
-	} else {
-		for(i = l; i <= r; i++) {
-			_swap(set, l, i);
-			_permute(set, l + 1, r, permutations);
-			_swap(set, l, i);   // backtrack.
-		}
+	PlanEstimate_InitCtx(&p->est, qg);
+	p->transpose_free  = maintain_transpose;
+	p->exp_count       = exp_count;
+	p->exps            = rm_malloc(sizeof(_PlanExp) * exp_count);
+	p->nodes           = rm_malloc(sizeof(_PlanNode) * exp_count * 2);
+	p->node_count_plan = 0;
+
+	for(uint i = 0; i < exp_count; i++) {
+		AlgebraicExpression *exp = exps[i];
+		_PlanExp *e = p->exps + i;
+		const char *src = AlgebraicExpression_Source(exp);
+		const char *dest = AlgebraicExpression_Destination(exp);
+
+		e->exp        = exp;
+		e->src        = _Planner_NodeIdx(p, src, filtered_entities, bound_vars);
+		e->dest       = _Planner_NodeIdx(p, dest, filtered_entities, bound_vars);
+		e->density    = PlanEstimate_TraversalDensity(&p->est, exp);
+		e->operands   = AlgebraicExpression_OperandCount(exp);
+		e->transposes = AlgebraicExpression_OperationCount(exp, AL_EXP_TRANSPOSE);
+
+		/* A 1 hop traversals where either the source node
+		 * or destination node is labeled, can't be the opening expression
+		 * in an arrangement.
+		 * Consider: MATCH (a:L0)-[:R*]->(b:L1)
+		 * [L0] * [R] * [L1] but because R is a variable length traversal
+		 * we're dealing with 3 different expressions:
+		 * exp0: [L0]
+		 * exp1: [R]
+		 * exp2: [L1]
+		 * the arrangement where [R] is the first expression:
+		 * exp0: [R]
+		 * exp1: [L0]
+		 * exp2: [L1]
+		 * Isn't valid, as currently the first expression is converted
+		 * into a scan operation. */
+		QGNode *src_node = QueryGraph_GetNodeByAlias(qg, src);
+		QGNode *dest_node = QueryGraph_GetNodeByAlias(qg, dest);
+		e->entry = (exp_count == 1 ||
+					!((src_node->label || dest_node->label) &&
+					  AlgebraicExpression_Edge(exp) && e->operands == 1));
 	}
-}
 
-// computes all possible permutations of exps
-static Arrangement *_permutations(const Arrangement exps, uint exps_count) {
-	// Number of permutations of a set S is |S|!.
-	unsigned long permutation_count = _factorial(exps_count);
-	Arrangement *permutations = array_new(Arrangement, permutation_count);
+	// make sure some expression can open the arrangement
+	bool entry = false;
+	for(uint i = 0; i < exp_count; i++) entry |= p->exps[i].entry;
+	if(!entry) {
+		for(uint i = 0; i < exp_count; i++) p->exps[i].entry = true;
+	}
+}
 
-	// Compute permutations.
-	_permute(exps, 0, exps_count - 1, &permutations);
-	ASSERT(array_len(permutations) == permutation_count);
+static void _Planner_Free(_Planner *p) {
+	rm_free(p->exps);
+	rm_free(p->nodes);
+}
 
-	return permutations;
+// returns the cost of transposing the operands of e
+// such that its source is resolved
+static inline double _Planner_TransposeCost(const _Planner *p,
+											const _PlanExp *e, bool src_resolved) {
+	if(p->transpose_free) return 0;
+	uint transposes = (src_resolved) ? e->transposes : e->operands - e->transposes;
+	return transposes * TRANSPOSE_PENALTY;
 }
 
-/* A valid arrangement of expressions is one in which the ith expression
- * source or destination nodes appear in a previous expression k where k < i. */
-static bool _valid_arrangement(const Arrangement arrangement, uint exps_count, QueryGraph *qg) {
-	AlgebraicExpression *exp = arrangement[0];
-	/* A 1 hop traversals where either the source node
-	 * or destination node is labeled, can't be the opening expression
-	 * in an arrangement.
-	 * Consider: MATCH (a:L0)-[:R*]->(b:L1)
-	 * [L0] * [R] * [L1] but because R is a variable length traversal
-	 * we're dealing with 3 different expressions:
-	 * exp0: [L0]
-	 * exp1: [R]
-	 * exp2: [L1]
-	 * the arrangement where [R] is the first expression:
-	 * exp0: [R]
-	 * exp1: [L0]
-	 * exp2: [L1]
-	 * Isn't valid, as currently the first expression is converted
-	 * into a scan operation. */
-	QGNode *src = QueryGraph_GetNodeByAlias(qg,
-											AlgebraicExpression_Source(exp)); // TODO unwisely expensive
-	QGNode *dest = QueryGraph_GetNodeByAlias(qg,
-											 AlgebraicExpression_Destination(exp)); // TODO unwisely expensive
-	if((src->label || dest->label) &&
-	   AlgebraicExpression_Edge(exp) &&
-	   AlgebraicExpression_OperandCount(exp) == 1) return false;
-
-	for(int i = 1; i < exps_count; i++) {
-		exp = arrangement[i];
-		int j = i - 1;
-
-		// Scan previous expressions.
-		for(; j >= 0; j--) {
-			AlgebraicExpression *prev_exp = arrangement[j];
-			const char *exp_src = AlgebraicExpression_Source(exp);
-			const char *exp_dest = AlgebraicExpression_Destination(exp);
-			const char *prev_exp_src = AlgebraicExpression_Source(prev_exp);
-			const char *prev_exp_dest = AlgebraicExpression_Destination(prev_exp);
-
-			if(!RG_STRCMP(prev_exp_src, exp_src)     ||
-			   !RG_STRCMP(prev_exp_dest, exp_src)    ||
-			   !RG_STRCMP(prev_exp_src, exp_dest)    ||
-			   !RG_STRCMP(prev_exp_dest, exp_dest)) break;
-		}
-		/* Nither src or dest nodes are mentioned in previous expressions
-		 * as such the arrangement is invalid. */
-		if(j < 0) return false;
+// returns the number of records produced once e is applied
+// to rows records which resolve the nodes marked in resolved
+// sets produced to the number of records e's traversal yields,
+// prior to applying the filters of the nodes it resolves
+static inline double _Planner_Rows(const _Planner *p, const _PlanExp *e,
+								   double rows, const bool *resolved, double *produced) {
+	double sel = 1;
+	rows *= e->density;
+	if(!resolved[e->src]) {
+		rows *= p->nodes[e->src].domain;
+		sel *= p->nodes[e->src].sel;
 	}
-	return true;
+	if(!resolved[e->dest] && e->dest != e->src) {
+		rows *= p->nodes[e->dest].domain;
+		sel *= p->nodes[e->dest].sel;
+	}
+	rows = _Min(rows, DBL_MAX);
+	*produced = _Min(rows / sel, DBL_MAX);
+	return rows;
 }
 
-static int _penalty_arrangement(Arrangement arrangement, uint exp_count) {
-	int penalty = 0;
-
-	/* see if graph maintains transpose matrices
-	 * if it does, there's no penalty */
-	bool maintain_transpose = false;
-	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
-	if(maintain_transpose) return 0;
+// returns the cost of scanning and applying opening expression e
+// sets dest_entry if the scan should start at e's destination
+// sets rows to the number of records e produces
+static inline double _Planner_EntryCost(const _Planner *p, const _PlanExp *e,
+										bool *dest_entry, double *rows) {
+	const _PlanNode *src = p->nodes + e->src;
+	const _PlanNode *dest = p->nodes + e->dest;
+
+	bool loop = (e->src == e->dest);
+
+	*rows = e->density * src->domain;
+	if(!loop) *rows *= dest->domain;
+	*rows = _Min(*rows, DBL_MAX);
+
+	// scanned entities, entities passing the scanned node's filters
+	// and records the traversal yields prior to the opposite node's filters
+	double src_cost = src->scan * ESTIMATE_SCAN_COST + src->input +
+					  *rows / ((loop) ? 1 : dest->sel) +
+					  _Planner_TransposeCost(p, e, true);
+	double dest_cost = dest->scan * ESTIMATE_SCAN_COST + dest->input +
+					   *rows / ((loop) ? 1 : src->sel) +
+					   _Planner_TransposeCost(p, e, false);
+
+	*dest_entry = (!loop && dest_cost < src_cost);
+	return (*dest_entry) ? dest_cost : src_cost;
+}
 
-	AlgebraicExpression *exp;
+// orders expressions via dynamic programming over subsets of expressions
+// returns false if no arrangement covering every expression was found
+static bool _Planner_OrderDP(const _Planner *p, uint *order, bool *dest_entry) {
+	ASSERT(p->exp_count <= MAX_DP_EXPRESSIONS);
+
+	uint n = p->exp_count;
+	uint state_count = 1 << n;
+	bool entry_dest[MAX_DP_EXPRESSIONS];
+	bool resolved[MAX_DP_EXPRESSIONS * 2] = {0};
+
+	// state S is the set of expressions applied so far
+	double *cost = rm_malloc(sizeof(double) * state_count);     // Cheapest arrangement of S.
+	double *rows = rm_malloc(sizeof(double) * state_count);     // Records produced by S.
+	uint64_t *nodes = rm_malloc(sizeof(uint64_t) * state_count); // Nodes resolved by S.
+	uint8_t *last = rm_malloc(sizeof(uint8_t) * state_count);   // Last expression applied.
+	memset(last, UINT8_MAX, sizeof(uint8_t) * state_count);
+
+	for(uint i = 0; i < n; i++) {
+		const _PlanExp *e = p->exps + i;
+		if(!e->entry) continue;
+
+		uint s = 1 << i;
+		cost[s]  = _Planner_EntryCost(p, e, entry_dest + i, rows + s);
+		nodes[s] = (1ULL << e->src) | (1ULL << e->dest);
+		last[s]  = i;
+	}
 
-	// account for first expression transposes
-	exp = arrangement[0];
-	uint transpose_count = AlgebraicExpression_OperationCount(exp, AL_EXP_TRANSPOSE);
-	penalty += transpose_count * T;
+	for(uint s = 1; s < state_count; s++) {
+		if(last[s] == UINT8_MAX) continue;  // unreachable
 
-	for(uint i = 1; i < exp_count; i++) {
-		exp = arrangement[i];
-		bool src_resolved = false;
+		for(uint k = 0; k < p->node_count_plan; k++) {
+			resolved[k] = (nodes[s] >> k) & 1;
+		}
 
-		// see if source is already resolved
-		for(int j = i - 1; j >= 0; j--) {
-			AlgebraicExpression *prev_exp = arrangement[j];
-			if(!RG_STRCMP(AlgebraicExpression_Source(prev_exp), AlgebraicExpression_Source(exp)) ||
-			   !RG_STRCMP(AlgebraicExpression_Destination(prev_exp), AlgebraicExpression_Source(exp))) {
-				src_resolved = true;
-				break;
+		for(uint i = 0; i < n; i++) {
+			if(s & (1 << i)) continue;
+
+			// expression must be connected to previous expressions
+			const _PlanExp *e = p->exps + i;
+			bool src_resolved = resolved[e->src];
+			if(!src_resolved && !resolved[e->dest]) continue;
+
+			double produced;
+			uint next = s | (1 << i);
+			double r = _Planner_Rows(p, e, rows[s], resolved, &produced);
+			double c = cost[s] + produced + _Planner_TransposeCost(p, e, src_resolved);
+			if(last[next] == UINT8_MAX || c < cost[next]) {
+				cost[next]  = c;
+				rows[next]  = r;
+				nodes[next] = nodes[s] | (1ULL << e->src) | (1ULL << e->dest);
+				last[next]  = i;
 			}
 		}
+	}
 
-		// dest must be resolved as we're working with valid arrangemet
-		if(src_resolved) {
-			// count how many transposes are performed
-			transpose_count = AlgebraicExpression_OperationCount(exp, AL_EXP_TRANSPOSE);
-			penalty += transpose_count * T;
-		} else {
-			// count how many transposes we require to perform
-			transpose_count = AlgebraicExpression_OperationCount(exp, AL_EXP_TRANSPOSE);
-			uint operand_count = AlgebraicExpression_OperandCount(exp);
-			penalty += (operand_count - transpose_count) * T;
+	uint s = state_count - 1;
+	bool found = (last[s] != UINT8_MAX);
+	if(found) {
+		for(int k = n - 1; k >= 0; k--) {
+			order[k] = last[s];
+			s &= ~(1 << last[s]);
 		}
+		*dest_entry = entry_dest[order[0]];
 	}
 
-	return penalty;
+	rm_free(cost);
+	rm_free(rows);
+	rm_free(nodes);
+	rm_free(last);
+	return found;
 }
 
-static int _reward_expression(AlgebraicExpression *exp, QueryGraph *qg,
-							  rax *filtered_entities, rax *bound_vars, uint reward_factor) {
-
-	// A bit naive at the moment.
-	void *res                = NULL;
-	int reward               = 0;
-	const char *src          = AlgebraicExpression_Source(exp);
-	const char *dest         = AlgebraicExpression_Destination(exp);
-	size_t src_len           = strlen(src);
-	size_t dest_len          = strlen(dest);
-
-	// Reward bound variables such that any expression with a bound variable
-	// will be preferred over any expression without.
-	if(bound_vars) {
-		res = raxFind(bound_vars, (unsigned char *)src, src_len);
-		if(res != raxNotFound) reward += B * reward_factor;
-
-		res = raxFind(bound_vars, (unsigned char *)dest, dest_len);
-		if(res != raxNotFound) reward += B * reward_factor;
-	}
-
-	// Reward filters in expression.
-	res = raxFind(filtered_entities, (unsigned char *)src, src_len);
-	if(res != raxNotFound) reward += F * reward_factor;
-
-	res = raxFind(filtered_entities, (unsigned char *)dest, dest_len);
-	if(res != raxNotFound) reward += F * reward_factor;
+// extends an arrangement opened by expression first greedily,
+// each step applying the expression producing the fewest records
+// returns the arrangement's cost
+static double _Planner_Extend(const _Planner *p, uint first, uint *order,
+		bool *dest_entry, bool *used, bool *resolved) {
+	uint n = p->exp_count;
+	memset(used, 0, sizeof(bool) * n);
+	memset(resolved, 0, sizeof(bool) * p->node_count_plan);
+
+	const _PlanExp *e = p->exps + first;
+	double rows;
+	double cost = _Planner_EntryCost(p, e, dest_entry, &rows);
+	order[0] = first;
+	used[first] = true;
+	resolved[e->src] = true;
+	resolved[e->dest] = true;
+
+	for(uint k = 1; k < n; k++) {
+		uint next = 0;
+		double best = 0;
+		double next_rows = 0;
+		bool next_connected = false;
+		bool found = false;
+
+		// prefer expressions connected to previous expressions
+		for(uint i = 0; i < n; i++) {
+			if(used[i]) continue;
+
+			e = p->exps + i;
+			bool src_resolved = resolved[e->src];
+			bool connected = src_resolved || resolved[e->dest];
+			double produced;
+			double r = _Planner_Rows(p, e, rows, resolved, &produced);
+			double c = produced + _Planner_TransposeCost(p, e, src_resolved);
+			if(!found || (connected && !next_connected) ||
+			   (connected == next_connected && c < best)) {
+				found = true;
+				best = c;
+				next = i;
+				next_rows = r;
+				next_connected = connected;
+			}
+		}
 
-	// TODO unwisely expensive
-	QGNode *src_node = QueryGraph_GetNodeByAlias(qg, src);
-	if(src_node->label) reward += L * reward_factor;
+		e = p->exps + next;
+		rows = next_rows;
+		cost += best;
+		order[k] = next;
+		used[next] = true;
+		resolved[e->src] = true;
+		resolved[e->dest] = true;
+	}
 
-	return reward;
+	return cost;
 }
 
-static int _reward_arrangement(Arrangement arrangement, uint exp_count, QueryGraph *qg,
-							   rax *filtered_entities, rax *bound_vars) {
-	int reward = 0;
-
-	// A bit naive at the moment.
-	for(uint i = 0; i < exp_count; i++) {
-		uint reward_factor = exp_count - i;
-		AlgebraicExpression *exp = arrangement[i];
-		reward += _reward_expression(exp, qg, filtered_entities, bound_vars,
-									 reward_factor);
+// orders expressions greedily, trying every opening expression
+static void _Planner_OrderGreedy(const _Planner *p, uint *order, bool *dest_entry) {
+	uint n = p->exp_count;
+	bool *used = rm_malloc(sizeof(bool) * n);
+	bool *resolved = rm_malloc(sizeof(bool) * p->node_count_plan);
+	uint *candidate = rm_malloc(sizeof(uint) * n);
+
+	bool found = false;
+	double best = 0;
+	for(uint i = 0; i < n; i++) {
+		if(!p->exps[i].entry) continue;
+
+		bool d;
+		double c = _Planner_Extend(p, i, candidate, &d, used, resolved);
+		if(!found || c < best) {
+			found = true;
+			best = c;
+			*dest_entry = d;
+			memcpy(order, candidate, sizeof(uint) * n);
+		}
 	}
+	ASSERT(found);
 
-	return reward;
-}
-
-static int _score_arrangement(Arrangement arrangement, uint exp_count, QueryGraph *qg,
-							  rax *filtered_entities, rax *bound_vars) {
-	int score = 0;
-	score -= _penalty_arrangement(arrangement, exp_count);
-	score += _reward_arrangement(arrangement, exp_count, qg, filtered_entities, bound_vars);
-	return score;
+	rm_free(used);
+	rm_free(resolved);
+	rm_free(candidate);
 }
 
 // Transpose out-of-order expressions
@@ -267,69 +394,10 @@ static void _resolve_winning_sequence(AlgebraicExpression **exps, uint exp_count
 	}
 }
 
-/* Having chosen which algebraic expression will be evaluated first,
- * determine whether it is worthwhile to transpose it
- * and thus swap the source and destination.
- *
- * If the source is bounded, we will not transpose,
- * if only the destination is bounded, we will.
- *
- * If neither are bounded, we fall back to label and filter heuristics.
- * Filters are considered more valuable than labels in selecting a starting point,
- * so we'll select the starting point with the best combination available of filters and labels. */
-static void _select_entry_point(QueryGraph *qg, AlgebraicExpression **ae, rax *filtered_entities,
-								rax *bound_vars) {
-
-	AlgebraicExpression *exp = *ae;
-	const char *src = AlgebraicExpression_Source(exp);
-	const char *dest = AlgebraicExpression_Destination(exp);
-	size_t src_len = strlen(src);
-	size_t dest_len = strlen(dest);
-
-	// MATCH (a)-[]->(a)
-	if(AlgebraicExpression_OperandCount(exp) == 1 && !RG_STRCMP(src, dest)) {
-		return;
-	}
-
-	// always start at a bound variable if one is present
-	void *lookup = NULL;
-	if(bound_vars) {
-		lookup = raxFind(bound_vars, (unsigned char *)src, src_len);
-		if(lookup != raxNotFound) {
-			return;
-		}
-
-		lookup = raxFind(bound_vars, (unsigned char *)dest, dest_len);
-		if(lookup != raxNotFound) {
-			AlgebraicExpression_Transpose(ae);
-			return;
-		}
-	}
-
-	int src_score  = 0;
-	int dest_score = 0;
-
-	// see if either source or destination nodes are filtered
-	lookup = raxFind(filtered_entities, (unsigned char *)src, src_len);
-	src_score += (lookup != raxNotFound) ? F : 0;
-
-	lookup = raxFind(filtered_entities, (unsigned char *)dest, dest_len);
-	dest_score += (lookup != raxNotFound) ? F : 0;
-
-	// see if either source or destination nodes are labeled
-	QGNode *src_node  = QueryGraph_GetNodeByAlias(qg, src);
-	src_score += (src_node->label != NULL) ? L : 0;
-
-	QGNode *dest_node = QueryGraph_GetNodeByAlias(qg, dest);
-	dest_score += (dest_node->label != NULL) ? L : 0;
-
-	// if the destination is a superior starting point, transpose expression
-	if(dest_score > src_score) AlgebraicExpression_Transpose(ae);
-}
-
 /* Given a set of algebraic expressions representing a graph traversal
  * we pick the order in which the expressions will be evaluated
- * taking into account filters and transposes.
+ * and the node the traversal starts at, taking into account label and
+ * relationship-type cardinalities, filters, bound variables and transposes.
  * exps will reordered. */
 void orderExpressions(QueryGraph *qg, AlgebraicExpression **exps, uint exp_count,
 					  const FT_FilterNode *filters, rax *bound_vars) {
@@ -342,55 +410,28 @@ void orderExpressions(QueryGraph *qg, AlgebraicExpression **exps, uint exp_count
 
 	// Collect all filtered aliases.
 	rax *filtered_entities = FilterTree_CollectModified(filters);
-	// Compute all possible permutations of algebraic expressions.
-	Arrangement *arrangements = _permutations(exps, exp_count);
-	uint arrangement_count = array_len(arrangements);
-
-	/* If we only have one arrangement, we still want to select the optimal entry point
-	 * but have no other work to do. */
-	if(arrangement_count == 1) goto select_entry_point;
-
-	// Remove invalid arrangements.
-	Arrangement *valid_arrangements = array_new(Arrangement, arrangement_count);
-	for(int i = 0; i < arrangement_count; i++) {
-		if(_valid_arrangement(arrangements[i], exp_count, qg)) {
-			valid_arrangements = array_append(valid_arrangements, arrangements[i]);
-		}
-	}
-	uint valid_arrangement_count = array_len(valid_arrangements);
-	ASSERT(valid_arrangement_count > 0);
-
-	/* Score each arrangement,
-	 * keep track after arrangement with highest score. */
-	int max_score = INT_MIN;
-	Arrangement top_arrangement = valid_arrangements[0];
-
-	for(uint i = 0; i < valid_arrangement_count; i++) {
-		Arrangement arrangement = valid_arrangements[i];
-		int score = _score_arrangement(arrangement, exp_count, qg, filtered_entities, bound_vars);
-		// printf("score: %d\n", score);
-		// _Arrangement_Print(arrangement, exp_count);
-		if(max_score < score) {
-			max_score = score;
-			top_arrangement = arrangement;
-		}
-	}
 
-	array_free(valid_arrangements);
+	_Planner p;
+	_Planner_Init(&p, qg, exps, exp_count, filtered_entities, bound_vars);
+
+	bool dest_entry = false;
+	uint *order = rm_malloc(sizeof(uint) * exp_count);
+	if(exp_count > MAX_DP_EXPRESSIONS || !_Planner_OrderDP(&p, order, &dest_entry)) {
+		_Planner_OrderGreedy(&p, order, &dest_entry);
+	}
 
 	// Update input.
-	for(uint i = 0; i < exp_count; i++) exps[i] = top_arrangement[i];
+	for(uint i = 0; i < exp_count; i++) exps[i] = p.exps[order[i]].exp;
+
+	// Start at the opening expression's destination if it is cheaper.
+	if(dest_entry) AlgebraicExpression_Transpose(exps);
 
 	// Depending on how the expressions have been ordered, we may have to transpose expressions
 	// so that their source nodes have already been resolved by previous expressions.
 	_resolve_winning_sequence(exps, exp_count);
 
-select_entry_point:
-	// Transpose the winning expression if the destination node is a more efficient starting place.
-	_select_entry_point(qg, exps + 0, filtered_entities, bound_vars);
-
+	rm_free(order);
+	_Planner_Free(&p);
 	raxFree(filtered_entities);
-	for(uint i = 0; i < arrangement_count; i++) _Arrangement_Free(arrangements[i]);
-	array_free(arrangements);
 }
 
@@ -5,16 +5,22 @@
 */
 
 #include "RG.h"
+#include <math.h>
 #include "../../value.h"
 #include "../../util/arr.h"
 #include "../../query_ctx.h"
+#include "../ops/op_sort.h"
 #include "../ops/op_filter.h"
 #include "../ops/op_index_scan.h"
+#include "../ops/op_edge_index_scan.h"
+#include "../ops/op_conditional_traverse.h"
 #include "../ops/op_node_by_label_scan.h"
 #include "../../ast/ast_shared.h"
+#include "../../ast/ast_build_op_contexts.h"
 #include "../../datatypes/array.h"
 #include "../../datatypes/point.h"
 #include "../../arithmetic/arithmetic_op.h"
+#include "../../util/range/numeric_range.h"
 #include "../../filter_tree/filter_tree_utils.h"
 #include "../execution_plan_build/execution_plan_modify.h"
 
@@ -96,7 +102,23 @@ static bool _applicable_predicate(const char* filtered_entity,
 		return _validateInExpression(filter->exp.exp);
 	}
 
-	if(isDistanceFilter(filter)) return true;
+	if(isDistanceFilter(filter)) {
+		// the filtered point must be an attribute of the filtered entity
+		rax *entities = FilterTree_CollectModified(filter);
+		res = raxFind(entities, (unsigned char *)filtered_entity,
+				strlen(filtered_entity)) != raxNotFound;
+		raxFree(entities);
+		return res;
+	}
+
+	if(isPrefixFilter(filter)) {
+		// the prefixed string must be an attribute of the filtered entity
+		rax *entities = FilterTree_CollectModified(filter);
+		res = raxFind(entities, (unsigned char *)filtered_entity,
+				strlen(filtered_entity)) != raxNotFound;
+		raxFree(entities);
+		return res;
+	}
 
 	switch(filter->t) {
 	case FT_N_PRED:
@@ -267,6 +289,348 @@ static FT_FilterNode *_Concat_Filters(OpFilter **filter_ops) {
 	return root;
 }
 
+// tightens 'range' by the numeric constraints of 'filter'
+// returns false if filter isn't a conjunction of comparisons between
+// a single attribute and a numeric constant, in which case the index
+// query is left to RediSearch
+// if 'runtime' is specified constraints by entity free expressions which can't
+// be reduced ahead of execution, e.g. n.v > timestamp() - 1000, are accepted
+// 'runtime' is set, range is then left to be evaluated once per query
+static bool _numericRange(const char *filtered_entity, FT_FilterNode *filter,
+		const char **attr, NumericRange *range, bool *runtime) {
+	SIValue v;
+	char *prop = NULL;
+	rax *entities = NULL;
+	bool constant = false;
+
+	switch(filter->t) {
+	case FT_N_COND:
+		if(filter->cond.op != OP_AND) return false;
+		return (_numericRange(filtered_entity, filter->cond.left, attr, range,
+					runtime) &&
+				_numericRange(filtered_entity, filter->cond.right, attr, range,
+					runtime));
+	case FT_N_PRED:
+		switch(filter->pred.op) {
+		case OP_EQUAL:
+		case OP_LT:
+		case OP_LE:
+		case OP_GT:
+		case OP_GE:
+			break;
+		default:
+			return false;
+		}
+
+		// filter is normalized, attribute lookup on the left hand side
+		if(!AR_EXP_IsAttribute(filter->pred.lhs, &prop)) return false;
+		if(*attr != NULL && strcmp(*attr, prop) != 0) return false;
+
+		// attribute must belong to the scanned entity
+		entities = raxNew();
+		AR_EXP_CollectEntities(filter->pred.lhs, entities);
+		constant = (raxSize(entities) == 1 && raxFind(entities,
+					(unsigned char *)filtered_entity, strlen(filtered_entity))
+				!= raxNotFound);
+		raxFree(entities);
+		if(!constant) return false;
+
+		// right hand side must be constant, e.g. n.v > 1 or n.v > $param
+		entities = raxNew();
+		AR_EXP_CollectEntities(filter->pred.rhs, entities);
+		constant = (raxSize(entities) == 0);
+		raxFree(entities);
+		if(!constant) return false;
+		if(!AR_EXP_ReduceToScalar(filter->pred.rhs, true, &v)) {
+			// e.g. n.v > timestamp(), bound is known only at runtime
+			if(runtime == NULL) return false;
+			*runtime = true;
+			*attr = prop;
+			return true;
+		}
+		if(!(SI_TYPE(v) & SI_NUMERIC)) return false;
+
+		*attr = prop;
+		NumericRange_TightenRange(range, filter->pred.op, SI_GET_NUMERIC(v));
+		return true;
+	default:
+		return false;
+	}
+}
+
+// returns true if filter is a single equality between an attribute
+// of the scanned entity and an expression over other entities
+// e.g. b.id = a.ref, such that it is a lookup of a runtime value
+static bool _numericLookup(const char *filtered_entity, FT_FilterNode *filter,
+		const char **attr, AR_ExpNode **exp) {
+	char *prop = NULL;
+	rax *entities = NULL;
+	bool runtime = false;
+
+	if(filter->t != FT_N_PRED || filter->pred.op != OP_EQUAL) return false;
+
+	// filter is normalized, attribute lookup on the left hand side
+	if(!AR_EXP_IsAttribute(filter->pred.lhs, &prop)) return false;
+
+	// right hand side must refer to other entities only
+	entities = raxNew();
+	AR_EXP_CollectEntities(filter->pred.rhs, entities);
+	runtime = (raxSize(entities) > 0 && raxFind(entities,
+				(unsigned char *)filtered_entity, strlen(filtered_entity))
+			== raxNotFound);
+	raxFree(entities);
+	if(!runtime) return false;
+
+	*attr = prop;
+	*exp = filter->pred.rhs;
+	return true;
+}
+
+// numeric constraints on a single attribute of the scanned entity
+typedef struct {
+	Attribute_ID attr;
+	NumericRange range;
+} AttributeRange;
+
+// collects the numeric constraints of 'filter' per attribute
+// returns false if filter isn't a conjunction of comparisons between
+// attributes of the scanned entity and numeric constants
+static bool _numericRanges(const char *filtered_entity, FT_FilterNode *filter,
+		AttributeRange **ranges) {
+	char *prop = NULL;
+
+	switch(filter->t) {
+	case FT_N_COND:
+		if(filter->cond.op != OP_AND) return false;
+		return (_numericRanges(filtered_entity, filter->cond.left, ranges) &&
+				_numericRanges(filtered_entity, filter->cond.right, ranges));
+	case FT_N_PRED:
+		if(!AR_EXP_IsAttribute(filter->pred.lhs, &prop)) return false;
+		GraphContext *gc = QueryCtx_GetGraphCtx();
+		Attribute_ID attr_id = GraphContext_GetAttributeID(gc, prop);
+		if(attr_id == ATTRIBUTE_NOTFOUND) return false;
+
+		// locate attribute constraints, introduce if missing
+		AttributeRange *r = NULL;
+		uint range_count = array_len(*ranges);
+		for(uint i = 0; i < range_count; i++) {
+			if((*ranges)[i].attr == attr_id) r = *ranges + i;
+		}
+		if(r == NULL) {
+			AttributeRange ar = {.attr = attr_id, .range = {.min = -INFINITY,
+				.max = INFINITY, .include_min = false, .include_max = false,
+				.valid = true}};
+			array_append(*ranges, ar);
+			r = *ranges + range_count;
+		}
+
+		const char *attr = prop;
+		return _numericRange(filtered_entity, filter, &attr, &r->range, NULL);
+	default:
+		return false;
+	}
+}
+
+static inline bool _pointRange(const NumericRange *range) {
+	return (range->min == range->max && range->include_min &&
+			range->include_max);
+}
+
+// creates a composite index scan resolving 'filter'
+// equality constraints are matched against the leading key columns
+// followed by an optional range constraint on the next column
+// nodes are only part of a composite if all of their key values are numeric
+// as such a composite is used if filter constrains each of its key columns
+// and nothing but its key columns
+// returns NULL if no composite index can resolve filter
+static OpBase *_buildCompositeScan(NodeByLabelScan *scan, Index *idx,
+		FT_FilterNode *filter) {
+	OpBase *op = NULL;
+	CompositeIndex **composites = Index_GetCompositeIndices(idx);
+	uint composite_count = array_len(composites);
+	if(composite_count == 0) return NULL;
+
+	AttributeRange *ranges = array_new(AttributeRange, 2);
+	if(!_numericRanges(scan->n.alias, filter, &ranges)) goto cleanup;
+
+	// contradicting constraints are left to the range index
+	uint range_count = array_len(ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(!NumericRange_IsValid(&ranges[i].range)) goto cleanup;
+	}
+
+	CompositeIndex *best = NULL;
+	uint best_prefix_len = 0;
+	const NumericRange *best_bounds = NULL;
+	double best_prefix[COMPOSITE_INDEX_MAX_FIELDS];
+
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex *ci = composites[i];
+		double prefix[COMPOSITE_INDEX_MAX_FIELDS];
+		const NumericRange *bounds = NULL;
+		uint prefix_len = 0;
+
+		// match leading key columns against equality constraints
+		for(; prefix_len < ci->key_count; prefix_len++) {
+			const NumericRange *r = NULL;
+			for(uint j = 0; j < range_count; j++) {
+				if(ranges[j].attr == ci->attributes[prefix_len]) {
+					r = &ranges[j].range;
+				}
+			}
+			if(r == NULL) break;
+			if(!_pointRange(r)) {
+				bounds = r;  // range constraint on the next column
+				break;
+			}
+			prefix[prefix_len] = r->min;
+		}
+
+		// all key columns and constraints must be matched
+		uint covered = prefix_len + (bounds != NULL);
+		if(covered != ci->key_count || covered != range_count) continue;
+
+		best = ci;
+		best_bounds = bounds;
+		best_prefix_len = prefix_len;
+		memcpy(best_prefix, prefix, sizeof(double) * prefix_len);
+		break;
+	}
+
+	if(best != NULL) {
+		op = NewIndexCompositeScanOp(scan->op.plan, scan->g, scan->n, idx->idx,
+				best, best_prefix, best_prefix_len, best_bounds, filter);
+	}
+
+cleanup:
+	array_free(ranges);
+	return op;
+}
+
+// creates an index scan operation resolving 'filter'
+// prefers the native composite and range indices over RediSearch
+// if they can resolve filter
+static OpBase *_buildIndexScan(NodeByLabelScan *scan, Index *idx,
+		FT_FilterNode *filter) {
+	const char *attr = NULL;
+	AR_ExpNode *lookup_exp = NULL;
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	NumericRange range = {.min = -INFINITY, .max = INFINITY,
+		.include_min = false, .include_max = false, .valid = true};
+
+	OpBase *composite_scan = _buildCompositeScan(scan, idx, filter);
+	if(composite_scan != NULL) return composite_scan;
+
+	bool runtime = false;
+	if(_numericRange(scan->n.alias, filter, &attr, &range, &runtime)) {
+		Attribute_ID attr_id = GraphContext_GetAttributeID(gc, attr);
+		RangeIndex *range_idx = Index_GetRangeIndex(idx, attr_id);
+		if(range_idx != NULL) {
+			return NewIndexRangeScanOp(scan->op.plan, scan->g, scan->n,
+					idx->idx, range_idx, runtime ? NULL : &range, filter);
+		}
+	}
+
+	// lookup runtime values directly in the range index
+	// rather than rebuilding a RediSearch query for every input record
+	attr = NULL;
+	if(_numericLookup(scan->n.alias, filter, &attr, &lookup_exp)) {
+		Attribute_ID attr_id = GraphContext_GetAttributeID(gc, attr);
+		RangeIndex *range_idx = Index_GetRangeIndex(idx, attr_id);
+		if(range_idx != NULL) {
+			return NewIndexLookupScanOp(scan->op.plan, scan->g, scan->n,
+					idx->idx, range_idx, lookup_exp, filter);
+		}
+	}
+
+	return NewIndexScanOp(scan->op.plan, scan->g, scan->n, idx->idx, filter);
+}
+
+//------------------------------------------------------------------------------
+// Index order
+//------------------------------------------------------------------------------
+
+// returns the scan whose output order reaches 'sort' unchanged
+// NULL if ops in between may reorder records
+static OpBase *_sortedScan(OpSort *sort) {
+	OpBase *op = sort->op.children[0];
+	// distinct and filters maintain the order of their input
+	while(op->type == OPType_DISTINCT || op->type == OPType_FILTER) {
+		op = op->children[0];
+	}
+	if(op->type != OPType_PROJECT || op->childCount != 1) return NULL;
+
+	op = op->children[0];
+	while(op->type == OPType_FILTER) op = op->children[0];
+
+	if(op->type != OPType_INDEX_SCAN) return NULL;
+	// scans fed by other ops are replayed per input record
+	if(op->childCount != 0) return NULL;
+	return op;
+}
+
+// returns the attribute of 'alias' by which sort orders its input
+// ATTRIBUTE_NOTFOUND if sort doesn't order by a single attribute of alias
+static Attribute_ID _sortAttribute(OpSort *sort, const char *alias,
+		bool *descending) {
+	if(array_len(sort->exps) != 1) return ATTRIBUTE_NOTFOUND;
+	*descending = (sort->directions[0] != DIR_ASC);
+
+	char *prop = NULL;
+	AR_ExpNode *exp = sort->exps[0];
+	if(!AR_EXP_IsAttribute(exp, &prop)) return ATTRIBUTE_NOTFOUND;
+
+	// attribute must belong to alias
+	rax *entities = raxNew();
+	AR_EXP_CollectEntities(exp, entities);
+	bool match = (raxSize(entities) == 1 && raxFind(entities,
+				(unsigned char *)alias, strlen(alias)) != raxNotFound);
+	raxFree(entities);
+	if(!match) return ATTRIBUTE_NOTFOUND;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	return GraphContext_GetAttributeID(gc, prop);
+}
+
+// remove sort operations whose input is already ordered by an index scan
+static void _utilizeIndexOrder(ExecutionPlan *plan, OpBase **sorts) {
+	uint sort_count = array_len(sorts);
+	for(uint i = 0; i < sort_count; i++) {
+		OpSort *sort = (OpSort *)sorts[i];
+		IndexScan *scan = (IndexScan *)_sortedScan(sort);
+		if(scan == NULL) continue;
+
+		bool descending;
+		Attribute_ID attr = _sortAttribute(sort, scan->n.alias, &descending);
+		if(attr == ATTRIBUTE_NOTFOUND) continue;
+
+		int key = IndexScan_OrderedCompositeKey(scan);
+		if(key != -1) {
+			// composite index scans report nodes in ascending key order
+			if(descending) continue;
+			if(scan->composite->attributes[key] != attr) continue;
+		} else if(scan->range != NULL && scan->lookup_exp == NULL &&
+				!scan->runtime_bounds) {
+			// range index scans are able to report nodes in either order
+			// runtime bounds might fall back to RediSearch, which is unordered
+			GraphContext *gc = QueryCtx_GetGraphCtx();
+			Index *idx = GraphContext_GetIndex(gc, scan->n.label, NULL,
+					IDX_EXACT_MATCH);
+			if(idx == NULL || Index_GetRangeIndex(idx, attr) != scan->range) {
+				continue;
+			}
+			// the scan's limit hint bounds the number of queried nodes
+			IndexScan_SetOrder(scan, descending);
+		} else {
+			continue;
+		}
+
+		// records reach sort in order, sort is redundant
+		ExecutionPlan_RemoveOp(plan, (OpBase *)sort);
+		OpBase_Free((OpBase *)sort);
+	}
+}
+
 // try to replace given Label Scan operation and a set of Filter operations with
 // a single Index Scan operation
 void reduce_scan_op(ExecutionPlan *plan, NodeByLabelScan *scan) {
@@ -274,10 +638,10 @@ void reduce_scan_op(ExecutionPlan *plan, NodeByLabelScan *scan) {
 	const char *label = scan->n.label;
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 	Index *idx = GraphContext_GetIndex(gc, label, NULL, IDX_EXACT_MATCH);
-	if(idx == NULL) return;
+	// indices under construction are partially populated
+	if(idx == NULL || !Index_Enabled(idx)) return;
 
 	// get all applicable filter for index
-	RSIndex *rs_idx = idx->idx;
 	OpFilter **filters = _applicableFilters(scan, idx);
 
 	// no filters, return
@@ -285,8 +649,7 @@ void reduce_scan_op(ExecutionPlan *plan, NodeByLabelScan *scan) {
 	if(filters_count == 0) goto cleanup;
 
 	FT_FilterNode *root = _Concat_Filters(filters);
-	OpBase *indexOp = NewIndexScanOp(scan->op.plan, scan->g, scan->n, rs_idx,
-			root);
+	OpBase *indexOp = _buildIndexScan(scan, idx, root);
 
 	// replace the redundant scan op with the newly-constructed Index Scan
 	ExecutionPlan_ReplaceOp(plan, (OpBase *)scan, indexOp);
@@ -306,6 +669,89 @@ cleanup:
 	array_free(filters);
 }
 
+//------------------------------------------------------------------------------
+// Relationship indices
+//------------------------------------------------------------------------------
+
+// returns the attribute of 'edge' constrained to a numeric range by 'filter'
+// ATTRIBUTE_NOTFOUND if filter isn't a range over an attribute of 'idx'
+static Attribute_ID _edgeRange(const char *edge, Index *idx, OpFilter *filter,
+		NumericRange *range) {
+	const char *attr = NULL;
+	Attribute_ID attr_id = ATTRIBUTE_NOTFOUND;
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+
+	// normalize a copy, the filter is retained for correctness
+	FT_FilterNode *tree = FilterTree_Clone(filter->filterTree);
+	_normalize_filter(edge, &tree);
+	if(_numericRange(edge, tree, &attr, range, NULL)) {
+		attr_id = GraphContext_GetAttributeID(gc, attr);
+		if(Index_GetRangeIndex(idx, attr_id) == NULL) attr_id = ATTRIBUTE_NOTFOUND;
+	}
+	FilterTree_Free(tree);
+
+	return attr_id;
+}
+
+// try to replace a scan followed by a traversal of an indexed relationship type
+// and a filter constraining the traversed edge to a numeric range
+// with an EdgeIndexScan, seeding the traversal from the matching edges
+// e.g. MATCH (a)-[e:R]->(b) WHERE e.v > 1
+static void _reduceEdgeTraversal(ExecutionPlan *plan, OpCondTraverse *traverse) {
+	if(traverse->edge_ctx == NULL) return;
+	if(traverse->op.childCount != 1) return;
+
+	// traversal must be seeded by a tap scan
+	OpBase *scan = traverse->op.children[0];
+	if(scan->type != OPType_ALL_NODE_SCAN &&
+	   scan->type != OPType_NODE_BY_LABEL_SCAN) return;
+	if(scan->childCount != 0) return;
+
+	// single typed, directed, single hop edge
+	AlgebraicExpression *ae = traverse->ae;
+	const char *edge = AlgebraicExpression_Edge(ae);
+	QGEdge *e = QueryGraph_GetEdgeByAlias(plan->query_graph, edge);
+	if(e == NULL || e->bidirectional || QGEdge_VariableLength(e)) return;
+	if(array_len(e->reltypeIDs) != 1 || e->reltypeIDs[0] < 0) return;
+	if(e->src == e->dest) return;
+
+	// the traversal must resolve exactly the edge endpoints
+	const char *src = AlgebraicExpression_Source(ae);
+	const char *dest = AlgebraicExpression_Destination(ae);
+	bool forward = (strcmp(src, e->src->alias) == 0 &&
+			strcmp(dest, e->dest->alias) == 0);
+	bool backward = (strcmp(src, e->dest->alias) == 0 &&
+			strcmp(dest, e->src->alias) == 0);
+	if(!forward && !backward) return;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchemaByID(gc, e->reltypeIDs[0], SCHEMA_EDGE);
+	Index *idx = Schema_GetIndex(s, NULL, IDX_EXACT_MATCH);
+	if(idx == NULL) return;
+
+	// locate a range filter over an indexed edge attribute
+	Attribute_ID attr = ATTRIBUTE_NOTFOUND;
+	NumericRange range;
+	OpBase *current = traverse->op.parent;
+	while(current != NULL && current->type == OPType_FILTER) {
+		range = (NumericRange) {.min = -INFINITY, .max = INFINITY,
+			.include_min = false, .include_max = false, .valid = true};
+		attr = _edgeRange(edge, idx, (OpFilter *)current, &range);
+		if(attr != ATTRIBUTE_NOTFOUND) break;
+		current = current->parent;
+	}
+	if(attr == ATTRIBUTE_NOTFOUND) return;
+
+	// the edge index scan takes ownership of the traversal's expression
+	traverse->ae = NULL;
+	OpBase *edge_scan = NewEdgeIndexScanOp(plan, traverse->graph, ae, attr, &range);
+
+	ExecutionPlan_RemoveOp(plan, scan);
+	OpBase_Free(scan);
+	ExecutionPlan_ReplaceOp(plan, (OpBase *)traverse, edge_scan);
+	OpBase_Free((OpBase *)traverse);
+}
+
 void utilizeIndices(ExecutionPlan *plan) {
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 	// return immediately if the graph has no indices
@@ -322,6 +768,20 @@ void utilizeIndices(ExecutionPlan *plan) {
 		reduce_scan_op(plan, scanOp);
 	}
 
+	// seed traversals of indexed relationship types from matching edges
+	OpBase **traversals = ExecutionPlan_CollectOps(plan->root,
+			OPType_CONDITIONAL_TRAVERSE);
+	uint traversal_count = array_len(traversals);
+	for(uint i = 0; i < traversal_count; i++) {
+		_reduceEdgeTraversal(plan, (OpCondTraverse *)traversals[i]);
+	}
+	array_free(traversals);
+
+	// remove sorts satisfied by the order of composite and range index scans
+	OpBase **sorts = ExecutionPlan_CollectOps(plan->root, OPType_SORT);
+	_utilizeIndexOrder(plan, sorts);
+
 	// cleanup
+	array_free(sorts);
 	array_free(scanOps);
 }
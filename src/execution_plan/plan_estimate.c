@@ -0,0 +1,429 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "plan_estimate.h"
+#include "../RG.h"
+#include "../query_ctx.h"
+#include "./ops/ops.h"
+#include "../datatypes/array.h"
+#include <strings.h>
+#include <math.h>
+#include <float.h>
+
+#define MAX_VARLEN_HOPS 32  // Hops considered when estimating variable length traversals.
+
+// estimates used when graph statistics are unavailable
+#define DEFAULT_NODE_COUNT 1000      // Number of nodes.
+#define DEFAULT_LABEL_FRACTION 0.1   // Fraction of nodes carrying a label.
+
+// estimates of operations whose output isn't derived from graph statistics
+#define DEFAULT_LIST_SIZE 10         // Number of elements of an unwound list.
+#define GROUP_FRACTION 0.1           // Number of groups relative to aggregated records.
+#define DISTINCT_FRACTION 0.5        // Fraction of distinct records.
+#define SEMI_APPLY_SELECTIVITY 0.5   // Fraction of records passing a pattern predicate.
+
+static inline double _Max(double a, double b) {
+	return (a > b) ? a : b;
+}
+
+static inline double _Min(double a, double b) {
+	return (a < b) ? a : b;
+}
+
+//------------------------------------------------------------------------------
+// statistics
+//------------------------------------------------------------------------------
+
+// cardinalities observed by an execution of the plan being built
+static __thread const PlanFeedback *_feedback = NULL;
+
+void PlanEstimate_SetFeedback(const PlanFeedback *feedback) {
+	_feedback = feedback;
+}
+
+void PlanEstimate_InitCtx(PlanEstimateCtx *ctx, QueryGraph *qg) {
+	ASSERT(ctx != NULL);
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	ctx->qg         = qg;
+	ctx->gc         = (gc && gc->g) ? gc : NULL;
+	ctx->node_count = (ctx->gc) ? _Max(Graph_NodeCount(gc->g), 1) : DEFAULT_NODE_COUNT;
+	ctx->feedback   = _feedback;
+}
+
+// returns the number of entities of schema, at least 1
+static double _SchemaCardinality(const Schema *s) {
+	// unknown schema, no entity will match
+	if(s == NULL) return 1;
+	uint64_t count = __atomic_load_n(&s->entity_count, __ATOMIC_RELAXED);
+	return _Max(count, 1);
+}
+
+double PlanEstimate_LabelCardinality(const PlanEstimateCtx *ctx, const char *label) {
+	if(label == NULL) return ctx->node_count;
+	if(ctx->gc == NULL) return ctx->node_count * DEFAULT_LABEL_FRACTION;
+	return _SchemaCardinality(GraphContext_GetSchema(ctx->gc, label, SCHEMA_NODE));
+}
+
+double PlanEstimate_RelationCardinality(const PlanEstimateCtx *ctx, const char *reltype) {
+	if(ctx->gc == NULL) return ctx->node_count;
+	if(reltype == NULL) return _Max(Graph_EdgeCount(ctx->gc->g), 1);
+	return _SchemaCardinality(GraphContext_GetSchema(ctx->gc, reltype, SCHEMA_EDGE));
+}
+
+double PlanEstimate_FilterSelectivity(const PlanEstimateCtx *ctx,
+		const char *alias, bool filtered) {
+	if(!filtered) return 1;
+
+	double sel;
+	if(ctx->feedback && PlanFeedback_Selectivity(ctx->feedback, alias, &sel)) {
+		// avoid zero estimates, a filter may pass a single entity
+		return _Min(_Max(sel, 1 / ctx->node_count), 1);
+	}
+	return ESTIMATE_FILTER_SELECTIVITY;
+}
+
+double PlanEstimate_TraversalDensity(const PlanEstimateCtx *ctx,
+		const AlgebraicExpression *exp) {
+	double density;
+	if(ctx->feedback && PlanFeedback_Density(ctx->feedback,
+				AlgebraicExpression_Source((AlgebraicExpression *)exp),
+				AlgebraicExpression_Destination((AlgebraicExpression *)exp), &density)) {
+		double n = ctx->node_count;
+		return _Min(_Max(density, 1 / (n * n)), 1);
+	}
+	return PlanEstimate_ExpDensity(ctx, exp);
+}
+
+// returns the fraction of node pairs connected by a path of
+// min_hops to max_hops edges, each edge connecting a density fraction of pairs
+static double _VarLenDensity(double density, double n, uint min_hops,
+							 uint max_hops) {
+	double total = (min_hops == 0) ? 1 / n : 0;
+	// pairs connected by a path of exactly h hops ~ n^(h-1) * density^h
+	double hop_density = density;
+	for(uint h = 1; h <= max_hops && h <= MAX_VARLEN_HOPS && total < 1; h++) {
+		if(h >= min_hops) total += hop_density;
+		hop_density = _Min(hop_density * density * n, 1);
+	}
+	return total;
+}
+
+double PlanEstimate_ExpDensity(const PlanEstimateCtx *ctx,
+							   const AlgebraicExpression *exp) {
+	double n = ctx->node_count;
+	double density = 0;
+
+	if(exp->type == AL_OPERAND) {
+		if(exp->operand.matrix == IDENTITY_MATRIX) {
+			density = 1 / n;
+		} else if(exp->operand.diagonal) {
+			density = PlanEstimate_LabelCardinality(ctx, exp->operand.label) / (n * n);
+		} else {
+			density = PlanEstimate_RelationCardinality(ctx, exp->operand.label) / (n * n);
+			const char *edge = exp->operand.edge;
+			QGEdge *e = (edge && ctx->qg) ? QueryGraph_GetEdgeByAlias(ctx->qg, edge) : NULL;
+			if(e && QGEdge_VariableLength(e)) {
+				density = _VarLenDensity(density, n, e->minHops, e->maxHops);
+			}
+		}
+	} else {
+		uint child_count = AlgebraicExpression_ChildCount(exp);
+		AlgebraicExpression **children = exp->operation.children;
+		switch(exp->operation.op) {
+		case AL_EXP_MUL:
+			// (A * B)[i,j] = sum over k of A[i,k] * B[k,j]
+			density = PlanEstimate_ExpDensity(ctx, children[0]);
+			for(uint i = 1; i < child_count; i++) {
+				density *= PlanEstimate_ExpDensity(ctx, children[i]) * n;
+			}
+			break;
+		case AL_EXP_ADD:
+			for(uint i = 0; i < child_count; i++) {
+				density += PlanEstimate_ExpDensity(ctx, children[i]);
+			}
+			break;
+		case AL_EXP_TRANSPOSE:
+			density = PlanEstimate_ExpDensity(ctx, children[0]);
+			break;
+		default:
+			ASSERT(false && "unknown algebraic expression operation");
+			break;
+		}
+	}
+
+	// avoid zero estimates, which would render all arrangements equal
+	return _Min(_Max(density, 1 / (n * n)), 1);
+}
+
+//------------------------------------------------------------------------------
+// operations
+//------------------------------------------------------------------------------
+
+// returns the number of entities of the schema identified by id
+static double _SchemaIDCardinality(const PlanEstimateCtx *ctx, int id, SchemaType t) {
+	if(ctx->gc == NULL) {
+		return (t == SCHEMA_NODE) ? ctx->node_count * DEFAULT_LABEL_FRACTION : ctx->node_count;
+	}
+	return _SchemaCardinality(GraphContext_GetSchemaByID(ctx->gc, id, t));
+}
+
+// returns the number of records produced by a traversal of exp
+// from each of input records
+static double _TraverseRecords(const PlanEstimateCtx *ctx,
+							   const AlgebraicExpression *exp, double input) {
+	return input * PlanEstimate_TraversalDensity(ctx, exp) * ctx->node_count;
+}
+
+// returns the constant integer value of exp, false if exp isn't one
+static bool _ConstantInt(const AR_ExpNode *exp, int64_t *v) {
+	if(exp->type != AR_EXP_OPERAND || exp->operand.type != AR_EXP_CONSTANT) return false;
+	if(SI_TYPE(exp->operand.constant) != T_INT64) return false;
+	*v = exp->operand.constant.longval;
+	return true;
+}
+
+// returns the length of the list exp evaluates to
+// lists and range() calls of constants are measured
+static double _ListLength(const AR_ExpNode *exp) {
+	if(exp->type == AR_EXP_OPERAND && exp->operand.type == AR_EXP_CONSTANT &&
+	   SI_TYPE(exp->operand.constant) == T_ARRAY) {
+		return SIArray_Length(exp->operand.constant);
+	}
+
+	if(exp->type == AR_EXP_OP && strcasecmp(exp->op.func_name, "range") == 0 &&
+	   (exp->op.child_count == 2 || exp->op.child_count == 3)) {
+		int64_t args[3] = {0, 0, 1};
+		for(int i = 0; i < exp->op.child_count; i++) {
+			if(!_ConstantInt(exp->op.children[i], args + i)) return DEFAULT_LIST_SIZE;
+		}
+		if(args[2] < 1 || args[1] < args[0]) return 0;
+		return (double)(args[1] - args[0]) / args[2] + 1;
+	}
+
+	return DEFAULT_LIST_SIZE;
+}
+
+// records a scan of 'scanned' entities, producing 'records' records
+// per input record
+static double _Scan(OpBase *op, double input, double scanned, double records) {
+	op->estimate.cost = input * (scanned * ESTIMATE_SCAN_COST + records);
+	return input * records;
+}
+
+// estimates op and its children, where arg is the number of records
+// taps of the op's branch are handed by an Apply operation
+// sets op's records estimate and its own cost within op->estimate.cost
+// returns the number of records op produces
+static double _Estimate(PlanEstimateCtx *ctx, OpBase *op, double arg) {
+	// operations whose first child holds the bound branch
+	// evaluate their remaining children once per bound record
+	bool bound_branch = (OP_IS_APPLY(op) || op->type == OPType_APPLY ||
+						 (op->type == OPType_MERGE && op->childCount == 3));
+
+	double children[op->childCount];
+	double input = 0;
+	for(int i = 0; i < op->childCount; i++) {
+		double child_arg = (bound_branch && i > 0) ? children[0] : arg;
+		children[i] = _Estimate(ctx, op->children[i], child_arg);
+	}
+	// scans without children operate on a single implicit record
+	if(op->childCount > 0) input = children[0];
+	else input = 1;
+
+	ctx->qg = (op->plan) ? op->plan->query_graph : NULL;
+
+	double records = input;
+	op->estimate.cost = records;
+
+	switch(op->type) {
+	case OPType_ALL_NODE_SCAN:
+		records = _Scan(op, input, ctx->node_count, ctx->node_count);
+		break;
+	case OPType_NODE_BY_LABEL_SCAN: {
+		NodeByLabelScan *scan = (NodeByLabelScan *)op;
+		double label = PlanEstimate_LabelCardinality(ctx, scan->n.label);
+		records = _Scan(op, input, label, label);
+		break;
+	}
+	case OPType_NODE_BY_LABEL_AND_ID_SCAN: {
+		NodeByLabelScan *scan = (NodeByLabelScan *)op;
+		double label = PlanEstimate_LabelCardinality(ctx, scan->n.label);
+		records = _Scan(op, input, label, label * ESTIMATE_FILTER_SELECTIVITY);
+		break;
+	}
+	case OPType_INDEX_SCAN: {
+		IndexScan *scan = (IndexScan *)op;
+		double label = PlanEstimate_LabelCardinality(ctx, scan->n.label);
+		double sel = (scan->filter) ?
+			FilterTree_EstimateSelectivity(scan->filter) : ESTIMATE_FILTER_SELECTIVITY;
+		// an index lookup visits matching entities only
+		records = _Scan(op, input, label * sel, label * sel);
+		break;
+	}
+	case OPType_EDGE_INDEX_SCAN: {
+		OpEdgeIndexScan *scan = (OpEdgeIndexScan *)op;
+		double edges = _SchemaIDCardinality(ctx, scan->relation_id, SCHEMA_EDGE);
+		records = _Scan(op, input, edges * ESTIMATE_FILTER_SELECTIVITY,
+						edges * ESTIMATE_FILTER_SELECTIVITY);
+		break;
+	}
+	case OPType_EDGE_BY_TYPE_SCAN: {
+		OpEdgeByTypeScan *scan = (OpEdgeByTypeScan *)op;
+		double edges = _SchemaIDCardinality(ctx, scan->relation_id, SCHEMA_EDGE);
+		records = _Scan(op, input, edges, edges);
+		break;
+	}
+	case OPType_EDGE_BY_ID_SEEK: {
+		// an edge for each listed ID at most
+		OpEdgeByIdSeek *seek = (OpEdgeByIdSeek *)op;
+		double ids = array_len(seek->ids);
+		records = _Scan(op, input, 1, ids);
+		break;
+	}
+	case OPType_NODE_BY_ID_SEEK: {
+		NodeByIdSeek *seek = (NodeByIdSeek *)op;
+		double ids = (seek->maxId >= seek->minId) ? (double)(seek->maxId - seek->minId) + 1 : 0;
+		records = _Scan(op, input, 1, _Min(ids, ctx->node_count));
+		break;
+	}
+	case OPType_CONDITIONAL_TRAVERSE:
+		records = _TraverseRecords(ctx, ((OpCondTraverse *)op)->ae, input);
+		op->estimate.cost = input + records;
+		break;
+	case OPType_CONDITIONAL_VAR_LEN_TRAVERSE:
+	case OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO: {
+		CondVarLenTraverse *traverse = (CondVarLenTraverse *)op;
+		records = _TraverseRecords(ctx, traverse->ae, input);
+		// both ends are resolved, a single destination may match
+		if(traverse->expandInto) records /= ctx->node_count;
+		op->estimate.cost = input + records;
+		break;
+	}
+	case OPType_EXPAND_INTO:
+		records = _TraverseRecords(ctx, ((OpExpandInto *)op)->ae, input) / ctx->node_count;
+		op->estimate.cost = input + records;
+		break;
+	case OPType_EXPAND_INTERSECT: {
+		OpExpandIntersect *intersect = (OpExpandIntersect *)op;
+		records = _TraverseRecords(ctx, intersect->ae, input) *
+				  PlanEstimate_ExpDensity(ctx, intersect->into_ae);
+		op->estimate.cost = input + records;
+		break;
+	}
+	case OPType_FILTER: {
+		FT_FilterNode *filter = ((OpFilter *)op)->filterTree;
+		records = input * FilterTree_EstimateSelectivity(filter);
+		op->estimate.cost = input;
+		break;
+	}
+	case OPType_AGGREGATE: {
+		OpAggregate *aggregate = (OpAggregate *)op;
+		records = (aggregate->key_count == 0) ? 1 : _Max(input * GROUP_FRACTION, _Min(input, 1));
+		op->estimate.cost = input + records;
+		break;
+	}
+	case OPType_SORT: {
+		OpSort *sort = (OpSort *)op;
+		records = _Max(input - sort->skip, 0);
+		if(sort->limit != UNLIMITED) records = _Min(records, sort->limit);
+		op->estimate.cost = input * log2(_Max(input, 2)) * ESTIMATE_SCAN_COST + records;
+		break;
+	}
+	case OPType_SKIP:
+		records = _Max(input - ((OpSkip *)op)->skip, 0);
+		break;
+	case OPType_LIMIT:
+		records = _Min(input, ((OpLimit *)op)->limit);
+		break;
+	case OPType_DISTINCT:
+		records = input * DISTINCT_FRACTION;
+		op->estimate.cost = input;
+		break;
+	case OPType_UNWIND:
+		records = input * _ListLength(((OpUnwind *)op)->exp);
+		op->estimate.cost = records;
+		break;
+	case OPType_PROC_CALL:
+		// procedures commonly yield a row per node
+		records = input * ctx->node_count;
+		op->estimate.cost = records;
+		break;
+	case OPType_ARGUMENT:
+		records = arg;
+		op->estimate.cost = 0;
+		break;
+	case OPType_CARTESIAN_PRODUCT:
+		records = 1;
+		for(int i = 0; i < op->childCount; i++) records *= children[i];
+		op->estimate.cost = records;
+		break;
+	case OPType_VALUE_HASH_JOIN: {
+		// each record of the smaller side is expected to match a record
+		double lhs = children[0];
+		double rhs = children[1];
+		records = _Min(lhs, rhs);
+		op->estimate.cost = lhs + rhs + records;
+		break;
+	}
+	case OPType_JOIN:
+		records = 0;
+		for(int i = 0; i < op->childCount; i++) records += children[i];
+		break;
+	case OPType_APPLY:
+		records = children[1];
+		op->estimate.cost = 0;
+		break;
+	case OPType_SEMI_APPLY:
+	case OPType_ANTI_SEMI_APPLY:
+	case OPType_OR_APPLY_MULTIPLEXER:
+	case OPType_AND_APPLY_MULTIPLEXER:
+		records = input * SEMI_APPLY_SELECTIVITY;
+		op->estimate.cost = 0;
+		break;
+	case OPType_OPTIONAL:
+		records = _Max(input, arg);
+		op->estimate.cost = 0;
+		break;
+	case OPType_MERGE:
+		// a record for every bound record, or a single record otherwise
+		records = (op->childCount == 3) ? children[0] : _Max(input, 1);
+		op->estimate.cost = records;
+		break;
+	default:
+		// projections, results and updates produce a record per input record
+		break;
+	}
+
+	records = _Min(_Max(records, 0), DBL_MAX);
+	op->estimate.records = records;
+	return records;
+}
+
+// returns the sum of the own costs of op and its children
+static double _TotalCost(const OpBase *op) {
+	double cost = op->estimate.cost;
+	for(int i = 0; i < op->childCount; i++) cost += _TotalCost(op->children[i]);
+	return cost;
+}
+
+// converts own costs into shares of total
+static void _CostShare(OpBase *op, double total) {
+	op->estimate.cost = (total > 0) ? (op->estimate.cost / total) * 100 : 0;
+	for(int i = 0; i < op->childCount; i++) _CostShare(op->children[i], total);
+}
+
+double ExecutionPlan_Estimate(ExecutionPlan *plan) {
+	ASSERT(plan != NULL && plan->root != NULL);
+
+	PlanEstimateCtx ctx;
+	PlanEstimate_InitCtx(&ctx, plan->query_graph);
+
+	_Estimate(&ctx, plan->root, 1);
+	double total = _TotalCost(plan->root);
+	_CostShare(plan->root, total);
+	return total;
+}
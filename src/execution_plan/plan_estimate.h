@@ -0,0 +1,89 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "execution_plan.h"
+#include "plan_feedback.h"
+#include "../graph/query_graph.h"
+#include "../graph/graphcontext.h"
+#include "../arithmetic/algebraic_expression.h"
+
+// Cardinality estimates, derived from label and relationship-type entity
+// counts under a uniform distribution of edges.
+// Both the traversal planner and EXPLAIN rely on these estimates,
+// such that EXPLAIN reports the figures the planner acted on.
+
+#define ESTIMATE_FILTER_SELECTIVITY 0.1  // Fraction of entities expected to pass a node's filters.
+#define ESTIMATE_SCAN_COST 0.1           // Cost of scanning an entity, relative to producing a record.
+
+// graph statistics estimates are derived from
+typedef struct {
+	GraphContext *gc;   // Graph context, NULL if statistics are unavailable.
+	QueryGraph *qg;     // Query graph, describes variable length edges, may be NULL.
+	double node_count;  // Number of nodes in the graph, at least 1.
+	const PlanFeedback *feedback;  // Observed cardinalities, NULL if none were observed.
+} PlanEstimateCtx;
+
+// sets the cardinalities observed by an execution of the plan being built
+// on the calling thread, estimates rely on them until cleared by passing NULL
+void PlanEstimate_SetFeedback
+(
+	const PlanFeedback *feedback  // observed cardinalities, may be NULL
+);
+
+// initialize an estimation context over the current query's graph
+void PlanEstimate_InitCtx
+(
+	PlanEstimateCtx *ctx,  // context to initialize
+	QueryGraph *qg         // query graph, may be NULL
+);
+
+// returns the number of nodes carrying label, all nodes if label is NULL
+double PlanEstimate_LabelCardinality
+(
+	const PlanEstimateCtx *ctx,  // estimation context
+	const char *label            // label, may be NULL
+);
+
+// returns the number of edges of relationship type,
+// every edge if reltype is NULL
+double PlanEstimate_RelationCardinality
+(
+	const PlanEstimateCtx *ctx,  // estimation context
+	const char *reltype          // relationship type, may be NULL
+);
+
+// returns the fraction of alias' entities expected to pass its filters
+double PlanEstimate_FilterSelectivity
+(
+	const PlanEstimateCtx *ctx,  // estimation context
+	const char *alias,           // node alias
+	bool filtered                // whether the node is filtered
+);
+
+// returns the fraction of node pairs connected by traversing exp
+// as observed by a previous execution if available, see PlanEstimate_ExpDensity
+double PlanEstimate_TraversalDensity
+(
+	const PlanEstimateCtx *ctx,     // estimation context
+	const AlgebraicExpression *exp  // traversal expression
+);
+
+// returns the fraction of node pairs connected by exp
+double PlanEstimate_ExpDensity
+(
+	const PlanEstimateCtx *ctx,     // estimation context
+	const AlgebraicExpression *exp  // expression
+);
+
+// annotates each operation of plan with the number of records it is
+// expected to produce and its share of the plan's estimated cost
+// see OpBase.estimate, returns the plan's estimated cost
+double ExecutionPlan_Estimate
+(
+	ExecutionPlan *plan  // plan to estimate
+);
@@ -0,0 +1,209 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "plan_feedback.h"
+#include "RG.h"
+#include "plan_estimate.h"
+#include "./ops/ops.h"
+#include "../util/rmalloc.h"
+#include "../filter_tree/filter_tree.h"
+#include <string.h>
+
+// operations producing fewer records, either estimated or actual,
+// are too small for their misestimate to matter
+#define REPLAN_MIN_RECORDS 1000
+
+static inline double _Max(double a, double b) {
+	return (a > b) ? a : b;
+}
+
+static inline double _Min(double a, double b) {
+	return (a < b) ? a : b;
+}
+
+// returns true if op's output size is decided by the graph's statistics
+static bool _Estimated(const OpBase *op) {
+	switch(op->type) {
+		case OPType_ALL_NODE_SCAN:
+		case OPType_NODE_BY_LABEL_SCAN:
+		case OPType_NODE_BY_LABEL_AND_ID_SCAN:
+		case OPType_INDEX_SCAN:
+		case OPType_EDGE_INDEX_SCAN:
+		case OPType_EDGE_BY_TYPE_SCAN:
+		case OPType_CONDITIONAL_TRAVERSE:
+		case OPType_CONDITIONAL_VAR_LEN_TRAVERSE:
+		case OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO:
+		case OPType_EXPAND_INTO:
+		case OPType_EXPAND_INTERSECT:
+		case OPType_FILTER:
+		case OPType_AGGREGATE:
+		case OPType_VALUE_HASH_JOIN:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool _Misestimated(const OpBase *op, double threshold) {
+	if(_Estimated(op) && op->stats != NULL && op->estimate.records >= 0) {
+		double actual = op->stats->profileRecordCount;
+		double estimate = op->estimate.records;
+		if(_Max(actual, estimate) >= REPLAN_MIN_RECORDS &&
+		   _Max(actual, estimate) >= _Max(_Min(actual, estimate), 1) * threshold) {
+			return true;
+		}
+	}
+
+	for(int i = 0; i < op->childCount; i++) {
+		if(_Misestimated(op->children[i], threshold)) return true;
+	}
+	return false;
+}
+
+bool PlanFeedback_Misestimated(const ExecutionPlan *plan, double threshold) {
+	ASSERT(plan != NULL);
+	ASSERT(threshold > 1);
+	return _Misestimated(plan->root, threshold);
+}
+
+// returns the number of records op consumed
+static double _Input(const OpBase *op) {
+	// scans without children operate on a single implicit record
+	if(op->childCount == 0) return 1;
+	const OpBase *child = op->children[0];
+	return (child->stats) ? child->stats->profileRecordCount : 0;
+}
+
+// multiplies the value stored under key by v, storing v if missing
+static void _Observe(rax *observed, const char *key, size_t len, double v) {
+	double *stored = raxFind(observed, (unsigned char *)key, len);
+	if(stored == raxNotFound) {
+		stored = rm_malloc(sizeof(double));
+		*stored = 1;
+		raxInsert(observed, (unsigned char *)key, len, stored, NULL);
+	}
+	*stored *= v;
+}
+
+// writes the key of the traversal between src and dest into key
+// traversals are keyed by their endpoints, regardless of their direction
+static size_t _DensityKey(char *key, size_t size, const char *src, const char *dest) {
+	if(strcmp(src, dest) > 0) {
+		const char *tmp = src;
+		src = dest;
+		dest = tmp;
+	}
+	int len = snprintf(key, size, "%s|%s", src, dest);
+	return _Min(len, size - 1);
+}
+
+static void _ObserveDensity(PlanFeedback *feedback, const AlgebraicExpression *ae,
+		double density) {
+	char key[512];
+	size_t len = _DensityKey(key, sizeof(key),
+			AlgebraicExpression_Source((AlgebraicExpression *)ae),
+			AlgebraicExpression_Destination((AlgebraicExpression *)ae));
+	// repeated traversals between the same nodes are observed once
+	if(raxFind(feedback->density, (unsigned char *)key, len) != raxNotFound) return;
+	_Observe(feedback->density, key, len, density);
+}
+
+static void _Collect(PlanFeedback *feedback, const PlanEstimateCtx *ctx, const OpBase *op) {
+	for(int i = 0; i < op->childCount; i++) _Collect(feedback, ctx, op->children[i]);
+
+	if(op->stats == NULL) return;
+	double input = _Input(op);
+	double records = op->stats->profileRecordCount;
+	if(input <= 0) return;
+
+	switch(op->type) {
+	case OPType_FILTER: {
+		// filters of a single node determine its selectivity
+		rax *aliases = FilterTree_CollectModified(((OpFilter *)op)->filterTree);
+		if(raxSize(aliases) == 1) {
+			raxIterator it;
+			raxStart(&it, aliases);
+			raxSeek(&it, "^", NULL, 0);
+			raxNext(&it);
+			_Observe(feedback->selectivity, (const char *)it.key, it.key_len,
+					records / input);
+			raxStop(&it);
+		}
+		raxFree(aliases);
+		break;
+	}
+	case OPType_INDEX_SCAN: {
+		// an index lookup yields the entities passing the node's indexed filters
+		IndexScan *scan = (IndexScan *)op;
+		double label = PlanEstimate_LabelCardinality(ctx, scan->n.label);
+		_Observe(feedback->selectivity, scan->n.alias, strlen(scan->n.alias),
+				_Min(records / (input * label), 1));
+		break;
+	}
+	case OPType_CONDITIONAL_TRAVERSE:
+		// each input record resolves the traversal's source
+		_ObserveDensity(feedback, ((OpCondTraverse *)op)->ae,
+				records / (input * ctx->node_count));
+		break;
+	case OPType_CONDITIONAL_VAR_LEN_TRAVERSE:
+		_ObserveDensity(feedback, ((CondVarLenTraverse *)op)->ae,
+				records / (input * ctx->node_count));
+		break;
+	case OPType_CONDITIONAL_VAR_LEN_TRAVERSE_EXPAND_INTO:
+		// both ends are resolved by each input record
+		_ObserveDensity(feedback, ((CondVarLenTraverse *)op)->ae, records / input);
+		break;
+	case OPType_EXPAND_INTO:
+		_ObserveDensity(feedback, ((OpExpandInto *)op)->ae, records / input);
+		break;
+	default:
+		break;
+	}
+}
+
+PlanFeedback *PlanFeedback_Collect(const ExecutionPlan *plan) {
+	ASSERT(plan != NULL);
+
+	PlanEstimateCtx ctx;
+	PlanEstimate_InitCtx(&ctx, plan->query_graph);
+
+	PlanFeedback *feedback = rm_malloc(sizeof(PlanFeedback));
+	feedback->selectivity = raxNew();
+	feedback->density = raxNew();
+	_Collect(feedback, &ctx, plan->root);
+
+	return feedback;
+}
+
+bool PlanFeedback_Selectivity(const PlanFeedback *feedback, const char *alias,
+		double *sel) {
+	ASSERT(feedback != NULL && alias != NULL);
+
+	double *observed = raxFind(feedback->selectivity, (unsigned char *)alias,
+			strlen(alias));
+	if(observed == raxNotFound) return false;
+	*sel = *observed;
+	return true;
+}
+
+bool PlanFeedback_Density(const PlanFeedback *feedback, const char *src,
+		const char *dest, double *density) {
+	ASSERT(feedback != NULL && src != NULL && dest != NULL);
+
+	char key[512];
+	size_t len = _DensityKey(key, sizeof(key), src, dest);
+	double *observed = raxFind(feedback->density, (unsigned char *)key, len);
+	if(observed == raxNotFound) return false;
+	*density = *observed;
+	return true;
+}
+
+void PlanFeedback_Free(PlanFeedback *feedback) {
+	if(feedback == NULL) return;
+	raxFreeWithCallback(feedback->selectivity, rm_free);
+	raxFreeWithCallback(feedback->density, rm_free);
+	rm_free(feedback);
+}
@@ -0,0 +1,66 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "rax.h"
+#include <stdbool.h>
+
+struct ExecutionPlan;
+
+// Cardinalities observed by a sampled execution of a cached plan.
+// Once an operation of a sampled plan produces REPLAN_THRESHOLD times more
+// or fewer records than estimated, the plan is built anew, its planner
+// relying on the observed figures rather than on uniform distribution
+// estimates, see PlanEstimate_SetFeedback.
+//
+// Two figures are observed:
+// the fraction of a node's entities passing its filters, and
+// the fraction of node pairs connected by a traversal's expression.
+
+typedef struct {
+	rax *selectivity;  // Node alias to observed filter selectivity.
+	rax *density;      // Traversal endpoints to observed expression density.
+} PlanFeedback;
+
+// returns true if an operation of the sampled plan produced at least
+// threshold times more or fewer records than estimated, see ExecutionPlan_Estimate
+bool PlanFeedback_Misestimated
+(
+	const struct ExecutionPlan *plan,  // sampled and estimated plan
+	double threshold                   // misestimate ratio
+);
+
+// collects the cardinalities observed by the sampled plan
+PlanFeedback *PlanFeedback_Collect
+(
+	const struct ExecutionPlan *plan  // sampled plan
+);
+
+// sets sel to the observed fraction of alias' entities passing its filters
+// returns false if none was observed
+bool PlanFeedback_Selectivity
+(
+	const PlanFeedback *feedback,  // observed cardinalities
+	const char *alias,             // node alias
+	double *sel                    // [output] selectivity
+);
+
+// sets density to the observed fraction of node pairs connected by
+// the traversal between src and dest, in either direction
+// returns false if none was observed
+bool PlanFeedback_Density
+(
+	const PlanFeedback *feedback,  // observed cardinalities
+	const char *src,               // traversal source alias
+	const char *dest,              // traversal destination alias
+	double *density                // [output] density
+);
+
+void PlanFeedback_Free
+(
+	PlanFeedback *feedback
+);
@@ -0,0 +1,164 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "plan_stats.h"
+#include "../RG.h"
+#include "../config.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include <inttypes.h>
+
+PlanStats *PlanStats_New(void) {
+	PlanStats *stats = rm_malloc(sizeof(PlanStats));
+	stats->executions = 0;
+	stats->samples = 0;
+	stats->replans = 0;
+	stats->ops = array_new(PlanStatsOp, 0);
+	pthread_mutex_init(&stats->lock, NULL);
+	return stats;
+}
+
+bool PlanStats_ShouldSample(PlanStats *stats) {
+	ASSERT(stats != NULL);
+
+	uint64_t rate;
+	Config_Option_get(Config_PLAN_STATS_SAMPLE_RATE, &rate);
+
+	uint64_t executions = __atomic_add_fetch(&stats->executions, 1,
+			__ATOMIC_RELAXED);
+	// the first execution is always sampled
+	return rate != 0 && (executions - 1) % rate == 0;
+}
+
+// operation string representation, excluding profiling statistics
+static char *_PlanStats_OpString(const OpBase *op) {
+	char buff[1024];
+	if(op->toString) op->toString(op, buff, sizeof(buff));
+	else snprintf(buff, sizeof(buff), "%s", op->name);
+	return rm_strdup(buff);
+}
+
+static void _PlanStats_CollectOps(const OpBase *op, uint depth, PlanStatsOp **ops) {
+	PlanStatsOp s = {
+		.op       =  NULL,
+		.depth    =  depth,
+		.records  =  op->stats->profileRecordCount,
+		.time     =  op->stats->profileExecTime,
+		.memory   =  op->stats->sampleMemory
+	};
+	*ops = array_append(*ops, s);
+
+	for(int i = 0; i < op->childCount; i++) {
+		_PlanStats_CollectOps(op->children[i], depth + 1, ops);
+	}
+}
+
+static void _PlanStats_NameOps(const OpBase *op, PlanStatsOp *ops, uint *idx) {
+	ops[(*idx)++].op = _PlanStats_OpString(op);
+	for(int i = 0; i < op->childCount; i++) {
+		_PlanStats_NameOps(op->children[i], ops, idx);
+	}
+}
+
+static void _PlanStats_ClearOps(PlanStats *stats) {
+	uint count = array_len(stats->ops);
+	for(uint i = 0; i < count; i++) rm_free(stats->ops[i].op);
+	array_clear(stats->ops);
+	stats->samples = 0;
+}
+
+void PlanStats_Add(PlanStats *stats, const ExecutionPlan *plan) {
+	ASSERT(stats != NULL);
+	ASSERT(plan != NULL);
+
+	// collect outside of the lock
+	PlanStatsOp *sample = array_new(PlanStatsOp, 16);
+	_PlanStats_CollectOps(plan->root, 0, &sample);
+	uint count = array_len(sample);
+
+	pthread_mutex_lock(&stats->lock);
+
+	// plans sharing a cache entry are clones of one another
+	// restart aggregation if the plan's shape differs nonetheless
+	bool match = (array_len(stats->ops) == count);
+	for(uint i = 0; match && i < count; i++) {
+		match = (stats->ops[i].depth == sample[i].depth);
+	}
+
+	if(!match) {
+		_PlanStats_ClearOps(stats);
+		uint idx = 0;
+		_PlanStats_NameOps(plan->root, sample, &idx);
+		for(uint i = 0; i < count; i++) {
+			PlanStatsOp s = sample[i];
+			s.records = 0;
+			s.time = 0;
+			s.memory = 0;
+			stats->ops = array_append(stats->ops, s);
+		}
+	}
+
+	for(uint i = 0; i < count; i++) {
+		stats->ops[i].records += sample[i].records;
+		stats->ops[i].time += sample[i].time;
+		stats->ops[i].memory += sample[i].memory;
+	}
+	stats->samples++;
+
+	pthread_mutex_unlock(&stats->lock);
+
+	array_free(sample);
+}
+
+void PlanStats_Replanned(PlanStats *stats) {
+	ASSERT(stats != NULL);
+
+	pthread_mutex_lock(&stats->lock);
+	_PlanStats_ClearOps(stats);
+	stats->replans++;
+	pthread_mutex_unlock(&stats->lock);
+}
+
+void PlanStats_Reply(PlanStats *stats, RedisModuleCtx *ctx) {
+	ASSERT(stats != NULL);
+	ASSERT(ctx != NULL);
+
+	char buff[1280];
+	pthread_mutex_lock(&stats->lock);
+
+	uint count = array_len(stats->ops);
+	uint64_t samples = stats->samples;
+
+	RedisModule_ReplyWithArray(ctx, 8);
+	RedisModule_ReplyWithSimpleString(ctx, "executions");
+	RedisModule_ReplyWithLongLong(ctx,
+			__atomic_load_n(&stats->executions, __ATOMIC_RELAXED));
+	RedisModule_ReplyWithSimpleString(ctx, "samples");
+	RedisModule_ReplyWithLongLong(ctx, samples);
+	RedisModule_ReplyWithSimpleString(ctx, "replanned");
+	RedisModule_ReplyWithLongLong(ctx, stats->replans);
+	RedisModule_ReplyWithSimpleString(ctx, "operations");
+	RedisModule_ReplyWithArray(ctx, count);
+	for(uint i = 0; i < count; i++) {
+		const PlanStatsOp *s = stats->ops + i;
+		int len = snprintf(buff, sizeof(buff),
+				"%*s%s | Records produced: %.1f, Execution time: %f ms, Memory: %" PRId64 " bytes",
+				s->depth * 4, "", s->op, (double)s->records / samples,
+				s->time / samples, s->memory / (int64_t)samples);
+		if(len >= (int)sizeof(buff)) len = sizeof(buff) - 1;
+		RedisModule_ReplyWithStringBuffer(ctx, buff, len);
+	}
+
+	pthread_mutex_unlock(&stats->lock);
+}
+
+void PlanStats_Free(PlanStats *stats) {
+	if(stats == NULL) return;
+	_PlanStats_ClearOps(stats);
+	array_free(stats->ops);
+	pthread_mutex_destroy(&stats->lock);
+	rm_free(stats);
+}
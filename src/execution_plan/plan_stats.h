@@ -0,0 +1,68 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "execution_plan.h"
+#include "../redismodule.h"
+#include <pthread.h>
+
+// statistics of a single operation, aggregated over sampled executions
+typedef struct {
+	char *op;             // operation string representation
+	uint depth;           // operation depth within the plan
+	uint64_t records;     // number of records produced
+	double time;          // execution time, in milliseconds
+	int64_t memory;       // number of bytes allocated
+} PlanStatsOp;
+
+// per-operation statistics of a cached execution plan
+// one in every PLAN_STATS_SAMPLE_RATE executions of the plan is sampled
+// operations are ordered as the plan is printed, depth first
+typedef struct {
+	uint64_t executions;   // number of executions
+	uint64_t samples;      // number of sampled executions
+	uint64_t replans;      // number of times the plan was built anew
+	PlanStatsOp *ops;      // operations statistics
+	pthread_mutex_t lock;  // protects 'samples' and 'ops'
+} PlanStats;
+
+// create new, empty plan statistics
+PlanStats *PlanStats_New(void);
+
+// accounts for an execution of the plan
+// returns true if the execution should be sampled
+bool PlanStats_ShouldSample
+(
+	PlanStats *stats  // plan statistics
+);
+
+// aggregates the statistics of a sampled plan which finished executing
+void PlanStats_Add
+(
+	PlanStats *stats,           // plan statistics
+	const ExecutionPlan *plan   // sampled plan, see ExecutionPlan_FinalizeSampling
+);
+
+// accounts for the plan being built anew, see REPLAN_THRESHOLD
+// statistics of the replaced plan are discarded
+void PlanStats_Replanned
+(
+	PlanStats *stats  // plan statistics
+);
+
+// replies with the plan's statistics, averaged over sampled executions
+void PlanStats_Reply
+(
+	PlanStats *stats,     // plan statistics
+	RedisModuleCtx *ctx   // redis module context
+);
+
+// free plan statistics
+void PlanStats_Free
+(
+	PlanStats *stats  // plan statistics
+);
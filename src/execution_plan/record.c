@@ -9,13 +9,31 @@
 #include "./record.h"
 #include "../util/rmalloc.h"
 
+// Returns the entry at position idx, either set by r or shared with its parent.
+static inline Entry *_RecordEntry(const Record r, uint idx) {
+	Record rec = r;
+	while(rec->entries[idx].type == REC_TYPE_UNKNOWN && rec->parent) rec = rec->parent;
+	return rec->entries + idx;
+}
+
+/* Copies an entry shared with r's parent into r,
+ * the parent retains ownership of scalar allocations. */
+static inline Entry *_RecordOwnEntry(Record r, uint idx) {
+	Entry *e = r->entries + idx;
+	if(e->type != REC_TYPE_UNKNOWN || r->parent == NULL) return e;
+
+	*e = *_RecordEntry(r->parent, idx);
+	if(e->type == REC_TYPE_SCALAR) SIValue_MakeVolatile(&e->value.s);
+	return e;
+}
+
 /* Migrate the entry at the given index in the source Record at the same index in the destination.
  * The source retains access to but not ownership of the entry if it is a heap allocation. */
 static void _RecordPropagateEntry(Record dest, Record src, uint idx) {
-	Entry e = src->entries[idx];
-	dest->entries[idx] = e;
+	Entry *e = _RecordOwnEntry(src, idx);
+	dest->entries[idx] = *e;
 	// If the entry is a scalar, make sure both Records don't believe they own the allocation.
-	if(e.type == REC_TYPE_SCALAR) SIValue_MakeVolatile(&src->entries[idx].value.s);
+	if(e->type == REC_TYPE_SCALAR) SIValue_MakeVolatile(&e->value.s);
 }
 
 // This function is currently unused.
@@ -28,6 +46,8 @@ Record Record_New(rax *mapping) {
 
 	Record r = rm_calloc(1, rec_size);
 	r->mapping = mapping;
+	r->ref_count = 1;
+	r->length = entries_count;
 
 	return r;
 }
@@ -35,12 +55,12 @@ Record Record_New(rax *mapping) {
 // Returns the number of entries held by record.
 uint Record_length(const Record r) {
 	ASSERT(r);
-	return raxSize(r->mapping);
+	return r->length;
 }
 
 bool Record_ContainsEntry(const Record r, uint idx) {
 	ASSERT(idx < Record_length(r));
-	return r->entries[idx].type != REC_TYPE_UNKNOWN;
+	return Record_GetType(r, idx) != REC_TYPE_UNKNOWN;
 }
 
 // Retrieve the offset into the Record of the given alias.
@@ -56,7 +76,16 @@ void Record_Clone(const Record r, Record clone) {
 	int entry_count = Record_length(r);
 	size_t required_record_size = sizeof(Entry) * entry_count;
 
-	memcpy(clone->entries, r->entries, required_record_size);
+	if(r->parent == NULL) {
+		memcpy(clone->entries, r->entries, required_record_size);
+	} else {
+		for(int i = 0; i < entry_count; i++) {
+			clone->entries[i] = *_RecordEntry(r, i);
+			if(clone->entries[i].type == REC_TYPE_REMOVED) {
+				clone->entries[i].type = REC_TYPE_UNKNOWN;
+			}
+		}
+	}
 
 	/* Foreach scalar entry in cloned record, make sure it is not freed.
 	 * it is the original record owner responsibility to free the record
@@ -71,13 +100,21 @@ void Record_Clone(const Record r, Record clone) {
 	}
 }
 
+void Record_Share(Record r, Record shared) {
+	ASSERT(r->owner == shared->owner);
+	ASSERT(shared->parent == NULL);
+
+	shared->parent = r;
+	r->ref_count++;
+}
+
 void Record_Merge(Record a, const Record b) {
 	ASSERT(a->owner == b->owner);
 	uint len = Record_length(a);
 
 	for(uint i = 0; i < len; i++) {
-		RecordEntryType a_type = a->entries[i].type;
-		RecordEntryType b_type = b->entries[i].type;
+		RecordEntryType a_type = Record_GetType(a, i);
+		RecordEntryType b_type = Record_GetType(b, i);
 
 		if(a_type == REC_TYPE_UNKNOWN && b_type != REC_TYPE_UNKNOWN) {
 			_RecordPropagateEntry(a, b, i);
@@ -88,25 +125,35 @@ void Record_Merge(Record a, const Record b) {
 void Record_TransferEntries(Record *to, Record from) {
 	uint len = Record_length(from);
 	for(uint i = 0; i < len; i++) {
-		if(from->entries[i].type != REC_TYPE_UNKNOWN) {
+		if(Record_GetType(from, i) != REC_TYPE_UNKNOWN) {
 			_RecordPropagateEntry(*to, from, i);
 		}
 	}
 }
 
 RecordEntryType Record_GetType(const Record r, uint idx) {
-	return r->entries[idx].type;
+	RecordEntryType t = _RecordEntry(r, idx)->type;
+	return (t == REC_TYPE_REMOVED) ? REC_TYPE_UNKNOWN : t;
+}
+
+Entry *Record_GetEntry(Record r, uint idx) {
+	Entry *e = _RecordOwnEntry(r, idx);
+	if(e->type == REC_TYPE_REMOVED) e->type = REC_TYPE_UNKNOWN;
+	return e;
 }
 
 Node *Record_GetNode(const Record r, uint idx) {
-	switch(r->entries[idx].type) {
+	// Nodes are handed out by reference, copy shared entries.
+	Entry *e = _RecordOwnEntry(r, idx);
+	switch(e->type) {
 		case REC_TYPE_NODE:
-			return &(r->entries[idx].value.n);
+			return &(e->value.n);
 		case REC_TYPE_UNKNOWN:
+		case REC_TYPE_REMOVED:
 			return NULL;
 		case REC_TYPE_SCALAR:
 			// Null scalar values are expected here; otherwise fall through.
-			if(SIValue_IsNull(r->entries[idx].value.s)) return NULL;
+			if(SIValue_IsNull(e->value.s)) return NULL;
 		default:
 			ASSERT("encountered unexpected type in Record; expected Node" && false);
 			return NULL;
@@ -114,14 +161,17 @@ Node *Record_GetNode(const Record r, uint idx) {
 }
 
 Edge *Record_GetEdge(const Record r, uint idx) {
-	switch(r->entries[idx].type) {
+	// Edges are handed out by reference, copy shared entries.
+	Entry *e = _RecordOwnEntry(r, idx);
+	switch(e->type) {
 		case REC_TYPE_EDGE:
-			return &(r->entries[idx].value.e);
+			return &(e->value.e);
 		case REC_TYPE_UNKNOWN:
+		case REC_TYPE_REMOVED:
 			return NULL;
 		case REC_TYPE_SCALAR:
 			// Null scalar values are expected here; otherwise fall through.
-			if(SIValue_IsNull(r->entries[idx].value.s)) return NULL;
+			if(SIValue_IsNull(e->value.s)) return NULL;
 		default:
 			ASSERT("encountered unexpected type in Record; expected Edge" && false);
 			return NULL;
@@ -129,15 +179,17 @@ Edge *Record_GetEdge(const Record r, uint idx) {
 }
 
 SIValue Record_Get(Record r, uint idx) {
-	Entry e = r->entries[idx];
-	switch(e.type) {
+	Entry *e = _RecordEntry(r, idx);
+	switch(e->type) {
 		case REC_TYPE_NODE:
 			return SI_Node(Record_GetNode(r, idx));
 		case REC_TYPE_EDGE:
 			return SI_Edge(Record_GetEdge(r, idx));
 		case REC_TYPE_SCALAR:
-			return r->entries[idx].value.s;
+			// Scalars shared with the parent remain owned by it.
+			return (e == r->entries + idx) ? e->value.s : SI_ShareValue(e->value.s);
 		case REC_TYPE_UNKNOWN:
+		case REC_TYPE_REMOVED:
 			return SI_NullVal();
 		default:
 			ASSERT(false);
@@ -146,12 +198,13 @@ SIValue Record_Get(Record r, uint idx) {
 }
 
 void Record_Remove(Record r, uint idx) {
-	r->entries[idx].type = REC_TYPE_UNKNOWN; 
+	// Hide the entry if the parent sets it.
+	bool shared = (r->parent && Record_ContainsEntry(r->parent, idx));
+	r->entries[idx].type = (shared) ? REC_TYPE_REMOVED : REC_TYPE_UNKNOWN;
 }
 
 GraphEntity *Record_GetGraphEntity(const Record r, uint idx) {
-	Entry e = r->entries[idx];
-	switch(e.type) {
+	switch(Record_GetType(r, idx)) {
 		case REC_TYPE_NODE:
 			return (GraphEntity *)Record_GetNode(r, idx);
 		case REC_TYPE_EDGE:
@@ -198,7 +251,9 @@ Edge *Record_AddEdge(Record r, uint idx, Edge edge) {
 void Record_PersistScalars(Record r) {
 	uint len = Record_length(r);
 	for(uint i = 0; i < len; i++) {
-		if(r->entries[i].type == REC_TYPE_SCALAR) SIValue_Persist(&r->entries[i].value.s);
+		if(Record_GetType(r, i) != REC_TYPE_SCALAR) continue;
+		// Shared scalars are copied into the record.
+		SIValue_Persist(&Record_GetEntry(r, i)->value.s);
 	}
 }
 
@@ -250,15 +305,17 @@ unsigned long long Record_Hash64(const Record r) {
 
 inline void Record_FreeEntry(Record r, int idx) {
 	if(r->entries[idx].type == REC_TYPE_SCALAR) SIValue_Free(r->entries[idx].value.s);
-	r->entries[idx].type = REC_TYPE_UNKNOWN;
+	Record_Remove(r, idx);
 }
 
 void Record_FreeEntries(Record r) {
 	uint length = Record_length(r);
 	for(uint i = 0; i < length; i++) {
 		// Free any allocations held by this Record.
-		Record_FreeEntry(r, i);
+		if(r->entries[i].type == REC_TYPE_SCALAR) SIValue_Free(r->entries[i].value.s);
 	}
+	// Clear all entries at once, REC_TYPE_UNKNOWN is zero.
+	memset(r->entries, 0, sizeof(Entry) * length);
 }
 
 // This function is currently unused.
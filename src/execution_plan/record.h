@@ -21,6 +21,7 @@ typedef enum  {
 	REC_TYPE_NODE = 1 << 1,
 	REC_TYPE_EDGE = 1 << 2,
 	REC_TYPE_HEADER = 1 << 3,
+	REC_TYPE_REMOVED = 1 << 4,  // Hides the parent's entry, reported as REC_TYPE_UNKNOWN.
 } RecordEntryType;
 
 typedef struct {
@@ -32,10 +33,17 @@ typedef struct {
 	RecordEntryType type;
 } Entry;
 
-typedef struct {
-	void *owner;        // Owner of record.
-	rax *mapping;       // Mapping between alias to record entry.
-	Entry entries[];    // Array of entries.
+/* A record may share the entries of a parent record rather than copying them,
+ * entries the record doesn't set are read from its parent. Writes always go
+ * to the record's own entries, the parent is never modified through it.
+ * A parent is kept alive by the records sharing it. */
+typedef struct _Record {
+	void *owner;                // Owner of record.
+	rax *mapping;               // Mapping between alias to record entry.
+	struct _Record *parent;     // Record whose entries are shared, NULL if none.
+	uint ref_count;             // Number of records sharing this record, plus one.
+	uint length;                // Number of entries, as sized by mapping.
+	Entry entries[];            // Array of entries.
 } _Record;
 
 typedef _Record *Record;
@@ -43,9 +51,13 @@ typedef _Record *Record;
 // Create a new record sized to accommodate all entries in the given map.
 Record Record_New(rax *mapping);
 
-// Clones record.
+// Clones record, copying entries shared with r's parent.
 void Record_Clone(const Record r, Record clone);
 
+// Sets 'shared' to read r's entries without copying them.
+// 'shared' must be empty, r must not be modified while shared.
+void Record_Share(Record r, Record shared);
+
 // Merge record b into a, sharing any nested references in b with a.
 void Record_Merge(Record a, const Record b);
 
@@ -64,6 +76,10 @@ uint Record_GetEntryIdx(Record r, const char *alias);
 // Get entry type.
 RecordEntryType Record_GetType(const Record r, uint idx);
 
+// Get the entry at position idx, owned by the record.
+// An entry shared with the record's parent is copied into the record.
+Entry *Record_GetEntry(Record r, uint idx);
+
 // Get a node from record at position idx.
 Node *Record_GetNode(const Record r, uint idx);
 
@@ -0,0 +1,87 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "record_pool.h"
+#include "../RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+
+// Rounds n up to a multiple of the record alignment.
+#define ALIGN_UP(n) \
+	(((n) + RECORD_POOL_ALIGNMENT - 1) & ~((size_t)RECORD_POOL_ALIGNMENT - 1))
+
+static void _RecordPool_AddSlab(RecordPool *pool) {
+	/* Over-allocate such that the first record starts on a cache line,
+	 * slab memory is zeroed as REC_TYPE_UNKNOWN marks an empty entry. */
+	size_t size = pool->record_size * RECORD_POOL_SLAB_CAP + RECORD_POOL_ALIGNMENT;
+	void *slab = rm_calloc(1, size);
+	array_append(pool->slabs, slab);
+
+	pool->slab = (char *)ALIGN_UP((uintptr_t)slab);
+	pool->slab_used = 0;
+}
+
+RecordPool *RecordPool_New(rax *mapping) {
+	ASSERT(mapping != NULL);
+
+	RecordPool *pool = rm_malloc(sizeof(RecordPool));
+	uint entries_count = raxSize(mapping);
+
+	pool->mapping        =  mapping;
+	pool->entries_count  =  entries_count;
+	pool->record_size    =  ALIGN_UP(sizeof(_Record) + (sizeof(Entry) * entries_count));
+	pool->slabs          =  array_new(void *, 1);
+	pool->released       =  array_new(Record, RECORD_POOL_SLAB_CAP);
+
+	_RecordPool_AddSlab(pool);
+	return pool;
+}
+
+Record RecordPool_Borrow(RecordPool *pool, void *owner) {
+	ASSERT(pool != NULL);
+
+	Record r;
+	if(array_len(pool->released) > 0) {
+		// released records were cleared on their return
+		r = array_pop(pool->released);
+	} else {
+		if(pool->slab_used == RECORD_POOL_SLAB_CAP) _RecordPool_AddSlab(pool);
+		r = (Record)(pool->slab + pool->record_size * pool->slab_used);
+		pool->slab_used++;
+	}
+
+	r->owner = owner;
+	r->mapping = pool->mapping;
+	r->parent = NULL;
+	r->ref_count = 1;
+	r->length = pool->entries_count;
+	return r;
+}
+
+void RecordPool_Return(RecordPool *pool, Record r) {
+	ASSERT(pool != NULL && r != NULL);
+
+	/* A record shared by other records is released along with the last of them,
+	 * releasing a record drops its reference to its parent. */
+	while(r != NULL && --r->ref_count == 0) {
+		Record parent = r->parent;
+		r->parent = NULL;
+		Record_FreeEntries(r);
+		array_append(pool->released, r);
+		r = parent;
+	}
+}
+
+void RecordPool_Free(RecordPool *pool) {
+	if(pool == NULL) return;
+
+	uint slab_count = array_len(pool->slabs);
+	for(uint i = 0; i < slab_count; i++) rm_free(pool->slabs[i]);
+	array_free(pool->slabs);
+	array_free(pool->released);
+	rm_free(pool);
+}
+
@@ -0,0 +1,45 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "record.h"
+#include <stdint.h>
+
+// Number of records in a slab.
+#define RECORD_POOL_SLAB_CAP 256
+
+// Records are laid out on cache line boundaries.
+#define RECORD_POOL_ALIGNMENT 64
+
+/* The RecordPool is a slab allocator for records sharing a single mapping.
+ * All records are sized once from the mapping, and handed out from
+ * contiguous slabs. Released records are cleared and kept for reuse,
+ * borrowing a record never zero-sets it. Not thread-safe. */
+typedef struct {
+	rax *mapping;         // Mapping shared by all records.
+	size_t record_size;   // Size of a single record in bytes.
+	uint entries_count;   // Number of entries in a single record.
+	void **slabs;         // Array of allocated slabs.
+	char *slab;           // Cache line aligned start of the last slab.
+	uint slab_used;       // Number of records handed out from the last slab.
+	Record *released;     // Array of cleared records, ready for reuse.
+} RecordPool;
+
+// Create a new RecordPool
+// mapping - alias to entry index mapping of the pool's records.
+RecordPool *RecordPool_New(rax *mapping);
+
+// Hand out an empty record, owned by 'owner'.
+Record RecordPool_Borrow(RecordPool *pool, void *owner);
+
+// Free record's entries and keep it for reuse,
+// once no other record shares its entries.
+void RecordPool_Return(RecordPool *pool, Record r);
+
+// Free pool and all of its records.
+void RecordPool_Free(RecordPool *pool);
+
@@ -6,6 +6,7 @@
 
 #include "filter_tree.h"
 #include "RG.h"
+#include "predicate_kernels.h"
 #include "../value.h"
 #include "../errors.h"
 #include "../util/arr.h"
@@ -89,7 +90,7 @@ FT_FilterNode *FilterTree_CreatePredicateFilter(AST_Operator op, AR_ExpNode *lhs
 }
 
 FT_FilterNode *FilterTree_CreateConditionFilter(AST_Operator op) {
-	FT_FilterNode *filterNode = rm_malloc(sizeof(FT_FilterNode));
+	FT_FilterNode *filterNode = rm_calloc(1, sizeof(FT_FilterNode));
 	filterNode->t = FT_N_COND;
 	filterNode->cond.op = op;
 	return filterNode;
@@ -253,6 +254,357 @@ int FilterTree_applyFilters(const FT_FilterNode *root, const Record r) {
 	return 0;
 }
 
+//------------------------------------------------------------------------------
+// Filter ordering
+//------------------------------------------------------------------------------
+
+// Estimated cost of evaluating a function, and of one handed private data,
+// e.g. list comprehensions and pattern comprehensions.
+#define FT_FUNCTION_COST 4
+#define FT_PRIVDATA_FUNCTION_COST 32
+// Number of records visiting an AND/OR node between reorder attempts.
+#define FT_REORDER_INTERVAL 4096
+
+// Estimated cost of evaluating an arithmetic expression.
+static double _FilterTree_ExpCost(const AR_ExpNode *exp) {
+	if(exp == NULL) return 0;
+	if(exp->type == AR_EXP_OPERAND) return AR_EXP_IsVariadic(exp) ? 1 : 0;
+
+	double cost = (exp->op.f->privdata) ? FT_PRIVDATA_FUNCTION_COST : FT_FUNCTION_COST;
+	for(int i = 0; i < exp->op.child_count; i++) {
+		cost += _FilterTree_ExpCost(exp->op.children[i]);
+	}
+	return cost;
+}
+
+// Estimated cost of evaluating a filter tree.
+static double _FilterTree_Cost(const FT_FilterNode *root) {
+	if(root == NULL) return 0;
+
+	switch(root->t) {
+	case FT_N_EXP:
+		return _FilterTree_ExpCost(root->exp.exp);
+	case FT_N_PRED:
+		return 1 + _FilterTree_ExpCost(root->pred.lhs) + _FilterTree_ExpCost(root->pred.rhs);
+	case FT_N_COND:
+		return _FilterTree_Cost(root->cond.left) + _FilterTree_Cost(root->cond.right);
+	default:
+		ASSERT(false);
+		return 0;
+	}
+}
+
+// Estimated fraction of records passing a filter tree.
+static double _FilterTree_Selectivity(const FT_FilterNode *root) {
+	switch(root->t) {
+	case FT_N_PRED:
+		switch(root->pred.op) {
+		case OP_EQUAL:
+			return 0.1;
+		case OP_NEQUAL:
+			return 0.9;
+		default:
+			return 0.33;
+		}
+	case FT_N_COND: {
+		if(root->cond.right == NULL) return 0.5;
+		double l = _FilterTree_Selectivity(root->cond.left);
+		double r = _FilterTree_Selectivity(root->cond.right);
+		if(root->cond.op == OP_AND) return l * r;
+		if(root->cond.op == OP_OR) return 1 - ((1 - l) * (1 - r));
+		return 0.5;
+	}
+	default:
+		return 0.5;
+	}
+}
+
+// Returns true if evaluating exp can not raise an error,
+// only variables, constants, property access and null checks are considered.
+static bool _FilterTree_ExpInfallible(const AR_ExpNode *exp) {
+	if(exp == NULL || exp->type == AR_EXP_OPERAND) return true;
+
+	const char *name = exp->op.f->name;
+	if(strcmp(name, "property") != 0 && strcmp(name, "is null") != 0 &&
+	   strcmp(name, "is not null") != 0) {
+		return false;
+	}
+
+	for(int i = 0; i < exp->op.child_count; i++) {
+		if(!_FilterTree_ExpInfallible(exp->op.children[i])) return false;
+	}
+	return true;
+}
+
+/* Returns true if evaluating the filter tree can not raise an error.
+ * errors follow the order in which filters are visited, e.g.
+ * WHERE x <> 0 AND 10 / x > 1
+ * must not divide by zero, as such fallible operands are never
+ * moved ahead of other operands. */
+static bool _FilterTree_Infallible(const FT_FilterNode *root) {
+	if(root == NULL) return true;
+
+	switch(root->t) {
+	case FT_N_EXP:
+		return _FilterTree_ExpInfallible(root->exp.exp);
+	case FT_N_PRED:
+		// comparisons never fail
+		return _FilterTree_ExpInfallible(root->pred.lhs) &&
+			_FilterTree_ExpInfallible(root->pred.rhs);
+	case FT_N_COND:
+		return _FilterTree_Infallible(root->cond.left) &&
+			_FilterTree_Infallible(root->cond.right);
+	default:
+		return false;
+	}
+}
+
+/* Rank of an operand within an AND/OR chain, given its pass rate,
+ * operands are visited in descending rank. an AND operand is ranked by
+ * the records it rejects per unit of cost, an OR operand by the records it
+ * accepts per unit of cost. */
+static inline double _FilterTree_Rank(AST_Operator op, double cost, double pass_rate) {
+	double decided = (op == OP_AND) ? 1 - pass_rate : pass_rate;
+	return decided / (cost + 1);
+}
+
+static inline bool _FilterTree_IsChain(const FT_FilterNode *node, AST_Operator op) {
+	return node->t == FT_N_COND && node->cond.op == op &&
+		node->cond.left != NULL && node->cond.right != NULL;
+}
+
+// Collects the operands and condition nodes forming the op chain rooted at node.
+static void _FilterTree_CollectChain(FT_FilterNode *node, AST_Operator op,
+		FT_FilterNode ***operands, FT_FilterNode ***conds) {
+	if(!_FilterTree_IsChain(node, op)) {
+		*operands = array_append(*operands, node);
+		return;
+	}
+	*conds = array_append(*conds, node);
+	_FilterTree_CollectChain(node->cond.left, op, operands, conds);
+	_FilterTree_CollectChain(node->cond.right, op, operands, conds);
+}
+
+double FilterTree_EstimateSelectivity(const FT_FilterNode *root) {
+	ASSERT(root != NULL);
+	return _FilterTree_Selectivity(root);
+}
+
+void FilterTree_Reorder(FT_FilterNode *root) {
+	ASSERT(root != NULL);
+	if(root->t != FT_N_COND) return;
+
+	AST_Operator op = root->cond.op;
+	if(!_FilterTree_IsChain(root, op) || (op != OP_AND && op != OP_OR)) {
+		if(root->cond.left) FilterTree_Reorder(root->cond.left);
+		if(root->cond.right) FilterTree_Reorder(root->cond.right);
+		return;
+	}
+
+	FT_FilterNode **conds = array_new(FT_FilterNode *, 1);
+	FT_FilterNode **operands = array_new(FT_FilterNode *, 2);
+	_FilterTree_CollectChain(root, op, &operands, &conds);
+
+	uint count = array_len(operands);
+	double ranks[count];
+	bool infallible[count];
+	for(uint i = 0; i < count; i++) {
+		FilterTree_Reorder(operands[i]);
+		ranks[i] = _FilterTree_Rank(op, _FilterTree_Cost(operands[i]),
+				_FilterTree_Selectivity(operands[i]));
+		infallible[i] = _FilterTree_Infallible(operands[i]);
+	}
+
+	// stable insertion sort, descending rank
+	// only infallible operands move ahead of others
+	for(uint i = 1; i < count; i++) {
+		FT_FilterNode *operand = operands[i];
+		double rank = ranks[i];
+		bool safe = infallible[i];
+		int j = i - 1;
+		for(; safe && j >= 0 && ranks[j] < rank; j--) {
+			operands[j + 1] = operands[j];
+			ranks[j + 1] = ranks[j];
+			infallible[j + 1] = infallible[j];
+		}
+		operands[j + 1] = operand;
+		ranks[j + 1] = rank;
+		infallible[j + 1] = safe;
+	}
+
+	// rebuild the chain left deep, operands[0] is visited first
+	uint cond_count = array_len(conds);
+	ASSERT(cond_count == count - 1);
+	for(uint i = 0; i < cond_count; i++) {
+		FT_FilterNode *cond = conds[i];
+		cond->cond.right = operands[count - 1 - i];
+		cond->cond.left = (i + 1 < cond_count) ? conds[i + 1] : operands[0];
+		memset(cond->cond.visits, 0, sizeof(cond->cond.visits));
+		memset(cond->cond.passes, 0, sizeof(cond->cond.passes));
+	}
+
+	array_free(operands);
+	array_free(conds);
+}
+
+// Swaps the children of an AND/OR node once the observed pass rates
+// show the right child decides more records per unit of cost.
+static void _FilterTree_AdaptOrder(FT_FilterNode *root) {
+	FT_ConditionNode *cond = &root->cond;
+	if(cond->visits[0] < FT_REORDER_INTERVAL) return;
+
+	// only an infallible right child may be moved ahead
+	if(cond->visits[1] > 0 && _FilterTree_Infallible(cond->right)) {
+		double left_rank = _FilterTree_Rank(cond->op, _FilterTree_Cost(cond->left),
+				(double)cond->passes[0] / cond->visits[0]);
+		double right_rank = _FilterTree_Rank(cond->op, _FilterTree_Cost(cond->right),
+				(double)cond->passes[1] / cond->visits[1]);
+		if(right_rank > left_rank) {
+			FT_FilterNode *left = cond->left;
+			cond->left = cond->right;
+			cond->right = left;
+		}
+	}
+
+	memset(cond->visits, 0, sizeof(cond->visits));
+	memset(cond->passes, 0, sizeof(cond->passes));
+}
+
+//------------------------------------------------------------------------------
+// Batch evaluation
+//------------------------------------------------------------------------------
+
+// Mirrors a comparison operator, such that a op b equals b op' a.
+static inline AST_Operator _MirrorOperator(AST_Operator op) {
+	switch(op) {
+	case OP_GT:
+		return OP_LT;
+	case OP_GE:
+		return OP_LE;
+	case OP_LT:
+		return OP_GT;
+	case OP_LE:
+		return OP_GE;
+	default:
+		return op;
+	}
+}
+
+static inline bool _IsNumericConstant(const AR_ExpNode *exp) {
+	return AR_EXP_IsConstant(exp) && (SI_TYPE(exp->operand.constant) & SI_NUMERIC);
+}
+
+// Runs each active record through the filter tree, one at a time.
+static uint64_t _applyFiltersPerRecord(const FT_FilterNode *root, Record *batch,
+		uint n, uint64_t active) {
+	uint64_t pass = 0;
+	for(uint i = 0; i < n; i++) {
+		uint64_t lane = 1ULL << i;
+		if(!(active & lane)) continue;
+		if(FilterTree_applyFilters(root, batch[i]) == FILTER_PASS) pass |= lane;
+	}
+	return pass;
+}
+
+/* Compares a numeric constant against an expression evaluated
+ * for each active record. numeric values are gathered into dense lanes
+ * and compared by a predicate kernel, other values are compared one by one. */
+static uint64_t _applyPredicateBatch(const FT_FilterNode *root, Record *batch,
+		uint n, uint64_t active) {
+	bool const_rhs = _IsNumericConstant(root->pred.rhs);
+	if(!const_rhs && !_IsNumericConstant(root->pred.lhs)) {
+		return _applyFiltersPerRecord(root, batch, n, active);
+	}
+
+	// exp op c
+	AR_ExpNode *exp = (const_rhs) ? root->pred.lhs : root->pred.rhs;
+	SIValue c = (const_rhs) ? root->pred.rhs->operand.constant :
+		root->pred.lhs->operand.constant;
+	AST_Operator op = (const_rhs) ? root->pred.op : _MirrorOperator(root->pred.op);
+	bool int_const = (SI_TYPE(c) == T_INT64);
+
+	uint64_t pass = 0;
+	uint64_t int_lanes = 0;
+	uint64_t double_lanes = 0;
+	int64_t ints[PREDICATE_KERNEL_LANES] = {0};
+	double doubles[PREDICATE_KERNEL_LANES] = {0};
+
+	for(uint i = 0; i < n; i++) {
+		uint64_t lane = 1ULL << i;
+		if(!(active & lane)) continue;
+
+		SIValue v = AR_EXP_Evaluate(exp, batch[i]);
+		if(int_const && SI_TYPE(v) == T_INT64) {
+			ints[i] = v.longval;
+			int_lanes |= lane;
+		} else if(SI_TYPE(v) & SI_NUMERIC) {
+			// mixed numerics are compared as doubles
+			doubles[i] = SI_GET_NUMERIC(v);
+			double_lanes |= lane;
+		} else {
+			bool passed = (const_rhs) ? _applyFilter(&v, &c, root->pred.op) :
+				_applyFilter(&c, &v, root->pred.op);
+			if(passed) pass |= lane;
+		}
+		SIValue_Free(v);
+	}
+
+	if(int_lanes) {
+		pass |= PredicateKernel_Int64(ints, n, c.longval, op) & int_lanes;
+	}
+	if(double_lanes) {
+		pass |= PredicateKernel_Double(doubles, n, SI_GET_NUMERIC(c), op) & double_lanes;
+	}
+
+	return pass;
+}
+
+// Runs the active records through the filter tree,
+// each record is evaluated exactly as FilterTree_applyFilters would.
+static uint64_t _applyFiltersBatch(FT_FilterNode *root, Record *batch,
+		uint n, uint64_t active) {
+	switch(root->t) {
+	case FT_N_COND: {
+		AST_Operator op = root->cond.op;
+		if(op != OP_AND && op != OP_OR) {
+			return _applyFiltersPerRecord(root, batch, n, active);
+		}
+
+		FT_ConditionNode *cond = &root->cond;
+		uint64_t left = _applyFiltersBatch(cond->left, batch, n, active);
+		cond->visits[0] += __builtin_popcountll(active);
+		cond->passes[0] += __builtin_popcountll(left);
+
+		// AND visits the right subtree with records passing the left one,
+		// OR visits it with records failing the left one
+		uint64_t undecided = (op == OP_AND) ? left : active & ~left;
+		uint64_t pass = (op == OP_AND) ? 0 : left;
+		if(undecided != 0) {
+			uint64_t right = _applyFiltersBatch(cond->right, batch, n, undecided);
+			cond->visits[1] += __builtin_popcountll(undecided);
+			cond->passes[1] += __builtin_popcountll(right);
+			pass |= right;
+		}
+
+		_FilterTree_AdaptOrder(root);
+		return pass;
+	}
+	case FT_N_PRED:
+		return _applyPredicateBatch(root, batch, n, active);
+	default:
+		return _applyFiltersPerRecord(root, batch, n, active);
+	}
+}
+
+uint64_t FilterTree_applyFiltersBatch(FT_FilterNode *root, Record *batch, uint n) {
+	ASSERT(root != NULL);
+	ASSERT(n <= PREDICATE_KERNEL_LANES);
+
+	if(n == 0) return 0;
+	uint64_t active = (n == 64) ? UINT64_MAX : ((1ULL << n) - 1);
+	return _applyFiltersBatch(root, batch, n, active);
+}
+
 void _FilterTree_CollectModified(const FT_FilterNode *root, rax *modified) {
 	if(root == NULL) return;
 
@@ -683,6 +1035,48 @@ void FilterTree_ResolveVariables(FT_FilterNode *root, const Record r) {
 	FilterTree_Compact(root);
 }
 
+void FilterTree_ResolveAliases(FT_FilterNode *root, const rax *mapping) {
+	ASSERT(root != NULL);
+
+	switch(root->t) {
+		case FT_N_EXP:
+			AR_EXP_ResolveAliases(root->exp.exp, mapping);
+			break;
+		case FT_N_COND:
+			FilterTree_ResolveAliases(root->cond.left, mapping);
+			if(root->cond.right) FilterTree_ResolveAliases(root->cond.right, mapping);
+			break;
+		case FT_N_PRED:
+			AR_EXP_ResolveAliases(root->pred.lhs, mapping);
+			AR_EXP_ResolveAliases(root->pred.rhs, mapping);
+			break;
+		default:
+			ASSERT(false && "FilterTree_ResolveAliases: Unknown filter tree node");
+			break;
+	}
+}
+
+void FilterTree_Compile(FT_FilterNode *root) {
+	ASSERT(root != NULL);
+
+	switch(root->t) {
+		case FT_N_EXP:
+			AR_EXP_Compile(root->exp.exp);
+			break;
+		case FT_N_COND:
+			FilterTree_Compile(root->cond.left);
+			if(root->cond.right) FilterTree_Compile(root->cond.right);
+			break;
+		case FT_N_PRED:
+			AR_EXP_Compile(root->pred.lhs);
+			AR_EXP_Compile(root->pred.rhs);
+			break;
+		default:
+			ASSERT(false && "FilterTree_Compile: Unknown filter tree node");
+			break;
+	}
+}
+
 // Clone an expression node.
 static inline FT_FilterNode *_FilterTree_Clone_Exp(const FT_FilterNode *node) {
 	AR_ExpNode *exp_clone = AR_EXP_Clone(node->exp.exp);
@@ -49,6 +49,8 @@ typedef struct {
 	struct FT_FilterNode *left;
 	struct FT_FilterNode *right;
 	AST_Operator op;	/* Can validly be OR, AND (and later, XOR and maybe NOT) */
+	uint64_t visits[2];	/* Records visiting each child, as observed by batch evaluation. */
+	uint64_t passes[2];	/* Records passing each child, as observed by batch evaluation. */
 } FT_ConditionNode;
 
 /* All nodes within the filter tree are of type FT_FilterNode. */
@@ -84,6 +86,19 @@ FT_FilterNode *FilterTree_CreateConditionFilter(AST_Operator op);
 /* Runs val through the filter tree. */
 int FilterTree_applyFilters(const FT_FilterNode *root, const Record r);
 
+/* Runs a batch of at most 64 records through the filter tree,
+ * returns a selection bitmap, bit i is set if batch[i] passes.
+ * AND and OR nodes track the pass rate of their children, periodically
+ * swapping them such that the child most likely to decide is visited first. */
+uint64_t FilterTree_applyFiltersBatch(FT_FilterNode *root, Record *batch, uint n);
+
+/* Returns the estimated fraction of records passing the filter tree. */
+double FilterTree_EstimateSelectivity(const FT_FilterNode *root);
+
+/* Reorders the operands of AND and OR chains by their estimated cost
+ * and selectivity, such that cheap and decisive operands are visited first. */
+void FilterTree_Reorder(FT_FilterNode *root);
+
 /* Extract every modified record ID mentioned in the tree
  * without duplications. */
 rax *FilterTree_CollectModified(const FT_FilterNode *root);
@@ -129,6 +144,12 @@ bool FilterTree_Compact(FT_FilterNode *root);
 /* Resolve variables to constants */
 void FilterTree_ResolveVariables(FT_FilterNode *root, const Record r);
 
+/* Resolve aliases referenced by the tree into their slots within mapping */
+void FilterTree_ResolveAliases(FT_FilterNode *root, const rax *mapping);
+
+/* Compile every expression within the tree */
+void FilterTree_Compile(FT_FilterNode *root);
+
 /* Clones tree. */
 FT_FilterNode *FilterTree_Clone(const FT_FilterNode *root);
 
@@ -64,12 +64,13 @@ bool extractOriginAndRadius(const FT_FilterNode *filter, SIValue *origin,
 	bool     l_scalar  =  AR_EXP_ReduceToScalar(lhs, true, &l);
 	bool     r_scalar  =  AR_EXP_ReduceToScalar(rhs, true, &r);
 
-	if(l_scalar && !r_scalar) {
+	// origin must be a point
+	if(l_scalar && !r_scalar && SI_TYPE(l) == T_POINT) {
 		res = AR_EXP_IsAttribute(rhs, &p);
 		if(point) *point = p;
 		if(origin) *origin = l;
 		if(radius) *radius = d;
-	} else if(!l_scalar && r_scalar) {
+	} else if(!l_scalar && r_scalar && SI_TYPE(r) == T_POINT) {
 		res = AR_EXP_IsAttribute(lhs, &p);
 		if(point) *point = p;
 		if(origin) *origin = r;
@@ -92,9 +93,52 @@ bool isDistanceFilter(FT_FilterNode *filter) {
 		ASSERT(filter->t == FT_N_PRED);
 		AST_Operator op = filter->pred.op;
 		// make sure filter structure is: distance(point, origin) <= radius
-		res = (op == OP_LT || op == OP_LE);
+		// or its mirror: radius >= distance(point, origin)
+		AR_ExpNode *lhs = filter->pred.lhs;
+		bool distance_lhs = AR_EXP_IsOperation(lhs) &&
+			strcasecmp(lhs->op.func_name, "distance") == 0;
+		if(distance_lhs) res = (op == OP_LT || op == OP_LE);
+		else res = (op == OP_GT || op == OP_GE);
 	}
 
 	return res;
 }
 
+
+// extracts both attribute and prefix from a prefix filter
+// n.name STARTS WITH prefix
+bool extractAttributeAndPrefix(const FT_FilterNode *filter, char **attr,
+		SIValue *prefix) {
+	ASSERT(filter != NULL);
+
+	if(filter->t != FT_N_EXP) return false;
+
+	AR_ExpNode *exp = filter->exp.exp;
+	if(!AR_EXP_IsOperation(exp) ||
+	   strcasecmp(exp->op.func_name, "starts with") != 0) {
+		return false;
+	}
+
+	// prefixed string must be an attribute
+	char *a = NULL;
+	if(!AR_EXP_IsAttribute(exp->op.children[0], &a)) return false;
+
+	// prefix must be a constant string
+	SIValue p = SI_NullVal();
+	if(!AR_EXP_ReduceToScalar(exp->op.children[1], true, &p)) return false;
+	if(SI_TYPE(p) != T_STRING) {
+		SIValue_Free(p);
+		return false;
+	}
+
+	if(attr) *attr = a;
+	if(prefix) *prefix = p;
+	else SIValue_Free(p);
+	return true;
+}
+
+// return true if filter performs prefix matching
+// n.name STARTS WITH 'Jo'
+bool isPrefixFilter(const FT_FilterNode *filter) {
+	return extractAttributeAndPrefix(filter, NULL, NULL);
+}
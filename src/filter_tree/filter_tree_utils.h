@@ -15,3 +15,10 @@ bool extractOriginAndRadius(const FT_FilterNode *filter, SIValue *origin,
 
 bool isDistanceFilter(FT_FilterNode *filter);
 
+// extracts both attribute and prefix from a prefix filter
+// n.name STARTS WITH prefix
+bool extractAttributeAndPrefix(const FT_FilterNode *filter, char **attr,
+		SIValue *prefix);
+
+bool isPrefixFilter(const FT_FilterNode *filter);
+
@@ -13,6 +13,9 @@
 #include "../util/range/string_range.h"
 #include "../util/range/numeric_range.h"
 
+// relative padding of radius queries, see _FilterTreeToDistanceQueryNode
+#define DISTANCE_QUERY_PADDING 0.001
+
 //------------------------------------------------------------------------------
 // forward declarations
 //------------------------------------------------------------------------------
@@ -70,6 +73,39 @@ static RSQNode *_StringRangeToQueryNode
 	return root;
 }
 
+// creates a RediSearch lexical range query from given prefix filter
+// matching all strings which start with the prefix
+static RSQNode *_FilterTreeToPrefixQueryNode
+(
+	FT_FilterNode *filter,  // filter to convert
+	RSIndex *idx            // queried index
+) {
+	char *field = NULL;
+	SIValue prefix = SI_NullVal();
+	bool res = extractAttributeAndPrefix(filter, &field, &prefix);
+	ASSERT(res == true);
+
+	// strings starting with the prefix sort before its successor
+	// the prefix with its last byte which isn't 0xFF incremented
+	char *max = rm_strdup(prefix.stringval);
+	size_t len = strlen(max);
+	while(len > 0 && (unsigned char)max[len - 1] == 0xFF) len--;
+	max[len] = '\0';
+	if(len > 0) max[len - 1]++;
+
+	const char *begin = (prefix.stringval[0] == '\0') ? RSLEXRANGE_NEG_INF :
+		prefix.stringval;
+	const char *end = (len == 0) ? RSLECRANGE_INF : max;
+
+	RSQNode *node = RediSearch_CreateTagNode(idx, field);
+	RSQNode *child = RediSearch_CreateLexRangeNode(idx, field, begin, end, 1, 0);
+	RediSearch_QueryNodeAddChild(node, child);
+
+	rm_free(max);
+	SIValue_Free(prefix);
+	return node;
+}
+
 // creates a RediSearch distance query from given filter
 static RSQNode *_FilterTreeToDistanceQueryNode
 (
@@ -82,8 +118,13 @@ static RSQNode *_FilterTreeToDistanceQueryNode
 
 	extractOriginAndRadius(filter, &origin, &radius, &field);
 
+	// RediSearch computes distances by a different earth radius and precision
+	// than distance() does, query a slightly larger circle, the filter itself
+	// is retained and applied to the index results
+	double r = SI_GET_NUMERIC(radius) * (1 + DISTANCE_QUERY_PADDING) + 1;
+
 	return RediSearch_CreateGeoNode(idx, field, Point_lat(origin),
-									Point_lon(origin), SI_GET_NUMERIC(radius), RS_GEO_DISTANCE_M);
+									Point_lon(origin), r, RS_GEO_DISTANCE_M);
 }
 
 // creates a RediSearch query node out of given IN filter
@@ -509,8 +550,15 @@ static bool _FilterTreeToQueryNode
 	}
 
 	if(isDistanceFilter(tree)) {
+		// index results are a superset of the filtered points
 		*root = _FilterTreeToDistanceQueryNode(tree, idx);
-		return true;
+		return false;
+	}
+
+	if(isPrefixFilter(tree)) {
+		// index results are a superset of the prefixed strings
+		*root = _FilterTreeToPrefixQueryNode(tree, idx);
+		return false;
 	}
 
 	FT_FilterNodeType t = tree->t;
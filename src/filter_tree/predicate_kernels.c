@@ -0,0 +1,57 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "predicate_kernels.h"
+#include "RG.h"
+
+// Lane relations are computed into a byte array, then packed into a bitmap,
+// keeping the comparison loop free of loop-carried dependencies.
+static inline uint64_t _PackLanes(const uint8_t *lanes, uint n) {
+	uint64_t bitmap = 0;
+	for(uint i = 0; i < n; i++) bitmap |= ((uint64_t)lanes[i]) << i;
+	return bitmap;
+}
+
+// Fill each lane with the outcome of comparing its relation to c,
+// switching on op outside of the loop so each loop vectorizes.
+#define KERNEL_LOOPS(rel)                                               \
+	switch(op) {                                                        \
+	case OP_EQUAL:  for(uint i = 0; i < n; i++) lanes[i] = (rel) == 0;  \
+		break;                                                          \
+	case OP_NEQUAL: for(uint i = 0; i < n; i++) lanes[i] = (rel) != 0;  \
+		break;                                                          \
+	case OP_GT:     for(uint i = 0; i < n; i++) lanes[i] = (rel) > 0;   \
+		break;                                                          \
+	case OP_GE:     for(uint i = 0; i < n; i++) lanes[i] = (rel) >= 0;  \
+		break;                                                          \
+	case OP_LT:     for(uint i = 0; i < n; i++) lanes[i] = (rel) < 0;   \
+		break;                                                          \
+	case OP_LE:     for(uint i = 0; i < n; i++) lanes[i] = (rel) <= 0;  \
+		break;                                                          \
+	default:                                                            \
+		ASSERT(false && "unsupported predicate kernel operator");       \
+		return 0;                                                       \
+	}
+
+uint64_t PredicateKernel_Int64(const int64_t *vals, uint n, int64_t c, AST_Operator op) {
+	ASSERT(vals != NULL);
+	ASSERT(n <= PREDICATE_KERNEL_LANES);
+
+	uint8_t lanes[PREDICATE_KERNEL_LANES];
+	KERNEL_LOOPS((vals[i] > c) - (vals[i] < c));
+	return _PackLanes(lanes, n);
+}
+
+uint64_t PredicateKernel_Double(const double *vals, uint n, double c, AST_Operator op) {
+	ASSERT(vals != NULL);
+	ASSERT(n <= PREDICATE_KERNEL_LANES);
+
+	// relation is the sign of the difference, NaN differences compare as
+	// equal, as they do for SIValue_Compare
+	uint8_t lanes[PREDICATE_KERNEL_LANES];
+	KERNEL_LOOPS(((vals[i] - c) > 0) - ((vals[i] - c) < 0));
+	return _PackLanes(lanes, n);
+}
@@ -0,0 +1,36 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../ast/ast_shared.h"
+#include <stdint.h>
+
+// Number of lanes evaluated by a single kernel invocation.
+#define PREDICATE_KERNEL_LANES 64
+
+/* Predicate kernels compare a dense array of numeric values against a
+ * constant, producing a selection bitmap, bit i is set if vals[i] op c holds.
+ * kernels are branch free, such that the compiler vectorizes them for the
+ * target's SIMD extension. comparisons follow SIValue_Compare semantics. */
+
+// Compare 'n' (at most PREDICATE_KERNEL_LANES) integers against 'c'.
+uint64_t PredicateKernel_Int64
+(
+	const int64_t *vals,  // Values to compare.
+	uint n,               // Number of values.
+	int64_t c,            // Constant to compare against.
+	AST_Operator op       // Comparison operator.
+);
+
+// Compare 'n' (at most PREDICATE_KERNEL_LANES) doubles against 'c'.
+uint64_t PredicateKernel_Double
+(
+	const double *vals,   // Values to compare.
+	uint n,               // Number of values.
+	double c,             // Constant to compare against.
+	AST_Operator op       // Comparison operator.
+);
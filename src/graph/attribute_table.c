@@ -0,0 +1,155 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "attribute_table.h"
+#include "RG.h"
+#include "xxhash.h"
+#include "../util/rmalloc.h"
+#include <string.h>
+
+// initial number of hash slots, a power of 2
+#define ATTRIBUTE_HASH_INIT_CAP 64
+
+// name to ID hash table, slots hold ID + 1, 0 marks an empty slot
+struct AttributeHash {
+	uint32_t cap;           // Number of slots, a power of 2.
+	AttributeHash *next;    // Next retired table.
+	uint32_t slots[];       // Open addressing slots.
+};
+
+static AttributeHash *_AttributeHash_New(uint32_t cap) {
+	AttributeHash *h = rm_calloc(1, sizeof(AttributeHash) + sizeof(uint32_t) * cap);
+	h->cap = cap;
+	return h;
+}
+
+static inline uint64_t _Hash(const char *name, size_t len) {
+	return XXH64(name, len, 0);
+}
+
+static inline const char *_Name(const AttributeTable *t, uint32_t id) {
+	char **chunk = __atomic_load_n(&t->chunks[id / ATTRIBUTE_CHUNK_SIZE],
+			__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&chunk[id % ATTRIBUTE_CHUNK_SIZE], __ATOMIC_ACQUIRE);
+}
+
+// place 'id' in the first free slot of its probe sequence
+static void _AttributeHash_Insert(AttributeHash *h, uint64_t hash, uint32_t id) {
+	uint32_t mask = h->cap - 1;
+	uint32_t i = hash & mask;
+	while(h->slots[i] != 0) i = (i + 1) & mask;
+	__atomic_store_n(&h->slots[i], id + 1, __ATOMIC_RELEASE);
+}
+
+AttributeTable *AttributeTable_New(void) {
+	AttributeTable *t = rm_calloc(1, sizeof(AttributeTable));
+	t->hash = _AttributeHash_New(ATTRIBUTE_HASH_INIT_CAP);
+	int res = pthread_mutex_init(&t->lock, NULL);
+	ASSERT(res == 0);
+	UNUSED(res);
+	return t;
+}
+
+uint AttributeTable_Count(const AttributeTable *t) {
+	ASSERT(t != NULL);
+	return __atomic_load_n(&t->count, __ATOMIC_ACQUIRE);
+}
+
+Attribute_ID AttributeTable_Find(const AttributeTable *t, const char *name) {
+	ASSERT(t != NULL && name != NULL);
+
+	size_t len = strlen(name);
+	uint64_t hash = _Hash(name, len);
+	const AttributeHash *h = __atomic_load_n(&t->hash, __ATOMIC_ACQUIRE);
+
+	uint32_t mask = h->cap - 1;
+	for(uint32_t i = hash & mask;; i = (i + 1) & mask) {
+		uint32_t slot = __atomic_load_n(&h->slots[i], __ATOMIC_ACQUIRE);
+		if(slot == 0) return ATTRIBUTE_NOTFOUND;
+		const char *candidate = _Name(t, slot - 1);
+		if(strcmp(candidate, name) == 0) return slot - 1;
+	}
+}
+
+Attribute_ID AttributeTable_FindOrAdd(AttributeTable *t, const char *name,
+		AttributeTable_OnAdd on_add, void *ctx) {
+	ASSERT(t != NULL && name != NULL);
+
+	Attribute_ID id = AttributeTable_Find(t, name);
+	if(id != ATTRIBUTE_NOTFOUND) return id;
+
+	pthread_mutex_lock(&t->lock);
+
+	// lookup the attribute again now that we are in a critical region
+	id = AttributeTable_Find(t, name);
+	if(id != ATTRIBUTE_NOTFOUND) {
+		pthread_mutex_unlock(&t->lock);
+		return id;
+	}
+
+	uint32_t next = t->count;
+	ASSERT(next < ATTRIBUTE_TABLE_CAP);
+
+	// publish the name ahead of its hash slot
+	uint32_t c = next / ATTRIBUTE_CHUNK_SIZE;
+	if(t->chunks[c] == NULL) {
+		char **chunk = rm_calloc(ATTRIBUTE_CHUNK_SIZE, sizeof(char *));
+		__atomic_store_n(&t->chunks[c], chunk, __ATOMIC_RELEASE);
+	}
+	__atomic_store_n(&t->chunks[c][next % ATTRIBUTE_CHUNK_SIZE], rm_strdup(name),
+			__ATOMIC_RELEASE);
+
+	// keep the table at most half full, rebuilding it aside
+	AttributeHash *h = t->hash;
+	if((next + 1) * 2 > h->cap) {
+		AttributeHash *grown = _AttributeHash_New(h->cap * 2);
+		for(uint32_t i = 0; i < next; i++) {
+			const char *s = _Name(t, i);
+			_AttributeHash_Insert(grown, _Hash(s, strlen(s)), i);
+		}
+		__atomic_store_n(&t->hash, grown, __ATOMIC_RELEASE);
+
+		// readers may still be probing the replaced table
+		h->next = t->retired;
+		t->retired = h;
+		h = grown;
+	}
+
+	_AttributeHash_Insert(h, _Hash(name, strlen(name)), next);
+	__atomic_store_n(&t->count, next + 1, __ATOMIC_RELEASE);
+
+	if(on_add) on_add(ctx, name);
+	pthread_mutex_unlock(&t->lock);
+
+	return next;
+}
+
+const char *AttributeTable_Name(const AttributeTable *t, Attribute_ID id) {
+	ASSERT(t != NULL);
+	ASSERT(id < AttributeTable_Count(t));
+	return _Name(t, id);
+}
+
+void AttributeTable_Free(AttributeTable *t) {
+	ASSERT(t != NULL);
+
+	for(uint32_t i = 0; i < t->count; i++) {
+		rm_free(t->chunks[i / ATTRIBUTE_CHUNK_SIZE][i % ATTRIBUTE_CHUNK_SIZE]);
+	}
+	for(uint32_t c = 0; c < (ATTRIBUTE_TABLE_CAP / ATTRIBUTE_CHUNK_SIZE) + 1; c++) {
+		if(t->chunks[c]) rm_free(t->chunks[c]);
+	}
+
+	rm_free(t->hash);
+	while(t->retired) {
+		AttributeHash *h = t->retired;
+		t->retired = h->next;
+		rm_free(h);
+	}
+
+	pthread_mutex_destroy(&t->lock);
+	rm_free(t);
+}
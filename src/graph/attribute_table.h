@@ -0,0 +1,76 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+#include "entities/graph_entity.h"
+
+// maximum number of attributes, IDs are 16 bit
+#define ATTRIBUTE_TABLE_CAP 65535
+
+// number of IDs mapped by each chunk of the ID to string array
+#define ATTRIBUTE_CHUNK_SIZE 256
+
+typedef struct AttributeHash AttributeHash;
+
+// invoked while an attribute is added, insertions are serialized
+typedef void (*AttributeTable_OnAdd)(void *ctx, const char *name);
+
+/* An append-only dictionary mapping attribute names to dense IDs and back.
+ * Lookups never lock: IDs are mapped to names by fixed size chunks which
+ * never move once allocated, names are mapped to IDs by an open addressing
+ * hash table, rebuilt at twice its size once half full and swapped in
+ * atomically. Insertions are serialized by a mutex, a name is published to
+ * the ID array before its hash slot and the count, such that a reader
+ * observing either finds the name in place. Replaced hash tables may still
+ * be probed by concurrent readers, they are released with the dictionary. */
+typedef struct {
+	char **chunks[(ATTRIBUTE_TABLE_CAP / ATTRIBUTE_CHUNK_SIZE) + 1];  // ID to name
+	AttributeHash *hash;      // Name to ID, current table.
+	AttributeHash *retired;   // Replaced tables, linked.
+	uint32_t count;           // Number of attributes.
+	pthread_mutex_t lock;     // Serializes insertions.
+} AttributeTable;
+
+// create an empty dictionary
+AttributeTable *AttributeTable_New(void);
+
+// number of attributes
+uint AttributeTable_Count
+(
+	const AttributeTable *t
+);
+
+// returns the ID of 'name', ATTRIBUTE_NOTFOUND if missing
+Attribute_ID AttributeTable_Find
+(
+	const AttributeTable *t,
+	const char *name
+);
+
+// returns the ID of 'name', adding it if missing
+Attribute_ID AttributeTable_FindOrAdd
+(
+	AttributeTable *t,
+	const char *name,
+	AttributeTable_OnAdd on_add,  // [optional] invoked if name is added
+	void *ctx                     // on_add context
+);
+
+// returns the name of attribute 'id', which must exist
+const char *AttributeTable_Name
+(
+	const AttributeTable *t,
+	Attribute_ID id
+);
+
+// free dictionary, no lookups may be in flight
+void AttributeTable_Free
+(
+	AttributeTable *t
+);
@@ -30,6 +30,16 @@ struct Edge {
 
 typedef struct Edge Edge;
 
+/* Edge as stored by the graph, the edge's endpoints and relation type
+ * are kept next to its attributes, such that an edge is resolved by ID alone.
+ * Edge::entity points to the edge's record. */
+typedef struct {
+	Entity entity;      // Edge attributes, MUST be the first member
+	NodeID srcNodeID;   // Source node ID
+	NodeID destNodeID;  // Destination node ID
+	int relationID;     // Relation type ID
+} EdgeRecord;
+
 /* Creates a new edge, connecting src to dest node. */
 // Edge* Edge_New(Node *src, Node *dest, const char *relationship, const char *alias);
 
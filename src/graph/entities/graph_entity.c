@@ -11,41 +11,212 @@
 #include "../../errors.h"
 #include "../../query_ctx.h"
 #include "../graphcontext.h"
+#include "../../util/arr.h"
 #include "../../util/rmalloc.h"
+#include "../../util/value_log/value_log.h"
+#include "../../datatypes/array.h"
 
 SIValue *PROPERTY_NOTFOUND = &(SIValue) {
 	.longval = 0, .type = T_NULL
 };
 
+// How a property's value is laid out within its payload.
+typedef enum {
+	PROP_ENC_VALUE = 0,   // Payload holds the value's union, no allocations.
+	PROP_ENC_HEAP,        // Payload holds a pointer owned by the property.
+	PROP_ENC_INTERNED,    // Payload holds a reference to an interned string.
+	PROP_ENC_INLINE_STR,  // Payload holds the string's bytes.
+	PROP_ENC_LOGGED,      // Payload holds a reference to a string in the value log.
+} PropertyEncoding;
+
+// The tag's low 5 bits hold the index of the value's SIType bit,
+// the remaining bits hold its PropertyEncoding.
+#define PROPERTY_TAG(type, encoding) ((uint8_t)(__builtin_ctz(type) | ((encoding) << 5)))
+#define PROPERTY_TYPE(tag) ((SIType)(1 << ((tag) & 0x1F)))
+#define PROPERTY_ENCODING(tag) ((PropertyEncoding)((tag) >> 5))
+
+void EntityProperty_Set(EntityProperty *p, Attribute_ID attr_id, SIValue value) {
+	ASSERT(p);
+	ASSERT(!SIValue_IsNull(value));
+
+	p->id = attr_id;
+	SIType t = SI_TYPE(value);
+
+	if(t == T_STRING) {
+		size_t len = strlen(value.stringval);
+		if(len <= PROPERTY_INLINE_STRLEN) {
+			// short strings are copied into the payload
+			p->tag = PROPERTY_TAG(t, PROP_ENC_INLINE_STR);
+			memcpy(p->payload, value.stringval, len + 1);
+			SIValue_Free(value);
+			return;
+		}
+		if(value.allocation == M_INTERN) {
+			p->tag = PROPERTY_TAG(t, PROP_ENC_INTERNED);
+			memcpy(p->payload, &value.stringval, sizeof(char *));
+			return;
+		}
+	}
+
+	if(value.allocation == M_NONE) {
+		p->tag = PROPERTY_TAG(t, PROP_ENC_VALUE);
+		memcpy(p->payload, &value.longval, sizeof(value.longval));
+		return;
+	}
+
+	// the property owns heap allocated values, duplicating shared ones
+	if(value.allocation != M_SELF) value = SI_CloneValue(value);
+	p->tag = PROPERTY_TAG(t, PROP_ENC_HEAP);
+	memcpy(p->payload, &value.ptrval, sizeof(void *));
+}
+
+SIValue EntityProperty_Value(const EntityProperty *p) {
+	ASSERT(p);
+
+	SIValue v;
+	v.type = PROPERTY_TYPE(p->tag);
+
+	switch(PROPERTY_ENCODING(p->tag)) {
+	case PROP_ENC_VALUE:
+		memcpy(&v.longval, p->payload, sizeof(v.longval));
+		v.allocation = M_NONE;
+		break;
+	case PROP_ENC_INLINE_STR:
+		v.stringval = (char *)p->payload;
+		v.allocation = M_CONST;
+		break;
+	default:
+		memcpy(&v.ptrval, p->payload, sizeof(void *));
+		v.allocation = M_CONST;
+		break;
+	}
+
+	return v;
+}
+
+void EntityProperty_Free(EntityProperty *p) {
+	ASSERT(p);
+
+	SIValue v = EntityProperty_Value(p);
+	switch(PROPERTY_ENCODING(p->tag)) {
+	case PROP_ENC_HEAP:
+		v.allocation = M_SELF;
+		SIValue_Free(v);
+		break;
+	case PROP_ENC_INTERNED:
+		v.allocation = M_INTERN;
+		SIValue_Free(v);
+		break;
+	case PROP_ENC_LOGGED:
+		ValueLog_Release(v.stringval);
+		break;
+	default:
+		break;
+	}
+}
+
+/* Returns the value to be stored as a property, the caller retains ownership
+ * over value. Strings too long to be stored inline are interned when the
+ * graph maintains a string pool. */
+static inline SIValue _GraphEntity_StoredValue(SIValue value) {
+	if(SI_TYPE(value) == T_STRING) {
+		GraphContext *gc = QueryCtx_GetGraphCtx();
+		if(gc && gc->string_pool && strlen(value.stringval) > PROPERTY_INLINE_STRLEN) {
+			return SI_InternedStringVal(StringPool_Intern(gc->string_pool, value.stringval));
+		}
+	}
+	// shared allocations are duplicated by EntityProperty_Set
+	return SI_ShareValue(value);
+}
+
+/* Encodes value into property p, the caller retains ownership over value.
+ * Strings of at least the value log's threshold are appended to
+ * the graph's value log, if it maintains one. */
+static void _GraphEntity_StoreProperty(EntityProperty *p, Attribute_ID attr_id,
+		SIValue value) {
+	if(SI_TYPE(value) == T_STRING) {
+		GraphContext *gc = QueryCtx_GetGraphCtx();
+		ValueLog *log = (gc) ? gc->value_log : NULL;
+		size_t len = strlen(value.stringval);
+		if(log && len > PROPERTY_INLINE_STRLEN && len >= log->threshold) {
+			char *logged = ValueLog_Append(log, value.stringval);
+			if(logged) {
+				p->id = attr_id;
+				p->tag = PROPERTY_TAG(T_STRING, PROP_ENC_LOGGED);
+				memcpy(p->payload, &logged, sizeof(char *));
+				return;
+			}
+		}
+	}
+
+	EntityProperty_Set(p, attr_id, _GraphEntity_StoredValue(value));
+}
+
+// Entity mask bit of attribute attr_id.
+#define ATTRIBUTE_BIT(attr_id) (1u << ((attr_id) & 31))
+
+// Property bags up to this size are scanned linearly rather than bisected.
+#define PROPERTY_LINEAR_SCAN 8
+
+/* Returns the position of the first property in [lo, prop_count)
+ * whose ID is not less than attr_id. */
+static inline int _GraphEntity_LowerBound(const Entity *e, int lo, Attribute_ID attr_id) {
+	const EntityProperty *properties = e->properties;
+	int hi = e->prop_count;
+
+	while(hi - lo > PROPERTY_LINEAR_SCAN) {
+		int mid = lo + (hi - lo) / 2;
+		if(properties[mid].id < attr_id) lo = mid + 1;
+		else hi = mid;
+	}
+	while(lo < hi && properties[lo].id < attr_id) lo++;
+	return lo;
+}
+
+// Returns entity's property attr_id, NULL if missing.
+static inline EntityProperty *_GraphEntity_FindProperty(const Entity *e,
+		Attribute_ID attr_id) {
+	if(!(e->attr_mask & ATTRIBUTE_BIT(attr_id))) return NULL;
+	int i = _GraphEntity_LowerBound(e, 0, attr_id);
+	if(i < e->prop_count && e->properties[i].id == attr_id) return e->properties + i;
+	return NULL;
+}
+
+static void _GraphEntity_UpdateMask(Entity *e) {
+	e->attr_mask = 0;
+	for(int i = 0; i < e->prop_count; i++) {
+		e->attr_mask |= ATTRIBUTE_BIT(e->properties[i].id);
+	}
+}
+
 /* Removes entity's property. */
 static bool _GraphEntity_RemoveProperty(const GraphEntity *e, Attribute_ID attr_id) {
 	// Quick return if attribute is missing.
 	if(attr_id == ATTRIBUTE_NOTFOUND) return false;
 
 	// Locate attribute position.
-	int prop_count = e->entity->prop_count;
-	for(int i = 0; i < prop_count; i++) {
-		if(attr_id == e->entity->properties[i].id) {
-			SIValue_Free(e->entity->properties[i].value);
-			e->entity->prop_count--;
-
-			if(e->entity->prop_count == 0) {
-				/* Only attribute removed, free properties bag. */
-				rm_free(e->entity->properties);
-				e->entity->properties = NULL;
-			} else {
-				/* Overwrite deleted attribute with the last
-				 * attribute and shrink properties bag. */
-				e->entity->properties[i] = e->entity->properties[prop_count - 1];
-				e->entity->properties = rm_realloc(e->entity->properties,
-												   sizeof(EntityProperty) * e->entity->prop_count);
-			}
+	Entity *en = e->entity;
+	EntityProperty *p = _GraphEntity_FindProperty(en, attr_id);
+	if(p == NULL) return false;
 
-			return true;
-		}
+	EntityProperty_Free(p);
+	en->prop_count--;
+
+	if(en->prop_count == 0) {
+		/* Only attribute removed, free properties bag. */
+		rm_free(en->properties);
+		en->properties = NULL;
+	} else {
+		/* Shift subsequent attributes to keep the bag sorted
+		 * and shrink properties bag. */
+		int i = p - en->properties;
+		memmove(p, p + 1, sizeof(EntityProperty) * (en->prop_count - i));
+		en->properties = rm_realloc(en->properties,
+									sizeof(EntityProperty) * en->prop_count);
 	}
 
-	return false;
+	_GraphEntity_UpdateMask(en);
+	return true;
 }
 
 /* Add a new property to entity */
@@ -53,40 +224,109 @@ bool GraphEntity_AddProperty(GraphEntity *e, Attribute_ID attr_id, SIValue value
 	ASSERT(e);
 	if(SIValue_IsNull(value)) return false;
 
-	if(e->entity->properties == NULL) {
-		e->entity->properties = rm_malloc(sizeof(EntityProperty));
+	Entity *en = e->entity;
+	if(en->properties == NULL) {
+		en->properties = rm_malloc(sizeof(EntityProperty));
 	} else {
-		e->entity->properties = rm_realloc(e->entity->properties,
-										   sizeof(EntityProperty) * (e->entity->prop_count + 1));
+		en->properties = rm_realloc(en->properties,
+									sizeof(EntityProperty) * (en->prop_count + 1));
 	}
 
-	int prop_idx = e->entity->prop_count;
-	e->entity->properties[prop_idx].id = attr_id;
-	e->entity->properties[prop_idx].value = SI_CloneValue(value);
-	e->entity->prop_count++;
+	// insert at the attribute's sorted position
+	int prop_idx = _GraphEntity_LowerBound(en, 0, attr_id);
+	ASSERT(prop_idx == en->prop_count || en->properties[prop_idx].id != attr_id);
+	memmove(en->properties + prop_idx + 1, en->properties + prop_idx,
+			sizeof(EntityProperty) * (en->prop_count - prop_idx));
+	_GraphEntity_StoreProperty(en->properties + prop_idx, attr_id, value);
+	en->prop_count++;
+	en->attr_mask |= ATTRIBUTE_BIT(attr_id);
 
 	return true;
 }
 
-SIValue *GraphEntity_GetProperty(const GraphEntity *e, Attribute_ID attr_id) {
-	if(attr_id == ATTRIBUTE_NOTFOUND) return PROPERTY_NOTFOUND;
+void GraphEntity_AdoptProperties(GraphEntity *e, EntityProperty *properties, int count) {
+	ASSERT(e && e->entity->properties == NULL);
+
+	if(count == 0) {
+		rm_free(properties);
+		return;
+	}
+
+	// properties are owned by the entity, intern their heap allocated strings
+	// and move strings long enough into the value log
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	if(gc && (gc->string_pool || gc->value_log)) {
+		for(int i = 0; i < count; i++) {
+			EntityProperty *p = properties + i;
+			if(PROPERTY_TYPE(p->tag) != T_STRING) continue;
+			PropertyEncoding enc = PROPERTY_ENCODING(p->tag);
+			if(enc != PROP_ENC_HEAP &&
+			   (enc != PROP_ENC_INTERNED || gc->value_log == NULL)) continue;
+			EntityProperty stored;
+			_GraphEntity_StoreProperty(&stored, p->id, EntityProperty_Value(p));
+			EntityProperty_Free(p);
+			*p = stored;
+		}
+	}
+
+	// sort properties by ID, bags are small and usually nearly sorted
+	for(int i = 1; i < count; i++) {
+		EntityProperty p = properties[i];
+		int j = i;
+		for(; j > 0 && properties[j - 1].id > p.id; j--) properties[j] = properties[j - 1];
+		properties[j] = p;
+	}
+
+	e->entity->properties = properties;
+	e->entity->prop_count = count;
+	_GraphEntity_UpdateMask(e->entity);
+}
+
+SIValue GraphEntity_GetProperty(const GraphEntity *e, Attribute_ID attr_id) {
+	if(attr_id == ATTRIBUTE_NOTFOUND) return *PROPERTY_NOTFOUND;
 	if(e->entity == NULL) {
 		/* The internal entity pointer should only be NULL if the entity
 		 * is in an intermediate state, such as a node scheduled for creation.
 		 * Note that this exception may cause memory to be leaked in the caller. */
 		ASSERT(e->id == INVALID_ENTITY_ID);
 		ErrorCtx_SetError("Attempted to access undefined property");
-		return PROPERTY_NOTFOUND;
+		return *PROPERTY_NOTFOUND;
 	}
 
-	for(int i = 0; i < e->entity->prop_count; i++) {
-		if(attr_id == e->entity->properties[i].id) {
-			// Note, unsafe as entity properties can get reallocated.
-			return &(e->entity->properties[i].value);
-		}
+	// Note, unsafe as entity properties can get reallocated.
+	EntityProperty *p = _GraphEntity_FindProperty(e->entity, attr_id);
+	if(p == NULL) return *PROPERTY_NOTFOUND;
+	return EntityProperty_Value(p);
+}
+
+void GraphEntity_GetProperties(const GraphEntity *e, const Attribute_ID *attr_ids,
+							   uint count, SIValue *values) {
+	ASSERT(e && (attr_ids || count == 0) && (values || count == 0));
+
+	if(e->entity == NULL) {
+		// see GraphEntity_GetProperty
+		ASSERT(e->id == INVALID_ENTITY_ID);
+		if(count > 0) ErrorCtx_SetError("Attempted to access undefined property");
+		for(uint i = 0; i < count; i++) values[i] = *PROPERTY_NOTFOUND;
+		return;
 	}
 
-	return PROPERTY_NOTFOUND;
+	const Entity *en = e->entity;
+	int lo = 0;  // search start, advances while IDs are ascending
+	Attribute_ID prev = 0;
+	for(uint i = 0; i < count; i++) {
+		Attribute_ID attr_id = attr_ids[i];
+		values[i] = *PROPERTY_NOTFOUND;
+		if(attr_id == ATTRIBUTE_NOTFOUND) continue;
+		if(attr_id < prev) lo = 0;
+		prev = attr_id;
+		if(!(en->attr_mask & ATTRIBUTE_BIT(attr_id))) continue;
+
+		lo = _GraphEntity_LowerBound(en, lo, attr_id);
+		if(lo < en->prop_count && en->properties[lo].id == attr_id) {
+			values[i] = EntityProperty_Value(en->properties + lo);
+		}
+	}
 }
 
 // Updates existing property value.
@@ -96,15 +336,15 @@ bool GraphEntity_SetProperty(const GraphEntity *e, Attribute_ID attr_id, SIValue
 	// Setting an attribute value to NULL removes that attribute.
 	if(SIValue_IsNull(value)) return _GraphEntity_RemoveProperty(e, attr_id);
 
-	SIValue *current = GraphEntity_GetProperty(e, attr_id);
-	ASSERT(current != PROPERTY_NOTFOUND);
+	EntityProperty *current = _GraphEntity_FindProperty(e->entity, attr_id);
+	ASSERT(current != NULL);
 
 	// compare current value to new value, only update if current != new
-	if(SIValue_Compare(*current, value, NULL) == 0) return false;
+	if(SIValue_Compare(EntityProperty_Value(current), value, NULL) == 0) return false;
 
 	// value != current, update entity
-	SIValue_Free(*current);
-	*current = SI_CloneValue(value);
+	EntityProperty_Free(current);
+	_GraphEntity_StoreProperty(current, attr_id, value);
 	return true;
 }
 
@@ -131,7 +371,7 @@ size_t GraphEntity_PropertiesToString(const GraphEntity *e, char **buffer, size_
 		*bytesWritten += snprintf(*buffer + *bytesWritten, *bufferLen, "%s:", key);
 
 		// print value
-		SIValue_ToString(properties[i].value, buffer, bufferLen, bytesWritten);
+		SIValue_ToString(EntityProperty_Value(properties + i), buffer, bufferLen, bytesWritten);
 
 		// if not the last element print ", "
 		if(i != propCount - 1) *bytesWritten = snprintf(*buffer + *bytesWritten, *bufferLen, ", ");
@@ -220,17 +460,53 @@ void GraphEntity_ToString(const GraphEntity *e, char **buffer, size_t *bufferLen
 	*bytesWritten += snprintf(*buffer + *bytesWritten, *bufferLen, "%s", closeSymbole);
 }
 
-inline bool GraphEntity_IsDeleted(const GraphEntity *e) {
-	return Graph_EntityIsDeleted(e->entity);
+// Returns the number of bytes allocated by a heap allocated value.
+static size_t _SIValue_HeapSize(SIValue v) {
+	switch(SI_TYPE(v)) {
+	case T_STRING:
+		return strlen(v.stringval) + 1;
+	case T_ARRAY:
+		return SIArray_MemoryUsage(v);
+	default:
+		return 0;
+	}
+}
+
+size_t Entity_PropertiesMemoryUsage(const Entity *e) {
+	ASSERT(e);
+
+	size_t usage = sizeof(EntityProperty) * e->prop_count;
+	for(int i = 0; i < e->prop_count; i++) {
+		const EntityProperty *p = e->properties + i;
+		// interned and logged strings are accounted for by their pool and log
+		if(PROPERTY_ENCODING(p->tag) != PROP_ENC_HEAP) continue;
+		usage += _SIValue_HeapSize(EntityProperty_Value(p));
+	}
+
+	return usage;
+}
+
+void Entity_RelocateLoggedProperties(Entity *e) {
+	ASSERT(e);
+
+	for(int i = 0; i < e->prop_count; i++) {
+		EntityProperty *p = e->properties + i;
+		if(PROPERTY_ENCODING(p->tag) != PROP_ENC_LOGGED) continue;
+		char *s;
+		memcpy(&s, p->payload, sizeof(char *));
+		s = ValueLog_Relocate(s);
+		memcpy(p->payload, &s, sizeof(char *));
+	}
 }
 
 void FreeEntity(Entity *e) {
 	ASSERT(e);
 	if(e->properties != NULL) {
-		for(int i = 0; i < e->prop_count; i++) SIValue_Free(e->properties[i].value);
+		for(int i = 0; i < e->prop_count; i++) EntityProperty_Free(e->properties + i);
 		rm_free(e->properties);
 		e->properties = NULL;
 		e->prop_count = 0;
+		e->attr_mask = 0;
 	}
 }
 
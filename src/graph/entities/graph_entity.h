@@ -19,6 +19,9 @@
 #define ENTITY_PROP_COUNT(graphEntity) ((graphEntity)->entity->prop_count)
 #define ENTITY_PROPS(graphEntity) ((graphEntity)->entity->properties)
 
+// Maximum length of a string property value stored inline.
+#define PROPERTY_INLINE_STRLEN 12
+
 // Defined in graph_entity.c
 extern SIValue *PROPERTY_NOTFOUND;
 
@@ -43,16 +46,22 @@ typedef enum GraphEntityType {
 	GETYPE_EDGE
 } GraphEntityType;
 
+/* Packed attribute value, numerics, booleans, points and strings of up to
+ * PROPERTY_INLINE_STRLEN bytes are stored inline, other values keep a pointer
+ * to their allocation. A single tag byte encodes both the value's type
+ * and how it is stored, properties are expanded into SIValues on access. */
 typedef struct {
-	Attribute_ID id;
-	SIValue value;
+	Attribute_ID id;                             // Attribute ID.
+	uint8_t tag;                                 // Value type and encoding.
+	uint8_t payload[PROPERTY_INLINE_STRLEN + 1]; // Encoded value.
 } EntityProperty;
 
 // Essence of a graph entity.
 // TODO: see if pragma pack 0 will cause memory access violation on ARM.
 typedef struct {
 	int prop_count;             // Number of properties.
-	EntityProperty *properties; // Key value pair of attributes.
+	uint32_t attr_mask;         // Bit (ID % 32) is set for each attribute held.
+	EntityProperty *properties; // Key value pair of attributes, sorted by ID.
 } Entity;
 
 // Common denominator between nodes and edges.
@@ -61,14 +70,36 @@ typedef struct {
 	EntityID id;
 } GraphEntity;
 
+/* Encodes value into property p, p takes ownership over value's allocations
+ * allocations which value does not own are duplicated. */
+void EntityProperty_Set(EntityProperty *p, Attribute_ID attr_id, SIValue value);
+
+/* Expands property p into an SIValue sharing p's allocations,
+ * the returned value is valid as long as the property is not modified. */
+SIValue EntityProperty_Value(const EntityProperty *p);
+
+// Release property p's allocations.
+void EntityProperty_Free(EntityProperty *p);
+
 /* Adds property to entity
  * returns - reference to newly added property. */
 bool GraphEntity_AddProperty(GraphEntity *e, Attribute_ID attr_id, SIValue value);
 
-/* Retrieves entity's property
- * NOTE: If the key does not exist, we return the special
- * constant value PROPERTY_NOTFOUND. */
-SIValue *GraphEntity_GetProperty(const GraphEntity *e, Attribute_ID attr_id);
+/* Hands properties, an array of count properties, to a property-less entity
+ * the entity takes ownership over both the array and its values. */
+void GraphEntity_AdoptProperties(GraphEntity *e, EntityProperty *properties, int count);
+
+/* Retrieves entity's property, the returned value shares the property's
+ * allocations, see EntityProperty_Value.
+ * NOTE: If the key does not exist, we return a NULL value,
+ * stored properties are never NULL. */
+SIValue GraphEntity_GetProperty(const GraphEntity *e, Attribute_ID attr_id);
+
+/* Retrieves count properties of entity at once, values[i] is set to
+ * attribute attr_ids[i], a NULL value if missing.
+ * Attributes requested in ascending order are located in a single pass. */
+void GraphEntity_GetProperties(const GraphEntity *e, const Attribute_ID *attr_ids,
+							   uint count, SIValue *values);
 
 /* Updates existing attribute value, return true if property been updated. */
 bool GraphEntity_SetProperty(const GraphEntity *e, Attribute_ID attr_id, SIValue value);
@@ -78,10 +109,15 @@ void GraphEntity_ToString(const GraphEntity *e, char **buffer, size_t *bufferLen
 						  size_t *bytesWritten,
 						  GraphEntityStringFromat format, GraphEntityType entityType);
 
-// Returns true if the given graph entity has been deleted.
-bool GraphEntity_IsDeleted(const GraphEntity *e);
-
 /* Release all memory allocated by entity */
+/* Returns the number of bytes held by the entity's properties,
+ * excluding interned strings. */
+size_t Entity_PropertiesMemoryUsage(const Entity *e);
+
+/* Re-references the entity's value log strings residing in segments
+ * being compacted, see ValueLog_Relocate. */
+void Entity_RelocateLoggedProperties(Entity *e);
+
 void FreeEntity(Entity *e);
 
 #endif
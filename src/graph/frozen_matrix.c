@@ -0,0 +1,259 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "frozen_matrix.h"
+#include "RG.h"
+#include "graph.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+
+static inline uint8_t *_varint_write(uint8_t *buf, uint64_t v) {
+	while(v >= 0x80) {
+		*buf++ = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	*buf++ = (uint8_t)v;
+	return buf;
+}
+
+static inline const uint8_t *_varint_read(const uint8_t *buf, uint64_t *v) {
+	uint64_t x = 0;
+	uint shift = 0;
+	while(*buf & 0x80) {
+		x |= (uint64_t)(*buf++ & 0x7F) << shift;
+		shift += 7;
+	}
+	x |= (uint64_t)(*buf++) << shift;
+	*v = x;
+	return buf;
+}
+
+static inline size_t _varint_len(uint64_t v) {
+	size_t len = 1;
+	while(v >= 0x80) {
+		v >>= 7;
+		len++;
+	}
+	return len;
+}
+
+FrozenMatrix *FrozenMatrix_New(GrB_Matrix M, const MultiEdgeTable *t) {
+	ASSERT(M != NULL && t != NULL);
+
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Index dim;
+	GrB_Index nvals;
+	info = GrB_Matrix_nrows(&dim, M);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_nvals(&nvals, M);
+	ASSERT(info == GrB_SUCCESS);
+
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * MAX(nvals, 1));
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * MAX(nvals, 1));
+	uint64_t  *X = rm_malloc(sizeof(uint64_t) * MAX(nvals, 1));
+	GrB_Index n = nvals;
+	info = GrB_Matrix_extractTuples_UINT64(I, J, X, &n, M);
+	ASSERT(info == GrB_SUCCESS && n == nvals);
+
+	// size both streams ahead of encoding
+	uint64_t row_count = 0;
+	size_t cols_size = 0;
+	size_t edges_size = 0;
+	for(GrB_Index k = 0; k < n; k++) {
+		bool new_row = (k == 0 || I[k] != I[k - 1]);
+		// CSR matrices yield their tuples in row major order
+		ASSERT(new_row || J[k] > J[k - 1]);
+		if(new_row) row_count++;
+		cols_size += _varint_len(new_row ? J[k] : J[k] - J[k - 1]);
+
+		if(SINGLE_EDGE(X[k])) {
+			edges_size += _varint_len(SINGLE_EDGE_ID(X[k]) << 1);
+		} else {
+			uint32_t count;
+			const EdgeID *ids = MultiEdgeTable_Run(t, MULTI_EDGE_RUN(X[k]), &count);
+			for(uint32_t i = 0; i < count; i++) edges_size += _varint_len(ids[i] << 1);
+		}
+	}
+
+	FrozenMatrix *fm = rm_malloc(sizeof(FrozenMatrix));
+	fm->dim = dim;
+	fm->nvals = n;
+	fm->row_count = row_count;
+	fm->rows = rm_malloc(sizeof(GrB_Index) * MAX(row_count, 1));
+	fm->col_offsets = rm_malloc(sizeof(uint64_t) * (row_count + 1));
+	fm->edge_offsets = rm_malloc(sizeof(uint64_t) * (row_count + 1));
+	fm->cols = rm_malloc(MAX(cols_size, 1));
+	fm->edges = rm_malloc(MAX(edges_size, 1));
+
+	uint8_t *col = fm->cols;
+	uint8_t *edge = fm->edges;
+	uint64_t row = 0;
+	for(GrB_Index k = 0; k < n; k++) {
+		bool new_row = (k == 0 || I[k] != I[k - 1]);
+		if(new_row) {
+			fm->rows[row] = I[k];
+			fm->col_offsets[row] = col - fm->cols;
+			fm->edge_offsets[row] = edge - fm->edges;
+			row++;
+		}
+		// first column of a row is absolute, subsequent ones are deltas
+		col = _varint_write(col, new_row ? J[k] : J[k] - J[k - 1]);
+
+		if(SINGLE_EDGE(X[k])) {
+			edge = _varint_write(edge, SINGLE_EDGE_ID(X[k]) << 1);
+		} else {
+			uint32_t count;
+			const EdgeID *ids = MultiEdgeTable_Run(t, MULTI_EDGE_RUN(X[k]), &count);
+			for(uint32_t i = 0; i < count; i++) {
+				uint64_t more = (i + 1 < count);
+				edge = _varint_write(edge, (ids[i] << 1) | more);
+			}
+		}
+	}
+	fm->col_offsets[row_count] = col - fm->cols;
+	fm->edge_offsets[row_count] = edge - fm->edges;
+	ASSERT((size_t)(col - fm->cols) == cols_size);
+	ASSERT((size_t)(edge - fm->edges) == edges_size);
+
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+	return fm;
+}
+
+GrB_Matrix FrozenMatrix_Thaw(const FrozenMatrix *fm, GrB_Index dim, MultiEdgeTable *t) {
+	ASSERT(fm != NULL && t != NULL && dim >= fm->dim);
+
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Index n = fm->nvals;
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * MAX(n, 1));
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * MAX(n, 1));
+	uint64_t  *X = rm_malloc(sizeof(uint64_t) * MAX(n, 1));
+
+	GrB_Index k = 0;
+	FrozenMatrixRowIter it;
+	EdgeID *ids = array_new(EdgeID, 2);
+	for(uint64_t r = 0; r < fm->row_count; r++) {
+		GrB_Index col;
+		FrozenMatrix_IterateRow(fm, fm->rows[r], &it);
+		while(FrozenMatrixRowIter_Next(&it, &col)) {
+			EdgeID id;
+			array_clear(ids);
+			while(FrozenMatrixRowIter_NextEdge(&it, &id)) ids = array_append(ids, id);
+			uint32_t count = array_len(ids);
+			X[k] = (count == 1) ? SET_MSB(ids[0]) : MultiEdgeTable_NewRun(t, ids, count);
+			I[k] = fm->rows[r];
+			J[k] = col;
+			k++;
+		}
+	}
+	ASSERT(k == n);
+	array_free(ids);
+
+	GrB_Matrix M;
+	info = GrB_Matrix_new(&M, GrB_UINT64, dim, dim);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_build_UINT64(M, I, J, X, n, GrB_FIRST_UINT64);
+	ASSERT(info == GrB_SUCCESS);
+
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+	return M;
+}
+
+size_t FrozenMatrix_MemoryUsage(const FrozenMatrix *fm) {
+	ASSERT(fm != NULL);
+	return sizeof(FrozenMatrix) +
+		   sizeof(GrB_Index) * fm->row_count +
+		   sizeof(uint64_t) * (fm->row_count + 1) * 2 +
+		   fm->col_offsets[fm->row_count] +
+		   fm->edge_offsets[fm->row_count];
+}
+
+void FrozenMatrix_IterateRow(const FrozenMatrix *fm, GrB_Index row, FrozenMatrixRowIter *it) {
+	ASSERT(fm != NULL && it != NULL);
+
+	it->col = NULL;
+	it->col_end = NULL;
+	it->edge = NULL;
+	it->last_col = 0;
+	it->started = false;
+	it->pending = false;
+
+	// binary search for row
+	uint64_t lo = 0;
+	uint64_t hi = fm->row_count;
+	while(lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		if(fm->rows[mid] < row) lo = mid + 1;
+		else hi = mid;
+	}
+	if(lo == fm->row_count || fm->rows[lo] != row) return;
+
+	it->col = fm->cols + fm->col_offsets[lo];
+	it->col_end = fm->cols + fm->col_offsets[lo + 1];
+	it->edge = fm->edges + fm->edge_offsets[lo];
+}
+
+bool FrozenMatrixRowIter_Next(FrozenMatrixRowIter *it, GrB_Index *col) {
+	ASSERT(it != NULL);
+
+	// skip edges of the current entry which were not retrieved
+	EdgeID id;
+	while(FrozenMatrixRowIter_NextEdge(it, &id));
+
+	if(it->col == it->col_end) return false;
+
+	uint64_t delta;
+	it->col = _varint_read(it->col, &delta);
+	it->last_col = it->started ? it->last_col + delta : delta;
+	it->started = true;
+	it->pending = true;
+
+	if(col) *col = it->last_col;
+	return true;
+}
+
+bool FrozenMatrixRowIter_Seek(FrozenMatrixRowIter *it, GrB_Index col) {
+	ASSERT(it != NULL);
+
+	if(it->started && it->last_col == col) return true;
+
+	GrB_Index c;
+	while(FrozenMatrixRowIter_Next(it, &c)) {
+		if(c == col) return true;
+		if(c > col) return false;
+	}
+	return false;
+}
+
+bool FrozenMatrixRowIter_NextEdge(FrozenMatrixRowIter *it, EdgeID *id) {
+	ASSERT(it != NULL && id != NULL);
+
+	if(!it->pending) return false;
+
+	uint64_t v;
+	it->edge = _varint_read(it->edge, &v);
+	*id = v >> 1;
+	it->pending = (v & 1);
+	return true;
+}
+
+void FrozenMatrix_Free(FrozenMatrix *fm) {
+	ASSERT(fm != NULL);
+	rm_free(fm->rows);
+	rm_free(fm->col_offsets);
+	rm_free(fm->edge_offsets);
+	rm_free(fm->cols);
+	rm_free(fm->edges);
+	rm_free(fm);
+}
+
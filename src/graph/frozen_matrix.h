@@ -0,0 +1,69 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "multi_edge_table.h"
+#include "entities/graph_entity.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+/* FrozenMatrix is a compressed, read-only copy of a relation matrix.
+ * Only non-empty rows are kept, each row's column indices are delta encoded
+ * as varints, followed in a second stream by the edge IDs of every entry.
+ * Each edge ID is stored as a varint of (id << 1 | more), where 'more' is set
+ * if the entry holds additional edges, such that multi-edge entries require
+ * no separate allocation.
+ * Rows are located by binary search, entries within a row are decoded
+ * sequentially, which is what neighbour iteration requires. */
+typedef struct FrozenMatrix {
+	GrB_Index dim;          // Number of rows and columns at freeze time.
+	GrB_Index nvals;        // Number of entries.
+	uint64_t row_count;     // Number of non-empty rows.
+	GrB_Index *rows;        // IDs of non-empty rows, ascending.
+	uint64_t *col_offsets;  // Row i's columns start at cols[col_offsets[i]].
+	uint64_t *edge_offsets; // Row i's edges start at edges[edge_offsets[i]].
+	uint8_t *cols;          // Delta encoded column indices.
+	uint8_t *edges;         // Edge IDs of every entry.
+} FrozenMatrix;
+
+// Iterator over the entries of a single FrozenMatrix row.
+typedef struct {
+	const uint8_t *col;      // Next encoded column.
+	const uint8_t *col_end;  // End of row's columns.
+	const uint8_t *edge;     // Next encoded edge ID.
+	GrB_Index last_col;      // Last decoded column.
+	bool started;            // A column has been decoded.
+	bool pending;            // Current entry has edges not yet decoded.
+} FrozenMatrixRowIter;
+
+/* Compresses relation matrix M, M must not have pending operations.
+ * The edge IDs of M's multi-edge entries are read from t. */
+FrozenMatrix *FrozenMatrix_New(GrB_Matrix M, const MultiEdgeTable *t);
+
+/* Rebuilds the relation matrix, the edge IDs
+ * of multi-edge entries are placed in new runs of t. */
+GrB_Matrix FrozenMatrix_Thaw(const FrozenMatrix *fm, GrB_Index dim, MultiEdgeTable *t);
+
+// Returns the number of bytes held by fm.
+size_t FrozenMatrix_MemoryUsage(const FrozenMatrix *fm);
+
+// Positions it at the start of row 'row'.
+void FrozenMatrix_IterateRow(const FrozenMatrix *fm, GrB_Index row, FrozenMatrixRowIter *it);
+
+// Advances to the next entry of the row, returns false once depleted.
+bool FrozenMatrixRowIter_Next(FrozenMatrixRowIter *it, GrB_Index *col);
+
+// Advances to the entry at column 'col', returns false if the row lacks it.
+bool FrozenMatrixRowIter_Seek(FrozenMatrixRowIter *it, GrB_Index col);
+
+// Retrieves the next edge ID of the current entry, returns false once depleted.
+bool FrozenMatrixRowIter_NextEdge(FrozenMatrixRowIter *it, EdgeID *id);
+
+// Free fm.
+void FrozenMatrix_Free(FrozenMatrix *fm);
+
@@ -4,72 +4,67 @@
 * This file is available under the Redis Labs Source Available License Agreement
 */
 
+#include <limits.h>
 #include "graph.h"
 #include "RG.h"
 #include "config.h"
+#include "frozen_matrix.h"
+#include "multi_edge_table.h"
 #include "../util/arr.h"
 #include "../util/qsort.h"
 #include "../GraphBLASExt/GxB_Delete.h"
 #include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../util/trace.h"
 #include "../util/datablock/oo_datablock.h"
 
-static GrB_BinaryOp _graph_edge_accum = NULL;
-// GraphBLAS binary operator for freeing edges
-static GrB_BinaryOp _binary_op_delete_edges = NULL;
-
 /* ========================= Forward declarations  ========================= */
 void _MatrixResizeToCapacity(const Graph *g, RG_Matrix m);
+static void _Graph_MergePending(const Graph *g, int r);
 
+/* ========================= RG_Matrix functions =============================== */
 
-/* ========================= GraphBLAS functions ========================= */
-void _edge_accum(void *_z, const void *_x, const void *_y) {
-	EdgeID *z = (EdgeID *)_z;
-	const EdgeID *x = (const EdgeID *)_x;
-	const EdgeID *y = (const EdgeID *)_y;
-
-	EdgeID *ids;
-	/* Single edge ID,
-	 * switching from single edge ID to multiple IDs. */
-	if(SINGLE_EDGE(*x)) {
-		ids = array_new(EdgeID, 2);
-		ids = array_append(ids, SINGLE_EDGE_ID(*x));
-		ids = array_append(ids, SINGLE_EDGE_ID(*y));
-		// TODO: Make sure MSB of ids isn't on.
-		*z = (EdgeID)ids;
-	} else {
-		// Multiple edges, adding another edge.
-		ids = (EdgeID *)(*x);
-		ids = array_append(ids, SINGLE_EDGE_ID(*y));
-		*z = (EdgeID)ids;
-	}
-}
+// Matrices holding at most dim / RG_MATRIX_HYPER_RATIO entries are kept
+// hypersparse, sparing a row pointer per node for nearly empty matrices.
+#define RG_MATRIX_HYPER_RATIO 16
+
+// selects a matrix's sparsity format by its density, once hypersparse
+// a matrix turns sparse only after doubling the threshold, such that a
+// matrix whose density hovers around the threshold isn't converted repeatedly
+// bitmap is never selected, graph matrices are iterated by the tuple iterator
+// which would otherwise convert them under a read lock
+static void _RG_Matrix_SelectSparsity(GrB_Matrix m) {
+	GrB_Info info;
+	GrB_Index dim;
+	GrB_Index nvals;
+	int control;
 
-void _binary_op_free_edge(void *z, const void *x, const void *y) {
-	const Graph *g = (const Graph *) * ((uint64_t *)x);
-	const EdgeID *id = (const EdgeID *)y;
+	GrB_Matrix_nrows(&dim, m);
+	GrB_Matrix_nvals(&nvals, m);
+	info = GxB_get(m, GxB_SPARSITY_CONTROL, &control);
+	ASSERT(info == GrB_SUCCESS);
 
-	if((SINGLE_EDGE(*id))) {
-		DataBlock_DeleteItem(g->edges, SINGLE_EDGE_ID(*id));
-	} else {
-		EdgeID *ids = (EdgeID *)(*id);
-		uint id_count = array_len(ids);
-		for(uint i = 0; i < id_count; i++) {
-			DataBlock_DeleteItem(g->edges, ids[i]);
-		}
-		array_free(ids);
-	}
-}
+	GrB_Index limit = dim / RG_MATRIX_HYPER_RATIO;
+	if(control == GxB_HYPERSPARSE) limit *= 2;
 
-/* ========================= RG_Matrix functions =============================== */
+	int sparsity = (nvals <= limit) ? GxB_HYPERSPARSE : GxB_SPARSE;
+	if(sparsity == control) return;
+
+	info = GxB_set(m, GxB_SPARSITY_CONTROL, sparsity);
+	UNUSED(info);
+	ASSERT(info == GrB_SUCCESS);
+}
 
 // Creates a new matrix
 static RG_Matrix RG_Matrix_New(GrB_Type data_type, GrB_Index nrows, GrB_Index ncols) {
 	RG_Matrix matrix = rm_calloc(1, sizeof(_RG_Matrix));
 
 	matrix->allow_multi_edge = true;
+	matrix->dirty = true;
 
 	GrB_Info matrix_res = GrB_Matrix_new(&matrix->grb_matrix, data_type, nrows, ncols);
 	ASSERT(matrix_res == GrB_SUCCESS);
+	_RG_Matrix_SelectSparsity(matrix->grb_matrix);
 
 	int mutex_res = pthread_mutex_init(&matrix->mutex, NULL);
 	ASSERT(mutex_res == 0);
@@ -92,28 +87,160 @@ static inline void _RG_Matrix_Unlock(RG_Matrix matrix) {
 	pthread_mutex_unlock(&matrix->mutex);
 }
 
+// Marks matrix as holding changes (pending tuples, zombies or
+// out of date dimensions) which were not folded into it yet.
+static inline void _RG_Matrix_MarkDirty(RG_Matrix matrix) {
+	__atomic_store_n(&matrix->dirty, true, __ATOMIC_RELAXED);
+}
+
+// Marks matrix as synchronized, all changes had been applied.
+static inline void _RG_Matrix_ClearDirty(RG_Matrix matrix) {
+	__atomic_store_n(&matrix->dirty, false, __ATOMIC_RELEASE);
+}
+
+// Returns true if matrix holds changes which were not applied.
+static inline bool _RG_Matrix_IsDirty(RG_Matrix matrix) {
+	return __atomic_load_n(&matrix->dirty, __ATOMIC_ACQUIRE);
+}
+
 static inline bool _RG_Matrix_MultiEdgeEnabled(RG_Matrix matrix) {
 	return matrix->allow_multi_edge;
 }
 
 // Free RG_Matrix.
 static void RG_Matrix_Free(RG_Matrix matrix) {
+	if(matrix->frozen) FrozenMatrix_Free(matrix->frozen);
+	if(matrix->multi_edges) MultiEdgeTable_Free(matrix->multi_edges);
+	if(matrix->pending) array_free(matrix->pending);
 	GrB_Matrix_free(&matrix->grb_matrix);
 	pthread_mutex_destroy(&matrix->mutex);
 	rm_free(matrix);
 }
 
+// Returns relation r's frozen copy, NULL if relation r isn't frozen.
+static inline const FrozenMatrix *_Graph_FrozenRelation(const Graph *g, int r) {
+	return g->relations[r]->frozen;
+}
+
+/* Rebuilds relation r's matrix from its frozen copy.
+ * A maintained transposed matrix references the relation's multi-edge runs,
+ * these are kept while frozen and the matrix is restored by transposition. */
+static GrB_Matrix _RG_Matrix_Unfreeze(const Graph *g, int r, GrB_Index dim) {
+	RG_Matrix matrix = g->relations[r];
+	if(g->t_relations == NULL) {
+		return FrozenMatrix_Thaw(matrix->frozen, dim, matrix->multi_edges);
+	}
+
+	GrB_Info info;
+	UNUSED(info);
+	RG_Matrix TM = g->t_relations[r];
+	RG_Matrix_Lock(TM);
+
+	GrB_Index n;
+	GrB_Matrix m;
+	info = GrB_Matrix_nrows(&n, TM->grb_matrix);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_new(&m, GrB_UINT64, n, n);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_transpose(m, GrB_NULL, GrB_NULL, TM->grb_matrix, GrB_NULL);
+	ASSERT(info == GrB_SUCCESS);
+
+	_RG_Matrix_Unlock(TM);
+
+	if(n < dim) {
+		info = GxB_Matrix_resize(m, dim, dim);
+		ASSERT(info == GrB_SUCCESS);
+	}
+	return m;
+}
+
+/* Restores the GrB_Matrix of a frozen relation matrix.
+ * A writer discards the frozen copy as the matrix is about to be modified,
+ * readers keep it as other readers might be iterating it. */
+static void _RG_Matrix_Thaw(const Graph *g, int r) {
+	RG_Matrix matrix = g->relations[r];
+	if(matrix->frozen == NULL) return;
+
+	// matrix dimensions may exceed the node count during bulk loading
+	GrB_Index dim = MAX(matrix->frozen->dim, Graph_RequiredMatrixDim(g));
+
+	if(g->_writelocked) {
+		if(matrix->grb_matrix == NULL) {
+			matrix->grb_matrix = _RG_Matrix_Unfreeze(g, r, dim);
+		}
+		FrozenMatrix_Free(matrix->frozen);
+		matrix->frozen = NULL;
+		_RG_Matrix_MarkDirty(matrix);
+		return;
+	}
+
+	// fast path, matrix was already thawed by a reader
+	if(__atomic_load_n(&matrix->grb_matrix, __ATOMIC_ACQUIRE) != NULL) return;
+
+	RG_Matrix_Lock(matrix);
+	if(matrix->grb_matrix == NULL) {
+		GrB_Matrix m = _RG_Matrix_Unfreeze(g, r, dim);
+		__atomic_store_n(&matrix->grb_matrix, m, __ATOMIC_RELEASE);
+	}
+	_RG_Matrix_Unlock(matrix);
+}
+
 /* ========================= Synchronization functions ========================= */
 
+// accounts for the time elapsed since timer was started waiting for lock
+static inline void _Graph_AddLockWait(Graph *g, GraphLock lock, double timer[2]) {
+	uint64_t us = simple_toc(timer) * 1000000;
+	__atomic_fetch_add(g->_lock_wait + lock, us, __ATOMIC_RELAXED);
+}
+
+double Graph_LockWait(const Graph *g, GraphLock lock) {
+	ASSERT(lock < GRAPH_LOCK_COUNT);
+	return (double)__atomic_load_n(g->_lock_wait + lock, __ATOMIC_RELAXED) / 1000;
+}
+
 /* Acquire a lock that does not restrict access from additional reader threads */
 void Graph_AcquireReadLock(Graph *g) {
-	pthread_rwlock_rdlock(&g->_rwlock);
+	TRACE_PROBE2(lock__acquire, g, 0);
+	// only contended acquisitions are timed
+	if(pthread_rwlock_tryrdlock(&g->_rwlock) != 0) {
+		double timer[2];
+		simple_tic(timer);
+		pthread_rwlock_rdlock(&g->_rwlock);
+		_Graph_AddLockWait(g, GRAPH_LOCK_READ, timer);
+	}
+	TRACE_PROBE2(lock__acquired, g, 0);
+}
+
+/* Acquire a read lock if it isn't held by a writer, without blocking */
+bool Graph_TryAcquireReadLock(Graph *g) {
+	return pthread_rwlock_tryrdlock(&g->_rwlock) == 0;
 }
 
 /* Acquire a lock for exclusive access to this graph's data */
 void Graph_AcquireWriteLock(Graph *g) {
-	pthread_rwlock_wrlock(&g->_rwlock);
+	TRACE_PROBE2(lock__acquire, g, 1);
+	double timer[2];
+	simple_tic(timer);
+	bool contended = (pthread_rwlock_trywrlock(&g->_rwlock) != 0);
+	if(contended) pthread_rwlock_wrlock(&g->_rwlock);
+
+	// suspended readers still hold on to the graph, wait for them to
+	// resume and release the read lock they reacquired
+	pthread_mutex_lock(&g->_suspend_mutex);
+	while(g->_suspended_readers > 0) {
+		pthread_rwlock_unlock(&g->_rwlock);
+		pthread_cond_wait(&g->_suspend_cond, &g->_suspend_mutex);
+		pthread_mutex_unlock(&g->_suspend_mutex);
+		pthread_rwlock_wrlock(&g->_rwlock);
+		pthread_mutex_lock(&g->_suspend_mutex);
+		contended = true;
+	}
+	pthread_mutex_unlock(&g->_suspend_mutex);
+	if(contended) _Graph_AddLockWait(g, GRAPH_LOCK_WRITE, timer);
+
 	g->_writelocked = true;
+	g->_write_epoch++;
+	TRACE_PROBE2(lock__acquired, g, 1);
 }
 
 /* Release the held lock */
@@ -127,11 +254,39 @@ void Graph_ReleaseLock(Graph *g) {
 	 * before setting `_writelocked` to false. */
 	g->_writelocked = false;
 	pthread_rwlock_unlock(&g->_rwlock);
+	TRACE_PROBE1(lock__release, g);
+}
+
+void Graph_SuspendReadLock(Graph *g) {
+	// register as suspended before unlocking,
+	// writers can't hold the lock at this point
+	pthread_mutex_lock(&g->_suspend_mutex);
+	g->_suspended_readers++;
+	pthread_mutex_unlock(&g->_suspend_mutex);
+	pthread_rwlock_unlock(&g->_rwlock);
+}
+
+void Graph_ResumeReadLock(Graph *g) {
+	pthread_rwlock_rdlock(&g->_rwlock);
+	pthread_mutex_lock(&g->_suspend_mutex);
+	ASSERT(g->_suspended_readers > 0);
+	if(--g->_suspended_readers == 0) pthread_cond_broadcast(&g->_suspend_cond);
+	pthread_mutex_unlock(&g->_suspend_mutex);
 }
 
 /* Writer request access to graph. */
 void Graph_WriterEnter(Graph *g) {
+	if(pthread_mutex_trylock(&g->_writers_mutex) == 0) return;
+
+	double timer[2];
+	simple_tic(timer);
 	pthread_mutex_lock(&g->_writers_mutex);
+	_Graph_AddLockWait(g, GRAPH_LOCK_WRITERS, timer);
+}
+
+/* Writer request access to graph without blocking. */
+bool Graph_TryWriterEnter(Graph *g) {
+	return pthread_mutex_trylock(&g->_writers_mutex) == 0;
 }
 
 /* Writer release access to graph. */
@@ -139,6 +294,10 @@ void Graph_WriterLeave(Graph *g) {
 	pthread_mutex_unlock(&g->_writers_mutex);
 }
 
+uint64_t Graph_WriteEpoch(const Graph *g) {
+	return g->_write_epoch;
+}
+
 /* Force execution of all pending operations on a matrix. */
 static inline void _Graph_ApplyPending(GrB_Matrix m) {
 	GrB_Info res = GrB_wait(&m);
@@ -157,67 +316,196 @@ size_t _Graph_EdgeCap(const Graph *g) {
 	return g->edges->itemCap;
 }
 
-// Locates edges connecting src to destination.
-void _Graph_GetEdgesConnectingNodes(const Graph *g, NodeID src, NodeID dest, int r, Edge **edges) {
-	ASSERT(g && src < Graph_RequiredMatrixDim(g) && dest < Graph_RequiredMatrixDim(g) &&
-		   r < Graph_RelationTypeCount(g));
+// discards the computed degrees of relation r, every relation if r is GRAPH_NO_RELATION
+static void _Graph_DiscardDegrees(Graph *g, int r) {
+	uint count = array_len(g->degrees);
+	for(uint i = 0; i < count; i++) {
+		if(r != GRAPH_NO_RELATION && (int)i != r) continue;
+		RelationDegrees *d = g->degrees + i;
+		if(d->out) array_free(d->out);
+		if(d->in) array_free(d->in);
+		d->out = NULL;
+		d->in = NULL;
+	}
+}
+
+// marks the cached transpose of relation r as stale,
+// every relation if r is GRAPH_NO_RELATION
+static void _Graph_InvalidateTransposes(Graph *g, int r) {
+	uint count = array_len(g->t_cache);
+	for(uint i = 0; i < count; i++) {
+		if(r != GRAPH_NO_RELATION && (int)i != r) continue;
+		g->t_cache[i].stale = true;
+	}
+}
 
+// sets entry [dest, src] of relation r's cached transpose
+// invoked by writers, patching the cache instead of recomputing it
+static void _Graph_PatchTranspose(Graph *g, int r, NodeID src, NodeID dest,
+		uint64_t v) {
+	if(g->t_cache == NULL) return;
+	TransposeCache *c = g->t_cache + r;
+	if(c->m == NULL || c->stale) return;
+
+	GrB_Info info;
+	UNUSED(info);
+	GrB_Index n;
+	GrB_Index dims = Graph_RequiredMatrixDim(g);
+	GrB_Matrix TR = RG_Matrix_Get_GrB_Matrix(c->m);
+	GrB_Matrix_nrows(&n, TR);
+	if(n != dims) {
+		info = GxB_Matrix_resize(TR, dims, dims);
+		ASSERT(info == GrB_SUCCESS);
+	}
+	info = GrB_Matrix_setElement_UINT64(TR, v, dest, src);
+	ASSERT(info == GrB_SUCCESS);
+}
+
+// adds delta to the computed degrees of relation r's edge connecting src to dest
+static void _Graph_AdjustDegrees(Graph *g, int r, NodeID src, NodeID dest,
+		int64_t delta) {
+	RelationDegrees *d = g->degrees + r;
+	NodeID ids[2] = {src, dest};
+	uint64_t **degrees[2] = {&d->out, &d->in};
+
+	for(int i = 0; i < 2; i++) {
+		uint64_t *v = *degrees[i];
+		if(v == NULL) continue;
+
+		uint64_t len = array_len(v);
+		if(ids[i] >= len) {
+			v = array_ensure_len(v, ids[i] + 1);
+			memset(v + len, 0, sizeof(uint64_t) * (ids[i] + 1 - len));
+			*degrees[i] = v;
+		}
+		v[ids[i]] += delta;
+	}
+}
+
+// Collects the edges of a frozen relation entry, see FrozenMatrixRowIter_Seek.
+static void _Graph_CollectFrozenEdges(const Graph *g, FrozenMatrixRowIter *it,
+		NodeID src, NodeID dest, int r, Edge **edges) {
 	Edge e;
 	EdgeID edgeId;
 	e.relationID = r;
 	e.srcNodeID = src;
 	e.destNodeID = dest;
 
-	// relation map, maps (src, dest, r) to edge IDs.
-	GrB_Matrix relation = Graph_GetRelationMatrix(g, r);
-	GrB_Info res = GrB_Matrix_extractElement_UINT64(&edgeId, relation, src, dest);
-
-	// No entry at [dest, src], src is not connected to dest with relation R.
-	if(res == GrB_NO_VALUE) return;
-
-	if(SINGLE_EDGE(edgeId)) {
-		// Discard most significate bit.
-		edgeId = SINGLE_EDGE_ID(edgeId);
+	while(FrozenMatrixRowIter_NextEdge(it, &edgeId)) {
 		e.entity = DataBlock_GetItem(g->edges, edgeId);
 		e.id = edgeId;
 		ASSERT(e.entity);
 		*edges = array_append(*edges, e);
+	}
+}
+
+// Collects the edges of relation matrix entry R[src, dest],
+// either a single edge ID or the ID of a run of edge IDs.
+static void _Graph_CollectEntryEdges(const Graph *g, NodeID src, NodeID dest, int r,
+		EdgeID entry, Edge **edges) {
+	if(SINGLE_EDGE(entry)) {
+		Edge e;
+		// Discard most significate bit.
+		e.id = SINGLE_EDGE_ID(entry);
+		e.entity = DataBlock_GetItem(g->edges, e.id);
+		e.relationID = r;
+		e.srcNodeID = src;
+		e.destNodeID = dest;
+		ASSERT(e.entity);
+		*edges = array_append(*edges, e);
 	} else {
 		/* Multiple edges connecting src to dest,
-		 * entry is a pointer to an array of edge IDs. */
-		EdgeID *edgeIds = (EdgeID *)edgeId;
-		int edgeCount = array_len(edgeIds);
-
-		for(int i = 0; i < edgeCount; i++) {
-			edgeId = edgeIds[i];
-			e.entity = DataBlock_GetItem(g->edges, edgeId);
-			e.id = edgeId;
-			ASSERT(e.entity);
-			*edges = array_append(*edges, e);
+		 * entry is the ID of a run of edge IDs. */
+		uint32_t edgeCount;
+		const EdgeID *edgeIds = Graph_MultiEdgeIDs(g, r, entry, &edgeCount);
+
+		// runs may be long, retrieve them while prefetching the edges ahead
+		uint32_t len = array_len(*edges);
+		*edges = array_ensure_len(*edges, len + edgeCount);
+		Graph_GetEdges(g, edgeIds, edgeCount, *edges + len);
+	}
+}
+
+// Locates edges connecting src to destination.
+void _Graph_GetEdgesConnectingNodes(const Graph *g, NodeID src, NodeID dest, int r, Edge **edges) {
+	ASSERT(g && src < Graph_RequiredMatrixDim(g) && dest < Graph_RequiredMatrixDim(g) &&
+		   r < Graph_RelationTypeCount(g));
+
+	// frozen relation, decode entry in place
+	const FrozenMatrix *fm = _Graph_FrozenRelation(g, r);
+	if(fm != NULL) {
+		FrozenMatrixRowIter it;
+		FrozenMatrix_IterateRow(fm, src, &it);
+		if(FrozenMatrixRowIter_Seek(&it, dest)) {
+			_Graph_CollectFrozenEdges(g, &it, src, dest, r, edges);
 		}
+		return;
 	}
+
+	EdgeID edgeId;
+
+	// relation map, maps (src, dest, r) to edge IDs.
+	GrB_Matrix relation = Graph_GetRelationMatrix(g, r);
+	GrB_Info res = GrB_Matrix_extractElement_UINT64(&edgeId, relation, src, dest);
+
+	// No entry at [dest, src], src is not connected to dest with relation R.
+	if(res == GrB_NO_VALUE) return;
+
+	_Graph_CollectEntryEdges(g, src, dest, r, edgeId, edges);
 }
 
 // Tests if there's an edge of type r between src and dest nodes.
 bool Graph_EdgeExists(const Graph *g, NodeID srcID, NodeID destID, int r) {
 	ASSERT(g);
+
+	if(r != GRAPH_NO_RELATION) {
+		const FrozenMatrix *fm = _Graph_FrozenRelation(g, r);
+		if(fm != NULL) {
+			FrozenMatrixRowIter it;
+			FrozenMatrix_IterateRow(fm, destID, &it);
+			return FrozenMatrixRowIter_Seek(&it, srcID);
+		}
+	}
+
 	EdgeID edgeId;
 	GrB_Matrix M = Graph_GetRelationMatrix(g, r);
 	GrB_Info res = GrB_Matrix_extractElement_UINT64(&edgeId, M, destID, srcID);
 	return res == GrB_SUCCESS;
 }
 
-static inline Entity *_Graph_GetEntity(const DataBlock *entities, EntityID id) {
-	return DataBlock_GetItem(entities, id);
+// node and edge storage items are of a fixed size, see Graph_New
+static inline Entity *_Graph_GetNodeEntity(const Graph *g, NodeID id) {
+	return DataBlock_GetItemSized(g->nodes, id, sizeof(Entity));
+}
+
+static inline Entity *_Graph_GetEdgeEntity(const Graph *g, EdgeID id) {
+	return DataBlock_GetItemSized(g->edges, id, sizeof(EdgeRecord));
+}
+
+// sets e's endpoints and relation type to those held by its record
+static inline void _Graph_ResolveEdge(Edge *e) {
+	const EdgeRecord *rec = (const EdgeRecord *)e->entity;
+	e->srcNodeID = rec->srcNodeID;
+	e->destNodeID = rec->destNodeID;
+	e->relationID = rec->relationID;
 }
 
 /* ============= Matrix synchronization and resizing functions =============== */
 
+// time spent by the calling thread synchronizing matrices, in milliseconds
+static __thread double _sync_time = 0;
+
+double Graph_SyncTime(void) {
+	return _sync_time;
+}
+
 /* Resize given matrix, such that its number of row and columns
  * matches the number of nodes in the graph. Also, synchronize
  * matrix to execute any pending operations. */
 void _MatrixSynchronize(const Graph *g, RG_Matrix rg_matrix) {
 	GrB_Matrix m = RG_Matrix_Get_GrB_Matrix(rg_matrix);
+	// frozen matrices hold no pending changes
+	if(m == NULL) return;
 	GrB_Index n_rows;
 	GrB_Index n_cols;
 	GrB_Matrix_nrows(&n_rows, m);
@@ -231,11 +519,19 @@ void _MatrixSynchronize(const Graph *g, RG_Matrix rg_matrix) {
 			ASSERT(res == GrB_SUCCESS);
 		}
 
-		// Writer under write lock, no need to flush pending changes.
+		// Writer under write lock, no need to flush pending changes,
+		// these are folded in by Graph_FlushAllPending once the writer commits.
+		_RG_Matrix_MarkDirty(rg_matrix);
 		return;
 	}
 
+	// Fast path, matrix was compacted by the last writer, no need to lock.
+	if(!_RG_Matrix_IsDirty(rg_matrix) && n_rows == dims && n_cols == dims) return;
+
 	// Lock the matrix.
+	double timer[2];
+	simple_tic(timer);
+	TRACE_PROBE1(matrix__sync__start, rg_matrix);
 	RG_Matrix_Lock(rg_matrix);
 
 	bool pending = false;
@@ -254,25 +550,38 @@ void _MatrixSynchronize(const Graph *g, RG_Matrix rg_matrix) {
 		}
 		// Flush changes to matrix.
 		_Graph_ApplyPending(m);
+		// readers iterate m only once its dirty flag is cleared
+		_RG_Matrix_SelectSparsity(m);
 	}
+	_RG_Matrix_ClearDirty(rg_matrix);
+
 	// Unlock matrix mutex.
 	_RG_Matrix_Unlock(rg_matrix);
+	TRACE_PROBE1(matrix__sync__done, rg_matrix);
+	_sync_time += simple_toc(timer) * 1000;
 }
 
-/* Resize matrix to node capacity. */
+/* Resize matrix to the dimension reserved by Graph_AllocateNodes,
+ * such that the writer's commit doesn't shrink it back to the node count,
+ * lacking a reservation the matrix is resized to node capacity. */
 void _MatrixResizeToCapacity(const Graph *g, RG_Matrix matrix) {
 	GrB_Matrix m = RG_Matrix_Get_GrB_Matrix(matrix);
+	if(m == NULL) return;
 	GrB_Index nrows;
 	GrB_Index ncols;
 	GrB_Matrix_ncols(&ncols, m);
 	GrB_Matrix_nrows(&nrows, m);
-	GrB_Index cap = _Graph_NodeCap(g);
+	GrB_Index cap = (g->_reserved_dim >= Graph_RequiredMatrixDim(g)) ?
+		g->_reserved_dim : _Graph_NodeCap(g);
 
 	// This policy should only be used in a thread-safe context, so no locking is required.
 	if(ncols != cap || nrows != cap) {
 		GrB_Info res = GxB_Matrix_resize(m, cap, cap);
 		ASSERT(res == GrB_SUCCESS);
 	}
+
+	// Matrix is expected to be modified, dimensions exceed node count.
+	_RG_Matrix_MarkDirty(matrix);
 }
 
 /* Do not update matrices. */
@@ -290,7 +599,7 @@ void Graph_SetMatrixPolicy(Graph *g, MATRIX_POLICY policy) {
 			break;
 		case RESIZE_TO_CAPACITY:
 			// Bulk insertion and creation behavior; does not force pending operations
-			// and resizes matrices to the graph's current node capacity.
+			// and resizes matrices to fit the nodes reserved for creation.
 			g->SynchronizeMatrix = _MatrixResizeToCapacity;
 			break;
 		case DISABLED:
@@ -327,6 +636,86 @@ void Graph_ApplyAllPending(Graph *g) {
 	}
 }
 
+/* Resize matrix to the graph's node count and apply all of its
+ * pending operations, caller is expected to hold the write lock. */
+static void _MatrixFlush(const Graph *g, RG_Matrix rg_matrix) {
+	if(!_RG_Matrix_IsDirty(rg_matrix)) return;
+
+	GrB_Matrix m = RG_Matrix_Get_GrB_Matrix(rg_matrix);
+	if(m == NULL) return;
+	GrB_Index n_rows;
+	GrB_Index n_cols;
+	GrB_Matrix_nrows(&n_rows, m);
+	GrB_Matrix_ncols(&n_cols, m);
+	GrB_Index dims = Graph_RequiredMatrixDim(g);
+
+	if((n_rows != dims) || (n_cols != dims)) {
+		GrB_Info res = GxB_Matrix_resize(m, dims, dims);
+		ASSERT(res == GrB_SUCCESS);
+	}
+
+	_Graph_ApplyPending(m);
+	_RG_Matrix_SelectSparsity(m);
+	_RG_Matrix_ClearDirty(rg_matrix);
+}
+
+void Graph_FlushAllPending(Graph *g) {
+	ASSERT(g && g->_writelocked);
+
+	_MatrixFlush(g, g->adjacency_matrix);
+	_MatrixFlush(g, g->_t_adjacency_matrix);
+	_MatrixFlush(g, g->_zero_matrix);
+
+	uint label_count = array_len(g->labels);
+	for(uint i = 0; i < label_count; i ++) _MatrixFlush(g, g->labels[i]);
+
+	uint relation_count = array_len(g->relations);
+	for(uint i = 0; i < relation_count; i ++) _Graph_MergePending(g, i);
+	for(uint i = 0; i < relation_count; i ++) _MatrixFlush(g, g->relations[i]);
+
+	if(g->t_relations) {
+		for(uint i = 0; i < relation_count; i ++) _MatrixFlush(g, g->t_relations[i]);
+	}
+
+	// reservations span a single commit
+	g->_reserved_dim = 0;
+}
+
+void Graph_FreezeRelations(Graph *g) {
+	ASSERT(g);
+
+	// runs referenced by transposed matrices outlive the frozen relation
+	bool keep_runs = (g->t_relations != NULL);
+
+	uint relation_count = array_len(g->relations);
+	for(uint i = 0; i < relation_count; i++) {
+		RG_Matrix M = g->relations[i];
+		if(M->frozen != NULL) {
+			// thawed by a reader, the frozen copy is still valid
+			if(M->grb_matrix != NULL) {
+				if(!keep_runs) MultiEdgeTable_Clear(M->multi_edges);
+				GrB_Matrix_free(&M->grb_matrix);
+			}
+			continue;
+		}
+
+		_Graph_MergePending(g, i);
+		_RG_Matrix_MarkDirty(M);
+		_MatrixFlush(g, M);
+
+		// edge IDs are copied into the frozen matrix
+		M->frozen = FrozenMatrix_New(M->grb_matrix, M->multi_edges);
+		if(!keep_runs) MultiEdgeTable_Clear(M->multi_edges);
+		GrB_Matrix_free(&M->grb_matrix);
+		M->grb_matrix = NULL;
+	}
+}
+
+bool Graph_RelationFrozen(const Graph *g, int r) {
+	ASSERT(g && r >= 0 && r < Graph_RelationTypeCount(g));
+	return _Graph_FrozenRelation(g, r) != NULL;
+}
+
 /* ================================ Graph API ================================ */
 Graph *Graph_New(size_t node_cap, size_t edge_cap) {
 	node_cap = MAX(node_cap, GRAPH_DEFAULT_NODE_CAP);
@@ -334,18 +723,23 @@ Graph *Graph_New(size_t node_cap, size_t edge_cap) {
 
 	Graph *g = rm_malloc(sizeof(Graph));
 	g->nodes = DataBlock_New(node_cap, sizeof(Entity), (fpDestructor)FreeEntity);
-	g->edges = DataBlock_New(edge_cap, sizeof(Entity), (fpDestructor)FreeEntity);
+	g->edges = DataBlock_New(edge_cap, sizeof(EdgeRecord), (fpDestructor)FreeEntity);
 	g->labels = array_new(RG_Matrix, GRAPH_DEFAULT_LABEL_CAP);
 	g->relations = array_new(RG_Matrix, GRAPH_DEFAULT_RELATION_TYPE_CAP);
 	g->adjacency_matrix = RG_Matrix_New(GrB_BOOL, node_cap, node_cap);
 	g->_t_adjacency_matrix = RG_Matrix_New(GrB_BOOL, node_cap, node_cap);
+	Config_Option_get(Config_MAINTAIN_ADJACENCY, &g->_maintain_adjacency);
+	g->_adjacency_stale = false;
 	g->_zero_matrix = RG_Matrix_New(GrB_BOOL, node_cap, node_cap);
+	g->degrees = array_new(RelationDegrees, GRAPH_DEFAULT_RELATION_TYPE_CAP);
 
 	// If we're maintaining transposed relation matrices, allocate a new array, otherwise NULL-set the pointer.
 	bool maintain_transpose;
 	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
 	g->t_relations = maintain_transpose ?
 					 array_new(RG_Matrix, GRAPH_DEFAULT_RELATION_TYPE_CAP) : NULL;
+	g->t_cache = maintain_transpose ?
+				 NULL : array_new(TransposeCache, GRAPH_DEFAULT_RELATION_TYPE_CAP);
 
 	// Initialize a read-write lock scoped to the individual graph
 	int res;
@@ -353,6 +747,10 @@ Graph *Graph_New(size_t node_cap, size_t edge_cap) {
 	res = pthread_rwlock_init(&g->_rwlock, NULL);
 	ASSERT(res == 0);
 	g->_writelocked = false;
+	g->_write_epoch = 0;
+	g->_reserved_dim = 0;
+	g->_suspended_readers = 0;
+	for(int i = 0; i < GRAPH_LOCK_COUNT; i++) g->_lock_wait[i] = 0;
 
 	// Force GraphBLAS updates and resize matrices to node count by default
 	Graph_SetMatrixPolicy(g, SYNC_AND_MINIMIZE_SPACE);
@@ -360,14 +758,12 @@ Graph *Graph_New(size_t node_cap, size_t edge_cap) {
 	// Synchronization objects initialization.
 	res = pthread_mutex_init(&g->_writers_mutex, NULL);
 	ASSERT(res == 0);
-
-	// Create edge accumulator binary function
-	if(!_graph_edge_accum) {
-		GrB_Info info;
-		UNUSED(info);
-		info = GrB_BinaryOp_new(&_graph_edge_accum, _edge_accum, GrB_UINT64, GrB_UINT64, GrB_UINT64);
-		ASSERT(info == GrB_SUCCESS);
-	}
+	res = pthread_mutex_init(&g->_suspend_mutex, NULL);
+	ASSERT(res == 0);
+	res = pthread_mutex_init(&g->_degrees_mutex, NULL);
+	ASSERT(res == 0);
+	res = pthread_cond_init(&g->_suspend_cond, NULL);
+	ASSERT(res == 0);
 
 	return g;
 }
@@ -402,6 +798,114 @@ size_t Graph_EdgeCount(const Graph *g) {
 	return g->edges->itemCount;
 }
 
+size_t Graph_RelationEdgeCount(const Graph *g, int relation) {
+	if(relation >= 0) {
+		const FrozenMatrix *fm = _Graph_FrozenRelation(g, relation);
+		if(fm) return fm->nvals;
+	}
+
+	GrB_Index nvals = 0;
+	GrB_Matrix m = Graph_GetRelationMatrix(g, relation);
+	if(m) GrB_Matrix_nvals(&nvals, m);
+	return nvals;
+}
+
+uint64_t Graph_RelationEdgeTotal(const Graph *g, int relation) {
+	ASSERT(g && relation >= 0 && relation < Graph_RelationTypeCount(g));
+
+	GrB_Index nvals = 0;
+	GrB_Matrix m = Graph_GetRelationMatrix(g, relation);
+	GrB_Matrix_nvals(&nvals, m);
+
+	// each run stands in for its edges within a single entry
+	const MultiEdgeTable *t = g->relations[relation]->multi_edges;
+	return nvals + t->edge_count - MultiEdgeTable_RunCount(t);
+}
+
+// computes the number of edges of relation r per node, rows are counted
+// unless 'incoming' is set, in which case columns are counted
+static uint64_t *_Graph_ComputeDegrees(const Graph *g, int r, bool incoming) {
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Index nvals;
+	GrB_Matrix R = Graph_GetRelationMatrix(g, r);
+	info = GrB_Matrix_nvals(&nvals, R);
+	ASSERT(info == GrB_SUCCESS);
+
+	size_t dim = Graph_RequiredMatrixDim(g);
+	uint64_t *degrees = array_newlen(uint64_t, dim);
+	memset(degrees, 0, sizeof(uint64_t) * dim);
+	if(nvals == 0) return degrees;
+
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * nvals);
+	uint64_t *X = rm_malloc(sizeof(uint64_t) * nvals);
+	if(incoming) {
+		info = GrB_Matrix_extractTuples_UINT64(GrB_NULL, I, X, &nvals, R);
+	} else {
+		info = GrB_Matrix_extractTuples_UINT64(I, GrB_NULL, X, &nvals, R);
+	}
+	ASSERT(info == GrB_SUCCESS);
+
+	// a multi-edge entry stands in for each of its run's edges
+	const MultiEdgeTable *t = g->relations[r]->multi_edges;
+	for(GrB_Index i = 0; i < nvals; i++) {
+		uint32_t count = 1;
+		if(!(SINGLE_EDGE(X[i]))) MultiEdgeTable_Run(t, MULTI_EDGE_RUN(X[i]), &count);
+		degrees[I[i]] += count;
+	}
+
+	rm_free(I);
+	rm_free(X);
+	return degrees;
+}
+
+// returns relation r's degrees, computing them if missing
+static const uint64_t *_Graph_Degrees(const Graph *g, int r, bool incoming) {
+	RelationDegrees *d = g->degrees + r;
+	uint64_t **degrees = (incoming) ? &d->in : &d->out;
+
+	// readers compute missing degrees one at a time
+	uint64_t *res = __atomic_load_n(degrees, __ATOMIC_ACQUIRE);
+	if(res != NULL) return res;
+
+	pthread_mutex_t *mutex = (pthread_mutex_t *)&g->_degrees_mutex;
+	pthread_mutex_lock(mutex);
+	res = *degrees;
+	if(res == NULL) {
+		res = _Graph_ComputeDegrees(g, r, incoming);
+		__atomic_store_n(degrees, res, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(mutex);
+
+	return res;
+}
+
+static inline uint64_t _Graph_RelationDegree(const Graph *g, NodeID id, int r,
+		bool incoming) {
+	const uint64_t *degrees = _Graph_Degrees(g, r, incoming);
+	return (id < array_len((uint64_t *)degrees)) ? degrees[id] : 0;
+}
+
+uint64_t Graph_NodeDegree(const Graph *g, NodeID id, int r, GRAPH_EDGE_DIR dir) {
+	ASSERT(g && (r == GRAPH_NO_RELATION || r < Graph_RelationTypeCount(g)));
+
+	int first = r;
+	int last = r + 1;
+	if(r == GRAPH_NO_RELATION) {
+		first = 0;
+		last = Graph_RelationTypeCount(g);
+	}
+
+	uint64_t degree = 0;
+	for(int i = first; i < last; i++) {
+		if(dir != GRAPH_EDGE_DIR_INCOMING) degree += _Graph_RelationDegree(g, id, i, false);
+		if(dir != GRAPH_EDGE_DIR_OUTGOING) degree += _Graph_RelationDegree(g, id, i, true);
+	}
+
+	return degree;
+}
+
 uint Graph_DeletedEdgeCount(const Graph *g) {
 	ASSERT(g);
 	return DataBlock_DeletedItemsCount(g->edges);
@@ -418,6 +922,10 @@ int Graph_LabelTypeCount(const Graph *g) {
 void Graph_AllocateNodes(Graph *g, size_t n) {
 	ASSERT(g);
 	DataBlock_Accommodate(g->nodes, n);
+
+	// new nodes reuse deleted IDs before extending the ID range
+	GrB_Index dim = MAX(Graph_RequiredMatrixDim(g), Graph_NodeCount(g) + n);
+	g->_reserved_dim = MAX(g->_reserved_dim, dim);
 }
 
 void Graph_AllocateEdges(Graph *g, size_t n) {
@@ -427,16 +935,54 @@ void Graph_AllocateEdges(Graph *g, size_t n) {
 
 int Graph_GetNode(const Graph *g, NodeID id, Node *n) {
 	ASSERT(g);
-	n->entity = _Graph_GetEntity(g->nodes, id);
+	n->entity = _Graph_GetNodeEntity(g, id);
 	n->id = id;
 	return (n->entity != NULL);
 }
 
+void Graph_PrefetchNode(const Graph *g, NodeID id) {
+	ASSERT(g);
+	DataBlock_PrefetchItem(g->nodes, id);
+}
+
 int Graph_GetEdge(const Graph *g, EdgeID id, Edge *e) {
 	ASSERT(g && id < _Graph_EdgeCap(g));
-	e->entity = _Graph_GetEntity(g->edges, id);
+	e->entity = _Graph_GetEdgeEntity(g, id);
 	e->id = id;
-	return (e->entity != NULL);
+	if(e->entity == NULL) return 0;
+
+	_Graph_ResolveEdge(e);
+	return 1;
+}
+
+void Graph_GetNodes(const Graph *g, const NodeID *ids, uint64_t count, Node *nodes) {
+	ASSERT(g && (ids || count == 0) && nodes);
+
+	uint64_t head = MIN(count, DATABLOCK_PREFETCH_DISTANCE);
+	for(uint64_t i = 0; i < head; i++) DataBlock_PrefetchItem(g->nodes, ids[i]);
+
+	for(uint64_t i = 0; i < count; i++) {
+		uint64_t ahead = i + DATABLOCK_PREFETCH_DISTANCE;
+		if(ahead < count) DataBlock_PrefetchItem(g->nodes, ids[ahead]);
+		nodes[i].entity = _Graph_GetNodeEntity(g, ids[i]);
+		nodes[i].id = ids[i];
+	}
+}
+
+void Graph_GetEdges(const Graph *g, const EdgeID *ids, uint64_t count, Edge *edges) {
+	ASSERT(g && (ids || count == 0) && edges);
+
+	uint64_t head = MIN(count, DATABLOCK_PREFETCH_DISTANCE);
+	for(uint64_t i = 0; i < head; i++) DataBlock_PrefetchItem(g->edges, ids[i]);
+
+	for(uint64_t i = 0; i < count; i++) {
+		uint64_t ahead = i + DATABLOCK_PREFETCH_DISTANCE;
+		if(ahead < count) DataBlock_PrefetchItem(g->edges, ids[ahead]);
+		Edge *e = edges + i;
+		e->entity = _Graph_GetEdgeEntity(g, ids[i]);
+		e->id = ids[i];
+		if(e->entity != NULL) _Graph_ResolveEdge(e);
+	}
 }
 
 int Graph_GetNodeLabel(const Graph *g, NodeID nodeID) {
@@ -456,43 +1002,19 @@ int Graph_GetNodeLabel(const Graph *g, NodeID nodeID) {
 }
 
 int Graph_GetEdgeRelation(const Graph *g, Edge *e) {
-	ASSERT(g && e);
-	NodeID srcNodeID = Edge_GetSrcNodeID(e);
-	NodeID destNodeID = Edge_GetDestNodeID(e);
-	EdgeID id = ENTITY_GET_ID(e);
-
-	// Search for relation mapping matrix M, where
-	// M[dest,src] == edge ID.
-	uint relationship_count = array_len(g->relations);
-	for(uint i = 0; i < relationship_count; i++) {
-		EdgeID edgeId = 0;
-		GrB_Matrix M = Graph_GetRelationMatrix(g, i);
-		GrB_Info res = GrB_Matrix_extractElement_UINT64(&edgeId, M, srcNodeID, destNodeID);
-		if(res != GrB_SUCCESS) continue;
-
-		if(SINGLE_EDGE(edgeId)) {
-			EdgeID curEdgeID = SINGLE_EDGE_ID(edgeId);
-			if(curEdgeID == id) {
-				Edge_SetRelationID(e, i);
-				return i;
-			}
-		} else {
-			/* Multiple edges exists between src and dest
-			 * see if given edge is one of them. */
-			EdgeID *edges = (EdgeID *)edgeId;
-			int edge_count = array_len(edges);
-			for(int j = 0; j < edge_count; j++) {
-				if(edges[j] == id) {
-					Edge_SetRelationID(e, i);
-					return i;
-				}
-			}
-		}
-	}
+	ASSERT(g && e && e->entity);
 
-	// We must be able to find edge relation.
-	ASSERT(false);
-	return GRAPH_NO_RELATION;
+	// the edge's record holds its relation type
+	const EdgeRecord *rec = (const EdgeRecord *)e->entity;
+	ASSERT(rec->relationID != GRAPH_NO_RELATION);
+	Edge_SetRelationID(e, rec->relationID);
+	return rec->relationID;
+}
+
+const EdgeID *Graph_MultiEdgeIDs(const Graph *g, int r, EdgeID entry, uint32_t *count) {
+	ASSERT(g && count && r >= 0 && r < Graph_RelationTypeCount(g));
+	ASSERT(!(SINGLE_EDGE(entry)));
+	return MultiEdgeTable_Run(g->relations[r]->multi_edges, MULTI_EDGE_RUN(entry), count);
 }
 
 void Graph_GetEdgesConnectingNodes(const Graph *g, NodeID srcID, NodeID destID, int r,
@@ -527,6 +1049,7 @@ void Graph_CreateNode(Graph *g, int label, Node *n) {
 	n->id = id;
 	n->entity = en;
 	en->prop_count = 0;
+	en->attr_mask = 0;
 	en->properties = NULL;
 
 	if(label != GRAPH_NO_LABEL) {
@@ -534,6 +1057,7 @@ void Graph_CreateNode(Graph *g, int label, Node *n) {
 		// incase of a failure, scale matrix.
 		RG_Matrix matrix = g->labels[label];
 		GrB_Matrix m = RG_Matrix_Get_GrB_Matrix(matrix);
+		_RG_Matrix_MarkDirty(matrix);
 		GrB_Info res = GrB_Matrix_setElement_BOOL(m, true, id, id);
 		if(res != GrB_SUCCESS) {
 			_MatrixResizeToCapacity(g, matrix);
@@ -547,93 +1071,507 @@ void Graph_FormConnection(Graph *g, NodeID src, NodeID dest, EdgeID edge_id, int
 	GrB_Info info;
 	UNUSED(info);
 	RG_Matrix M = g->relations[r];
-	GrB_Matrix t_relationMat = NULL;
-	GrB_Matrix adj = Graph_GetAdjacencyMatrix(g);
-	GrB_Matrix tadj = Graph_GetTransposedAdjacencyMatrix(g);
+	if(g->_maintain_adjacency) {
+		GrB_Matrix adj = Graph_GetAdjacencyMatrix(g);
+		GrB_Matrix tadj = Graph_GetTransposedAdjacencyMatrix(g);
+
+		// Rows represent source nodes, columns represent destination nodes.
+		GrB_Matrix_setElement_BOOL(adj, true, src, dest);
+		GrB_Matrix_setElement_BOOL(tadj, true, dest, src);
+	} else {
+		g->_adjacency_stale = true;
+	}
+	_Graph_AdjustDegrees(g, r, src, dest, 1);
+
+	/* Matrix multi-edge is enabled for this matrix, src might already be
+	 * connected to dest, defer connection until the relation matrix is
+	 * accessed, at which point all pending connections are merged at once. */
+	if(_RG_Matrix_MultiEdgeEnabled(M)) {
+		_RG_Matrix_Thaw(g, r);
+		_Graph_InvalidateTransposes(g, r);
+		if(M->pending == NULL) M->pending = array_new(PendingConnection, 16);
+		PendingConnection c = {.src = src, .dest = dest, .id = edge_id};
+		M->pending = array_append(M->pending, c);
+		return;
+	}
+
+	// Multi-edge is disabled, use GrB_Matrix_setElement.
+	edge_id = SET_MSB(edge_id);
 	GrB_Matrix relationMat = Graph_GetRelationMatrix(g, r);
+	info = GrB_Matrix_setElement_UINT64(relationMat, edge_id, src, dest);
+	ASSERT(info == GrB_SUCCESS);
 
+	// Update the transposed matrix if one is present.
+	bool maintain_transpose;
+	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
+	if(maintain_transpose) {
+		GrB_Matrix t_relationMat = Graph_GetTransposedRelationMatrix(g, r);
+		info = GrB_Matrix_setElement_UINT64(t_relationMat, edge_id, dest, src);
+		ASSERT(info == GrB_SUCCESS);
+	} else {
+		_Graph_PatchTranspose(g, r, src, dest, edge_id);
+	}
+}
+
+void Graph_CreateEdge(Graph *g, NodeID src, NodeID dest, int r, Edge *e) {
+	Node srcNode = GE_NEW_NODE();
+	Node destNode = GE_NEW_NODE();
+
+	int res;
+	UNUSED(res);
+	res = Graph_GetNode(g, src, &srcNode);
+	ASSERT(res == 1);
+	res = Graph_GetNode(g, dest, &destNode);
+	ASSERT(res == 1);
+	ASSERT(g && r < Graph_RelationTypeCount(g));
+
+	EdgeID id;
+	EdgeRecord *rec = DataBlock_AllocateItem(g->edges, &id);
+	rec->entity.prop_count = 0;
+	rec->entity.attr_mask = 0;
+	rec->entity.properties = NULL;
+	rec->srcNodeID = src;
+	rec->destNodeID = dest;
+	rec->relationID = r;
+	e->id = id;
+	e->entity = &rec->entity;
+	e->relationID = r;
+	e->srcNodeID = src;
+	e->destNodeID = dest;
+}
+
+int Graph_ConnectNodes(Graph *g, NodeID src, NodeID dest, int r, Edge *e) {
+	Graph_CreateEdge(g, src, dest, r, e);
+	Graph_FormConnection(g, src, dest, e->id, r);
+	return 1;
+}
+
+// C = C + {(I[k], J[k]) = X[k]}, entries sharing a position are merged by op
+static void _Graph_BuildInto(GrB_Matrix C, const GrB_Index *I,
+		const GrB_Index *J, const void *X, GrB_Index n, GrB_Type type,
+		GrB_BinaryOp op) {
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Index nrows;
+	GrB_Index nvals;
+	info = GrB_Matrix_nrows(&nrows, C);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_nvals(&nvals, C);
+	ASSERT(info == GrB_SUCCESS);
+
+	// build directly into an empty matrix
+	GrB_Matrix B = C;
+	if(nvals > 0) {
+		info = GrB_Matrix_new(&B, type, nrows, nrows);
+		ASSERT(info == GrB_SUCCESS);
+	}
+
+	if(type == GrB_BOOL) {
+		info = GrB_Matrix_build_BOOL(B, I, J, X, n, op);
+	} else {
+		info = GrB_Matrix_build_UINT64(B, I, J, X, n, op);
+	}
+	ASSERT(info == GrB_SUCCESS);
+
+	if(B != C) {
+		info = GrB_eWiseAdd(C, GrB_NULL, GrB_NULL, op, C, B, GrB_NULL);
+		ASSERT(info == GrB_SUCCESS);
+		GrB_free(&B);
+	}
+}
+
+#define PENDING_CONNECTION_ISLT(a, b) \
+	((a)->src < (b)->src || ((a)->src == (b)->src && \
+	((a)->dest < (b)->dest || ((a)->dest == (b)->dest && (a)->id < (b)->id))))
+
+/* Merges connections into relation r's matrices.
+ * Connections sharing a source and destination, either with one another or
+ * with an existing entry, are gathered into a single multi-edge run. */
+static void _Graph_MergeConnections(const Graph *g, int r, PendingConnection *conns,
+		uint64_t n) {
+	GrB_Info info;
+	UNUSED(info);
+
+	RG_Matrix M = g->relations[r];
+	RG_Matrix TM = (g->t_relations) ? g->t_relations[r] : NULL;
+	MultiEdgeTable *t = M->multi_edges;
+	GrB_Matrix R = RG_Matrix_Get_GrB_Matrix(M);
+	GrB_Matrix TR = (TM) ? RG_Matrix_Get_GrB_Matrix(TM) : NULL;
+
+	// make sure matrices are able to hold every connection
+	GrB_Index nrows;
+	GrB_Index dim = Graph_RequiredMatrixDim(g);
+	GrB_Matrix_nrows(&nrows, R);
+	if(nrows < dim) {
+		info = GxB_Matrix_resize(R, dim, dim);
+		ASSERT(info == GrB_SUCCESS);
+	}
+	if(TR) {
+		GrB_Matrix_nrows(&nrows, TR);
+		if(nrows < dim) {
+			info = GxB_Matrix_resize(TR, dim, dim);
+			ASSERT(info == GrB_SUCCESS);
+		}
+	}
+
+	// group connections by source and destination
+	// bulk inserted connections usually arrive presorted
+	uint64_t sorted = 1;
+	while(sorted < n && !PENDING_CONNECTION_ISLT(conns + sorted, conns + sorted - 1)) {
+		sorted++;
+	}
+	if(sorted < n) QSORT(PendingConnection, conns, n, PENDING_CONNECTION_ISLT);
+
+	// fold in pending operations once, such that lookups are cheap
+	GrB_Index nvals;
+	info = GrB_Matrix_nvals(&nvals, R);
+	ASSERT(info == GrB_SUCCESS);
+
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * n);
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * n);
+	uint64_t  *X = rm_malloc(sizeof(uint64_t) * n);
+	EdgeID *ids = array_new(EdgeID, 2);
+
+	GrB_Index k = 0;
+	for(uint64_t i = 0; i < n;) {
+		NodeID src = conns[i].src;
+		NodeID dest = conns[i].dest;
+		uint64_t j = i + 1;
+		while(j < n && conns[j].src == src && conns[j].dest == dest) j++;
+
+		EdgeID entry;
+		info = GrB_NO_VALUE;
+		if(nvals > 0) info = GrB_Matrix_extractElement_UINT64(&entry, R, src, dest);
+
+		if(info == GrB_SUCCESS && !(SINGLE_EDGE(entry))) {
+			// src is already connected to dest by multiple edges, extend run
+			for(uint64_t l = i; l < j; l++) {
+				MultiEdgeTable_Append(t, MULTI_EDGE_RUN(entry), conns[l].id);
+			}
+		} else {
+			array_clear(ids);
+			if(info == GrB_SUCCESS) ids = array_append(ids, SINGLE_EDGE_ID(entry));
+			for(uint64_t l = i; l < j; l++) ids = array_append(ids, conns[l].id);
+
+			uint32_t count = array_len(ids);
+			I[k] = src;
+			J[k] = dest;
+			X[k] = (count == 1) ? SET_MSB(ids[0]) : MultiEdgeTable_NewRun(t, ids, count);
+			k++;
+		}
+		i = j;
+	}
+
+	// new entries override existing ones, runs are shared with the transpose
+	if(k > 0) {
+		_RG_Matrix_MarkDirty(M);
+		_Graph_BuildInto(R, I, J, X, k, GrB_UINT64, GrB_SECOND_UINT64);
+		if(TR) {
+			_RG_Matrix_MarkDirty(TM);
+			_Graph_BuildInto(TR, J, I, X, k, GrB_UINT64, GrB_SECOND_UINT64);
+		}
+	}
+
+	array_free(ids);
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+}
+
+// Merges relation r's pending connections, see Graph_FormConnection.
+static void _Graph_MergePending(const Graph *g, int r) {
+	RG_Matrix M = g->relations[r];
+	if(__atomic_load_n(&M->pending, __ATOMIC_ACQUIRE) == NULL) return;
+
+	// readers merge connections left pending by the last writer
+	bool lock = !g->_writelocked;
+	if(lock) RG_Matrix_Lock(M);
+
+	PendingConnection *pending = M->pending;
+	if(pending != NULL) {
+		_Graph_MergeConnections(g, r, pending, array_len(pending));
+		array_free(pending);
+		__atomic_store_n(&M->pending, NULL, __ATOMIC_RELEASE);
+	}
+
+	if(lock) _RG_Matrix_Unlock(M);
+}
+
+void Graph_BulkFormConnections(Graph *g, int r, const GrB_Index *src,
+		const GrB_Index *dest, EdgeID *ids, GrB_Index n) {
+	ASSERT(g != NULL);
+	ASSERT(r < Graph_RelationTypeCount(g));
+	if(n == 0) return;
+
+	_Graph_DiscardDegrees(g, r);
+	_Graph_InvalidateTransposes(g, r);
+	RG_Matrix M = g->relations[r];
+	GrB_Matrix relationMat = Graph_GetRelationMatrix(g, r);
+
+	if(_RG_Matrix_MultiEdgeEnabled(M)) {
+		PendingConnection *conns = rm_malloc(sizeof(PendingConnection) * n);
+		for(GrB_Index i = 0; i < n; i++) {
+			conns[i].src = src[i];
+			conns[i].dest = dest[i];
+			conns[i].id = ids[i];
+		}
+		_Graph_MergeConnections(g, r, conns, n);
+		rm_free(conns);
+		return;
+	}
+
+	GrB_Matrix t_relationMat = NULL;
 	bool maintain_transpose;
 	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
 	if(maintain_transpose) {
 		t_relationMat = Graph_GetTransposedRelationMatrix(g, r);
 	}
 
-	// Rows represent source nodes, columns represent destination nodes.
-	edge_id = SET_MSB(edge_id);
-	GrB_Matrix_setElement_BOOL(adj, true, src, dest);
-	GrB_Matrix_setElement_BOOL(tadj, true, dest, src);
+	for(GrB_Index i = 0; i < n; i++) ids[i] = SET_MSB(ids[i]);
+
+	// similar to Graph_FormConnection, a connection formed over an
+	// existing one overrides it as multi-edge is disabled
+	_RG_Matrix_MarkDirty(M);
+	_Graph_BuildInto(relationMat, src, dest, ids, n, GrB_UINT64, GrB_SECOND_UINT64);
+	if(t_relationMat != NULL) {
+		_RG_Matrix_MarkDirty(g->t_relations[r]);
+		_Graph_BuildInto(t_relationMat, dest, src, ids, n, GrB_UINT64, GrB_SECOND_UINT64);
+	}
+}
+
+void Graph_BulkConnectAdjacency(Graph *g, const GrB_Index *src,
+		const GrB_Index *dest, GrB_Index n) {
+	ASSERT(g != NULL);
+	if(n == 0) return;
+
+	if(!g->_maintain_adjacency) {
+		g->_adjacency_stale = true;
+		return;
+	}
+
+	GrB_Matrix adj = Graph_GetAdjacencyMatrix(g);
+	GrB_Matrix tadj = Graph_GetTransposedAdjacencyMatrix(g);
+
+	// build a structural pattern, every value is true
+	bool *X = rm_malloc(sizeof(bool) * n);
+	memset(X, true, sizeof(bool) * n);
+
+	_RG_Matrix_MarkDirty(g->adjacency_matrix);
+	_Graph_BuildInto(adj, src, dest, X, n, GrB_BOOL, GrB_LOR);
+	_RG_Matrix_MarkDirty(g->_t_adjacency_matrix);
+	_Graph_BuildInto(tadj, dest, src, X, n, GrB_BOOL, GrB_LOR);
+
+	rm_free(X);
+}
+
+// resizes m to dim x dim, if it differs
+static void _Graph_ResizeMatrix(GrB_Matrix m, GrB_Index dim) {
+	GrB_Index nrows;
+	GrB_Matrix_nrows(&nrows, m);
+	if(nrows == dim) return;
+	GrB_Info info = GxB_Matrix_resize(m, dim, dim);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+}
+
+// records the endpoints of every edge held by R, relation r's matrix
+static void _Graph_RecordRelationEdges(Graph *g, int r, GrB_Matrix R) {
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Index nvals;
+	info = GrB_Matrix_nvals(&nvals, R);
+	ASSERT(info == GrB_SUCCESS);
+	if(nvals == 0) return;
+
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * nvals);
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * nvals);
+	uint64_t *X = rm_malloc(sizeof(uint64_t) * nvals);
+	info = GrB_Matrix_extractTuples_UINT64(I, J, X, &nvals, R);
+	ASSERT(info == GrB_SUCCESS);
+
+	MultiEdgeTable *t = g->relations[r]->multi_edges;
+	for(GrB_Index k = 0; k < nvals; k++) {
+		uint32_t count = 1;
+		EdgeID single;
+		const EdgeID *ids = &single;
+		if(SINGLE_EDGE(X[k])) {
+			single = SINGLE_EDGE_ID(X[k]);
+		} else {
+			ids = MultiEdgeTable_Run(t, MULTI_EDGE_RUN(X[k]), &count);
+		}
+
+		for(uint32_t j = 0; j < count; j++) {
+			EdgeRecord *rec = DataBlock_GetItem(g->edges, ids[j]);
+			ASSERT(rec != NULL);
+			rec->srcNodeID = I[k];
+			rec->destNodeID = J[k];
+			rec->relationID = r;
+		}
+	}
+
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+}
+
+void Graph_ImportRelationMatrix(Graph *g, int r, GrB_Matrix R) {
+	ASSERT(g != NULL && R != NULL);
+	ASSERT(r < Graph_RelationTypeCount(g));
+
+	GrB_Info info;
+	UNUSED(info);
+
+	RG_Matrix M = g->relations[r];
+	ASSERT(M->frozen == NULL && M->pending == NULL);
+
+	_Graph_DiscardDegrees(g, r);
+	_Graph_InvalidateTransposes(g, r);
+	_Graph_RecordRelationEdges(g, r, R);
+
+	GrB_Index dim = Graph_RequiredMatrixDim(g);
+	_Graph_ResizeMatrix(R, dim);
+	_RG_Matrix_SelectSparsity(R);
+	GrB_Matrix_free(&M->grb_matrix);
+	M->grb_matrix = R;
+	_RG_Matrix_MarkDirty(M);
+
+	if(g->t_relations) {
+		RG_Matrix TM = g->t_relations[r];
+		GrB_Matrix TR = RG_Matrix_Get_GrB_Matrix(TM);
+		_Graph_ResizeMatrix(TR, dim);
+		info = GrB_transpose(TR, NULL, NULL, R, NULL);
+		ASSERT(info == GrB_SUCCESS);
+		_RG_Matrix_MarkDirty(TM);
+	}
+
+	if(!g->_maintain_adjacency) {
+		g->_adjacency_stale = true;
+		return;
+	}
+
+	// R's structure, run IDs may be zero
+	GrB_Matrix P;
+	info = GrB_Matrix_new(&P, GrB_BOOL, dim, dim);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_apply(P, NULL, NULL, GxB_ONE_BOOL, R, NULL);
+	ASSERT(info == GrB_SUCCESS);
+
+	// adjacency matrices are shared by all relation types
+	GrB_Matrix adj = RG_Matrix_Get_GrB_Matrix(g->adjacency_matrix);
+	GrB_Matrix tadj = RG_Matrix_Get_GrB_Matrix(g->_t_adjacency_matrix);
+	_Graph_ResizeMatrix(adj, dim);
+	_Graph_ResizeMatrix(tadj, dim);
+	info = GrB_eWiseAdd(adj, NULL, NULL, GrB_LOR, adj, P, NULL);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_transpose(tadj, NULL, GrB_LOR, P, NULL);
+	ASSERT(info == GrB_SUCCESS);
+	_RG_Matrix_MarkDirty(g->adjacency_matrix);
+	_RG_Matrix_MarkDirty(g->_t_adjacency_matrix);
+
+	GrB_Matrix_free(&P);
+}
+
+void Graph_BulkLabelNodes(Graph *g, int label, const GrB_Index *ids, GrB_Index n) {
+	ASSERT(g != NULL);
+	ASSERT(label >= 0 && label < Graph_LabelTypeCount(g));
+	if(n == 0) return;
+
+	RG_Matrix matrix = g->labels[label];
+	GrB_Matrix m = RG_Matrix_Get_GrB_Matrix(matrix);
+
+	// make sure the label matrix is able to hold every node
+	GrB_Index nrows;
+	GrB_Matrix_nrows(&nrows, m);
+	if(nrows < Graph_RequiredMatrixDim(g)) _MatrixResizeToCapacity(g, matrix);
+
+	// build a structural diagonal, every value is true
+	bool *X = rm_malloc(sizeof(bool) * n);
+	memset(X, true, sizeof(bool) * n);
+
+	_RG_Matrix_MarkDirty(matrix);
+	_Graph_BuildInto(m, ids, ids, X, n, GrB_BOOL, GrB_LOR);
+
+	rm_free(X);
+}
+
+void Graph_BufferConnection(BulkConnections **conns, const Edge *e) {
+	ASSERT(conns != NULL && e != NULL);
+	int r = e->relationID;
+	while(array_len(*conns) <= (uint)r) {
+		BulkConnections c = {
+			.src = array_new(GrB_Index, 0),
+			.dest = array_new(GrB_Index, 0),
+			.ids = array_new(EdgeID, 0)
+		};
+		*conns = array_append(*conns, c);
+	}
+
+	BulkConnections *c = (*conns) + r;
+	c->src = array_append(c->src, e->srcNodeID);
+	c->dest = array_append(c->dest, e->destNodeID);
+	c->ids = array_append(c->ids, e->id);
+}
 
-	// Matrix multi-edge is enable for this matrix, use GxB_Matrix_subassign.
-	if(_RG_Matrix_MultiEdgeEnabled(M)) {
-		GrB_Index I = src;
-		GrB_Index J = dest;
-		info = GxB_Matrix_subassign_UINT64   // C(I,J)<Mask> = accum (C(I,J),x)
-			   (
-				   relationMat,          // input/output matrix for results
-				   GrB_NULL,             // optional mask for C(I,J), unused if NULL
-				   _graph_edge_accum,    // optional accum for Z=accum(C(I,J),x)
-				   edge_id,              // scalar to assign to C(I,J)
-				   &I,                   // row indices
-				   1,                    // number of row indices
-				   &J,                   // column indices
-				   1,                    // number of column indices
-				   GrB_NULL              // descriptor for C(I,J) and Mask
-			   );
-		ASSERT(info == GrB_SUCCESS);
+void Graph_BulkConnect(Graph *g, BulkConnections *conns) {
+	ASSERT(g != NULL);
+	int relation_count = array_len(conns);
 
-		// Update the transposed matrix if one is present.
-		if(t_relationMat != NULL) {
-			// Perform the same update to the J,I coordinates of the transposed matrix.
-			info = GxB_Matrix_subassign_UINT64   // C(I,J)<Mask> = accum (C(I,J),x)
-				   (
-					   t_relationMat,       // input/output matrix for results
-					   GrB_NULL,            // optional mask for C(J,I), unused if NULL
-					   _graph_edge_accum,   // optional accum for Z=accum(C(J,I),x)
-					   edge_id,             // scalar to assign to C(J,I)
-					   &J,                  // row indices
-					   1,                   // number of row indices
-					   &I,                  // column indices
-					   1,                   // number of column indices
-					   GrB_NULL             // descriptor for C(J,I) and Mask
-				   );
-			ASSERT(info == GrB_SUCCESS);
-		}
-	} else {
-		// Multi-edge is disabled, use GrB_Matrix_setElement.
-		info = GrB_Matrix_setElement_UINT64(relationMat, edge_id, src, dest);
-		ASSERT(info == GrB_SUCCESS);
+	#pragma omp parallel for schedule(dynamic, 1)
+	for(int r = 0; r < relation_count; r++) {
+		BulkConnections *c = conns + r;
+		Graph_BulkFormConnections(g, r, c->src, c->dest, c->ids,
+								  array_len(c->src));
+	}
 
-		// Update the transposed matrix if one is present.
-		if(t_relationMat != NULL) {
-			info = GrB_Matrix_setElement_UINT64(t_relationMat, edge_id, dest, src);
-			ASSERT(info == GrB_SUCCESS);
-		}
+	for(int r = 0; r < relation_count; r++) {
+		BulkConnections *c = conns + r;
+		Graph_BulkConnectAdjacency(g, c->src, c->dest, array_len(c->src));
+		array_free(c->src);
+		array_free(c->dest);
+		array_free(c->ids);
 	}
+	array_clear(conns);
 }
 
-int Graph_ConnectNodes(Graph *g, NodeID src, NodeID dest, int r, Edge *e) {
-	Node srcNode = GE_NEW_NODE();
-	Node destNode = GE_NEW_NODE();
+/* Collects the edges of row 'id' of M, a relation or adjacency matrix,
+ * transposed if 'transposed' is set, walking the row as a single slice.
+ * Relation matrices hold edge entries, resolved in place, while adjacency
+ * matrices only mark connected pairs, whose edges are looked up. */
+static void _Graph_CollectRowEdges(const Graph *g, GrB_Matrix M, NodeID id,
+		int edgeType, bool transposed, Edge **edges) {
+	GxB_MatrixTupleIter *tupleIter;
+	GxB_MatrixTupleIter_new(&tupleIter, M);
+	GxB_MatrixTupleIter_iterate_row(tupleIter, id);
 
-	int res;
-	UNUSED(res);
-	res = Graph_GetNode(g, src, &srcNode);
-	ASSERT(res == 1);
-	res = Graph_GetNode(g, dest, &destNode);
-	ASSERT(res == 1);
-	ASSERT(g && r < Graph_RelationTypeCount(g));
+	GrB_Type type;
+	GxB_Matrix_type(&type, M);
+	bool typed = (type == GrB_UINT64);
+	ASSERT(!typed || edgeType != GRAPH_NO_RELATION);
 
-	EdgeID id;
-	Entity *en = DataBlock_AllocateItem(g->edges, &id);
-	en->prop_count = 0;
-	en->properties = NULL;
-	e->id = id;
-	e->entity = en;
-	e->relationID = r;
-	e->srcNodeID = src;
-	e->destNodeID = dest;
-	Graph_FormConnection(g, src, dest, id, r);
-	return 1;
+	while(true) {
+		bool depleted = false;
+		const GrB_Index *cols;
+		const void *vals;
+		GrB_Index count;
+		GxB_MatrixTupleIter_next_row(tupleIter, NULL, &cols, typed ? &vals : NULL,
+				&count, &depleted);
+		if(depleted) break;
+
+		for(GrB_Index i = 0; i < count; i++) {
+			NodeID src = transposed ? cols[i] : id;
+			NodeID dest = transposed ? id : cols[i];
+			if(typed) {
+				EdgeID entry = ((const EdgeID *)vals)[i];
+				_Graph_CollectEntryEdges(g, src, dest, edgeType, entry, edges);
+			} else {
+				Graph_GetEdgesConnectingNodes(g, src, dest, edgeType, edges);
+			}
+		}
+	}
+
+	GxB_MatrixTupleIter_free(tupleIter);
 }
 
 /* Retrieves all either incoming or outgoing edges
@@ -644,59 +1582,71 @@ void Graph_GetNodeEdges(const Graph *g, const Node *n, GRAPH_EDGE_DIR dir, int e
 	GrB_Matrix M;
 	NodeID srcNodeID;
 	NodeID destNodeID;
-	GxB_MatrixTupleIter *tupleIter;
 
 	if(edgeType == GRAPH_UNKNOWN_RELATION) return;
 
-	// Outgoing.
-	if(dir == GRAPH_EDGE_DIR_OUTGOING || dir == GRAPH_EDGE_DIR_BOTH) {
+	// unmaintained adjacency matrices are invalidated by every write,
+	// collect the node's edges of each relation type instead
+	if(edgeType == GRAPH_NO_RELATION && !g->_maintain_adjacency) {
+		int relation_count = Graph_RelationTypeCount(g);
+		for(int r = 0; r < relation_count; r++) Graph_GetNodeEdges(g, n, dir, r, edges);
+		return;
+	}
+
+	// Outgoing, a frozen relation's row holds both destinations and edges.
+	const FrozenMatrix *fm = (edgeType == GRAPH_NO_RELATION) ? NULL :
+							 _Graph_FrozenRelation(g, edgeType);
+	if(fm != NULL && (dir == GRAPH_EDGE_DIR_OUTGOING || dir == GRAPH_EDGE_DIR_BOTH)) {
+		FrozenMatrixRowIter it;
+		srcNodeID = ENTITY_GET_ID(n);
+		FrozenMatrix_IterateRow(fm, srcNodeID, &it);
+		while(FrozenMatrixRowIter_Next(&it, &destNodeID)) {
+			_Graph_CollectFrozenEdges(g, &it, srcNodeID, destNodeID, edgeType, edges);
+		}
+	} else if(dir == GRAPH_EDGE_DIR_OUTGOING || dir == GRAPH_EDGE_DIR_BOTH) {
 		/* If a relationship type is specified, retrieve the appropriate relation matrix;
 		 * otherwise use the overall adjacency matrix. */
 		if(edgeType == GRAPH_NO_RELATION) M = Graph_GetAdjacencyMatrix(g);
 		else M = Graph_GetRelationMatrix(g, edgeType);
 
-		/* Construct an iterator to traverse the source node's row, which contains
-		 * all outgoing edges. */
-		GxB_MatrixTupleIter_new(&tupleIter, M);
-		srcNodeID = ENTITY_GET_ID(n);
-		GxB_MatrixTupleIter_iterate_row(tupleIter, srcNodeID);
-		while(true) {
-			bool depleted = false;
-			GxB_MatrixTupleIter_next(tupleIter, NULL, &destNodeID, &depleted);
-			if(depleted) break;
-			// Collect all edges connecting this source node to each of its destinations.
-			Graph_GetEdgesConnectingNodes(g, srcNodeID, destNodeID, edgeType, edges);
-		}
-		GxB_MatrixTupleIter_free(tupleIter);
+		// the source node's row contains all outgoing edges
+		_Graph_CollectRowEdges(g, M, ENTITY_GET_ID(n), edgeType, false, edges);
 	}
 
 	// Incoming.
 	if(dir == GRAPH_EDGE_DIR_INCOMING || dir == GRAPH_EDGE_DIR_BOTH) {
 		/* Retrieve the transposed adjacency matrix, regardless of whether or not
-		 * a relationship type is specified. */
-		M = Graph_GetTransposedAdjacencyMatrix(g);
-
-		/* Construct an iterator to traverse the node's row, which in the transposed
-		 * adjacency matrix contains all incoming edges. */
-		GxB_MatrixTupleIter_new(&tupleIter, M);
-		destNodeID = ENTITY_GET_ID(n);
-		GxB_MatrixTupleIter_iterate_row(tupleIter, destNodeID);
-
-		while(true) {
-			bool depleted = false;
-			GxB_MatrixTupleIter_next(tupleIter, NULL, &srcNodeID, &depleted);
-			if(depleted) break;
-			/* Collect all edges connecting this destination node to each of its sources.
-			 * This call will only collect edges of the appropriate relationship type,
-			 * if one is specified. */
-			Graph_GetEdgesConnectingNodes(g, srcNodeID, destNodeID, edgeType, edges);
+		 * a relationship type is specified, unless it isn't maintained. */
+		if(!g->_maintain_adjacency && g->t_relations) {
+			M = Graph_GetTransposedRelationMatrix(g, edgeType);
+		} else {
+			M = Graph_GetTransposedAdjacencyMatrix(g);
 		}
 
-		// Clean up
-		GxB_MatrixTupleIter_free(tupleIter);
+		/* The node's row, in the transposed matrix, contains all incoming edges,
+		 * only edges of the appropriate relationship type are collected,
+		 * if one is specified. */
+		_Graph_CollectRowEdges(g, M, ENTITY_GET_ID(n), edgeType, true, edges);
 	}
 }
 
+/* Removes edge 'id' from the multi-edge entry R[src, dest].
+ * Once a single edge is left its ID replaces the run,
+ * in R as well as in TR which shares the run. */
+static void _Graph_RemoveMultiEdge(Graph *g, int r, GrB_Matrix R, GrB_Matrix TR,
+		NodeID src_id, NodeID dest_id, EdgeID entry, EdgeID id) {
+	MultiEdgeTable *t = g->relations[r]->multi_edges;
+	uint64_t run = MULTI_EDGE_RUN(entry);
+	if(MultiEdgeTable_Remove(t, run, id) > 1) return;
+
+	uint32_t count;
+	EdgeID edge_id = MultiEdgeTable_Run(t, run, &count)[0];
+	MultiEdgeTable_ReleaseRun(t, run);
+
+	GrB_Matrix_setElement(R, SET_MSB(edge_id), src_id, dest_id);
+	if(TR) GrB_Matrix_setElement(TR, SET_MSB(edge_id), dest_id, src_id);
+}
+
 /* Removes an edge from Graph and updates graph relevent matrices. */
 int Graph_DeleteEdge(Graph *g, Edge *e) {
 	uint64_t x;
@@ -705,6 +1655,9 @@ int Graph_DeleteEdge(Graph *g, Edge *e) {
 	GrB_Info info;
 	EdgeID edge_id;
 	GrB_Matrix TR = GrB_NULL;
+
+	// the edge's record locates it, even if e doesn't specify its endpoints
+	_Graph_ResolveEdge(e);
 	int r = Edge_GetRelationID(e);
 	NodeID src_id = Edge_GetSrcNodeID(e);
 	NodeID dest_id = Edge_GetDestNodeID(e);
@@ -728,8 +1681,9 @@ int Graph_DeleteEdge(Graph *g, Edge *e) {
 		}
 
 		// See if source is connected to destination with additional edges.
-		bool connected = false;
-		int relationCount = Graph_RelationTypeCount(g);
+		bool connected = !g->_maintain_adjacency;
+		g->_adjacency_stale |= connected;
+		int relationCount = (connected) ? 0 : Graph_RelationTypeCount(g);
 		for(int i = 0; i < relationCount; i++) {
 			if(i == r) continue;
 			M = Graph_GetRelationMatrix(g, i);
@@ -753,57 +1707,28 @@ int Graph_DeleteEdge(Graph *g, Edge *e) {
 		}
 	} else {
 		/* Multiple edges connecting src to dest
-		 * locate specific edge and remove it
-		 * revert back from array representation to edge ID
+		 * remove edge from the run of edges connecting the two,
+		 * revert back from run representation to edge ID
 		 * incase we're left with a single edge connecting src to dest. */
-
-		int i = 0;
-		EdgeID id = ENTITY_GET_ID(e);
-		EdgeID *edges = (EdgeID *)edge_id;
-		int edge_count = array_len(edges);
-
-		// Locate edge within edge array.
-		for(; i < edge_count; i++) if(edges[i] == id) break;
-		ASSERT(i < edge_count);
-
-		/* Remove edge from edge array
-		 * migrate last edge ID and reduce array size.
-		 * TODO: reallocate array of size / capacity ratio is high. */
-		edges[i] = edges[edge_count - 1];
-		array_pop(edges);
-
-		/* Incase we're left with a single edge connecting src to dest
-		 * revert back from array to scalar. */
-		if(array_len(edges) == 1) {
-			edge_id = edges[0];
-			array_free(edges);
-			GrB_Matrix_setElement(R, SET_MSB(edge_id), src_id, dest_id);
-		}
-
-		if(TR) {
-			/* We must make the matching updates to the transposed matrix.
-			 * First, extract the element that is known to be an edge array. */
-			info = GrB_Matrix_extractElement(edges, TR, dest_id, src_id);
-			ASSERT(info == GrB_SUCCESS);
-			// Replace the deleted edge with the last edge in the matrix.
-			edges[i] = edges[edge_count - 1];
-			array_pop(edges);
-			// Free and replace the array if it now has 1 element.
-			if(array_len(edges) == 1) {
-				edge_id = edges[0];
-				array_free(edges);
-				GrB_Matrix_setElement(TR, SET_MSB(edge_id), dest_id, src_id);
-			}
-		}
+		_Graph_RemoveMultiEdge(g, r, R, TR, src_id, dest_id, edge_id, ENTITY_GET_ID(e));
 	}
 
+	_Graph_AdjustDegrees(g, r, src_id, dest_id, -1);
+	_Graph_InvalidateTransposes(g, r);
+
 	// Free and remove edges from datablock.
 	DataBlock_DeleteItem(g->edges, ENTITY_GET_ID(e));
 	return 1;
 }
 
-inline bool Graph_EntityIsDeleted(Entity *e) {
-	return DataBlock_ItemIsDeleted(e);
+void Graph_MarkEntityModified(Graph *g, GraphEntityType t, EntityID id) {
+	ASSERT(g);
+	DataBlock_MarkModified((t == GETYPE_NODE) ? g->nodes : g->edges, id);
+}
+
+bool Graph_EntityIsDeleted(const Graph *g, GraphEntityType t, EntityID id) {
+	ASSERT(g);
+	return DataBlock_ItemIsDeleted((t == GETYPE_NODE) ? g->nodes : g->edges, id);
 }
 
 void Graph_DeleteNode(Graph *g, Node *n) {
@@ -823,67 +1748,50 @@ void Graph_DeleteNode(Graph *g, Node *n) {
 }
 
 static void _Graph_FreeRelationMatrices(Graph *g) {
-	// TODO: disable datablock deleted items array
-	// there's no need to keep track after deleted items as the graph
-	// is being removed we won't be reusing items
-
-	if(!_binary_op_delete_edges) {
-		// The binary operator has not yet been constructed; build it now.
-		GrB_Info res;
-		UNUSED(res);
-		res = GrB_BinaryOp_new(&_binary_op_delete_edges, _binary_op_free_edge,
-							   GrB_UINT64, GrB_UINT64, GrB_UINT64);
-		ASSERT(res == GrB_SUCCESS);
-	}
-
-	GxB_Scalar thunk;
-	GxB_Scalar_new(&thunk, GrB_UINT64);
-	GxB_Scalar_setElement_UINT64(thunk, (uint64_t)g);
-
-	bool maintain_transpose;
-	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
+	// edges are freed by Graph_Free,
+	// multi-edge runs are freed along with their relation matrix
 	uint relationCount = Graph_RelationTypeCount(g);
-	/* use the edge deletion binary operation to free all edge arrays within
-	 * the adjacency matrix */
-
 	for(uint i = 0; i < relationCount; i++) {
-		RG_Matrix  M = g->relations[i];
-		GrB_Matrix C = M->grb_matrix;
-
-		GxB_Matrix_apply_BinaryOp1st(C, GrB_NULL, GrB_NULL,
-									 _binary_op_delete_edges, thunk, C, GrB_NULL);
+		RG_Matrix_Free(g->relations[i]);
+		if(g->t_relations) RG_Matrix_Free(g->t_relations[i]);
+	}
+}
 
-		// free the matrix itself
-		RG_Matrix_Free(M);
+// Deletes the edges of every entry of A, A's entries are taken from relation r.
+static void _Graph_DeleteEntryEdges(Graph *g, int r, GrB_Matrix A) {
+	GrB_Info info;
+	UNUSED(info);
 
-		// perform the same update to transposed matrices
-		if(maintain_transpose) {
-			RG_Matrix TM = g->t_relations[i];
-			C = TM->grb_matrix;
+	GrB_Index nvals;
+	info = GrB_Matrix_nvals(&nvals, A);
+	ASSERT(info == GrB_SUCCESS);
+	if(nvals == 0) return;
 
-			GxB_Matrix_apply_BinaryOp1st(C, GrB_NULL, GrB_NULL,
-										 _binary_op_delete_edges, thunk, C, GrB_NULL);
+	uint64_t *X = rm_malloc(sizeof(uint64_t) * nvals);
+	info = GrB_Matrix_extractTuples_UINT64(GrB_NULL, GrB_NULL, X, &nvals, A);
+	ASSERT(info == GrB_SUCCESS);
 
-			// free the matrix itself
-			RG_Matrix_Free(TM);
+	MultiEdgeTable *t = g->relations[r]->multi_edges;
+	for(GrB_Index i = 0; i < nvals; i++) {
+		if(SINGLE_EDGE(X[i])) {
+			DataBlock_DeleteItem(g->edges, SINGLE_EDGE_ID(X[i]));
+			continue;
 		}
+
+		uint32_t count;
+		uint64_t run = MULTI_EDGE_RUN(X[i]);
+		const EdgeID *ids = MultiEdgeTable_Run(t, run, &count);
+		for(uint32_t j = 0; j < count; j++) DataBlock_DeleteItem(g->edges, ids[j]);
+		MultiEdgeTable_ReleaseRun(t, run);
 	}
-	GrB_free(&thunk);
+
+	rm_free(X);
 }
 
 static void _BulkDeleteNodes(Graph *g, Node *nodes, uint node_count,
 							 uint *node_deleted, uint *edge_deleted) {
 	ASSERT(g && g->_writelocked && nodes && node_count > 0);
 
-	if(!_binary_op_delete_edges) {
-		// The binary operator has not yet been constructed; build it now.
-		GrB_Info res;
-		UNUSED(res);
-		res = GrB_BinaryOp_new(&_binary_op_delete_edges, _binary_op_free_edge,
-							   GrB_UINT64, GrB_UINT64, GrB_UINT64);
-		ASSERT(res == GrB_SUCCESS);
-	}
-
 	/* Create a matrix M where M[j,i] = 1 if:
 	 * Node i is connected to node j. */
 
@@ -910,17 +1818,6 @@ static void _BulkDeleteNodes(Graph *g, Node *nodes, uint node_count,
 	GrB_Matrix_new(&Mask, GrB_BOOL, nrows, ncols);
 	GrB_Matrix_new(&Nodes, GrB_BOOL, nrows, ncols);
 
-	/* For user-defined select operators,
-	 * If Thunk is not NULL, it must be a valid GxB_Scalar. If it has no entry,
-	 * it is treated as if it had a single entry equal to zero, for built-in types (not
-	 * user-defined types).
-	 * For user-defined select operators, the entry is passed to the user-defined
-	 * select operator, with no typecasting. Its type must be identical to 'ttype' of
-	 * the select operator. */
-	GxB_Scalar thunk;
-	GxB_Scalar_new(&thunk, GrB_UINT64);
-	GxB_Scalar_setElement_UINT64(thunk, (uint64_t)g);
-
 	// Populate mask with implicit edges, take note of deleted nodes.
 	for(uint i = 0; i < node_count; i++) {
 		GrB_Index src;
@@ -974,9 +1871,8 @@ static void _BulkDeleteNodes(Graph *g, Node *nodes, uint node_count,
 		 * A will contain all implicitly deleted edges from R */
 		GrB_Matrix_apply(A, Mask, GrB_NULL, GrB_IDENTITY_UINT64, R, desc);
 
-		// free each multi edge array entry in A
-		GxB_Matrix_apply_BinaryOp1st(A, GrB_NULL, GrB_NULL,
-									 _binary_op_delete_edges, thunk, A, GrB_NULL);
+		// delete the edges of each entry in A, releasing multi-edge runs
+		_Graph_DeleteEntryEdges(g, i, A);
 
 		// clear the relation matrix
 		GrB_Descriptor_set(desc, GrB_MASK, GrB_COMP);
@@ -1007,18 +1903,7 @@ static void _BulkDeleteNodes(Graph *g, Node *nodes, uint node_count,
 		for(int i = 0; i < relation_count; i++) {
 			GrB_Matrix TR = Graph_GetTransposedRelationMatrix(g, i);
 
-			// reset mask descriptor
-			GrB_Descriptor_set(desc, GrB_MASK, GxB_DEFAULT);
-
-			/* isolate implicit edges
-			 * A will contain all implicitly deleted edges from TR */
-			GrB_Matrix_apply(A, Mask, GrB_NULL, GrB_IDENTITY_UINT64, TR, desc);
-
-			// free each multi edge array entry in A
-			GxB_Matrix_apply_BinaryOp1st(A, GrB_NULL, GrB_NULL,
-										 _binary_op_delete_edges, thunk, A, GrB_NULL);
-
-			// clear the relation matrix
+			// edges were deleted along with R's entries, TR shares R's runs
 			GrB_Descriptor_set(desc, GrB_MASK, GrB_COMP);
 			GrB_Descriptor_set(desc, GrB_MASK, GrB_STRUCTURE);
 
@@ -1045,7 +1930,6 @@ static void _BulkDeleteNodes(Graph *g, Node *nodes, uint node_count,
 	GrB_free(&A);
 	GrB_free(&desc);
 	GrB_free(&Mask);
-	GrB_free(&thunk);
 	GrB_free(&Nodes);
 	GxB_MatrixTupleIter_free(adj_iter);
 	GxB_MatrixTupleIter_free(tadj_iter);
@@ -1064,6 +1948,8 @@ static void _BulkDeleteEdges(Graph *g, Edge *edges, size_t edge_count) {
 
 	for(int i = 0; i < edge_count; i++) {
 		Edge *e = edges + i;
+		// edges are located by their records, callers needn't resolve them
+		_Graph_ResolveEdge(e);
 		int r = Edge_GetRelationID(e);
 		NodeID src_id = Edge_GetSrcNodeID(e);
 		NodeID dest_id = Edge_GetDestNodeID(e);
@@ -1084,48 +1970,9 @@ static void _BulkDeleteEdges(Graph *g, Edge *edges, size_t edge_count) {
 			GrB_Matrix_setElement_BOOL(mask, true, src_id, dest_id);
 		} else {
 			/* Multiple edges connecting src to dest
-			 * locate specific edge and remove it
-			 * revert back from array representation to edge ID
-			 * incase we're left with a single edge connecting src to dest. */
-
-			int i = 0;
-			EdgeID id = ENTITY_GET_ID(e);
-			EdgeID *multi_edges = (EdgeID *)edge_id;
-			int multi_edge_count = array_len(multi_edges);
-
-			// Locate edge within edge array.
-			for(; i < multi_edge_count; i++) if(multi_edges[i] == id) break;
-			ASSERT(i < multi_edge_count);
-
-			/* Remove edge from edge array
-			 * migrate last edge ID and reduce array size.
-			 * TODO: reallocate array of size / capacity ratio is high. */
-			multi_edges[i] = multi_edges[multi_edge_count - 1];
-			array_pop(multi_edges);
-
-			/* Incase we're left with a single edge connecting src to dest
-			 * revert back from array to scalar. */
-			if(array_len(multi_edges) == 1) {
-				edge_id = multi_edges[0];
-				array_free(multi_edges);
-				GrB_Matrix_setElement(R, SET_MSB(edge_id), src_id, dest_id);
-			}
-
-			if(TR) {
-				/* We must make the matching updates to the transposed matrix.
-				 * First, extract the element that is known to be an edge array. */
-				GrB_Matrix_extractElement(&edge_id, TR, dest_id, src_id);
-				multi_edges = (EdgeID *)edge_id;
-				int multi_edge_count = array_len(multi_edges);
-				multi_edges[i] = multi_edges[multi_edge_count - 1];
-				array_pop(multi_edges);
-				// Free and replace the array if it now has 1 element.
-				if(array_len(multi_edges) == 1) {
-					edge_id = multi_edges[0];
-					array_free(multi_edges);
-					GrB_Matrix_setElement(TR, SET_MSB(edge_id), dest_id, src_id);
-				}
-			}
+			 * remove edge from its run, reverting back to
+			 * a single edge ID incase only one edge is left. */
+			_Graph_RemoveMultiEdge(g, r, R, TR, src_id, dest_id, edge_id, ENTITY_GET_ID(e));
 		}
 
 		// Free and remove edges from datablock.
@@ -1164,21 +2011,27 @@ static void _BulkDeleteEdges(Graph *g, Edge *edges, size_t edge_count) {
 			}
 
 			// Collect remaining edges. remaining_mask = remaining_mask + R.
-			GrB_eWiseAdd(remaining_mask, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, remaining_mask,
-						 R, GrB_NULL);
+			if(g->_maintain_adjacency) {
+				GrB_eWiseAdd(remaining_mask, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL,
+							 remaining_mask, R, GrB_NULL);
+			}
 		}
 
-		GrB_Matrix adj_matrix = Graph_GetAdjacencyMatrix(g);
-		GrB_Matrix t_adj_matrix = Graph_GetTransposedAdjacencyMatrix(g);
-		// To calculate edges to delete, remove all the remaining edges from "The" adjency matrix.
-		// Set descriptor mask to default.
-		GrB_Descriptor_set(desc, GrB_MASK, GxB_DEFAULT);
-		// adj_matrix = adj_matrix & remaining_mask.
-		GrB_Matrix_apply(adj_matrix, remaining_mask, GrB_NULL, GrB_IDENTITY_BOOL, adj_matrix, desc);
-		// Transpose remaining_mask.
-		GrB_transpose(remaining_mask, GrB_NULL,  GrB_NULL, remaining_mask, GrB_NULL);
-		// t_adj_matrix = t_adj_matrix & remaining_mask.
-		GrB_Matrix_apply(t_adj_matrix, remaining_mask, GrB_NULL, GrB_IDENTITY_BOOL, t_adj_matrix, desc);
+		if(g->_maintain_adjacency) {
+			GrB_Matrix adj_matrix = Graph_GetAdjacencyMatrix(g);
+			GrB_Matrix t_adj_matrix = Graph_GetTransposedAdjacencyMatrix(g);
+			// To calculate edges to delete, remove all the remaining edges from "The" adjency matrix.
+			// Set descriptor mask to default.
+			GrB_Descriptor_set(desc, GrB_MASK, GxB_DEFAULT);
+			// adj_matrix = adj_matrix & remaining_mask.
+			GrB_Matrix_apply(adj_matrix, remaining_mask, GrB_NULL, GrB_IDENTITY_BOOL, adj_matrix, desc);
+			// Transpose remaining_mask.
+			GrB_transpose(remaining_mask, GrB_NULL,  GrB_NULL, remaining_mask, GrB_NULL);
+			// t_adj_matrix = t_adj_matrix & remaining_mask.
+			GrB_Matrix_apply(t_adj_matrix, remaining_mask, GrB_NULL, GrB_IDENTITY_BOOL, t_adj_matrix, desc);
+		} else {
+			g->_adjacency_stale = true;
+		}
 
 		GrB_free(&remaining_mask);
 		GrB_free(&desc);
@@ -1193,6 +2046,10 @@ void Graph_BulkDelete(Graph *g, Node *nodes, uint node_count, Edge *edges, uint
 	*edge_deleted = 0;
 	*node_deleted = 0;
 
+	if(node_count || edge_count) {
+		_Graph_DiscardDegrees(g, GRAPH_NO_RELATION);
+		_Graph_InvalidateTransposes(g, GRAPH_NO_RELATION);
+	}
 	if(node_count) _BulkDeleteNodes(g, nodes, node_count, node_deleted, edge_deleted);
 
 	if(edge_count) {
@@ -1200,10 +2057,7 @@ void Graph_BulkDelete(Graph *g, Node *nodes, uint node_count, Edge *edges, uint
 		if(node_count) {
 			for(int i = 0; i < edge_count; i++) {
 				Edge *e = edges + i;
-				NodeID src = Edge_GetSrcNodeID(e);
-				NodeID dest = Edge_GetDestNodeID(e);
-
-				if(!DataBlock_GetItem(g->nodes, src) || !DataBlock_GetItem(g->nodes, dest)) {
+				if(!DataBlock_GetItem(g->edges, ENTITY_GET_ID(e))) {
 					/* Edge already removed due to node removal.
 					* Replace current edge with last edge. */
 					edges[i] = edges[edge_count - 1];
@@ -1239,6 +2093,277 @@ void Graph_BulkDelete(Graph *g, Node *nodes, uint node_count, Edge *edges, uint
 	*edge_deleted += edge_count;
 }
 
+size_t Graph_CompactEntities(Graph *g) {
+	ASSERT(g && g->_writelocked);
+	return DataBlock_Compact(g->nodes) + DataBlock_Compact(g->edges);
+}
+
+// M = M(order, order), M is resized to the number of nodes in order
+// 'dim' is the graph's matrix dimension prior to the permutation
+static void _Graph_PermuteMatrix(RG_Matrix M, const GrB_Index *order, GrB_Index n,
+		GrB_Index dim) {
+	GrB_Info info;
+	UNUSED(info);
+	GrB_Type type;
+	GrB_Index nrows;
+	GrB_Matrix C;
+	GrB_Matrix A = M->grb_matrix;
+
+	info = GxB_Matrix_type(&type, A);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_nrows(&nrows, A);
+	ASSERT(info == GrB_SUCCESS);
+	if(nrows < dim) {
+		info = GxB_Matrix_resize(A, dim, dim);
+		ASSERT(info == GrB_SUCCESS);
+	}
+
+	info = GrB_Matrix_new(&C, type, n, n);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_extract(C, GrB_NULL, GrB_NULL, A, order, n, order, n, GrB_NULL);
+	ASSERT(info == GrB_SUCCESS);
+	_Graph_ApplyPending(C);
+	_RG_Matrix_SelectSparsity(C);
+
+	GrB_Matrix_free(&M->grb_matrix);
+	M->grb_matrix = C;
+	_RG_Matrix_ClearDirty(M);
+}
+
+// rewrites the endpoints of every edge record, node order[k] becomes node k
+static void _Graph_RelabelEdgeRecords(Graph *g, const NodeID *order, GrB_Index n,
+		GrB_Index dim) {
+	NodeID *relabel = rm_malloc(sizeof(NodeID) * MAX(dim, 1));
+	for(GrB_Index k = 0; k < n; k++) relabel[order[k]] = k;
+
+	EdgeID id;
+	EdgeRecord *rec;
+	DataBlockIterator *it = DataBlock_Scan(g->edges);
+	while((rec = DataBlockIterator_Next(it, &id)) != NULL) {
+		rec->srcNodeID = relabel[rec->srcNodeID];
+		rec->destNodeID = relabel[rec->destNodeID];
+	}
+	DataBlockIterator_Free(it);
+
+	rm_free(relabel);
+}
+
+void Graph_PermuteNodes(Graph *g, const NodeID *order) {
+	ASSERT(g && g->_writelocked && order);
+
+	uint relation_count = array_len(g->relations);
+	GrB_Index n = Graph_NodeCount(g);
+	GrB_Index dim = Graph_RequiredMatrixDim(g);
+
+	// restore frozen relations and fold in pending changes,
+	// entries are relocated, multi-edge runs are addressed by value
+	bool frozen = false;
+	for(uint i = 0; i < relation_count; i++) {
+		frozen |= (_Graph_FrozenRelation(g, i) != NULL);
+		_RG_Matrix_Thaw(g, i);
+	}
+	Graph_FlushAllPending(g);
+
+	_Graph_PermuteMatrix(g->adjacency_matrix, order, n, dim);
+	_Graph_PermuteMatrix(g->_t_adjacency_matrix, order, n, dim);
+
+	uint label_count = array_len(g->labels);
+	for(uint i = 0; i < label_count; i++) _Graph_PermuteMatrix(g->labels[i], order, n, dim);
+
+	for(uint i = 0; i < relation_count; i++) {
+		_Graph_PermuteMatrix(g->relations[i], order, n, dim);
+		if(g->t_relations) _Graph_PermuteMatrix(g->t_relations[i], order, n, dim);
+	}
+
+	// derived structures are computed anew on first use
+	_Graph_DiscardDegrees(g, GRAPH_NO_RELATION);
+	_Graph_InvalidateTransposes(g, GRAPH_NO_RELATION);
+
+	DataBlock_Permute(g->nodes, order);
+	_Graph_RelabelEdgeRecords(g, order, n, dim);
+
+	if(frozen) Graph_FreezeRelations(g);
+}
+
+// relabels the edges held by relation r's matrix, in the matrix's row major
+// order, order[k] is set to the previous ID of the edge assigned ID k
+// returns relation r's matrix with its single edge entries relabeled,
+// multi-edge runs are relabeled in place, their run IDs are preserved
+static GrB_Matrix _Graph_RelabelRelationEdges(Graph *g, int r, EdgeID *order,
+		uint64_t *next) {
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Matrix R = g->relations[r]->grb_matrix;
+	GrB_Index dim;
+	GrB_Index nvals;
+	info = GrB_Matrix_nrows(&dim, R);
+	ASSERT(info == GrB_SUCCESS);
+	info = GrB_Matrix_nvals(&nvals, R);
+	ASSERT(info == GrB_SUCCESS);
+
+	GrB_Matrix C;
+	info = GrB_Matrix_new(&C, GrB_UINT64, dim, dim);
+	ASSERT(info == GrB_SUCCESS);
+	if(nvals == 0) return C;
+
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * nvals);
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * nvals);
+	uint64_t *X = rm_malloc(sizeof(uint64_t) * nvals);
+	info = GrB_Matrix_extractTuples_UINT64(I, J, X, &nvals, R);
+	ASSERT(info == GrB_SUCCESS);
+
+	MultiEdgeTable *t = g->relations[r]->multi_edges;
+	for(GrB_Index k = 0; k < nvals; k++) {
+		if(SINGLE_EDGE(X[k])) {
+			order[*next] = SINGLE_EDGE_ID(X[k]);
+			X[k] = SET_MSB(*next);
+			(*next)++;
+			continue;
+		}
+
+		// a run's edges are laid out one after the other
+		const EdgeRun *run = t->runs + MULTI_EDGE_RUN(X[k]);
+		EdgeID *ids = t->ids + run->offset;
+		for(uint32_t j = 0; j < run->len; j++) {
+			order[*next] = ids[j];
+			ids[j] = (*next)++;
+		}
+	}
+
+	info = GrB_Matrix_build_UINT64(C, I, J, X, nvals, GrB_FIRST_UINT64);
+	ASSERT(info == GrB_SUCCESS);
+
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+	return C;
+}
+
+uint64_t Graph_ClusterEdges(Graph *g) {
+	ASSERT(g && g->_writelocked);
+
+	uint relation_count = array_len(g->relations);
+	uint64_t edge_count = Graph_EdgeCount(g);
+
+	// restore frozen relations and fold in pending changes
+	bool frozen = false;
+	for(uint i = 0; i < relation_count; i++) {
+		frozen |= (_Graph_FrozenRelation(g, i) != NULL);
+		_RG_Matrix_Thaw(g, i);
+	}
+	Graph_FlushAllPending(g);
+
+	uint64_t next = 0;
+	EdgeID *order = rm_malloc(sizeof(EdgeID) * MAX(edge_count, 1));
+	for(uint i = 0; i < relation_count; i++) {
+		RG_Matrix M = g->relations[i];
+		GrB_Matrix C = _Graph_RelabelRelationEdges(g, i, order, &next);
+		_RG_Matrix_SelectSparsity(C);
+		GrB_Matrix_free(&M->grb_matrix);
+		M->grb_matrix = C;
+		_RG_Matrix_ClearDirty(M);
+
+		// transposed entries hold the relation's values, run IDs included
+		if(g->t_relations) {
+			GrB_Matrix TR = g->t_relations[i]->grb_matrix;
+			GrB_Info info = GrB_transpose(TR, GrB_NULL, GrB_NULL, C, GrB_NULL);
+			ASSERT(info == GrB_SUCCESS);
+			UNUSED(info);
+			_RG_Matrix_SelectSparsity(TR);
+		}
+	}
+	ASSERT(next == edge_count);
+
+	uint64_t relabeled = 0;
+	for(uint64_t i = 0; i < edge_count; i++) relabeled += (order[i] != i);
+
+	// edge records carry their endpoints and type, they're relocated as is
+	DataBlock_Permute(g->edges, order);
+	rm_free(order);
+
+	// cached transposes hold edge IDs, degrees are unaffected
+	_Graph_InvalidateTransposes(g, GRAPH_NO_RELATION);
+
+	if(frozen) Graph_FreezeRelations(g);
+	return relabeled;
+}
+
+size_t Graph_EntitiesMemoryUsage(const Graph *g) {
+	ASSERT(g);
+	return DataBlock_MemoryUsage(g->nodes) + DataBlock_MemoryUsage(g->edges);
+}
+
+// estimates the number of bytes held by a single matrix
+static size_t _RG_Matrix_MemoryUsage(RG_Matrix m) {
+	size_t usage = sizeof(_RG_Matrix);
+
+	RG_Matrix_Lock(m);
+
+	GrB_Matrix M = RG_Matrix_Get_GrB_Matrix(m);
+	if(M != NULL) {
+		// GraphBLAS doesn't report its memory consumption
+		// estimate a sparse layout: row pointers, column indices and values
+		GrB_Type type;
+		size_t type_size;
+		GrB_Index nrows;
+		GrB_Index nvals;
+		GxB_Matrix_type(&type, M);
+		GxB_Type_size(&type_size, type);
+		GrB_Matrix_nrows(&nrows, M);
+		GrB_Matrix_nvals(&nvals, M);
+		usage += sizeof(int64_t) * (nrows + 1) + (sizeof(int64_t) + type_size) * nvals;
+	}
+
+	if(m->frozen) usage += FrozenMatrix_MemoryUsage(m->frozen);
+	if(m->multi_edges) usage += MultiEdgeTable_MemoryUsage(m->multi_edges);
+	if(m->pending) usage += sizeof(PendingConnection) * array_len(m->pending);
+
+	_RG_Matrix_Unlock(m);
+
+	return usage;
+}
+
+size_t Graph_AdjacencyMatrixMemoryUsage(const Graph *g) {
+	ASSERT(g);
+	return _RG_Matrix_MemoryUsage(g->adjacency_matrix) +
+		   _RG_Matrix_MemoryUsage(g->_t_adjacency_matrix);
+}
+
+size_t Graph_LabelMatrixMemoryUsage(const Graph *g, int label) {
+	ASSERT(g && label >= 0 && label < array_len(g->labels));
+	return _RG_Matrix_MemoryUsage(g->labels[label]);
+}
+
+size_t Graph_RelationMatrixMemoryUsage(const Graph *g, int relation) {
+	ASSERT(g && relation >= 0 && relation < array_len(g->relations));
+
+	size_t usage = _RG_Matrix_MemoryUsage(g->relations[relation]);
+	if(g->t_relations) usage += _RG_Matrix_MemoryUsage(g->t_relations[relation]);
+	if(g->t_cache && g->t_cache[relation].m) {
+		usage += _RG_Matrix_MemoryUsage(g->t_cache[relation].m);
+	}
+	return usage;
+}
+
+size_t Graph_MatricesMemoryUsage(const Graph *g) {
+	ASSERT(g);
+
+	size_t usage = Graph_AdjacencyMatrixMemoryUsage(g);
+
+	uint label_count = array_len(g->labels);
+	for(uint i = 0; i < label_count; i++) {
+		usage += Graph_LabelMatrixMemoryUsage(g, i);
+	}
+
+	uint relation_count = array_len(g->relations);
+	for(uint i = 0; i < relation_count; i++) {
+		usage += Graph_RelationMatrixMemoryUsage(g, i);
+	}
+
+	return usage;
+}
+
 DataBlockIterator *Graph_ScanNodes(const Graph *g) {
 	ASSERT(g);
 	return DataBlock_Scan(g->nodes);
@@ -1252,21 +2377,12 @@ DataBlockIterator *Graph_ScanEdges(const Graph *g) {
 int Graph_AddLabel(Graph *g) {
 	ASSERT(g != NULL);
 
-	GrB_Info info;
 	GrB_Index nrows = Graph_RequiredMatrixDim(g);
 	GrB_Index ncols = nrows;
+	// label matrices are iterated within the LabelScan operation,
+	// their format is either sparse or hypersparse, see _RG_Matrix_SelectSparsity
 	RG_Matrix m = RG_Matrix_New(GrB_BOOL, nrows, ncols);
 
-	/* matrix iterator requires matrix format to be sparse
-	 * to avoid future conversion from HYPER-SPARSE, BITMAP, FULL to SPARSE
-	 * we set matrix format at creation time, as Label matrices are iterated
-	 * within the LabelScan Execution-Plan operation. */
-
-	GrB_Matrix M = RG_Matrix_Get_GrB_Matrix(m);
-	info = GxB_set(M, GxB_SPARSITY_CONTROL, GxB_SPARSE);
-	UNUSED(info);
-	ASSERT(info == GrB_SUCCESS);
-
 	array_append(g->labels, m);
 	return array_len(g->labels) - 1;
 }
@@ -1276,22 +2392,71 @@ int Graph_AddRelationType(Graph *g) {
 
 	size_t dims = Graph_RequiredMatrixDim(g);
 	RG_Matrix m = RG_Matrix_New(GrB_UINT64, dims, dims);
+	m->multi_edges = MultiEdgeTable_New();
 	g->relations = array_append(g->relations, m);
+	RelationDegrees d = {.out = NULL, .in = NULL};
+	g->degrees = array_append(g->degrees, d);
 	bool maintain_transpose;
 	Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
 
 	if(maintain_transpose) {
 		RG_Matrix tm = RG_Matrix_New(GrB_UINT64, dims, dims);
 		g->t_relations = array_append(g->t_relations, tm);
+	} else {
+		TransposeCache c = {.m = NULL, .stale = true};
+		g->t_cache = array_append(g->t_cache, c);
 	}
 
 	int relationID = Graph_RelationTypeCount(g) - 1;
 	return relationID;
 }
 
+// recomputes unmaintained adjacency matrices as the union of relation matrices
+// computed once under the adjacency matrix's lock by the first reader to
+// require them, writers invalidate rather than update them
+static void _Graph_RefreshAdjacency(const Graph *g) {
+	if(!g->_adjacency_stale) return;
+
+	GrB_Info info;
+	UNUSED(info);
+	Graph *graph = (Graph *)g;
+	RG_Matrix_Lock(g->adjacency_matrix);
+
+	if(g->_adjacency_stale) {
+		GrB_Index dims = Graph_RequiredMatrixDim(g);
+		GrB_Matrix adj = RG_Matrix_Get_GrB_Matrix(g->adjacency_matrix);
+		GrB_Matrix tadj = RG_Matrix_Get_GrB_Matrix(g->_t_adjacency_matrix);
+		info = GrB_Matrix_clear(adj);
+		ASSERT(info == GrB_SUCCESS);
+		_Graph_ResizeMatrix(adj, dims);
+		_Graph_ResizeMatrix(tadj, dims);
+
+		// R's structure, run IDs may be zero
+		uint relation_count = Graph_RelationTypeCount(g);
+		for(uint r = 0; r < relation_count; r++) {
+			GrB_Matrix R = Graph_GetRelationMatrix(g, r);
+			info = GrB_Matrix_apply(adj, NULL, GrB_LOR, GxB_ONE_BOOL, R, NULL);
+			ASSERT(info == GrB_SUCCESS);
+		}
+		info = GrB_transpose(tadj, NULL, NULL, adj, NULL);
+		ASSERT(info == GrB_SUCCESS);
+
+		info = GrB_wait(&adj);
+		ASSERT(info == GrB_SUCCESS);
+		info = GrB_wait(&tadj);
+		ASSERT(info == GrB_SUCCESS);
+		_RG_Matrix_SelectSparsity(adj);
+		_RG_Matrix_SelectSparsity(tadj);
+		graph->_adjacency_stale = false;
+	}
+
+	_RG_Matrix_Unlock(g->adjacency_matrix);
+}
+
 GrB_Matrix Graph_GetAdjacencyMatrix(const Graph *g) {
 	ASSERT(g);
 	RG_Matrix m = g->adjacency_matrix;
+	_Graph_RefreshAdjacency(g);
 	g->SynchronizeMatrix(g, m);
 	return RG_Matrix_Get_GrB_Matrix(m);
 }
@@ -1300,6 +2465,7 @@ GrB_Matrix Graph_GetAdjacencyMatrix(const Graph *g) {
 GrB_Matrix Graph_GetTransposedAdjacencyMatrix(const Graph *g) {
 	ASSERT(g);
 	RG_Matrix m = g->_t_adjacency_matrix;
+	_Graph_RefreshAdjacency(g);
 	g->SynchronizeMatrix(g, m);
 	return RG_Matrix_Get_GrB_Matrix(m);
 }
@@ -1318,6 +2484,8 @@ GrB_Matrix Graph_GetRelationMatrix(const Graph *g, int relation_idx) {
 		return Graph_GetAdjacencyMatrix(g);
 	} else {
 		RG_Matrix m = g->relations[relation_idx];
+		_RG_Matrix_Thaw(g, relation_idx);
+		_Graph_MergePending(g, relation_idx);
 		g->SynchronizeMatrix(g, m);
 		return RG_Matrix_Get_GrB_Matrix(m);
 	}
@@ -1332,11 +2500,57 @@ GrB_Matrix Graph_GetTransposedRelationMatrix(const Graph *g, int relation_idx) {
 		ASSERT(g->t_relations && "tried to retrieve nonexistent transposed matrix.");
 
 		RG_Matrix m = g->t_relations[relation_idx];
+		_Graph_MergePending(g, relation_idx);
 		g->SynchronizeMatrix(g, m);
 		return RG_Matrix_Get_GrB_Matrix(m);
 	}
 }
 
+GrB_Matrix Graph_GetCachedTransposedRelationMatrix(const Graph *g, int relation_idx) {
+	ASSERT(g && (relation_idx == GRAPH_NO_RELATION || relation_idx < Graph_RelationTypeCount(g)));
+
+	if(relation_idx == GRAPH_NO_RELATION || g->t_cache == NULL) {
+		return Graph_GetTransposedRelationMatrix(g, relation_idx);
+	}
+
+	GrB_Info info;
+	UNUSED(info);
+	// merges pending connections and resizes R
+	GrB_Matrix R = Graph_GetRelationMatrix(g, relation_idx);
+	GrB_Index dims = Graph_RequiredMatrixDim(g);
+	TransposeCache *c = g->t_cache + relation_idx;
+
+	// the transpose is computed once under the relation's lock,
+	// the cache's matrix outlives modifications as queries may refer to it
+	RG_Matrix_Lock(g->relations[relation_idx]);
+
+	if(c->m == NULL) {
+		c->m = RG_Matrix_New(GrB_UINT64, dims, dims);
+		c->stale = true;
+	}
+
+	GrB_Index n;
+	GrB_Matrix TR = RG_Matrix_Get_GrB_Matrix(c->m);
+	GrB_Matrix_nrows(&n, TR);
+	if(n != dims) {
+		info = GxB_Matrix_resize(TR, dims, dims);
+		ASSERT(info == GrB_SUCCESS);
+	}
+
+	if(c->stale) {
+		info = GrB_transpose(TR, GrB_NULL, GrB_NULL, R, GrB_NULL);
+		ASSERT(info == GrB_SUCCESS);
+		c->stale = false;
+	}
+	// fold in writers' patches
+	info = GrB_wait(&TR);
+	ASSERT(info == GrB_SUCCESS);
+
+	_RG_Matrix_Unlock(g->relations[relation_idx]);
+
+	return TR;
+}
+
 GrB_Matrix Graph_GetZeroMatrix(const Graph *g) {
 	GrB_Index nvals;
 	RG_Matrix z = g->_zero_matrix;
@@ -1349,11 +2563,19 @@ GrB_Matrix Graph_GetZeroMatrix(const Graph *g) {
 	return grb_z;
 }
 
+bool Graph_ReleaseEntityBlocks(Graph *g, uint block_count) {
+	ASSERT(g);
+
+	// blocks hold their entity properties, which are released along
+	while(block_count > 0 && DataBlock_FreeLastBlock(g->edges)) block_count--;
+	while(block_count > 0 && DataBlock_FreeLastBlock(g->nodes)) block_count--;
+
+	return g->edges->blockCount == 0 && g->nodes->blockCount == 0;
+}
+
 void Graph_Free(Graph *g) {
 	ASSERT(g);
 	// Free matrices.
-	Entity *en;
-	DataBlockIterator *it;
 	RG_Matrix_Free(g->_zero_matrix);
 	RG_Matrix_Free(g->adjacency_matrix);
 	RG_Matrix_Free(g->_t_adjacency_matrix);
@@ -1361,6 +2583,15 @@ void Graph_Free(Graph *g) {
 	_Graph_FreeRelationMatrices(g);
 	array_free(g->relations);
 	array_free(g->t_relations);
+	if(g->t_cache) {
+		uint count = array_len(g->t_cache);
+		for(uint i = 0; i < count; i++) {
+			if(g->t_cache[i].m) RG_Matrix_Free(g->t_cache[i].m);
+		}
+		array_free(g->t_cache);
+	}
+	_Graph_DiscardDegrees(g, GRAPH_NO_RELATION);
+	array_free(g->degrees);
 
 	uint32_t labelCount = array_len(g->labels);
 	for(int i = 0; i < labelCount; i++) {
@@ -1368,17 +2599,8 @@ void Graph_Free(Graph *g) {
 	}
 	array_free(g->labels);
 
-	it = Graph_ScanNodes(g);
-	while((en = (Entity *)DataBlockIterator_Next(it, NULL)) != NULL)
-		FreeEntity(en);
-
-	DataBlockIterator_Free(it);
-
-	it = Graph_ScanEdges(g);
-	while((en = DataBlockIterator_Next(it, NULL)) != NULL)
-		FreeEntity(en);
-
-	DataBlockIterator_Free(it);
+	// Free entities, blocks already released by Graph_ReleaseEntityBlocks are gone.
+	Graph_ReleaseEntityBlocks(g, UINT_MAX);
 
 	// Free blocks.
 	DataBlock_Free(g->nodes);
@@ -1388,6 +2610,12 @@ void Graph_Free(Graph *g) {
 	UNUSED(res);
 	res = pthread_mutex_destroy(&g->_writers_mutex);
 	ASSERT(res == 0);
+	res = pthread_mutex_destroy(&g->_suspend_mutex);
+	ASSERT(res == 0);
+	res = pthread_mutex_destroy(&g->_degrees_mutex);
+	ASSERT(res == 0);
+	res = pthread_cond_destroy(&g->_suspend_cond);
+	ASSERT(res == 0);
 
 	if(g->_writelocked) Graph_ReleaseLock(g);
 	res = pthread_rwlock_destroy(&g->_rwlock);
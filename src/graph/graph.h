@@ -38,6 +38,8 @@
 #define SINGLE_EDGE(x) (x) & MSB_MASK
 // Returns edge ID.
 #define SINGLE_EDGE_ID(x) CLEAR_MSB(x)
+// Returns the multi-edge run ID of X, see multi_edge_table.h.
+#define MULTI_EDGE_RUN(x) (x)
 
 typedef enum {
 	GRAPH_EDGE_DIR_INCOMING,
@@ -51,14 +53,59 @@ typedef enum {
 	DISABLED,
 } MATRIX_POLICY;
 
+// Compressed read-only copy of a relation matrix, see frozen_matrix.h.
+struct FrozenMatrix;
+// Edge IDs of a relation's multi-edge entries, see multi_edge_table.h.
+struct MultiEdgeTable;
+
+// Connection awaiting to be merged into a multi-edge relation matrix.
+typedef struct {
+	NodeID src;   // Source node ID.
+	NodeID dest;  // Destination node ID.
+	EdgeID id;    // Edge ID.
+} PendingConnection;
+
+// Connections of a single relation type, accumulated such that
+// each relation matrix is built at once, see Graph_BulkConnect.
+typedef struct {
+	GrB_Index *src;   // Source node IDs.
+	GrB_Index *dest;  // Destination node IDs.
+	EdgeID *ids;      // Edge IDs.
+} BulkConnections;
+
+// Number of edges of a single relation type leaving and reaching each node,
+// indexed by node ID, computed on first use, see Graph_NodeDegree.
+typedef struct {
+	uint64_t *out;  // Outgoing edges per node, NULL if not computed.
+	uint64_t *in;   // Incoming edges per node, NULL if not computed.
+} RelationDegrees;
+
 // Forward declaration of RG_Matrix type. Internal to graph.
 typedef struct {
 	bool allow_multi_edge;              // Entry i,j can contain multiple edges
-	GrB_Matrix grb_matrix;              // Underlying GrB_Matrix.
+	bool dirty;                         // Matrix holds changes not yet folded in.
+	GrB_Matrix grb_matrix;              // Underlying GrB_Matrix, NULL while frozen.
+	struct FrozenMatrix *frozen;        // Compressed copy, NULL unless frozen.
+	struct MultiEdgeTable *multi_edges; // Multi-edge runs, relation matrices only.
+	PendingConnection *pending;         // Connections not yet merged, NULL if none.
 	pthread_mutex_t mutex;              // Lock.
 } _RG_Matrix;
 typedef _RG_Matrix *RG_Matrix;
 
+// A relation's transpose, computed on first use when transposes aren't maintained.
+typedef struct {
+	RG_Matrix m;  // Transposed relation matrix, NULL until first requested.
+	bool stale;   // m misses changes made to the relation matrix since computed.
+} TransposeCache;
+
+// Graph locks whose contention is accounted for, see Graph_LockWait
+typedef enum {
+	GRAPH_LOCK_READ,     // _rwlock, acquired by a reader
+	GRAPH_LOCK_WRITE,    // _rwlock, acquired by a writer
+	GRAPH_LOCK_WRITERS,  // _writers_mutex
+	GRAPH_LOCK_COUNT
+} GraphLock;
+
 // Forward declaration of Graph struct
 typedef struct Graph Graph;
 // typedef for synchronization function pointer
@@ -69,13 +116,24 @@ struct Graph {
 	DataBlock *edges;                   // Graph edges stored in blocks.
 	RG_Matrix adjacency_matrix;         // Adjacency matrix, holds all graph connections.
 	RG_Matrix _t_adjacency_matrix;      // Transposed Adjacency matrix.
+	bool _maintain_adjacency;           // Writers update the adjacency matrices, see MAINTAIN_ADJACENCY.
+	bool _adjacency_stale;              // Unmaintained adjacency matrices miss relation changes.
 	RG_Matrix *labels;                  // Label matrices.
 	RG_Matrix *relations;               // Relation matrices.
 	RG_Matrix *t_relations;             // Transposed relation matrices.
+	TransposeCache *t_cache;            // Relation transposes computed on demand, NULL if maintained.
 	RG_Matrix _zero_matrix;             // Zero matrix.
+	RelationDegrees *degrees;           // Per relation node degrees, indexed by relation type.
+	pthread_mutex_t _degrees_mutex;     // Serializes readers computing node degrees.
 	pthread_mutex_t _writers_mutex;     // Mutex restrict single writer.
 	pthread_rwlock_t _rwlock;           // Read-write lock scoped to this specific graph
 	bool _writelocked;                  // true if the read-write lock was acquired by a writer
+	uint64_t _write_epoch;              // number of times the write lock was acquired
+	GrB_Index _reserved_dim;            // matrix dimension once reserved nodes are created
+	uint _suspended_readers;            // readers holding on to the graph while off-thread
+	pthread_mutex_t _suspend_mutex;     // protects _suspended_readers
+	pthread_cond_t _suspend_cond;       // signaled once all suspended readers resumed
+	uint64_t _lock_wait[GRAPH_LOCK_COUNT]; // time spent waiting for contended locks, in microseconds
 	SyncMatrixFunc SynchronizeMatrix;   // Function pointer to matrix synchronization routine.
 };
 
@@ -85,24 +143,56 @@ struct Graph {
 /* Acquire a lock that does not restrict access from additional reader threads */
 void Graph_AcquireReadLock(Graph *g);
 
+/* Acquire a read lock without blocking, returns false if held by a writer */
+bool Graph_TryAcquireReadLock(Graph *g);
+
 /* Acquire a lock for exclusive access to this graph's data */
 void Graph_AcquireWriteLock(Graph *g);
 
 /* Release the held lock */
 void Graph_ReleaseLock(Graph *g);
 
+/* Releases a held read lock while keeping writers out of the graph,
+ * allowing the reader to resume on a different thread.
+ * Writers wait for suspended readers to resume and release their lock. */
+void Graph_SuspendReadLock(Graph *g);
+
+/* Reacquires the read lock of a reader suspended by Graph_SuspendReadLock. */
+void Graph_ResumeReadLock(Graph *g);
+
 /* Writer request access to graph. */
 void Graph_WriterEnter(Graph *g);
 
+/* Writer request access to graph without blocking,
+ * returns true if access was granted. */
+bool Graph_TryWriterEnter(Graph *g);
+
 /* Writer release access to graph. */
 void Graph_WriterLeave(Graph *g);
 
+/* Returns the number of times the graph's write lock has been acquired,
+ * callers holding the read lock can compare epochs to detect intermediate writes. */
+uint64_t Graph_WriteEpoch(const Graph *g);
+
 /* Choose the current matrix synchronization policy. */
 void Graph_SetMatrixPolicy(Graph *g, MATRIX_POLICY policy);
 
 /* Synchronize and resize all matrices in graph. */
 void Graph_ApplyAllPending(Graph *g);
 
+/* Returns the total time threads spent waiting for the graph's lock
+ * while it was held by others, in milliseconds. */
+double Graph_LockWait(const Graph *g, GraphLock lock);
+
+/* Returns the time the calling thread spent waiting for and applying
+ * pending matrix operations, in milliseconds. */
+double Graph_SyncTime(void);
+
+/* Fold every pending change into the graph's matrices.
+ * Called by a writer holding the write lock just before releasing it,
+ * such that readers are never required to flush a matrix. */
+void Graph_FlushAllPending(Graph *g);
+
 // Create a new graph.
 Graph *Graph_New(
 	size_t node_cap,    // Allocation size for node datablocks and matrix dimensions.
@@ -114,12 +204,29 @@ int Graph_AddLabel(
 	Graph *g
 );
 
+/* Compresses every relation matrix into a frozen representation, releasing
+ * its GrB_Matrix. Neighbour lookups read frozen relations directly, a
+ * relation thaws back into a GrB_Matrix once it is retrieved as such, and is
+ * discarded once retrieved by a writer.
+ * Caller must have exclusive access to the graph. */
+void Graph_FreezeRelations(
+	Graph *g
+);
+
+// Returns true if relation r is frozen.
+bool Graph_RelationFrozen(
+	const Graph *g,
+	int r
+);
+
 // Creates a new relation matrix, returns id given to relation.
 int Graph_AddRelationType(
 	Graph *g
 );
 
 // Make sure graph can hold an additional N nodes.
+// until the writer commits, matrices resized under the RESIZE_TO_CAPACITY
+// policy are sized to fit these nodes rather than the node capacity
 void Graph_AllocateNodes(
 	Graph *g,               // Graph for which nodes will be added.
 	size_t n                // Number of nodes to create.
@@ -149,6 +256,69 @@ int Graph_ConnectNodes(
 	Edge *e
 );
 
+// Allocates a new edge of relation type r between src and dest
+// without connecting the two, see Graph_BulkFormConnections.
+void Graph_CreateEdge(
+	Graph *g,           // Graph on which to operate.
+	NodeID src,         // Source node ID.
+	NodeID dest,        // Destination node ID.
+	int r,              // Edge type.
+	Edge *e             // [output] created edge.
+);
+
+// Connects n pairs of nodes with relation type r using a single matrix
+// build per relation matrix, the adjacency matrices are left untouched,
+// see Graph_BulkConnectAdjacency.
+// invocations for distinct relation types may run concurrently.
+void Graph_BulkFormConnections(
+	Graph *g,               // Graph on which to operate.
+	int r,                  // Edge type.
+	const GrB_Index *src,   // Source node IDs.
+	const GrB_Index *dest,  // Destination node IDs.
+	EdgeID *ids,            // Edge IDs, overwritten in the process.
+	GrB_Index n             // Number of connections.
+);
+
+// Sets the adjacency matrices for n pairs of connected nodes.
+void Graph_BulkConnectAdjacency(
+	Graph *g,               // Graph on which to operate.
+	const GrB_Index *src,   // Source node IDs.
+	const GrB_Index *dest,  // Destination node IDs.
+	GrB_Index n             // Number of connections.
+);
+
+// Replaces relation r's matrix with R, taking ownership over R
+// R's entries are edge IDs and multi-edge runs of relation r, see
+// MultiEdgeTable, relation r's transpose and the adjacency matrices
+// are updated to hold R's connections.
+void Graph_ImportRelationMatrix(
+	Graph *g,               // Graph on which to operate.
+	int r,                  // Edge type.
+	GrB_Matrix R            // Relation matrix.
+);
+
+// Labels n nodes with label using a single label matrix build.
+void Graph_BulkLabelNodes(
+	Graph *g,               // Graph on which to operate.
+	int label,              // Label ID.
+	const GrB_Index *ids,   // Node IDs.
+	GrB_Index n             // Number of nodes.
+);
+
+// Buffers edge e's connection within conns, an array indexed by
+// relation type, the connection is formed by Graph_BulkConnect.
+void Graph_BufferConnection(
+	BulkConnections **conns,  // Connection buffers.
+	const Edge *e             // Created edge, see Graph_CreateEdge.
+);
+
+// Forms all connections buffered within conns and frees their buffers,
+// relation matrices are built in parallel, one relation type per thread.
+void Graph_BulkConnect(
+	Graph *g,                // Graph on which to operate.
+	BulkConnections *conns   // Connection buffers.
+);
+
 // Removes node and all of its connections within the graph.
 void Graph_DeleteNode(
 	Graph *g,
@@ -161,9 +331,19 @@ int Graph_DeleteEdge(
 	Edge *e
 );
 
+// Notes an in-place update of an entity's attributes,
+// such that state derived from the entity's storage block is refreshed.
+void Graph_MarkEntityModified(
+	Graph *g,
+	GraphEntityType t,  // Entity type, node / edge.
+	EntityID id         // Entity ID.
+);
+
 // Returns true if the given entity has been deleted.
 bool Graph_EntityIsDeleted(
-	Entity *e
+	const Graph *g,
+	GraphEntityType t,  // Entity type, node / edge.
+	EntityID id         // Entity ID.
 );
 
 // Removes both nodes and edges from graph.
@@ -177,6 +357,65 @@ void Graph_BulkDelete(
 	uint *edge_deleted  // Number of edges removed.
 );
 
+// Defragments node and edge storage, entity IDs are preserved.
+// Returns the number of bytes released.
+size_t Graph_CompactEntities(
+	Graph *g
+);
+
+// Relabels nodes, node order[i] is assigned ID i.
+// order lists each of the graph's nodes exactly once, deleted node IDs
+// are discarded such that node IDs range from 0 to the node count.
+// Node storage and every matrix are permuted consistently,
+// caller is expected to hold the write lock.
+void Graph_PermuteNodes(
+	Graph *g,
+	const NodeID *order
+);
+
+// Relabels edges such that the edges of each relation type are stored
+// contiguously, ordered by source and destination, relation by relation.
+// Edge scans, property filters and encoders of a single relation type then
+// read consecutive records. Deleted edge IDs are discarded, such that edge IDs
+// range from 0 to the edge count, node IDs are preserved.
+// Caller is expected to hold the write lock.
+// Returns the number of edges relabeled.
+uint64_t Graph_ClusterEdges(
+	Graph *g
+);
+
+// Returns the number of bytes held by node and edge storage,
+// excluding entity attributes.
+size_t Graph_EntitiesMemoryUsage(
+	const Graph *g
+);
+
+// Returns an estimate of the number of bytes held by the graph matrices,
+// must be called under the graph read lock.
+size_t Graph_MatricesMemoryUsage(
+	const Graph *g
+);
+
+// Returns an estimate of the number of bytes held by the adjacency matrix
+// and its transpose, must be called under the graph read lock.
+size_t Graph_AdjacencyMatrixMemoryUsage(
+	const Graph *g
+);
+
+// Returns an estimate of the number of bytes held by a label matrix,
+// must be called under the graph read lock.
+size_t Graph_LabelMatrixMemoryUsage(
+	const Graph *g,
+	int label
+);
+
+// Returns an estimate of the number of bytes held by a relation matrix,
+// its transpose and multi-edge table, must be called under the graph read lock.
+size_t Graph_RelationMatrixMemoryUsage(
+	const Graph *g,
+	int relation
+);
+
 // All graph matrices are required to be squared NXN
 // where N is Graph_RequiredMatrixDim.
 size_t Graph_RequiredMatrixDim(
@@ -216,6 +455,29 @@ size_t Graph_EdgeCount(
 	const Graph *g
 );
 
+// Returns number of connected node pairs with given relation type.
+size_t Graph_RelationEdgeCount(
+	const Graph *g,
+	int relation
+);
+
+// Returns number of edges with given relation type.
+uint64_t Graph_RelationEdgeTotal(
+	const Graph *g,
+	int relation
+);
+
+// Returns number of edges of relation r connected to node id,
+// outgoing, incoming or both according to dir, any relation if r is GRAPH_NO_RELATION.
+// A relation's degrees are computed at once on first use and are maintained
+// by subsequent connections and deletions, bulk modifications discard them.
+uint64_t Graph_NodeDegree(
+	const Graph *g,
+	NodeID id,
+	int r,
+	GRAPH_EDGE_DIR dir
+);
+
 // Returns number of deleted edges in the graph.
 uint Graph_DeletedEdgeCount(
 	const Graph *g
@@ -239,6 +501,21 @@ int Graph_GetNode(
 	Node *n
 );
 
+// Retrieves count nodes by their IDs, a node's entity is NULL if it is deleted
+// the storage of the nodes ahead is prefetched while nodes are retrieved.
+void Graph_GetNodes(
+	const Graph *g,
+	const NodeID *ids,  // Node IDs.
+	uint64_t count,     // Number of IDs.
+	Node *nodes         // [output] Nodes, count entries.
+);
+
+// Hints the CPU to fetch node with given id ahead of its retrieval.
+void Graph_PrefetchNode(
+	const Graph *g,
+	NodeID id
+);
+
 // Retrieves node label
 // Returns GRAPH_NO_LABEL if node has no label.
 int Graph_GetNodeLabel(
@@ -246,14 +523,24 @@ int Graph_GetNodeLabel(
 	NodeID nodeID
 );
 
-// Retrieves edge with given id from graph,
-// Returns NULL if edge wasn't found.
+// Retrieves edge with given id from graph, along with its endpoints
+// and relation type, Returns NULL if edge wasn't found.
 int Graph_GetEdge(
 	const Graph *g,
 	EdgeID id,
 	Edge *e
 );
 
+// Retrieves count edges by their IDs, along with their endpoints and
+// relation type, an edge's entity is NULL if it is deleted
+// the storage of the edges ahead is prefetched while edges are retrieved.
+void Graph_GetEdges(
+	const Graph *g,
+	const EdgeID *ids,  // Edge IDs.
+	uint64_t count,     // Number of IDs.
+	Edge *edges         // [output] Edges, count entries.
+);
+
 // Retrieves edge relation type
 // Returns GRAPH_NO_RELATION if edge has no relation type.
 int Graph_GetEdgeRelation(
@@ -261,6 +548,15 @@ int Graph_GetEdgeRelation(
 	Edge *e
 );
 
+// Retrieves the edge IDs of relation r's multi-edge entry,
+// valid until the relation is next modified.
+const EdgeID *Graph_MultiEdgeIDs(
+	const Graph *g,
+	int r,
+	EdgeID entry,
+	uint32_t *count
+);
+
 // Retrieves edges connecting source to destination,
 // relation is optional, pass GRAPH_NO_RELATION if you do not care
 // about edge type.
@@ -324,11 +620,28 @@ GrB_Matrix Graph_GetTransposedRelationMatrix(
 	int relation        // Relation described by matrix.
 );
 
+// Retrieves a transposed typed adjacency matrix, whether transposes are
+// maintained or not. Unmaintained transposes are computed on first use and
+// shared by subsequent queries until the relation is modified.
+GrB_Matrix Graph_GetCachedTransposedRelationMatrix(
+	const Graph *g,     // Graph from which to get adjacency matrix.
+	int relation        // Relation described by matrix.
+);
+
 // Retrieves the zero matrix.
 // The function will resize it to match all other
 // internal matrices, caller mustn't modify it in any way.
 GrB_Matrix Graph_GetZeroMatrix(const Graph *g);
 
+// Releases up to block_count of the graph's entity blocks along with their
+// entities, spreading the teardown of a large graph over multiple calls.
+// Once called, the graph may only be passed to further calls and to Graph_Free.
+// Returns true once all entity blocks had been released.
+bool Graph_ReleaseEntityBlocks(
+	Graph *g,
+	uint block_count    // maximum number of blocks to release
+);
+
 // Free graph.
 void Graph_Free(
 	Graph *g
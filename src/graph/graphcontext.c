@@ -4,17 +4,25 @@
 * This file is available under the Redis Labs Source Available License Agreement
 */
 
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <sys/param.h>
 #include <pthread.h>
 #include "graphcontext.h"
+#include "materialized_view.h"
 #include "../RG.h"
 #include "../util/arr.h"
 #include "../util/uuid.h"
 #include "../query_ctx.h"
 #include "../redismodule.h"
 #include "../util/rmalloc.h"
+#include "../util/cron.h"
 #include "../util/thpool/pools.h"
+#include "../serializers/serializer_io.h"
 #include "../serializers/graphcontext_type.h"
+#include "../serializers/encoder/encode_graph.h"
+#include "../serializers/decoders/decode_graph.h"
 #include "../commands/execution_ctx.h"
 
 // Global array tracking all extant GraphContexts (defined in module.c)
@@ -24,9 +32,27 @@ extern uint currently_decoding_graphs;
 // GraphContext type as it is registered at Redis.
 extern RedisModuleType *GraphContextRedisModuleType;
 
+// Incremented by each graph retrieval, orders graphs by their last access.
+// Graphs are retrieved by the main thread, guarded by the GIL.
+static uint64_t _access_clock = 0;
+
+// Eviction files are created within the server's working directory.
+#define EVICTION_FILE_TEMPLATE "redisgraph_evicted_XXXXXX"
+
+// Module event handler functions declarations.
+void ModuleEventHandler_IncreaseDecodingGraphsCount(void);
+
+// Number of entity blocks released by each step of an async graph deletion.
+#define GRAPH_DELETE_STEP_BLOCKS 4
+// Delay in ms between consecutive steps of an async graph deletion.
+#define GRAPH_DELETE_STEP_INTERVAL 10
+
 // Forward declarations.
 static void _GraphContext_Free(void *arg);
+static void _GraphContext_FreeStep(void *arg);
+static void _GraphContext_ScheduleFreeStep(void *arg);
 static void _GraphContext_UpdateVersion(GraphContext *gc, const char *str);
+static void _GraphContext_FreeContent(GraphContext *gc);
 
 static inline void _GraphContext_IncreaseRefCount(GraphContext *gc) {
 	__atomic_fetch_add(&gc->ref_count, 1, __ATOMIC_RELAXED);
@@ -39,8 +65,8 @@ static inline void _GraphContext_DecreaseRefCount(GraphContext *gc) {
 		Config_Option_get(Config_ASYNC_DELETE, &async_delete);
 
 		if(async_delete) {
-			// Async delete
-			ThreadPools_AddWorkWriter(_GraphContext_Free, gc);
+			// Async delete, the graph is released in steps
+			_GraphContext_ScheduleFreeStep(gc);
 		} else {
 			// Sync delete
 			_GraphContext_Free(gc);
@@ -52,37 +78,83 @@ static inline void _GraphContext_DecreaseRefCount(GraphContext *gc) {
 // GraphContext API
 //------------------------------------------------------------------------------
 
-// Creates and initializes a graph context struct.
-GraphContext *GraphContext_New(const char *graph_name, size_t node_cap, size_t edge_cap) {
-	GraphContext *gc = rm_malloc(sizeof(GraphContext));
-
-	gc->version          = 0;  // initial graph version
-	gc->slowlog          = SlowLog_New();
-	gc->ref_count        = 0;  // no refences
-	gc->attributes       = raxNew();
-	gc->index_count      = 0;  // no indicies
-	gc->string_mapping   = array_new(char *, 64);
-	gc->encoding_context = GraphEncodeContext_New();
-	gc->decoding_context = GraphDecodeContext_New();
+// Allocate the graph's content: its graph, schemas and caches
+// these are released when the graph is evicted and reallocated on reload
+static void _GraphContext_InitContent(GraphContext *gc, size_t node_cap,
+		size_t edge_cap) {
+	gc->attributes  = AttributeTable_New();
+	gc->index_count = 0;  // no indicies
 
 	// initialize the graph's matrices and datablock storage
 	gc->g = Graph_New(node_cap, edge_cap);
-	gc->graph_name = rm_strdup(graph_name);
 
 	// allocate the default space for schemas and indices
 	gc->node_schemas = array_new(Schema *, GRAPH_DEFAULT_LABEL_CAP);
 	gc->relation_schemas = array_new(Schema *, GRAPH_DEFAULT_RELATION_TYPE_CAP);
 
-	// initialize the read-write lock to protect access to the attributes rax
-	assert(pthread_rwlock_init(&gc->_attribute_rwlock, NULL) == 0);
-
 	// build the execution plans cache
 	uint64_t cache_size;
 	Config_Option_get(Config_CACHE_SIZE, &cache_size);
 	gc->cache = Cache_New(cache_size, (CacheEntryFreeFunc)ExecutionCtx_Free,
 						  (CacheEntryCopyFunc)ExecutionCtx_Clone);
+	gc->hot_queries = NULL;
+	gc->product_cache = ProductCache_New();
+	gc->result_cache = ResultCache_New();
+
+	// intern string properties if enabled
+	bool intern_strings;
+	Config_Option_get(Config_INTERN_STRINGS, &intern_strings);
+	gc->string_pool = (intern_strings) ? StringPool_New() : NULL;
+
+	// hold large string properties in a value log if enabled
+	uint64_t value_log_threshold;
+	Config_Option_get(Config_VALUE_LOG_THRESHOLD, &value_log_threshold);
+	gc->value_log = (value_log_threshold > 0) ?
+		ValueLog_New(value_log_threshold) : NULL;
+
+	// no encoded blocks, populated by maintenance if enabled
+	gc->node_packs = PackCache_New(false);
+	gc->edge_packs = PackCache_New(true);
+
+	// no projections
+	gc->projections = array_new(Projection *, 0);
+
+	// no materialized views
+	gc->views = array_new(MaterializedView *, 0);
 
 	Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
+}
+
+// Creates and initializes a graph context struct.
+GraphContext *GraphContext_New(const char *graph_name, size_t node_cap, size_t edge_cap) {
+	GraphContext *gc = rm_malloc(sizeof(GraphContext));
+
+	gc->version          = 0;  // initial graph version
+	gc->slowlog          = SlowLog_New();
+	gc->query_stats      = QueryStats_New();
+	gc->metrics          = GraphMetrics_New();
+	gc->ref_count        = 0;  // no refences
+	gc->encoding_context = GraphEncodeContext_New();
+	gc->decoding_context = GraphDecodeContext_New();
+	gc->maintained_epoch = 0;  // never maintained
+	gc->graph_name       = rm_strdup(graph_name);
+
+	// resident, accessed as it's created
+	gc->residency.fd          = -1;
+	gc->residency.len         = 0;
+	gc->residency.last_access = ++_access_clock;
+
+	// no write queries are pending group commit
+	gc->write_group.queued    = array_new(void *, 0);
+	gc->write_group.scheduled = false;
+	gc->write_group.active    = false;
+	gc->write_group.modified  = false;
+	assert(pthread_mutex_init(&gc->write_group.lock, NULL) == 0);
+
+	// no queries are running against the graph
+	QueryQuota_Init(&gc->quota);
+
+	_GraphContext_InitContent(gc, node_cap, edge_cap);
 	QueryCtx_SetGraphCtx(gc);
 
 	return gc;
@@ -144,7 +216,15 @@ GraphContext *GraphContext_Retrieve(RedisModuleCtx *ctx, RedisModuleString *grap
 
 	RedisModule_CloseKey(key);
 
-	if(gc) _GraphContext_IncreaseRefCount(gc);
+	if(gc && GraphContext_IsEvicted(gc) && !GraphContext_Reload(gc)) {
+		RedisModule_ReplyWithError(ctx, "ERR Failed to reload evicted graph");
+		return NULL;
+	}
+
+	if(gc) {
+		gc->residency.last_access = ++_access_clock;
+		_GraphContext_IncreaseRefCount(gc);
+	}
 
 	return gc;
 }
@@ -154,6 +234,11 @@ void GraphContext_Release(GraphContext *gc) {
 	_GraphContext_DecreaseRefCount(gc);
 }
 
+void GraphContext_Retain(GraphContext *gc) {
+	ASSERT(gc);
+	_GraphContext_IncreaseRefCount(gc);
+}
+
 void GraphContext_MarkWriter(RedisModuleCtx *ctx, GraphContext *gc) {
 	RedisModuleString *graphID = RedisModule_CreateString(ctx, gc->graph_name, strlen(gc->graph_name));
 
@@ -256,11 +341,11 @@ Schema *GraphContext_AddSchema(GraphContext *gc, const char *label, SchemaType t
 
 	if(t == SCHEMA_NODE) {
 		label_id = Graph_AddLabel(gc->g);
-		schema = Schema_New(label, label_id);
+		schema = Schema_New(label, label_id, t);
 		gc->node_schemas = array_append(gc->node_schemas, schema);
 	} else {
 		label_id = Graph_AddRelationType(gc->g);
-		schema = Schema_New(label, label_id);
+		schema = Schema_New(label, label_id, t);
 		gc->relation_schemas = array_append(gc->relation_schemas, schema);
 	}
 
@@ -276,6 +361,151 @@ const char *GraphContext_GetNodeLabel(const GraphContext *gc, Node *n) {
 	return gc->node_schemas[label_id]->name;
 }
 
+void GraphContext_DropColumns(GraphContext *gc) {
+	ASSERT(gc != NULL);
+	uint count = array_len(gc->node_schemas);
+	for(uint i = 0; i < count; i++) Schema_DropColumns(gc->node_schemas[i]);
+
+	// weight matrices are a copy of relationship attributes
+	count = array_len(gc->relation_schemas);
+	for(uint i = 0; i < count; i++) Schema_DropWeights(gc->relation_schemas[i]);
+}
+
+void GraphContext_RefreshStatistics(GraphContext *gc) {
+	ASSERT(gc != NULL);
+
+	// counts are read by planners without holding the graph lock
+	uint count = array_len(gc->node_schemas);
+	for(uint i = 0; i < count; i++) {
+		Schema *s = gc->node_schemas[i];
+		__atomic_store_n(&s->entity_count, Graph_LabeledNodeCount(gc->g, s->id),
+				__ATOMIC_RELAXED);
+	}
+
+	count = array_len(gc->relation_schemas);
+	for(uint i = 0; i < count; i++) {
+		Schema *s = gc->relation_schemas[i];
+		__atomic_store_n(&s->entity_count, Graph_RelationEdgeCount(gc->g, s->id),
+				__ATOMIC_RELAXED);
+	}
+}
+
+// relocates the logged properties of the scanned entities
+static void _GraphContext_RelocateLoggedProperties(DataBlockIterator *it) {
+	Entity *e;
+	while((e = DataBlockIterator_Next(it, NULL)) != NULL) {
+		Entity_RelocateLoggedProperties(e);
+	}
+	DataBlockIterator_Free(it);
+}
+
+size_t GraphContext_CompactValueLog(GraphContext *gc) {
+	ASSERT(gc != NULL);
+
+	ValueLog *log = gc->value_log;
+	if(log == NULL || !ValueLog_CompactionDue(log)) return 0;
+
+	// columns share the strings about to be relocated
+	GraphContext_DropColumns(gc);
+
+	uint64_t mapped = ValueLog_MappedBytes(log);
+	ValueLog_BeginCompaction(log);
+	_GraphContext_RelocateLoggedProperties(Graph_ScanNodes(gc->g));
+	_GraphContext_RelocateLoggedProperties(Graph_ScanEdges(gc->g));
+	ValueLog_EndCompaction(log);
+
+	// relocated values may have called for new segments
+	uint64_t remapped = ValueLog_MappedBytes(log);
+	return (remapped < mapped) ? mapped - remapped : 0;
+}
+
+//------------------------------------------------------------------------------
+// Projection API
+//------------------------------------------------------------------------------
+
+static int _GraphContext_ProjectionIdx(const GraphContext *gc, const char *name) {
+	uint count = array_len(gc->projections);
+	for(uint i = 0; i < count; i++) {
+		if(strcmp(gc->projections[i]->name, name) == 0) return i;
+	}
+	return -1;
+}
+
+Projection *GraphContext_GetProjection(const GraphContext *gc, const char *name) {
+	ASSERT(gc != NULL);
+	ASSERT(name != NULL);
+	int idx = _GraphContext_ProjectionIdx(gc, name);
+	return (idx == -1) ? NULL : gc->projections[idx];
+}
+
+void GraphContext_AddProjection(GraphContext *gc, Projection *p) {
+	ASSERT(gc != NULL);
+	ASSERT(p != NULL);
+	GraphContext_RemoveProjection(gc, p->name);
+	gc->projections = array_append(gc->projections, p);
+}
+
+bool GraphContext_RemoveProjection(GraphContext *gc, const char *name) {
+	ASSERT(gc != NULL);
+	ASSERT(name != NULL);
+	int idx = _GraphContext_ProjectionIdx(gc, name);
+	if(idx == -1) return false;
+
+	Projection_Free(gc->projections[idx]);
+	array_del_fast(gc->projections, idx);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Materialized view API
+//------------------------------------------------------------------------------
+
+static int _GraphContext_ViewIdx(const GraphContext *gc, const char *name) {
+	uint count = array_len(gc->views);
+	for(uint i = 0; i < count; i++) {
+		if(strcmp(gc->views[i]->name, name) == 0) return i;
+	}
+	return -1;
+}
+
+MaterializedView *GraphContext_GetView(const GraphContext *gc, const char *name) {
+	ASSERT(gc != NULL);
+	ASSERT(name != NULL);
+	int idx = _GraphContext_ViewIdx(gc, name);
+	return (idx == -1) ? NULL : gc->views[idx];
+}
+
+void GraphContext_AddView(GraphContext *gc, MaterializedView *view) {
+	ASSERT(gc != NULL);
+	ASSERT(view != NULL);
+	GraphContext_RemoveView(gc, view->name);
+	gc->views = array_append(gc->views, view);
+}
+
+bool GraphContext_RemoveView(GraphContext *gc, const char *name) {
+	ASSERT(gc != NULL);
+	ASSERT(name != NULL);
+	int idx = _GraphContext_ViewIdx(gc, name);
+	if(idx == -1) return false;
+
+	MaterializedView_Free(gc->views[idx]);
+	array_del_fast(gc->views, idx);
+	return true;
+}
+
+bool GraphContext_HasViews(const GraphContext *gc) {
+	ASSERT(gc != NULL);
+	return (gc->views != NULL && array_len(gc->views) > 0);
+}
+
+void GraphContext_UpdateViews(GraphContext *gc, const char *effects, size_t len) {
+	ASSERT(gc != NULL);
+	uint count = array_len(gc->views);
+	for(uint i = 0; i < count; i++) {
+		MaterializedView_Update(gc->views[i], gc, effects, len);
+	}
+}
+
 const char *GraphContext_GetEdgeRelationType(const GraphContext *gc, Edge *e) {
 	int reltype_id = Graph_GetEdgeRelation(gc->g, e);
 	ASSERT(reltype_id != GRAPH_NO_RELATION);
@@ -283,67 +513,25 @@ const char *GraphContext_GetEdgeRelationType(const GraphContext *gc, Edge *e) {
 }
 
 uint GraphContext_AttributeCount(GraphContext *gc) {
-	pthread_rwlock_rdlock(&gc->_attribute_rwlock);
-	uint size = raxSize(gc->attributes);
-	pthread_rwlock_unlock(&gc->_attribute_rwlock);
-	return size;
+	return AttributeTable_Count(gc->attributes);
 }
 
-Attribute_ID GraphContext_FindOrAddAttribute(GraphContext *gc, const char *attribute) {
-	// Acquire a read lock for looking up the attribute.
-	pthread_rwlock_rdlock(&gc->_attribute_rwlock);
-
-	// See if attribute already exists.
-	void *attribute_id = raxFind(gc->attributes, (unsigned char *)attribute, strlen(attribute));
-
-	if(attribute_id == raxNotFound) {
-		// We are writing to the shared GraphContext; release the held lock and re-acquire as a writer.
-		pthread_rwlock_unlock(&gc->_attribute_rwlock);
-		pthread_rwlock_wrlock(&gc->_attribute_rwlock);
-
-		// Lookup the attribute again now that we are in a critical region.
-		attribute_id = raxFind(gc->attributes, (unsigned char *)attribute, strlen(attribute));
-		// If it has been set by another thread, use the retrieved value.
-		if(attribute_id == raxNotFound) {
-			// Otherwise, it will be assigned an ID equal to the current mapping size.
-			attribute_id = (void *)raxSize(gc->attributes);
-			// Insert the new attribute key and ID.
-			raxInsert(gc->attributes,
-					  (unsigned char *)attribute,
-					  strlen(attribute),
-					  attribute_id,
-					  NULL);
-			gc->string_mapping = array_append(gc->string_mapping, rm_strdup(attribute));
-
-			// new attribute been added, update graph version
-			_GraphContext_UpdateVersion(gc, attribute);
-		}
-	}
+// new attribute been added, update graph version
+static void _GraphContext_AttributeAdded(void *ctx, const char *attribute) {
+	_GraphContext_UpdateVersion((GraphContext *)ctx, attribute);
+}
 
-	// Release the lock.
-	pthread_rwlock_unlock(&gc->_attribute_rwlock);
-	return (uintptr_t)attribute_id;
+Attribute_ID GraphContext_FindOrAddAttribute(GraphContext *gc, const char *attribute) {
+	return AttributeTable_FindOrAdd(gc->attributes, attribute,
+			_GraphContext_AttributeAdded, gc);
 }
 
 const char *GraphContext_GetAttributeString(GraphContext *gc, Attribute_ID id) {
-	pthread_rwlock_rdlock(&gc->_attribute_rwlock);
-	ASSERT(id < array_len(gc->string_mapping));
-	const char *name = gc->string_mapping[id];
-	pthread_rwlock_unlock(&gc->_attribute_rwlock);
-	return name;
+	return AttributeTable_Name(gc->attributes, id);
 }
 
 Attribute_ID GraphContext_GetAttributeID(GraphContext *gc, const char *attribute) {
-	// Acquire a read lock for looking up the attribute.
-	pthread_rwlock_rdlock(&gc->_attribute_rwlock);
-	// Look up the attribute ID.
-	void *id = raxFind(gc->attributes, (unsigned char *)attribute, strlen(attribute));
-	// Release the lock.
-	pthread_rwlock_unlock(&gc->_attribute_rwlock);
-
-	if(id == raxNotFound) return ATTRIBUTE_NOTFOUND;
-
-	return (uintptr_t)id;
+	return AttributeTable_Find(gc->attributes, attribute);
 }
 
 //------------------------------------------------------------------------------
@@ -356,6 +544,11 @@ bool GraphContext_HasIndices(GraphContext *gc) {
 	for(uint i = 0; i < schema_count; i++) {
 		if(Schema_HasIndices(gc->node_schemas[i])) return true;
 	}
+
+	schema_count = array_len(gc->relation_schemas);
+	for(uint i = 0; i < schema_count; i++) {
+		if(Schema_HasIndices(gc->relation_schemas[i])) return true;
+	}
 	return false;
 }
 
@@ -388,6 +581,22 @@ int GraphContext_AddIndex(Index **idx, GraphContext *gc, const char *label,
 	return res;
 }
 
+int GraphContext_AddCompositeIndex(Index **idx, GraphContext *gc, const char *label,
+								   const char **fields, uint count) {
+
+	ASSERT(idx && gc && label && fields);
+
+	// Retrieve the schema for this label
+	Schema *s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+	if(s == NULL) s = GraphContext_AddSchema(gc, label, SCHEMA_NODE);
+
+	int res = Schema_AddCompositeIndex(idx, s, fields, count);
+	ResultSet *result_set = QueryCtx_GetResultSet();
+	ResultSet_IndexCreated(result_set, res);
+
+	return res;
+}
+
 int GraphContext_DeleteIndex(GraphContext *gc, const char *label,
 							 const char *field, IndexType type) {
 	ASSERT(gc != NULL);
@@ -409,27 +618,96 @@ int GraphContext_DeleteIndex(GraphContext *gc, const char *label,
 	return res;
 }
 
-// Delete all references to a node from any indices built upon its properties
-void GraphContext_DeleteNodeFromIndices(GraphContext *gc, Node *n) {
-	Schema *s = NULL;
+int GraphContext_AddConstraint(UniqueConstraint **uc, GraphContext *gc,
+							   const char *label, const char *field) {
 
-	if(n->label) {
-		// Node will have a label string if one was specified in the query MATCH clause
-		s = GraphContext_GetSchema(gc, n->label, SCHEMA_NODE);
-	} else {
-		EntityID node_id = ENTITY_GET_ID(n);
-		// Otherwise, look up the offset of the matching label (if any)
-		int schema_id = Graph_GetNodeLabel(gc->g, node_id);
-		// Do nothing if node had no label
-		if(schema_id == GRAPH_NO_LABEL) return;
-		s = GraphContext_GetSchemaByID(gc, schema_id, SCHEMA_NODE);
+	ASSERT(uc && gc && label && field);
+
+	// Retrieve the schema for this label
+	Schema *s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+	if(s == NULL) s = GraphContext_AddSchema(gc, label, SCHEMA_NODE);
+
+	// constraints are backed by their own index, reported as such
+	int res = Schema_AddConstraint(uc, s, field);
+	ResultSet *result_set = QueryCtx_GetResultSet();
+	ResultSet_IndexCreated(result_set, res);
+
+	return res;
+}
+
+int GraphContext_DeleteConstraint(GraphContext *gc, const char *label,
+								  const char *field) {
+	ASSERT(gc != NULL);
+	ASSERT(label != NULL);
+
+	int res = INDEX_FAIL;
+	Schema *s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+
+	if(s != NULL) {
+		res = Schema_RemoveConstraint(s, field);
+		if(res != INDEX_FAIL) {
+			// update resultset statistics
+			ResultSet *result_set = QueryCtx_GetResultSet();
+			ResultSet_IndexDeleted(result_set, res);
+		}
+	}
+
+	return res;
+}
+
+Index *GraphContext_GetEdgeIndex(const GraphContext *gc, const char *relation,
+								 Attribute_ID *attribute_id) {
+	ASSERT(gc != NULL);
+	ASSERT(relation != NULL);
+
+	Schema *s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
+	if(s == NULL) return NULL;
+
+	return Schema_GetIndex(s, attribute_id, IDX_EXACT_MATCH);
+}
+
+int GraphContext_AddEdgeIndex(Index **idx, GraphContext *gc, const char *relation,
+							  const char *field) {
+	ASSERT(idx && gc && relation && field);
+
+	// Retrieve the schema for this relationship type
+	Schema *s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
+	if(s == NULL) s = GraphContext_AddSchema(gc, relation, SCHEMA_EDGE);
+
+	int res = Schema_AddIndex(idx, s, field, IDX_EXACT_MATCH);
+	ResultSet *result_set = QueryCtx_GetResultSet();
+	ResultSet_IndexCreated(result_set, res);
+
+	return res;
+}
+
+int GraphContext_DeleteEdgeIndex(GraphContext *gc, const char *relation,
+								 const char *field) {
+	ASSERT(gc && relation && field);
+
+	int res = INDEX_FAIL;
+	Schema *s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
+
+	if(s != NULL) {
+		res = Schema_RemoveIndex(s, field, IDX_EXACT_MATCH);
+		if(res != INDEX_FAIL) {
+			// update resultset statistics
+			ResultSet *result_set = QueryCtx_GetResultSet();
+			ResultSet_IndexDeleted(result_set, res);
+		}
+	}
+
+	return res;
+}
+
+void GraphContext_DeleteEdgeFromIndices(GraphContext *gc, Edge *e) {
+	int relation_id = Edge_GetRelationID(e);
+	if(relation_id == GRAPH_NO_RELATION || relation_id == GRAPH_UNKNOWN_RELATION) {
+		return;
 	}
 
-	// Update any indices this entity is represented in
-	Index *idx = Schema_GetIndex(s, NULL, IDX_FULLTEXT);
-	if(idx) Index_RemoveNode(idx, n);
-	idx = Schema_GetIndex(s, NULL, IDX_EXACT_MATCH);
-	if(idx) Index_RemoveNode(idx, n);
+	Schema *s = GraphContext_GetSchemaByID(gc, relation_id, SCHEMA_EDGE);
+	Schema_RemoveEdgeFromIndices(s, e);
 }
 
 //------------------------------------------------------------------------------
@@ -479,6 +757,18 @@ SlowLog *GraphContext_GetSlowLog(const GraphContext *gc) {
 	return gc->slowlog;
 }
 
+// Return query statistics registry associated with graph context.
+QueryStats *GraphContext_GetQueryStats(const GraphContext *gc) {
+	ASSERT(gc);
+	return gc->query_stats;
+}
+
+// Return metrics associated with graph context.
+GraphMetrics *GraphContext_GetMetrics(const GraphContext *gc) {
+	ASSERT(gc);
+	return gc->metrics;
+}
+
 //------------------------------------------------------------------------------
 // Cache API
 //------------------------------------------------------------------------------
@@ -489,18 +779,232 @@ Cache *GraphContext_GetCache(const GraphContext *gc) {
 	return gc->cache;
 }
 
+void GraphContext_SnapshotHotQueries(GraphContext *gc) {
+	ASSERT(gc != NULL);
+	GraphContext_ClearHotQueries(gc);
+	// evicted graphs hold no cache
+	if(GraphContext_IsEvicted(gc)) return;
+	// the cache can't hold more entries than its capacity once reloaded
+	gc->hot_queries = Cache_HotKeys(gc->cache, Cache_GetStats(gc->cache).cap);
+}
+
+void GraphContext_ClearHotQueries(GraphContext *gc) {
+	ASSERT(gc != NULL);
+	if(gc->hot_queries == NULL) return;
+
+	uint count = array_len(gc->hot_queries);
+	for(uint i = 0; i < count; i++) rm_free(gc->hot_queries[i]);
+	array_free(gc->hot_queries);
+	gc->hot_queries = NULL;
+}
+
+//------------------------------------------------------------------------------
+// Eviction API
+//------------------------------------------------------------------------------
+
+// Writes 'len' bytes of 'data' to a new file, unlinked right away
+// returns the file's descriptor, -1 on failure
+static int _GraphContext_WriteEvictionFile(const char *data, size_t len) {
+	char path[] = EVICTION_FILE_TEMPLATE;
+	int fd = mkstemp(path);
+	if(fd == -1) return -1;
+
+	// the file is reachable only through its descriptor
+	unlink(path);
+
+	size_t written = 0;
+	while(written < len) {
+		ssize_t n = write(fd, data + written, len - written);
+		if(n == -1 && errno == EINTR) continue;
+		if(n <= 0) {
+			close(fd);
+			return -1;
+		}
+		written += n;
+	}
+
+	return fd;
+}
+
+bool GraphContext_IsEvicted(const GraphContext *gc) {
+	ASSERT(gc != NULL);
+	return gc->residency.fd != -1;
+}
+
+bool GraphContext_Evictable(const GraphContext *gc) {
+	ASSERT(gc != NULL);
+
+	if(GraphContext_IsEvicted(gc)) return false;
+	// queries, cursors, prepared statements and background work
+	// all retain the graph
+	if(__atomic_load_n(&gc->ref_count, __ATOMIC_RELAXED) != 0) return false;
+	// graph is being loaded
+	if(GraphDecodeContext_Decoding(gc->decoding_context)) return false;
+	// graph is being persisted across meta keys
+	if(GraphEncodeContext_GetKeyCount(gc->encoding_context) != 1) return false;
+	// projections and views aren't encoded
+	return array_len(gc->projections) == 0 && array_len(gc->views) == 0;
+}
+
+bool GraphContext_Evict(GraphContext *gc) {
+	ASSERT(gc != NULL);
+	if(!GraphContext_Evictable(gc)) return false;
+
+	// outside of persistence the graph is encoded as a single key
+	EncodeBuffer buf;
+	EncodeBuffer_Init(&buf);
+	SerializerIO io;
+	SerializerIO_FromBuffer(&io, &buf);
+	EncodeGraph(&io, gc);
+
+	// the encoding leads with the graph's name, which is omitted
+	// such that the graph is decoded under its name at the time
+	// see GraphContext_EvictedEncoding
+	EncodeBufferReader reader;
+	EncodeBufferReader_Init(&reader, buf.data, buf.len);
+	rm_free(EncodeBufferReader_LoadStringBuffer(&reader, NULL));
+	size_t len = reader.end - reader.p;
+
+	int fd = _GraphContext_WriteEvictionFile(reader.p, len);
+	EncodeBuffer_Free(&buf);
+	if(fd == -1) return false;
+
+	_GraphContext_FreeContent(gc);
+	gc->residency.fd = fd;
+	gc->residency.len = len;
+
+	return true;
+}
+
+bool GraphContext_EvictedEncoding(const GraphContext *gc, EncodeBuffer *buf) {
+	ASSERT(gc != NULL);
+	ASSERT(buf != NULL);
+	ASSERT(GraphContext_IsEvicted(gc));
+
+	SerializerIO io;
+	SerializerIO_FromBuffer(&io, buf);
+	SerializerIO_SaveStringBuffer(&io, gc->graph_name, strlen(gc->graph_name) + 1);
+
+	size_t len = gc->residency.len;
+	char *data = rm_malloc(len);
+	size_t offset = 0;
+	while(offset < len) {
+		// positional reads leave the descriptor's offset untouched,
+		// it is shared with forked children
+		ssize_t n = pread(gc->residency.fd, data + offset, len - offset, offset);
+		if(n == -1 && errno == EINTR) continue;
+		if(n <= 0) {
+			rm_free(data);
+			return false;
+		}
+		offset += n;
+	}
+
+	EncodeBuffer_SaveRecorded(buf, data, len);
+	rm_free(data);
+
+	return true;
+}
+
+bool GraphContext_Reload(GraphContext *gc) {
+	ASSERT(gc != NULL);
+	ASSERT(GraphContext_IsEvicted(gc));
+
+	EncodeBuffer buf;
+	EncodeBuffer_Init(&buf);
+	if(!GraphContext_EvictedEncoding(gc, &buf)) {
+		EncodeBuffer_Free(&buf);
+		return false;
+	}
+
+	close(gc->residency.fd);
+	gc->residency.fd = -1;
+	gc->residency.len = 0;
+
+	// schemas and attributes are reintroduced as they're decoded
+	// each updating the graph's version, which must remain as it was
+	XXH32_hash_t version = gc->version;
+
+	// the decoder locates the registered graph by its name, and loads into it
+	// the way it loads the first key of a graph, informing the module
+	// of the graph's decoding as it does for graphs loaded from an RDB
+	_GraphContext_InitContent(gc, GRAPH_DEFAULT_NODE_CAP, GRAPH_DEFAULT_EDGE_CAP);
+	Graph_SetMatrixPolicy(gc->g, RESIZE_TO_CAPACITY);
+	ModuleEventHandler_IncreaseDecodingGraphsCount();
+
+	SerializerIO io;
+	SerializerIO_FromData(&io, buf.data, buf.len);
+	GraphContext *decoded = DecodeGraph(&io);
+	UNUSED(decoded);
+	// the encoding is produced in-process, it always decodes
+	ASSERT(decoded == gc);
+	ASSERT(!SerializerIO_Failed(&io));
+
+	gc->version = version;
+	EncodeBuffer_Free(&buf);
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 // Free routine
 //------------------------------------------------------------------------------
 
-// Free all data associated with graph
-static void _GraphContext_Free(void *arg) {
+// the deletion steps are performed on the graph's writer lane
+static void _GraphContext_ScheduleFreeStep(void *arg) {
+	GraphContext *gc = (GraphContext *)arg;
+	if(ThreadPools_AddWorkWriter(_GraphContext_FreeStep, gc, gc->graph_name) ==
+	   THPOOL_QUEUE_FULL) {
+		Cron_AddTask(GRAPH_DELETE_STEP_INTERVAL, _GraphContext_ScheduleFreeStep, gc);
+	}
+}
+
+// Releases a bounded number of the graph's entity blocks, rescheduling itself
+// until none remain, at which point the rest of the graph is freed
+// spreading the deletion of a large graph such that it doesn't
+// monopolize a writer thread or the allocator
+static void _GraphContext_FreeStep(void *arg) {
 	GraphContext *gc = (GraphContext *)arg;
+	if(GraphContext_IsEvicted(gc) ||
+	   Graph_ReleaseEntityBlocks(gc->g, GRAPH_DELETE_STEP_BLOCKS)) {
+		_GraphContext_Free(gc);
+	} else {
+		Cron_AddTask(GRAPH_DELETE_STEP_INTERVAL, _GraphContext_ScheduleFreeStep, gc);
+	}
+}
+
+// Free the graph's content, see _GraphContext_InitContent
+static void _GraphContext_FreeContent(GraphContext *gc) {
 	uint len;
 
 	// Disable matrix synchronization for graph deletion.
 	Graph_SetMatrixPolicy(gc->g, DISABLED);
 	Graph_Free(gc->g);
+	gc->g = NULL;
+
+	// properties released their interned strings along with the graph
+	if(gc->string_pool) StringPool_Free(gc->string_pool);
+	gc->string_pool = NULL;
+	if(gc->value_log) ValueLog_Free(gc->value_log);
+	gc->value_log = NULL;
+	PackCache_Free(gc->node_packs);
+	PackCache_Free(gc->edge_packs);
+	gc->node_packs = NULL;
+	gc->edge_packs = NULL;
+
+	if(gc->projections) {
+		uint count = array_len(gc->projections);
+		for(uint i = 0; i < count; i++) Projection_Free(gc->projections[i]);
+		array_free(gc->projections);
+		gc->projections = NULL;
+	}
+
+	if(gc->views) {
+		uint count = array_len(gc->views);
+		for(uint i = 0; i < count; i++) MaterializedView_Free(gc->views[i]);
+		array_free(gc->views);
+		gc->views = NULL;
+	}
 
 	//--------------------------------------------------------------------------
 	// Free node schemas
@@ -512,6 +1016,7 @@ static void _GraphContext_Free(void *arg) {
 			Schema_Free(gc->node_schemas[i]);
 		}
 		array_free(gc->node_schemas);
+		gc->node_schemas = NULL;
 	}
 
 	//--------------------------------------------------------------------------
@@ -524,36 +1029,50 @@ static void _GraphContext_Free(void *arg) {
 			Schema_Free(gc->relation_schemas[i]);
 		}
 		array_free(gc->relation_schemas);
+		gc->relation_schemas = NULL;
 	}
 
 	//--------------------------------------------------------------------------
 	// Free attribute mappings
 	//--------------------------------------------------------------------------
 
-	if(gc->attributes) raxFree(gc->attributes);
-
-	if(gc->string_mapping) {
-		len = array_len(gc->string_mapping);
-		for(uint32_t i = 0; i < len; i ++) {
-			rm_free(gc->string_mapping[i]);
-		}
-		array_free(gc->string_mapping);
-	}
-
-	int res = pthread_rwlock_destroy(&gc->_attribute_rwlock);
-	ASSERT(res == 0);
-
-	if(gc->slowlog) SlowLog_Free(gc->slowlog);
+	if(gc->attributes) AttributeTable_Free(gc->attributes);
+	gc->attributes = NULL;
 
 	//--------------------------------------------------------------------------
 	// Clear cache
 	//--------------------------------------------------------------------------
 
 	if(gc->cache) Cache_Free(gc->cache);
+	gc->cache = NULL;
+	GraphContext_ClearHotQueries(gc);
+	ProductCache_Free(gc->product_cache);
+	gc->product_cache = NULL;
+	ResultCache_Free(gc->result_cache);
+	gc->result_cache = NULL;
+}
+
+// Free all data associated with graph
+static void _GraphContext_Free(void *arg) {
+	GraphContext *gc = (GraphContext *)arg;
+
+	// an evicted graph holds no content, only the file of its encoding
+	if(GraphContext_IsEvicted(gc)) close(gc->residency.fd);
+	else _GraphContext_FreeContent(gc);
+
+	// queued writers hold a reference to the graph, the queue must be empty
+	ASSERT(array_len(gc->write_group.queued) == 0);
+	array_free(gc->write_group.queued);
+	int res = pthread_mutex_destroy(&gc->write_group.lock);
+	ASSERT(res == 0);
+	QueryQuota_Destroy(&gc->quota);
+
+	if(gc->slowlog) SlowLog_Free(gc->slowlog);
+	if(gc->query_stats) QueryStats_Free(gc->query_stats);
+	if(gc->metrics) GraphMetrics_Free(gc->metrics);
 
 	GraphEncodeContext_Free(gc->encoding_context);
 	GraphDecodeContext_Free(gc->decoding_context);
 	rm_free(gc->graph_name);
 	rm_free(gc);
 }
-
@@ -11,10 +11,21 @@
 #include "../index/index.h"
 #include "../schema/schema.h"
 #include "../slow_log/slow_log.h"
+#include "../slow_log/query_stats.h"
+#include "../metrics/metrics.h"
 #include "graph.h"
+#include "projection.h"
+#include "attribute_table.h"
+#include "product_cache.h"
+#include "query_quota.h"
+#include "../resultset/result_cache.h"
 #include "../serializers/encode_context.h"
 #include "../serializers/decode_context.h"
+#include "../serializers/encoder/encode_buffer.h"
 #include "../util/cache/cache.h"
+#include "../util/string_pool/string_pool.h"
+#include "../util/value_log/value_log.h"
+#include "../serializers/pack_cache.h"
 
 /* GraphContext holds refrences to various elements of a graph object
  * It is the value sitting behind a Redis graph key
@@ -26,21 +37,55 @@
  * can use the graph version to understand if the schema was modified
  * and take action accordingly */
 
+/* Write queries queued against a graph, to be committed as a group
+ * by a single writer, entering the graph once */
+typedef struct {
+	void **queued;                          // Queued write queries.
+	bool scheduled;                         // A writer is scheduled to drain the queue.
+	pthread_mutex_t lock;                   // Protects queued and scheduled.
+	bool active;                            // Writers execute as the group's members.
+	bool modified;                          // A grouped writer modified the graph.
+} GraphWriteGroup;
+
+/* Residency of a graph's content
+ * a cold graph is evicted to disk, its content is encoded into a file
+ * and released, leaving the GraphContext as a stub until it is accessed again
+ * the file is unlinked as soon as it's created, it is reachable only through
+ * its descriptor, which forked children inherit */
+typedef struct {
+	int fd;                                 // File holding the graph's encoding, -1 if resident.
+	size_t len;                             // Encoding length, in bytes.
+	uint64_t last_access;                   // Access clock reading of the graph's last retrieval.
+} GraphResidency;
+
 typedef struct {
 	Graph *g;                               // Container for all matrices and entity properties
 	int ref_count;                          // Number of active references.
-	rax *attributes;                        // From strings to attribute IDs
-	pthread_rwlock_t _attribute_rwlock;     // Read-write lock to protect access to the attribute maps.
+	AttributeTable *attributes;             // Attribute names to IDs and back, lock-free lookups
 	char *graph_name;                       // String associated with graph
-	char **string_mapping;                  // From attribute IDs to strings
 	Schema **node_schemas;                  // Array of schemas for each node label
 	Schema **relation_schemas;              // Array of schemas for each relation type
 	unsigned short index_count;             // Number of indicies.
 	SlowLog *slowlog;                       // Slowlog associated with graph.
+	QueryStats *query_stats;                // Per fingerprint query statistics.
+	GraphMetrics *metrics;                  // Latency histograms and memory estimates.
 	GraphEncodeContext *encoding_context;   // Encode context of the graph.
 	GraphDecodeContext *decoding_context;   // Decode context of the graph.
 	Cache *cache;                           // Global cache of execution plans.
+	char **hot_queries;                     // Most hit cached queries, saved while persisting.
+	ProductCache *product_cache;            // Traversal products shared across queries.
+	ResultCache *result_cache;              // Replies of read-only queries shared across queries.
 	XXH32_hash_t version;                   // Graph version.
+	GraphWriteGroup write_group;            // Write queries pending group commit.
+	StringPool *string_pool;                // Interned string properties, NULL if disabled.
+	ValueLog *value_log;                    // Large string properties held out of the heap, NULL if disabled.
+	PackCache *node_packs;                  // Encoded node blocks reused by snapshots.
+	PackCache *edge_packs;                  // Encoded edge blocks reused by snapshots.
+	Projection **projections;               // Named projections consumed by algorithms.
+	struct MaterializedView **views;        // Incrementally maintained query results.
+	uint64_t maintained_epoch;              // Graph write epoch at its last maintenance.
+	GraphResidency residency;               // Whether the graph's content is in memory or on disk.
+	QueryQuota quota;                       // Concurrency and CPU time consumed by the graph's queries.
 } GraphContext;
 
 //------------------------------------------------------------------------------
@@ -55,6 +100,9 @@ GraphContext *GraphContext_Retrieve(RedisModuleCtx *ctx, RedisModuleString *grap
 									bool shouldCreate);
 // GraphContext_Retrieve counterpart, releases a retrieved GraphContext.
 void GraphContext_Release(GraphContext *gc);
+// Acquire an additional reference to an already retrieved GraphContext,
+// to be released by GraphContext_Release.
+void GraphContext_Retain(GraphContext *gc);
 // Mark graph key as "dirty" for Redis to pick up on.
 void GraphContext_MarkWriter(RedisModuleCtx *ctx, GraphContext *gc);
 
@@ -70,6 +118,32 @@ void GraphContext_Rename(GraphContext *gc, const char *name);
 // Get graph context version
 XXH32_hash_t GraphContext_GetVersion(const GraphContext *gc);
 
+//------------------------------------------------------------------------------
+// Eviction API
+//------------------------------------------------------------------------------
+
+// Returns true if the graph's content was evicted to disk.
+// Evicted graphs hold no graph, schemas or caches, only their name, statistics
+// and persistence state, GraphContext_Retrieve reloads them.
+bool GraphContext_IsEvicted(const GraphContext *gc);
+
+// Returns true if the graph is held by no one and can be evicted.
+// Expects the GIL to be held.
+bool GraphContext_Evictable(const GraphContext *gc);
+
+// Encode the graph's content to disk and release it, expects the GIL to be held.
+// Returns false if the graph isn't evictable or its encoding couldn't be written.
+bool GraphContext_Evict(GraphContext *gc);
+
+// Decode an evicted graph's content back into memory.
+// Returns false if the encoding couldn't be read, leaving the graph evicted.
+bool GraphContext_Reload(GraphContext *gc);
+
+// Append the encoding of an evicted graph to 'buf', a single graph key
+// encoded under the graph's current name, as EncodeGraph would produce.
+// Returns false if the encoding couldn't be read.
+bool GraphContext_EvictedEncoding(const GraphContext *gc, EncodeBuffer *buf);
+
 //------------------------------------------------------------------------------
 // Schema API
 //------------------------------------------------------------------------------
@@ -84,6 +158,48 @@ Schema *GraphContext_GetSchema(const GraphContext *gc, const char *label, Schema
 Schema *GraphContext_AddSchema(GraphContext *gc, const char *label, SchemaType t);
 // Retrieve the label string for a given Node object
 const char *GraphContext_GetNodeLabel(const GraphContext *gc, Node *n);
+// Drop the columnar attribute layout of every node schema
+// and the weight matrices of every relationship schema,
+// called by writers under the graph's write lock
+void GraphContext_DropColumns(GraphContext *gc);
+// Refresh the entity count of every schema,
+// called by writers under the graph's write lock
+void GraphContext_RefreshStatistics(GraphContext *gc);
+// Compact the graph's value log, relocating values out of segments
+// dominated by released values, returns the number of bytes unmapped
+// called by writers under the graph's write lock
+size_t GraphContext_CompactValueLog(GraphContext *gc);
+
+//------------------------------------------------------------------------------
+// Projection API
+//------------------------------------------------------------------------------
+
+// Retrieve projection by name, NULL if missing.
+Projection *GraphContext_GetProjection(const GraphContext *gc, const char *name);
+// Add projection, replacing any projection of the same name,
+// called under the graph's write lock
+void GraphContext_AddProjection(GraphContext *gc, Projection *p);
+// Remove and free projection, returns false if missing,
+// called under the graph's write lock
+bool GraphContext_RemoveProjection(GraphContext *gc, const char *name);
+
+//------------------------------------------------------------------------------
+// Materialized view API
+//------------------------------------------------------------------------------
+
+// Retrieve view by name, NULL if missing.
+struct MaterializedView *GraphContext_GetView(const GraphContext *gc, const char *name);
+// Add view, replacing any view of the same name,
+// called under the graph's read lock while holding the GIL
+void GraphContext_AddView(GraphContext *gc, struct MaterializedView *view);
+// Remove and free view, returns false if missing,
+// called under the graph's read lock while holding the GIL
+bool GraphContext_RemoveView(GraphContext *gc, const char *name);
+// Returns true if the graph maintains any view.
+bool GraphContext_HasViews(const GraphContext *gc);
+// Fold a commit's effects into every view, called under the graph's write lock.
+void GraphContext_UpdateViews(GraphContext *gc, const char *effects, size_t len);
+
 // Retrieve the relation type string for a given Edge object
 const char *GraphContext_GetEdgeRelationType(const GraphContext *gc, Edge *e);
 // Retrieve number of unique attribute keys
@@ -106,11 +222,27 @@ Index *GraphContext_GetIndex(const GraphContext *gc, const char *label, Attribut
 // Create an index for the given label and attribute
 int GraphContext_AddIndex(Index **idx, GraphContext *gc, const char *label, const char *field,
 						  IndexType type);
+// Create a composite index for the given label over 'fields', in order
+int GraphContext_AddCompositeIndex(Index **idx, GraphContext *gc, const char *label,
+								   const char **fields, uint count);
 // Remove and free an index
 int GraphContext_DeleteIndex(GraphContext *gc, const char *label, const char *field,
 							 IndexType type);
-// Remove a single node from all indices that refer to it
-void GraphContext_DeleteNodeFromIndices(GraphContext *gc, Node *n);
+// Create a uniqueness constraint on the given label and attribute
+int GraphContext_AddConstraint(UniqueConstraint **uc, GraphContext *gc, const char *label,
+							   const char *field);
+// Remove a uniqueness constraint
+int GraphContext_DeleteConstraint(GraphContext *gc, const char *label, const char *field);
+// Attempt to retrieve an index on the given relationship type and attribute
+Index *GraphContext_GetEdgeIndex(const GraphContext *gc, const char *relation,
+								 Attribute_ID *attribute_id);
+// Create an index for the given relationship type and attribute
+int GraphContext_AddEdgeIndex(Index **idx, GraphContext *gc, const char *relation,
+							  const char *field);
+// Remove an attribute from a relationship type index
+int GraphContext_DeleteEdgeIndex(GraphContext *gc, const char *relation, const char *field);
+// Remove a single edge from the index of its relationship type
+void GraphContext_DeleteEdgeFromIndices(GraphContext *gc, Edge *e);
 
 // Add GraphContext to global array
 void GraphContext_RegisterWithModule(GraphContext *gc);
@@ -127,8 +259,20 @@ void GraphContext_RemoveFromRegistry(GraphContext *gc);
 
 SlowLog *GraphContext_GetSlowLog(const GraphContext *gc);
 
+// Return query statistics registry associated with graph context.
+QueryStats *GraphContext_GetQueryStats(const GraphContext *gc);
+
+// Return metrics associated with graph context.
+GraphMetrics *GraphContext_GetMetrics(const GraphContext *gc);
+
 /* Cache API - Return cache associated with graph context and current thread id. */
 Cache *GraphContext_GetCache(const GraphContext *gc);
 
+// Snapshot the graph's most hit cached queries, to be saved along the graph.
+void GraphContext_SnapshotHotQueries(GraphContext *gc);
+
+// Free the snapshot taken by GraphContext_SnapshotHotQueries.
+void GraphContext_ClearHotQueries(GraphContext *gc);
+
 #endif
 
@@ -0,0 +1,644 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "materialized_view.h"
+#include "RG.h"
+#include "../ast/ast.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../effects/effects.h"
+#include "../resultset/reply_buffer.h"
+#include "../resultset/formatters/resultset_replyverbose.h"
+#include <string.h>
+#include <strings.h>
+
+// a group of nodes sharing their grouping key
+typedef struct {
+	SIValue *values;   // per column, the group's key or aggregated value
+	uint64_t members;  // number of nodes in the group
+	bool dirty;        // min or max must be recomputed over the group's members
+} ViewGroup;
+
+// a node's contribution to its group
+typedef struct {
+	char *key;         // encoded grouping key
+	size_t key_len;    // encoded grouping key length
+	ViewGroup *group;  // group the node is a member of
+	SIValue *values;   // per column, the node's attribute value
+} ViewMember;
+
+//------------------------------------------------------------------------------
+// Defining query
+//------------------------------------------------------------------------------
+
+// aggregate functions a view maintains
+static const struct {
+	const char *name;
+	ViewColumnType type;
+} _view_aggregates[] = {
+	{"count", VIEW_COLUMN_COUNT},
+	{"sum", VIEW_COLUMN_SUM},
+	{"min", VIEW_COLUMN_MIN},
+	{"max", VIEW_COLUMN_MAX},
+};
+
+// returns the attribute of 'exp' if it is of the form alias.attr, NULL otherwise
+static const char *_PropertyOf(const cypher_astnode_t *exp, const char *alias) {
+	if(cypher_astnode_type(exp) != CYPHER_AST_PROPERTY_OPERATOR) return NULL;
+	const cypher_astnode_t *entity = cypher_ast_property_operator_get_expression(exp);
+	if(cypher_astnode_type(entity) != CYPHER_AST_IDENTIFIER) return NULL;
+	if(strcmp(cypher_ast_identifier_get_name(entity), alias) != 0) return NULL;
+	const cypher_astnode_t *prop = cypher_ast_property_operator_get_prop_name(exp);
+	return cypher_ast_prop_name_get_value(prop);
+}
+
+// sets column out of a RETURN projection, returns false if unsupported
+static bool _ParseColumn(const cypher_astnode_t *exp, const char *alias,
+		ViewColumn *column) {
+	column->attr = NULL;
+
+	// grouping key, n.attr
+	const char *attr = _PropertyOf(exp, alias);
+	if(attr != NULL) {
+		column->type = VIEW_COLUMN_KEY;
+		column->attr = rm_strdup(attr);
+		return true;
+	}
+
+	// count(*)
+	if(cypher_astnode_type(exp) == CYPHER_AST_APPLY_ALL_OPERATOR) {
+		if(cypher_ast_apply_all_operator_get_distinct(exp)) return false;
+		const cypher_astnode_t *func = cypher_ast_apply_all_operator_get_func_name(exp);
+		column->type = VIEW_COLUMN_COUNT;
+		return strcasecmp(cypher_ast_function_name_get_value(func), "count") == 0;
+	}
+
+	if(cypher_astnode_type(exp) != CYPHER_AST_APPLY_OPERATOR) return false;
+	if(cypher_ast_apply_operator_get_distinct(exp)) return false;
+	if(cypher_ast_apply_operator_narguments(exp) != 1) return false;
+
+	const cypher_astnode_t *func = cypher_ast_apply_operator_get_func_name(exp);
+	const char *func_name = cypher_ast_function_name_get_value(func);
+	int aggregate = -1;
+	int aggregate_count = sizeof(_view_aggregates) / sizeof(_view_aggregates[0]);
+	for(int i = 0; i < aggregate_count; i++) {
+		if(strcasecmp(func_name, _view_aggregates[i].name) == 0) aggregate = i;
+	}
+	if(aggregate == -1) return false;
+	column->type = _view_aggregates[aggregate].type;
+
+	const cypher_astnode_t *arg = cypher_ast_apply_operator_get_argument(exp, 0);
+	attr = _PropertyOf(arg, alias);
+	if(attr != NULL) {
+		column->attr = rm_strdup(attr);
+		return true;
+	}
+
+	// count(n) counts every node
+	return (column->type == VIEW_COLUMN_COUNT &&
+			cypher_astnode_type(arg) == CYPHER_AST_IDENTIFIER &&
+			strcmp(cypher_ast_identifier_get_name(arg), alias) == 0);
+}
+
+// sets the view's label and columns out of its defining query
+// returns false and sets err if the query isn't supported
+static bool _ParseQuery(MaterializedView *view, const AST *ast, const char **err) {
+	*err = "Views support a single MATCH of a node pattern followed by RETURN";
+
+	const cypher_astnode_t *root = ast->root;
+	if(cypher_astnode_type(root) != CYPHER_AST_QUERY) return false;
+	if(cypher_ast_query_nclauses(root) != 2) return false;
+
+	// MATCH (n:Label)
+	const cypher_astnode_t *match = cypher_ast_query_get_clause(root, 0);
+	if(cypher_astnode_type(match) != CYPHER_AST_MATCH) return false;
+	if(cypher_ast_match_is_optional(match)) return false;
+	if(cypher_ast_match_get_predicate(match) != NULL) {
+		*err = "Views don't support filters";
+		return false;
+	}
+
+	const cypher_astnode_t *pattern = cypher_ast_match_get_pattern(match);
+	if(cypher_ast_pattern_npaths(pattern) != 1) return false;
+	const cypher_astnode_t *path = cypher_ast_pattern_get_path(pattern, 0);
+	if(cypher_astnode_type(path) != CYPHER_AST_PATTERN_PATH) return false;
+	if(cypher_ast_pattern_path_nelements(path) != 1) return false;
+
+	const cypher_astnode_t *node = cypher_ast_pattern_path_get_element(path, 0);
+	const cypher_astnode_t *identifier = cypher_ast_node_pattern_get_identifier(node);
+	if(identifier == NULL) return false;
+	if(cypher_ast_node_pattern_get_properties(node) != NULL) {
+		*err = "Views don't support filters";
+		return false;
+	}
+	uint label_count = cypher_ast_node_pattern_nlabels(node);
+	if(label_count > 1) return false;
+	if(label_count == 1) {
+		const cypher_astnode_t *label = cypher_ast_node_pattern_get_label(node, 0);
+		view->label = rm_strdup(cypher_ast_label_get_name(label));
+	}
+	const char *alias = cypher_ast_identifier_get_name(identifier);
+
+	// RETURN n.k, count(n), sum(n.v), min(n.v), max(n.v)
+	const cypher_astnode_t *ret = cypher_ast_query_get_clause(root, 1);
+	if(cypher_astnode_type(ret) != CYPHER_AST_RETURN) return false;
+	if(cypher_ast_return_is_distinct(ret) ||
+	   cypher_ast_return_has_include_existing(ret) ||
+	   cypher_ast_return_get_order_by(ret) != NULL ||
+	   cypher_ast_return_get_skip(ret) != NULL ||
+	   cypher_ast_return_get_limit(ret) != NULL) {
+		*err = "Views don't support DISTINCT, ORDER BY, SKIP or LIMIT";
+		return false;
+	}
+
+	const char **names = AST_BuildReturnColumnNames(ret);
+	uint column_count = cypher_ast_return_nprojections(ret);
+	for(uint i = 0; i < column_count; i++) {
+		const cypher_astnode_t *projection = cypher_ast_return_get_projection(ret, i);
+		const cypher_astnode_t *exp = cypher_ast_projection_get_expression(projection);
+
+		ViewColumn column;
+		if(!_ParseColumn(exp, alias, &column)) {
+			*err = "Views support projections of node attributes and of count, sum, min and max";
+			array_free(names);
+			return false;
+		}
+		column.name = rm_strdup(names[i]);
+		array_append(view->columns, column);
+	}
+	array_free(names);
+
+	*err = NULL;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Groups
+//------------------------------------------------------------------------------
+
+// encodes the grouping key out of the key column values
+// values are tagged by their type, as 1 and '1' are distinct keys
+static char *_EncodeKey(const MaterializedView *view, const SIValue *values,
+		size_t *len) {
+	size_t cap = 32;
+	size_t n = 0;
+	char *key = rm_malloc(cap);
+
+	char *str = rm_malloc(64);
+	size_t str_cap = 64;
+
+	uint column_count = array_len(view->columns);
+	for(uint i = 0; i < column_count; i++) {
+		if(view->columns[i].type != VIEW_COLUMN_KEY) continue;
+
+		size_t written = 0;
+		SIValue_ToString(values[i], &str, &str_cap, &written);
+
+		// type tag, string representation and its terminator
+		size_t required = n + sizeof(SIType) + written + 1;
+		if(required > cap) {
+			cap = MAX(cap * 2, required);
+			key = rm_realloc(key, cap);
+		}
+		SIType t = SI_TYPE(values[i]);
+		memcpy(key + n, &t, sizeof(SIType));
+		n += sizeof(SIType);
+		memcpy(key + n, str, written);
+		n += written;
+		key[n++] = '\0';
+	}
+
+	rm_free(str);
+	*len = n;
+	return key;
+}
+
+static ViewGroup *_GroupNew(const MaterializedView *view, const SIValue *values) {
+	uint column_count = array_len(view->columns);
+	ViewGroup *group = rm_malloc(sizeof(ViewGroup));
+	group->values = rm_malloc(sizeof(SIValue) * column_count);
+	group->members = 0;
+	group->dirty = false;
+
+	for(uint i = 0; i < column_count; i++) {
+		switch(view->columns[i].type) {
+			case VIEW_COLUMN_KEY:
+				group->values[i] = SI_CloneValue(values[i]);
+				break;
+			case VIEW_COLUMN_COUNT:
+				group->values[i] = SI_LongVal(0);
+				break;
+			case VIEW_COLUMN_SUM:
+				// sums are reported as doubles, as by the sum aggregate function
+				group->values[i] = SI_DoubleVal(0);
+				break;
+			default:
+				group->values[i] = SI_NullVal();
+				break;
+		}
+	}
+	return group;
+}
+
+static void _GroupFree(const MaterializedView *view, ViewGroup *group) {
+	uint column_count = array_len(view->columns);
+	for(uint i = 0; i < column_count; i++) SIValue_Free(group->values[i]);
+	rm_free(group->values);
+	rm_free(group);
+}
+
+// folds a min or max candidate into the group's extremum
+static void _FoldExtremum(ViewGroup *group, uint i, ViewColumnType t, SIValue v) {
+	if(SIValue_IsNull(v)) return;
+
+	SIValue *current = group->values + i;
+	if(!SIValue_IsNull(*current)) {
+		int disjoint;
+		int cmp = SIValue_Compare(v, *current, &disjoint);
+		if(disjoint == COMPARED_NULL || disjoint == DISJOINT) return;
+		if(t == VIEW_COLUMN_MIN && cmp >= 0) return;
+		if(t == VIEW_COLUMN_MAX && cmp <= 0) return;
+	}
+
+	SIValue_Free(*current);
+	*current = SI_CloneValue(v);
+}
+
+// adds the member's values to its group
+static void _GroupAdd(const MaterializedView *view, ViewGroup *group,
+		const SIValue *values) {
+	group->members++;
+
+	uint column_count = array_len(view->columns);
+	for(uint i = 0; i < column_count; i++) {
+		const ViewColumn *column = view->columns + i;
+		SIValue v = values[i];
+		SIValue *agg = group->values + i;
+
+		switch(column->type) {
+			case VIEW_COLUMN_COUNT:
+				if(column->attr == NULL || !SIValue_IsNull(v)) agg->longval++;
+				break;
+			case VIEW_COLUMN_SUM:
+				if(SI_TYPE(v) & SI_NUMERIC) agg->doubleval += SI_GET_NUMERIC(v);
+				break;
+			case VIEW_COLUMN_MIN:
+			case VIEW_COLUMN_MAX:
+				// a dirty extremum is recomputed over every member
+				if(!group->dirty) _FoldExtremum(group, i, column->type, v);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+// retracts the member's values from its group
+static void _GroupRemove(const MaterializedView *view, ViewGroup *group,
+		const SIValue *values) {
+	ASSERT(group->members > 0);
+	group->members--;
+
+	uint column_count = array_len(view->columns);
+	for(uint i = 0; i < column_count; i++) {
+		const ViewColumn *column = view->columns + i;
+		SIValue v = values[i];
+		SIValue *agg = group->values + i;
+
+		switch(column->type) {
+			case VIEW_COLUMN_COUNT:
+				if(column->attr == NULL || !SIValue_IsNull(v)) agg->longval--;
+				break;
+			case VIEW_COLUMN_SUM:
+				if(SI_TYPE(v) & SI_NUMERIC) agg->doubleval -= SI_GET_NUMERIC(v);
+				break;
+			case VIEW_COLUMN_MIN:
+			case VIEW_COLUMN_MAX: {
+				if(SIValue_IsNull(v) || SIValue_IsNull(*agg)) break;
+				int disjoint;
+				if(SIValue_Compare(v, *agg, &disjoint) == 0) group->dirty = true;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Members
+//------------------------------------------------------------------------------
+
+static void _MemberFree(const MaterializedView *view, ViewMember *member) {
+	uint column_count = array_len(view->columns);
+	for(uint i = 0; i < column_count; i++) SIValue_Free(member->values[i]);
+	rm_free(member->values);
+	rm_free(member->key);
+	rm_free(member);
+}
+
+// returns true if node n is matched by the view's pattern
+static bool _Matches(const MaterializedView *view, GraphContext *gc, NodeID id) {
+	if(view->label == NULL) return true;
+
+	Schema *s = GraphContext_GetSchema(gc, view->label, SCHEMA_NODE);
+	if(s == NULL) return false;
+
+	bool x = false;
+	GrB_Matrix L = Graph_GetLabelMatrix(gc->g, s->id);
+	return (GrB_Matrix_extractElement_BOOL(&x, L, id, id) == GrB_SUCCESS && x);
+}
+
+// folds node n into the view
+static void _AddNode(MaterializedView *view, GraphContext *gc, const Node *n) {
+	uint column_count = array_len(view->columns);
+	ViewMember *member = rm_malloc(sizeof(ViewMember));
+	member->values = rm_malloc(sizeof(SIValue) * column_count);
+
+	for(uint i = 0; i < column_count; i++) {
+		const char *attr = view->columns[i].attr;
+		SIValue v = SI_NullVal();
+		if(attr != NULL) {
+			Attribute_ID attr_id = GraphContext_GetAttributeID(gc, attr);
+			v = GraphEntity_GetProperty((const GraphEntity *)n, attr_id);
+			// missing attributes are null
+			v = (v.type == T_NULL) ? SI_NullVal() : SI_CloneValue(v);
+		}
+		member->values[i] = v;
+	}
+
+	member->key = _EncodeKey(view, member->values, &member->key_len);
+	ViewGroup *group = raxFind(view->groups, (unsigned char *)member->key,
+			member->key_len);
+	if(group == raxNotFound) {
+		group = _GroupNew(view, member->values);
+		raxInsert(view->groups, (unsigned char *)member->key, member->key_len,
+				group, NULL);
+	}
+	member->group = group;
+	_GroupAdd(view, group, member->values);
+
+	NodeID id = ENTITY_GET_ID(n);
+	raxInsert(view->members, (unsigned char *)&id, sizeof(id), member, NULL);
+}
+
+// retracts node id's contribution, if it is a member of the view
+static void _RemoveNode(MaterializedView *view, NodeID id) {
+	ViewMember *member = NULL;
+	if(!raxRemove(view->members, (unsigned char *)&id, sizeof(id),
+				(void **)&member)) {
+		return;
+	}
+
+	ViewGroup *group = member->group;
+	_GroupRemove(view, group, member->values);
+
+	// empty groups are dropped, unless the view has no grouping key
+	// in which case its single row is reported even if no node matches
+	if(group->members == 0 && member->key_len > 0) {
+		raxRemove(view->groups, (unsigned char *)member->key, member->key_len, NULL);
+		_GroupFree(view, group);
+	}
+
+	_MemberFree(view, member);
+}
+
+typedef struct {
+	MaterializedView *view;
+	GraphContext *gc;
+	uint64_t node_slots;
+} _RefreshCtx;
+
+// replaces node id's contribution by its current state
+static void _RefreshNode(NodeID id, void *pdata) {
+	_RefreshCtx *ctx = pdata;
+	_RemoveNode(ctx->view, id);
+
+	Node n = GE_NEW_NODE();
+	if(id >= ctx->node_slots || !Graph_GetNode(ctx->gc->g, id, &n)) return;
+	if(_Matches(ctx->view, ctx->gc, id)) _AddNode(ctx->view, ctx->gc, &n);
+}
+
+// recomputes the min and max of groups whose extremum was retracted
+static void _RecomputeDirty(MaterializedView *view) {
+	uint column_count = array_len(view->columns);
+	bool dirty = false;
+
+	raxIterator it;
+	raxStart(&it, view->groups);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) {
+		ViewGroup *group = it.data;
+		if(!group->dirty) continue;
+		dirty = true;
+		for(uint i = 0; i < column_count; i++) {
+			ViewColumnType t = view->columns[i].type;
+			if(t != VIEW_COLUMN_MIN && t != VIEW_COLUMN_MAX) continue;
+			SIValue_Free(group->values[i]);
+			group->values[i] = SI_NullVal();
+		}
+	}
+	raxStop(&it);
+	if(!dirty) return;
+
+	raxStart(&it, view->members);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) {
+		ViewMember *member = it.data;
+		ViewGroup *group = member->group;
+		if(!group->dirty) continue;
+		for(uint i = 0; i < column_count; i++) {
+			ViewColumnType t = view->columns[i].type;
+			if(t != VIEW_COLUMN_MIN && t != VIEW_COLUMN_MAX) continue;
+			_FoldExtremum(group, i, t, member->values[i]);
+		}
+	}
+	raxStop(&it);
+
+	raxStart(&it, view->groups);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) ((ViewGroup *)it.data)->dirty = false;
+	raxStop(&it);
+}
+
+// discards the view's content
+static void _Clear(MaterializedView *view) {
+	raxIterator it;
+	raxStart(&it, view->members);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) _MemberFree(view, it.data);
+	raxStop(&it);
+
+	raxStart(&it, view->groups);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) _GroupFree(view, it.data);
+	raxStop(&it);
+
+	raxFree(view->members);
+	raxFree(view->groups);
+	view->members = raxNew();
+	view->groups = raxNew();
+}
+
+// populates the view by scanning the nodes matched by its pattern
+static void _Populate(MaterializedView *view, GraphContext *gc) {
+	Graph *g = gc->g;
+	_Clear(view);
+
+	// a view without grouping keys reports a single row
+	uint column_count = array_len(view->columns);
+	SIValue none[column_count];
+	for(uint i = 0; i < column_count; i++) none[i] = SI_NullVal();
+	size_t key_len;
+	char *key = _EncodeKey(view, none, &key_len);
+	if(key_len == 0) {
+		raxInsert(view->groups, (unsigned char *)key, 0, _GroupNew(view, none), NULL);
+	}
+	rm_free(key);
+
+	Node n = GE_NEW_NODE();
+	if(view->label != NULL) {
+		Schema *s = GraphContext_GetSchema(gc, view->label, SCHEMA_NODE);
+		if(s != NULL) {
+			bool depleted = false;
+			GxB_MatrixTupleIter *iter;
+			GxB_MatrixTupleIter_new(&iter, Graph_GetLabelMatrix(g, s->id));
+			while(true) {
+				NodeID id;
+				GxB_MatrixTupleIter_next(iter, NULL, &id, &depleted);
+				if(depleted) break;
+				if(Graph_GetNode(g, id, &n)) _AddNode(view, gc, &n);
+			}
+			GxB_MatrixTupleIter_free(iter);
+		}
+	} else {
+		DataBlockIterator *iter = Graph_ScanNodes(g);
+		while((n.entity = DataBlockIterator_Next(iter, &n.id)) != NULL) {
+			_AddNode(view, gc, &n);
+		}
+		DataBlockIterator_Free(iter);
+	}
+
+	view->epoch = Graph_WriteEpoch(g);
+}
+
+//------------------------------------------------------------------------------
+// MaterializedView API
+//------------------------------------------------------------------------------
+
+MaterializedView *MaterializedView_New(GraphContext *gc, const char *name,
+		const char *query, const char **err) {
+	ASSERT(gc != NULL && name != NULL && query != NULL && err != NULL);
+
+	cypher_parse_result_t *parse_result = parse_query(query);
+	if(parse_result == NULL) {
+		*err = "Failed to parse view query";
+		return NULL;
+	}
+	AST *ast = AST_Build(parse_result);
+
+	MaterializedView *view = rm_malloc(sizeof(MaterializedView));
+	view->name = rm_strdup(name);
+	view->query = rm_strdup(query);
+	view->label = NULL;
+	view->columns = array_new(ViewColumn, 1);
+	view->groups = raxNew();
+	view->members = raxNew();
+	view->epoch = 0;
+
+	bool supported = _ParseQuery(view, ast, err);
+	AST_Free(ast);
+	if(!supported) {
+		MaterializedView_Free(view);
+		return NULL;
+	}
+
+	_Populate(view, gc);
+	return view;
+}
+
+void MaterializedView_Update(MaterializedView *view, GraphContext *gc,
+		const char *effects, size_t len) {
+	ASSERT(view != NULL && gc != NULL);
+
+	// the view folds in the changes of consecutive write lock acquisitions
+	// and of queries committing as a group under the same acquisition,
+	// once it missed an acquisition it is rebuilt on its next read
+	uint64_t epoch = Graph_WriteEpoch(gc->g);
+	if(view->epoch != epoch && view->epoch + 1 != epoch) return;
+
+	if(effects != NULL && len > 0) {
+		_RefreshCtx ctx = {
+			.view = view,
+			.gc = gc,
+			.node_slots = Graph_NodeCount(gc->g) + Graph_DeletedNodeCount(gc->g)
+		};
+		// malformed effects leave the view stale
+		if(!Effects_VisitNodes(effects, len, _RefreshNode, &ctx)) return;
+		_RecomputeDirty(view);
+	}
+
+	view->epoch = epoch;
+}
+
+void MaterializedView_Reply(MaterializedView *view, GraphContext *gc,
+		RedisModuleCtx *ctx) {
+	ASSERT(view != NULL && gc != NULL && ctx != NULL);
+
+	// rebuild a view which missed changes, e.g. made by bulk insertion
+	if(view->epoch != Graph_WriteEpoch(gc->g)) _Populate(view, gc);
+
+	uint column_count = array_len(view->columns);
+	const char **columns = array_new(const char *, column_count);
+	for(uint i = 0; i < column_count; i++) {
+		array_append(columns, view->columns[i].name);
+	}
+
+	ReplyBuffer reply;
+	ReplyBuffer_Init(&reply);
+	ReplyBuffer_ReplyWithArray(&reply, 3);
+	ResultSet_ReplyWithVerboseHeader(&reply, columns, NULL);
+
+	ReplyBuffer_ReplyWithArray(&reply, raxSize(view->groups));
+	SIValue *row[column_count];
+	raxIterator it;
+	raxStart(&it, view->groups);
+	raxSeek(&it, "^", NULL, 0);
+	while(raxNext(&it)) {
+		ViewGroup *group = it.data;
+		for(uint i = 0; i < column_count; i++) row[i] = group->values + i;
+		ResultSet_EmitVerboseRow(&reply, gc, row, column_count);
+	}
+	raxStop(&it);
+
+	// statistics, reading a view doesn't execute its query
+	ReplyBuffer_ReplyWithArray(&reply, 1);
+	ReplyBuffer_ReplyWithCString(&reply, "Cached execution: 1");
+
+	ReplyBuffer_Flush(&reply, ctx);
+	ReplyBuffer_Free(&reply);
+	array_free(columns);
+}
+
+void MaterializedView_Free(MaterializedView *view) {
+	if(view == NULL) return;
+
+	_Clear(view);
+	raxFree(view->members);
+	raxFree(view->groups);
+
+	uint column_count = array_len(view->columns);
+	for(uint i = 0; i < column_count; i++) {
+		rm_free(view->columns[i].name);
+		if(view->columns[i].attr) rm_free(view->columns[i].attr);
+	}
+	array_free(view->columns);
+
+	if(view->label) rm_free(view->label);
+	rm_free(view->query);
+	rm_free(view->name);
+	rm_free(view);
+}
@@ -0,0 +1,84 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "rax.h"
+#include "graphcontext.h"
+#include "../redismodule.h"
+
+// a named query result maintained incrementally by write commits
+// a view is defined by a restricted class of queries, aggregating the nodes
+// of a single node pattern, grouped by their attributes:
+//
+// MATCH (n:Label) RETURN n.k AS k, count(n), sum(n.v), min(n.v), max(n.v)
+//
+// each node's contribution to its group is kept, as a commit modifies nodes
+// their previous contribution is retracted and their current one folded in,
+// such that reading a view costs O(result) rather than a scan of the label
+//
+// min and max of a group are recomputed over its members once their
+// extremum is retracted, changes which aren't recorded as effects,
+// e.g. by bulk insertion, rebuild the view on its next read
+typedef enum {
+	VIEW_COLUMN_KEY,    // n.attr, grouping key
+	VIEW_COLUMN_COUNT,  // count(n), count(*) or count(n.attr)
+	VIEW_COLUMN_SUM,    // sum(n.attr)
+	VIEW_COLUMN_MIN,    // min(n.attr)
+	VIEW_COLUMN_MAX,    // max(n.attr)
+} ViewColumnType;
+
+typedef struct {
+	ViewColumnType type;  // column type
+	char *name;           // column name, as reported by the view's header
+	char *attr;           // aggregated or grouping attribute, NULL for count(n)
+} ViewColumn;
+
+typedef struct MaterializedView {
+	char *name;            // view name
+	char *query;           // defining query
+	char *label;           // node label, NULL for every node
+	ViewColumn *columns;   // projected columns
+	rax *groups;           // encoded grouping keys to groups
+	rax *members;          // node IDs to their contribution
+	uint64_t epoch;        // graph write epoch the view is up to date with
+} MaterializedView;
+
+// create a view out of its defining query, populated by scanning the graph
+// returns NULL and sets 'err' if the query isn't supported
+// caller holds the GIL and the graph's read lock
+MaterializedView *MaterializedView_New
+(
+	GraphContext *gc,    // graph the view aggregates
+	const char *name,    // view name
+	const char *query,   // defining query
+	const char **err     // [output] reason the query isn't supported
+);
+
+// fold in the nodes modified by a commit, as recorded by its effects
+// caller holds the graph's write lock
+void MaterializedView_Update
+(
+	MaterializedView *view,  // view
+	GraphContext *gc,        // graph the view aggregates
+	const char *effects,     // encoded effects, NULL if none were recorded
+	size_t len               // number of bytes
+);
+
+// reply with the view's rows, shaped as a verbose result-set
+// caller holds the graph's read lock
+void MaterializedView_Reply
+(
+	MaterializedView *view,  // view
+	GraphContext *gc,        // graph the view aggregates
+	RedisModuleCtx *ctx      // context to reply to
+);
+
+// free view
+void MaterializedView_Free
+(
+	MaterializedView *view  // view to free
+);
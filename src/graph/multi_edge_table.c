@@ -0,0 +1,182 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "multi_edge_table.h"
+#include "RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include <string.h>
+
+// Minimum number of slots reserved for a run.
+#define RUN_MIN_CAP 4
+
+// Moves every run to the start of the buffer, dropping garbage slots.
+static void _MultiEdgeTable_Compact(MultiEdgeTable *t) {
+	EdgeID *ids = rm_malloc(sizeof(EdgeID) * t->ids_cap);
+	uint64_t len = 0;
+
+	uint run_count = array_len(t->runs);
+	for(uint i = 0; i < run_count; i++) {
+		EdgeRun *r = t->runs + i;
+		if(r->cap == 0) continue;
+		memcpy(ids + len, t->ids + r->offset, sizeof(EdgeID) * r->len);
+		r->offset = len;
+		len += r->cap;
+	}
+
+	rm_free(t->ids);
+	t->ids = ids;
+	t->ids_len = len;
+	t->garbage = 0;
+}
+
+// Makes room for n additional slots at the buffer's tail.
+static void _MultiEdgeTable_Reserve(MultiEdgeTable *t, uint64_t n) {
+	if(t->ids_len + n <= t->ids_cap) return;
+
+	// reclaim garbage before growing the buffer
+	if(t->garbage > t->ids_len / 2) {
+		_MultiEdgeTable_Compact(t);
+		if(t->ids_len + n <= t->ids_cap) return;
+	}
+
+	t->ids_cap = MAX(t->ids_cap * 2, t->ids_len + n);
+	t->ids = rm_realloc(t->ids, sizeof(EdgeID) * t->ids_cap);
+}
+
+MultiEdgeTable *MultiEdgeTable_New(void) {
+	MultiEdgeTable *t = rm_malloc(sizeof(MultiEdgeTable));
+	t->ids_len = 0;
+	t->ids_cap = RUN_MIN_CAP * 16;
+	t->ids = rm_malloc(sizeof(EdgeID) * t->ids_cap);
+	t->garbage = 0;
+	t->runs = array_new(EdgeRun, 16);
+	t->free_runs = array_new(uint64_t, 0);
+	t->edge_count = 0;
+	return t;
+}
+
+uint64_t MultiEdgeTable_NewRun(MultiEdgeTable *t, const EdgeID *ids, uint32_t count) {
+	ASSERT(t != NULL && ids != NULL && count > 1);
+
+	uint32_t cap = MAX(count, RUN_MIN_CAP);
+	_MultiEdgeTable_Reserve(t, cap);
+
+	uint64_t run;
+	if(array_len(t->free_runs) > 0) {
+		run = array_pop(t->free_runs);
+	} else {
+		run = array_len(t->runs);
+		EdgeRun r = {0};
+		t->runs = array_append(t->runs, r);
+	}
+
+	EdgeRun *r = t->runs + run;
+	r->offset = t->ids_len;
+	r->len = count;
+	r->cap = cap;
+	memcpy(t->ids + r->offset, ids, sizeof(EdgeID) * count);
+
+	t->ids_len += cap;
+	t->edge_count += count;
+	return run;
+}
+
+void MultiEdgeTable_Append(MultiEdgeTable *t, uint64_t run, EdgeID id) {
+	ASSERT(t != NULL && run < array_len(t->runs));
+
+	EdgeRun *r = t->runs + run;
+	ASSERT(r->cap > 0);
+
+	if(r->len == r->cap) {
+		uint32_t cap = r->cap * 2;
+		// reserving may compact the buffer, relocating the run
+		_MultiEdgeTable_Reserve(t, cap);
+
+		if(r->offset + r->cap == t->ids_len) {
+			// run is at the buffer's tail, extend it in place
+			t->ids_len += cap - r->cap;
+		} else {
+			// move run to the buffer's tail
+			memcpy(t->ids + t->ids_len, t->ids + r->offset, sizeof(EdgeID) * r->len);
+			t->garbage += r->cap;
+			r->offset = t->ids_len;
+			t->ids_len += cap;
+		}
+		r->cap = cap;
+	}
+
+	t->ids[r->offset + r->len] = id;
+	r->len++;
+	t->edge_count++;
+}
+
+uint32_t MultiEdgeTable_Remove(MultiEdgeTable *t, uint64_t run, EdgeID id) {
+	ASSERT(t != NULL && run < array_len(t->runs));
+
+	EdgeRun *r = t->runs + run;
+	EdgeID *ids = t->ids + r->offset;
+
+	uint32_t i = 0;
+	for(; i < r->len; i++) if(ids[i] == id) break;
+	ASSERT(i < r->len);
+
+	// migrate last edge ID into the vacated slot
+	ids[i] = ids[r->len - 1];
+	r->len--;
+	t->edge_count--;
+	return r->len;
+}
+
+void MultiEdgeTable_ReleaseRun(MultiEdgeTable *t, uint64_t run) {
+	ASSERT(t != NULL && run < array_len(t->runs));
+
+	EdgeRun *r = t->runs + run;
+	ASSERT(r->cap > 0);
+
+	if(r->offset + r->cap == t->ids_len) {
+		// run is at the buffer's tail, trim it
+		t->ids_len -= r->cap;
+	} else {
+		t->garbage += r->cap;
+	}
+
+	t->edge_count -= r->len;
+	r->len = 0;
+	r->cap = 0;
+	t->free_runs = array_append(t->free_runs, run);
+}
+
+uint64_t MultiEdgeTable_RunCount(const MultiEdgeTable *t) {
+	ASSERT(t != NULL);
+	return array_len(t->runs) - array_len(t->free_runs);
+}
+
+void MultiEdgeTable_Clear(MultiEdgeTable *t) {
+	ASSERT(t != NULL);
+	t->ids_len = 0;
+	t->garbage = 0;
+	t->edge_count = 0;
+	array_clear(t->runs);
+	array_clear(t->free_runs);
+}
+
+size_t MultiEdgeTable_MemoryUsage(const MultiEdgeTable *t) {
+	ASSERT(t != NULL);
+	return sizeof(MultiEdgeTable) +
+		   sizeof(EdgeID) * t->ids_cap +
+		   sizeof(EdgeRun) * array_len(t->runs) +
+		   sizeof(uint64_t) * array_len(t->free_runs);
+}
+
+void MultiEdgeTable_Free(MultiEdgeTable *t) {
+	ASSERT(t != NULL);
+	rm_free(t->ids);
+	array_free(t->runs);
+	array_free(t->free_runs);
+	rm_free(t);
+}
+
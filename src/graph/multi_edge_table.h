@@ -0,0 +1,71 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "entities/graph_entity.h"
+
+/* MultiEdgeTable holds the edge IDs of every relation matrix entry
+ * connecting its source to its destination with more than one edge.
+ * Such an entry stores a run ID (MSB off) in place of an edge ID (MSB on),
+ * the run's edge IDs are kept contiguously in a single buffer shared by
+ * all runs of the relation, such that no allocation is made per entry.
+ * Runs are addressed by ID, as a run may relocate within the buffer when
+ * it outgrows its capacity or when the buffer is compacted. */
+
+typedef struct {
+	uint64_t offset;  // Position of the run's first edge ID within ids.
+	uint32_t len;     // Number of edge IDs in the run.
+	uint32_t cap;     // Number of slots reserved for the run, 0 if released.
+} EdgeRun;
+
+typedef struct MultiEdgeTable {
+	EdgeID *ids;          // Edge IDs of every run.
+	uint64_t ids_len;     // Number of slots in use within ids, garbage included.
+	uint64_t ids_cap;     // Number of slots allocated for ids.
+	uint64_t garbage;     // Number of slots held by no run.
+	EdgeRun *runs;        // Runs, indexed by run ID.
+	uint64_t *free_runs;  // IDs of released runs, available for reuse.
+	uint64_t edge_count;  // Number of edge IDs held by all runs.
+} MultiEdgeTable;
+
+// Create a new, empty table.
+MultiEdgeTable *MultiEdgeTable_New(void);
+
+// Creates a run holding 'count' edge IDs, returns its ID.
+uint64_t MultiEdgeTable_NewRun(MultiEdgeTable *t, const EdgeID *ids, uint32_t count);
+
+// Adds edge 'id' to run.
+void MultiEdgeTable_Append(MultiEdgeTable *t, uint64_t run, EdgeID id);
+
+// Removes edge 'id' from run, returns the number of edge IDs left in run.
+uint32_t MultiEdgeTable_Remove(MultiEdgeTable *t, uint64_t run, EdgeID id);
+
+// Releases run, its ID may be reused by a later run.
+void MultiEdgeTable_ReleaseRun(MultiEdgeTable *t, uint64_t run);
+
+// Returns run's edge IDs, valid until the table is next modified.
+static inline const EdgeID *MultiEdgeTable_Run(const MultiEdgeTable *t, uint64_t run,
+		uint32_t *count) {
+	const EdgeRun *r = t->runs + run;
+	*count = r->len;
+	return t->ids + r->offset;
+}
+
+// Returns the number of live runs.
+uint64_t MultiEdgeTable_RunCount(const MultiEdgeTable *t);
+
+// Releases every run.
+void MultiEdgeTable_Clear(MultiEdgeTable *t);
+
+// Returns the number of bytes held by t.
+size_t MultiEdgeTable_MemoryUsage(const MultiEdgeTable *t);
+
+// Free table.
+void MultiEdgeTable_Free(MultiEdgeTable *t);
+
@@ -0,0 +1,179 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "product_cache.h"
+#include "RG.h"
+#include "../config.h"
+#include "../util/rmalloc.h"
+#include <string.h>
+
+struct ProductCacheEntry {
+	char *key;          // Expression canonical string.
+	uint64_t version;   // Graph version the product was computed against.
+	GrB_Matrix m;       // Product.
+	size_t size;        // Estimated memory held by m, in bytes.
+	uint64_t last_use;  // Logical time of the most recent lookup.
+	uint refcount;      // Number of holders, the cache holds a reference while cached.
+};
+
+// estimates a product's memory, a sparse layout:
+// row pointers, column indices and values
+static size_t _ProductSize(GrB_Matrix m) {
+	GrB_Index nrows;
+	GrB_Index nvals;
+	GrB_Matrix_nrows(&nrows, m);
+	GrB_Matrix_nvals(&nvals, m);
+	return sizeof(int64_t) * (nrows + 1) + (sizeof(int64_t) + sizeof(bool)) * nvals;
+}
+
+static void _EntryFree(ProductCacheEntry *entry) {
+	GrB_Matrix_free(&entry->m);
+	rm_free(entry->key);
+	rm_free(entry);
+}
+
+static void _EntryDecRef(ProductCacheEntry *entry) {
+	ASSERT(entry->refcount > 0);
+	entry->refcount--;
+	if(entry->refcount == 0) _EntryFree(entry);
+}
+
+// removes entry from the cache, the entry is freed once released by its holders
+static void _Evict(ProductCache *cache, ProductCacheEntry *entry) {
+	raxRemove(cache->lookup, (unsigned char *)entry->key, strlen(entry->key), NULL);
+	cache->usage -= entry->size;
+	_EntryDecRef(entry);
+}
+
+// evicts least recently used entries until the cache fits within capacity
+static void _EvictToCapacity(ProductCache *cache, size_t capacity) {
+	while(cache->usage > capacity) {
+		ProductCacheEntry *lru = NULL;
+		raxIterator it;
+		raxStart(&it, cache->lookup);
+		raxSeek(&it, "^", NULL, 0);
+		while(raxNext(&it)) {
+			ProductCacheEntry *entry = it.data;
+			if(lru == NULL || entry->last_use < lru->last_use) lru = entry;
+		}
+		raxStop(&it);
+
+		if(lru == NULL) break;
+		_Evict(cache, lru);
+	}
+}
+
+ProductCache *ProductCache_New(void) {
+	ProductCache *cache = rm_malloc(sizeof(ProductCache));
+	cache->lookup = raxNew();
+	cache->usage = 0;
+	cache->clock = 0;
+	int res = pthread_mutex_init(&cache->mutex, NULL);
+	UNUSED(res);
+	ASSERT(res == 0);
+	return cache;
+}
+
+bool ProductCache_Enabled(void) {
+	uint64_t capacity;
+	Config_Option_get(Config_PRODUCT_CACHE_CAPACITY, &capacity);
+	return capacity > 0;
+}
+
+ProductCacheEntry *ProductCache_Acquire(ProductCache *cache, const char *key,
+		uint64_t version) {
+	ASSERT(cache != NULL && key != NULL);
+
+	pthread_mutex_lock(&cache->mutex);
+
+	ProductCacheEntry *entry = raxFind(cache->lookup, (unsigned char *)key, strlen(key));
+	if(entry == raxNotFound) {
+		entry = NULL;
+	} else if(entry->version != version) {
+		// the graph was modified since the product was computed
+		_Evict(cache, entry);
+		entry = NULL;
+	} else {
+		entry->last_use = ++cache->clock;
+		entry->refcount++;
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+	return entry;
+}
+
+ProductCacheEntry *ProductCache_Insert(ProductCache *cache, const char *key,
+		uint64_t version, GrB_Matrix m) {
+	ASSERT(cache != NULL && key != NULL && m != NULL);
+
+	uint64_t capacity;
+	Config_Option_get(Config_PRODUCT_CACHE_CAPACITY, &capacity);
+
+	ProductCacheEntry *entry = rm_malloc(sizeof(ProductCacheEntry));
+	entry->key = rm_strdup(key);
+	entry->version = version;
+	entry->m = m;
+	entry->size = _ProductSize(m);
+	entry->refcount = 1;
+
+	pthread_mutex_lock(&cache->mutex);
+
+	ProductCacheEntry *existing = raxFind(cache->lookup, (unsigned char *)key, strlen(key));
+	if(existing != raxNotFound) {
+		if(existing->version == version) {
+			// computed concurrently by another query, discard ours
+			existing->last_use = ++cache->clock;
+			existing->refcount++;
+			pthread_mutex_unlock(&cache->mutex);
+			_EntryFree(entry);
+			return existing;
+		}
+		_Evict(cache, existing);
+	}
+
+	entry->last_use = ++cache->clock;
+	if(entry->size <= capacity) {
+		// make room for the product, the cache holds a reference of its own
+		_EvictToCapacity(cache, capacity - entry->size);
+		raxInsert(cache->lookup, (unsigned char *)key, strlen(key), entry, NULL);
+		cache->usage += entry->size;
+		entry->refcount++;
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+	return entry;
+}
+
+GrB_Matrix ProductCacheEntry_Matrix(const ProductCacheEntry *entry) {
+	ASSERT(entry != NULL);
+	return entry->m;
+}
+
+void ProductCache_Release(ProductCache *cache, ProductCacheEntry *entry) {
+	ASSERT(cache != NULL && entry != NULL);
+
+	pthread_mutex_lock(&cache->mutex);
+	_EntryDecRef(entry);
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+size_t ProductCache_MemoryUsage(ProductCache *cache) {
+	ASSERT(cache != NULL);
+
+	pthread_mutex_lock(&cache->mutex);
+	size_t usage = cache->usage;
+	pthread_mutex_unlock(&cache->mutex);
+	return usage;
+}
+
+void ProductCache_Free(ProductCache *cache) {
+	if(cache == NULL) return;
+
+	_EvictToCapacity(cache, 0);
+	raxFree(cache->lookup);
+	pthread_mutex_destroy(&cache->mutex);
+	rm_free(cache);
+}
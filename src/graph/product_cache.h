@@ -0,0 +1,79 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+#include "rax.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// Products of algebraic expressions shared across queries.
+// Products are keyed by their expression's canonical string and computed
+// against a specific graph version, a product of an outdated version is never
+// returned. The cache's memory is bounded by PRODUCT_CACHE_CAPACITY, least
+// recently used products are evicted first.
+// Acquired entries outlive their eviction until released.
+
+typedef struct ProductCacheEntry ProductCacheEntry;
+
+typedef struct {
+	rax *lookup;            // Mapping between keys and entries.
+	size_t usage;           // Estimated memory held by cached products, in bytes.
+	uint64_t clock;         // Logical time, advanced by each lookup.
+	pthread_mutex_t mutex;  // Serializes cache access.
+} ProductCache;
+
+// create a new, empty product cache
+ProductCache *ProductCache_New(void);
+
+// returns true if products should be cached
+bool ProductCache_Enabled(void);
+
+// retrieves the product cached under key for graph version,
+// NULL if missing, the entry must be released by ProductCache_Release
+ProductCacheEntry *ProductCache_Acquire
+(
+	ProductCache *cache,  // cache
+	const char *key,      // expression canonical string
+	uint64_t version      // graph version
+);
+
+// caches m under key for graph version, taking ownership over m
+// returns an acquired entry, which must be released by ProductCache_Release
+// if an entry for key and version exists m is freed and the entry is returned
+ProductCacheEntry *ProductCache_Insert
+(
+	ProductCache *cache,  // cache
+	const char *key,      // expression canonical string
+	uint64_t version,     // graph version
+	GrB_Matrix m          // product
+);
+
+// returns the entry's product
+GrB_Matrix ProductCacheEntry_Matrix
+(
+	const ProductCacheEntry *entry
+);
+
+// releases an acquired entry
+void ProductCache_Release
+(
+	ProductCache *cache,
+	ProductCacheEntry *entry
+);
+
+// returns the estimated memory held by cached products, in bytes
+size_t ProductCache_MemoryUsage
+(
+	ProductCache *cache
+);
+
+// frees the cache, all entries must be released
+void ProductCache_Free
+(
+	ProductCache *cache
+);
@@ -0,0 +1,103 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "projection.h"
+#include "../RG.h"
+#include "../util/rmalloc.h"
+#include "../algorithms/subgraph.h"
+#include "../algorithms/undirected.h"
+
+// epoch of a projection which must be rebuilt on access
+#define PROJECTION_STALE UINT64_MAX
+
+Projection *Projection_New(const char *name, const char *label, int label_id,
+						   const char *relation, int relation_id) {
+	ASSERT(name != NULL);
+
+	Projection *p = rm_malloc(sizeof(Projection));
+	p->name = rm_strdup(name);
+	p->label = (label) ? rm_strdup(label) : NULL;
+	p->relation = (relation) ? rm_strdup(relation) : NULL;
+	p->label_id = label_id;
+	p->relation_id = relation_id;
+	p->S = GrB_NULL;
+	p->U = GrB_NULL;
+	p->mapping = NULL;
+	p->epoch = 0;
+	int res = pthread_mutex_init(&p->lock, NULL);
+	ASSERT(res == 0);
+	UNUSED(res);
+	return p;
+}
+
+static void _Projection_Clear(Projection *p) {
+	GrB_free(&p->S);
+	GrB_free(&p->U);
+	if(p->mapping) rm_free(p->mapping);
+	p->mapping = NULL;
+}
+
+static GrB_Info _Projection_Build(Projection *p, Graph *g) {
+	_Projection_Clear(p);
+
+	GrB_Matrix l = GrB_NULL;
+	if(p->label_id != GRAPH_NO_LABEL) l = Graph_GetLabelMatrix(g, p->label_id);
+
+	GrB_Matrix r;
+	if(p->relation_id != GRAPH_NO_RELATION) {
+		r = Graph_GetRelationMatrix(g, p->relation_id);
+	} else {
+		r = Graph_GetAdjacencyMatrix(g);
+	}
+
+	GrB_Info info = Subgraph(&p->S, &p->mapping, r, l);
+
+	// a writer might modify the graph after the projection is built
+	// without advancing the epoch, rebuild on next access
+	p->epoch = (g->_writelocked) ? PROJECTION_STALE : Graph_WriteEpoch(g);
+	return info;
+}
+
+GrB_Info Projection_Get(Projection *p, Graph *g, bool undirected, GrB_Matrix *S,
+						const GrB_Index **mapping) {
+	ASSERT(p != NULL);
+	ASSERT(g != NULL);
+	ASSERT(S != NULL);
+	ASSERT(mapping != NULL);
+
+	GrB_Info info = GrB_SUCCESS;
+	pthread_mutex_lock(&p->lock);
+
+	// rebuild once the graph was modified
+	if(p->S == GrB_NULL || p->epoch != Graph_WriteEpoch(g)) {
+		info = _Projection_Build(p, g);
+		if(info != GrB_SUCCESS) goto cleanup;
+	}
+
+	if(undirected && p->U == GrB_NULL) {
+		// S is already restricted to the projected nodes
+		GrB_Index *unused = NULL;
+		info = Undirected(&p->U, &unused, p->S, GrB_NULL);
+		if(info != GrB_SUCCESS) goto cleanup;
+	}
+
+	*S = (undirected) ? p->U : p->S;
+	*mapping = p->mapping;
+
+cleanup:
+	pthread_mutex_unlock(&p->lock);
+	return info;
+}
+
+void Projection_Free(Projection *p) {
+	ASSERT(p != NULL);
+	_Projection_Clear(p);
+	rm_free(p->name);
+	if(p->label) rm_free(p->label);
+	if(p->relation) rm_free(p->relation);
+	pthread_mutex_destroy(&p->lock);
+	rm_free(p);
+}
@@ -0,0 +1,60 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "graph.h"
+#include <pthread.h>
+
+// a named, in-memory view of the graph consumed by algorithm procedures
+// holding the boolean matrix of the nodes of a label connected by edges
+// of a relationship type, as built by Subgraph, along with its
+// undirected counterpart, as built by Undirected, once requested
+//
+// the matrices are rebuilt on access once the graph was modified,
+// as detected by the graph's write epoch, such that a projection is never
+// stale but its setup cost is paid once for any number of reads
+typedef struct {
+	char *name;             // projection name
+	char *label;            // node label, NULL for every node
+	char *relation;         // relationship type, NULL for every type
+	int label_id;           // node label ID, GRAPH_NO_LABEL for every node
+	int relation_id;        // relationship type ID, GRAPH_NO_RELATION for every type
+	GrB_Matrix S;           // directed projected graph, NULL until built
+	GrB_Matrix U;           // undirected projected graph, NULL until requested
+	GrB_Index *mapping;     // rows of S to node IDs, NULL if rows are node IDs
+	uint64_t epoch;         // graph write epoch at which S was built
+	pthread_mutex_t lock;   // serializes rebuilds by concurrent readers
+} Projection;
+
+// create a new projection, matrices are built on first access
+Projection *Projection_New
+(
+	const char *name,      // projection name
+	const char *label,     // node label, NULL for every node
+	int label_id,          // node label ID
+	const char *relation,  // relationship type, NULL for every type
+	int relation_id        // relationship type ID
+);
+
+// retrieve the projected graph and its mapping from rows to node IDs
+// the matrix is rebuilt if the graph was modified since it was built
+// caller holds the graph's lock, the matrix and mapping are owned by
+// the projection and remain valid for as long as the lock is held
+GrB_Info Projection_Get
+(
+	Projection *p,              // projection
+	Graph *g,                   // projected graph
+	bool undirected,            // retrieve the undirected projection
+	GrB_Matrix *S,              // [output] projected graph
+	const GrB_Index **mapping   // [output] rows to node IDs, NULL if rows are node IDs
+);
+
+// free projection
+void Projection_Free
+(
+	Projection *p  // projection to free
+);
@@ -0,0 +1,111 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "query_quota.h"
+#include "RG.h"
+#include "../config.h"
+#include "../util/simple_timer.h"
+
+// pays off the debt accumulated since it was last paid off
+// the caller holds the quota's lock
+static void _QueryQuota_PayOff(QueryQuota *quota) {
+	double elapsed = simple_toc(quota->debt_timer);
+	simple_tic(quota->debt_timer);
+
+	quota->debt -= elapsed * quota->debt_rate;
+	if(quota->debt < 0) quota->debt = 0;
+}
+
+void QueryQuota_Init(QueryQuota *quota) {
+	ASSERT(quota != NULL);
+
+	quota->running    =  0;
+	quota->debt       =  0;
+	quota->debt_rate  =  0;
+	quota->cpu_time   =  0;
+	quota->rejected   =  0;
+	simple_tic(quota->debt_timer);
+	int res = pthread_mutex_init(&quota->lock, NULL);
+	ASSERT(res == 0);
+}
+
+QuotaResult QueryQuota_Admit(QueryQuota *quota) {
+	ASSERT(quota != NULL);
+
+	uint64_t max_concurrent;
+	uint64_t cpu_quota;
+	Config_Option_get(Config_GRAPH_MAX_CONCURRENT_QUERIES, &max_concurrent);
+	Config_Option_get(Config_GRAPH_CPU_QUOTA, &cpu_quota);
+
+	QuotaResult res = QUOTA_ADMITTED;
+	pthread_mutex_lock(&quota->lock);
+
+	// debt accumulated under a previous quota is paid off at its rate
+	// lifting the quota forgives the debt
+	_QueryQuota_PayOff(quota);
+	quota->debt_rate = cpu_quota;
+	if(cpu_quota == 0) quota->debt = 0;
+
+	if(max_concurrent > 0 && quota->running >= max_concurrent) {
+		res = QUOTA_CONCURRENCY;
+	} else if(cpu_quota > 0 && quota->debt >= cpu_quota) {
+		res = QUOTA_CPU;
+	}
+
+	if(res == QUOTA_ADMITTED) quota->running++;
+	else quota->rejected++;
+
+	pthread_mutex_unlock(&quota->lock);
+	return res;
+}
+
+void QueryQuota_Release(QueryQuota *quota, double cpu_time) {
+	ASSERT(quota != NULL);
+	ASSERT(cpu_time >= 0);
+
+	pthread_mutex_lock(&quota->lock);
+	ASSERT(quota->running > 0);
+
+	_QueryQuota_PayOff(quota);
+	quota->running--;
+	quota->cpu_time += cpu_time;
+	// debt only matters while a CPU quota is set
+	if(quota->debt_rate > 0) quota->debt += cpu_time;
+
+	pthread_mutex_unlock(&quota->lock);
+}
+
+const char *QueryQuota_Error(QuotaResult res) {
+	switch(res) {
+		case QUOTA_CONCURRENCY:
+			return "Max concurrent queries per graph exceeded";
+		case QUOTA_CPU:
+			return "Graph CPU quota exceeded";
+		default:
+			ASSERT(false);
+			return NULL;
+	}
+}
+
+void QueryQuota_Usage(QueryQuota *quota, uint64_t *running, double *cpu_time,
+		uint64_t *rejected) {
+	ASSERT(quota != NULL);
+
+	pthread_mutex_lock(&quota->lock);
+	*running   =  quota->running;
+	*cpu_time  =  quota->cpu_time;
+	*rejected  =  quota->rejected;
+	pthread_mutex_unlock(&quota->lock);
+}
+
+void QueryQuota_Destroy(QueryQuota *quota) {
+	ASSERT(quota != NULL);
+	// admitted queries hold a reference to the graph
+	ASSERT(quota->running == 0);
+
+	int res = pthread_mutex_destroy(&quota->lock);
+	ASSERT(res == 0);
+}
@@ -0,0 +1,75 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Resources consumed by the queries of a single graph.
+// A query is admitted while the number of queries queued or running against
+// its graph is below GRAPH_MAX_CONCURRENT_QUERIES and the graph's CPU debt is
+// below GRAPH_CPU_QUOTA. Each completed query adds the CPU time it consumed to
+// the debt, which is paid off at GRAPH_CPU_QUOTA milliseconds per second,
+// such that a graph may burst up to a second's worth of its quota.
+
+// outcome of a query's admission
+typedef enum {
+	QUOTA_ADMITTED,     // query may execute
+	QUOTA_CONCURRENCY,  // graph runs GRAPH_MAX_CONCURRENT_QUERIES queries
+	QUOTA_CPU,          // graph consumed its GRAPH_CPU_QUOTA
+} QuotaResult;
+
+typedef struct {
+	uint64_t running;        // Admitted queries yet to complete.
+	double debt;             // CPU milliseconds consumed and not yet paid off.
+	double debt_rate;        // Milliseconds of debt paid off per second.
+	double debt_timer[2];    // Time since the debt was last paid off.
+	double cpu_time;         // Total CPU milliseconds consumed by admitted queries.
+	uint64_t rejected;       // Number of queries rejected for exceeding a quota.
+	pthread_mutex_t lock;    // Protects the quota.
+} QueryQuota;
+
+// initialize quota, no queries are running against the graph
+void QueryQuota_Init
+(
+	QueryQuota *quota
+);
+
+// admits a query against the configured quotas
+// an admitted query must be released by QueryQuota_Release
+QuotaResult QueryQuota_Admit
+(
+	QueryQuota *quota
+);
+
+// releases an admitted query, which consumed 'cpu_time' milliseconds
+void QueryQuota_Release
+(
+	QueryQuota *quota,
+	double cpu_time
+);
+
+// returns the error reported to a client whose query wasn't admitted
+const char *QueryQuota_Error
+(
+	QuotaResult res
+);
+
+// reports the quota's usage
+void QueryQuota_Usage
+(
+	QueryQuota *quota,
+	uint64_t *running,   // [output] queries queued or running
+	double *cpu_time,    // [output] total CPU milliseconds consumed
+	uint64_t *rejected   // [output] rejected queries
+);
+
+void QueryQuota_Destroy
+(
+	QueryQuota *quota
+);
@@ -5,51 +5,131 @@
 */
 
 #include "group_cache.h"
+#include "RG.h"
+#include "../util/arr.h"
 #include "../util/rmalloc.h"
 
+#define INITIAL_SLOT_COUNT 16
+
+// hash of the single group formed when there are no keys
+#define SINGLE_GROUP_HASH 0
+
+static inline bool _KeysEqual(const Group *g, const SIValue *keys,
+		uint key_count) {
+	ASSERT(g->key_count == key_count);
+	for(uint i = 0; i < key_count; i++) {
+		if(SIValue_Compare(g->keys[i], keys[i], NULL) != 0) return false;
+	}
+	return true;
+}
+
+// double number of slots, keeping load factor under 0.5
+static void _Grow(CacheGroup *groups) {
+	uint32_t slot_count = groups->slot_count * 2;
+	uint32_t mask = slot_count - 1;
+	CacheGroupSlot *slots = rm_calloc(slot_count, sizeof(CacheGroupSlot));
+
+	for(uint32_t i = 0; i < groups->slot_count; i++) {
+		CacheGroupSlot *s = groups->slots + i;
+		if(s->idx == 0) continue;
+		uint32_t j = s->hash & mask;
+		while(slots[j].idx != 0) j = (j + 1) & mask;
+		slots[j] = *s;
+	}
+
+	rm_free(groups->slots);
+	groups->slots = slots;
+	groups->slot_count = slot_count;
+}
+
 CacheGroup *CacheGroupNew() {
-	return raxNew();
+	CacheGroup *groups = rm_malloc(sizeof(CacheGroup));
+	groups->groups = array_new(Group *, 1);
+	groups->slot_count = INITIAL_SLOT_COUNT;
+	groups->slots = rm_calloc(INITIAL_SLOT_COUNT, sizeof(CacheGroupSlot));
+	return groups;
+}
+
+XXH64_hash_t CacheGroupHash(const SIValue *keys, uint key_count) {
+	if(key_count == 0) return SINGLE_GROUP_HASH;
+
+	XXH64_state_t state;
+	XXH_errorcode res = XXH64_reset(&state, 0);
+	UNUSED(res);
+	ASSERT(res != XXH_ERROR);
+
+	for(uint i = 0; i < key_count; i++) SIValue_HashUpdate(keys[i], &state);
+	return XXH64_digest(&state);
 }
 
-void CacheGroupAdd(CacheGroup *groups, char *key, Group *group) {
-	raxInsert(groups, (unsigned char *)key, strlen(key), group, NULL);
+void CacheGroupAdd(CacheGroup *groups, XXH64_hash_t hash, Group *group) {
+	ASSERT(groups != NULL && group != NULL);
+
+	uint32_t count = array_len(groups->groups);
+	if((uint64_t)(count + 1) * 2 > groups->slot_count) _Grow(groups);
+
+	groups->groups = array_append(groups->groups, group);
+
+	uint32_t mask = groups->slot_count - 1;
+	uint32_t i = hash & mask;
+	while(groups->slots[i].idx != 0) i = (i + 1) & mask;
+	groups->slots[i].hash = hash;
+	groups->slots[i].idx = count + 1;
 }
 
 // Retrives a group,
-// Sets group to NULL if key is missing.
-Group *CacheGroupGet(CacheGroup *groups, char *key) {
-	Group *g = raxFind(groups, (unsigned char *)key, strlen(key));
-	if(g == raxNotFound) return NULL;
-	return g;
+// Returns NULL if key is missing.
+Group *CacheGroupGet(CacheGroup *groups, XXH64_hash_t hash,
+		const SIValue *keys, uint key_count) {
+	ASSERT(groups != NULL);
+
+	uint32_t mask = groups->slot_count - 1;
+	for(uint32_t i = hash & mask; groups->slots[i].idx != 0;
+			i = (i + 1) & mask) {
+		CacheGroupSlot *s = groups->slots + i;
+		if(s->hash != hash) continue;
+		Group *g = groups->groups[s->idx - 1];
+		if(_KeysEqual(g, keys, key_count)) return g;
+	}
+
+	return NULL;
+}
+
+uint CacheGroupCount(const CacheGroup *groups) {
+	ASSERT(groups != NULL);
+	return array_len(groups->groups);
 }
 
 void FreeGroupCache(CacheGroup *groups) {
-	raxFreeWithCallback(groups, (void (*)(void *))FreeGroup);
+	if(groups == NULL) return;
+
+	uint count = array_len(groups->groups);
+	for(uint i = 0; i < count; i++) FreeGroup(groups->groups[i]);
+	array_free(groups->groups);
+	rm_free(groups->slots);
+	rm_free(groups);
 }
 
 // Populates an iterator to scan entire group cache
 CacheGroupIterator *CacheGroupIter(CacheGroup *groups) {
 	CacheGroupIterator *iter = rm_malloc(sizeof(CacheGroupIterator));
-
-	raxStart(iter, groups);
-	raxSeek(iter, "^", NULL, 0);
-
+	iter->groups = groups;
+	iter->pos = 0;
 	return iter;
 }
 
-// Advance iterator and returns key & value in current position.
-int CacheGroupIterNext(CacheGroupIterator *iter, char **key, Group **group) {
-	int res = raxNext(iter);
-	if(res == 0) {
+// Advance iterator and returns group in current position.
+int CacheGroupIterNext(CacheGroupIterator *iter, Group **group) {
+	if(iter->pos == array_len(iter->groups->groups)) {
 		*group = NULL;
-	} else {
-		*group = iter->data; // TODO revisit this to fix up
+		return 0;
 	}
-	return res;
+
+	*group = iter->groups->groups[iter->pos++];
+	return 1;
 }
 
 void CacheGroupIterator_Free(CacheGroupIterator *iter) {
 	if(iter == NULL) return;
-	raxStop(iter);
 	rm_free(iter);
 }
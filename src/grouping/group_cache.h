@@ -8,27 +8,51 @@
 #define GROUP_CACHE_H_
 
 #include "group.h"
-#include "rax.h"
-
-typedef raxIterator CacheGroupIterator;
-typedef rax CacheGroup;
+#include "xxhash.h"
+
+// open addressing hash table slot
+typedef struct {
+	XXH64_hash_t hash;  // hash of group key
+	uint32_t idx;       // group position + 1, 0 marks an empty slot
+} CacheGroupSlot;
+
+// groups are kept in creation order
+// and located through an open addressing table keyed by group key hash
+typedef struct {
+	Group **groups;         // groups in creation order
+	CacheGroupSlot *slots;  // linear probing table
+	uint32_t slot_count;    // number of slots, power of 2
+} CacheGroup;
+
+typedef struct {
+	CacheGroup *groups;  // iterated groups
+	uint32_t pos;        // position of next group
+} CacheGroupIterator;
 
 CacheGroup *CacheGroupNew();
 
-void CacheGroupAdd(CacheGroup *groups, char *key, Group *group);
+// hash group key
+XXH64_hash_t CacheGroupHash(const SIValue *keys, uint key_count);
+
+// add group, 'hash' must be the hash of the group's keys
+void CacheGroupAdd(CacheGroup *groups, XXH64_hash_t hash, Group *group);
+
+// Retrives the group associated with keys
+// Returns NULL if key is missing.
+Group *CacheGroupGet(CacheGroup *groups, XXH64_hash_t hash,
+		const SIValue *keys, uint key_count);
 
-// Retrives a group,
-// Sets group to NULL if key is missing.
-Group *CacheGroupGet(CacheGroup *groups, char *key);
+// Returns number of groups.
+uint CacheGroupCount(const CacheGroup *groups);
 
 void FreeGroupCache(CacheGroup *groups);
 
-// Populates an iterator to scan group cache
+// Populates an iterator to scan group cache in group creation order
 CacheGroupIterator *CacheGroupIter(CacheGroup *groups);
 
-// Advance iterator and returns key & value in current position.
-int CacheGroupIterNext(CacheGroupIterator *iter, char **key, Group **group);
+// Advance iterator and returns group in current position.
+int CacheGroupIterNext(CacheGroupIterator *iter, Group **group);
 
 void CacheGroupIterator_Free(CacheGroupIterator *iter);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,373 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "composite_index.h"
+#include "RG.h"
+#include "../util/arr.h"
+#include "../util/qsort.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+#include <string.h>
+
+// marks a removed run entry, node ids never reach the most significant bit
+#define COMPOSITE_INDEX_REMOVED ((NodeID)1 << 63)
+#define ENTRY_ID(e) ((e)->id & ~COMPOSITE_INDEX_REMOVED)
+#define ENTRY_REMOVED(e) ((e)->id & COMPOSITE_INDEX_REMOVED)
+
+#define ENTRY_ISLT(a, b) (_EntryCompare((a), (b)) < 0)
+
+// compares the first 'n' keys of 'e' against 'keys'
+static inline int _KeyCompare(const CompositeIndexEntry *e, const double *keys,
+		uint n) {
+	for(uint i = 0; i < n; i++) {
+		if(e->keys[i] < keys[i]) return -1;
+		if(e->keys[i] > keys[i]) return 1;
+	}
+	return 0;
+}
+
+// compares entries by (keys, id), unused key columns are zeroed
+static inline int _EntryCompare(const CompositeIndexEntry *a,
+		const CompositeIndexEntry *b) {
+	int rel = _KeyCompare(a, b->keys, COMPOSITE_INDEX_MAX_FIELDS);
+	if(rel != 0) return rel;
+	if(ENTRY_ID(a) < ENTRY_ID(b)) return -1;
+	if(ENTRY_ID(a) > ENTRY_ID(b)) return 1;
+	return 0;
+}
+
+static inline double *_NodeKeys(const CompositeIndex *ci, NodeID id) {
+	return ci->values + id * ci->key_count;
+}
+
+static inline bool _Indexed(const CompositeIndex *ci, NodeID id) {
+	return (id * ci->key_count < array_len(ci->values) &&
+			!isnan(_NodeKeys(ci, id)[0]));
+}
+
+//------------------------------------------------------------------------------
+// Run lookup
+//------------------------------------------------------------------------------
+
+// returns the position of the first run entry which doesn't precede 'keys'
+// strict = false: first entry with entry.keys[0..n) >= keys
+// strict = true:  first entry with entry.keys[0..n) >  keys
+static uint64_t _Bound(const CompositeIndex *ci, const double *keys, uint n,
+		bool strict) {
+	uint64_t lo = 0;
+	uint64_t hi = array_len(ci->run);
+
+	while(lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		int rel = _KeyCompare(ci->run + mid, keys, n);
+		if(rel < 0 || (strict && rel == 0)) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return lo;
+}
+
+// returns the run position of (keys, id), -1 if missing
+// removed entries are located as well
+static int64_t _RunFind(const CompositeIndex *ci, const double *keys,
+		NodeID id) {
+	uint64_t lo = _Bound(ci, keys, ci->key_count, false);
+	uint64_t hi = _Bound(ci, keys, ci->key_count, true);
+
+	// entries sharing keys are ordered by id
+	while(lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		if(ENTRY_ID(ci->run + mid) < id) lo = mid + 1;
+		else hi = mid;
+	}
+
+	if(lo < array_len(ci->run) &&
+			_KeyCompare(ci->run + lo, keys, ci->key_count) == 0 &&
+			ENTRY_ID(ci->run + lo) == id) {
+		return lo;
+	}
+	return -1;
+}
+
+// merge the delta into the run, dropping removed entries
+static void _Merge(CompositeIndex *ci) {
+	uint32_t delta_len = array_len(ci->delta);
+	if(delta_len == 0 && ci->removed == 0) return;
+
+	QSORT(CompositeIndexEntry, ci->delta, delta_len, ENTRY_ISLT);
+
+	uint32_t run_len = array_len(ci->run);
+	CompositeIndexEntry *run = array_newlen(CompositeIndexEntry,
+			run_len - ci->removed + delta_len);
+
+	uint64_t i = 0;  // run position
+	uint64_t j = 0;  // delta position
+	uint64_t k = 0;  // merged position
+	while(i < run_len || j < delta_len) {
+		CompositeIndexEntry *e;
+		if(j == delta_len ||
+				(i < run_len && ENTRY_ISLT(ci->run + i, ci->delta + j))) {
+			e = ci->run + i++;
+			if(ENTRY_REMOVED(e)) continue;
+		} else {
+			e = ci->delta + j++;
+		}
+		run[k++] = *e;
+	}
+	ASSERT(k == array_len(run));
+
+	array_free(ci->run);
+	ci->run = run;
+	ci->removed = 0;
+	array_clear(ci->delta);
+}
+
+static inline bool _Contains(const NumericRange *range, double key) {
+	if(range->min != -INFINITY) {
+		if(range->include_min ? key < range->min : key <= range->min) {
+			return false;
+		}
+	}
+	if(range->max != INFINITY) {
+		if(range->include_max ? key > range->max : key >= range->max) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// API
+//------------------------------------------------------------------------------
+
+CompositeIndex *CompositeIndex_New(const Attribute_ID *attributes,
+		uint key_count) {
+	ASSERT(attributes != NULL);
+	ASSERT(key_count > 0 && key_count <= COMPOSITE_INDEX_MAX_FIELDS);
+
+	CompositeIndex *ci = rm_malloc(sizeof(CompositeIndex));
+
+	ci->attributes  =  array_new(Attribute_ID, key_count);
+	ci->key_count   =  key_count;
+	ci->run         =  array_new(CompositeIndexEntry, 0);
+	ci->delta       =  array_new(CompositeIndexEntry, 0);
+	ci->values      =  array_new(double, 0);
+	ci->count       =  0;
+	ci->removed     =  0;
+	ci->loading     =  true;
+	ci->batching    =  false;
+
+	for(uint i = 0; i < key_count; i++) {
+		array_append(ci->attributes, attributes[i]);
+	}
+
+	return ci;
+}
+
+void CompositeIndex_Insert(CompositeIndex *ci, NodeID id, const double *keys) {
+	ASSERT(ci != NULL && keys != NULL);
+	ASSERT(!(id & COMPOSITE_INDEX_REMOVED));
+
+	uint key_count = ci->key_count;
+
+	// NaN doesn't compare, treat as missing
+	for(uint i = 0; i < key_count; i++) {
+		if(isnan(keys[i])) {
+			CompositeIndex_Remove(ci, id);
+			return;
+		}
+	}
+
+	uint64_t values_len = array_len(ci->values);
+	if((id + 1) * key_count > values_len) {
+		ci->values = (double *)array_ensure_len(ci->values,
+				(id + 1) * key_count);
+		for(uint64_t i = values_len; i < (id + 1) * key_count; i++) {
+			ci->values[i] = NAN;
+		}
+	}
+
+	double *prev = _NodeKeys(ci, id);
+	if(!isnan(prev[0])) {
+		if(memcmp(prev, keys, sizeof(double) * key_count) == 0) return;
+		CompositeIndex_Remove(ci, id);
+	}
+
+	memcpy(prev, keys, sizeof(double) * key_count);
+	ci->count++;
+
+	// revive a previously removed run entry
+	int64_t pos = _RunFind(ci, keys, id);
+	if(pos != -1) {
+		ASSERT(ENTRY_REMOVED(ci->run + pos));
+		ci->run[pos].id = id;
+		ci->removed--;
+		return;
+	}
+
+	CompositeIndexEntry e = {0};
+	memcpy(e.keys, keys, sizeof(double) * key_count);
+	e.id = id;
+	array_append(ci->delta, e);
+	if(!ci->loading && array_len(ci->delta) >= COMPOSITE_INDEX_DELTA_CAP) {
+		_Merge(ci);
+	}
+}
+
+void CompositeIndex_Remove(CompositeIndex *ci, NodeID id) {
+	ASSERT(ci != NULL);
+
+	if(!_Indexed(ci, id)) return;
+
+	double *keys = _NodeKeys(ci, id);
+	int64_t pos = _RunFind(ci, keys, id);
+
+	// mark node as missing
+	for(uint i = 0; i < ci->key_count; i++) keys[i] = NAN;
+	ci->count--;
+
+	if(pos != -1 && !ENTRY_REMOVED(ci->run + pos)) {
+		ci->run[pos].id |= COMPOSITE_INDEX_REMOVED;
+		ci->removed++;
+		// compact once most of the run is removed
+		if(!ci->loading && ci->removed > COMPOSITE_INDEX_DELTA_CAP &&
+				ci->removed > array_len(ci->run) / 2) {
+			_Merge(ci);
+		}
+		return;
+	}
+
+	uint32_t delta_len = array_len(ci->delta);
+	for(uint32_t i = 0; i < delta_len; i++) {
+		if(ci->delta[i].id == id) {
+			array_del_fast(ci->delta, i);
+			return;
+		}
+	}
+
+	ASSERT(false && "indexed key is missing");
+}
+
+void CompositeIndex_Flush(CompositeIndex *ci) {
+	ASSERT(ci != NULL);
+	ci->loading = false;
+	_Merge(ci);
+}
+
+void CompositeIndex_DeferMerges(CompositeIndex *ci) {
+	ASSERT(ci != NULL);
+	if(ci->loading) return;
+	ci->batching = true;
+	ci->loading = true;
+}
+
+void CompositeIndex_ResumeMerges(CompositeIndex *ci) {
+	ASSERT(ci != NULL);
+	if(!ci->batching) return;
+
+	ci->batching = false;
+	ci->loading = false;
+	if(array_len(ci->delta) >= COMPOSITE_INDEX_DELTA_CAP ||
+			(ci->removed > COMPOSITE_INDEX_DELTA_CAP &&
+			 ci->removed > array_len(ci->run) / 2)) {
+		_Merge(ci);
+	}
+}
+
+NodeID *CompositeIndex_Query(const CompositeIndex *ci, const double *prefix,
+		uint prefix_len, const NumericRange *range) {
+	ASSERT(ci != NULL);
+	ASSERT(prefix_len + (range != NULL) <= ci->key_count);
+	ASSERT(prefix != NULL || prefix_len == 0);
+
+	if(range != NULL && !NumericRange_IsValid(range)) {
+		return array_new(NodeID, 0);
+	}
+
+	double bound[COMPOSITE_INDEX_MAX_FIELDS];
+	if(prefix_len > 0) memcpy(bound, prefix, sizeof(double) * prefix_len);
+
+	// locate the run slice holding the prefix, narrowed by range
+	uint64_t begin;
+	uint64_t end;
+	if(range != NULL && range->min != -INFINITY) {
+		bound[prefix_len] = range->min;
+		begin = _Bound(ci, bound, prefix_len + 1, !range->include_min);
+	} else {
+		begin = _Bound(ci, bound, prefix_len, false);
+	}
+
+	if(range != NULL && range->max != INFINITY) {
+		bound[prefix_len] = range->max;
+		end = _Bound(ci, bound, prefix_len + 1, range->include_max);
+	} else {
+		end = _Bound(ci, bound, prefix_len, true);
+	}
+	if(end < begin) end = begin;
+
+	// collect matching pending insertions, in key order
+	CompositeIndexEntry *pending = array_new(CompositeIndexEntry, 0);
+	uint32_t delta_len = array_len(ci->delta);
+	for(uint32_t i = 0; i < delta_len; i++) {
+		const CompositeIndexEntry *e = ci->delta + i;
+		if(_KeyCompare(e, prefix, prefix_len) != 0) continue;
+		if(range != NULL && !_Contains(range, e->keys[prefix_len])) continue;
+		array_append(pending, *e);
+	}
+	uint32_t pending_len = array_len(pending);
+	QSORT(CompositeIndexEntry, pending, pending_len, ENTRY_ISLT);
+
+	// merge run slice with pending insertions
+	NodeID *ids = array_new(NodeID, (end - begin) + pending_len);
+	uint64_t i = begin;
+	uint32_t j = 0;
+	while(i < end || j < pending_len) {
+		if(j == pending_len ||
+				(i < end && ENTRY_ISLT(ci->run + i, pending + j))) {
+			const CompositeIndexEntry *e = ci->run + i++;
+			if(!ENTRY_REMOVED(e)) array_append(ids, e->id);
+		} else {
+			array_append(ids, pending[j++].id);
+		}
+	}
+
+	array_free(pending);
+	return ids;
+}
+
+int CompositeIndex_KeyPosition(const CompositeIndex *ci,
+		Attribute_ID attribute) {
+	ASSERT(ci != NULL);
+	for(uint i = 0; i < ci->key_count; i++) {
+		if(ci->attributes[i] == attribute) return i;
+	}
+	return -1;
+}
+
+uint64_t CompositeIndex_Count(const CompositeIndex *ci) {
+	ASSERT(ci != NULL);
+	return ci->count;
+}
+
+size_t CompositeIndex_MemoryUsage(const CompositeIndex *ci) {
+	ASSERT(ci != NULL);
+	return sizeof(CompositeIndex) +
+		   array_sizeof(array_hdr(ci->attributes)) +
+		   array_sizeof(array_hdr(ci->run)) +
+		   array_sizeof(array_hdr(ci->delta)) +
+		   array_sizeof(array_hdr(ci->values));
+}
+
+void CompositeIndex_Free(CompositeIndex *ci) {
+	ASSERT(ci != NULL);
+
+	array_free(ci->attributes);
+	array_free(ci->run);
+	array_free(ci->delta);
+	array_free(ci->values);
+	rm_free(ci);
+}
+
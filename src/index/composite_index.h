@@ -0,0 +1,134 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../graph/entities/node.h"
+#include "../graph/entities/graph_entity.h"
+#include "../util/range/numeric_range.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of key columns
+#define COMPOSITE_INDEX_MAX_FIELDS 4
+
+// number of pending insertions which trigger a merge into the sorted run
+#define COMPOSITE_INDEX_DELTA_CAP 4096
+
+// a single indexed key
+typedef struct {
+	double keys[COMPOSITE_INDEX_MAX_FIELDS];  // indexed values, in column order
+	NodeID id;                                // indexed node
+} CompositeIndexEntry;
+
+// ordered index over a sequence of numeric attributes
+//
+// entries live in a run sorted lexicographically by (keys, id)
+// such that an equality constraint on the leading columns
+// followed by a range constraint on the next column maps to
+// a contiguous slice of the run, ordered by that next column
+//
+// a node is indexed only if all of its key attributes are numeric
+//
+// insertions are appended to an unsorted delta which is merged into the run
+// once it grows past COMPOSITE_INDEX_DELTA_CAP, removals mark run entries
+//
+// the index is modified under the graph write lock and queried
+// under the graph read lock, queries never modify the index
+typedef struct {
+	Attribute_ID *attributes;    // key columns, in order
+	uint key_count;              // number of key columns
+	CompositeIndexEntry *run;    // entries sorted by (keys, id)
+	CompositeIndexEntry *delta;  // unsorted recent insertions
+	double *values;              // key_count indexed values per node id, NAN if absent
+	uint64_t removed;            // number of removed run entries
+	uint64_t count;              // number of indexed nodes
+	bool loading;                // defer merges until CompositeIndex_Flush
+	bool batching;               // merges deferred by CompositeIndex_DeferMerges
+} CompositeIndex;
+
+// create a new, empty composite index over 'attributes'
+// merges are deferred until the first call to CompositeIndex_Flush
+CompositeIndex *CompositeIndex_New
+(
+	const Attribute_ID *attributes,  // key columns, in order
+	uint key_count                   // number of key columns
+);
+
+// index node 'id' under 'keys', holding key_count values
+// replaces any key previously indexed for 'id'
+void CompositeIndex_Insert
+(
+	CompositeIndex *ci,  // composite index
+	NodeID id,           // node to index
+	const double *keys   // indexed values
+);
+
+// remove node 'id' from the index
+// NOP if 'id' isn't indexed
+void CompositeIndex_Remove
+(
+	CompositeIndex *ci,  // composite index
+	NodeID id            // node to remove
+);
+
+// merge pending insertions into the sorted run
+// and end the initial loading phase
+void CompositeIndex_Flush
+(
+	CompositeIndex *ci  // composite index
+);
+
+// defer merges while applying a batch of modifications
+// NOP during the initial loading phase
+void CompositeIndex_DeferMerges
+(
+	CompositeIndex *ci  // composite index
+);
+
+// resume merges deferred by CompositeIndex_DeferMerges, merging pending
+// modifications only if they exceed the thresholds of a single modification
+void CompositeIndex_ResumeMerges
+(
+	CompositeIndex *ci  // composite index
+);
+
+// returns the ids of all nodes whose first 'prefix_len' keys equal 'prefix'
+// and, if 'range' is specified, whose next key lies within 'range'
+// ids are reported in key order, the returned array is owned by the caller
+NodeID *CompositeIndex_Query
+(
+	const CompositeIndex *ci,  // composite index
+	const double *prefix,      // leading key values
+	uint prefix_len,           // number of leading key values
+	const NumericRange *range  // optional, range of key 'prefix_len'
+);
+
+// returns the position of 'attribute' among the key columns, -1 if missing
+int CompositeIndex_KeyPosition
+(
+	const CompositeIndex *ci,  // composite index
+	Attribute_ID attribute     // attribute to locate
+);
+
+// returns number of indexed nodes
+uint64_t CompositeIndex_Count
+(
+	const CompositeIndex *ci  // composite index
+);
+
+// returns the number of bytes held by the index
+size_t CompositeIndex_MemoryUsage
+(
+	const CompositeIndex *ci  // composite index
+);
+
+// free composite index
+void CompositeIndex_Free
+(
+	CompositeIndex *ci  // composite index
+);
+
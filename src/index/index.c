@@ -10,9 +10,18 @@
 #include "../util/arr.h"
 #include "../query_ctx.h"
 #include "../util/rmalloc.h"
+#include "../config.h"
+#include "../redismodule.h"
+#include "../util/thpool/pools.h"
 #include "../datatypes/point.h"
 #include "../graph/graphcontext.h"
 #include "../graph/entities/node.h"
+#include "../graph/entities/edge.h"
+
+// number of queued fulltext updates applied per lock window
+#define FULLTEXT_FLUSH_CHUNK_SIZE 1024
+
+static void _Index_IndexNode(Index *idx, const Node *n);
 
 static int _getNodeAttribute(void *ctx, const char *fieldName, const void *id, char **strVal,
 							 double *doubleVal) {
@@ -26,15 +35,15 @@ static int _getNodeAttribute(void *ctx, const char *fieldName, const void *id, c
 	ASSERT(node_found != 0);
 
 	Attribute_ID attrId = GraphContext_GetAttributeID(gc, fieldName);
-	SIValue *v = GraphEntity_GetProperty((GraphEntity *)&n, attrId);
+	SIValue v = GraphEntity_GetProperty((GraphEntity *)&n, attrId);
 	int ret;
-	if(v == PROPERTY_NOTFOUND) {
+	if(SI_TYPE(v) == T_NULL) {
 		ret = RSVALTYPE_NOTFOUND;
-	} else if(v->type & T_STRING) {
-		*strVal = v->stringval;
+	} else if(v.type & T_STRING) {
+		*strVal = v.stringval;
 		ret = RSVALTYPE_STRING;
-	} else if(v->type & SI_NUMERIC) {
-		*doubleVal = SI_GET_NUMERIC(*v);
+	} else if(v.type & SI_NUMERIC) {
+		*doubleVal = SI_GET_NUMERIC(v);
 		ret = RSVALTYPE_DOUBLE;
 	} else {
 		// Skiping booleans.
@@ -43,42 +52,111 @@ static int _getNodeAttribute(void *ctx, const char *fieldName, const void *id, c
 	return ret;
 }
 
-static void _populateIndex(Index *idx) {
-	GraphContext *gc = QueryCtx_GetGraphCtx();
+// index each edge of the indexed relationship type
+static void _populateEdgeIndex(Index *idx, GraphContext *gc) {
+	Schema *s = GraphContext_GetSchema(gc, idx->label, SCHEMA_EDGE);
+
+	// Relationship type doesn't exists.
+	if(s == NULL) return;
+
+	Graph *g = gc->g;
+	int relation_id = s->id;
+	NodeID src_id;
+	NodeID dest_id;
+	Edge *edges = array_new(Edge, 1);
+	GxB_MatrixTupleIter *it;
+	const GrB_Matrix relation_matrix = Graph_GetRelationMatrix(g, relation_id);
+	GxB_MatrixTupleIter_new(&it, relation_matrix);
+
+	// Iterate over each connected pair of nodes.
+	while(true) {
+		bool depleted = false;
+		GxB_MatrixTupleIter_next(it, &src_id, &dest_id, &depleted);
+		if(depleted) break;
+
+		Graph_GetEdgesConnectingNodes(g, src_id, dest_id, relation_id, &edges);
+		uint edge_count = array_len(edges);
+		for(uint i = 0; i < edge_count; i++) Index_IndexEdge(idx, edges + i);
+		array_clear(edges);
+	}
+
+	GxB_MatrixTupleIter_free(it);
+	array_free(edges);
+}
+
+// index up to 'limit' labeled nodes, starting at node ID '*next'
+// a limit of 0 indexes all remaining nodes
+// advances '*next' past the last indexed node, returns true once depleted
+static bool _populateNodeIndex(Index *idx, GraphContext *gc, NodeID *next,
+		uint64_t limit) {
 	Schema *s = GraphContext_GetSchema(gc, idx->label, SCHEMA_NODE);
 
 	// Label doesn't exists.
-	if(s == NULL) return;
+	if(s == NULL) return true;
 
 	Node node = GE_NEW_NODE();
 	NodeID node_id;
 	Graph *g = gc->g;
 	int label_id = s->id;
+	bool depleted = false;
+	uint64_t indexed = 0;
 	GxB_MatrixTupleIter *it;
 	const GrB_Matrix label_matrix = Graph_GetLabelMatrix(g, label_id);
 	GxB_MatrixTupleIter_new(&it, label_matrix);
 
+	// resume past the previous chunk, out of range once all rows were visited
+	if(*next > 0 && GxB_MatrixTupleIter_jump_to_row(it, *next) != GrB_SUCCESS) {
+		GxB_MatrixTupleIter_free(it);
+		return true;
+	}
+
 	// Iterate over each labeled node.
-	while(true) {
-		bool depleted = false;
+	while(limit == 0 || indexed < limit) {
 		GxB_MatrixTupleIter_next(it, NULL, &node_id, &depleted);
 		if(depleted) break;
 
 		Graph_GetNode(g, node_id, &node);
-		Index_IndexNode(idx, &node);
+		_Index_IndexNode(idx, &node);
+		*next = node_id + 1;
+		indexed++;
 	}
 	GxB_MatrixTupleIter_free(it);
+
+	return depleted;
+}
+
+static void _populateIndex(Index *idx) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	if(idx->entity_type == GETYPE_EDGE) {
+		_populateEdgeIndex(idx, gc);
+		return;
+	}
+
+	NodeID next = 0;
+	_populateNodeIndex(idx, gc, &next, 0);
 }
 
 // Create a new index.
-Index *Index_New(const char *label, IndexType type) {
+Index *Index_New(const char *label, IndexType type, GraphEntityType entity_type) {
+	ASSERT(entity_type == GETYPE_NODE || type == IDX_EXACT_MATCH);
+
 	Index *idx = rm_malloc(sizeof(Index));
 	idx->idx = NULL;
 	idx->fields_count = 0;
 	idx->type = type;
+	idx->entity_type = entity_type;
+	idx->endpoints = array_new(NodeID, 0);
 	idx->label = rm_strdup(label);
 	idx->fields = array_new(char *, 0);
 	idx->fields_ids = array_new(Attribute_ID, 0);
+	idx->ranges = array_new(RangeIndex *, 0);
+	idx->composites = array_new(CompositeIndex *, 0);
+	idx->vectors = array_new(VectorIndex *, 0);
+	idx->state = IDX_OPERATIONAL;
+	idx->build_id = 0;
+	idx->pending = array_new(NodeID, 0);
+	idx->version = 0;
+	idx->flushing = false;
 	return idx;
 }
 
@@ -92,6 +170,12 @@ void Index_AddField(Index *idx, const char *field) {
 	idx->fields_count++;
 	idx->fields = array_append(idx->fields, rm_strdup(field));
 	idx->fields_ids = array_append(idx->fields_ids, fieldID);
+	// range index is introduced once the index is constructed
+	if(idx->type == IDX_EXACT_MATCH) {
+		idx->ranges = array_append(idx->ranges, (RangeIndex *)NULL);
+	} else if(idx->type == IDX_VECTOR) {
+		idx->vectors = array_append(idx->vectors, VectorIndex_New());
+	}
 }
 
 // Removes fields from index.
@@ -107,16 +191,104 @@ void Index_RemoveField(Index *idx, const char *field) {
 			rm_free(idx->fields[i]);
 			array_del_fast(idx->fields, i);
 			array_del_fast(idx->fields_ids, i);
+			if(idx->type == IDX_EXACT_MATCH) {
+				if(idx->ranges[i]) RangeIndex_Free(idx->ranges[i]);
+				array_del_fast(idx->ranges, i);
+			} else if(idx->type == IDX_VECTOR) {
+				VectorIndex_Free(idx->vectors[i]);
+				array_del_fast(idx->vectors, i);
+			}
 			break;
 		}
 	}
+
+	// drop composites keyed on the removed field
+	for(int i = array_len(idx->composites) - 1; i >= 0; i--) {
+		CompositeIndex *ci = idx->composites[i];
+		if(CompositeIndex_KeyPosition(ci, attribute_id) != -1) {
+			CompositeIndex_Free(ci);
+			array_del(idx->composites, i);
+		}
+	}
 }
 
-void Index_IndexNode(Index *idx, const Node *n) {
+int Index_AddComposite(Index *idx, const Attribute_ID *attributes, uint count) {
+	ASSERT(idx != NULL && attributes != NULL);
+	ASSERT(idx->type == IDX_EXACT_MATCH && idx->entity_type == GETYPE_NODE);
+	ASSERT(count > 1 && count <= COMPOSITE_INDEX_MAX_FIELDS);
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex *ci = idx->composites[i];
+		if(ci->key_count == count && memcmp(ci->attributes, attributes,
+					sizeof(Attribute_ID) * count) == 0) {
+			return INDEX_FAIL;
+		}
+	}
+
+	// all key columns must be indexed
+	for(uint i = 0; i < count; i++) {
+		ASSERT(Index_ContainsAttribute(idx, attributes[i]));
+	}
+
+	CompositeIndex *ci = CompositeIndex_New(attributes, count);
+	array_append(idx->composites, ci);
+	return INDEX_OK;
+}
+
+// maintain composite indices, nodes are indexed if all key values are numeric
+static void _IndexComposites(Index *idx, NodeID node_id, const SIValue *values) {
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex *ci = idx->composites[i];
+		bool numeric = true;
+		double keys[COMPOSITE_INDEX_MAX_FIELDS];
+
+		for(uint j = 0; j < ci->key_count && numeric; j++) {
+			// locate key value among indexed fields
+			numeric = false;
+			for(uint k = 0; k < idx->fields_count; k++) {
+				if(idx->fields_ids[k] != ci->attributes[j]) continue;
+				SIValue v = values[k];
+				if(SI_TYPE(v) & SI_NUMERIC) {
+					keys[j] = SI_GET_NUMERIC(v);
+					numeric = true;
+				}
+				break;
+			}
+		}
+
+		if(numeric) CompositeIndex_Insert(ci, node_id, keys);
+		else CompositeIndex_Remove(ci, node_id);
+	}
+}
+
+// maintain vector indices, arrays of numbers only
+static void _IndexVectors(Index *idx, const Node *n) {
+	NodeID node_id = ENTITY_GET_ID(n);
+	float vec[VECTOR_INDEX_MAX_DIM];
+
+	// retrieve all indexed properties at once
+	SIValue values[idx->fields_count];
+	GraphEntity_GetProperties((GraphEntity *)n, idx->fields_ids, idx->fields_count,
+							  values);
+
+	for(uint i = 0; i < idx->fields_count; i++) {
+		uint dim = VectorIndex_ToVector(values[i], vec);
+		VectorIndex_Insert(idx->vectors[i], node_id, vec, dim);
+	}
+}
+
+static void _Index_IndexNode(Index *idx, const Node *n) {
+	if(idx->type == IDX_VECTOR) {
+		_IndexVectors(idx, n);
+		return;
+	}
+
 	double      score            = 1;     // default score
 	const char  *lang            = NULL;  // default language
 	const char  *field_name      = NULL;  // name of current indexed field
-	SIValue     *v               = NULL;  // current indexed value
+	SIValue     v;                        // current indexed value
 	RSIndex     *rsIdx           = idx->idx;
 	NodeID      node_id          = ENTITY_GET_ID(n);
 	uint        doc_field_count  = 0;
@@ -128,41 +300,59 @@ void Index_IndexNode(Index *idx, const Node *n) {
 	// create a document out of node
 	RSDoc *doc = RediSearch_CreateDocument(&node_id, sizeof(EntityID), score, lang);
 
+	// retrieve all indexed properties at once
+	SIValue values[idx->fields_count];
+	GraphEntity_GetProperties((GraphEntity *)n, idx->fields_ids, idx->fields_count,
+							  values);
+
 	// add document field for each indexed property
 	if(idx->type == IDX_FULLTEXT) {
 		for(uint i = 0; i < idx->fields_count; i++) {
 			field_name = idx->fields[i];
-			v = GraphEntity_GetProperty((GraphEntity *)n, idx->fields_ids[i]);
-			if(v == PROPERTY_NOTFOUND) continue;
+			v = values[i];
+			if(SI_TYPE(v) == T_NULL) continue;
 
-			SIType t = SI_TYPE(*v);
+			SIType t = SI_TYPE(v);
 
 			// value must be of type string
 			if(t == T_STRING) {
 				doc_field_count++;
 				RediSearch_DocumentAddFieldString(doc, idx->fields[i], 
-						v->stringval, strlen(v->stringval), RSFLDTYPE_FULLTEXT);
+						v.stringval, strlen(v.stringval), RSFLDTYPE_FULLTEXT);
 			}
 		}
 	} else {
 		for(uint i = 0; i < idx->fields_count; i++) {
 			field_name = idx->fields[i];
-			v = GraphEntity_GetProperty((GraphEntity *)n, idx->fields_ids[i]);
-			if(v == PROPERTY_NOTFOUND) continue;
+			v = values[i];
+
+			// maintain range index, numeric values only
+			RangeIndex *range = idx->ranges[i];
+			if(range != NULL) {
+				if(SI_TYPE(v) & SI_NUMERIC) {
+					RangeIndex_Insert(range, node_id, SI_GET_NUMERIC(v));
+				} else if(SI_TYPE(v) != T_NULL) {
+					RangeIndex_Exclude(range, node_id);
+				} else {
+					RangeIndex_Remove(range, node_id);
+				}
+			}
 
-			SIType t = SI_TYPE(*v);
+			if(SI_TYPE(v) == T_NULL) continue;
+
+			SIType t = SI_TYPE(v);
 
 			doc_field_count++;
 			if(t == T_STRING) {
 				RediSearch_DocumentAddFieldString(doc, idx->fields[i],
-						v->stringval, strlen(v->stringval), RSFLDTYPE_TAG);
+						v.stringval, strlen(v.stringval), RSFLDTYPE_TAG);
 			} else if(t & (SI_NUMERIC | T_BOOL)) {
-				double d = SI_GET_NUMERIC(*v);
+				double d = SI_GET_NUMERIC(v);
 				RediSearch_DocumentAddFieldNumber(doc, field_name, d,
 						RSFLDTYPE_NUMERIC);
 			} else if(t == T_POINT) {
-				double lat = (double)Point_lat(*v);
-				double lon = (double)Point_lon(*v);
+				double lat = (double)Point_lat(v);
+				double lon = (double)Point_lon(v);
 				RediSearch_DocumentAddFieldGeo(doc, field_name, lat, lon,
 						RSFLDTYPE_GEO);
 			} else {
@@ -172,6 +362,8 @@ void Index_IndexNode(Index *idx, const Node *n) {
 			}
 		}
 
+		_IndexComposites(idx, node_id, values);
+
 		// index name of none index fields
 		if(none_indexable_fields_count > 0) {
 			// concat all none indexable field names
@@ -203,15 +395,240 @@ void Index_IndexNode(Index *idx, const Node *n) {
 	else RediSearch_FreeDocument(doc);
 }
 
-void Index_RemoveNode(Index *idx, const Node *n) {
+static void _Index_RemoveNode(Index *idx, NodeID node_id) {
+	if(idx->idx) RediSearch_DeleteDocument(idx->idx, &node_id, sizeof(EntityID));
+
+	uint vector_count = array_len(idx->vectors);
+	for(uint i = 0; i < vector_count; i++) {
+		VectorIndex_Remove(idx->vectors[i], node_id);
+	}
+
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(idx->ranges[i]) RangeIndex_Remove(idx->ranges[i], node_id);
+	}
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex_Remove(idx->composites[i], node_id);
+	}
+}
+
+// background fulltext flush context
+typedef struct {
+	GraphContext *gc;   // graph holding the index, retained
+	char *label;        // indexed label
+	uint64_t build_id;  // construction whose updates are applied
+} IndexFlushCtx;
+
+// re-index the oldest queued nodes, caller holds the graph write lock
+// returns true once the queue is depleted
+static bool _Index_FlushChunk(Index *idx, GraphContext *gc) {
+	Schema *s = GraphContext_GetSchema(gc, idx->label, SCHEMA_NODE);
+	uint count = array_len(idx->pending);
+	uint chunk = MIN(count, FULLTEXT_FLUSH_CHUNK_SIZE);
+
+	Node n = GE_NEW_NODE();
+	for(uint i = 0; i < chunk; i++) {
+		NodeID id = idx->pending[i];
+		_Index_RemoveNode(idx, id);
+		// the node may have been deleted since,
+		// or its ID reused by a node of a different label
+		if(s != NULL && Graph_GetNode(gc->g, id, &n) &&
+		   Graph_GetNodeLabel(gc->g, id) == s->id) {
+			_Index_IndexNode(idx, &n);
+		}
+	}
+
+	memmove(idx->pending, idx->pending + chunk, sizeof(NodeID) * (count - chunk));
+	idx->pending = array_trimm_len(idx->pending, count - chunk);
+
+	if(count > chunk) return false;
+	idx->flushing = false;
+	return true;
+}
+
+// applies queued fulltext updates on a bulk loader thread
+// locks are released in between chunks, such that queries can proceed
+static void _Index_FlushPending(void *args) {
+	ASSERT(args != NULL);
+
+	IndexFlushCtx *ctx = (IndexFlushCtx *)args;
+	GraphContext *gc = ctx->gc;
+
+	bool done = false;
+	while(!done) {
+		Graph_AcquireWriteLock(gc->g);
+
+		// the index may have been dropped or reconstructed since
+		Index *idx = GraphContext_GetIndex(gc, ctx->label, NULL, IDX_FULLTEXT);
+		done = (idx == NULL || idx->build_id != ctx->build_id ||
+				_Index_FlushChunk(idx, gc));
+
+		Graph_ReleaseLock(gc->g);
+	}
+
+	GraphContext_Release(gc);
+	rm_free(ctx->label);
+	rm_free(ctx);
+}
+
+// queues a fulltext update when FULLTEXT_ASYNC is enabled
+// returns false if the update is to be applied right away
+static bool _Index_Defer(Index *idx, NodeID id) {
+	idx->version++;
+
+	// updates are applied in order, once queued all updates are queued
+	// until the queue is depleted
+	bool async;
+	Config_Option_get(Config_FULLTEXT_ASYNC, &async);
+	if(!async && array_len(idx->pending) == 0) return false;
+
+	idx->pending = array_append(idx->pending, id);
+	if(idx->flushing) return true;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	ASSERT(gc != NULL);
+
+	IndexFlushCtx *ctx = rm_malloc(sizeof(IndexFlushCtx));
+	ctx->gc = gc;
+	ctx->label = rm_strdup(idx->label);
+	ctx->build_id = idx->build_id;
+
+	idx->flushing = true;
+	GraphContext_Retain(gc);
+	ThreadPools_AddWorkBulkLoader(_Index_FlushPending, ctx);
+	return true;
+}
+
+void Index_IndexNode(Index *idx, const Node *n) {
 	ASSERT(idx != NULL && n != NULL);
-	NodeID node_id = ENTITY_GET_ID(n);
-	RediSearch_DeleteDocument(idx->idx, &node_id, sizeof(EntityID));
+	ASSERT(idx->entity_type == GETYPE_NODE);
+
+	if(idx->type == IDX_FULLTEXT && _Index_Defer(idx, ENTITY_GET_ID(n))) return;
+	_Index_IndexNode(idx, n);
 }
 
-// Constructs index.
-void Index_Construct(Index *idx) {
+void Index_RemoveNode(Index *idx, NodeID node_id) {
+	ASSERT(idx != NULL);
+
+	if(idx->type == IDX_FULLTEXT && _Index_Defer(idx, node_id)) return;
+	_Index_RemoveNode(idx, node_id);
+}
+
+uint64_t Index_Version(const Index *idx) {
+	ASSERT(idx != NULL);
+	return idx->version;
+}
+
+uint64_t Index_AppliedVersion(const Index *idx) {
 	ASSERT(idx != NULL);
+	return idx->version - array_len(idx->pending);
+}
+
+void Index_IndexEdge(Index *idx, const Edge *e) {
+	ASSERT(idx != NULL && e != NULL);
+	ASSERT(idx->entity_type == GETYPE_EDGE);
+
+	EdgeID edge_id = ENTITY_GET_ID(e);
+
+	// retrieve all indexed properties at once
+	SIValue values[idx->fields_count];
+	GraphEntity_GetProperties((GraphEntity *)e, idx->fields_ids, idx->fields_count,
+							  values);
+
+	// maintain range indices, numeric values only
+	bool indexed = false;
+	for(uint i = 0; i < idx->fields_count; i++) {
+		SIValue v = values[i];
+		RangeIndex *range = idx->ranges[i];
+		if(range == NULL) continue;
+		if(SI_TYPE(v) & SI_NUMERIC) {
+			RangeIndex_Insert(range, edge_id, SI_GET_NUMERIC(v));
+			indexed = true;
+		} else if(SI_TYPE(v) != T_NULL) {
+			RangeIndex_Exclude(range, edge_id);
+		} else {
+			RangeIndex_Remove(range, edge_id);
+		}
+	}
+
+	if(!indexed) return;
+
+	// record edge endpoints
+	uint64_t len = array_len(idx->endpoints);
+	if((edge_id + 1) * 2 > len) {
+		idx->endpoints = array_ensure_len(idx->endpoints, (edge_id + 1) * 2);
+		for(uint64_t i = len; i < (edge_id + 1) * 2; i++) {
+			idx->endpoints[i] = INVALID_ENTITY_ID;
+		}
+	}
+	idx->endpoints[edge_id * 2] = Edge_GetSrcNodeID(e);
+	idx->endpoints[edge_id * 2 + 1] = Edge_GetDestNodeID(e);
+}
+
+void Index_RemoveEdge(Index *idx, const Edge *e) {
+	ASSERT(idx != NULL && e != NULL);
+	ASSERT(idx->entity_type == GETYPE_EDGE);
+
+	EdgeID edge_id = ENTITY_GET_ID(e);
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(idx->ranges[i]) RangeIndex_Remove(idx->ranges[i], edge_id);
+	}
+
+	if(edge_id * 2 < array_len(idx->endpoints)) {
+		idx->endpoints[edge_id * 2] = INVALID_ENTITY_ID;
+		idx->endpoints[edge_id * 2 + 1] = INVALID_ENTITY_ID;
+	}
+}
+
+bool Index_GetEdgeEndpoints(const Index *idx, EdgeID id, NodeID *src,
+		NodeID *dest) {
+	ASSERT(idx != NULL && src != NULL && dest != NULL);
+	ASSERT(idx->entity_type == GETYPE_EDGE);
+
+	if(id * 2 >= array_len(idx->endpoints)) return false;
+	*src = idx->endpoints[id * 2];
+	*dest = idx->endpoints[id * 2 + 1];
+	return *src != INVALID_ENTITY_ID;
+}
+
+// Constructs a relationship index, range indices only.
+static void _Index_ConstructEdgeIndex(Index *idx) {
+	for(uint i = 0; i < idx->fields_count; i++) {
+		if(idx->ranges[i]) RangeIndex_Free(idx->ranges[i]);
+		idx->ranges[i] = RangeIndex_New();
+	}
+	array_clear(idx->endpoints);
+
+	_populateIndex(idx);
+
+	for(uint i = 0; i < idx->fields_count; i++) RangeIndex_Flush(idx->ranges[i]);
+}
+
+// source of construction IDs, telling apart successive constructions
+static uint64_t _build_id = 0;
+
+// background construction context
+typedef struct {
+	GraphContext *gc;   // graph holding the index, retained
+	char *label;        // indexed label
+	uint64_t build_id;  // construction populated by this context
+	NodeID next;        // next node ID to index
+} IndexBuildCtx;
+
+// drop and recreate the index structures, leaving the index empty
+static void _Index_Reset(Index *idx) {
+	ASSERT(idx->entity_type == GETYPE_NODE);
+
+	if(idx->type == IDX_VECTOR) {
+		for(uint i = 0; i < idx->fields_count; i++) {
+			VectorIndex_Free(idx->vectors[i]);
+			idx->vectors[i] = VectorIndex_New();
+		}
+		return;
+	}
 
 	// RediSearch index already exists, re-construct
 	if(idx->idx) {
@@ -255,10 +672,163 @@ void Index_Construct(Index *idx) {
 
 		RediSearch_TagFieldSetSeparator(rsIdx, fieldID, INDEX_SEPARATOR);
 		RediSearch_TagFieldSetCaseSensitive(rsIdx, fieldID, 1);
+
+		// (re)create range indices
+		for(uint i = 0; i < idx->fields_count; i++) {
+			if(idx->ranges[i]) RangeIndex_Free(idx->ranges[i]);
+			idx->ranges[i] = RangeIndex_New();
+		}
+
+		// (re)create composite indices
+		uint composite_count = array_len(idx->composites);
+		for(uint i = 0; i < composite_count; i++) {
+			CompositeIndex *ci = idx->composites[i];
+			idx->composites[i] = CompositeIndex_New(ci->attributes,
+					ci->key_count);
+			CompositeIndex_Free(ci);
+		}
 	}
 
 	idx->idx = rsIdx;
+}
+
+// sort populated range and composite indices
+static void _Index_Flush(Index *idx) {
+	// populated range indices are sorted once
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) RangeIndex_Flush(idx->ranges[i]);
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex_Flush(idx->composites[i]);
+	}
+}
+
+// Constructs index.
+void Index_Construct(Index *idx) {
+	ASSERT(idx != NULL);
+
+	// supersede any construction in progress
+	idx->build_id = __atomic_add_fetch(&_build_id, 1, __ATOMIC_RELAXED);
+	idx->state = IDX_OPERATIONAL;
+
+	if(idx->entity_type == GETYPE_EDGE) {
+		_Index_ConstructEdgeIndex(idx);
+		return;
+	}
+
+	_Index_Reset(idx);
 	_populateIndex(idx);
+	_Index_Flush(idx);
+
+	// the index reflects the current state of the graph,
+	// queued updates are dropped along with their background flush
+	array_clear(idx->pending);
+	idx->flushing = false;
+}
+
+// index the next chunk of nodes, caller holds the graph write lock
+// returns true once the index is populated and operational
+static bool _Index_BuildChunk(Index *idx, GraphContext *gc, NodeID *next) {
+	uint64_t chunk_size;
+	Config_Option_get(Config_INDEX_BUILD_CHUNK_SIZE, &chunk_size);
+	if(!_populateNodeIndex(idx, gc, next, chunk_size)) return false;
+
+	_Index_Flush(idx);
+	idx->state = IDX_OPERATIONAL;
+	return true;
+}
+
+// locate the index populated by 'ctx'
+// NULL if the index was dropped or reconstructed since
+static Index *_Index_BuildTarget(const IndexBuildCtx *ctx) {
+	Index *idx = GraphContext_GetIndex(ctx->gc, ctx->label, NULL,
+			IDX_EXACT_MATCH);
+	if(idx == NULL || idx->build_id != ctx->build_id) return NULL;
+	return idx;
+}
+
+// populates an index chunk by chunk on a bulk loader thread
+// locks are released in between chunks, such that queries can proceed
+static void _Index_BuildChunks(void *args) {
+	ASSERT(args != NULL);
+
+	IndexBuildCtx *ctx = (IndexBuildCtx *)args;
+	GraphContext *gc = ctx->gc;
+
+	bool done = false;
+	while(!done) {
+		// writers maintain indices under the graph's write lock,
+		// the keyspace isn't touched, the GIL isn't required
+		Graph_AcquireWriteLock(gc->g);
+
+		Index *idx = _Index_BuildTarget(ctx);
+		done = (idx == NULL || _Index_BuildChunk(idx, gc, &ctx->next));
+
+		Graph_ReleaseLock(gc->g);
+	}
+
+	GraphContext_Release(gc);
+	rm_free(ctx->label);
+	rm_free(ctx);
+}
+
+void Index_ConstructAsync(Index *idx) {
+	ASSERT(idx != NULL);
+	ASSERT(idx->entity_type == GETYPE_NODE && idx->type == IDX_EXACT_MATCH);
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+
+	_Index_Reset(idx);
+	idx->state = IDX_UNDER_CONSTRUCTION;
+	idx->build_id = __atomic_add_fetch(&_build_id, 1, __ATOMIC_RELAXED);
+
+	// the caller holds the write lock, index the first chunk right away
+	NodeID next = 0;
+	if(_Index_BuildChunk(idx, gc, &next)) return;
+
+	// populate the remaining nodes in the background
+	IndexBuildCtx *ctx = rm_malloc(sizeof(IndexBuildCtx));
+	ctx->gc = gc;
+	ctx->label = rm_strdup(idx->label);
+	ctx->build_id = idx->build_id;
+	ctx->next = next;
+
+	GraphContext_Retain(gc);
+	ThreadPools_AddWorkBulkLoader(_Index_BuildChunks, ctx);
+}
+
+void Index_DeferMerges(Index *idx) {
+	ASSERT(idx != NULL);
+
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(idx->ranges[i]) RangeIndex_DeferMerges(idx->ranges[i]);
+	}
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex_DeferMerges(idx->composites[i]);
+	}
+}
+
+void Index_ResumeMerges(Index *idx) {
+	ASSERT(idx != NULL);
+
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(idx->ranges[i]) RangeIndex_ResumeMerges(idx->ranges[i]);
+	}
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex_ResumeMerges(idx->composites[i]);
+	}
+}
+
+bool Index_Enabled(const Index *idx) {
+	ASSERT(idx != NULL);
+	return idx->state == IDX_OPERATIONAL;
 }
 
 // Query index.
@@ -295,6 +865,56 @@ bool Index_ContainsAttribute(const Index *idx, Attribute_ID attribute_id) {
 	return false;
 }
 
+RangeIndex *Index_GetRangeIndex(const Index *idx, Attribute_ID attribute_id) {
+	ASSERT(idx != NULL);
+	if(idx->type != IDX_EXACT_MATCH) return NULL;
+
+	for(uint i = 0; i < idx->fields_count; i++) {
+		if(idx->fields_ids[i] == attribute_id) return idx->ranges[i];
+	}
+
+	return NULL;
+}
+
+VectorIndex *Index_GetVectorIndex(const Index *idx, Attribute_ID attribute_id) {
+	ASSERT(idx != NULL);
+	if(idx->type != IDX_VECTOR) return NULL;
+
+	for(uint i = 0; i < idx->fields_count; i++) {
+		if(idx->fields_ids[i] == attribute_id) return idx->vectors[i];
+	}
+
+	return NULL;
+}
+
+CompositeIndex **Index_GetCompositeIndices(const Index *idx) {
+	ASSERT(idx != NULL);
+	return idx->composites;
+}
+
+size_t Index_MemoryUsage(const Index *idx) {
+	ASSERT(idx != NULL);
+
+	size_t usage = sizeof(Index) + array_sizeof(array_hdr(idx->endpoints));
+
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(idx->ranges[i]) usage += RangeIndex_MemoryUsage(idx->ranges[i]);
+	}
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		usage += CompositeIndex_MemoryUsage(idx->composites[i]);
+	}
+
+	uint vector_count = array_len(idx->vectors);
+	for(uint i = 0; i < vector_count; i++) {
+		usage += VectorIndex_MemoryUsage(idx->vectors[i]);
+	}
+
+	return usage;
+}
+
 // Free index.
 void Index_Free(Index *idx) {
 	ASSERT(idx != NULL);
@@ -309,6 +929,26 @@ void Index_Free(Index *idx) {
 	array_free(idx->fields);
 	array_free(idx->fields_ids);
 
+	uint range_count = array_len(idx->ranges);
+	for(uint i = 0; i < range_count; i++) {
+		if(idx->ranges[i]) RangeIndex_Free(idx->ranges[i]);
+	}
+	array_free(idx->ranges);
+
+	uint composite_count = array_len(idx->composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex_Free(idx->composites[i]);
+	}
+	array_free(idx->composites);
+
+	uint vector_count = array_len(idx->vectors);
+	for(uint i = 0; i < vector_count; i++) {
+		VectorIndex_Free(idx->vectors[i]);
+	}
+	array_free(idx->vectors);
+	array_free(idx->endpoints);
+	array_free(idx->pending);
+
 	rm_free(idx);
 }
 
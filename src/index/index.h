@@ -7,7 +7,11 @@
 #pragma once
 
 #include "../graph/entities/node.h"
+#include "../graph/entities/edge.h"
 #include "../graph/entities/graph_entity.h"
+#include "range_index.h"
+#include "composite_index.h"
+#include "vector_index.h"
 #include "redisearch_api.h"
 
 #define INDEX_OK 1
@@ -19,24 +23,50 @@ typedef enum {
 	IDX_ANY = 0,
 	IDX_EXACT_MATCH = 1,
 	IDX_FULLTEXT = 2,
+	IDX_COMPOSITE = 3,  // ordered key over exact-match fields
+	IDX_VECTOR = 4,     // similarity over array fields
+	IDX_UNIQUE = 5,     // uniqueness constraint over a single field
 } IndexType;
 
+typedef enum {
+	IDX_OPERATIONAL = 0,         // index is populated, utilized by queries
+	IDX_UNDER_CONSTRUCTION = 1,  // index is being populated, ignored by the planner
+} IndexState;
+
+/* Relationship indices are exact-match indices over a relationship type.
+ * They don't maintain a RediSearch index, only a numeric range index per field
+ * keyed by edge ID, along with the endpoints of each indexed edge, such that
+ * traversals can be seeded from matching edges.
+ *
+ * Vector indices don't maintain a RediSearch index either,
+ * only a vector index per field, see vector_index.h. */
 typedef struct {
-	char *label;                // Indexed label.
+	char *label;                // Indexed label or relationship type.
 	char **fields;              // Indexed fields.
 	Attribute_ID *fields_ids;   // Indexed field IDs.
 	uint fields_count;          // Number of fields.
-	RSIndex *idx;               // RediSearch index.
+	RSIndex *idx;               // RediSearch index, node indices only.
+	RangeIndex **ranges;        // Per field numeric range index, exact-match only.
+	CompositeIndex **composites;  // Composite numeric indices, exact-match only.
+	VectorIndex **vectors;      // Per field vector index, vector only.
+	NodeID *endpoints;          // Source and destination of each indexed edge, by edge ID.
 	IndexType type;             // Index type exact-match / fulltext.
+	GraphEntityType entity_type;  // Indexed entity type, node / edge.
+	IndexState state;           // Operational / under construction.
+	uint64_t build_id;          // Identifies the latest construction of the index.
+	NodeID *pending;            // Nodes awaiting re-indexing, fulltext only, oldest first.
+	uint64_t version;           // Number of updates requested, fulltext only.
+	bool flushing;              // Pending updates are being applied in the background.
 } Index;
 
 /**
  * @brief  Create a new index.
- * @param  *label: Indexed label
+ * @param  *label: Indexed label or relationship type.
  * @param  type: Index type - exact match or full text.
+ * @param  entity_type: Indexed entity type, relationships support exact match only.
  * @retval New constructed index for the label.
  */
-Index *Index_New(const char *label, IndexType type);
+Index *Index_New(const char *label, IndexType type, GraphEntityType entity_type);
 
 /**
  * @brief  Adds field to index.
@@ -52,8 +82,20 @@ void Index_AddField(Index *idx, const char *field);
  */
 void Index_RemoveField(Index *idx, const char *field);
 
+/**
+ * @brief  Introduces a composite key over indexed fields.
+ * @note   Composite is populated once the index is constructed.
+ * @param  *idx: Exact-match index holding all key fields.
+ * @param  *attributes: Key attributes, in order.
+ * @param  count: Number of key attributes.
+ * @retval INDEX_OK if composite was introduced, INDEX_FAIL if it exists.
+ */
+int Index_AddComposite(Index *idx, const Attribute_ID *attributes, uint count);
+
 /**
  * @brief  Index node.
+ * @note   When FULLTEXT_ASYNC is enabled fulltext updates are queued
+ *         and applied on a bulk loader thread, see Index_AppliedVersion.
  * @param  *idx: Index
  * @param  *n :Node
  */
@@ -62,9 +104,35 @@ void Index_IndexNode(Index *idx, const Node *n);
 /**
  * @brief  Remove node from index.
  * @param  *idx: Index to remove the node from.
- * @param  *n: Node to remove.
+ * @param  id: ID of the node to remove.
+ */
+void Index_RemoveNode(Index *idx, NodeID node_id);
+
+/**
+ * @brief  Index edge, relationship index only.
+ * @param  *idx: Index
+ * @param  *e: Edge, holding its endpoints.
  */
-void Index_RemoveNode(Index *idx, const Node *n);
+void Index_IndexEdge(Index *idx, const Edge *e);
+
+/**
+ * @brief  Remove edge from relationship index.
+ * @param  *idx: Index to remove the edge from.
+ * @param  *e: Edge to remove.
+ */
+void Index_RemoveEdge(Index *idx, const Edge *e);
+
+/**
+ * @brief  Retrieves the endpoints an edge was indexed with.
+ * @note   Edges deleted along with their endpoints aren't removed from the index,
+ *         callers must validate reported edges against the graph.
+ * @param  *idx: Relationship index.
+ * @param  id: Indexed edge ID.
+ * @param  *src: Set to the edge source node ID.
+ * @param  *dest: Set to the edge destination node ID.
+ * @retval True if the edge is indexed.
+ */
+bool Index_GetEdgeEndpoints(const Index *idx, EdgeID id, NodeID *src, NodeID *dest);
 
 /**
  * @brief  Constructs index.
@@ -72,6 +140,49 @@ void Index_RemoveNode(Index *idx, const Node *n);
  */
 void Index_Construct(Index *idx);
 
+/**
+ * @brief  Constructs node exact-match index in chunks of INDEX_BUILD_CHUNK_SIZE nodes.
+ * @note   The caller must hold the graph write lock, under which the first chunk
+ *         is indexed. Remaining chunks are indexed on a bulk loader thread,
+ *         each under a short lock window, during which the index is maintained
+ *         by writers as usual but is under construction and ignored by the planner.
+ * @param  *idx: Index to construct.
+ */
+void Index_ConstructAsync(Index *idx);
+
+/**
+ * @brief  Defers range and composite index merges while applying a batch of updates.
+ * @note   Merges are resumed by Index_ResumeMerges, before the index is queried.
+ * @param  *idx: Index.
+ */
+void Index_DeferMerges(Index *idx);
+
+/**
+ * @brief  Resumes merges deferred by Index_DeferMerges.
+ * @param  *idx: Index.
+ */
+void Index_ResumeMerges(Index *idx);
+
+/**
+ * @brief  Returns true if the index is operational, false while under construction.
+ * @param  *idx: Index.
+ */
+bool Index_Enabled(const Index *idx);
+
+/**
+ * @brief  Returns the number of updates requested from a fulltext index.
+ * @param  *idx: Index.
+ */
+uint64_t Index_Version(const Index *idx);
+
+/**
+ * @brief  Returns the number of updates a fulltext index reflects,
+ *         updates are applied in order, such that every update up to
+ *         the returned version is reflected by the index.
+ * @param  *idx: Index.
+ */
+uint64_t Index_AppliedVersion(const Index *idx);
+
 /**
  * @brief  Query an index.
  * @param  *idx: Index.
@@ -81,6 +192,29 @@ void Index_Construct(Index *idx);
  */
 RSResultsIterator *Index_Query(const Index *idx, const char *query, char **err);
 
+/**
+ * @brief  Returns the numeric range index of an indexed attribute.
+ * @param  *idx: Index.
+ * @param  attribute_id: Indexed attribute id.
+ * @retval Range index, NULL if attribute isn't range indexed.
+ */
+RangeIndex *Index_GetRangeIndex(const Index *idx, Attribute_ID attribute_id);
+
+/**
+ * @brief  Returns the vector index of an indexed attribute.
+ * @param  *idx: Index.
+ * @param  attribute_id: Indexed attribute id.
+ * @retval Vector index, NULL if attribute isn't vector indexed.
+ */
+VectorIndex *Index_GetVectorIndex(const Index *idx, Attribute_ID attribute_id);
+
+/**
+ * @brief  Returns the composite indices of an exact-match index.
+ * @param  *idx: Index.
+ * @retval Array of composite indices, owned by the index.
+ */
+CompositeIndex **Index_GetCompositeIndices(const Index *idx);
+
 /**
  * @brief Return indexed label.
  * @param  *idx: Index.
@@ -111,6 +245,14 @@ const char **Index_GetFields(const Index *idx);
  */
 bool Index_ContainsAttribute(const Index *idx, Attribute_ID attribute_id);
 
+/**
+ * @brief  Returns an estimate of the number of bytes held by the index.
+ * @note   Memory held by the RediSearch index isn't accounted for.
+ * @param  *idx: Index to measure.
+ * @retval Number of bytes.
+ */
+size_t Index_MemoryUsage(const Index *idx);
+
 /**
  * @brief  Free fulltext index.
  * @param  *idx: Index to drop.
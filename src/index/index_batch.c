@@ -0,0 +1,86 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "index_batch.h"
+#include "RG.h"
+#include "../util/arr.h"
+#include "../util/qsort.h"
+
+// orders entries by (label, removals first, id)
+#define ENTRY_ISLT(a, b) ((a)->label_id < (b)->label_id || \
+		((a)->label_id == (b)->label_id && ((a)->remove > (b)->remove || \
+		((a)->remove == (b)->remove && (a)->id < (b)->id))))
+
+static inline void _AddEntry(IndexBatch *batch, int label_id, NodeID id, bool remove) {
+	ASSERT(batch != NULL);
+	ASSERT(label_id != GRAPH_NO_LABEL);
+
+	if(batch->entries == NULL) batch->entries = array_new(IndexBatchEntry, 32);
+	IndexBatchEntry e = {.label_id = label_id, .id = id, .remove = remove};
+	array_append(batch->entries, e);
+}
+
+void IndexBatch_AddNode(IndexBatch *batch, int label_id, NodeID id) {
+	_AddEntry(batch, label_id, id, false);
+}
+
+void IndexBatch_RemoveNode(IndexBatch *batch, int label_id, NodeID id) {
+	_AddEntry(batch, label_id, id, true);
+}
+
+// prepare schema indices for a batch of updates
+static inline void _BeginSchema(Schema *s) {
+	if(s->index) Index_DeferMerges(s->index);
+}
+
+static inline void _EndSchema(Schema *s) {
+	if(s->index) Index_ResumeMerges(s->index);
+}
+
+void IndexBatch_Apply(IndexBatch *batch, GraphContext *gc) {
+	ASSERT(batch != NULL && gc != NULL);
+
+	if(batch->entries == NULL) return;
+	uint32_t count = array_len(batch->entries);
+	QSORT(IndexBatchEntry, batch->entries, count, ENTRY_ISLT);
+
+	Schema *s = NULL;
+	Node n = GE_NEW_NODE();
+	for(uint32_t i = 0; i < count; i++) {
+		IndexBatchEntry *e = batch->entries + i;
+
+		// repeated requests remove or index the node once
+		if(i > 0 && e->label_id == e[-1].label_id && e->id == e[-1].id &&
+		   e->remove == e[-1].remove) continue;
+
+		if(s == NULL || s->id != e->label_id) {
+			if(s != NULL) _EndSchema(s);
+			s = GraphContext_GetSchemaByID(gc, e->label_id, SCHEMA_NODE);
+			ASSERT(s != NULL);
+			_BeginSchema(s);
+		}
+
+		if(e->remove) {
+			Schema_RemoveNodeFromIndices(s, e->id);
+			continue;
+		}
+
+		// node may have been deleted since the request
+		if(!Graph_GetNode(gc->g, e->id, &n)) continue;
+		Schema_AddNodeToIndices(s, &n);
+	}
+	if(s != NULL) _EndSchema(s);
+
+	array_clear(batch->entries);
+}
+
+void IndexBatch_Free(IndexBatch *batch) {
+	ASSERT(batch != NULL);
+	if(batch->entries) {
+		array_free(batch->entries);
+		batch->entries = NULL;
+	}
+}
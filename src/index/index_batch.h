@@ -0,0 +1,61 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../graph/graphcontext.h"
+#include "../graph/entities/node.h"
+
+// node pending (re)indexing or removal
+typedef struct {
+	int label_id;  // node label
+	NodeID id;     // node ID
+	bool remove;   // remove the node rather than index it
+} IndexBatchEntry;
+
+// index maintenance requests issued by a writer during commit
+// applied at once, by IndexBatch_Apply, once the writer modified the graph
+//
+// nodes are indexed from their state at the time the batch is applied
+// such that repeated updates to the same node index it once
+//
+// removals precede indexing, a deleted node's ID may be reused
+// by a node created thereafter, which is indexed in its place
+typedef struct {
+	IndexBatchEntry *entries;  // pending requests, NULL until the first request
+} IndexBatch;
+
+// request node 'id' to be (re)indexed under 'label_id' indices
+void IndexBatch_AddNode
+(
+	IndexBatch *batch,  // batch
+	int label_id,       // node label
+	NodeID id           // node ID
+);
+
+// request node 'id' to be removed from 'label_id' indices
+// the node may be deleted from the graph before the batch is applied
+void IndexBatch_RemoveNode
+(
+	IndexBatch *batch,  // batch
+	int label_id,       // node label
+	NodeID id           // node ID
+);
+
+// remove and index each pending node once, by ascending label and node ID
+// caller holds the graph write lock, the batch is emptied
+void IndexBatch_Apply
+(
+	IndexBatch *batch,  // batch to apply
+	GraphContext *gc    // graph context
+);
+
+// free batch internals
+void IndexBatch_Free
+(
+	IndexBatch *batch  // batch to free
+);
+
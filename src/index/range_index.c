@@ -0,0 +1,430 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "range_index.h"
+#include "RG.h"
+#include "../util/arr.h"
+#include "../util/qsort.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+
+// marks a removed run entry, node ids never reach the most significant bit
+#define RANGE_INDEX_REMOVED ((NodeID)1 << 63)
+#define ENTRY_ID(e) ((e)->id & ~RANGE_INDEX_REMOVED)
+#define ENTRY_REMOVED(e) ((e)->id & RANGE_INDEX_REMOVED)
+
+#define ENTRY_ISLT(a, b) ((a)->key < (b)->key || \
+	((a)->key == (b)->key && ENTRY_ID(a) < ENTRY_ID(b)))
+#define ID_ISLT(a, b) (*(a) < *(b))
+
+//------------------------------------------------------------------------------
+// Run lookup
+//------------------------------------------------------------------------------
+
+static inline bool _Precedes(double k, double key, bool upper) {
+	return (upper) ? k <= key : k < key;
+}
+
+// returns the position of the first run entry which doesn't precede 'key'
+// upper = false: first entry with entry.key >= key
+// upper = true:  first entry with entry.key >  key
+static uint64_t _Bound(const RangeIndex *ri, double key, bool upper) {
+	uint64_t lo = 0;
+	uint64_t hi = array_len(ri->fences);
+	uint64_t fence_count = hi;
+
+	// locate the first fence which doesn't precede key
+	while(lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		if(_Precedes(ri->fences[mid], key, upper)) lo = mid + 1;
+		else hi = mid;
+	}
+
+	// bound lies within the block preceding that fence
+	uint64_t end = (lo == fence_count) ? array_len(ri->run) :
+		lo * RANGE_INDEX_FENCE_INTERVAL;
+	lo = (lo == 0) ? 0 : (lo - 1) * RANGE_INDEX_FENCE_INTERVAL + 1;
+	hi = end;
+
+	while(lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		if(_Precedes(ri->run[mid].key, key, upper)) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return lo;
+}
+
+// returns the position of the first run entry which doesn't precede (key, id)
+static uint64_t _RunPosition(const RangeIndex *ri, double key, NodeID id) {
+	uint64_t lo = _Bound(ri, key, false);
+	uint64_t hi = _Bound(ri, key, true);
+
+	// entries sharing a key are ordered by id
+	while(lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		if(ENTRY_ID(ri->run + mid) < id) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return lo;
+}
+
+// returns the run position of (key, id), -1 if missing
+// removed entries are located as well
+static int64_t _RunFind(const RangeIndex *ri, double key, NodeID id) {
+	uint64_t lo = _RunPosition(ri, key, id);
+
+	if(lo < array_len(ri->run) && ri->run[lo].key == key &&
+			ENTRY_ID(ri->run + lo) == id) {
+		return lo;
+	}
+	return -1;
+}
+
+// merge the delta into the run, dropping removed entries
+static void _Merge(RangeIndex *ri) {
+	uint32_t delta_len = array_len(ri->delta);
+	if(delta_len == 0 && ri->removed == 0) return;
+
+	QSORT(RangeIndexEntry, ri->delta, delta_len, ENTRY_ISLT);
+
+	uint32_t run_len = array_len(ri->run);
+	RangeIndexEntry *run = array_newlen(RangeIndexEntry,
+			run_len - ri->removed + delta_len);
+
+	uint64_t i = 0;  // run position
+	uint64_t j = 0;  // delta position
+	uint64_t k = 0;  // merged position
+	while(i < run_len || j < delta_len) {
+		RangeIndexEntry *e;
+		if(j == delta_len ||
+				(i < run_len && ENTRY_ISLT(ri->run + i, ri->delta + j))) {
+			e = ri->run + i++;
+			if(ENTRY_REMOVED(e)) continue;
+		} else {
+			e = ri->delta + j++;
+		}
+		run[k++] = *e;
+	}
+	ASSERT(k == array_len(run));
+
+	array_free(ri->run);
+	ri->run = run;
+	ri->removed = 0;
+	array_clear(ri->delta);
+
+	// rebuild fences
+	array_clear(ri->fences);
+	for(uint64_t f = 0; f < k; f += RANGE_INDEX_FENCE_INTERVAL) {
+		array_append(ri->fences, run[f].key);
+	}
+}
+
+static inline bool _Contains(const NumericRange *range, double key) {
+	if(range->min != -INFINITY) {
+		if(range->include_min ? key < range->min : key <= range->min) {
+			return false;
+		}
+	}
+	if(range->max != INFINITY) {
+		if(range->include_max ? key > range->max : key >= range->max) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// clear the exclusion mark of node 'id'
+static inline void _Unexclude(RangeIndex *ri, NodeID id) {
+	if(raxSize(ri->excluded) == 0) return;
+	raxRemove(ri->excluded, (unsigned char *)&id, sizeof(id), NULL);
+}
+
+//------------------------------------------------------------------------------
+// API
+//------------------------------------------------------------------------------
+
+RangeIndex *RangeIndex_New(void) {
+	RangeIndex *ri = rm_malloc(sizeof(RangeIndex));
+
+	ri->run      =  array_new(RangeIndexEntry, 0);
+	ri->fences   =  array_new(double, 0);
+	ri->delta    =  array_new(RangeIndexEntry, 0);
+	ri->values   =  array_new(double, 0);
+	ri->excluded =  raxNew();
+	ri->count    =  0;
+	ri->removed  =  0;
+	ri->loading  =  true;
+	ri->batching =  false;
+
+	return ri;
+}
+
+void RangeIndex_Insert(RangeIndex *ri, NodeID id, double key) {
+	ASSERT(ri != NULL);
+	ASSERT(!(id & RANGE_INDEX_REMOVED));
+
+	// NaN doesn't compare, treat as a non numeric value
+	if(isnan(key)) {
+		RangeIndex_Exclude(ri, id);
+		return;
+	}
+
+	_Unexclude(ri, id);
+
+	uint32_t values_len = array_len(ri->values);
+	if(id >= values_len) {
+		ri->values = (double *)array_ensure_len(ri->values, id + 1);
+		for(uint64_t i = values_len; i <= id; i++) ri->values[i] = NAN;
+	}
+
+	double prev = ri->values[id];
+	if(prev == key) return;  // already indexed
+	if(!isnan(prev)) RangeIndex_Remove(ri, id);
+
+	ri->values[id] = key;
+	ri->count++;
+
+	// revive a previously removed run entry
+	int64_t pos = _RunFind(ri, key, id);
+	if(pos != -1) {
+		ASSERT(ENTRY_REMOVED(ri->run + pos));
+		ri->run[pos].id = id;
+		ri->removed--;
+		return;
+	}
+
+	RangeIndexEntry e = {.key = key, .id = id};
+	array_append(ri->delta, e);
+	if(!ri->loading && array_len(ri->delta) >= RANGE_INDEX_DELTA_CAP) {
+		_Merge(ri);
+	}
+}
+
+void RangeIndex_Remove(RangeIndex *ri, NodeID id) {
+	ASSERT(ri != NULL);
+
+	_Unexclude(ri, id);
+	if(id >= array_len(ri->values) || isnan(ri->values[id])) return;
+
+	double key = ri->values[id];
+	ri->values[id] = NAN;
+	ri->count--;
+
+	int64_t pos = _RunFind(ri, key, id);
+	if(pos != -1 && !ENTRY_REMOVED(ri->run + pos)) {
+		ri->run[pos].id |= RANGE_INDEX_REMOVED;
+		ri->removed++;
+		// compact once most of the run is removed
+		if(!ri->loading && ri->removed > RANGE_INDEX_DELTA_CAP &&
+				ri->removed > array_len(ri->run) / 2) {
+			_Merge(ri);
+		}
+		return;
+	}
+
+	uint32_t delta_len = array_len(ri->delta);
+	for(uint32_t i = 0; i < delta_len; i++) {
+		if(ri->delta[i].id == id) {
+			array_del_fast(ri->delta, i);
+			return;
+		}
+	}
+
+	ASSERT(false && "indexed value is missing");
+}
+
+void RangeIndex_Exclude(RangeIndex *ri, NodeID id) {
+	ASSERT(ri != NULL);
+
+	RangeIndex_Remove(ri, id);
+	raxInsert(ri->excluded, (unsigned char *)&id, sizeof(id), NULL, NULL);
+}
+
+void RangeIndex_Flush(RangeIndex *ri) {
+	ASSERT(ri != NULL);
+	ri->loading = false;
+	_Merge(ri);
+}
+
+void RangeIndex_DeferMerges(RangeIndex *ri) {
+	ASSERT(ri != NULL);
+	if(ri->loading) return;
+	ri->batching = true;
+	ri->loading = true;
+}
+
+void RangeIndex_ResumeMerges(RangeIndex *ri) {
+	ASSERT(ri != NULL);
+	if(!ri->batching) return;
+
+	ri->batching = false;
+	ri->loading = false;
+	if(array_len(ri->delta) >= RANGE_INDEX_DELTA_CAP ||
+			(ri->removed > RANGE_INDEX_DELTA_CAP &&
+			 ri->removed > array_len(ri->run) / 2)) {
+		_Merge(ri);
+	}
+}
+
+NodeID *RangeIndex_Query(const RangeIndex *ri, const NumericRange *range) {
+	ASSERT(ri != NULL && range != NULL);
+
+	if(!NumericRange_IsValid(range)) return array_new(NodeID, 0);
+
+	uint64_t begin = (range->min == -INFINITY) ? 0 :
+		_Bound(ri, range->min, !range->include_min);
+	uint64_t end = (range->max == INFINITY) ? array_len(ri->run) :
+		_Bound(ri, range->max, range->include_max);
+	if(end < begin) end = begin;
+
+	uint32_t delta_len = array_len(ri->delta);
+	NodeID *ids = array_new(NodeID, (end - begin) + delta_len);
+
+	for(uint64_t i = begin; i < end; i++) {
+		const RangeIndexEntry *e = ri->run + i;
+		if(!ENTRY_REMOVED(e)) array_append(ids, e->id);
+	}
+
+	for(uint32_t i = 0; i < delta_len; i++) {
+		const RangeIndexEntry *e = ri->delta + i;
+		if(_Contains(range, e->key)) array_append(ids, e->id);
+	}
+
+	// report nodes in id order, matching the graph's storage order
+	QSORT(NodeID, ids, array_len(ids), ID_ISLT);
+	return ids;
+}
+
+NodeID *RangeIndex_QueryOrdered(const RangeIndex *ri,
+		const NumericRange *range, bool desc, const NodeID *after,
+		uint64_t cap) {
+	ASSERT(ri != NULL && range != NULL);
+
+	NodeID *ids = array_new(NodeID, 0);
+	if(!NumericRange_IsValid(range) || cap == 0) return ids;
+
+	uint64_t begin = (range->min == -INFINITY) ? 0 :
+		_Bound(ri, range->min, !range->include_min);
+	uint64_t end = (range->max == INFINITY) ? array_len(ri->run) :
+		_Bound(ri, range->max, range->include_max);
+
+	// resume past the last reported entry
+	RangeIndexEntry last;
+	if(after != NULL) {
+		ASSERT(*after < array_len(ri->values) && !isnan(ri->values[*after]));
+		last.key = ri->values[*after];
+		last.id = *after;
+		if(desc) end = MIN(end, _RunPosition(ri, last.key, last.id));
+		else begin = MAX(begin, _RunPosition(ri, last.key, last.id + 1));
+	}
+	if(end < begin) end = begin;
+
+	// pending insertions within range and past the last reported entry
+	uint32_t delta_len = array_len(ri->delta);
+	RangeIndexEntry *delta = array_new(RangeIndexEntry, 0);
+	for(uint32_t i = 0; i < delta_len; i++) {
+		const RangeIndexEntry *e = ri->delta + i;
+		if(!_Contains(range, e->key)) continue;
+		if(after != NULL &&
+				(desc ? !ENTRY_ISLT(e, &last) : !ENTRY_ISLT(&last, e))) {
+			continue;
+		}
+		array_append(delta, *e);
+	}
+	uint32_t match_len = array_len(delta);
+	QSORT(RangeIndexEntry, delta, match_len, ENTRY_ISLT);
+
+	// merge run and delta matches in order, up to cap entries
+	uint64_t i = 0;  // number of run entries consumed
+	uint32_t j = 0;  // number of delta entries consumed
+	uint64_t run_len = end - begin;
+	while(array_len(ids) < cap && (i < run_len || j < match_len)) {
+		const RangeIndexEntry *r = NULL;
+		const RangeIndexEntry *d = NULL;
+		if(i < run_len) r = ri->run + (desc ? end - 1 - i : begin + i);
+		if(j < match_len) d = delta + (desc ? match_len - 1 - j : j);
+
+		bool take_run = (d == NULL ||
+				(r != NULL && (desc ? ENTRY_ISLT(d, r) : ENTRY_ISLT(r, d))));
+		if(take_run) {
+			i++;
+			if(ENTRY_REMOVED(r)) continue;
+			array_append(ids, r->id);
+		} else {
+			j++;
+			array_append(ids, d->id);
+		}
+	}
+
+	array_free(delta);
+	return ids;
+}
+
+bool RangeIndex_Extreme(const RangeIndex *ri, bool max, NodeID *id) {
+	ASSERT(ri != NULL && id != NULL);
+
+	if(ri->count == 0) return false;
+
+	// first or last live run entry
+	const RangeIndexEntry *extreme = NULL;
+	uint64_t run_len = array_len(ri->run);
+	for(uint64_t i = 0; i < run_len; i++) {
+		const RangeIndexEntry *e = ri->run + (max ? run_len - 1 - i : i);
+		if(!ENTRY_REMOVED(e)) {
+			extreme = e;
+			break;
+		}
+	}
+
+	// pending insertions aren't sorted
+	uint32_t delta_len = array_len(ri->delta);
+	for(uint32_t i = 0; i < delta_len; i++) {
+		const RangeIndexEntry *e = ri->delta + i;
+		if(extreme == NULL ||
+				(max ? ENTRY_ISLT(extreme, e) : ENTRY_ISLT(e, extreme))) {
+			extreme = e;
+		}
+	}
+
+	ASSERT(extreme != NULL);
+	*id = ENTRY_ID(extreme);
+	return true;
+}
+
+uint64_t RangeIndex_ExcludedCount(const RangeIndex *ri) {
+	ASSERT(ri != NULL);
+	return raxSize(ri->excluded);
+}
+
+uint64_t RangeIndex_Count(const RangeIndex *ri) {
+	ASSERT(ri != NULL);
+	return ri->count;
+}
+
+size_t RangeIndex_MemoryUsage(const RangeIndex *ri) {
+	ASSERT(ri != NULL);
+	// excluded nodes are accounted for by their keys alone
+	return sizeof(RangeIndex) +
+		   array_sizeof(array_hdr(ri->run)) +
+		   array_sizeof(array_hdr(ri->fences)) +
+		   array_sizeof(array_hdr(ri->delta)) +
+		   array_sizeof(array_hdr(ri->values)) +
+		   sizeof(NodeID) * raxSize(ri->excluded);
+}
+
+void RangeIndex_Free(RangeIndex *ri) {
+	ASSERT(ri != NULL);
+
+	array_free(ri->run);
+	array_free(ri->fences);
+	array_free(ri->delta);
+	array_free(ri->values);
+	raxFree(ri->excluded);
+	rm_free(ri);
+}
+
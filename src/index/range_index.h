@@ -0,0 +1,158 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../graph/entities/node.h"
+#include "../util/range/numeric_range.h"
+#include "rax.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// number of run entries between two consecutive fence pointers
+#define RANGE_INDEX_FENCE_INTERVAL 64
+
+// number of pending insertions which trigger a merge into the sorted run
+#define RANGE_INDEX_DELTA_CAP 4096
+
+// a single indexed value
+typedef struct {
+	double key;  // indexed value
+	NodeID id;   // indexed node, INVALID_ENTITY_ID if removed
+} RangeIndexEntry;
+
+// ordered index over a single numeric attribute
+//
+// entries live in a run sorted by (key, id)
+// every RANGE_INDEX_FENCE_INTERVAL-th key is copied into a fence array
+// such that lookups binary search a small cache resident array
+// before touching the run itself
+//
+// insertions are appended to an unsorted delta which is merged into the run
+// once it grows past RANGE_INDEX_DELTA_CAP, removals mark run entries
+//
+// nodes holding a value outside of the index, e.g. a string,
+// are tracked such that it is known whether the index covers every value
+//
+// the index is modified under the graph write lock and queried
+// under the graph read lock, queries never modify the index
+typedef struct {
+	RangeIndexEntry *run;    // entries sorted by (key, id)
+	double *fences;          // key of every RANGE_INDEX_FENCE_INTERVAL-th run entry
+	RangeIndexEntry *delta;  // unsorted recent insertions
+	double *values;          // indexed value of each node id, NAN if absent
+	uint64_t removed;        // number of removed run entries
+	uint64_t count;          // number of indexed nodes
+	rax *excluded;           // nodes holding a value which isn't indexed
+	bool loading;            // defer merges until RangeIndex_Flush
+	bool batching;           // merges deferred by RangeIndex_DeferMerges
+} RangeIndex;
+
+// create a new, empty range index
+// merges are deferred until the first call to RangeIndex_Flush
+RangeIndex *RangeIndex_New(void);
+
+// index node 'id' under 'key'
+// replaces any value previously indexed for 'id'
+void RangeIndex_Insert
+(
+	RangeIndex *ri,  // range index
+	NodeID id,       // node to index
+	double key       // indexed value
+);
+
+// remove node 'id' from the index
+// NOP if 'id' isn't indexed
+void RangeIndex_Remove
+(
+	RangeIndex *ri,  // range index
+	NodeID id        // node to remove
+);
+
+// mark node 'id' as holding a value which can't be indexed, e.g. a string
+// removes any value previously indexed for 'id'
+void RangeIndex_Exclude
+(
+	RangeIndex *ri,  // range index
+	NodeID id        // node holding a non numeric value
+);
+
+// merge pending insertions into the sorted run
+// and end the initial loading phase
+void RangeIndex_Flush
+(
+	RangeIndex *ri  // range index
+);
+
+// defer merges while applying a batch of modifications
+// NOP during the initial loading phase
+void RangeIndex_DeferMerges
+(
+	RangeIndex *ri  // range index
+);
+
+// resume merges deferred by RangeIndex_DeferMerges, merging pending
+// modifications only if they exceed the thresholds of a single modification
+void RangeIndex_ResumeMerges
+(
+	RangeIndex *ri  // range index
+);
+
+// returns the ids of all nodes with a key within 'range'
+// in ascending id order, the returned array is owned by the caller
+NodeID *RangeIndex_Query
+(
+	const RangeIndex *ri,      // range index
+	const NumericRange *range  // queried range
+);
+
+// returns the ids of up to 'cap' nodes with a key within 'range'
+// in ascending (key, id) order, descending if 'desc' is set
+// if 'after' is specified, only nodes following it in that order are reported
+// such that a range is consumed in consecutive pages
+// the returned array is owned by the caller
+NodeID *RangeIndex_QueryOrdered
+(
+	const RangeIndex *ri,       // range index
+	const NumericRange *range,  // queried range
+	bool desc,                  // report nodes in descending order
+	const NodeID *after,        // [optional] last node of the previous page
+	uint64_t cap                // maximum number of nodes to report
+);
+
+// sets 'id' to the node holding the smallest indexed value, or the largest
+// if 'max' is set, returns false if the index is empty
+bool RangeIndex_Extreme
+(
+	const RangeIndex *ri,  // range index
+	bool max,              // locate the largest value
+	NodeID *id             // [output] node holding the value
+);
+
+// returns number of nodes marked by RangeIndex_Exclude
+uint64_t RangeIndex_ExcludedCount
+(
+	const RangeIndex *ri  // range index
+);
+
+// returns number of indexed nodes
+uint64_t RangeIndex_Count
+(
+	const RangeIndex *ri  // range index
+);
+
+// returns an estimate of the number of bytes held by the index
+size_t RangeIndex_MemoryUsage
+(
+	const RangeIndex *ri  // range index
+);
+
+// free range index
+void RangeIndex_Free
+(
+	RangeIndex *ri  // range index
+);
+
@@ -0,0 +1,178 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "unique_constraint.h"
+#include "RG.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+#include <string.h>
+
+// keys up to this size are encoded on the stack
+#define KEY_INLINE_CAP 64
+
+// key tags, numerics share their tag once integral
+#define KEY_TAG_INT    'i'
+#define KEY_TAG_DOUBLE 'd'
+#define KEY_TAG_BOOL   'b'
+#define KEY_TAG_STRING 's'
+
+// encoded constraint key
+typedef struct {
+	unsigned char *data;                       // encoded key
+	size_t len;                                // key length
+	unsigned char inline_buf[KEY_INLINE_CAP];  // storage of short keys
+} _Key;
+
+// key held by a node
+typedef struct {
+	size_t len;            // key length
+	unsigned char data[];  // encoded key
+} _OwnedKey;
+
+static void _Key_Set(_Key *k, char tag, const void *payload, size_t len) {
+	k->len = len + 1;
+	k->data = (k->len > KEY_INLINE_CAP) ? rm_malloc(k->len) : k->inline_buf;
+	k->data[0] = tag;
+	memcpy(k->data + 1, payload, len);
+}
+
+// encodes 'v', returns false if 'v' isn't constrained
+static bool _Key_Encode(_Key *k, SIValue v) {
+	switch(SI_TYPE(v)) {
+	case T_INT64:
+		_Key_Set(k, KEY_TAG_INT, &v.longval, sizeof(v.longval));
+		return true;
+	case T_DOUBLE: {
+		double d = v.doubleval;
+		if(isnan(d)) return false;
+		// integral doubles equal their integer counterpart
+		if(d == trunc(d) && d >= -9223372036854775808.0 &&
+		   d < 9223372036854775808.0) {
+			int64_t l = (int64_t)d;
+			_Key_Set(k, KEY_TAG_INT, &l, sizeof(l));
+		} else {
+			_Key_Set(k, KEY_TAG_DOUBLE, &d, sizeof(d));
+		}
+		return true;
+	}
+	case T_BOOL: {
+		unsigned char b = (v.longval != 0);
+		_Key_Set(k, KEY_TAG_BOOL, &b, sizeof(b));
+		return true;
+	}
+	case T_STRING:
+		_Key_Set(k, KEY_TAG_STRING, v.stringval, strlen(v.stringval));
+		return true;
+	default:
+		return false;
+	}
+}
+
+static inline void _Key_Free(_Key *k) {
+	if(k->data != k->inline_buf) rm_free(k->data);
+}
+
+UniqueConstraint *UniqueConstraint_New(Attribute_ID attribute) {
+	UniqueConstraint *uc = rm_malloc(sizeof(UniqueConstraint));
+	uc->attribute = attribute;
+	uc->keys = raxNew();
+	uc->owners = raxNew();
+	return uc;
+}
+
+NodeID UniqueConstraint_Lookup(const UniqueConstraint *uc, SIValue v) {
+	ASSERT(uc != NULL);
+
+	_Key k;
+	if(!_Key_Encode(&k, v)) return INVALID_ENTITY_ID;
+
+	void *holder = raxFind(uc->keys, k.data, k.len);
+	_Key_Free(&k);
+
+	if(holder == raxNotFound) return INVALID_ENTITY_ID;
+	return (NodeID)(uintptr_t)holder;
+}
+
+bool UniqueConstraint_Accepts(const UniqueConstraint *uc, NodeID id, SIValue v) {
+	NodeID holder = UniqueConstraint_Lookup(uc, v);
+	return (holder == INVALID_ENTITY_ID || holder == id);
+}
+
+bool UniqueConstraint_Claim(const UniqueConstraint *uc, rax *claims, SIValue v) {
+	ASSERT(uc != NULL && claims != NULL);
+
+	_Key k;
+	if(!_Key_Encode(&k, v)) return true;
+
+	bool claimed = false;
+	if(raxFind(uc->keys, k.data, k.len) == raxNotFound) {
+		// claims are scoped by constraint, such that constraints can share them
+		size_t len = sizeof(uc) + k.len;
+		unsigned char claim[len];
+		memcpy(claim, &uc, sizeof(uc));
+		memcpy(claim + sizeof(uc), k.data, k.len);
+		claimed = raxTryInsert(claims, claim, len, NULL, NULL);
+	}
+
+	_Key_Free(&k);
+	return claimed;
+}
+
+void UniqueConstraint_Insert(UniqueConstraint *uc, NodeID id, SIValue v) {
+	ASSERT(uc != NULL);
+
+	UniqueConstraint_Remove(uc, id);
+
+	_Key k;
+	if(!_Key_Encode(&k, v)) return;
+
+	raxInsert(uc->keys, k.data, k.len, (void *)(uintptr_t)id, NULL);
+
+	_OwnedKey *owned = rm_malloc(sizeof(_OwnedKey) + k.len);
+	owned->len = k.len;
+	memcpy(owned->data, k.data, k.len);
+	raxInsert(uc->owners, (unsigned char *)&id, sizeof(id), owned, NULL);
+
+	_Key_Free(&k);
+}
+
+void UniqueConstraint_Remove(UniqueConstraint *uc, NodeID id) {
+	ASSERT(uc != NULL);
+
+	_OwnedKey *owned = NULL;
+	if(!raxRemove(uc->owners, (unsigned char *)&id, sizeof(id), (void **)&owned)) {
+		return;
+	}
+
+	// the value might have been taken over by another node,
+	// e.g. by a bulk insertion which doesn't enforce the constraint
+	void *holder = raxFind(uc->keys, owned->data, owned->len);
+	if(holder != raxNotFound && (NodeID)(uintptr_t)holder == id) {
+		raxRemove(uc->keys, owned->data, owned->len, NULL);
+	}
+
+	rm_free(owned);
+}
+
+uint64_t UniqueConstraint_Count(const UniqueConstraint *uc) {
+	ASSERT(uc != NULL);
+	return raxSize(uc->keys);
+}
+
+void UniqueConstraint_Clear(UniqueConstraint *uc) {
+	ASSERT(uc != NULL);
+	raxFree(uc->keys);
+	raxFreeWithCallback(uc->owners, rm_free);
+	uc->keys = raxNew();
+	uc->owners = raxNew();
+}
+
+void UniqueConstraint_Free(UniqueConstraint *uc) {
+	ASSERT(uc != NULL);
+	raxFree(uc->keys);
+	raxFreeWithCallback(uc->owners, rm_free);
+	rm_free(uc);
+}
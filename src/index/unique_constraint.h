@@ -0,0 +1,97 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../value.h"
+#include "../graph/entities/node.h"
+#include "../graph/entities/graph_entity.h"
+#include "rax.h"
+#include <stdbool.h>
+
+// uniqueness constraint over a single node attribute
+//
+// constrained values map to the node holding them, such that checking
+// a value or resolving the node holding it costs a single lookup
+//
+// only strings, booleans and numerics are constrained, numerics compare
+// by value, 1 and 1.0 are the same key, other values, including NULL
+// and NaN, are never considered duplicates
+//
+// the constraint is modified under the graph write lock and queried
+// under either the graph read or write lock
+typedef struct {
+	Attribute_ID attribute;  // constrained attribute
+	rax *keys;               // encoded values to the node holding them
+	rax *owners;             // node IDs to their encoded value
+} UniqueConstraint;
+
+// create a new, empty constraint over 'attribute'
+UniqueConstraint *UniqueConstraint_New
+(
+	Attribute_ID attribute  // constrained attribute
+);
+
+// returns the node holding 'v', INVALID_ENTITY_ID if none
+NodeID UniqueConstraint_Lookup
+(
+	const UniqueConstraint *uc,  // constraint
+	SIValue v                    // value to look up
+);
+
+// returns true if node 'id' may hold 'v'
+// i.e. 'v' isn't constrained or isn't held by any other node
+bool UniqueConstraint_Accepts
+(
+	const UniqueConstraint *uc,  // constraint
+	NodeID id,                   // node about to hold 'v'
+	SIValue v                    // value
+);
+
+// claim 'v' for an entity which is yet to be created
+// returns false if 'v' is held by a node or was already claimed in 'claims'
+// 'claims' may be shared by multiple constraints
+bool UniqueConstraint_Claim
+(
+	const UniqueConstraint *uc,  // constraint
+	rax *claims,                 // values claimed so far
+	SIValue v                    // value to claim
+);
+
+// record node 'id' holding 'v', replacing its previous value
+// a value which isn't constrained only removes the node's previous value
+void UniqueConstraint_Insert
+(
+	UniqueConstraint *uc,  // constraint
+	NodeID id,             // node
+	SIValue v              // value held by the node
+);
+
+// remove node 'id' from the constraint
+// NOP if 'id' holds no constrained value
+void UniqueConstraint_Remove
+(
+	UniqueConstraint *uc,  // constraint
+	NodeID id              // node to remove
+);
+
+// returns the number of constrained values
+uint64_t UniqueConstraint_Count
+(
+	const UniqueConstraint *uc  // constraint
+);
+
+// remove every node from the constraint
+void UniqueConstraint_Clear
+(
+	UniqueConstraint *uc  // constraint to clear
+);
+
+// free constraint
+void UniqueConstraint_Free
+(
+	UniqueConstraint *uc  // constraint to free
+);
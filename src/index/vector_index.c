@@ -0,0 +1,209 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "vector_index.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../datatypes/array.h"
+#include <math.h>
+#include <string.h>
+
+#define NO_SLOT UINT64_MAX
+
+VectorIndex *VectorIndex_New(void) {
+	VectorIndex *vi = rm_malloc(sizeof(VectorIndex));
+	vi->dim = 0;
+	vi->vectors = array_new(float, 0);
+	vi->ids = array_new(NodeID, 0);
+	vi->slots = array_new(uint64_t, 0);
+	return vi;
+}
+
+uint VectorIndex_ToVector(SIValue v, float *out) {
+	ASSERT(out != NULL);
+
+	if(SI_TYPE(v) != T_ARRAY) return 0;
+	uint len = SIArray_Length(v);
+	if(len > VECTOR_INDEX_MAX_DIM) return 0;
+
+	// packed lists are converted without per element access
+	const double *doubles = SIArray_Doubles(v);
+	if(doubles != NULL) {
+		for(uint i = 0; i < len; i++) out[i] = doubles[i];
+		return len;
+	}
+
+	for(uint i = 0; i < len; i++) {
+		SIValue c = SIArray_Get(v, i);
+		if(!(SI_TYPE(c) & SI_NUMERIC)) return 0;
+		out[i] = SI_GET_NUMERIC(c);
+	}
+
+	return len;
+}
+
+// returns the slot of node 'id', NO_SLOT if 'id' isn't indexed
+static inline uint64_t _Slot(const VectorIndex *vi, NodeID id) {
+	if(id >= array_len(vi->slots)) return NO_SLOT;
+	return vi->slots[id];
+}
+
+bool VectorIndex_Insert(VectorIndex *vi, NodeID id, const float *v, uint dim) {
+	ASSERT(vi != NULL);
+
+	// the first indexed vector sets the index dimension
+	double norm = 0;
+	if(dim == vi->dim || vi->dim == 0) {
+		for(uint i = 0; i < dim; i++) norm += (double)v[i] * v[i];
+		norm = sqrt(norm);
+	}
+
+	// vector of a different dimension or of length 0
+	if(norm == 0 || !isfinite(norm)) {
+		VectorIndex_Remove(vi, id);
+		return false;
+	}
+	vi->dim = dim;
+
+	uint64_t slot = _Slot(vi, id);
+	if(slot == NO_SLOT) {
+		// introduce node
+		uint64_t len = array_len(vi->slots);
+		if(id >= len) {
+			vi->slots = array_ensure_len(vi->slots, id + 1);
+			for(uint64_t i = len; i <= id; i++) vi->slots[i] = NO_SLOT;
+		}
+		slot = array_len(vi->ids);
+		vi->slots[id] = slot;
+		array_append(vi->ids, id);
+		vi->vectors = array_ensure_len(vi->vectors, (slot + 1) * dim);
+	}
+
+	float *entry = vi->vectors + slot * dim;
+	for(uint i = 0; i < dim; i++) entry[i] = v[i] / norm;
+	return true;
+}
+
+void VectorIndex_Remove(VectorIndex *vi, NodeID id) {
+	ASSERT(vi != NULL);
+
+	uint64_t slot = _Slot(vi, id);
+	if(slot == NO_SLOT) return;
+
+	// move the last entry into the vacated slot
+	uint64_t last = array_len(vi->ids) - 1;
+	if(slot != last) {
+		NodeID moved = vi->ids[last];
+		vi->ids[slot] = moved;
+		vi->slots[moved] = slot;
+		memcpy(vi->vectors + slot * vi->dim, vi->vectors + last * vi->dim,
+				sizeof(float) * vi->dim);
+	}
+
+	vi->slots[id] = NO_SLOT;
+	array_pop(vi->ids);
+	vi->vectors = array_trimm_len(vi->vectors, last * vi->dim);
+}
+
+uint64_t VectorIndex_Count(const VectorIndex *vi) {
+	ASSERT(vi != NULL);
+	return array_len(vi->ids);
+}
+
+// restores the min-heap property of 'heap' downwards from position 'i'
+static void _SiftDown(VectorIndexMatch *heap, uint n, uint i) {
+	while(true) {
+		uint min = i;
+		uint l = 2 * i + 1;
+		uint r = l + 1;
+		if(l < n && heap[l].similarity < heap[min].similarity) min = l;
+		if(r < n && heap[r].similarity < heap[min].similarity) min = r;
+		if(min == i) return;
+		VectorIndexMatch t = heap[i];
+		heap[i] = heap[min];
+		heap[min] = t;
+		i = min;
+	}
+}
+
+// restores the min-heap property of 'heap' upwards from position 'i'
+static void _SiftUp(VectorIndexMatch *heap, uint i) {
+	while(i > 0) {
+		uint parent = (i - 1) / 2;
+		if(heap[parent].similarity <= heap[i].similarity) return;
+		VectorIndexMatch t = heap[i];
+		heap[i] = heap[parent];
+		heap[parent] = t;
+		i = parent;
+	}
+}
+
+VectorIndexMatch *VectorIndex_Query(const VectorIndex *vi, const float *query,
+		uint dim, uint k) {
+	ASSERT(vi != NULL && query != NULL);
+
+	uint64_t count = array_len(vi->ids);
+	if(k > count) k = count;
+	VectorIndexMatch *matches = array_new(VectorIndexMatch, k);
+	if(k == 0 || dim != vi->dim) return matches;
+
+	// normalize query, such that similarity is a dot product
+	double norm = 0;
+	for(uint i = 0; i < dim; i++) norm += (double)query[i] * query[i];
+	norm = sqrt(norm);
+	if(norm == 0 || !isfinite(norm)) return matches;
+
+	float q[dim];
+	for(uint i = 0; i < dim; i++) q[i] = query[i] / norm;
+
+	// keep the k most similar entries in a min-heap
+	// the least similar of them at its root
+	for(uint64_t slot = 0; slot < count; slot++) {
+		const float *v = vi->vectors + slot * dim;
+		float dot = 0;
+		for(uint i = 0; i < dim; i++) dot += q[i] * v[i];
+
+		uint n = array_len(matches);
+		if(n < k) {
+			VectorIndexMatch m = {.id = vi->ids[slot], .similarity = dot};
+			array_append(matches, m);
+			_SiftUp(matches, n);
+		} else if(dot > matches[0].similarity) {
+			matches[0].id = vi->ids[slot];
+			matches[0].similarity = dot;
+			_SiftDown(matches, n, 0);
+		}
+	}
+
+	// heap sort, least similar entries are moved to the end
+	for(uint n = array_len(matches); n > 1; n--) {
+		VectorIndexMatch t = matches[0];
+		matches[0] = matches[n - 1];
+		matches[n - 1] = t;
+		_SiftDown(matches, n - 1, 0);
+	}
+
+	return matches;
+}
+
+size_t VectorIndex_MemoryUsage(const VectorIndex *vi) {
+	ASSERT(vi != NULL);
+
+	return sizeof(VectorIndex) +
+		array_sizeof(array_hdr(vi->vectors)) +
+		array_sizeof(array_hdr(vi->ids)) +
+		array_sizeof(array_hdr(vi->slots));
+}
+
+void VectorIndex_Free(VectorIndex *vi) {
+	ASSERT(vi != NULL);
+
+	array_free(vi->vectors);
+	array_free(vi->ids);
+	array_free(vi->slots);
+	rm_free(vi);
+}
@@ -0,0 +1,101 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../value.h"
+#include "../graph/entities/node.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of components of an indexed vector
+#define VECTOR_INDEX_MAX_DIM 4096
+
+// a node reported by a similarity query
+typedef struct {
+	NodeID id;         // matching node
+	double similarity; // cosine similarity between node vector and query
+} VectorIndexMatch;
+
+// similarity index over a single array attribute
+//
+// vectors are normalized and stored back to back in a single buffer
+// such that the cosine similarity of a query and an indexed vector
+// is the dot product of the two, computed over contiguous memory
+// rather than per node property lookups
+//
+// the dimension of the index is set by the first indexed vector
+// values which are not arrays of numbers of that dimension aren't indexed
+// as are vectors of length 0, whose similarity is undefined
+//
+// the index is modified under the graph write lock and queried
+// under the graph read lock, queries never modify the index
+typedef struct {
+	uint dim;          // vector dimension, 0 until the first vector is indexed
+	float *vectors;    // normalized vectors, dim components per entry
+	NodeID *ids;       // node of each entry
+	uint64_t *slots;   // entry of each node id, UINT64_MAX if not indexed
+} VectorIndex;
+
+// create a new, empty vector index
+VectorIndex *VectorIndex_New(void);
+
+// converts 'v' into a vector, 'out' must hold VECTOR_INDEX_MAX_DIM floats
+// returns the vector's dimension
+// 0 if 'v' isn't an array of at most VECTOR_INDEX_MAX_DIM numbers
+uint VectorIndex_ToVector
+(
+	SIValue v,  // value to convert
+	float *out  // [output] vector components
+);
+
+// index node 'id' under vector 'v'
+// replaces any vector previously indexed for 'id'
+// returns false and removes 'id' if 'v' can't be indexed
+bool VectorIndex_Insert
+(
+	VectorIndex *vi,  // vector index
+	NodeID id,        // node to index
+	const float *v,   // vector components
+	uint dim          // number of components
+);
+
+// remove node 'id' from the index
+// NOP if 'id' isn't indexed
+void VectorIndex_Remove
+(
+	VectorIndex *vi,  // vector index
+	NodeID id         // node to remove
+);
+
+// returns the number of indexed nodes
+uint64_t VectorIndex_Count
+(
+	const VectorIndex *vi  // vector index
+);
+
+// reports the 'k' indexed nodes most similar to 'query'
+// in descending similarity order, the caller is responsible for freeing
+// the returned array, empty if query dimension doesn't match the index
+VectorIndexMatch *VectorIndex_Query
+(
+	const VectorIndex *vi,  // vector index
+	const float *query,     // query vector components
+	uint dim,               // number of components
+	uint k                  // number of nodes to report
+);
+
+// returns an estimate of the number of bytes held by the index
+size_t VectorIndex_MemoryUsage
+(
+	const VectorIndex *vi  // vector index
+);
+
+// free vector index
+void VectorIndex_Free
+(
+	VectorIndex *vi  // vector index
+);
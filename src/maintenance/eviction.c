@@ -0,0 +1,117 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "eviction.h"
+#include "RG.h"
+#include "../config.h"
+#include "../util/arr.h"
+#include "../util/cron.h"
+#include "../util/qsort.h"
+#include "../redismodule.h"
+#include "../graph/graphcontext.h"
+
+// graphs currently in the keyspace, see module.c
+extern GraphContext **graphs_in_keyspace;
+
+// interval between consecutive budget checks, in milliseconds
+#define EVICTION_INTERVAL 1000
+// max number of graphs evicted by a single check
+// each eviction encodes a graph while holding the GIL
+#define EVICTION_MAX_PER_CHECK 4
+
+// orders resident graphs by their last access, least recent first
+#define ACCESSED_BEFORE(a, b) \
+	((a)->gc->residency.last_access < (b)->gc->residency.last_access)
+
+// a graph whose content is in memory
+typedef struct {
+	GraphContext *gc;  // resident graph
+	size_t memory;     // estimated memory held by the graph's entities and matrices
+} ResidentGraph;
+
+static uint64_t _evictions = 0;  // number of graphs evicted
+
+static void _Eviction_Tick(void *pdata);
+
+// estimates the memory held by a resident graph
+// graphs held by a writer are estimated as they were last reported by INFO
+static size_t _Eviction_GraphMemory(GraphContext *gc) {
+	Graph *g = gc->g;
+	GraphMetrics *gm = GraphContext_GetMetrics(gc);
+	// don't block the redis main thread waiting for a writer
+	if(!Graph_TryAcquireReadLock(g)) {
+		return gm->memory[METRICS_MEM_ENTITIES] + gm->memory[METRICS_MEM_MATRICES];
+	}
+
+	size_t memory = Graph_EntitiesMemoryUsage(g) + Graph_MatricesMemoryUsage(g);
+	Graph_ReleaseLock(g);
+	return memory;
+}
+
+// evicts the least recently accessed graphs until the memory held by
+// resident graphs is within budget, expects the GIL to be held
+static void _Eviction_Enforce(uint64_t budget) {
+	uint graph_count = array_len(graphs_in_keyspace);
+	ResidentGraph *resident = array_new(ResidentGraph, graph_count);
+
+	size_t total = 0;
+	for(uint i = 0; i < graph_count; i++) {
+		GraphContext *gc = graphs_in_keyspace[i];
+		if(GraphContext_IsEvicted(gc)) continue;
+
+		ResidentGraph r = {.gc = gc, .memory = _Eviction_GraphMemory(gc)};
+		total += r.memory;
+		resident = array_append(resident, r);
+	}
+
+	if(total > budget) {
+		uint count = array_len(resident);
+		QSORT(ResidentGraph, resident, count, ACCESSED_BEFORE);
+
+		uint evicted = 0;
+		for(uint i = 0; i < count && total > budget; i++) {
+			if(evicted == EVICTION_MAX_PER_CHECK) break;
+			// graphs in use keep counting against the budget
+			if(!GraphContext_Evict(resident[i].gc)) continue;
+
+			RedisModule_Log(NULL, "verbose", "Evicted graph %s",
+					GraphContext_GetName(resident[i].gc));
+			total -= resident[i].memory;
+			evicted++;
+		}
+		__atomic_add_fetch(&_evictions, evicted, __ATOMIC_RELAXED);
+	}
+
+	array_free(resident);
+}
+
+// CRON task, checks the graph memory budget
+static void _Eviction_Tick(void *pdata) {
+	uint64_t budget;
+	Config_Option_get(Config_GRAPH_MEMORY_BUDGET, &budget);
+
+	if(budget > 0) {
+		RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+
+		// graphs are introduced, retrieved and removed by the main thread
+		RedisModule_ThreadSafeContextLock(ctx);
+		int flags = RedisModule_GetContextFlags(ctx);
+		if(!(flags & REDISMODULE_CTX_FLAGS_LOADING)) _Eviction_Enforce(budget);
+		RedisModule_ThreadSafeContextUnlock(ctx);
+
+		RedisModule_FreeThreadSafeContext(ctx);
+	}
+
+	Cron_AddTask(EVICTION_INTERVAL, _Eviction_Tick, NULL);
+}
+
+void Eviction_Start(void) {
+	Cron_AddTask(EVICTION_INTERVAL, _Eviction_Tick, NULL);
+}
+
+uint64_t Eviction_EvictionCount(void) {
+	return __atomic_load_n(&_evictions, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,21 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// graph eviction
+// while the memory held by resident graphs exceeds GRAPH_MEMORY_BUDGET
+// the least recently accessed graphs which no one holds are evicted to disk
+// an evicted graph is reloaded once it is accessed again
+// see GraphContext_Evict and GraphContext_Retrieve
+
+// start enforcing the graph memory budget, expects CRON to be running
+void Eviction_Start(void);
+
+// returns the number of graphs evicted since the module loaded
+uint64_t Eviction_EvictionCount(void);
@@ -0,0 +1,285 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "RG.h"
+#include "maintenance.h"
+#include "../config.h"
+#include "../redismodule.h"
+#include "../util/cron.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+#include <sys/param.h>
+
+// milliseconds between scheduler runs
+#define MAINTENANCE_INTERVAL 1000
+// min milliseconds between consecutive maintenance runs
+#define MAINTENANCE_MIN_REST 10
+// min number of deleted entities worth compacting
+#define MAINTENANCE_COMPACT_MIN 10000
+// graphs are compacted once deleted entities make up a quarter of their storage
+#define MAINTENANCE_COMPACT_RATIO 4
+// max number of entity blocks encoded per run, nodes and edges each
+#define MAINTENANCE_PACK_BLOCKS 32
+
+extern GraphContext **graphs_in_keyspace;  // all extant graphs, see module.c
+
+// maintenance run context
+typedef struct {
+	GraphContext *gc;  // graph being maintained
+	bool replica;      // server is a replica, compaction is left to the primary
+	bool entities;     // compact entity storage
+	bool values;       // compact the value log
+	double time;       // time spent maintaining gc, in milliseconds
+} MaintenanceCtx;
+
+static MaintenanceStats _stats = {0};  // maintenance activity
+static uint64_t _time_us = 0;          // time spent maintaining, in microseconds
+static uint _next_graph = 0;           // round-robin position, guarded by the GIL
+
+static const char *_job_names[MAINTENANCE_JOB_COUNT] = {"sync", "compact", "values", "pack"};
+
+static void _Maintenance_Tick(void *pdata);
+
+// returns true if graph was modified since its last maintenance
+static inline bool _Maintenance_Pending(const GraphContext *gc) {
+	return Graph_WriteEpoch(gc->g) != gc->maintained_epoch;
+}
+
+// retains the next graph due for maintenance, NULL if there's none
+static GraphContext *_Maintenance_NextGraph(bool *replica) {
+	GraphContext *gc = NULL;
+	RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+
+	// graphs are introduced and removed by the main thread
+	RedisModule_ThreadSafeContextLock(ctx);
+
+	int flags = RedisModule_GetContextFlags(ctx);
+	*replica = (flags & REDISMODULE_CTX_FLAGS_SLAVE);
+	bool loading = (flags & REDISMODULE_CTX_FLAGS_LOADING);
+
+	uint graph_count = (loading) ? 0 : array_len(graphs_in_keyspace);
+	for(uint i = 0; i < graph_count; i++) {
+		uint idx = (_next_graph + i) % graph_count;
+		GraphContext *candidate = graphs_in_keyspace[idx];
+		if(GraphDecodeContext_Decoding(candidate->decoding_context)) continue;
+		if(GraphContext_IsEvicted(candidate)) continue;
+		if(!_Maintenance_Pending(candidate)) continue;
+
+		gc = candidate;
+		GraphContext_Retain(gc);
+		_next_graph = idx + 1;
+		break;
+	}
+
+	RedisModule_ThreadSafeContextUnlock(ctx);
+	RedisModule_FreeThreadSafeContext(ctx);
+
+	return gc;
+}
+
+// schedule the next tick once the time spent maintaining is amortized
+// over the CPU budget
+static void _Maintenance_Done(MaintenanceCtx *mctx) {
+	GraphContext_Release(mctx->gc);
+
+	__atomic_add_fetch(&_time_us, (uint64_t)(mctx->time * 1000), __ATOMIC_RELAXED);
+	__atomic_store_n(&_stats.active, false, __ATOMIC_RELAXED);
+
+	uint budget;
+	Config_Option_get(Config_MAINTENANCE_CPU_BUDGET, &budget);
+	uint rest = (budget > 0) ?
+		mctx->time * (100 - budget) / budget :
+		MAINTENANCE_INTERVAL;
+	rm_free(mctx);
+
+	Cron_AddTask(MAX(rest, MAINTENANCE_MIN_REST), _Maintenance_Tick, NULL);
+}
+
+// releases storage held by deleted entities and released values
+// on the graph's writer thread serialized with the graph's write queries,
+// as GRAPH.COMPACT is
+static void _Maintenance_Compact(void *args) {
+	MaintenanceCtx *mctx = args;
+	GraphContext *gc = mctx->gc;
+
+	double tic[2];
+	simple_tic(tic);
+
+	size_t released = 0;
+	Graph_WriterEnter(gc->g);
+	Graph_AcquireWriteLock(gc->g);
+	if(mctx->entities) released += Graph_CompactEntities(gc->g);
+	// relocating values modifies no entity, it's performed by replicas as well
+	if(mctx->values) released += GraphContext_CompactValueLog(gc);
+	// compaction acquired the write lock, it doesn't call for maintenance
+	gc->maintained_epoch = Graph_WriteEpoch(gc->g);
+	Graph_ReleaseLock(gc->g);
+
+	if(mctx->entities) {
+		// compaction determines the order in which deleted IDs are reused,
+		// replicas must compact as well to assign the same IDs
+		// replicated ahead of the next writer's commit, which may reuse them
+		RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+		RedisModule_ThreadSafeContextLock(ctx);
+		RedisModule_Replicate(ctx, "GRAPH.COMPACT", "c", gc->graph_name);
+		RedisModule_ThreadSafeContextUnlock(ctx);
+		RedisModule_FreeThreadSafeContext(ctx);
+		__atomic_add_fetch(&_stats.runs[MAINTENANCE_COMPACT], 1, __ATOMIC_RELAXED);
+	}
+	Graph_WriterLeave(gc->g);
+	if(mctx->values) {
+		__atomic_add_fetch(&_stats.runs[MAINTENANCE_VALUES], 1, __ATOMIC_RELAXED);
+	}
+	__atomic_add_fetch(&_stats.released, released, __ATOMIC_RELAXED);
+
+	mctx->time += simple_toc(tic) * 1000;
+	_Maintenance_Done(mctx);
+}
+
+// encodes entity blocks modified since they were last encoded, such that
+// snapshots reuse their encoding, returns false if further blocks are due
+static bool _Maintenance_Pack(GraphContext *gc) {
+	Graph *g = gc->g;
+	bool enabled;
+	Config_Option_get(Config_SNAPSHOT_PACK_CACHE, &enabled);
+
+	if(!enabled) {
+		// release packs retained before the cache was disabled
+		if(array_len(gc->node_packs->blocks) == 0 &&
+		   array_len(gc->edge_packs->blocks) == 0) {
+			return true;
+		}
+		Graph_AcquireWriteLock(g);
+		PackCache_Clear(gc->node_packs);
+		PackCache_Clear(gc->edge_packs);
+		Graph_ReleaseLock(g);
+		return true;
+	}
+
+	// encode under the read lock, alongside the graph's readers
+	bool nodes_depleted;
+	bool edges_depleted;
+	Graph_AcquireReadLock(g);
+	PackedBlock *node_packs = PackCache_Collect(gc->node_packs, g,
+			MAINTENANCE_PACK_BLOCKS, &nodes_depleted);
+	PackedBlock *edge_packs = PackCache_Collect(gc->edge_packs, g,
+			MAINTENANCE_PACK_BLOCKS, &edges_depleted);
+	Graph_ReleaseLock(g);
+
+	// snapshots encode under the read lock, packs are installed exclusively
+	Graph_AcquireWriteLock(g);
+	PackCache_Install(gc->node_packs, g, node_packs);
+	PackCache_Install(gc->edge_packs, g, edge_packs);
+	Graph_ReleaseLock(g);
+
+	__atomic_add_fetch(&_stats.runs[MAINTENANCE_PACK], 1, __ATOMIC_RELAXED);
+	return nodes_depleted && edges_depleted;
+}
+
+// maintains a single graph on a bulk loader thread
+static void _Maintenance_Run(void *args) {
+	MaintenanceCtx *mctx = args;
+	GraphContext *gc = mctx->gc;
+	Graph *g = gc->g;
+
+	double tic[2];
+	simple_tic(tic);
+
+	// synchronize matrices ahead of the graph's next readers
+	Graph_AcquireReadLock(g);
+	uint64_t epoch = Graph_WriteEpoch(g);
+	Graph_ApplyAllPending(g);
+	size_t deleted = Graph_DeletedNodeCount(g) + Graph_DeletedEdgeCount(g);
+	size_t entities = Graph_NodeCount(g) + Graph_EdgeCount(g) + deleted;
+	mctx->values = gc->value_log && ValueLog_CompactionDue(gc->value_log);
+	Graph_ReleaseLock(g);
+
+	__atomic_add_fetch(&_stats.runs[MAINTENANCE_SYNC], 1, __ATOMIC_RELAXED);
+
+	// blocks left unencoded call for another run
+	bool packed = _Maintenance_Pack(gc);
+	mctx->time += simple_toc(tic) * 1000;
+
+	// writes following the read lock's release call for another run
+	if(packed) gc->maintained_epoch = epoch;
+
+	mctx->entities = !mctx->replica &&
+		deleted >= MAINTENANCE_COMPACT_MIN &&
+		deleted * MAINTENANCE_COMPACT_RATIO >= entities;
+
+	if((mctx->entities || mctx->values) &&
+	   ThreadPools_AddWorkWriter(_Maintenance_Compact, mctx, gc->graph_name) == 0) {
+		return;
+	}
+
+	_Maintenance_Done(mctx);
+}
+
+// CRON task, dispatches maintenance of the next graph due
+// while the module's threads are mostly idle
+static void _Maintenance_Tick(void *pdata) {
+	uint budget;
+	Config_Option_get(Config_MAINTENANCE_CPU_BUDGET, &budget);
+
+	if(budget > 0) {
+		if(!ThreadPools_LowLoad()) {
+			__atomic_add_fetch(&_stats.deferred, 1, __ATOMIC_RELAXED);
+		} else {
+			bool replica;
+			GraphContext *gc = _Maintenance_NextGraph(&replica);
+			if(gc != NULL) {
+				MaintenanceCtx *mctx = rm_malloc(sizeof(MaintenanceCtx));
+				mctx->gc = gc;
+				mctx->replica = replica;
+				mctx->entities = false;
+				mctx->values = false;
+				mctx->time = 0;
+
+				__atomic_store_n(&_stats.active, true, __ATOMIC_RELAXED);
+				if(ThreadPools_AddWorkBulkLoader(_Maintenance_Run, mctx) == 0) {
+					// the run schedules the next tick
+					return;
+				}
+
+				__atomic_store_n(&_stats.active, false, __ATOMIC_RELAXED);
+				GraphContext_Release(gc);
+				rm_free(mctx);
+			}
+		}
+	}
+
+	Cron_AddTask(MAINTENANCE_INTERVAL, _Maintenance_Tick, NULL);
+}
+
+void Maintenance_Start(void) {
+	Cron_AddTask(MAINTENANCE_INTERVAL, _Maintenance_Tick, NULL);
+}
+
+const char *Maintenance_JobName
+(
+	MaintenanceJob job
+) {
+	ASSERT(job < MAINTENANCE_JOB_COUNT);
+	return _job_names[job];
+}
+
+void Maintenance_GetStats
+(
+	MaintenanceStats *stats
+) {
+	ASSERT(stats != NULL);
+
+	stats->active = __atomic_load_n(&_stats.active, __ATOMIC_RELAXED);
+	for(int i = 0; i < MAINTENANCE_JOB_COUNT; i++) {
+		stats->runs[i] = __atomic_load_n(&_stats.runs[i], __ATOMIC_RELAXED);
+	}
+	stats->deferred = __atomic_load_n(&_stats.deferred, __ATOMIC_RELAXED);
+	stats->time = __atomic_load_n(&_time_us, __ATOMIC_RELAXED) / 1000;
+	stats->released = __atomic_load_n(&_stats.released, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,51 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// background maintenance
+// while the module's threads are mostly idle, graphs modified since their
+// last maintenance are maintained one at a time on a bulk loader thread
+// such that queries find their graph's matrices synchronized and its
+// entity storage compacted rather than doing so inline
+// the time spent maintaining is bounded by MAINTENANCE_CPU_BUDGET
+
+// maintenance jobs
+typedef enum {
+	MAINTENANCE_SYNC,     // resize matrices and apply their pending changes
+	MAINTENANCE_COMPACT,  // release storage held by deleted entities
+	MAINTENANCE_VALUES,   // release value log segments held by released values
+	MAINTENANCE_PACK,     // encode modified entity blocks ahead of snapshots
+	MAINTENANCE_JOB_COUNT
+} MaintenanceJob;
+
+// maintenance activity since the module loaded
+typedef struct {
+	bool active;                           // a graph is being maintained
+	uint64_t runs[MAINTENANCE_JOB_COUNT];  // number of executions, per job
+	uint64_t deferred;                     // runs deferred as threads were busy
+	uint64_t time;                         // time spent maintaining, in milliseconds
+	size_t released;                       // bytes released by compaction, values included
+} MaintenanceStats;
+
+// start scheduling maintenance, expects CRON and the thread pools to be running
+void Maintenance_Start(void);
+
+// returns job name, e.g. "sync"
+const char *Maintenance_JobName
+(
+	MaintenanceJob job  // maintenance job
+);
+
+// retrieve maintenance activity
+void Maintenance_GetStats
+(
+	MaintenanceStats *stats  // [output] maintenance activity
+);
@@ -0,0 +1,260 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "metrics.h"
+#include "RG.h"
+#include "../config.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../util/thpool/pools.h"
+#include "../graph/graphcontext.h"
+#include "../maintenance/eviction.h"
+#include "../commands/execution_ctx.h"
+#include <stdio.h>
+
+// graphs currently in the keyspace, see module.c
+extern GraphContext **graphs_in_keyspace;
+
+// latency of every executed command, in microseconds
+static Histogram _latency[METRICS_CMD_COUNT];
+
+static uint64_t _rejected;   // number of queries rejected due to a full queue or their cost
+static uint64_t _timed_out;  // number of queries which timed out
+static uint64_t _conflicts;  // number of write queries whose read phase was invalidated
+static uint64_t _sync_time;  // time spent synchronizing matrices, in microseconds
+static uint64_t _gil_wait;   // time queries spent waiting for the GIL, in microseconds
+
+static const char *_command_names[METRICS_CMD_COUNT] = {
+	"query",
+	"ro_query",
+	"bulk",
+	"delete"
+};
+
+static const char *_memory_names[METRICS_MEM_COUNT] = {
+	"memory_entities",
+	"memory_matrices",
+	"memory_indexes",
+	"memory_cache"
+};
+
+GraphMetrics *GraphMetrics_New(void) {
+	GraphMetrics *gm = rm_calloc(1, sizeof(GraphMetrics));
+	for(int i = 0; i < METRICS_CMD_COUNT; i++) gm->latency[i] = Histogram_New();
+	return gm;
+}
+
+void GraphMetrics_Free(GraphMetrics *gm) {
+	ASSERT(gm != NULL);
+	for(int i = 0; i < METRICS_CMD_COUNT; i++) Histogram_Free(gm->latency[i]);
+	rm_free(gm);
+}
+
+const char *Metrics_CommandName(MetricsCommand cmd) {
+	ASSERT(cmd < METRICS_CMD_COUNT);
+	return _command_names[cmd];
+}
+
+void Metrics_RecordLatency(GraphMetrics *gm, MetricsCommand cmd, double latency) {
+	ASSERT(cmd < METRICS_CMD_COUNT);
+
+	uint64_t us = (latency > 0) ? (uint64_t)(latency * 1000) : 0;
+	Histogram_Record(_latency + cmd, us);
+	if(gm) Histogram_Record(gm->latency[cmd], us);
+}
+
+void Metrics_QueryRejected(void) {
+	__atomic_fetch_add(&_rejected, 1, __ATOMIC_RELAXED);
+}
+
+void Metrics_QueryTimedOut(void) {
+	__atomic_fetch_add(&_timed_out, 1, __ATOMIC_RELAXED);
+}
+
+void Metrics_WriteConflict(void) {
+	__atomic_fetch_add(&_conflicts, 1, __ATOMIC_RELAXED);
+}
+
+void Metrics_AddSyncTime(double ms) {
+	if(ms <= 0) return;
+	__atomic_fetch_add(&_sync_time, (uint64_t)(ms * 1000), __ATOMIC_RELAXED);
+}
+
+void Metrics_AddGILWaitTime(double ms) {
+	if(ms <= 0) return;
+	__atomic_fetch_add(&_gil_wait, (uint64_t)(ms * 1000), __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+// INFO
+//------------------------------------------------------------------------------
+
+// adds a microseconds value as a milliseconds field
+static void _AddFieldMs(RedisModuleInfoCtx *ctx, const char *field, double us) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.3f", us / 1000);
+	RedisModule_InfoAddFieldCString(ctx, (char *)field, buf);
+}
+
+// reports a latency histogram as a single dictionary field
+static void _AddLatencyField(RedisModuleInfoCtx *ctx, const char *field,
+		const Histogram *h) {
+	uint64_t count = Histogram_Count(h);
+	double mean = (count > 0) ? (double)Histogram_Sum(h) / count : 0;
+
+	RedisModule_InfoBeginDictField(ctx, (char *)field);
+	RedisModule_InfoAddFieldULongLong(ctx, "count", count);
+	_AddFieldMs(ctx, "mean_ms", mean);
+	_AddFieldMs(ctx, "p50_ms", Histogram_Quantile(h, 0.5));
+	_AddFieldMs(ctx, "p90_ms", Histogram_Quantile(h, 0.9));
+	_AddFieldMs(ctx, "p99_ms", Histogram_Quantile(h, 0.99));
+	_AddFieldMs(ctx, "p999_ms", Histogram_Quantile(h, 0.999));
+	_AddFieldMs(ctx, "max_ms", Histogram_Max(h));
+	RedisModule_InfoEndDictField(ctx);
+}
+
+static void _CacheMemoryUsage(const char *key, void *value, void *pdata) {
+	size_t *usage = pdata;
+	*usage += ExecutionCtx_MemoryUsage(value);
+}
+
+// refreshes the memory estimates of a graph
+// graphs held by a writer keep their previous estimates
+static void _UpdateGraphMemory(GraphContext *gc, GraphMetrics *gm) {
+	// evicted graphs hold none of their content in memory
+	if(GraphContext_IsEvicted(gc)) {
+		for(int i = 0; i < METRICS_MEM_COUNT; i++) gm->memory[i] = 0;
+		return;
+	}
+
+	size_t cache = 0;
+	Cache_ForEach(GraphContext_GetCache(gc), _CacheMemoryUsage, &cache);
+	gm->memory[METRICS_MEM_CACHE] = cache;
+
+	// bulk insertions and compactions modify the graph without the GIL
+	// don't block the redis main thread waiting for them
+	Graph *g = gc->g;
+	if(!Graph_TryAcquireReadLock(g)) return;
+
+	size_t indexes = 0;
+	Schema **schemas[2] = {gc->node_schemas, gc->relation_schemas};
+	for(int i = 0; i < 2; i++) {
+		uint schema_count = array_len(schemas[i]);
+		for(uint j = 0; j < schema_count; j++) {
+			Schema *s = schemas[i][j];
+			if(s->index) indexes += Index_MemoryUsage(s->index);
+			if(s->vectorIdx) indexes += Index_MemoryUsage(s->vectorIdx);
+		}
+	}
+
+	gm->memory[METRICS_MEM_ENTITIES] = Graph_EntitiesMemoryUsage(g);
+	gm->memory[METRICS_MEM_MATRICES] = Graph_MatricesMemoryUsage(g);
+	gm->memory[METRICS_MEM_INDEXES] = indexes;
+
+	Graph_ReleaseLock(g);
+}
+
+void Metrics_Info(RedisModuleInfoCtx *ctx) {
+	ASSERT(ctx != NULL);
+
+	uint graph_count = array_len(graphs_in_keyspace);
+	uint64_t cache_hits = 0;
+	uint64_t cache_misses = 0;
+	uint64_t result_cache_hits = 0;
+	uint64_t result_cache_misses = 0;
+	uint64_t evicted_graphs = 0;
+	size_t memory[METRICS_MEM_COUNT] = {0};
+
+	for(uint i = 0; i < graph_count; i++) {
+		GraphContext *gc = graphs_in_keyspace[i];
+		_UpdateGraphMemory(gc, GraphContext_GetMetrics(gc));
+		if(GraphContext_IsEvicted(gc)) {
+			evicted_graphs++;
+			continue;
+		}
+		CacheStats stats = Cache_GetStats(GraphContext_GetCache(gc));
+		cache_hits += stats.hits;
+		cache_misses += stats.misses;
+		uint64_t hits;
+		uint64_t misses;
+		ResultCache_GetStats(gc->result_cache, &hits, &misses);
+		result_cache_hits += hits;
+		result_cache_misses += misses;
+		for(int j = 0; j < METRICS_MEM_COUNT; j++) memory[j] += GraphContext_GetMetrics(gc)->memory[j];
+	}
+
+	uint64_t max_queued_queries;
+	Config_Option_get(Config_MAX_QUEUED_QUERIES, &max_queued_queries);
+
+	RedisModule_InfoAddSection(ctx, "metrics");
+	RedisModule_InfoAddFieldULongLong(ctx, "queued_queries",
+			ThreadPools_ReadersQueueSize());
+	RedisModule_InfoAddFieldULongLong(ctx, "max_queued_queries", max_queued_queries);
+	RedisModule_InfoAddFieldULongLong(ctx, "reader_threads", ThreadPools_ReaderCount());
+	RedisModule_InfoAddFieldULongLong(ctx, "rejected_queries",
+			__atomic_load_n(&_rejected, __ATOMIC_RELAXED));
+	RedisModule_InfoAddFieldULongLong(ctx, "timed_out_queries",
+			__atomic_load_n(&_timed_out, __ATOMIC_RELAXED));
+	RedisModule_InfoAddFieldULongLong(ctx, "write_conflicts",
+			__atomic_load_n(&_conflicts, __ATOMIC_RELAXED));
+	RedisModule_InfoAddFieldULongLong(ctx, "cache_hits", cache_hits);
+	RedisModule_InfoAddFieldULongLong(ctx, "cache_misses", cache_misses);
+	RedisModule_InfoAddFieldULongLong(ctx, "result_cache_hits", result_cache_hits);
+	RedisModule_InfoAddFieldULongLong(ctx, "result_cache_misses", result_cache_misses);
+	RedisModule_InfoAddFieldULongLong(ctx, "evicted_graphs", evicted_graphs);
+	RedisModule_InfoAddFieldULongLong(ctx, "graph_evictions", Eviction_EvictionCount());
+	_AddFieldMs(ctx, "matrix_sync_time_ms",
+			__atomic_load_n(&_sync_time, __ATOMIC_RELAXED));
+	_AddFieldMs(ctx, "gil_wait_time_ms",
+			__atomic_load_n(&_gil_wait, __ATOMIC_RELAXED));
+	for(int i = 0; i < METRICS_MEM_COUNT; i++) {
+		RedisModule_InfoAddFieldULongLong(ctx, (char *)_memory_names[i], memory[i]);
+	}
+
+	char field[256];
+	for(int i = 0; i < METRICS_CMD_COUNT; i++) {
+		snprintf(field, sizeof(field), "latency_%s", _command_names[i]);
+		_AddLatencyField(ctx, field, _latency + i);
+	}
+
+	// a field per graph and command
+	RedisModule_InfoAddSection(ctx, "graphs");
+	for(uint i = 0; i < graph_count; i++) {
+		GraphContext *gc = graphs_in_keyspace[i];
+		GraphMetrics *gm = GraphContext_GetMetrics(gc);
+		RedisModule_InfoBeginDictField(ctx, gc->graph_name);
+		for(int j = 0; j < METRICS_MEM_COUNT; j++) {
+			RedisModule_InfoAddFieldULongLong(ctx, (char *)_memory_names[j],
+					gm->memory[j]);
+		}
+
+		// resources consumed by the graph's queries, see GRAPH_CPU_QUOTA
+		uint64_t running;
+		double cpu_time;
+		uint64_t rejected;
+		QueryQuota_Usage(&gc->quota, &running, &cpu_time, &rejected);
+		RedisModule_InfoAddFieldULongLong(ctx, "running_queries", running);
+		RedisModule_InfoAddFieldULongLong(ctx, "cpu_time_ms", (uint64_t)cpu_time);
+		RedisModule_InfoAddFieldULongLong(ctx, "quota_rejected_queries", rejected);
+
+		// time spent waiting for the graph's contended locks
+		// evicted graphs hold no locks
+		const Graph *g = gc->g;
+		_AddFieldMs(ctx, "read_lock_wait_ms",
+				(g) ? Graph_LockWait(g, GRAPH_LOCK_READ) * 1000 : 0);
+		_AddFieldMs(ctx, "write_lock_wait_ms",
+				(g) ? Graph_LockWait(g, GRAPH_LOCK_WRITE) * 1000 : 0);
+		_AddFieldMs(ctx, "writers_wait_ms",
+				(g) ? Graph_LockWait(g, GRAPH_LOCK_WRITERS) * 1000 : 0);
+		RedisModule_InfoEndDictField(ctx);
+
+		for(int j = 0; j < METRICS_CMD_COUNT; j++) {
+			snprintf(field, sizeof(field), "%s_latency_%s", gc->graph_name,
+					_command_names[j]);
+			_AddLatencyField(ctx, field, gm->latency[j]);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../redismodule.h"
+#include "../util/sketch/histogram.h"
+#include <stddef.h>
+
+// commands whose latency is tracked
+typedef enum {
+	METRICS_CMD_QUERY,     // GRAPH.QUERY
+	METRICS_CMD_RO_QUERY,  // GRAPH.RO_QUERY
+	METRICS_CMD_BULK,      // GRAPH.BULK
+	METRICS_CMD_DELETE,    // GRAPH.DELETE
+	METRICS_CMD_COUNT
+} MetricsCommand;
+
+// graph components whose memory consumption is reported
+typedef enum {
+	METRICS_MEM_ENTITIES,  // node and edge storage
+	METRICS_MEM_MATRICES,  // label and relation matrices
+	METRICS_MEM_INDEXES,   // exact-match indices, excluding RediSearch
+	METRICS_MEM_CACHE,     // cached execution plans
+	METRICS_MEM_COUNT
+} MetricsMemory;
+
+// metrics scoped to a single graph
+typedef struct {
+	Histogram *latency[METRICS_CMD_COUNT];  // latency in microseconds, per command
+	size_t memory[METRICS_MEM_COUNT];       // latest memory estimates, in bytes
+} GraphMetrics;
+
+// create metrics of a new graph
+GraphMetrics *GraphMetrics_New(void);
+
+// free graph metrics
+void GraphMetrics_Free
+(
+	GraphMetrics *gm  // graph metrics
+);
+
+// returns command name, e.g. "ro_query"
+const char *Metrics_CommandName
+(
+	MetricsCommand cmd  // command
+);
+
+// record the latency of a command
+// both globally and for the graph it ran against
+void Metrics_RecordLatency
+(
+	GraphMetrics *gm,    // graph metrics, NULL if not scoped to a graph
+	MetricsCommand cmd,  // executed command
+	double latency       // latency in milliseconds
+);
+
+// count a query rejected due to a full queue
+void Metrics_QueryRejected(void);
+
+// count a query which timed out
+void Metrics_QueryTimedOut(void);
+
+// count a write query executed anew, as the graph was modified
+// between its read phase and its commit
+void Metrics_WriteConflict(void);
+
+// accumulate time spent synchronizing matrices
+void Metrics_AddSyncTime
+(
+	double ms  // time in milliseconds
+);
+
+// accumulate time queries spent waiting for the redis global lock
+void Metrics_AddGILWaitTime
+(
+	double ms  // time in milliseconds
+);
+
+// report metrics via the redis INFO command
+// must be called from the redis main thread
+void Metrics_Info
+(
+	RedisModuleInfoCtx *ctx  // info context
+);
@@ -13,11 +13,17 @@
 #include "version.h"
 #include "util/arr.h"
 #include "util/cron.h"
+#include "util/tsc.h"
+#include "util/rmalloc.h"
 #include "query_ctx.h"
 #include "arithmetic/funcs.h"
 #include "commands/commands.h"
+#include "commands/query_cursor.h"
+#include "commands/prepared_statement.h"
 #include "util/thpool/pools.h"
 #include "graph/graphcontext.h"
+#include "maintenance/maintenance.h"
+#include "maintenance/eviction.h"
 #include "ast/cypher_whitelist.h"
 #include "procedures/procedure.h"
 #include "arithmetic/arithmetic_expression.h"
@@ -91,9 +97,13 @@ int RedisModule_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc)
 	RedisModule_Log(ctx, "notice", "Starting up RedisGraph version %d.%d.%d.",
 					REDISGRAPH_VERSION_MAJOR, REDISGRAPH_VERSION_MINOR, REDISGRAPH_VERSION_PATCH);
 
+	Alloc_EnableAccounting(); // Track per-query memory consumption.
+	TSC_Calibrate();          // Timestamps of sampled query executions.
 	Proc_Register();         // Register procedures.
 	AR_RegisterFuncs();      // Register arithmetic functions.
 	Cron_Start();            // Start CRON
+	QueryCursor_Init();      // Set up query cursors registry
+	PreparedStatement_Init(); // Set up prepared statements registry
 	// Set up global lock and variables scoped to the entire module.
 	_PrepareModuleGlobals(ctx, argv, argc);
 
@@ -108,15 +118,27 @@ int RedisModule_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc)
 	if(!ErrorCtx_Init()) return REDISMODULE_ERR;
 
 	int reader_thread_count;
-	int bulk_thread_count = 1;
-	int writer_thread_count = 1;
+	// a second bulk loader thread decodes a batch while another is committed
+	int bulk_thread_count = 2;
+	uint writer_thread_count;
+	uint max_reader_thread_count;
 	Config_Option_get(Config_THREAD_POOL_SIZE, &reader_thread_count);
+	Config_Option_get(Config_MAX_THREAD_COUNT, &max_reader_thread_count);
+	Config_Option_get(Config_WRITER_THREAD_COUNT, &writer_thread_count);
 
-	if(!ThreadPools_CreatePools(reader_thread_count, writer_thread_count, bulk_thread_count)) {
+	if(!ThreadPools_CreatePools(reader_thread_count, max_reader_thread_count,
+				writer_thread_count, bulk_thread_count)) {
 		return REDISMODULE_ERR;
 	}
 
 	RedisModule_Log(ctx, "notice", "Thread pool created, using %d threads.", reader_thread_count);
+	// readers are resized by THREAD_COUNT and THREAD_AUTOSCALE at runtime
+	ThreadPools_StartAutoscaler();
+	// graphs are maintained while threads are mostly idle
+	Maintenance_Start();
+	// cold graphs are evicted to disk once over the memory budget
+	Eviction_Start();
+	RedisModule_Log(ctx, "notice", "Writes are sharded across %u writer threads.", writer_thread_count);
 
 	int ompThreadCount;
 	Config_Option_get(Config_OPENMP_NTHREAD, &ompThreadCount);
@@ -125,6 +147,8 @@ int RedisModule_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc)
 		RedisModule_Log(ctx, "warning", "Failed to set OpenMP thread count to %d", ompThreadCount);
 		return REDISMODULE_ERR;
 	}
+	// executing queries share the OpenMP threads
+	ThreadPools_SetOpenMPBudget(ompThreadCount);
 	RedisModule_Log(ctx, "notice", "Maximum number of OpenMP threads set to %d", ompThreadCount);
 
 	// initialize array of command contexts
@@ -142,6 +166,21 @@ int RedisModule_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc)
 		return REDISMODULE_ERR;
 	}
 
+	if(RedisModule_CreateCommand(ctx, "graph.MULTI_QUERY", CommandDispatch, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.PREPARE", CommandDispatch, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.EXECUTE", Graph_Execute, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
 	if(RedisModule_CreateCommand(ctx, "graph.DELETE", Graph_Delete, "write", 1, 1,
 								 1) == REDISMODULE_ERR) {
 		return REDISMODULE_ERR;
@@ -177,6 +216,76 @@ int RedisModule_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc)
 		return REDISMODULE_ERR;
 	}
 
+	if(RedisModule_CreateCommand(ctx, "graph.CACHE", Graph_Cache, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.PLANSTATS", Graph_PlanStats, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.QUERYSTATS", Graph_QueryStats, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.MEMORY", Graph_Memory, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.CURSOR", Graph_Cursor, "readonly", 2, 2,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.COMPACT", Graph_Compact, "write", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.REORDER", Graph_Reorder, "write", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.EFFECT", Graph_Effect, "write deny-oom", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.RESTORE", Graph_Restore, "write deny-oom", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.COPY", Graph_Copy, "write deny-oom", 1, 2,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.VIEW", Graph_View, "write deny-oom", 2, 2,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.RO_VIEW", Graph_View, "readonly", 2, 2,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.MAINTENANCE", Graph_Maintenance, "readonly", 0, 0,
+								 0) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
+	if(RedisModule_CreateCommand(ctx, "graph.EXPORT", Graph_Export, "readonly", 1, 1,
+								 1) == REDISMODULE_ERR) {
+		return REDISMODULE_ERR;
+	}
+
 	setupCrashHandlers(ctx);
 
 	return REDISMODULE_OK;
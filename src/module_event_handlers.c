@@ -15,6 +15,7 @@
 #include "util/redis_version.h"
 #include "util/thpool/pools.h"
 #include "util/uuid.h"
+#include "util/datablock/datablock.h"
 
 // Global array tracking all extant GraphContexts.
 extern GraphContext **graphs_in_keyspace;
@@ -38,6 +39,13 @@ uint aux_field_counter = 0 ;
  * This field is used to represent when the module is replicating its graphs. */
 uint currently_decoding_graphs = 0;
 
+/* Graphs read locked from the start of a persistence event up until the fork
+ * it precedes, or its end once persisted by the main thread.
+ * Writers modify graphs without holding the GIL, see QueryCtx_LockForCommit,
+ * the lock keeps a commit from interleaving with the creation of the graphs'
+ * meta keys and from being halfway through once the process forks. */
+static GraphContext **_locked_graphs = NULL;
+
 /* This callback invokes once rename for a graph is done. Since the key value is a graph context
  * which saves the name of the graph for later key accesses, this data must be consistent with the key name,
  * otherwise, the graph context will remain with the previous graph name, and a key access to this name might
@@ -77,11 +85,15 @@ static bool _GraphContext_NameContainsTag(const GraphContext *gc) {
 
 // Calculate how many virtual keys are needed to represent the graph.
 static uint64_t _GraphContext_RequiredMetaKeys(const GraphContext *gc) {
+	// evicted graphs are saved as a single key
+	if(GraphContext_IsEvicted(gc)) return 0;
+
 	uint64_t vkey_entity_count;
 	Config_Option_get(Config_VKEY_MAX_ENTITY_COUNT, &vkey_entity_count);
 
+	// each relation matrix is encoded as a single entity
 	uint64_t entities_count = Graph_NodeCount(gc->g) + Graph_EdgeCount(gc->g) + Graph_DeletedNodeCount(
-								  gc->g) + Graph_DeletedEdgeCount(gc->g);
+								  gc->g) + Graph_DeletedEdgeCount(gc->g) + Graph_RelationTypeCount(gc->g);
 	if(entities_count == 0) return 0;
 	// Calculate the required keys and substruct one since there is also the graph context key.
 	uint64_t key_count = ceil((double)entities_count / vkey_entity_count) - 1;
@@ -148,6 +160,9 @@ static void _CreateKeySpaceMetaKeys(RedisModuleCtx *ctx) {
 	uint graphs_in_keyspace_count = array_len(graphs_in_keyspace);
 	for(uint i = 0; i < graphs_in_keyspace_count; i ++) {
 		_CreateGraphMetaKeys(ctx, graphs_in_keyspace[i]);
+		/* A forked child can't acquire the cache lock,
+		 * snapshot the queries saved after the keyspace ahead of forking. */
+		GraphContext_SnapshotHotQueries(graphs_in_keyspace[i]);
 	}
 }
 
@@ -164,6 +179,7 @@ static void _ClearKeySpaceMetaKeys(RedisModuleCtx *ctx, bool decode) {
 	uint graphs_in_keyspace_count = array_len(graphs_in_keyspace);
 	for(uint i = 0; i < graphs_in_keyspace_count; i ++) {
 		_DeleteGraphMetaKeys(ctx, graphs_in_keyspace[i], decode);
+		GraphContext_ClearHotQueries(graphs_in_keyspace[i]);
 	}
 }
 
@@ -177,6 +193,33 @@ static void _FlushDBHandler(RedisModuleCtx *ctx, RedisModuleEvent eid, uint64_t
 	}
 }
 
+static void _LockKeySpaceGraphs(void) {
+	ASSERT(_locked_graphs == NULL);
+	uint graphs_in_keyspace_count = array_len(graphs_in_keyspace);
+	_locked_graphs = array_new(GraphContext *, graphs_in_keyspace_count);
+	for(uint i = 0; i < graphs_in_keyspace_count; i ++) {
+		GraphContext *gc = graphs_in_keyspace[i];
+		// an evicted graph is saved from its encoding, which needs no lock
+		if(GraphContext_IsEvicted(gc)) continue;
+		// retained graphs aren't evicted while their lock is held
+		GraphContext_Retain(gc);
+		Graph_AcquireReadLock(gc->g);
+		_locked_graphs = array_append(_locked_graphs, gc);
+	}
+}
+
+static void _UnlockKeySpaceGraphs(void) {
+	if(_locked_graphs == NULL) return;
+	uint locked_count = array_len(_locked_graphs);
+	for(uint i = 0; i < locked_count; i ++) {
+		GraphContext *gc = _locked_graphs[i];
+		Graph_ReleaseLock(gc->g);
+		GraphContext_Release(gc);
+	}
+	array_free(_locked_graphs);
+	_locked_graphs = NULL;
+}
+
 // Checks if the event is persistence start event.
 static bool _IsEventPersistenceStart(RedisModuleEvent eid, uint64_t subevent) {
 	return eid.id == REDISMODULE_EVENT_PERSISTENCE  &&
@@ -197,8 +240,14 @@ static bool _IsEventPersistenceEnd(RedisModuleEvent eid, uint64_t subevent) {
 // Server persistence event handler.
 static void _PersistenceEventHandler(RedisModuleCtx *ctx, RedisModuleEvent eid, uint64_t subevent,
 									 void *data) {
-	if(_IsEventPersistenceStart(eid, subevent)) _CreateKeySpaceMetaKeys(ctx);
-	else if(_IsEventPersistenceEnd(eid, subevent)) _ClearKeySpaceMetaKeys(ctx, false);
+	if(_IsEventPersistenceStart(eid, subevent)) {
+		_LockKeySpaceGraphs();
+		_CreateKeySpaceMetaKeys(ctx);
+	} else if(_IsEventPersistenceEnd(eid, subevent)) {
+		// Persisted by the main thread, or failed to fork.
+		_UnlockKeySpaceGraphs();
+		_ClearKeySpaceMetaKeys(ctx, false);
+	}
 }
 
 // Perform clean-up upon server shutdown.
@@ -233,10 +282,19 @@ static void RG_AfterForkChild() {
 	process_is_child = true;
 }
 
+static void RG_AfterForkParent() {
+	/* The child shares the parent's pages copy-on-write until it exits,
+	 * have writes allocate fresh entity blocks rather than reuse shared ones. */
+	DataBlock_SetForkActive(true);
+	// The child holds a copy of consistent graphs, writers may resume.
+	_UnlockKeySpaceGraphs();
+}
+
 static void _RegisterForkHooks() {
 	/* Register handlers to control the behavior of fork calls.
-	 * Only the child process requires a handler, to prevent the acquisition of locks it doesn't own. */
-	int res = pthread_atfork(NULL, NULL, RG_AfterForkChild);
+	 * The child requires a handler to prevent the acquisition of locks it doesn't own,
+	 * the parent tracks the fork to avoid touching pages shared with the child. */
+	int res = pthread_atfork(NULL, RG_AfterForkParent, RG_AfterForkChild);
 	ASSERT(res == 0);
 }
 
@@ -270,6 +328,13 @@ void ModuleEventHandler_DecreaseDecodingGraphsCount(void) {
 	_ModuleEventHandler_TryClearKeyspace();
 }
 
+void ModuleEventHandler_UpdateForkState(RedisModuleCtx *ctx) {
+	// Set by RG_AfterForkParent, cleared once Redis reports no active child.
+	if(!(RedisModule_GetContextFlags(ctx) & REDISMODULE_CTX_FLAGS_ACTIVE_CHILD)) {
+		DataBlock_SetForkActive(false);
+	}
+}
+
 void RegisterEventHandlers(RedisModuleCtx *ctx) {
 	_RegisterForkHooks();       // Set up hooks for forking logic to prevent bgsave deadlocks.
 	_RegisterServerEvents(ctx); // Set up hooks for rename and server events on Redis 6 and up.
@@ -10,3 +10,7 @@
 
 // Register event handlers for Redis server, keyspace and fork events.
 void RegisterEventHandlers(RedisModuleCtx *ctx);
+
+// Refresh the fork state, called on Redis main thread before dispatching a query,
+// while a forked child is active entity slots shared with it are not reused.
+void ModuleEventHandler_UpdateForkState(RedisModuleCtx *ctx);
@@ -0,0 +1,189 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_betweenness.h"
+#include "proc_projection.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/centrality.h"
+
+// every node is reported along with the number of shortest paths
+// between other nodes passing through it, each path weighted by
+// the inverse of the number of shortest paths connecting its endpoints
+//
+// if 'samples' is specified, only paths originating at a random sample
+// of nodes are considered and centrality is scaled accordingly
+//
+// CALL algo.betweenness(NULL, NULL, NULL)         YIELD node, centrality
+// CALL algo.betweenness('User', 'FOLLOWS', NULL)  YIELD node, centrality
+// CALL algo.betweenness('User', 'FOLLOWS', 1000)  YIELD node, centrality
+
+typedef struct {
+	GrB_Index n;              // number of nodes
+	GrB_Index i;              // current node to return
+	Graph *g;                 // graph
+	Node node;                // node
+	GrB_Index *rows;          // rows of existing nodes
+	GrB_Index *mapping;       // mapping between extracted matrix rows and node ids
+	double *centrality;       // centrality of each row
+	SIValue *output;          // array with 4 entries ["node", node, "centrality", c]
+} BetweennessContext;
+
+// collect the rows of 'S' associated with existing nodes
+static GrB_Index *_ExistingRows(Graph *g, GrB_Matrix S, const GrB_Index *mapping,
+								GrB_Index *count) {
+	GrB_Index n;
+	GrB_Matrix_nrows(&n, S);
+	GrB_Index node_count = Graph_RequiredMatrixDim(g);
+	GrB_Index *rows = rm_malloc(sizeof(GrB_Index) * n);
+
+	*count = 0;
+	for(GrB_Index i = 0; i < n; i++) {
+		Node node;
+		NodeID id = (mapping) ? mapping[i] : i;
+		if(id >= node_count || !Graph_GetNode(g, id, &node)) continue;
+		rows[(*count)++] = i;
+	}
+	return rows;
+}
+
+static ProcedureResult Proc_BetweennessInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting 3 arguments, and an optional configuration map
+	uint argc = array_len((SIValue *)args);
+	if(argc != 3 && argc != 4) return PROCEDURE_ERR;
+	// arg0 and arg1 can be either String or NULL, arg2 either Integer or NULL
+	SIType arg0_t = SI_TYPE(args[0]);
+	SIType arg1_t = SI_TYPE(args[1]);
+	SIType arg2_t = SI_TYPE(args[2]);
+	if(!(arg0_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg2_t & (T_INT64 | T_NULL))) return PROCEDURE_ERR;
+	if(arg2_t == T_INT64 && args[2].longval <= 0) return PROCEDURE_ERR;
+
+	// optional configuration map can specify a projection
+	const char *projection;
+	SIValue config = (argc == 4) ? args[3] : SI_NullVal();
+	if(!Proc_ProjectionConfig("algo.betweenness", config, &projection)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	Graph *g = QueryCtx_GetGraph();
+
+	// setup context
+	BetweennessContext *pdata = rm_malloc(sizeof(BetweennessContext));
+	pdata->n = 0;
+	pdata->i = 0;
+	pdata->g = g;
+	pdata->node = GE_NEW_NODE();
+	pdata->rows = NULL;
+	pdata->mapping = NULL;
+	pdata->centrality = NULL;
+	pdata->output = array_new(SIValue, 4);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
+	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("centrality"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+	ctx->privateData = pdata;
+
+	GrB_Matrix S;
+	bool shared;
+	ProcedureResult res = Proc_AlgorithmGraph("algo.betweenness", projection, args[0], args[1],
+			false, &S, &pdata->mapping, &shared);
+	// unknown schema or projection
+	if(S == GrB_NULL) return res;
+
+	GrB_Info info;
+	pdata->rows = _ExistingRows(g, S, pdata->mapping, &pdata->n);
+
+	// paths originate at every node, or at a random sample of nodes
+	GrB_Index *sources = pdata->rows;
+	GrB_Index source_count = pdata->n;
+	if(arg2_t == T_INT64 && (GrB_Index)args[2].longval < pdata->n) {
+		source_count = args[2].longval;
+		sources = rm_malloc(sizeof(GrB_Index) * pdata->n);
+		memcpy(sources, pdata->rows, sizeof(GrB_Index) * pdata->n);
+		// partial Fisher-Yates shuffle
+		for(GrB_Index i = 0; i < source_count; i++) {
+			GrB_Index j = i + random() % (pdata->n - i);
+			GrB_Index tmp = sources[i];
+			sources[i] = sources[j];
+			sources[j] = tmp;
+		}
+	}
+
+	info = Betweenness(&pdata->centrality, S, sources, source_count);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	// scale sampled centrality to the whole graph
+	if(sources != pdata->rows) {
+		GrB_Index n;
+		GrB_Matrix_nrows(&n, S);
+		double scale = (double)pdata->n / source_count;
+		for(GrB_Index i = 0; i < n; i++) pdata->centrality[i] *= scale;
+		rm_free(sources);
+	}
+
+	if(!shared) GrB_free(&S);
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_BetweennessStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	BetweennessContext *pdata = (BetweennessContext *)ctx->privateData;
+
+	// depleted/no results
+	if(pdata->i >= pdata->n) return NULL;
+
+	GrB_Index row = pdata->rows[pdata->i++];
+	NodeID node_id = (pdata->mapping) ? pdata->mapping[row] : row;
+	Graph_GetNode(pdata->g, node_id, &pdata->node);
+
+	pdata->output[1] = SI_Node(&pdata->node);
+	pdata->output[3] = SI_DoubleVal(pdata->centrality[row]);
+	return pdata->output;
+}
+
+static ProcedureResult Proc_BetweennessFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		BetweennessContext *pdata = ctx->privateData;
+		if(pdata->output) array_free(pdata->output);
+		if(pdata->rows) rm_free(pdata->rows);
+		if(pdata->mapping) rm_free(pdata->mapping);
+		if(pdata->centrality) rm_free(pdata->centrality);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_BetweennessCtx() {
+	void *privateData = NULL;
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 2);
+	ProcedureOutput output_node = {.name = "node", .type = T_NODE};
+	ProcedureOutput output_centrality = {.name = "centrality", .type = T_DOUBLE};
+	outputs = array_append(outputs, output_node);
+	outputs = array_append(outputs, output_centrality);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.betweenness",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_BetweennessStep,
+								   Proc_BetweennessInvoke,
+								   Proc_BetweennessFree,
+								   privateData,
+								   true);
+	return ctx;
+}
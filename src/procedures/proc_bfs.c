@@ -13,37 +13,57 @@
 #include "../util/rmalloc.h"
 #include "../datatypes/array.h"
 #include "../graph/graphcontext.h"
-#include "../algorithms/LAGraph_bfs_pushpull.h"
+#include "../errors.h"
+#include "../algorithms/multi_source_bfs.h"
 
-// The BFS procedure performs a single source BFS scan
+// The BFS procedure performs a BFS scan from one or more sources
 // it's inputs are:
-// 1. source node to traverse from
+// 1. source node or list of source nodes to traverse from
 // 2. depth, how deep should the procedure traverse (0 no limit)
-// 3. relationship type to traverse, (NULL for edge type agnostic)
+// 3. relationship type or list of relationship types to traverse,
+//    (NULL for edge type agnostic)
+// 4. optional, maximum number of nodes discovered per level (0 no limit)
+//
+// every node is reached at the depth of its closest source
 //
 // output:
 // 1. nodes - an array of reachable nodes
 // 2. edges- an array of edges traversed
 //
+// or, one row per reached node, sources included at level 0:
+// 1. node - reached node
+// 2. level - depth at which node was reached
+//
 // MATCH (a:User {id: 1}) CALL algo.bfs(a, 0, 'MANAGES') YIELD nodes, edges
+// MATCH (a:User) WITH collect(a) AS users
+// CALL algo.bfs(users, 2, ['MANAGES', 'KNOWS'], 100) YIELD node, level
 
 typedef struct {
 	Graph *g;                       // Graph scanned.
 	GrB_Index n;                    // Total number of results.
+	GrB_Index i;                    // Current result to stream.
 	bool depleted;                  // True if BFS has already been performed for this node.
-	int reltype_id;                 // ID of relationship matrix to traverse.
+	int *reltype_ids;               // IDs of relationship matrices to traverse, NULL for all.
 	SIValue *output;                // Array with a maximum of 4 entries: ["nodes", nodes, "edges", edges].
 	bool yield_nodes;               // Return reachable nodes.
 	bool yield_edges;               // Return edges traversed.
-	GrB_Vector nodes;               // Vector of reachable nodes.
+	bool yield_node;                // Stream reached nodes.
+	bool yield_level;               // Stream levels of reached nodes.
+	Node node;                      // Streamed node.
+	GrB_Index *ids;                 // Reached nodes.
+	uint64_t *levels;               // Level of each reached node.
 	GrB_Vector parents;             // Vector associating each node in the BFS tree with its parent.
 	int nodes_output_idx;           // Offset of nodes array in outputs
 	int edges_output_idx;           // Offset of edges array in outputs
+	int node_output_idx;            // Offset of streamed node in outputs
+	int level_output_idx;           // Offset of streamed level in outputs
 } BFSCtx;
 
 static void _process_yield(BFSCtx *ctx, const char **yield) {
 	bool yield_nodes = false;
 	bool yield_edges = false;
+	bool yield_node = false;
+	bool yield_level = false;
 
 	if(yield != NULL) {
 		for(uint i = 0; i < array_len(yield); i++) {
@@ -55,6 +75,14 @@ static void _process_yield(BFSCtx *ctx, const char **yield) {
 				yield_edges = true;
 				continue;
 			}
+			if(strcasecmp("node", yield[i]) == 0) {
+				yield_node = true;
+				continue;
+			}
+			if(strcasecmp("level", yield[i]) == 0) {
+				yield_level = true;
+				continue;
+			}
 		}
 	} else {
 		/* User did not add an explicit YIELD
@@ -65,6 +93,8 @@ static void _process_yield(BFSCtx *ctx, const char **yield) {
 
 	ctx->yield_nodes = yield_nodes;
 	ctx->yield_edges = yield_edges;
+	ctx->yield_node = yield_node;
+	ctx->yield_level = yield_level;
 
 	if(yield_nodes) {
 		ctx->output = array_append(ctx->output, SI_ConstStringVal("nodes"));
@@ -77,6 +107,76 @@ static void _process_yield(BFSCtx *ctx, const char **yield) {
 		ctx->edges_output_idx = array_len(ctx->output);
 		ctx->output = array_append(ctx->output, SI_NullVal()); // Place holder.
 	}
+
+	if(yield_node) {
+		ctx->output = array_append(ctx->output, SI_ConstStringVal("node"));
+		ctx->node_output_idx = array_len(ctx->output);
+		ctx->output = array_append(ctx->output, SI_NullVal()); // Place holder.
+	}
+
+	if(yield_level) {
+		ctx->output = array_append(ctx->output, SI_ConstStringVal("level"));
+		ctx->level_output_idx = array_len(ctx->output);
+		ctx->output = array_append(ctx->output, SI_NullVal()); // Place holder.
+	}
+}
+
+// returns true if 'v' is a node or a list of nodes
+static bool _ValidSources(SIValue v) {
+	if(SI_TYPE(v) == T_NODE) return true;
+	if(SI_TYPE(v) != T_ARRAY) return false;
+	uint len = SIArray_Length(v);
+	for(uint i = 0; i < len; i++) {
+		if(SI_TYPE(SIArray_Get(v, i)) != T_NODE) return false;
+	}
+	return true;
+}
+
+// returns true if 'v' is NULL, a string or a list of strings
+static bool _ValidRelationships(SIValue v) {
+	if(SI_TYPE(v) & (T_NULL | T_STRING)) return true;
+	if(SI_TYPE(v) != T_ARRAY) return false;
+	uint len = SIArray_Length(v);
+	for(uint i = 0; i < len; i++) {
+		if(SI_TYPE(SIArray_Get(v, i)) != T_STRING) return false;
+	}
+	return true;
+}
+
+// collect the IDs of the traversed relationship types
+// returns NULL if every relationship type is traversed
+static int *_RelationshipIDs(GraphContext *gc, SIValue v) {
+	if(SIValue_IsNull(v)) return NULL;
+
+	int *ids = array_new(int, 1);
+	uint len = (SI_TYPE(v) == T_STRING) ? 1 : SIArray_Length(v);
+	for(uint i = 0; i < len; i++) {
+		SIValue reltype = (SI_TYPE(v) == T_STRING) ? v : SIArray_Get(v, i);
+		Schema *s = GraphContext_GetSchema(gc, reltype.stringval, SCHEMA_EDGE);
+		// unknown relationship types are never traversed
+		if(s) ids = array_append(ids, s->id);
+	}
+	return ids;
+}
+
+// retrieve the matrix to traverse, sets 'free_R' if it must be freed
+static GrB_Matrix _TraversedMatrix(Graph *g, const int *reltype_ids, bool *free_R) {
+	*free_R = false;
+	if(reltype_ids == NULL) return Graph_GetAdjacencyMatrix(g);
+
+	uint count = array_len((int *)reltype_ids);
+	if(count == 1) return Graph_GetRelationMatrix(g, reltype_ids[0]);
+
+	// union of the traversed relationship matrices
+	GrB_Matrix R;
+	GrB_Index n = Graph_RequiredMatrixDim(g);
+	GrB_Matrix_new(&R, GrB_BOOL, n, n);
+	for(uint i = 0; i < count; i++) {
+		GrB_Matrix M = Graph_GetRelationMatrix(g, reltype_ids[i]);
+		GrB_eWiseAdd(R, GrB_NULL, GrB_NULL, GrB_LOR, R, M, GrB_NULL);
+	}
+	*free_R = true;
+	return R;
 }
 
 static ProcedureResult Proc_BFS_Invoke(ProcedureCtx *ctx,
@@ -85,80 +185,128 @@ static ProcedureResult Proc_BFS_Invoke(ProcedureCtx *ctx,
 	ASSERT(ctx != NULL);
 	ASSERT(args != NULL);
 
-	if(array_len((SIValue *)args) != 3) return PROCEDURE_ERR;
-	if(SI_TYPE(args[0]) != T_NODE                 ||   // Source node.
+	uint argc = array_len((SIValue *)args);
+	if(argc != 3 && argc != 4) return PROCEDURE_ERR;
+	if(!_ValidSources(args[0])                    ||   // Source node(s).
 	   SI_TYPE(args[1]) != T_INT64                ||   // Max level to iterate to, unlimited if 0.
-	   !(SI_TYPE(args[2]) & (T_NULL | T_STRING)))      // Relationship type to traverse if not NULL.
+	   !_ValidRelationships(args[2]))                  // Relationship type(s) to traverse if not NULL.
 		return PROCEDURE_ERR;
+	// Max number of nodes discovered per level, unlimited if 0 or NULL.
+	if(argc == 4 && !(SI_TYPE(args[3]) & (T_NULL | T_INT64))) return PROCEDURE_ERR;
 
 	BFSCtx *bfs_ctx = ctx->privateData;
 	_process_yield(bfs_ctx, yield);
 
+	bool stream = bfs_ctx->yield_node || bfs_ctx->yield_level;
+	if(stream && (bfs_ctx->yield_nodes || bfs_ctx->yield_edges)) {
+		ErrorCtx_SetError("algo.BFS can't yield node or level along with nodes or edges");
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
 	//--------------------------------------------------------------------------
 	// Process inputs
 	//--------------------------------------------------------------------------
 
-	Node *source_node = args[0].ptrval;
 	int64_t max_level = args[1].longval;
-	const char *reltype = SIValue_IsNull(args[2]) ? NULL : args[2].stringval;
-
-	/* The BFS algorithm uses a level of 1 to indicate the source node.
-	 * If this value is not zero (unlimited), increment it by 1
-	 * to make level 1 indicate the source's direct neighbors. */
-	if(max_level > 0) max_level++;
-	GrB_Index src_id = ENTITY_GET_ID(source_node);
+	int64_t level_cap = (argc == 4 && !SIValue_IsNull(args[3])) ? args[3].longval : 0;
+	if(max_level < 0 || level_cap < 0) return PROCEDURE_ERR;
+
+	uint source_count = (SI_TYPE(args[0]) == T_NODE) ? 1 : SIArray_Length(args[0]);
+	GrB_Index *sources = rm_malloc(sizeof(GrB_Index) * source_count);
+	for(uint i = 0; i < source_count; i++) {
+		SIValue source = (SI_TYPE(args[0]) == T_NODE) ? args[0] : SIArray_Get(args[0], i);
+		sources[i] = ENTITY_GET_ID((Node *)source.ptrval);
+	}
 
-	// Get edge matrix and transpose matrix, if available.
-	GrB_Matrix R;
-	GrB_Matrix TR;
+	// Get edge matrix.
 	GraphContext *gc = QueryCtx_GetGraphCtx();
-	if(reltype == NULL) {
-		R = Graph_GetAdjacencyMatrix(gc->g);
-		TR = Graph_GetTransposedAdjacencyMatrix(gc->g);
-	} else {
-		Schema *s = GraphContext_GetSchema(gc, reltype, SCHEMA_EDGE);
-		if(!s) return PROCEDURE_OK; // Failed to find schema, first step will return NULL.
-		bfs_ctx->reltype_id = s->id;
-		R = Graph_GetRelationMatrix(gc->g, s->id);
-		bool maintain_transpose;
-		Config_Option_get(Config_MAINTAIN_TRANSPOSE, &maintain_transpose);
-		if(maintain_transpose) TR = Graph_GetTransposedRelationMatrix(gc->g, s->id);
-		else TR = GrB_NULL;
+	bfs_ctx->reltype_ids = _RelationshipIDs(gc, args[2]);
+	// Failed to find schema, first step will return NULL.
+	if(bfs_ctx->reltype_ids && array_len(bfs_ctx->reltype_ids) == 0) {
+		rm_free(sources);
+		return PROCEDURE_OK;
 	}
 
+	bool free_R;
+	GrB_Matrix R = _TraversedMatrix(gc->g, bfs_ctx->reltype_ids, &free_R);
+
 	/* If we're not collecting edges, pass a NULL parent pointer
 	 * so that the algorithm will not perform unnecessary work. */
 	GrB_Vector V = GrB_NULL;  // Vector of results
 	GrB_Vector PI = GrB_NULL; // Vector backtracking results to their parents.
 	GrB_Vector *pPI = &PI;
 	if(!bfs_ctx->yield_edges) pPI = NULL;
-	GrB_Info res = LAGraph_bfs_pushpull(&V, pPI, R, TR, src_id, NULL, max_level, true);
+	GrB_Info res = MultiSourceBFS(&V, pPI, R, sources, source_count, max_level,
+								  level_cap);
 	ASSERT(res == GrB_SUCCESS);
+	UNUSED(res);
+	if(free_R) GrB_free(&R);
+	rm_free(sources);
+
+	/* Sources are at level 0, when collecting arrays only
+	 * nodes reached from the sources are reported. */
+	if(!stream) {
+		GxB_Scalar thunk;
+		GxB_Scalar_new(&thunk, GrB_UINT64);
+		GxB_Scalar_setElement_UINT64(thunk, 0);
+		GxB_Vector_select(V, GrB_NULL, GrB_NULL, GxB_GT_THUNK, V, thunk, GrB_NULL);
+		GxB_Scalar_free(&thunk);
+	}
 
-	/* Remove all values with a level less than or equal to 1.
-	 * Values of 0 are not connected to the source, and values of 1 are the source. */
-	GxB_Scalar thunk;
-	GxB_Scalar_new(&thunk, GrB_UINT64);
-	GxB_Scalar_setElement_UINT64(thunk, 1);
-	GxB_Vector_select(V, GrB_NULL, GrB_NULL, GxB_GT_THUNK, V, thunk, GrB_NULL);
-	GxB_Scalar_free(&thunk);
-
-	// Get number of entries.
+	// Extract reached nodes, ordered by ID.
 	GrB_Index nvals;
 	GrB_Vector_nvals(&nvals, V);
+	bfs_ctx->ids = rm_malloc(sizeof(GrB_Index) * nvals);
+	bfs_ctx->levels = rm_malloc(sizeof(uint64_t) * nvals);
+	GrB_Vector_extractTuples_UINT64(bfs_ctx->ids, bfs_ctx->levels, &nvals, V);
+	GrB_free(&V);
 
 	bfs_ctx->n = nvals;
-	bfs_ctx->nodes = V;
 	bfs_ctx->parents = PI;
 
 	return PROCEDURE_OK;
 }
 
+// retrieve the edge connecting 'parent' to 'id'
+static void _ParentEdge(BFSCtx *bfs_ctx, NodeID parent_id, NodeID id, Edge **edge) {
+	if(bfs_ctx->reltype_ids == NULL) {
+		Graph_GetEdgesConnectingNodes(bfs_ctx->g, parent_id, id, GRAPH_NO_RELATION, edge);
+		return;
+	}
+
+	uint count = array_len(bfs_ctx->reltype_ids);
+	for(uint i = 0; i < count && array_len(*edge) == 0; i++) {
+		Graph_GetEdgesConnectingNodes(bfs_ctx->g, parent_id, id,
+									  bfs_ctx->reltype_ids[i], edge);
+	}
+}
+
+// stream a single reached node
+static SIValue *_BFS_StreamStep(BFSCtx *bfs_ctx) {
+	while(bfs_ctx->i < bfs_ctx->n) {
+		GrB_Index k = bfs_ctx->i++;
+		if(!Graph_GetNode(bfs_ctx->g, bfs_ctx->ids[k], &bfs_ctx->node)) continue;
+
+		if(bfs_ctx->yield_node) {
+			bfs_ctx->output[bfs_ctx->node_output_idx] = SI_Node(&bfs_ctx->node);
+		}
+		if(bfs_ctx->yield_level) {
+			bfs_ctx->output[bfs_ctx->level_output_idx] = SI_LongVal(bfs_ctx->levels[k]);
+		}
+		return bfs_ctx->output;
+	}
+
+	return NULL;
+}
+
 static SIValue *Proc_BFS_Step(ProcedureCtx *ctx) {
 	ASSERT(ctx->privateData);
 
 	BFSCtx *bfs_ctx = (BFSCtx *)ctx->privateData;
 
+	if(bfs_ctx->yield_node || bfs_ctx->yield_level) return _BFS_StreamStep(bfs_ctx);
+
 	// Return NULL if the BFS for this source has already been emitted or there are no connected nodes.
 	if(bfs_ctx->depleted || bfs_ctx->n == 0) return NULL;
 
@@ -169,26 +317,19 @@ static SIValue *Proc_BFS_Step(ProcedureCtx *ctx) {
 	if(bfs_ctx->yield_edges) edges = SI_Array(n);
 	Edge *edge = array_new(Edge, 1);
 
-	// Setup result iterator
-	NodeID id;
-	GrB_Info res;
-	bool depleted;
-	GxB_MatrixTupleIter *iter;
+	// retrieve reached nodes at once, prefetching their storage
+	Node *reached = NULL;
+	if(bfs_ctx->yield_nodes) {
+		reached = rm_malloc(sizeof(Node) * n);
+		for(uint i = 0; i < n; i++) reached[i] = GE_NEW_NODE();
+		Graph_GetNodes(bfs_ctx->g, bfs_ctx->ids, n, reached);
+	}
 
-	UNUSED(res);
-	res = GxB_MatrixTupleIter_new(&iter, (GrB_Matrix)bfs_ctx->nodes);
-	ASSERT(res == GrB_SUCCESS);
-	res = GxB_MatrixTupleIter_next(iter, NULL, &id, &depleted);
-	ASSERT(res == GrB_SUCCESS);
+	for(uint i = 0; i < n; i++) {
+		NodeID id = bfs_ctx->ids[i];
 
-	while(!depleted) {
-		// Get the reached node.
-		if(bfs_ctx->yield_nodes) {
-			// Append each reachable node to the nodes output array.
-			Node n = GE_NEW_NODE();
-			Graph_GetNode(bfs_ctx->g, id, &n);
-			SIArray_Append(&nodes, SI_Node(&n));
-		}
+		// Append each reachable node to the nodes output array.
+		if(bfs_ctx->yield_nodes) SIArray_Append(&nodes, SI_Node(reached + i));
 
 		array_clear(edge);
 		if(bfs_ctx->yield_edges) {
@@ -196,18 +337,15 @@ static SIValue *Proc_BFS_Step(ProcedureCtx *ctx) {
 			// Find the parent of the reached node.
 			GrB_Info res = GrB_Vector_extractElement(&parent_id, bfs_ctx->parents, id);
 			ASSERT(res == GrB_SUCCESS);
-			parent_id --; // Decrement the parent ID by 1 to correct 1-indexing.
+			UNUSED(res);
 			// Retrieve edges connecting the parent node to the current node.
-			Graph_GetEdgesConnectingNodes(bfs_ctx->g, parent_id, id, bfs_ctx->reltype_id, &edge);
+			_ParentEdge(bfs_ctx, parent_id, id, &edge);
 			// Append one edge to the edges output array.
 			SIArray_Append(&edges, SI_Edge(edge));
 		}
-
-		res = GxB_MatrixTupleIter_next(iter, NULL, &id, &depleted);
-		ASSERT(res == GrB_SUCCESS);
 	}
 
-	bfs_ctx->depleted = depleted; // Mark that this node has been mapped.
+	bfs_ctx->depleted = true; // Mark that this node has been mapped.
 
 	// Populate output.
 	if(bfs_ctx->yield_nodes) bfs_ctx->output[bfs_ctx->nodes_output_idx] = nodes;
@@ -215,7 +353,7 @@ static SIValue *Proc_BFS_Step(ProcedureCtx *ctx) {
 
 	// Clean up.
 	array_free(edge);
-	GxB_MatrixTupleIter_free(iter);
+	if(reached) rm_free(reached);
 
 	return bfs_ctx->output;
 }
@@ -225,7 +363,9 @@ static ProcedureResult Proc_BFS_Free(ProcedureCtx *ctx) {
 	// Free private data.
 	BFSCtx *pdata = ctx->privateData;
 	if(pdata->output != NULL) array_free(pdata->output);
-	if(pdata->nodes != NULL) GrB_Vector_free(&pdata->nodes);
+	if(pdata->ids != NULL) rm_free(pdata->ids);
+	if(pdata->levels != NULL) rm_free(pdata->levels);
+	if(pdata->reltype_ids != NULL) array_free(pdata->reltype_ids);
 	if(pdata->parents != NULL) GrB_Vector_free(&pdata->parents);
 	rm_free(ctx->privateData);
 
@@ -236,15 +376,22 @@ static BFSCtx *_Build_Private_Data() {
 	// Set up the BFS context.
 	BFSCtx *pdata = rm_calloc(1, sizeof(BFSCtx));
 	pdata->n = 0;
-	pdata->nodes = GrB_NULL;
+	pdata->i = 0;
+	pdata->ids = NULL;
+	pdata->levels = NULL;
 	pdata->depleted = false;
 	pdata->parents = GrB_NULL;
+	pdata->node = GE_NEW_NODE();
 	pdata->yield_nodes = false;
 	pdata->yield_edges = false;
+	pdata->yield_node = false;
+	pdata->yield_level = false;
 	pdata->nodes_output_idx = -1;
 	pdata->edges_output_idx = -1;
+	pdata->node_output_idx = -1;
+	pdata->level_output_idx = -1;
 	pdata->g = QueryCtx_GetGraph();
-	pdata->reltype_id = GRAPH_NO_RELATION;
+	pdata->reltype_ids = NULL;
 	pdata->output = array_new(SIValue, 4);
 	return pdata;
 }
@@ -254,14 +401,18 @@ ProcedureCtx *Proc_BFS_Ctx() {
 	void *privdata = _Build_Private_Data();
 
 	// Declare possible outputs.
-	ProcedureOutput *outputs = array_new(ProcedureOutput, 2);
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 4);
 	ProcedureOutput out_nodes = {.name = "nodes", .type = T_ARRAY};
 	ProcedureOutput out_edges = {.name = "edges", .type = T_ARRAY};
+	ProcedureOutput out_node = {.name = "node", .type = T_NODE};
+	ProcedureOutput out_level = {.name = "level", .type = T_INT64};
 	outputs = array_append(outputs, out_nodes);
 	outputs = array_append(outputs, out_edges);
+	outputs = array_append(outputs, out_node);
+	outputs = array_append(outputs, out_level);
 
 	ProcedureCtx *ctx = ProcCtxNew("algo.BFS",
-								   3,
+								   PROCEDURE_VARIABLE_ARG_COUNT,
 								   outputs,
 								   Proc_BFS_Step,
 								   Proc_BFS_Invoke,
@@ -9,6 +9,6 @@
 #include "proc_ctx.h"
 #include "../arithmetic/arithmetic_expression.h"
 
-// Perform BFS from a single source node.
+// Perform BFS from one or more source nodes.
 ProcedureCtx *Proc_BFS_Ctx();
 
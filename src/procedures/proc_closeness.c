@@ -0,0 +1,167 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_closeness.h"
+#include "proc_projection.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/centrality.h"
+
+// every node is reported along with its closeness centrality, the inverse
+// of its average distance to the nodes it reaches, and its harmonic centrality,
+// the sum of its inverse distances to all other nodes, normalized
+//
+// CALL algo.closeness(NULL, NULL)         YIELD node, closeness, harmonic
+// CALL algo.closeness('User', 'FOLLOWS')  YIELD node, closeness, harmonic
+
+typedef struct {
+	GrB_Index n;              // number of nodes
+	GrB_Index i;              // current node to return
+	Graph *g;                 // graph
+	Node node;                // node
+	GrB_Index *rows;          // rows of existing nodes
+	GrB_Index *mapping;       // mapping between extracted matrix rows and node ids
+	double *closeness;        // closeness centrality of each existing node
+	double *harmonic;         // harmonic centrality of each existing node
+	SIValue *output;          // array with 6 entries ["node", node, "closeness", c, "harmonic", h]
+} ClosenessContext;
+
+// collect the rows of 'S' associated with existing nodes
+static GrB_Index *_ExistingRows(Graph *g, GrB_Matrix S, const GrB_Index *mapping,
+								GrB_Index *count) {
+	GrB_Index n;
+	GrB_Matrix_nrows(&n, S);
+	GrB_Index node_count = Graph_RequiredMatrixDim(g);
+	GrB_Index *rows = rm_malloc(sizeof(GrB_Index) * n);
+
+	*count = 0;
+	for(GrB_Index i = 0; i < n; i++) {
+		Node node;
+		NodeID id = (mapping) ? mapping[i] : i;
+		if(id >= node_count || !Graph_GetNode(g, id, &node)) continue;
+		rows[(*count)++] = i;
+	}
+	return rows;
+}
+
+static ProcedureResult Proc_ClosenessInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting 2 arguments, and an optional configuration map
+	uint argc = array_len((SIValue *)args);
+	if(argc != 2 && argc != 3) return PROCEDURE_ERR;
+	// arg0 and arg1 can be either String or NULL
+	SIType arg0_t = SI_TYPE(args[0]);
+	SIType arg1_t = SI_TYPE(args[1]);
+	if(!(arg0_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+
+	// optional configuration map can specify a projection
+	const char *projection;
+	SIValue config = (argc == 3) ? args[2] : SI_NullVal();
+	if(!Proc_ProjectionConfig("algo.closeness", config, &projection)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	Graph *g = QueryCtx_GetGraph();
+
+	// setup context
+	ClosenessContext *pdata = rm_malloc(sizeof(ClosenessContext));
+	pdata->n = 0;
+	pdata->i = 0;
+	pdata->g = g;
+	pdata->node = GE_NEW_NODE();
+	pdata->rows = NULL;
+	pdata->mapping = NULL;
+	pdata->closeness = NULL;
+	pdata->harmonic = NULL;
+	pdata->output = array_new(SIValue, 6);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
+	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("closeness"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("harmonic"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+	ctx->privateData = pdata;
+
+	GrB_Matrix S;
+	bool shared;
+	ProcedureResult res = Proc_AlgorithmGraph("algo.closeness", projection, args[0], args[1],
+			false, &S, &pdata->mapping, &shared);
+	// unknown schema or projection
+	if(S == GrB_NULL) return res;
+
+	GrB_Info info;
+	pdata->rows = _ExistingRows(g, S, pdata->mapping, &pdata->n);
+
+	info = Closeness(&pdata->closeness, &pdata->harmonic, S, pdata->rows,
+					 pdata->n);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	if(!shared) GrB_free(&S);
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_ClosenessStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	ClosenessContext *pdata = (ClosenessContext *)ctx->privateData;
+
+	// depleted/no results
+	if(pdata->i >= pdata->n) return NULL;
+
+	GrB_Index k = pdata->i++;
+	GrB_Index row = pdata->rows[k];
+	NodeID node_id = (pdata->mapping) ? pdata->mapping[row] : row;
+	Graph_GetNode(pdata->g, node_id, &pdata->node);
+
+	pdata->output[1] = SI_Node(&pdata->node);
+	pdata->output[3] = SI_DoubleVal(pdata->closeness[k]);
+	pdata->output[5] = SI_DoubleVal(pdata->harmonic[k]);
+	return pdata->output;
+}
+
+static ProcedureResult Proc_ClosenessFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		ClosenessContext *pdata = ctx->privateData;
+		if(pdata->output) array_free(pdata->output);
+		if(pdata->rows) rm_free(pdata->rows);
+		if(pdata->mapping) rm_free(pdata->mapping);
+		if(pdata->closeness) rm_free(pdata->closeness);
+		if(pdata->harmonic) rm_free(pdata->harmonic);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_ClosenessCtx() {
+	void *privateData = NULL;
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 3);
+	ProcedureOutput output_node = {.name = "node", .type = T_NODE};
+	ProcedureOutput output_closeness = {.name = "closeness", .type = T_DOUBLE};
+	ProcedureOutput output_harmonic = {.name = "harmonic", .type = T_DOUBLE};
+	outputs = array_append(outputs, output_node);
+	outputs = array_append(outputs, output_closeness);
+	outputs = array_append(outputs, output_harmonic);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.closeness",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_ClosenessStep,
+								   Proc_ClosenessInvoke,
+								   Proc_ClosenessFree,
+								   privateData,
+								   true);
+	return ctx;
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "../value.h"
+#include "../graph/entities/node.h"
 
 // Procedure accepts a variable number of arguments.
 #define PROCEDURE_VARIABLE_ARG_COUNT UINT_MAX
@@ -31,12 +32,42 @@ typedef struct {
 	SIType type;    // Type of output.
 } ProcedureOutput;
 
+// Maximum number of rows in a block of procedure output.
+#define PROCEDURE_BATCH_SIZE 1024
+
+// Type of values held by a procedure output column.
+typedef enum {
+	PROCEDURE_COLUMN_VALUE,   // SIValue per row.
+	PROCEDURE_COLUMN_NODE,    // Node per row.
+	PROCEDURE_COLUMN_DOUBLE,  // double per row.
+} ProcedureColumnType;
+
+// A single procedure output column, pointing at procedure owned memory.
+typedef struct {
+	ProcedureColumnType type;
+	union {
+		const SIValue *values;
+		const Node *nodes;
+		const double *doubles;
+	};
+} ProcedureColumn;
+
+// A block of procedure output rows, stored column-wise.
+// columns[i] holds the values of the procedure's i-th output,
+// the block remains valid until the next call to the procedure's StepBatch.
+typedef struct {
+	uint count;                // Number of rows in the block.
+	ProcedureColumn *columns;  // One column per procedure output.
+} ProcedureBatch;
+
 struct ProcedureCtx;
 
 // Procedure instance generator.
 typedef struct ProcedureCtx *(*ProcGenerator)(void);
 // Procedure step function.
 typedef SIValue *(*ProcStep)(struct ProcedureCtx *ctx);
+// Procedure batched step function, returns NULL once depleted.
+typedef const ProcedureBatch *(*ProcStepBatch)(struct ProcedureCtx *ctx);
 // Procedure function pointer.
 typedef ProcedureResult(*ProcInvoke)(struct ProcedureCtx *ctx, const SIValue *args, const char **yield);
 // Procedure free resources.
@@ -50,9 +81,11 @@ struct ProcedureCtx {
 	ProcedureOutput *output;    // Procedure possible output(s).
 	void *privateData;          //
 	ProcStep Step;              //
+	ProcStepBatch StepBatch;    // Optional, produces a block of rows per call.
 	ProcInvoke Invoke;          //
 	ProcFree Free;              //
 	bool readOnly;              // Indicates if the procedure is able to mutate the graph.
+	uint limit_hint;            // Rows expected to be required from an invocation, UINT_MAX if unknown.
 };
 typedef struct ProcedureCtx ProcedureCtx;
 
@@ -0,0 +1,76 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_edge_create_index.h"
+#include "../value.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../index/index.h"
+
+//------------------------------------------------------------------------------
+// relationship createIndex
+//------------------------------------------------------------------------------
+
+// CALL db.idx.edge.createIndex(relation, fields...)
+// CALL db.idx.edge.createIndex('TRANSFER', 'ts', 'amount')
+ProcedureResult Proc_EdgeCreateIdxInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	uint arg_count = array_len((SIValue *)args);
+	if(arg_count < 2) return PROCEDURE_ERR;
+
+	// validation, all arguments should be of type string
+	for(uint i = 0; i < arg_count; i++) {
+		if(!(SI_TYPE(args[i]) & T_STRING)) return PROCEDURE_ERR;
+	}
+
+	// create relationship index
+	int res               = INDEX_FAIL;
+	Index *idx            = NULL;
+	GraphContext *gc      = QueryCtx_GetGraphCtx();
+	uint fields_count     = arg_count - 1;
+	const char *relation  = args[0].stringval;
+	const SIValue *fields = args + 1; // skip relationship type
+
+	// introduce fields to index
+	for(int i = 0; i < fields_count; i++) {
+		const char *field = fields[i].stringval;
+		if(GraphContext_AddEdgeIndex(&idx, gc, relation, field) == INDEX_OK) {
+			res = INDEX_OK;
+		}
+	}
+
+	// build index
+	if(res == INDEX_OK) Index_Construct(idx);
+
+	return PROCEDURE_OK;
+}
+
+SIValue *Proc_EdgeCreateIdxStep(ProcedureCtx *ctx) {
+	return NULL;
+}
+
+ProcedureResult Proc_EdgeCreateIdxFree(ProcedureCtx *ctx) {
+	// Clean up.
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_EdgeCreateIdxGen() {
+	void *privateData = NULL;
+	ProcedureOutput *output = array_new(ProcedureOutput, 0);
+	ProcedureCtx *ctx = ProcCtxNew("db.idx.edge.createIndex",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   output,
+								   Proc_EdgeCreateIdxStep,
+								   Proc_EdgeCreateIdxInvoke,
+								   Proc_EdgeCreateIdxFree,
+								   privateData,
+								   false);
+
+	return ctx;
+}
+
@@ -0,0 +1,62 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_edge_drop_index.h"
+#include "../query_ctx.h"
+#include "../value.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+
+//------------------------------------------------------------------------------
+// relationship dropIndex
+//------------------------------------------------------------------------------
+
+// CALL db.idx.edge.drop(relation, fields...)
+// CALL db.idx.edge.drop('TRANSFER', 'ts')
+
+ProcedureResult Proc_EdgeDropIdxInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	uint arg_count = array_len((SIValue *)args);
+	if(arg_count < 2) return PROCEDURE_ERR;
+
+	// validation, all arguments should be of type string
+	for(uint i = 0; i < arg_count; i++) {
+		if(!(SI_TYPE(args[i]) & T_STRING)) return PROCEDURE_ERR;
+	}
+
+	const char *relation = args[0].stringval;
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	for(uint i = 1; i < arg_count; i++) {
+		GraphContext_DeleteEdgeIndex(gc, relation, args[i].stringval);
+	}
+
+	return PROCEDURE_OK;
+}
+
+SIValue *Proc_EdgeDropIdxStep(ProcedureCtx *ctx) {
+	return NULL;
+}
+
+ProcedureResult Proc_EdgeDropIdxFree(ProcedureCtx *ctx) {
+	// Clean up.
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_EdgeDropIdxGen() {
+	void *privateData = NULL;
+	ProcedureOutput *output = array_new(ProcedureOutput, 0);
+	ProcedureCtx *ctx = ProcCtxNew("db.idx.edge.drop",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   output,
+								   Proc_EdgeDropIdxStep,
+								   Proc_EdgeDropIdxInvoke,
+								   Proc_EdgeDropIdxFree,
+								   privateData,
+								   false);
+
+	return ctx;
+}
@@ -0,0 +1,98 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_edge_weights.h"
+#include "../errors.h"
+#include "../query_ctx.h"
+#include "../value.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+
+// a promoted attribute is copied into typed matrices of its relationship type,
+// comparisons against constants on traversed edges are then evaluated within
+// GraphBLAS, promotions are kept in memory only, they're neither persisted
+// nor replicated
+//
+// CALL db.idx.weight.create('TX', 'amount')
+// MATCH (a)-[e:TX]->(b) WHERE e.amount > 1000 RETURN a, b
+// CALL db.idx.weight.drop('TX')
+
+static Schema *_RelationSchema(const char *proc, SIValue relation) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchema(gc, relation.stringval, SCHEMA_EDGE);
+	if(!s) {
+		ErrorCtx_SetError("%s unknown relationship type '%s'", proc,
+						  relation.stringval);
+		ErrorCtx_RaiseRuntimeException(NULL);
+	}
+	return s;
+}
+
+static ProcedureResult Proc_WeightCreateInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting relationship type and attribute
+	if(array_len((SIValue *)args) != 2) return PROCEDURE_ERR;
+	if(SI_TYPE(args[0]) != T_STRING || SI_TYPE(args[1]) != T_STRING) {
+		return PROCEDURE_ERR;
+	}
+
+	Schema *s = _RelationSchema("db.idx.weight.create", args[0]);
+	if(!s) return PROCEDURE_ERR;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Attribute_ID attr = GraphContext_FindOrAddAttribute(gc, args[1].stringval);
+	Schema_SetWeightAttribute(s, attr);
+
+	return PROCEDURE_OK;
+}
+
+static ProcedureResult Proc_WeightDropInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting relationship type
+	if(array_len((SIValue *)args) != 1) return PROCEDURE_ERR;
+	if(SI_TYPE(args[0]) != T_STRING) return PROCEDURE_ERR;
+
+	Schema *s = _RelationSchema("db.idx.weight.drop", args[0]);
+	if(!s) return PROCEDURE_ERR;
+
+	Schema_SetWeightAttribute(s, ATTRIBUTE_NOTFOUND);
+
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_WeightStep(ProcedureCtx *ctx) {
+	return NULL;
+}
+
+static ProcedureResult Proc_WeightFree(ProcedureCtx *ctx) {
+	// Clean up.
+	return PROCEDURE_OK;
+}
+
+static ProcedureCtx *_WeightCtx(const char *name, unsigned int argc,
+		ProcInvoke invoke) {
+	void *privateData = NULL;
+	ProcedureOutput *output = array_new(ProcedureOutput, 0);
+	// modifying the schema's weights requires the write lock
+	ProcedureCtx *ctx = ProcCtxNew(name,
+								   argc,
+								   output,
+								   Proc_WeightStep,
+								   invoke,
+								   Proc_WeightFree,
+								   privateData,
+								   false);
+	return ctx;
+}
+
+ProcedureCtx *Proc_WeightCreateGen() {
+	return _WeightCtx("db.idx.weight.create", 2, Proc_WeightCreateInvoke);
+}
+
+ProcedureCtx *Proc_WeightDropGen() {
+	return _WeightCtx("db.idx.weight.drop", 1, Proc_WeightDropInvoke);
+}
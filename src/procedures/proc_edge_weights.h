@@ -0,0 +1,15 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "proc_ctx.h"
+
+// promote a numeric relationship attribute to weight matrices
+ProcedureCtx *Proc_WeightCreateGen();
+
+// demote a relationship type's promoted attribute
+ProcedureCtx *Proc_WeightDropGen();
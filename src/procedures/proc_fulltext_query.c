@@ -9,6 +9,8 @@
 #include "../value.h"
 #include "../errors.h"
 #include "../util/arr.h"
+#include "../util/qsort.h"
+#include "../datatypes/map.h"
 #include "../query_ctx.h"
 #include "../index/index.h"
 #include "../util/rmalloc.h"
@@ -19,22 +21,149 @@
 //------------------------------------------------------------------------------
 
 // CALL db.idx.fulltext.queryNodes(label, query)
+// CALL db.idx.fulltext.queryNodes(label, query, {limit: 10, skip: 0})
+// CALL db.idx.fulltext.queryNodes(label, query, {version: 42})
+//
+// if a limit is specified only the top scoring matches are reported
+// in descending score order, such that only limit + skip matches are held
+//
+// when FULLTEXT_ASYNC is enabled the index may lag behind the graph,
+// a version, as reported by db.idx.fulltext.status, fails the query
+// unless the index reflects at least that many updates
+// the query can't wait for the index to catch up, as it holds the read lock
+// under which queued updates are applied
+
+// a node matching the query and its score
+typedef struct {
+	NodeID id;
+	double score;
+} FulltextMatch;
+
+// descending score, ties broken by node id
+#define MATCH_ISLT(a, b) \
+	((a)->score > (b)->score || ((a)->score == (b)->score && (a)->id < (b)->id))
 
 typedef struct {
 	Node n;
 	Graph *g;
 	SIValue *output;
 	Index *idx;
+	int label_id;                 // Indexed label ID.
+	bool stale;                   // Index holds queued updates, matches are validated.
 	RSResultsIterator *iter;
+	FulltextMatch *matches;       // Top scoring matches, NULL if streamed.
+	uint match_pos;               // Next match to report.
+	uint block_size;              // Number of rows in the next batch.
+	Node *nodes;                  // Batch node column.
+	double *scores;               // Batch score column.
+	ProcedureColumn columns[2];   // Batch columns [node, score].
+	ProcedureBatch batch;         // Current block of rows.
 } QueryNodeContext;
 
+// parses the optional configuration map into limit, skip and version
+// limit is UINT_MAX if not specified
+static bool _QueryNodeConfig(SIValue config, uint *limit, uint *skip,
+		uint64_t *version) {
+	*limit = UINT_MAX;
+	*skip = 0;
+	*version = 0;
+	if(SIValue_IsNull(config)) return true;
+	if(SI_TYPE(config) != T_MAP) {
+		ErrorCtx_SetError("db.idx.fulltext.queryNodes expects a configuration map");
+		return false;
+	}
+
+	uint key_count = Map_KeyCount(config);
+	for(uint i = 0; i < key_count; i++) {
+		const char *key = config.map[i].key.stringval;
+		SIValue v = config.map[i].val;
+
+		if(strcmp(key, "version") == 0) {
+			if(SI_TYPE(v) != T_INT64 || v.longval < 0) {
+				ErrorCtx_SetError("db.idx.fulltext.queryNodes invalid value for configuration key '%s'",
+								  key);
+				return false;
+			}
+			*version = v.longval;
+			continue;
+		}
+		if(strcmp(key, "limit") != 0 && strcmp(key, "skip") != 0) {
+			ErrorCtx_SetError("db.idx.fulltext.queryNodes unknown configuration key '%s'",
+							  key);
+			return false;
+		}
+		if(SI_TYPE(v) != T_INT64 || v.longval < 0 || v.longval >= UINT_MAX) {
+			ErrorCtx_SetError("db.idx.fulltext.queryNodes invalid value for configuration key '%s'",
+							  key);
+			return false;
+		}
+		if(key[0] == 'l') *limit = v.longval;
+		else *skip = v.longval;
+	}
+
+	return true;
+}
+
+// returns false if a match refers to a node deleted or relabeled
+// since it was indexed, possible while updates are queued
+static bool _ValidMatch(QueryNodeContext *pdata, NodeID id) {
+	if(!pdata->stale) return true;
+	Node n = GE_NEW_NODE();
+	return Graph_GetNode(pdata->g, id, &n) &&
+		Graph_GetNodeLabel(pdata->g, id) == pdata->label_id;
+}
+
+// retains the k top scoring matches out of the iterator
+// matches are sorted and trimmed whenever the buffer fills up
+static FulltextMatch *_TopMatches(QueryNodeContext *pdata, uint k) {
+	uint cap = (k > UINT_MAX - PROCEDURE_BATCH_SIZE) ? UINT_MAX :
+		k + MIN(k, PROCEDURE_BATCH_SIZE);
+	FulltextMatch *matches = array_new(FulltextMatch, MIN(cap, PROCEDURE_BATCH_SIZE));
+	if(k == 0) return matches;
+
+	size_t len = 0;
+	const NodeID *id;
+	while((id = RediSearch_ResultsIteratorNext(pdata->iter, pdata->idx->idx,
+					&len)) != NULL) {
+		if(!_ValidMatch(pdata, *id)) continue;
+		FulltextMatch m = {.id = *id,
+			.score = RediSearch_ResultsIteratorGetScore(pdata->iter)};
+		matches = array_append(matches, m);
+		if(array_len(matches) == cap) {
+			QSORT(FulltextMatch, matches, cap, MATCH_ISLT);
+			matches = array_trimm_len(matches, k);
+		}
+	}
+
+	uint count = array_len(matches);
+	QSORT(FulltextMatch, matches, count, MATCH_ISLT);
+	if(count > k) matches = array_trimm_len(matches, k);
+	return matches;
+}
+
 ProcedureResult Proc_FulltextQueryNodeInvoke(ProcedureCtx *ctx, const SIValue *args, const char **yield) {
-	if(array_len((SIValue *)args) != 2) return PROCEDURE_ERR;
+	// expecting 2 arguments, and an optional configuration map
+	ctx->privateData = NULL;
+	uint argc = array_len((SIValue *)args);
+	if(argc != 2 && argc != 3) {
+		ErrorCtx_SetError("Procedure `db.idx.fulltext.queryNodes` requires 2 or 3 arguments, got %d",
+						  argc);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
 	if(!(SI_TYPE(args[0]) & SI_TYPE(args[1]) & T_STRING)) return PROCEDURE_ERR;
 
-	ctx->privateData = NULL;
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 
+	uint limit;
+	uint skip;
+	uint64_t version;
+	SIValue config = (argc == 3) ? args[2] : SI_NullVal();
+	if(!_QueryNodeConfig(config, &limit, &skip, &version)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
 	// See if there's a full-text index for given label.
 	char *err = NULL;
 	const char *label = args[0].stringval;
@@ -46,17 +175,35 @@ ProcedureResult Proc_FulltextQueryNodeInvoke(ProcedureCtx *ctx, const SIValue *a
 	Index *idx = Schema_GetIndex(s, NULL, IDX_FULLTEXT);
 	if(!idx) return PROCEDURE_ERR; // TODO this should cause an error to be emitted.
 
+	uint64_t applied = Index_AppliedVersion(idx);
+	if(applied < version) {
+		ErrorCtx_SetError("db.idx.fulltext.queryNodes index is at version %llu, behind requested version %llu",
+						  (unsigned long long)applied, (unsigned long long)version);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
 	ctx->privateData = rm_malloc(sizeof(QueryNodeContext));
 	QueryNodeContext *pdata = ctx->privateData;
 	pdata->idx = idx;
+	pdata->label_id = s->id;
+	pdata->stale = applied < Index_Version(idx);
 	pdata->g = gc->g;
 	pdata->n = GE_NEW_NODE();
+	pdata->matches = NULL;
+	pdata->match_pos = 0;
+	pdata->nodes = NULL;
+	pdata->scores = NULL;
 	pdata->output = array_new(SIValue, 4);
 	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
 	pdata->output = array_append(pdata->output, SI_Node(&pdata->n));
 	pdata->output = array_append(pdata->output, SI_ConstStringVal("score"));
 	pdata->output = array_append(pdata->output, SI_DoubleVal(0.0));
 
+	// first block holds as many rows as the query is expected to require
+	// subsequent blocks grow up to PROCEDURE_BATCH_SIZE
+	pdata->block_size = MAX(1, MIN(ctx->limit_hint, PROCEDURE_BATCH_SIZE));
+
 	// Execute query
 	pdata->iter = Index_Query(pdata->idx, query, &err);
 	// Raise runtime exception if err != NULL.
@@ -72,28 +219,58 @@ ProcedureResult Proc_FulltextQueryNodeInvoke(ProcedureCtx *ctx, const SIValue *a
 	}
 	ASSERT(pdata->iter != NULL);
 
+	if(limit != UINT_MAX) {
+		// hold on to the top scoring matches only
+		uint k = (skip < UINT_MAX - limit) ? skip + limit : UINT_MAX - 1;
+		pdata->matches = _TopMatches(pdata, k);
+		pdata->match_pos = MIN(skip, array_len(pdata->matches));
+		RediSearch_ResultsIteratorFree(pdata->iter);
+		pdata->iter = NULL;
+	}
+
 	return PROCEDURE_OK;
 }
 
-SIValue *Proc_FulltextQueryNodeStep(ProcedureCtx *ctx) {
-	if(!ctx->privateData) return NULL; // No index was attached to this procedure.
+// retrieves the next match, returns false once depleted
+static bool _NextMatch(QueryNodeContext *pdata, NodeID *id, double *score) {
+	if(pdata->matches != NULL) {
+		if(pdata->match_pos == array_len(pdata->matches)) return false;
+		FulltextMatch *m = pdata->matches + pdata->match_pos++;
+		*id = m->id;
+		*score = m->score;
+		return true;
+	}
 
-	QueryNodeContext *pdata = (QueryNodeContext *)ctx->privateData;
-	if(!pdata || !pdata->iter) return NULL;
+	if(!pdata->iter) return false;
 
 	/* Try to get a result out of the iterator.
 	 * NULL is returned if iterator id depleted. */
 	size_t len = 0;
-	NodeID *id = (NodeID *)RediSearch_ResultsIteratorNext(pdata->iter, pdata->idx->idx, &len);
+	NodeID *res;
+	do {
+		res = (NodeID *)RediSearch_ResultsIteratorNext(pdata->iter,
+				pdata->idx->idx, &len);
+		if(!res) return false;
+	} while(!_ValidMatch(pdata, *res));
 
-	// Depleted.
-	if(!id) return NULL;
+	*id = *res;
+	*score = RediSearch_ResultsIteratorGetScore(pdata->iter);
+	return true;
+}
+
+SIValue *Proc_FulltextQueryNodeStep(ProcedureCtx *ctx) {
+	if(!ctx->privateData) return NULL; // No index was attached to this procedure.
 
-	double score = RediSearch_ResultsIteratorGetScore(pdata->iter);
+	QueryNodeContext *pdata = (QueryNodeContext *)ctx->privateData;
+
+	NodeID id;
+	double score;
+	// Depleted.
+	if(!_NextMatch(pdata, &id, &score)) return NULL;
 
 	// Get Node.
 	Node *n = &pdata->n;
-	Graph_GetNode(pdata->g, *id, n);
+	Graph_GetNode(pdata->g, id, n);
 
 	pdata->output[1] = SI_Node(n);
 	pdata->output[3] = SI_DoubleVal(score);
@@ -101,6 +278,36 @@ SIValue *Proc_FulltextQueryNodeStep(ProcedureCtx *ctx) {
 	return pdata->output;
 }
 
+const ProcedureBatch *Proc_FulltextQueryNodeStepBatch(ProcedureCtx *ctx) {
+	if(!ctx->privateData) return NULL; // No index was attached to this procedure.
+
+	QueryNodeContext *pdata = (QueryNodeContext *)ctx->privateData;
+
+	if(pdata->nodes == NULL) {
+		pdata->nodes = rm_malloc(sizeof(Node) * PROCEDURE_BATCH_SIZE);
+		pdata->scores = rm_malloc(sizeof(double) * PROCEDURE_BATCH_SIZE);
+		pdata->columns[0].type = PROCEDURE_COLUMN_NODE;
+		pdata->columns[0].nodes = pdata->nodes;
+		pdata->columns[1].type = PROCEDURE_COLUMN_DOUBLE;
+		pdata->columns[1].doubles = pdata->scores;
+		pdata->batch.columns = pdata->columns;
+	}
+
+	// Drain up to block_size matches.
+	uint count = 0;
+	NodeID id;
+	while(count < pdata->block_size &&
+		  _NextMatch(pdata, &id, pdata->scores + count)) {
+		pdata->nodes[count] = GE_NEW_NODE();
+		Graph_GetNode(pdata->g, id, pdata->nodes + count);
+		count++;
+	}
+	pdata->block_size = MIN(pdata->block_size * 2, PROCEDURE_BATCH_SIZE);
+
+	pdata->batch.count = count;
+	return &pdata->batch;
+}
+
 ProcedureResult Proc_FulltextQueryNodeFree(ProcedureCtx *ctx) {
 	// Clean up.
 	if(!ctx->privateData) return PROCEDURE_OK;
@@ -108,6 +315,9 @@ ProcedureResult Proc_FulltextQueryNodeFree(ProcedureCtx *ctx) {
 	QueryNodeContext *pdata = ctx->privateData;
 	array_free(pdata->output);
 	if(pdata->iter) RediSearch_ResultsIteratorFree(pdata->iter);
+	if(pdata->matches) array_free(pdata->matches);
+	if(pdata->nodes) rm_free(pdata->nodes);
+	if(pdata->scores) rm_free(pdata->scores);
 	rm_free(pdata);
 
 	return PROCEDURE_OK;
@@ -122,13 +332,14 @@ ProcedureCtx *Proc_FulltextQueryNodeGen() {
 	output = array_append(output, out_score);
 
 	ProcedureCtx *ctx = ProcCtxNew("db.idx.fulltext.queryNodes",
-								   2,
+								   PROCEDURE_VARIABLE_ARG_COUNT,
 								   output,
 								   Proc_FulltextQueryNodeStep,
 								   Proc_FulltextQueryNodeInvoke,
 								   Proc_FulltextQueryNodeFree,
 								   privateData,
 								   true);
+	ctx->StepBatch = Proc_FulltextQueryNodeStepBatch;
 	return ctx;
 }
 
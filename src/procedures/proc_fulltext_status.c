@@ -0,0 +1,92 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_fulltext_status.h"
+#include "RG.h"
+#include "../value.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../index/index.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+
+//------------------------------------------------------------------------------
+// fulltext status
+//------------------------------------------------------------------------------
+
+// CALL db.idx.fulltext.status(label)
+//
+// reports the number of updates requested from the label's fulltext index
+// and the number of updates it reflects, the two differ while FULLTEXT_ASYNC
+// updates are queued, see db.idx.fulltext.queryNodes's version key
+
+typedef struct {
+	bool depleted;    // Status was reported.
+	SIValue *output;  // Output row [version, applied].
+} FulltextStatusContext;
+
+ProcedureResult Proc_FulltextStatusInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	ctx->privateData = NULL;
+	if(array_len((SIValue *)args) != 1) return PROCEDURE_ERR;
+	if(!(SI_TYPE(args[0]) & T_STRING)) return PROCEDURE_ERR;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	const char *label = args[0].stringval;
+	Index *idx = GraphContext_GetIndex(gc, label, NULL, IDX_FULLTEXT);
+	// no index, no rows
+	if(idx == NULL) return PROCEDURE_OK;
+
+	FulltextStatusContext *pdata = rm_malloc(sizeof(FulltextStatusContext));
+	pdata->depleted = false;
+	pdata->output = array_new(SIValue, 4);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("version"));
+	pdata->output = array_append(pdata->output, SI_LongVal(Index_Version(idx)));
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("applied"));
+	pdata->output = array_append(pdata->output,
+			SI_LongVal(Index_AppliedVersion(idx)));
+
+	ctx->privateData = pdata;
+	return PROCEDURE_OK;
+}
+
+SIValue *Proc_FulltextStatusStep(ProcedureCtx *ctx) {
+	FulltextStatusContext *pdata = ctx->privateData;
+	if(pdata == NULL || pdata->depleted) return NULL;
+
+	pdata->depleted = true;
+	return pdata->output;
+}
+
+ProcedureResult Proc_FulltextStatusFree(ProcedureCtx *ctx) {
+	// Clean up.
+	if(ctx->privateData) {
+		FulltextStatusContext *pdata = ctx->privateData;
+		array_free(pdata->output);
+		rm_free(pdata);
+	}
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_FulltextStatusGen() {
+	void *privateData = NULL;
+	ProcedureOutput *output = array_new(ProcedureOutput, 2);
+	ProcedureOutput out_version = {.name = "version", .type = T_INT64};
+	ProcedureOutput out_applied = {.name = "applied", .type = T_INT64};
+	output = array_append(output, out_version);
+	output = array_append(output, out_applied);
+
+	ProcedureCtx *ctx = ProcCtxNew("db.idx.fulltext.status",
+								   1,
+								   output,
+								   Proc_FulltextStatusStep,
+								   Proc_FulltextStatusInvoke,
+								   Proc_FulltextStatusFree,
+								   privateData,
+								   true);
+	return ctx;
+}
@@ -0,0 +1,149 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_label_propagation.h"
+#include "proc_projection.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../algorithms/label_propagation.h"
+#include "../graph/graphcontext.h"
+
+// edge direction is ignored, every node is reported along with
+// the ID of a member of its community
+//
+// CALL algo.labelPropagation(NULL, NULL)       YIELD node, communityId
+// CALL algo.labelPropagation('User', NULL)     YIELD node, communityId
+// CALL algo.labelPropagation(NULL, 'FOLLOWS')  YIELD node, communityId
+// CALL algo.labelPropagation('User', 'FOLLOWS') YIELD node, communityId
+
+typedef struct {
+	GrB_Index n;              // number of nodes
+	GrB_Index i;              // current node to return
+	Graph *g;                 // graph
+	Node node;                // node
+	GrB_Index *mapping;       // mapping between extracted matrix rows and node ids
+	GrB_Index *communities;   // community of each node
+	SIValue *output;          // array with 4 entries ["node", node, "communityId", id]
+} LabelPropagationContext;
+
+static ProcedureResult Proc_LabelPropagationInvoke(ProcedureCtx *ctx, const SIValue *args,
+		const char **yield) {
+	// expecting 2 arguments, and an optional configuration map
+	uint argc = array_len((SIValue *)args);
+	if(argc != 2 && argc != 3) return PROCEDURE_ERR;
+	// arg0 and arg1 can be either String or NULL
+	SIType arg0_t = SI_TYPE(args[0]);
+	SIType arg1_t = SI_TYPE(args[1]);
+	if(!(arg0_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+
+	// optional configuration map can specify a projection
+	const char *projection;
+	SIValue config = (argc == 3) ? args[2] : SI_NullVal();
+	if(!Proc_ProjectionConfig("algo.labelPropagation", config, &projection)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	Graph *g = QueryCtx_GetGraph();
+
+	// setup context
+	LabelPropagationContext *pdata = rm_malloc(sizeof(LabelPropagationContext));
+	pdata->n = 0;
+	pdata->i = 0;
+	pdata->g = g;
+	pdata->node = GE_NEW_NODE();
+	pdata->mapping = NULL;
+	pdata->communities = NULL;
+	pdata->output = array_new(SIValue, 4);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
+	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("communityId"));
+	pdata->output = array_append(pdata->output, SI_LongVal(0)); // Place holder.
+	ctx->privateData = pdata;
+
+	GrB_Matrix S;
+	bool shared;
+	ProcedureResult res = Proc_AlgorithmGraph("algo.labelPropagation", projection, args[0], args[1],
+			true, &S, &pdata->mapping, &shared);
+	// unknown schema or projection
+	if(S == GrB_NULL) return res;
+
+	GrB_Info info;
+	info = GrB_Matrix_nrows(&pdata->n, S);
+	ASSERT(info == GrB_SUCCESS);
+
+	int iters;                // rounds performed
+	const int itermax = 20;   // max rounds
+	info = LabelPropagation(&pdata->communities, S, itermax, &iters);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	if(!shared) GrB_free(&S);
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_LabelPropagationStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	LabelPropagationContext *pdata = (LabelPropagationContext *)ctx->privateData;
+	GrB_Index node_count = Graph_RequiredMatrixDim(pdata->g);
+
+	while(pdata->i < pdata->n) {
+		GrB_Index i = pdata->i++;
+		NodeID node_id = (pdata->mapping) ? pdata->mapping[i] : i;
+		// skip deleted nodes
+		if(node_id >= node_count) continue;
+		if(!Graph_GetNode(pdata->g, node_id, &pdata->node)) continue;
+
+		// communities are named after one of their members
+		GrB_Index label = pdata->communities[i];
+		NodeID community_id = (pdata->mapping) ? pdata->mapping[label] : label;
+
+		pdata->output[1] = SI_Node(&pdata->node);
+		pdata->output[3] = SI_LongVal(community_id);
+		return pdata->output;
+	}
+
+	// depleted/no results
+	return NULL;
+}
+
+static ProcedureResult Proc_LabelPropagationFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		LabelPropagationContext *pdata = ctx->privateData;
+		if(pdata->output) array_free(pdata->output);
+		if(pdata->mapping) rm_free(pdata->mapping);
+		if(pdata->communities) rm_free(pdata->communities);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_LabelPropagationCtx() {
+	void *privateData = NULL;
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 2);
+	ProcedureOutput output_node = {.name = "node", .type = T_NODE};
+	ProcedureOutput output_community = {.name = "communityId", .type = T_INT64};
+	outputs = array_append(outputs, output_node);
+	outputs = array_append(outputs, output_community);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.labelPropagation",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_LabelPropagationStep,
+								   Proc_LabelPropagationInvoke,
+								   Proc_LabelPropagationFree,
+								   privateData,
+								   true);
+	return ctx;
+}
@@ -16,11 +16,13 @@
 typedef struct {
 	SIValue *out;               // outputs
 	int schema_id;              // current schema ID
+	SchemaType schema_type;     // current schema type, node schemas first
 	IndexType type;             // current index type to retrieve
 	GraphContext *gc;           // graph context
 	SIValue *yield_type;        // yield index type
 	SIValue *yield_label;       // yield index label
 	SIValue *yield_properties;  // yield index properties
+	SIValue *yield_status;      // yield index status
 } IndexesContext;
 
 // CALL db.indexes()
@@ -38,12 +40,14 @@ ProcedureResult Proc_IndexesInvoke(ProcedureCtx *ctx, const SIValue *args,
 
 	IndexesContext *pdata   = rm_malloc(sizeof(IndexesContext));
 	pdata->gc               = gc;
-	pdata->out              = array_new(SIValue, 6);
+	pdata->out              = array_new(SIValue, 8);
 	pdata->type             = IDX_EXACT_MATCH;
 	pdata->schema_id        = GraphContext_SchemaCount(gc, SCHEMA_NODE) - 1;
+	pdata->schema_type      = SCHEMA_NODE;
 	pdata->yield_type       = NULL;
 	pdata->yield_label      = NULL;
 	pdata->yield_properties = NULL;
+	pdata->yield_status     = NULL;
 
 	uint yield_count = array_len(yield);
 	for(uint i = 0; i < yield_count; i++) {
@@ -65,6 +69,12 @@ ProcedureResult Proc_IndexesInvoke(ProcedureCtx *ctx, const SIValue *args,
 			pdata->yield_properties = pdata->out + (i * 2 + 1);
 			continue;
 		}
+		if(strcasecmp("status", yield[i]) == 0) {
+			pdata->out = array_append(pdata->out, SI_ConstStringVal("status"));
+			pdata->out = array_append(pdata->out, SI_NullVal());
+			pdata->yield_status = pdata->out + (i * 2 + 1);
+			continue;
+		}
 	}
 
 	ctx->privateData = pdata;
@@ -77,8 +87,12 @@ static bool _EmitIndex(IndexesContext *ctx, const Schema *s, IndexType type) {
 	if(idx == NULL) return false;
 
 	if(ctx->yield_type != NULL) {
-		if(type == IDX_EXACT_MATCH) {
+		if(idx->entity_type == GETYPE_EDGE) {
+			*ctx->yield_type = SI_ConstStringVal("relationship");
+		} else if(type == IDX_EXACT_MATCH) {
 			*ctx->yield_type = SI_ConstStringVal("exact-match");
+		} else if(type == IDX_VECTOR) {
+			*ctx->yield_type = SI_ConstStringVal("vector");
 		} else {
 			*ctx->yield_type = SI_ConstStringVal("full-text");
 		}
@@ -99,6 +113,12 @@ static bool _EmitIndex(IndexesContext *ctx, const Schema *s, IndexType type) {
 		}
 	}
 
+	if(ctx->yield_status) {
+		*ctx->yield_status = (Index_Enabled(idx)) ?
+			SI_ConstStringVal("operational") :
+			SI_ConstStringVal("under construction");
+	}
+
 	return true;
 }
 
@@ -108,9 +128,18 @@ SIValue *Proc_IndexesStep(ProcedureCtx *ctx) {
 	Schema *s = NULL;
 	IndexesContext *pdata = ctx->privateData;
 
-	// loop over all schemas from last to first
-	while(pdata->schema_id >= 0) {
-		s = GraphContext_GetSchemaByID(pdata->gc, pdata->schema_id, SCHEMA_NODE);
+	// loop over all schemas from last to first, node schemas first
+	while(true) {
+		if(pdata->schema_id < 0) {
+			if(pdata->schema_type == SCHEMA_EDGE) break;
+			// node schemas depleted, continue to relationship schemas
+			pdata->schema_type = SCHEMA_EDGE;
+			pdata->schema_id = GraphContext_SchemaCount(pdata->gc, SCHEMA_EDGE) - 1;
+			continue;
+		}
+
+		s = GraphContext_GetSchemaByID(pdata->gc, pdata->schema_id,
+				pdata->schema_type);
 		if(!Schema_HasIndices(s)) {
 			// no indexes found, continue to the next schema
 			pdata->schema_id--;
@@ -120,10 +149,13 @@ SIValue *Proc_IndexesStep(ProcedureCtx *ctx) {
 		// populate index data if one is found
 		bool found = _EmitIndex(pdata, s, pdata->type);
 
-		if(pdata->type == IDX_FULLTEXT) {
+		if(pdata->type == IDX_VECTOR) {
 			// all indexes retrieved; update schema_id, reset schema type
 			pdata->schema_id--;
 			pdata->type = IDX_EXACT_MATCH;
+		} else if(pdata->type == IDX_FULLTEXT) {
+			// next iteration will check the same schema for a vector index
+			pdata->type = IDX_VECTOR;
 		} else {
 			// next iteration will check the same schema for a full-text index
 			pdata->type = IDX_FULLTEXT;
@@ -149,9 +181,9 @@ ProcedureResult Proc_IndexesFree(ProcedureCtx *ctx) {
 ProcedureCtx *Proc_IndexesCtx() {
 	void *privateData = NULL;
 	ProcedureOutput output;
-	ProcedureOutput *outputs = array_new(ProcedureOutput, 3);
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 4);
 
-	// index type (exact-match / fulltext)
+	// index type (exact-match / fulltext / vector)
 	output  = (ProcedureOutput) {
 		.name = "type", .type = T_STRING
 	};
@@ -169,6 +201,12 @@ ProcedureCtx *Proc_IndexesCtx() {
 	};
 	outputs = array_append(outputs, output);
 
+	// index status (operational / under construction)
+	output  = (ProcedureOutput) {
+		.name = "status", .type = T_STRING
+	};
+	outputs = array_append(outputs, output);
+
 	ProcedureCtx *ctx = ProcCtxNew("db.indexes",
 								   0,
 								   outputs,
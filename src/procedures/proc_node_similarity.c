@@ -0,0 +1,222 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_node_similarity.h"
+#include "proc_projection.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../datatypes/map.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/node_similarity.h"
+
+// every pair of nodes sharing at least one neighbor is reported
+// along with the similarity of their neighborhoods, both (a, b) and (b, a)
+//
+// CALL algo.nodeSimilarity(NULL, NULL)          YIELD node1, node2, similarity
+// CALL algo.nodeSimilarity('User', 'BOUGHT')    YIELD node1, node2, similarity
+//
+// an optional configuration map controls the similarity measure
+// CALL algo.nodeSimilarity('User', 'BOUGHT', {metric: 'cosine', topK: 5,
+//      similarityCutoff: 0.5}) YIELD node1, node2, similarity
+//
+// metric           - 'jaccard' (default), 'overlap' or 'cosine'
+// topK             - only the topK most similar nodes of each node are reported
+// similarityCutoff - pairs less similar than the cutoff are discarded
+// projection       - compare the nodes of a projection, see algo.project
+
+typedef struct {
+	uint64_t n;                // number of similar pairs
+	uint64_t i;                // current pair to return
+	Graph *g;                  // graph
+	Node node1;                // compared node
+	Node node2;                // similar node
+	GrB_Index *mapping;        // mapping between extracted matrix rows and node ids
+	SimilarityPair *pairs;     // similar pairs
+	SIValue *output;           // array with 6 entries ["node1", n1, "node2", n2, "similarity", s]
+} NodeSimilarityContext;
+
+typedef struct {
+	SimilarityMetric metric;  // similarity measure
+	GrB_Index top_k;          // number of similar nodes to report per node, 0 for all
+	double cutoff;            // minimal reported similarity
+	const char *projection;   // projection to compare, NULL if unspecified
+} NodeSimilarityConfig;
+
+// parse the optional configuration map
+// returns false and sets an error if the configuration is invalid
+static bool _NodeSimilarityConfig_Parse(SIValue config,
+										NodeSimilarityConfig *conf) {
+	conf->metric = SIMILARITY_JACCARD;
+	conf->top_k = 0;
+	conf->cutoff = 0;
+	conf->projection = NULL;
+
+	if(SIValue_IsNull(config)) return true;
+
+	uint key_count = Map_KeyCount(config);
+	for(uint i = 0; i < key_count; i++) {
+		const char *key = config.map[i].key.stringval;
+		SIValue v = config.map[i].val;
+
+		if(strcmp(key, "metric") == 0) {
+			if(SI_TYPE(v) != T_STRING) goto invalid;
+			if(strcasecmp(v.stringval, "jaccard") == 0) {
+				conf->metric = SIMILARITY_JACCARD;
+			} else if(strcasecmp(v.stringval, "overlap") == 0) {
+				conf->metric = SIMILARITY_OVERLAP;
+			} else if(strcasecmp(v.stringval, "cosine") == 0) {
+				conf->metric = SIMILARITY_COSINE;
+			} else {
+				goto invalid;
+			}
+		} else if(strcmp(key, "topK") == 0) {
+			if(SI_TYPE(v) != T_INT64 || v.longval <= 0) goto invalid;
+			conf->top_k = v.longval;
+		} else if(strcmp(key, "similarityCutoff") == 0) {
+			if(!(SI_TYPE(v) & SI_NUMERIC)) goto invalid;
+			conf->cutoff = SI_GET_NUMERIC(v);
+		} else if(strcmp(key, "projection") == 0) {
+			if(SI_TYPE(v) != T_STRING) goto invalid;
+			conf->projection = v.stringval;
+		} else {
+			ErrorCtx_SetError("algo.nodeSimilarity unknown configuration key '%s'",
+							  key);
+			return false;
+		}
+		continue;
+
+invalid:
+		ErrorCtx_SetError("algo.nodeSimilarity invalid value for configuration key '%s'",
+						  key);
+		return false;
+	}
+
+	return true;
+}
+
+static ProcedureResult Proc_NodeSimilarityInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting 2 arguments, and an optional configuration map
+	uint argc = array_len((SIValue *)args);
+	if(argc != 2 && argc != 3) return PROCEDURE_ERR;
+	// arg0 and arg1 can be either String or NULL
+	SIType arg0_t = SI_TYPE(args[0]);
+	SIType arg1_t = SI_TYPE(args[1]);
+	if(!(arg0_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+
+	// arg2 can be either Map or NULL
+	NodeSimilarityConfig conf;
+	SIValue config = (argc == 3) ? args[2] : SI_NullVal();
+	if(!(SI_TYPE(config) & (T_MAP | T_NULL))) return PROCEDURE_ERR;
+	if(!_NodeSimilarityConfig_Parse(config, &conf)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	Graph *g = QueryCtx_GetGraph();
+
+	// setup context
+	NodeSimilarityContext *pdata = rm_malloc(sizeof(NodeSimilarityContext));
+	pdata->n = 0;
+	pdata->i = 0;
+	pdata->g = g;
+	pdata->node1 = GE_NEW_NODE();
+	pdata->node2 = GE_NEW_NODE();
+	pdata->mapping = NULL;
+	pdata->pairs = NULL;
+	pdata->output = array_new(SIValue, 6);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node1"));
+	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node2"));
+	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("similarity"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+	ctx->privateData = pdata;
+
+	GrB_Matrix S;
+	bool shared;
+	ProcedureResult res = Proc_AlgorithmGraph("algo.nodeSimilarity",
+			conf.projection, args[0], args[1], false, &S, &pdata->mapping, &shared);
+	// unknown schema or projection
+	if(S == GrB_NULL) return res;
+
+	GrB_Info info;
+
+	info = NodeSimilarity(&pdata->pairs, S, conf.metric, conf.top_k,
+						  conf.cutoff);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	pdata->n = array_len(pdata->pairs);
+
+	if(!shared) GrB_free(&S);
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_NodeSimilarityStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	NodeSimilarityContext *pdata = (NodeSimilarityContext *)ctx->privateData;
+	GrB_Index node_count = Graph_RequiredMatrixDim(pdata->g);
+
+	while(pdata->i < pdata->n) {
+		SimilarityPair *pair = pdata->pairs + pdata->i++;
+		NodeID src = (pdata->mapping) ? pdata->mapping[pair->src] : pair->src;
+		NodeID dest = (pdata->mapping) ? pdata->mapping[pair->dest] : pair->dest;
+
+		// skip pairs involving deleted nodes
+		if(src >= node_count || dest >= node_count) continue;
+		if(!Graph_GetNode(pdata->g, src, &pdata->node1)) continue;
+		if(!Graph_GetNode(pdata->g, dest, &pdata->node2)) continue;
+
+		pdata->output[1] = SI_Node(&pdata->node1);
+		pdata->output[3] = SI_Node(&pdata->node2);
+		pdata->output[5] = SI_DoubleVal(pair->similarity);
+		return pdata->output;
+	}
+
+	// depleted/no results
+	return NULL;
+}
+
+static ProcedureResult Proc_NodeSimilarityFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		NodeSimilarityContext *pdata = ctx->privateData;
+		if(pdata->output) array_free(pdata->output);
+		if(pdata->mapping) rm_free(pdata->mapping);
+		if(pdata->pairs) array_free(pdata->pairs);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_NodeSimilarityCtx() {
+	void *privateData = NULL;
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 3);
+	ProcedureOutput output_node1 = {.name = "node1", .type = T_NODE};
+	ProcedureOutput output_node2 = {.name = "node2", .type = T_NODE};
+	ProcedureOutput output_similarity = {.name = "similarity", .type = T_DOUBLE};
+	outputs = array_append(outputs, output_node1);
+	outputs = array_append(outputs, output_node2);
+	outputs = array_append(outputs, output_similarity);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.nodeSimilarity",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_NodeSimilarityStep,
+								   Proc_NodeSimilarityInvoke,
+								   Proc_NodeSimilarityFree,
+								   privateData,
+								   true);
+	return ctx;
+}
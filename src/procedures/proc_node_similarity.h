@@ -0,0 +1,12 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "proc_ctx.h"
+
+// compute the neighborhood similarity of pairs of nodes
+ProcedureCtx *Proc_NodeSimilarityCtx();
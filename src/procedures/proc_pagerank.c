@@ -5,9 +5,13 @@
 */
 
 #include "proc_pagerank.h"
+#include "proc_projection.h"
 #include "../RG.h"
 #include "../value.h"
+#include "../errors.h"
 #include "../util/arr.h"
+#include "../datatypes/map.h"
+#include "../datatypes/array.h"
 #include "../query_ctx.h"
 #include "../util/rmalloc.h"
 #include "../graph/graphcontext.h"
@@ -17,27 +21,176 @@
 // CALL algo.pageRank('Page', NULL)    YIELD node, score
 // CALL algo.pageRank(NULL, 'LINKS')   YIELD node, score
 // CALL algo.pageRank('Page', 'LINKS') YIELD node, score
+//
+// an optional configuration map personalizes the ranking
+// CALL algo.pageRank('Page', 'LINKS', {sourceNodes: [a, b]}) YIELD node, score
+// CALL algo.pageRank('Page', 'LINKS', {warmStart: 'rank'})   YIELD node, score
+// CALL algo.pageRank('Page', 'LINKS', {topK: 10})            YIELD node, score
+//
+// sourceNodes - random jumps land on the given nodes only
+// warmStart   - node attribute holding a previous score, iterations start
+//               from the stored scores instead of a uniform ranking
+// topK        - only the topK highest ranked nodes are reported
+// projection  - rank the nodes of a projection, see algo.project
 
 typedef struct {
-	int n;                          // Number of nodes to rank.
-	int i;                          // Current node to return.
+	GrB_Index n;                    // Number of ranked nodes.
+	GrB_Index i;                    // Current node to return.
 	Graph *g;                       // Graph.
 	Node node;                      // Node.
 	GrB_Index *mapping;             // Mapping between extracted matrix rows and node ids.
 	LAGraph_PageRank *ranking;      // Nodes ranking.
 	SIValue *output;                // Array with 4 entries ["node", node, "score", score].
+	Node *nodes;                    // Batch node column.
+	double *scores;                 // Batch score column.
+	ProcedureColumn columns[2];     // Batch columns [node, score].
+	ProcedureBatch batch;           // Current block of rows.
 } PagerankContext;
 
+typedef struct {
+	SIValue sources;        // nodes random jumps land on, NULL if unspecified
+	const char *warm_start; // attribute holding previous scores
+	GrB_Index top_k;        // number of nodes to report, 0 for all
+	const char *projection; // projection to rank, NULL if unspecified
+} PagerankConfig;
+
+// parse the optional configuration map
+// returns false and sets an error if the configuration is invalid
+static bool _PagerankConfig_Parse(SIValue config, PagerankConfig *conf) {
+	conf->sources = SI_NullVal();
+	conf->warm_start = NULL;
+	conf->top_k = 0;
+	conf->projection = NULL;
+
+	if(SIValue_IsNull(config)) return true;
+
+	uint key_count = Map_KeyCount(config);
+	for(uint i = 0; i < key_count; i++) {
+		const char *key = config.map[i].key.stringval;
+		SIValue v = config.map[i].val;
+
+		if(strcmp(key, "sourceNodes") == 0) {
+			if(SI_TYPE(v) != T_ARRAY) goto invalid;
+			uint len = SIArray_Length(v);
+			for(uint j = 0; j < len; j++) {
+				if(SI_TYPE(SIArray_Get(v, j)) != T_NODE) goto invalid;
+			}
+			conf->sources = v;
+		} else if(strcmp(key, "warmStart") == 0) {
+			if(SI_TYPE(v) != T_STRING) goto invalid;
+			conf->warm_start = v.stringval;
+		} else if(strcmp(key, "topK") == 0) {
+			if(SI_TYPE(v) != T_INT64 || v.longval <= 0) goto invalid;
+			conf->top_k = v.longval;
+		} else if(strcmp(key, "projection") == 0) {
+			if(SI_TYPE(v) != T_STRING) goto invalid;
+			conf->projection = v.stringval;
+		} else {
+			ErrorCtx_SetError("algo.pageRank unknown configuration key '%s'", key);
+			return false;
+		}
+		continue;
+
+invalid:
+		ErrorCtx_SetError("algo.pageRank invalid value for configuration key '%s'",
+						  key);
+		return false;
+	}
+
+	return true;
+}
+
+// returns the row of node 'id' in the ranked matrix, false if it isn't ranked
+static bool _PagerankRow(const GrB_Index *mapping, GrB_Index n, NodeID id,
+						 GrB_Index *row) {
+	if(mapping == NULL) {
+		*row = id;
+		return (id < n);
+	}
+
+	// mapping is sorted in ascending order
+	GrB_Index lo = 0;
+	GrB_Index hi = n;
+	while(lo < hi) {
+		GrB_Index mid = lo + (hi - lo) / 2;
+		if(mapping[mid] < id) lo = mid + 1;
+		else hi = mid;
+	}
+
+	*row = lo;
+	return (lo < n && mapping[lo] == id);
+}
+
+// builds the teleport distribution, uniform over the ranked source nodes
+static GrB_Vector _PagerankSeeds(SIValue sources, const GrB_Index *mapping,
+								 GrB_Index n) {
+	GrB_Vector seeds;
+	GrB_Vector_new(&seeds, GrB_FP32, n);
+
+	uint len = SIArray_Length(sources);
+	for(uint i = 0; i < len; i++) {
+		GrB_Index row;
+		Node *node = SIArray_Get(sources, i).ptrval;
+		if(!_PagerankRow(mapping, n, ENTITY_GET_ID(node), &row)) continue;
+		GrB_Vector_setElement_FP32(seeds, 1, row);
+	}
+
+	return seeds;
+}
+
+// builds the initial ranking from the scores stored under 'attr_id'
+static GrB_Vector _PagerankWarmStart(Graph *g, Attribute_ID attr_id,
+									 const GrB_Index *mapping, GrB_Index n) {
+	GrB_Index count = 0;
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * n);
+	float *X = rm_malloc(sizeof(float) * n);
+	GrB_Index node_count = Graph_RequiredMatrixDim(g);
+
+	for(GrB_Index i = 0; i < n; i++) {
+		Node node;
+		NodeID id = (mapping) ? mapping[i] : i;
+		if(id >= node_count || !Graph_GetNode(g, id, &node)) continue;
+
+		SIValue v = GraphEntity_GetProperty((GraphEntity *)&node, attr_id);
+		if(!(SI_TYPE(v) & SI_NUMERIC)) continue;
+
+		double score = SI_GET_NUMERIC(v);
+		if(!(score >= 0)) continue;
+
+		I[count] = i;
+		X[count] = score;
+		count++;
+	}
+
+	GrB_Vector init;
+	GrB_Vector_new(&init, GrB_FP32, n);
+	GrB_Vector_build_FP32(init, I, X, count, GrB_FIRST_FP32);
+
+	rm_free(I);
+	rm_free(X);
+	return init;
+}
+
 ProcedureResult Proc_PagerankInvoke(ProcedureCtx *ctx,
 		const SIValue *args, const char **yield) {
-	// Expecting 2 arguments.
-	if(array_len((SIValue *)args) != 2) return PROCEDURE_ERR;
+	// Expecting 2 arguments, and an optional configuration map.
+	uint argc = array_len((SIValue *)args);
+	if(argc != 2 && argc != 3) return PROCEDURE_ERR;
 	// arg0 and arg1 can be either String or NULL
 	SIType arg0_t = SI_TYPE(args[0]);
 	SIType arg1_t = SI_TYPE(args[1]);
 	if(!(arg0_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
 	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
 
+	// arg2 can be either Map or NULL
+	PagerankConfig conf;
+	SIValue config = (argc == 3) ? args[2] : SI_NullVal();
+	if(!(SI_TYPE(config) & (T_MAP | T_NULL))) return PROCEDURE_ERR;
+	if(!_PagerankConfig_Parse(config, &conf)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
 	// Read arguments.
 	const char *label = NULL;    // Node filter.
 	const char *relation = NULL; // Edge filter.
@@ -70,6 +223,8 @@ ProcedureResult Proc_PagerankInvoke(ProcedureCtx *ctx,
 	pdata->node = GE_NEW_NODE();
 	pdata->mapping = mapping;
 	pdata->ranking = ranking;
+	pdata->nodes = NULL;
+	pdata->scores = NULL;
 	pdata->output = array_new(SIValue, 4);
 	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
 	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
@@ -77,77 +232,88 @@ ProcedureResult Proc_PagerankInvoke(ProcedureCtx *ctx,
 	pdata->output = array_append(pdata->output, SI_DoubleVal(0.0)); // Place holder.
 	ctx->privateData = pdata;
 
-	// Get label matrix.
-	if(label) {
-		s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
-		// Unknown label, quickly return.
-		if(!s) return PROCEDURE_OK;
-		l = Graph_GetLabelMatrix(g, s->id);
-	}
-
-	// Get relation matrix.
-	if(relation) {
-		s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
-		// Unknown relation, quickly return.
-		if(!s) return PROCEDURE_OK;
-		r = Graph_GetRelationMatrix(g, s->id);
+	if(conf.projection) {
+		// Rank a projection's nodes.
+		bool shared;
+		ProcedureResult res = Proc_AlgorithmGraph("algo.pageRank", conf.projection,
+				args[0], args[1], false, &r, &mapping, &shared);
+		// Unknown projection.
+		if(r == GrB_NULL) return res;
+		info = GrB_Matrix_nrows(&n, r);
+		ASSERT(info == GrB_SUCCESS);
 	} else {
-		// Relation isn't specified, 'r' is the adjacency matrix.
-		r = Graph_GetAdjacencyMatrix(g);
-	}
-
-	info = GrB_Matrix_nrows(&nrows, r);
-	UNUSED(info);
-	ASSERT(info == GrB_SUCCESS);
-	n = nrows;
-
-	/* Incase label or relation is specified
-	 * if label is specified:
-	 * filter 'r' to contain only rows and columns associated with
-	 * nodes of type 'l'
-	 *
-	 * if relation is specified:
-	 * cast 'r' to a boolean matrix */
-	if(label != NULL || relation != NULL) {
-		//----------------------------------------------------------------------
-		// Create a NxN matrix, one row for each labeled entity
-		//----------------------------------------------------------------------
+		// Get label matrix.
 		if(label) {
-			info = GrB_Matrix_nvals(&n, l);
-			ASSERT(info == GrB_SUCCESS);
+			s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+			// Unknown label, quickly return.
+			if(!s) return PROCEDURE_OK;
+			l = Graph_GetLabelMatrix(g, s->id);
 		}
 
-		GrB_Matrix reduced; // Relation matrix reduced to only 'l' rows/cols
-		info = GrB_Matrix_new(&reduced, GrB_BOOL, n, n);
+		// Get relation matrix.
+		if(relation) {
+			s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
+			// Unknown relation, quickly return.
+			if(!s) return PROCEDURE_OK;
+			r = Graph_GetRelationMatrix(g, s->id);
+		} else {
+			// Relation isn't specified, 'r' is the adjacency matrix.
+			r = Graph_GetAdjacencyMatrix(g);
+		}
+
+		info = GrB_Matrix_nrows(&nrows, r);
+		UNUSED(info);
 		ASSERT(info == GrB_SUCCESS);
+		n = nrows;
 
-		// Discard rows of 'r' associated with nodes of a different type than 'l'
-		// this will also perform casting to boolean.
-		if(n != nrows) {
-			mapping = rm_malloc(sizeof(GrB_Index) * n);
-			// Extract row indecies from 'l', coresponding to node IDs.
-			info = GrB_Matrix_extractTuples_BOOL(mapping, GrB_NULL, GrB_NULL, &n, l);
-			ASSERT(info == GrB_SUCCESS);
+		/* Incase label or relation is specified
+		 * if label is specified:
+		 * filter 'r' to contain only rows and columns associated with
+		 * nodes of type 'l'
+		 *
+		 * if relation is specified:
+		 * cast 'r' to a boolean matrix */
+		if(label != NULL || relation != NULL) {
+			//----------------------------------------------------------------------
+			// Create a NxN matrix, one row for each labeled entity
+			//----------------------------------------------------------------------
+			if(label) {
+				info = GrB_Matrix_nvals(&n, l);
+				ASSERT(info == GrB_SUCCESS);
+			}
 
-			info = GrB_Matrix_extract(reduced, GrB_NULL, GrB_NULL, r, mapping, n,
-					mapping, n, GrB_NULL);
-			ASSERT(info == GrB_SUCCESS);
-		} else {
-			/* There no need to perform extraction as either 'l' isn't specified
-			 * if if 'l' is given, 'r' dimension is NxN the same as
-			 * the number of entries in 'l' which means all connections
-			 * described in 'r' connect nodes of type 'l'
-			 * Unfortunately we still need to type cast 'r' to boolean */
-			GrB_Descriptor desc;
-			GrB_Descriptor_new(&desc);
-			GrB_Descriptor_set(desc, GrB_INP0, GrB_TRAN);
-			info = GrB_transpose(reduced, GrB_NULL, GrB_NULL, r, desc);
+			GrB_Matrix reduced; // Relation matrix reduced to only 'l' rows/cols
+			info = GrB_Matrix_new(&reduced, GrB_BOOL, n, n);
 			ASSERT(info == GrB_SUCCESS);
-			GrB_free(&desc);
-		}
 
-		r = reduced;
-		free_r = true;
+			// Discard rows of 'r' associated with nodes of a different type than 'l'
+			// this will also perform casting to boolean.
+			if(n != nrows) {
+				mapping = rm_malloc(sizeof(GrB_Index) * n);
+				// Extract row indecies from 'l', coresponding to node IDs.
+				info = GrB_Matrix_extractTuples_BOOL(mapping, GrB_NULL, GrB_NULL, &n, l);
+				ASSERT(info == GrB_SUCCESS);
+
+				info = GrB_Matrix_extract(reduced, GrB_NULL, GrB_NULL, r, mapping, n,
+						mapping, n, GrB_NULL);
+				ASSERT(info == GrB_SUCCESS);
+			} else {
+				/* There no need to perform extraction as either 'l' isn't specified
+				 * if if 'l' is given, 'r' dimension is NxN the same as
+				 * the number of entries in 'l' which means all connections
+				 * described in 'r' connect nodes of type 'l'
+				 * Unfortunately we still need to type cast 'r' to boolean */
+				GrB_Descriptor desc;
+				GrB_Descriptor_new(&desc);
+				GrB_Descriptor_set(desc, GrB_INP0, GrB_TRAN);
+				info = GrB_transpose(reduced, GrB_NULL, GrB_NULL, r, desc);
+				ASSERT(info == GrB_SUCCESS);
+				GrB_free(&desc);
+			}
+
+			r = reduced;
+			free_r = true;
+		}
 	}
 
 	// Invoke Pagerank only if 'r' contains entries.
@@ -155,8 +321,32 @@ ProcedureResult Proc_PagerankInvoke(ProcedureCtx *ctx,
 	ASSERT(info == GrB_SUCCESS);
 
 	if(nvals > 0) {
-		info = Pagerank(&ranking, r, itermax, tol, &iters);
-		ASSERT(info == GrB_SUCCESS);
+		GrB_Vector seeds = GrB_NULL;
+		GrB_Vector init = GrB_NULL;
+
+		if(!SIValue_IsNull(conf.sources)) {
+			seeds = _PagerankSeeds(conf.sources, mapping, n);
+			GrB_Index seed_count;
+			GrB_Vector_nvals(&seed_count, seeds);
+			// none of the source nodes is ranked
+			if(seed_count == 0) nvals = 0;
+		}
+
+		if(conf.warm_start != NULL) {
+			Attribute_ID attr_id = GraphContext_GetAttributeID(gc, conf.warm_start);
+			if(attr_id != ATTRIBUTE_NOTFOUND) {
+				init = _PagerankWarmStart(g, attr_id, mapping, n);
+			}
+		}
+
+		if(nvals > 0) {
+			info = Pagerank_Personalized(&ranking, &n, r, seeds, init, conf.top_k,
+					itermax, tol, &iters);
+			ASSERT(info == GrB_SUCCESS);
+		}
+
+		if(seeds != GrB_NULL) GrB_free(&seeds);
+		if(init != GrB_NULL) GrB_free(&init);
 	}
 
 	// Clean up.
@@ -187,6 +377,40 @@ SIValue *Proc_PagerankStep(ProcedureCtx *ctx) {
 	return pdata->output;
 }
 
+const ProcedureBatch *Proc_PagerankStepBatch(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	PagerankContext *pdata = (PagerankContext *)ctx->privateData;
+
+	// Depleted/no results
+	if(pdata->i >= pdata->n || pdata->ranking == NULL) return NULL;
+
+	if(pdata->nodes == NULL) {
+		pdata->nodes = rm_malloc(sizeof(Node) * PROCEDURE_BATCH_SIZE);
+		pdata->scores = rm_malloc(sizeof(double) * PROCEDURE_BATCH_SIZE);
+		pdata->columns[0].type = PROCEDURE_COLUMN_NODE;
+		pdata->columns[0].nodes = pdata->nodes;
+		pdata->columns[1].type = PROCEDURE_COLUMN_DOUBLE;
+		pdata->columns[1].doubles = pdata->scores;
+		pdata->batch.columns = pdata->columns;
+	}
+
+	uint count = PROCEDURE_BATCH_SIZE;
+	if(pdata->n - pdata->i < count) count = pdata->n - pdata->i;
+	const LAGraph_PageRank *ranking = pdata->ranking + pdata->i;
+	for(uint j = 0; j < count; j++) {
+		NodeID node_id = (pdata->mapping) ? pdata->mapping[ranking[j].page] :
+			ranking[j].page;
+		pdata->nodes[j] = GE_NEW_NODE();
+		Graph_GetNode(pdata->g, node_id, pdata->nodes + j);
+		pdata->scores[j] = ranking[j].pagerank;
+	}
+
+	pdata->i += count;
+	pdata->batch.count = count;
+	return &pdata->batch;
+}
+
 ProcedureResult Proc_PagerankFree(ProcedureCtx *ctx) {
 	// Clean up.
 	if(ctx->privateData) {
@@ -194,6 +418,8 @@ ProcedureResult Proc_PagerankFree(ProcedureCtx *ctx) {
 		if(pdata->output) array_free(pdata->output);
 		if(pdata->mapping) rm_free(pdata->mapping);
 		if(pdata->ranking) rm_free(pdata->ranking);
+		if(pdata->nodes) rm_free(pdata->nodes);
+		if(pdata->scores) rm_free(pdata->scores);
 		rm_free(ctx->privateData);
 	}
 
@@ -209,13 +435,14 @@ ProcedureCtx *Proc_PagerankCtx() {
 	outputs = array_append(outputs, output_score);
 
 	ProcedureCtx *ctx = ProcCtxNew("algo.pageRank",
-								   2,
+								   PROCEDURE_VARIABLE_ARG_COUNT,
 								   outputs,
 								   Proc_PagerankStep,
 								   Proc_PagerankInvoke,
 								   Proc_PagerankFree,
 								   privateData,
 								   true);
+	ctx->StepBatch = Proc_PagerankStepBatch;
 	return ctx;
 }
 
@@ -0,0 +1,254 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_projection.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../datatypes/map.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/subgraph.h"
+#include "../algorithms/undirected.h"
+
+// projections are built on first use by an algorithm, rebuilt once the graph
+// is modified, and kept in memory only, they're neither persisted nor replicated
+//
+// CALL algo.project('p', 'Person', 'KNOWS') YIELD name
+// CALL algo.pageRank(NULL, NULL, {projection: 'p'}) YIELD node, score
+// CALL algo.WCC(NULL, NULL, {projection: 'p'}) YIELD node, componentId
+// CALL algo.dropProjection('p') YIELD name
+
+typedef struct {
+	bool depleted;     // name was reported
+	SIValue *output;   // array with 2 entries ["name", name]
+} ProjectionContext;
+
+static ProcedureResult _ProjectionContext_Init(ProcedureCtx *ctx,
+		const char *name) {
+	ProjectionContext *pdata = rm_malloc(sizeof(ProjectionContext));
+	pdata->depleted = false;
+	pdata->output = array_new(SIValue, 2);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("name"));
+	pdata->output = array_append(pdata->output, SI_ConstStringVal((char *)name));
+	ctx->privateData = pdata;
+	return PROCEDURE_OK;
+}
+
+static ProcedureResult Proc_ProjectInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting 3 arguments
+	if(array_len((SIValue *)args) != 3) return PROCEDURE_ERR;
+	// arg0 is a String, arg1 and arg2 can be either String or NULL
+	SIType arg0_t = SI_TYPE(args[0]);
+	SIType arg1_t = SI_TYPE(args[1]);
+	SIType arg2_t = SI_TYPE(args[2]);
+	if(arg0_t != T_STRING) return PROCEDURE_ERR;
+	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg2_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	const char *name = args[0].stringval;
+	const char *label = (arg1_t == T_STRING) ? args[1].stringval : NULL;
+	const char *relation = (arg2_t == T_STRING) ? args[2].stringval : NULL;
+
+	int label_id = GRAPH_NO_LABEL;
+	if(label) {
+		Schema *s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+		if(!s) {
+			ErrorCtx_SetError("algo.project unknown label '%s'", label);
+			ErrorCtx_RaiseRuntimeException(NULL);
+			return PROCEDURE_ERR;
+		}
+		label_id = s->id;
+	}
+
+	int relation_id = GRAPH_NO_RELATION;
+	if(relation) {
+		Schema *s = GraphContext_GetSchema(gc, relation, SCHEMA_EDGE);
+		if(!s) {
+			ErrorCtx_SetError("algo.project unknown relationship type '%s'",
+							  relation);
+			ErrorCtx_RaiseRuntimeException(NULL);
+			return PROCEDURE_ERR;
+		}
+		relation_id = s->id;
+	}
+
+	Projection *p = Projection_New(name, label, label_id, relation, relation_id);
+	GraphContext_AddProjection(gc, p);
+
+	return _ProjectionContext_Init(ctx, p->name);
+}
+
+static ProcedureResult Proc_DropProjectionInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// expecting a single String argument
+	if(array_len((SIValue *)args) != 1) return PROCEDURE_ERR;
+	if(SI_TYPE(args[0]) != T_STRING) return PROCEDURE_ERR;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	const char *name = args[0].stringval;
+	if(!GraphContext_RemoveProjection(gc, name)) {
+		ErrorCtx_SetError("algo.dropProjection unknown projection '%s'", name);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	return _ProjectionContext_Init(ctx, name);
+}
+
+static SIValue *Proc_ProjectionStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	ProjectionContext *pdata = (ProjectionContext *)ctx->privateData;
+
+	// name is reported once
+	if(pdata->depleted) return NULL;
+	pdata->depleted = true;
+	return pdata->output;
+}
+
+static ProcedureResult Proc_ProjectionFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		ProjectionContext *pdata = ctx->privateData;
+		if(pdata->output) array_free(pdata->output);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+static ProcedureCtx *_ProjectionCtx(const char *name, unsigned int argc,
+									ProcInvoke invoke) {
+	void *privateData = NULL;
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 1);
+	ProcedureOutput output_name = {.name = "name", .type = T_STRING};
+	outputs = array_append(outputs, output_name);
+
+	// modifying the graph's projections requires the write lock
+	ProcedureCtx *ctx = ProcCtxNew(name,
+								   argc,
+								   outputs,
+								   Proc_ProjectionStep,
+								   invoke,
+								   Proc_ProjectionFree,
+								   privateData,
+								   false);
+	return ctx;
+}
+
+ProcedureCtx *Proc_ProjectCtx() {
+	return _ProjectionCtx("algo.project", 3, Proc_ProjectInvoke);
+}
+
+ProcedureCtx *Proc_DropProjectionCtx() {
+	return _ProjectionCtx("algo.dropProjection", 1, Proc_DropProjectionInvoke);
+}
+
+bool Proc_ProjectionConfig(const char *proc, SIValue config,
+						   const char **projection) {
+	*projection = NULL;
+	if(SIValue_IsNull(config)) return true;
+	if(SI_TYPE(config) != T_MAP) {
+		ErrorCtx_SetError("%s expects a configuration map", proc);
+		return false;
+	}
+
+	uint key_count = Map_KeyCount(config);
+	for(uint i = 0; i < key_count; i++) {
+		const char *key = config.map[i].key.stringval;
+		SIValue v = config.map[i].val;
+
+		if(strcmp(key, "projection") != 0) {
+			ErrorCtx_SetError("%s unknown configuration key '%s'", proc, key);
+			return false;
+		}
+		if(SI_TYPE(v) != T_STRING) {
+			ErrorCtx_SetError("%s invalid value for configuration key '%s'", proc,
+							  key);
+			return false;
+		}
+		*projection = v.stringval;
+	}
+
+	return true;
+}
+
+ProcedureResult Proc_AlgorithmGraph(const char *proc, const char *projection,
+		SIValue label, SIValue relation, bool undirected, GrB_Matrix *S,
+		GrB_Index **mapping, bool *shared) {
+	Graph *g = QueryCtx_GetGraph();
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+
+	GrB_Info info;
+	*S = GrB_NULL;
+	*mapping = NULL;
+	*shared = false;
+
+	if(projection) {
+		if(!SIValue_IsNull(label) || !SIValue_IsNull(relation)) {
+			ErrorCtx_SetError("%s projection can't be combined with a label or a relationship type",
+							  proc);
+			ErrorCtx_RaiseRuntimeException(NULL);
+			return PROCEDURE_ERR;
+		}
+
+		Projection *p = GraphContext_GetProjection(gc, projection);
+		if(!p) {
+			ErrorCtx_SetError("%s unknown projection '%s'", proc, projection);
+			ErrorCtx_RaiseRuntimeException(NULL);
+			return PROCEDURE_ERR;
+		}
+
+		const GrB_Index *p_mapping;
+		info = Projection_Get(p, g, undirected, S, &p_mapping);
+		ASSERT(info == GrB_SUCCESS);
+		UNUSED(info);
+
+		// callers own the mapping
+		if(p_mapping) {
+			GrB_Index n;
+			GrB_Matrix_nrows(&n, *S);
+			*mapping = rm_malloc(sizeof(GrB_Index) * n);
+			memcpy(*mapping, p_mapping, sizeof(GrB_Index) * n);
+		}
+
+		*shared = true;
+		return PROCEDURE_OK;
+	}
+
+	// get label matrix
+	GrB_Matrix l = GrB_NULL;
+	if(!SIValue_IsNull(label)) {
+		Schema *s = GraphContext_GetSchema(gc, label.stringval, SCHEMA_NODE);
+		// unknown label, quickly return
+		if(!s) return PROCEDURE_OK;
+		l = Graph_GetLabelMatrix(g, s->id);
+	}
+
+	// get relation matrix
+	GrB_Matrix r;
+	if(!SIValue_IsNull(relation)) {
+		Schema *s = GraphContext_GetSchema(gc, relation.stringval, SCHEMA_EDGE);
+		// unknown relation, quickly return
+		if(!s) return PROCEDURE_OK;
+		r = Graph_GetRelationMatrix(g, s->id);
+	} else {
+		// relation isn't specified, 'r' is the adjacency matrix
+		r = Graph_GetAdjacencyMatrix(g);
+	}
+
+	if(undirected) info = Undirected(S, mapping, r, l);
+	else info = Subgraph(S, mapping, r, l);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	return PROCEDURE_OK;
+}
@@ -0,0 +1,48 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "proc_ctx.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// create a named projection of the graph, reused by algorithm procedures
+ProcedureCtx *Proc_ProjectCtx();
+
+// drop a named projection
+ProcedureCtx *Proc_DropProjectionCtx();
+
+// parse an algorithm's optional configuration map, which may only
+// specify 'projection', NULL configurations are accepted
+// returns false and sets an error if the configuration is invalid
+bool Proc_ProjectionConfig
+(
+	const char *proc,         // procedure name, used in error messages
+	SIValue config,           // configuration map or NULL
+	const char **projection   // [output] projection name, NULL if unspecified
+);
+
+// resolve the graph an algorithm procedure operates on,
+// either the named projection or the subgraph of 'label' nodes
+// connected by 'relation' edges, built by Subgraph or Undirected
+//
+// S is set to NULL if 'label' or 'relation' doesn't exist
+// returns PROCEDURE_ERR and raises an error if the projection doesn't exist
+// or if it's combined with a label or a relationship type
+//
+// if 'shared' is set on return S belongs to the projection and must not be
+// freed, 'mapping' is always owned by the caller
+ProcedureResult Proc_AlgorithmGraph
+(
+	const char *proc,         // procedure name, used in error messages
+	const char *projection,   // projection name, NULL if unspecified
+	SIValue label,            // node label or NULL
+	SIValue relation,         // relationship type or NULL
+	bool undirected,          // symmetrize the graph
+	GrB_Matrix *S,            // [output] graph
+	GrB_Index **mapping,      // [output] rows of S to node IDs, NULL if rows are node IDs
+	bool *shared              // [output] S is owned by the projection
+);
@@ -0,0 +1,390 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_random_walk.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../datatypes/array.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/random_walk.h"
+
+// the randomWalk procedure walks the graph at random from one or more sources
+// it's inputs are:
+// 1. source node or list of source nodes to walk from
+// 2. walk length, maximum number of hops per walk
+// 3. relationship type to traverse, NULL for edge type agnostic
+// 4. optional, number of walks per source, 1 if NULL
+// 5. optional, random seed, the same seed reproduces the same walks
+//
+// each hop follows one of the current node's outgoing edges,
+// picked uniformly at random, a walk ends early at a node without any
+//
+// output:
+// 1. source - the walk's source
+// 2. walk - nodes visited by the walk, source first
+//
+// MATCH (u:User) WITH collect(u) AS users
+// CALL algo.randomWalk(users, 10, 'FOLLOWS', 5, 42) YIELD source, walk
+//
+// the sampleNeighbors procedure samples the neighborhood of one or more sources
+// it's inputs are:
+// 1. source node or list of source nodes to sample from
+// 2. fan-out, list of the number of neighbors sampled per node at each hop
+// 3. relationship type to traverse, NULL for edge type agnostic
+// 4. optional, random seed, the same seed reproduces the same samples
+//
+// at hop h up to the h-th fan-out distinct outgoing neighbors of every node
+// sampled at hop h - 1 are drawn, the source being hop 0
+//
+// output, one row per sampled node:
+// 1. source - the sampled neighborhood's source
+// 2. parent - node the sample was drawn from
+// 3. node - sampled node
+// 4. hop - distance from the source
+//
+// MATCH (u:User) WITH collect(u) AS users
+// CALL algo.sampleNeighbors(users, [10, 5], 'FOLLOWS') YIELD source, node, hop
+
+typedef struct {
+	Graph *g;                 // graph walked
+	GrB_Index *sources;       // source nodes
+	GrB_Index source_count;   // number of sources
+	uint64_t walk_count;      // number of walks per source
+	uint64_t length;          // maximum number of hops per walk
+	GrB_Index walk_total;     // number of walks
+	GrB_Index *walks;         // nodes of each walk, length + 1 slots per walk
+	uint64_t *lengths;        // number of nodes in each walk
+	NeighborSample **samples; // samples of each source
+	GrB_Index i;              // current walk or source to stream
+	uint32_t j;               // current sample of source i to stream
+	Node source;              // streamed source
+	Node parent;              // streamed parent
+	Node node;                // streamed node
+	SIValue *output;          // yielded outputs, name value pairs
+	int source_output_idx;    // offset of streamed source in outputs
+	int walk_output_idx;      // offset of streamed walk in outputs
+	int parent_output_idx;    // offset of streamed parent in outputs
+	int node_output_idx;      // offset of streamed node in outputs
+	int hop_output_idx;       // offset of streamed hop in outputs
+} RandomWalkCtx;
+
+// adds output 'name' if yielded, setting *idx to its value's offset
+static void _process_output(RandomWalkCtx *ctx, const char **yield,
+		const char *name, int *idx) {
+	bool yielded = (yield == NULL);
+	for(uint i = 0; yield != NULL && i < array_len(yield) && !yielded; i++) {
+		yielded = (strcasecmp(name, yield[i]) == 0);
+	}
+	if(!yielded) return;
+
+	ctx->output = array_append(ctx->output, SI_ConstStringVal((char *)name));
+	*idx = array_len(ctx->output);
+	ctx->output = array_append(ctx->output, SI_NullVal()); // Place holder.
+}
+
+// returns true if 'v' is a node or a list of nodes
+static bool _ValidSources(SIValue v) {
+	if(SI_TYPE(v) == T_NODE) return true;
+	if(SI_TYPE(v) != T_ARRAY) return false;
+	uint len = SIArray_Length(v);
+	for(uint i = 0; i < len; i++) {
+		if(SI_TYPE(SIArray_Get(v, i)) != T_NODE) return false;
+	}
+	return true;
+}
+
+// returns true if 'v' is a list of non negative integers
+static bool _ValidFanouts(SIValue v) {
+	if(SI_TYPE(v) != T_ARRAY) return false;
+	uint len = SIArray_Length(v);
+	for(uint i = 0; i < len; i++) {
+		SIValue fanout = SIArray_Get(v, i);
+		if(SI_TYPE(fanout) != T_INT64 || fanout.longval < 0) return false;
+	}
+	return true;
+}
+
+// collects the IDs of the source nodes
+static void _Sources(RandomWalkCtx *ctx, SIValue v) {
+	ctx->source_count = (SI_TYPE(v) == T_NODE) ? 1 : SIArray_Length(v);
+	ctx->sources = rm_malloc(sizeof(GrB_Index) * MAX(ctx->source_count, 1));
+	for(GrB_Index i = 0; i < ctx->source_count; i++) {
+		SIValue source = (SI_TYPE(v) == T_NODE) ? v : SIArray_Get(v, i);
+		ctx->sources[i] = ENTITY_GET_ID((Node *)source.ptrval);
+	}
+}
+
+// retrieve the matrix to traverse, NULL if relationship type is unknown
+static GrB_Matrix _TraversedMatrix(Graph *g, SIValue reltype) {
+	if(SIValue_IsNull(reltype)) return Graph_GetAdjacencyMatrix(g);
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Schema *s = GraphContext_GetSchema(gc, reltype.stringval, SCHEMA_EDGE);
+	return (s != NULL) ? Graph_GetRelationMatrix(g, s->id) : GrB_NULL;
+}
+
+// random seed, unless specified
+static uint64_t _Seed(SIValue v) {
+	return SIValue_IsNull(v) ? (uint64_t)random() : (uint64_t)v.longval;
+}
+
+static ProcedureResult Proc_RandomWalk_Invoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// validate inputs
+	ASSERT(ctx != NULL);
+	ASSERT(args != NULL);
+
+	uint argc = array_len((SIValue *)args);
+	if(argc < 3 || argc > 5) return PROCEDURE_ERR;
+	SIValue walk_count = (argc > 3) ? args[3] : SI_NullVal();
+	SIValue seed = (argc > 4) ? args[4] : SI_NullVal();
+	if(!_ValidSources(args[0])                       ||  // source node(s)
+	   SI_TYPE(args[1]) != T_INT64                   ||  // walk length
+	   !(SI_TYPE(args[2]) & (T_NULL | T_STRING))     ||  // relationship type
+	   !(SI_TYPE(walk_count) & (T_NULL | T_INT64))   ||  // walks per source
+	   !(SI_TYPE(seed) & (T_NULL | T_INT64)))            // random seed
+		return PROCEDURE_ERR;
+
+	int64_t length = args[1].longval;
+	int64_t walks = SIValue_IsNull(walk_count) ? 1 : walk_count.longval;
+	if(length < 0 || walks < 1) {
+		ErrorCtx_SetError("algo.randomWalk expects a non negative length and a positive number of walks");
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	RandomWalkCtx *pdata = ctx->privateData;
+	_process_output(pdata, yield, "source", &pdata->source_output_idx);
+	_process_output(pdata, yield, "walk", &pdata->walk_output_idx);
+
+	//--------------------------------------------------------------------------
+	// walk
+	//--------------------------------------------------------------------------
+
+	GrB_Matrix A = _TraversedMatrix(pdata->g, args[2]);
+	// unknown relationship type, first step will return NULL
+	if(A == GrB_NULL) return PROCEDURE_OK;
+
+	_Sources(pdata, args[0]);
+	pdata->walk_count = walks;
+	pdata->length = length;
+
+	GrB_Index total = pdata->source_count * pdata->walk_count;
+	pdata->walk_total = total;
+	pdata->walks = rm_malloc(sizeof(GrB_Index) * MAX(total * (length + 1), 1));
+	pdata->lengths = rm_malloc(sizeof(uint64_t) * MAX(total, 1));
+	GrB_Info info = RandomWalk(pdata->walks, pdata->lengths, pdata->sources,
+			pdata->source_count, pdata->walk_count, pdata->length, _Seed(seed), A);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_RandomWalk_Step(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	RandomWalkCtx *pdata = (RandomWalkCtx *)ctx->privateData;
+	if(pdata->i >= pdata->walk_total) return NULL;
+
+	GrB_Index w = pdata->i++;
+	const GrB_Index *walk = pdata->walks + w * (pdata->length + 1);
+
+	if(pdata->source_output_idx != -1) {
+		Graph_GetNode(pdata->g, walk[0], &pdata->source);
+		pdata->output[pdata->source_output_idx] = SI_Node(&pdata->source);
+	}
+
+	if(pdata->walk_output_idx != -1) {
+		uint64_t n = pdata->lengths[w];
+		SIValue nodes = SI_Array(n);
+		for(uint64_t k = 0; k < n; k++) {
+			Node node = GE_NEW_NODE();
+			Graph_GetNode(pdata->g, walk[k], &node);
+			SIArray_Append(&nodes, SI_Node(&node));
+		}
+		pdata->output[pdata->walk_output_idx] = nodes;
+	}
+
+	return pdata->output;
+}
+
+static ProcedureResult Proc_SampleNeighbors_Invoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// validate inputs
+	ASSERT(ctx != NULL);
+	ASSERT(args != NULL);
+
+	uint argc = array_len((SIValue *)args);
+	if(argc != 3 && argc != 4) return PROCEDURE_ERR;
+	SIValue seed = (argc > 3) ? args[3] : SI_NullVal();
+	if(!_ValidSources(args[0])                       ||  // source node(s)
+	   !(SI_TYPE(args[2]) & (T_NULL | T_STRING))     ||  // relationship type
+	   !(SI_TYPE(seed) & (T_NULL | T_INT64)))            // random seed
+		return PROCEDURE_ERR;
+
+	// fan-out per hop
+	if(!_ValidFanouts(args[1])) {
+		ErrorCtx_SetError("algo.sampleNeighbors expects a list of non negative fan-outs");
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	RandomWalkCtx *pdata = ctx->privateData;
+	_process_output(pdata, yield, "source", &pdata->source_output_idx);
+	_process_output(pdata, yield, "parent", &pdata->parent_output_idx);
+	_process_output(pdata, yield, "node", &pdata->node_output_idx);
+	_process_output(pdata, yield, "hop", &pdata->hop_output_idx);
+
+	//--------------------------------------------------------------------------
+	// sample
+	//--------------------------------------------------------------------------
+
+	GrB_Matrix A = _TraversedMatrix(pdata->g, args[2]);
+	// unknown relationship type, first step will return NULL
+	if(A == GrB_NULL) return PROCEDURE_OK;
+
+	_Sources(pdata, args[0]);
+
+	uint hop_count = SIArray_Length(args[1]);
+	uint64_t *fanouts = rm_malloc(sizeof(uint64_t) * MAX(hop_count, 1));
+	for(uint i = 0; i < hop_count; i++) fanouts[i] = SIArray_Get(args[1], i).longval;
+
+	GrB_Info info = SampleNeighbors(&pdata->samples, pdata->sources,
+			pdata->source_count, fanouts, hop_count, _Seed(seed), A);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+	rm_free(fanouts);
+
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_SampleNeighbors_Step(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	RandomWalkCtx *pdata = (RandomWalkCtx *)ctx->privateData;
+	if(pdata->samples == NULL) return NULL;
+
+	// advance to the next source with samples left
+	while(pdata->i < pdata->source_count &&
+		  pdata->j >= array_len(pdata->samples[pdata->i])) {
+		pdata->i++;
+		pdata->j = 0;
+	}
+	if(pdata->i >= pdata->source_count) return NULL;
+
+	const NeighborSample *s = pdata->samples[pdata->i] + pdata->j++;
+
+	if(pdata->source_output_idx != -1) {
+		Graph_GetNode(pdata->g, pdata->sources[pdata->i], &pdata->source);
+		pdata->output[pdata->source_output_idx] = SI_Node(&pdata->source);
+	}
+	if(pdata->parent_output_idx != -1) {
+		Graph_GetNode(pdata->g, s->parent, &pdata->parent);
+		pdata->output[pdata->parent_output_idx] = SI_Node(&pdata->parent);
+	}
+	if(pdata->node_output_idx != -1) {
+		Graph_GetNode(pdata->g, s->node, &pdata->node);
+		pdata->output[pdata->node_output_idx] = SI_Node(&pdata->node);
+	}
+	if(pdata->hop_output_idx != -1) {
+		pdata->output[pdata->hop_output_idx] = SI_LongVal(s->hop);
+	}
+
+	return pdata->output;
+}
+
+static ProcedureResult Proc_RandomWalk_Free(ProcedureCtx *ctx) {
+	ASSERT(ctx != NULL);
+	// free private data
+	RandomWalkCtx *pdata = ctx->privateData;
+	if(pdata->samples != NULL) {
+		for(GrB_Index i = 0; i < pdata->source_count; i++) array_free(pdata->samples[i]);
+		rm_free(pdata->samples);
+	}
+	if(pdata->output != NULL) array_free(pdata->output);
+	if(pdata->sources != NULL) rm_free(pdata->sources);
+	if(pdata->walks != NULL) rm_free(pdata->walks);
+	if(pdata->lengths != NULL) rm_free(pdata->lengths);
+	rm_free(ctx->privateData);
+
+	return PROCEDURE_OK;
+}
+
+static RandomWalkCtx *_Build_Private_Data() {
+	RandomWalkCtx *pdata = rm_calloc(1, sizeof(RandomWalkCtx));
+	pdata->g = QueryCtx_GetGraph();
+	pdata->sources = NULL;
+	pdata->source_count = 0;
+	pdata->walk_total = 0;
+	pdata->walks = NULL;
+	pdata->lengths = NULL;
+	pdata->samples = NULL;
+	pdata->i = 0;
+	pdata->j = 0;
+	pdata->source = GE_NEW_NODE();
+	pdata->parent = GE_NEW_NODE();
+	pdata->node = GE_NEW_NODE();
+	pdata->output = array_new(SIValue, 8);
+	pdata->source_output_idx = -1;
+	pdata->walk_output_idx = -1;
+	pdata->parent_output_idx = -1;
+	pdata->node_output_idx = -1;
+	pdata->hop_output_idx = -1;
+	return pdata;
+}
+
+ProcedureCtx *Proc_RandomWalkCtx() {
+	// construct procedure private data
+	void *privdata = _Build_Private_Data();
+
+	// declare possible outputs
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 2);
+	ProcedureOutput out_source = {.name = "source", .type = T_NODE};
+	ProcedureOutput out_walk = {.name = "walk", .type = T_ARRAY};
+	outputs = array_append(outputs, out_source);
+	outputs = array_append(outputs, out_walk);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.randomWalk",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_RandomWalk_Step,
+								   Proc_RandomWalk_Invoke,
+								   Proc_RandomWalk_Free,
+								   privdata,
+								   true);
+	return ctx;
+}
+
+ProcedureCtx *Proc_SampleNeighborsCtx() {
+	// construct procedure private data
+	void *privdata = _Build_Private_Data();
+
+	// declare possible outputs
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 4);
+	ProcedureOutput out_source = {.name = "source", .type = T_NODE};
+	ProcedureOutput out_parent = {.name = "parent", .type = T_NODE};
+	ProcedureOutput out_node = {.name = "node", .type = T_NODE};
+	ProcedureOutput out_hop = {.name = "hop", .type = T_INT64};
+	outputs = array_append(outputs, out_source);
+	outputs = array_append(outputs, out_parent);
+	outputs = array_append(outputs, out_node);
+	outputs = array_append(outputs, out_hop);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.sampleNeighbors",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_SampleNeighbors_Step,
+								   Proc_SampleNeighbors_Invoke,
+								   Proc_RandomWalk_Free,
+								   privdata,
+								   true);
+	return ctx;
+}
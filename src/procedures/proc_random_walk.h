@@ -0,0 +1,15 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "proc_ctx.h"
+
+// perform random walks from one or more source nodes
+ProcedureCtx *Proc_RandomWalkCtx();
+
+// sample the neighborhoods of one or more source nodes
+ProcedureCtx *Proc_SampleNeighborsCtx();
@@ -0,0 +1,388 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_sp_paths.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../algorithms/sssp.h"
+#include "../datatypes/path/path.h"
+#include "../graph/graphcontext.h"
+#include <math.h>
+
+// the SPpaths procedure finds the cheapest path from a source node
+// it's inputs are:
+// 1. source node to traverse from
+// 2. target node, if NULL the cheapest path to every reachable node is reported
+// 3. relationship type to traverse, NULL for edge type agnostic
+// 4. edge attribute holding each edge's cost, NULL for a cost of 1 per edge
+//    edges lacking a numeric cost are not traversed
+// 5. maximum path cost, NULL for unbounded
+//
+// output:
+// 1. path - a cheapest path
+// 2. cost - the path's total cost
+//
+// MATCH (a:City {name: 'A'}), (b:City {name: 'B'})
+// CALL algo.SPpaths(a, b, 'ROAD', 'distance', NULL) YIELD path, cost
+
+typedef struct {
+	Graph *g;                 // graph scanned
+	int reltype_id;           // relationship type traversed
+	Attribute_ID weight_id;   // edge attribute holding edge cost
+	bool unit_weight;         // every edge costs 1
+	NodeID src;               // source node
+	GrB_Matrix WT;            // transposed edge costs, row v holds v's predecessors
+	GrB_Vector cost;          // cost of the cheapest path to each node
+	GrB_Vector level;         // round in which each node's cost was set
+	GrB_Index *reached;       // nodes to report
+	GrB_Index reached_count;  // number of nodes to report
+	GrB_Index pos;            // next node to report
+	Edge *edges;              // edges connecting a pair of nodes
+	SIValue *output;          // ["path", path, "cost", cost]
+	int path_output_idx;      // offset of path in outputs
+	int cost_output_idx;      // offset of cost in outputs
+} SPPathsCtx;
+
+static void _process_yield(SPPathsCtx *ctx, const char **yield) {
+	bool yield_path = (yield == NULL);
+	bool yield_cost = (yield == NULL);
+
+	for(uint i = 0; yield != NULL && i < array_len(yield); i++) {
+		if(strcasecmp("path", yield[i]) == 0) yield_path = true;
+		else if(strcasecmp("cost", yield[i]) == 0) yield_cost = true;
+	}
+
+	if(yield_path) {
+		ctx->output = array_append(ctx->output, SI_ConstStringVal("path"));
+		ctx->path_output_idx = array_len(ctx->output);
+		ctx->output = array_append(ctx->output, SI_NullVal()); // Place holder.
+	}
+
+	if(yield_cost) {
+		ctx->output = array_append(ctx->output, SI_ConstStringVal("cost"));
+		ctx->cost_output_idx = array_len(ctx->output);
+		ctx->output = array_append(ctx->output, SI_NullVal()); // Place holder.
+	}
+}
+
+// sets 'w' to the cost of edge 'e', returns false if 'e' can't be traversed
+static bool _EdgeCost(const SPPathsCtx *ctx, Edge *e, double *w) {
+	if(ctx->unit_weight) {
+		*w = 1;
+		return true;
+	}
+
+	SIValue v = GraphEntity_GetProperty((GraphEntity *)e, ctx->weight_id);
+	if(!(SI_TYPE(v) & SI_NUMERIC)) return false;
+
+	*w = SI_GET_NUMERIC(v);
+	if(*w < 0 || isnan(*w)) {
+		ErrorCtx_SetError("algo.SPpaths expects non-negative edge costs");
+		return false;
+	}
+	return true;
+}
+
+// sets 'w' to the cost of the cheapest edge connecting src to dest
+// returns the cheapest edge, NULL if src and dest aren't connected
+static Edge *_CheapestEdge(SPPathsCtx *ctx, NodeID src, NodeID dest, double *w) {
+	array_clear(ctx->edges);
+	Graph_GetEdgesConnectingNodes(ctx->g, src, dest, ctx->reltype_id, &ctx->edges);
+
+	Edge *cheapest = NULL;
+	uint count = array_len(ctx->edges);
+	for(uint i = 0; i < count; i++) {
+		double edge_cost;
+		if(!_EdgeCost(ctx, ctx->edges + i, &edge_cost)) continue;
+		if(cheapest == NULL || edge_cost < *w) {
+			cheapest = ctx->edges + i;
+			*w = edge_cost;
+		}
+	}
+	return cheapest;
+}
+
+// extract the cost of each traversable connection into W and its transpose
+static bool _BuildCostMatrix(SPPathsCtx *ctx, GrB_Matrix R, GrB_Matrix *W) {
+	GrB_Index n = Graph_RequiredMatrixDim(ctx->g);
+	GrB_Index nvals;
+	GrB_Matrix_nvals(&nvals, R);
+
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * nvals);
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * nvals);
+	double *X = rm_malloc(sizeof(double) * nvals);
+	GrB_Index count = 0;
+
+	GrB_Index src;
+	GrB_Index dest;
+	bool depleted = false;
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, R);
+	while(true) {
+		GxB_MatrixTupleIter_next(iter, &src, &dest, &depleted);
+		if(depleted) break;
+
+		double w;
+		if(_CheapestEdge(ctx, src, dest, &w) == NULL) continue;
+		I[count] = src;
+		J[count] = dest;
+		X[count] = w;
+		count++;
+	}
+	GxB_MatrixTupleIter_free(iter);
+
+	bool valid = !ErrorCtx_EncounteredError();
+	if(valid) {
+		GrB_Matrix_new(W, GrB_FP64, n, n);
+		GrB_Matrix_new(&ctx->WT, GrB_FP64, n, n);
+		GrB_Matrix_build_FP64(*W, I, J, X, count, GrB_MIN_FP64);
+		GrB_Matrix_build_FP64(ctx->WT, J, I, X, count, GrB_MIN_FP64);
+	}
+
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+	return valid;
+}
+
+static ProcedureResult Proc_SPPaths_Invoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	// validate inputs
+	ASSERT(ctx != NULL);
+	ASSERT(args != NULL);
+
+	if(array_len((SIValue *)args) != 5) return PROCEDURE_ERR;
+	if(SI_TYPE(args[0]) != T_NODE                   ||  // source node
+	   !(SI_TYPE(args[1]) & (T_NULL | T_NODE))      ||  // target node
+	   !(SI_TYPE(args[2]) & (T_NULL | T_STRING))    ||  // relationship type
+	   !(SI_TYPE(args[3]) & (T_NULL | T_STRING))    ||  // cost attribute
+	   !(SI_TYPE(args[4]) & (T_NULL | SI_NUMERIC)))     // maximum cost
+		return PROCEDURE_ERR;
+
+	SPPathsCtx *pdata = ctx->privateData;
+	_process_yield(pdata, yield);
+
+	//--------------------------------------------------------------------------
+	// process inputs
+	//--------------------------------------------------------------------------
+
+	pdata->src = ENTITY_GET_ID((Node *)args[0].ptrval);
+	GrB_Index target = GxB_INDEX_MAX;
+	if(SI_TYPE(args[1]) == T_NODE) target = ENTITY_GET_ID((Node *)args[1].ptrval);
+	double max_cost = SIValue_IsNull(args[4]) ? INFINITY : SI_GET_NUMERIC(args[4]);
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	GrB_Matrix R;
+	if(SIValue_IsNull(args[2])) {
+		R = Graph_GetAdjacencyMatrix(pdata->g);
+	} else {
+		Schema *s = GraphContext_GetSchema(gc, args[2].stringval, SCHEMA_EDGE);
+		// unknown relationship type, first step will return NULL
+		if(!s) return PROCEDURE_OK;
+		pdata->reltype_id = s->id;
+		R = Graph_GetRelationMatrix(pdata->g, s->id);
+	}
+
+	if(!SIValue_IsNull(args[3])) {
+		pdata->unit_weight = false;
+		pdata->weight_id = GraphContext_GetAttributeID(gc, args[3].stringval);
+		// unknown attribute, no edge can be traversed
+		if(pdata->weight_id == ATTRIBUTE_NOTFOUND) R = GrB_NULL;
+	}
+
+	//--------------------------------------------------------------------------
+	// compute path costs
+	//--------------------------------------------------------------------------
+
+	GrB_Matrix W = GrB_NULL;
+	if(R == GrB_NULL) {
+		GrB_Index n = Graph_RequiredMatrixDim(pdata->g);
+		GrB_Matrix_new(&W, GrB_FP64, n, n);
+		GrB_Matrix_new(&pdata->WT, GrB_FP64, n, n);
+	} else if(!_BuildCostMatrix(pdata, R, &W)) {
+		// invalid edge cost
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	GrB_Info info = SSSP(&pdata->cost, &pdata->level, W, pdata->src, target,
+						 max_cost);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+	GrB_free(&W);
+
+	//--------------------------------------------------------------------------
+	// collect nodes to report
+	//--------------------------------------------------------------------------
+
+	if(target != GxB_INDEX_MAX) {
+		double target_cost;
+		if(GrB_Vector_extractElement_FP64(&target_cost, pdata->cost, target) == GrB_SUCCESS) {
+			pdata->reached = rm_malloc(sizeof(GrB_Index));
+			pdata->reached[0] = target;
+			pdata->reached_count = 1;
+		}
+	} else {
+		// every reached node but the source, in ID order
+		GrB_Index nvals;
+		GrB_Vector_nvals(&nvals, pdata->cost);
+		pdata->reached = rm_malloc(sizeof(GrB_Index) * nvals);
+		GrB_Vector_extractTuples_FP64(pdata->reached, NULL, &nvals, pdata->cost);
+		GrB_Index count = 0;
+		for(GrB_Index i = 0; i < nvals; i++) {
+			if(pdata->reached[i] != pdata->src) pdata->reached[count++] = pdata->reached[i];
+		}
+		pdata->reached_count = count;
+	}
+
+	return PROCEDURE_OK;
+}
+
+// reconstruct the cheapest path from the source to 'dest'
+static Path *_BuildPath(SPPathsCtx *ctx, GrB_Index dest) {
+	Edge *path_edges = array_new(Edge, 1);
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, ctx->WT);
+
+	// walk from dest back to the source
+	// following predecessors set at an earlier round on the cheapest path
+	GrB_Index v = dest;
+	while(v != ctx->src) {
+		double v_cost;
+		uint64_t v_level;
+		GrB_Vector_extractElement_FP64(&v_cost, ctx->cost, v);
+		GrB_Vector_extractElement_UINT64(&v_level, ctx->level, v);
+
+		GrB_Index p;
+		bool found = false;
+		bool depleted = false;
+		GxB_MatrixTupleIter_iterate_row(iter, v);
+		while(!found) {
+			GxB_MatrixTupleIter_next(iter, NULL, &p, &depleted);
+			if(depleted) break;
+
+			double p_cost;
+			uint64_t p_level;
+			if(GrB_Vector_extractElement_UINT64(&p_level, ctx->level, p) != GrB_SUCCESS) continue;
+			if(p_level >= v_level) continue;
+
+			double w;
+			GrB_Vector_extractElement_FP64(&p_cost, ctx->cost, p);
+			GrB_Matrix_extractElement_FP64(&w, ctx->WT, v, p);
+			found = (p_cost + w == v_cost);
+		}
+		ASSERT(found);
+		if(!found) break;
+
+		double w;
+		Edge *e = _CheapestEdge(ctx, p, v, &w);
+		ASSERT(e != NULL);
+		path_edges = array_append(path_edges, *e);
+		v = p;
+	}
+
+	GxB_MatrixTupleIter_free(iter);
+
+	// path edges were collected from dest to source
+	uint edge_count = array_len(path_edges);
+	Path *path = Path_New(edge_count);
+	Node n = GE_NEW_NODE();
+	Graph_GetNode(ctx->g, ctx->src, &n);
+	Path_AppendNode(path, n);
+	for(int i = edge_count - 1; i >= 0; i--) {
+		Edge *e = path_edges + i;
+		Path_AppendEdge(path, *e);
+		n = GE_NEW_NODE();
+		Graph_GetNode(ctx->g, Edge_GetDestNodeID(e), &n);
+		Path_AppendNode(path, n);
+	}
+
+	array_free(path_edges);
+	return path;
+}
+
+static SIValue *Proc_SPPaths_Step(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	SPPathsCtx *pdata = (SPPathsCtx *)ctx->privateData;
+	if(pdata->pos >= pdata->reached_count) return NULL;
+
+	GrB_Index dest = pdata->reached[pdata->pos++];
+
+	if(pdata->path_output_idx != -1) {
+		Path *path = _BuildPath(pdata, dest);
+		pdata->output[pdata->path_output_idx] = SI_Path(path);
+		Path_Free(path);
+	}
+
+	if(pdata->cost_output_idx != -1) {
+		double cost;
+		GrB_Vector_extractElement_FP64(&cost, pdata->cost, dest);
+		pdata->output[pdata->cost_output_idx] = SI_DoubleVal(cost);
+	}
+
+	return pdata->output;
+}
+
+static ProcedureResult Proc_SPPaths_Free(ProcedureCtx *ctx) {
+	ASSERT(ctx != NULL);
+	// free private data
+	SPPathsCtx *pdata = ctx->privateData;
+	if(pdata->output != NULL) array_free(pdata->output);
+	if(pdata->edges != NULL) array_free(pdata->edges);
+	if(pdata->reached != NULL) rm_free(pdata->reached);
+	if(pdata->WT != GrB_NULL) GrB_free(&pdata->WT);
+	if(pdata->cost != GrB_NULL) GrB_free(&pdata->cost);
+	if(pdata->level != GrB_NULL) GrB_free(&pdata->level);
+	rm_free(ctx->privateData);
+
+	return PROCEDURE_OK;
+}
+
+static SPPathsCtx *_Build_Private_Data() {
+	SPPathsCtx *pdata = rm_calloc(1, sizeof(SPPathsCtx));
+	pdata->g = QueryCtx_GetGraph();
+	pdata->reltype_id = GRAPH_NO_RELATION;
+	pdata->weight_id = ATTRIBUTE_NOTFOUND;
+	pdata->unit_weight = true;
+	pdata->WT = GrB_NULL;
+	pdata->cost = GrB_NULL;
+	pdata->level = GrB_NULL;
+	pdata->reached = NULL;
+	pdata->reached_count = 0;
+	pdata->pos = 0;
+	pdata->edges = array_new(Edge, 1);
+	pdata->output = array_new(SIValue, 4);
+	pdata->path_output_idx = -1;
+	pdata->cost_output_idx = -1;
+	return pdata;
+}
+
+ProcedureCtx *Proc_SPPathsCtx() {
+	// construct procedure private data
+	void *privdata = _Build_Private_Data();
+
+	// declare possible outputs
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 2);
+	ProcedureOutput out_path = {.name = "path", .type = T_PATH};
+	ProcedureOutput out_cost = {.name = "cost", .type = T_DOUBLE};
+	outputs = array_append(outputs, out_path);
+	outputs = array_append(outputs, out_cost);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.SPpaths",
+								   5,
+								   outputs,
+								   Proc_SPPaths_Step,
+								   Proc_SPPaths_Invoke,
+								   Proc_SPPaths_Free,
+								   privdata,
+								   true);
+	return ctx;
+}
@@ -0,0 +1,152 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_triangle_count.h"
+#include "proc_projection.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../algorithms/triangle_count.h"
+
+// edge direction and self loops are ignored, every node is reported along
+// with the number of triangles it takes part in and its local clustering coefficient
+//
+// CALL algo.triangleCount(NULL, NULL)        YIELD node, triangles, coefficient
+// CALL algo.triangleCount('User', NULL)      YIELD node, triangles, coefficient
+// CALL algo.triangleCount(NULL, 'KNOWS')     YIELD node, triangles, coefficient
+// CALL algo.triangleCount('User', 'KNOWS')   YIELD node, triangles, coefficient
+
+typedef struct {
+	GrB_Index n;              // number of nodes
+	GrB_Index i;              // current node to return
+	Graph *g;                 // graph
+	Node node;                // node
+	GrB_Index *mapping;       // mapping between extracted matrix rows and node ids
+	uint64_t *triangles;      // number of triangles containing each node
+	double *coefficients;     // local clustering coefficient of each node
+	SIValue *output;          // array with 6 entries ["node", node, "triangles", t, "coefficient", c]
+} TriangleCountContext;
+
+static ProcedureResult Proc_TriangleCountInvoke(ProcedureCtx *ctx, const SIValue *args,
+		const char **yield) {
+	// expecting 2 arguments, and an optional configuration map
+	uint argc = array_len((SIValue *)args);
+	if(argc != 2 && argc != 3) return PROCEDURE_ERR;
+	// arg0 and arg1 can be either String or NULL
+	SIType arg0_t = SI_TYPE(args[0]);
+	SIType arg1_t = SI_TYPE(args[1]);
+	if(!(arg0_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+	if(!(arg1_t & (T_STRING | T_NULL))) return PROCEDURE_ERR;
+
+	// optional configuration map can specify a projection
+	const char *projection;
+	SIValue config = (argc == 3) ? args[2] : SI_NullVal();
+	if(!Proc_ProjectionConfig("algo.triangleCount", config, &projection)) {
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	Graph *g = QueryCtx_GetGraph();
+
+	// setup context
+	TriangleCountContext *pdata = rm_malloc(sizeof(TriangleCountContext));
+	pdata->n = 0;
+	pdata->i = 0;
+	pdata->g = g;
+	pdata->node = GE_NEW_NODE();
+	pdata->mapping = NULL;
+	pdata->triangles = NULL;
+	pdata->coefficients = NULL;
+	pdata->output = array_new(SIValue, 6);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
+	pdata->output = array_append(pdata->output, SI_Node(NULL)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("triangles"));
+	pdata->output = array_append(pdata->output, SI_LongVal(0)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("coefficient"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+	ctx->privateData = pdata;
+
+	GrB_Matrix S;
+	bool shared;
+	ProcedureResult res = Proc_AlgorithmGraph("algo.triangleCount", projection, args[0], args[1],
+			true, &S, &pdata->mapping, &shared);
+	// unknown schema or projection
+	if(S == GrB_NULL) return res;
+
+	GrB_Info info;
+	info = GrB_Matrix_nrows(&pdata->n, S);
+	ASSERT(info == GrB_SUCCESS);
+
+	uint64_t total;
+	info = TriangleCount(&pdata->triangles, &pdata->coefficients, &total, S);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	if(!shared) GrB_free(&S);
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_TriangleCountStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	TriangleCountContext *pdata = (TriangleCountContext *)ctx->privateData;
+	GrB_Index node_count = Graph_RequiredMatrixDim(pdata->g);
+
+	while(pdata->i < pdata->n) {
+		GrB_Index i = pdata->i++;
+		NodeID node_id = (pdata->mapping) ? pdata->mapping[i] : i;
+		// skip deleted nodes
+		if(node_id >= node_count) continue;
+		if(!Graph_GetNode(pdata->g, node_id, &pdata->node)) continue;
+
+		pdata->output[1] = SI_Node(&pdata->node);
+		pdata->output[3] = SI_LongVal(pdata->triangles[i]);
+		pdata->output[5] = SI_DoubleVal(pdata->coefficients[i]);
+		return pdata->output;
+	}
+
+	// depleted/no results
+	return NULL;
+}
+
+static ProcedureResult Proc_TriangleCountFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		TriangleCountContext *pdata = ctx->privateData;
+		if(pdata->output) array_free(pdata->output);
+		if(pdata->mapping) rm_free(pdata->mapping);
+		if(pdata->triangles) rm_free(pdata->triangles);
+		if(pdata->coefficients) rm_free(pdata->coefficients);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_TriangleCountCtx() {
+	void *privateData = NULL;
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 3);
+	ProcedureOutput output_node = {.name = "node", .type = T_NODE};
+	ProcedureOutput output_triangles = {.name = "triangles", .type = T_INT64};
+	ProcedureOutput output_coefficient = {.name = "coefficient", .type = T_DOUBLE};
+	outputs = array_append(outputs, output_node);
+	outputs = array_append(outputs, output_triangles);
+	outputs = array_append(outputs, output_coefficient);
+
+	ProcedureCtx *ctx = ProcCtxNew("algo.triangleCount",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_TriangleCountStep,
+								   Proc_TriangleCountInvoke,
+								   Proc_TriangleCountFree,
+								   privateData,
+								   true);
+	return ctx;
+}
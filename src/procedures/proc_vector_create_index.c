@@ -0,0 +1,75 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_vector_create_index.h"
+#include "../value.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+#include "../index/index.h"
+
+//------------------------------------------------------------------------------
+// vector createNodeIndex
+//------------------------------------------------------------------------------
+
+// CALL db.idx.vector.createNodeIndex(label, attributes...)
+// CALL db.idx.vector.createNodeIndex('document', 'embedding')
+ProcedureResult Proc_VectorCreateNodeIdxInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	uint arg_count = array_len((SIValue *)args);
+	if(arg_count < 2) return PROCEDURE_ERR;
+
+	// validation, all arguments should be of type string
+	for(uint i = 0; i < arg_count; i++) {
+		if(!(SI_TYPE(args[i]) & T_STRING)) return PROCEDURE_ERR;
+	}
+
+	// create vector index
+	int res               = INDEX_FAIL;
+	Index *idx            = NULL;
+	GraphContext *gc      = QueryCtx_GetGraphCtx();
+	uint fields_count     = arg_count - 1;
+	const char *label     = args[0].stringval;
+	const SIValue *fields = args + 1; // skip label
+
+	// introduce fields to index
+	for(int i = 0; i < fields_count; i++) {
+		const char *field = fields[i].stringval;
+		if(GraphContext_AddIndex(&idx, gc, label, field, IDX_VECTOR) == INDEX_OK) {
+			res = INDEX_OK;
+		}
+	}
+
+	// build index
+	if(res == INDEX_OK) Index_Construct(idx);
+
+	return PROCEDURE_OK;
+}
+
+SIValue *Proc_VectorCreateNodeIdxStep(ProcedureCtx *ctx) {
+	return NULL;
+}
+
+ProcedureResult Proc_VectorCreateNodeIdxFree(ProcedureCtx *ctx) {
+	// Clean up.
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_VectorCreateNodeIdxGen() {
+	void *privateData = NULL;
+	ProcedureOutput *output = array_new(ProcedureOutput, 0);
+	ProcedureCtx *ctx = ProcCtxNew("db.idx.vector.createNodeIndex",
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   output,
+								   Proc_VectorCreateNodeIdxStep,
+								   Proc_VectorCreateNodeIdxInvoke,
+								   Proc_VectorCreateNodeIdxFree,
+								   privateData,
+								   false);
+
+	return ctx;
+}
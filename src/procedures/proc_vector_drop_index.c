@@ -0,0 +1,55 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_vector_drop_index.h"
+#include "../query_ctx.h"
+#include "../value.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+
+//------------------------------------------------------------------------------
+// vector drop
+//------------------------------------------------------------------------------
+
+// CALL db.idx.vector.drop(label)
+// CALL db.idx.vector.drop('document')
+
+ProcedureResult Proc_VectorDropIndexInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	if(array_len((SIValue *)args) != 1) return PROCEDURE_ERR;
+	if(!(SI_TYPE(args[0]) & T_STRING)) return PROCEDURE_ERR;
+
+	const char *label = args[0].stringval;
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	GraphContext_DeleteIndex(gc, label, NULL, IDX_VECTOR);
+
+	return PROCEDURE_OK;
+}
+
+SIValue *Proc_VectorDropIndexStep(ProcedureCtx *ctx) {
+	return NULL;
+}
+
+ProcedureResult Proc_VectorDropIndexFree(ProcedureCtx *ctx) {
+	// Clean up.
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_VectorDropIdxGen() {
+	void *privateData = NULL;
+	ProcedureOutput *output = array_new(ProcedureOutput, 0);
+	ProcedureCtx *ctx = ProcCtxNew("db.idx.vector.drop",
+								   1,
+								   output,
+								   Proc_VectorDropIndexStep,
+								   Proc_VectorDropIndexInvoke,
+								   Proc_VectorDropIndexFree,
+								   privateData,
+								   false);
+
+	return ctx;
+}
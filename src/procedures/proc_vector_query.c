@@ -0,0 +1,139 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_vector_query.h"
+#include "RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../index/index.h"
+#include "../util/rmalloc.h"
+#include "../graph/graphcontext.h"
+
+//------------------------------------------------------------------------------
+// vector query
+//------------------------------------------------------------------------------
+
+// CALL db.idx.vector.query(label, attribute, k, vector)
+// CALL db.idx.vector.query('document', 'embedding', 10, [0.1, 0.2, 0.3])
+//
+// reports the k nodes whose vector is most similar to the query vector
+// in descending cosine similarity order
+
+typedef struct {
+	Node n;
+	Graph *g;
+	SIValue *output;
+	VectorIndexMatch *matches;  // Top k matches.
+	uint match_pos;             // Next match to report.
+} VectorQueryContext;
+
+ProcedureResult Proc_VectorQueryInvoke(ProcedureCtx *ctx, const SIValue *args,
+		const char **yield) {
+	ctx->privateData = NULL;
+	if(array_len((SIValue *)args) != 4) return PROCEDURE_ERR;
+	if(!(SI_TYPE(args[0]) & SI_TYPE(args[1]) & T_STRING)) return PROCEDURE_ERR;
+
+	if(SI_TYPE(args[2]) != T_INT64 || args[2].longval < 0) {
+		ErrorCtx_SetError("db.idx.vector.query expects k to be a non-negative integer");
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	float query[VECTOR_INDEX_MAX_DIM];
+	uint dim = VectorIndex_ToVector(args[3], query);
+	if(dim == 0) {
+		ErrorCtx_SetError("db.idx.vector.query expects the query vector to be a non-empty array of at most %d numbers",
+						  VECTOR_INDEX_MAX_DIM);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	const char *label = args[0].stringval;
+	const char *attribute = args[1].stringval;
+
+	// get vector index from schema
+	VectorIndex *vi = NULL;
+	Schema *s = GraphContext_GetSchema(gc, label, SCHEMA_NODE);
+	Attribute_ID attr_id = GraphContext_GetAttributeID(gc, attribute);
+	if(s != NULL && attr_id != ATTRIBUTE_NOTFOUND) {
+		Index *idx = Schema_GetIndex(s, &attr_id, IDX_VECTOR);
+		if(idx) vi = Index_GetVectorIndex(idx, attr_id);
+	}
+	if(vi == NULL) {
+		ErrorCtx_SetError("No vector index on :%s(%s)", label, attribute);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	uint k = MIN(args[2].longval, UINT_MAX);
+
+	ctx->privateData = rm_malloc(sizeof(VectorQueryContext));
+	VectorQueryContext *pdata = ctx->privateData;
+	pdata->g = gc->g;
+	pdata->n = GE_NEW_NODE();
+	pdata->match_pos = 0;
+	pdata->matches = VectorIndex_Query(vi, query, dim, k);
+	pdata->output = array_new(SIValue, 4);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("node"));
+	pdata->output = array_append(pdata->output, SI_Node(&pdata->n));
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("score"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0.0));
+
+	return PROCEDURE_OK;
+}
+
+SIValue *Proc_VectorQueryStep(ProcedureCtx *ctx) {
+	if(!ctx->privateData) return NULL; // No index was attached to this procedure.
+
+	VectorQueryContext *pdata = (VectorQueryContext *)ctx->privateData;
+
+	// Depleted.
+	if(pdata->match_pos == array_len(pdata->matches)) return NULL;
+	VectorIndexMatch *m = pdata->matches + pdata->match_pos++;
+
+	// Get Node.
+	Node *n = &pdata->n;
+	Graph_GetNode(pdata->g, m->id, n);
+
+	pdata->output[1] = SI_Node(n);
+	pdata->output[3] = SI_DoubleVal(m->similarity);
+
+	return pdata->output;
+}
+
+ProcedureResult Proc_VectorQueryFree(ProcedureCtx *ctx) {
+	// Clean up.
+	if(!ctx->privateData) return PROCEDURE_OK;
+
+	VectorQueryContext *pdata = ctx->privateData;
+	array_free(pdata->output);
+	array_free(pdata->matches);
+	rm_free(pdata);
+
+	return PROCEDURE_OK;
+}
+
+ProcedureCtx *Proc_VectorQueryGen() {
+	void *privateData = NULL;
+	ProcedureOutput *output   = array_new(ProcedureOutput, 2);
+	ProcedureOutput out_node  = {.name = "node", .type = T_NODE};
+	ProcedureOutput out_score = {.name = "score", .type = T_DOUBLE};
+	output = array_append(output, out_node);
+	output = array_append(output, out_score);
+
+	ProcedureCtx *ctx = ProcCtxNew("db.idx.vector.query",
+								   4,
+								   output,
+								   Proc_VectorQueryStep,
+								   Proc_VectorQueryInvoke,
+								   Proc_VectorQueryFree,
+								   privateData,
+								   true);
+	return ctx;
+}
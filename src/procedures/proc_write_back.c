@@ -0,0 +1,252 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "proc_write_back.h"
+#include "procedure.h"
+#include "../RG.h"
+#include "../value.h"
+#include "../errors.h"
+#include "../util/arr.h"
+#include "../query_ctx.h"
+#include "../datatypes/map.h"
+#include "../util/rmalloc.h"
+#include "../util/simple_timer.h"
+#include "../index/index_batch.h"
+#include "../graph/graphcontext.h"
+
+// the algorithm procedure is invoked with the configuration map stripped of
+// 'writeProperty', each node it yields is updated directly, bypassing the
+// record by record SET path, and a single summary row is reported
+//
+// CALL algo.pageRank.write('Page', 'LINKS', {writeProperty: 'rank'})
+//      YIELD nodePropertiesWritten, computeMillis, writeMillis
+// CALL algo.WCC.write(NULL, 'FOLLOWS', {writeProperty: 'component'})
+//      YIELD nodePropertiesWritten
+//
+// the write lock is held for the duration of the call
+
+typedef struct {
+	const char *name;        // write procedure name
+	const char *base;        // algorithm procedure name
+	const char *value;       // algorithm output holding the written value
+	ProcedureCtx *proc;      // algorithm procedure
+	SIValue *args;           // arguments forwarded to the algorithm procedure
+	SIValue config;          // forwarded configuration map, NULL if empty
+	bool depleted;           // summary was reported
+	SIValue *output;         // array with 6 entries ["nodePropertiesWritten", n, "computeMillis", c, "writeMillis", w]
+} WriteBackContext;
+
+// locate the key 'name' within a procedure output, returns its value index
+static int _OutputIdx(const SIValue *output, const char *name) {
+	uint len = array_len((SIValue *)output);
+	for(uint i = 0; i < len; i += 2) {
+		if(strcmp(output[i].stringval, name) == 0) return i + 1;
+	}
+	return -1;
+}
+
+// write 'value' to attribute 'attr' of every node yielded by 'proc'
+// returns the number of nodes visited and sets 'changes' to the number
+// of attributes actually modified
+static int64_t _WriteBack(ProcedureCtx *proc, const char *value,
+						  Attribute_ID attr, uint64_t *changes) {
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Graph *g = gc->g;
+	IndexBatch *batch = QueryCtx_GetIndexBatch();
+	EffectsBuffer *effects = QueryCtx_GetEffects();
+
+	// determine which labels index the written attribute
+	int label_count = Graph_LabelTypeCount(g);
+	bool indexed[label_count + 1];
+	for(int i = 0; i < label_count; i++) {
+		Schema *s = GraphContext_GetSchemaByID(gc, i, SCHEMA_NODE);
+		indexed[i] = (s != NULL && Schema_GetIndex(s, &attr, IDX_ANY) != NULL);
+	}
+
+	int node_idx = -1;
+	int value_idx = -1;
+	int64_t written = 0;
+	*changes = 0;
+
+	SIValue *row;
+	while((row = Proc_Step(proc)) != NULL) {
+		if(node_idx == -1) {
+			node_idx = _OutputIdx(row, "node");
+			value_idx = _OutputIdx(row, value);
+			ASSERT(node_idx != -1 && value_idx != -1);
+		}
+
+		Node *n = row[node_idx].ptrval;
+		GraphEntity *ge = (GraphEntity *)n;
+		SIValue v = row[value_idx];
+		written++;
+
+		SIValue current = GraphEntity_GetProperty(ge, attr);
+		if(SI_TYPE(current) == T_NULL) {
+			GraphEntity_AddProperty(ge, attr, v);
+		} else if(!GraphEntity_SetProperty(ge, attr, v)) {
+			// value didn't change
+			continue;
+		}
+		(*changes)++;
+		Graph_MarkEntityModified(g, GETYPE_NODE, ENTITY_GET_ID(n));
+
+		if(effects) EffectsBuffer_AddSetProperty(effects, gc, GETYPE_NODE, ge, attr, v);
+
+		int label = Graph_GetNodeLabel(g, ENTITY_GET_ID(n));
+		if(label != GRAPH_NO_LABEL && indexed[label]) {
+			IndexBatch_AddNode(batch, label, ENTITY_GET_ID(n));
+		}
+	}
+
+	// reindex each updated node once
+	IndexBatch_Apply(batch, gc);
+	return written;
+}
+
+static ProcedureResult Proc_WriteBackInvoke(ProcedureCtx *ctx,
+		const SIValue *args, const char **yield) {
+	WriteBackContext *pdata = ctx->privateData;
+
+	// last argument is the configuration map
+	uint argc = array_len((SIValue *)args);
+	SIValue write_property;
+	SIValue key = SI_ConstStringVal("writeProperty");
+	if(argc == 0 || SI_TYPE(args[argc - 1]) != T_MAP ||
+	   !Map_Get(args[argc - 1], key, &write_property) ||
+	   SI_TYPE(write_property) != T_STRING) {
+		ErrorCtx_SetError("%s expects a configuration map specifying writeProperty",
+						  pdata->name);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	// forward the remaining configuration, if any, to the algorithm
+	pdata->args = array_new(SIValue, argc);
+	for(uint i = 0; i < argc - 1; i++) pdata->args = array_append(pdata->args, args[i]);
+	if(Map_KeyCount(args[argc - 1]) > 1) {
+		pdata->config = Map_Clone(args[argc - 1]);
+		Map_Remove(pdata->config, key);
+		pdata->args = array_append(pdata->args, pdata->config);
+	}
+
+	pdata->proc = Proc_Get(pdata->base);
+	ASSERT(pdata->proc != NULL);
+	uint proc_argc = Procedure_Argc(pdata->proc);
+	if(proc_argc != PROCEDURE_VARIABLE_ARG_COUNT &&
+	   proc_argc != array_len(pdata->args)) {
+		ErrorCtx_SetError("%s unexpected configuration", pdata->name);
+		ErrorCtx_RaiseRuntimeException(NULL);
+		return PROCEDURE_ERR;
+	}
+
+	double tic[2];
+	simple_tic(tic);
+	ProcedureResult res = Proc_Invoke(pdata->proc, pdata->args, NULL);
+	if(res != PROCEDURE_OK) return res;
+	double compute = simple_toc(tic);
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Attribute_ID attr = GraphContext_FindOrAddAttribute(gc,
+			write_property.stringval);
+
+	simple_tic(tic);
+	uint64_t changes;
+	int64_t written = _WriteBack(pdata->proc, pdata->value, attr, &changes);
+	double write = simple_toc(tic);
+
+	ResultSetStatistics *stats = QueryCtx_GetResultSetStatistics();
+	stats->properties_set += changes;
+
+	pdata->output[1] = SI_LongVal(written);
+	pdata->output[3] = SI_DoubleVal(compute * 1000);
+	pdata->output[5] = SI_DoubleVal(write * 1000);
+	return PROCEDURE_OK;
+}
+
+static SIValue *Proc_WriteBackStep(ProcedureCtx *ctx) {
+	ASSERT(ctx->privateData);
+
+	WriteBackContext *pdata = (WriteBackContext *)ctx->privateData;
+
+	// summary is reported once
+	if(pdata->depleted) return NULL;
+	pdata->depleted = true;
+	return pdata->output;
+}
+
+static ProcedureResult Proc_WriteBackFree(ProcedureCtx *ctx) {
+	// clean up
+	if(ctx->privateData) {
+		WriteBackContext *pdata = ctx->privateData;
+		if(pdata->proc) Proc_Free(pdata->proc);
+		if(pdata->args) array_free(pdata->args);
+		if(!SIValue_IsNull(pdata->config)) Map_Free(pdata->config);
+		if(pdata->output) array_free(pdata->output);
+		rm_free(ctx->privateData);
+	}
+
+	return PROCEDURE_OK;
+}
+
+static ProcedureCtx *_WriteBackCtx(const char *name, const char *base,
+								   const char *value) {
+	WriteBackContext *pdata = rm_malloc(sizeof(WriteBackContext));
+	pdata->name = name;
+	pdata->base = base;
+	pdata->value = value;
+	pdata->proc = NULL;
+	pdata->args = NULL;
+	pdata->config = SI_NullVal();
+	pdata->depleted = false;
+	pdata->output = array_new(SIValue, 6);
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("nodePropertiesWritten"));
+	pdata->output = array_append(pdata->output, SI_LongVal(0)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("computeMillis"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+	pdata->output = array_append(pdata->output, SI_ConstStringVal("writeMillis"));
+	pdata->output = array_append(pdata->output, SI_DoubleVal(0)); // Place holder.
+
+	ProcedureOutput *outputs = array_new(ProcedureOutput, 3);
+	ProcedureOutput output_written = {.name = "nodePropertiesWritten", .type = T_INT64};
+	ProcedureOutput output_compute = {.name = "computeMillis", .type = T_DOUBLE};
+	ProcedureOutput output_write = {.name = "writeMillis", .type = T_DOUBLE};
+	outputs = array_append(outputs, output_written);
+	outputs = array_append(outputs, output_compute);
+	outputs = array_append(outputs, output_write);
+
+	ProcedureCtx *ctx = ProcCtxNew(name,
+								   PROCEDURE_VARIABLE_ARG_COUNT,
+								   outputs,
+								   Proc_WriteBackStep,
+								   Proc_WriteBackInvoke,
+								   Proc_WriteBackFree,
+								   pdata,
+								   false);
+	return ctx;
+}
+
+ProcedureCtx *Proc_PagerankWriteCtx() {
+	return _WriteBackCtx("algo.pageRank.write", "algo.pageRank", "score");
+}
+
+ProcedureCtx *Proc_WCCWriteCtx() {
+	return _WriteBackCtx("algo.WCC.write", "algo.WCC", "componentId");
+}
+
+ProcedureCtx *Proc_LabelPropagationWriteCtx() {
+	return _WriteBackCtx("algo.labelPropagation.write", "algo.labelPropagation",
+						 "communityId");
+}
+
+ProcedureCtx *Proc_BetweennessWriteCtx() {
+	return _WriteBackCtx("algo.betweenness.write", "algo.betweenness",
+						 "centrality");
+}
+
+ProcedureCtx *Proc_ClosenessWriteCtx() {
+	return _WriteBackCtx("algo.closeness.write", "algo.closeness", "closeness");
+}
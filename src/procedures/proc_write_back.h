@@ -0,0 +1,19 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "proc_ctx.h"
+
+// write variants of the algorithm procedures
+// each accepts its algorithm's arguments followed by a configuration map
+// specifying 'writeProperty', the node attribute results are written to
+// results are written in a single pass, and summary statistics are yielded
+ProcedureCtx *Proc_PagerankWriteCtx();
+ProcedureCtx *Proc_WCCWriteCtx();
+ProcedureCtx *Proc_LabelPropagationWriteCtx();
+ProcedureCtx *Proc_BetweennessWriteCtx();
+ProcedureCtx *Proc_ClosenessWriteCtx();
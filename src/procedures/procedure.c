@@ -35,11 +35,39 @@ void Proc_Register() {
 	// Register graph algorithms.
 	_procRegister("algo.BFS", Proc_BFS_Ctx);
 	_procRegister("algo.pageRank", Proc_PagerankCtx);
+	_procRegister("algo.WCC", Proc_WCCCtx);
+	_procRegister("algo.labelPropagation", Proc_LabelPropagationCtx);
+	_procRegister("algo.triangleCount", Proc_TriangleCountCtx);
+	_procRegister("algo.betweenness", Proc_BetweennessCtx);
+	_procRegister("algo.closeness", Proc_ClosenessCtx);
+	_procRegister("algo.nodeSimilarity", Proc_NodeSimilarityCtx);
+	_procRegister("algo.pageRank.write", Proc_PagerankWriteCtx);
+	_procRegister("algo.WCC.write", Proc_WCCWriteCtx);
+	_procRegister("algo.labelPropagation.write", Proc_LabelPropagationWriteCtx);
+	_procRegister("algo.betweenness.write", Proc_BetweennessWriteCtx);
+	_procRegister("algo.closeness.write", Proc_ClosenessWriteCtx);
+	_procRegister("algo.project", Proc_ProjectCtx);
+	_procRegister("algo.dropProjection", Proc_DropProjectionCtx);
+	_procRegister("algo.SPpaths", Proc_SPPathsCtx);
+	_procRegister("algo.randomWalk", Proc_RandomWalkCtx);
+	_procRegister("algo.sampleNeighbors", Proc_SampleNeighborsCtx);
 
 	// Register FullText Search generator.
 	_procRegister("db.idx.fulltext.drop", Proc_FulltextDropIdxGen);
 	_procRegister("db.idx.fulltext.queryNodes", Proc_FulltextQueryNodeGen);
+	_procRegister("db.idx.fulltext.status", Proc_FulltextStatusGen);
 	_procRegister("db.idx.fulltext.createNodeIndex", Proc_FulltextCreateNodeIdxGen);
+	_procRegister("db.idx.vector.drop", Proc_VectorDropIdxGen);
+	_procRegister("db.idx.vector.query", Proc_VectorQueryGen);
+	_procRegister("db.idx.vector.createNodeIndex", Proc_VectorCreateNodeIdxGen);
+
+	// Relationship indices.
+	_procRegister("db.idx.edge.createIndex", Proc_EdgeCreateIdxGen);
+	_procRegister("db.idx.edge.drop", Proc_EdgeDropIdxGen);
+
+	// Relationship weight matrices.
+	_procRegister("db.idx.weight.create", Proc_WeightCreateGen);
+	_procRegister("db.idx.weight.drop", Proc_WeightDropGen);
 }
 
 ProcedureCtx *ProcCtxNew(const char *name,
@@ -55,11 +83,13 @@ ProcedureCtx *ProcCtxNew(const char *name,
 	ctx->argc = argc;
 	ctx->name = name;
 	ctx->Step = fStep;
+	ctx->StepBatch = NULL;
 	ctx->Free = fFree;
 	ctx->output = output;
 	ctx->Invoke = fInvoke;
 	ctx->privateData = privateData;
 	ctx->readOnly = readOnly;
+	ctx->limit_hint = UINT_MAX;
 	return ctx;
 }
 
@@ -109,6 +139,31 @@ SIValue *Proc_Step(ProcedureCtx *proc) {
 	return val;
 }
 
+const ProcedureBatch *Proc_StepBatch(ProcedureCtx *proc) {
+	ASSERT(proc != NULL);
+	ASSERT(proc->StepBatch != NULL);
+	// Validate procedure state, can only consumed if state is initialized.
+	if(proc->state != PROCEDURE_INIT) return NULL;
+
+	const ProcedureBatch *batch = proc->StepBatch(proc);
+	// Set procedure state to depleted once all rows were produced.
+	if(batch == NULL || batch->count == 0) {
+		proc->state = PROCEDURE_DEPLETED;
+		return NULL;
+	}
+	return batch;
+}
+
+bool Procedure_SupportsBatch(const ProcedureCtx *proc) {
+	ASSERT(proc != NULL);
+	return proc->StepBatch != NULL;
+}
+
+void Procedure_SetLimitHint(ProcedureCtx *proc, uint limit_hint) {
+	ASSERT(proc != NULL);
+	proc->limit_hint = limit_hint;
+}
+
 uint Procedure_Argc(const ProcedureCtx *proc) {
 	ASSERT(proc != NULL);
 	return proc->argc;
@@ -26,6 +26,19 @@ ProcedureResult Proc_Invoke(ProcedureCtx *proc, const SIValue *args, const char
  * Returns array of key value pairs. */
 SIValue *Proc_Step(ProcedureCtx *proc);
 
+/* Produces the procedure's next block of rows,
+ * NULL is returned once the procedure is depleted.
+ * Requires Procedure_SupportsBatch. */
+const ProcedureBatch *Proc_StepBatch(ProcedureCtx *proc);
+
+/* Returns true if the procedure produces blocks of rows. */
+bool Procedure_SupportsBatch(const ProcedureCtx *proc);
+
+/* Sets the number of rows expected to be required from the procedure's next
+ * invocation, batched procedures size their first block of rows accordingly.
+ * this is a hint, rows are produced for as long as they're consumed. */
+void Procedure_SetLimitHint(ProcedureCtx *proc, uint limit_hint);
+
 /* Resets procedure, restore procedure state to invoked. */
 ProcedureResult ProcedureReset(ProcedureCtx *proc);
 
@@ -9,11 +9,28 @@
 #include "proc_bfs.h"
 #include "proc_labels.h"
 #include "proc_pagerank.h"
+#include "proc_wcc.h"
+#include "proc_label_propagation.h"
+#include "proc_triangle_count.h"
+#include "proc_betweenness.h"
+#include "proc_closeness.h"
+#include "proc_node_similarity.h"
+#include "proc_write_back.h"
+#include "proc_projection.h"
+#include "proc_sp_paths.h"
+#include "proc_random_walk.h"
 #include "proc_relations.h"
 #include "proc_procedures.h"
 #include "proc_list_indexes.h"
 #include "proc_property_keys.h"
 #include "proc_fulltext_query.h"
+#include "proc_fulltext_status.h"
 #include "proc_fulltext_drop_index.h"
 #include "proc_fulltext_create_index.h"
+#include "proc_vector_query.h"
+#include "proc_vector_drop_index.h"
+#include "proc_vector_create_index.h"
+#include "proc_edge_create_index.h"
+#include "proc_edge_drop_index.h"
+#include "proc_edge_weights.h"
 
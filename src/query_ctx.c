@@ -7,8 +7,12 @@
 #include "query_ctx.h"
 #include "RG.h"
 #include "errors.h"
+#include "util/rmalloc.h"
 #include "util/simple_timer.h"
+#include "config.h"
+#include "util/thpool/pools.h"
 #include "arithmetic/arithmetic_expression.h"
+#include "execution_plan/execution_plan.h"
 #include "serializers/graphcontext_type.h"
 
 // GraphContext type as it is registered at Redis.
@@ -50,6 +54,18 @@ inline void QueryCtx_RemoveFromTLS() {
 void QueryCtx_BeginTimer(void) {
 	QueryCtx *ctx = _QueryCtx_GetCtx(); // Attempt to retrieve the QueryCtx.
 	simple_tic(ctx->internal_exec_ctx.timer); // Start the execution timer.
+	memset(ctx->internal_exec_ctx.phases, 0, sizeof(ctx->internal_exec_ctx.phases));
+	Alloc_ResetConsumption(); // Account for memory allocated from now on.
+}
+
+void QueryCtx_SuspendAccounting(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	ctx->internal_exec_ctx.mem = Alloc_SaveConsumption();
+}
+
+void QueryCtx_ResumeAccounting(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	Alloc_RestoreConsumption(ctx->internal_exec_ctx.mem);
 }
 
 void QueryCtx_SetGlobalExecutionCtx(CommandCtx *cmd_ctx) {
@@ -59,6 +75,11 @@ void QueryCtx_SetGlobalExecutionCtx(CommandCtx *cmd_ctx) {
 	ctx->global_exec_ctx.bc = CommandCtx_GetBlockingClient(cmd_ctx);
 	ctx->global_exec_ctx.redis_ctx = CommandCtx_GetRedisCtx(cmd_ctx);
 	ctx->global_exec_ctx.command_name = CommandCtx_GetCommandName(cmd_ctx);
+	// decided once per query, such that its changes are replicated one way
+	Config_Option_get(Config_REPLICATE_EFFECTS, &ctx->internal_exec_ctx.replicate_effects);
+	// each sampled query draws blocks of its own
+	ctx->internal_exec_ctx.sample_rate = cmd_ctx->sample_rate;
+	ctx->internal_exec_ctx.sample_seed = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
 }
 
 void QueryCtx_SetAST(AST *ast) {
@@ -81,6 +102,11 @@ void QueryCtx_SetLastWriter(OpBase *last_writer) {
 	ctx->internal_exec_ctx.last_writer = last_writer;
 }
 
+void QueryCtx_SetTimedPlan(ExecutionPlan *plan) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	ctx->internal_exec_ctx.timed_plan = plan;
+}
+
 AST *QueryCtx_GetAST(void) {
 	QueryCtx *ctx = _QueryCtx_GetCtx();
 	return ctx->query_data.ast;
@@ -118,6 +144,45 @@ ResultSetStatistics *QueryCtx_GetResultSetStatistics(void) {
 	return &ctx->internal_exec_ctx.result_set->stats;
 }
 
+double QueryCtx_GetSampleRate(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	double rate = ctx->internal_exec_ctx.sample_rate;
+	return (rate > 0 && rate < 1) ? rate : 1;
+}
+
+uint64_t QueryCtx_GetSampleSeed(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	return ctx->internal_exec_ctx.sample_seed;
+}
+
+Arena *QueryCtx_GetArena(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	if(!ctx->internal_exec_ctx.arena) {
+		ctx->internal_exec_ctx.arena = Arena_New(ARENA_BLOCK_SIZE);
+	}
+	return ctx->internal_exec_ctx.arena;
+}
+
+void QueryCtx_ResetArena(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	if(ctx->internal_exec_ctx.arena) Arena_Reset(ctx->internal_exec_ctx.arena);
+}
+
+IndexBatch *QueryCtx_GetIndexBatch(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	return &ctx->internal_exec_ctx.index_batch;
+}
+
+EffectsBuffer *QueryCtx_GetEffects(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	// effects are recorded for replication and for maintaining views
+	if(!ctx->internal_exec_ctx.replicate_effects &&
+	   (ctx->gc == NULL || !GraphContext_HasViews(ctx->gc))) {
+		return NULL;
+	}
+	return &ctx->internal_exec_ctx.effects;
+}
+
 void QueryCtx_PrintQuery(void) {
 	QueryCtx *ctx = _QueryCtx_GetCtx();
 	printf("%s\n", ctx->query_data.query);
@@ -131,41 +196,129 @@ static void _QueryCtx_ThreadSafeContextUnlock(QueryCtx *ctx) {
 	if(ctx->global_exec_ctx.bc) RedisModule_ThreadSafeContextUnlock(ctx->global_exec_ctx.redis_ctx);
 }
 
-bool QueryCtx_LockForCommit(void) {
-	QueryCtx *ctx = _QueryCtx_GetCtx();
-	if(ctx->internal_exec_ctx.locked_for_commit) return true;
-	// Lock GIL.
-	RedisModuleCtx *redis_ctx = ctx->global_exec_ctx.redis_ctx;
-	GraphContext *gc = ctx->gc;
+/* Folds pending changes into the graph's matrices, accounting for the time it took. */
+static void _QueryCtx_FlushAllPending(QueryCtx *ctx, Graph *g) {
+	double timer[2];
+	simple_tic(timer);
+	Graph_FlushAllPending(g);
+	ctx->internal_exec_ctx.phases[QUERY_PHASE_SYNC] += simple_toc(timer) * 1000;
+}
+
+/* Opens the graph key for writing and verifies it still holds gc.
+ * Expects the GIL to be held, returns NULL on failure, setting an error if report is set. */
+static RedisModuleKey *_QueryCtx_OpenGraphKey(RedisModuleCtx *redis_ctx, GraphContext *gc,
+											  bool report) {
+	const char *err = NULL;
 	RedisModuleString *graphID = RedisModule_CreateString(redis_ctx, gc->graph_name,
 														  strlen(gc->graph_name));
-	_QueryCtx_ThreadSafeContextLock(ctx);
-	// Open key and verify.
 	RedisModuleKey *key = RedisModule_OpenKey(redis_ctx, graphID, REDISMODULE_WRITE);
 	RedisModule_FreeString(redis_ctx, graphID);
 	if(RedisModule_KeyType(key) == REDISMODULE_KEYTYPE_EMPTY) {
-		ErrorCtx_SetError("Encountered an empty key when opened key %s", ctx->gc->graph_name);
+		err = "Encountered an empty key when opened key";
 		goto clean_up;
 	}
 	if(RedisModule_ModuleTypeGetType(key) != GraphContextRedisModuleType) {
-		ErrorCtx_SetError("Encountered a non-graph value type when opened key %s", ctx->gc->graph_name);
+		err = "Encountered a non-graph value type when opened key";
 		goto clean_up;
 
 	}
 	if(gc != RedisModule_ModuleTypeGetValue(key)) {
-		ErrorCtx_SetError("Encountered different graph value when opened key %s", ctx->gc->graph_name);
+		err = "Encountered different graph value when opened key";
 		goto clean_up;
 	}
-	ctx->internal_exec_ctx.key = key;
-	// Acquire graph write lock.
+	return key;
+
+clean_up:
+	if(report) ErrorCtx_SetError("%s %s", err, gc->graph_name);
+	// Free key handle.
+	RedisModule_CloseKey(key);
+	return NULL;
+}
+
+void QueryCtx_BeginSnapshot(uint64_t epoch) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	ctx->internal_exec_ctx.snapshot = true;
+	ctx->internal_exec_ctx.snapshot_epoch = epoch;
+	ctx->internal_exec_ctx.snapshot_conflict = false;
+}
+
+bool QueryCtx_InSnapshot(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	return ctx->internal_exec_ctx.snapshot;
+}
+
+bool QueryCtx_SnapshotConflicted(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	return ctx->internal_exec_ctx.snapshot_conflict;
+}
+
+/* Trades the snapshot's read lock for the graph's writer access.
+ * A read lock can't be upgraded, entering as the writer before releasing it,
+ * when the writer access is available, keeps other writers from committing
+ * in between. */
+static void _QueryCtx_EndSnapshot(QueryCtx *ctx) {
+	Graph *g = ctx->gc->g;
+	double timer[2];
+	simple_tic(timer);
+
+	bool entered = Graph_TryWriterEnter(g);
+	Graph_ReleaseLock(g);
+	if(!entered) Graph_WriterEnter(g);
+
+	ctx->internal_exec_ctx.phases[QUERY_PHASE_LOCK] += simple_toc(timer) * 1000;
+	ctx->internal_exec_ctx.snapshot = false;
+}
+
+bool QueryCtx_LockForCommit(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	if(ctx->internal_exec_ctx.locked_for_commit) return true;
+	GraphContext *gc = ctx->gc;
+
+	// a timed out query is aborted before it modifies the graph,
+	// its pending changes are discarded along with its operations
+	ExecutionPlan *timed_plan = ctx->internal_exec_ctx.timed_plan;
+	if(timed_plan != NULL && !ExecutionPlan_DisarmTimeout(timed_plan)) {
+		ErrorCtx_RaiseRuntimeException("Query timed out");
+		return false;
+	}
+
+	// The snapshot's changes are validated once the write lock is acquired.
+	bool validate = ctx->internal_exec_ctx.snapshot;
+	if(validate) _QueryCtx_EndSnapshot(ctx);
+
+	// Lock GIL, only to verify the key still holds the graph,
+	// opening it for writing marks it as modified.
+	double timer[2];
+	double *phases = ctx->internal_exec_ctx.phases;
+	simple_tic(timer);
+	RedisModuleCtx *redis_ctx = ctx->global_exec_ctx.redis_ctx;
+	_QueryCtx_ThreadSafeContextLock(ctx);
+	phases[QUERY_PHASE_GIL] += simple_toc(timer) * 1000;
+	RedisModuleKey *key = _QueryCtx_OpenGraphKey(redis_ctx, gc, true);
+	if(key == NULL) goto clean_up;
+	RedisModule_CloseKey(key);
+	_QueryCtx_ThreadSafeContextUnlock(ctx);
+
+	// The graph is modified under its own write lock alone,
+	// the GIL is locked anew once the changes are replicated.
+	simple_tic(timer);
 	Graph_AcquireWriteLock(gc->g);
+	phases[QUERY_PHASE_LOCK] += simple_toc(timer) * 1000;
+
+	// Acquiring the write lock advances the epoch, any further advance
+	// is a commit made since the snapshot was read.
+	if(validate && Graph_WriteEpoch(gc->g) != ctx->internal_exec_ctx.snapshot_epoch + 1) {
+		Graph_ReleaseLock(gc->g);
+		ctx->internal_exec_ctx.snapshot_conflict = true;
+		ErrorCtx_RaiseRuntimeException("Graph was modified while the query was read");
+		return false;
+	}
+
 	ctx->internal_exec_ctx.locked_for_commit = true;
 
 	return true;
 
 clean_up:
-	// Free key handle.
-	RedisModule_CloseKey(key);
 	// Unlock GIL.
 	_QueryCtx_ThreadSafeContextUnlock(ctx);
 	// If there is a break point for runtime exception, raise it, otherwise return false.
@@ -174,25 +327,137 @@ clean_up:
 
 }
 
+// replicates the query's pending effects, returns false if the query's changes
+// are to be replicated by its text, index changes aren't recorded as effects
+static bool _QueryCtx_ReplicateEffects(QueryCtx *ctx) {
+	if(!ctx->internal_exec_ctx.replicate_effects) return false;
+
+	ResultSetStatistics *stats = &ctx->internal_exec_ctx.result_set->stats;
+	if(stats->indices_created > 0 || stats->indices_deleted > 0) return false;
+
+	EffectsBuffer *effects = &ctx->internal_exec_ctx.effects;
+	if(effects->count == 0) return ctx->internal_exec_ctx.effects_replicated;
+
+	RedisModule_Replicate(ctx->global_exec_ctx.redis_ctx, "GRAPH.EFFECT", "cb!",
+						  ctx->gc->graph_name, effects->data, effects->len);
+	EffectsBuffer_Reset(effects);
+	ctx->internal_exec_ctx.effects_replicated = true;
+	return true;
+}
+
+// replicates the query's changes, either by their effects or by the query's text
+static void _QueryCtx_Replicate(QueryCtx *ctx) {
+	if(!_QueryCtx_ReplicateEffects(ctx)) {
+		RedisModule_Replicate(ctx->global_exec_ctx.redis_ctx, ctx->global_exec_ctx.command_name,
+							  "cc!", ctx->gc->graph_name, ctx->query_data.query);
+	}
+}
+
+/* Locks the GIL once the graph's write lock is released, verifying the key
+ * still holds the graph and replicating the changes committed so far.
+ * Writers replicate in the order they commit, as they enter the graph one at a time.
+ * 'final' marks the query's last commit, replicated by the query's text unless
+ * its effects are, a key deleted or replaced in the meantime took the changes
+ * along and the query completes, otherwise an error is set.
+ * Returns false if the key no longer holds the graph, nothing is replicated. */
+static bool _QueryCtx_PublishCommit(QueryCtx *ctx, bool final) {
+	double timer[2];
+	simple_tic(timer);
+	_QueryCtx_ThreadSafeContextLock(ctx);
+	ctx->internal_exec_ctx.phases[QUERY_PHASE_GIL] += simple_toc(timer) * 1000;
+
+	RedisModuleKey *key = _QueryCtx_OpenGraphKey(ctx->global_exec_ctx.redis_ctx, ctx->gc,
+												 !final);
+	if(key != NULL) {
+		if(ResultSetStat_IndicateModification(ctx->internal_exec_ctx.result_set->stats)) {
+			if(final) _QueryCtx_Replicate(ctx);
+			else _QueryCtx_ReplicateEffects(ctx);
+		}
+		// Closing a key opened for writing signals its watchers.
+		RedisModule_CloseKey(key);
+	}
+
+	_QueryCtx_ThreadSafeContextUnlock(ctx);
+	return key != NULL;
+}
+
+// folds the query's pending effects into the graph's views
+// effects which aren't replicated are discarded once applied
+static void _QueryCtx_UpdateViews(QueryCtx *ctx) {
+	GraphContext *gc = ctx->gc;
+	EffectsBuffer *effects = &ctx->internal_exec_ctx.effects;
+	if(!GraphContext_HasViews(gc)) return;
+
+	GraphContext_UpdateViews(gc, effects->data, effects->len);
+	if(!ctx->internal_exec_ctx.replicate_effects) EffectsBuffer_Reset(effects);
+}
+
+// refreshes the graph's entity counts, a commit group refreshes them
+// once all of its writers committed
+static void _QueryCtx_RefreshStatistics(GraphContext *gc) {
+	if(gc->write_group.active) gc->write_group.modified = true;
+	else GraphContext_RefreshStatistics(gc);
+}
+
 static void _QueryCtx_UnlockCommit(QueryCtx *ctx) {
 	GraphContext *gc = ctx->gc;
-	RedisModuleCtx *redis_ctx = ctx->global_exec_ctx.redis_ctx;
+	bool modified = ResultSetStat_IndicateModification(ctx->internal_exec_ctx.result_set->stats);
 
-	if(ResultSetStat_IndicateModification(ctx->internal_exec_ctx.result_set->stats)) {
-		// Replicate only in case of changes.
-		RedisModule_Replicate(redis_ctx, ctx->global_exec_ctx.command_name, "cc!", gc->graph_name,
-							  ctx->query_data.query);
+	// Apply index updates left pending by an interrupted writer.
+	IndexBatch_Apply(&ctx->internal_exec_ctx.index_batch, gc);
+
+	// Views follow every commit, keeping up with the graph's write epoch.
+	_QueryCtx_UpdateViews(ctx);
+
+	if(modified) {
+		// Columnar attribute copies are out of date.
+		GraphContext_DropColumns(gc);
+		// Cached replies are out of date.
+		ResultCache_Clear(gc->result_cache);
 	}
 
 	ctx->internal_exec_ctx.locked_for_commit = false;
+
+	// Compact matrices modified by this query before readers gain access.
+	_QueryCtx_FlushAllPending(ctx, gc->g);
+	// Entity counts guide traversal ordering.
+	if(modified) _QueryCtx_RefreshStatistics(gc);
 	// Release graph R/W lock.
 	Graph_ReleaseLock(gc->g);
 
-	// Close Key.
-	RedisModule_CloseKey(ctx->internal_exec_ctx.key);
+	// Replicate only in case of changes.
+	_QueryCtx_PublishCommit(ctx, true);
+}
 
-	// Unlock GIL.
-	_QueryCtx_ThreadSafeContextUnlock(ctx);
+bool QueryCtx_YieldCommit(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	ASSERT(ctx->internal_exec_ctx.locked_for_commit);
+	GraphContext *gc = ctx->gc;
+
+	// Readers must observe a compacted, consistent graph.
+	IndexBatch_Apply(&ctx->internal_exec_ctx.index_batch, gc);
+	_QueryCtx_UpdateViews(ctx);
+	if(ResultSetStat_IndicateModification(ctx->internal_exec_ctx.result_set->stats)) {
+		GraphContext_DropColumns(gc);
+		ResultCache_Clear(gc->result_cache);
+		_QueryCtx_FlushAllPending(ctx, gc->g);
+		_QueryCtx_RefreshStatistics(gc);
+	}
+	Graph_ReleaseLock(gc->g);
+
+	// Effects are replicated in the order they're exposed to readers,
+	// the key might have been modified meanwhile.
+	if(!_QueryCtx_PublishCommit(ctx, false)) {
+		ctx->internal_exec_ctx.locked_for_commit = false;
+		return false;
+	}
+
+	double timer[2];
+	simple_tic(timer);
+	Graph_AcquireWriteLock(gc->g);
+	ctx->internal_exec_ctx.phases[QUERY_PHASE_LOCK] += simple_toc(timer) * 1000;
+
+	return true;
 }
 
 void QueryCtx_UnlockCommit(OpBase *writer_op) {
@@ -221,11 +486,105 @@ void QueryCtx_ForceUnlockCommit() {
 	_QueryCtx_UnlockCommit(ctx);
 }
 
+void QueryCtx_BeginCommitGroup(GraphContext *gc) {
+	ASSERT(gc != NULL && !gc->write_group.active);
+
+	// Grouped writers execute back to back, each committing on its own.
+	Graph_WriterEnter(gc->g);
+	gc->write_group.modified = false;
+	gc->write_group.active = true;
+}
+
+void QueryCtx_EndCommitGroup(GraphContext *gc) {
+	ASSERT(gc != NULL && gc->write_group.active);
+
+	gc->write_group.active = false;
+
+	// Entity counts guide traversal ordering.
+	if(gc->write_group.modified) {
+		Graph_AcquireReadLock(gc->g);
+		GraphContext_RefreshStatistics(gc);
+		Graph_ReleaseLock(gc->g);
+	}
+
+	Graph_WriterLeave(gc->g);
+}
+
 double QueryCtx_GetExecutionTime(void) {
 	QueryCtx *ctx = _QueryCtx_GetCtx();
 	return simple_toc(ctx->internal_exec_ctx.timer) * 1000;
 }
 
+void QueryCtx_AddPhaseTime(QueryPhase phase, double ms) {
+	ASSERT(phase < QUERY_PHASE_COUNT);
+	// don't create a context for threads which aren't executing a query
+	QueryCtx *ctx = pthread_getspecific(_tlsQueryCtxKey);
+	if(ctx) ctx->internal_exec_ctx.phases[phase] += ms;
+}
+
+double QueryCtx_GetPhaseTime(QueryPhase phase) {
+	ASSERT(phase < QUERY_PHASE_COUNT);
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	return ctx->internal_exec_ctx.phases[phase];
+}
+
+const double *QueryCtx_GetPhaseTimes(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	return ctx->internal_exec_ctx.phases;
+}
+
+int QueryCtx_PhasesToString(char *buf, size_t len) {
+	ASSERT(buf != NULL && len > 0);
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	double *phases = ctx->internal_exec_ctx.phases;
+
+	int n = 0;
+	buf[0] = '\0';
+	// the reply is still being serialized
+	for(int i = 0; i < QUERY_PHASE_REPLY && (size_t)n < len; i++) {
+		n += snprintf(buf + n, len - n, "%s%s: %.6f ms", (i > 0) ? ", " : "",
+					  QueryPhase_Name(i), phases[i]);
+	}
+
+	return ((size_t)n < len) ? n : (int)len - 1;
+}
+
+// sum of the phases which might be nested within the execution phase
+static inline double _QueryCtx_NestedPhases(const double *phases) {
+	return phases[QUERY_PHASE_LOCK] + phases[QUERY_PHASE_SYNC] +
+		   phases[QUERY_PHASE_GIL];
+}
+
+void QueryCtx_BeginExecution(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	QueryCtx_ExecutionMark *mark = &ctx->internal_exec_ctx.execution_mark;
+	simple_tic(mark->timer);
+	mark->nested = _QueryCtx_NestedPhases(ctx->internal_exec_ctx.phases);
+	mark->sync = Graph_SyncTime();
+	ThreadPools_AcquireOpenMPThreads();
+}
+
+void QueryCtx_EndExecution(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	QueryCtx_ExecutionMark *mark = &ctx->internal_exec_ctx.execution_mark;
+	double *phases = ctx->internal_exec_ctx.phases;
+
+	ThreadPools_ReleaseOpenMPThreads();
+
+	// matrices synchronized by this thread since execution began
+	phases[QUERY_PHASE_SYNC] += Graph_SyncTime() - mark->sync;
+
+	double elapsed = simple_toc(mark->timer) * 1000;
+	double nested = _QueryCtx_NestedPhases(phases) - mark->nested;
+	phases[QUERY_PHASE_EXECUTION] += (elapsed > nested) ? elapsed - nested : 0;
+}
+
+double QueryCtx_GetLockWait(void) {
+	QueryCtx *ctx = _QueryCtx_GetCtx();
+	double *phases = ctx->internal_exec_ctx.phases;
+	return phases[QUERY_PHASE_LOCK] + phases[QUERY_PHASE_GIL];
+}
+
 void QueryCtx_Free(void) {
 	QueryCtx *ctx = _QueryCtx_GetCtx();
 
@@ -234,6 +593,11 @@ void QueryCtx_Free(void) {
 		ctx->query_data.params = NULL;
 	}
 
+	// release the query's transient allocations in one shot
+	Arena_Free(ctx->internal_exec_ctx.arena);
+	IndexBatch_Free(&ctx->internal_exec_ctx.index_batch);
+	EffectsBuffer_Free(&ctx->internal_exec_ctx.effects);
+
 	rm_free(ctx);
 	// NULL-set the context for reuse the next time this thread receives a query
 	QueryCtx_RemoveFromTLS();
@@ -9,10 +9,14 @@
 #include "ast/ast.h"
 #include "redismodule.h"
 #include "util/rmalloc.h"
+#include "util/arena/arena.h"
 #include "graph/graphcontext.h"
+#include "index/index_batch.h"
+#include "effects/effects.h"
 #include "commands/cmd_context.h"
 #include "resultset/resultset.h"
 #include "execution_plan/ops/op.h"
+#include "slow_log/query_phases.h"
 #include <pthread.h>
 
 extern pthread_key_t _tlsQueryCtxKey;  // Thread local storage query context key.
@@ -23,12 +27,32 @@ typedef struct {
 	const char *query;    // Query string.
 } QueryCtx_QueryData;
 
+/* Marks the beginning of an execution phase, see QueryCtx_BeginExecution. */
+typedef struct {
+	double timer[2];            // Execution start time.
+	double nested;              // Nested phases time at execution start.
+	double sync;                // Thread's matrix synchronization time at execution start.
+} QueryCtx_ExecutionMark;
+
 typedef struct {
 	double timer[2];            // Query execution time tracking.
-	RedisModuleKey *key;        // Saves an open key value, for later extraction and closing.
+	double phases[QUERY_PHASE_COUNT]; // Time spent in each phase, in milliseconds.
+	QueryCtx_ExecutionMark execution_mark; // Beginning of the current execution phase.
 	ResultSet *result_set;      // Save the execution result set.
 	bool locked_for_commit;     // Indicates if a call for QueryCtx_LockForCommit issued before.
 	OpBase *last_writer;        // The last writer operation which indicates the need for commit.
+	struct ExecutionPlan *timed_plan; // Plan whose timeout is disarmed on commit, NULL if untimed.
+	Arena *arena;               // Transient allocations, released at once.
+	IndexBatch index_batch;     // Node index updates, applied by the end of each commit.
+	bool replicate_effects;     // Changes are replicated as effects rather than as the query.
+	EffectsBuffer effects;      // Effects yet to be replicated.
+	bool effects_replicated;    // Effects were replicated ahead of the commit's end.
+	bool snapshot;              // Write query reading the graph under its read lock, see QueryCtx_BeginSnapshot.
+	uint64_t snapshot_epoch;    // Graph write epoch observed by the snapshot.
+	bool snapshot_conflict;     // The graph was modified between the snapshot and the commit.
+	double sample_rate;         // Fraction of the graph scanned by the query, see ops/shared/scan_sample.h.
+	uint64_t sample_seed;       // Seed drawing the query's sampled blocks.
+	AllocConsumption mem;       // Memory counters, saved as the query migrates between threads.
 } QueryCtx_InternalExecCtx;
 
 typedef struct {
@@ -59,6 +83,13 @@ void QueryCtx_RemoveFromTLS();
 /* Start timing query execution. */
 void QueryCtx_BeginTimer(void);
 
+/* Saves the calling thread's memory counters to the query,
+ * ahead of the query's migration to another thread. */
+void QueryCtx_SuspendAccounting(void);
+
+/* Restores the query's memory counters on the thread it migrated to. */
+void QueryCtx_ResumeAccounting(void);
+
 /* Setters */
 /* Sets the global execution context */
 void QueryCtx_SetGlobalExecutionCtx(CommandCtx *cmd_ctx);
@@ -70,6 +101,8 @@ void QueryCtx_SetGraphCtx(GraphContext *gc);
 void QueryCtx_SetResultSet(ResultSet *result_set);
 /* Set the last writer which needs to commit */
 void QueryCtx_SetLastWriter(OpBase *op);
+/* Set the timed plan, which times out up until the query commits. */
+void QueryCtx_SetTimedPlan(struct ExecutionPlan *plan);
 
 /* Getters */
 /* Retrieve the AST. */
@@ -86,20 +119,63 @@ RedisModuleCtx *QueryCtx_GetRedisModuleCtx(void);
 ResultSet *QueryCtx_GetResultSet(void);
 /* Retrive the resultset statistics. */
 ResultSetStatistics *QueryCtx_GetResultSetStatistics(void);
+/* Retrieve the fraction of the graph the query scans, 1 unless sampled. */
+double QueryCtx_GetSampleRate(void);
+/* Retrieve the seed drawing the query's sampled blocks. */
+uint64_t QueryCtx_GetSampleSeed(void);
+/* Retrieve the query's arena, allocations from which live until
+ * the query ends or the arena is reset. */
+Arena *QueryCtx_GetArena(void);
+
+/* Release all of the query's arena allocations. */
+void QueryCtx_ResetArena(void);
+
+/* Retrieve the query's pending node index updates.
+ * Writers apply the batch once they have modified the graph, updates left
+ * pending, for example by a runtime error, are applied as the commit ends. */
+IndexBatch *QueryCtx_GetIndexBatch(void);
+
+/* Retrieve the buffer the query's changes are recorded in,
+ * NULL if the query is replicated by its text. */
+EffectsBuffer *QueryCtx_GetEffects(void);
 
 /* Print the current query. */
 void QueryCtx_PrintQuery(void);
 
+/* Marks the beginning of a write query's read phase, executed under the graph's
+ * read lock rather than as the graph's single writer. 'epoch' is the graph's
+ * write epoch once the read lock was acquired.
+ * The first call to QueryCtx_LockForCommit ends the snapshot: the read lock is
+ * released and the query enters the graph as its writer, if another writer
+ * committed in between, the query's pending changes were computed against a
+ * stale graph and the commit is aborted, see QueryCtx_SnapshotConflicted. */
+void QueryCtx_BeginSnapshot(uint64_t epoch);
+
+/* Returns true if the query is within its read phase, holding the read lock. */
+bool QueryCtx_InSnapshot(void);
+
+/* Returns true if the query's commit was aborted as the graph was modified
+ * since its read phase, in which case none of its changes were committed and
+ * the query still holds the graph's writer access, such that it can be executed
+ * anew without any other writer interleaving. */
+bool QueryCtx_SnapshotConflicted(void);
+
 /* Starts a locking flow before commiting changes in the graph and Redis keyspace.
+ * A query whose timeout had expired is aborted before locking, with none of its
+ * changes committed, otherwise its timeout is disarmed.
  * Locking flow is:
  * 1. LOCK GIL
- * 2. Key open with `write` flag
- * 3. Graph R/W lock with write flag
+ * 2. Key open with `write` flag, verifying it still holds the graph
+ * 3. UNLOCK GIL
+ * 4. Graph R/W lock with write flag
+ * The graph is modified holding its write lock alone, keeping a long commit
+ * from blocking the rest of the server.
  * Since 2PL protocal is implemented, the method returns true if the it managed to achieve
  * locks in this call or a previous call. In case that the locks are already locked, there will
  * be no attempt to lock them again.
  * This method returns false if the key has changed from the current graph,
- * and sets the relevant error message. */
+ * and sets the relevant error message.
+ * Within a snapshot, the read lock is traded for the graph's writer access first. */
 bool QueryCtx_LockForCommit(void);
 
 /* Starts an ulocking flow and notifies Redis after commiting changes in the graph and Redis keyspace.
@@ -107,12 +183,24 @@ bool QueryCtx_LockForCommit(void);
  * The method get an OpBase and compares it to the last writer, if they are equal then the commit
  * and unlock flow will start.
  * Unlocking flow is:
- * 1. Replicate.
- * 2. Unlock graph R/W lock
- * 3. Close key
- * 4. Unlock GIL */
+ * 1. Unlock graph R/W lock
+ * 2. LOCK GIL
+ * 3. Key open with `write` flag, replicating only if it still holds the graph
+ * 4. Close key, signaling the key's watchers
+ * 5. Unlock GIL
+ * The GIL is never locked while holding the graph's write lock, as the main
+ * thread read locks graphs holding the GIL ahead of persisting them. */
 void QueryCtx_UnlockCommit(OpBase *writer_op);
 
+/* Commits the changes made so far and briefly releases the locks acquired by
+ * QueryCtx_LockForCommit, granting readers access to the graph midway through
+ * a long write. Changes are replicated once, by QueryCtx_UnlockCommit.
+ * Within a commit group this is a no-op, as the group holds the locks.
+ * This method returns false if the key has changed from the current graph
+ * while unlocked, in which case no lock is held and the relevant
+ * error message is set. */
+bool QueryCtx_YieldCommit(void);
+
 /*
  * -------------------------FOR SAFETY ONLY---------------------------
  *
@@ -120,9 +208,47 @@ void QueryCtx_UnlockCommit(OpBase *writer_op);
  * some reason the last writer op has not invoked QueryCtx_UnlockCommit and Redis is locked.*/
 void QueryCtx_ForceUnlockCommit(void);
 
+/* Begins a commit group on the graph, for writers executed back to back by
+ * the calling thread. The group enters the graph as its single writer once.
+ * Each writer still acquires the GIL and the graph's write lock only around
+ * its own commit and replication, such that readers and other commands
+ * progress between commits. Until QueryCtx_EndCommitGroup is called,
+ * entity counts aren't refreshed by the group's writers. */
+void QueryCtx_BeginCommitGroup(GraphContext *gc);
+
+/* Ends a commit group: refreshes entity counts and leaves the graph. */
+void QueryCtx_EndCommitGroup(GraphContext *gc);
+
 /* Compute and return elapsed query execution time. */
 double QueryCtx_GetExecutionTime(void);
 
+/* Accounts for 'ms' milliseconds spent in 'phase'.
+ * NOP if the calling thread isn't executing a query. */
+void QueryCtx_AddPhaseTime(QueryPhase phase, double ms);
+
+/* Return the time the query spent in 'phase', in milliseconds. */
+double QueryCtx_GetPhaseTime(QueryPhase phase);
+
+/* Return the time the query spent in each phase, in milliseconds. */
+const double *QueryCtx_GetPhaseTimes(void);
+
+/* Writes "phase: time ms" pairs of the phases preceding the reply to 'buf'.
+ * Returns the number of bytes written, excluding the terminating NULL. */
+int QueryCtx_PhasesToString(char *buf, size_t len);
+
+/* Begins timing an execution of the query's plan on the calling thread.
+ * Time spent in nested lock, GIL and matrix synchronization phases
+ * is excluded from the execution phase.
+ * The thread is allotted its share of the OpenMP threads until the
+ * execution ends. */
+void QueryCtx_BeginExecution(void);
+
+/* Ends timing the execution begun by QueryCtx_BeginExecution. */
+void QueryCtx_EndExecution(void);
+
+/* Return the time the query spent waiting for the graph's locks and the GIL. */
+double QueryCtx_GetLockWait(void);
+
 /* Free the allocations within the QueryCtx and reset it for the next query. */
 void QueryCtx_Free(void);
 
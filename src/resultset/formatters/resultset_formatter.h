@@ -7,8 +7,10 @@
 #pragma once
 
 #include "../../redismodule.h"
+#include "../reply_buffer.h"
 #include "../../graph/graphcontext.h"
 #include "../../graph/query_graph.h"
+#include "../../util/datablock/datablock.h"
 
 typedef enum {
 	COLUMN_UNKNOWN = 0,
@@ -33,16 +35,21 @@ typedef enum {
 } ValueType;
 
 // Typedef for header formatters.
-typedef void (*EmitHeaderFunc)(RedisModuleCtx *ctx, const char **columns,
+typedef void (*EmitHeaderFunc)(ReplyBuffer *reply, const char **columns,
 							   uint *col_rec_map);
 
 // Typedef for row formatters.
-typedef void (*EmitRowFunc)(RedisModuleCtx *ctx, GraphContext *gc,
+typedef void (*EmitRowFunc)(ReplyBuffer *reply, GraphContext *gc,
 		SIValue **row, uint numcols);
 							   
+// Typedef for formatters emitting all accumulated rows at once.
+typedef void (*EmitRowsFunc)(ReplyBuffer *reply, GraphContext *gc,
+		DataBlock *cells, uint numcols);
+
 typedef struct {
 	EmitRowFunc    EmitRow;
 	EmitHeaderFunc EmitHeader;
+	EmitRowsFunc   EmitRows;    // optional, replaces per-row emission
 } ResultSetFormatter;
 
 /* Redis prints doubles with up to 17 digits of precision, which captures
@@ -50,11 +57,11 @@ typedef struct {
  * By using the %g format and a precision of 15 significant digits, we avoid many
  * awkward representations like RETURN 0.1 emitting "0.10000000000000001",
  * though we're still subject to many of the typical issues with floating-point error. */
-static inline void _ResultSet_ReplyWithRoundedDouble(RedisModuleCtx *ctx, double d) {
+static inline void _ResultSet_ReplyWithRoundedDouble(ReplyBuffer *reply, double d) {
 	// Get length required to print number
 	int len = snprintf(NULL, 0, "%.15g", d);
 	char str[len + 1]; // TODO a reusable buffer would be far preferable
 	sprintf(str, "%.15g", d);
 	// Output string-formatted number
-	RedisModule_ReplyWithStringBuffer(ctx, str, len);
+	ReplyBuffer_ReplyWithStringBuffer(reply, str, len);
 }
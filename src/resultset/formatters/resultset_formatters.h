@@ -10,11 +10,13 @@
 #include "resultset_replynop.h"
 #include "resultset_replycompact.h"
 #include "resultset_replyverbose.h"
+#include "resultset_replybinary.h"
 
 typedef enum {
 	FORMATTER_NOP = 0,
 	FORMATTER_VERBOSE = 1,
 	FORMATTER_COMPACT = 2,
+	FORMATTER_BINARY = 3,
 } ResultSetFormatterType;
 
 /* Retrieves result-set formatter.
@@ -34,6 +36,13 @@ static ResultSetFormatter ResultSetFormatterCompact __attribute__((used)) = {
 	.EmitHeader = ResultSet_ReplyWithCompactHeader
 };
 
+/* Binary reply formatter, packs scalar result-sets into a columnar buffer. */
+static ResultSetFormatter ResultSetFormatterBinary __attribute__((used)) = {
+	.EmitRow = ResultSet_EmitCompactRow,
+	.EmitHeader = ResultSet_ReplyWithCompactHeader,
+	.EmitRows = ResultSet_EmitBinaryRows
+};
+
 /* Verbose reply formatter, used when querying via CLI. */
 static ResultSetFormatter ResultSetFormatterVerbose __attribute__((used)) = {
 	.EmitRow = ResultSet_EmitVerboseRow,
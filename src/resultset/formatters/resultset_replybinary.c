@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "resultset_formatters.h"
+#include "RG.h"
+#include "../../value.h"
+#include "../../util/rmalloc.h"
+
+// layout of a single column within the binary buffer
+typedef struct {
+	ValueType type;  // shared type of non-null values, VALUE_UNKNOWN if mixed
+	bool nullable;   // column contains both nulls and non-null values
+} _BinaryColumn;
+
+// maps a scalar to its value type, VALUE_UNKNOWN for non-scalars
+static inline ValueType _scalarValueType(const SIValue *v) {
+	switch(SI_TYPE(*v)) {
+	case T_NULL:
+		return VALUE_NULL;
+	case T_STRING:
+		return VALUE_STRING;
+	case T_INT64:
+		return VALUE_INTEGER;
+	case T_BOOL:
+		return VALUE_BOOLEAN;
+	case T_DOUBLE:
+		return VALUE_DOUBLE;
+	default:
+		return VALUE_UNKNOWN;
+	}
+}
+
+// number of bytes required to encode v's payload
+static inline size_t _payloadSize(const SIValue *v, ValueType t) {
+	switch(t) {
+	case VALUE_INTEGER:
+	case VALUE_DOUBLE:
+		return 8;
+	case VALUE_BOOLEAN:
+		return 1;
+	case VALUE_STRING:
+		return sizeof(uint32_t) + strlen(v->stringval);
+	default:
+		return 0;
+	}
+}
+
+static inline char *_writePayload(char *buf, const SIValue *v, ValueType t) {
+	switch(t) {
+	case VALUE_INTEGER:
+		memcpy(buf, &v->longval, 8);
+		return buf + 8;
+	case VALUE_DOUBLE:
+		memcpy(buf, &v->doubleval, 8);
+		return buf + 8;
+	case VALUE_BOOLEAN:
+		*buf = (v->longval != 0);
+		return buf + 1;
+	case VALUE_STRING: {
+		uint32_t len = strlen(v->stringval);
+		memcpy(buf, &len, sizeof(uint32_t));
+		memcpy(buf + sizeof(uint32_t), v->stringval, len);
+		return buf + sizeof(uint32_t) + len;
+	}
+	default:
+		return buf;
+	}
+}
+
+// emits rows one by one, as the compact formatter would
+static void _EmitCompactRows(ReplyBuffer *reply, GraphContext *gc,
+		DataBlock *cells, uint numcols, uint64_t nrows) {
+	ReplyBuffer_ReplyWithArray(reply, nrows);
+	SIValue *row[numcols];
+	for(uint64_t i = 0; i < nrows; i++) {
+		for(uint j = 0; j < numcols; j++) {
+			row[j] = DataBlock_GetItem(cells, i * numcols + j);
+		}
+		ResultSet_EmitCompactRow(reply, gc, row, numcols);
+	}
+}
+
+void ResultSet_EmitBinaryRows(ReplyBuffer *reply, GraphContext *gc,
+		DataBlock *cells, uint numcols) {
+	ASSERT(numcols > 0);
+
+	uint64_t nrows = DataBlock_ItemCount(cells) / numcols;
+	size_t bitmap_size = (nrows + 7) / 8;
+
+	//--------------------------------------------------------------------------
+	// determine column types and buffer size
+	//--------------------------------------------------------------------------
+
+	// row count, column count
+	size_t size = sizeof(uint64_t) + sizeof(uint32_t);
+	_BinaryColumn columns[numcols];
+
+	for(uint j = 0; j < numcols; j++) {
+		uint64_t nulls = 0;
+		ValueType type = VALUE_NULL;
+		size_t values_size = 0;  // payload size of non-null values
+		size_t tagged_size = 0;  // payload size, tagging each value with its type
+
+		for(uint64_t i = 0; i < nrows; i++) {
+			const SIValue *v = DataBlock_GetItem(cells, i * numcols + j);
+			ValueType t = _scalarValueType(v);
+			if(t == VALUE_UNKNOWN) {
+				// non-scalar value
+				_EmitCompactRows(reply, gc, cells, numcols, nrows);
+				return;
+			}
+
+			tagged_size += 1 + _payloadSize(v, t);
+			if(t == VALUE_NULL) {
+				nulls++;
+				continue;
+			}
+
+			if(type == VALUE_NULL) type = t;
+			else if(type != t) type = VALUE_UNKNOWN;
+			values_size += _payloadSize(v, t);
+		}
+
+		bool nullable = false;
+		size += 2; // type, nullable
+		if(type == VALUE_UNKNOWN) {
+			// mixed column, type tags mark nulls
+			size += tagged_size;
+		} else if(type != VALUE_NULL) {
+			// nulls are encoded as zeroed values, flagged by a bitmap
+			nullable = (nulls > 0);
+			if(type == VALUE_STRING) values_size += nulls * sizeof(uint32_t);
+			else if(type == VALUE_BOOLEAN) values_size = nrows;
+			else values_size = nrows * 8;
+			size += values_size;
+			if(nullable) size += bitmap_size;
+		}
+
+		columns[j].type = type;
+		columns[j].nullable = nullable;
+	}
+
+	//--------------------------------------------------------------------------
+	// populate buffer
+	//--------------------------------------------------------------------------
+
+	char *buf = rm_malloc(size);
+	char *p = buf;
+
+	uint32_t ncols = numcols;
+	memcpy(p, &nrows, sizeof(uint64_t));
+	p += sizeof(uint64_t);
+	memcpy(p, &ncols, sizeof(uint32_t));
+	p += sizeof(uint32_t);
+
+	for(uint j = 0; j < numcols; j++) {
+		ValueType type = columns[j].type;
+		bool nullable = columns[j].nullable;
+		*p++ = type;
+		*p++ = nullable;
+
+		if(type == VALUE_NULL) continue;
+
+		if(type == VALUE_UNKNOWN) {
+			for(uint64_t i = 0; i < nrows; i++) {
+				const SIValue *v = DataBlock_GetItem(cells, i * numcols + j);
+				ValueType t = _scalarValueType(v);
+				*p++ = t;
+				p = _writePayload(p, v, t);
+			}
+			continue;
+		}
+
+		char *bitmap = NULL;
+		if(nullable) {
+			bitmap = p;
+			memset(bitmap, 0, bitmap_size);
+			p += bitmap_size;
+		}
+
+		for(uint64_t i = 0; i < nrows; i++) {
+			const SIValue *v = DataBlock_GetItem(cells, i * numcols + j);
+			if(SI_TYPE(*v) == T_NULL) {
+				bitmap[i / 8] |= (1 << (i % 8));
+				if(type == VALUE_STRING) {
+					memset(p, 0, sizeof(uint32_t));
+					p += sizeof(uint32_t);
+				} else {
+					size_t width = (type == VALUE_BOOLEAN) ? 1 : 8;
+					memset(p, 0, width);
+					p += width;
+				}
+				continue;
+			}
+			p = _writePayload(p, v, type);
+		}
+	}
+
+	ASSERT((size_t)(p - buf) == size);
+	ReplyBuffer_ReplyWithStringBuffer(reply, buf, size);
+	rm_free(buf);
+}
+
@@ -0,0 +1,18 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include "../../util/datablock/datablock.h"
+
+/* Formatter for binary columnar replies
+ * scalar-only result-sets are packed into a single buffer, one column after
+ * the other, and emitted using a single reply call, see docs/client_spec.md
+ * result-sets containing graph entities, collections or points
+ * fall back to compact rows. */
+void ResultSet_EmitBinaryRows(ReplyBuffer *reply, GraphContext *gc,
+		DataBlock *cells, uint numcols);
+
@@ -10,12 +10,12 @@
 #include "../../datatypes/datatypes.h"
 
 // Forward declarations.
-static void _ResultSet_CompactReplyWithNode(RedisModuleCtx *ctx, GraphContext *gc, Node *n);
-static void _ResultSet_CompactReplyWithEdge(RedisModuleCtx *ctx, GraphContext *gc, Edge *e);
-static void _ResultSet_CompactReplyWithSIArray(RedisModuleCtx *ctx, GraphContext *gc, SIValue array);
-static void _ResultSet_CompactReplyWithPath(RedisModuleCtx *ctx, GraphContext *gc, SIValue path);
-static void _ResultSet_CompactReplyWithMap(RedisModuleCtx *ctx, GraphContext *gc, SIValue v);
-static void _ResultSet_CompactReplyWithPoint(RedisModuleCtx *ctx, GraphContext *gc, SIValue v);
+static void _ResultSet_CompactReplyWithNode(ReplyBuffer *reply, GraphContext *gc, Node *n);
+static void _ResultSet_CompactReplyWithEdge(ReplyBuffer *reply, GraphContext *gc, Edge *e);
+static void _ResultSet_CompactReplyWithSIArray(ReplyBuffer *reply, GraphContext *gc, SIValue array);
+static void _ResultSet_CompactReplyWithPath(ReplyBuffer *reply, GraphContext *gc, SIValue path);
+static void _ResultSet_CompactReplyWithMap(ReplyBuffer *reply, GraphContext *gc, SIValue v);
+static void _ResultSet_CompactReplyWithPoint(ReplyBuffer *reply, GraphContext *gc, SIValue v);
 
 static inline ValueType _mapValueType(const SIValue v) {
 	switch(SI_TYPE(v)) {
@@ -46,49 +46,49 @@ static inline ValueType _mapValueType(const SIValue v) {
 	}
 }
 
-static inline void _ResultSet_ReplyWithValueType(RedisModuleCtx *ctx, const SIValue v) {
-	RedisModule_ReplyWithLongLong(ctx, _mapValueType(v));
+static inline void _ResultSet_ReplyWithValueType(ReplyBuffer *reply, const SIValue v) {
+	ReplyBuffer_ReplyWithLongLong(reply, _mapValueType(v));
 }
 
-static void _ResultSet_CompactReplyWithSIValue(RedisModuleCtx *ctx, GraphContext *gc,
+static void _ResultSet_CompactReplyWithSIValue(ReplyBuffer *reply, GraphContext *gc,
 											   const SIValue v) {
 	// Emit the value type, then the actual value (to facilitate client-side parsing)
-	_ResultSet_ReplyWithValueType(ctx, v);
+	_ResultSet_ReplyWithValueType(reply, v);
 
 	switch(SI_TYPE(v)) {
 	case T_STRING:
-		RedisModule_ReplyWithStringBuffer(ctx, v.stringval, strlen(v.stringval));
+		ReplyBuffer_ReplyWithStringBuffer(reply, v.stringval, strlen(v.stringval));
 		return;
 	case T_INT64:
-		RedisModule_ReplyWithLongLong(ctx, v.longval);
+		ReplyBuffer_ReplyWithLongLong(reply, v.longval);
 		return;
 	case T_DOUBLE:
-		_ResultSet_ReplyWithRoundedDouble(ctx, v.doubleval);
+		_ResultSet_ReplyWithRoundedDouble(reply, v.doubleval);
 		return;
 	case T_BOOL:
-		if(v.longval != 0) RedisModule_ReplyWithStringBuffer(ctx, "true", 4);
-		else RedisModule_ReplyWithStringBuffer(ctx, "false", 5);
+		if(v.longval != 0) ReplyBuffer_ReplyWithStringBuffer(reply, "true", 4);
+		else ReplyBuffer_ReplyWithStringBuffer(reply, "false", 5);
 		return;
 	case T_ARRAY:
-		_ResultSet_CompactReplyWithSIArray(ctx, gc, v);
+		_ResultSet_CompactReplyWithSIArray(reply, gc, v);
 		break;
 	case T_NULL:
-		RedisModule_ReplyWithNull(ctx);
+		ReplyBuffer_ReplyWithNull(reply);
 		return;
 	case T_NODE:
-		_ResultSet_CompactReplyWithNode(ctx, gc, v.ptrval);
+		_ResultSet_CompactReplyWithNode(reply, gc, v.ptrval);
 		return;
 	case T_EDGE:
-		_ResultSet_CompactReplyWithEdge(ctx, gc, v.ptrval);
+		_ResultSet_CompactReplyWithEdge(reply, gc, v.ptrval);
 		return;
 	case T_PATH:
-		_ResultSet_CompactReplyWithPath(ctx, gc, v);
+		_ResultSet_CompactReplyWithPath(reply, gc, v);
 		return;
 	case T_MAP:
-		_ResultSet_CompactReplyWithMap(ctx, gc, v);
+		_ResultSet_CompactReplyWithMap(reply, gc, v);
 		return;
 	case T_POINT:
-		_ResultSet_CompactReplyWithPoint(ctx, gc, v);
+		_ResultSet_CompactReplyWithPoint(reply, gc, v);
 		return;
 	default:
 		RedisModule_Assert("Unhandled value type" && false);
@@ -96,23 +96,23 @@ static void _ResultSet_CompactReplyWithSIValue(RedisModuleCtx *ctx, GraphContext
 	}
 }
 
-static void _ResultSet_CompactReplyWithProperties(RedisModuleCtx *ctx, GraphContext *gc,
+static void _ResultSet_CompactReplyWithProperties(ReplyBuffer *reply, GraphContext *gc,
 												  const GraphEntity *e) {
 	int prop_count = ENTITY_PROP_COUNT(e);
-	RedisModule_ReplyWithArray(ctx, prop_count);
+	ReplyBuffer_ReplyWithArray(reply, prop_count);
 	// Iterate over all properties stored on entity
 	for(int i = 0; i < prop_count; i ++) {
 		// Compact replies include the value's type; verbose replies do not
-		RedisModule_ReplyWithArray(ctx, 3);
-		EntityProperty prop = ENTITY_PROPS(e)[i];
+		ReplyBuffer_ReplyWithArray(reply, 3);
+		EntityProperty *prop = ENTITY_PROPS(e) + i;
 		// Emit the string index
-		RedisModule_ReplyWithLongLong(ctx, prop.id);
+		ReplyBuffer_ReplyWithLongLong(reply, prop->id);
 		// Emit the value
-		_ResultSet_CompactReplyWithSIValue(ctx, gc, prop.value);
+		_ResultSet_CompactReplyWithSIValue(reply, gc, EntityProperty_Value(prop));
 	}
 }
 
-static void _ResultSet_CompactReplyWithNode(RedisModuleCtx *ctx, GraphContext *gc, Node *n) {
+static void _ResultSet_CompactReplyWithNode(ReplyBuffer *reply, GraphContext *gc, Node *n) {
 	/*  Compact node reply format:
 	 *  [
 	 *      Node ID (integer),
@@ -121,28 +121,28 @@ static void _ResultSet_CompactReplyWithNode(RedisModuleCtx *ctx, GraphContext *g
 	 *  ]
 	 */
 	// 3 top-level entities in node reply
-	RedisModule_ReplyWithArray(ctx, 3);
+	ReplyBuffer_ReplyWithArray(reply, 3);
 
 	// id (integer)
 	EntityID id = ENTITY_GET_ID(n);
-	RedisModule_ReplyWithLongLong(ctx, id);
+	ReplyBuffer_ReplyWithLongLong(reply, id);
 
 	// [label string index]
 	int label_id = NODE_GET_LABEL_ID(n, gc->g);
 	if(label_id == GRAPH_NO_LABEL) {
 		// Emit an empty array for unlabeled nodes.
-		RedisModule_ReplyWithArray(ctx, 0);
+		ReplyBuffer_ReplyWithArray(reply, 0);
 	} else {
 		// Print label in nested array for multi-label support.
-		RedisModule_ReplyWithArray(ctx, 1);
-		RedisModule_ReplyWithLongLong(ctx, label_id);
+		ReplyBuffer_ReplyWithArray(reply, 1);
+		ReplyBuffer_ReplyWithLongLong(reply, label_id);
 	}
 
 	// [properties]
-	_ResultSet_CompactReplyWithProperties(ctx, gc, (GraphEntity *)n);
+	_ResultSet_CompactReplyWithProperties(reply, gc, (GraphEntity *)n);
 }
 
-static void _ResultSet_CompactReplyWithEdge(RedisModuleCtx *ctx, GraphContext *gc, Edge *e) {
+static void _ResultSet_CompactReplyWithEdge(ReplyBuffer *reply, GraphContext *gc, Edge *e) {
 	/*  Compact edge reply format:
 	 *  [
 	 *      Edge ID (integer),
@@ -153,28 +153,28 @@ static void _ResultSet_CompactReplyWithEdge(RedisModuleCtx *ctx, GraphContext *g
 	 *  ]
 	 */
 	// 5 top-level entities in edge reply
-	RedisModule_ReplyWithArray(ctx, 5);
+	ReplyBuffer_ReplyWithArray(reply, 5);
 
 	// id (integer)
 	EntityID id = ENTITY_GET_ID(e);
-	RedisModule_ReplyWithLongLong(ctx, id);
+	ReplyBuffer_ReplyWithLongLong(reply, id);
 
 	// reltype string index, retrieve reltype.
 	int reltype_id = Graph_GetEdgeRelation(gc->g, e);
 	ASSERT(reltype_id != GRAPH_NO_RELATION);
-	RedisModule_ReplyWithLongLong(ctx, reltype_id);
+	ReplyBuffer_ReplyWithLongLong(reply, reltype_id);
 
 	// src node ID
-	RedisModule_ReplyWithLongLong(ctx, Edge_GetSrcNodeID(e));
+	ReplyBuffer_ReplyWithLongLong(reply, Edge_GetSrcNodeID(e));
 
 	// dest node ID
-	RedisModule_ReplyWithLongLong(ctx, Edge_GetDestNodeID(e));
+	ReplyBuffer_ReplyWithLongLong(reply, Edge_GetDestNodeID(e));
 
 	// [properties]
-	_ResultSet_CompactReplyWithProperties(ctx, gc, (GraphEntity *)e);
+	_ResultSet_CompactReplyWithProperties(reply, gc, (GraphEntity *)e);
 }
 
-static void _ResultSet_CompactReplyWithSIArray(RedisModuleCtx *ctx, GraphContext *gc,
+static void _ResultSet_CompactReplyWithSIArray(ReplyBuffer *reply, GraphContext *gc,
 											   SIValue array) {
 
 	/*  Compact array reply format:
@@ -188,14 +188,14 @@ static void _ResultSet_CompactReplyWithSIArray(RedisModuleCtx *ctx, GraphContext
 	 *  ]
 	 */
 	uint arrayLen = SIArray_Length(array);
-	RedisModule_ReplyWithArray(ctx, arrayLen);
+	ReplyBuffer_ReplyWithArray(reply, arrayLen);
 	for(uint i = 0; i < arrayLen; i++) {
-		RedisModule_ReplyWithArray(ctx, 2); // Reply with array with space for type and value
-		_ResultSet_CompactReplyWithSIValue(ctx, gc, SIArray_Get(array, i));
+		ReplyBuffer_ReplyWithArray(reply, 2); // Reply with array with space for type and value
+		_ResultSet_CompactReplyWithSIValue(reply, gc, SIArray_Get(array, i));
 	}
 }
 
-static void _ResultSet_CompactReplyWithPath(RedisModuleCtx *ctx, GraphContext *gc, SIValue path) {
+static void _ResultSet_CompactReplyWithPath(ReplyBuffer *reply, GraphContext *gc, SIValue path) {
 	/* Path will return as an array of two SIArrays, the first is path nodes and the second is edges,
 	* see array compact format.
 	* Compact path reply:
@@ -219,21 +219,32 @@ static void _ResultSet_CompactReplyWithPath(RedisModuleCtx *ctx, GraphContext *g
 	* ]
 	*/
 
+	// The arrays are emitted straight from the path,
+	// without collecting its nodes and edges into intermediate arrays.
+
 	// Response consists of two arrays.
-	RedisModule_ReplyWithArray(ctx, 2);
+	ReplyBuffer_ReplyWithArray(reply, 2);
 	// First array type and value.
-	RedisModule_ReplyWithArray(ctx, 2);
-	SIValue nodes = SIPath_Nodes(path);
-	_ResultSet_CompactReplyWithSIValue(ctx, gc, nodes);
-	SIValue_Free(nodes);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithLongLong(reply, VALUE_ARRAY);
+	size_t node_count = SIPath_NodeCount(path);
+	ReplyBuffer_ReplyWithArray(reply, node_count);
+	for(size_t i = 0; i < node_count; i++) {
+		ReplyBuffer_ReplyWithArray(reply, 2);
+		_ResultSet_CompactReplyWithSIValue(reply, gc, SIPath_GetNode(path, i));
+	}
 	// Second array type and value.
-	RedisModule_ReplyWithArray(ctx, 2);
-	SIValue relationships = SIPath_Relationships(path);
-	_ResultSet_CompactReplyWithSIValue(ctx, gc, relationships);
-	SIValue_Free(relationships);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithLongLong(reply, VALUE_ARRAY);
+	size_t edge_count = SIPath_Length(path);
+	ReplyBuffer_ReplyWithArray(reply, edge_count);
+	for(size_t i = 0; i < edge_count; i++) {
+		ReplyBuffer_ReplyWithArray(reply, 2);
+		_ResultSet_CompactReplyWithSIValue(reply, gc, SIPath_GetRelationship(path, i));
+	}
 }
 
-static void _ResultSet_CompactReplyWithMap(RedisModuleCtx *ctx, GraphContext *gc, SIValue v) {
+static void _ResultSet_CompactReplyWithMap(ReplyBuffer *reply, GraphContext *gc, SIValue v) {
 	// map will be returned as an array of key/value pairs
 	// consider the map object: {a:1, b:'str', c: {x:1, y:2}}
 	//
@@ -252,55 +263,55 @@ static void _ResultSet_CompactReplyWithMap(RedisModuleCtx *ctx, GraphContext *gc
 
 	// response consists of N pairs array:
 	// (string, value type, value)
-	RedisModule_ReplyWithArray(ctx, key_count * 2);
+	ReplyBuffer_ReplyWithArray(reply, key_count * 2);
 	for(int i = 0; i < key_count; i++) {
 		Pair     p     =  m[i];
 		SIValue  val   =  p.val;
 		char     *key  =  p.key.stringval;
 
 		// emit key
-		RedisModule_ReplyWithCString(ctx, key);
+		ReplyBuffer_ReplyWithCString(reply, key);
 
 		// emit value
-		RedisModule_ReplyWithArray(ctx, 2);
-		_ResultSet_CompactReplyWithSIValue(ctx, gc, val);
+		ReplyBuffer_ReplyWithArray(reply, 2);
+		_ResultSet_CompactReplyWithSIValue(reply, gc, val);
 	}
 }
 
-static void _ResultSet_CompactReplyWithPoint(RedisModuleCtx *ctx, GraphContext *gc, SIValue v) {
+static void _ResultSet_CompactReplyWithPoint(ReplyBuffer *reply, GraphContext *gc, SIValue v) {
 	ASSERT(SI_TYPE(v) == T_POINT);
-	RedisModule_ReplyWithArray(ctx, 2);
+	ReplyBuffer_ReplyWithArray(reply, 2);
 
-	_ResultSet_ReplyWithRoundedDouble(ctx, Point_lat(v));
-	_ResultSet_ReplyWithRoundedDouble(ctx, Point_lon(v));
+	_ResultSet_ReplyWithRoundedDouble(reply, Point_lat(v));
+	_ResultSet_ReplyWithRoundedDouble(reply, Point_lon(v));
 }
 
-void ResultSet_EmitCompactRow(RedisModuleCtx *ctx, GraphContext *gc,
+void ResultSet_EmitCompactRow(ReplyBuffer *reply, GraphContext *gc,
 		SIValue **row, uint numcols) {
 	// Prepare return array sized to the number of RETURN entities
-	RedisModule_ReplyWithArray(ctx, numcols);
+	ReplyBuffer_ReplyWithArray(reply, numcols);
 
 	for(uint i = 0; i < numcols; i++) {
 		SIValue cell = *row[i];
-		RedisModule_ReplyWithArray(ctx, 2); // Reply with array with space for type and value
-		_ResultSet_CompactReplyWithSIValue(ctx, gc, cell);
+		ReplyBuffer_ReplyWithArray(reply, 2); // Reply with array with space for type and value
+		_ResultSet_CompactReplyWithSIValue(reply, gc, cell);
 	}
 }
 
 // For every column in the header, emit a 2-array containing the ColumnType enum
 // followed by the column alias.
-void ResultSet_ReplyWithCompactHeader(RedisModuleCtx *ctx, const char **columns,
+void ResultSet_ReplyWithCompactHeader(ReplyBuffer *reply, const char **columns,
 									  uint *col_rec_map) {
 	uint columns_len = array_len(columns);
-	RedisModule_ReplyWithArray(ctx, columns_len);
+	ReplyBuffer_ReplyWithArray(reply, columns_len);
 	for(uint i = 0; i < columns_len; i++) {
-		RedisModule_ReplyWithArray(ctx, 2);
+		ReplyBuffer_ReplyWithArray(reply, 2);
 		/* Because the types found in the first Record do not necessarily inform the types
 		 * in subsequent records, we will always set the column type as scalar. */
 		ColumnType t = COLUMN_SCALAR;
-		RedisModule_ReplyWithLongLong(ctx, t);
+		ReplyBuffer_ReplyWithLongLong(reply, t);
 
 		// Second, emit the identifier string associated with the column
-		RedisModule_ReplyWithStringBuffer(ctx, columns[i], strlen(columns[i]));
+		ReplyBuffer_ReplyWithStringBuffer(reply, columns[i], strlen(columns[i]));
 	}
 }
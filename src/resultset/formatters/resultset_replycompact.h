@@ -7,8 +7,8 @@
 #pragma once
 
 // Formatter for compact (client-parsed) replies
-void ResultSet_ReplyWithCompactHeader(RedisModuleCtx *ctx, const char **columns, uint *col_rec_map);
+void ResultSet_ReplyWithCompactHeader(ReplyBuffer *reply, const char **columns, uint *col_rec_map);
 
-void ResultSet_EmitCompactRow(RedisModuleCtx *ctx, GraphContext *gc,
+void ResultSet_EmitCompactRow(ReplyBuffer *reply, GraphContext *gc,
 		SIValue **row, uint numcols);
 
@@ -7,11 +7,11 @@
 #include "resultset_formatters.h"
 #include "../../util/arr.h"
 
-void ResultSet_EmitNOPHeader(RedisModuleCtx *ctx, const char **columns,
+void ResultSet_EmitNOPHeader(ReplyBuffer *reply, const char **columns,
 		uint *col_rec_map) {
 }
 
-void ResultSet_EmitNOPRow(RedisModuleCtx *ctx, GraphContext *gc, SIValue **row,
+void ResultSet_EmitNOPRow(ReplyBuffer *reply, GraphContext *gc, SIValue **row,
 		uint numcols) {
 }
 
@@ -7,6 +7,6 @@
 #pragma once
 
 // Formatter for compact (client-parsed) replies
-void ResultSet_EmitNOPHeader(RedisModuleCtx *ctx, const char **columns, uint *col_rec_map);
-void ResultSet_EmitNOPRow(RedisModuleCtx *ctx, GraphContext *gc, SIValue **row, uint numcols);
+void ResultSet_EmitNOPHeader(ReplyBuffer *reply, const char **columns, uint *col_rec_map);
+void ResultSet_EmitNOPRow(ReplyBuffer *reply, GraphContext *gc, SIValue **row, uint numcols);
 
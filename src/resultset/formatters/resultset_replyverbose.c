@@ -9,75 +9,75 @@
 #include "../../datatypes/datatypes.h"
 
 // Forward declarations.
-static void _ResultSet_VerboseReplyWithMap(RedisModuleCtx *ctx, SIValue map);
-static void _ResultSet_VerboseReplyWithPath(RedisModuleCtx *ctx, SIValue path);
-static void _ResultSet_VerboseReplyWithPoint(RedisModuleCtx *ctx, SIValue point);
-static void _ResultSet_VerboseReplyWithArray(RedisModuleCtx *ctx, SIValue array);
-static void _ResultSet_VerboseReplyWithNode(RedisModuleCtx *ctx, GraphContext *gc, Node *n);
-static void _ResultSet_VerboseReplyWithEdge(RedisModuleCtx *ctx, GraphContext *gc, Edge *e);
+static void _ResultSet_VerboseReplyWithMap(ReplyBuffer *reply, SIValue map);
+static void _ResultSet_VerboseReplyWithPath(ReplyBuffer *reply, SIValue path);
+static void _ResultSet_VerboseReplyWithPoint(ReplyBuffer *reply, SIValue point);
+static void _ResultSet_VerboseReplyWithArray(ReplyBuffer *reply, SIValue array);
+static void _ResultSet_VerboseReplyWithNode(ReplyBuffer *reply, GraphContext *gc, Node *n);
+static void _ResultSet_VerboseReplyWithEdge(ReplyBuffer *reply, GraphContext *gc, Edge *e);
 
 /* This function has handling for all SIValue scalar types.
  * The current RESP protocol only has unique support for strings, 8-byte integers,
  * and NULL values. */
-static void _ResultSet_VerboseReplyWithSIValue(RedisModuleCtx *ctx, GraphContext *gc,
+static void _ResultSet_VerboseReplyWithSIValue(ReplyBuffer *reply, GraphContext *gc,
 											   const SIValue v) {
 	switch(SI_TYPE(v)) {
 	case T_STRING:
-		RedisModule_ReplyWithStringBuffer(ctx, v.stringval, strlen(v.stringval));
+		ReplyBuffer_ReplyWithStringBuffer(reply, v.stringval, strlen(v.stringval));
 		return;
 	case T_INT64:
-		RedisModule_ReplyWithLongLong(ctx, v.longval);
+		ReplyBuffer_ReplyWithLongLong(reply, v.longval);
 		return;
 	case T_DOUBLE:
-		_ResultSet_ReplyWithRoundedDouble(ctx, v.doubleval);
+		_ResultSet_ReplyWithRoundedDouble(reply, v.doubleval);
 		return;
 	case T_BOOL:
-		if(v.longval != 0) RedisModule_ReplyWithStringBuffer(ctx, "true", 4);
-		else RedisModule_ReplyWithStringBuffer(ctx, "false", 5);
+		if(v.longval != 0) ReplyBuffer_ReplyWithStringBuffer(reply, "true", 4);
+		else ReplyBuffer_ReplyWithStringBuffer(reply, "false", 5);
 		return;
 	case T_NULL:
-		RedisModule_ReplyWithNull(ctx);
+		ReplyBuffer_ReplyWithNull(reply);
 		return;
 	case T_NODE:
-		_ResultSet_VerboseReplyWithNode(ctx, gc, v.ptrval);
+		_ResultSet_VerboseReplyWithNode(reply, gc, v.ptrval);
 		return;
 	case T_EDGE:
-		_ResultSet_VerboseReplyWithEdge(ctx, gc, v.ptrval);
+		_ResultSet_VerboseReplyWithEdge(reply, gc, v.ptrval);
 		return;
 	case T_ARRAY:
-		_ResultSet_VerboseReplyWithArray(ctx, v);
+		_ResultSet_VerboseReplyWithArray(reply, v);
 		return;
 	case T_PATH:
-		_ResultSet_VerboseReplyWithPath(ctx, v);
+		_ResultSet_VerboseReplyWithPath(reply, v);
 		return;
 	case T_MAP:
-		_ResultSet_VerboseReplyWithMap(ctx, v);
+		_ResultSet_VerboseReplyWithMap(reply, v);
 		return;
 	case T_POINT:
-		_ResultSet_VerboseReplyWithPoint(ctx, v);
+		_ResultSet_VerboseReplyWithPoint(reply, v);
 		return;
 	default:
 		RedisModule_Assert("Unhandled value type" && false);
 	}
 }
 
-static void _ResultSet_VerboseReplyWithProperties(RedisModuleCtx *ctx, GraphContext *gc,
+static void _ResultSet_VerboseReplyWithProperties(ReplyBuffer *reply, GraphContext *gc,
 												  const GraphEntity *e) {
 	int prop_count = ENTITY_PROP_COUNT(e);
-	RedisModule_ReplyWithArray(ctx, prop_count);
+	ReplyBuffer_ReplyWithArray(reply, prop_count);
 	// Iterate over all properties stored on entity
 	for(int i = 0; i < prop_count; i ++) {
-		RedisModule_ReplyWithArray(ctx, 2);
-		EntityProperty prop = ENTITY_PROPS(e)[i];
+		ReplyBuffer_ReplyWithArray(reply, 2);
+		EntityProperty *prop = ENTITY_PROPS(e) + i;
 		// Emit the actual string
-		const char *prop_str = GraphContext_GetAttributeString(gc, prop.id);
-		RedisModule_ReplyWithStringBuffer(ctx, prop_str, strlen(prop_str));
+		const char *prop_str = GraphContext_GetAttributeString(gc, prop->id);
+		ReplyBuffer_ReplyWithStringBuffer(reply, prop_str, strlen(prop_str));
 		// Emit the value
-		_ResultSet_VerboseReplyWithSIValue(ctx, gc, prop.value);
+		_ResultSet_VerboseReplyWithSIValue(reply, gc, EntityProperty_Value(prop));
 	}
 }
 
-static void _ResultSet_VerboseReplyWithNode(RedisModuleCtx *ctx, GraphContext *gc, Node *n) {
+static void _ResultSet_VerboseReplyWithNode(ReplyBuffer *reply, GraphContext *gc, Node *n) {
 	/*  Verbose node reply format:
 	 *  [
 	 *      ["id", Node ID (integer)]
@@ -86,37 +86,37 @@ static void _ResultSet_VerboseReplyWithNode(RedisModuleCtx *ctx, GraphContext *g
 	 *  ]
 	 */
 	// 3 top-level entities in node reply
-	RedisModule_ReplyWithArray(ctx, 3);
+	ReplyBuffer_ReplyWithArray(reply, 3);
 
 	// ["id", id (integer)]
 	EntityID id = ENTITY_GET_ID(n);
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "id", 2);
-	RedisModule_ReplyWithLongLong(ctx, id);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "id", 2);
+	ReplyBuffer_ReplyWithLongLong(reply, id);
 
 	// ["labels", [label (string)]]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "labels", 6);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "labels", 6);
 	const char *label = NODE_GET_LABEL(n);
 	// Retrieve label if it is not set on the node.
 	// TODO Make a more efficient lookup for this string
 	if(label == NULL) label = GraphContext_GetNodeLabel(gc, n);
 	if(label == NULL) {
 		// Emit an empty array for unlabeled nodes.
-		RedisModule_ReplyWithArray(ctx, 0);
+		ReplyBuffer_ReplyWithArray(reply, 0);
 	} else {
 		// Print label in nested array for multi-label support.
-		RedisModule_ReplyWithArray(ctx, 1);
-		RedisModule_ReplyWithStringBuffer(ctx, label, strlen(label));
+		ReplyBuffer_ReplyWithArray(reply, 1);
+		ReplyBuffer_ReplyWithStringBuffer(reply, label, strlen(label));
 	}
 
 	// [properties, [properties]]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "properties", 10);
-	_ResultSet_VerboseReplyWithProperties(ctx, gc, (GraphEntity *)n);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "properties", 10);
+	_ResultSet_VerboseReplyWithProperties(reply, gc, (GraphEntity *)n);
 }
 
-static void _ResultSet_VerboseReplyWithEdge(RedisModuleCtx *ctx, GraphContext *gc, Edge *e) {
+static void _ResultSet_VerboseReplyWithEdge(ReplyBuffer *reply, GraphContext *gc, Edge *e) {
 	/*  Edge reply format:
 	 *  [
 	 *      ["id", Edge ID (integer)]
@@ -127,88 +127,88 @@ static void _ResultSet_VerboseReplyWithEdge(RedisModuleCtx *ctx, GraphContext *g
 	 *  ]
 	 */
 	// 5 top-level entities in edge reply
-	RedisModule_ReplyWithArray(ctx, 5);
+	ReplyBuffer_ReplyWithArray(reply, 5);
 
 	// ["id", id (integer)]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "id", 2);
-	RedisModule_ReplyWithLongLong(ctx, ENTITY_GET_ID(e));
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "id", 2);
+	ReplyBuffer_ReplyWithLongLong(reply, ENTITY_GET_ID(e));
 
 	// ["type", type (string)]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "type", 4);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "type", 4);
 	// Retrieve relation type
 	Schema *s = GraphContext_GetSchemaByID(gc, Edge_GetRelationID(e), SCHEMA_EDGE);
 	const char *reltype = Schema_GetName(s);
-	RedisModule_ReplyWithStringBuffer(ctx, reltype, strlen(reltype));
+	ReplyBuffer_ReplyWithStringBuffer(reply, reltype, strlen(reltype));
 
 	// ["src_node", srcNodeID (integer)]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "src_node", 8);
-	RedisModule_ReplyWithLongLong(ctx, Edge_GetSrcNodeID(e));
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "src_node", 8);
+	ReplyBuffer_ReplyWithLongLong(reply, Edge_GetSrcNodeID(e));
 
 	// ["dest_node", destNodeID (integer)]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "dest_node", 9);
-	RedisModule_ReplyWithLongLong(ctx, Edge_GetDestNodeID(e));
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "dest_node", 9);
+	ReplyBuffer_ReplyWithLongLong(reply, Edge_GetDestNodeID(e));
 
 	// [properties, [properties]]
-	RedisModule_ReplyWithArray(ctx, 2);
-	RedisModule_ReplyWithStringBuffer(ctx, "properties", 10);
-	_ResultSet_VerboseReplyWithProperties(ctx, gc, (GraphEntity *)e);
+	ReplyBuffer_ReplyWithArray(reply, 2);
+	ReplyBuffer_ReplyWithStringBuffer(reply, "properties", 10);
+	_ResultSet_VerboseReplyWithProperties(reply, gc, (GraphEntity *)e);
 }
 
-static void _ResultSet_VerboseReplyWithArray(RedisModuleCtx *ctx, SIValue array) {
+static void _ResultSet_VerboseReplyWithArray(ReplyBuffer *reply, SIValue array) {
 	size_t bufferLen = 512;
 	char *str = rm_calloc(bufferLen, sizeof(char));
 	size_t bytesWrriten = 0;
 	SIValue_ToString(array, &str, &bufferLen, &bytesWrriten);
-	RedisModule_ReplyWithStringBuffer(ctx, str, bytesWrriten);
+	ReplyBuffer_ReplyWithStringBuffer(reply, str, bytesWrriten);
 	rm_free(str);
 }
 
-static void _ResultSet_VerboseReplyWithPath(RedisModuleCtx *ctx, SIValue path) {
-	SIValue path_array = SIPath_ToList(path);
-	_ResultSet_VerboseReplyWithArray(ctx, path_array);
-	SIValue_Free(path_array);
+static void _ResultSet_VerboseReplyWithPath(ReplyBuffer *reply, SIValue path) {
+	// a path prints as the list of its nodes and edges, by ID
+	// print it directly rather than materializing that list
+	_ResultSet_VerboseReplyWithArray(reply, path);
 }
 
-static void _ResultSet_VerboseReplyWithMap(RedisModuleCtx *ctx, SIValue map) {
+static void _ResultSet_VerboseReplyWithMap(ReplyBuffer *reply, SIValue map) {
 	size_t bufferLen = 512;
 	char *str = rm_calloc(bufferLen, sizeof(char));
 	size_t bytesWrriten = 0;
 	SIValue_ToString(map, &str, &bufferLen, &bytesWrriten);
-	RedisModule_ReplyWithStringBuffer(ctx, str, bytesWrriten);
+	ReplyBuffer_ReplyWithStringBuffer(reply, str, bytesWrriten);
 	rm_free(str);
 }
 
-static void _ResultSet_VerboseReplyWithPoint(RedisModuleCtx *ctx, SIValue point) {
+static void _ResultSet_VerboseReplyWithPoint(ReplyBuffer *reply, SIValue point) {
 	// point({latitude:56.7, longitude:12.78})
 	char buffer[256];
 	int bytes_written = sprintf(buffer, "point({latitude:%f, longitude:%f})",
 			Point_lat(point), Point_lon(point));
 
-	RedisModule_ReplyWithStringBuffer(ctx, buffer, bytes_written);
+	ReplyBuffer_ReplyWithStringBuffer(reply, buffer, bytes_written);
 }
 
-void ResultSet_EmitVerboseRow(RedisModuleCtx *ctx, GraphContext *gc,
+void ResultSet_EmitVerboseRow(ReplyBuffer *reply, GraphContext *gc,
 		SIValue **row, uint numcols) {
 	// Prepare return array sized to the number of RETURN entities
-	RedisModule_ReplyWithArray(ctx, numcols);
+	ReplyBuffer_ReplyWithArray(reply, numcols);
 
 	for(int i = 0; i < numcols; i++) {
 		SIValue v = *row[i];
-		_ResultSet_VerboseReplyWithSIValue(ctx, gc, v);
+		_ResultSet_VerboseReplyWithSIValue(reply, gc, v);
 	}
 }
 
 // Emit the alias or descriptor for each column in the header.
-void ResultSet_ReplyWithVerboseHeader(RedisModuleCtx *ctx, const char **columns,
+void ResultSet_ReplyWithVerboseHeader(ReplyBuffer *reply, const char **columns,
 		uint *col_rec_map) {
 	uint columns_len = array_len(columns);
-	RedisModule_ReplyWithArray(ctx, columns_len);
+	ReplyBuffer_ReplyWithArray(reply, columns_len);
 	for(uint i = 0; i < columns_len; i++) {
 		// Emit the identifier string associated with the column
-		RedisModule_ReplyWithStringBuffer(ctx, columns[i], strlen(columns[i]));
+		ReplyBuffer_ReplyWithStringBuffer(reply, columns[i], strlen(columns[i]));
 	}
 }
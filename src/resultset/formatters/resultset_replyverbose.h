@@ -7,8 +7,8 @@
 #pragma once
 
 // Formatter for verbose (human-readable) replies
-void ResultSet_ReplyWithVerboseHeader(RedisModuleCtx *ctx, const char **columns, uint *col_rec_map);
+void ResultSet_ReplyWithVerboseHeader(ReplyBuffer *reply, const char **columns, uint *col_rec_map);
 
-void ResultSet_EmitVerboseRow(RedisModuleCtx *ctx, GraphContext *gc,
+void ResultSet_EmitVerboseRow(ReplyBuffer *reply, GraphContext *gc,
 		SIValue **row, uint numcols);
 
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "reply_buffer.h"
+#include "RG.h"
+#include "../util/rmalloc.h"
+#include <string.h>
+
+#define REPLY_BUFFER_INITIAL_CAP 4096
+
+// type tag preceding each recorded reply
+typedef enum {
+	REPLY_ARRAY,
+	REPLY_LONGLONG,
+	REPLY_STRING,
+	REPLY_NULL,
+} _ReplyTag;
+
+// make sure buf can hold n additional bytes
+static inline void _ReplyBuffer_Reserve(ReplyBuffer *buf, size_t n) {
+	if(buf->len + n <= buf->cap) return;
+	size_t cap = (buf->cap == 0) ? REPLY_BUFFER_INITIAL_CAP : buf->cap;
+	while(cap < buf->len + n) cap *= 2;
+	buf->data = rm_realloc(buf->data, cap);
+	buf->cap = cap;
+}
+
+static inline void _ReplyBuffer_Write(ReplyBuffer *buf, _ReplyTag tag,
+		const void *v, size_t n) {
+	_ReplyBuffer_Reserve(buf, 1 + n);
+	buf->data[buf->len++] = tag;
+	memcpy(buf->data + buf->len, v, n);
+	buf->len += n;
+}
+
+void ReplyBuffer_Init(ReplyBuffer *buf) {
+	ASSERT(buf != NULL);
+	buf->data = NULL;
+	buf->len = 0;
+	buf->cap = 0;
+}
+
+void ReplyBuffer_ReplyWithArray(ReplyBuffer *buf, long len) {
+	int64_t v = len;
+	_ReplyBuffer_Write(buf, REPLY_ARRAY, &v, sizeof(v));
+}
+
+void ReplyBuffer_ReplyWithLongLong(ReplyBuffer *buf, long long ll) {
+	int64_t v = ll;
+	_ReplyBuffer_Write(buf, REPLY_LONGLONG, &v, sizeof(v));
+}
+
+void ReplyBuffer_ReplyWithStringBuffer(ReplyBuffer *buf, const char *str,
+		size_t len) {
+	uint64_t n = len;
+	_ReplyBuffer_Write(buf, REPLY_STRING, &n, sizeof(n));
+	_ReplyBuffer_Reserve(buf, len);
+	memcpy(buf->data + buf->len, str, len);
+	buf->len += len;
+}
+
+void ReplyBuffer_ReplyWithCString(ReplyBuffer *buf, const char *str) {
+	ReplyBuffer_ReplyWithStringBuffer(buf, str, strlen(str));
+}
+
+void ReplyBuffer_ReplyWithNull(ReplyBuffer *buf) {
+	_ReplyBuffer_Write(buf, REPLY_NULL, NULL, 0);
+}
+
+void ReplyBuffer_Append(ReplyBuffer *buf, const char *data, size_t len) {
+	ASSERT(buf != NULL);
+	_ReplyBuffer_Reserve(buf, len);
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+}
+
+void ReplyBuffer_Flush(ReplyBuffer *buf, RedisModuleCtx *ctx) {
+	ASSERT(buf != NULL && ctx != NULL);
+
+	const char *p = buf->data;
+	const char *end = buf->data + buf->len;
+
+	while(p < end) {
+		_ReplyTag tag = *p++;
+		switch(tag) {
+		case REPLY_ARRAY: {
+			int64_t v;
+			memcpy(&v, p, sizeof(v));
+			RedisModule_ReplyWithArray(ctx, v);
+			p += sizeof(v);
+			break;
+		}
+		case REPLY_LONGLONG: {
+			int64_t v;
+			memcpy(&v, p, sizeof(v));
+			RedisModule_ReplyWithLongLong(ctx, v);
+			p += sizeof(v);
+			break;
+		}
+		case REPLY_STRING: {
+			uint64_t n;
+			memcpy(&n, p, sizeof(n));
+			p += sizeof(n);
+			RedisModule_ReplyWithStringBuffer(ctx, p, n);
+			p += n;
+			break;
+		}
+		case REPLY_NULL:
+			RedisModule_ReplyWithNull(ctx);
+			break;
+		default:
+			ASSERT(false && "unknown reply buffer tag");
+			break;
+		}
+	}
+
+	buf->len = 0;
+}
+
+void ReplyBuffer_Free(ReplyBuffer *buf) {
+	ASSERT(buf != NULL);
+	rm_free(buf->data);
+	buf->data = NULL;
+	buf->len = 0;
+	buf->cap = 0;
+}
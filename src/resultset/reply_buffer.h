@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../redismodule.h"
+
+// ReplyBuffer records a sequence of reply calls in memory
+// formatters serialize an entire reply into a private buffer
+// without going through Redis reply machinery cell by cell
+// once complete, the buffer is handed to the client in a single pass
+// producing the exact same reply as replying directly
+typedef struct {
+	char *data;  // recorded replies
+	size_t len;  // number of bytes in use
+	size_t cap;  // allocated size
+} ReplyBuffer;
+
+// initialize an empty buffer
+void ReplyBuffer_Init
+(
+	ReplyBuffer *buf  // buffer to initialize
+);
+
+// record RedisModule_ReplyWithArray
+void ReplyBuffer_ReplyWithArray
+(
+	ReplyBuffer *buf,  // buffer to write to
+	long len           // number of array elements
+);
+
+// record RedisModule_ReplyWithLongLong
+void ReplyBuffer_ReplyWithLongLong
+(
+	ReplyBuffer *buf,  // buffer to write to
+	long long ll       // value to reply with
+);
+
+// record RedisModule_ReplyWithStringBuffer
+void ReplyBuffer_ReplyWithStringBuffer
+(
+	ReplyBuffer *buf,  // buffer to write to
+	const char *str,   // string to reply with
+	size_t len         // string length
+);
+
+// record RedisModule_ReplyWithCString
+void ReplyBuffer_ReplyWithCString
+(
+	ReplyBuffer *buf,  // buffer to write to
+	const char *str    // NULL terminated string to reply with
+);
+
+// record RedisModule_ReplyWithNull
+void ReplyBuffer_ReplyWithNull
+(
+	ReplyBuffer *buf  // buffer to write to
+);
+
+// record the replies recorded by another buffer
+void ReplyBuffer_Append
+(
+	ReplyBuffer *buf,  // buffer to write to
+	const char *data,  // recorded replies
+	size_t len         // number of bytes to copy
+);
+
+// replay recorded replies into ctx and empty the buffer
+void ReplyBuffer_Flush
+(
+	ReplyBuffer *buf,    // buffer to replay
+	RedisModuleCtx *ctx  // context to reply to
+);
+
+// free buffer's internal storage
+void ReplyBuffer_Free
+(
+	ReplyBuffer *buf  // buffer to free
+);
@@ -0,0 +1,183 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "result_cache.h"
+#include "RG.h"
+#include "../config.h"
+#include "../util/rmalloc.h"
+#include <string.h>
+
+struct ResultCacheEntry {
+	char *key;           // Query key.
+	uint64_t version;    // Graph version the reply was recorded against.
+	char *reply;         // Recorded reply.
+	size_t len;          // Reply length.
+	uint64_t row_count;  // Number of rows in the reply.
+	uint64_t last_use;   // Logical time of the most recent lookup.
+};
+
+// memory held by an entry, its key and reply
+static inline size_t _EntrySize(const ResultCacheEntry *entry) {
+	return sizeof(ResultCacheEntry) + strlen(entry->key) + entry->len;
+}
+
+static void _EntryFree(void *entry) {
+	ResultCacheEntry *e = entry;
+	rm_free(e->reply);
+	rm_free(e->key);
+	rm_free(e);
+}
+
+// removes entry from the cache and frees it
+static void _Evict(ResultCache *cache, ResultCacheEntry *entry) {
+	raxRemove(cache->lookup, (unsigned char *)entry->key, strlen(entry->key), NULL);
+	cache->usage -= _EntrySize(entry);
+	_EntryFree(entry);
+}
+
+// evicts least recently used entries until the cache fits within capacity
+static void _EvictToCapacity(ResultCache *cache, size_t capacity) {
+	while(cache->usage > capacity) {
+		ResultCacheEntry *lru = NULL;
+		raxIterator it;
+		raxStart(&it, cache->lookup);
+		raxSeek(&it, "^", NULL, 0);
+		while(raxNext(&it)) {
+			ResultCacheEntry *entry = it.data;
+			if(lru == NULL || entry->last_use < lru->last_use) lru = entry;
+		}
+		raxStop(&it);
+
+		if(lru == NULL) break;
+		_Evict(cache, lru);
+	}
+}
+
+// evicts all entries at once
+static void _EvictAll(ResultCache *cache) {
+	if(raxSize(cache->lookup) == 0) return;
+	raxFreeWithCallback(cache->lookup, _EntryFree);
+	cache->lookup = raxNew();
+	cache->usage = 0;
+}
+
+ResultCache *ResultCache_New(void) {
+	ResultCache *cache = rm_malloc(sizeof(ResultCache));
+	cache->lookup = raxNew();
+	cache->usage = 0;
+	cache->clock = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+	int res = pthread_mutex_init(&cache->mutex, NULL);
+	UNUSED(res);
+	ASSERT(res == 0);
+	return cache;
+}
+
+bool ResultCache_Enabled(void) {
+	uint64_t capacity;
+	Config_Option_get(Config_RESULT_CACHE_CAPACITY, &capacity);
+	return capacity > 0;
+}
+
+bool ResultCache_Get(ResultCache *cache, const char *key, uint64_t version,
+		ReplyBuffer *reply, uint64_t *row_count) {
+	ASSERT(cache != NULL && key != NULL);
+	ASSERT(reply != NULL && row_count != NULL);
+
+	bool found = false;
+	pthread_mutex_lock(&cache->mutex);
+
+	ResultCacheEntry *entry = raxFind(cache->lookup, (unsigned char *)key, strlen(key));
+	if(entry != raxNotFound && entry->version != version) {
+		// the graph was modified since the reply was recorded
+		_Evict(cache, entry);
+	} else if(entry != raxNotFound) {
+		entry->last_use = ++cache->clock;
+		ReplyBuffer_Append(reply, entry->reply, entry->len);
+		*row_count = entry->row_count;
+		found = true;
+	}
+
+	if(found) cache->hits++;
+	else cache->misses++;
+
+	pthread_mutex_unlock(&cache->mutex);
+	return found;
+}
+
+void ResultCache_Insert(ResultCache *cache, const char *key, uint64_t version,
+		const char *reply, size_t len, uint64_t row_count) {
+	ASSERT(cache != NULL && key != NULL && reply != NULL);
+
+	uint64_t capacity;
+	Config_Option_get(Config_RESULT_CACHE_CAPACITY, &capacity);
+
+	ResultCacheEntry *entry = rm_malloc(sizeof(ResultCacheEntry));
+	entry->key = rm_strdup(key);
+	entry->version = version;
+	entry->len = len;
+	entry->row_count = row_count;
+
+	// replies exceeding the capacity aren't copied
+	size_t size = _EntrySize(entry);
+	if(size > capacity) {
+		rm_free(entry->key);
+		rm_free(entry);
+		return;
+	}
+
+	entry->reply = rm_malloc(len);
+	memcpy(entry->reply, reply, len);
+
+	pthread_mutex_lock(&cache->mutex);
+
+	// replace a reply recorded concurrently or against another version
+	ResultCacheEntry *existing = raxFind(cache->lookup, (unsigned char *)key, strlen(key));
+	if(existing != raxNotFound) _Evict(cache, existing);
+
+	// make room for the reply
+	_EvictToCapacity(cache, capacity - size);
+	entry->last_use = ++cache->clock;
+	raxInsert(cache->lookup, (unsigned char *)key, strlen(key), entry, NULL);
+	cache->usage += size;
+
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void ResultCache_Clear(ResultCache *cache) {
+	ASSERT(cache != NULL);
+
+	pthread_mutex_lock(&cache->mutex);
+	_EvictAll(cache);
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void ResultCache_GetStats(ResultCache *cache, uint64_t *hits, uint64_t *misses) {
+	ASSERT(cache != NULL && hits != NULL && misses != NULL);
+
+	pthread_mutex_lock(&cache->mutex);
+	*hits = cache->hits;
+	*misses = cache->misses;
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+size_t ResultCache_MemoryUsage(ResultCache *cache) {
+	ASSERT(cache != NULL);
+
+	pthread_mutex_lock(&cache->mutex);
+	size_t usage = cache->usage;
+	pthread_mutex_unlock(&cache->mutex);
+	return usage;
+}
+
+void ResultCache_Free(ResultCache *cache) {
+	if(cache == NULL) return;
+
+	raxFreeWithCallback(cache->lookup, _EntryFree);
+	pthread_mutex_destroy(&cache->mutex);
+	rm_free(cache);
+}
@@ -0,0 +1,86 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "rax.h"
+#include "reply_buffer.h"
+
+// Serialized replies of read-only queries shared across executions.
+// Replies are keyed by their query string, parameters included, and recorded
+// against a specific graph version, a reply of an outdated version is never
+// returned. The cache's memory is bounded by RESULT_CACHE_CAPACITY, least
+// recently used replies are evicted first.
+// A cached reply holds the result-set header and rows, statistics are
+// reported anew by each execution served from the cache.
+
+typedef struct ResultCacheEntry ResultCacheEntry;
+
+typedef struct {
+	rax *lookup;            // Mapping between keys and entries.
+	size_t usage;           // Memory held by cached replies, in bytes.
+	uint64_t clock;         // Logical time, advanced by each lookup.
+	uint64_t hits;          // Number of lookups which found their key.
+	uint64_t misses;        // Number of lookups which missed their key.
+	pthread_mutex_t mutex;  // Serializes cache access.
+} ResultCache;
+
+// create a new, empty result cache
+ResultCache *ResultCache_New(void);
+
+// returns true if replies should be cached
+bool ResultCache_Enabled(void);
+
+// appends the reply cached under key for graph version to 'reply'
+// returns false if missing
+bool ResultCache_Get
+(
+	ResultCache *cache,   // cache
+	const char *key,      // query key
+	uint64_t version,     // graph version
+	ReplyBuffer *reply,   // [output] buffer to append the cached reply to
+	uint64_t *row_count   // [output] number of rows in the cached reply
+);
+
+// caches a copy of 'len' bytes of 'reply' under key for graph version
+void ResultCache_Insert
+(
+	ResultCache *cache,   // cache
+	const char *key,      // query key
+	uint64_t version,     // graph version
+	const char *reply,    // recorded reply
+	size_t len,           // reply length
+	uint64_t row_count    // number of rows in the reply
+);
+
+// evicts all cached replies
+void ResultCache_Clear
+(
+	ResultCache *cache
+);
+
+// reports the number of lookups which found and missed their key
+void ResultCache_GetStats
+(
+	ResultCache *cache,  // cache
+	uint64_t *hits,      // [output] number of hits
+	uint64_t *misses     // [output] number of misses
+);
+
+// returns the memory held by cached replies, in bytes
+size_t ResultCache_MemoryUsage
+(
+	ResultCache *cache
+);
+
+// frees the cache
+void ResultCache_Free
+(
+	ResultCache *cache
+);
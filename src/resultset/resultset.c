@@ -8,16 +8,21 @@
 #include "RG.h"
 #include "../value.h"
 #include "../errors.h"
+#include "../config.h"
 #include "../util/arr.h"
 #include "../query_ctx.h"
 #include "../util/rmalloc.h"
 #include "../grouping/group_cache.h"
 
-static void _ResultSet_ReplayStats(RedisModuleCtx *ctx, ResultSet *set) {
+static void _ResultSet_ReplayStats(ReplyBuffer *reply, ResultSet *set) {
 	char buff[512] = {0};
 	size_t resultset_size = 2; // execution time, cached
 	int buflen;
 
+	bool report_phases;
+	Config_Option_get(Config_REPORT_QUERY_PHASES, &report_phases);
+	if(report_phases) resultset_size++;
+
 	if(set->stats.labels_added > 0) resultset_size++;
 	if(set->stats.nodes_created > 0) resultset_size++;
 	if(set->stats.properties_set > 0) resultset_size++;
@@ -26,54 +31,72 @@ static void _ResultSet_ReplayStats(RedisModuleCtx *ctx, ResultSet *set) {
 	if(set->stats.relationships_deleted > 0) resultset_size++;
 	if(set->stats.indices_created != STAT_NOT_SET) resultset_size++;
 	if(set->stats.indices_deleted != STAT_NOT_SET) resultset_size++;
+	if(set->stats.sample_rate < 1) resultset_size++;
+	if(set->stats.sample_error > 0) resultset_size++;
 
-	RedisModule_ReplyWithArray(ctx, resultset_size);
+	ReplyBuffer_ReplyWithArray(reply, resultset_size);
 
 	if(set->stats.labels_added > 0) {
 		buflen = sprintf(buff, "Labels added: %d", set->stats.labels_added);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.nodes_created > 0) {
 		buflen = sprintf(buff, "Nodes created: %d", set->stats.nodes_created);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.properties_set > 0) {
 		buflen = sprintf(buff, "Properties set: %d", set->stats.properties_set);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.relationships_created > 0) {
 		buflen = sprintf(buff, "Relationships created: %d", set->stats.relationships_created);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.nodes_deleted > 0) {
 		buflen = sprintf(buff, "Nodes deleted: %d", set->stats.nodes_deleted);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.relationships_deleted > 0) {
 		buflen = sprintf(buff, "Relationships deleted: %d", set->stats.relationships_deleted);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.indices_created != STAT_NOT_SET) {
 		buflen = sprintf(buff, "Indices created: %d", set->stats.indices_created);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	if(set->stats.indices_deleted != STAT_NOT_SET) {
 		buflen = sprintf(buff, "Indices deleted: %d", set->stats.indices_deleted);
-		RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
 	}
 
 	buflen = sprintf(buff, "Cached execution: %d", set->stats.cached ? 1 : 0);
-	RedisModule_ReplyWithStringBuffer(ctx, (const char *)buff, buflen);
+	ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
+
+	if(set->stats.sample_rate < 1) {
+		buflen = sprintf(buff, "Sample rate: %f", set->stats.sample_rate);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
+	}
+
+	if(set->stats.sample_error > 0) {
+		buflen = sprintf(buff, "Sample margin of error: %f", set->stats.sample_error);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
+	}
 
 	// Emit query execution time.
-	ResultSet_ReportQueryRuntime(ctx);
+	ResultSet_ReportQueryRuntime(reply);
+
+	if(report_phases) {
+		buflen = sprintf(buff, "Query phases: ");
+		buflen += QueryCtx_PhasesToString(buff + buflen, sizeof(buff) - buflen);
+		ReplyBuffer_ReplyWithStringBuffer(reply, (const char *)buff, buflen);
+	}
 }
 
 /* Map each column to a record index
@@ -90,15 +113,17 @@ void ResultSet_MapProjection(ResultSet *set, const Record r) {
 	}
 }
 
-static void _ResultSet_ReplyWithPreamble(ResultSet *set) {
+static void _ResultSet_ReplyWithPreamble(ResultSet *set, bool with_cursor) {
+	// a cursor id trails the statistics
+	uint extra = (with_cursor) ? 1 : 0;
 	if(set->column_count > 0) {
 		// prepare a response containing a header, records, and statistics
-		RedisModule_ReplyWithArray(set->ctx, 3);
+		ReplyBuffer_ReplyWithArray(&set->reply, 3 + extra);
 		// emit the table header using the appropriate formatter
-		set->formatter->EmitHeader(set->ctx, set->columns, set->columns_record_map);
+		set->formatter->EmitHeader(&set->reply, set->columns, set->columns_record_map);
 	} else {
 		// prepare a response containing only statistics
-		RedisModule_ReplyWithArray(set->ctx, 1);
+		ReplyBuffer_ReplyWithArray(&set->reply, 1 + extra);
 	}
 }
 
@@ -132,6 +157,10 @@ ResultSet *NewResultSet(RedisModuleCtx *ctx, ResultSetFormatterType format) {
 	set->column_count = 0;
 	set->columns_record_map = NULL;
 	set->cells = DataBlock_New(32, sizeof(SIValue), NULL);
+	ReplyBuffer_Init(&set->reply);
+	set->rows_len = 0;
+	set->cached_result = false;
+	set->cached_row_count = 0;
 
 	set->stats.labels_added = 0;
 	set->stats.nodes_created = 0;
@@ -142,6 +171,8 @@ ResultSet *NewResultSet(RedisModuleCtx *ctx, ResultSetFormatterType format) {
 	set->stats.indices_created = STAT_NOT_SET;
 	set->stats.indices_deleted = STAT_NOT_SET;
 	set->stats.cached = false;
+	set->stats.sample_rate = 1;
+	set->stats.sample_error = 0;
 
 	_ResultSet_SetColumns(set);
 
@@ -150,16 +181,24 @@ ResultSet *NewResultSet(RedisModuleCtx *ctx, ResultSetFormatterType format) {
 
 uint64_t ResultSet_RowCount(const ResultSet *set) {
 	ASSERT(set != NULL);
+	if(set->cached_result) return set->cached_row_count;
 	if(set->column_count == 0) return 0;
 	return DataBlock_ItemCount(set->cells) / set->column_count;
 }
 
 void _ResultSet_ConsumeRecord(ResultSet *set, Record r) {
+	Arena *arena = QueryCtx_GetArena();
 	for(int i = 0; i < set->column_count; i++) {
 		int idx = set->columns_record_map[i];
 		SIValue *cell = DataBlock_AllocateItem(set->cells, NULL);
 		*cell = Record_Get(r, idx);
-		SIValue_Persist(cell);
+		if(cell->allocation == M_VOLATILE && SI_TYPE(*cell) == T_STRING) {
+			// copy borrowed strings into the query's arena
+			// rather than allocating each of them individually
+			*cell = SI_ConstStringVal(Arena_Strdup(arena, cell->stringval));
+		} else {
+			SIValue_Persist(cell);
+		}
 	}
 
 	// remove entry from record in a second pass
@@ -211,7 +250,21 @@ void ResultSet_CachedExecution(ResultSet *set) {
 	set->stats.cached = true;
 }
 
-void ResultSet_Reply(ResultSet *set) {
+void ResultSet_CachedResult(ResultSet *set, uint64_t row_count) {
+	ASSERT(set != NULL);
+	set->cached_result = true;
+	set->cached_row_count = row_count;
+	set->stats.cached = true;
+}
+
+const char *ResultSet_RowsReply(const ResultSet *set, size_t *len) {
+	ASSERT(set != NULL && len != NULL);
+	*len = set->rows_len;
+	return set->reply.data;
+}
+
+static void _ResultSet_Reply(ResultSet *set, bool with_cursor,
+		uint64_t cursor_id) {
 	uint64_t row_count = ResultSet_RowCount(set);
 	/* Check to see if we've encountered a run-time error.
 	 * If so, emit it as the only response. */
@@ -220,12 +273,22 @@ void ResultSet_Reply(ResultSet *set) {
 		return;
 	}
 
+	// header and rows served by the result cache are already recorded
+	if(set->cached_result) goto stats;
+
 	// Set up the results array and emit the header if the query requires one.
-	_ResultSet_ReplyWithPreamble(set);
+	_ResultSet_ReplyWithPreamble(set, with_cursor);
 
 	// Emit the records cached in the result set.
-	if(set->column_count > 0) {
-		RedisModule_ReplyWithArray(set->ctx, row_count);
+	if(set->column_count > 0 && set->formatter->EmitRows) {
+		// the formatter emits all rows at once
+		set->formatter->EmitRows(&set->reply, set->gc, set->cells, set->column_count);
+		uint64_t cells = DataBlock_ItemCount(set->cells);
+		for(uint64_t i = 0; i < cells; i++) {
+			SIValue_Free(*(SIValue *)DataBlock_GetItem(set->cells, i));
+		}
+	} else if(set->column_count > 0) {
+		ReplyBuffer_ReplyWithArray(&set->reply, row_count);
 		SIValue *row[set->column_count];
 		uint64_t cells = DataBlock_ItemCount(set->cells);
 		for(uint64_t i = 0; i < cells; i += set->column_count) {
@@ -233,22 +296,46 @@ void ResultSet_Reply(ResultSet *set) {
 				row[j] = DataBlock_GetItem(set->cells, i + j);
 			}
 
-			set->formatter->EmitRow(set->ctx, set->gc, row, set->column_count);
+			set->formatter->EmitRow(&set->reply, set->gc, row, set->column_count);
 
 			for(uint j = 0; j < set->column_count; j++) SIValue_Free(*row[j]);
 		}
 	}
 
-	_ResultSet_ReplayStats(set->ctx, set); // The last response is query statistics.
+stats:
+	set->rows_len = set->reply.len;
+	_ResultSet_ReplayStats(&set->reply, set); // The last response is query statistics.
+
+	if(with_cursor) {
+		ReplyBuffer_ReplyWithLongLong(&set->reply, cursor_id);
+
+		// emitted rows are discarded, the next batch starts out empty
+		DataBlock_Free(set->cells);
+		set->cells = DataBlock_New(32, sizeof(SIValue), NULL);
+		QueryCtx_ResetArena();
+	}
+}
+
+void ResultSet_Reply(ResultSet *set) {
+	_ResultSet_Reply(set, false, 0);
+}
+
+void ResultSet_ReplyWithCursor(ResultSet *set, uint64_t cursor_id) {
+	_ResultSet_Reply(set, true, cursor_id);
+}
+
+void ResultSet_Flush(ResultSet *set) {
+	ASSERT(set != NULL);
+	ReplyBuffer_Flush(&set->reply, set->ctx);
 }
 
 /* Report execution timing. */
-void ResultSet_ReportQueryRuntime(RedisModuleCtx *ctx) {
-	char *strElapsed;
+void ResultSet_ReportQueryRuntime(ReplyBuffer *reply) {
+	char buff[128];
 	double t = QueryCtx_GetExecutionTime();
-	asprintf(&strElapsed, "Query internal execution time: %.6f milliseconds", t);
-	RedisModule_ReplyWithStringBuffer(ctx, strElapsed, strlen(strElapsed));
-	free(strElapsed);
+	int buflen = snprintf(buff, sizeof(buff),
+			"Query internal execution time: %.6f milliseconds", t);
+	ReplyBuffer_ReplyWithStringBuffer(reply, buff, buflen);
 }
 
 void ResultSet_Free(ResultSet *set) {
@@ -257,6 +344,7 @@ void ResultSet_Free(ResultSet *set) {
 	if(set->columns) array_free(set->columns);
 	if(set->columns_record_map) rm_free(set->columns_record_map);
 	if(set->cells) DataBlock_Free(set->cells);
+	ReplyBuffer_Free(&set->reply);
 
 	rm_free(set);
 }
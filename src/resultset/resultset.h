@@ -10,6 +10,7 @@
 #include "../redismodule.h"
 #include "../execution_plan/record.h"
 #include "rax.h"
+#include "reply_buffer.h"
 #include "./formatters/resultset_formatters.h"
 
 #define RESULTSET_OK 1
@@ -26,6 +27,10 @@ typedef struct {
 	ResultSetStatistics stats;      /* ResultSet statistics. */
 	ResultSetFormatterType format;  /* Result-set format; compact/verbose/nop. */
 	ResultSetFormatter *formatter;  /* ResultSet data formatter. */
+	ReplyBuffer reply;              /* Serialized reply, pending hand over. */
+	size_t rows_len;                /* Length of the reply preceding its statistics. */
+	bool cached_result;             /* Header and rows were served by the result cache. */
+	uint64_t cached_row_count;      /* Number of rows served by the result cache. */
 } ResultSet;
 
 void ResultSet_MapProjection(ResultSet *set, const Record r);
@@ -43,9 +48,28 @@ void ResultSet_IndexDeleted(ResultSet *set, int status_code);
 
 void ResultSet_CachedExecution(ResultSet *set);
 
+// marks the header and rows as served by the result cache
+// the cached reply is expected to be recorded in the set's reply buffer
+// only statistics are added by ResultSet_Reply
+void ResultSet_CachedResult(ResultSet *set, uint64_t row_count);
+
+// returns the serialized header and rows of a replied result-set
+// excluding its statistics, to be cached by the result cache
+const char *ResultSet_RowsReply(const ResultSet *set, size_t *len);
+
+// serializes the reply into the result-set's reply buffer
+// nothing is sent to the client until ResultSet_Flush is called
 void ResultSet_Reply(ResultSet *set);
 
-void ResultSet_ReportQueryRuntime(RedisModuleCtx *ctx);
+// serializes the rows accumulated since the previous batch
+// followed by 'cursor_id', 0 once the result-set is exhausted
+void ResultSet_ReplyWithCursor(ResultSet *set, uint64_t cursor_id);
+
+// hands the serialized reply over to the client in a single pass
+// serialized entities are copied, the graph lock need not be held
+void ResultSet_Flush(ResultSet *set);
+
+void ResultSet_ReportQueryRuntime(ReplyBuffer *reply);
 
 void ResultSet_Free(ResultSet *set);
 
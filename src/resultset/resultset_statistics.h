@@ -19,6 +19,8 @@ typedef struct {
 	int indices_created;        // number of indices created
 	int indices_deleted;        // number of indices deleted
 	bool cached;                // indication for a cached query execution
+	double sample_rate;         // fraction of the graph scanned, 1 unless sampled
+	double sample_error;        // relative 95% margin of error of sampled counts
 } ResultSetStatistics;
 
 // Checks to see if resultset-statistics indicate that a modification was made
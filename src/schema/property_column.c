@@ -0,0 +1,65 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "property_column.h"
+#include "../RG.h"
+#include "../util/rmalloc.h"
+
+PropertyColumn *PropertyColumn_New(const Graph *g, int label, Attribute_ID attr) {
+	ASSERT(g != NULL);
+	ASSERT(label != GRAPH_NO_LABEL);
+
+	uint64_t len = Graph_RequiredMatrixDim(g);
+	uint64_t nwords = (len + 63) / 64;
+
+	PropertyColumn *c = rm_malloc(sizeof(PropertyColumn));
+	c->len = len;
+	c->values = rm_malloc(sizeof(SIValue) * MAX(len, 1));
+	// all slots start out as missing
+	c->nulls = rm_malloc(sizeof(uint64_t) * MAX(nwords, 1));
+	memset(c->nulls, 0xFF, sizeof(uint64_t) * MAX(nwords, 1));
+
+	// scan label matrix, materialize attribute of each labeled node
+	bool depleted = false;
+	GrB_Index id;
+	GxB_MatrixTupleIter *iter;
+	GrB_Matrix L = Graph_GetLabelMatrix(g, label);
+	GxB_MatrixTupleIter_new(&iter, L);
+
+	while(true) {
+		GxB_MatrixTupleIter_next(iter, NULL, &id, &depleted);
+		if(depleted) break;
+		if(id >= len) continue;
+
+		Node n;
+		if(!Graph_GetNode(g, id, &n)) continue;
+
+		SIValue v = GraphEntity_GetProperty((GraphEntity *)&n, attr);
+		if(SI_TYPE(v) == T_NULL) continue;
+
+		c->values[id] = v;
+		c->nulls[id >> 6] &= ~(1ULL << (id & 63));
+	}
+
+	GxB_MatrixTupleIter_free(iter);
+	return c;
+}
+
+size_t PropertyColumn_MemoryUsage(const PropertyColumn *c) {
+	ASSERT(c != NULL);
+	// values are shallow copies, owned by their entities
+	uint64_t nwords = (c->len + 63) / 64;
+	return sizeof(PropertyColumn) +
+		   sizeof(SIValue) * MAX(c->len, 1) +
+		   sizeof(uint64_t) * MAX(nwords, 1);
+}
+
+void PropertyColumn_Free(PropertyColumn *c) {
+	ASSERT(c != NULL);
+	rm_free(c->values);
+	rm_free(c->nulls);
+	rm_free(c);
+}
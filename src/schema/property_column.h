@@ -0,0 +1,57 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../value.h"
+#include "../graph/graph.h"
+#include "../graph/entities/graph_entity.h"
+
+/* PropertyColumn is a columnar copy of a single attribute
+ * of every node carrying a specific label.
+ * values are kept in a dense array indexed by node ID, alongside a bitmap
+ * marking nodes which lack the attribute, such that scanning an attribute
+ * across a label streams contiguous memory, instead of chasing an
+ * entity pointer and scanning its property bag for every node.
+ *
+ * values are shallow copies of the entities' values, a column is only valid
+ * as long as the graph is not modified. */
+typedef struct {
+	uint64_t len;        // Number of slots, node IDs [0, len).
+	uint64_t *nulls;     // Bitmap, bit i is set if node i lacks the attribute.
+	SIValue *values;     // Dense array of values, indexed by node ID.
+} PropertyColumn;
+
+// Build a column of attribute 'attr' over all nodes labeled 'label'.
+PropertyColumn *PropertyColumn_New
+(
+	const Graph *g,      // Graph to scan.
+	int label,           // Label matrix to scan.
+	Attribute_ID attr    // Attribute to materialize.
+);
+
+// Retrieves the value of node 'id', returns PROPERTY_NOTFOUND if missing.
+static inline SIValue *PropertyColumn_Get
+(
+	const PropertyColumn *c,
+	NodeID id
+) {
+	if(id >= c->len) return PROPERTY_NOTFOUND;
+	if(c->nulls[id >> 6] & (1ULL << (id & 63))) return PROPERTY_NOTFOUND;
+	return c->values + id;
+}
+
+// Returns the number of bytes held by the column.
+size_t PropertyColumn_MemoryUsage
+(
+	const PropertyColumn *c
+);
+
+// Free column.
+void PropertyColumn_Free
+(
+	PropertyColumn *c
+);
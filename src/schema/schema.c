@@ -10,12 +10,23 @@
 #include "../util/rmalloc.h"
 #include "../graph/graphcontext.h"
 
-Schema *Schema_New(const char *name, int id) {
+Schema *Schema_New(const char *name, int id, SchemaType type) {
 	Schema *schema = rm_malloc(sizeof(Schema));
 	schema->id = id;
+	schema->type = type;
 	schema->index = NULL;
 	schema->fulltextIdx = NULL;
+	schema->vectorIdx = NULL;
+	schema->constraints = NULL;
 	schema->name = rm_strdup(name);
+	memset(schema->columns, 0, sizeof(schema->columns));
+	memset(schema->column_hits, 0, sizeof(schema->column_hits));
+	schema->entity_count = 0;
+	schema->weight_attr = ATTRIBUTE_NOTFOUND;
+	schema->weights = NULL;
+	int res = pthread_mutex_init(&schema->column_lock, NULL);
+	UNUSED(res);
+	ASSERT(res == 0);
 	return schema;
 }
 
@@ -26,7 +37,7 @@ const char *Schema_GetName(const Schema *s) {
 
 bool Schema_HasIndices(const Schema *s) {
 	ASSERT(s);
-	return (s->fulltextIdx || s->index);
+	return (s->fulltextIdx || s->index || s->vectorIdx || s->constraints);
 }
 
 unsigned short Schema_IndexCount(const Schema *s) {
@@ -35,6 +46,8 @@ unsigned short Schema_IndexCount(const Schema *s) {
 
 	if(s->index) n += Index_FieldsCount(s->index);
 	if(s->fulltextIdx) n += Index_FieldsCount(s->fulltextIdx);
+	if(s->vectorIdx) n += Index_FieldsCount(s->vectorIdx);
+	if(s->index) n += array_len(Index_GetCompositeIndices(s->index));
 
 	return n;
 }
@@ -46,9 +59,19 @@ Index *Schema_GetIndex(const Schema *s, Attribute_ID *attribute_id, IndexType ty
 		idx = s->index;
 	} else if(type ==  IDX_FULLTEXT) {
 		idx = s->fulltextIdx;
+	} else if(type == IDX_VECTOR) {
+		idx = s->vectorIdx;
+	} else if(attribute_id) {
+		// If type is unspecified, use the first index holding the attribute.
+		Index *indices[3] = {s->index, s->fulltextIdx, s->vectorIdx};
+		for(int i = 0; i < 3 && !idx; i++) {
+			if(indices[i] && Index_ContainsAttribute(indices[i], *attribute_id)) {
+				idx = indices[i];
+			}
+		}
 	} else {
 		// If type is unspecified, use the first index that exists.
-		idx = s->index ? : s->fulltextIdx;
+		idx = s->index ? : (s->fulltextIdx ? : s->vectorIdx);
 	}
 
 	if(!idx) return NULL;
@@ -65,6 +88,7 @@ int Schema_AddIndex(Index **idx, Schema *s, const char *field, IndexType type) {
 	ASSERT(field);
 
 	*idx = NULL;
+	if(s->type == SCHEMA_EDGE && type != IDX_EXACT_MATCH) return INDEX_FAIL;
 	Index *_idx = Schema_GetIndex(s, NULL, type);
 
 	// Index exists, make sure attribute isn't already indexed.
@@ -74,8 +98,11 @@ int Schema_AddIndex(Index **idx, Schema *s, const char *field, IndexType type) {
 		if(Index_ContainsAttribute(_idx, fieldID)) return INDEX_FAIL;
 	} else {
 		// Index doesn't exist, create it.
-		_idx = Index_New(s->name, type);
+		GraphEntityType entity_type = (s->type == SCHEMA_NODE) ? GETYPE_NODE :
+			GETYPE_EDGE;
+		_idx = Index_New(s->name, type, entity_type);
 		if(type == IDX_FULLTEXT) s->fulltextIdx = _idx;
+		else if(type == IDX_VECTOR) s->vectorIdx = _idx;
 		else s->index = _idx;
 	}
 
@@ -85,6 +112,36 @@ int Schema_AddIndex(Index **idx, Schema *s, const char *field, IndexType type) {
 	return INDEX_OK;
 }
 
+int Schema_AddCompositeIndex(Index **idx, Schema *s, const char **fields, uint count) {
+	ASSERT(fields != NULL);
+
+	*idx = NULL;
+	if(s->type != SCHEMA_NODE) return INDEX_FAIL;
+	if(count < 2 || count > COMPOSITE_INDEX_MAX_FIELDS) return INDEX_FAIL;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Attribute_ID attributes[count];
+	for(uint i = 0; i < count; i++) {
+		attributes[i] = GraphContext_FindOrAddAttribute(gc, fields[i]);
+		// key columns must be distinct
+		for(uint j = 0; j < i; j++) {
+			if(attributes[j] == attributes[i]) return INDEX_FAIL;
+		}
+	}
+
+	// make sure each key field is indexed
+	Index *_idx = NULL;
+	for(uint i = 0; i < count; i++) {
+		Schema_AddIndex(&_idx, s, fields[i], IDX_EXACT_MATCH);
+	}
+	_idx = Schema_GetIndex(s, NULL, IDX_EXACT_MATCH);
+	ASSERT(_idx != NULL);
+
+	int res = Index_AddComposite(_idx, attributes, count);
+	*idx = _idx;
+	return res;
+}
+
 static int _Schema_RemoveExactMatchIndex(Schema *s, const char *field) {
 	ASSERT(field != NULL);
 	GraphContext *gc = QueryCtx_GetGraphCtx();
@@ -116,10 +173,22 @@ static int _Schema_RemoveFullTextIndex(Schema *s) {
 	return INDEX_OK;
 }
 
+static int _Schema_RemoveVectorIndex(Schema *s) {
+	Index *idx = Schema_GetIndex(s, NULL, IDX_VECTOR);
+	if(idx == NULL) return INDEX_FAIL;
+
+	Index_Free(idx);
+	s->vectorIdx = NULL;
+
+	return INDEX_OK;
+}
+
 int Schema_RemoveIndex(Schema *s, const char *field, IndexType type) {
 	switch(type) {
 	case IDX_FULLTEXT:
 		return _Schema_RemoveFullTextIndex(s);
+	case IDX_VECTOR:
+		return _Schema_RemoveVectorIndex(s);
 	case IDX_EXACT_MATCH:
 		return _Schema_RemoveExactMatchIndex(s, field);
 	default:
@@ -127,24 +196,283 @@ int Schema_RemoveIndex(Schema *s, const char *field, IndexType type) {
 	}
 }
 
+// record the constrained value of each of the schema's nodes
+// returns false if two nodes hold the same value
+static bool _Schema_PopulateConstraint(const Schema *s, const Graph *g,
+		UniqueConstraint *uc) {
+	// label matrix is yet to be introduced, e.g. while decoding
+	if(g == NULL || s->id >= Graph_LabelTypeCount(g)) return true;
+
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, Graph_GetLabelMatrix(g, s->id));
+
+	NodeID id;
+	bool unique = true;
+	bool depleted = false;
+	while(unique) {
+		GxB_MatrixTupleIter_next(iter, NULL, &id, &depleted);
+		if(depleted) break;
+		Node n = GE_NEW_NODE();
+		Graph_GetNode(g, id, &n);
+		SIValue v = GraphEntity_GetProperty((GraphEntity *)&n, uc->attribute);
+		unique = UniqueConstraint_Accepts(uc, id, v);
+		if(unique) UniqueConstraint_Insert(uc, id, v);
+	}
+	GxB_MatrixTupleIter_free(iter);
+
+	return unique;
+}
+
+int Schema_AddConstraint(UniqueConstraint **uc, Schema *s, const char *field) {
+	ASSERT(uc != NULL && field != NULL);
+
+	*uc = NULL;
+	if(s->type != SCHEMA_NODE) return INDEX_FAIL;
+
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Attribute_ID attr = GraphContext_FindOrAddAttribute(gc, field);
+	if(Schema_GetConstraint(s, attr) != NULL) return INDEX_FAIL;
+
+	// existing nodes must hold distinct values
+	UniqueConstraint *_uc = UniqueConstraint_New(attr);
+	if(!_Schema_PopulateConstraint(s, gc->g, _uc)) {
+		UniqueConstraint_Free(_uc);
+		return INDEX_FAIL;
+	}
+
+	if(s->constraints == NULL) s->constraints = array_new(UniqueConstraint *, 1);
+	s->constraints = array_append(s->constraints, _uc);
+
+	*uc = _uc;
+	return INDEX_OK;
+}
+
+void Schema_PopulateConstraints(Schema *s, const Graph *g) {
+	ASSERT(s != NULL && g != NULL);
+	if(s->constraints == NULL) return;
+
+	uint count = array_len(s->constraints);
+	for(uint i = 0; i < count; i++) {
+		UniqueConstraint_Clear(s->constraints[i]);
+		bool unique = _Schema_PopulateConstraint(s, g, s->constraints[i]);
+		UNUSED(unique);
+		ASSERT(unique);
+	}
+}
+
+UniqueConstraint *Schema_GetConstraint(const Schema *s, Attribute_ID attribute_id) {
+	ASSERT(s != NULL);
+	if(s->constraints == NULL) return NULL;
+
+	uint count = array_len(s->constraints);
+	for(uint i = 0; i < count; i++) {
+		if(s->constraints[i]->attribute == attribute_id) return s->constraints[i];
+	}
+	return NULL;
+}
+
+int Schema_RemoveConstraint(Schema *s, const char *field) {
+	ASSERT(field != NULL);
+	GraphContext *gc = QueryCtx_GetGraphCtx();
+	Attribute_ID attribute_id = GraphContext_GetAttributeID(gc, field);
+	if(attribute_id == ATTRIBUTE_NOTFOUND) return INDEX_FAIL;
+
+	UniqueConstraint *uc = Schema_GetConstraint(s, attribute_id);
+	if(uc == NULL) return INDEX_FAIL;
+
+	uint count = array_len(s->constraints);
+	for(uint i = 0; i < count; i++) {
+		if(s->constraints[i] != uc) continue;
+		array_del_fast(s->constraints, i);
+		break;
+	}
+	UniqueConstraint_Free(uc);
+
+	// if no constraints remain, remove them from schema
+	if(array_len(s->constraints) == 0) {
+		array_free(s->constraints);
+		s->constraints = NULL;
+	}
+
+	return INDEX_OK;
+}
+
+UniqueConstraint *Schema_ConstraintViolation(const Schema *s, NodeID id,
+		Attribute_ID attribute_id, SIValue v) {
+	if(s == NULL || s->constraints == NULL) return NULL;
+
+	UniqueConstraint *uc = Schema_GetConstraint(s, attribute_id);
+	if(uc == NULL || UniqueConstraint_Accepts(uc, id, v)) return NULL;
+	return uc;
+}
+
 // Index node under all schema indices.
 void Schema_AddNodeToIndices(const Schema *s, const Node *n) {
 	if(!s) return;
 	Index *idx = NULL;
 
+	if(s->constraints) {
+		uint count = array_len(s->constraints);
+		for(uint i = 0; i < count; i++) {
+			UniqueConstraint *uc = s->constraints[i];
+			SIValue v = GraphEntity_GetProperty((GraphEntity *)n, uc->attribute);
+			UniqueConstraint_Insert(uc, ENTITY_GET_ID(n), v);
+		}
+	}
+
 	idx = s->fulltextIdx;
 	if(idx) Index_IndexNode(idx, n);
 
 	idx = s->index;
 	if(idx) Index_IndexNode(idx, n);
+
+	idx = s->vectorIdx;
+	if(idx) Index_IndexNode(idx, n);
+}
+
+// Index edge under relationship schema index.
+void Schema_AddEdgeToIndices(const Schema *s, const Edge *e) {
+	if(!s || !s->index) return;
+	ASSERT(s->type == SCHEMA_EDGE);
+	Index_IndexEdge(s->index, e);
+}
+
+void Schema_RemoveNodeFromIndices(const Schema *s, NodeID id) {
+	if(!s) return;
+
+	if(s->constraints) {
+		uint count = array_len(s->constraints);
+		for(uint i = 0; i < count; i++) UniqueConstraint_Remove(s->constraints[i], id);
+	}
+
+	if(s->fulltextIdx) Index_RemoveNode(s->fulltextIdx, id);
+	if(s->index) Index_RemoveNode(s->index, id);
+	if(s->vectorIdx) Index_RemoveNode(s->vectorIdx, id);
+}
+
+void Schema_RemoveEdgeFromIndices(const Schema *s, const Edge *e) {
+	if(!s || !s->index) return;
+	ASSERT(s->type == SCHEMA_EDGE);
+	Index_RemoveEdge(s->index, e);
+}
+
+SIValue *Schema_GetColumnValue(Schema *s, const Graph *g, Attribute_ID attr, NodeID id) {
+	ASSERT(s != NULL && g != NULL);
+
+	if(attr >= SCHEMA_COLUMN_CAP) return NULL;
+
+	PropertyColumn *c = __atomic_load_n(&s->columns[attr], __ATOMIC_ACQUIRE);
+	if(c) return PropertyColumn_Get(c, id);
+
+	// decide if attribute is scanned often enough to justify a column
+	// recheck label size once every 1024 accesses
+	uint64_t hits = __atomic_add_fetch(&s->column_hits[attr], 1, __ATOMIC_RELAXED);
+	if((hits & 1023) != 0) return NULL;
+	if(hits < Graph_LabeledNodeCount(g, s->id)) return NULL;
+
+	pthread_mutex_lock(&s->column_lock);
+	{
+		// another thread might have built the column
+		c = s->columns[attr];
+		if(c == NULL) {
+			c = PropertyColumn_New(g, s->id, attr);
+			__atomic_store_n(&s->columns[attr], c, __ATOMIC_RELEASE);
+		}
+	}
+	pthread_mutex_unlock(&s->column_lock);
+
+	return PropertyColumn_Get(c, id);
+}
+
+void Schema_SetWeightAttribute(Schema *s, Attribute_ID attr) {
+	ASSERT(s != NULL);
+	ASSERT(s->type == SCHEMA_EDGE);
+
+	s->weight_attr = attr;
+	Schema_DropWeights(s);
+}
+
+const WeightMatrix *Schema_GetWeights(Schema *s, const Graph *g) {
+	ASSERT(s != NULL && g != NULL);
+
+	if(s->weight_attr == ATTRIBUTE_NOTFOUND) return NULL;
+	// writers modify the graph while holding the write lock
+	if(g->_writelocked) return NULL;
+
+	WeightMatrix *w;
+	pthread_mutex_lock(&s->column_lock);
+	{
+		// writers drop the matrices while modifying the graph,
+		// changes made otherwise are detected by the write epoch,
+		// readers of an older epoch released the read lock before the graph
+		// was modified, no other thread references stale matrices
+		w = s->weights;
+		if(w != NULL && w->epoch != Graph_WriteEpoch(g)) {
+			WeightMatrix_Free(w);
+			w = NULL;
+		}
+		if(w == NULL) {
+			w = WeightMatrix_New(g, s->id, s->weight_attr);
+			__atomic_store_n(&s->weights, w, __ATOMIC_RELEASE);
+		}
+	}
+	pthread_mutex_unlock(&s->column_lock);
+
+	return w;
+}
+
+size_t Schema_ColumnsMemoryUsage(const Schema *s) {
+	ASSERT(s != NULL);
+
+	size_t usage = 0;
+	for(uint i = 0; i < SCHEMA_COLUMN_CAP; i++) {
+		PropertyColumn *c = __atomic_load_n(&s->columns[i], __ATOMIC_ACQUIRE);
+		if(c) usage += PropertyColumn_MemoryUsage(c);
+	}
+
+	WeightMatrix *w = __atomic_load_n(&s->weights, __ATOMIC_ACQUIRE);
+	if(w) usage += WeightMatrix_MemoryUsage(w);
+
+	return usage;
+}
+
+void Schema_DropColumns(Schema *s) {
+	ASSERT(s != NULL);
+
+	for(uint i = 0; i < SCHEMA_COLUMN_CAP; i++) {
+		s->column_hits[i] = 0;
+		if(s->columns[i] == NULL) continue;
+		PropertyColumn_Free(s->columns[i]);
+		s->columns[i] = NULL;
+	}
+}
+
+void Schema_DropWeights(Schema *s) {
+	ASSERT(s != NULL);
+	if(s->weights == NULL) return;
+	WeightMatrix_Free(s->weights);
+	s->weights = NULL;
 }
 
 void Schema_Free(Schema *schema) {
 	if(schema->name) rm_free(schema->name);
 
+	// Free columns.
+	Schema_DropColumns(schema);
+	Schema_DropWeights(schema);
+	pthread_mutex_destroy(&schema->column_lock);
+
 	// Free indicies.
 	if(schema->index) Index_Free(schema->index);
 	if(schema->fulltextIdx) Index_Free(schema->fulltextIdx);
+	if(schema->vectorIdx) Index_Free(schema->vectorIdx);
+
+	// Free constraints.
+	if(schema->constraints) {
+		uint count = array_len(schema->constraints);
+		for(uint i = 0; i < count; i++) UniqueConstraint_Free(schema->constraints[i]);
+		array_free(schema->constraints);
+	}
 	rm_free(schema);
 }
 
@@ -8,9 +8,16 @@
 
 #include "../redismodule.h"
 #include "../index/index.h"
+#include "../index/unique_constraint.h"
 #include "rax.h"
 #include "redisearch_api.h"
+#include "property_column.h"
+#include "weight_matrix.h"
 #include "../graph/entities/graph_entity.h"
+#include <pthread.h>
+
+// Number of attributes which can be laid out in columns, per schema.
+#define SCHEMA_COLUMN_CAP 64
 
 typedef enum {
 	SCHEMA_NODE,
@@ -23,16 +30,26 @@ typedef enum {
 typedef struct {
 	int id;               // Internal ID to a matrix within the graph.
 	char *name;           // Schema name.
+	SchemaType type;      // Schema type, node label / relationship type.
 	Index *index;         // Exact match index.
 	Index *fulltextIdx;   // Full-text index.
+	Index *vectorIdx;     // Vector similarity index.
+	UniqueConstraint **constraints;             // Uniqueness constraints, NULL if none.
+	PropertyColumn *columns[SCHEMA_COLUMN_CAP]; // Columnar attributes, by attribute ID.
+	uint64_t column_hits[SCHEMA_COLUMN_CAP];    // Attribute access count.
+	pthread_mutex_t column_lock;                // Guards column and weight matrix construction.
+	Attribute_ID weight_attr;                   // Promoted edge attribute, ATTRIBUTE_NOTFOUND if none.
+	WeightMatrix *weights;                      // Weight matrices of weight_attr, NULL until built.
+	uint64_t entity_count;                      // Number of entities, as of the last refresh.
 } Schema;
 
 /* Creates a new schema. */
-Schema *Schema_New(const char *label, int id);
+Schema *Schema_New(const char *label, int id, SchemaType type);
 
 const char *Schema_GetName(const Schema *s);
 
-/* Returns true if schema has either a full-text or exact-match index. */
+/* Returns true if schema has either a full-text, exact-match or vector index
+ * or a uniqueness constraint, all of which are maintained as nodes change. */
 bool Schema_HasIndices(const Schema *s);
 
 /* Returns number of indices in schema. */
@@ -43,15 +60,79 @@ unsigned short Schema_IndexCount(const Schema *s);
 Index *Schema_GetIndex(const Schema *s, Attribute_ID *attribute_id, IndexType type);
 
 /* Assign a new index to attribute
- * attribute must already exists and not associated with an index. */
+ * attribute must already exists and not associated with an index.
+ * Relationship schemas support exact-match indices only. */
 int Schema_AddIndex(Index **idx, Schema *s, const char *field, IndexType type);
 
+/* Introduce a composite key over 'fields', in order
+ * fields which aren't indexed yet are added to the exact-match index. */
+int Schema_AddCompositeIndex(Index **idx, Schema *s, const char **fields, uint count);
+
 /* Removes index. */
 int Schema_RemoveIndex(Schema *s, const char *field, IndexType type);
 
+/* Introduce a uniqueness constraint on 'field', populated from the schema's nodes.
+ * Returns INDEX_FAIL if the field is already constrained, if the schema isn't
+ * a node label or if two nodes hold the same value, in which case 'uc' is NULL. */
+int Schema_AddConstraint(UniqueConstraint **uc, Schema *s, const char *field);
+
+/* Populate the schema's constraints from its nodes, once a graph is decoded
+ * or once its nodes were relabeled, previously recorded nodes are discarded.
+ * Such graphs hold distinct values for each constraint. */
+void Schema_PopulateConstraints(Schema *s, const Graph *g);
+
+/* Retrieves the uniqueness constraint on attribute.
+ * Returns NULL if the attribute isn't constrained. */
+UniqueConstraint *Schema_GetConstraint(const Schema *s, Attribute_ID attribute_id);
+
+/* Removes the uniqueness constraint on 'field'. */
+int Schema_RemoveConstraint(Schema *s, const char *field);
+
+/* Returns the constraint on 'attribute_id' if it rejects node 'id' holding 'v',
+ * NULL if the value is accepted, INVALID_ENTITY_ID stands for a node yet to be created. */
+UniqueConstraint *Schema_ConstraintViolation(const Schema *s, NodeID id,
+		Attribute_ID attribute_id, SIValue v);
+
 /* Introduce node schema indicies */
 void Schema_AddNodeToIndices(const Schema *s, const Node *n);
 
+/* Remove node from schema indicies and uniqueness constraints. */
+void Schema_RemoveNodeFromIndices(const Schema *s, NodeID id);
+
+/* Introduce edge to relationship schema index. */
+void Schema_AddEdgeToIndices(const Schema *s, const Edge *e);
+
+/* Remove edge from relationship schema index. */
+void Schema_RemoveEdgeFromIndices(const Schema *s, const Edge *e);
+
+/* Retrieves node's attribute value from the schema's columnar layout.
+ * Once an attribute had been accessed as many times as there are nodes
+ * with the schema's label, a column is built for it.
+ * Returns NULL if the attribute is not laid out in a column. */
+SIValue *Schema_GetColumnValue(Schema *s, const Graph *g, Attribute_ID attr, NodeID id);
+
+/* Promote relationship attribute 'attr' to weight matrices, replacing any
+ * previously promoted attribute, ATTRIBUTE_NOTFOUND demotes the attribute.
+ * Must be called under the graph's write lock. */
+void Schema_SetWeightAttribute(Schema *s, Attribute_ID attr);
+
+/* Retrieves the weight matrices of the schema's promoted attribute,
+ * built on first access and rebuilt once the graph was modified.
+ * Returns NULL if no attribute is promoted or if the graph is write locked,
+ * the matrices remain valid for as long as the graph's read lock is held. */
+const WeightMatrix *Schema_GetWeights(Schema *s, const Graph *g);
+
+/* Returns the number of bytes held by the schema's columns. */
+size_t Schema_ColumnsMemoryUsage(const Schema *s);
+
+/* Drop all columns, must be called under the graph's write lock
+ * whenever the graph is modified. */
+void Schema_DropColumns(Schema *s);
+
+/* Drop weight matrices, must be called under the graph's write lock
+ * whenever the graph is modified. */
+void Schema_DropWeights(Schema *s);
+
 /* Free schema. */
 void Schema_Free(Schema *s);
 
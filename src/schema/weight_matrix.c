@@ -0,0 +1,162 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "weight_matrix.h"
+#include "../RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+
+WeightMatrix *WeightMatrix_New(const Graph *g, int relation, Attribute_ID attr) {
+	ASSERT(g != NULL);
+	ASSERT(relation != GRAPH_NO_RELATION);
+
+	GrB_Index n = Graph_RequiredMatrixDim(g);
+	GrB_Matrix R = Graph_GetRelationMatrix(g, relation);
+	GrB_Index nvals;
+	GrB_Matrix_nvals(&nvals, R);
+
+	// an entry per edge, parallel edges are reduced while building
+	uint64_t cap = MAX(nvals, 1);
+	GrB_Index *I = rm_malloc(sizeof(GrB_Index) * cap);
+	GrB_Index *J = rm_malloc(sizeof(GrB_Index) * cap);
+	double *X = rm_malloc(sizeof(double) * cap);
+	GrB_Index count = 0;
+
+	Edge *edges = array_new(Edge, 1);
+	GrB_Index src;
+	GrB_Index dest;
+	bool depleted = false;
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, R);
+
+	while(true) {
+		GxB_MatrixTupleIter_next(iter, &src, &dest, &depleted);
+		if(depleted) break;
+
+		array_clear(edges);
+		Graph_GetEdgesConnectingNodes(g, src, dest, relation, &edges);
+
+		uint edge_count = array_len(edges);
+		for(uint i = 0; i < edge_count; i++) {
+			SIValue v = GraphEntity_GetProperty((GraphEntity *)(edges + i), attr);
+			if(!(SI_TYPE(v) & SI_NUMERIC)) continue;
+			double x = SI_GET_NUMERIC(v);
+			if(isnan(x)) continue;
+
+			if(count == cap) {
+				cap *= 2;
+				I = rm_realloc(I, sizeof(GrB_Index) * cap);
+				J = rm_realloc(J, sizeof(GrB_Index) * cap);
+				X = rm_realloc(X, sizeof(double) * cap);
+			}
+			I[count] = src;
+			J[count] = dest;
+			X[count] = x;
+			count++;
+		}
+	}
+
+	GxB_MatrixTupleIter_free(iter);
+	array_free(edges);
+
+	WeightMatrix *w = rm_malloc(sizeof(WeightMatrix));
+	w->attr = attr;
+	w->epoch = Graph_WriteEpoch(g);
+	GrB_Matrix_new(&w->min, GrB_FP64, n, n);
+	GrB_Matrix_new(&w->max, GrB_FP64, n, n);
+	GrB_Matrix_build_FP64(w->min, I, J, X, count, GrB_MIN_FP64);
+	GrB_Matrix_build_FP64(w->max, I, J, X, count, GrB_MAX_FP64);
+
+	rm_free(I);
+	rm_free(J);
+	rm_free(X);
+	return w;
+}
+
+// T = entries of A satisfying 'a <op> constant'
+static void _Select(GrB_Matrix A, GxB_SelectOp op, double constant, GrB_Matrix *T) {
+	GrB_Index nrows;
+	GrB_Index ncols;
+	GrB_Matrix_nrows(&nrows, A);
+	GrB_Matrix_ncols(&ncols, A);
+	GrB_Matrix_new(T, GrB_FP64, nrows, ncols);
+
+	GxB_Scalar thunk;
+	GxB_Scalar_new(&thunk, GrB_FP64);
+	GxB_Scalar_setElement_FP64(thunk, constant);
+
+	GrB_Info info = GxB_select(*T, GrB_NULL, GrB_NULL, op, A, thunk, GrB_NULL);
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+
+	GrB_free(&thunk);
+}
+
+// S = S ∩ pattern(T), S is created out of T if NULL
+static void _Intersect(GrB_Matrix T, GrB_Matrix *S) {
+	GrB_Info info;
+	if(*S == GrB_NULL) {
+		GrB_Index nrows;
+		GrB_Index ncols;
+		GrB_Matrix_nrows(&nrows, T);
+		GrB_Matrix_ncols(&ncols, T);
+		GrB_Matrix_new(S, GrB_BOOL, nrows, ncols);
+		info = GrB_apply(*S, GrB_NULL, GrB_NULL, GxB_ONE_BOOL, T, GrB_NULL);
+	} else {
+		info = GrB_eWiseMult(*S, GrB_NULL, GrB_NULL, GxB_PAIR_BOOL, *S, T, GrB_NULL);
+	}
+	ASSERT(info == GrB_SUCCESS);
+	UNUSED(info);
+}
+
+bool WeightMatrix_Select(const WeightMatrix *w, GxB_SelectOp op, double constant,
+		GrB_Matrix *S) {
+	ASSERT(w != NULL && S != NULL);
+
+	// a pair may have an edge greater than the constant if its greatest edge
+	// is, and an edge lesser than the constant if its smallest edge is
+	GrB_Matrix T = GrB_NULL;
+	if(op == GxB_GT_THUNK || op == GxB_GE_THUNK) {
+		_Select(w->max, op, constant, &T);
+	} else if(op == GxB_LT_THUNK || op == GxB_LE_THUNK) {
+		_Select(w->min, op, constant, &T);
+	} else if(op == GxB_EQ_THUNK) {
+		// an edge equals the constant only if it lies within [min, max]
+		_Select(w->min, GxB_LE_THUNK, constant, &T);
+		_Intersect(T, S);
+		GrB_free(&T);
+		_Select(w->max, GxB_GE_THUNK, constant, &T);
+	} else {
+		return false;
+	}
+
+	_Intersect(T, S);
+	GrB_free(&T);
+	return true;
+}
+
+// estimate a sparse layout: row pointers, column indices and values
+static size_t _MatrixMemoryUsage(GrB_Matrix A) {
+	GrB_Index nrows;
+	GrB_Index nvals;
+	GrB_Matrix_nrows(&nrows, A);
+	GrB_Matrix_nvals(&nvals, A);
+	return (nrows + 1) * sizeof(GrB_Index) + nvals * (sizeof(GrB_Index) + sizeof(double));
+}
+
+size_t WeightMatrix_MemoryUsage(const WeightMatrix *w) {
+	ASSERT(w != NULL);
+	return sizeof(WeightMatrix) + _MatrixMemoryUsage(w->min) +
+		   _MatrixMemoryUsage(w->max);
+}
+
+void WeightMatrix_Free(WeightMatrix *w) {
+	ASSERT(w != NULL);
+	GrB_free(&w->min);
+	GrB_free(&w->max);
+	rm_free(w);
+}
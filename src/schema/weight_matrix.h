@@ -0,0 +1,61 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "../graph/graph.h"
+#include "../graph/entities/graph_entity.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+/* WeightMatrix is a typed copy of a numeric edge attribute
+ * of a single relationship type.
+ * as multiple edges may connect the same pair of nodes, entry i,j of 'min'
+ * holds the smallest value among the edges connecting i to j and 'max'
+ * the greatest, edges lacking a numeric value are left out.
+ *
+ * comparisons against a constant are evaluated over these matrices by
+ * GxB_select, resolving the pairs connected by at least one edge which may
+ * pass the comparison without visiting the edges themselves.
+ *
+ * a weight matrix is only valid as long as the graph is not modified,
+ * as detected by the graph's write epoch. */
+typedef struct {
+	Attribute_ID attr;   // Promoted attribute.
+	GrB_Matrix min;      // Smallest value among the edges connecting each pair.
+	GrB_Matrix max;      // Greatest value among the edges connecting each pair.
+	uint64_t epoch;      // Graph write epoch at which the matrices were built.
+} WeightMatrix;
+
+// Build the weight matrices of attribute 'attr' over relationship 'relation'.
+WeightMatrix *WeightMatrix_New
+(
+	const Graph *g,      // Graph to scan.
+	int relation,        // Relation matrix to scan.
+	Attribute_ID attr    // Attribute to materialize.
+);
+
+// Narrows S to the pairs connected by at least one edge
+// whose value may satisfy 'value <op> constant'.
+// S is created if NULL, returns false if 'op' isn't supported.
+bool WeightMatrix_Select
+(
+	const WeightMatrix *w,  // Weight matrix.
+	GxB_SelectOp op,        // One of GxB_{EQ,LT,LE,GT,GE}_THUNK.
+	double constant,        // Value compared against.
+	GrB_Matrix *S           // [input/output] Boolean matrix of qualifying pairs.
+);
+
+// Returns the number of bytes held by the weight matrix.
+size_t WeightMatrix_MemoryUsage
+(
+	const WeightMatrix *w
+);
+
+// Free weight matrix.
+void WeightMatrix_Free
+(
+	WeightMatrix *w
+);
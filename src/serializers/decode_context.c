@@ -6,6 +6,7 @@
 
 #include "decode_context.h"
 #include "../RG.h"
+#include "../util/arr.h"
 #include "../util/rmalloc.h"
 #include "../util/rax_extensions.h"
 
@@ -14,12 +15,14 @@ GraphDecodeContext *GraphDecodeContext_New() {
 	ctx->keys_processed = 0;
 	ctx->graph_keys_count = 1;
 	ctx->meta_keys = raxNew();
+	ctx->pending = array_new(PendingEdges, 0);
 	return ctx;
 }
 
 void GraphDecodeContext_Reset(GraphDecodeContext *ctx) {
 	ASSERT(ctx);
 	ctx->keys_processed = 0;
+	GraphDecodeContext_ClearPendingEdges(ctx);
 }
 
 void GraphDecodeContext_SetKeyCount(GraphDecodeContext *ctx, uint64_t key_count) {
@@ -54,6 +57,11 @@ bool GraphDecodeContext_Finished(const GraphDecodeContext *ctx) {
 	return ctx->keys_processed == ctx->graph_keys_count;
 }
 
+bool GraphDecodeContext_Decoding(const GraphDecodeContext *ctx) {
+	ASSERT(ctx);
+	return ctx->keys_processed > 0;
+}
+
 void GraphDecodeContext_IncreaseProcessedKeyCount(GraphDecodeContext *ctx) {
 	ASSERT(ctx);
 	ctx->keys_processed++;
@@ -64,8 +72,44 @@ bool GraphDecodeContext_GetProcessedKeyCount(const GraphDecodeContext *ctx) {
 	return ctx->keys_processed;
 }
 
+void GraphDecodeContext_AddPendingEdge(GraphDecodeContext *ctx, int r, NodeID src,
+									   NodeID dest, EdgeID id) {
+	ASSERT(ctx);
+	while(array_len(ctx->pending) <= (uint)r) {
+		PendingEdges p = {
+			.src = array_new(GrB_Index, 0),
+			.dest = array_new(GrB_Index, 0),
+			.ids = array_new(EdgeID, 0)
+		};
+		ctx->pending = array_append(ctx->pending, p);
+	}
+
+	PendingEdges *p = ctx->pending + r;
+	p->src = array_append(p->src, src);
+	p->dest = array_append(p->dest, dest);
+	p->ids = array_append(p->ids, id);
+}
+
+PendingEdges *GraphDecodeContext_GetPendingEdges(const GraphDecodeContext *ctx) {
+	ASSERT(ctx);
+	return ctx->pending;
+}
+
+void GraphDecodeContext_ClearPendingEdges(GraphDecodeContext *ctx) {
+	ASSERT(ctx);
+	uint n = array_len(ctx->pending);
+	for(uint i = 0; i < n; i++) {
+		array_free(ctx->pending[i].src);
+		array_free(ctx->pending[i].dest);
+		array_free(ctx->pending[i].ids);
+	}
+	array_clear(ctx->pending);
+}
+
 void GraphDecodeContext_Free(GraphDecodeContext *ctx) {
 	if(ctx) {
+		GraphDecodeContext_ClearPendingEdges(ctx);
+		array_free(ctx->pending);
 		raxFree(ctx->meta_keys);
 		rm_free(ctx);
 	}
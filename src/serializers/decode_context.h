@@ -10,12 +10,23 @@
 #include "stdbool.h"
 #include "stdint.h"
 #include "rax.h"
+#include "../graph/entities/graph_entity.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+// Edges of a single relation type decoded so far
+// connections are formed in bulk once all graph keys were decoded
+typedef struct {
+	GrB_Index *src;   // source node IDs
+	GrB_Index *dest;  // destination node IDs
+	EdgeID *ids;      // edge IDs
+} PendingEdges;
 
 // A struct that maintains the state of a graph decoding from RDB.
 typedef struct {
 	uint64_t keys_processed;    // Count the number of procssed graph keys.
 	uint64_t graph_keys_count;  // The number of keys representing the graph.
 	rax *meta_keys;             // The meta keys encountered so far in the decode process.
+	PendingEdges *pending;      // Decoded edges pending connection, per relation type.
 } GraphDecodeContext;
 
 // Creates a new graph decoding context.
@@ -42,11 +53,25 @@ void GraphDecodeContext_ClearMetaKeys(GraphDecodeContext *ctx);
 // Returns if the number of processed keys is equal to the total number of graph keys.
 bool GraphDecodeContext_Finished(const GraphDecodeContext *ctx);
 
+// Returns true while some but not all of the graph's keys were decoded,
+// once decoded the processed key count is reset.
+bool GraphDecodeContext_Decoding(const GraphDecodeContext *ctx);
+
 // Increment the number of processed keys by one.
 void GraphDecodeContext_IncreaseProcessedKeyCount(GraphDecodeContext *ctx);
 
 // Returns the number of processed keys.
 bool GraphDecodeContext_GetProcessedKeyCount(const GraphDecodeContext *ctx);
 
+// Add a decoded edge, to be connected once decoding ends.
+void GraphDecodeContext_AddPendingEdge(GraphDecodeContext *ctx, int r, NodeID src,
+									   NodeID dest, EdgeID id);
+
+// Returns the pending edges array, one entry per relation type.
+PendingEdges *GraphDecodeContext_GetPendingEdges(const GraphDecodeContext *ctx);
+
+// Discards all pending edges.
+void GraphDecodeContext_ClearPendingEdges(GraphDecodeContext *ctx);
+
 // Free graph decoding context.
 void GraphDecodeContext_Free(GraphDecodeContext *ctx);
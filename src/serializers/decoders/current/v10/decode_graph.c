@@ -4,7 +4,7 @@
 * This file is available under the Redis Labs Source Available License Agreement
 */
 
-#include "decode_v9.h"
+#include "decode_v10.h"
 
 // Module event handler functions declarations.
 void ModuleEventHandler_IncreaseDecodingGraphsCount(void);
@@ -43,7 +43,7 @@ static void _EnableMultiEdgeSupport(Graph *g) {
 	for(uint i = 0; i < n; i++) g->relations[i]->allow_multi_edge = true;
 }
 
-static GraphContext *_DecodeHeader(RedisModuleIO *rdb) {
+static GraphContext *_DecodeHeader(SerializerIO *io) {
 	/* Header format:
 	 * Graph name
 	 * Node count
@@ -55,21 +55,21 @@ static GraphContext *_DecodeHeader(RedisModuleIO *rdb) {
 	 */
 
 	// Graph name
-	char *graph_name = RedisModule_LoadStringBuffer(rdb, NULL);
+	char *graph_name = SerializerIO_LoadStringBuffer(io, NULL);
 
 	// Each key header contains the following: #nodes, #edges, #labels matrices, #relation matrices
-	uint64_t node_count = RedisModule_LoadUnsigned(rdb);
-	uint64_t edge_count = RedisModule_LoadUnsigned(rdb);
-	uint64_t label_count = RedisModule_LoadUnsigned(rdb);
-	uint64_t relation_count = RedisModule_LoadUnsigned(rdb);
+	uint64_t node_count = SerializerIO_LoadUnsigned(io);
+	uint64_t edge_count = SerializerIO_LoadUnsigned(io);
+	uint64_t label_count = SerializerIO_LoadUnsigned(io);
+	uint64_t relation_count = SerializerIO_LoadUnsigned(io);
 	uint64_t multi_edge[relation_count];
 
 	for(uint i = 0; i < relation_count; i++) {
-		multi_edge[i] = RedisModule_LoadUnsigned(rdb);
+		multi_edge[i] = SerializerIO_LoadUnsigned(io);
 	}
 
 	// Total keys representing the graph.
-	uint64_t key_number = RedisModule_LoadUnsigned(rdb);
+	uint64_t key_number = SerializerIO_LoadUnsigned(io);
 
 	GraphContext *gc = _GetOrCreateGraphContext(graph_name);
 	Graph *g = gc->g;
@@ -91,7 +91,7 @@ static GraphContext *_DecodeHeader(RedisModuleIO *rdb) {
 	return gc;
 }
 
-static PayloadInfo *_RdbLoadKeySchema(RedisModuleIO *rdb) {
+static PayloadInfo *_RdbLoadKeySchema(SerializerIO *io) {
 	/* Format:
 	*  #Number of payloads info - N
 	*  N * Payload info:
@@ -99,33 +99,33 @@ static PayloadInfo *_RdbLoadKeySchema(RedisModuleIO *rdb) {
 	*      Number of entities encoded in this state.
 	*/
 
-	uint64_t payloads_count = RedisModule_LoadUnsigned(rdb);
+	uint64_t payloads_count = SerializerIO_LoadUnsigned(io);
 	PayloadInfo *payloads = array_new(PayloadInfo, payloads_count);
 
 	for(uint i = 0; i < payloads_count; i++) {
 		// For each payload, load its type and the number of entities it contains.
 		PayloadInfo payload_info;
-		payload_info.state =  RedisModule_LoadUnsigned(rdb);
-		payload_info.entities_count =  RedisModule_LoadUnsigned(rdb);
+		payload_info.state =  SerializerIO_LoadUnsigned(io);
+		payload_info.entities_count =  SerializerIO_LoadUnsigned(io);
 		payloads = array_append(payloads, payload_info);
 	}
 	return payloads;
 }
 
-GraphContext *RdbLoadGraph_v9(RedisModuleIO *rdb) {
+GraphContext *RdbLoadGraph_v10(SerializerIO *io) {
 
 	/* Key format:
 	 *  Header
 	 *  Payload(s) count: N
 	 *  Key content X N:
-	 *      Payload type (Nodes / Edges / Deleted nodes/ Deleted edges/ Graph schema)
+	 *      Payload type (Nodes / Edges / Deleted nodes/ Deleted edges/ Graph schema/ Relation matrices)
 	 *      Entities in payload
 	 *  Payload(s) X N
 	 * */
 
-	GraphContext *gc = _DecodeHeader(rdb);
+	GraphContext *gc = _DecodeHeader(io);
 	// Load the key schema.
-	PayloadInfo *key_schema = _RdbLoadKeySchema(rdb);
+	PayloadInfo *key_schema = _RdbLoadKeySchema(io);
 
 	/* The decode process contains the decode operation of many meta keys, representing independent parts of the graph.
 	 * Each key contains data on one or more of the following:
@@ -134,25 +134,29 @@ GraphContext *RdbLoadGraph_v9(RedisModuleIO *rdb) {
 	 * 3. Edges - The edges that are currently valid in the graph.
 	 * 4. Deleted edges - Edges that were deleted and there ids can be re-used. Used for exact replication of data block state.
 	 * 5. Graph schema - Properties, indices.
+	 * 6. Relation matrices - The connections of the edges, imported as is.
 	 * The following switch checks which part of the graph the current key holds, and decodes it accordingly. */
 	uint payloads_count = array_len(key_schema);
 	for(uint i = 0; i < payloads_count; i++) {
 		PayloadInfo payload = key_schema[i];
 		switch(payload.state) {
 		case ENCODE_STATE_NODES:
-			RdbLoadNodes_v9(rdb, gc, payload.entities_count);
+			RdbLoadNodes_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_DELETED_NODES:
-			RdbLoadDeletedNodes_v9(rdb, gc, payload.entities_count);
+			RdbLoadDeletedNodes_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_EDGES:
-			RdbLoadEdges_v9(rdb, gc, payload.entities_count);
+			RdbLoadEdges_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_DELETED_EDGES:
-			RdbLoadDeletedEdges_v9(rdb, gc, payload.entities_count);
+			RdbLoadDeletedEdges_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_GRAPH_SCHEMA:
-			RdbLoadGraphSchema_v9(rdb, gc);
+			RdbLoadGraphSchema_v10(io, gc);
+			break;
+		case ENCODE_STATE_RELATION_MATRICES:
+			RdbLoadRelationMatrices_v10(io, gc, payload.entities_count);
 			break;
 		default:
 			ASSERT(false && "Unknown encoding");
@@ -164,17 +168,21 @@ GraphContext *RdbLoadGraph_v9(RedisModuleIO *rdb) {
 	// Update decode context.
 	GraphDecodeContext_IncreaseProcessedKeyCount(gc->decoding_context);
 	// Before finalizing keep encountered meta keys names, for future deletion.
-	const RedisModuleString *rm_key_name = RedisModule_GetKeyNameFromIO(rdb);
-	const char *key_name = RedisModule_StringPtrLen(rm_key_name, NULL);
-	// The virtual key name is not equal the graph name.
-	if(strcmp(key_name, gc->graph_name) != 0) {
-		GraphDecodeContext_AddMetaKey(gc->decoding_context, key_name);
+	// buffers are not loaded into keys, see GRAPH.RESTORE
+	const RedisModuleString *rm_key_name = SerializerIO_KeyName(io);
+	if(rm_key_name != NULL) {
+		const char *key_name = RedisModule_StringPtrLen(rm_key_name, NULL);
+		// The virtual key name is not equal the graph name.
+		if(strcmp(key_name, gc->graph_name) != 0) {
+			GraphDecodeContext_AddMetaKey(gc->decoding_context, key_name);
+		}
 	}
 
 	if(GraphDecodeContext_Finished(gc->decoding_context)) {
 		// Revert to default synchronization behavior
 		Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
 		Graph_ApplyAllPending(gc->g);
+		GraphContext_RefreshStatistics(gc);
 		// Set the thread-local GraphContext, as it will be accessed when creating indexes.
 		QueryCtx_SetGraphCtx(gc);
 		// Index the nodes when decoding ends.
@@ -183,16 +191,30 @@ GraphContext *RdbLoadGraph_v9(RedisModuleIO *rdb) {
 			Schema *s = gc->node_schemas[i];
 			if(s->index) Index_Construct(s->index);
 			if(s->fulltextIdx) Index_Construct(s->fulltextIdx);
+			if(s->vectorIdx) Index_Construct(s->vectorIdx);
+			Schema_PopulateConstraints(s, gc->g);
 		}
 
 		// Enable support for multi edge on all relationship matrices.
 		_EnableMultiEdgeSupport(gc->g);
 
+		// Index the edges, prior to freezing relation matrices.
+		uint relation_schemas_count = array_len(gc->relation_schemas);
+		for(uint i = 0; i < relation_schemas_count; i++) {
+			Schema *s = gc->relation_schemas[i];
+			if(s->index) Index_Construct(s->index);
+		}
+
+		// Compress relation matrices of read-mostly graphs.
+		bool freeze_relations;
+		Config_Option_get(Config_FREEZE_RELATIONS, &freeze_relations);
+		if(freeze_relations) Graph_FreezeRelations(gc->g);
+
 		QueryCtx_Free(); // Release thread-local variables.
 		GraphDecodeContext_Reset(gc->decoding_context);
 		// Graph has finished decoding, inform the module.
 		ModuleEventHandler_DecreaseDecodingGraphsCount();
-		RedisModuleCtx *ctx = RedisModule_GetContextFromIO(rdb);
+		RedisModuleCtx *ctx = SerializerIO_Context(io);
 		RedisModule_Log(ctx, "notice", "Done decoding graph %s", gc->graph_name);
 	}
 	return gc;
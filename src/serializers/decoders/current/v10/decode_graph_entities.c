@@ -0,0 +1,194 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "decode_v10.h"
+#include "../../../entity_pack.h"
+
+// loads packs until count entities are decoded
+// a malformed pack fails the stream
+static void _RdbLoadPacks(SerializerIO *io, GraphContext *gc, uint64_t count,
+		bool edges) {
+	uint64_t decoded = 0;
+	while(decoded < count) {
+		size_t len;
+		char *pack = SerializerIO_LoadStringBuffer(io, &len);
+		if(SerializerIO_Failed(io)) {
+			rm_free(pack);
+			return;
+		}
+
+		EntityUnpacker unpacker;
+		EntityUnpacker_Init(&unpacker, pack, len, gc->string_pool);
+		uint64_t unpacked = 0;
+		while(!EntityUnpacker_Done(&unpacker) && decoded < count) {
+			if(edges) {
+				Edge e;
+				EdgeID id;
+				EntityUnpacker_NextEntity(&unpacker, &id);
+				if(EntityUnpacker_Failed(&unpacker)) break;
+				// edges are connected by their relation matrix
+				Serializer_Graph_AllocEdgeEntity(gc->g, id, &e);
+				EntityUnpacker_Properties(&unpacker, (GraphEntity *)&e);
+			} else {
+				Node n;
+				NodeID id;
+				int label;
+				EntityUnpacker_NextNode(&unpacker, &id, &label);
+				if(EntityUnpacker_Failed(&unpacker)) break;
+				Serializer_Graph_SetNode(gc->g, id, label, &n);
+				EntityUnpacker_Properties(&unpacker, (GraphEntity *)&n);
+			}
+			unpacked++;
+			decoded++;
+		}
+
+		// a pack holds at least one entity and is consumed entirely
+		bool failed = EntityUnpacker_Failed(&unpacker) || unpacked == 0 ||
+			!EntityUnpacker_Done(&unpacker);
+		EntityUnpacker_Free(&unpacker);
+		rm_free(pack);
+		if(failed) {
+			SerializerIO_Fail(io);
+			return;
+		}
+	}
+}
+
+void RdbLoadNodes_v10(SerializerIO *io, GraphContext *gc, uint64_t node_count) {
+	/* Format:
+	 * packed nodes, a string per chunk, see EntityUnpacker_NextNode */
+	_RdbLoadPacks(io, gc, node_count, false);
+}
+
+void RdbLoadDeletedNodes_v10(SerializerIO *io, GraphContext *gc, uint64_t deleted_node_count) {
+	/* Format:
+	* node id X N */
+	for(uint64_t i = 0; i < deleted_node_count; i++) {
+		NodeID id = SerializerIO_LoadUnsigned(io);
+		Serializer_Graph_MarkNodeDeleted(gc->g, id);
+	}
+}
+
+void RdbLoadEdges_v10(SerializerIO *io, GraphContext *gc, uint64_t edge_count) {
+	/* Format:
+	 * packed edges, a string per chunk, see EntityUnpacker_NextEntity */
+	_RdbLoadPacks(io, gc, edge_count, true);
+}
+
+void RdbLoadDeletedEdges_v10(SerializerIO *io, GraphContext *gc, uint64_t deleted_edge_count) {
+	/* Format:
+	 * edge id X N */
+	for(uint64_t i = 0; i < deleted_edge_count; i++) {
+		EdgeID id = SerializerIO_LoadUnsigned(io);
+		Serializer_Graph_MarkEdgeDeleted(gc->g, id);
+	}
+}
+
+
+// loads an array of n indices saved as a single string
+// returns NULL if the string does not hold n indices
+static GrB_Index *_RdbLoadIndexArray(SerializerIO *io, GrB_Index n) {
+	size_t len;
+	char *arr = SerializerIO_LoadStringBuffer(io, &len);
+	if(SerializerIO_Failed(io) || len != n * sizeof(GrB_Index)) {
+		rm_free(arr);
+		return NULL;
+	}
+	return (GrB_Index *)arr;
+}
+
+// recreates the multi-edge runs of relation r, rewriting their entries in Ax
+// returns false if runs do not match Ax
+static bool _RdbLoadMultiEdgeRuns(SerializerIO *io, GraphContext *gc, int r,
+		uint64_t *Ax, GrB_Index nvals) {
+	size_t len;
+	EdgeID *runs = (EdgeID *)SerializerIO_LoadStringBuffer(io, &len);
+	if(SerializerIO_Failed(io) || len % sizeof(EdgeID) != 0) {
+		rm_free(runs);
+		return false;
+	}
+
+	size_t n = len / sizeof(EdgeID);
+	size_t i = 0;
+	for(GrB_Index k = 0; k < nvals; k++) {
+		if(SINGLE_EDGE(Ax[k])) continue;
+		if(i >= n || runs[i] > n - i - 1) break;
+		uint32_t edge_count = runs[i];
+		Ax[k] = Serializer_Graph_NewMultiEdgeRun(gc->g, r, runs + i + 1, edge_count);
+		i += edge_count + 1;
+	}
+
+	rm_free(runs);
+	return i == n;
+}
+
+static bool _RdbLoadRelationMatrix(SerializerIO *io, GraphContext *gc) {
+	/* Format:
+	 * relation type
+	 * dimension
+	 * #rows holding entries, nvec
+	 * #entries, nvals
+	 * jumbled
+	 * if nvals > 0:
+	 *  row indices, Ah[nvec]
+	 *  row pointers, Ap[nvec + 1]
+	 *  column indices, Aj[nvals]
+	 *  values, Ax[nvals]
+	 *  multi-edge runs, (#edges, edge IDs) for each multi-edge entry */
+
+	uint64_t r = SerializerIO_LoadUnsigned(io);
+	GrB_Index dim = SerializerIO_LoadUnsigned(io);
+	GrB_Index nvec = SerializerIO_LoadUnsigned(io);
+	GrB_Index nvals = SerializerIO_LoadUnsigned(io);
+	bool jumbled = SerializerIO_LoadUnsigned(io);
+	if(SerializerIO_Failed(io) || r >= Graph_RelationTypeCount(gc->g) ||
+	   nvec > nvals || nvec > dim) {
+		return false;
+	}
+
+	// empty relation
+	if(nvals == 0) return true;
+
+	// loaded arrays are handed to the imported matrix as is
+	GrB_Index *Ah = _RdbLoadIndexArray(io, nvec);
+	GrB_Index *Ap = _RdbLoadIndexArray(io, nvec + 1);
+	GrB_Index *Aj = _RdbLoadIndexArray(io, nvals);
+	uint64_t  *Ax = _RdbLoadIndexArray(io, nvals);
+	bool valid = Ah && Ap && Aj && Ax && Ap[0] == 0 && Ap[nvec] == nvals &&
+		_RdbLoadMultiEdgeRuns(io, gc, r, Ax, nvals);
+
+	GrB_Matrix R = NULL;
+	if(valid) {
+		GrB_Info info = GxB_Matrix_import_HyperCSR(&R, GrB_UINT64, dim, dim,
+				&Ap, &Ah, &Aj, (void **)&Ax, nvec + 1, nvec, nvals, nvals, nvec,
+				jumbled, NULL);
+		valid = (info == GrB_SUCCESS);
+	}
+
+	if(!valid) {
+		// arrays are left untouched by a failed import
+		rm_free(Ah);
+		rm_free(Ap);
+		rm_free(Aj);
+		rm_free(Ax);
+		return false;
+	}
+
+	Graph_ImportRelationMatrix(gc->g, r, R);
+	return true;
+}
+
+void RdbLoadRelationMatrices_v10(SerializerIO *io, GraphContext *gc,
+		uint64_t matrix_count) {
+	/* Format:
+	 * relation matrix X N */
+	for(uint64_t i = 0; i < matrix_count; i++) {
+		if(!_RdbLoadRelationMatrix(io, gc)) {
+			SerializerIO_Fail(io);
+			return;
+		}
+	}
+}
@@ -0,0 +1,97 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "decode_v10.h"
+
+static Schema *_RdbLoadSchema(SerializerIO *io, SchemaType type) {
+	/* Format:
+	 * id
+	 * name
+	 * #indices
+	 * (index type, indexed property) X M
+	 * uniqueness constraints are loaded as (IDX_UNIQUE, constrained property) */
+
+	int id = SerializerIO_LoadUnsigned(io);
+	char *name = SerializerIO_LoadStringBuffer(io, NULL);
+	Schema *s = Schema_New(name, id, type);
+	RedisModule_Free(name);
+
+	Index *idx = NULL;
+	uint index_count = SerializerIO_LoadUnsigned(io);
+	for(uint i = 0; i < index_count; i++) {
+		IndexType type = SerializerIO_LoadUnsigned(io);
+		char *field = SerializerIO_LoadStringBuffer(io, NULL);
+
+		if(type == IDX_COMPOSITE) {
+			// split composite key into its fields
+			const char *fields[COMPOSITE_INDEX_MAX_FIELDS];
+			uint count = 0;
+			char *f = field;
+			fields[count++] = f;
+			while((f = strchr(f, INDEX_SEPARATOR)) != NULL &&
+					count < COMPOSITE_INDEX_MAX_FIELDS) {
+				*f++ = '\0';
+				fields[count++] = f;
+			}
+			Schema_AddCompositeIndex(&idx, s, fields, count);
+		} else if(type == IDX_UNIQUE) {
+			// populated once decoding ends
+			UniqueConstraint *uc = NULL;
+			Schema_AddConstraint(&uc, s, field);
+		} else {
+			Schema_AddIndex(&idx, s, field, type);
+		}
+		RedisModule_Free(field);
+	}
+
+	return s;
+}
+
+static void _RdbLoadAttributeKeys(SerializerIO *io, GraphContext *gc) {
+	/* Format:
+	 * #attribute keys
+	 * attribute keys
+	 */
+
+	uint count = SerializerIO_LoadUnsigned(io);
+	for(uint i = 0; i < count; i ++) {
+		char *attr = SerializerIO_LoadStringBuffer(io, NULL);
+		GraphContext_FindOrAddAttribute(gc, attr);
+		RedisModule_Free(attr);
+	}
+}
+
+void RdbLoadGraphSchema_v10(SerializerIO *io, GraphContext *gc) {
+	/* Format:
+	 * attribute keys (unified schema)
+	 * #node schemas
+	 * node schema X #node schemas
+	 * #relation schemas
+	 * unified relation schema
+	 * relation schema X #relation schemas
+	 */
+
+	// Attributes, Load the full attribute mapping.
+	_RdbLoadAttributeKeys(io, gc);
+
+	// #Node schemas
+	uint schema_count = SerializerIO_LoadUnsigned(io);
+
+	// Load each node schema
+	gc->node_schemas = array_ensure_cap(gc->node_schemas, schema_count);
+	for(uint i = 0; i < schema_count; i ++) {
+		gc->node_schemas = array_append(gc->node_schemas, _RdbLoadSchema(io, SCHEMA_NODE));
+	}
+
+	// #Edge schemas
+	schema_count = SerializerIO_LoadUnsigned(io);
+
+	// Load each edge schema
+	gc->relation_schemas = array_ensure_cap(gc->relation_schemas, schema_count);
+	for(uint i = 0; i < schema_count; i ++) {
+		gc->relation_schemas = array_append(gc->relation_schemas, _RdbLoadSchema(io, SCHEMA_EDGE));
+	}
+}
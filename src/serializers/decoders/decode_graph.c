@@ -5,9 +5,15 @@
  */
 
 #include "decode_graph.h"
-#include "current/v9/decode_v9.h"
+#include "current/v10/decode_v10.h"
 
 GraphContext *RdbLoadGraph(RedisModuleIO *rdb) {
-	return RdbLoadGraph_v9(rdb);
+	SerializerIO io;
+	SerializerIO_FromRdb(&io, rdb);
+	return DecodeGraph(&io);
+}
+
+GraphContext *DecodeGraph(SerializerIO *io) {
+	return RdbLoadGraph_v10(io);
 }
 
@@ -10,3 +10,6 @@
 
 // Load RDB.
 GraphContext *RdbLoadGraph(RedisModuleIO *rdb);
+
+// Decode a graph key encoded by EncodeGraph.
+GraphContext *DecodeGraph(SerializerIO *io);
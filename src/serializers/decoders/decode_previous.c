@@ -17,6 +17,11 @@ GraphContext *Decode_Previous(RedisModuleIO *rdb, int encver) {
 		return RdbLoadGraphContext_v7(rdb);
 	case 8:
 		return RdbLoadGraphContext_v8(rdb);
+	case 9: {
+		SerializerIO io;
+		SerializerIO_FromRdb(&io, rdb);
+		return RdbLoadGraph_v9(&io);
+	}
 	default:
 		ASSERT(false && "attempted to read unsupported RedisGraph version from RDB file.");
 		return NULL;
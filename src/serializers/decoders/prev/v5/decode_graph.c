@@ -164,5 +164,6 @@ void RdbLoadGraph_v5(RedisModuleIO *rdb, GraphContext *gc) {
 
 	// Resize and flush all pending changes to matrices.
 	Graph_ApplyAllPending(gc->g);
+	GraphContext_RefreshStatistics(gc);
 }
 
@@ -15,7 +15,7 @@ Schema *RdbLoadSchema_v5(RedisModuleIO *rdb, SchemaType type) {
 
 	int id = RedisModule_LoadUnsigned(rdb);
 	char *name = RedisModule_LoadStringBuffer(rdb, NULL);
-	Schema *s = Schema_New(name, id);
+	Schema *s = Schema_New(name, id, type);
 
 	Index *idx = NULL;
 	uint index_count = RedisModule_LoadUnsigned(rdb);
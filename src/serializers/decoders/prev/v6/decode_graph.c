@@ -156,5 +156,6 @@ void RdbLoadGraph_v6(RedisModuleIO *rdb, GraphContext *gc) {
 
 	// Resize and flush all pending changes to matrices.
 	Graph_ApplyAllPending(gc->g);
+	GraphContext_RefreshStatistics(gc);
 }
 
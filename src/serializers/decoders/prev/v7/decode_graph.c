@@ -154,6 +154,7 @@ GraphContext *RdbLoadGraphContext_v7(RedisModuleIO *rdb) {
 		// Revert to default synchronization behavior
 		Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
 		Graph_ApplyAllPending(gc->g);
+		GraphContext_RefreshStatistics(gc);
 		// Set the thread-local GraphContext, as it will be accessed when creating indexes.
 		QueryCtx_SetGraphCtx(gc);
 		// Index the nodes when decoding ends.
@@ -175,6 +175,7 @@ GraphContext *RdbLoadGraphContext_v8(RedisModuleIO *rdb) {
 		// Revert to default synchronization behavior
 		Graph_SetMatrixPolicy(gc->g, SYNC_AND_MINIMIZE_SPACE);
 		Graph_ApplyAllPending(gc->g);
+		GraphContext_RefreshStatistics(gc);
 		// Set the thread-local GraphContext, as it will be accessed when creating indexes.
 		QueryCtx_SetGraphCtx(gc);
 		// Index the nodes when decoding ends.
@@ -188,6 +189,11 @@ GraphContext *RdbLoadGraphContext_v8(RedisModuleIO *rdb) {
 		// Enable support for multi edge on all relationship matrices.
 		_EnableMultiEdgeSupport(gc->g);
 
+		// Compress relation matrices of read-mostly graphs.
+		bool freeze_relations;
+		Config_Option_get(Config_FREEZE_RELATIONS, &freeze_relations);
+		if(freeze_relations) Graph_FreezeRelations(gc->g);
+
 		QueryCtx_Free(); // Release thread-local variables.
 		GraphDecodeContext_Reset(gc->decoding_context);
 		// Graph has finished decoding, inform the module.
@@ -0,0 +1,155 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "decode_v9.h"
+
+// Forward declarations.
+static SIValue _RdbLoadPoint(SerializerIO *io);
+static SIValue _RdbLoadSIArray(SerializerIO *io);
+
+static SIValue _RdbLoadSIValue(SerializerIO *io) {
+	/* Format:
+	 * SIType
+	 * Value */
+	SIType t = SerializerIO_LoadUnsigned(io);
+	switch(t) {
+		case T_INT64:
+			return SI_LongVal(SerializerIO_LoadSigned(io));
+		case T_DOUBLE:
+			return SI_DoubleVal(SerializerIO_LoadDouble(io));
+		case T_STRING:
+			// Transfer ownership of the heap-allocated string to the
+			// newly-created SIValue
+			return SI_TransferStringVal(SerializerIO_LoadStringBuffer(io, NULL));
+		case T_BOOL:
+			return SI_BoolVal(SerializerIO_LoadSigned(io));
+		case T_ARRAY:
+			return _RdbLoadSIArray(io);
+		case T_POINT:
+			return _RdbLoadPoint(io);
+		case T_NULL:
+		default: // currently impossible
+			return SI_NullVal();
+	}
+}
+
+static SIValue _RdbLoadPoint(SerializerIO *io) {
+	double lat = SerializerIO_LoadDouble(io);
+	double lon = SerializerIO_LoadDouble(io);
+	return SI_Point(lat, lon);
+}
+
+static SIValue _RdbLoadSIArray(SerializerIO *io) {
+	/* loads array as
+	   unsinged : array legnth
+	   array[0]
+	   .
+	   .
+	   .
+	   array[array length -1]
+	 */
+	uint arrayLen = SerializerIO_LoadUnsigned(io);
+	SIValue list = SI_Array(arrayLen);
+	for(uint i = 0; i < arrayLen; i++) {
+		SIValue elem = _RdbLoadSIValue(io);
+		SIArray_Append(&list, elem);
+		SIValue_Free(elem);
+	}
+	return list;
+}
+
+static void _RdbLoadEntity(SerializerIO *io, GraphContext *gc, GraphEntity *e) {
+	/* Format:
+	 * #properties N
+	 * (name, value type, value) X N
+	*/
+	uint64_t propCount = SerializerIO_LoadUnsigned(io);
+	if(propCount == 0) return;
+
+	// allocate the property array once and move decoded values into it
+	// rather than growing and cloning property by property
+	int count = 0;
+	EntityProperty *properties = rm_malloc(sizeof(EntityProperty) * propCount);
+	for(int i = 0; i < propCount; i++) {
+		Attribute_ID attr_id = SerializerIO_LoadUnsigned(io);
+		SIValue attr_value = _RdbLoadSIValue(io);
+		if(SIValue_IsNull(attr_value)) continue;
+		EntityProperty_Set(properties + count, attr_id, attr_value);
+		count++;
+	}
+
+	GraphEntity_AdoptProperties(e, properties, count);
+}
+
+
+void RdbLoadNodes_v9(SerializerIO *io, GraphContext *gc, uint64_t node_count) {
+	/* Node Format:
+	 *      ID
+	 *      #labels M
+	 *      (labels) X M
+	 *      #properties N
+	 *      (name, value type, value) X N
+	 */
+
+	for(uint64_t i = 0; i < node_count; i++) {
+		Node n;
+		NodeID id = SerializerIO_LoadUnsigned(io);
+
+		// Extend this logic when multi-label support is added.
+		// #labels M
+		uint64_t nodeLabelCount = SerializerIO_LoadUnsigned(io);
+
+		// * (labels) x M
+		// M will currently always be 0 or 1
+		uint64_t l = (nodeLabelCount) ? SerializerIO_LoadUnsigned(io) : GRAPH_NO_LABEL;
+		Serializer_Graph_SetNode(gc->g, id, l, &n);
+
+		_RdbLoadEntity(io, gc, (GraphEntity *)&n);
+	}
+}
+
+void RdbLoadDeletedNodes_v9(SerializerIO *io, GraphContext *gc, uint64_t deleted_node_count) {
+	/* Format:
+	* node id X N */
+	for(uint64_t i = 0; i < deleted_node_count; i++) {
+		NodeID id = SerializerIO_LoadUnsigned(io);
+		Serializer_Graph_MarkNodeDeleted(gc->g, id);
+	}
+}
+
+void RdbLoadEdges_v9(SerializerIO *io, GraphContext *gc, uint64_t edge_count) {
+	/* Format:
+	 * {
+	 *  edge ID
+	 *  source node ID
+	 *  destination node ID
+	 *  relation type
+	 * } X N
+	 * edge properties X N */
+
+	// Allocate edges, connections are formed in bulk once decoding ends.
+	for(uint64_t i = 0; i < edge_count; i++) {
+		Edge e;
+		EdgeID edgeId = SerializerIO_LoadUnsigned(io);
+		NodeID srcId = SerializerIO_LoadUnsigned(io);
+		NodeID destId = SerializerIO_LoadUnsigned(io);
+		uint64_t relation = SerializerIO_LoadUnsigned(io);
+		Serializer_Graph_AllocEdge(gc->g, edgeId, srcId, destId, relation, &e);
+		GraphDecodeContext_AddPendingEdge(gc->decoding_context, relation, srcId,
+										  destId, edgeId);
+		_RdbLoadEntity(io, gc, (GraphEntity *)&e);
+	}
+}
+
+void RdbLoadDeletedEdges_v9(SerializerIO *io, GraphContext *gc, uint64_t deleted_edge_count) {
+	/* Format:
+	 * edge id X N */
+	for(uint64_t i = 0; i < deleted_edge_count; i++) {
+		EdgeID id = SerializerIO_LoadUnsigned(io);
+		Serializer_Graph_MarkEdgeDeleted(gc->g, id);
+	}
+}
+
@@ -6,46 +6,60 @@
 
 #include "decode_v9.h"
 
-static Schema *_RdbLoadSchema(RedisModuleIO *rdb, SchemaType type) {
+static Schema *_RdbLoadSchema(SerializerIO *io, SchemaType type) {
 	/* Format:
 	 * id
 	 * name
 	 * #indices
 	 * (index type, indexed property) X M */
 
-	int id = RedisModule_LoadUnsigned(rdb);
-	char *name = RedisModule_LoadStringBuffer(rdb, NULL);
-	Schema *s = Schema_New(name, id);
+	int id = SerializerIO_LoadUnsigned(io);
+	char *name = SerializerIO_LoadStringBuffer(io, NULL);
+	Schema *s = Schema_New(name, id, type);
 	RedisModule_Free(name);
 
 	Index *idx = NULL;
-	uint index_count = RedisModule_LoadUnsigned(rdb);
+	uint index_count = SerializerIO_LoadUnsigned(io);
 	for(uint i = 0; i < index_count; i++) {
-		IndexType type = RedisModule_LoadUnsigned(rdb);
-		char *field = RedisModule_LoadStringBuffer(rdb, NULL);
+		IndexType type = SerializerIO_LoadUnsigned(io);
+		char *field = SerializerIO_LoadStringBuffer(io, NULL);
 
-		Schema_AddIndex(&idx, s, field, type);
+		if(type == IDX_COMPOSITE) {
+			// split composite key into its fields
+			const char *fields[COMPOSITE_INDEX_MAX_FIELDS];
+			uint count = 0;
+			char *f = field;
+			fields[count++] = f;
+			while((f = strchr(f, INDEX_SEPARATOR)) != NULL &&
+					count < COMPOSITE_INDEX_MAX_FIELDS) {
+				*f++ = '\0';
+				fields[count++] = f;
+			}
+			Schema_AddCompositeIndex(&idx, s, fields, count);
+		} else {
+			Schema_AddIndex(&idx, s, field, type);
+		}
 		RedisModule_Free(field);
 	}
 
 	return s;
 }
 
-static void _RdbLoadAttributeKeys(RedisModuleIO *rdb, GraphContext *gc) {
+static void _RdbLoadAttributeKeys(SerializerIO *io, GraphContext *gc) {
 	/* Format:
 	 * #attribute keys
 	 * attribute keys
 	 */
 
-	uint count = RedisModule_LoadUnsigned(rdb);
+	uint count = SerializerIO_LoadUnsigned(io);
 	for(uint i = 0; i < count; i ++) {
-		char *attr = RedisModule_LoadStringBuffer(rdb, NULL);
+		char *attr = SerializerIO_LoadStringBuffer(io, NULL);
 		GraphContext_FindOrAddAttribute(gc, attr);
 		RedisModule_Free(attr);
 	}
 }
 
-void RdbLoadGraphSchema_v9(RedisModuleIO *rdb, GraphContext *gc) {
+void RdbLoadGraphSchema_v9(SerializerIO *io, GraphContext *gc) {
 	/* Format:
 	 * attribute keys (unified schema)
 	 * #node schemas
@@ -56,23 +70,23 @@ void RdbLoadGraphSchema_v9(RedisModuleIO *rdb, GraphContext *gc) {
 	 */
 
 	// Attributes, Load the full attribute mapping.
-	_RdbLoadAttributeKeys(rdb, gc);
+	_RdbLoadAttributeKeys(io, gc);
 
 	// #Node schemas
-	uint schema_count = RedisModule_LoadUnsigned(rdb);
+	uint schema_count = SerializerIO_LoadUnsigned(io);
 
 	// Load each node schema
 	gc->node_schemas = array_ensure_cap(gc->node_schemas, schema_count);
 	for(uint i = 0; i < schema_count; i ++) {
-		gc->node_schemas = array_append(gc->node_schemas, _RdbLoadSchema(rdb, SCHEMA_NODE));
+		gc->node_schemas = array_append(gc->node_schemas, _RdbLoadSchema(io, SCHEMA_NODE));
 	}
 
 	// #Edge schemas
-	schema_count = RedisModule_LoadUnsigned(rdb);
+	schema_count = SerializerIO_LoadUnsigned(io);
 
 	// Load each edge schema
 	gc->relation_schemas = array_ensure_cap(gc->relation_schemas, schema_count);
 	for(uint i = 0; i < schema_count; i ++) {
-		gc->relation_schemas = array_append(gc->relation_schemas, _RdbLoadSchema(rdb, SCHEMA_EDGE));
+		gc->relation_schemas = array_append(gc->relation_schemas, _RdbLoadSchema(io, SCHEMA_EDGE));
 	}
 }
@@ -42,23 +42,12 @@ void GraphEncodeContext_Reset(GraphEncodeContext *ctx) {
 	ctx->offset = 0;
 	ctx->keys_processed = 0;
 	ctx->state = ENCODE_STATE_INIT;
-	ctx->multiple_edges_src_id = 0;
-	ctx->multiple_edges_dest_id = 0;
-	ctx->multiple_edges_array = NULL;
-	ctx->current_relation_matrix_id = 0;
-	ctx->multiple_edges_current_index = 0;
 
 	// Avoid leaks in case or reset during encodeing.
 	if(ctx->datablock_iterator != NULL) {
 		DataBlockIterator_Free(ctx->datablock_iterator);
 		ctx->datablock_iterator = NULL;
 	}
-
-	// Avoid leaks in case or reset during encodeing.
-	if(ctx->matrix_tuple_iterator != NULL) {
-		GxB_MatrixTupleIter_free(ctx->matrix_tuple_iterator);
-		ctx->matrix_tuple_iterator = NULL;
-	}
 }
 
 // Determine if matrix 'R' contains entries representing multiple edges
@@ -174,59 +163,6 @@ void GraphEncodeContext_SetDatablockIterator(GraphEncodeContext *ctx,
 	ctx->datablock_iterator = iter;
 }
 
-uint GraphEncodeContext_GetCurrentRelationID(const GraphEncodeContext *ctx) {
-	ASSERT(ctx);
-	return ctx->current_relation_matrix_id;
-}
-
-void GraphEncodeContext_SetCurrentRelationID(GraphEncodeContext *ctx,
-											 uint current_relation_matrix_id) {
-	ASSERT(ctx);
-	ctx->current_relation_matrix_id = current_relation_matrix_id;
-}
-
-GxB_MatrixTupleIter *GraphEncodeContext_GetMatrixTupleIterator(
-	const GraphEncodeContext *ctx) {
-	ASSERT(ctx);
-	return ctx->matrix_tuple_iterator;
-}
-
-void GraphEncodeContext_SetMatrixTupleIterator(GraphEncodeContext *ctx,
-											   GxB_MatrixTupleIter *iter) {
-	ASSERT(ctx);
-	ctx->matrix_tuple_iterator = iter;
-}
-
-void GraphEncodeContext_SetMutipleEdgesArray(GraphEncodeContext *ctx, EdgeID *edges,
-											 uint current_index, NodeID src, NodeID dest) {
-	ASSERT(ctx);
-	ctx->multiple_edges_array = edges;
-	ctx->multiple_edges_current_index = current_index;
-	ctx->multiple_edges_src_id = src;
-	ctx->multiple_edges_dest_id = dest;
-}
-
-EdgeID *GraphEncodeContext_GetMultipleEdgesArray(const GraphEncodeContext *ctx) {
-	ASSERT(ctx);
-	return ctx->multiple_edges_array;
-}
-
-uint GraphEncodeContext_GetMultipleEdgesCurrentIndex(const GraphEncodeContext *ctx) {
-	ASSERT(ctx);
-	return ctx->multiple_edges_current_index;
-}
-
-
-NodeID GraphEncodeContext_GetMultipleEdgesSourceNode(const GraphEncodeContext *ctx) {
-	ASSERT(ctx);
-	return ctx->multiple_edges_src_id;
-}
-
-NodeID GraphEncodeContext_GetMultipleEdgesDestinationNode(const GraphEncodeContext *ctx) {
-	ASSERT(ctx);
-	return ctx->multiple_edges_dest_id;
-}
-
 bool GraphEncodeContext_Finished(const GraphEncodeContext *ctx) {
 	ASSERT(ctx);
 	return ctx->keys_processed == GraphEncodeContext_GetKeyCount(ctx);
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "encode_buffer.h"
+#include "RG.h"
+#include "../../util/rmalloc.h"
+#include <string.h>
+
+#define ENCODE_BUFFER_INITIAL_CAP 4096
+
+// type tag preceding each recorded value
+typedef enum {
+	ENCODE_UNSIGNED,
+	ENCODE_SIGNED,
+	ENCODE_DOUBLE,
+	ENCODE_STRING,
+} _EncodeTag;
+
+// make sure buf can hold n additional bytes
+static inline void _EncodeBuffer_Reserve(EncodeBuffer *buf, size_t n) {
+	if(buf->len + n <= buf->cap) return;
+	size_t cap = (buf->cap == 0) ? ENCODE_BUFFER_INITIAL_CAP : buf->cap;
+	while(cap < buf->len + n) cap *= 2;
+	buf->data = rm_realloc(buf->data, cap);
+	buf->cap = cap;
+}
+
+static inline void _EncodeBuffer_Write(EncodeBuffer *buf, _EncodeTag tag,
+		const void *v, size_t n) {
+	_EncodeBuffer_Reserve(buf, 1 + n);
+	buf->data[buf->len++] = tag;
+	memcpy(buf->data + buf->len, v, n);
+	buf->len += n;
+}
+
+void EncodeBuffer_Init(EncodeBuffer *buf) {
+	ASSERT(buf != NULL);
+	buf->data = NULL;
+	buf->len = 0;
+	buf->cap = 0;
+}
+
+void EncodeBuffer_SaveUnsigned(EncodeBuffer *buf, uint64_t v) {
+	_EncodeBuffer_Write(buf, ENCODE_UNSIGNED, &v, sizeof(v));
+}
+
+void EncodeBuffer_SaveSigned(EncodeBuffer *buf, int64_t v) {
+	_EncodeBuffer_Write(buf, ENCODE_SIGNED, &v, sizeof(v));
+}
+
+void EncodeBuffer_SaveDouble(EncodeBuffer *buf, double v) {
+	_EncodeBuffer_Write(buf, ENCODE_DOUBLE, &v, sizeof(v));
+}
+
+void EncodeBuffer_SaveStringBuffer(EncodeBuffer *buf, const char *str,
+		size_t len) {
+	uint64_t n = len;
+	_EncodeBuffer_Write(buf, ENCODE_STRING, &n, sizeof(n));
+	_EncodeBuffer_Reserve(buf, len);
+	memcpy(buf->data + buf->len, str, len);
+	buf->len += len;
+}
+
+void EncodeBuffer_SaveRecorded(EncodeBuffer *buf, const char *data,
+		size_t len) {
+	_EncodeBuffer_Reserve(buf, len);
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+}
+
+void EncodeBuffer_Flush(EncodeBuffer *buf, RedisModuleIO *rdb) {
+	ASSERT(buf != NULL && rdb != NULL);
+
+	const char *p = buf->data;
+	const char *end = buf->data + buf->len;
+
+	while(p < end) {
+		_EncodeTag tag = *p++;
+		switch(tag) {
+		case ENCODE_UNSIGNED: {
+			uint64_t v;
+			memcpy(&v, p, sizeof(v));
+			RedisModule_SaveUnsigned(rdb, v);
+			p += sizeof(v);
+			break;
+		}
+		case ENCODE_SIGNED: {
+			int64_t v;
+			memcpy(&v, p, sizeof(v));
+			RedisModule_SaveSigned(rdb, v);
+			p += sizeof(v);
+			break;
+		}
+		case ENCODE_DOUBLE: {
+			double v;
+			memcpy(&v, p, sizeof(v));
+			RedisModule_SaveDouble(rdb, v);
+			p += sizeof(v);
+			break;
+		}
+		case ENCODE_STRING: {
+			uint64_t n;
+			memcpy(&n, p, sizeof(n));
+			p += sizeof(n);
+			RedisModule_SaveStringBuffer(rdb, p, n);
+			p += n;
+			break;
+		}
+		default:
+			ASSERT(false && "unknown encode buffer tag");
+			break;
+		}
+	}
+
+	buf->len = 0;
+}
+
+void EncodeBuffer_Free(EncodeBuffer *buf) {
+	ASSERT(buf != NULL);
+	rm_free(buf->data);
+	buf->data = NULL;
+	buf->len = 0;
+	buf->cap = 0;
+}
+
+
+void EncodeBufferReader_Init(EncodeBufferReader *reader, const char *data,
+		size_t len) {
+	ASSERT(reader != NULL);
+	reader->p = data;
+	reader->end = data + len;
+	reader->error = false;
+}
+
+// consume a value of type tag, returns NULL if no such value is next
+static const char *_EncodeBufferReader_Read(EncodeBufferReader *reader,
+		_EncodeTag tag, size_t n) {
+	if(reader->error) return NULL;
+	if(reader->end - reader->p < (ptrdiff_t)(1 + n) || *reader->p != tag) {
+		reader->error = true;
+		return NULL;
+	}
+	const char *v = reader->p + 1;
+	reader->p += 1 + n;
+	return v;
+}
+
+uint64_t EncodeBufferReader_LoadUnsigned(EncodeBufferReader *reader) {
+	uint64_t v = 0;
+	const char *p = _EncodeBufferReader_Read(reader, ENCODE_UNSIGNED, sizeof(v));
+	if(p) memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+int64_t EncodeBufferReader_LoadSigned(EncodeBufferReader *reader) {
+	int64_t v = 0;
+	const char *p = _EncodeBufferReader_Read(reader, ENCODE_SIGNED, sizeof(v));
+	if(p) memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+double EncodeBufferReader_LoadDouble(EncodeBufferReader *reader) {
+	double v = 0;
+	const char *p = _EncodeBufferReader_Read(reader, ENCODE_DOUBLE, sizeof(v));
+	if(p) memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+char *EncodeBufferReader_LoadStringBuffer(EncodeBufferReader *reader,
+		size_t *len) {
+	uint64_t n = 0;
+	const char *p = _EncodeBufferReader_Read(reader, ENCODE_STRING, sizeof(n));
+	if(p) {
+		memcpy(&n, p, sizeof(n));
+		if((uint64_t)(reader->end - reader->p) < n) {
+			reader->error = true;
+			n = 0;
+		}
+	}
+
+	// strings are saved with their NULL terminator, terminate regardless
+	char *str = rm_malloc(n + 1);
+	if(!reader->error) {
+		memcpy(str, reader->p, n);
+		reader->p += n;
+	}
+	str[n] = '\0';
+
+	if(len) *len = n;
+	return str;
+}
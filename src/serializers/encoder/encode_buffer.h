@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../../redismodule.h"
+
+// EncodeBuffer records a sequence of RDB save calls in memory
+// RDB IO can only be used by a single thread, buffers allow independent
+// sections of a graph to be encoded concurrently, each into its own buffer
+// once encoded, buffers are replayed into the RDB in order
+// producing the exact same stream as saving directly
+typedef struct {
+	char *data;  // recorded values
+	size_t len;  // number of bytes in use
+	size_t cap;  // allocated size
+} EncodeBuffer;
+
+// initialize an empty buffer
+void EncodeBuffer_Init
+(
+	EncodeBuffer *buf  // buffer to initialize
+);
+
+// record RedisModule_SaveUnsigned
+void EncodeBuffer_SaveUnsigned
+(
+	EncodeBuffer *buf,  // buffer to write to
+	uint64_t v          // value to save
+);
+
+// record RedisModule_SaveSigned
+void EncodeBuffer_SaveSigned
+(
+	EncodeBuffer *buf,  // buffer to write to
+	int64_t v           // value to save
+);
+
+// record RedisModule_SaveDouble
+void EncodeBuffer_SaveDouble
+(
+	EncodeBuffer *buf,  // buffer to write to
+	double v            // value to save
+);
+
+// record RedisModule_SaveStringBuffer
+void EncodeBuffer_SaveStringBuffer
+(
+	EncodeBuffer *buf,  // buffer to write to
+	const char *str,    // string to save
+	size_t len          // string length
+);
+
+// append len bytes of values recorded by another buffer
+void EncodeBuffer_SaveRecorded
+(
+	EncodeBuffer *buf,  // buffer to write to
+	const char *data,   // recorded values
+	size_t len          // number of bytes
+);
+
+// replay recorded values into rdb and empty the buffer
+void EncodeBuffer_Flush
+(
+	EncodeBuffer *buf,  // buffer to replay
+	RedisModuleIO *rdb  // RDB to write to
+);
+
+// free buffer's internal storage
+void EncodeBuffer_Free
+(
+	EncodeBuffer *buf  // buffer to free
+);
+
+// EncodeBufferReader loads values recorded by an EncodeBuffer
+// in the order they were saved, mirroring the RDB load calls
+// loading past the end or a value of the wrong type marks the reader
+// as failed, from that point on loads return zeroed values
+typedef struct {
+	const char *p;    // next value
+	const char *end;  // end of recorded values
+	bool error;       // a load failed
+} EncodeBufferReader;
+
+// initialize a reader over len bytes of recorded values
+void EncodeBufferReader_Init
+(
+	EncodeBufferReader *reader,  // reader to initialize
+	const char *data,            // recorded values
+	size_t len                   // number of bytes
+);
+
+// mirror RedisModule_LoadUnsigned
+uint64_t EncodeBufferReader_LoadUnsigned
+(
+	EncodeBufferReader *reader
+);
+
+// mirror RedisModule_LoadSigned
+int64_t EncodeBufferReader_LoadSigned
+(
+	EncodeBufferReader *reader
+);
+
+// mirror RedisModule_LoadDouble
+double EncodeBufferReader_LoadDouble
+(
+	EncodeBufferReader *reader
+);
+
+// mirror RedisModule_LoadStringBuffer, the returned string is owned by the
+// caller, a failed load returns an empty string
+char *EncodeBufferReader_LoadStringBuffer
+(
+	EncodeBufferReader *reader,
+	size_t *len                  // [optional] loaded string length
+);
+
@@ -5,9 +5,20 @@
  */
 
 #include "encode_graph.h"
-#include "v9/encode_v9.h"
+#include "v10/encode_v10.h"
 
 void RdbSaveGraph(RedisModuleIO *rdb, void *value) {
-	return RdbSaveGraph_v9(rdb, value);
+	SerializerIO io;
+	SerializerIO_FromRdb(&io, rdb);
+	EncodeGraph(&io, value);
+}
+
+void EncodeGraph(SerializerIO *io, void *value) {
+	GraphContext *gc = value;
+	RdbSaveGraph_v10(io, gc, gc->graph_name);
+}
+
+void EncodeGraphAs(SerializerIO *io, void *value, const char *graph_name) {
+	RdbSaveGraph_v10(io, value, graph_name);
 }
 
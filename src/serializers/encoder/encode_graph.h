@@ -9,3 +9,10 @@
 #include "../serializers_include.h"
 
 void RdbSaveGraph(RedisModuleIO *rdb, void *value);
+
+// Encode the graph's next key into io, see RdbSaveGraph.
+void EncodeGraph(SerializerIO *io, void *value);
+
+// Encode the graph's next key into io, as if the graph was named graph_name
+// such that it decodes into a different graph, see GRAPH.COPY.
+void EncodeGraphAs(SerializerIO *io, void *value, const char *graph_name);
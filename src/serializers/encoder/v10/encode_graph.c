@@ -4,7 +4,8 @@
 * This file is available under the Redis Labs Source Available License Agreement
 */
 
-#include "encode_v9.h"
+#include "encode_v10.h"
+#include "../../../util/trace.h"
 
 extern bool process_is_child; // Global variable declared in module.c
 
@@ -14,7 +15,7 @@ static inline bool _shouldAcquireLocks(void) {
 	return !process_is_child;
 }
 
-static void _RdbSaveHeader(RedisModuleIO *rdb, GraphEncodeContext *ctx) {
+static void _RdbSaveHeader(SerializerIO *io, GraphEncodeContext *ctx) {
 	/* Header format:
 	 * Graph name
 	 * Node count
@@ -30,28 +31,28 @@ static void _RdbSaveHeader(RedisModuleIO *rdb, GraphEncodeContext *ctx) {
 	GraphEncodeHeader *header = &(ctx->header);
 
 	// Graph name.
-	RedisModule_SaveStringBuffer(rdb, header->graph_name, strlen(header->graph_name) + 1);
+	SerializerIO_SaveStringBuffer(io, header->graph_name, strlen(header->graph_name) + 1);
 
 	// Node count.
-	RedisModule_SaveUnsigned(rdb, header->node_count);
+	SerializerIO_SaveUnsigned(io, header->node_count);
 
 	// Edge count.
-	RedisModule_SaveUnsigned(rdb, header->edge_count);
+	SerializerIO_SaveUnsigned(io, header->edge_count);
 
 	// Label matrix count.
-	RedisModule_SaveUnsigned(rdb, header->label_matrix_count);
+	SerializerIO_SaveUnsigned(io, header->label_matrix_count);
 
 	// Relation matrix count.
-	RedisModule_SaveUnsigned(rdb, header->relationship_matrix_count);
+	SerializerIO_SaveUnsigned(io, header->relationship_matrix_count);
 
 	// Does relationship Ri holds mutiple edges under a single entry X N.
 	for(int i = 0; i < header->relationship_matrix_count; i++) {
 		// true if R[i] contain a multi edge entry
-		RedisModule_SaveUnsigned(rdb, header->multi_edge[i]);
+		SerializerIO_SaveUnsigned(io, header->multi_edge[i]);
 	}
 
 	// Number of keys.
-	RedisModule_SaveUnsigned(rdb, header->key_count);
+	SerializerIO_SaveUnsigned(io, header->key_count);
 }
 
 // Returns the a state information regarding the number of entities required to encode in this state.
@@ -74,6 +75,9 @@ static PayloadInfo _StatePayloadInfo(GraphContext *gc, EncodeState state,
 	case ENCODE_STATE_GRAPH_SCHEMA:
 		required_entities_count = 1;
 		break;
+	case ENCODE_STATE_RELATION_MATRICES:
+		required_entities_count = Graph_RelationTypeCount(gc->g);
+		break;
 	default:
 		ASSERT(false && "Unknown encoding state in _CurrentStatePayloadInfo");
 		break;
@@ -87,7 +91,7 @@ static PayloadInfo _StatePayloadInfo(GraphContext *gc, EncodeState state,
 }
 
 // This function saves the key content schema and returns it so the encoder can know how to encode the key.
-static PayloadInfo *_RdbSaveKeySchema(RedisModuleIO *rdb, GraphContext *gc) {
+static PayloadInfo *_RdbSaveKeySchema(SerializerIO *io, GraphContext *gc) {
 	/*  Format:
 	 *  #Number of payloads info - N
 	 *  N * Payload info:
@@ -126,32 +130,33 @@ static PayloadInfo *_RdbSaveKeySchema(RedisModuleIO *rdb, GraphContext *gc) {
 
 	// Save the number of payloads.
 	uint payloads_count = array_len(payloads);
-	RedisModule_SaveUnsigned(rdb, payloads_count);
+	SerializerIO_SaveUnsigned(io, payloads_count);
 	for(uint i = 0; i < payloads_count; i++) {
 		// For each payload, save its type and the number of entities it contains.
 		PayloadInfo payload_info = payloads[i];
-		RedisModule_SaveUnsigned(rdb, payload_info.state);
-		RedisModule_SaveUnsigned(rdb, payload_info.entities_count);
+		SerializerIO_SaveUnsigned(io, payload_info.state);
+		SerializerIO_SaveUnsigned(io, payload_info.entities_count);
 	}
 
 	return payloads;
 }
 
-void RdbSaveGraph_v9(RedisModuleIO *rdb, void *value) {
+void RdbSaveGraph_v10(SerializerIO *io, void *value, const char *graph_name) {
 	/* Encoding format for graph context and graph meta key:
 	 *  Header
 	 *  Payload(s) count: N
 	 *  Key content X N:
-	 *      Payload type (Nodes / Edges / Deleted nodes/ Deleted edges/ Graph schema)
+	 *      Payload type (Nodes / Edges / Deleted nodes/ Deleted edges/ Graph schema/ Relation matrices)
 	 *      Entities in payload
 	 *  Payload(s) X N
 	 *
 	 * This function will encode each payload type (if needed) in the following order:
 	 * 1. Nodes
 	 * 2. Deleted nodes
-	 * 3. Edges
+	 * 3. Edges, attributes alone
 	 * 4. Deleted edges
 	 * 5. Graph schema.
+	 * 6. Relation matrices, the edges' connections.
 	 *
 	 * Each payload type can spread over one or more keys. For example: A graph with 200,000 nodes, and the number of entities per payload
 	 * is 100,000 then there will be two nodes payloads, each containing 100,000 nodes, encoded into two different RDB meta keys.
@@ -166,40 +171,46 @@ void RdbSaveGraph_v9(RedisModuleIO *rdb, void *value) {
 
 	if(current_state == ENCODE_STATE_INIT) {
 		// Inital state, populate encoding context header
-		GraphEncodeContext_InitHeader(gc->encoding_context, gc->graph_name, gc->g);
+		GraphEncodeContext_InitHeader(gc->encoding_context, graph_name, gc->g);
 	}
 
 	// Save header
-	_RdbSaveHeader(rdb, gc->encoding_context);
+	_RdbSaveHeader(io, gc->encoding_context);
 
 	// Save payloads info for this key and retrive the key schema.
-	PayloadInfo *key_schema = _RdbSaveKeySchema(rdb, gc);
+	PayloadInfo *key_schema = _RdbSaveKeySchema(io, gc);
 
 	uint payloads_count = array_len(key_schema);
 	for(uint i = 0; i < payloads_count; i++) {
 		// If the current key encoding more than one payload type, payloads count >1 and we are in a new state, zero the entities count.
 		if(i > 0) GraphEncodeContext_SetProcessedEntitiesOffset(gc->encoding_context, 0);
 		PayloadInfo payload = key_schema[i];
+		TRACE_PROBE3(rdb__encode__start, gc->graph_name, payload.state,
+					 payload.entities_count);
 		switch(payload.state) {
 		case ENCODE_STATE_NODES:
-			RdbSaveNodes_v9(rdb, gc, payload.entities_count);
+			RdbSaveNodes_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_DELETED_NODES:
-			RdbSaveDeletedNodes_v9(rdb, gc, payload.entities_count);
+			RdbSaveDeletedNodes_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_EDGES:
-			RdbSaveEdges_v9(rdb, gc, payload.entities_count);
+			RdbSaveEdges_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_DELETED_EDGES:
-			RdbSaveDeletedEdges_v9(rdb, gc, payload.entities_count);
+			RdbSaveDeletedEdges_v10(io, gc, payload.entities_count);
 			break;
 		case ENCODE_STATE_GRAPH_SCHEMA:
-			RdbSaveGraphSchema_v9(rdb, gc);
+			RdbSaveGraphSchema_v10(io, gc);
+			break;
+		case ENCODE_STATE_RELATION_MATRICES:
+			RdbSaveRelationMatrices_v10(io, gc, payload.entities_count);
 			break;
 		default:
 			ASSERT(false && "Unknown encoding phase");
 			break;
 		}
+		TRACE_PROBE2(rdb__encode__done, gc->graph_name, payload.state);
 		// Save the current state and the number of encoded entities.
 		GraphEncodeContext_SetEncodeState(gc->encoding_context, payload.state);
 		uint64_t offset = GraphEncodeContext_GetProcessedEntitiesOffset(gc->encoding_context);
@@ -212,7 +223,7 @@ void RdbSaveGraph_v9(RedisModuleIO *rdb, void *value) {
 	GraphEncodeContext_IncreaseProcessedKeyCount(gc->encoding_context);
 	if(GraphEncodeContext_Finished(gc->encoding_context)) {
 		GraphEncodeContext_Reset(gc->encoding_context);
-		RedisModuleCtx *ctx = RedisModule_GetContextFromIO(rdb);
+		RedisModuleCtx *ctx = SerializerIO_Context(io);
 		RedisModule_Log(ctx, "notice", "Done encoding graph %s", gc->graph_name);
 	}
 
@@ -0,0 +1,334 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "encode_v10.h"
+#include "../../entity_pack.h"
+#include "../../pack_cache.h"
+#include <omp.h>
+
+// entities are collected and encoded in batches of up to ENCODE_BATCH_SIZE
+#define ENCODE_BATCH_SIZE 65536
+// minimum number of entities encoded by a single thread
+#define ENCODE_MIN_CHUNK 1024
+
+// an entity collected for encoding
+typedef struct {
+	EntityID id;     // entity ID
+	Entity *entity;  // entity attributes
+	int t;           // node label
+} _PendingEntity;
+
+// a batch of entities pending encoding
+// the batch is split into consecutive chunks, each packed by a different
+// thread, packs are written to the RDB in order, a string per chunk
+typedef struct {
+	SerializerIO *io;            // stream to write to
+	bool edges;                  // batch holds edges
+	uint count;                  // number of pending entities
+	uint cap;                    // batch capacity
+	uint nthreads;               // number of encoding threads
+	_PendingEntity *entities;    // pending entities
+	EntityPacker *packs;         // pack per chunk
+} _EncodeBatch;
+
+static void _EncodeBatch_Init(_EncodeBatch *batch, SerializerIO *io,
+		bool edges, uint64_t entities_to_encode) {
+	uint nthreads;
+	Config_Option_get(Config_OPENMP_NTHREAD, &nthreads);
+
+	batch->io        =  io;
+	batch->edges     =  edges;
+	batch->count     =  0;
+	batch->cap       =  MIN(entities_to_encode, ENCODE_BATCH_SIZE);
+	batch->nthreads  =  (nthreads > 0) ? nthreads : 1;
+	batch->entities  =  rm_malloc(sizeof(_PendingEntity) * batch->cap);
+	batch->packs     =  rm_malloc(sizeof(EntityPacker) * batch->nthreads);
+	for(uint i = 0; i < batch->nthreads; i++) {
+		EntityPacker_Init(batch->packs + i);
+	}
+}
+
+// encode pending entities and write them to the RDB
+static void _EncodeBatch_Flush(_EncodeBatch *batch) {
+	uint count = batch->count;
+	if(count == 0) return;
+
+	// avoid spliting small batches
+	uint chunks = (count + ENCODE_MIN_CHUNK - 1) / ENCODE_MIN_CHUNK;
+	if(chunks > batch->nthreads) chunks = batch->nthreads;
+
+	// RDB IO isn't thread-safe, each chunk is packed on its own
+	int n = chunks;
+	#pragma omp parallel for num_threads(chunks) schedule(static, 1)
+	for(int c = 0; c < n; c++) {
+		uint begin = ((uint64_t)count * c) / chunks;
+		uint end = ((uint64_t)count * (c + 1)) / chunks;
+		EntityPacker *pack = batch->packs + c;
+		for(uint i = begin; i < end; i++) {
+			_PendingEntity *e = batch->entities + i;
+			if(batch->edges) {
+				EntityPacker_AddEntity(pack, e->id, e->entity);
+			} else {
+				EntityPacker_AddNode(pack, e->id, e->t, e->entity);
+			}
+		}
+	}
+
+	// write chunks in order
+	for(uint c = 0; c < chunks; c++) {
+		EntityPacker *pack = batch->packs + c;
+		SerializerIO_SaveStringBuffer(batch->io, pack->data, pack->len);
+		EntityPacker_Reset(pack);
+	}
+
+	batch->count = 0;
+}
+
+// add an entity to the batch, encoding the batch once it is full
+static inline _PendingEntity *_EncodeBatch_Add(_EncodeBatch *batch) {
+	if(batch->count == batch->cap) _EncodeBatch_Flush(batch);
+	return batch->entities + batch->count++;
+}
+
+// encode remaining entities and free the batch
+static void _EncodeBatch_Free(_EncodeBatch *batch) {
+	_EncodeBatch_Flush(batch);
+	for(uint i = 0; i < batch->nthreads; i++) {
+		EntityPacker_Free(batch->packs + i);
+	}
+	rm_free(batch->packs);
+	rm_free(batch->entities);
+}
+
+// encodes the next count entities iter visits, blocks whose entities are
+// unmodified since they were cached are written as their cached pack
+static void _RdbSaveEntities_v10(SerializerIO *io, GraphContext *gc,
+		DataBlockIterator *iter, bool edges, uint64_t count) {
+	bool use_cache;
+	Config_Option_get(Config_SNAPSHOT_PACK_CACHE, &use_cache);
+	const PackCache *cache = (edges) ? gc->edge_packs : gc->node_packs;
+
+	// collect entities on this thread, encode them concurrently
+	_EncodeBatch batch;
+	_EncodeBatch_Init(&batch, io, edges, count);
+
+	EntityID id;
+	uint64_t last_block = UINT64_MAX;
+	uint64_t i = 0;
+	while(i < count) {
+		Entity *entity = (Entity *)DataBlockIterator_Next(iter, &id);
+		ASSERT(entity != NULL);
+
+		// an unmodified block, written as is if wholly due for encoding
+		uint64_t block = id / DATABLOCK_BLOCK_CAP;
+		const PackedBlock *pack;
+		if(use_cache && block != last_block &&
+		   PackCache_Get(cache, gc->g, block, &pack) &&
+		   pack->first == id && pack->count <= count - i) {
+			_EncodeBatch_Flush(&batch);
+			SerializerIO_SaveStringBuffer(io, pack->data, pack->len);
+			DataBlockIterator_Seek(iter, (block + 1) * DATABLOCK_BLOCK_CAP);
+			i += pack->count;
+			last_block = block;
+			continue;
+		}
+		last_block = block;
+
+		_PendingEntity *e = _EncodeBatch_Add(&batch);
+		e->id = id;
+		e->entity = entity;
+		if(!edges) e->t = Graph_GetNodeLabel(gc->g, id);
+		i++;
+	}
+	_EncodeBatch_Free(&batch);
+}
+
+static void _RdbSaveDeletedEntities_v10(SerializerIO *io, GraphContext *gc,
+									   uint64_t deleted_entities_to_encode, uint64_t *deleted_id_list) {
+	// Get the number of deleted entities already encoded.
+	uint64_t offset = GraphEncodeContext_GetProcessedEntitiesOffset(gc->encoding_context);
+
+	// Iterated over the required range in the datablock deleted items.
+	for(uint64_t i = offset; i < offset + deleted_entities_to_encode; i++) {
+		SerializerIO_SaveUnsigned(io, deleted_id_list[i]);
+	}
+}
+
+void RdbSaveDeletedNodes_v10(SerializerIO *io, GraphContext *gc,
+							uint64_t deleted_nodes_to_encode) {
+	/* Format:
+	 * node id X N */
+
+	if(deleted_nodes_to_encode == 0) return;
+	// Get deleted nodes list.
+	uint64_t *deleted_nodes_list = Serializer_Graph_GetDeletedNodesList(gc->g);
+	_RdbSaveDeletedEntities_v10(io, gc, deleted_nodes_to_encode, deleted_nodes_list);
+}
+
+void RdbSaveDeletedEdges_v10(SerializerIO *io, GraphContext *gc,
+							uint64_t deleted_edges_to_encode) {
+	/* Format:
+	 * edge id X N */
+
+	if(deleted_edges_to_encode == 0) return;
+	// Get deleted edges list.
+	uint64_t *deleted_edges_list = Serializer_Graph_GetDeletedEdgesList(gc->g);
+	_RdbSaveDeletedEntities_v10(io, gc, deleted_edges_to_encode, deleted_edges_list);
+}
+
+void RdbSaveNodes_v10(SerializerIO *io, GraphContext *gc, uint64_t nodes_to_encode) {
+	/* Format:
+	 * packed nodes, a string per chunk, see EntityPacker_AddNode:
+	 *  ID delta
+	 *  label + 1
+	 *  #properties N
+	 *  (name, value tag, value) X N
+	 */
+
+	if(nodes_to_encode == 0) return;
+	// Get graph's node count.
+	uint64_t graph_nodes = Graph_NodeCount(gc->g);
+	// Get the number of nodes already encoded.
+	uint64_t offset = GraphEncodeContext_GetProcessedEntitiesOffset(gc->encoding_context);
+
+	// Get datablock iterator from context, already set to offset by a previous encodeing of nodes, or create new one.
+	DataBlockIterator *iter = GraphEncodeContext_GetDatablockIterator(gc->encoding_context);
+	if(!iter) {
+		iter = Graph_ScanNodes(gc->g);
+		GraphEncodeContext_SetDatablockIterator(gc->encoding_context, iter);
+	}
+
+	_RdbSaveEntities_v10(io, gc, iter, false, nodes_to_encode);
+
+	// Check if done encodeing nodes.
+	if(offset + nodes_to_encode == graph_nodes) {
+		DataBlockIterator_Free(iter);
+		iter = NULL;
+		GraphEncodeContext_SetDatablockIterator(gc->encoding_context, iter);
+	}
+}
+
+void RdbSaveEdges_v10(SerializerIO *io, GraphContext *gc, uint64_t edges_to_encode) {
+	/* Format:
+	 * packed edges, a string per chunk, see EntityPacker_AddEntity:
+	 *  edge ID delta
+	 *  edge properties
+	 * connections are encoded by the relation matrices
+	 */
+
+	if(edges_to_encode == 0) return;
+	// Get graph's edge count.
+	uint64_t graph_edges = Graph_EdgeCount(gc->g);
+	// Get the number of edges already encoded.
+	uint64_t offset = GraphEncodeContext_GetProcessedEntitiesOffset(gc->encoding_context);
+
+	// Get datablock iterator from context, already set to offset by a previous encoding of edges, or create new one.
+	DataBlockIterator *iter = GraphEncodeContext_GetDatablockIterator(gc->encoding_context);
+	if(!iter) {
+		iter = Graph_ScanEdges(gc->g);
+		GraphEncodeContext_SetDatablockIterator(gc->encoding_context, iter);
+	}
+
+	_RdbSaveEntities_v10(io, gc, iter, true, edges_to_encode);
+
+	// Check if done encoding edges.
+	if(offset + edges_to_encode == graph_edges) {
+		DataBlockIterator_Free(iter);
+		iter = NULL;
+		GraphEncodeContext_SetDatablockIterator(gc->encoding_context, iter);
+	}
+}
+
+// saves an array of n indices as a single string
+static inline void _RdbSaveIndexArray(SerializerIO *io, const GrB_Index *arr,
+		GrB_Index n) {
+	SerializerIO_SaveStringBuffer(io, (const char *)arr, n * sizeof(GrB_Index));
+}
+
+static void _RdbSaveRelationMatrix(SerializerIO *io, GraphContext *gc, int r) {
+	/* Format:
+	 * relation type
+	 * dimension
+	 * #rows holding entries, nvec
+	 * #entries, nvals
+	 * jumbled
+	 * if nvals > 0:
+	 *  row indices, Ah[nvec]
+	 *  row pointers, Ap[nvec + 1]
+	 *  column indices, Aj[nvals]
+	 *  values, Ax[nvals]
+	 *  multi-edge runs, (#edges, edge IDs) for each multi-edge entry
+	 * arrays are saved in native byte order, as exported by GraphBLAS */
+
+	GrB_Info info;
+	UNUSED(info);
+
+	GrB_Matrix R;
+	info = GrB_Matrix_dup(&R, Graph_GetRelationMatrix(gc->g, r));
+	ASSERT(info == GrB_SUCCESS);
+
+	GrB_Type type;
+	GrB_Index nrows;
+	GrB_Index ncols;
+	GrB_Index nvec;
+	GrB_Index *Ap;
+	GrB_Index *Ah;
+	GrB_Index *Aj;
+	uint64_t  *Ax;
+	GrB_Index Ap_size;
+	GrB_Index Ah_size;
+	GrB_Index Aj_size;
+	GrB_Index Ax_size;
+	bool jumbled;
+	info = GxB_Matrix_export_HyperCSR(&R, &type, &nrows, &ncols, &Ap, &Ah, &Aj,
+			(void **)&Ax, &Ap_size, &Ah_size, &Aj_size, &Ax_size, &nvec, &jumbled,
+			NULL);
+	ASSERT(info == GrB_SUCCESS);
+	GrB_Index nvals = Ap[nvec];
+
+	SerializerIO_SaveUnsigned(io, r);
+	SerializerIO_SaveUnsigned(io, nrows);
+	SerializerIO_SaveUnsigned(io, nvec);
+	SerializerIO_SaveUnsigned(io, nvals);
+	SerializerIO_SaveUnsigned(io, jumbled);
+
+	if(nvals > 0) {
+		_RdbSaveIndexArray(io, Ah, nvec);
+		_RdbSaveIndexArray(io, Ap, nvec + 1);
+		_RdbSaveIndexArray(io, Aj, nvals);
+		_RdbSaveIndexArray(io, Ax, nvals);
+
+		// run IDs are local to the relation's MultiEdgeTable,
+		// runs are saved by value in entry order
+		EdgeID *runs = array_new(EdgeID, 0);
+		for(GrB_Index k = 0; k < nvals; k++) {
+			if(SINGLE_EDGE(Ax[k])) continue;
+			uint32_t edge_count;
+			const EdgeID *ids = Graph_MultiEdgeIDs(gc->g, r, Ax[k], &edge_count);
+			runs = array_append(runs, edge_count);
+			for(uint32_t i = 0; i < edge_count; i++) runs = array_append(runs, ids[i]);
+		}
+		_RdbSaveIndexArray(io, runs, array_len(runs));
+		array_free(runs);
+	}
+
+	rm_free(Ap);
+	rm_free(Ah);
+	rm_free(Aj);
+	rm_free(Ax);
+}
+
+void RdbSaveRelationMatrices_v10(SerializerIO *io, GraphContext *gc,
+		uint64_t matrices_to_encode) {
+	/* Format:
+	 * relation matrix X N */
+
+	// Get the number of relation matrices already encoded.
+	uint64_t offset = GraphEncodeContext_GetProcessedEntitiesOffset(gc->encoding_context);
+	for(uint64_t r = offset; r < offset + matrices_to_encode; r++) {
+		_RdbSaveRelationMatrix(io, gc, r);
+	}
+}
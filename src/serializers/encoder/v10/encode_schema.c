@@ -0,0 +1,144 @@
+/*
+* Copyright 2018-2020 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "encode_v10.h"
+
+static void _RdbSaveAttributeKeys(SerializerIO *io, GraphContext *gc) {
+	/* Format:
+	 * #attribute keys
+	 * attribute keys
+	*/
+
+	uint count = GraphContext_AttributeCount(gc);
+	SerializerIO_SaveUnsigned(io, count);
+	for(uint i = 0; i < count; i ++) {
+		const char *key = GraphContext_GetAttributeString(gc, i);
+		SerializerIO_SaveStringBuffer(io, key, strlen(key) + 1);
+	}
+}
+
+static inline void _RdbSaveIndexData(SerializerIO *io, Index *idx) {
+	if(!idx) return;
+
+	for(uint i = 0; i < idx->fields_count; i++) {
+		// Index type
+		SerializerIO_SaveUnsigned(io, idx->type);
+		// Indexed property
+		SerializerIO_SaveStringBuffer(io, idx->fields[i], strlen(idx->fields[i]) + 1);
+	}
+}
+
+static inline void _RdbSaveCompositeIndexData(SerializerIO *io, GraphContext *gc,
+		Index *idx) {
+	if(!idx) return;
+
+	// composite key fields are concatenated, separated by INDEX_SEPARATOR
+	CompositeIndex **composites = Index_GetCompositeIndices(idx);
+	uint composite_count = array_len(composites);
+	for(uint i = 0; i < composite_count; i++) {
+		CompositeIndex *ci = composites[i];
+		size_t len = 0;
+		for(uint j = 0; j < ci->key_count; j++) {
+			len += strlen(GraphContext_GetAttributeString(gc, ci->attributes[j])) + 1;
+		}
+
+		char fields[len];
+		len = 0;
+		for(uint j = 0; j < ci->key_count; j++) {
+			const char *field = GraphContext_GetAttributeString(gc, ci->attributes[j]);
+			if(j > 0) fields[len++] = INDEX_SEPARATOR;
+			len += sprintf(fields + len, "%s", field);
+		}
+
+		// Index type
+		SerializerIO_SaveUnsigned(io, IDX_COMPOSITE);
+		// Indexed properties
+		SerializerIO_SaveStringBuffer(io, fields, len + 1);
+	}
+}
+
+static inline void _RdbSaveConstraintData(SerializerIO *io, GraphContext *gc,
+		Schema *s) {
+	if(!s->constraints) return;
+
+	uint constraint_count = array_len(s->constraints);
+	for(uint i = 0; i < constraint_count; i++) {
+		const char *field = GraphContext_GetAttributeString(gc,
+				s->constraints[i]->attribute);
+		// Index type
+		SerializerIO_SaveUnsigned(io, IDX_UNIQUE);
+		// Constrained property
+		SerializerIO_SaveStringBuffer(io, field, strlen(field) + 1);
+	}
+}
+
+static void _RdbSaveSchema(SerializerIO *io, GraphContext *gc, Schema *s) {
+	/* Format:
+	 * id
+	 * name
+	 * #indices
+	 * (index type, indexed property) X M
+	 * composite indices are saved as (IDX_COMPOSITE, separated properties)
+	 * uniqueness constraints are saved as (IDX_UNIQUE, constrained property) */
+
+	// Schema ID.
+	SerializerIO_SaveUnsigned(io, s->id);
+
+	// Schema name.
+	SerializerIO_SaveStringBuffer(io, s->name, strlen(s->name) + 1);
+
+	// Number of indices, constraints included.
+	uint constraint_count = (s->constraints) ? array_len(s->constraints) : 0;
+	SerializerIO_SaveUnsigned(io, Schema_IndexCount(s) + constraint_count);
+
+	// Exact match indices.
+	_RdbSaveIndexData(io, s->index);
+
+	// Composite indices, following their exact match fields.
+	_RdbSaveCompositeIndexData(io, gc, s->index);
+
+	// Fulltext indices.
+	_RdbSaveIndexData(io, s->fulltextIdx);
+
+	// Vector indices.
+	_RdbSaveIndexData(io, s->vectorIdx);
+
+	// Uniqueness constraints.
+	_RdbSaveConstraintData(io, gc, s);
+}
+
+void RdbSaveGraphSchema_v10(SerializerIO *io, GraphContext *gc) {
+	/* Format:
+	 * attribute keys (unified schema)
+	 * #node schemas
+	 * node schema X #node schemas
+	 * #relation schemas
+	 * relation schema X #relation schemas
+	*/
+
+	// Serialize all attribute keys
+	_RdbSaveAttributeKeys(io, gc);
+
+	// #Node schemas.
+	unsigned short schema_count = GraphContext_SchemaCount(gc, SCHEMA_NODE);
+	SerializerIO_SaveUnsigned(io, schema_count);
+
+	// Name of label X #node schemas.
+	for(int i = 0; i < schema_count; i++) {
+		Schema *s = gc->node_schemas[i];
+		_RdbSaveSchema(io, gc, s);
+	}
+
+	// #Relation schemas.
+	unsigned short relation_count = GraphContext_SchemaCount(gc, SCHEMA_EDGE);
+	SerializerIO_SaveUnsigned(io, relation_count);
+
+	// Name of label X #relation schemas.
+	for(unsigned short i = 0; i < relation_count; i++) {
+		Schema *s = gc->relation_schemas[i];
+		_RdbSaveSchema(io, gc, s);
+	}
+}
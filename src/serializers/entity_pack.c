@@ -0,0 +1,437 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "entity_pack.h"
+#include "../RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../datatypes/array.h"
+#include "../datatypes/point.h"
+#include <string.h>
+
+// initial size of a pack
+#define PACK_INITIAL_CAP 4096
+// strings longer than this are never added to a pack's dictionary
+#define PACK_DICT_MAX_STRLEN 128
+// maximum number of dictionary entries per pack
+#define PACK_DICT_MAX_ENTRIES 65536
+
+// value tags
+typedef enum {
+	PACK_NULL = 0,     // no payload
+	PACK_FALSE,        // no payload
+	PACK_TRUE,         // no payload
+	PACK_INT,          // zigzag varint
+	PACK_DOUBLE,       // 8 bytes
+	PACK_STRING,       // varint length, bytes, NULL terminator
+	PACK_STRING_DEF,   // as PACK_STRING, adds the string to the dictionary
+	PACK_STRING_REF,   // varint dictionary index
+	PACK_ARRAY,        // varint length, values
+	PACK_POINT,        // latitude and longitude, 4 bytes each
+	PACK_LONG_ARRAY,   // varint length, zigzag varint per element
+	PACK_DOUBLE_ARRAY, // varint length, 8 bytes per element
+} PackTag;
+
+static inline uint64_t _Zigzag(int64_t v) {
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t _Unzigzag(uint64_t v) {
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+//------------------------------------------------------------------------------
+// packer
+//------------------------------------------------------------------------------
+
+static inline void _Packer_Reserve(EntityPacker *packer, size_t n) {
+	if(packer->len + n <= packer->cap) return;
+	while(packer->len + n > packer->cap) packer->cap *= 2;
+	packer->data = rm_realloc(packer->data, packer->cap);
+}
+
+static inline void _Packer_Byte(EntityPacker *packer, uint8_t b) {
+	_Packer_Reserve(packer, 1);
+	packer->data[packer->len++] = b;
+}
+
+static inline void _Packer_Bytes(EntityPacker *packer, const void *p, size_t n) {
+	_Packer_Reserve(packer, n);
+	memcpy(packer->data + packer->len, p, n);
+	packer->len += n;
+}
+
+static inline void _Packer_Varint(EntityPacker *packer, uint64_t v) {
+	_Packer_Reserve(packer, 10);
+	while(v >= 0x80) {
+		packer->data[packer->len++] = (char)(v | 0x80);
+		v >>= 7;
+	}
+	packer->data[packer->len++] = (char)v;
+}
+
+static void _Packer_String(EntityPacker *packer, const char *s) {
+	size_t len = strlen(s);
+
+	if(len <= PACK_DICT_MAX_STRLEN) {
+		void *idx = raxFind(packer->strings, (unsigned char *)s, len);
+		if(idx != raxNotFound) {
+			// repeated string, refer to its dictionary entry
+			_Packer_Byte(packer, PACK_STRING_REF);
+			_Packer_Varint(packer, (uint64_t)(uintptr_t)idx);
+			return;
+		}
+	}
+
+	PackTag tag = PACK_STRING;
+	if(len <= PACK_DICT_MAX_STRLEN &&
+	   packer->dict_size < PACK_DICT_MAX_ENTRIES) {
+		raxInsert(packer->strings, (unsigned char *)s, len,
+				  (void *)(uintptr_t)packer->dict_size++, NULL);
+		tag = PACK_STRING_DEF;
+	}
+
+	_Packer_Byte(packer, tag);
+	_Packer_Varint(packer, len);
+	_Packer_Bytes(packer, s, len + 1);
+}
+
+static void _Packer_Value(EntityPacker *packer, SIValue v) {
+	switch(SI_TYPE(v)) {
+	case T_BOOL:
+		_Packer_Byte(packer, v.longval ? PACK_TRUE : PACK_FALSE);
+		return;
+	case T_INT64:
+		_Packer_Byte(packer, PACK_INT);
+		_Packer_Varint(packer, _Zigzag(v.longval));
+		return;
+	case T_DOUBLE:
+		_Packer_Byte(packer, PACK_DOUBLE);
+		_Packer_Bytes(packer, &v.doubleval, sizeof(double));
+		return;
+	case T_STRING:
+		_Packer_String(packer, v.stringval);
+		return;
+	case T_ARRAY: {
+		uint len = SIArray_Length(v);
+		// packed lists are written without per element tags
+		const int64_t *longs = SIArray_Longs(v);
+		if(longs != NULL) {
+			_Packer_Byte(packer, PACK_LONG_ARRAY);
+			_Packer_Varint(packer, len);
+			for(uint i = 0; i < len; i++) _Packer_Varint(packer, _Zigzag(longs[i]));
+			return;
+		}
+		const double *doubles = SIArray_Doubles(v);
+		if(doubles != NULL) {
+			_Packer_Byte(packer, PACK_DOUBLE_ARRAY);
+			_Packer_Varint(packer, len);
+			_Packer_Bytes(packer, doubles, sizeof(double) * len);
+			return;
+		}
+		_Packer_Byte(packer, PACK_ARRAY);
+		_Packer_Varint(packer, len);
+		for(uint i = 0; i < len; i++) _Packer_Value(packer, SIArray_Get(v, i));
+		return;
+	}
+	case T_POINT: {
+		float lat = Point_lat(v);
+		float lon = Point_lon(v);
+		_Packer_Byte(packer, PACK_POINT);
+		_Packer_Bytes(packer, &lat, sizeof(float));
+		_Packer_Bytes(packer, &lon, sizeof(float));
+		return;
+	}
+	case T_NULL:
+		_Packer_Byte(packer, PACK_NULL);
+		return;
+	default:
+		ASSERT(0 && "Attempted to serialize value of invalid type.");
+	}
+}
+
+static void _Packer_Properties(EntityPacker *packer, const Entity *e) {
+	_Packer_Varint(packer, e->prop_count);
+	for(int i = 0; i < e->prop_count; i++) {
+		EntityProperty *attr = e->properties + i;
+		_Packer_Varint(packer, attr->id);
+		_Packer_Value(packer, EntityProperty_Value(attr));
+	}
+}
+
+void EntityPacker_Init(EntityPacker *packer) {
+	ASSERT(packer != NULL);
+
+	packer->len       =  0;
+	packer->cap       =  PACK_INITIAL_CAP;
+	packer->data      =  rm_malloc(packer->cap);
+	packer->strings   =  raxNew();
+	packer->dict_size =  0;
+	packer->last_id   =  0;
+}
+
+void EntityPacker_AddNode(EntityPacker *packer, NodeID id, int label,
+		const Entity *e) {
+	ASSERT(packer != NULL && e != NULL);
+
+	// nodes are packed in ascending ID order, deltas are usually 1
+	_Packer_Varint(packer, _Zigzag(id - packer->last_id));
+	_Packer_Varint(packer, label + 1);  // GRAPH_NO_LABEL packs as 0
+	_Packer_Properties(packer, e);
+	packer->last_id = id;
+}
+
+void EntityPacker_AddEntity(EntityPacker *packer, EntityID id,
+		const Entity *e) {
+	ASSERT(packer != NULL && e != NULL);
+
+	// entities are packed in DataBlock order, deltas are usually 1
+	_Packer_Varint(packer, _Zigzag(id - packer->last_id));
+	_Packer_Properties(packer, e);
+	packer->last_id = id;
+}
+
+void EntityPacker_Reset(EntityPacker *packer) {
+	ASSERT(packer != NULL);
+
+	packer->len = 0;
+	packer->dict_size = 0;
+	packer->last_id = 0;
+	raxFree(packer->strings);
+	packer->strings = raxNew();
+}
+
+void EntityPacker_Free(EntityPacker *packer) {
+	ASSERT(packer != NULL);
+
+	raxFree(packer->strings);
+	rm_free(packer->data);
+}
+
+//------------------------------------------------------------------------------
+// unpacker
+//------------------------------------------------------------------------------
+
+static inline bool _Unpacker_Need(EntityUnpacker *unpacker, size_t n) {
+	if(unpacker->error || (size_t)(unpacker->end - unpacker->p) < n) {
+		unpacker->error = true;
+		return false;
+	}
+	return true;
+}
+
+static inline uint8_t _Unpacker_Byte(EntityUnpacker *unpacker) {
+	if(!_Unpacker_Need(unpacker, 1)) return 0;
+	return *unpacker->p++;
+}
+
+static inline uint64_t _Unpacker_Varint(EntityUnpacker *unpacker) {
+	uint64_t v = 0;
+	for(uint shift = 0; shift < 64; shift += 7) {
+		if(!_Unpacker_Need(unpacker, 1)) return 0;
+		uint8_t b = *unpacker->p++;
+		v |= (uint64_t)(b & 0x7F) << shift;
+		if(!(b & 0x80)) return v;
+	}
+	unpacker->error = true;
+	return 0;
+}
+
+// returns a string of the pack, NULL terminated, of length len
+static const char *_Unpacker_String(EntityUnpacker *unpacker, uint32_t *len) {
+	uint64_t n = _Unpacker_Varint(unpacker);
+	if(unpacker->error || n >= (uint64_t)(unpacker->end - unpacker->p) ||
+	   unpacker->p[n] != '\0') {
+		unpacker->error = true;
+		return NULL;
+	}
+	const char *s = (const char *)unpacker->p;
+	unpacker->p += n + 1;
+	*len = n;
+	return s;
+}
+
+// returns the dictionary string as a value to be stored as a property
+// long strings are interned once, each use retains a reference
+static SIValue _Unpacker_StoredString(EntityUnpacker *unpacker,
+		PackedString *entry) {
+	if(unpacker->pool == NULL || entry->len <= PROPERTY_INLINE_STRLEN) {
+		return SI_ConstStringVal((char *)entry->str);
+	}
+	if(entry->interned == NULL) {
+		entry->interned = StringPool_Intern(unpacker->pool, entry->str);
+	}
+	return SI_InternedStringVal(StringPool_Retain(entry->interned));
+}
+
+// unpacks a value, strings are shared with the pack or the string pool
+// nested values are never interned
+static SIValue _Unpacker_Value(EntityUnpacker *unpacker, bool nested) {
+	uint8_t tag = _Unpacker_Byte(unpacker);
+	switch(tag) {
+	case PACK_NULL:
+		return SI_NullVal();
+	case PACK_FALSE:
+		return SI_BoolVal(false);
+	case PACK_TRUE:
+		return SI_BoolVal(true);
+	case PACK_INT:
+		return SI_LongVal(_Unzigzag(_Unpacker_Varint(unpacker)));
+	case PACK_DOUBLE: {
+		double d = 0;
+		if(_Unpacker_Need(unpacker, sizeof(double))) {
+			memcpy(&d, unpacker->p, sizeof(double));
+			unpacker->p += sizeof(double);
+		}
+		return SI_DoubleVal(d);
+	}
+	case PACK_STRING:
+	case PACK_STRING_DEF: {
+		PackedString entry = {0};
+		entry.str = _Unpacker_String(unpacker, &entry.len);
+		if(entry.str == NULL) return SI_NullVal();
+		if(tag == PACK_STRING) return SI_ConstStringVal((char *)entry.str);
+		array_append(unpacker->strings, entry);
+		if(nested) return SI_ConstStringVal((char *)entry.str);
+		return _Unpacker_StoredString(unpacker,
+				unpacker->strings + array_len(unpacker->strings) - 1);
+	}
+	case PACK_STRING_REF: {
+		uint64_t idx = _Unpacker_Varint(unpacker);
+		if(unpacker->error || idx >= array_len(unpacker->strings)) {
+			unpacker->error = true;
+			return SI_NullVal();
+		}
+		PackedString *entry = unpacker->strings + idx;
+		if(nested) return SI_ConstStringVal((char *)entry->str);
+		return _Unpacker_StoredString(unpacker, entry);
+	}
+	case PACK_ARRAY: {
+		uint64_t len = _Unpacker_Varint(unpacker);
+		// every element takes at least a byte
+		if(!_Unpacker_Need(unpacker, len)) return SI_NullVal();
+		SIValue list = SI_Array(len);
+		for(uint64_t i = 0; i < len && !unpacker->error; i++) {
+			// elements are cloned into the array
+			SIValue elem = _Unpacker_Value(unpacker, true);
+			SIArray_Append(&list, elem);
+			SIValue_Free(elem);
+		}
+		return list;
+	}
+	case PACK_LONG_ARRAY: {
+		uint64_t len = _Unpacker_Varint(unpacker);
+		// every element takes at least a byte
+		if(!_Unpacker_Need(unpacker, len)) return SI_NullVal();
+		SIValue list = SI_Array(len);
+		for(uint64_t i = 0; i < len && !unpacker->error; i++) {
+			int64_t l = _Unzigzag(_Unpacker_Varint(unpacker));
+			SIArray_Append(&list, SI_LongVal(l));
+		}
+		return list;
+	}
+	case PACK_DOUBLE_ARRAY: {
+		uint64_t len = _Unpacker_Varint(unpacker);
+		if(len > SIZE_MAX / sizeof(double) ||
+		   !_Unpacker_Need(unpacker, len * sizeof(double))) {
+			unpacker->error = true;
+			return SI_NullVal();
+		}
+		SIValue list = SI_Array(len);
+		for(uint64_t i = 0; i < len; i++) {
+			double d;
+			memcpy(&d, unpacker->p, sizeof(double));
+			unpacker->p += sizeof(double);
+			SIArray_Append(&list, SI_DoubleVal(d));
+		}
+		return list;
+	}
+	case PACK_POINT: {
+		float lat = 0;
+		float lon = 0;
+		if(_Unpacker_Need(unpacker, 2 * sizeof(float))) {
+			memcpy(&lat, unpacker->p, sizeof(float));
+			memcpy(&lon, unpacker->p + sizeof(float), sizeof(float));
+			unpacker->p += 2 * sizeof(float);
+		}
+		return SI_Point(lat, lon);
+	}
+	default:
+		unpacker->error = true;
+		return SI_NullVal();
+	}
+}
+
+void EntityUnpacker_Init(EntityUnpacker *unpacker, const char *data,
+		size_t len, StringPool *pool) {
+	ASSERT(unpacker != NULL);
+
+	unpacker->p        =  (const unsigned char *)data;
+	unpacker->end      =  (const unsigned char *)data + len;
+	unpacker->error    =  false;
+	unpacker->pool     =  pool;
+	unpacker->strings  =  array_new(PackedString, 0);
+	unpacker->last_id  =  0;
+}
+
+bool EntityUnpacker_Done(const EntityUnpacker *unpacker) {
+	ASSERT(unpacker != NULL);
+	return unpacker->error || unpacker->p == unpacker->end;
+}
+
+bool EntityUnpacker_Failed(const EntityUnpacker *unpacker) {
+	ASSERT(unpacker != NULL);
+	return unpacker->error;
+}
+
+void EntityUnpacker_NextNode(EntityUnpacker *unpacker, NodeID *id, int *label) {
+	ASSERT(unpacker != NULL && id != NULL && label != NULL);
+
+	unpacker->last_id += _Unzigzag(_Unpacker_Varint(unpacker));
+	*id = unpacker->last_id;
+	*label = (int)_Unpacker_Varint(unpacker) - 1;
+}
+
+void EntityUnpacker_NextEntity(EntityUnpacker *unpacker, EntityID *id) {
+	ASSERT(unpacker != NULL && id != NULL);
+
+	unpacker->last_id += _Unzigzag(_Unpacker_Varint(unpacker));
+	*id = unpacker->last_id;
+}
+
+void EntityUnpacker_Properties(EntityUnpacker *unpacker, GraphEntity *e) {
+	ASSERT(unpacker != NULL && e != NULL);
+
+	uint64_t prop_count = _Unpacker_Varint(unpacker);
+	if(prop_count == 0) return;
+	// every property takes at least two bytes
+	if(!_Unpacker_Need(unpacker, prop_count * 2)) return;
+
+	int count = 0;
+	EntityProperty *properties = rm_malloc(sizeof(EntityProperty) * prop_count);
+	for(uint64_t i = 0; i < prop_count && !unpacker->error; i++) {
+		Attribute_ID attr_id = _Unpacker_Varint(unpacker);
+		SIValue attr_value = _Unpacker_Value(unpacker, false);
+		if(SIValue_IsNull(attr_value)) continue;
+		// values shared with the pack are duplicated
+		EntityProperty_Set(properties + count, attr_id, attr_value);
+		count++;
+	}
+
+	GraphEntity_AdoptProperties(e, properties, count);
+}
+
+void EntityUnpacker_Free(EntityUnpacker *unpacker) {
+	ASSERT(unpacker != NULL);
+
+	// release the dictionary's references to interned strings
+	uint count = array_len(unpacker->strings);
+	for(uint i = 0; i < count; i++) {
+		char *interned = unpacker->strings[i].interned;
+		if(interned) StringPool_Release(interned);
+	}
+	array_free(unpacker->strings);
+}
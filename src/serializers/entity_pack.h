@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rax.h"
+#include "../graph/entities/node.h"
+#include "../util/string_pool/string_pool.h"
+
+// An entity pack holds a run of nodes or edges, properties included,
+// packed into a single string, which is saved by a single SaveStringBuffer
+// integers are varint encoded, entity IDs as deltas from their predecessor
+// strings repeated within a pack are written once, then referred to by
+// their index in the pack's dictionary
+// each pack is self-contained, packs are produced concurrently
+
+typedef struct {
+	char *data;          // packed entities
+	size_t len;          // number of bytes in use
+	size_t cap;          // allocated size
+	rax *strings;        // dictionary, string bytes to index
+	uint64_t dict_size;  // number of dictionary entries
+	EntityID last_id;    // ID of the previous entity
+} EntityPacker;
+
+// initialize an empty pack
+void EntityPacker_Init
+(
+	EntityPacker *packer
+);
+
+// pack node
+void EntityPacker_AddNode
+(
+	EntityPacker *packer,
+	NodeID id,            // node ID
+	int label,            // node label, GRAPH_NO_LABEL if unlabeled
+	const Entity *e       // node attributes
+);
+
+// pack an entity by its ID and attributes alone, e.g. an edge
+// whose connection is held by its relation matrix
+void EntityPacker_AddEntity
+(
+	EntityPacker *packer,
+	EntityID id,          // entity ID
+	const Entity *e       // entity attributes
+);
+
+// discard packed entities, the packer retains its allocation
+void EntityPacker_Reset
+(
+	EntityPacker *packer
+);
+
+// free packer's internals
+void EntityPacker_Free
+(
+	EntityPacker *packer
+);
+
+// dictionary entry of an unpacker
+typedef struct {
+	const char *str;  // string bytes, within the pack
+	uint32_t len;     // string length
+	char *interned;   // interned copy, NULL if not interned
+} PackedString;
+
+typedef struct {
+	const unsigned char *p;    // next byte
+	const unsigned char *end;  // end of pack
+	bool error;                // pack is malformed
+	StringPool *pool;          // pool to intern dictionary strings into
+	PackedString *strings;     // dictionary
+	EntityID last_id;          // ID of the previous entity
+} EntityUnpacker;
+
+// initialize an unpacker over len bytes of packed entities
+// strings repeated within the pack are interned into pool, if not NULL
+void EntityUnpacker_Init
+(
+	EntityUnpacker *unpacker,
+	const char *data,         // packed entities
+	size_t len,               // number of bytes
+	StringPool *pool          // [optional] graph's string pool
+);
+
+// returns true once the pack is exhausted or found to be malformed
+bool EntityUnpacker_Done
+(
+	const EntityUnpacker *unpacker
+);
+
+// returns true if the pack is malformed
+bool EntityUnpacker_Failed
+(
+	const EntityUnpacker *unpacker
+);
+
+// unpack the next node, to be followed by EntityUnpacker_Properties
+void EntityUnpacker_NextNode
+(
+	EntityUnpacker *unpacker,
+	NodeID *id,               // [output] node ID
+	int *label                // [output] node label
+);
+
+// unpack the next entity packed by EntityPacker_AddEntity,
+// to be followed by EntityUnpacker_Properties
+void EntityUnpacker_NextEntity
+(
+	EntityUnpacker *unpacker,
+	EntityID *id              // [output] entity ID
+);
+
+// unpack the properties of the last unpacked entity into e
+void EntityUnpacker_Properties
+(
+	EntityUnpacker *unpacker,
+	GraphEntity *e            // property-less entity
+);
+
+// free unpacker's internals
+void EntityUnpacker_Free
+(
+	EntityUnpacker *unpacker
+);
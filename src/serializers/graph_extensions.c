@@ -7,6 +7,7 @@
 #include "graph_extensions.h"
 #include "../RG.h"
 #include "../util/datablock/oo_datablock.h"
+#include "../graph/multi_edge_table.h"
 
 // Functions declerations - implemented in graph.c
 void Graph_FormConnection(Graph *g, NodeID src, NodeID dest, EdgeID edge_id, int r);
@@ -24,6 +25,7 @@ void Serializer_Graph_SetNode(Graph *g, NodeID id, int label, Node *n) {
 
 	Entity *en = DataBlock_AllocateItemOutOfOrder(g->nodes, id);
 	en->prop_count = 0;
+	en->attr_mask = 0;
 	en->properties = NULL;
 	n->id = id;
 	n->entity = en;
@@ -34,18 +36,47 @@ void Serializer_Graph_SetNode(Graph *g, NodeID id, int label, Node *n) {
 	}
 }
 
-// Set a given edge in the graph - Used for deserialization of graph.
-void Serializer_Graph_SetEdge(Graph *g, EdgeID edge_id, NodeID src, NodeID dest, int r, Edge *e) {
-	GrB_Info info;
-
-	Entity *en = DataBlock_AllocateItemOutOfOrder(g->edges, edge_id);
-	en->prop_count = 0;
-	en->properties = NULL;
+// Allocate a given edge in the graph - Used for deserialization of graph.
+void Serializer_Graph_AllocEdge(Graph *g, EdgeID edge_id, NodeID src, NodeID dest, int r,
+								Edge *e) {
+	EdgeRecord *rec = DataBlock_AllocateItemOutOfOrder(g->edges, edge_id);
+	rec->entity.prop_count = 0;
+	rec->entity.attr_mask = 0;
+	rec->entity.properties = NULL;
+	rec->srcNodeID = src;
+	rec->destNodeID = dest;
+	rec->relationID = r;
 	e->id = edge_id;
-	e->entity = en;
+	e->entity = &rec->entity;
 	e->relationID = r;
 	e->srcNodeID = src;
 	e->destNodeID = dest;
+}
+
+// Allocate a given edge's attributes - Used for deserialization of graph.
+// the edge's endpoints are recorded once its relation matrix is imported
+void Serializer_Graph_AllocEdgeEntity(Graph *g, EdgeID edge_id, Edge *e) {
+	EdgeRecord *rec = DataBlock_AllocateItemOutOfOrder(g->edges, edge_id);
+	rec->entity.prop_count = 0;
+	rec->entity.attr_mask = 0;
+	rec->entity.properties = NULL;
+	rec->srcNodeID = INVALID_ENTITY_ID;
+	rec->destNodeID = INVALID_ENTITY_ID;
+	rec->relationID = GRAPH_NO_RELATION;
+	e->id = edge_id;
+	e->entity = &rec->entity;
+	e->relationID = GRAPH_NO_RELATION;
+}
+
+uint64_t Serializer_Graph_NewMultiEdgeRun(Graph *g, int r, const EdgeID *ids,
+		uint32_t count) {
+	ASSERT(g && r < Graph_RelationTypeCount(g));
+	return MultiEdgeTable_NewRun(g->relations[r]->multi_edges, ids, count);
+}
+
+// Set a given edge in the graph - Used for deserialization of graph.
+void Serializer_Graph_SetEdge(Graph *g, EdgeID edge_id, NodeID src, NodeID dest, int r, Edge *e) {
+	Serializer_Graph_AllocEdge(g, edge_id, src, dest, r, e);
 	Graph_FormConnection(g, src, dest, edge_id, r);
 }
 
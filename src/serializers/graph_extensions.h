@@ -14,6 +14,18 @@ void Serializer_Graph_SetNode(Graph *g, NodeID id, int label, Node *n);
 // Set a given edge in the graph.
 void Serializer_Graph_SetEdge(Graph *g, EdgeID edge_id, NodeID src, NodeID dest, int r, Edge *e);
 
+// Allocates a given edge without connecting it.
+// the edge is expected to be connected in bulk via Graph_BulkFormConnections.
+void Serializer_Graph_AllocEdge(Graph *g, EdgeID edge_id, NodeID src, NodeID dest, int r,
+								Edge *e);
+
+// Allocates a given edge's attributes.
+// the edge is connected by its relation matrix, see Graph_ImportRelationMatrix.
+void Serializer_Graph_AllocEdgeEntity(Graph *g, EdgeID edge_id, Edge *e);
+
+// Creates a multi-edge run of relation r holding count edge IDs, returns its ID.
+uint64_t Serializer_Graph_NewMultiEdgeRun(Graph *g, int r, const EdgeID *ids, uint32_t count);
+
 // Marks a node ID as deleted.
 void Serializer_Graph_MarkNodeDeleted(Graph *g, NodeID ID);
 
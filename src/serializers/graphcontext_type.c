@@ -8,14 +8,31 @@
 #include "../version.h"
 #include "encoding_version.h"
 #include "encoder/encode_graph.h"
+#include "encoder/encode_buffer.h"
 #include "decoders/decode_graph.h"
 #include "decoders/decode_previous.h"
 #include "../util/redis_version.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include "../commands/execution_ctx.h"
+#include "../graph/materialized_view.h"
+#include "../query_ctx.h"
+#include "../errors.h"
 
 // forward declerations of the module event handler functions
 void ModuleEventHandler_AUXBeforeKeyspaceEvent(void);
 void ModuleEventHandler_AUXAfterKeyspaceEvent(void);
 
+extern GraphContext **graphs_in_keyspace;
+
+// version of the aux fields saved after the keyspace
+// 0  - hot queries of each graph
+// 1  - hot queries and materialized views of each graph
+#define AUX_VERSION_LATEST 1
+
+// aux version of the RDB being loaded, saved before its keyspace
+static uint64_t _aux_version = 0;
+
 // declaration of the type for redis registration
 RedisModuleType *GraphContextRedisModuleType;
 
@@ -44,25 +61,177 @@ static void *_GraphContextType_RdbLoad(RedisModuleIO *rdb, int encver) {
 	return gc;
 }
 
+// Replays the encoding of an evicted graph, as it was encoded when evicted
+// evicted graphs are saved as a single key
+// an encoding which can't be read can't be replaced, the save is aborted
+static void _GraphContextType_SaveEvicted(EncodeBuffer *buf, GraphContext *gc) {
+	bool read = GraphContext_EvictedEncoding(gc, buf);
+	if(!read) {
+		RedisModule_Log(NULL, "warning",
+				"Failed to read the encoding of evicted graph %s", gc->graph_name);
+	}
+	RedisModule_Assert(read);
+}
+
 // Save RDB for Redis 6 and up.
 static void _GraphContextType_RdbSave(RedisModuleIO *rdb, void *value) {
-	RdbSaveGraph(rdb, value);
+	GraphContext *gc = value;
+	if(!GraphContext_IsEvicted(gc)) {
+		RdbSaveGraph(rdb, gc);
+		return;
+	}
+
+	EncodeBuffer buf;
+	EncodeBuffer_Init(&buf);
+	_GraphContextType_SaveEvicted(&buf, gc);
+	EncodeBuffer_Flush(&buf, rdb);
+	EncodeBuffer_Free(&buf);
 }
 
+// Rewrite the graph as GRAPH.RESTORE commands, one per graph key
+// each command carries the key's encoding, exactly as it would be saved to an RDB
 static void _GraphContextType_AofRewrite(RedisModuleIO *aof, RedisModuleString *key, void *value) {
-	// TODO: implement.
+	GraphContext *gc = value;
+
+	EncodeBuffer buf;
+	EncodeBuffer_Init(&buf);
+	SerializerIO io;
+	SerializerIO_FromBuffer(&io, &buf);
+
+	// meta keys are not rewritten, their content is emitted by the graph key
+	uint64_t key_count = GraphEncodeContext_GetKeyCount(gc->encoding_context);
+	for(uint64_t i = 0; i < key_count; i++) {
+		// payloads lead with their encoding version
+		SerializerIO_SaveUnsigned(&io, GRAPH_ENCODING_VERSION_LATEST);
+		if(GraphContext_IsEvicted(gc)) _GraphContextType_SaveEvicted(&buf, gc);
+		else EncodeGraph(&io, gc);
+		RedisModule_EmitAOF(aof, "GRAPH.RESTORE", "sb", key, buf.data, buf.len);
+		buf.len = 0;
+	}
+
+	EncodeBuffer_Free(&buf);
+
+	// views are rewritten by their definition, populated once restored
+	// evicted graphs hold no views
+	uint view_count = (gc->views) ? array_len(gc->views) : 0;
+	for(uint i = 0; i < view_count; i++) {
+		MaterializedView *view = gc->views[i];
+		RedisModule_EmitAOF(aof, "GRAPH.VIEW", "cscc", "CREATE", key, view->name,
+				view->query);
+	}
 }
 
-// Save an unsigned placeholder before and after the keyspace encoding.
+// Save the definitions of the graph's views, evicted graphs hold none.
+static void _GraphContextType_SaveViews(RedisModuleIO *rdb, GraphContext *gc) {
+	uint view_count = (gc->views) ? array_len(gc->views) : 0;
+	RedisModule_SaveUnsigned(rdb, view_count);
+	for(uint i = 0; i < view_count; i++) {
+		MaterializedView *view = gc->views[i];
+		RedisModule_SaveStringBuffer(rdb, view->name, strlen(view->name) + 1);
+		RedisModule_SaveStringBuffer(rdb, view->query, strlen(view->query) + 1);
+	}
+}
+
+// Load the views saved by _GraphContextType_SaveViews
+// and populate them from their graph, views of a missing graph are discarded.
+static void _GraphContextType_LoadViews(RedisModuleIO *rdb, GraphContext *gc) {
+	uint64_t view_count = RedisModule_LoadUnsigned(rdb);
+	for(uint64_t i = 0; i < view_count; i++) {
+		char *name = RedisModule_LoadStringBuffer(rdb, NULL);
+		char *query = RedisModule_LoadStringBuffer(rdb, NULL);
+
+		if(gc != NULL) {
+			const char *err = NULL;
+			Graph_AcquireReadLock(gc->g);
+			MaterializedView *view = MaterializedView_New(gc, name, query, &err);
+			if(view != NULL) GraphContext_AddView(gc, view);
+			Graph_ReleaseLock(gc->g);
+
+			if(view == NULL) {
+				RedisModule_Log(NULL, "warning", "Failed to restore view %s of graph %s",
+						name, gc->graph_name);
+			}
+			// parsing a view's query populates the thread's query context
+			QueryCtx_Free();
+			ErrorCtx_Clear();
+		}
+
+		RedisModule_Free(name);
+		RedisModule_Free(query);
+	}
+}
+
+// Save the most hit cached queries and the views of each graph,
+// snapshot as persistence started.
+static void _GraphContextType_SaveHotQueries(RedisModuleIO *rdb) {
+	uint graph_count = array_len(graphs_in_keyspace);
+	RedisModule_SaveUnsigned(rdb, graph_count);
+
+	for(uint i = 0; i < graph_count; i++) {
+		GraphContext *gc = graphs_in_keyspace[i];
+		RedisModule_SaveStringBuffer(rdb, gc->graph_name, strlen(gc->graph_name) + 1);
+
+		uint query_count = (gc->hot_queries) ? array_len(gc->hot_queries) : 0;
+		RedisModule_SaveUnsigned(rdb, query_count);
+		for(uint j = 0; j < query_count; j++) {
+			const char *query = gc->hot_queries[j];
+			RedisModule_SaveStringBuffer(rdb, query, strlen(query) + 1);
+		}
+
+		_GraphContextType_SaveViews(rdb, gc);
+	}
+}
+
+// Load the queries and views saved by _GraphContextType_SaveHotQueries
+// and plan the queries into the cache of their graph.
+static void _GraphContextType_LoadHotQueries(RedisModuleIO *rdb) {
+	// RDBs saved by previous versions hold a 0 placeholder, read as no graphs
+	uint64_t graph_count = RedisModule_LoadUnsigned(rdb);
+
+	for(uint64_t i = 0; i < graph_count; i++) {
+		char *graph_name = RedisModule_LoadStringBuffer(rdb, NULL);
+		uint64_t query_count = RedisModule_LoadUnsigned(rdb);
+
+		char **queries = array_new(char *, query_count);
+		for(uint64_t j = 0; j < query_count; j++) {
+			char *query = RedisModule_LoadStringBuffer(rdb, NULL);
+			array_append(queries, rm_strdup(query));
+			RedisModule_Free(query);
+		}
+
+		GraphContext *gc = GraphContext_GetRegisteredGraphContext(graph_name);
+		RedisModule_Free(graph_name);
+
+		// RDBs saved by previous versions hold no views
+		if(_aux_version >= 1) _GraphContextType_LoadViews(rdb, gc);
+
+		if(gc != NULL && query_count > 0) {
+			ExecutionCtx_WarmCache(gc, queries);
+		} else {
+			for(uint64_t j = 0; j < query_count; j++) rm_free(queries[j]);
+			array_free(queries);
+		}
+	}
+}
+
+// Save the aux version before the keyspace encoding,
+// and the most hit cached queries and views of each graph after it.
 static void _GraphContextType_AuxSave(RedisModuleIO *rdb, int when) {
-	RedisModule_SaveUnsigned(rdb, 0);
+	if(when == REDISMODULE_AUX_BEFORE_RDB) RedisModule_SaveUnsigned(rdb, AUX_VERSION_LATEST);
+	else _GraphContextType_SaveHotQueries(rdb);
 }
 
-// Decode the unsigned placeholders saved before and after the keyspace values and call the module event handler.
+// Decode the aux fields saved before and after the keyspace values and call the module event handler.
 static int _GraphContextType_AuxLoad(RedisModuleIO *rdb, int encver, int when) {
-	RedisModule_LoadUnsigned(rdb);
-	if(when == REDISMODULE_AUX_BEFORE_RDB) ModuleEventHandler_AUXBeforeKeyspaceEvent();
-	else ModuleEventHandler_AUXAfterKeyspaceEvent();
+	if(when == REDISMODULE_AUX_BEFORE_RDB) {
+		// previous versions saved a 0 placeholder
+		_aux_version = RedisModule_LoadUnsigned(rdb);
+		ModuleEventHandler_AUXBeforeKeyspaceEvent();
+	} else {
+		_GraphContextType_LoadHotQueries(rdb);
+		_aux_version = 0;
+		ModuleEventHandler_AUXAfterKeyspaceEvent();
+	}
 	return REDISMODULE_OK;
 };
 
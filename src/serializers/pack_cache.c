@@ -0,0 +1,168 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "pack_cache.h"
+#include "entity_pack.h"
+#include "../RG.h"
+#include "../util/arr.h"
+#include "../util/rmalloc.h"
+#include <string.h>
+#include <sys/param.h>
+
+static inline const DataBlock *_PackCache_DataBlock(const PackCache *cache,
+		const Graph *g) {
+	return (cache->edges) ? g->edges : g->nodes;
+}
+
+static inline void _PackedBlock_Free(PackedBlock *pack) {
+	if(pack->data) rm_free(pack->data);
+	pack->data = NULL;
+	pack->version = 0;
+}
+
+// packs the entities of block blockIdx, in ascending ID order
+// as a DataBlockIterator visits them
+static PackedBlock _PackCache_PackBlock(const PackCache *cache, const Graph *g,
+		uint blockIdx, EntityPacker *packer) {
+	const DataBlock *db = _PackCache_DataBlock(cache, g);
+	uint64_t begin = (uint64_t)blockIdx * DATABLOCK_BLOCK_CAP;
+	uint64_t end = MIN(begin + DATABLOCK_BLOCK_CAP,
+			db->itemCount + array_len(db->deletedIdx));
+
+	PackedBlock pack = {.version = DataBlock_BlockVersion(db, blockIdx),
+		.first = begin, .count = 0, .len = 0, .data = NULL};
+	// released and empty blocks hold nothing to pack
+	if(begin >= end || DataBlock_BlockItemCount(db, blockIdx) == 0) return pack;
+
+	EntityID id;
+	Entity *e;
+	DataBlockIterator *it = DataBlockIterator_New(db, begin, end, 1);
+	while((e = DataBlockIterator_Next(it, &id)) != NULL) {
+		if(pack.count == 0) pack.first = id;
+		if(cache->edges) EntityPacker_AddEntity(packer, id, e);
+		else EntityPacker_AddNode(packer, id, Graph_GetNodeLabel(g, id), e);
+		pack.count++;
+	}
+	DataBlockIterator_Free(it);
+
+	pack.len = packer->len;
+	pack.data = rm_malloc(packer->len);
+	memcpy(pack.data, packer->data, packer->len);
+	EntityPacker_Reset(packer);
+
+	return pack;
+}
+
+PackCache *PackCache_New(bool edges) {
+	PackCache *cache = rm_malloc(sizeof(PackCache));
+	cache->edges = edges;
+	cache->blocks = array_new(PackedBlock, 0);
+	return cache;
+}
+
+bool PackCache_Get(const PackCache *cache, const Graph *g, uint blockIdx,
+		const PackedBlock **pack) {
+	ASSERT(cache != NULL && g != NULL && pack != NULL);
+
+	const DataBlock *db = _PackCache_DataBlock(cache, g);
+	if(blockIdx >= array_len(cache->blocks) || blockIdx >= db->blockCount) {
+		return false;
+	}
+
+	const PackedBlock *p = cache->blocks + blockIdx;
+	if(p->version == 0 || p->version != DataBlock_BlockVersion(db, blockIdx)) {
+		return false;
+	}
+
+	*pack = p;
+	return true;
+}
+
+PackedBlock *PackCache_Collect(const PackCache *cache, const Graph *g,
+		uint max_blocks, bool *depleted) {
+	ASSERT(cache != NULL && g != NULL && depleted != NULL);
+
+	const DataBlock *db = _PackCache_DataBlock(cache, g);
+	PackedBlock *packs = array_new(PackedBlock, 0);
+	uint cached = array_len(cache->blocks);
+
+	EntityPacker packer;
+	EntityPacker_Init(&packer);
+
+	*depleted = true;
+	for(uint b = 0; b < db->blockCount; b++) {
+		uint64_t version = DataBlock_BlockVersion(db, b);
+		if(b < cached && cache->blocks[b].version == version) continue;
+		if(array_len(packs) == max_blocks) {
+			*depleted = false;
+			break;
+		}
+		PackedBlock pack = _PackCache_PackBlock(cache, g, b, &packer);
+		packs = array_append(packs, pack);
+	}
+
+	EntityPacker_Free(&packer);
+	return packs;
+}
+
+void PackCache_Install(PackCache *cache, const Graph *g, PackedBlock *packs) {
+	ASSERT(cache != NULL && g != NULL && packs != NULL);
+
+	const DataBlock *db = _PackCache_DataBlock(cache, g);
+
+	// drop packs of released blocks
+	uint cached = array_len(cache->blocks);
+	for(uint b = db->blockCount; b < cached; b++) _PackedBlock_Free(cache->blocks + b);
+	if(cached > db->blockCount) {
+		cache->blocks = array_trimm_len(cache->blocks, db->blockCount);
+	}
+
+	// introduce entries for new blocks
+	PackedBlock none = {0};
+	while(array_len(cache->blocks) < db->blockCount) {
+		cache->blocks = array_append(cache->blocks, none);
+	}
+
+	uint count = array_len(packs);
+	for(uint i = 0; i < count; i++) {
+		PackedBlock *pack = packs + i;
+		uint b = pack->first / DATABLOCK_BLOCK_CAP;
+		// the block was modified since it was packed
+		if(b >= db->blockCount || DataBlock_BlockVersion(db, b) != pack->version) {
+			_PackedBlock_Free(pack);
+			continue;
+		}
+		_PackedBlock_Free(cache->blocks + b);
+		cache->blocks[b] = *pack;
+	}
+
+	array_free(packs);
+}
+
+void PackCache_Clear(PackCache *cache) {
+	ASSERT(cache != NULL);
+
+	uint count = array_len(cache->blocks);
+	for(uint i = 0; i < count; i++) _PackedBlock_Free(cache->blocks + i);
+	array_clear(cache->blocks);
+}
+
+size_t PackCache_MemoryUsage(const PackCache *cache) {
+	ASSERT(cache != NULL);
+
+	uint count = array_len(cache->blocks);
+	size_t usage = sizeof(PackCache) + sizeof(PackedBlock) * count;
+	for(uint i = 0; i < count; i++) usage += cache->blocks[i].len;
+	return usage;
+}
+
+void PackCache_Free(PackCache *cache) {
+	ASSERT(cache != NULL);
+
+	PackCache_Clear(cache);
+	array_free(cache->blocks);
+	rm_free(cache);
+}
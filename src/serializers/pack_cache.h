@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../graph/graph.h"
+
+// PackCache retains the packed encoding of each DataBlock block of a graph's
+// nodes or edges, see EntityPacker, along with the block version it reflects
+// snapshots write the cached pack of every unmodified block as is, such that
+// their encoding cost scales with the number of blocks modified since
+// the cache was last refreshed rather than with the size of the graph
+//
+// packs are produced under the graph's read lock and installed under its
+// write lock, encoders holding the read lock, or running in a forked child,
+// observe a consistent cache without further synchronization
+
+// a packed block
+typedef struct {
+	uint64_t version;  // block version packed, 0 if none
+	EntityID first;    // ID of the block's first entity
+	uint64_t count;    // number of packed entities
+	size_t len;        // pack length
+	char *data;        // packed entities
+} PackedBlock;
+
+typedef struct {
+	bool edges;             // cache holds edges, nodes otherwise
+	PackedBlock *blocks;    // pack per block, indexed by block
+} PackCache;
+
+// create an empty cache of a graph's nodes or edges
+PackCache *PackCache_New
+(
+	bool edges  // cache edges, nodes otherwise
+);
+
+// retrieve the pack of block blockIdx, if it reflects the block's content
+bool PackCache_Get
+(
+	const PackCache *cache,
+	const Graph *g,
+	uint blockIdx,            // block index
+	const PackedBlock **pack  // [output] packed block
+);
+
+// pack up to max_blocks blocks modified since they were last cached
+// the caller holds the graph's read lock
+// returns packs to install by PackCache_Install, sets *depleted once
+// no further blocks are due
+PackedBlock *PackCache_Collect
+(
+	const PackCache *cache,
+	const Graph *g,
+	uint max_blocks,          // maximum number of blocks to pack
+	bool *depleted            // [output] every block is packed
+);
+
+// install packs collected by PackCache_Collect, packs of blocks modified
+// since they were collected are discarded, the caller holds the graph's
+// write lock, packs are consumed
+void PackCache_Install
+(
+	PackCache *cache,
+	const Graph *g,
+	PackedBlock *packs
+);
+
+// discard all packs, the caller holds the graph's write lock
+void PackCache_Clear
+(
+	PackCache *cache
+);
+
+// returns the number of bytes held by the cache
+size_t PackCache_MemoryUsage
+(
+	const PackCache *cache
+);
+
+// free cache
+void PackCache_Free
+(
+	PackCache *cache
+);
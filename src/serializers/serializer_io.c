@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "serializer_io.h"
+#include "RG.h"
+
+void SerializerIO_FromRdb(SerializerIO *io, RedisModuleIO *rdb) {
+	ASSERT(io != NULL && rdb != NULL);
+	io->rdb = rdb;
+	io->buf = NULL;
+	EncodeBufferReader_Init(&io->reader, NULL, 0);
+}
+
+void SerializerIO_FromBuffer(SerializerIO *io, EncodeBuffer *buf) {
+	ASSERT(io != NULL && buf != NULL);
+	io->rdb = NULL;
+	io->buf = buf;
+	EncodeBufferReader_Init(&io->reader, NULL, 0);
+}
+
+void SerializerIO_FromData(SerializerIO *io, const char *data, size_t len) {
+	ASSERT(io != NULL);
+	io->rdb = NULL;
+	io->buf = NULL;
+	EncodeBufferReader_Init(&io->reader, data, len);
+}
+
+void SerializerIO_SaveUnsigned(SerializerIO *io, uint64_t v) {
+	if(io->rdb) RedisModule_SaveUnsigned(io->rdb, v);
+	else EncodeBuffer_SaveUnsigned(io->buf, v);
+}
+
+void SerializerIO_SaveSigned(SerializerIO *io, int64_t v) {
+	if(io->rdb) RedisModule_SaveSigned(io->rdb, v);
+	else EncodeBuffer_SaveSigned(io->buf, v);
+}
+
+void SerializerIO_SaveDouble(SerializerIO *io, double v) {
+	if(io->rdb) RedisModule_SaveDouble(io->rdb, v);
+	else EncodeBuffer_SaveDouble(io->buf, v);
+}
+
+void SerializerIO_SaveStringBuffer(SerializerIO *io, const char *str,
+		size_t len) {
+	if(io->rdb) RedisModule_SaveStringBuffer(io->rdb, str, len);
+	else EncodeBuffer_SaveStringBuffer(io->buf, str, len);
+}
+
+uint64_t SerializerIO_LoadUnsigned(SerializerIO *io) {
+	if(io->rdb) return RedisModule_LoadUnsigned(io->rdb);
+	return EncodeBufferReader_LoadUnsigned(&io->reader);
+}
+
+int64_t SerializerIO_LoadSigned(SerializerIO *io) {
+	if(io->rdb) return RedisModule_LoadSigned(io->rdb);
+	return EncodeBufferReader_LoadSigned(&io->reader);
+}
+
+double SerializerIO_LoadDouble(SerializerIO *io) {
+	if(io->rdb) return RedisModule_LoadDouble(io->rdb);
+	return EncodeBufferReader_LoadDouble(&io->reader);
+}
+
+char *SerializerIO_LoadStringBuffer(SerializerIO *io, size_t *len) {
+	if(io->rdb) return RedisModule_LoadStringBuffer(io->rdb, len);
+	return EncodeBufferReader_LoadStringBuffer(&io->reader, len);
+}
+
+bool SerializerIO_Failed(const SerializerIO *io) {
+	return io->rdb == NULL && io->reader.error;
+}
+
+void SerializerIO_Fail(SerializerIO *io) {
+	if(io->rdb) RedisModule_LogIOError(io->rdb, "warning", "Malformed graph entities");
+	else io->reader.error = true;
+}
+
+const RedisModuleString *SerializerIO_KeyName(SerializerIO *io) {
+	if(io->rdb) return RedisModule_GetKeyNameFromIO(io->rdb);
+	return NULL;
+}
+
+RedisModuleCtx *SerializerIO_Context(SerializerIO *io) {
+	if(io->rdb) return RedisModule_GetContextFromIO(io->rdb);
+	return NULL;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../redismodule.h"
+#include "encoder/encode_buffer.h"
+
+// SerializerIO is the stream a graph is encoded to and decoded from
+// either an RDB or the values recorded by an EncodeBuffer
+// buffers carry graph keys outside of an RDB, e.g. within the AOF
+// see GRAPH.RESTORE
+typedef struct {
+	RedisModuleIO *rdb;         // RDB, NULL for buffers
+	EncodeBuffer *buf;          // buffer to encode into
+	EncodeBufferReader reader;  // recorded values to decode
+} SerializerIO;
+
+// stream over an RDB
+void SerializerIO_FromRdb
+(
+	SerializerIO *io,
+	RedisModuleIO *rdb
+);
+
+// stream encoding into buf
+void SerializerIO_FromBuffer
+(
+	SerializerIO *io,
+	EncodeBuffer *buf
+);
+
+// stream decoding len bytes of values recorded by an EncodeBuffer
+void SerializerIO_FromData
+(
+	SerializerIO *io,
+	const char *data,
+	size_t len
+);
+
+void SerializerIO_SaveUnsigned
+(
+	SerializerIO *io,
+	uint64_t v
+);
+
+void SerializerIO_SaveSigned
+(
+	SerializerIO *io,
+	int64_t v
+);
+
+void SerializerIO_SaveDouble
+(
+	SerializerIO *io,
+	double v
+);
+
+void SerializerIO_SaveStringBuffer
+(
+	SerializerIO *io,
+	const char *str,
+	size_t len
+);
+
+uint64_t SerializerIO_LoadUnsigned
+(
+	SerializerIO *io
+);
+
+int64_t SerializerIO_LoadSigned
+(
+	SerializerIO *io
+);
+
+double SerializerIO_LoadDouble
+(
+	SerializerIO *io
+);
+
+// the returned string is owned by the caller
+char *SerializerIO_LoadStringBuffer
+(
+	SerializerIO *io,
+	size_t *len  // [optional] loaded string length
+);
+
+// returns true if decoding a buffer ran into malformed values
+// RDB load errors are handled by Redis
+bool SerializerIO_Failed
+(
+	const SerializerIO *io
+);
+
+// flags the stream as holding malformed values
+void SerializerIO_Fail
+(
+	SerializerIO *io
+);
+
+// name of the key being saved or loaded, NULL for buffers
+const RedisModuleString *SerializerIO_KeyName
+(
+	SerializerIO *io
+);
+
+// Redis context of the stream, NULL for buffers
+RedisModuleCtx *SerializerIO_Context
+(
+	SerializerIO *io
+);
@@ -24,6 +24,8 @@
 #include "../datatypes/array.h"
 // Graph extentions.
 #include "graph_extensions.h"
+// Serialization stream.
+#include "serializer_io.h"
 // Module configuration
 #include "../config.h"
 
@@ -0,0 +1,44 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+// phases of a query's execution, timed individually
+typedef enum {
+	QUERY_PHASE_PARSE,      // parameters and query parsing, plan construction
+	QUERY_PHASE_CACHE,      // execution plan cache lookup and plan clone
+	QUERY_PHASE_QUEUE,      // waiting in a thread pool queue
+	QUERY_PHASE_LOCK,       // waiting for the graph's read or write lock
+	QUERY_PHASE_SYNC,       // applying pending matrix modifications
+	QUERY_PHASE_EXECUTION,  // running the execution plan, excluding nested phases
+	QUERY_PHASE_GIL,        // waiting for the global redis lock
+	QUERY_PHASE_REPLY,      // serializing the reply
+	QUERY_PHASE_COUNT       // number of phases
+} QueryPhase;
+
+// returns the name phase is reported by
+static inline const char *QueryPhase_Name(QueryPhase phase) {
+	switch(phase) {
+		case QUERY_PHASE_PARSE:
+			return "parse";
+		case QUERY_PHASE_CACHE:
+			return "cache";
+		case QUERY_PHASE_QUEUE:
+			return "queue";
+		case QUERY_PHASE_LOCK:
+			return "lock";
+		case QUERY_PHASE_SYNC:
+			return "sync";
+		case QUERY_PHASE_EXECUTION:
+			return "execution";
+		case QUERY_PHASE_GIL:
+			return "gil";
+		case QUERY_PHASE_REPLY:
+			return "reply";
+		default:
+			return "unknown";
+	}
+}
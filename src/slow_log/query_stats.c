@@ -0,0 +1,230 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "./query_stats.h"
+#include "RG.h"
+#include "xxhash.h"
+#include "../util/arr.h"
+#include "../util/qsort.h"
+#include "../util/rmalloc.h"
+#include <math.h>
+#include <ctype.h>
+#include <stdio.h>
+
+// number of fields replied per item
+#define QUERY_STATS_ITEM_FIELDS 10
+
+static inline bool _IdentifierChar(char c) {
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+char *QueryStats_Normalize(const char *query) {
+	ASSERT(query != NULL);
+
+	size_t len = strlen(query);
+	char *normalized = rm_malloc(len + 1);
+	size_t n = 0;
+	const char *c = query;
+
+	while(*c) {
+		if(isspace((unsigned char)*c)) {
+			// collapse whitespace, dropping leading whitespace
+			while(isspace((unsigned char)*c)) c++;
+			if(n > 0 && *c) normalized[n++] = ' ';
+		} else if(*c == '\'' || *c == '"') {
+			// string literal
+			char quote = *c++;
+			while(*c && *c != quote) {
+				if(*c == '\\' && c[1]) c++;
+				c++;
+			}
+			if(*c) c++;
+			normalized[n++] = '?';
+		} else if(*c == '`') {
+			// escaped identifier, kept as is
+			normalized[n++] = *c++;
+			while(*c && *c != '`') normalized[n++] = *c++;
+			if(*c) normalized[n++] = *c++;
+		} else if(isdigit((unsigned char)*c) &&
+				  (n == 0 || !_IdentifierChar(normalized[n - 1]))) {
+			// numeric literal, not part of an identifier
+			while(_IdentifierChar(*c) || *c == '.') {
+				// signed exponent
+				if((*c == 'e' || *c == 'E') && (c[1] == '-' || c[1] == '+')) c++;
+				c++;
+			}
+			normalized[n++] = '?';
+		} else {
+			normalized[n++] = *c++;
+		}
+	}
+
+	normalized[n] = '\0';
+	return normalized;
+}
+
+QueryStats *QueryStats_New(void) {
+	QueryStats *stats = rm_malloc(sizeof(QueryStats));
+	stats->lookup = raxNew();
+	int res = pthread_mutex_init(&stats->lock, NULL);
+	UNUSED(res);
+	ASSERT(res == 0);
+	return stats;
+}
+
+static QueryStatsItem *_QueryStatsItem_New(uint64_t fingerprint, char *query) {
+	QueryStatsItem *item = rm_malloc(sizeof(QueryStatsItem));
+	item->fingerprint    =  fingerprint;
+	item->query          =  query;
+	item->calls          =  0;
+	item->total_latency  =  0;
+	item->min_latency    =  INFINITY;
+	item->max_latency    =  0;
+	item->latencies      =  TDigest_New();
+	item->rows           =  0;
+	item->cache_hits     =  0;
+	item->lock_wait      =  0;
+	return item;
+}
+
+static void _QueryStatsItem_Free(void *ptr) {
+	QueryStatsItem *item = ptr;
+	rm_free(item->query);
+	TDigest_Free(item->latencies);
+	rm_free(item);
+}
+
+// evicts the least called item, must be called under the registry lock
+static void _QueryStats_Evict(QueryStats *stats) {
+	QueryStatsItem *victim = NULL;
+
+	raxIterator iter;
+	raxStart(&iter, stats->lookup);
+	raxSeek(&iter, "^", NULL, 0);
+	while(raxNext(&iter)) {
+		QueryStatsItem *item = iter.data;
+		if(victim == NULL || item->calls < victim->calls) victim = item;
+	}
+	raxStop(&iter);
+
+	ASSERT(victim != NULL);
+	raxRemove(stats->lookup, (unsigned char *)&victim->fingerprint,
+			sizeof(uint64_t), NULL);
+	_QueryStatsItem_Free(victim);
+}
+
+void QueryStats_Add(QueryStats *stats, const char *query, double latency,
+		uint64_t rows, bool cached, double lock_wait) {
+	ASSERT(stats != NULL && query != NULL && latency >= 0);
+
+	// normalize outside of the lock
+	char *normalized = QueryStats_Normalize(query);
+	uint64_t fingerprint = XXH64(normalized, strlen(normalized), 0);
+	unsigned char *key = (unsigned char *)&fingerprint;
+
+	pthread_mutex_lock(&stats->lock);
+
+	QueryStatsItem *item = raxFind(stats->lookup, key, sizeof(uint64_t));
+	if(item == raxNotFound) {
+		if(raxSize(stats->lookup) >= QUERY_STATS_SIZE) _QueryStats_Evict(stats);
+		item = _QueryStatsItem_New(fingerprint, normalized);
+		raxInsert(stats->lookup, key, sizeof(uint64_t), item, NULL);
+		normalized = NULL;
+	}
+
+	item->calls++;
+	item->total_latency += latency;
+	if(latency < item->min_latency) item->min_latency = latency;
+	if(latency > item->max_latency) item->max_latency = latency;
+	TDigest_Add(item->latencies, latency);
+	item->rows += rows;
+	if(cached) item->cache_hits++;
+	item->lock_wait += lock_wait;
+
+	pthread_mutex_unlock(&stats->lock);
+
+	if(normalized) rm_free(normalized);
+}
+
+uint64_t QueryStats_Count(QueryStats *stats) {
+	ASSERT(stats != NULL);
+	pthread_mutex_lock(&stats->lock);
+	uint64_t count = raxSize(stats->lookup);
+	pthread_mutex_unlock(&stats->lock);
+	return count;
+}
+
+// see SlowLog, prints doubles with 5 significant digits
+static inline void _ReplyWithRoundedDouble(RedisModuleCtx *ctx, double d) {
+	char str[64];
+	int len = snprintf(str, sizeof(str), "%.5g", d);
+	RedisModule_ReplyWithStringBuffer(ctx, str, len);
+}
+
+static void _QueryStatsItem_Reply(QueryStatsItem *item, RedisModuleCtx *ctx) {
+	RedisModule_ReplyWithArray(ctx, QUERY_STATS_ITEM_FIELDS * 2);
+	RedisModule_ReplyWithSimpleString(ctx, "query");
+	RedisModule_ReplyWithStringBuffer(ctx, item->query, strlen(item->query));
+	RedisModule_ReplyWithSimpleString(ctx, "calls");
+	RedisModule_ReplyWithLongLong(ctx, item->calls);
+	RedisModule_ReplyWithSimpleString(ctx, "total_ms");
+	_ReplyWithRoundedDouble(ctx, item->total_latency);
+	RedisModule_ReplyWithSimpleString(ctx, "mean_ms");
+	_ReplyWithRoundedDouble(ctx, item->total_latency / item->calls);
+	RedisModule_ReplyWithSimpleString(ctx, "min_ms");
+	_ReplyWithRoundedDouble(ctx, item->min_latency);
+	RedisModule_ReplyWithSimpleString(ctx, "max_ms");
+	_ReplyWithRoundedDouble(ctx, item->max_latency);
+	RedisModule_ReplyWithSimpleString(ctx, "p99_ms");
+	_ReplyWithRoundedDouble(ctx, TDigest_Quantile(item->latencies, 0.99));
+	RedisModule_ReplyWithSimpleString(ctx, "rows");
+	RedisModule_ReplyWithLongLong(ctx, item->rows);
+	RedisModule_ReplyWithSimpleString(ctx, "cache_hits");
+	RedisModule_ReplyWithLongLong(ctx, item->cache_hits);
+	RedisModule_ReplyWithSimpleString(ctx, "lock_wait_ms");
+	_ReplyWithRoundedDouble(ctx, item->lock_wait);
+}
+
+void QueryStats_Reply(QueryStats *stats, RedisModuleCtx *ctx) {
+	ASSERT(stats != NULL && ctx != NULL);
+
+	pthread_mutex_lock(&stats->lock);
+
+	uint64_t count = raxSize(stats->lookup);
+	QueryStatsItem **items = array_new(QueryStatsItem *, count);
+
+	raxIterator iter;
+	raxStart(&iter, stats->lookup);
+	raxSeek(&iter, "^", NULL, 0);
+	while(raxNext(&iter)) items = array_append(items, iter.data);
+	raxStop(&iter);
+
+	// most expensive queries first
+#define TOTAL_LATENCY_GT(a, b) ((*a)->total_latency > (*b)->total_latency)
+	QSORT(QueryStatsItem *, items, count, TOTAL_LATENCY_GT);
+#undef TOTAL_LATENCY_GT
+
+	RedisModule_ReplyWithArray(ctx, count);
+	for(uint64_t i = 0; i < count; i++) _QueryStatsItem_Reply(items[i], ctx);
+
+	pthread_mutex_unlock(&stats->lock);
+	array_free(items);
+}
+
+void QueryStats_Reset(QueryStats *stats) {
+	ASSERT(stats != NULL);
+	pthread_mutex_lock(&stats->lock);
+	raxFreeWithCallback(stats->lookup, _QueryStatsItem_Free);
+	stats->lookup = raxNew();
+	pthread_mutex_unlock(&stats->lock);
+}
+
+void QueryStats_Free(QueryStats *stats) {
+	if(stats == NULL) return;
+	raxFreeWithCallback(stats->lookup, _QueryStatsItem_Free);
+	pthread_mutex_destroy(&stats->lock);
+	rm_free(stats);
+}
@@ -0,0 +1,87 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "../redismodule.h"
+#include "../util/sketch/tdigest.h"
+#include "../../deps/rax/rax.h"
+
+// maximal number of tracked query fingerprints
+// once reached, the least called query is evicted
+#define QUERY_STATS_SIZE 1000
+
+// aggregated statistics of all queries sharing a fingerprint
+typedef struct {
+	uint64_t fingerprint;   // hash of the normalized query
+	char *query;            // normalized query
+	uint64_t calls;         // number of executions
+	double total_latency;   // sum of execution times, in milliseconds
+	double min_latency;     // fastest execution, in milliseconds
+	double max_latency;     // slowest execution, in milliseconds
+	TDigest *latencies;     // execution time distribution
+	uint64_t rows;          // number of returned rows
+	uint64_t cache_hits;    // number of executions reusing a cached plan
+	double lock_wait;       // time spent waiting for the graph's locks, in milliseconds
+} QueryStatsItem;
+
+// query statistics registry
+// keyed by the fingerprint of normalized queries, such that queries
+// differing only by their literals are aggregated together
+typedef struct {
+	rax *lookup;            // maps fingerprint to item
+	pthread_mutex_t lock;   // protects lookup and its items
+} QueryStats;
+
+// create a new, empty registry
+QueryStats *QueryStats_New(void);
+
+// normalizes query text, replacing string and numeric literals with '?'
+// and collapsing whitespace, the returned string is owned by the caller
+char *QueryStats_Normalize
+(
+	const char *query  // query text
+);
+
+// accounts for an execution of query
+void QueryStats_Add
+(
+	QueryStats *stats,   // registry
+	const char *query,   // executed query
+	double latency,      // execution time, in milliseconds
+	uint64_t rows,       // number of returned rows
+	bool cached,         // execution reused a cached plan
+	double lock_wait     // time spent waiting for locks, in milliseconds
+);
+
+// returns number of tracked fingerprints
+uint64_t QueryStats_Count
+(
+	QueryStats *stats  // registry
+);
+
+// replies with registry content, ordered by descending total latency
+void QueryStats_Reply
+(
+	QueryStats *stats,   // registry
+	RedisModuleCtx *ctx  // redis module context
+);
+
+// forget all tracked queries
+void QueryStats_Reset
+(
+	QueryStats *stats  // registry
+);
+
+// free registry
+void QueryStats_Free
+(
+	QueryStats *stats  // registry
+);
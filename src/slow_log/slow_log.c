@@ -27,16 +27,27 @@ static inline void _ReplyWithRoundedDouble(RedisModuleCtx *ctx, double d) {
 	RedisModule_ReplyWithStringBuffer(ctx, str, len);
 }
 
+static inline void _SlowLogItem_SetPhases(SlowLogItem *item, const double *phases) {
+	if(phases) memcpy(item->phases, phases, sizeof(item->phases));
+	else memset(item->phases, 0, sizeof(item->phases));
+}
+
 static SlowLogItem *_SlowLogItem_New
 (
 	const char *cmd,
 	const char *query,
 	double latency,
+	int64_t memory,
+	double wait,
+	const double *phases,
 	time_t t
 ) {
 	SlowLogItem *item = rm_malloc(sizeof(SlowLogItem));
 	item->time = t;
 	item->latency = latency;
+	item->memory = memory;
+	item->wait = wait;
+	_SlowLogItem_SetPhases(item, phases);
 	item->cmd = rm_strdup(cmd);
 	item->query = rm_strdup(query);
 	return item;
@@ -105,7 +116,8 @@ SlowLog *SlowLog_New() {
 }
 
 void SlowLog_Add(SlowLog *slowlog, const char *cmd, const char *query,
-				 double latency, time_t *t) {
+				 double latency, int64_t memory, double wait, const double *phases,
+				 time_t *t) {
 	ASSERT(slowlog && cmd && query && latency >= 0);
 
 	int res;
@@ -136,6 +148,9 @@ void SlowLog_Add(SlowLog *slowlog, const char *cmd, const char *query,
 			if(existing_item->latency < latency) {
 				existing_item->time = _time;
 				existing_item->latency = latency;
+				existing_item->memory = memory;
+				existing_item->wait = wait;
+				_SlowLogItem_SetPhases(existing_item, phases);
 			}
 			goto cleanup;
 		}
@@ -157,7 +172,8 @@ void SlowLog_Add(SlowLog *slowlog, const char *cmd, const char *query,
 		}
 
 		if(introduce_item) {
-			SlowLogItem *item = _SlowLogItem_New(cmd, query, latency, _time);
+			SlowLogItem *item = _SlowLogItem_New(cmd, query, latency, memory, wait,
+					phases, _time);
 			Heap_offer(slowlog->min_heap + t_id, item);
 			raxInsert(lookup, (unsigned char *)key, key_len, item, NULL);
 		}
@@ -185,7 +201,8 @@ void SlowLog_Replay(const SlowLog *slowlog, RedisModuleCtx *ctx) {
 			while(raxNext(&iter)) {
 				SlowLogItem *item = iter.data;
 				SlowLog_Add(aggregated_slowlog, item->cmd, item->query,
-							item->latency, &item->time);
+							item->latency, item->memory, item->wait, item->phases,
+							&item->time);
 			}
 			raxStop(&iter);
 			// End of critical section.
@@ -198,11 +215,18 @@ void SlowLog_Replay(const SlowLog *slowlog, RedisModuleCtx *ctx) {
 
 	while(Heap_count(heap)) {
 		SlowLogItem *item = Heap_poll(heap);
-		RedisModule_ReplyWithArray(ctx, 4);
+		RedisModule_ReplyWithArray(ctx, 7);
 		RedisModule_ReplyWithDouble(ctx, item->time);
 		RedisModule_ReplyWithStringBuffer(ctx, (const char *)item->cmd, strlen(item->cmd));
 		RedisModule_ReplyWithStringBuffer(ctx, (const char *)item->query, strlen(item->query));
 		_ReplyWithRoundedDouble(ctx, item->latency);
+		RedisModule_ReplyWithLongLong(ctx, item->memory);
+		_ReplyWithRoundedDouble(ctx, item->wait);
+		RedisModule_ReplyWithArray(ctx, QUERY_PHASE_COUNT * 2);
+		for(int i = 0; i < QUERY_PHASE_COUNT; i++) {
+			RedisModule_ReplyWithSimpleString(ctx, QueryPhase_Name(i));
+			_ReplyWithRoundedDouble(ctx, item->phases[i]);
+		}
 	}
 
 	SlowLog_Free(aggregated_slowlog);
@@ -8,8 +8,10 @@
 
 #define SLOW_LOG_SIZE 10
 
+#include <stdint.h>
 #include <pthread.h>
 
+#include "./query_phases.h"
 #include "../util/heap.h"
 #include "../redismodule.h"
 #include "../../deps/rax/rax.h"
@@ -20,6 +22,9 @@ typedef struct {
     time_t time;        // Item creation time.
 	char *query;        // Query.
 	double latency;     // How much time query was processed.
+	int64_t memory;     // Peak memory consumed by the query, in bytes.
+	double wait;        // How much time query waited to be executed.
+	double phases[QUERY_PHASE_COUNT];  // Time spent in each execution phase.
 } SlowLogItem;
 
 // Slowlog, maintains N slowest queries.
@@ -40,6 +45,9 @@ void SlowLog_Add
 	const char *cmd,			// command being logged
 	const char *query,			// query being logged
 	double latency,				// command latency
+	int64_t memory,				// command peak memory consumption
+	double wait,				// time command spent queued
+	const double *phases,		// optional time spent in each execution phase
 	time_t *time				// optional time command was issued
 );
 
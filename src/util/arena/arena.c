@@ -0,0 +1,84 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "arena.h"
+#include "RG.h"
+#include "../rmalloc.h"
+#include <string.h>
+
+// Rounds n up to a multiple of 8.
+#define ARENA_ALIGN(n) (((n) + 7) & ~((size_t)7))
+
+static ArenaBlock *_ArenaBlock_New(size_t cap, ArenaBlock *next) {
+	ArenaBlock *block = rm_malloc(sizeof(ArenaBlock) + cap);
+	block->next = next;
+	block->cap = cap;
+	block->used = 0;
+	return block;
+}
+
+Arena *Arena_New(size_t block_size) {
+	ASSERT(block_size > 0);
+
+	Arena *arena = rm_malloc(sizeof(Arena));
+	arena->block_size = ARENA_ALIGN(block_size);
+	arena->head = _ArenaBlock_New(arena->block_size, NULL);
+	return arena;
+}
+
+void *Arena_Alloc(Arena *arena, size_t n) {
+	ASSERT(arena != NULL);
+
+	n = ARENA_ALIGN(n);
+	ArenaBlock *head = arena->head;
+
+	if(head->used + n > head->cap) {
+		if(n > arena->block_size / 4) {
+			/* Large allocations get a dedicated block, placed behind the head
+			 * such that the remainder of the head block is not wasted. */
+			ArenaBlock *block = _ArenaBlock_New(n, head->next);
+			head->next = block;
+			block->used = n;
+			return block->data;
+		}
+		head = _ArenaBlock_New(arena->block_size, head);
+		arena->head = head;
+	}
+
+	void *p = head->data + head->used;
+	head->used += n;
+	return p;
+}
+
+char *Arena_Strdup(Arena *arena, const char *s) {
+	size_t len = strlen(s) + 1;
+	char *dup = Arena_Alloc(arena, len);
+	memcpy(dup, s, len);
+	return dup;
+}
+
+void Arena_Reset(Arena *arena) {
+	ASSERT(arena != NULL);
+
+	// Keep the head block, which is always of standard size.
+	ArenaBlock *block = arena->head->next;
+	while(block) {
+		ArenaBlock *next = block->next;
+		rm_free(block);
+		block = next;
+	}
+	arena->head->next = NULL;
+	arena->head->used = 0;
+}
+
+void Arena_Free(Arena *arena) {
+	if(arena == NULL) return;
+
+	Arena_Reset(arena);
+	rm_free(arena->head);
+	rm_free(arena);
+}
+
@@ -0,0 +1,47 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// Default number of bytes in an arena block.
+#define ARENA_BLOCK_SIZE 65536
+
+typedef struct ArenaBlock ArenaBlock;
+
+struct ArenaBlock {
+	ArenaBlock *next;   // Previously filled block.
+	size_t cap;         // Number of bytes the block can hold.
+	size_t used;        // Number of bytes handed out.
+	char data[];        // Block memory.
+};
+
+/* The Arena is a bump allocator, handing out memory from large blocks.
+ * Allocations are not freed individually, all of them are released at once
+ * when the arena is reset or freed. Not thread-safe. */
+typedef struct {
+	ArenaBlock *head;   // Block allocations are currently served from.
+	size_t block_size;  // Size of a standard block in bytes.
+} Arena;
+
+// Create a new Arena
+// block_size - number of bytes in each block.
+Arena *Arena_New(size_t block_size);
+
+// Allocate n bytes within the arena, aligned to 8 bytes.
+void *Arena_Alloc(Arena *arena, size_t n);
+
+// Copy a NULL-terminated string into the arena.
+char *Arena_Strdup(Arena *arena, const char *s);
+
+// Release all allocations, keeping a single block for reuse.
+void Arena_Reset(Arena *arena);
+
+// Free arena and all of its allocations.
+void Arena_Free(Arena *arena);
+
@@ -8,13 +8,120 @@
 #include "RG.h"
 #include "../rmalloc.h"
 #include "cache_array.h"
+#include "../arr.h"
 #include <pthread.h>
 
+// max number of keys a thread remembers before forgetting them all
+#define THREAD_LOOKUP_CAP 4096
+
+// entry found by a thread, valid as long as the entry wasn't evicted
+typedef struct {
+	CacheEntry *entry;    // cache entry
+	uint64_t generation;  // entry generation when it was found
+} _ThreadLookupItem;
+
+// ids of created caches
+static uint64_t _cache_id = 0;
+
+// number of freed caches, invalidates the lookups of every thread
+static uint64_t _freed_caches = 0;
+
+/* Thread local mapping between keys and the entries the thread had found,
+ * keys are prefixed by their cache id as threads access multiple caches
+ * and caches may be freed while threads still refer to them. */
+static __thread rax *_thread_lookup = NULL;
+
+// number of freed caches as of the calling thread's last lookup
+static __thread uint64_t _thread_lookup_freed = 0;
+
+// forget all of the calling thread's entries
+static void _ThreadLookup_Clear(void) {
+	raxFreeWithCallback(_thread_lookup, rm_free);
+	_thread_lookup = NULL;
+}
+
+/* Forget the calling thread's entries once a cache was freed,
+ * the entries of a freed cache are released along with it
+ * and would otherwise be kept until the lookup reaches its cap. */
+static void _ThreadLookup_Validate(void) {
+	uint64_t freed = __atomic_load_n(&_freed_caches, __ATOMIC_ACQUIRE);
+	if(freed == _thread_lookup_freed) return;
+	if(_thread_lookup != NULL) _ThreadLookup_Clear();
+	_thread_lookup_freed = freed;
+}
+
+// builds a thread lookup key, the caller must free it
+static unsigned char *_ThreadLookup_Key(const Cache *cache, const char *key,
+		size_t key_len, size_t *len) {
+	*len = sizeof(uint64_t) + key_len;
+	unsigned char *k = rm_malloc(*len);
+	memcpy(k, &cache->id, sizeof(uint64_t));
+	memcpy(k + sizeof(uint64_t), key, key_len);
+	return k;
+}
+
+/* Copies the value of an entry the calling thread had found,
+ * without locking the cache. Returns NULL if the thread hadn't found
+ * the key, or if its entry has since been evicted. */
+static void *_ThreadLookup_GetValue(Cache *cache, const unsigned char *key,
+		size_t key_len) {
+	_ThreadLookup_Validate();
+	if(_thread_lookup == NULL) return NULL;
+
+	_ThreadLookupItem *item = raxFind(_thread_lookup, (unsigned char *)key,
+			key_len);
+	if(item == raxNotFound) return NULL;
+
+	/* announce ourselves as a reader before validating the entry,
+	 * an evicting thread bumps the generation before waiting for readers */
+	void *value = NULL;
+	CacheEntry *entry = item->entry;
+	__atomic_fetch_add(&entry->readers, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&entry->generation, __ATOMIC_SEQ_CST) == item->generation) {
+		entry->LRU = __atomic_add_fetch(&cache->counter, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&entry->hits, 1, __ATOMIC_RELAXED);
+		value = cache->copy_item(entry->value);
+	}
+	__atomic_fetch_sub(&entry->readers, 1, __ATOMIC_SEQ_CST);
+
+	if(value == NULL) {
+		// entry was evicted, forget it
+		raxRemove(_thread_lookup, (unsigned char *)key, key_len, NULL);
+		rm_free(item);
+	}
+
+	return value;
+}
+
+// remembers an entry found by the calling thread
+static void _ThreadLookup_SetEntry(const unsigned char *key, size_t key_len,
+		CacheEntry *entry) {
+	_ThreadLookup_Validate();
+	if(_thread_lookup != NULL && raxSize(_thread_lookup) >= THREAD_LOOKUP_CAP) {
+		_ThreadLookup_Clear();
+	}
+	if(_thread_lookup == NULL) _thread_lookup = raxNew();
+
+	_ThreadLookupItem *item = rm_malloc(sizeof(_ThreadLookupItem));
+	item->entry = entry;
+	item->generation = __atomic_load_n(&entry->generation, __ATOMIC_SEQ_CST);
+
+	_ThreadLookupItem *old = NULL;
+	raxInsert(_thread_lookup, (unsigned char *)key, key_len, item, (void **)&old);
+	if(old != NULL) rm_free(old);
+}
+
 static CacheEntry *_CacheEvictLRU(Cache *cache) {
 	CacheEntry *entry = CacheArray_FindMinLRU(cache->arr, cache->cap);
 	// Remove evicted element from the rax.
 	raxRemove(cache->lookup, (unsigned  char *)entry->key,
 	  strlen(entry->key), NULL);
+
+	/* invalidate the entry for threads which had found it,
+	 * and wait for threads copying its value to complete */
+	__atomic_add_fetch(&entry->generation, 1, __ATOMIC_SEQ_CST);
+	while(__atomic_load_n(&entry->readers, __ATOMIC_SEQ_CST) > 0);
+
 	CacheArray_CleanEntry(entry, cache->free_item);
 
 	return entry;
@@ -59,10 +166,13 @@ Cache *Cache_New(uint cap, CacheEntryFreeFunc freeFunc, CacheEntryCopyFunc copyF
 	ASSERT(copyFunc != NULL);
 
 	Cache *cache     = rm_malloc(sizeof(Cache));
+	cache->id        = __atomic_add_fetch(&_cache_id, 1, __ATOMIC_RELAXED);
 	cache->cap       = cap;
 	cache->size      = 0;
 	cache->lookup    = raxNew();       // Instantiate key entry mapping.
 	cache->counter   = 0;             // Initialize counter to zero.
+	cache->hits      = 0;
+	cache->misses    = 0;
 	cache->copy_item = copyFunc;
 	cache->free_item = freeFunc;
 	cache->arr = rm_calloc(cap, sizeof(CacheEntry)); // Array of cached values.
@@ -80,26 +190,46 @@ void *Cache_GetValue(Cache *cache, const char *key) {
 
 	ASSERT(cache != NULL);
 
+	size_t key_len = strlen(key);
+	size_t thread_key_len;
+	unsigned char *thread_key = _ThreadLookup_Key(cache, key, key_len,
+			&thread_key_len);
+
+	// try the calling thread's lookup first, avoiding the cache lock
+	item = _ThreadLookup_GetValue(cache, thread_key, thread_key_len);
+	if(item != NULL) {
+		__atomic_fetch_add(&cache->hits, 1, __ATOMIC_RELAXED);
+		rm_free(thread_key);
+		return item;
+	}
+
 	int res = pthread_rwlock_rdlock(&cache->_cache_rwlock);
 	UNUSED(res);
 	ASSERT(res == 0);
 
-	size_t key_len = strlen(key);
 	CacheEntry *entry = raxFind(cache->lookup, (unsigned char *)key, key_len);
 
-	if(entry == raxNotFound) goto cleanup;
+	if(entry == raxNotFound) {
+		__atomic_fetch_add(&cache->misses, 1, __ATOMIC_RELAXED);
+		goto cleanup;
+	}
+	__atomic_fetch_add(&cache->hits, 1, __ATOMIC_RELAXED);
 
 	/* element is now the most recently used; update its LRU
 	 * note that multiple threads can be here simultaneously */
-	cache->counter++;
-	entry->LRU = cache->counter;
+	entry->LRU = __atomic_add_fetch(&cache->counter, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&entry->hits, 1, __ATOMIC_RELAXED);
 
 	// return a copy of element
 	item = cache->copy_item(entry->value);
 
+	// remember the entry, later lookups by this thread skip the lock
+	_ThreadLookup_SetEntry(thread_key, thread_key_len, entry);
+
 cleanup:
 	res = pthread_rwlock_unlock(&cache->_cache_rwlock);
 	ASSERT(res == 0);
+	rm_free(thread_key);
 	return item;
 }
 
@@ -145,6 +275,79 @@ void *Cache_SetGetValue(Cache *cache, const char *key, void *value) {
 	return value_to_return;
 }
 
+CacheStats Cache_GetStats(Cache *cache) {
+	ASSERT(cache != NULL);
+
+	int res = pthread_rwlock_rdlock(&cache->_cache_rwlock);
+	UNUSED(res);
+	ASSERT(res == 0);
+
+	CacheStats stats;
+	stats.size    =  cache->size;
+	stats.cap     =  cache->cap;
+	stats.hits    =  __atomic_load_n(&cache->hits, __ATOMIC_RELAXED);
+	stats.misses  =  __atomic_load_n(&cache->misses, __ATOMIC_RELAXED);
+
+	res = pthread_rwlock_unlock(&cache->_cache_rwlock);
+	ASSERT(res == 0);
+
+	return stats;
+}
+
+void Cache_ForEach(Cache *cache, CacheEntryCallback cb, void *pdata) {
+	ASSERT(cache != NULL);
+	ASSERT(cb != NULL);
+
+	int res = pthread_rwlock_rdlock(&cache->_cache_rwlock);
+	UNUSED(res);
+	ASSERT(res == 0);
+
+	for(uint i = 0; i < cache->size; i++) {
+		CacheEntry *entry = cache->arr + i;
+		cb(entry->key, entry->value, pdata);
+	}
+
+	res = pthread_rwlock_unlock(&cache->_cache_rwlock);
+	ASSERT(res == 0);
+}
+
+// orders entries by descending number of hits
+static int _CacheEntry_HitsCmp(const void *a, const void *b) {
+	uint64_t hits_a = (*(const CacheEntry **)a)->hits;
+	uint64_t hits_b = (*(const CacheEntry **)b)->hits;
+	return (hits_a < hits_b) - (hits_a > hits_b);
+}
+
+char **Cache_HotKeys(Cache *cache, uint n) {
+	ASSERT(cache != NULL);
+
+	int res = pthread_rwlock_rdlock(&cache->_cache_rwlock);
+	UNUSED(res);
+	ASSERT(res == 0);
+
+	// collect entries which were hit at least once
+	uint count = 0;
+	CacheEntry **entries = rm_malloc(sizeof(CacheEntry *) * cache->size);
+	for(uint i = 0; i < cache->size; i++) {
+		CacheEntry *entry = cache->arr + i;
+		if(__atomic_load_n(&entry->hits, __ATOMIC_RELAXED) > 0) {
+			entries[count++] = entry;
+		}
+	}
+
+	qsort(entries, count, sizeof(CacheEntry *), _CacheEntry_HitsCmp);
+
+	if(n > count) n = count;
+	char **keys = array_new(char *, n);
+	for(uint i = 0; i < n; i++) array_append(keys, rm_strdup(entries[i]->key));
+	rm_free(entries);
+
+	res = pthread_rwlock_unlock(&cache->_cache_rwlock);
+	ASSERT(res == 0);
+
+	return keys;
+}
+
 void Cache_Free(Cache *cache) {
 	ASSERT(cache != NULL);
 
@@ -162,6 +365,9 @@ void Cache_Free(Cache *cache) {
 	UNUSED(res);
 	ASSERT(res == 0);
 
+	// threads forget their entries on their next lookup
+	__atomic_add_fetch(&_freed_caches, 1, __ATOMIC_RELEASE);
+
 	rm_free(cache);
 }
 
@@ -9,14 +9,32 @@
 #include "cache_array.h"
 #include "rax.h"
 
+/**
+ * @brief Cache usage statistics.
+ */
+typedef struct {
+	uint size;          // Number of cached entries.
+	uint cap;           // Cache capacity.
+	uint64_t hits;      // Number of lookups which found their key.
+	uint64_t misses;    // Number of lookups which missed their key.
+} CacheStats;
+
+/**
+ * @brief Callback invoked for each cached entry.
+ */
+typedef void (*CacheEntryCallback)(const char *key, void *value, void *pdata);
+
 /**
  * @brief Key-value cache, uses LRU policy for eviction.
  * Assumes owership over stored objects.
  */
 typedef struct Cache {
+	uint64_t id;                       // Unique cache id, scopes thread local lookups.
 	uint cap;                          // Cache capacity.
 	uint size;                         // Cache current size.
 	long long counter;                 // Atomic counter for number of reads.
+	uint64_t hits;                     // Number of lookups which found their key.
+	uint64_t misses;                   // Number of lookups which missed their key.
 	rax *lookup;                       // Mapping between keys to entries, for fast lookups.
 	CacheEntry *arr;                   // Array of cache elements.
 	CacheEntryFreeFunc free_item;      // Callback function that free cached value.
@@ -35,6 +53,8 @@ Cache *Cache_New(uint size, CacheEntryFreeFunc freeFunc, CacheEntryCopyFunc copy
 
 /**
  * @brief  Returns a copy of value if it is cached, NULL otherwise.
+ * @note   Each thread remembers the entries it had found, repeated lookups
+ *         of a key by the same thread copy the value without locking the cache.
  * @param  *cache: cache pointer.
  * @param  *key: Key to look for.
  * @retval  pointer with the cached answer, NULL if the key isn't cached.
@@ -60,6 +80,32 @@ void Cache_SetValue(Cache *cache, const char *key, void *item);
  */
 void *Cache_SetGetValue(Cache *cache, const char *key, void *value);
 
+/**
+ * @brief  Returns cache usage statistics.
+ * @param  *cache: cache pointer.
+ * @retval Cache statistics.
+ */
+CacheStats Cache_GetStats(Cache *cache);
+
+/**
+ * @brief  Invokes cb for each cached entry, holding the cache read lock.
+ * @note   Values are passed as stored, without copying them.
+ * @param  *cache: cache pointer.
+ * @param  cb: callback invoked for each entry.
+ * @param  *pdata: private data passed to cb.
+ */
+void Cache_ForEach(Cache *cache, CacheEntryCallback cb, void *pdata);
+
+/**
+ * @brief  Returns the keys of the n most hit entries, most hit first.
+ * @note   Entries which were never hit are skipped,
+ *         the caller is responsible for freeing the returned array and its keys.
+ * @param  *cache: cache pointer.
+ * @param  n: maximal number of keys to return.
+ * @retval Array of keys.
+ */
+char **Cache_HotKeys(Cache *cache, uint n);
+
 /**
  * @brief  Destroys the cache and free all stored items.
  * @param  *cache: cache pointer
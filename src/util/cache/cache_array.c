@@ -29,6 +29,7 @@ CacheEntry *CacheArray_PopulateEntry(long long counter, CacheEntry *entry, char
 	entry->key   = key;
 	entry->value = value;
 	entry->LRU   = counter;
+	entry->hits  = 0;
 
 	return entry;
 }
@@ -28,6 +28,9 @@ typedef struct CacheEntry_t {
 	char *key;      // Entry key.
 	void *value;    // Entry stored value.
 	long long LRU;  // Indicates the time when the entry was last recently used.
+	uint64_t hits;  // Number of lookups which found the entry.
+	uint64_t generation;  // Incremented whenever the entry is evicted.
+	uint readers;         // Number of threads copying the value without the cache lock.
 } CacheEntry;
 
 
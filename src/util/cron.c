@@ -1,30 +1,53 @@
 #include "cron.h"
-#include "heap.h"
 #include "rmalloc.h"
 #include "../RG.h"
 #include <time.h>
+#include <stdint.h>
 #include <pthread.h>
-#include <stdbool.h>
 
-#define MAX(a,b) ((a) >= (b)) ? (a) : (b)
+//------------------------------------------------------------------------------
+// Timer wheel
+//------------------------------------------------------------------------------
+
+// tasks are placed in a hierarchy of wheels, each wheel level spans
+// WHEEL_SIZE slots of the level beneath it, the lowest level's slots
+// span a single tick of a millisecond
+// as time advances past a slot of a higher level, its tasks are cascaded
+// into the levels beneath, such that every task fires from the lowest level
+#define WHEEL_BITS   6
+#define WHEEL_SIZE   (1 << WHEEL_BITS)
+#define WHEEL_MASK   (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+// number of ticks covered by the wheels, distant tasks are cascaded
+// once per revolution of the highest level until they're within range
+#define WHEEL_RANGE  (1ULL << (WHEEL_BITS * WHEEL_LEVELS))
+
+// milliseconds CRON sleeps while no task is pending
+#define IDLE_SLEEP 1000
 
 //------------------------------------------------------------------------------
 // Data structures
 //------------------------------------------------------------------------------
 
 // CRON task
-typedef struct {
-	struct timespec due;    // absolute time for when task should run
-	CronTaskCB cb;          // callback to call when task is due
-	void *pdata;            // [optional] private data passed to callback
+typedef struct CRON_TASK {
+	uint64_t due;             // tick at which task should run
+	CronTaskCB cb;            // callback to call when task is due
+	void *pdata;              // [optional] private data passed to callback
+	struct CRON_TASK *prev;   // previous task in slot
+	struct CRON_TASK *next;   // next task in slot
+	bool pending;             // task is held by the wheels
+	int ref_count;            // held by CRON and by an abortable task's handle
 } CRON_TASK;
 
 // CRON object
 typedef struct {
 	bool alive;                   // indicates cron is active
-	heap_t *tasks;                // min heap of cron tasks
+	CRON_TASK slots[WHEEL_LEVELS][WHEEL_SIZE];  // sentinels of each slot's task list
+	uint64_t now;                 // last tick processed, tasks due by it were executed
+	uint64_t wakeup;              // tick CRON's thread sleeps until
+	uint64_t task_count;          // number of pending tasks
 	pthread_mutex_t mutex;        // mutex control access to tasks
-	pthread_mutex_t condv_mutex;  // mutex control access to condv
 	pthread_cond_t condv;         // conditional variable
 	pthread_t thread;             // thread running cron main loop
 } CRON;
@@ -32,90 +55,152 @@ typedef struct {
 // single static CRON instance, initialized at CRON_Start
 static CRON *cron = NULL;
 
-// compares two time objects
-static int cmp_timespec(struct timespec a, struct timespec b) {
-	if(a.tv_sec == b.tv_sec) {
-		return a.tv_nsec - b.tv_nsec;
-	} else {
-		return a.tv_sec - b.tv_sec;
-	}
-}
-
-// minimum heap sort function
-static int CRON_JobCmp(const void *a, const void *b, const void *udata) {
-	CRON_TASK *_a = (CRON_TASK*)a;
-	CRON_TASK *_b = (CRON_TASK*)b;
-	return cmp_timespec(_b->due, _a->due);
-}
-
 //------------------------------------------------------------------------------
 // Utility functions
 //------------------------------------------------------------------------------
 
-// compute now + ms
-static struct timespec due_in_ms(uint ms) {
-	struct timespec due;
-    clock_gettime(CLOCK_REALTIME, &due);
-
-	due.tv_sec += ms / 1000;
-    due.tv_nsec += (ms % 1000) * 1000000;
+// returns the current tick, in milliseconds
+static uint64_t CRON_Now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
 
-	return due;
+// returns the absolute time of 'tick', as expected by the condition variable
+static struct timespec CRON_TickTime(uint64_t tick) {
+	struct timespec t;
+	t.tv_sec = tick / 1000;
+	t.tv_nsec = (tick % 1000) * 1000000;
+	return t;
 }
 
-static void CRON_WakeUp(void) {
-	// Set conditional variable to wake up CRON thread
-	pthread_mutex_lock(&cron->condv_mutex);
-	pthread_cond_signal(&cron->condv);
-	pthread_mutex_unlock(&cron->condv_mutex);
+static inline void CRON_SlotInit(CRON_TASK *slot) {
+	slot->prev = slot;
+	slot->next = slot;
 }
 
-// determines if task is due
-static bool CRON_TaskDue(const CRON_TASK *t) {
-	ASSERT(t);
+static inline bool CRON_SlotEmpty(const CRON_TASK *slot) {
+	return slot->next == slot;
+}
 
-	struct timespec now;
-    clock_gettime(CLOCK_REALTIME, &now);
-	return cmp_timespec(now, t->due) >= 0;
+static inline void CRON_Unlink(CRON_TASK *t) {
+	t->prev->next = t->next;
+	t->next->prev = t->prev;
+	t->prev = t;
+	t->next = t;
 }
 
-static CRON_TASK *CRON_Peek() {
-	pthread_mutex_lock(&cron->mutex);
-	CRON_TASK *task = Heap_peek(cron->tasks);
-	pthread_mutex_unlock(&cron->mutex);
-	return task;
+// places a task in the slot of the lowest level covering its due tick
+// overdue tasks are placed at 'earliest', the first tick yet to be processed
+// expects cron->mutex to be held
+static void CRON_Place(CRON_TASK *t, uint64_t earliest) {
+	uint64_t due = (t->due > earliest) ? t->due : earliest;
+	uint64_t delta = due - cron->now;
+
+	int level = 0;
+	while(level < WHEEL_LEVELS - 1 &&
+		  delta >= (1ULL << (WHEEL_BITS * (level + 1)))) {
+		level++;
+	}
+	// out of range, wait for a revolution of the highest level
+	if(delta >= WHEEL_RANGE) due = cron->now + WHEEL_RANGE - 1;
+
+	uint slot_idx = (due >> (WHEEL_BITS * level)) & WHEEL_MASK;
+	CRON_TASK *slot = &cron->slots[level][slot_idx];
+
+	t->prev = slot->prev;
+	t->next = slot;
+	slot->prev->next = t;
+	slot->prev = t;
 }
 
-static CRON_TASK *CRON_RemoveTask(void) {
-	pthread_mutex_lock(&cron->mutex);
-	CRON_TASK *task = (CRON_TASK*)Heap_poll(cron->tasks);
-	pthread_mutex_unlock(&cron->mutex);
-	return task;
+// advances the wheels by a single tick, moving due tasks to 'due'
+// expects cron->mutex to be held
+static void CRON_Tick(CRON_TASK *due) {
+	uint64_t now = ++cron->now;
+
+	// cascade higher level slots whose span begins at this tick
+	// tasks due by this tick are placed in the slot about to be processed
+	for(int level = 1; level < WHEEL_LEVELS; level++) {
+		if(now & ((1ULL << (WHEEL_BITS * level)) - 1)) break;
+		uint slot_idx = (now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+		CRON_TASK *slot = &cron->slots[level][slot_idx];
+		while(!CRON_SlotEmpty(slot)) {
+			CRON_TASK *t = slot->next;
+			CRON_Unlink(t);
+			CRON_Place(t, now);
+		}
+	}
+
+	CRON_TASK *slot = &cron->slots[0][now & WHEEL_MASK];
+	while(!CRON_SlotEmpty(slot)) {
+		CRON_TASK *t = slot->next;
+		CRON_Unlink(t);
+		t->pending = false;
+		cron->task_count--;
+
+		t->prev = due->prev;
+		t->next = due;
+		due->prev->next = t;
+		due->prev = t;
+	}
 }
 
-static void CRON_InsertTask(CRON_TASK *t) {
-	pthread_mutex_lock(&cron->mutex);
-	Heap_offer(&cron->tasks, t);
-	pthread_mutex_unlock(&cron->mutex);
+// returns the next tick at which a task might be due
+// expects cron->mutex to be held
+static uint64_t CRON_NextWakeUp(void) {
+	if(cron->task_count == 0) return cron->now + IDLE_SLEEP;
 
-	CRON_WakeUp();
+	// scan the lowest level up until the next cascade
+	uint64_t cascade = (cron->now | WHEEL_MASK) + 1;
+	for(uint64_t tick = cron->now + 1; tick < cascade; tick++) {
+		if(!CRON_SlotEmpty(&cron->slots[0][tick & WHEEL_MASK])) return tick;
+	}
+	return cascade;
 }
 
-static void CRON_PerformTask(CRON_TASK *t) {
+static void CRON_ReleaseTask(CRON_TASK *t) {
 	ASSERT(t);
-	t->cb(t->pdata);
+	if(__atomic_sub_fetch(&t->ref_count, 1, __ATOMIC_ACQ_REL) == 0) rm_free(t);
 }
 
-static void CRON_FreeTask(CRON_TASK *t) {
-	ASSERT(t);
-	rm_free(t);
+static CRON_TASK *CRON_InsertTask(uint when, CronTaskCB cb, void *pdata,
+		int ref_count) {
+	ASSERT(cron != NULL);
+	ASSERT(cb != NULL);
+
+	CRON_TASK *task = rm_malloc(sizeof(CRON_TASK));
+	task->cb         =  cb;
+	task->pdata      =  pdata;
+	task->pending    =  true;
+	task->ref_count  =  ref_count;
+
+	pthread_mutex_lock(&cron->mutex);
+	task->due = CRON_Now() + when;
+	CRON_Place(task, cron->now + 1);
+	cron->task_count++;
+	// wake CRON only if it sleeps past the task's due tick
+	bool wake = (task->due < cron->wakeup);
+	if(wake) cron->wakeup = task->due;
+	pthread_mutex_unlock(&cron->mutex);
+
+	if(wake) pthread_cond_signal(&cron->condv);
+	return task;
 }
 
 static void clear_tasks() {
-	CRON_TASK *task = NULL;
-	while((task = CRON_RemoveTask())) {
-		CRON_FreeTask(task);
+	for(int level = 0; level < WHEEL_LEVELS; level++) {
+		for(int i = 0; i < WHEEL_SIZE; i++) {
+			CRON_TASK *slot = &cron->slots[level][i];
+			while(!CRON_SlotEmpty(slot)) {
+				CRON_TASK *t = slot->next;
+				CRON_Unlink(t);
+				t->pending = false;
+				CRON_ReleaseTask(t);
+			}
+		}
 	}
+	cron->task_count = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -123,20 +208,33 @@ static void clear_tasks() {
 //------------------------------------------------------------------------------
 
 static void *Cron_Run(void *arg) {
+	CRON_TASK due;
+	CRON_SlotInit(&due);
+
+	pthread_mutex_lock(&cron->mutex);
 	while(cron->alive) {
-		// execute due tasks
-		CRON_TASK *task = NULL;
-		while((task = CRON_Peek()) && CRON_TaskDue(task)) {
-			task = CRON_RemoveTask();
-			CRON_PerformTask(task);
-			CRON_FreeTask(task);
+		// advance the wheels up to the current tick, collecting due tasks
+		uint64_t now = CRON_Now();
+		while(cron->now < now) CRON_Tick(&due);
+
+		// execute due tasks, tasks may introduce or abort other tasks
+		if(!CRON_SlotEmpty(&due)) {
+			pthread_mutex_unlock(&cron->mutex);
+			while(!CRON_SlotEmpty(&due)) {
+				CRON_TASK *t = due.next;
+				CRON_Unlink(t);
+				t->cb(t->pdata);
+				CRON_ReleaseTask(t);
+			}
+			pthread_mutex_lock(&cron->mutex);
+			continue;
 		}
 
-		struct timespec timeout = (task) ? task->due : due_in_ms(1000);
-		pthread_mutex_lock(&cron->condv_mutex);
-		pthread_cond_timedwait(&cron->condv, &cron->condv_mutex, &timeout);
-		pthread_mutex_unlock(&cron->condv_mutex);
+		cron->wakeup = CRON_NextWakeUp();
+		struct timespec timeout = CRON_TickTime(cron->wakeup);
+		pthread_cond_timedwait(&cron->condv, &cron->mutex, &timeout);
 	}
+	pthread_mutex_unlock(&cron->mutex);
 
 	return NULL;
 }
@@ -150,10 +248,21 @@ void Cron_Start(void) {
 
 	cron = rm_malloc(sizeof(CRON));
 	cron->alive = true;
-	cron->tasks = Heap_new(CRON_JobCmp, NULL);
-	pthread_cond_init(&cron->condv, NULL);
+	for(int level = 0; level < WHEEL_LEVELS; level++) {
+		for(int i = 0; i < WHEEL_SIZE; i++) CRON_SlotInit(&cron->slots[level][i]);
+	}
+	cron->now = CRON_Now();
+	cron->wakeup = cron->now;
+	cron->task_count = 0;
+
+	// ticks are measured by the monotonic clock
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cron->condv, &attr);
+	pthread_condattr_destroy(&attr);
+
 	pthread_mutex_init(&cron->mutex, NULL);
-	pthread_mutex_init(&cron->condv_mutex, NULL);
 	pthread_create(&cron->thread, NULL, Cron_Run, NULL);
 }
 
@@ -161,31 +270,49 @@ void Cron_Stop(void) {
 	ASSERT(cron != NULL);
 
 	// Stop cron main loop
+	pthread_mutex_lock(&cron->mutex);
 	cron->alive = false;
-	CRON_WakeUp();
+	pthread_mutex_unlock(&cron->mutex);
+	pthread_cond_signal(&cron->condv);
 
 	// Wait for thread to terminate
 	pthread_join(cron->thread, NULL);
 
 	clear_tasks();
 
-	Heap_free(cron->tasks);
 	pthread_mutex_destroy(&cron->mutex);
-	pthread_mutex_destroy(&cron->condv_mutex);
 	pthread_cond_destroy(&cron->condv);
 	rm_free(cron);
 	cron = NULL;
 }
 
 void Cron_AddTask(uint when, CronTaskCB cb, void *pdata) {
-	ASSERT(cron != NULL);
-	ASSERT(cb != NULL);
-
-	CRON_TASK *task = rm_malloc(sizeof(CRON_TASK));
-	task->cb     =  cb;
-	task->pdata  =  pdata;
-	task->due    =  due_in_ms(when);
+	CRON_InsertTask(when, cb, pdata, 1);
+}
 
-	CRON_InsertTask(task);
+CronTaskHandle Cron_AddAbortableTask(uint when, CronTaskCB cb, void *pdata) {
+	// referenced by CRON and by the returned handle
+	return CRON_InsertTask(when, cb, pdata, 2);
 }
 
+bool Cron_AbortTask(CronTaskHandle task) {
+	ASSERT(task != NULL);
+
+	// a stopped CRON discarded its tasks
+	bool aborted = false;
+	if(cron != NULL) {
+		pthread_mutex_lock(&cron->mutex);
+		if(task->pending) {
+			CRON_Unlink(task);
+			task->pending = false;
+			cron->task_count--;
+			aborted = true;
+		}
+		pthread_mutex_unlock(&cron->mutex);
+	}
+
+	// release CRON's reference of an aborted task and the handle's
+	if(aborted) CRON_ReleaseTask(task);
+	CRON_ReleaseTask(task);
+	return aborted;
+}
@@ -6,22 +6,29 @@
 
 #pragma once
 
-#include "heap.h"
+#include <stdbool.h>
 #include <sys/types.h>
 
 /* CRON is a task scheduler
  * a task is defined by:
  * when it should run; delta in ms from the time it's introduced
  * a callback to call when it is time to execute the task
- * and an optional private data passed to the callback */
+ * and an optional private data passed to the callback
+ *
+ * tasks are kept in a hierarchical timer wheel, introducing and
+ * aborting a task takes constant time, tasks are executed within
+ * a millisecond of their due time */
 
 // task callback function
 typedef void (*CronTaskCB)(void *pdata);
 
+// handle to an abortable task, see Cron_AddAbortableTask
+typedef struct CRON_TASK *CronTaskHandle;
+
 // Start CRON, should be called once
 void Cron_Start(void);
 
-// Stop CRON
+// Stop CRON, pending tasks are discarded without being executed
 void Cron_Stop(void);
 
 // Create a new CRON task
@@ -32,3 +39,21 @@ void Cron_AddTask
 	void *pdata     // private data to pass to callback
 );
 
+// Create a new CRON task which can be aborted before it is due
+// the returned handle must be passed to Cron_AbortTask exactly once,
+// whether or not the task was executed
+CronTaskHandle Cron_AddAbortableTask
+(
+	uint when,      // number of miliseconds until task invocation
+	CronTaskCB cb,  // callback to call when task is due
+	void *pdata     // private data to pass to callback
+);
+
+// Abort a task and release its handle
+// returns true if the task was aborted, in which case its callback
+// is never called, false if the task was executed or is executing
+bool Cron_AbortTask
+(
+	CronTaskHandle task  // task to abort
+);
+
@@ -8,25 +8,37 @@
 #include "datablock.h"
 #include "datablock_iterator.h"
 #include "../arr.h"
+#include "../qsort.h"
 #include "../rmalloc.h"
 #include <math.h>
+#include <string.h>
 #include <stdbool.h>
 
 // Computes the number of blocks required to accommodate n items.
 #define ITEM_COUNT_TO_BLOCK_COUNT(n) \
     ceil((double)n / DATABLOCK_BLOCK_CAP)
 
-// Computes block index from item index.
-#define ITEM_INDEX_TO_BLOCK_INDEX(idx) \
-    (idx / DATABLOCK_BLOCK_CAP)
+// Sets or clears the occupancy bit of item at position idx.
+#define OCCUPANCY_SET(dataBlock, idx) \
+    ((dataBlock)->occupancy[(idx) / 64] |= (1ULL << ((idx) % 64)))
 
-// Computes item position within a block.
-#define ITEM_POSITION_WITHIN_BLOCK(idx) \
-    (idx % DATABLOCK_BLOCK_CAP)
+#define OCCUPANCY_CLEAR(dataBlock, idx) \
+    __atomic_fetch_and((dataBlock)->occupancy + ((idx) / 64), ~(1ULL << ((idx) % 64)), \
+                       __ATOMIC_RELAXED)
 
-// Retrieves block in which item with index resides.
-#define GET_ITEM_BLOCK(dataBlock, idx) \
-    dataBlock->blocks[ITEM_INDEX_TO_BLOCK_INDEX(idx)]
+// Set while a forked child shares the process pages, see DataBlock_SetForkActive.
+static bool _fork_active = false;
+
+// Last block version assigned, shared by all datablocks such that
+// versions are never reused, see DataBlock_BlockVersion.
+static uint64_t _version = 0;
+
+// Assigns block blockIdx a new version.
+// Items are deleted concurrently by GraphBLAS operations, see DataBlock_DeleteItem.
+static inline void _DataBlock_Touch(DataBlock *dataBlock, uint blockIdx) {
+	uint64_t version = __atomic_add_fetch(&_version, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(dataBlock->versions + blockIdx, version, __ATOMIC_RELAXED);
+}
 
 static void _DataBlock_AddBlocks(DataBlock *dataBlock, uint blockCount) {
 	ASSERT(dataBlock && blockCount > 0);
@@ -38,9 +50,18 @@ static void _DataBlock_AddBlocks(DataBlock *dataBlock, uint blockCount) {
 	else
 		dataBlock->blocks = rm_realloc(dataBlock->blocks, sizeof(Block *) * dataBlock->blockCount);
 
+	// New blocks hold no items.
+	size_t words = (size_t)dataBlock->blockCount * DATABLOCK_OCCUPANCY_WORDS;
+	size_t prevWords = (size_t)prevBlockCount * DATABLOCK_OCCUPANCY_WORDS;
+	dataBlock->occupancy = rm_realloc(dataBlock->occupancy, sizeof(uint64_t) * words);
+	memset(dataBlock->occupancy + prevWords, 0, sizeof(uint64_t) * (words - prevWords));
+	dataBlock->versions = rm_realloc(dataBlock->versions,
+									 sizeof(uint64_t) * dataBlock->blockCount);
+
 	uint i;
 	for(i = prevBlockCount; i < dataBlock->blockCount; i++) {
 		dataBlock->blocks[i] = Block_New(dataBlock->itemSize, DATABLOCK_BLOCK_CAP);
+		_DataBlock_Touch(dataBlock, i);
 		if(i > 0) dataBlock->blocks[i - 1]->next = dataBlock->blocks[i];
 	}
 	dataBlock->blocks[i - 1]->next = NULL;
@@ -48,19 +69,20 @@ static void _DataBlock_AddBlocks(DataBlock *dataBlock, uint blockCount) {
 	dataBlock->itemCap = dataBlock->blockCount * DATABLOCK_BLOCK_CAP;
 }
 
-// Checks to see if idx is within global array bounds
-// array bounds are between 0 and itemCount + #deleted indices
-// e.g. [3, 7, 2, D, 1, D, 5] where itemCount = 5 and #deleted indices is 2
-// and so it is valid to query the array with idx 6.
-static inline bool _DataBlock_IndexOutOfBounds(const DataBlock *dataBlock, uint64_t idx) {
-	return (idx >= (dataBlock->itemCount + array_len(dataBlock->deletedIdx)));
+// Retrieves item at position idx, allocated or not.
+static inline void *_DataBlock_Item(const DataBlock *dataBlock, uint64_t idx) {
+	return GET_BLOCK_ITEM(GET_ITEM_BLOCK(dataBlock, idx), idx, dataBlock->itemSize);
 }
 
-static inline DataBlockItemHeader *DataBlock_GetItemHeader(const DataBlock *dataBlock,
-														   uint64_t idx) {
-	Block *block = GET_ITEM_BLOCK(dataBlock, idx);
-	idx = ITEM_POSITION_WITHIN_BLOCK(idx);
-	return (DataBlockItemHeader *)block->data + (idx * block->itemSize);
+// Recreates a block released by compaction, all of its items are deleted
+// as the block's occupancy bits are clear.
+static Block *_DataBlock_RestoreBlock(DataBlock *dataBlock, uint blockIdx) {
+	ASSERT(dataBlock->blocks[blockIdx] == NULL);
+
+	Block *block = Block_New(dataBlock->itemSize, DATABLOCK_BLOCK_CAP);
+	dataBlock->blocks[blockIdx] = block;
+	_DataBlock_Touch(dataBlock, blockIdx);
+	return block;
 }
 
 //------------------------------------------------------------------------------
@@ -70,9 +92,11 @@ static inline DataBlockItemHeader *DataBlock_GetItemHeader(const DataBlock *data
 DataBlock *DataBlock_New(uint64_t itemCap, uint itemSize, fpDestructor fp) {
 	DataBlock *dataBlock = rm_malloc(sizeof(DataBlock));
 	dataBlock->itemCount = 0;
-	dataBlock->itemSize = itemSize + ITEM_HEADER_SIZE;
+	dataBlock->itemSize = itemSize;
 	dataBlock->blockCount = 0;
 	dataBlock->blocks = NULL;
+	dataBlock->occupancy = NULL;
+	dataBlock->versions = NULL;
 	dataBlock->deletedIdx = array_new(uint64_t, 128);
 	dataBlock->destructor = fp;
 	int res = pthread_mutex_init(&dataBlock->mutex, NULL);
@@ -88,18 +112,20 @@ uint64_t DataBlock_ItemCount(const DataBlock *dataBlock) {
 
 DataBlockIterator *DataBlock_Scan(const DataBlock *dataBlock) {
 	ASSERT(dataBlock != NULL);
-	Block *startBlock = dataBlock->blocks[0];
 
 	// Deleted items are skipped, we're about to perform
 	// array_len(dataBlock->deletedIdx) skips during out scan.
 	int64_t endPos = dataBlock->itemCount + array_len(dataBlock->deletedIdx);
-	return DataBlockIterator_New(startBlock, 0, endPos, 1);
+	return DataBlockIterator_New(dataBlock, 0, endPos, 1);
 }
 
 // Make sure datablock can accommodate at least k items.
 void DataBlock_Accommodate(DataBlock *dataBlock, int64_t k) {
-	// Compute number of free slots.
-	int64_t freeSlotsCount = dataBlock->itemCap - dataBlock->itemCount;
+	// Compute number of free slots,
+	// deleted indices are not reused while a fork is active.
+	int64_t usedSlotsCount = dataBlock->itemCount;
+	if(_fork_active) usedSlotsCount += array_len(dataBlock->deletedIdx);
+	int64_t freeSlotsCount = dataBlock->itemCap - usedSlotsCount;
 	int64_t additionalItems = k - freeSlotsCount;
 
 	if(additionalItems > 0) {
@@ -108,59 +134,72 @@ void DataBlock_Accommodate(DataBlock *dataBlock, int64_t k) {
 	}
 }
 
-void *DataBlock_GetItem(const DataBlock *dataBlock, uint64_t idx) {
-	ASSERT(dataBlock != NULL);
 
-	ASSERT(!_DataBlock_IndexOutOfBounds(dataBlock, idx));
+uint64_t DataBlock_BlockVersion(const DataBlock *dataBlock, uint blockIdx) {
+	ASSERT(dataBlock != NULL && blockIdx < dataBlock->blockCount);
+	return __atomic_load_n(dataBlock->versions + blockIdx, __ATOMIC_RELAXED);
+}
+
+uint64_t DataBlock_BlockItemCount(const DataBlock *dataBlock, uint blockIdx) {
+	ASSERT(dataBlock != NULL && blockIdx < dataBlock->blockCount);
 
-	DataBlockItemHeader *item_header = DataBlock_GetItemHeader(dataBlock, idx);
+	uint64_t count = 0;
+	const uint64_t *words = dataBlock->occupancy + (size_t)blockIdx * DATABLOCK_OCCUPANCY_WORDS;
+	for(uint w = 0; w < DATABLOCK_OCCUPANCY_WORDS; w++) count += __builtin_popcountll(words[w]);
+	return count;
+}
 
-	// Incase item is marked as deleted, return NULL.
-	if(IS_ITEM_DELETED(item_header)) return NULL;
+void DataBlock_MarkModified(DataBlock *dataBlock, uint64_t idx) {
+	ASSERT(dataBlock != NULL && idx < dataBlock->itemCap);
+	_DataBlock_Touch(dataBlock, ITEM_INDEX_TO_BLOCK_INDEX(idx));
+}
 
-	return ITEM_DATA(item_header);
+void DataBlock_SetForkActive(bool active) {
+	_fork_active = active;
 }
 
 void *DataBlock_AllocateItem(DataBlock *dataBlock, uint64_t *idx) {
+	// Get index into which to store item,
+	// prefer reusing free indicies, unless a forked child shares our pages
+	// in which case items are appended, leaving shared blocks untouched.
+	uint64_t deletedCount = array_len(dataBlock->deletedIdx);
+	bool reuse = deletedCount > 0 && !_fork_active;
+	uint64_t end = dataBlock->itemCount + deletedCount;
+
 	// Make sure we've got room for items.
-	if(dataBlock->itemCount >= dataBlock->itemCap) {
+	if(!reuse && end >= dataBlock->itemCap) {
 		// Allocate twice as much items then we currently hold.
-		uint newCap = dataBlock->itemCount * 2;
+		uint64_t newCap = MAX(end * 2, 1);
 		uint requiredAdditionalBlocks = ITEM_COUNT_TO_BLOCK_COUNT(newCap) - dataBlock->blockCount;
 		_DataBlock_AddBlocks(dataBlock, requiredAdditionalBlocks);
 	}
 
-	// Get index into which to store item,
-	// prefer reusing free indicies.
-	uint pos = dataBlock->itemCount;
-	if(array_len(dataBlock->deletedIdx) > 0) {
-		pos = array_pop(dataBlock->deletedIdx);
-	}
+	uint64_t pos = reuse ? array_pop(dataBlock->deletedIdx) : end;
 	dataBlock->itemCount++;
 
 	if(idx) *idx = pos;
 
-	DataBlockItemHeader *item_header = DataBlock_GetItemHeader(dataBlock, pos);
-	MARK_HEADER_AS_NOT_DELETED(item_header);
+	uint blockIdx = ITEM_INDEX_TO_BLOCK_INDEX(pos);
+	if(dataBlock->blocks[blockIdx] == NULL) _DataBlock_RestoreBlock(dataBlock, blockIdx);
 
-	return ITEM_DATA(item_header);
+	OCCUPANCY_SET(dataBlock, pos);
+	_DataBlock_Touch(dataBlock, blockIdx);
+
+	return _DataBlock_Item(dataBlock, pos);
 }
 
 void DataBlock_DeleteItem(DataBlock *dataBlock, uint64_t idx) {
 	ASSERT(dataBlock != NULL);
-	ASSERT(!_DataBlock_IndexOutOfBounds(dataBlock, idx));
+	ASSERT(!DataBlock_IndexOutOfBounds(dataBlock, idx));
 
-	// Return if item already deleted.
-	DataBlockItemHeader *item_header = DataBlock_GetItemHeader(dataBlock, idx);
-	if(IS_ITEM_DELETED(item_header)) return;
+	// Return if item already deleted, released blocks hold no items.
+	if(!OCCUPANCY_TEST(dataBlock, idx)) return;
 
 	// Call item destructor.
-	if(dataBlock->destructor) {
-		unsigned char *item = ITEM_DATA(item_header);
-		dataBlock->destructor(item);
-	}
+	if(dataBlock->destructor) dataBlock->destructor(_DataBlock_Item(dataBlock, idx));
 
-	MARK_HEADER_AS_DELETED(item_header);
+	OCCUPANCY_CLEAR(dataBlock, idx);
+	_DataBlock_Touch(dataBlock, ITEM_INDEX_TO_BLOCK_INDEX(idx));
 
 	/* DataBlock_DeleteItem should be thread-safe as it's being called
 	 * from GraphBLAS concurent operations, e.g. GxB_SelectOp.
@@ -180,15 +219,171 @@ uint DataBlock_DeletedItemsCount(const DataBlock *dataBlock) {
 	return array_len(dataBlock->deletedIdx);
 }
 
-inline bool DataBlock_ItemIsDeleted(void *item) {
-	DataBlockItemHeader *header = GET_ITEM_HEADER(item);
-	return IS_ITEM_DELETED(header);
+size_t DataBlock_MemoryUsage(const DataBlock *dataBlock) {
+	ASSERT(dataBlock != NULL);
+
+	size_t usage = sizeof(DataBlock) +
+				   sizeof(Block *) * dataBlock->blockCount +
+				   sizeof(uint64_t) * dataBlock->blockCount * DATABLOCK_OCCUPANCY_WORDS +
+				   sizeof(uint64_t) * dataBlock->blockCount +
+				   sizeof(uint64_t) * array_len(dataBlock->deletedIdx);
+
+	// released blocks don't consume memory
+	for(uint i = 0; i < dataBlock->blockCount; i++) {
+		if(dataBlock->blocks[i] == NULL) continue;
+		usage += sizeof(Block) + (size_t)dataBlock->itemSize * DATABLOCK_BLOCK_CAP;
+	}
+
+	return usage;
+}
+
+// Deleted indices are popped from the array's end,
+// order them such that the lowest index is reused first.
+#define DELETED_IDX_ISGT(a, b) (*(a) > *(b))
+
+size_t DataBlock_Compact(DataBlock *dataBlock) {
+	ASSERT(dataBlock != NULL);
+
+	// Compaction rewrites shared pages, postpone it while a fork is active.
+	if(_fork_active) return 0;
+
+	uint64_t deletedCount = array_len(dataBlock->deletedIdx);
+	uint64_t end = dataBlock->itemCount + deletedCount;
+	size_t released = 0;
+
+	QSORT(uint64_t, dataBlock->deletedIdx, deletedCount, DELETED_IDX_ISGT);
+
+	// Trim trailing deleted items, which lead the deleted indices array.
+	uint64_t trimmed = 0;
+	while(trimmed < deletedCount && dataBlock->deletedIdx[trimmed] == end - 1) {
+		trimmed++;
+		end--;
+	}
+	if(trimmed > 0) {
+		memmove(dataBlock->deletedIdx, dataBlock->deletedIdx + trimmed,
+				sizeof(uint64_t) * (deletedCount - trimmed));
+		dataBlock->deletedIdx = array_trimm_len(dataBlock->deletedIdx, deletedCount - trimmed);
+	}
+
+	// Release blocks past the last item, retaining at least a single block.
+	uint blockCount = MAX(ITEM_COUNT_TO_BLOCK_COUNT(end), 1);
+	size_t blockSize = sizeof(Block) + (size_t)dataBlock->itemSize * DATABLOCK_BLOCK_CAP;
+	for(uint i = blockCount; i < dataBlock->blockCount; i++) {
+		if(dataBlock->blocks[i] == NULL) continue;
+		Block_Free(dataBlock->blocks[i]);
+		released += blockSize;
+	}
+	if(blockCount < dataBlock->blockCount) {
+		released += (sizeof(Block *) + sizeof(uint64_t) * (DATABLOCK_OCCUPANCY_WORDS + 1)) *
+					(dataBlock->blockCount - blockCount);
+		dataBlock->blockCount = blockCount;
+		dataBlock->blocks = rm_realloc(dataBlock->blocks, sizeof(Block *) * blockCount);
+		dataBlock->occupancy = rm_realloc(dataBlock->occupancy,
+										  sizeof(uint64_t) * blockCount * DATABLOCK_OCCUPANCY_WORDS);
+		dataBlock->versions = rm_realloc(dataBlock->versions, sizeof(uint64_t) * blockCount);
+		dataBlock->itemCap = blockCount * DATABLOCK_BLOCK_CAP;
+	}
+
+	// Release blocks holding no items, the last block is retained.
+	Block *prev = NULL;
+	for(uint i = 0; i < dataBlock->blockCount; i++) {
+		Block *block = dataBlock->blocks[i];
+		if(block == NULL) continue;
+
+		bool empty = (i + 1 < dataBlock->blockCount);
+		const uint64_t *words = dataBlock->occupancy + (size_t)i * DATABLOCK_OCCUPANCY_WORDS;
+		for(uint w = 0; w < DATABLOCK_OCCUPANCY_WORDS && empty; w++) empty = (words[w] == 0);
+
+		if(empty) {
+			Block_Free(block);
+			dataBlock->blocks[i] = NULL;
+			_DataBlock_Touch(dataBlock, i);
+			released += blockSize;
+			continue;
+		}
+
+		// Keep remaining blocks chained.
+		if(prev) prev->next = block;
+		prev = block;
+	}
+	if(prev) prev->next = NULL;
+
+	return released;
+}
+
+void DataBlock_Permute(DataBlock *dataBlock, const uint64_t *order) {
+	ASSERT(dataBlock != NULL && order != NULL);
+
+	uint64_t count = dataBlock->itemCount;
+	size_t dataSize = dataBlock->itemSize;
+
+	// Gather items in their new order.
+	unsigned char *items = rm_malloc(dataSize * MAX(count, 1));
+	for(uint64_t i = 0; i < count; i++) {
+		void *item = DataBlock_GetItem(dataBlock, order[i]);
+		ASSERT(item != NULL);
+		memcpy(items + i * dataSize, item, dataSize);
+	}
+
+	// Vacate every index, then lay items out from the first index.
+	memset(dataBlock->occupancy, 0,
+		   sizeof(uint64_t) * dataBlock->blockCount * DATABLOCK_OCCUPANCY_WORDS);
+	array_clear(dataBlock->deletedIdx);
+
+	for(uint64_t pos = 0; pos < count; pos++) {
+		uint blockIdx = ITEM_INDEX_TO_BLOCK_INDEX(pos);
+		if(dataBlock->blocks[blockIdx] == NULL) _DataBlock_RestoreBlock(dataBlock, blockIdx);
+
+		OCCUPANCY_SET(dataBlock, pos);
+		memcpy(_DataBlock_Item(dataBlock, pos), items + pos * dataSize, dataSize);
+	}
+
+	// Every block's items were relocated.
+	for(uint i = 0; i < dataBlock->blockCount; i++) _DataBlock_Touch(dataBlock, i);
+
+	rm_free(items);
+}
+
+bool DataBlock_FreeLastBlock(DataBlock *dataBlock) {
+	ASSERT(dataBlock != NULL);
+	if(dataBlock->blockCount == 0) return false;
+
+	uint blockIdx = dataBlock->blockCount - 1;
+	Block *block = dataBlock->blocks[blockIdx];
+	if(block != NULL) {
+		// Visit allocated items by the block's occupancy bitmap.
+		const uint64_t *words = dataBlock->occupancy +
+								(size_t)blockIdx * DATABLOCK_OCCUPANCY_WORDS;
+		for(uint w = 0; w < DATABLOCK_OCCUPANCY_WORDS; w++) {
+			uint64_t word = words[w];
+			while(word) {
+				uint pos = w * 64 + __builtin_ctzll(word);
+				word &= word - 1;
+				if(dataBlock->destructor) {
+					dataBlock->destructor(GET_BLOCK_ITEM(block, pos, dataBlock->itemSize));
+				}
+				dataBlock->itemCount--;
+			}
+		}
+		Block_Free(block);
+	}
+
+	dataBlock->blockCount--;
+	dataBlock->itemCap = dataBlock->blockCount * DATABLOCK_BLOCK_CAP;
+	if(blockIdx > 0 && dataBlock->blocks[blockIdx - 1]) {
+		dataBlock->blocks[blockIdx - 1]->next = NULL;
+	}
+	return true;
 }
 
 void DataBlock_Free(DataBlock *dataBlock) {
-	for(uint i = 0; i < dataBlock->blockCount; i++) Block_Free(dataBlock->blocks[i]);
+	for(uint i = 0; i < dataBlock->blockCount; i++) {
+		if(dataBlock->blocks[i]) Block_Free(dataBlock->blocks[i]);
+	}
 
 	rm_free(dataBlock->blocks);
+	rm_free(dataBlock->occupancy);
+	rm_free(dataBlock->versions);
 	array_free(dataBlock->deletedIdx);
 	int res = pthread_mutex_destroy(&dataBlock->mutex);
 	UNUSED(res);
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include "../arr.h"
 #include "../block.h"
 #include "./datablock_iterator.h"
 
@@ -17,46 +18,57 @@ typedef void (*fpDestructor)(void *);
 // Number of items in a block. Should always be a power of 2.
 #define DATABLOCK_BLOCK_CAP 16384
 
-// Returns the item header size.
-#define ITEM_HEADER_SIZE 1
+// Number of 64 bit words in a block's occupancy bitmap.
+#define DATABLOCK_OCCUPANCY_WORDS (DATABLOCK_BLOCK_CAP / 64)
 
-// DataBlock item is stored as ||header|data||. This macro retrive the data pointer out of the header pointer.
-#define ITEM_DATA(header) ((void *)((header) + ITEM_HEADER_SIZE))
+// Number of items ahead of the current one prefetched by scans and batch retrievals.
+#define DATABLOCK_PREFETCH_DISTANCE 8
 
-// DataBlock item is stored as ||header|data||. This macro retrive the header pointer out of the data pointer.
-#define GET_ITEM_HEADER(item) ((item) - ITEM_HEADER_SIZE)
+// Computes block index from item index.
+#define ITEM_INDEX_TO_BLOCK_INDEX(idx) \
+    ((idx) / DATABLOCK_BLOCK_CAP)
 
-// Sets the deleted bit in the header to 1.
-#define MARK_HEADER_AS_DELETED(header) ((header)->deleted |= 1)
+// Computes item position within a block.
+#define ITEM_POSITION_WITHIN_BLOCK(idx) \
+    ((idx) % DATABLOCK_BLOCK_CAP)
 
-// Sets the deleted bit in the header to 0.
-#define MARK_HEADER_AS_NOT_DELETED(header) ((header)->deleted &= 0)
+// Retrieves block in which item with index resides.
+#define GET_ITEM_BLOCK(dataBlock, idx) \
+    (dataBlock)->blocks[ITEM_INDEX_TO_BLOCK_INDEX(idx)]
 
-// Checks if the deleted bit in the header is 1 or not.
-#define IS_ITEM_DELETED(header) ((header)->deleted & 1)
+// Retrieves item at position idx within block, allocated or not.
+#define GET_BLOCK_ITEM(block, idx, itemSize) \
+    ((void *)((block)->data + ITEM_POSITION_WITHIN_BLOCK(idx) * (itemSize)))
+
+// Checks if the occupancy bit of item at position idx is set.
+#define OCCUPANCY_TEST(dataBlock, idx) \
+    ((dataBlock)->occupancy[(idx) / 64] & (1ULL << ((idx) % 64)))
 
 
 /* The DataBlock is a container structure for holding arbitrary items of a uniform type
  * in order to reduce the number of alloc/free calls and improve locality of reference.
  * Item deletions are thread-safe, and a DataBlockIterator can be used to traverse a
- * range within the block. */
-typedef struct {
+ * range within the block.
+ * Items are laid out back to back, each block is accompanied by an occupancy bitmap,
+ * a set bit marks an allocated item, such that items retain their natural alignment
+ * and scans skip runs of deleted items a word at a time.
+ * A block whose items are all deleted may be released by DataBlock_Compact,
+ * in which case its entry in blocks is NULL.
+ * Each block carries a version, which changes whenever its items do,
+ * allowing derived state, e.g. encoded snapshots, to be maintained per block. */
+typedef struct DataBlock {
 	uint64_t itemCount;         // Number of items stored in datablock.
 	uint64_t itemCap;           // Number of items datablock can hold.
 	uint blockCount;            // Number of blocks in datablock.
 	uint itemSize;              // Size of a single item in bytes.
 	Block **blocks;             // Array of blocks.
+	uint64_t *occupancy;        // Occupancy bitmaps, DATABLOCK_OCCUPANCY_WORDS per block.
+	uint64_t *versions;         // Version of each block, see DataBlock_BlockVersion.
 	uint64_t *deletedIdx;       // Array of free indicies.
 	pthread_mutex_t mutex;      // Mutex guarding from concurent updates.
 	fpDestructor destructor;    // Function pointer to a clean-up function of an item.
 } DataBlock;
 
-// This struct is for data block item header data.
-// TODO: Consider using pragma pack/pop for tight memory/word alignment.
-typedef struct {
-	unsigned char deleted: 1;  // A bit indicate if the current item is deleted or not.
-} DataBlockItemHeader;
-
 // Create a new DataBlock
 // itemCap - number of items datablock can hold before resizing.
 // itemSize - item size in bytes.
@@ -72,8 +84,62 @@ void DataBlock_Accommodate(DataBlock *dataBlock, int64_t k);
 // Returns an iterator which scans entire datablock.
 DataBlockIterator *DataBlock_Scan(const DataBlock *dataBlock);
 
-// Get item at position idx
-void *DataBlock_GetItem(const DataBlock *dataBlock, uint64_t idx);
+// Checks to see if idx is within global array bounds
+// array bounds are between 0 and itemCount + #deleted indices
+// e.g. [3, 7, 2, D, 1, D, 5] where itemCount = 5 and #deleted indices is 2
+// and so it is valid to query the array with idx 6.
+static inline bool DataBlock_IndexOutOfBounds(const DataBlock *dataBlock, uint64_t idx) {
+	return (idx >= (dataBlock->itemCount + array_len(dataBlock->deletedIdx)));
+}
+
+// Get item at position idx, NULL if the item is deleted
+// itemSize must equal the datablock's item size, passing it as a constant,
+// e.g. sizeof(Entity), turns item addressing into a constant multiplication.
+static inline void *DataBlock_GetItemSized(const DataBlock *dataBlock, uint64_t idx,
+		uint itemSize) {
+	ASSERT(dataBlock != NULL && itemSize == dataBlock->itemSize);
+	ASSERT(!DataBlock_IndexOutOfBounds(dataBlock, idx));
+
+	// Released blocks hold no items, their occupancy bits are clear.
+	if(!OCCUPANCY_TEST(dataBlock, idx)) return NULL;
+	return GET_BLOCK_ITEM(GET_ITEM_BLOCK(dataBlock, idx), idx, itemSize);
+}
+
+// Get item at position idx, NULL if the item is deleted.
+static inline void *DataBlock_GetItem(const DataBlock *dataBlock, uint64_t idx) {
+	ASSERT(dataBlock != NULL);
+	return DataBlock_GetItemSized(dataBlock, idx, dataBlock->itemSize);
+}
+
+// Hints the CPU to fetch item at position idx ahead of its access,
+// NOP if idx is out of bounds.
+static inline void DataBlock_PrefetchItem(const DataBlock *dataBlock, uint64_t idx) {
+	ASSERT(dataBlock != NULL);
+
+	if(DataBlock_IndexOutOfBounds(dataBlock, idx)) return;
+	const Block *block = GET_ITEM_BLOCK(dataBlock, idx);
+	if(block == NULL) return;
+
+	__builtin_prefetch(GET_BLOCK_ITEM(block, idx, dataBlock->itemSize));
+}
+
+// Marks whether a forked child shares the process pages, e.g. during BGSAVE,
+// while set, deleted indices are not reused and compaction is postponed
+// such that writes land in fresh blocks rather than in pages shared with the child.
+void DataBlock_SetForkActive(bool active);
+
+// Returns the version of block blockIdx, holding items
+// [blockIdx * DATABLOCK_BLOCK_CAP, (blockIdx + 1) * DATABLOCK_BLOCK_CAP)
+// a block's version changes whenever one of its items is allocated, deleted,
+// relocated or marked as modified, versions are unique across datablocks
+// and never reused.
+uint64_t DataBlock_BlockVersion(const DataBlock *dataBlock, uint blockIdx);
+
+// Returns the number of items held by block blockIdx.
+uint64_t DataBlock_BlockItemCount(const DataBlock *dataBlock, uint blockIdx);
+
+// Marks item at position idx as modified, changing its block's version.
+void DataBlock_MarkModified(DataBlock *dataBlock, uint64_t idx);
 
 // Allocate a new item within given dataBlock,
 // if idx is not NULL, idx will contain item position
@@ -86,8 +152,32 @@ void DataBlock_DeleteItem(DataBlock *dataBlock, uint64_t idx);
 // Returns the number of deleted items.
 uint DataBlock_DeletedItemsCount(const DataBlock *dataBlock);
 
-// Returns true if the given item has been deleted.
-bool DataBlock_ItemIsDeleted(void *item);
+// Returns the number of bytes allocated by the datablock,
+// excluding memory owned by its items.
+size_t DataBlock_MemoryUsage(const DataBlock *dataBlock);
+
+// Returns true if item at position idx has been deleted.
+static inline bool DataBlock_ItemIsDeleted(const DataBlock *dataBlock, uint64_t idx) {
+	ASSERT(dataBlock != NULL);
+	return DataBlock_IndexOutOfBounds(dataBlock, idx) || !OCCUPANCY_TEST(dataBlock, idx);
+}
+
+// Defragments the datablock, item indices are preserved:
+// deleted indices are reused lowest first, trailing deleted items are trimmed
+// and blocks holding no items are released.
+// Returns the number of bytes released.
+size_t DataBlock_Compact(DataBlock *dataBlock);
+
+// Relocates every item, such that item order[i] is placed at index i.
+// order lists each of the datablock's items exactly once,
+// once relocated the datablock holds no deleted items.
+void DataBlock_Permute(DataBlock *dataBlock, const uint64_t *order);
+
+// Releases the datablock's last block, calling the destructor on each of its items.
+// Spreads the teardown of a large datablock, once called the datablock
+// may only be passed to further calls and to DataBlock_Free.
+// Returns false if the datablock holds no blocks.
+bool DataBlock_FreeLastBlock(DataBlock *dataBlock);
 
 // Free block.
 void DataBlock_Free(DataBlock *block);
@@ -11,13 +11,12 @@
 #include <stdio.h>
 #include <stdbool.h>
 
-DataBlockIterator *DataBlockIterator_New(Block *block, uint64_t start_pos, uint64_t end_pos, uint step) {
-	ASSERT(block && end_pos >= start_pos && step >= 1);
+DataBlockIterator *DataBlockIterator_New(const DataBlock *datablock, uint64_t start_pos,
+										 uint64_t end_pos, uint step) {
+	ASSERT(datablock && end_pos >= start_pos && step >= 1);
 
 	DataBlockIterator *iter = rm_malloc(sizeof(DataBlockIterator));
-	iter->_start_block = block;
-	iter->_current_block = block;
-	iter->_block_pos = start_pos % DATABLOCK_BLOCK_CAP;
+	iter->_datablock = datablock;
 	iter->_start_pos = start_pos;
 	iter->_current_pos = iter->_start_pos;
 	iter->_end_pos = end_pos;
@@ -26,46 +25,63 @@ DataBlockIterator *DataBlockIterator_New(Block *block, uint64_t start_pos, uint6
 }
 
 DataBlockIterator *DataBlockIterator_Clone(const DataBlockIterator *it) {
-	return DataBlockIterator_New(it->_start_block, it->_start_pos, it->_end_pos, it->_step);
+	return DataBlockIterator_New(it->_datablock, it->_start_pos, it->_end_pos, it->_step);
 }
 
 void *DataBlockIterator_Next(DataBlockIterator *iter, uint64_t *id) {
 	ASSERT(iter != NULL);
 
-	// Set default.
-	void *item = NULL;
-	DataBlockItemHeader *item_header = NULL;
+	const DataBlock *dataBlock = iter->_datablock;
+	const uint64_t *occupancy = dataBlock->occupancy;
+	uint64_t pos = iter->_current_pos;
+	uint64_t end = iter->_end_pos;
+	uint step = iter->_step;
 
 	// Have we reached the end of our iterator?
-	while(iter->_current_pos < iter->_end_pos && iter->_current_block != NULL) {
-		// Get item at current position.
-		Block *block = iter->_current_block;
-		item_header = (DataBlockItemHeader *)block->data + (iter->_block_pos * block->itemSize);
-
-		// Advance to next position.
-		iter->_block_pos += iter->_step;
-		iter->_current_pos += iter->_step;
-
-		// Advance to next block if current block consumed.
-		if(iter->_block_pos >= DATABLOCK_BLOCK_CAP) {
-			iter->_block_pos -= DATABLOCK_BLOCK_CAP;
-			iter->_current_block = iter->_current_block->next;
+	while(pos < end) {
+		// Occupancy of current position and the rest of its word.
+		uint64_t word = occupancy[pos / 64] >> (pos % 64);
+
+		if(word == 0) {
+			// Skip to the first position past the current word.
+			uint64_t skip = 64 - (pos % 64);
+			pos += ((skip + step - 1) / step) * step;
+			continue;
+		}
+
+		if(step == 1) {
+			// Jump directly to the next occupied position.
+			pos += __builtin_ctzll(word);
+			if(pos >= end) break;
+		} else if(!(word & 1)) {
+			pos += step;
+			continue;
 		}
 
-		if(!IS_ITEM_DELETED(item_header)) {
-			item = ITEM_DATA(item_header);
-			if(id) *id = iter->_current_pos - iter->_step;
-			break;
+		// Position is occupied, prefetch the item a few positions ahead
+		// such that its storage is cached once reached.
+		uint64_t ahead = pos + (uint64_t)step * DATABLOCK_PREFETCH_DISTANCE;
+		if(ahead < end) {
+			const Block *next = GET_ITEM_BLOCK(dataBlock, ahead);
+			if(next) __builtin_prefetch(GET_BLOCK_ITEM(next, ahead, dataBlock->itemSize));
 		}
+
+		if(id) *id = pos;
+		iter->_current_pos = pos + step;
+		return GET_BLOCK_ITEM(GET_ITEM_BLOCK(dataBlock, pos), pos, dataBlock->itemSize);
 	}
 
-	return item;
+	iter->_current_pos = end;
+	return NULL;
+}
+
+void DataBlockIterator_Seek(DataBlockIterator *iter, uint64_t pos) {
+	ASSERT(iter != NULL);
+	iter->_current_pos = (pos < iter->_end_pos) ? pos : iter->_end_pos;
 }
 
 void DataBlockIterator_Reset(DataBlockIterator *iter) {
 	ASSERT(iter != NULL);
-	iter->_block_pos = iter->_start_pos % DATABLOCK_BLOCK_CAP;
-	iter->_current_block = iter->_start_block;
 	iter->_current_pos = iter->_start_pos;
 }
 
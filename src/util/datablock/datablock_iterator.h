@@ -9,12 +9,14 @@
 #include <stdint.h>
 #include "../block.h"
 
-/* Datablock iterator iterates over items within a datablock. */
+struct DataBlock;
+
+/* Datablock iterator iterates over items within a datablock,
+ * consulting the blocks' occupancy bitmaps to skip deleted items,
+ * the storage of items ahead of the iterator is prefetched. */
 
 typedef struct {
-	Block *_start_block;			// First block accessed by iterator.
-	Block *_current_block;			// Current block.
-	uint _block_pos;				// Position within a block.
+	const struct DataBlock *_datablock;	// Iterated datablock.
 	uint64_t _start_pos;			// Iterator initial position.
 	uint64_t _current_pos;			// Iterator current position.
 	uint64_t _end_pos;				// Iterator won't pass end position.
@@ -23,7 +25,7 @@ typedef struct {
 
 // Creates a new datablock iterator.
 DataBlockIterator *DataBlockIterator_New(
-	Block *block,       // Block from which iteration begins.
+	const struct DataBlock *datablock,  // Datablock to iterate.
 	uint64_t start_pos,	// Iteration starts here.
 	uint64_t end_pos,	// Iteration stops here.
 	uint step           // To scan entire range, set step to 1.
@@ -42,6 +44,9 @@ DataBlockIterator *DataBlockIterator_Clone(
 // `id` will be set to the returned item index
 void *DataBlockIterator_Next(DataBlockIterator *iter, uint64_t *id);
 
+// Moves the iterator to position pos, bounded by its end position.
+void DataBlockIterator_Seek(DataBlockIterator *iter, uint64_t pos);
+
 // Reset iterator to original position.
 void DataBlockIterator_Reset(DataBlockIterator *iter);
 
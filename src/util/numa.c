@@ -0,0 +1,141 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "numa.h"
+#include "RG.h"
+#include "rmalloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#define NUMA_SYSFS "/sys/devices/system/node"
+
+// memory policies, see set_mempolicy(2)
+#define NUMA_MPOL_DEFAULT    0
+#define NUMA_MPOL_INTERLEAVE 3
+
+static uint _node_count = 1;
+static pthread_once_t _initialized = PTHREAD_ONCE_INIT;
+
+#if defined(__linux__)
+
+static cpu_set_t *_node_cpus = NULL;    // CPUs of each node
+static unsigned long _node_mask = 0;  // online nodes, the first 64 node IDs
+
+// parses a sysfs list, e.g. "0-3,8-11", into set
+// returns false if the list is malformed
+static bool _ParseList(const char *list, cpu_set_t *set) {
+	CPU_ZERO(set);
+	const char *p = list;
+	while(*p != '\0' && *p != '\n') {
+		char *end;
+		long first = strtol(p, &end, 10);
+		if(end == p || first < 0) return false;
+		long last = first;
+		if(*end == '-') {
+			p = end + 1;
+			last = strtol(p, &end, 10);
+			if(end == p || last < first) return false;
+		}
+		for(long i = first; i <= last && i < CPU_SETSIZE; i++) CPU_SET(i, set);
+		p = end;
+		if(*p == ',') p++;
+	}
+	return true;
+}
+
+// reads the sysfs list at path into set
+static bool _ReadList(const char *path, cpu_set_t *set) {
+	FILE *f = fopen(path, "r");
+	if(f == NULL) return false;
+
+	char list[4096];
+	bool res = fgets(list, sizeof(list), f) != NULL && _ParseList(list, set);
+	fclose(f);
+	return res;
+}
+
+static void _NUMA_Init(void) {
+	cpu_set_t online;
+	if(!_ReadList(NUMA_SYSFS "/online", &online)) return;
+
+	uint count = CPU_COUNT(&online);
+	if(count == 0) return;
+
+	cpu_set_t *node_cpus = rm_malloc(sizeof(cpu_set_t) * count);
+	uint n = 0;
+	for(int id = 0; id < CPU_SETSIZE && n < count; id++) {
+		if(!CPU_ISSET(id, &online)) continue;
+
+		char path[128];
+		snprintf(path, sizeof(path), NUMA_SYSFS "/node%d/cpulist", id);
+		// memory-only nodes hold no CPUs, threads aren't placed on them
+		if(!_ReadList(path, node_cpus + n) || CPU_COUNT(node_cpus + n) == 0) {
+			continue;
+		}
+		if(id < (int)(sizeof(_node_mask) * 8)) _node_mask |= 1UL << id;
+		n++;
+	}
+
+	if(n == 0) {
+		rm_free(node_cpus);
+		return;
+	}
+
+	_node_cpus = node_cpus;
+	_node_count = n;
+}
+
+#else
+
+// topology isn't exposed, the machine is a single node
+static void _NUMA_Init(void) {
+}
+
+#endif
+
+void NUMA_Init(void) {
+	pthread_once(&_initialized, _NUMA_Init);
+}
+
+uint NUMA_NodeCount(void) {
+	NUMA_Init();
+	return _node_count;
+}
+
+bool NUMA_PinThread(pthread_t thread, uint node) {
+	NUMA_Init();
+	ASSERT(node < _node_count);
+
+#if defined(__linux__)
+	if(_node_cpus == NULL) return false;
+	return pthread_setaffinity_np(thread, sizeof(cpu_set_t),
+			_node_cpus + node) == 0;
+#else
+	return false;
+#endif
+}
+
+bool NUMA_InterleaveMemory(bool interleave) {
+	NUMA_Init();
+
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+	if(interleave) {
+		// a single node has nothing to interleave across
+		if(_node_count < 2) return false;
+		return syscall(SYS_set_mempolicy, NUMA_MPOL_INTERLEAVE, &_node_mask,
+				sizeof(_node_mask) * 8) == 0;
+	}
+	return syscall(SYS_set_mempolicy, NUMA_MPOL_DEFAULT, NULL, 0) == 0;
+#else
+	return false;
+#endif
+}
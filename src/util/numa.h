@@ -0,0 +1,38 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+// NUMA topology, as exposed by Linux under /sys/devices/system/node
+// where it isn't exposed, the machine is treated as a single node
+
+// discovers the machine's NUMA topology, called once at module load
+// later calls are NOPs
+void NUMA_Init(void);
+
+// returns the number of NUMA nodes, at least 1
+uint NUMA_NodeCount(void);
+
+// restricts thread to the CPUs of the given node
+// returns false if thread affinity isn't supported
+bool NUMA_PinThread
+(
+	pthread_t thread,  // thread to pin
+	uint node          // node index, 0 to NUMA_NodeCount() - 1
+);
+
+// interleaves pages allocated by the calling thread across all nodes
+// threads the calling thread creates inherit its policy
+// when interleave is false, pages are allocated on the first-touch node
+// returns false if memory policies aren't supported
+bool NUMA_InterleaveMemory
+(
+	bool interleave
+);
@@ -1,5 +1,64 @@
 #include "rmalloc.h"
 
+// memory consumption of the current thread
+static __thread int64_t _n_alloced = 0;
+// peak memory consumption of the current thread
+static __thread int64_t _n_alloced_peak = 0;
+// maximum memory a thread may consume, 0 for unlimited
+static int64_t _mem_capacity = 0;
+
+#ifdef REDIS_MODULE_TARGET
+
+// allocator functions wrapped by the accounting functions
+static void *(*_alloc)(size_t bytes);
+static void *(*_calloc)(size_t nmemb, size_t size);
+static void *(*_realloc)(void *ptr, size_t bytes);
+static void (*_free)(void *ptr);
+static char *(*_strdup)(const char *str);
+
+static inline void _Alloc_Consume(void *p) {
+	if(p == NULL) return;
+	_n_alloced += RedisModule_MallocSize(p);
+	if(_n_alloced > _n_alloced_peak) _n_alloced_peak = _n_alloced;
+}
+
+static inline void _Alloc_Release(void *p) {
+	if(p == NULL) return;
+	_n_alloced -= RedisModule_MallocSize(p);
+}
+
+static void *_Alloc_WithAccounting(size_t bytes) {
+	void *p = _alloc(bytes);
+	_Alloc_Consume(p);
+	return p;
+}
+
+static void *_Calloc_WithAccounting(size_t nmemb, size_t size) {
+	void *p = _calloc(nmemb, size);
+	_Alloc_Consume(p);
+	return p;
+}
+
+static void *_Realloc_WithAccounting(void *ptr, size_t bytes) {
+	_Alloc_Release(ptr);
+	void *p = _realloc(ptr, bytes);
+	_Alloc_Consume(p);
+	return p;
+}
+
+static void _Free_WithAccounting(void *ptr) {
+	_Alloc_Release(ptr);
+	_free(ptr);
+}
+
+static char *_Strdup_WithAccounting(const char *str) {
+	char *p = _strdup(str);
+	_Alloc_Consume(p);
+	return p;
+}
+
+#endif
+
 /* Redefine the allocator functions to use the malloc family.
  * Only to be used when running module code from a non-Redis
  * context, such as unit tests. */
@@ -10,3 +69,59 @@ void Alloc_Reset() {
   RedisModule_Free = free;
   RedisModule_Strdup = strdup;
 }
+
+void Alloc_EnableAccounting(void) {
+#ifdef REDIS_MODULE_TARGET
+	// accounting relies on the allocator reporting allocation sizes
+	if(RedisModule_MallocSize == NULL) return;
+	if(RedisModule_Alloc == _Alloc_WithAccounting) return;
+
+	_alloc   = RedisModule_Alloc;
+	_calloc  = RedisModule_Calloc;
+	_realloc = RedisModule_Realloc;
+	_free    = RedisModule_Free;
+	_strdup  = RedisModule_Strdup;
+
+	RedisModule_Alloc   = _Alloc_WithAccounting;
+	RedisModule_Calloc  = _Calloc_WithAccounting;
+	RedisModule_Realloc = _Realloc_WithAccounting;
+	RedisModule_Free    = _Free_WithAccounting;
+	RedisModule_Strdup  = _Strdup_WithAccounting;
+#endif
+}
+
+void Alloc_SetMemCapacity(int64_t cap) {
+	_mem_capacity = (cap > 0) ? cap : 0;
+}
+
+void Alloc_ResetConsumption(void) {
+	_n_alloced = 0;
+	_n_alloced_peak = 0;
+}
+
+int64_t Alloc_GetConsumption(void) {
+	return _n_alloced;
+}
+
+void Alloc_AddConsumption(int64_t bytes) {
+	_n_alloced += bytes;
+	if(_n_alloced > _n_alloced_peak) _n_alloced_peak = _n_alloced;
+}
+
+int64_t Alloc_GetPeakConsumption(void) {
+	return _n_alloced_peak;
+}
+
+AllocConsumption Alloc_SaveConsumption(void) {
+	AllocConsumption consumption = {_n_alloced, _n_alloced_peak};
+	return consumption;
+}
+
+void Alloc_RestoreConsumption(AllocConsumption consumption) {
+	_n_alloced = consumption.alloced;
+	_n_alloced_peak = consumption.peak;
+}
+
+bool Alloc_CapacityExceeded(void) {
+	return _mem_capacity > 0 && _n_alloced > _mem_capacity;
+}
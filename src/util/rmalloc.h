@@ -2,6 +2,8 @@
 #define __REDISGRAPH_ALLOC__
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include "../redismodule.h"
 
@@ -52,5 +54,47 @@ static inline char *rm_strndup(const char *s, size_t n) {
  * contexts like unit tests. */
 void Alloc_Reset(void);
 
+/* Per-thread memory accounting.
+ * Once enabled, memory allocated and freed through the allocator
+ * is attributed to the calling thread; a query resets its thread's
+ * counters before it starts executing. */
+void Alloc_EnableAccounting(void);
+
+/* Sets the maximum number of bytes a thread may hold since its
+ * counters were last reset, 0 for unlimited. */
+void Alloc_SetMemCapacity(int64_t cap);
+
+/* Resets the calling thread's memory counters. */
+void Alloc_ResetConsumption(void);
+
+/* Returns the calling thread's memory consumption in bytes,
+ * since its counters were last reset. */
+int64_t Alloc_GetConsumption(void);
+
+/* Attributes 'bytes' allocated by another thread on the calling thread's
+ * behalf to the calling thread, which is to free them. */
+void Alloc_AddConsumption(int64_t bytes);
+
+/* Returns the calling thread's peak memory consumption in bytes,
+ * since its counters were last reset. */
+int64_t Alloc_GetPeakConsumption(void);
+
+/* Memory counters of a thread, carried along by a query
+ * which migrates to another thread. */
+typedef struct {
+	int64_t alloced;  // bytes held
+	int64_t peak;     // peak bytes held
+} AllocConsumption;
+
+/* Returns the calling thread's memory counters. */
+AllocConsumption Alloc_SaveConsumption(void);
+
+/* Sets the calling thread's memory counters, as saved by another thread. */
+void Alloc_RestoreConsumption(AllocConsumption consumption);
+
+/* Returns true if the calling thread's memory consumption
+ * exceeded the configured capacity. */
+bool Alloc_CapacityExceeded(void);
+
 #endif
 
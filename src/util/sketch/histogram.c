@@ -0,0 +1,105 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "histogram.h"
+#include "RG.h"
+#include "../rmalloc.h"
+#include <string.h>
+
+static inline uint _Histogram_BucketIdx(uint64_t value) {
+	if(value < HISTOGRAM_SUB_BUCKETS) return value;
+
+	uint exp = 63 - __builtin_clzll(value);
+	if(exp >= HISTOGRAM_MAX_BITS) return HISTOGRAM_BUCKETS - 1;
+
+	// leading bits following the most significant one select the sub-bucket
+	uint shift = exp - HISTOGRAM_SUB_BUCKET_BITS;
+	uint sub = (value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1);
+	return ((shift + 1) << HISTOGRAM_SUB_BUCKET_BITS) + sub;
+}
+
+// returns the value representing bucket idx, the middle of its range
+static inline uint64_t _Histogram_BucketValue(uint idx) {
+	if(idx < HISTOGRAM_SUB_BUCKETS) return idx;
+
+	uint shift = (idx >> HISTOGRAM_SUB_BUCKET_BITS) - 1;
+	uint64_t sub = idx & (HISTOGRAM_SUB_BUCKETS - 1);
+	uint64_t lower = (HISTOGRAM_SUB_BUCKETS + sub) << shift;
+	return lower + ((1ULL << shift) >> 1);
+}
+
+Histogram *Histogram_New(void) {
+	return rm_calloc(1, sizeof(Histogram));
+}
+
+void Histogram_Record(Histogram *h, uint64_t value) {
+	ASSERT(h != NULL);
+
+	__atomic_fetch_add(h->buckets + _Histogram_BucketIdx(value), 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->sum, value, __ATOMIC_RELAXED);
+
+	uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+	while(value > max &&
+		  !__atomic_compare_exchange_n(&h->max, &max, value, true,
+			  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+uint64_t Histogram_Count(const Histogram *h) {
+	ASSERT(h != NULL);
+	return __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+}
+
+uint64_t Histogram_Sum(const Histogram *h) {
+	ASSERT(h != NULL);
+	return __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+}
+
+uint64_t Histogram_Max(const Histogram *h) {
+	ASSERT(h != NULL);
+	return __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+}
+
+uint64_t Histogram_Quantile(const Histogram *h, double q) {
+	ASSERT(h != NULL);
+	ASSERT(q >= 0 && q <= 1);
+
+	// buckets are read one by one while values might be recorded
+	// sum them up rather than relying on 'count'
+	uint64_t counts[HISTOGRAM_BUCKETS];
+	uint64_t total = 0;
+	for(uint i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		counts[i] = __atomic_load_n(h->buckets + i, __ATOMIC_RELAXED);
+		total += counts[i];
+	}
+	if(total == 0) return 0;
+
+	// rank of the requested value, 1 based
+	uint64_t rank = (uint64_t)(q * total);
+	if(rank < 1) rank = 1;
+
+	uint64_t max = Histogram_Max(h);
+	uint64_t seen = 0;
+	for(uint i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += counts[i];
+		if(seen < rank) continue;
+		// don't report beyond the largest recorded value
+		uint64_t v = _Histogram_BucketValue(i);
+		return (v < max) ? v : max;
+	}
+
+	return max;
+}
+
+void Histogram_Reset(Histogram *h) {
+	ASSERT(h != NULL);
+	memset(h, 0, sizeof(Histogram));
+}
+
+void Histogram_Free(Histogram *h) {
+	ASSERT(h != NULL);
+	rm_free(h);
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// number of bits resolving a value within its power of two
+// bucket width is at most 1 / 2^HISTOGRAM_SUB_BUCKET_BITS, ~12.5%, of its values
+#define HISTOGRAM_SUB_BUCKET_BITS 3
+
+// number of buckets covering each power of two
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+
+// values at or above 2^HISTOGRAM_MAX_BITS are recorded into the last bucket
+#define HISTOGRAM_MAX_BITS 40
+
+// number of buckets
+#define HISTOGRAM_BUCKETS \
+	((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) << HISTOGRAM_SUB_BUCKET_BITS)
+
+// HDR-style log-linear histogram of unsigned integer values
+//
+// values below HISTOGRAM_SUB_BUCKETS are counted exactly,
+// each larger power of two is split into HISTOGRAM_SUB_BUCKETS equal buckets
+// such that quantiles are reported within a bounded relative error
+//
+// values are recorded with atomic increments, recording threads
+// don't synchronize among themselves nor with readers
+typedef struct {
+	uint64_t buckets[HISTOGRAM_BUCKETS];  // number of values per bucket
+	uint64_t count;                       // number of recorded values
+	uint64_t sum;                         // sum of recorded values
+	uint64_t max;                         // largest recorded value
+} Histogram;
+
+// create a new, empty histogram
+Histogram *Histogram_New(void);
+
+// record value
+void Histogram_Record
+(
+	Histogram *h,   // histogram
+	uint64_t value  // recorded value
+);
+
+// returns number of recorded values
+uint64_t Histogram_Count
+(
+	const Histogram *h  // histogram
+);
+
+// returns sum of recorded values
+uint64_t Histogram_Sum
+(
+	const Histogram *h  // histogram
+);
+
+// returns largest recorded value
+uint64_t Histogram_Max
+(
+	const Histogram *h  // histogram
+);
+
+// returns an estimate of the q-quantile of recorded values
+// 0 if the histogram is empty
+uint64_t Histogram_Quantile
+(
+	const Histogram *h,  // histogram
+	double q             // quantile, within [0, 1]
+);
+
+// forget all recorded values
+void Histogram_Reset
+(
+	Histogram *h  // histogram
+);
+
+// free histogram
+void Histogram_Free
+(
+	Histogram *h  // histogram
+);
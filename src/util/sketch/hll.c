@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "hll.h"
+#include "RG.h"
+#include "../arr.h"
+#include "../rmalloc.h"
+#include <math.h>
+#include <string.h>
+
+#define SPARSE_ENTRY(reg, rank) (((uint32_t)(reg) << 8) | (rank))
+#define SPARSE_REGISTER(e) ((e) >> 8)
+#define SPARSE_RANK(e) ((e) & 0xFF)
+
+// split hash into register index and rank
+// rank is the position of the first set bit following the register bits
+static inline void _HLL_Split(uint64_t hash, uint32_t *reg, uint8_t *rank) {
+	*reg = hash >> (64 - HLL_PRECISION);
+	// guard bit bounds the rank at 64 - HLL_PRECISION + 1
+	uint64_t w = (hash << HLL_PRECISION) | ((uint64_t)1 << (HLL_PRECISION - 1));
+	*rank = __builtin_clzll(w) + 1;
+}
+
+static inline void _HLL_SetRegister(uint8_t *registers, uint32_t reg,
+		uint8_t rank) {
+	if(registers[reg] < rank) registers[reg] = rank;
+}
+
+// convert sparse entries into dense registers
+static void _HLL_Densify(HLL *hll) {
+	ASSERT(hll->registers == NULL);
+
+	hll->registers = rm_calloc(HLL_REGISTERS, sizeof(uint8_t));
+	uint32_t count = array_len(hll->sparse);
+	for(uint32_t i = 0; i < count; i++) {
+		uint32_t e = hll->sparse[i];
+		_HLL_SetRegister(hll->registers, SPARSE_REGISTER(e), SPARSE_RANK(e));
+	}
+
+	array_free(hll->sparse);
+	hll->sparse = NULL;
+}
+
+// returns the position of the first sparse entry with a register >= reg
+static uint32_t _HLL_SparseFind(const HLL *hll, uint32_t reg) {
+	uint32_t lo = 0;
+	uint32_t hi = array_len(hll->sparse);
+	while(lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if(SPARSE_REGISTER(hll->sparse[mid]) < reg) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+static void _HLL_SetSparse(HLL *hll, uint32_t reg, uint8_t rank) {
+	uint32_t count = array_len(hll->sparse);
+	uint32_t pos = _HLL_SparseFind(hll, reg);
+
+	if(pos < count && SPARSE_REGISTER(hll->sparse[pos]) == reg) {
+		if(SPARSE_RANK(hll->sparse[pos]) < rank) {
+			hll->sparse[pos] = SPARSE_ENTRY(reg, rank);
+		}
+		return;
+	}
+
+	if(count == HLL_SPARSE_MAX) {
+		_HLL_Densify(hll);
+		_HLL_SetRegister(hll->registers, reg, rank);
+		return;
+	}
+
+	// shift entries to make room for the new register
+	hll->sparse = array_append(hll->sparse, 0);
+	memmove(hll->sparse + pos + 1, hll->sparse + pos,
+			sizeof(uint32_t) * (count - pos));
+	hll->sparse[pos] = SPARSE_ENTRY(reg, rank);
+}
+
+HLL *HLL_New(void) {
+	HLL *hll = rm_malloc(sizeof(HLL));
+	hll->sparse = array_new(uint32_t, 0);
+	hll->registers = NULL;
+	return hll;
+}
+
+void HLL_Add(HLL *hll, uint64_t hash) {
+	ASSERT(hll != NULL);
+
+	uint32_t reg;
+	uint8_t rank;
+	_HLL_Split(hash, &reg, &rank);
+
+	if(hll->registers) _HLL_SetRegister(hll->registers, reg, rank);
+	else _HLL_SetSparse(hll, reg, rank);
+}
+
+void HLL_Merge(HLL *dst, const HLL *src) {
+	ASSERT(dst != NULL && src != NULL);
+
+	if(src->registers == NULL) {
+		uint32_t count = array_len(src->sparse);
+		for(uint32_t i = 0; i < count; i++) {
+			uint32_t e = src->sparse[i];
+			if(dst->registers) {
+				_HLL_SetRegister(dst->registers, SPARSE_REGISTER(e), SPARSE_RANK(e));
+			} else {
+				_HLL_SetSparse(dst, SPARSE_REGISTER(e), SPARSE_RANK(e));
+			}
+		}
+		return;
+	}
+
+	if(dst->registers == NULL) _HLL_Densify(dst);
+	for(uint32_t i = 0; i < HLL_REGISTERS; i++) {
+		_HLL_SetRegister(dst->registers, i, src->registers[i]);
+	}
+}
+
+uint64_t HLL_Count(const HLL *hll) {
+	ASSERT(hll != NULL);
+
+	const double m = HLL_REGISTERS;
+	double sum = 0;
+	uint32_t zeros = 0;
+
+	if(hll->registers) {
+		for(uint32_t i = 0; i < HLL_REGISTERS; i++) {
+			uint8_t rank = hll->registers[i];
+			if(rank == 0) zeros++;
+			sum += ldexp(1.0, -rank);
+		}
+	} else {
+		uint32_t count = array_len(hll->sparse);
+		zeros = HLL_REGISTERS - count;
+		sum = zeros;
+		for(uint32_t i = 0; i < count; i++) {
+			sum += ldexp(1.0, -SPARSE_RANK(hll->sparse[i]));
+		}
+	}
+
+	double alpha = 0.7213 / (1 + 1.079 / m);
+	double estimate = alpha * m * m / sum;
+
+	// small range correction, linear counting
+	if(estimate <= 2.5 * m && zeros > 0) estimate = m * log(m / zeros);
+
+	return (uint64_t)llround(estimate);
+}
+
+void HLL_Free(HLL *hll) {
+	if(hll == NULL) return;
+	if(hll->sparse) array_free(hll->sparse);
+	if(hll->registers) rm_free(hll->registers);
+	rm_free(hll);
+}
+
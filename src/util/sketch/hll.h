@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// number of hash bits selecting a register
+// standard error is 1.04 / sqrt(2^HLL_PRECISION), ~0.8%
+#define HLL_PRECISION 14
+
+// number of registers
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+// maximal number of sparse entries kept before switching to dense registers
+#define HLL_SPARSE_MAX (HLL_REGISTERS / 16)
+
+// HyperLogLog cardinality estimator
+//
+// estimates the number of distinct 64 bit hashes added to it
+// small sketches keep a sorted array of (register, rank) pairs
+// which is converted into a dense register array once it grows
+// past HLL_SPARSE_MAX entries, bounding memory at HLL_REGISTERS bytes
+typedef struct {
+	uint32_t *sparse;    // sorted (register << 8 | rank) entries, NULL once dense
+	uint8_t *registers;  // dense registers, NULL while sparse
+} HLL;
+
+// create a new, empty sketch
+HLL *HLL_New(void);
+
+// add a hashed value to the sketch
+void HLL_Add
+(
+	HLL *hll,      // sketch
+	uint64_t hash  // hash of added value
+);
+
+// merge src into dst, dst estimates the union of both sketches
+void HLL_Merge
+(
+	HLL *dst,       // merged into sketch
+	const HLL *src  // merged sketch
+);
+
+// estimate number of distinct hashes added to sketch
+uint64_t HLL_Count
+(
+	const HLL *hll  // sketch
+);
+
+// free sketch
+void HLL_Free
+(
+	HLL *hll  // sketch
+);
+
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "tdigest.h"
+#include "RG.h"
+#include "../qsort.h"
+#include "../rmalloc.h"
+#include <math.h>
+
+#define CENTROID_ISLT(a, b) ((a)->mean < (b)->mean)
+
+// k1 scale function, maps quantile q to scale k
+static inline double _TDigest_K(double q) {
+	return (TDIGEST_COMPRESSION / (2 * M_PI)) * asin(2 * q - 1);
+}
+
+// inverse of the k1 scale function
+static inline double _TDigest_Q(double k) {
+	return (sin(k * (2 * M_PI) / TDIGEST_COMPRESSION) + 1) / 2;
+}
+
+// merge buffered points into the compressed centroids
+static void _TDigest_Compress(TDigest *td) {
+	if(td->buffer_count == 0) return;
+
+	uint32_t n = td->centroid_count + td->buffer_count;
+	TDigestCentroid *c = td->centroids;
+	QSORT(TDigestCentroid, c, n, CENTROID_ISLT);
+
+	// greedily fold neighbouring centroids as long as the merged
+	// centroid doesn't span more than a single unit of scale
+	double total = td->weight;
+	double weight_so_far = 0;  // weight preceding the current centroid
+	double q_limit = _TDigest_Q(_TDigest_K(0) + 1) * total;
+	uint32_t cur = 0;
+
+	for(uint32_t i = 1; i < n; i++) {
+		double w = weight_so_far + c[cur].weight + c[i].weight;
+		if(w <= q_limit) {
+			double weight = c[cur].weight + c[i].weight;
+			c[cur].mean += (c[i].mean - c[cur].mean) * c[i].weight / weight;
+			c[cur].weight = weight;
+		} else {
+			weight_so_far += c[cur].weight;
+			q_limit = _TDigest_Q(_TDigest_K(weight_so_far / total) + 1) * total;
+			c[++cur] = c[i];
+		}
+	}
+
+	td->centroid_count = cur + 1;
+	td->buffer_count = 0;
+	ASSERT(td->centroid_count <= TDIGEST_CENTROID_CAP);
+}
+
+static inline void _TDigest_AddCentroid(TDigest *td, double mean, double weight) {
+	if(td->buffer_count == TDIGEST_BUFFER_CAP) _TDigest_Compress(td);
+
+	TDigestCentroid *c = td->centroids + td->centroid_count + td->buffer_count;
+	c->mean = mean;
+	c->weight = weight;
+	td->buffer_count++;
+	td->weight += weight;
+}
+
+TDigest *TDigest_New(void) {
+	TDigest *td = rm_malloc(sizeof(TDigest));
+
+	td->centroids = rm_malloc(sizeof(TDigestCentroid) *
+			(TDIGEST_CENTROID_CAP + TDIGEST_BUFFER_CAP));
+	td->centroid_count  =  0;
+	td->buffer_count    =  0;
+	td->weight          =  0;
+	td->min             =  INFINITY;
+	td->max             =  -INFINITY;
+
+	return td;
+}
+
+void TDigest_Add(TDigest *td, double v) {
+	ASSERT(td != NULL);
+
+	// NaN can't be ordered
+	if(isnan(v)) return;
+
+	if(v < td->min) td->min = v;
+	if(v > td->max) td->max = v;
+	_TDigest_AddCentroid(td, v, 1);
+}
+
+void TDigest_Merge(TDigest *dst, const TDigest *src) {
+	ASSERT(dst != NULL && src != NULL);
+
+	uint32_t n = src->centroid_count + src->buffer_count;
+	for(uint32_t i = 0; i < n; i++) {
+		_TDigest_AddCentroid(dst, src->centroids[i].mean, src->centroids[i].weight);
+	}
+
+	if(src->min < dst->min) dst->min = src->min;
+	if(src->max > dst->max) dst->max = src->max;
+}
+
+double TDigest_Quantile(TDigest *td, double q) {
+	ASSERT(td != NULL);
+	ASSERT(q >= 0 && q <= 1);
+
+	if(td->weight == 0) return NAN;
+
+	_TDigest_Compress(td);
+
+	const TDigestCentroid *c = td->centroids;
+	uint32_t n = td->centroid_count;
+	if(n == 1) return c[0].mean;
+
+	double target = q * td->weight;
+
+	// interpolate between minimum and the first centroid's center
+	double center = c[0].weight / 2;
+	if(target < center) {
+		return td->min + (c[0].mean - td->min) * (target / center);
+	}
+
+	// interpolate between neighbouring centroid centers
+	double cumulative = 0;
+	for(uint32_t i = 0; i < n - 1; i++) {
+		double left = cumulative + c[i].weight / 2;
+		double right = cumulative + c[i].weight + c[i + 1].weight / 2;
+		if(target <= right) {
+			double t = (target - left) / (right - left);
+			return c[i].mean + (c[i + 1].mean - c[i].mean) * t;
+		}
+		cumulative += c[i].weight;
+	}
+
+	// interpolate between the last centroid's center and maximum
+	double last_center = td->weight - c[n - 1].weight / 2;
+	double tail = td->weight - last_center;
+	if(tail <= 0) return td->max;
+	double t = (target - last_center) / tail;
+	return c[n - 1].mean + (td->max - c[n - 1].mean) * t;
+}
+
+uint64_t TDigest_Count(const TDigest *td) {
+	ASSERT(td != NULL);
+	return (uint64_t)td->weight;
+}
+
+void TDigest_Free(TDigest *td) {
+	if(td == NULL) return;
+	rm_free(td->centroids);
+	rm_free(td);
+}
+
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// t-digest compression, bounds the number of centroids
+// larger values trade memory for accuracy
+#define TDIGEST_COMPRESSION 100
+
+// maximal number of compressed centroids
+#define TDIGEST_CENTROID_CAP (2 * TDIGEST_COMPRESSION)
+
+// number of buffered points which trigger compression
+#define TDIGEST_BUFFER_CAP (5 * TDIGEST_COMPRESSION)
+
+typedef struct {
+	double mean;    // mean of summarized points
+	double weight;  // number of summarized points
+} TDigestCentroid;
+
+// merging t-digest quantile estimator
+//
+// points are buffered and periodically merged with the compressed
+// centroids, a centroid's weight is limited by the k1 scale function
+// such that centroids close to the distribution's tails stay small
+// and extreme quantiles remain accurate
+//
+// centroids and buffered points share a single, fixed size allocation
+typedef struct {
+	TDigestCentroid *centroids;  // compressed centroids followed by buffered points
+	uint32_t centroid_count;     // number of compressed centroids
+	uint32_t buffer_count;       // number of buffered points
+	double weight;               // total weight
+	double min;                  // smallest added value
+	double max;                  // largest added value
+} TDigest;
+
+// create a new, empty digest
+TDigest *TDigest_New(void);
+
+// add a value to the digest
+void TDigest_Add
+(
+	TDigest *td,  // digest
+	double v      // added value
+);
+
+// merge src into dst
+void TDigest_Merge
+(
+	TDigest *dst,       // merged into digest
+	const TDigest *src  // merged digest
+);
+
+// estimate quantile q within [0, 1] of the added values
+// returns NAN if digest is empty
+double TDigest_Quantile
+(
+	TDigest *td,  // digest
+	double q      // quantile
+);
+
+// returns number of added values
+uint64_t TDigest_Count
+(
+	const TDigest *td  // digest
+);
+
+// free digest
+void TDigest_Free
+(
+	TDigest *td  // digest
+);
+
@@ -0,0 +1,78 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "string_pool.h"
+#include "RG.h"
+#include "../rmalloc.h"
+#include <stddef.h>
+#include <string.h>
+
+static inline InternedString *_StringPool_Header(char *s) {
+	return (InternedString *)(s - offsetof(InternedString, str));
+}
+
+StringPool *StringPool_New(void) {
+	StringPool *pool = rm_malloc(sizeof(StringPool));
+	pool->strings = raxNew();
+	pool->bytes = 0;
+	return pool;
+}
+
+char *StringPool_Intern(StringPool *pool, const char *s) {
+	ASSERT(pool != NULL && s != NULL);
+
+	size_t len = strlen(s);
+	InternedString *entry = raxFind(pool->strings, (unsigned char *)s, len);
+	if(entry != raxNotFound) {
+		entry->refcount++;
+		return entry->str;
+	}
+
+	entry = rm_malloc(sizeof(InternedString) + len + 1);
+	entry->pool = pool;
+	entry->refcount = 1;
+	entry->len = len;
+	memcpy(entry->str, s, len + 1);
+	raxInsert(pool->strings, (unsigned char *)entry->str, len, entry, NULL);
+	pool->bytes += sizeof(InternedString) + len + 1;
+
+	return entry->str;
+}
+
+char *StringPool_Retain(char *s) {
+	ASSERT(s != NULL);
+	_StringPool_Header(s)->refcount++;
+	return s;
+}
+
+void StringPool_Release(char *s) {
+	ASSERT(s != NULL);
+
+	InternedString *entry = _StringPool_Header(s);
+	ASSERT(entry->refcount > 0);
+	if(--entry->refcount > 0) return;
+
+	raxRemove(entry->pool->strings, (unsigned char *)entry->str, entry->len, NULL);
+	entry->pool->bytes -= sizeof(InternedString) + entry->len + 1;
+	rm_free(entry);
+}
+
+uint64_t StringPool_Count(const StringPool *pool) {
+	ASSERT(pool != NULL);
+	return raxSize(pool->strings);
+}
+
+uint64_t StringPool_MemoryUsage(const StringPool *pool) {
+	ASSERT(pool != NULL);
+	return sizeof(StringPool) + pool->bytes;
+}
+
+void StringPool_Free(StringPool *pool) {
+	ASSERT(pool != NULL);
+	// strings still referenced are freed along with the pool
+	raxFreeWithCallback(pool->strings, rm_free);
+	rm_free(pool);
+}
@@ -0,0 +1,52 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include "rax.h"
+#include <stdint.h>
+
+typedef struct StringPool StringPool;
+
+/* An interned string, the string's bytes follow its header
+ * such that an interned string is handed out as a plain char pointer. */
+typedef struct {
+	StringPool *pool;   // Pool holding the string.
+	uint32_t refcount;  // Number of references to the string.
+	uint32_t len;       // Length of the string, excluding the NULL terminator.
+	char str[];         // String bytes.
+} InternedString;
+
+/* The StringPool holds a single copy of each distinct string interned
+ * into it, shared by every reference to that string, such that repeated
+ * values are stored once and equal strings share a pointer.
+ * Strings are refcounted, a string is freed once its last reference is
+ * released. Not thread-safe. */
+struct StringPool {
+	rax *strings;    // Map of string bytes to InternedString.
+	uint64_t bytes;  // Bytes allocated by interned strings.
+};
+
+// Create a new StringPool.
+StringPool *StringPool_New(void);
+
+// Returns a reference to the interned copy of s.
+char *StringPool_Intern(StringPool *pool, const char *s);
+
+// Adds a reference to an interned string.
+char *StringPool_Retain(char *s);
+
+// Releases a reference to an interned string.
+void StringPool_Release(char *s);
+
+// Returns the number of distinct strings held by the pool.
+uint64_t StringPool_Count(const StringPool *pool);
+
+// Returns the number of bytes held by the pool, excluding its lookup table.
+uint64_t StringPool_MemoryUsage(const StringPool *pool);
+
+// Free pool, all references must have been released.
+void StringPool_Free(StringPool *pool);
@@ -7,7 +7,13 @@
 #include "RG.h"
 #include "pools.h"
 #include "../../config.h"
+#include "xxhash.h"
+#include "../numa.h"
+#include "../cron.h"
+#include "../rmalloc.h"
+#include "../../../deps/GraphBLAS/Include/GraphBLAS.h"
 #include <pthread.h>
+#include <sys/param.h>
 
 //------------------------------------------------------------------------------
 // Thread pools
@@ -15,28 +21,101 @@
 
 static threadpool _bulk_thpool = NULL;     // bulk loader workers
 static threadpool _readers_thpool = NULL;  // readers
-static threadpool _writers_thpool = NULL;  // writers
+static threadpool *_writers_thpools = NULL;  // writer lanes, one thread each
+static uint _writers_count = 0;              // number of writer lanes
+static uint _omp_budget = 1;                 // cores shared by OpenMP threads
+static uint _omp_holders = 0;                // threads holding an allotment
+static uint _readers_count = 0;              // number of threads readers are sized to
+static pthread_mutex_t _resize_lock = PTHREAD_MUTEX_INITIALIZER;  // serializes resizes
+
+//------------------------------------------------------------------------------
+// Readers autoscaler
+//------------------------------------------------------------------------------
+
+// milliseconds between autoscaler runs
+#define AUTOSCALE_INTERVAL 100
+// average time, in microseconds, read tasks spend queued above which
+// a reader is added
+#define AUTOSCALE_WAIT_THRESHOLD 2000
+// number of consecutive runs finding an idle reader after which
+// a reader is removed
+#define AUTOSCALE_IDLE_RUNS 10
+
+static uint64_t _autoscale_wait = 0;   // queue wait observed by the last run
+static uint64_t _autoscale_jobs = 0;   // tasks pulled observed by the last run
+static uint _autoscale_idle_runs = 0;  // consecutive runs finding an idle reader
+
+// returns the NUMA node writer lane is placed on
+static inline uint _ThreadPools_WriterNode(uint lane) {
+	return lane % NUMA_NodeCount();
+}
+
+// pin readers to NUMA nodes, readers are spread evenly across nodes
+static void _ThreadPools_PinReaders(void) {
+	uint node_count = NUMA_NodeCount();
+
+	for(uint i = 0; i < _readers_count; i++) {
+		pthread_t reader = thpool_get_thread(_readers_thpool, i);
+		NUMA_PinThread(reader, i % node_count);
+	}
+}
+
+// pin threads to NUMA nodes, see THREAD_AFFINITY
+// writer lanes are assigned nodes round-robin, a graph's matrices and
+// DataBlocks are allocated by its writer, on its lane's node
+static void _ThreadPools_PinThreads(void) {
+	_ThreadPools_PinReaders();
+
+	for(uint i = 0; i < _writers_count; i++) {
+		pthread_t writer = thpool_get_thread(_writers_thpools[i], 0);
+		NUMA_PinThread(writer, _ThreadPools_WriterNode(i));
+	}
+}
 
 // set up thread pools  (readers and writers)
 // returns 1 if thread pools initialized, 0 otherwise
 int ThreadPools_CreatePools
 (
 	uint reader_count,
+	uint max_reader_count,
 	uint writer_count,
 	uint bulk_count
 ) {
+	ASSERT(writer_count > 0);
 	ASSERT(_readers_thpool == NULL);
-	ASSERT(_writers_thpool == NULL);
+	ASSERT(_writers_thpools == NULL);
 
-	_readers_thpool = thpool_init(reader_count, "reader");
-	if(_readers_thpool == NULL) return 0;
+	bool thread_affinity;
+	bool numa_interleave;
+	Config_Option_get(Config_THREAD_AFFINITY, &thread_affinity);
+	Config_Option_get(Config_NUMA_INTERLEAVE, &numa_interleave);
+
+	// threads inherit the memory policy of their creator
+	if(numa_interleave) NUMA_InterleaveMemory(true);
 
-	_writers_thpool = thpool_init(writer_count, "writer");
-	if(_writers_thpool == NULL) return 0;
+	// readers may be resized at runtime, up to max_reader_count
+	ASSERT(max_reader_count >= reader_count);
+	_readers_thpool = thpool_init_resizable(reader_count, max_reader_count, "reader");
+	if(_readers_thpool == NULL) return 0;
+	_readers_count = reader_count;
+
+	// each writer lane is served by a single thread, executing the writes
+	// of the graphs mapped to it in order
+	_writers_thpools = rm_calloc(writer_count, sizeof(threadpool));
+	for(uint i = 0; i < writer_count; i++) {
+		_writers_thpools[i] = thpool_init(1, "writer");
+		if(_writers_thpools[i] == NULL) return 0;
+		_writers_count++;
+	}
 
 	_bulk_thpool = thpool_init(bulk_count, "bulk_loader");
 	if(_bulk_thpool == NULL) return 0;
 
+	// restore Redis main thread's policy
+	if(numa_interleave) NUMA_InterleaveMemory(false);
+
+	if(thread_affinity) _ThreadPools_PinThreads();
+
 	return 1;
 }
 
@@ -46,11 +125,14 @@ uint ThreadPools_ThreadCount
 	void
 ) {
 	ASSERT(_readers_thpool != NULL);
-	ASSERT(_writers_thpool != NULL);
+	ASSERT(_writers_thpools != NULL);
 
+	// thread ids are reserved for readers the pool may grow to
 	uint count = 0;
-	count += thpool_num_threads(_readers_thpool);
-	count += thpool_num_threads(_writers_thpool);
+	count += thpool_max_threads(_readers_thpool);
+	for(uint i = 0; i < _writers_count; i++) {
+		count += thpool_num_threads(_writers_thpools[i]);
+	}
 
 	return count;
 }
@@ -64,18 +146,20 @@ int ThreadPools_GetThreadID
 	void
 ) {
 	ASSERT(_readers_thpool != NULL);
-	ASSERT(_writers_thpool != NULL);
+	ASSERT(_writers_thpools != NULL);
 
 	// thpool_get_thread_id returns -1 if pthread_self isn't in the thread pool
 	// most likely Redis main thread
 	int thread_id;
 	pthread_t pthread = pthread_self();
-	int readers_count = thpool_num_threads(_readers_thpool);
+	int readers_count = thpool_max_threads(_readers_thpool);
 
-	// search in writers
-	thread_id = thpool_get_thread_id(_writers_thpool, pthread);
-	// compensate for Redis main thread
-	if(thread_id != -1) return readers_count + thread_id + 1;
+	// search in writers, lanes are served by a single thread
+	for(uint i = 0; i < _writers_count; i++) {
+		thread_id = thpool_get_thread_id(_writers_thpools[i], pthread);
+		// compensate for Redis main thread
+		if(thread_id != -1) return readers_count + i + 1;
+	}
 
 	// search in readers pool
 	thread_id = thpool_get_thread_id(_readers_thpool, pthread);
@@ -92,11 +176,11 @@ void ThreadPools_Pause
 ) {
 	ASSERT(_bulk_thpool != NULL);
 	ASSERT(_readers_thpool != NULL);
-	ASSERT(_writers_thpool != NULL);
+	ASSERT(_writers_thpools != NULL);
 
 	thpool_pause(_bulk_thpool);
 	thpool_pause(_readers_thpool);
-	thpool_pause(_writers_thpool);
+	for(uint i = 0; i < _writers_count; i++) thpool_pause(_writers_thpools[i]);
 }
 
 void ThreadPools_Resume
@@ -106,11 +190,11 @@ void ThreadPools_Resume
 
 	ASSERT(_bulk_thpool != NULL);
 	ASSERT(_readers_thpool != NULL);
-	ASSERT(_writers_thpool != NULL);
+	ASSERT(_writers_thpools != NULL);
 
 	thpool_resume(_bulk_thpool);
 	thpool_resume(_readers_thpool);
-	thpool_resume(_writers_thpool);
+	for(uint i = 0; i < _writers_count; i++) thpool_resume(_writers_thpools[i]);
 }
 
 // return true if thread pool internal queue is full with pending work
@@ -143,18 +227,182 @@ int ThreadPools_AddWorkReader
 	return thpool_add_work(_readers_thpool, function_p, arg_p);
 }
 
-// add task for writer thread
-int ThreadPools_AddWorkWriter
+// add low priority task for reader thread
+int ThreadPools_DeferWorkReader
 (
 	void (*function_p)(void *),
 	void *arg_p
 ) {
-	ASSERT(_writers_thpool != NULL);
+	ASSERT(_readers_thpool != NULL);
+
+	// deferred tasks had already been admitted, don't enforce queue capacity
+	return thpool_add_low_priority_work(_readers_thpool, function_p, arg_p);
+}
+
+// return number of read tasks waiting for a reader thread
+uint ThreadPools_ReadersQueueSize
+(
+	void
+) {
+	ASSERT(_readers_thpool != NULL);
+
+	return thpool_queue_size(_readers_thpool);
+}
+
+// return number of read tasks waiting for a reader thread,
+// excluding deferred tasks
+uint ThreadPools_ReadersPriorityQueueSize
+(
+	void
+) {
+	ASSERT(_readers_thpool != NULL);
+
+	return thpool_priority_queue_size(_readers_thpool);
+}
+
+bool ThreadPools_SetReaderCount
+(
+	uint reader_count
+) {
+	ASSERT(_readers_thpool != NULL);
+
+	if(reader_count == 0) return false;
+	if(reader_count > thpool_max_threads(_readers_thpool)) return false;
+
+	bool thread_affinity;
+	bool numa_interleave;
+	Config_Option_get(Config_THREAD_AFFINITY, &thread_affinity);
+	Config_Option_get(Config_NUMA_INTERLEAVE, &numa_interleave);
+
+	pthread_mutex_lock(&_resize_lock);
+
+	if(reader_count != _readers_count) {
+		// started readers inherit the memory policy of their creator
+		if(numa_interleave) NUMA_InterleaveMemory(true);
+		thpool_resize(_readers_thpool, reader_count);
+		if(numa_interleave) NUMA_InterleaveMemory(false);
+
+		__atomic_store_n(&_readers_count, reader_count, __ATOMIC_RELAXED);
+		if(thread_affinity) _ThreadPools_PinReaders();
+	}
+
+	pthread_mutex_unlock(&_resize_lock);
+
+	return true;
+}
+
+uint ThreadPools_ReaderCount
+(
+	void
+) {
+	return __atomic_load_n(&_readers_count, __ATOMIC_RELAXED);
+}
+
+bool ThreadPools_LowLoad
+(
+	void
+) {
+	ASSERT(_readers_thpool != NULL);
+	ASSERT(_writers_thpools != NULL);
+
+	if(thpool_queue_size(_readers_thpool) > 0) return false;
+	uint busy = thpool_num_threads_working(_readers_thpool);
+	if(busy > ThreadPools_ReaderCount() / 4) return false;
+
+	for(uint i = 0; i < _writers_count; i++) {
+		threadpool thpool = _writers_thpools[i];
+		if(thpool_queue_size(thpool) > 0) return false;
+		if(thpool_num_threads_working(thpool) > 0) return false;
+	}
+
+	return true;
+}
+
+// returns the number of readers the pool should be sized to
+static uint _ThreadPools_AutoscaleTarget(void) {
+	uint min_count;
+	uint max_count = thpool_max_threads(_readers_thpool);
+	Config_Option_get(Config_MIN_THREAD_COUNT, &min_count);
+	min_count = MIN(min_count, max_count);
+
+	uint readers = ThreadPools_ReaderCount();
+	uint target = readers;
+
+	// average time tasks pulled since the last run spent queued
+	uint64_t jobs;
+	uint64_t wait = thpool_queue_wait(_readers_thpool, &jobs);
+	uint64_t pulled = jobs - _autoscale_jobs;
+	uint64_t waited = wait - _autoscale_wait;
+	_autoscale_jobs = jobs;
+	_autoscale_wait = wait;
+
+	bool backlog = thpool_queue_size(_readers_thpool) > 0;
+	bool waiting = (pulled > 0) ?
+		(waited / pulled > AUTOSCALE_WAIT_THRESHOLD) :
+		backlog;  // no task was pulled while tasks are queued
+
+	if(waiting) {
+		_autoscale_idle_runs = 0;
+		target = readers + 1;
+	} else if(!backlog &&
+			thpool_num_threads_working(_readers_thpool) < (int)readers) {
+		// remove a reader once readers had been idle for a while
+		if(++_autoscale_idle_runs >= AUTOSCALE_IDLE_RUNS) {
+			_autoscale_idle_runs = 0;
+			target = readers - 1;
+		}
+	} else {
+		_autoscale_idle_runs = 0;
+	}
+
+	return MAX(min_count, MIN(target, max_count));
+}
+
+// CRON task, resizes readers by their queue's wait time
+// with autoscaling disabled readers are restored to THREAD_COUNT
+static void _ThreadPools_Autoscale(void *pdata) {
+	bool autoscale;
+	uint target;
+	Config_Option_get(Config_THREAD_AUTOSCALE, &autoscale);
+
+	if(autoscale) {
+		target = _ThreadPools_AutoscaleTarget();
+	} else {
+		_autoscale_idle_runs = 0;
+		Config_Option_get(Config_THREAD_POOL_SIZE, &target);
+	}
+
+	if(target != ThreadPools_ReaderCount()) ThreadPools_SetReaderCount(target);
+
+	Cron_AddTask(AUTOSCALE_INTERVAL, _ThreadPools_Autoscale, NULL);
+}
+
+void ThreadPools_StartAutoscaler
+(
+	void
+) {
+	ASSERT(_readers_thpool != NULL);
+
+	Cron_AddTask(AUTOSCALE_INTERVAL, _ThreadPools_Autoscale, NULL);
+}
+
+// add task for writer thread, tasks sharing a lane key execute in order
+int ThreadPools_AddWorkWriter
+(
+	void (*function_p)(void *),
+	void *arg_p,
+	const char *lane_key
+) {
+	ASSERT(lane_key != NULL);
+	ASSERT(_writers_thpools != NULL);
+
+	uint lane = XXH32(lane_key, strlen(lane_key), 0) % _writers_count;
+	threadpool thpool = _writers_thpools[lane];
 
 	// make sure there's enough room in thread pool queue
-	if(_queue_full(_writers_thpool)) return THPOOL_QUEUE_FULL;
+	if(_queue_full(thpool)) return THPOOL_QUEUE_FULL;
 
-	return thpool_add_work(_writers_thpool, function_p, arg_p);
+	return thpool_add_work(thpool, function_p, arg_p);
 }
 
 // add task for bulk loader thread
@@ -168,3 +416,31 @@ int ThreadPools_AddWorkBulkLoader
 	return thpool_add_work(_bulk_thpool, function_p, arg_p);
 }
 
+void ThreadPools_SetOpenMPBudget
+(
+	uint budget
+) {
+	ASSERT(budget > 0);
+	_omp_budget = budget;
+}
+
+uint ThreadPools_AcquireOpenMPThreads
+(
+	void
+) {
+	// the calling thread is counted as one of its OpenMP threads
+	uint holders = __atomic_add_fetch(&_omp_holders, 1, __ATOMIC_RELAXED);
+	uint allotment = MAX(1, _omp_budget / holders);
+	GxB_set(GxB_THREAD_NTHREADS, (int)allotment);
+	return allotment;
+}
+
+void ThreadPools_ReleaseOpenMPThreads
+(
+	void
+) {
+	ASSERT(_omp_holders > 0);
+	__atomic_sub_fetch(&_omp_holders, 1, __ATOMIC_RELAXED);
+	// fall back to the global OpenMP thread count
+	GxB_set(GxB_THREAD_NTHREADS, 0);
+}
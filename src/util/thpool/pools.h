@@ -10,14 +10,18 @@
 
 #define THPOOL_QUEUE_FULL -2
 // create both readers and writers thread pools
+// writers are split into writer_count single threaded lanes
+// readers can later be resized up to max_reader_count threads
 int ThreadPools_CreatePools
 (
 	uint reader_count,
+	uint max_reader_count,
 	uint writer_count,
 	uint bulk_count
 );
 
 // return number of threads in both the readers and writers pools
+// readers are counted by the size they may grow to
 uint ThreadPools_ThreadCount
 (
 	void
@@ -51,13 +55,63 @@ int ThreadPools_AddWorkReader
 	void *arg_p
 );
 
-// add a write task
-int ThreadPools_AddWorkWriter
+// adds a low priority read task, executed once pending read tasks
+// had been picked up
+int ThreadPools_DeferWorkReader
 (
 	void (*function_p)(void *),
 	void *arg_p
 );
 
+// return number of read tasks waiting for a reader thread
+uint ThreadPools_ReadersQueueSize
+(
+	void
+);
+
+// return number of read tasks waiting for a reader thread,
+// excluding deferred tasks
+uint ThreadPools_ReadersPriorityQueueSize
+(
+	void
+);
+
+// resize the readers pool
+// returns false if reader_count is out of the pool's bounds
+bool ThreadPools_SetReaderCount
+(
+	uint reader_count  // number of reader threads
+);
+
+// return number of threads the readers pool is sized to
+uint ThreadPools_ReaderCount
+(
+	void
+);
+
+// returns true if readers and writers are mostly idle
+// no write is pending and at most a quarter of the readers are busy
+bool ThreadPools_LowLoad
+(
+	void
+);
+
+// start the readers pool autoscaler, see THREAD_AUTOSCALE
+// expects CRON to be running
+void ThreadPools_StartAutoscaler
+(
+	void
+);
+
+// add a write task to the lane lane_key maps to
+// tasks sharing a lane key are executed in order, by the same thread
+int ThreadPools_AddWorkWriter
+(
+	void (*function_p)(void *),
+	void *arg_p,
+	const char *lane_key
+);
+
 // add a bulk laoder task
 int ThreadPools_AddWorkBulkLoader
 (
@@ -65,3 +119,23 @@ int ThreadPools_AddWorkBulkLoader
 	void *arg_p
 );
 
+// set the number of cores shared by executing queries and their OpenMP threads
+void ThreadPools_SetOpenMPBudget
+(
+	uint budget
+);
+
+// allots the calling thread an even share of the OpenMP budget among
+// executing queries, GraphBLAS calls made by the thread are limited to it
+// returns the number of OpenMP threads allotted
+uint ThreadPools_AcquireOpenMPThreads
+(
+	void
+);
+
+// returns the calling thread's allotment to the OpenMP budget
+void ThreadPools_ReleaseOpenMPThreads
+(
+	void
+);
+
@@ -15,8 +15,10 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <errno.h>
+#include <sched.h>
 #include <time.h>
 #include <assert.h>
+#include <stdint.h>
 #if defined(__linux__)
 #include <sys/prctl.h>
 #endif
@@ -35,57 +37,98 @@
 #define err(str)
 #endif
 
+/* Number of jobs pulled ahead of a pending low priority job */
+#define THPOOL_LOW_PRIORITY_INTERVAL 8
+
+/* Initial number of slots in a thread's deque, must be a power of 2 */
+#define THPOOL_DEQUE_CAPACITY 64
+
+/* Microseconds between checks of thpool_wait */
+#define THPOOL_WAIT_POLL 1000
+
 static volatile int threads_keepalive;
 static volatile int threads_on_hold;
 
 /* ========================== STRUCTURES ============================ */
 
-/* Binary semaphore */
-typedef struct bsem {
-	pthread_mutex_t mutex;
-	pthread_cond_t cond;
-	int v;
-} bsem;
-
 /* Job */
 typedef struct job {
-	struct job *prev;            /* pointer to previous job   */
+	struct job *next;            /* next job in queue         */
 	void (*function)(void *arg); /* function pointer          */
 	void *arg;                   /* function's argument       */
+	uint64_t enqueued;           /* time job was queued, in microseconds */
 } job;
 
-/* Job queue */
+/* Job queue
+ * multi-producer queue, jobs are submitted without taking a lock
+ * consumers pull one job at a time under pull_lock, a thread failing
+ * to acquire it moves on to other sources of work */
 typedef struct jobqueue {
-	pthread_mutex_t rwmutex; /* used for queue r/w access */
-	job *front;              /* pointer to front of queue */
-	job *rear;               /* pointer to rear  of queue */
-	bsem *has_jobs;          /* flag as binary semaphore  */
-	int len;                 /* number of jobs in queue   */
+	job *head;                   /* most recently submitted job */
+	job *tail;                   /* next job to pull            */
+	job stub;                    /* keeps the queue non-empty   */
+	pthread_mutex_t pull_lock;   /* serializes consumers        */
+	int len;                     /* number of jobs in queue     */
 } jobqueue;
 
+/* Circular array backing a job deque */
+typedef struct jobarray {
+	long capacity;               /* number of slots, a power of 2     */
+	struct jobarray *prev;       /* retired array replaced by this one */
+	job *jobs[];                 /* slots                             */
+} jobarray;
+
+/* Job deque
+ * Chase-Lev work stealing deque, its owning thread pushes and takes jobs
+ * at the bottom, other threads of the pool steal jobs from the top */
+typedef struct jobdeque {
+	long top;                    /* next job to steal  */
+	long bottom;                 /* next free slot     */
+	jobarray *array;             /* current array      */
+} jobdeque;
+
 /* Thread */
 typedef struct thread {
 	int id;                   /* friendly id               */
 	pthread_t pthread;        /* pointer to actual thread  */
 	struct thpool_ *thpool_p; /* access to thpool          */
+	jobdeque deque;           /* jobs spawned by thread    */
+	int running;              /* pthread serves the thread, guarded by thcount_lock */
 } thread;
 
 /* Threadpool */
 typedef struct thpool_ {
 	thread **threads;                 /* pointer to threads        */
 	const char *name;                 /* name associated with pool */
+	int max_threads;                  /* number of thread slots    */
+	int target_threads;               /* threads meant to be running */
 	volatile int num_threads_alive;   /* threads currently alive   */
 	volatile int num_threads_working; /* threads currently working */
+	int num_threads_idle;             /* threads waiting for jobs  */
+	int num_jobs;                     /* jobs pending in all queues and deques */
+	int skipped_low;                  /* jobs pulled ahead of a low priority job */
+	uint64_t queue_wait;              /* time pulled jobs spent queued, in microseconds */
+	uint64_t queue_pulled;            /* number of jobs pulled from job queue */
 	pthread_mutex_t thcount_lock;     /* used for thread count etc */
-	pthread_cond_t threads_all_idle;  /* signal to thpool_wait     */
+	pthread_mutex_t idle_lock;        /* guards idle threads       */
+	pthread_cond_t has_jobs;          /* signal to idle threads    */
 	jobqueue jobqueue;                /* job queue                 */
+	jobqueue low_jobqueue;            /* low priority job queue    */
 } thpool_;
 
+/* Thread of the pool running on the calling thread, NULL otherwise */
+static __thread thread *current_thread = NULL;
+
 /* ========================== PROTOTYPES ============================ */
 
 static int thread_init(thpool_* thpool_p, struct thread **thread_p, int id);
+static void thread_start(struct thread *thread_p);
+static int thread_retire(struct thread *thread_p);
 static void *thread_do(struct thread *thread_p);
 static void thread_hold(int sig_id);
+static void thread_idle(struct thread *thread_p);
+static struct job *thread_next_job(struct thread *thread_p);
+static struct job *thread_steal(struct thread *thread_p);
 static void thread_destroy(struct thread *thread_p);
 
 static int jobqueue_init(jobqueue *jobqueue_p);
@@ -94,16 +137,30 @@ static void jobqueue_push(jobqueue *jobqueue_p, struct job *newjob_p);
 static struct job *jobqueue_pull(jobqueue *jobqueue_p);
 static void jobqueue_destroy(jobqueue *jobqueue_p);
 
-static void bsem_init(struct bsem *bsem_p, int value);
-static void bsem_reset(struct bsem *bsem_p);
-static void bsem_post(struct bsem *bsem_p);
-static void bsem_post_all(struct bsem *bsem_p);
-static void bsem_wait(struct bsem *bsem_p);
+static int jobdeque_init(jobdeque *jobdeque_p);
+static int jobdeque_push(jobdeque *jobdeque_p, struct job *newjob_p);
+static struct job *jobdeque_take(jobdeque *jobdeque_p);
+static struct job *jobdeque_steal(jobdeque *jobdeque_p);
+static void jobdeque_destroy(jobdeque *jobdeque_p);
+
+static void thpool_notify(thpool_* thpool_p);
 
 /* ========================== THREADPOOL ============================ */
 
+/* Current time, in microseconds */
+static uint64_t thpool_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 /* Initialise thread pool */
 struct thpool_ *thpool_init(int num_threads, const char *name) {
+	return thpool_init_resizable(num_threads, num_threads, name);
+}
+
+/* Initialise resizable thread pool */
+struct thpool_ *thpool_init_resizable(int num_threads, int max_threads, const char *name) {
 
 	threads_on_hold = 0;
 	threads_keepalive = 1;
@@ -111,6 +168,9 @@ struct thpool_ *thpool_init(int num_threads, const char *name) {
 	if(num_threads < 0) {
 		num_threads = 0;
 	}
+	if(max_threads < num_threads) {
+		max_threads = num_threads;
+	}
 
 	/* Make new thread pool */
 	thpool_* thpool_p;
@@ -125,35 +185,49 @@ struct thpool_ *thpool_init(int num_threads, const char *name) {
 	}
 
 	thpool_p->name = name;
+	thpool_p->max_threads = max_threads;
+	thpool_p->target_threads = num_threads;
 	thpool_p->num_threads_alive = 0;
 	thpool_p->num_threads_working = 0;
-
-	/* Initialise the job queue */
-	if(jobqueue_init(&thpool_p->jobqueue) == -1) {
+	thpool_p->num_threads_idle = 0;
+	thpool_p->num_jobs = 0;
+	thpool_p->skipped_low = 0;
+	thpool_p->queue_wait = 0;
+	thpool_p->queue_pulled = 0;
+
+	/* Initialise the job queues */
+	if(jobqueue_init(&thpool_p->jobqueue) == -1 ||
+	   jobqueue_init(&thpool_p->low_jobqueue) == -1) {
 		err("thpool_init(): Could not allocate memory for job queue\n");
 		free(thpool_p);
 		return NULL;
 	}
 
 	/* Make threads in pool */
-	thpool_p->threads = (struct thread **)malloc(num_threads * sizeof(struct thread *));
+	thpool_p->threads = (struct thread **)malloc(max_threads * sizeof(struct thread *));
 	if(thpool_p->threads == NULL) {
 		err("thpool_init(): Could not allocate memory for threads\n");
 		jobqueue_destroy(&thpool_p->jobqueue);
+		jobqueue_destroy(&thpool_p->low_jobqueue);
 		free(thpool_p);
 		return NULL;
 	}
 
 	pthread_mutex_init(&(thpool_p->thcount_lock), NULL);
-	pthread_cond_init(&thpool_p->threads_all_idle, NULL);
+	pthread_mutex_init(&(thpool_p->idle_lock), NULL);
+	pthread_cond_init(&thpool_p->has_jobs, NULL);
 
-	/* Thread init */
+	/* Thread init, threads steal from one another
+	 * every slot's deque is set before any thread starts */
 	int n;
+	for(n = 0; n < max_threads; n++) {
+		if(thread_init(thpool_p, &thpool_p->threads[n], n) == -1) {
+			err("thpool_init(): Could not allocate memory for thread\n");
+			exit(1);
+		}
+	}
 	for(n = 0; n < num_threads; n++) {
-		thread_init(thpool_p, &thpool_p->threads[n], n);
-#if THPOOL_DEBUG
-		printf("THPOOL_DEBUG: Created thread %d in pool \n", n);
-#endif
+		thread_start(thpool_p->threads[n]);
 	}
 
 	/* Wait for threads to initialize */
@@ -163,33 +237,79 @@ struct thpool_ *thpool_init(int num_threads, const char *name) {
 	return thpool_p;
 }
 
-/* Add work to the thread pool */
-int thpool_add_work(thpool_* thpool_p, void (*function_p)(void *), void *arg_p) {
+static struct job *_thpool_new_job(void (*function_p)(void *), void *arg_p) {
 	job *newjob;
 
 	newjob = (struct job *)malloc(sizeof(struct job));
 	if(newjob == NULL) {
 		err("thpool_add_work(): Could not allocate memory for new job\n");
-		return -1;
+		return NULL;
 	}
 
 	/* add function and argument */
 	newjob->function = function_p;
 	newjob->arg = arg_p;
 
+	return newjob;
+}
+
+static int _thpool_add_work(thpool_* thpool_p, void (*function_p)(void *), void *arg_p,
+		int low_priority) {
+	job *newjob = _thpool_new_job(function_p, arg_p);
+	if(newjob == NULL) return -1;
+	if(!low_priority) newjob->enqueued = thpool_now();
+
+	/* count the job before it is reachable, a thread finding
+	 * pending jobs it can't reach yet retries rather than sleep */
+	__atomic_add_fetch(&thpool_p->num_jobs, 1, __ATOMIC_SEQ_CST);
+
 	/* add job to queue */
-	jobqueue_push(&thpool_p->jobqueue, newjob);
+	jobqueue_push((low_priority) ? &thpool_p->low_jobqueue : &thpool_p->jobqueue, newjob);
+	thpool_notify(thpool_p);
+
+	return 0;
+}
+
+/* Add work to the thread pool */
+int thpool_add_work(thpool_* thpool_p, void (*function_p)(void *), void *arg_p) {
+	return _thpool_add_work(thpool_p, function_p, arg_p, 0);
+}
+
+/* Add low priority work to the thread pool */
+int thpool_add_low_priority_work(thpool_* thpool_p, void (*function_p)(void *), void *arg_p) {
+	return _thpool_add_work(thpool_p, function_p, arg_p, 1);
+}
+
+/* Add work to the calling thread's deque */
+int thpool_add_local_work(thpool_* thpool_p, void (*function_p)(void *), void *arg_p) {
+	thread *thread_p = current_thread;
+
+	/* callers outside of the pool submit to its queue */
+	if(thread_p == NULL || thread_p->thpool_p != thpool_p) {
+		return _thpool_add_work(thpool_p, function_p, arg_p, 0);
+	}
+
+	job *newjob = _thpool_new_job(function_p, arg_p);
+	if(newjob == NULL) return -1;
+
+	__atomic_add_fetch(&thpool_p->num_jobs, 1, __ATOMIC_SEQ_CST);
+
+	/* fall back to the queue if the deque can't grow */
+	if(jobdeque_push(&thread_p->deque, newjob) == -1) {
+		newjob->enqueued = thpool_now();
+		jobqueue_push(&thpool_p->jobqueue, newjob);
+	}
+	thpool_notify(thpool_p);
 
 	return 0;
 }
 
 /* Wait until all jobs have finished */
 void thpool_wait(thpool_* thpool_p) {
-	pthread_mutex_lock(&thpool_p->thcount_lock);
-	while(thpool_p->jobqueue.len || thpool_p->num_threads_working) {
-		pthread_cond_wait(&thpool_p->threads_all_idle, &thpool_p->thcount_lock);
+	while(__atomic_load_n(&thpool_p->num_jobs, __ATOMIC_SEQ_CST) ||
+		  __atomic_load_n(&thpool_p->num_threads_working, __ATOMIC_SEQ_CST)) {
+		usleep(THPOOL_WAIT_POLL);
 	}
-	pthread_mutex_unlock(&thpool_p->thcount_lock);
 }
 
 /* Destroy the threadpool */
@@ -197,7 +317,7 @@ void thpool_destroy(thpool_* thpool_p) {
 	/* No need to destory if it's NULL */
 	if(thpool_p == NULL) return;
 
-	volatile int threads_total = thpool_p->num_threads_alive;
+	volatile int threads_total = thpool_p->max_threads;
 
 	/* End each thread 's infinite loop */
 	threads_keepalive = 0;
@@ -208,7 +328,9 @@ void thpool_destroy(thpool_* thpool_p) {
 	double tpassed = 0.0;
 	time(&start);
 	while(tpassed < TIMEOUT && thpool_p->num_threads_alive) {
-		bsem_post_all(thpool_p->jobqueue.has_jobs);
+		pthread_mutex_lock(&thpool_p->idle_lock);
+		pthread_cond_broadcast(&thpool_p->has_jobs);
+		pthread_mutex_unlock(&thpool_p->idle_lock);
 		time(&end);
 		tpassed = difftime(end, start);
 	}
@@ -222,6 +344,7 @@ void thpool_destroy(thpool_* thpool_p) {
 
 	/* Job queue cleanup */
 	jobqueue_destroy(&thpool_p->jobqueue);
+	jobqueue_destroy(&thpool_p->low_jobqueue);
 	/* Deallocs */
 	int n;
 	for(n = 0; n < threads_total; n++) {
@@ -236,12 +359,36 @@ void thpool_pause(thpool_* thpool_p) {
 	int n;
 	pthread_t caller = pthread_self();
 
-	for(n = 0; n < thpool_p->num_threads_alive; n++) {
+	pthread_mutex_lock(&thpool_p->thcount_lock);
+	for(n = 0; n < thpool_p->max_threads; n++) {
+		thread *thread_p = thpool_p->threads[n];
 		// do not pause caller
-		if(thpool_p->threads[n]->pthread != caller) {
-			pthread_kill(thpool_p->threads[n]->pthread, SIGUSR2);
+		if(thread_p->running && thread_p->pthread != caller) {
+			pthread_kill(thread_p->pthread, SIGUSR2);
 		}
 	}
+	pthread_mutex_unlock(&thpool_p->thcount_lock);
+}
+
+/* Resize threadpool */
+void thpool_resize(thpool_* thpool_p, int num_threads) {
+	if(num_threads < 0) num_threads = 0;
+	if(num_threads > thpool_p->max_threads) num_threads = thpool_p->max_threads;
+
+	pthread_mutex_lock(&thpool_p->thcount_lock);
+	__atomic_store_n(&thpool_p->target_threads, num_threads, __ATOMIC_SEQ_CST);
+
+	/* threads which haven't retired yet keep on serving */
+	for(int n = 0; n < num_threads; n++) {
+		thread *thread_p = thpool_p->threads[n];
+		if(!thread_p->running) thread_start(thread_p);
+	}
+	pthread_mutex_unlock(&thpool_p->thcount_lock);
+
+	/* wake idle threads, those beyond the new size retire */
+	pthread_mutex_lock(&thpool_p->idle_lock);
+	pthread_cond_broadcast(&thpool_p->has_jobs);
+	pthread_mutex_unlock(&thpool_p->idle_lock);
 }
 
 /* Resume all threads in threadpool */
@@ -262,18 +409,54 @@ int thpool_num_threads(thpool_* thpool_p) {
 	return thpool_p->num_threads_alive;
 }
 
+int thpool_max_threads(thpool_* thpool_p) {
+	return thpool_p->max_threads;
+}
+
 int thpool_get_thread_id(thpool_* thpool_p, pthread_t pthread) {
-	for(int i = 0; i < thpool_p->num_threads_alive; i++) {
+	// the calling thread knows whether it belongs to the pool
+	if(pthread_equal(pthread, pthread_self())) {
+		thread *thread_p = current_thread;
+		if(thread_p != NULL && thread_p->thpool_p == thpool_p) return thread_p->id;
+		return -1;
+	}
+
+	for(int i = 0; i < thpool_p->max_threads; i++) {
 		thread *thread = thpool_p->threads[i];
-		if(thread->pthread == pthread) return thread->id;
+		if(thread->running && thread->pthread == pthread) return thread->id;
 	}
 
 	// Could not locate thread.
 	return -1;
 }
 
+pthread_t thpool_get_thread(thpool_* thpool_p, int n) {
+	assert(n >= 0 && n < thpool_p->max_threads);
+	return thpool_p->threads[n]->pthread;
+}
+
 uint thpool_queue_size(thpool_* thpool_p) {
-	return thpool_p->jobqueue.len;
+	return __atomic_load_n(&thpool_p->jobqueue.len, __ATOMIC_RELAXED) +
+		   __atomic_load_n(&thpool_p->low_jobqueue.len, __ATOMIC_RELAXED);
+}
+
+uint thpool_priority_queue_size(thpool_* thpool_p) {
+	return __atomic_load_n(&thpool_p->jobqueue.len, __ATOMIC_RELAXED);
+}
+
+uint64_t thpool_queue_wait(thpool_* thpool_p, uint64_t *jobs) {
+	*jobs = __atomic_load_n(&thpool_p->queue_pulled, __ATOMIC_RELAXED);
+	return __atomic_load_n(&thpool_p->queue_wait, __ATOMIC_RELAXED);
+}
+
+/* Wake an idle thread, if there is one
+ * submitters only take idle_lock while threads are waiting for jobs */
+static void thpool_notify(thpool_* thpool_p) {
+	if(__atomic_load_n(&thpool_p->num_threads_idle, __ATOMIC_SEQ_CST) == 0) return;
+
+	pthread_mutex_lock(&thpool_p->idle_lock);
+	pthread_cond_signal(&thpool_p->has_jobs);
+	pthread_mutex_unlock(&thpool_p->idle_lock);
 }
 
 /* ============================ THREAD ============================== */
@@ -287,19 +470,60 @@ uint thpool_queue_size(thpool_* thpool_p) {
 static int thread_init(thpool_* thpool_p, struct thread **thread_p, int id) {
 
 	*thread_p = (struct thread *)malloc(sizeof(struct thread));
-	if(thread_p == NULL) {
+	if(*thread_p == NULL) {
 		err("thread_init(): Could not allocate memory for thread\n");
 		return -1;
 	}
 
 	(*thread_p)->thpool_p = thpool_p;
 	(*thread_p)->id = id;
+	(*thread_p)->running = 0;
+
+	if(jobdeque_init(&(*thread_p)->deque) == -1) {
+		err("thread_init(): Could not allocate memory for job deque\n");
+		free(*thread_p);
+		return -1;
+	}
 
-	pthread_create(&(*thread_p)->pthread, NULL, (void *)thread_do, (*thread_p));
-	pthread_detach((*thread_p)->pthread);
 	return 0;
 }
 
+/* Start a pthread serving thread
+ *
+ * Notice: Caller MUST hold thcount_lock, unless threads haven't started yet
+ */
+static void thread_start(thread *thread_p) {
+	thread_p->running = 1;
+	pthread_create(&thread_p->pthread, NULL, (void *)thread_do, thread_p);
+	pthread_detach(thread_p->pthread);
+#if THPOOL_DEBUG
+	printf("THPOOL_DEBUG: Created thread %d in pool \n", thread_p->id);
+#endif
+}
+
+/* Retire thread if it is beyond the pool's size
+ * threads retire once done with the jobs they had spawned
+ *
+ * @return 1 if thread retired, 0 otherwise
+ */
+static int thread_retire(thread *thread_p) {
+	thpool_* thpool_p = thread_p->thpool_p;
+	if(thread_p->id < __atomic_load_n(&thpool_p->target_threads, __ATOMIC_RELAXED)) return 0;
+	if(__atomic_load_n(&thread_p->deque.bottom, __ATOMIC_RELAXED) >
+	   __atomic_load_n(&thread_p->deque.top, __ATOMIC_RELAXED)) return 0;
+
+	int retired = 0;
+	pthread_mutex_lock(&thpool_p->thcount_lock);
+	if(thread_p->id >= thpool_p->target_threads) {
+		thread_p->running = 0;
+		thpool_p->num_threads_alive--;
+		retired = 1;
+	}
+	pthread_mutex_unlock(&thpool_p->thcount_lock);
+
+	return retired;
+}
+
 /* Sets the calling thread on hold */
 static void thread_hold(int sig_id) {
 	(void)sig_id;
@@ -309,6 +533,84 @@ static void thread_hold(int sig_id) {
 	}
 }
 
+/* Waits until jobs are pending, or the pool is destroyed */
+static void thread_idle(thread *thread_p) {
+	thpool_* thpool_p = thread_p->thpool_p;
+	pthread_mutex_lock(&thpool_p->idle_lock);
+
+	/* announce the wait before checking for jobs, a submitter
+	 * either sees this thread idle or this thread sees its job */
+	__atomic_add_fetch(&thpool_p->num_threads_idle, 1, __ATOMIC_SEQ_CST);
+	while(threads_keepalive &&
+		  thread_p->id < __atomic_load_n(&thpool_p->target_threads, __ATOMIC_SEQ_CST) &&
+		  __atomic_load_n(&thpool_p->num_jobs, __ATOMIC_SEQ_CST) == 0) {
+		pthread_cond_wait(&thpool_p->has_jobs, &thpool_p->idle_lock);
+	}
+	__atomic_sub_fetch(&thpool_p->num_threads_idle, 1, __ATOMIC_SEQ_CST);
+
+	pthread_mutex_unlock(&thpool_p->idle_lock);
+}
+
+/* Find the next job for thread to execute
+ *
+ * jobs are looked for in order:
+ * a low priority job skipped for too long,
+ * the thread's own deque, most recently spawned job first,
+ * the pool's job queue,
+ * the other threads' deques,
+ * the pool's low priority job queue
+ *
+ * @param  thread_p      thread looking for a job
+ * @return job, NULL if none was found
+ */
+static struct job *thread_next_job(thread *thread_p) {
+	thpool_* thpool_p = thread_p->thpool_p;
+	job *job_p = NULL;
+	int low_pending = __atomic_load_n(&thpool_p->low_jobqueue.len, __ATOMIC_RELAXED) > 0;
+
+	if(low_pending &&
+	   __atomic_load_n(&thpool_p->skipped_low, __ATOMIC_RELAXED) >= THPOOL_LOW_PRIORITY_INTERVAL) {
+		job_p = jobqueue_pull(&thpool_p->low_jobqueue);
+	}
+
+	if(job_p == NULL) job_p = jobdeque_take(&thread_p->deque);
+
+	if(job_p == NULL) {
+		job_p = jobqueue_pull(&thpool_p->jobqueue);
+		if(job_p != NULL) {
+			uint64_t wait = thpool_now() - job_p->enqueued;
+			__atomic_add_fetch(&thpool_p->queue_wait, wait, __ATOMIC_RELAXED);
+			__atomic_add_fetch(&thpool_p->queue_pulled, 1, __ATOMIC_RELAXED);
+			if(low_pending) __atomic_add_fetch(&thpool_p->skipped_low, 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	if(job_p == NULL) job_p = thread_steal(thread_p);
+
+	if(job_p == NULL) {
+		job_p = jobqueue_pull(&thpool_p->low_jobqueue);
+		if(job_p != NULL) __atomic_store_n(&thpool_p->skipped_low, 0, __ATOMIC_RELAXED);
+	}
+
+	if(job_p != NULL) __atomic_sub_fetch(&thpool_p->num_jobs, 1, __ATOMIC_SEQ_CST);
+	return job_p;
+}
+
+/* Steal a job from another thread of the pool */
+static struct job *thread_steal(thread *thread_p) {
+	thpool_* thpool_p = thread_p->thpool_p;
+	int n = thpool_p->max_threads;
+
+	/* start with the thread's successor, spreading thieves across victims */
+	for(int i = 1; i < n; i++) {
+		thread *victim = thpool_p->threads[(thread_p->id + i) % n];
+		job *job_p = jobdeque_steal(&victim->deque);
+		if(job_p != NULL) return job_p;
+	}
+
+	return NULL;
+}
+
 /* What each thread is doing
 *
 * In principle this is an endless loop. The only time this loop gets interuppted is once
@@ -334,6 +636,7 @@ static void *thread_do(struct thread *thread_p) {
 
 	/* Assure all threads have been created before starting serving */
 	thpool_* thpool_p = thread_p->thpool_p;
+	current_thread = thread_p;
 
 	/* Register signal handler */
 	struct sigaction act;
@@ -351,34 +654,38 @@ static void *thread_do(struct thread *thread_p) {
 
 	while(threads_keepalive) {
 
-		bsem_wait(thpool_p->jobqueue.has_jobs);
+		if(thread_retire(thread_p)) {
+			current_thread = NULL;
+			return NULL;
+		}
 
-		if(threads_keepalive) {
+		/* counted as working while looking for a job, such that
+		 * thpool_wait never observes a pulled job neither pending nor running */
+		__atomic_add_fetch(&thpool_p->num_threads_working, 1, __ATOMIC_SEQ_CST);
 
-			pthread_mutex_lock(&thpool_p->thcount_lock);
-			thpool_p->num_threads_working++;
-			pthread_mutex_unlock(&thpool_p->thcount_lock);
+		/* Read job from queue and execute it */
+		job *job_p = thread_next_job(thread_p);
+		if(job_p) {
+			job_p->function(job_p->arg);
+			free(job_p);
+		}
 
-			/* Read job from queue and execute it */
-			void (*func_buff)(void *);
-			void *arg_buff;
-			job *job_p = jobqueue_pull(&thpool_p->jobqueue);
-			if(job_p) {
-				func_buff = job_p->function;
-				arg_buff = job_p->arg;
-				func_buff(arg_buff);
-				free(job_p);
-			}
+		__atomic_sub_fetch(&thpool_p->num_threads_working, 1, __ATOMIC_SEQ_CST);
 
-			pthread_mutex_lock(&thpool_p->thcount_lock);
-			thpool_p->num_threads_working--;
-			if(!thpool_p->num_threads_working) {
-				pthread_cond_signal(&thpool_p->threads_all_idle);
-			}
-			pthread_mutex_unlock(&thpool_p->thcount_lock);
+		if(job_p) continue;
+
+		/* pending jobs are being submitted or pulled by another thread */
+		if(__atomic_load_n(&thpool_p->num_jobs, __ATOMIC_SEQ_CST) > 0) {
+			sched_yield();
+			continue;
 		}
+
+		thread_idle(thread_p);
 	}
+	current_thread = NULL;
+
 	pthread_mutex_lock(&thpool_p->thcount_lock);
+	thread_p->running = 0;
 	thpool_p->num_threads_alive--;
 	pthread_mutex_unlock(&thpool_p->thcount_lock);
 
@@ -387,6 +694,7 @@ static void *thread_do(struct thread *thread_p) {
 
 /* Frees a thread  */
 static void thread_destroy(thread *thread_p) {
+	jobdeque_destroy(&thread_p->deque);
 	free(thread_p);
 }
 
@@ -394,133 +702,201 @@ static void thread_destroy(thread *thread_p) {
 
 /* Initialize queue */
 static int jobqueue_init(jobqueue *jobqueue_p) {
-	jobqueue_p->len         =  0;
-	jobqueue_p->front       =  NULL;
-	jobqueue_p->rear        =  NULL;
+	jobqueue_p->len       =  0;
+	jobqueue_p->stub.next =  NULL;
+	jobqueue_p->head      =  &jobqueue_p->stub;
+	jobqueue_p->tail      =  &jobqueue_p->stub;
 
-	jobqueue_p->has_jobs = (struct bsem *)malloc(sizeof(struct bsem));
-	if(jobqueue_p->has_jobs == NULL) {
-		return -1;
-	}
-
-	pthread_mutex_init(&(jobqueue_p->rwmutex), NULL);
-	bsem_init(jobqueue_p->has_jobs, 0);
+	pthread_mutex_init(&(jobqueue_p->pull_lock), NULL);
 
 	return 0;
 }
 
 /* Clear the queue */
 static void jobqueue_clear(jobqueue *jobqueue_p) {
-
-	while(jobqueue_p->len) {
-		free(jobqueue_pull(jobqueue_p));
+	job *job_p;
+	while((job_p = jobqueue_pull(jobqueue_p)) != NULL) {
+		free(job_p);
 	}
+}
 
-	jobqueue_p->front = NULL;
-	jobqueue_p->rear = NULL;
-	bsem_reset(jobqueue_p->has_jobs);
-	jobqueue_p->len = 0;
+/* Link job at the head of the queue
+ * a job is reachable by consumers once its predecessor links to it */
+static void jobqueue_link(jobqueue *jobqueue_p, struct job *newjob) {
+	__atomic_store_n(&newjob->next, NULL, __ATOMIC_RELAXED);
+	job *prev = __atomic_exchange_n(&jobqueue_p->head, newjob, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&prev->next, newjob, __ATOMIC_RELEASE);
 }
 
 /* Add (allocated) job to queue */
 static void jobqueue_push(jobqueue *jobqueue_p, struct job *newjob) {
-	newjob->prev = NULL;
-
-	pthread_mutex_lock(&jobqueue_p->rwmutex);
-
-	switch(jobqueue_p->len) {
-		case 0: /* no jobs in queue */
-			jobqueue_p->front = newjob;
-			jobqueue_p->rear = newjob;
-			break;
-		default: /* jobs in queue */
-			jobqueue_p->rear->prev = newjob;
-			jobqueue_p->rear = newjob;
-	}
-
-	jobqueue_p->len++;
-	bsem_post(jobqueue_p->has_jobs);
-
-	pthread_mutex_unlock(&jobqueue_p->rwmutex);
+	__atomic_add_fetch(&jobqueue_p->len, 1, __ATOMIC_RELAXED);
+	jobqueue_link(jobqueue_p, newjob);
 }
 
 /* Get first job from queue(removes it from queue)
  *
- * Notice: Caller MUST hold a mutex
+ * returns NULL if the queue is empty, if another thread is pulling from it
+ * or if its first job is still being linked
  */
 static struct job *jobqueue_pull(jobqueue *jobqueue_p) {
 
-	pthread_mutex_lock(&jobqueue_p->rwmutex);
-	job *job_p = jobqueue_p->front;
+	if(__atomic_load_n(&jobqueue_p->len, __ATOMIC_RELAXED) == 0) return NULL;
+	if(pthread_mutex_trylock(&jobqueue_p->pull_lock) != 0) return NULL;
 
-	switch(jobqueue_p->len) {
+	job *job_p = NULL;
+	job *tail = jobqueue_p->tail;
+	job *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
 
-	case 0: /* if no jobs in queue */
-		break;
-
-	case 1: /* if one job in queue */
-		jobqueue_p->front = NULL;
-		jobqueue_p->rear = NULL;
-		jobqueue_p->len = 0;
-		break;
+	/* skip over the stub */
+	if(tail == &jobqueue_p->stub) {
+		if(next == NULL) goto cleanup;
+		jobqueue_p->tail = next;
+		tail = next;
+		next = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+	}
 
-	default: /* if >1 jobs in queue */
-		jobqueue_p->front = job_p->prev;
-		jobqueue_p->len--;
-		/* more than one job in queue -> post it */
-		bsem_post(jobqueue_p->has_jobs);
+	/* last job, put the stub behind it to keep the queue non-empty */
+	if(next == NULL) {
+		if(tail != __atomic_load_n(&jobqueue_p->head, __ATOMIC_ACQUIRE)) goto cleanup;
+		jobqueue_link(jobqueue_p, &jobqueue_p->stub);
+		next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+		if(next == NULL) goto cleanup;
 	}
 
-	pthread_mutex_unlock(&jobqueue_p->rwmutex);
+	jobqueue_p->tail = next;
+	job_p = tail;
+	__atomic_sub_fetch(&jobqueue_p->len, 1, __ATOMIC_RELAXED);
+
+cleanup:
+	pthread_mutex_unlock(&jobqueue_p->pull_lock);
 	return job_p;
 }
 
 /* Free all queue resources back to the system */
 static void jobqueue_destroy(jobqueue *jobqueue_p) {
 	jobqueue_clear(jobqueue_p);
-	free(jobqueue_p->has_jobs);
+	pthread_mutex_destroy(&jobqueue_p->pull_lock);
 }
 
-/* ======================== SYNCHRONISATION ========================= */
+/* ============================ JOB DEQUE =========================== */
 
-/* Init semaphore to 1 or 0 */
-static void bsem_init(bsem *bsem_p, int value) {
-	if(value < 0 || value > 1) {
-		err("bsem_init(): Binary semaphore can take only values 1 or 0");
-		exit(1);
-	}
-	pthread_mutex_init(&(bsem_p->mutex), NULL);
-	pthread_cond_init(&(bsem_p->cond), NULL);
-	bsem_p->v = value;
+static jobarray *jobarray_new(long capacity, jobarray *prev) {
+	jobarray *array = (jobarray *)malloc(sizeof(jobarray) + capacity * sizeof(job *));
+	if(array == NULL) return NULL;
+
+	array->capacity = capacity;
+	array->prev = prev;
+	return array;
 }
 
-/* Reset semaphore to 0 */
-static void bsem_reset(bsem *bsem_p) {
-	bsem_init(bsem_p, 0);
+/* Initialize deque */
+static int jobdeque_init(jobdeque *jobdeque_p) {
+	jobdeque_p->top    = 0;
+	jobdeque_p->bottom = 0;
+	jobdeque_p->array  = jobarray_new(THPOOL_DEQUE_CAPACITY, NULL);
+
+	return (jobdeque_p->array == NULL) ? -1 : 0;
 }
 
-/* Post to at least one thread */
-static void bsem_post(bsem *bsem_p) {
-	pthread_mutex_lock(&bsem_p->mutex);
-	bsem_p->v = 1;
-	pthread_cond_signal(&bsem_p->cond);
-	pthread_mutex_unlock(&bsem_p->mutex);
+/* Push job at the bottom of the deque, called by its owner only
+ *
+ * @return 0 on success, -1 if the deque is full and can't grow
+ */
+static int jobdeque_push(jobdeque *jobdeque_p, struct job *newjob) {
+	long b = __atomic_load_n(&jobdeque_p->bottom, __ATOMIC_RELAXED);
+	long t = __atomic_load_n(&jobdeque_p->top, __ATOMIC_ACQUIRE);
+	jobarray *array = __atomic_load_n(&jobdeque_p->array, __ATOMIC_RELAXED);
+
+	if(b - t > array->capacity - 1) {
+		/* grow, thieves may still read from the retired array
+		 * which is kept until the deque is destroyed */
+		jobarray *grown = jobarray_new(array->capacity * 2, array);
+		if(grown == NULL) return -1;
+		for(long i = t; i < b; i++) {
+			grown->jobs[i & (grown->capacity - 1)] = array->jobs[i & (array->capacity - 1)];
+		}
+		__atomic_store_n(&jobdeque_p->array, grown, __ATOMIC_RELEASE);
+		array = grown;
+	}
+
+	__atomic_store_n(&array->jobs[b & (array->capacity - 1)], newjob, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&jobdeque_p->bottom, b + 1, __ATOMIC_RELAXED);
+
+	return 0;
 }
 
-/* Post to all threads */
-static void bsem_post_all(bsem *bsem_p) {
-	pthread_mutex_lock(&bsem_p->mutex);
-	bsem_p->v = 1;
-	pthread_cond_broadcast(&bsem_p->cond);
-	pthread_mutex_unlock(&bsem_p->mutex);
+/* Take job from the bottom of the deque, called by its owner only */
+static struct job *jobdeque_take(jobdeque *jobdeque_p) {
+	/* top only grows, a stale top never hides a job */
+	if(__atomic_load_n(&jobdeque_p->bottom, __ATOMIC_RELAXED) <=
+	   __atomic_load_n(&jobdeque_p->top, __ATOMIC_RELAXED)) {
+		return NULL;
+	}
+
+	long b = __atomic_load_n(&jobdeque_p->bottom, __ATOMIC_RELAXED) - 1;
+	jobarray *array = __atomic_load_n(&jobdeque_p->array, __ATOMIC_RELAXED);
+	__atomic_store_n(&jobdeque_p->bottom, b, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	long t = __atomic_load_n(&jobdeque_p->top, __ATOMIC_RELAXED);
+
+	job *job_p = NULL;
+	if(t <= b) {
+		job_p = __atomic_load_n(&array->jobs[b & (array->capacity - 1)], __ATOMIC_RELAXED);
+		if(t == b) {
+			/* last job, race thieves for it */
+			if(!__atomic_compare_exchange_n(&jobdeque_p->top, &t, t + 1, 0,
+						__ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+				job_p = NULL;
+			}
+			__atomic_store_n(&jobdeque_p->bottom, b + 1, __ATOMIC_RELAXED);
+		}
+	} else {
+		/* empty */
+		__atomic_store_n(&jobdeque_p->bottom, b + 1, __ATOMIC_RELAXED);
+	}
+
+	return job_p;
+}
+
+/* Steal job from the top of the deque
+ *
+ * returns NULL if the deque is empty, or if another thread won the job
+ */
+static struct job *jobdeque_steal(jobdeque *jobdeque_p) {
+	/* skip the fence for deques observed empty, the caller retries
+	 * while jobs are pending */
+	if(__atomic_load_n(&jobdeque_p->bottom, __ATOMIC_RELAXED) <=
+	   __atomic_load_n(&jobdeque_p->top, __ATOMIC_RELAXED)) {
+		return NULL;
+	}
+
+	long t = __atomic_load_n(&jobdeque_p->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	long b = __atomic_load_n(&jobdeque_p->bottom, __ATOMIC_ACQUIRE);
+	if(t >= b) return NULL;
+
+	jobarray *array = __atomic_load_n(&jobdeque_p->array, __ATOMIC_ACQUIRE);
+	job *job_p = __atomic_load_n(&array->jobs[t & (array->capacity - 1)], __ATOMIC_RELAXED);
+	if(!__atomic_compare_exchange_n(&jobdeque_p->top, &t, t + 1, 0,
+				__ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		return NULL;
+	}
+
+	return job_p;
 }
 
-/* Wait on semaphore until semaphore has value 0 */
-static void bsem_wait(bsem *bsem_p) {
-	pthread_mutex_lock(&bsem_p->mutex);
-	while(bsem_p->v != 1) {
-		pthread_cond_wait(&bsem_p->cond, &bsem_p->mutex);
+/* Free all deque resources back to the system */
+static void jobdeque_destroy(jobdeque *jobdeque_p) {
+	jobarray *array = jobdeque_p->array;
+	for(long i = jobdeque_p->top; i < jobdeque_p->bottom; i++) {
+		free(array->jobs[i & (array->capacity - 1)]);
+	}
+
+	while(array != NULL) {
+		jobarray *prev = array->prev;
+		free(array);
+		array = prev;
 	}
-	bsem_p->v = 0;
-	pthread_mutex_unlock(&bsem_p->mutex);
 }
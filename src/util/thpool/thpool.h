@@ -11,6 +11,7 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
 
@@ -41,6 +42,20 @@ typedef struct thpool_* threadpool;
 threadpool thpool_init(int num_threads, const char *name);
 
 
+/**
+ * @brief  Initialize resizable threadpool
+ * Same as thpool_init, the pool can later be resized by thpool_resize
+ * up to max_threads threads. Threads are identified by their slot,
+ * friendly ids range from 0 to max_threads - 1.
+ * @param  num_threads   number of threads to be created in the threadpool
+ * @param  max_threads   maximum number of threads in the threadpool
+ * @param  name          name associated with pool
+ * @return threadpool    created threadpool on success,
+ *                       NULL on error
+ */
+threadpool thpool_init_resizable(int num_threads, int max_threads, const char *name);
+
+
 /**
  * @brief Add work to the job queue
  *
@@ -71,6 +86,37 @@ threadpool thpool_init(int num_threads, const char *name);
 int thpool_add_work(threadpool, void (*function_p)(void*), void* arg_p);
 
 
+/**
+ * @brief Add low priority work to the job queue
+ *
+ * Low priority jobs are executed once the jobs added via thpool_add_work
+ * are exhausted, to avoid starvation one low priority job is executed for
+ * every THPOOL_LOW_PRIORITY_INTERVAL jobs pulled while both kinds are queued.
+ *
+ * @param  threadpool    threadpool to which the work will be added
+ * @param  function_p    pointer to function to add as work
+ * @param  arg_p         pointer to an argument
+ * @return 0 on successs -1 otherwise
+ */
+int thpool_add_low_priority_work(threadpool, void (*function_p)(void*), void* arg_p);
+
+
+/**
+ * @brief Add work to the calling thread's deque
+ * Meant for jobs spawned by a job of the pool, e.g. splitting a task into
+ * parts. The job is pushed onto the calling thread's own deque, which its
+ * thread works through most recent job first, while idle threads of the
+ * pool steal the oldest jobs off it. Callers outside of the pool have their
+ * job added as if by thpool_add_work.
+ * Jobs added this way are not counted by thpool_queue_size.
+ * @param  threadpool    threadpool to which the work will be added
+ * @param  function_p    pointer to function to add as work
+ * @param  arg_p         pointer to an argument
+ * @return 0 on successs -1 otherwise
+ */
+int thpool_add_local_work(threadpool, void (*function_p)(void*), void* arg_p);
+
+
 /**
  * @brief Wait for all queued jobs to finish
  *
@@ -78,11 +124,7 @@ int thpool_add_work(threadpool, void (*function_p)(void*), void* arg_p);
  * Once the queue is empty and all work has completed, the calling thread
  * (probably the main program) will continue.
  *
- * Smart polling is used in wait. The polling is initially 0 - meaning that
- * there is virtually no polling at all. If after 1 seconds the threads
- * haven't finished, the polling interval starts growing exponentially
- * untill it reaches max_secs seconds. Then it jumps down to a maximum polling
- * interval assuming that heavy processing is being used in the threadpool.
+ * The pool is polled every millisecond until it is drained.
  *
  * @example
  *
@@ -141,6 +183,19 @@ void thpool_pause(threadpool);
 void thpool_resume(threadpool);
 
 
+/**
+ * @brief Resize the threadpool
+ * Missing threads are started right away, threads beyond the new size
+ * retire once done with their current job, and with the jobs they had
+ * spawned via thpool_add_local_work.
+ * Size is bounded by the max_threads given to thpool_init_resizable.
+ * @param threadpool     the threadpool to resize
+ * @param num_threads    number of threads the pool should have
+ * @return nothing
+ */
+void thpool_resize(threadpool, int num_threads);
+
+
 /**
  * @brief Destroy the threadpool
  *
@@ -195,6 +250,14 @@ int thpool_num_threads_working(threadpool);
 int thpool_num_threads(threadpool);
 
 
+/**
+ * @brief Returns maximum number of threads in pool.
+ * @param threadpool     the threadpool of interest
+ * @return integer       number of thread slots
+ */
+int thpool_max_threads(threadpool);
+
+
 /**
  * @brief Returns friendly id associated with thread.
  *
@@ -204,6 +267,15 @@ int thpool_num_threads(threadpool);
  */
 int thpool_get_thread_id(threadpool, pthread_t);
 
+/**
+ * @brief Returns the nth thread of the pool.
+ *
+ * @param threadpool    the threadpool of interest
+ * @param n             friendly id of the thread
+ * @return pthread_t    the thread
+ */
+pthread_t thpool_get_thread(threadpool, int n);
+
 /**
  * @brief Returns number of pending jobs in queue
  *
@@ -212,6 +284,24 @@ int thpool_get_thread_id(threadpool, pthread_t);
  */
 uint thpool_queue_size(threadpool);
 
+/**
+ * @brief Returns number of pending jobs added via thpool_add_work
+ *
+ * @param threadpool    the threadpool of interest
+ * @return integer      number of pending jobs, excluding low priority jobs
+ */
+uint thpool_priority_queue_size(threadpool);
+
+/**
+ * @brief Returns time jobs spent in queue
+ * Accumulated over the jobs added via thpool_add_work, from the time they
+ * were added until a thread pulled them.
+ * @param threadpool    the threadpool of interest
+ * @param jobs          set to the number of jobs pulled so far
+ * @return uint64_t     accumulated time, in microseconds
+ */
+uint64_t thpool_queue_wait(threadpool, uint64_t *jobs);
+
 #ifdef __cplusplus
 }
 #endif
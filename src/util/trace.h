@@ -0,0 +1,45 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+// statically defined tracing probes (USDT)
+// probes are compiled in when building with TRACE=1, otherwise they expand
+// to nothing, a disabled probe costs a single NOP once compiled in
+//
+// probes are listed by:
+//   bpftrace -l 'usdt:/path/to/redisgraph.so:redisgraph:*'
+//
+// probe                 arguments
+// query__start          graph name, query
+// query__done           graph name, query, execution time (us)
+// op__init              operation name
+// op__consume__batch    operation name, records produced, batch capacity
+// lock__acquire         graph, write lock (0/1)
+// lock__acquired        graph, write lock (0/1)
+// lock__release         graph
+// matrix__sync__start   matrix
+// matrix__sync__done    matrix
+// rdb__encode__start    graph name, encode state, entities count
+// rdb__encode__done     graph name, encode state
+
+#if defined(RG_TRACE) && defined(__linux__)
+
+#include <sys/sdt.h>
+
+#define TRACE_PROBE(name) DTRACE_PROBE(redisgraph, name)
+#define TRACE_PROBE1(name, a) DTRACE_PROBE1(redisgraph, name, a)
+#define TRACE_PROBE2(name, a, b) DTRACE_PROBE2(redisgraph, name, a, b)
+#define TRACE_PROBE3(name, a, b, c) DTRACE_PROBE3(redisgraph, name, a, b, c)
+
+#else
+
+#define TRACE_PROBE(name)
+#define TRACE_PROBE1(name, a)
+#define TRACE_PROBE2(name, a, b)
+#define TRACE_PROBE3(name, a, b, c)
+
+#endif
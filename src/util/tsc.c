@@ -0,0 +1,43 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "tsc.h"
+#include <pthread.h>
+
+// duration of the calibration, in milliseconds
+#define TSC_CALIBRATION_MS 10
+
+static double _ticks_per_ms = 1;
+static pthread_once_t _calibrated = PTHREAD_ONCE_INIT;
+
+static inline uint64_t _MonotonicNs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void _TSC_Calibrate(void) {
+	// count ticks elapsed over a fixed wall clock interval
+	uint64_t start_ns = _MonotonicNs();
+	uint64_t start = TSC_Now();
+	uint64_t elapsed_ns;
+	do {
+		elapsed_ns = _MonotonicNs() - start_ns;
+	} while(elapsed_ns < TSC_CALIBRATION_MS * 1000000);
+	uint64_t ticks = TSC_Now() - start;
+
+	double ticks_per_ms = (double)ticks * 1000000 / elapsed_ns;
+	if(ticks_per_ms > 0) _ticks_per_ms = ticks_per_ms;
+}
+
+void TSC_Calibrate(void) {
+	pthread_once(&_calibrated, _TSC_Calibrate);
+}
+
+double TSC_TicksPerMs(void) {
+	TSC_Calibrate();
+	return _ticks_per_ms;
+}
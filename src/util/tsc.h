@@ -0,0 +1,43 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// cheap monotonic timestamps, for timing code paths too hot for clock_gettime
+// timestamps are converted to milliseconds using TSC_TicksPerMs
+
+// returns the current timestamp, in ticks
+static inline uint64_t TSC_Now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#elif defined(__aarch64__)
+	uint64_t ticks;
+	__asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+// measures the timestamp frequency, called once at module load
+// later calls are NOPs
+void TSC_Calibrate(void);
+
+// returns the number of ticks per millisecond, calibrating on first call
+double TSC_TicksPerMs(void);
+
+// converts a number of ticks to milliseconds
+static inline double TSC_ToMs(uint64_t ticks) {
+	return ticks / TSC_TicksPerMs();
+}
@@ -0,0 +1,216 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "value_log.h"
+#include "RG.h"
+#include "../arr.h"
+#include "../rmalloc.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+
+// Size of a segment, larger values are held by a segment of their own.
+#define VALUE_LOG_SEGMENT_SIZE (8 * 1024 * 1024)
+// Min number of released bytes worth compacting.
+#define VALUE_LOG_COMPACT_MIN (1024 * 1024)
+// Sealed segments are compacted once released values make up half of their bytes.
+#define VALUE_LOG_COMPACT_RATIO 2
+// Segment files are created within the server's working directory.
+#define VALUE_LOG_FILE_TEMPLATE "redisgraph_values_XXXXXX"
+
+// Bytes taken by a value of len bytes, values are 8 byte aligned.
+#define ENTRY_SIZE(len) (((sizeof(LoggedValue) + (len) + 1) + 7) & ~(size_t)7)
+
+static inline LoggedValue *_ValueLog_Header(char *s) {
+	return (LoggedValue *)(s - offsetof(LoggedValue, str));
+}
+
+// Returns true if values are appended to segment.
+static inline bool _ValueLog_Active(const ValueLogSegment *segment) {
+	ValueLogSegment **segments = segment->log->segments;
+	return segments[array_len(segments) - 1] == segment;
+}
+
+static void _ValueLog_RemoveSegment(ValueLog *log, ValueLogSegment *segment) {
+	uint count = array_len(log->segments);
+	for(uint i = 0; i < count; i++) {
+		if(log->segments[i] != segment) continue;
+		array_del(log->segments, i);
+		break;
+	}
+
+	log->used -= segment->used;
+	log->dead -= segment->dead;
+	log->mapped -= segment->cap;
+	munmap(segment->base, segment->cap);
+	rm_free(segment);
+}
+
+// Maps a new segment of at least min_cap bytes, to which values are appended
+// returns NULL if the segment's file couldn't be created or mapped.
+static ValueLogSegment *_ValueLog_AddSegment(ValueLog *log, size_t min_cap) {
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t cap = MAX(VALUE_LOG_SEGMENT_SIZE, (min_cap + page - 1) / page * page);
+
+	char path[] = VALUE_LOG_FILE_TEMPLATE;
+	int fd = mkstemp(path);
+	if(fd == -1) return NULL;
+
+	// the file is reachable only through its mapping
+	unlink(path);
+
+	// reserve the segment's disk space, a write to the mapping of a sparse
+	// file which the disk can't hold raises SIGBUS
+	char *base = MAP_FAILED;
+	if(posix_fallocate(fd, 0, cap) == 0) {
+		base = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if(base == MAP_FAILED) return NULL;
+
+	ValueLogSegment *segment = rm_malloc(sizeof(ValueLogSegment));
+	segment->log = log;
+	segment->base = base;
+	segment->cap = cap;
+	segment->used = 0;
+	segment->dead = 0;
+	segment->compacting = false;
+
+	// the previous segment is sealed, its values may have all been released
+	uint count = array_len(log->segments);
+	ValueLogSegment *sealed = (count > 0) ? log->segments[count - 1] : NULL;
+	log->segments = array_append(log->segments, segment);
+	log->mapped += cap;
+	if(sealed && sealed->dead == sealed->used) _ValueLog_RemoveSegment(log, sealed);
+
+	return segment;
+}
+
+ValueLog *ValueLog_New(uint64_t threshold) {
+	ValueLog *log = rm_malloc(sizeof(ValueLog));
+	log->segments = array_new(ValueLogSegment *, 0);
+	log->threshold = threshold;
+	log->used = 0;
+	log->dead = 0;
+	log->mapped = 0;
+	return log;
+}
+
+char *ValueLog_Append(ValueLog *log, const char *s) {
+	ASSERT(log != NULL && s != NULL);
+
+	size_t len = strlen(s);
+	size_t size = ENTRY_SIZE(len);
+	uint count = array_len(log->segments);
+	ValueLogSegment *segment = (count > 0) ? log->segments[count - 1] : NULL;
+	if(segment == NULL || segment->cap - segment->used < size) {
+		segment = _ValueLog_AddSegment(log, size);
+		if(segment == NULL) return NULL;
+	}
+
+	LoggedValue *entry = (LoggedValue *)(segment->base + segment->used);
+	entry->segment = segment;
+	entry->len = len;
+	memcpy(entry->str, s, len + 1);
+	segment->used += size;
+	log->used += size;
+
+	return entry->str;
+}
+
+void ValueLog_Release(char *s) {
+	ASSERT(s != NULL);
+
+	LoggedValue *entry = _ValueLog_Header(s);
+	ValueLogSegment *segment = entry->segment;
+	ValueLog *log = segment->log;
+	size_t size = ENTRY_SIZE(entry->len);
+
+	ASSERT(segment->dead + size <= segment->used);
+	segment->dead += size;
+	log->dead += size;
+
+	// sealed segments are unmapped once their last value is released
+	if(segment->dead == segment->used && !_ValueLog_Active(segment)) {
+		_ValueLog_RemoveSegment(log, segment);
+	}
+}
+
+// Returns true if segment is worth compacting.
+static inline bool _ValueLog_Compactable(const ValueLogSegment *segment) {
+	// the active segment is left as is, its values were appended lately
+	return !_ValueLog_Active(segment) &&
+		segment->dead * VALUE_LOG_COMPACT_RATIO >= segment->used;
+}
+
+bool ValueLog_CompactionDue(const ValueLog *log) {
+	ASSERT(log != NULL);
+
+	uint64_t dead = 0;
+	uint count = array_len(log->segments);
+	for(uint i = 0; i < count; i++) {
+		const ValueLogSegment *segment = log->segments[i];
+		if(_ValueLog_Compactable(segment)) dead += segment->dead;
+	}
+	return dead >= VALUE_LOG_COMPACT_MIN;
+}
+
+void ValueLog_BeginCompaction(ValueLog *log) {
+	ASSERT(log != NULL);
+
+	uint count = array_len(log->segments);
+	for(uint i = 0; i < count; i++) {
+		ValueLogSegment *segment = log->segments[i];
+		segment->compacting = _ValueLog_Compactable(segment);
+	}
+}
+
+char *ValueLog_Relocate(char *s) {
+	ASSERT(s != NULL);
+
+	ValueLogSegment *segment = _ValueLog_Header(s)->segment;
+	if(!segment->compacting) return s;
+
+	// values which fail to relocate remain in place
+	char *copy = ValueLog_Append(segment->log, s);
+	if(copy == NULL) return s;
+
+	ValueLog_Release(s);
+	return copy;
+}
+
+void ValueLog_EndCompaction(ValueLog *log) {
+	ASSERT(log != NULL);
+
+	uint count = array_len(log->segments);
+	for(uint i = 0; i < count; i++) log->segments[i]->compacting = false;
+}
+
+uint64_t ValueLog_MappedBytes(const ValueLog *log) {
+	ASSERT(log != NULL);
+	return log->mapped;
+}
+
+uint64_t ValueLog_LiveBytes(const ValueLog *log) {
+	ASSERT(log != NULL);
+	return log->used - log->dead;
+}
+
+void ValueLog_Free(ValueLog *log) {
+	ASSERT(log != NULL);
+
+	uint count = array_len(log->segments);
+	for(uint i = 0; i < count; i++) {
+		ValueLogSegment *segment = log->segments[i];
+		munmap(segment->base, segment->cap);
+		rm_free(segment);
+	}
+	array_free(log->segments);
+	rm_free(log);
+}
@@ -0,0 +1,83 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct ValueLog ValueLog;
+
+/* A segment of the value log, a file mapped into memory to which values
+ * are appended. Segments are never remapped, a value's address is stable
+ * until it is released. */
+typedef struct {
+	ValueLog *log;    // Log holding the segment.
+	char *base;       // Start of the segment's mapping.
+	size_t cap;       // Size of the mapping.
+	size_t used;      // Bytes appended.
+	size_t dead;      // Bytes of released values.
+	bool compacting;  // Live values are being relocated out of the segment.
+} ValueLogSegment;
+
+/* A logged value, the value's bytes follow its header
+ * such that a logged value is handed out as a plain char pointer. */
+typedef struct {
+	ValueLogSegment *segment;  // Segment holding the value.
+	uint64_t len;              // Length of the value, excluding the NULL terminator.
+	char str[];                // Value bytes.
+} LoggedValue;
+
+/* The ValueLog holds large string values out of the heap, within
+ * append-only files mapped into memory, such that their pages are written
+ * back to disk and reclaimed by the kernel under memory pressure, and are
+ * read in as accessed. Values aren't overwritten in place, a segment is
+ * unmapped once all of its values are released and segments dominated by
+ * released values are compacted by relocating their live values.
+ * Segment files are unlinked as they're created, forked processes keep
+ * the mappings they inherited. Not thread-safe. */
+struct ValueLog {
+	ValueLogSegment **segments;  // Mapped segments, the last is appended to.
+	uint64_t threshold;          // Min length of logged values.
+	uint64_t used;               // Bytes appended to mapped segments.
+	uint64_t dead;               // Bytes of released values within mapped segments.
+	uint64_t mapped;             // Bytes mapped by segments.
+};
+
+// Create a new ValueLog holding values of at least threshold bytes.
+ValueLog *ValueLog_New(uint64_t threshold);
+
+/* Returns a reference to the logged copy of s, NULL if the log failed
+ * to extend, in which case the caller keeps its own copy of s. */
+char *ValueLog_Append(ValueLog *log, const char *s);
+
+// Releases a logged value, which mustn't be accessed afterwards.
+void ValueLog_Release(char *s);
+
+// Returns true if released values make up enough of the log's sealed
+// segments to compact them.
+bool ValueLog_CompactionDue(const ValueLog *log);
+
+/* Marks segments dominated by released values for compaction,
+ * their live values are relocated by ValueLog_Relocate. */
+void ValueLog_BeginCompaction(ValueLog *log);
+
+/* Returns the value to reference in place of s, a copy appended anew
+ * if s resides in a segment being compacted, in which case s is released. */
+char *ValueLog_Relocate(char *s);
+
+// Concludes compaction, segments relocated entirely have been unmapped.
+void ValueLog_EndCompaction(ValueLog *log);
+
+// Returns the number of bytes mapped by the log.
+uint64_t ValueLog_MappedBytes(const ValueLog *log);
+
+// Returns the number of bytes held by live values.
+uint64_t ValueLog_LiveBytes(const ValueLog *log);
+
+// Free log, segments still holding values are unmapped along with the log.
+void ValueLog_Free(ValueLog *log);
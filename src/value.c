@@ -18,6 +18,7 @@
 #include "datatypes/map.h"
 #include "datatypes/array.h"
 #include "datatypes/path/sipath.h"
+#include "util/string_pool/string_pool.h"
 
 static inline void _SIString_ToString(SIValue str, char **buf, size_t *bufferLen,
 									  size_t *bytesWritten) {
@@ -110,6 +111,12 @@ SIValue SI_TransferStringVal(char *s) {
 	};
 }
 
+SIValue SI_InternedStringVal(char *s) {
+	return (SIValue) {
+		.stringval = s, .type = T_STRING, .allocation = M_INTERN
+	};
+}
+
 SIValue SI_Point(float latitude, float longitude) {
 	return (SIValue) {
 		.type = T_POINT, .allocation = M_NONE,
@@ -123,7 +130,7 @@ SIValue SI_Point(float latitude, float longitude) {
 SIValue SI_ShareValue(const SIValue v) {
 	SIValue dup = v;
 	// If the original value owns an allocation, mark that the duplicate shares it.
-	if(v.allocation == M_SELF) dup.allocation = M_VOLATILE;
+	if(v.allocation & (M_SELF | M_INTERN)) dup.allocation = M_VOLATILE;
 	return dup;
 }
 
@@ -134,7 +141,8 @@ SIValue SI_CloneValue(const SIValue v) {
 	if(v.allocation == M_NONE) return v; // Stack value; no allocation necessary.
 
 	if(v.type == T_STRING) {
-		// Allocate a new copy of the input's string value.
+		// Allocate a new copy of the input's string value,
+		// interned strings are only referenced by the graph's properties.
 		return SI_DuplicateStringVal(v.stringval);
 	}
 
@@ -186,7 +194,7 @@ SIValue SI_ConstValue(const SIValue v) {
 // Clone 'v' and set v's allocation to volatile if 'v' owned the memory
 SIValue SI_TransferOwnership(SIValue *v) {
 	SIValue dup = *v;
-	if(v->allocation == M_SELF) v->allocation = M_VOLATILE;
+	if(v->allocation & (M_SELF | M_INTERN)) v->allocation = M_VOLATILE;
 	return dup;
 }
 
@@ -194,7 +202,7 @@ SIValue SI_TransferOwnership(SIValue *v) {
  * with no responsibility for freeing or guarantee regarding scope.
  * This is used in cases like performing shallow copies of scalars in Record entries. */
 void SIValue_MakeVolatile(SIValue *v) {
-	if(v->allocation == M_SELF) v->allocation = M_VOLATILE;
+	if(v->allocation & (M_SELF | M_INTERN)) v->allocation = M_VOLATILE;
 }
 
 /* Ensure that any allocation held by the given SIValue is guaranteed to not go out
@@ -515,6 +523,8 @@ int SIValue_Compare(const SIValue a, const SIValue b, int *disjointOrNull) {
 		case T_DOUBLE:
 			return SAFE_COMPARISON_RESULT(a.doubleval - b.doubleval);
 		case T_STRING:
+			// equal interned strings share a pointer
+			if(a.stringval == b.stringval) return 0;
 			return strcmp(a.stringval, b.stringval);
 		case T_NODE:
 		case T_EDGE:
@@ -670,6 +680,12 @@ XXH64_hash_t SIValue_HashCode(SIValue v) {
 }
 
 void SIValue_Free(SIValue v) {
+	// Interned strings are shared, release this value's reference.
+	if(v.allocation == M_INTERN) {
+		StringPool_Release(v.stringval);
+		return;
+	}
+
 	// The free routine only performs work if it owns a heap allocation.
 	if(v.allocation != M_SELF) return;
 
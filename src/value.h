@@ -44,7 +44,8 @@ typedef enum {
 	M_NONE = 0,       // SIValue is not heap-allocated
 	M_SELF = 0x1,     // SIValue is responsible for freeing its reference
 	M_VOLATILE = 0x2, // SIValue does not own its reference and may go out of scope
-	M_CONST = 0x4     // SIValue does not own its allocation, but its access is safe
+	M_CONST = 0x4,    // SIValue does not own its allocation, but its access is safe
+	M_INTERN = 0x8    // SIValue holds a reference to a string interned in a StringPool
 } SIAllocation;
 
 #define SI_TYPE(value) (value).type
@@ -77,6 +78,7 @@ typedef enum {
 #define COMPARED_NULL INT_MIN
 
 struct Pair;
+struct SIArray;
 
 typedef struct SIValue {
 	union {
@@ -85,7 +87,7 @@ typedef struct SIValue {
 		char *stringval;
 		void *ptrval;
 		struct Pair *map;
-		struct SIValue *array;
+		struct SIArray *array;
 		struct {
 			float latitude;   // 32 bit
 			float longitude;  // 32 bit
@@ -119,6 +121,10 @@ SIValue SI_ConstStringVal(char *s);
 // Don't duplicate input string, but assume ownership.
 SIValue SI_TransferStringVal(char *s);
 
+// Returns an SIValue holding a reference to an interned string,
+// the reference is released once the value is freed.
+SIValue SI_InternedStringVal(char *s);
+
 /* Functions for copying and guaranteeing memory safety for SIValues. */
 // SI_ShareValue creates an SIValue that shares all of the original's allocations.
 SIValue SI_ShareValue(const SIValue v);
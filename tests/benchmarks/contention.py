@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+#
+# Measures read latency while writers commit to the same graph.
+#
+# Each scenario runs N reader and M writer clients against a single graph for
+# a fixed duration, writers creating WRITE_SIZE nodes per query. A reads-only
+# scenario runs first and serves as the baseline.
+#
+# Besides client side read and write latency percentiles, each scenario reports
+# the time spent waiting for the graph's read-write lock and writers mutex, the
+# redis global lock and matrix synchronization, as reported by INFO.
+#
+# KPIs fail the run, exiting with a non zero status, once read p99 exceeds
+# --max-read-p99 milliseconds or --max-read-p99-ratio times the baseline p99.
+#
+#   python3 contention.py --module ../../src/redisgraph.so --readers 16 --writers 2 \
+#       --write-size 1 --write-size 100 --write-size 1000 --output contention.json
+
+import json
+import os
+import random
+import shutil
+import subprocess
+import tempfile
+import threading
+import time
+
+import click
+import redis
+
+GRAPH = "contention"
+READ_QUERY = "MATCH (n:N {id: $id}) RETURN n.v"
+WRITE_QUERY = "UNWIND range(1, $size) AS x CREATE (:W {v: x})"
+
+# INFO graph_graphs fields, per graph
+GRAPH_LOCK_FIELDS = ["read_lock_wait_ms", "write_lock_wait_ms", "writers_wait_ms"]
+# INFO graph_metrics fields, across graphs
+GLOBAL_WAIT_FIELDS = ["gil_wait_time_ms", "matrix_sync_time_ms"]
+
+def start_server(module):
+    server = os.environ.get("REDIS_SERVER", "redis-server")
+    workdir = tempfile.mkdtemp()
+    port = 6400 + random.randint(0, 1000)
+    proc = subprocess.Popen([server, "--port", str(port), "--dir", workdir, "--save", "",
+                             "--loadmodule", os.path.abspath(module)], stdout=subprocess.DEVNULL)
+    con = redis.Redis(port=port)
+    for _ in range(100):
+        try:
+            con.ping()
+            break
+        except redis.exceptions.ConnectionError:
+            time.sleep(0.1)
+    return proc, workdir, port
+
+def populate(con, nodes):
+    con.delete(GRAPH)
+    con.execute_command("GRAPH.QUERY", GRAPH, "CREATE INDEX ON :N(id)")
+    for i in range(0, nodes, 10000):
+        con.execute_command("GRAPH.QUERY", GRAPH,
+                            "UNWIND range(%d, %d) AS x CREATE (:N {id: x, v: x %% 100})" %
+                            (i, min(nodes, i + 10000) - 1))
+
+def wait_times(con):
+    graphs = con.info("graph_graphs")
+    metrics = con.info("graph_metrics")
+    graph = graphs.get("graph_" + GRAPH, {})
+    waits = {f: float(graph.get(f, 0)) for f in GRAPH_LOCK_FIELDS}
+    waits.update({f: float(metrics.get("graph_" + f, 0)) for f in GLOBAL_WAIT_FIELDS})
+    return waits
+
+def percentiles(latencies):
+    if len(latencies) == 0:
+        return {"count": 0}
+    latencies = sorted(latencies)
+    def q(p):
+        return latencies[min(len(latencies) - 1, int(p * len(latencies)))]
+    return {
+        "count": len(latencies),
+        "avg": sum(latencies) / len(latencies),
+        "q50": q(0.5),
+        "q95": q(0.95),
+        "q99": q(0.99),
+        "q999": q(0.999),
+        "max": latencies[-1],
+    }
+
+# issues queries until deadline, appending their latency in milliseconds
+def client(port, command, query_fn, deadline, latencies, errors):
+    con = redis.Redis(port=port)
+    while time.time() < deadline:
+        query = query_fn()
+        start = time.perf_counter()
+        try:
+            con.execute_command(command, GRAPH, query)
+        except redis.exceptions.ResponseError:
+            errors.append(query)
+            continue
+        latencies.append((time.perf_counter() - start) * 1000)
+
+def run_scenario(port, nodes, readers, writers, write_size, duration):
+    con = redis.Redis(port=port, decode_responses=True)
+    before = wait_times(con)
+
+    rng = random.Random(0)
+    read_query = lambda: "CYPHER id=%d %s" % (rng.randrange(nodes), READ_QUERY)
+    write_query = lambda: "CYPHER size=%d %s" % (write_size, WRITE_QUERY)
+
+    deadline = time.time() + duration
+    read_latencies, write_latencies, errors = [], [], []
+    threads = [threading.Thread(target=client, args=(port, "GRAPH.RO_QUERY", read_query,
+                                                     deadline, read_latencies, errors))
+               for _ in range(readers)]
+    threads += [threading.Thread(target=client, args=(port, "GRAPH.QUERY", write_query,
+                                                      deadline, write_latencies, errors))
+                for _ in range(writers)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    after = wait_times(con)
+    return {
+        "Readers": readers,
+        "Writers": writers,
+        "WriteSize": write_size,
+        "Duration": duration,
+        "Errors": len(errors),
+        "ReadRate": len(read_latencies) / duration,
+        "WriteRate": len(write_latencies) / duration,
+        "ReadLatencies": percentiles(read_latencies),
+        "WriteLatencies": percentiles(write_latencies),
+        "WaitTimes": {f: after[f] - before[f] for f in after},
+    }
+
+@click.command()
+@click.option("--module", default=None, help="Path to redisgraph.so, starts a dedicated server")
+@click.option("--port", type=int, default=6379, help="Port of a running server, unless --module is set")
+@click.option("--nodes", type=int, default=100000, help="Number of nodes readers look up")
+@click.option("--readers", type=int, default=16, help="Number of reader clients")
+@click.option("--writers", type=int, default=2, help="Number of writer clients")
+@click.option("--write-size", "write_sizes", type=int, multiple=True, default=[1, 100, 1000],
+              help="Nodes created per write query, can be repeated")
+@click.option("--duration", type=float, default=30, help="Seconds per scenario")
+@click.option("--max-read-p99", type=float, default=None, help="KPI, read p99 upper bound in milliseconds")
+@click.option("--max-read-p99-ratio", type=float, default=None,
+              help="KPI, read p99 upper bound relative to the reads-only baseline")
+@click.option("--output", default=None, help="JSON results file")
+def main(module, port, nodes, readers, writers, write_sizes, duration, max_read_p99,
+         max_read_p99_ratio, output):
+    proc, workdir = None, None
+    if module:
+        proc, workdir, port = start_server(module)
+
+    try:
+        populate(redis.Redis(port=port), nodes)
+        scenarios = [run_scenario(port, nodes, readers, 0, 0, duration)]
+        for size in write_sizes:
+            scenarios.append(run_scenario(port, nodes, readers, writers, size, duration))
+    finally:
+        if proc:
+            proc.terminate()
+            proc.wait()
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    baseline = scenarios[0]["ReadLatencies"].get("q99", 0)
+    failures = []
+    for s in scenarios:
+        p99 = s["ReadLatencies"].get("q99", 0)
+        click.echo("readers=%d writers=%d write_size=%d read_p99=%.3fms read_rate=%.0f/s "
+                   "write_rate=%.0f/s waits=%s" %
+                   (s["Readers"], s["Writers"], s["WriteSize"], p99, s["ReadRate"],
+                    s["WriteRate"], json.dumps(s["WaitTimes"])))
+        if s["Errors"] > 0:
+            failures.append("write_size=%d: %d errors" % (s["WriteSize"], s["Errors"]))
+        if max_read_p99 is not None and p99 > max_read_p99:
+            failures.append("write_size=%d: read p99 %.3fms exceeds %.3fms" %
+                            (s["WriteSize"], p99, max_read_p99))
+        if max_read_p99_ratio is not None and baseline > 0 and p99 > baseline * max_read_p99_ratio:
+            failures.append("write_size=%d: read p99 %.3fms exceeds %.1fx the baseline %.3fms" %
+                            (s["WriteSize"], p99, max_read_p99_ratio, baseline))
+
+    if output:
+        with open(output, "w") as f:
+            json.dump({"StartTime": int(time.time() * 1000), "Scenarios": scenarios}, f, indent=2)
+
+    for failure in failures:
+        click.echo("KPI failed, " + failure, err=True)
+    raise SystemExit(1 if failures else 0)
+
+if __name__ == "__main__":
+    main()
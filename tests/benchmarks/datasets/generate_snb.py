@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+#
+# Generates LDBC SNB-like social network datasets for the benchmark suite.
+#
+# A scale factor of 1 holds 10K persons, ~320K nodes and ~1.5M edges, the degree
+# distribution of KNOWS follows a power law similar to the LDBC generator's.
+# Generation is deterministic for a given scale factor and seed.
+#
+# Each dataset is built on a dedicated redis-server loading the module and saved
+# as 'snb_sf<SCALE_FACTOR>.rdb' holding graph 'g'.
+#
+#   python3 generate_snb.py --module ../../../src/redisgraph.so --scale-factor 0.1 --scale-factor 1
+
+import os
+import random
+import shutil
+import subprocess
+import tempfile
+import time
+
+import click
+import redis
+
+GRAPH = "g"
+BATCH_SIZE = 5000
+
+GENDERS = ["male", "female"]
+BROWSERS = ["Firefox", "Chrome", "Safari", "Internet Explorer", "Opera"]
+LANGUAGES = ["en", "es", "de", "fr", "zh", "pt", "ru"]
+FIRST_NAMES = ["Jan", "Maria", "Ali", "Wei", "Anna", "John", "Chen", "Ivan", "Ana", "Hans"]
+LAST_NAMES = ["Smith", "Garcia", "Khan", "Wang", "Muller", "Silva", "Ivanov", "Kim", "Rossi", "Cohen"]
+
+# entity counts at scale factor 1
+PERSONS = 10000
+CITIES = 500
+TAGS = 1000
+FORUMS = 1000
+POSTS_PER_PERSON = 10
+COMMENTS_PER_PERSON = 20
+LIKES_PER_PERSON = 10
+INTERESTS_PER_PERSON = 5
+MEMBERS_PER_FORUM = 50
+TAGS_PER_POST = 2
+KNOWS_AVG_DEGREE = 20
+
+# dates are encoded as yyyymmdd integers
+def random_date(rng, first_year, last_year):
+    return rng.randint(first_year, last_year) * 10000 + rng.randint(1, 12) * 100 + rng.randint(1, 28)
+
+def literal(v):
+    if isinstance(v, str):
+        return '"%s"' % v.replace('\\', '\\\\').replace('"', '\\"')
+    if isinstance(v, (list, tuple)):
+        return "[%s]" % ",".join(literal(x) for x in v)
+    return str(v)
+
+def run_batched(con, query, rows):
+    for i in range(0, len(rows), BATCH_SIZE):
+        batch = literal(rows[i:i + BATCH_SIZE])
+        con.execute_command("GRAPH.QUERY", GRAPH, "CYPHER batch=%s %s" % (batch, query))
+
+def create_nodes(con, label, rows):
+    # rows are maps sharing the same keys, passed as lists of values
+    keys = list(rows[0].keys())
+    props = ", ".join("%s: row[%d]" % (k, i) for i, k in enumerate(keys))
+    run_batched(con, "UNWIND $batch AS row CREATE (:%s {%s})" % (label, props),
+                [[r[k] for k in keys] for r in rows])
+
+def create_edges(con, src, relation, dest, rows):
+    # rows are [src id, dest id] or [src id, dest id, creationDate]
+    props = " {creationDate: e[2]}" if rows and len(rows[0]) > 2 else ""
+    run_batched(con, "UNWIND $batch AS e MATCH (a:%s {id: e[0]}), (b:%s {id: e[1]}) CREATE (a)-[:%s%s]->(b)"
+                % (src, dest, relation, props), rows)
+
+def populate(con, sf, seed):
+    rng = random.Random(seed)
+
+    persons = max(1, int(PERSONS * sf))
+    cities = max(1, int(CITIES * min(sf, 1)))
+    tags = max(1, int(TAGS * min(sf, 1)))
+    forums = max(1, int(FORUMS * sf))
+    posts = persons * POSTS_PER_PERSON
+    comments = persons * COMMENTS_PER_PERSON
+
+    # indices are created upfront, edges are connected by id lookups
+    for label, attribute in [("Person", "id"), ("Person", "birthday"), ("City", "id"), ("Tag", "id"),
+                             ("Tag", "name"), ("Forum", "id"), ("Post", "id"), ("Comment", "id")]:
+        con.execute_command("GRAPH.QUERY", GRAPH, "CREATE INDEX ON :%s(%s)" % (label, attribute))
+
+    create_nodes(con, "City", [{"id": i, "name": "City_%d" % i} for i in range(cities)])
+    create_nodes(con, "Tag", [{"id": i, "name": "Tag_%d" % i} for i in range(tags)])
+    create_nodes(con, "Person", [{
+        "id": i,
+        "firstName": rng.choice(FIRST_NAMES),
+        "lastName": rng.choice(LAST_NAMES),
+        "gender": rng.choice(GENDERS),
+        "birthday": random_date(rng, 1950, 2000),
+        "creationDate": random_date(rng, 2010, 2012),
+        "browserUsed": rng.choice(BROWSERS)
+    } for i in range(persons)])
+    create_nodes(con, "Forum", [{
+        "id": i,
+        "title": "Forum_%d" % i,
+        "creationDate": random_date(rng, 2010, 2012)
+    } for i in range(forums)])
+    create_nodes(con, "Post", [{
+        "id": i,
+        "creationDate": random_date(rng, 2010, 2012),
+        "length": rng.randint(0, 2000),
+        "language": rng.choice(LANGUAGES)
+    } for i in range(posts)])
+    create_nodes(con, "Comment", [{
+        "id": i,
+        "creationDate": random_date(rng, 2010, 2012),
+        "length": rng.randint(0, 500)
+    } for i in range(comments)])
+
+    # power law KNOWS degrees, scaled to the expected average degree
+    weights = [rng.paretovariate(1.5) for _ in range(persons)]
+    scale = KNOWS_AVG_DEGREE * persons / sum(weights)
+    knows = set()
+    for p in range(persons):
+        degree = min(persons - 1, int(weights[p] * scale))
+        for _ in range(degree):
+            friend = rng.randrange(persons)
+            if friend != p:
+                knows.add((p, friend))
+    create_edges(con, "Person", "KNOWS", "Person",
+                 [[a, b, random_date(rng, 2010, 2012)] for a, b in sorted(knows)])
+
+    create_edges(con, "Person", "IS_LOCATED_IN", "City",
+                 [[p, rng.randrange(cities)] for p in range(persons)])
+    create_edges(con, "Person", "HAS_INTEREST", "Tag",
+                 [[p, t] for p in range(persons) for t in rng.sample(range(tags), min(tags, INTERESTS_PER_PERSON))])
+    create_edges(con, "Forum", "HAS_MEMBER", "Person",
+                 [[f, rng.randrange(persons)] for f in range(forums) for _ in range(MEMBERS_PER_FORUM)])
+    create_edges(con, "Forum", "CONTAINER_OF", "Post",
+                 [[rng.randrange(forums), p] for p in range(posts)])
+    create_edges(con, "Post", "HAS_CREATOR", "Person",
+                 [[p, p // POSTS_PER_PERSON] for p in range(posts)])
+    create_edges(con, "Post", "HAS_TAG", "Tag",
+                 [[p, rng.randrange(tags)] for p in range(posts) for _ in range(TAGS_PER_POST)])
+    create_edges(con, "Comment", "HAS_CREATOR", "Person",
+                 [[c, rng.randrange(persons)] for c in range(comments)])
+    create_edges(con, "Comment", "REPLY_OF", "Post",
+                 [[c, rng.randrange(posts)] for c in range(comments)])
+    create_edges(con, "Person", "LIKES", "Post",
+                 [[p, rng.randrange(posts)] for p in range(persons) for _ in range(LIKES_PER_PERSON)])
+
+def generate(module, sf, seed, output):
+    server = os.environ.get("REDIS_SERVER", "redis-server")
+    workdir = tempfile.mkdtemp()
+    port = 6400 + random.randint(0, 1000)
+    proc = subprocess.Popen([server, "--port", str(port), "--dir", workdir, "--save", "",
+                             "--loadmodule", os.path.abspath(module)], stdout=subprocess.DEVNULL)
+    try:
+        con = redis.Redis(port=port)
+        for _ in range(100):
+            try:
+                con.ping()
+                break
+            except redis.exceptions.ConnectionError:
+                time.sleep(0.1)
+
+        populate(con, sf, seed)
+        con.save()
+        shutil.copy(os.path.join(workdir, "dump.rdb"), output)
+    finally:
+        proc.terminate()
+        proc.wait()
+        shutil.rmtree(workdir, ignore_errors=True)
+
+@click.command()
+@click.option("--module", required=True, help="Path to redisgraph.so")
+@click.option("--scale-factor", "scale_factors", type=float, multiple=True, default=[1],
+              help="Scale factor, can be repeated")
+@click.option("--seed", type=int, default=0, help="Random seed")
+@click.option("--skip-existing", is_flag=True, help="Don't regenerate existing datasets")
+def main(module, scale_factors, seed, skip_existing):
+    for sf in scale_factors:
+        output = os.path.join(os.path.dirname(os.path.abspath(__file__)), "snb_sf%g.rdb" % sf)
+        if skip_existing and os.path.exists(output):
+            continue
+        click.echo("generating %s" % output)
+        generate(module, sf, seed, output)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+#
+# Measures the quality of the plans the optimizer picks.
+#
+# A catalogue of representative queries runs against a generated graph whose
+# labels and degrees are skewed, defying the planner's uniform distribution
+# estimates. For each query the benchmark reports:
+#
+# - per operation estimated and actual record counts, as reported by
+#   GRAPH.PROFILE, and their q-error, max(estimate, actual) / min(estimate, actual)
+# - the execution time of the chosen plan versus forced alternatives, which
+#   pin the traversal's starting point and order by binding variables through
+#   WITH clauses, overriding orderExpressions' arrangement
+#
+# KPIs fail the run, exiting with a non zero status, once a chosen plan is
+# --max-slowdown times slower than its fastest alternative, or an operation's
+# q-error exceeds --max-qerror.
+#
+#   python3 planner_quality.py --module ../../src/redisgraph.so --scale 1 \
+#       --max-slowdown 10 --output planner_quality.json
+
+import json
+import random
+import re
+import shutil
+import statistics
+import time
+
+import click
+import redis
+
+from contention import start_server
+
+GRAPH = "planner_quality"
+
+# each entry's alternatives must produce the same result as its query
+CATALOGUE = [
+    {
+        "name": "selective_endpoint",
+        "query": "MATCH (p:Person)-[:LIKES]->(i:Item) WHERE i.id = 1 RETURN count(p)",
+        "alternatives": {
+            "from_person": "MATCH (p:Person) WITH p MATCH (p)-[:LIKES]->(i:Item) WHERE i.id = 1 RETURN count(p)",
+            "from_item": "MATCH (i:Item) WHERE i.id = 1 WITH i MATCH (p:Person)-[:LIKES]->(i) RETURN count(p)",
+        },
+    },
+    {
+        "name": "hub_fanout",
+        "query": "MATCH (h:Hub)-[:OWNS]->(i:Item)<-[:LIKES]-(p:Person) RETURN count(p)",
+        "alternatives": {
+            "from_hub": "MATCH (h:Hub) WITH h MATCH (h)-[:OWNS]->(i:Item)<-[:LIKES]-(p:Person) RETURN count(p)",
+            "from_item": "MATCH (i:Item) WITH i MATCH (h:Hub)-[:OWNS]->(i)<-[:LIKES]-(p:Person) RETURN count(p)",
+            "from_person": "MATCH (p:Person) WITH p MATCH (h:Hub)-[:OWNS]->(i:Item)<-[:LIKES]-(p) RETURN count(p)",
+        },
+    },
+    {
+        "name": "skewed_filter",
+        "query": "MATCH (p:Person)-[:FOLLOWS]->(q:Person) WHERE q.id < 10 RETURN count(p)",
+        "alternatives": {
+            "from_follower": "MATCH (p:Person) WITH p MATCH (p)-[:FOLLOWS]->(q:Person) WHERE q.id < 10 RETURN count(p)",
+            "from_followed": "MATCH (q:Person) WHERE q.id < 10 WITH q MATCH (p:Person)-[:FOLLOWS]->(q) RETURN count(p)",
+        },
+    },
+    {
+        "name": "two_hops",
+        "query": "MATCH (a:Person)-[:FOLLOWS]->(b:Person)-[:LIKES]->(i:Item) WHERE a.id = 7 RETURN count(i)",
+        "alternatives": {
+            "from_source": "MATCH (a:Person) WHERE a.id = 7 WITH a MATCH (a)-[:FOLLOWS]->(b:Person)-[:LIKES]->(i:Item) RETURN count(i)",
+            "from_middle": "MATCH (b:Person) WITH b MATCH (a:Person)-[:FOLLOWS]->(b)-[:LIKES]->(i:Item) WHERE a.id = 7 RETURN count(i)",
+            "from_item": "MATCH (i:Item) WITH i MATCH (a:Person)-[:FOLLOWS]->(b:Person)-[:LIKES]->(i) WHERE a.id = 7 RETURN count(i)",
+        },
+    },
+    {
+        "name": "mutual_follow",
+        "query": "MATCH (a:Person)-[:FOLLOWS]->(b:Person)-[:FOLLOWS]->(a) WHERE b.id < 100 RETURN count(a)",
+        "alternatives": {
+            "from_a": "MATCH (a:Person) WITH a MATCH (a)-[:FOLLOWS]->(b:Person)-[:FOLLOWS]->(a) WHERE b.id < 100 RETURN count(a)",
+            "from_b": "MATCH (b:Person) WHERE b.id < 100 WITH b MATCH (a:Person)-[:FOLLOWS]->(b)-[:FOLLOWS]->(a) RETURN count(a)",
+        },
+    },
+]
+
+# draws a node index in [0, n), lower indices drawn far more often
+def zipf(rng, n, skew):
+    return min(n - 1, int(rng.paretovariate(skew)) - 1)
+
+def create_edges(con, rel, src, dest, edges):
+    for i in range(0, len(edges), 10000):
+        batch = edges[i:i + 10000]
+        con.execute_command("GRAPH.QUERY", GRAPH,
+                            "CYPHER edges=%s UNWIND $edges AS e MATCH (a:%s {id: e[0]}), (b:%s {id: e[1]}) "
+                            "CREATE (a)-[:%s]->(b)" % (json.dumps(batch), src, dest, rel))
+
+# Persons follow and like a few popular Persons and Items, a handful of Hubs
+# own most Items
+def populate(con, scale, skew, seed):
+    rng = random.Random(seed)
+    persons, items, hubs = 20000 * scale, 5000 * scale, 10
+
+    con.delete(GRAPH)
+    for label in ["Person", "Item", "Hub"]:
+        con.execute_command("GRAPH.QUERY", GRAPH, "CREATE INDEX ON :%s(id)" % label)
+    for label, count in [("Person", persons), ("Item", items), ("Hub", hubs)]:
+        for i in range(0, count, 10000):
+            con.execute_command("GRAPH.QUERY", GRAPH, "UNWIND range(%d, %d) AS x CREATE (:%s {id: x})" %
+                                (i, min(count, i + 10000) - 1, label))
+
+    follows = set()
+    for p in range(persons):
+        for _ in range(zipf(rng, 50, skew) + 1):
+            follows.add((p, zipf(rng, persons, skew)))
+    likes = set()
+    for p in range(persons):
+        for _ in range(zipf(rng, 20, skew) + 1):
+            likes.add((p, zipf(rng, items, skew)))
+    owns = [(zipf(rng, hubs, skew), i) for i in range(items)]
+
+    create_edges(con, "FOLLOWS", "Person", "Person", sorted(follows))
+    create_edges(con, "LIKES", "Person", "Item", sorted(likes))
+    create_edges(con, "OWNS", "Hub", "Item", owns)
+
+def qerror(estimate, actual):
+    estimate, actual = max(estimate, 1), max(actual, 1)
+    return max(estimate, actual) / min(estimate, actual)
+
+# parses GRAPH.PROFILE's reply into per operation estimates and actuals
+def profile(con, query):
+    operations = []
+    for line in con.execute_command("GRAPH.PROFILE", GRAPH, query):
+        actual = re.search(r"Records produced: (\d+)", line)
+        estimate = re.search(r"Estimated records: ([\d.]+)", line)
+        op = {"operation": line.split(" | ")[0].strip(), "actual": int(actual.group(1))}
+        if estimate:
+            op["estimate"] = float(estimate.group(1))
+            op["qerror"] = qerror(op["estimate"], op["actual"])
+        operations.append(op)
+    return operations
+
+# returns the query's result and its median internal execution time in milliseconds
+def execute(con, query, repeat):
+    times = []
+    for _ in range(repeat):
+        reply = con.execute_command("GRAPH.RO_QUERY", GRAPH, query)
+        stats = reply[-1]
+        times.append(float(next(s for s in stats if s.startswith("Query internal execution time"))
+                           .split(":")[1].split()[0]))
+    return reply[1], statistics.median(times)
+
+def run_entry(con, entry, repeat):
+    operations = profile(con, entry["query"])
+    result, chosen = execute(con, entry["query"], repeat)
+
+    errors = []
+    alternatives = {}
+    for name, query in entry["alternatives"].items():
+        alt_result, alternatives[name] = execute(con, query, repeat)
+        if alt_result != result:
+            errors.append("%s returned %s, expected %s" % (name, alt_result, result))
+
+    best = min(alternatives, key=alternatives.get)
+    qerrors = [op["qerror"] for op in operations if "qerror" in op]
+    return {
+        "Name": entry["name"],
+        "Query": entry["query"],
+        "Errors": errors,
+        "Operations": operations,
+        "MaxQError": max(qerrors, default=1),
+        "ChosenMs": chosen,
+        "AlternativesMs": alternatives,
+        "BestAlternative": best,
+        "Slowdown": chosen / max(alternatives[best], 0.001),
+    }
+
+@click.command()
+@click.option("--module", default=None, help="Path to redisgraph.so, starts a dedicated server")
+@click.option("--port", type=int, default=6379, help="Port of a running server, unless --module is set")
+@click.option("--scale", type=int, default=1, help="Graph size multiplier, 20000 persons and 5000 items each")
+@click.option("--skew", type=float, default=1.2, help="Pareto shape of degrees and popularity, lower is more skewed")
+@click.option("--seed", type=int, default=0, help="Graph generation seed")
+@click.option("--repeat", type=int, default=5, help="Executions per plan, their median time is reported")
+@click.option("--query", "names", multiple=True, help="Catalogue entry to run, can be repeated, defaults to all")
+@click.option("--max-slowdown", type=float, default=None,
+              help="KPI, chosen plan's time upper bound relative to its fastest alternative")
+@click.option("--max-qerror", type=float, default=None, help="KPI, operations' q-error upper bound")
+@click.option("--output", default=None, help="JSON results file")
+def main(module, port, scale, skew, seed, repeat, names, max_slowdown, max_qerror, output):
+    proc, workdir = None, None
+    if module:
+        proc, workdir, port = start_server(module)
+
+    entries = [e for e in CATALOGUE if not names or e["name"] in names]
+    try:
+        con = redis.Redis(port=port, decode_responses=True)
+        populate(con, scale, skew, seed)
+        results = [run_entry(con, entry, repeat) for entry in entries]
+    finally:
+        if proc:
+            proc.terminate()
+            proc.wait()
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    failures = []
+    for r in results:
+        click.echo("%s: chosen=%.3fms best=%s %.3fms slowdown=%.2fx max_qerror=%.1f" %
+                   (r["Name"], r["ChosenMs"], r["BestAlternative"], r["AlternativesMs"][r["BestAlternative"]],
+                    r["Slowdown"], r["MaxQError"]))
+        failures += ["%s: %s" % (r["Name"], e) for e in r["Errors"]]
+        if max_slowdown is not None and r["Slowdown"] > max_slowdown:
+            failures.append("%s: chosen plan %.2fx slower than %s" % (r["Name"], r["Slowdown"], r["BestAlternative"]))
+        if max_qerror is not None and r["MaxQError"] > max_qerror:
+            failures.append("%s: q-error %.1f exceeds %.1f" % (r["Name"], r["MaxQError"], max_qerror))
+
+    if output:
+        with open(output, "w") as f:
+            json.dump({"StartTime": int(time.time() * 1000), "Scale": scale, "Skew": skew,
+                       "Results": results}, f, indent=2)
+
+    for failure in failures:
+        click.echo("KPI failed, " + failure, err=True)
+    raise SystemExit(1 if failures else 0)
+
+if __name__ == "__main__":
+    main()
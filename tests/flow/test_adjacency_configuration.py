@@ -0,0 +1,88 @@
+import os
+import sys
+from RLTest import Env
+from redisgraph import Graph
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+
+from base import FlowTestsBase
+
+GRAPH_ID = "G"
+redis_con = None
+graph = None
+
+class testAdjacencyConfiguration(FlowTestsBase):
+    def __init__(self):
+        # instantiate a server which computes adjacency matrices on demand
+        self.env = Env(decodeResponses=True, moduleArgs="MAINTAIN_ADJACENCY no")
+        global redis_con
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # (v1)-[:R]->(v2)-[:S]->(v3), (v1)-[:S]->(v3), (v3)-[:R]->(v1)
+        graph.query("""CREATE (v1:L {val: 'v1'}), (v2:L {val: 'v2'}), (v3:L {val: 'v3'}),
+                       (v1)-[:R]->(v2), (v2)-[:S]->(v3), (v1)-[:S]->(v3), (v3)-[:R]->(v1)""")
+
+    def test01_config_get(self):
+        response = redis_con.execute_command("GRAPH.CONFIG GET MAINTAIN_ADJACENCY")
+        self.env.assertEqual(response, ["MAINTAIN_ADJACENCY", 0])
+
+    # typeless traversals are served by the on demand adjacency matrices
+    def test02_typeless_traversal(self):
+        query = """MATCH (a:L)-[]->(b) RETURN a.val, b.val ORDER BY a.val, b.val"""
+        result = graph.query(query)
+        expected_result = [['v1', 'v2'],
+                           ['v1', 'v3'],
+                           ['v2', 'v3'],
+                           ['v3', 'v1']]
+        self.env.assertEquals(result.result_set, expected_result)
+
+        query = """MATCH (a)<-[]-(b:L) RETURN a.val, b.val ORDER BY a.val, b.val"""
+        result = graph.query(query)
+        expected_result = [['v1', 'v3'],
+                           ['v2', 'v1'],
+                           ['v3', 'v1'],
+                           ['v3', 'v2']]
+        self.env.assertEquals(result.result_set, expected_result)
+
+        query = """MATCH (a {val: 'v1'})-[*2]->(b) RETURN b.val ORDER BY b.val"""
+        result = graph.query(query)
+        expected_result = [['v1'], ['v3']]
+        self.env.assertEquals(result.result_set, expected_result)
+
+    # edges of all types are collected without the adjacency matrix
+    def test03_node_edges(self):
+        query = """MATCH (a {val: 'v1'})-[e]-() RETURN type(e) ORDER BY type(e)"""
+        result = graph.query(query)
+        expected_result = [['R'], ['R'], ['S']]
+        self.env.assertEquals(result.result_set, expected_result)
+
+    # modifications are reflected by the adjacency matrices computed next
+    def test04_modifications(self):
+        query = """MATCH (a:L)-[]->(b) RETURN a.val, b.val ORDER BY a.val, b.val"""
+
+        graph.query("""MATCH (a {val: 'v2'}), (b {val: 'v1'}) CREATE (a)-[:T]->(b)""")
+        result = graph.query(query)
+        expected_result = [['v1', 'v2'],
+                           ['v1', 'v3'],
+                           ['v2', 'v1'],
+                           ['v2', 'v3'],
+                           ['v3', 'v1']]
+        self.env.assertEquals(result.result_set, expected_result)
+
+        graph.query("""MATCH ({val: 'v1'})-[e:S]->({val: 'v3'}) DELETE e""")
+        result = graph.query(query)
+        expected_result = [['v1', 'v2'],
+                           ['v2', 'v1'],
+                           ['v2', 'v3'],
+                           ['v3', 'v1']]
+        self.env.assertEquals(result.result_set, expected_result)
+
+        graph.query("""MATCH (n {val: 'v3'}) DELETE n""")
+        result = graph.query(query)
+        expected_result = [['v1', 'v2'],
+                           ['v2', 'v1']]
+        self.env.assertEquals(result.result_set, expected_result)
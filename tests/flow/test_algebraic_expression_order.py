@@ -88,3 +88,26 @@ class testAlgebraicExpressionOrder(FlowTestsBase):
         self.env.assertIn("Node By Label Scan | (b:B)", plan)
         result = graph.query(query)
         self.env.assertEquals(result.result_set, expected_result)
+
+    # Test that traversals start at the least populated label.
+    def test02_label_cardinality(self):
+        redis_con = self.env.getConnection()
+        g = Graph("AlgebraicExpressionOrderCardinality", redis_con)
+        g.query("UNWIND range(1, 100) AS x CREATE (:Many {v: x})")
+        g.query("UNWIND range(1, 2) AS x CREATE (:Few {v: x})")
+        g.query("MATCH (m:Many), (f:Few) WHERE m.v % 2 = f.v - 1 CREATE (m)-[:E]->(f)")
+
+        # Few is smaller than Many, start at Few although it is the destination.
+        query = """MATCH (m:Many)-[:E]->(f:Few) RETURN f.v, count(m) ORDER BY f.v"""
+        plan = g.execution_plan(query)
+        self.env.assertIn("Node By Label Scan | (f:Few)", plan)
+        result = g.query(query)
+        self.env.assertEquals(result.result_set, [[1, 50], [2, 50]])
+
+        # Few is the source.
+        query = """MATCH (f:Few)<-[:E]-(m:Many) WHERE m.v > 90 RETURN f.v, count(m) ORDER BY f.v"""
+        plan = g.execution_plan(query)
+        self.env.assertIn("Node By Label Scan | (f:Few)", plan)
+        result = g.query(query)
+        self.env.assertEquals(result.result_set, [[1, 5], [2, 5]])
+        g.delete()
@@ -0,0 +1,86 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "proc_write_back"
+graph = None
+redis_con = None
+
+class testAlgoWriteBack(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        global redis_con
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # two components {a, b, c} and {d, e}
+        q = """CREATE (a:P {v: 'a'}), (b:P {v: 'b'}), (c:P {v: 'c'}),
+                      (d:P {v: 'd'}), (e:P {v: 'e'}),
+                      (a)-[:R]->(b), (b)-[:R]->(c), (c)-[:R]->(a),
+                      (d)-[:R]->(e)"""
+        graph.query(q)
+
+    def test01_wcc_write(self):
+        q = """CALL algo.WCC.write('P', 'R', {writeProperty: 'component'})
+               YIELD nodePropertiesWritten, computeMillis, writeMillis
+               RETURN nodePropertiesWritten, computeMillis >= 0, writeMillis >= 0"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[5, True, True]])
+        self.env.assertEquals(result.properties_set, 5)
+
+        # written values match the algorithm's output
+        q = """CALL algo.WCC('P', 'R') YIELD node, componentId
+               RETURN count(node), sum(toInteger(node.component = componentId))"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[5, 5]])
+
+        # rewriting unchanged values sets no property
+        q = """CALL algo.WCC.write('P', 'R', {writeProperty: 'component'})
+               YIELD nodePropertiesWritten RETURN nodePropertiesWritten"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[5]])
+        self.env.assertEquals(result.properties_set, 0)
+
+    def test02_pagerank_write_forwards_config(self):
+        q = """CALL algo.pageRank.write('P', 'R', {writeProperty: 'rank', topK: 2})
+               YIELD nodePropertiesWritten RETURN nodePropertiesWritten"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[2]])
+
+        q = """MATCH (n:P) WHERE exists(n.rank) RETURN count(n)"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[2]])
+
+    def test03_write_updates_index(self):
+        graph.query("CREATE INDEX ON :P(community)")
+        q = """CALL algo.labelPropagation.write('P', 'R', {writeProperty: 'community'})
+               YIELD nodePropertiesWritten RETURN nodePropertiesWritten"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[5]])
+
+        q = """MATCH (d:P {v: 'd'}), (n:P) WHERE n.community = d.community
+               RETURN n.v ORDER BY n.v"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [['d'], ['e']])
+
+    def test04_invalid_calls(self):
+        queries = ["CALL algo.WCC.write('P', 'R') YIELD nodePropertiesWritten RETURN 1",
+                   "CALL algo.WCC.write('P', 'R', {writeProperty: 1}) YIELD nodePropertiesWritten RETURN 1",
+                   "CALL algo.WCC.write('P', 'R', {writeProperty: 'c', topK: 1}) YIELD nodePropertiesWritten RETURN 1"]
+        for q in queries:
+            try:
+                graph.query(q)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+        # write procedures modify the graph
+        try:
+            q = "CALL algo.WCC.write('P', 'R', {writeProperty: 'c'}) YIELD nodePropertiesWritten RETURN 1"
+            redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q)
+            self.env.assertTrue(False)
+        except Exception:
+            pass
@@ -0,0 +1,60 @@
+import time
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "aof_rewrite"
+redis_con = None
+
+# graphs are rewritten into the AOF as GRAPH.RESTORE commands, one per graph key
+
+class testAofRewrite(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True, useAof=True,
+                       moduleArgs='VKEY_MAX_ENTITY_COUNT 10')
+        global redis_con
+        redis_con = self.env.getConnection()
+        # rewrite the AOF by its commands rather than an RDB preamble
+        redis_con.config_set("aof-use-rdb-preamble", "no")
+
+    def _rewrite_and_load(self):
+        redis_con.execute_command("BGREWRITEAOF")
+        while redis_con.info("persistence")["aof_rewrite_in_progress"] or \
+              redis_con.info("persistence")["aof_rewrite_scheduled"]:
+            time.sleep(0.1)
+        redis_con.execute_command("DEBUG", "LOADAOF")
+
+    def test01_restore_graph(self):
+        graph = Graph(GRAPH_ID, redis_con)
+        graph.query("CREATE INDEX ON :L(v)")
+        graph.query("UNWIND range(0, 50) AS x CREATE (:L {v: x, s: 'str', a: [x, 1.5]})-[:R {w: x}]->(:M {p: point({latitude: 1.5, longitude: 2.5})})")
+        # multiple edges between the same pair of nodes
+        graph.query("MATCH (a:L {v: 0}), (b:M) WITH a, b LIMIT 1 CREATE (a)-[:R]->(b), (a)-[:R]->(b)")
+        # introduce deleted entities
+        deleted = graph.query("MATCH (n:L) WHERE n.v % 7 = 0 RETURN ID(n)").result_set
+        graph.query("MATCH (n:L) WHERE n.v % 7 = 0 DELETE n")
+
+        queries = ["MATCH (n) RETURN ID(n), labels(n), properties(n) ORDER BY ID(n)",
+                   "MATCH (a)-[e]->(b) RETURN ID(e), ID(a), ID(b), type(e), properties(e) ORDER BY ID(e)",
+                   "CALL db.indexes()"]
+        expected = [graph.query(q).result_set for q in queries]
+
+        self._rewrite_and_load()
+
+        for q, e in zip(queries, expected):
+            actual = graph.query(q).result_set
+            self.env.assertEquals(actual, e)
+
+        # indices are rebuilt
+        q = "MATCH (n:L {v: 3}) RETURN n.v"
+        self.env.assertIn("Index Scan", graph.execution_plan(q))
+        self.env.assertEquals(graph.query(q).result_set, [[3]])
+
+        # graph meta keys are not part of the keyspace
+        self.env.assertEquals(redis_con.keys("*"), [GRAPH_ID])
+
+        # deleted IDs are reused
+        created = graph.query("UNWIND range(0, 3) AS x CREATE (n:N) RETURN ID(n)").result_set
+        for row in created:
+            self.env.assertIn(row, deleted)
@@ -177,3 +177,51 @@ class testBFS(FlowTestsBase):
         actual_result = graph.query(query)
         self.env.assertEquals(actual_result.result_set, empty_result_set)
 
+
+    # Test BFS from multiple sources, streaming levels.
+    def test07_bfs_multiple_sources(self):
+        query = """MATCH (a {v: 'a'}), (d {v: 'd'}) CALL algo.BFS([a, d], 0, NULL)
+                   YIELD node, level RETURN node.v, level ORDER BY node.v"""
+        actual_result = graph.query(query)
+        # every node is reached at the depth of its closest source
+        expected_result = [['a', 0], ['b', 1], ['c', 2], ['d', 0], ['e', 1]]
+        self.env.assertEquals(actual_result.result_set, expected_result)
+
+        # arrays exclude the sources
+        query = """MATCH (a {v: 'a'}), (d {v: 'd'}) CALL algo.BFS([a, d], 1, NULL)
+                   YIELD nodes, edges RETURN [n IN nodes | n.v], [e IN edges | e.v]"""
+        actual_result = graph.query(query)
+        self.compare_unsorted_arrays(actual_result.result_set[0][0], ['b', 'e'])
+        self.compare_unsorted_arrays(actual_result.result_set[0][1], ['b', 'e'])
+
+    # Test BFS over a set of relationship types.
+    def test08_bfs_relationship_types(self):
+        query = """MATCH (a {v: 'a'}) CALL algo.BFS(a, 0, ['E1', 'E2'])
+                   YIELD nodes, edges RETURN [n IN nodes | n.v], [e IN edges | e.v]"""
+        actual_result = graph.query(query)
+        self.compare_unsorted_arrays(actual_result.result_set[0][0], ['b', 'c', 'd', 'e'])
+        self.compare_unsorted_arrays(actual_result.result_set[0][1], ['b', 'c', 'd', 'e'])
+
+        # unknown relationship types are ignored
+        query = """MATCH (a {v: 'a'}) CALL algo.BFS(a, 0, ['E1', 'NONE_EXISTING_RELATION'])
+                   YIELD node, level RETURN node.v, level ORDER BY node.v"""
+        actual_result = graph.query(query)
+        expected_result = [['a', 0], ['b', 1], ['c', 2]]
+        self.env.assertEquals(actual_result.result_set, expected_result)
+
+    # Test BFS with a cap on the nodes discovered per level.
+    def test09_bfs_level_cap(self):
+        query = """MATCH (b {v: 'b'}) CALL algo.BFS(b, 0, NULL, 1)
+                   YIELD node, level RETURN level, count(node) ORDER BY level"""
+        actual_result = graph.query(query)
+        # only c, the first of b's neighbors c and d, is discovered
+        # d is never traversed, such that e isn't reached
+        self.env.assertEquals(actual_result.result_set, [[0, 1], [1, 1]])
+
+    def test10_bfs_mixed_yields(self):
+        try:
+            query = """MATCH (a {v: 'a'}) CALL algo.BFS(a, 0, NULL) YIELD nodes, level RETURN level"""
+            graph.query(query)
+            self.env.assertTrue(False)
+        except Exception:
+            pass
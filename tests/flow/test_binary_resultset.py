@@ -0,0 +1,100 @@
+import struct
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "binary_resultset"
+redis_con = None
+redis_graph = None
+
+VALUE_UNKNOWN = 0
+VALUE_NULL = 1
+VALUE_STRING = 2
+VALUE_INTEGER = 3
+VALUE_BOOLEAN = 4
+VALUE_DOUBLE = 5
+
+# decodes a binary result-set into a list of rows
+def decode(buf):
+    offset = 0
+
+    def read(fmt):
+        nonlocal offset
+        v = struct.unpack_from(fmt, buf, offset)
+        offset += struct.calcsize(fmt)
+        return v[0]
+
+    def read_value(t):
+        nonlocal offset
+        if t == VALUE_INTEGER:
+            return read("<q")
+        if t == VALUE_DOUBLE:
+            return read("<d")
+        if t == VALUE_BOOLEAN:
+            return read("<B") != 0
+        if t == VALUE_STRING:
+            n = read("<I")
+            s = buf[offset:offset + n].decode()
+            offset += n
+            return s
+        return None
+
+    nrows = read("<Q")
+    ncols = read("<I")
+    columns = []
+    for _ in range(ncols):
+        t = read("<B")
+        nullable = read("<B")
+        bitmap = None
+        if nullable:
+            bitmap = buf[offset:offset + (nrows + 7) // 8]
+            offset += (nrows + 7) // 8
+
+        column = []
+        for i in range(nrows):
+            if t == VALUE_UNKNOWN:
+                column.append(read_value(read("<B")))
+            else:
+                v = read_value(t)
+                if bitmap is not None and bitmap[i // 8] & (1 << (i % 8)):
+                    v = None
+                column.append(v)
+        columns.append(column)
+
+    assert offset == len(buf)
+    return [list(row) for row in zip(*columns)]
+
+class testBinaryResultSet(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=False)
+        global redis_con
+        global redis_graph
+
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE ({i: x, d: x / 2.0, s: 'v' + toString(x), b: x % 2 = 0})")
+
+    def test01_scalar_columns(self):
+        q = "MATCH (n) RETURN n.i, n.d, n.s, n.b ORDER BY n.i"
+        res = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "--binary")
+        rows = decode(res[1])
+        expected = [[i, i / 2.0, 'v' + str(i), i % 2 == 0] for i in range(1, 11)]
+        self.env.assertEquals(rows, expected)
+
+    def test02_nulls_and_mixed_types(self):
+        q = "UNWIND [1, null, 3] AS x RETURN x, null, CASE WHEN x = 1 THEN 'a' ELSE x END"
+        res = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "--binary")
+        rows = decode(res[1])
+        self.env.assertEquals(rows, [[1, None, 'a'], [None, None, None], [3, None, 3]])
+
+    def test03_empty_result_set(self):
+        q = "MATCH (n) WHERE n.i > 100 RETURN n.i"
+        res = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "--binary")
+        self.env.assertEquals(decode(res[1]), [])
+
+    def test04_non_scalar_fallback(self):
+        # graph entities are emitted as compact rows
+        q = "MATCH (n) RETURN n LIMIT 2"
+        binary = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "--binary")
+        compact = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "--compact")
+        self.env.assertEquals(binary[1], compact[1])
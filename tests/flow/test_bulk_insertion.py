@@ -3,6 +3,7 @@ import os
 import sys
 import csv
 import time
+import struct
 import redis
 import threading
 from RLTest import Env
@@ -24,6 +25,28 @@ def run_bulk_loader(graphname, filename):
                                 '--nodes', filename,
                                 graphname])
 
+# binary blob encoders, see docs/bulk_spec.md
+def blob_header(name, keys):
+    blob = name.encode() + b'\0' + struct.pack('I', len(keys))
+    for key in keys:
+        blob += key.encode() + b'\0'
+    return blob
+
+def long_prop(v):
+    return struct.pack('=Bq', 4, v)
+
+def node_blob(start, end, label="L"):
+    blob = blob_header(label, ["v"])
+    for v in range(start, end):
+        blob += long_prop(v)
+    return blob
+
+def edge_blob(pairs, relation="R"):
+    blob = blob_header(relation, ["w"])
+    for src, dest in pairs:
+        blob += struct.pack('QQ', src, dest) + long_prop(src * 10)
+    return blob
+
 class testGraphBulkInsertFlow(FlowTestsBase):
     def __init__(self):
         self.env = Env(decodeResponses=True)
@@ -389,3 +412,55 @@ class testGraphBulkInsertFlow(FlowTestsBase):
         # Verify that at least one ping was issued
         self.env.assertGreater(ping_count, 1)
 
+
+    # Verify that pipelined batches are committed in order
+    def test10_pipelined_batches(self):
+        graphname = "tmpgraph6"
+
+        pipe = redis_con.pipeline(transaction=False)
+        pipe.execute_command("GRAPH.BULK", graphname, "BEGIN", 10, 0, 1, 0, node_blob(0, 10))
+        pipe.execute_command("GRAPH.BULK", graphname, 10, 9, 1, 1, node_blob(10, 20),
+                             edge_blob([(i, i + 1) for i in range(0, 18, 2)]))
+        for i in range(5):
+            pipe.execute_command("GRAPH.BULK", graphname, 2, 1, 1, 1,
+                                 node_blob(20 + i * 2, 22 + i * 2),
+                                 edge_blob([(20 + i * 2, 21 + i * 2)]))
+        replies = pipe.execute()
+
+        self.env.assertEquals(replies[0], "10 nodes created, 0 edges created")
+        self.env.assertEquals(replies[1], "10 nodes created, 9 edges created")
+
+        graph = Graph(graphname, redis_con)
+        res = graph.query("MATCH (n:L) RETURN count(n), min(n.v), max(n.v)")
+        self.env.assertEquals(res.result_set, [[30, 0, 29]])
+
+        # every edge connects consecutive nodes, IDs follow batch order
+        res = graph.query("MATCH (a:L)-[e:R]->(b:L) RETURN count(e), sum(b.v - a.v), sum(e.w - ID(a) * 10)")
+        self.env.assertEquals(res.result_set, [[14, 14, 0]])
+
+    # Verify that batches appended to an existing graph are indexed
+    def test11_append_to_indexed_graph(self):
+        graphname = "tmpgraph7"
+        graph = Graph(graphname, redis_con)
+        graph.query("UNWIND range(0, 9) AS x CREATE (:L {v: x})")
+        graph.query("CREATE INDEX ON :L(v)")
+        graph.query("CALL db.idx.edge.createIndex('R', 'w')")
+
+        # edges are listed out of order, connecting existing and appended nodes
+        pairs = [(12, 3), (1, 11), (5, 2), (1, 10), (0, 14)]
+        res = redis_con.execute_command("GRAPH.BULK", graphname, 5, 5, 1, 1,
+                                        node_blob(10, 15), edge_blob(pairs))
+        self.env.assertEquals(res, "5 nodes created, 5 edges created")
+
+        query = "MATCH (n:L) WHERE n.v >= 10 RETURN n.v ORDER BY n.v"
+        plan = graph.execution_plan(query)
+        self.env.assertIn("Index Scan", plan)
+        res = graph.query(query)
+        self.env.assertEquals(res.result_set, [[10], [11], [12], [13], [14]])
+
+        query = "MATCH (a)-[e:R]->(b) WHERE e.w = 10 RETURN a.v, b.v ORDER BY b.v"
+        res = graph.query(query)
+        self.env.assertEquals(res.result_set, [[1, 10], [1, 11]])
+
+        res = graph.query("MATCH (a)-[e:R]->(b) RETURN a.v, b.v ORDER BY a.v, b.v")
+        self.env.assertEquals(res.result_set, sorted([list(p) for p in pairs]))
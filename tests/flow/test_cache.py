@@ -1,3 +1,4 @@
+import time
 from RLTest import Env
 from redisgraph import Graph, Node, Edge
 
@@ -245,3 +246,71 @@ class testCache(FlowTestsBase):
         cached_result = graph.query(query, params)
         self.env.assertEqual(expected_result, cached_result.result_set)
         self.env.assertTrue(cached_result.cached_execution)
+
+    def test13_reused_plans(self):
+        # Repeated cache hits may reuse previously executed plans,
+        # these must observe modifications made in between.
+        graph = Graph('Cache_Reused_Plans', redis_con)
+        query = "MATCH (n:L) WHERE n.v > 0 RETURN n.v ORDER BY n.v DESC LIMIT 3"
+        for i in range(1, 6):
+            graph.query("CREATE (:L {v: %d})" % i)
+            # consecutive executions without writes in between
+            for _ in range(3):
+                result = graph.query(query)
+                expected = [[v] for v in range(i, max(i - 3, 0), -1)]
+                self.env.assertEqual(expected, result.result_set)
+
+        # aggregations start each execution from scratch
+        query = "MATCH (n:L) RETURN count(n), sum(n.v)"
+        for _ in range(3):
+            result = graph.query(query)
+            self.env.assertEqual([[5, 15]], result.result_set)
+            self.env.assertTrue(graph.query(query).cached_execution)
+
+    def test14_cached_write_queries(self):
+        # cached queries keep their access mode, resolved when first cached
+        graph = Graph('Cache_Write_Queries', redis_con)
+        query = "CREATE (:W {v: 1})"
+        for i in range(3):
+            result = graph.query(query)
+            self.env.assertEqual(result.nodes_created, 1)
+            self.env.assertEqual(result.cached_execution, i > 0)
+
+        # write queries are rejected by GRAPH.RO_QUERY on cache hits as well
+        for _ in range(2):
+            try:
+                redis_con.execute_command("GRAPH.RO_QUERY", 'Cache_Write_Queries', query)
+                assert(False)
+            except Exception as e:
+                self.env.assertIn("graph.RO_QUERY is to be executed only on read-only queries", str(e))
+
+        result = graph.query("MATCH (n:W) RETURN count(n)")
+        self.env.assertEqual([[3]], result.result_set)
+
+    def test15_cache_warmed_up_after_reload(self):
+        # queries hit at least once are saved and re-planned after load
+        graph_id = 'Cache_Warm_Up'
+        graph = Graph(graph_id, redis_con)
+        graph.query("CREATE (:L {v: 1})")
+        hot_query = "MATCH (n:L) RETURN n.v"
+        cold_query = "MATCH (n:L) RETURN count(n)"
+        for _ in range(3):
+            graph.query(hot_query)
+        graph.query(cold_query)
+
+        redis_con.execute_command("DEBUG", "RELOAD")
+
+        # queries are planned in the background, without executing them
+        cached = []
+        for _ in range(50):
+            reply = redis_con.execute_command("GRAPH.PLANSTATS", graph_id)
+            cached = [q for q, stats in reply]
+            if hot_query in cached:
+                break
+            time.sleep(0.1)
+        self.env.assertEqual(cached, [hot_query])
+
+        result = graph.query(hot_query)
+        self.env.assertTrue(result.cached_execution)
+        self.env.assertEqual([[1]], result.result_set)
+        self.env.assertFalse(graph.query(cold_query).cached_execution)
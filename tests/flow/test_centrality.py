@@ -0,0 +1,72 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+graph = None
+
+class testCentrality(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph("proc_centrality", redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # a diamond (a)->(b|c)->(d) followed by (d)->(e)
+        # and an (e)-[:S]->(a) edge of another type
+        q = """CREATE (a:P {v: 'a'}), (b:P {v: 'b'}), (c:P {v: 'c'}),
+                      (d:P {v: 'd'}), (e:P {v: 'e'}),
+                      (a)-[:R]->(b), (a)-[:R]->(c), (b)-[:R]->(d),
+                      (c)-[:R]->(d), (d)-[:R]->(e), (e)-[:S]->(a)"""
+        graph.query(q)
+
+    def test01_betweenness(self):
+        q = """CALL algo.betweenness('P', 'R', NULL) YIELD node, centrality
+               RETURN node.v, centrality ORDER BY node.v"""
+        result = graph.query(q)
+        expected = [['a', 0.0], ['b', 1.0], ['c', 1.0], ['d', 3.0], ['e', 0.0]]
+        self.env.assertEquals(result.result_set, expected)
+
+    def test02_sampled_betweenness(self):
+        # sampling every node is exact
+        q = """CALL algo.betweenness('P', 'R', 5) YIELD node, centrality
+               RETURN node.v, centrality ORDER BY node.v"""
+        result = graph.query(q)
+        expected = [['a', 0.0], ['b', 1.0], ['c', 1.0], ['d', 3.0], ['e', 0.0]]
+        self.env.assertEquals(result.result_set, expected)
+
+        # a sample still reports every node
+        q = """CALL algo.betweenness('P', 'R', 2) YIELD node, centrality
+               RETURN count(node), min(centrality) >= 0"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[5, True]])
+
+    def test03_closeness(self):
+        q = """CALL algo.closeness(NULL, 'R') YIELD node, closeness, harmonic
+               RETURN node.v, closeness, harmonic ORDER BY node.v"""
+        result = graph.query(q)
+        expected = [['a', 4 / 7, (1 + 1 + 1 / 2 + 1 / 3) / 4],
+                    ['b', 2 / 3, (1 + 1 / 2) / 4],
+                    ['c', 2 / 3, (1 + 1 / 2) / 4],
+                    ['d', 1.0, 1 / 4],
+                    ['e', 0.0, 0.0]]
+        self.env.assertEquals(len(result.result_set), len(expected))
+        for row, expected_row in zip(result.result_set, expected):
+            self.env.assertEquals(row[0], expected_row[0])
+            self.env.assertAlmostEqual(row[1], expected_row[1], 1e-6)
+            self.env.assertAlmostEqual(row[2], expected_row[2], 1e-6)
+
+    def test04_all_relationships(self):
+        # (e)->(a) closes a cycle, every node reaches every other node
+        q = """CALL algo.closeness(NULL, NULL) YIELD closeness
+               RETURN min(closeness) > 0"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[True]])
+
+    def test05_unknown_schema(self):
+        queries = ["CALL algo.betweenness('FAKE', NULL, NULL) YIELD node RETURN count(node)",
+                   "CALL algo.closeness(NULL, 'FAKE') YIELD node RETURN count(node)"]
+        for q in queries:
+            result = graph.query(q)
+            self.env.assertEquals(result.result_set, [[0]])
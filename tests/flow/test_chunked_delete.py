@@ -0,0 +1,73 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "chunked_delete"
+NODE_COUNT = 500
+redis_con = None
+redis_graph = None
+
+class testChunkedDelete(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+    def tearDown(self):
+        # restore unbounded deletions
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "DELETE_CHUNK_SIZE", 0)
+        redis_con.delete(GRAPH_ID)
+
+    def populate(self):
+        # a chain of nodes, each connected to its successor twice
+        q = """UNWIND range(1, %d) AS x CREATE (:N {v: x})""" % NODE_COUNT
+        redis_graph.query(q)
+        redis_graph.query("CREATE INDEX ON :N(v)")
+        q = """MATCH (a:N), (b:N) WHERE b.v = a.v + 1
+               CREATE (a)-[:R]->(b), (a)-[:R]->(b)"""
+        res = redis_graph.query(q)
+        self.env.assertEquals(res.relationships_created, (NODE_COUNT - 1) * 2)
+
+    def test01_default_chunk_size(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "DELETE_CHUNK_SIZE")
+        self.env.assertEquals(response[1], 0)
+
+    def test02_chunked_detach_delete(self):
+        self.populate()
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "DELETE_CHUNK_SIZE", 64)
+
+        # delete every other node, each node is matched multiple times
+        q = """MATCH (n:N)-[:R]-() WHERE n.v % 2 = 0 DETACH DELETE n"""
+        res = redis_graph.query(q)
+        self.env.assertEquals(res.nodes_deleted, NODE_COUNT // 2)
+        # each deleted node removes the edges to both of its neighbours
+        self.env.assertEquals(res.relationships_deleted, (NODE_COUNT - 1) * 2)
+
+        res = redis_graph.query("MATCH (n:N) RETURN count(n)")
+        self.env.assertEquals(res.result_set[0][0], NODE_COUNT // 2)
+        res = redis_graph.query("MATCH ()-[e:R]->() RETURN count(e)")
+        self.env.assertEquals(res.result_set[0][0], 0)
+
+        # deleted nodes were removed from the index
+        res = redis_graph.query("MATCH (n:N) WHERE n.v = 2 RETURN n")
+        self.env.assertEquals(len(res.result_set), 0)
+        res = redis_graph.query("MATCH (n:N) WHERE n.v = 3 RETURN n.v")
+        self.env.assertEquals(res.result_set[0][0], 3)
+
+    def test03_chunked_edge_delete(self):
+        self.populate()
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "DELETE_CHUNK_SIZE", 50)
+
+        # deleting both nodes and edges, some edges are removed implicitly
+        q = """MATCH (a:N)-[e:R]->(b:N) WHERE a.v <= 100 DELETE e
+               WITH a WHERE a.v <= 10 DELETE a"""
+        res = redis_graph.query(q)
+        self.env.assertEquals(res.nodes_deleted, 10)
+        self.env.assertEquals(res.relationships_deleted, 200)
+
+        res = redis_graph.query("MATCH (n:N) RETURN count(n)")
+        self.env.assertEquals(res.result_set[0][0], NODE_COUNT - 10)
+        res = redis_graph.query("MATCH ()-[e:R]->() RETURN count(e)")
+        self.env.assertEquals(res.result_set[0][0], (NODE_COUNT - 1 - 100) * 2)
@@ -0,0 +1,68 @@
+import os
+import sys
+from RLTest import Env
+from redisgraph import Graph, Node, Edge
+
+from base import FlowTestsBase
+
+GRAPH_ID = "columnar"
+redis_graph = None
+
+NODE_COUNT = 2000
+
+class testColumnarProperties(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        q = "UNWIND range(1, %d) AS x CREATE (:L {v: x, s: toString(x)})" % NODE_COUNT
+        redis_graph.query(q)
+        # node lacking attribute 'v'
+        redis_graph.query("CREATE (:L {s: 'none'})")
+
+    def expected_sum(self):
+        return NODE_COUNT * (NODE_COUNT + 1) / 2
+
+    def test01_repeated_scans(self):
+        # repeated scans over the same attribute switch to the columnar layout
+        # results must not be effected
+        q = "MATCH (n:L) RETURN sum(n.v), count(n.v), min(n.s)"
+        for i in range(4):
+            actual = redis_graph.query(q).result_set
+            self.env.assertEquals(actual, [[self.expected_sum(), NODE_COUNT, '1']])
+
+        q = "MATCH (n:L) WHERE n.v > %d RETURN count(n)" % (NODE_COUNT - 10)
+        for i in range(4):
+            actual = redis_graph.query(q).result_set
+            self.env.assertEquals(actual, [[10]])
+
+    def test02_updates_are_visible(self):
+        q = "MATCH (n:L) RETURN sum(n.v)"
+        for i in range(4):
+            redis_graph.query(q)
+
+        # update attribute, columns must be invalidated
+        redis_graph.query("MATCH (n:L) WHERE n.v = 1 SET n.v = 101")
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[self.expected_sum() + 100]])
+
+        # remove attribute
+        redis_graph.query("MATCH (n:L) WHERE n.v = 101 SET n.v = NULL")
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[self.expected_sum() - 1]])
+
+        # delete node
+        redis_graph.query("MATCH (n:L) WHERE n.v = 2 DELETE n")
+        for i in range(4):
+            actual = redis_graph.query(q).result_set
+            self.env.assertEquals(actual, [[self.expected_sum() - 3]])
+
+        # new nodes
+        redis_graph.query("CREATE (:L {v: 3})")
+        for i in range(4):
+            actual = redis_graph.query(q).result_set
+            self.env.assertEquals(actual, [[self.expected_sum()]])
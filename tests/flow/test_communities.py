@@ -0,0 +1,71 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+graph = None
+
+class testCommunities(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph("proc_communities", redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # two triangles of :P nodes bridged by an :B edge, and an isolated :Q node
+        # (a)->(b)->(c)->(a), (d)->(e)->(f)->(d), (c)-[:B]->(d)
+        q = """CREATE (a:P {v: 'a'}), (b:P {v: 'b'}), (c:P {v: 'c'}),
+                      (d:P {v: 'd'}), (e:P {v: 'e'}), (f:P {v: 'f'}),
+                      (:Q {v: 'q'}),
+                      (a)-[:R]->(b), (b)-[:R]->(c), (c)-[:R]->(a),
+                      (d)-[:R]->(e), (e)-[:R]->(f), (f)-[:R]->(d),
+                      (c)-[:B]->(d)"""
+        graph.query(q)
+
+    def groups(self, query):
+        # map each group to the sorted members sharing its ID
+        result = graph.query(query)
+        groups = {}
+        for row in result.result_set:
+            groups.setdefault(row[1], []).append(row[0])
+        return sorted(sorted(g) for g in groups.values())
+
+    def test01_wcc(self):
+        # edge direction is ignored
+        q = """CALL algo.WCC(NULL, 'R') YIELD node, componentId
+               RETURN node.v, componentId"""
+        self.env.assertEquals(self.groups(q),
+                              [['a', 'b', 'c'], ['d', 'e', 'f'], ['q']])
+
+        # any relationship type joins both triangles
+        q = """CALL algo.WCC(NULL, NULL) YIELD node, componentId
+               RETURN node.v, componentId"""
+        self.env.assertEquals(self.groups(q),
+                              [['a', 'b', 'c', 'd', 'e', 'f'], ['q']])
+
+        # restricted to a label
+        q = """CALL algo.WCC('P', 'B') YIELD node, componentId
+               RETURN node.v, componentId"""
+        self.env.assertEquals(self.groups(q),
+                              [['a'], ['b'], ['c', 'd'], ['e'], ['f']])
+
+        # components are named after their smallest member
+        q = """CALL algo.WCC('P', NULL) YIELD node, componentId
+               RETURN count(DISTINCT componentId), min(ID(node)) = min(componentId)"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[1, True]])
+
+    def test02_label_propagation(self):
+        # the bridge doesn't merge the two triangles
+        q = """CALL algo.labelPropagation('P', NULL) YIELD node, communityId
+               RETURN node.v, communityId"""
+        self.env.assertEquals(self.groups(q),
+                              [['a', 'b', 'c'], ['d', 'e', 'f']])
+
+    def test03_unknown_schema(self):
+        for proc in ['algo.WCC', 'algo.labelPropagation']:
+            for args in ["'FAKE', NULL", "NULL, 'FAKE'"]:
+                q = "CALL %s(%s) YIELD node RETURN count(node)" % (proc, args)
+                result = graph.query(q)
+                self.env.assertEquals(result.result_set, [[0]])
@@ -0,0 +1,46 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "compact"
+NODE_COUNT = 40000
+redis_con = None
+redis_graph = None
+
+class testCompact(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+    def test01_compact_preserves_ids(self):
+        redis_graph.query("UNWIND range(0, %d) AS x CREATE (:N {v: x})" % (NODE_COUNT - 1))
+        redis_graph.query("MATCH (a:N {v: 0}), (b:N {v: %d}) CREATE (a)-[:R]->(b)" % (NODE_COUNT - 1))
+
+        # delete all nodes but the first and the last
+        res = redis_graph.query("MATCH (n:N) WHERE n.v > 0 AND n.v < %d DELETE n" % (NODE_COUNT - 1))
+        self.env.assertEquals(res.nodes_deleted, NODE_COUNT - 2)
+
+        ids_before = redis_graph.query("MATCH (n:N) RETURN ID(n), n.v ORDER BY n.v").result_set
+
+        reply = redis_con.execute_command("GRAPH.COMPACT", GRAPH_ID)
+        self.env.assertContains("Graph compacted", reply)
+
+        # entities are intact
+        ids_after = redis_graph.query("MATCH (n:N) RETURN ID(n), n.v ORDER BY n.v").result_set
+        self.env.assertEquals(ids_before, ids_after)
+        res = redis_graph.query("MATCH (a:N)-[:R]->(b:N) RETURN a.v, b.v")
+        self.env.assertEquals(res.result_set, [[0, NODE_COUNT - 1]])
+
+        # freed IDs are reused lowest first
+        res = redis_graph.query("CREATE (n:N {v: -1}) RETURN ID(n)")
+        self.env.assertEquals(res.result_set[0][0], 1)
+
+    def test02_compact_missing_graph(self):
+        try:
+            redis_con.execute_command("GRAPH.COMPACT", "no_such_graph")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
@@ -1,5 +1,6 @@
 import os
 import sys
+import time
 import threading
 from RLTest import Env
 from redisgraph import Graph, Node, Edge
@@ -339,3 +340,56 @@ class testConcurrentQueryFlow(FlowTestsBase):
         for i in range(CLIENT_COUNT):
             self.env.assertIsNone(exceptions[i])
             self.env.assertEquals(1000, len(assertions[i].result_set))
+
+    def test_10_unrelated_keys_during_commit(self):
+        # A commit holds the graph's write lock, the GIL is only held briefly
+        # such that commands against unrelated keys proceed meanwhile.
+        global assertions
+        global exceptions
+        graphs[0].query("MATCH (n) RETURN n")
+        assertions[0] = None
+        exceptions[0] = None
+
+        # readers of the graph wait for the commit's write lock, each read
+        # records the interval it spent, long reads span the commit
+        reads = []
+        def read_graph():
+            while writer.is_alive():
+                start = time.time()
+                graphs[1].query("MATCH (n) RETURN count(n)")
+                reads.append((start, time.time()))
+
+        redis_con = self.env.getConnection()
+        heavy_write_query = """UNWIND(range(0,999999)) as x CREATE(n)"""
+        writer = threading.Thread(target=thread_run_query, args=(graphs[0], heavy_write_query, 0))
+        writer.setDaemon(True)
+        reader = threading.Thread(target=read_graph)
+        reader.setDaemon(True)
+        writer.start()
+        reader.start()
+
+        i = 0
+        sets = []
+        while writer.is_alive():
+            start = time.time()
+            redis_con.set("unrelated", i)
+            sets.append((start, time.time()))
+            self.env.assertEquals(int(redis_con.get("unrelated")), i)
+            i += 1
+        writer.join()
+        reader.join()
+
+        self.env.assertIsNone(exceptions[0])
+        self.env.assertEquals(1000000, assertions[0].nodes_created)
+
+        # a reader was held by the commit's write lock
+        blocked = [r for r in reads if r[1] - r[0] >= 0.2]
+        self.env.assertGreater(len(blocked), 0)
+
+        # while it was held, unrelated commands completed within a bound
+        during = [s for s in sets for r in blocked if r[0] <= s[0] and s[0] <= r[1]]
+        self.env.assertGreater(len(during), 0)
+        for s in during:
+            self.env.assertLess(s[1] - s[0], 0.1)
+
+        redis_con.delete("unrelated")
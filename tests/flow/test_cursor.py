@@ -0,0 +1,111 @@
+import redis
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "cursor_test"
+redis_con = None
+redis_graph = None
+NODE_COUNT = 250
+
+class testCursor(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, %d) AS x CREATE ({v: x})" % NODE_COUNT)
+
+    # read cursor batches until it is exhausted, returns all rows
+    def read_all(self, reply, count=None):
+        rows = reply[1]
+        cursor = reply[3]
+        while cursor != 0:
+            cmd = ["GRAPH.CURSOR", "READ", GRAPH_ID, cursor]
+            if count is not None:
+                cmd += ["COUNT", count]
+            reply = redis_con.execute_command(*cmd)
+            self.env.assertEquals(reply[0], ["n.v"])
+            if count is not None:
+                self.env.assertLessEqual(len(reply[1]), count)
+            rows += reply[1]
+            cursor = reply[3]
+        return rows
+
+    def test01_cursor_batches(self):
+        q = "MATCH (n) RETURN n.v ORDER BY n.v"
+        reply = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "CURSOR", "COUNT", 100)
+        # header, rows, statistics and cursor id
+        self.env.assertEquals(len(reply), 4)
+        self.env.assertEquals(reply[0], ["n.v"])
+        self.env.assertEquals(len(reply[1]), 100)
+        self.env.assertNotEqual(reply[3], 0)
+
+        rows = self.read_all(reply, 30)
+        self.env.assertEquals(rows, [[i] for i in range(1, NODE_COUNT + 1)])
+
+        # batch size defaults to the query's count
+        reply = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "CURSOR", "COUNT", 100)
+        rows = self.read_all(reply)
+        self.env.assertEquals(len(rows), NODE_COUNT)
+
+    def test02_small_result_set(self):
+        # a result-set fitting in the first batch doesn't leave a cursor behind
+        q = "MATCH (n) RETURN count(n)"
+        reply = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "CURSOR")
+        self.env.assertEquals(reply[1], [[NODE_COUNT]])
+        self.env.assertEquals(reply[3], 0)
+
+    def test03_delete_cursor(self):
+        q = "MATCH (n) RETURN n.v"
+        reply = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "CURSOR", "COUNT", 10)
+        cursor = reply[3]
+        self.env.assertEquals(redis_con.execute_command("GRAPH.CURSOR", "DEL", GRAPH_ID, cursor), "OK")
+
+        try:
+            redis_con.execute_command("GRAPH.CURSOR", "READ", GRAPH_ID, cursor)
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertContains("Cursor not found", str(e))
+
+    def test04_write_invalidates_cursor(self):
+        q = "MATCH (n) RETURN n.v"
+        reply = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "CURSOR", "COUNT", 10)
+        cursor = reply[3]
+
+        redis_graph.query("CREATE ({v: 0})")
+
+        try:
+            redis_con.execute_command("GRAPH.CURSOR", "READ", GRAPH_ID, cursor)
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertContains("Cursor invalidated by a concurrent write", str(e))
+
+        # invalidated cursors are discarded
+        try:
+            redis_con.execute_command("GRAPH.CURSOR", "READ", GRAPH_ID, cursor)
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertContains("Cursor not found", str(e))
+
+    def test05_invalid_cursor_usage(self):
+        # cursors are restricted to read-only queries
+        try:
+            redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, "CREATE ()", "CURSOR")
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertContains("CURSOR is supported only for read-only queries", str(e))
+
+        try:
+            redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, "MATCH (n) RETURN n", "CURSOR", "COUNT", 0)
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertContains("Failed to parse cursor count value", str(e))
+
+        try:
+            redis_con.execute_command("GRAPH.CURSOR", "READ", GRAPH_ID, 123456)
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertContains("Cursor not found", str(e))
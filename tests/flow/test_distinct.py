@@ -190,3 +190,34 @@ class testDistinct(FlowTestsBase):
         actual_result = graph3.query(query)
         expected_result = [[None]]
         self.env.assertEquals(actual_result.result_set, expected_result)
+
+    def test_distinct_large_input(self):
+        global graph3
+        # grow the fingerprint table well past its initial capacity
+        query = """UNWIND range(0, 99999) AS x RETURN DISTINCT x % 10000 AS v"""
+        actual_result = graph3.query(query)
+        self.env.assertEquals(len(actual_result.result_set), 10000)
+
+        # numeric values of different types are considered equal
+        query = """UNWIND [1, 1.0, 2, 2.0, 2.5] AS x RETURN DISTINCT x"""
+        actual_result = graph3.query(query)
+        self.env.assertEquals(len(actual_result.result_set), 3)
+
+    def test_distinct_sorted_input(self):
+        global graph3
+        # input ordered by the distinct keys only compares adjacent records
+        query = """UNWIND [3, 1, 2, 1, 3, 3, null, null] AS x WITH x ORDER BY x WITH DISTINCT x RETURN x"""
+        actual_result = graph3.query(query)
+        expected_result = [[1], [2], [3], [None]]
+        self.env.assertEquals(actual_result.result_set, expected_result)
+
+        query = """UNWIND range(0, 20) AS x WITH x % 3 AS a, x % 2 AS b ORDER BY b, a WITH DISTINCT a, b RETURN a, b"""
+        actual_result = graph3.query(query)
+        expected_result = [[0, 0], [1, 0], [2, 0], [0, 1], [1, 1], [2, 1]]
+        self.env.assertEquals(actual_result.result_set, expected_result)
+
+        # distinct keys which aren't the leading sort keys may be apart
+        query = """UNWIND range(0, 20) AS x WITH x % 3 AS a, x % 2 AS b ORDER BY b, a WITH DISTINCT a RETURN a ORDER BY a"""
+        actual_result = graph3.query(query)
+        expected_result = [[0], [1], [2]]
+        self.env.assertEquals(actual_result.result_set, expected_result)
@@ -0,0 +1,91 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "edge_weights"
+redis_con = None
+redis_graph = None
+
+class testEdgeWeights(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+        # accounts connected by transfers, consecutive accounts by two
+        # parallel transfers of different amounts
+        redis_graph.query("UNWIND range(0, 19) AS x CREATE (:A {v: x})")
+        redis_graph.query("""MATCH (a:A), (b:A) WHERE b.v = (a.v + 1) % 20
+                             CREATE (a)-[:TX {amount: a.v * 10}]->(b),
+                                    (a)-[:TX {amount: a.v * 10 + 5}]->(b)""")
+        redis_graph.query("""MATCH (a:A), (b:A) WHERE b.v = (a.v + 7) % 20
+                             CREATE (a)-[:TX {amount: 'n/a'}]->(b)""")
+
+    # returns true if the query's traversal is restricted by weight matrices
+    def filtered(self, query):
+        profile = redis_con.execute_command("GRAPH.PROFILE", GRAPH_ID, query)
+        return any("Weight filtered" in op for op in profile)
+
+    def run(self, query, params=None):
+        return redis_graph.query(query, params).result_set
+
+    def test01_filter(self):
+        queries = ["MATCH (a:A)-[e:TX]->(b) WHERE e.amount > 150 RETURN a.v, e.amount, b.v ORDER BY e.amount",
+                   "MATCH (a:A)-[e:TX]->(b) WHERE e.amount >= 45 AND e.amount < 60 RETURN a.v, e.amount, b.v ORDER BY e.amount",
+                   "MATCH (a:A)-[e:TX]->(b) WHERE e.amount = 35 RETURN a.v, e.amount, b.v",
+                   "MATCH (a:A)<-[e:TX]-(b) WHERE 20 >= e.amount RETURN a.v, e.amount, b.v ORDER BY e.amount"]
+
+        expected = [self.run(q) for q in queries]
+        redis_graph.query("CALL db.idx.weight.create('TX', 'amount')")
+
+        for q, e in zip(queries, expected):
+            self.env.assertEquals(self.run(q), e)
+            self.env.assertTrue(self.filtered(q))
+
+        self.env.assertEquals(self.run(queries[2]), [[3, 35, 4]])
+
+    def test02_parameters(self):
+        query = "MATCH (a:A)-[e:TX]->(b) WHERE e.amount <= $amount RETURN count(e)"
+        res = self.run(query, {'amount': 15})
+        self.env.assertEquals(res, [[4]])
+        self.env.assertTrue(self.filtered("CYPHER amount=15 " + query))
+
+    def test03_unsupported_filters(self):
+        queries = ["MATCH (a:A)-[e:TX]->(b) WHERE e.amount > 150 OR e.amount < 10 RETURN count(e)",
+                   "MATCH (a:A)-[e:TX]-(b) WHERE e.amount > 150 RETURN count(e)",
+                   "MATCH (a:A)-[e:TX]->(b) WHERE e.amount > b.v RETURN count(e)"]
+        for q in queries:
+            self.env.assertFalse(self.filtered(q))
+
+    def test04_updates(self):
+        query = "MATCH (a:A)-[e:TX]->(b) WHERE e.amount > 1000 RETURN a.v, b.v"
+        self.env.assertEquals(self.run(query), [])
+
+        # modifications are reflected by the next read
+        redis_graph.query("MATCH (a:A {v: 0})-[e:TX {amount: 5}]->() SET e.amount = 5000")
+        self.env.assertEquals(self.run(query), [[0, 1]])
+
+        redis_graph.query("MATCH (a:A {v: 2}), (b:A {v: 9}) CREATE (a)-[:TX {amount: 2000}]->(b)")
+        self.env.assertEquals(self.run(query + " ORDER BY a.v"), [[0, 1], [2, 9]])
+
+        redis_graph.query("MATCH ()-[e:TX {amount: 5000}]->() DELETE e")
+        self.env.assertEquals(self.run(query), [[2, 9]])
+
+        # writing queries aren't weight filtered
+        q = "MATCH (a:A)-[e:TX]->(b) WHERE e.amount > 1000 SET e.amount = 1000"
+        self.env.assertFalse(self.filtered(q))
+        self.env.assertEquals(self.run(query), [])
+
+    def test05_drop(self):
+        redis_graph.query("CALL db.idx.weight.drop('TX')")
+        query = "MATCH (a:A)-[e:TX]->(b) WHERE e.amount > 150 RETURN count(e)"
+        self.env.assertFalse(self.filtered(query))
+
+        try:
+            redis_graph.query("CALL db.idx.weight.create('NONE', 'amount')")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("unknown relationship type", str(e))
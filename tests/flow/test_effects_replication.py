@@ -0,0 +1,65 @@
+import time
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "effects_replication"
+
+# write queries are replicated by their effects when REPLICATE_EFFECTS is on
+# replicas must end up with the same graph, entity IDs included
+
+class testEffectsReplication(FlowTestsBase):
+    def __init__(self):
+        # skip test if we're running under Valgrind
+        if Env().envRunner.debugger is not None:
+            Env().skip() # valgrind is not working correctly with replication
+
+        self.env = Env(decodeResponses=True, env='oss', useSlaves=True,
+                       moduleArgs="REPLICATE_EFFECTS yes")
+        self.source_con = self.env.getConnection()
+        self.replica_con = self.env.getSlaveConnection()
+        # enable write commands on slave, required as all RedisGraph
+        # commands are registered as write commands
+        self.replica_con.config_set("slave-read-only", "no")
+        self.graph = Graph(GRAPH_ID, self.source_con)
+        self.replica = Graph(GRAPH_ID, self.replica_con)
+
+    def _assert_in_sync(self):
+        # give replica some time to catch up
+        time.sleep(1)
+
+        queries = ["MATCH (n) RETURN ID(n), labels(n), properties(n) ORDER BY ID(n)",
+                   "MATCH ()-[e]->() RETURN ID(e), type(e), properties(e) ORDER BY ID(e)",
+                   "CALL db.indexes()"]
+        for q in queries:
+            result = self.graph.query(q).result_set
+            replica_result = self.replica.query(q).result_set
+            self.env.assertEquals(replica_result, result)
+
+    def test01_create(self):
+        self.graph.query("CREATE INDEX ON :L(v)")
+        self.graph.query("CREATE (:L {v: 1, s: 'a string longer than inline', a: [1, 2.5, 'x', true]})")
+        self.graph.query("UNWIND range(0, 2000) AS x CREATE (:L {v: x})-[:R {w: x}]->(:M {p: point({latitude: 1.5, longitude: 2.5})})")
+        self._assert_in_sync()
+
+    def test02_update(self):
+        self.graph.query("MATCH (n:L) WHERE n.v % 3 = 0 SET n.v = -n.v, n.s = NULL")
+        self.graph.query("MATCH ()-[e:R]->() WHERE e.w < 10 SET e.w = 'updated'")
+        self.graph.query("MERGE (n:L {v: 5}) ON MATCH SET n.merged = true")
+        self.graph.query("MERGE (n:L {v: 99999}) ON CREATE SET n.created = true")
+        self._assert_in_sync()
+
+        # updates are reflected by the replica's indices
+        q = "MATCH (n:L {v: -3}) RETURN n.v"
+        self.env.assertIn("Index Scan", self.replica.execution_plan(q))
+        self.env.assertEquals(self.replica.query(q).result_set, [[-3]])
+
+    def test03_delete(self):
+        self.graph.query("MATCH (n:L) WHERE n.v < 0 DELETE n")
+        self.graph.query("MATCH ()-[e:R]->() WHERE e.w > 1000 DELETE e")
+        self._assert_in_sync()
+
+        # deleted IDs are reused identically by both
+        self.graph.query("UNWIND range(0, 10) AS x CREATE (:N {x: x})")
+        self._assert_in_sync()
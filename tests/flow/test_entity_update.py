@@ -51,3 +51,24 @@ class testEntityUpdate(FlowTestsBase):
         expected_result = [[1, 'Calgary']]
         self.env.assertEqual(result.properties_set, 1)
         self.env.assertEqual(result.result_set, expected_result)
+
+    def test06_repeated_updates(self):
+        # the same attribute is updated once per record, last update wins
+        # each update which changes the attribute's value is reported
+        result = graph.query("MATCH (n) UNWIND [5, 5, 6, 7] AS x SET n.v = x RETURN n.v")
+        self.env.assertEqual(result.properties_set, 3)
+        self.env.assertEqual(result.result_set, [[7], [7], [7], [7]])
+
+        # updates ending at the original value still report their changes
+        result = graph.query("MATCH (n) UNWIND [8, 7] AS x SET n.v = x")
+        self.env.assertEqual(result.properties_set, 2)
+        result = graph.query("MATCH (n) RETURN n.v")
+        self.env.assertEqual(result.result_set, [[7]])
+
+        # removing and restoring an attribute
+        result = graph.query("MATCH (n) UNWIND [NULL, NULL, 1] AS x SET n.y = x")
+        self.env.assertEqual(result.properties_set, 1)
+        result = graph.query("MATCH (n) UNWIND [NULL, 2] AS x SET n.y = x")
+        self.env.assertEqual(result.properties_set, 2)
+        result = graph.query("MATCH (n) RETURN n.y")
+        self.env.assertEqual(result.result_set, [[2]])
@@ -0,0 +1,78 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "expand_intersect"
+NODE_COUNT = 30
+redis_con = None
+redis_graph = None
+edges = set()
+
+class testExpandIntersect(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        for i in range(NODE_COUNT):
+            for j in [(i + 1) % NODE_COUNT, (i * 7 + 3) % NODE_COUNT, (i * i) % NODE_COUNT]:
+                if i != j:
+                    edges.add((i, j))
+
+        redis_graph.query("UNWIND range(0, %d) AS x CREATE (:N {v: x})" % (NODE_COUNT - 1))
+        pairs = [[a, b] for (a, b) in edges]
+        redis_graph.query("""UNWIND $pairs AS p
+                             MATCH (a:N {v: p[0]}), (b:N {v: p[1]})
+                             CREATE (a)-[:R]->(b)""", {'pairs': pairs})
+
+    def expected_triangles(self):
+        return sorted([[a, b, c] for (a, b) in edges for (x, c) in edges
+                       if x == b and (c, a) in edges])
+
+    def test01_triangles(self):
+        query = """MATCH (a:N)-[:R]->(b:N)-[:R]->(c:N)-[:R]->(a)
+                   RETURN a.v, b.v, c.v ORDER BY a.v, b.v, c.v"""
+        plan = redis_graph.execution_plan(query)
+        self.env.assertIn("Expand Intersect", plan)
+        self.env.assertNotIn("Expand Into", plan)
+
+        expected = self.expected_triangles()
+        self.env.assertGreater(len(expected), 0)
+        result = redis_graph.query(query)
+        self.env.assertEquals(result.result_set, expected)
+
+    def test02_referenced_edge(self):
+        # referenced edges are not collected by the intersection,
+        # their traversals must be left in place
+        query = """MATCH (a:N)-[:R]->(b:N)-[:R]->(c:N)-[e:R]->(a)
+                   RETURN a.v, b.v, c.v, type(e) ORDER BY a.v, b.v, c.v"""
+
+        expected = [row + ['R'] for row in self.expected_triangles()]
+        result = redis_graph.query(query)
+        self.env.assertEquals(result.result_set, expected)
+
+    def test03_closing_edge_direction(self):
+        # the closing edge points away from the newly bound node
+        query = """MATCH (a:N)-[:R]->(b:N)-[:R]->(c:N)<-[:R]-(a)
+                   RETURN a.v, b.v, c.v ORDER BY a.v, b.v, c.v"""
+        plan = redis_graph.execution_plan(query)
+        self.env.assertIn("Expand Intersect", plan)
+
+        expected = sorted([[a, b, c] for (a, b) in edges for (x, c) in edges
+                           if x == b and (a, c) in edges])
+        result = redis_graph.query(query)
+        self.env.assertEquals(result.result_set, expected)
+
+    def test04_cycle_count_with_limit(self):
+        expected = self.expected_triangles()
+        query = """MATCH (a:N)-[:R]->(b:N)-[:R]->(c:N)-[:R]->(a) RETURN count(c)"""
+        result = redis_graph.query(query)
+        self.env.assertEquals(result.result_set[0][0], len(expected))
+
+        query = """MATCH (a:N)-[:R]->(b:N)-[:R]->(c:N)-[:R]->(a) RETURN c LIMIT 1"""
+        result = redis_graph.query(query)
+        self.env.assertEquals(len(result.result_set), 1)
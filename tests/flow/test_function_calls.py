@@ -382,3 +382,66 @@ class testFunctionCallsFlow(FlowTestsBase):
         expected_result = [['STR1', [1, 2, 3]],
                            ['STR2', [1, 2, 3]]]
         self.env.assertEquals(actual_result.result_set, expected_result)
+
+    # Large inputs are aggregated in parallel and merged.
+    def test19_parallel_aggregation(self):
+        g = Graph("parallel_aggregation", redis_con)
+        n = 40000
+        g.query("UNWIND range(0, %d) AS x CREATE (:P {g: x %% 7, v: x})" % (n - 1))
+
+        query = """MATCH (p:P) RETURN p.g AS g, count(p), sum(p.v), min(p.v), max(p.v), avg(p.v) ORDER BY g"""
+        actual_result = g.query(query)
+        expected_result = []
+        for k in range(7):
+            values = [x for x in range(n) if x % 7 == k]
+            expected_result.append([k, len(values), sum(values), min(values),
+                                    max(values), sum(values) / len(values)])
+        self.env.assertEquals(actual_result.result_set, expected_result)
+
+        # Keys projected by a previous clause.
+        query = """UNWIND range(0, %d) AS x WITH x %% 3 AS k, x RETURN k, count(x), sum(x) ORDER BY k""" % (n - 1)
+        actual_result = g.query(query)
+        expected_result = []
+        for k in range(3):
+            values = [x for x in range(n) if x % 3 == k]
+            expected_result.append([k, len(values), sum(values)])
+        self.env.assertEquals(actual_result.result_set, expected_result)
+
+        # Type errors are still reported.
+        try:
+            g.query("""MATCH (p:P) WITH p, 'a' AS s RETURN sum(s)""")
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertIn("Type mismatch", str(e))
+        g.delete()
+
+    def test20_approximate_aggregations(self):
+        # Small inputs are counted exactly.
+        query = """UNWIND [1, 2, 2, 3, 'a', 'a', NULL] AS x RETURN approxCountDistinct(x)"""
+        actual_result = graph.query(query)
+        self.env.assertEquals(actual_result.result_set, [[4]])
+
+        query = """UNWIND range(1, 100000) AS x RETURN approxCountDistinct(x % 50000)"""
+        actual_result = graph.query(query)
+        estimate = actual_result.result_set[0][0]
+        self.env.assertLess(abs(estimate - 50000), 50000 * 0.03)
+
+        # Exact while every value is a centroid of its own.
+        query = """UNWIND range(1, 10) AS x RETURN approxPercentile(x, 0.5)"""
+        actual_result = graph.query(query)
+        self.env.assertEquals(actual_result.result_set, [[5.5]])
+
+        query = """UNWIND range(0, 99999) AS x RETURN approxPercentile(x, 0.9)"""
+        actual_result = graph.query(query)
+        estimate = actual_result.result_set[0][0]
+        self.env.assertLess(abs(estimate - 90000), 100000 * 0.01)
+
+        query = """UNWIND [] AS x RETURN approxPercentile(x, 0.5)"""
+        actual_result = graph.query(query)
+        self.env.assertEquals(actual_result.result_set, [[None]])
+
+        try:
+            graph.query("""UNWIND range(1, 10) AS x RETURN approxPercentile(x, 1.5)""")
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertIn("must be a number in the range 0.0 to 1.0", str(e))
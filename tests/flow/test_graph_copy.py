@@ -0,0 +1,59 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+SRC_ID = "copy_src"
+DST_ID = "copy_dst"
+redis_con = None
+
+class testGraphCopy(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        redis_con = self.env.getConnection()
+
+    def test01_copy_graph(self):
+        src = Graph(SRC_ID, redis_con)
+        src.query("CREATE INDEX ON :L(v)")
+        src.query("UNWIND range(0, 100) AS x CREATE (:L {v: x, s: 'str'})-[:R {w: x}]->(:M {a: [x, 1.5]})")
+        # multiple edges between the same pair of nodes
+        src.query("MATCH (a:L {v: 0})-[:R]->(b:M) CREATE (a)-[:R]->(b)")
+        src.query("MATCH (n:L) WHERE n.v % 9 = 0 DELETE n")
+
+        queries = ["MATCH (n) RETURN ID(n), labels(n), properties(n) ORDER BY ID(n)",
+                   "MATCH (a)-[e]->(b) RETURN ID(e), ID(a), ID(b), type(e), properties(e) ORDER BY ID(e)",
+                   "CALL db.indexes()"]
+        expected = [src.query(q).result_set for q in queries]
+
+        self.env.assertEquals(redis_con.execute_command("GRAPH.COPY", SRC_ID, DST_ID), "OK")
+
+        dst = Graph(DST_ID, redis_con)
+        for q, e in zip(queries, expected):
+            self.env.assertEquals(dst.query(q).result_set, e)
+
+        # indices are rebuilt
+        q = "MATCH (n:L {v: 3}) RETURN n.v"
+        self.env.assertIn("Index Scan", dst.execution_plan(q))
+        self.env.assertEquals(dst.query(q).result_set, [[3]])
+
+        # graphs are independent of one another
+        dst.query("MATCH (n:M) DETACH DELETE n")
+        for q, e in zip(queries, expected):
+            self.env.assertEquals(src.query(q).result_set, e)
+
+    def test02_copy_errors(self):
+        # existing destination
+        try:
+            redis_con.execute_command("GRAPH.COPY", SRC_ID, DST_ID)
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("already exists", str(e))
+
+        # missing source
+        try:
+            redis_con.execute_command("GRAPH.COPY", "no_such_graph", "copy_new")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("empty key", str(e))
+        self.env.assertFalse(redis_con.exists("copy_new"))
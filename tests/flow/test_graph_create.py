@@ -102,3 +102,35 @@ class testGraphCreationFlow(FlowTestsBase):
 
         self.env.assertEquals(result.nodes_created, 1)
         self.env.assertEquals(result.result_set, expected_result)
+
+    def test07_create_in_bulk(self):
+        # Large creations label nodes and form connections in bulk.
+        graph = Graph("bulk_create", self.env.getConnection())
+        query = """UNWIND range(0, 4999) AS x
+                   CREATE (a:A {v: x})-[:R {v: x}]->(b:B {v: x}), (a)-[:S]->(b)"""
+        result = graph.query(query)
+        self.env.assertEquals(result.nodes_created, 10000)
+        self.env.assertEquals(result.relationships_created, 10000)
+
+        result = graph.query("MATCH (a:A) RETURN count(a)")
+        self.env.assertEquals(result.result_set, [[5000]])
+        result = graph.query("MATCH (b:B) RETURN count(b)")
+        self.env.assertEquals(result.result_set, [[5000]])
+
+        # Every edge connects the nodes it was created with.
+        result = graph.query("MATCH (a:A)-[r:R]->(b:B) WHERE a.v = r.v AND b.v = r.v RETURN count(r)")
+        self.env.assertEquals(result.result_set, [[5000]])
+        result = graph.query("MATCH (:A {v: 7})-[:S]->(b) RETURN b.v")
+        self.env.assertEquals(result.result_set, [[7]])
+        result = graph.query("MATCH (b:B {v: 7})<-[e]-() RETURN count(e)")
+        self.env.assertEquals(result.result_set, [[2]])
+
+        # Bulk creations extend previously created labels and relations.
+        query = """MATCH (b:B) WHERE b.v < 2000 CREATE (b)-[:R]->(:A {v: -1})"""
+        result = graph.query(query)
+        self.env.assertEquals(result.nodes_created, 2000)
+        self.env.assertEquals(result.relationships_created, 2000)
+        result = graph.query("MATCH (:B)-[:R]->(a:A) RETURN count(a)")
+        self.env.assertEquals(result.result_set, [[2000]])
+        result = graph.query("MATCH (a:A) RETURN count(a)")
+        self.env.assertEquals(result.result_set, [[7000]])
@@ -0,0 +1,151 @@
+import os
+import sys
+import time
+from RLTest import Env
+from redisgraph import Graph
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+
+from base import FlowTestsBase
+
+GRAPH_ID = "eviction"
+OTHER_GRAPH_ID = "eviction_other"
+redis_con = None
+graph = None
+other_graph = None
+
+QUERIES = ["MATCH (n) RETURN ID(n), labels(n), properties(n) ORDER BY ID(n)",
+           "MATCH (a)-[e]->(b) RETURN ID(e), ID(a), ID(b), type(e), properties(e) ORDER BY ID(e)",
+           "CALL db.indexes()"]
+
+class testGraphEviction(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global graph
+        global other_graph
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        other_graph = Graph(OTHER_GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def tearDown(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_MEMORY_BUDGET", "0")
+
+    def populate_graph(self):
+        graph.query("CREATE INDEX ON :L(v)")
+        graph.query("UNWIND range(0, 50) AS x CREATE (:L {v: x, s: 'str', a: [x, 1.5]})-[:R {w: x}]->(:M {v: x})")
+        # multiple edges between the same pair of nodes
+        graph.query("MATCH (a:L {v: 0})-[:R]->(b:M) CREATE (a)-[:R]->(b)")
+        # introduce deleted entities
+        graph.query("MATCH (n:L) WHERE n.v % 7 = 0 DELETE n")
+        other_graph.query("UNWIND range(0, 10) AS x CREATE (:N {v: x})")
+
+    # returns the module INFO field ending with 'name'
+    # redis prefixes module fields by the module name
+    def info_field(self, name):
+        info = redis_con.info("everything")
+        for key in info:
+            if key.endswith(name):
+                return info[key]
+        return None
+
+    # returns the graph's version, reported by a query issued with
+    # a mismatched version
+    def graph_version(self):
+        res = redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, "RETURN 1", "version", 0)
+        return int(res[1])
+
+    # evict every graph, waiting for 'count' graphs to be evicted
+    # graphs mustn't be accessed while waiting, accessing a graph reloads it
+    def evict(self, count, timeout=10):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_MEMORY_BUDGET", "1")
+        deadline = time.time() + timeout
+        while self.info_field("evicted_graphs") < count and time.time() < deadline:
+            time.sleep(0.1)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_MEMORY_BUDGET", "0")
+        self.env.assertEquals(self.info_field("evicted_graphs"), count)
+
+    def test01_config(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "GRAPH_MEMORY_BUDGET")
+        self.env.assertEquals(response, ["GRAPH_MEMORY_BUDGET", 0])
+
+        for invalid in ["-1", "a"]:
+            try:
+                redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_MEMORY_BUDGET", invalid)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+        # an unlimited budget evicts nothing
+        self.env.assertEquals(self.info_field("evicted_graphs"), 0)
+
+    def test02_reload(self):
+        expected = [graph.query(q).result_set for q in QUERIES]
+        version = self.graph_version()
+
+        evictions = self.info_field("graph_evictions")
+        self.evict(2)
+        self.env.assertEquals(self.info_field("graph_evictions"), evictions + 2)
+
+        # graphs are reloaded as they're accessed
+        for q, e in zip(QUERIES, expected):
+            self.env.assertEquals(graph.query(q).result_set, e)
+        self.env.assertEquals(self.info_field("evicted_graphs"), 1)
+
+        result = other_graph.query("MATCH (n:N) RETURN count(n)")
+        self.env.assertEquals(result.result_set, [[11]])
+        self.env.assertEquals(self.info_field("evicted_graphs"), 0)
+
+        # indices are rebuilt
+        q = "MATCH (n:L {v: 3}) RETURN n.v"
+        self.env.assertIn("Index Scan", graph.execution_plan(q))
+        self.env.assertEquals(graph.query(q).result_set, [[3]])
+
+        # the graph's schema is unchanged, keeping its version
+        self.env.assertEquals(self.graph_version(), version)
+
+    def test03_modify_reloaded(self):
+        self.evict(2)
+
+        # write queries reload the graph as well
+        result = graph.query("MATCH (a:M {v: 1}) CREATE (a)-[:R {w: 100}]->(:M {v: 100})")
+        self.env.assertEquals(result.relationships_created, 1)
+
+        self.evict(2)
+        result = graph.query("MATCH (:M {v: 1})-[e:R]->(b:M) RETURN e.w, b.v")
+        self.env.assertEquals(result.result_set, [[100, 100]])
+
+    def test04_persist_evicted(self):
+        expected = [graph.query(q).result_set for q in QUERIES]
+
+        # evicted graphs are saved by their encoding
+        self.evict(2)
+        redis_con.execute_command("DEBUG", "RELOAD")
+        self.env.assertEquals(self.info_field("evicted_graphs"), 0)
+
+        for q, e in zip(QUERIES, expected):
+            self.env.assertEquals(graph.query(q).result_set, e)
+
+        result = other_graph.query("MATCH (n:N) RETURN count(n)")
+        self.env.assertEquals(result.result_set, [[11]])
+
+    def test05_rename_evicted(self):
+        expected = other_graph.query("MATCH (n:N) RETURN n.v ORDER BY n.v").result_set
+
+        self.evict(2)
+        redis_con.execute_command("RENAME", OTHER_GRAPH_ID, "eviction_renamed")
+
+        renamed = Graph("eviction_renamed", redis_con)
+        result = renamed.query("MATCH (n:N) RETURN n.v ORDER BY n.v")
+        self.env.assertEquals(result.result_set, expected)
+        self.env.assertEquals(self.info_field("evicted_graphs"), 1)
+
+    def test06_delete_evicted(self):
+        self.evict(2)
+        graph.delete()
+        self.env.assertEquals(self.info_field("evicted_graphs"), 1)
+
+        # a new graph can be created under the evicted graph's name
+        result = graph.query("CREATE (:L {v: 1})")
+        self.env.assertEquals(result.nodes_created, 1)
@@ -0,0 +1,97 @@
+import os
+import sys
+import csv
+import shutil
+import tempfile
+from RLTest import Env
+from redisgraph import Graph
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+
+from base import FlowTestsBase
+
+GRAPH_ID = "export"
+redis_con = None
+graph = None
+
+def read_csv(path):
+    with open(path, newline='') as f:
+        return list(csv.reader(f))
+
+class testGraphExport(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        graph.query("""CREATE (a:Person {name: 'Roi, "the" dev', age: 33}),
+                              (b:Person {name: 'Ailon'}),
+                              (c:`Big City` {name: 'Tel Aviv', pop: 460613.5}),
+                              (:Tag {flag: true, v: [1, 2]}),
+                              (),
+                              (a)-[:knows {since: 2010}]->(b),
+                              (a)-[:lives]->(c)""")
+
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def export(self, graph_id=GRAPH_ID):
+        reply = redis_con.execute_command("GRAPH.EXPORT", graph_id, self.dir)
+        return dict(zip(reply[0::2], reply[1::2]))
+
+    def test01_export(self):
+        self.env.assertEquals(self.export(), {"nodes": 5, "edges": 2})
+        self.env.assertEquals(sorted(os.listdir(self.dir)),
+                              ["edges_knows.csv", "edges_lives.csv", "nodes.csv",
+                               "nodes_Big%20City.csv", "nodes_Person.csv", "nodes_Tag.csv"])
+
+        # quoted fields and missing attributes are read back as written
+        rows = read_csv(os.path.join(self.dir, "nodes_Person.csv"))
+        self.env.assertEquals(rows, [["_id", "name", "age"],
+                                     ["0", 'Roi, "the" dev', "33"],
+                                     ["1", "Ailon", ""]])
+
+        rows = read_csv(os.path.join(self.dir, "nodes_Big%20City.csv"))
+        self.env.assertEquals(rows[0], ["_id", "name", "pop"])
+        self.env.assertEquals(rows[1][:2], ["2", "Tel Aviv"])
+        self.env.assertEquals(float(rows[1][2]), 460613.5)
+
+        rows = read_csv(os.path.join(self.dir, "nodes_Tag.csv"))
+        self.env.assertEquals(rows, [["_id", "flag", "v"], ["3", "true", "[1, 2]"]])
+
+        # unlabeled nodes
+        rows = read_csv(os.path.join(self.dir, "nodes.csv"))
+        self.env.assertEquals(rows, [["_id"], ["4"]])
+
+        # edges hold their endpoints
+        rows = read_csv(os.path.join(self.dir, "edges_knows.csv"))
+        self.env.assertEquals(rows, [["_id", "_src", "_dest", "since"], ["0", "0", "1", "2010"]])
+        rows = read_csv(os.path.join(self.dir, "edges_lives.csv"))
+        self.env.assertEquals(rows, [["_id", "_src", "_dest"], ["1", "0", "2"]])
+
+    def test02_deleted_entities(self):
+        # deleted entities aren't exported, nor do empty tables get a file
+        g = Graph("export_deleted", redis_con)
+        g.query("CREATE (:A {v: 1})-[:R]->(:B {v: 2})")
+        g.query("MATCH (b:B) DELETE b")
+        self.env.assertEquals(self.export("export_deleted"), {"nodes": 1, "edges": 0})
+        self.env.assertEquals(os.listdir(self.dir), ["nodes_A.csv"])
+        rows = read_csv(os.path.join(self.dir, "nodes_A.csv"))
+        self.env.assertEquals(rows, [["_id", "v"], ["0", "1"]])
+
+    def test03_errors(self):
+        try:
+            redis_con.execute_command("GRAPH.EXPORT", GRAPH_ID, os.path.join(self.dir, "missing"))
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertContains("Export directory doesn't exist", str(e))
+
+        try:
+            redis_con.execute_command("GRAPH.EXPORT", "missing_graph", self.dir)
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertNotContains("Export directory", str(e))
@@ -575,3 +575,50 @@ class testGraphMergeFlow(FlowTestsBase):
         except redis.exceptions.ResponseError as e:
             # Expecting an error.
             self.env.assertIn("undefined property", str(e))
+
+    def test28_batched_merge(self):
+        redis_con = self.env.getConnection()
+        graph = Graph("batched_merge", redis_con)
+
+        # seed existing nodes, matched by both numeric and string keys
+        graph.query("UNWIND range(0, 9) AS x CREATE (:User {id: x, name: 'u' + toString(x)})")
+
+        # bound records are matched by key in a single pass
+        # duplicate keys in the batch create a single node
+        query = """UNWIND [1, 2.0, 10, 10, 11] AS x
+                   MERGE (n:User {id: x})
+                   ON MATCH SET n.matched = true
+                   ON CREATE SET n.created = true
+                   RETURN n.id, n.matched, n.created ORDER BY n.id"""
+        result = graph.query(query)
+        self.env.assertEquals(result.nodes_created, 2)
+        expected = [[1, True, None],
+                    [2, True, None],
+                    [10, None, True],
+                    [11, None, True]]
+        self.env.assertEquals(result.result_set, expected)
+
+        # composite string and numeric key
+        query = """UNWIND [{id: 3, name: 'u3'}, {id: 4, name: 'x'}] AS row
+                   MERGE (n:User {id: row.id, name: row.name})
+                   RETURN n.id, n.name ORDER BY n.name"""
+        result = graph.query(query)
+        self.env.assertEquals(result.nodes_created, 1)
+        self.env.assertEquals(result.result_set, [[3, 'u3'], [4, 'x']])
+
+        # indexed numeric key
+        graph.query("CREATE INDEX ON :User(id)")
+        query = """UNWIND [5, 6, 12] AS x
+                   MERGE (n:User {id: x})
+                   RETURN count(n)"""
+        result = graph.query(query)
+        self.env.assertEquals(result.nodes_created, 1)
+        self.env.assertEquals(result.result_set, [[3]])
+
+        # repeating the query modifies nothing
+        result = graph.query(query)
+        self.env.assertEquals(result.nodes_created, 0)
+        self.env.assertEquals(result.result_set, [[3]])
+
+        result = graph.query("MATCH (n:User) RETURN count(n)")
+        self.env.assertEquals(result.result_set, [[14]])
@@ -0,0 +1,114 @@
+import time
+import threading
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "quota"
+OTHER_GRAPH_ID = "quota_other"
+# takes a while to run, consuming CPU time throughout
+HEAVY_QUERY = "UNWIND range(0, 3000000) AS x WITH x WHERE x % 7 = 0 RETURN count(x)"
+redis_con = None
+graph = None
+other_graph = None
+
+def issue_heavy_query(env, results):
+    con = env.getConnection()
+    try:
+        Graph(GRAPH_ID, con).query(HEAVY_QUERY)
+        results.append(True)
+    except Exception:
+        results.append(False)
+
+class testGraphQuota(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global graph
+        global other_graph
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        other_graph = Graph(OTHER_GRAPH_ID, redis_con)
+        graph.query("CREATE (:N {v: 1})")
+        other_graph.query("CREATE (:N {v: 1})")
+
+    def tearDown(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_MAX_CONCURRENT_QUERIES", "0")
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_CPU_QUOTA", "0")
+
+    def usage(self, graph_id=GRAPH_ID):
+        info = redis_con.execute_command("INFO", "graph_graphs")
+        return info["graph_" + graph_id]
+
+    def test01_config(self):
+        for name in ["GRAPH_MAX_CONCURRENT_QUERIES", "GRAPH_CPU_QUOTA"]:
+            response = redis_con.execute_command("GRAPH.CONFIG", "GET", name)
+            self.env.assertEquals(response, [name, 0])
+
+            redis_con.execute_command("GRAPH.CONFIG", "SET", name, "10")
+            response = redis_con.execute_command("GRAPH.CONFIG", "GET", name)
+            self.env.assertEquals(response, [name, 10])
+
+            try:
+                redis_con.execute_command("GRAPH.CONFIG", "SET", name, "-1")
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+    def test02_max_concurrent_queries(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_MAX_CONCURRENT_QUERIES", "1")
+
+        results = []
+        t = threading.Thread(target=issue_heavy_query, args=(self.env, results))
+        t.start()
+
+        # wait for the heavy query to be admitted
+        deadline = time.time() + 10
+        while self.usage()["running_queries"] == 0 and t.is_alive() and time.time() < deadline:
+            time.sleep(0.01)
+
+        rejected = False
+        if t.is_alive():
+            try:
+                graph.query("MATCH (n:N) RETURN n.v")
+            except Exception as e:
+                self.env.assertContains("Max concurrent queries per graph exceeded", str(e))
+                rejected = True
+
+            # queries against other graphs are admitted
+            result = other_graph.query("MATCH (n:N) RETURN n.v")
+            self.env.assertEquals(result.result_set, [[1]])
+
+        t.join()
+        self.env.assertEquals(results, [True])
+        if rejected:
+            self.env.assertGreater(self.usage()["quota_rejected_queries"], 0)
+
+        # the completed query released its slot
+        self.env.assertEquals(self.usage()["running_queries"], 0)
+        result = graph.query("MATCH (n:N) RETURN n.v")
+        self.env.assertEquals(result.result_set, [[1]])
+
+    def test03_cpu_quota(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_CPU_QUOTA", "1")
+        rejected = self.usage()["quota_rejected_queries"]
+
+        # the heavy query consumes far more than a second worth of the quota
+        graph.query(HEAVY_QUERY)
+        self.env.assertGreater(self.usage()["cpu_time_ms"], 1)
+
+        try:
+            graph.query("MATCH (n:N) RETURN n.v")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertContains("Graph CPU quota exceeded", str(e))
+        self.env.assertEquals(self.usage()["quota_rejected_queries"], rejected + 1)
+
+        # the quota applies to each graph on its own
+        result = other_graph.query("MATCH (n:N) RETURN n.v")
+        self.env.assertEquals(result.result_set, [[1]])
+
+        # lifting the quota admits the graph's queries
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GRAPH_CPU_QUOTA", "0")
+        result = graph.query("MATCH (n:N) RETURN n.v")
+        self.env.assertEquals(result.result_set, [[1]])
@@ -0,0 +1,109 @@
+import time
+import threading
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "group_commit"
+CLIENT_COUNT = 8        # Number of concurrent connections.
+QUERIES_PER_CLIENT = 25 # Write queries issued by each connection.
+redis_con = None
+redis_graph = None
+
+def issue_writes(env, client_id, results):
+    con = env.getConnection()
+    graph = Graph(GRAPH_ID, con)
+    ok = True
+    for i in range(QUERIES_PER_CLIENT):
+        q = "CREATE (:N {client: %d, i: %d})" % (client_id, i)
+        res = graph.query(q)
+        if res.nodes_created != 1 or res.properties_set != 2:
+            ok = False
+    results[client_id] = ok
+
+def issue_slow_writes(env, count):
+    con = env.getConnection()
+    graph = Graph(GRAPH_ID, con)
+    # a long read phase followed by a small commit
+    q = """UNWIND range(1, 1000000) AS x WITH x WHERE x % 1000000 = 0
+           CREATE (:S {x: x})"""
+    for i in range(count):
+        graph.query(q)
+
+class testGroupCommit(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+    def tearDown(self):
+        # restore per-query commits
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GROUP_COMMIT_SIZE", 1)
+
+    def test01_default_group_size(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "GROUP_COMMIT_SIZE")
+        self.env.assertEquals(response[1], 1)
+
+    def test02_concurrent_grouped_writes(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GROUP_COMMIT_SIZE", 16)
+        redis_graph.query("CREATE INDEX ON :N(client)")
+
+        results = [False] * CLIENT_COUNT
+        threads = []
+        for i in range(CLIENT_COUNT):
+            t = threading.Thread(target=issue_writes, args=(self.env, i, results))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        # every query reports its own modifications
+        self.env.assertEquals(results, [True] * CLIENT_COUNT)
+
+        # all writes were committed
+        res = redis_graph.query("MATCH (n:N) RETURN count(n)")
+        self.env.assertEquals(res.result_set[0][0], CLIENT_COUNT * QUERIES_PER_CLIENT)
+
+        # indices and statistics reflect the grouped writes
+        for i in range(CLIENT_COUNT):
+            res = redis_graph.query("MATCH (n:N {client: %d}) RETURN count(n)" % i)
+            self.env.assertEquals(res.result_set[0][0], QUERIES_PER_CLIENT)
+
+
+    def test03_progress_during_group(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "GROUP_COMMIT_SIZE", 16)
+
+        threads = []
+        for i in range(CLIENT_COUNT):
+            t = threading.Thread(target=issue_slow_writes, args=(self.env, 2))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        # let the writers queue up as a group
+        time.sleep(0.2)
+
+        # locks are held only around each query's commit, readers and
+        # unrelated commands aren't stalled for the group's duration
+        con = self.env.getConnection()
+        reader = Graph(GRAPH_ID, con)
+        for i in range(5):
+            start = time.time()
+            con.ping()
+            con.set("unrelated", i)
+            reader.query("MATCH (n:N) RETURN count(n)")
+            self.env.assertLess(time.time() - start, 0.5)
+            time.sleep(0.05)
+
+        # the group was still executing while making progress
+        self.env.assertTrue(any(t.is_alive() for t in threads))
+
+        for t in threads:
+            t.join()
+
+        res = redis_graph.query("MATCH (s:S) RETURN count(s)")
+        self.env.assertEquals(res.result_set[0][0], CLIENT_COUNT * 2)
@@ -36,3 +36,24 @@ class testHashJoin(FlowTestsBase):
 
         self.env.assertEquals(actual_result.result_set, expected_result)
 
+
+    def test_hashjoin_build_side(self):
+        graph = Graph("hashjoin_build_side", self.env.getConnection())
+        graph.query("UNWIND range(0, 999) AS x CREATE (:L {v: x % 100})")
+        graph.query("UNWIND range(0, 9) AS x CREATE (:R {v: toFloat(x * 20)})")
+
+        # either stream may be the smaller one, results must not depend on it
+        # integer and float join values compare equal
+        expected = [[v, 10] for v in range(0, 100, 20)]
+        queries = ["MATCH (a:L), (b:R) WHERE a.v = b.v RETURN b.v, count(a) ORDER BY b.v",
+                   "MATCH (b:R), (a:L) WHERE b.v = a.v RETURN b.v, count(a) ORDER BY b.v"]
+        for q in queries:
+            plan = graph.execution_plan(q)
+            self.env.assertIn("Value Hash Join", plan)
+            actual_result = graph.query(q)
+            self.env.assertEquals(actual_result.result_set, expected)
+
+        # joined streams are pulled lazily, LIMIT stops the probe stream early
+        q = "MATCH (a:L), (b:R) WHERE a.v = b.v RETURN a.v LIMIT 3"
+        actual_result = graph.query(q)
+        self.env.assertEquals(len(actual_result.result_set), 3)
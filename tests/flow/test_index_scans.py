@@ -1,5 +1,6 @@
 import os
 import sys
+import time
 from RLTest import Env
 from redisgraph import Graph, Node, Edge
 from base import FlowTestsBase
@@ -519,3 +520,340 @@ class testIndexScanFlow(FlowTestsBase):
         expected_result = [["leonard"]]
         self.env.assertEquals(query_result.result_set, expected_result)
 
+
+    def test18_numeric_range_index(self):
+        # numeric range filters are resolved by a native range index
+        g = Graph("range_index", self.env.getConnection())
+        g.query("CREATE INDEX ON :R(v)")
+        g.query("UNWIND range(1, 100) AS x CREATE (:R {v: x})")
+        # values of none numeric types are not part of the range index
+        g.query("CREATE (:R {v: '50'}), (:R {v: [50]}), (:R {v: true})")
+
+        queries = [
+                ("MATCH (n:R) WHERE n.v > 95 RETURN n.v ORDER BY n.v", [[x] for x in range(96, 101)]),
+                ("MATCH (n:R) WHERE n.v >= 10 AND n.v < 13 RETURN n.v ORDER BY n.v", [[10], [11], [12]]),
+                ("MATCH (n:R) WHERE 3 >= n.v RETURN n.v ORDER BY n.v", [[1], [2], [3]]),
+                ("MATCH (n:R) WHERE n.v = 50 RETURN n.v", [[50]]),
+                ("MATCH (n:R) WHERE n.v = 50.5 RETURN n.v", []),
+                ("MATCH (n:R) WHERE n.v > 2.5 AND n.v <= 4 RETURN n.v ORDER BY n.v", [[3], [4]]),
+                ("MATCH (n:R) WHERE n.v > 10 AND n.v < 5 RETURN n.v", []),
+                ("CYPHER lo=20 hi=22 MATCH (n:R) WHERE n.v >= $lo AND n.v <= $hi RETURN n.v ORDER BY n.v", [[20], [21], [22]]),
+                ]
+        for q, expected in queries:
+            plan = g.execution_plan(q)
+            self.env.assertIn('Index Scan', plan)
+            self.env.assertEquals(g.query(q).result_set, expected)
+
+        # updates and deletions are reflected by the range index
+        g.query("MATCH (n:R) WHERE n.v = 1 SET n.v = 1000")
+        g.query("MATCH (n:R) WHERE n.v = 2 DELETE n")
+        g.query("MATCH (n:R) WHERE n.v = 3 SET n.v = 'three'")
+        g.query("MATCH (n:R) WHERE n.v = 4 SET n.v = NULL")
+
+        q = "MATCH (n:R) WHERE n.v < 6 RETURN n.v ORDER BY n.v"
+        self.env.assertEquals(g.query(q).result_set, [[5]])
+        q = "MATCH (n:R) WHERE n.v > 999 RETURN n.v"
+        self.env.assertEquals(g.query(q).result_set, [[1000]])
+
+        # results match a label scan
+        q = "MATCH (n:R) WHERE n.v >= 30 AND n.v < 70 RETURN count(n)"
+        self.env.assertEquals(g.query(q).result_set, [[40]])
+        g.query("DROP INDEX ON :R(v)")
+        self.env.assertEquals(g.query(q).result_set, [[40]])
+        g.delete()
+
+    def test19_numeric_index_lookup_join(self):
+        # equality filters on runtime values are looked up in the range index
+        g = Graph("index_lookup", self.env.getConnection())
+        g.query("CREATE INDEX ON :B(id)")
+        g.query("UNWIND range(1, 200) AS x CREATE (:B {id: x})")
+        g.query("CREATE (:B {id: '7'})")
+        g.query("UNWIND range(1, 150) AS x CREATE (:A {ref: x % 10, v: x})")
+        g.query("CREATE (:A {ref: 'x', v: 0}), (:A {v: -1}), (:A {ref: 2.5, v: -2})")
+
+        q = "MATCH (a:A) MATCH (b:B) WHERE b.id = a.ref RETURN a.v, b.id ORDER BY a.v"
+        plan = g.execution_plan(q)
+        self.env.assertIn('Index Scan', plan)
+        expected = [[x, x % 10] for x in range(1, 151) if x % 10 != 0]
+        self.env.assertEquals(g.query(q).result_set, expected)
+
+        # duplicated lookup values
+        g.query("CREATE (:B {id: 3})")
+        q = "MATCH (a:A) WHERE a.v <= 23 MATCH (b:B) WHERE b.id = a.ref RETURN a.v, count(b) ORDER BY a.v"
+        expected = [[x, 2 if x % 10 == 3 else 1] for x in range(1, 24) if x % 10 != 0]
+        self.env.assertEquals(g.query(q).result_set, expected)
+
+        # results match a label scan
+        q = "MATCH (a:A) MATCH (b:B) WHERE b.id = a.ref + 100 RETURN count(b)"
+        self.env.assertEquals(g.query(q).result_set, [[150]])
+        g.query("DROP INDEX ON :B(id)")
+        self.env.assertEquals(g.query(q).result_set, [[150]])
+        g.delete()
+
+    def test20_composite_index(self):
+        # composite indices resolve equality prefix and range suffix filters
+        g = Graph("composite_index", self.env.getConnection())
+        g.query("CREATE INDEX ON :O(c, t)")
+        g.query("UNWIND range(0, 299) AS x CREATE (:O {c: x % 10, t: 299 - x})")
+        # nodes holding none numeric key values are not part of the composite
+        g.query("CREATE (:O {c: 3, t: 'late'}), (:O {c: 3})")
+
+        indices = g.query("CALL db.indexes() YIELD label, properties")
+        self.env.assertEquals(indices.result_set, [['O', ['c', 't']]])
+
+        expected = sorted([299 - x for x in range(300) if x % 10 == 3])
+        q = "MATCH (o:O) WHERE o.c = 3 AND o.t >= 0 RETURN o.t ORDER BY o.t"
+        plan = g.execution_plan(q)
+        self.env.assertIn('Index Scan', plan)
+        self.env.assertNotIn('Sort', plan)
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in expected])
+
+        q = "MATCH (o:O) WHERE o.c = 3 AND o.t >= 100 AND o.t < 150 RETURN o.t ORDER BY o.t LIMIT 3"
+        plan = g.execution_plan(q)
+        self.env.assertNotIn('Sort', plan)
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in expected if 100 <= t < 150][:3])
+
+        q = "MATCH (o:O) WHERE o.c = 3 AND o.t = 196 RETURN o.t"
+        self.env.assertEquals(g.query(q).result_set, [[196]])
+
+        # descending order is still sorted
+        q = "MATCH (o:O) WHERE o.c = 3 AND o.t >= 0 RETURN o.t ORDER BY o.t DESC"
+        plan = g.execution_plan(q)
+        self.env.assertIn('Sort', plan)
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in reversed(expected)])
+
+        # filters which don't constrain all key properties
+        # match nodes missing from the composite
+        q = "MATCH (o:O) WHERE o.c = 3 RETURN count(o)"
+        self.env.assertEquals(g.query(q).result_set, [[len(expected) + 2]])
+
+        # updates are reflected by the composite index
+        g.query("MATCH (o:O) WHERE o.c = 3 AND o.t = 196 SET o.t = 1000")
+        g.query("MATCH (o:O) WHERE o.c = 3 AND o.t = 186 SET o.c = 4")
+        g.query("MATCH (o:O) WHERE o.c = 3 AND o.t = 176 DELETE o")
+        expected = sorted([t for t in expected if t not in (196, 186, 176)] + [1000])
+        q = "MATCH (o:O) WHERE o.c = 3 AND o.t > 0 RETURN o.t ORDER BY o.t"
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in expected])
+
+        # dropping the composite drops its properties' indices
+        g.query("DROP INDEX ON :O(c, t)")
+        indices = g.query("CALL db.indexes()")
+        self.env.assertEquals(len(indices.result_set), 0)
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in expected])
+        g.delete()
+
+    def test21_relationship_index(self):
+        # relationship indices seed traversals from matching edges
+        g = Graph("relationship_index", self.env.getConnection())
+        g.query("UNWIND range(0, 99) AS x CREATE (:A {v: x})-[:TRANSFER {ts: x}]->(:B {v: x})")
+        g.query("CALL db.idx.edge.createIndex('TRANSFER', 'ts')")
+
+        indices = g.query("CALL db.indexes() YIELD type, label, properties")
+        self.env.assertEquals(indices.result_set, [['relationship', 'TRANSFER', ['ts']]])
+
+        q = "MATCH (a)-[e:TRANSFER]->(b) WHERE e.ts >= 10 AND e.ts < 15 RETURN a.v, e.ts, b.v ORDER BY e.ts"
+        plan = g.execution_plan(q)
+        self.env.assertIn('Edge Index Scan', plan)
+        self.env.assertNotIn('Conditional Traverse', plan)
+        self.env.assertEquals(g.query(q).result_set, [[x, x, x] for x in range(10, 15)])
+
+        # pattern written right to left, endpoint labels are respected
+        q = "MATCH (b:B)<-[e:TRANSFER]-(a:A) WHERE e.ts < 3 RETURN a.v, b.v ORDER BY a.v"
+        plan = g.execution_plan(q)
+        self.env.assertIn('Edge Index Scan', plan)
+        self.env.assertEquals(g.query(q).result_set, [[x, x] for x in range(3)])
+        q = "MATCH (a:B)-[e:TRANSFER]->(b) WHERE e.ts < 3 RETURN count(e)"
+        self.env.assertEquals(g.query(q).result_set, [[0]])
+
+        # creations, updates and deletions are reflected by the index
+        g.query("MATCH (a:A {v: 0}), (b:B {v: 1}) CREATE (a)-[:TRANSFER {ts: 1}]->(b)")
+        g.query("MATCH ()-[e:TRANSFER]->() WHERE e.ts = 2 SET e.ts = 200")
+        g.query("MATCH ()-[e:TRANSFER]->() WHERE e.ts = 0 DELETE e")
+        # edge removed along with its endpoint
+        g.query("MATCH (a:A {v: 1}) DELETE a")
+        q = "MATCH (a)-[e:TRANSFER]->(b) WHERE e.ts < 5 RETURN a.v, e.ts, b.v ORDER BY e.ts"
+        self.env.assertEquals(g.query(q).result_set, [[0, 1, 1], [3, 3, 3], [4, 4, 4]])
+        q = "MATCH (a)-[e:TRANSFER]->(b) WHERE e.ts > 150 RETURN a.v, e.ts"
+        self.env.assertEquals(g.query(q).result_set, [[2, 200]])
+
+        # dropping the index, plans built using it scan the relation
+        q = "MATCH (a)-[e:TRANSFER]->(b) WHERE e.ts < 5 RETURN e.ts ORDER BY e.ts"
+        g.query(q)
+        g.query("CALL db.idx.edge.drop('TRANSFER', 'ts')")
+        self.env.assertEquals(len(g.query("CALL db.indexes()").result_set), 0)
+        self.env.assertEquals(g.query(q).result_set, [[1], [3], [4]])
+        g.delete()
+
+    def test22_background_index_construction(self):
+        # indices over large labels are populated in the background
+        redis_con = self.env.getConnection()
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "INDEX_BUILD_CHUNK_SIZE", 100)
+        g = Graph("background_index", redis_con)
+        g.query("UNWIND range(0, 9999) AS x CREATE (:P {v: x})")
+        g.query("CREATE INDEX ON :P(v)")
+
+        # writes issued during construction are reflected by the index
+        g.query("UNWIND range(10000, 10099) AS x CREATE (:P {v: x})")
+        g.query("MATCH (p:P) WHERE p.v < 50 SET p.v = p.v + 20000")
+        g.query("MATCH (p:P) WHERE p.v >= 9950 AND p.v < 10000 DELETE p")
+
+        # wait for the index to become operational
+        q = "CALL db.indexes() YIELD label, status"
+        for _ in range(100):
+            if g.query(q).result_set == [['P', 'operational']]:
+                break
+            time.sleep(0.1)
+        self.env.assertEquals(g.query(q).result_set, [['P', 'operational']])
+
+        q = "MATCH (p:P) WHERE p.v >= 9900 RETURN count(p)"
+        self.env.assertIn('Index Scan', g.execution_plan(q))
+        # 50 left untouched, 100 added during construction, 50 updated
+        self.env.assertEquals(g.query(q).result_set, [[200]])
+        q = "MATCH (p:P) WHERE p.v < 100 RETURN count(p)"
+        self.env.assertEquals(g.query(q).result_set, [[50]])
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "INDEX_BUILD_CHUNK_SIZE", 100000)
+        g.delete()
+
+    def test23_batched_index_updates(self):
+        # index updates issued by a single write are applied at once
+        g = Graph("batched_index_updates", self.env.getConnection())
+        g.query("CREATE INDEX ON :B(v)")
+        g.query("UNWIND range(0, 9999) AS x CREATE (:B {v: x})")
+        q = "MATCH (b:B) WHERE b.v >= 9990 RETURN count(b)"
+        self.env.assertIn('Index Scan', g.execution_plan(q))
+        self.env.assertEquals(g.query(q).result_set, [[10]])
+
+        # nodes updated by multiple records reflect their final value
+        g.query("UNWIND range(1, 5) AS i MATCH (b:B) WHERE b.v < 10 SET b.v = b.v + 100000")
+        q = "MATCH (b:B) WHERE b.v >= 100000 RETURN count(b)"
+        self.env.assertEquals(g.query(q).result_set, [[10]])
+        q = "MATCH (b:B) WHERE b.v < 10 RETURN count(b)"
+        self.env.assertEquals(g.query(q).result_set, [[0]])
+
+        g.query("UNWIND range(1, 5) AS i MERGE (b:B {v: 100000}) ON MATCH SET b.v = -1")
+        q = "MATCH (b:B) WHERE b.v < 0 RETURN b.v"
+        self.env.assertEquals(g.query(q).result_set, [[-1]])
+        q = "MATCH (b:B) WHERE b.v = 100000 RETURN count(b)"
+        self.env.assertEquals(g.query(q).result_set, [[0]])
+
+        # nodes created and read back by the same query
+        q = "CREATE (:B {v: 200000}) WITH 1 AS x MATCH (b:B) WHERE b.v = 200000 RETURN count(b)"
+        self.env.assertEquals(g.query(q).result_set, [[1]])
+        g.delete()
+
+    def test24_point_index_results(self):
+        # point index scans report exactly the points a label scan does
+        g = Graph("point_index_results", self.env.getConnection())
+        g.query("UNWIND range(0, 200) AS x CREATE (:P {loc: point({latitude: 32 + x * 0.0001, longitude: 34}), v: x})")
+
+        origin = "point({latitude: 32, longitude: 34})"
+        queries = ["MATCH (p:P) WHERE distance(p.loc, %s) < 1000 RETURN p.v ORDER BY p.v" % origin,
+                   "MATCH (p:P) WHERE distance(p.loc, %s) <= 555.5 RETURN p.v ORDER BY p.v" % origin,
+                   "MATCH (p:P) WHERE 1000 > distance(%s, p.loc) RETURN p.v ORDER BY p.v" % origin,
+                   "MATCH (p:P) WHERE distance(p.loc, %s) < 1000 OR p.v = 200 RETURN p.v ORDER BY p.v" % origin]
+        expected = [g.query(q).result_set for q in queries]
+
+        g.query("CREATE INDEX ON :P(loc)")
+        # wait for the index to be operational
+        time.sleep(1)
+
+        for q, e in zip(queries, expected):
+            self.env.assertEquals(g.query(q).result_set, e)
+        self.env.assertIn("Index Scan", g.execution_plan(queries[0]))
+        self.env.assertIn("Index Scan", g.execution_plan(queries[2]))
+
+        # points outside of the circle are not served by the index
+        q = "MATCH (p:P) WHERE 1000 < distance(%s, p.loc) RETURN count(p)" % origin
+        self.env.assertNotIn("Index Scan", g.execution_plan(q))
+        g.delete()
+
+    def test25_timestamp_range(self):
+        # ranges relative to the current time are resolved by the index
+        g = Graph("timestamp_range", self.env.getConnection())
+        g.query("CREATE INDEX ON :E(ts)")
+        g.query("WITH timestamp() AS now UNWIND range(0, 9) AS x CREATE (:E {ts: now - x * 3600000, v: x})")
+
+        q = "MATCH (e:E) WHERE e.ts > timestamp() - 3 * 3600000 - 60000 RETURN e.v ORDER BY e.v"
+        self.env.assertIn('Index Scan', g.execution_plan(q))
+        self.env.assertEquals(g.query(q).result_set, [[0], [1], [2], [3]])
+
+        since = g.query("MATCH (e:E {v: 8}) RETURN e.ts").result_set[0][0]
+        q = "MATCH (e:E) WHERE e.ts < timestamp() - 7 * 3600000 + 60000 AND e.ts >= %d RETURN e.v ORDER BY e.v" % since
+        self.env.assertIn('Index Scan', g.execution_plan(q))
+        self.env.assertEquals(g.query(q).result_set, [[7], [8]])
+        g.delete()
+
+    def test26_range_index_order(self):
+        # range index scans satisfy ORDER BY over the indexed attribute
+        g = Graph("range_index_order", self.env.getConnection())
+        g.query("CREATE INDEX ON :Event(ts)")
+        g.query("UNWIND range(0, 2999) AS x CREATE (:Event {ts: (x * 7919) % 3000, v: x})")
+        # values outside of the index don't match a numeric range
+        g.query("CREATE (:Event {ts: 'late'}), (:Event)")
+
+        expected = list(range(1001, 3000))
+        q = "MATCH (e:Event) WHERE e.ts > $t RETURN e.ts ORDER BY e.ts LIMIT 20"
+        plan = g.execution_plan("MATCH (e:Event) WHERE e.ts > 1000 RETURN e.ts ORDER BY e.ts LIMIT 20")
+        self.env.assertIn('Index Scan', plan)
+        self.env.assertNotIn('Sort', plan)
+        self.env.assertEquals(g.query(q, {'t': 1000}).result_set, [[t] for t in expected[:20]])
+
+        q = "MATCH (e:Event) WHERE e.ts > 1000 RETURN e.ts ORDER BY e.ts DESC SKIP 5 LIMIT 20"
+        self.env.assertNotIn('Sort', g.execution_plan(q))
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in list(reversed(expected))[5:25]])
+
+        # ranges spanning multiple pages
+        q = "MATCH (e:Event) WHERE e.ts > 1000 RETURN e.ts ORDER BY e.ts"
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in expected])
+        q = "MATCH (e:Event) WHERE e.ts > 1000 RETURN e.ts ORDER BY e.ts DESC"
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in reversed(expected)])
+
+        # modifications pending a merge are reported in order
+        g.query("MATCH (e:Event) WHERE e.ts = 1500 SET e.ts = 999")
+        g.query("CREATE (:Event {ts: 1000.5})")
+        expected = [1000.5] + [t for t in expected if t != 1500]
+        q = "MATCH (e:Event) WHERE e.ts > 1000 RETURN e.ts ORDER BY e.ts"
+        self.env.assertEquals(g.query(q).result_set, [[t] for t in expected])
+
+        # ordering by another attribute is still sorted
+        q = "MATCH (e:Event) WHERE e.ts > 1000 RETURN e.v ORDER BY e.v LIMIT 1"
+        self.env.assertIn('Sort', g.execution_plan(q))
+        g.delete()
+
+    def test27_prefix_index_scan(self):
+        # STARTS WITH is resolved by a lexical range over the exact-match index
+        g = Graph("prefix_index", self.env.getConnection())
+        g.query("CREATE INDEX ON :W(s)")
+        g.query("UNWIND ['a', 'ab', 'abc', 'abd', 'ac', 'b', 'Ab', 'abÿ'] AS s CREATE (:W {s: s})")
+        g.query("CREATE (:W {s: 1}), (:W)")
+
+        q = "MATCH (w:W) WHERE w.s STARTS WITH 'ab' RETURN w.s ORDER BY w.s"
+        self.env.assertIn('Index Scan', g.execution_plan(q))
+        self.env.assertEquals(g.query(q).result_set, [['ab'], ['abc'], ['abd'], ['abÿ']])
+
+        q = "MATCH (w:W) WHERE w.s STARTS WITH $p RETURN w.s ORDER BY w.s"
+        self.env.assertEquals(g.query(q, {'p': 'a'}).result_set,
+                [['a'], ['ab'], ['abc'], ['abd'], ['abÿ'], ['ac']])
+
+        # the empty prefix matches every string
+        q = "MATCH (w:W) WHERE w.s STARTS WITH '' RETURN count(w)"
+        self.env.assertEquals(g.query(q).result_set, [[8]])
+
+        # other string predicates are evaluated per node
+        q = "MATCH (w:W) WHERE w.s ENDS WITH 'b' RETURN w.s ORDER BY w.s"
+        self.env.assertEquals(g.query(q).result_set, [['Ab'], ['ab'], ['b']])
+        q = "MATCH (w:W) WHERE w.s CONTAINS 'bc' RETURN w.s"
+        self.env.assertEquals(g.query(q).result_set, [['abc']])
+        g.delete()
+
+    def test26_runtime_string_range(self):
+        # runtime bounds other than numbers are resolved by RediSearch
+        g = Graph("runtime_string_range", self.env.getConnection())
+        g.query("CREATE INDEX ON :P(name)")
+        g.query("UNWIND ['a', 'b', 'z'] AS name CREATE (:P {name: name})")
+
+        q = "MATCH (p:P) WHERE p.name > toString(timestamp()) RETURN p.name ORDER BY p.name"
+        self.env.assertIn('Index Scan', g.execution_plan(q))
+        self.env.assertEquals(g.query(q).result_set, [['a'], ['b'], ['z']])
+        g.delete()
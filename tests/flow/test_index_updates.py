@@ -152,3 +152,30 @@ class testIndexUpdatesFlow(FlowTestsBase):
         expected_result = [[5, unique_prop]]
         self.env.assertEquals(result.result_set, expected_result)
         self.env.assertEquals(result.properties_set, 1)
+
+    # Delete an entire indexed label in one query, then reuse the freed node IDs
+    def test06_bulk_node_deletion(self):
+        global node_ctr
+        count = redis_graph.query("MATCH (b:label_b) RETURN count(b)").result_set[0][0]
+        result = redis_graph.query("MATCH (b:label_b) DETACH DELETE b")
+        self.env.assertEquals(result.nodes_deleted, count)
+
+        # Indices no longer report the deleted nodes
+        result = redis_graph.query("MATCH (b:label_b) WHERE b.intval > 0 RETURN count(b)")
+        self.env.assertEquals(result.result_set[0][0], 0)
+        result = redis_graph.query("MATCH (b:label_b) WHERE b.group = 'Group A' RETURN count(b)")
+        self.env.assertEquals(result.result_set[0][0], 0)
+
+        # New nodes take over the deleted nodes' IDs
+        redis_graph.nodes = {}
+        for i in range(100):
+            node = self.new_node()
+            node.label = "label_b"
+            node.properties["unique"] = 2 * i + 1
+            redis_graph.add_node(node)
+        node_ctr += 100
+        redis_graph.commit()
+        self.validate_state()
+
+        result = redis_graph.query("MATCH (b:label_b) WHERE b.unique >= 0 RETURN count(b)")
+        self.env.assertEquals(result.result_set[0][0], 100)
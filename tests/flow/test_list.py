@@ -146,3 +146,40 @@ class testList(FlowTestsBase):
         expected_result = [[False]]
         self.env.assertEquals(actual_result.result_set, expected_result)
 
+
+    def test04_unwind_range(self):
+        # large ranges are generated one value at a time
+        query = """UNWIND range(1, 10000000) AS x RETURN count(x), sum(x)"""
+        result_set = redis_graph.query(query).result_set
+        self.env.assertEquals(result_set, [[10000000, 50000005000000]])
+
+        # step and empty ranges
+        query = """UNWIND range(0, 20000, 7) AS x RETURN count(x), max(x)"""
+        result_set = redis_graph.query(query).result_set
+        self.env.assertEquals(result_set, [[2858, 19999]])
+
+        query = """UNWIND range(5, 0) AS x RETURN x"""
+        result_set = redis_graph.query(query).result_set
+        self.env.assertEquals(result_set, [])
+
+        # range bounds depending on each input record
+        query = """UNWIND [1, 2, 3] AS i UNWIND range(i, 10 * i, 5) AS x RETURN i, x"""
+        result_set = redis_graph.query(query).result_set
+        expected_result = [[1, 1], [1, 6], [2, 2], [2, 7], [2, 12], [2, 17],
+                           [3, 3], [3, 8], [3, 13], [3, 18], [3, 23], [3, 28]]
+        self.env.assertEquals(result_set, expected_result)
+
+        # generated ranges respect limits
+        query = """UNWIND range(0, 9223372036854775806) AS x RETURN x LIMIT 3"""
+        result_set = redis_graph.query(query).result_set
+        self.env.assertEquals(result_set, [[0], [1], [2]])
+
+        # invalid arguments are still reported
+        for query in ["UNWIND range(0, 100000, 0) AS x RETURN x",
+                      "UNWIND range(0, 'a') AS x RETURN x"]:
+            try:
+                redis_graph.query(query)
+                assert(False)
+            except redis.exceptions.ResponseError:
+                # Expecting an error.
+                pass
@@ -0,0 +1,106 @@
+import time
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "maintenance"
+redis_con = None
+redis_graph = None
+
+class testMaintenance(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+    def tearDown(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "MAINTENANCE_CPU_BUDGET", "10")
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "SNAPSHOT_PACK_CACHE", "no")
+
+    def stats(self):
+        res = redis_con.execute_command("GRAPH.MAINTENANCE")
+        return dict(zip(res[0::2], res[1::2]))
+
+    # wait for stat to exceed value, returns the last stats observed
+    def wait_for(self, stat, value, timeout=10):
+        stats = self.stats()
+        deadline = time.time() + timeout
+        while stats[stat] <= value and time.time() < deadline:
+            time.sleep(0.1)
+            stats = self.stats()
+        return stats
+
+    def test01_config(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "MAINTENANCE_CPU_BUDGET")
+        self.env.assertEquals(response[1], 10)
+
+        for invalid in ["-1", "101", "a"]:
+            try:
+                redis_con.execute_command("GRAPH.CONFIG", "SET", "MAINTENANCE_CPU_BUDGET", invalid)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "MAINTENANCE_CPU_BUDGET", "0")
+        self.env.assertEquals(self.stats()["cpu_budget"], 0)
+
+    def test02_sync(self):
+        redis_graph.query("UNWIND range(1, 100) AS x CREATE (:L {v: x})")
+        stats = self.wait_for("sync", self.stats()["sync"])
+        self.env.assertGreater(stats["sync"], 0)
+
+        result = redis_graph.query("MATCH (n:L) RETURN count(n)")
+        self.env.assertEquals(result.result_set, [[100]])
+
+    def test03_compact(self):
+        redis_graph.query("UNWIND range(1, 20000) AS x CREATE (:M {v: x})")
+        result = redis_graph.query("MATCH (n:M) WHERE n.v > 5000 DELETE n")
+        self.env.assertEquals(result.nodes_deleted, 15000)
+
+        stats = self.wait_for("compact", self.stats()["compact"])
+        self.env.assertGreater(stats["compact"], 0)
+        self.env.assertGreater(stats["bytes_released"], 0)
+
+        # remaining nodes are intact
+        result = redis_graph.query("MATCH (n:M) RETURN count(n), max(n.v)")
+        self.env.assertEquals(result.result_set, [[5000, 5000]])
+
+    def test04_disabled(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "MAINTENANCE_CPU_BUDGET", "0")
+        # let a scheduled run complete
+        time.sleep(1.5)
+        runs = self.stats()["sync"]
+
+        redis_graph.query("CREATE (:L {v: 0})")
+        time.sleep(1.5)
+        self.env.assertEquals(self.stats()["sync"], runs)
+
+    def test05_pack_cache(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "SNAPSHOT_PACK_CACHE", "yes")
+        graph = Graph("pack_cache", redis_con)
+        graph.query("UNWIND range(1, 50000) AS x CREATE (:P {v: x})-[:R {w: x}]->(:Q)")
+        stats = self.wait_for("pack", self.stats()["pack"])
+        self.env.assertGreater(stats["pack"], 0)
+
+        # modify, delete and create entities of already encoded blocks
+        graph.query("MATCH (n:P) WHERE n.v % 1000 = 0 SET n.v = -n.v")
+        graph.query("MATCH ()-[e:R]->() WHERE e.w % 999 = 0 DELETE e")
+        graph.query("UNWIND range(1, 10) AS x CREATE (:P {v: 0})")
+
+        # snapshots reflect modifications whether or not blocks were re-encoded
+        expected = graph.query("MATCH (n:P) RETURN count(n), sum(n.v)").result_set
+        expected_edges = graph.query("MATCH ()-[e:R]->() RETURN count(e), sum(e.w)").result_set
+        redis_con.execute_command("DEBUG", "RELOAD")
+        self.env.assertEquals(graph.query("MATCH (n:P) RETURN count(n), sum(n.v)").result_set, expected)
+        self.env.assertEquals(graph.query("MATCH ()-[e:R]->() RETURN count(e), sum(e.w)").result_set, expected_edges)
+
+        # encode the reloaded graph's blocks, snapshots reuse every block
+        graph.query("CREATE (:P {v: 0})")
+        expected = graph.query("MATCH (n:P) RETURN count(n), sum(n.v)").result_set
+        self.wait_for("pack", self.stats()["pack"])
+        redis_con.execute_command("DEBUG", "RELOAD")
+        self.env.assertEquals(graph.query("MATCH (n:P) RETURN count(n), sum(n.v)").result_set, expected)
+        self.env.assertEquals(graph.query("MATCH ()-[e:R]->() RETURN count(e), sum(e.w)").result_set, expected_edges)
+        graph.delete()
@@ -146,3 +146,25 @@ class testMap(FlowTestsBase):
         except redis.exceptions.ResponseError as e:
             self.env.assertIn("Encountered unhandled type", str(e))
 
+
+    # Validate lookups into large maps, which are kept sorted by key.
+    def test08_large_map_accesses(self):
+        keys = ["k%d" % i for i in range(50)]
+        row = {k: i for i, k in enumerate(keys)}
+        batch = [dict(row, id=j) for j in range(10)]
+        query = """UNWIND $batch AS row
+                   RETURN row.id, row.k0, row.k17, row.k49, row.missing, row["k33"]
+                   ORDER BY row.id"""
+        query_result = redis_graph.query(query, {'batch': batch})
+        expected_result = [[j, 0, 17, 49, None, 33] for j in range(10)]
+        self.env.assertEquals(query_result.result_set, expected_result)
+
+        # key order doesn't affect map equality
+        query = "RETURN $a = $b"
+        b = dict(reversed(list(row.items())))
+        query_result = redis_graph.query(query, {'a': row, 'b': b})
+        self.env.assertEquals(query_result.result_set, [[True]])
+
+        query = "WITH $a AS m RETURN m"
+        query_result = redis_graph.query(query, {'a': row})
+        self.env.assertEquals(query_result.result_set, [[row]])
@@ -0,0 +1,130 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "materialized_views"
+redis_con = None
+redis_graph = None
+
+class testMaterializedViews(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE (:L {c: x % 2, v: x})")
+
+    def create(self, name, query):
+        return redis_con.execute_command("GRAPH.VIEW", "CREATE", GRAPH_ID, name, query)
+
+    # returns the view's rows, sorted
+    def read(self, name):
+        reply = redis_con.execute_command("GRAPH.VIEW", "READ", GRAPH_ID, name)
+        return sorted(reply[1])
+
+    # returns the rows of the view's defining query, sorted
+    # both are verbose replies, doubles are reported as strings
+    def query(self, query):
+        reply = redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, query)
+        return sorted(reply[1])
+
+    def test01_create(self):
+        query = "MATCH (n:L) RETURN n.c AS c, count(n), sum(n.v), min(n.v), max(n.v)"
+        self.env.assertEquals(self.create("per_c", query), "OK")
+
+        reply = redis_con.execute_command("GRAPH.VIEW", "READ", GRAPH_ID, "per_c")
+        self.env.assertEquals(reply[0], ["c", "count(n)", "sum(n.v)", "min(n.v)", "max(n.v)"])
+        self.env.assertEquals(self.read("per_c"), [[0, 5, "30", 2, 10], [1, 5, "25", 1, 9]])
+
+        views = redis_con.execute_command("GRAPH.VIEW", "LIST", GRAPH_ID)
+        self.env.assertEquals(views, [["per_c", query]])
+
+    def test02_incremental_updates(self):
+        query = "MATCH (n:L) RETURN n.c AS c, count(n), sum(n.v), min(n.v), max(n.v)"
+
+        redis_graph.query("CREATE (:L {c: 2, v: 100}), (:Other {c: 0, v: 1000})")
+        self.env.assertEquals(self.read("per_c"), self.query(query))
+
+        # moving a node between groups
+        redis_graph.query("MATCH (n:L {v: 1}) SET n.c = 2")
+        self.env.assertEquals(self.read("per_c"), self.query(query))
+
+        redis_graph.query("MATCH (n:L {c: 2}) DELETE n")
+        self.env.assertEquals(self.read("per_c"), self.query(query))
+        self.env.assertEquals(len(self.read("per_c")), 2)
+
+    def test03_retracted_extremum(self):
+        query = "MATCH (n:L) RETURN n.c AS c, min(n.v), max(n.v)"
+        self.create("extremum", query)
+
+        redis_graph.query("MATCH (n:L {v: 10}) DELETE n")
+        redis_graph.query("MATCH (n:L {v: 2}) SET n.v = 20")
+        self.env.assertEquals(self.read("extremum"), self.query(query))
+
+    def test04_global_aggregate(self):
+        query = "MATCH (n:L) RETURN count(n), sum(n.v)"
+        self.create("totals", query)
+        self.env.assertEquals(self.read("totals"), self.query(query))
+
+        # a view without grouping keys reports a row once every node is deleted
+        redis_graph.query("MATCH (n:L) DELETE n")
+        self.env.assertEquals(self.read("totals")[0][0], 0)
+
+        redis_graph.query("CREATE (:L {c: 1, v: 7})")
+        self.env.assertEquals(self.read("totals"), [[1, "7"]])
+
+    def test05_unsupported_queries(self):
+        queries = ["MATCH (n:L) WHERE n.v > 1 RETURN count(n)",
+                   "MATCH (n:L)-[]->(m) RETURN count(m)",
+                   "MATCH (n:L) RETURN n.c, avg(n.v)",
+                   "MATCH (n:L) RETURN count(n) ORDER BY count(n)",
+                   "CREATE (:L)",
+                   "MATCH (n:L RETURN n"]
+        for query in queries:
+            try:
+                self.create("unsupported", query)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+        views = redis_con.execute_command("GRAPH.VIEW", "LIST", GRAPH_ID)
+        self.env.assertNotContains("unsupported", [v[0] for v in views])
+
+    def test06_drop(self):
+        self.env.assertEquals(redis_con.execute_command("GRAPH.VIEW", "DROP", GRAPH_ID, "totals"), "OK")
+        try:
+            redis_con.execute_command("GRAPH.VIEW", "READ", GRAPH_ID, "totals")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("Unknown view", str(e))
+
+    def test07_read_only(self):
+        query = "MATCH (n:L) RETURN n.c AS c, count(n), sum(n.v), min(n.v), max(n.v)"
+        reply = redis_con.execute_command("GRAPH.RO_VIEW", "READ", GRAPH_ID, "per_c")
+        self.env.assertEquals(sorted(reply[1]), self.query(query))
+
+        views = redis_con.execute_command("GRAPH.RO_VIEW", "LIST", GRAPH_ID)
+        self.env.assertContains("per_c", [v[0] for v in views])
+
+        # views are only modified by GRAPH.VIEW
+        for args in [["CREATE", GRAPH_ID, "ro", query], ["DROP", GRAPH_ID, "per_c"]]:
+            try:
+                redis_con.execute_command("GRAPH.RO_VIEW", *args)
+                self.env.assertTrue(False)
+            except Exception as e:
+                self.env.assertIn("READ or LIST", str(e))
+
+    def test08_persisted(self):
+        query = "MATCH (n:L) RETURN n.c AS c, count(n), sum(n.v), min(n.v), max(n.v)"
+        views = redis_con.execute_command("GRAPH.VIEW", "LIST", GRAPH_ID)
+
+        redis_con.execute_command("DEBUG", "RELOAD")
+
+        # views are restored by their definition, populated from the loaded graph
+        self.env.assertEquals(redis_con.execute_command("GRAPH.VIEW", "LIST", GRAPH_ID), views)
+        self.env.assertEquals(self.read("per_c"), self.query(query))
+
+        redis_graph.query("CREATE (:L {c: 3, v: 5})")
+        self.env.assertEquals(self.read("per_c"), self.query(query))
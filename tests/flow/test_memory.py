@@ -0,0 +1,56 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "memory"
+redis_con = None
+redis_graph = None
+
+class testMemory(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("""UNWIND range(1, 1000) AS x
+                             CREATE (:A {v: x, s: 'a long string property ' + toString(x)})-[:R {w: x}]->(:B {v: x})""")
+        redis_graph.query("UNWIND range(1, 10) AS x MATCH (a:A {v: x}) CREATE (a)-[:S]->(a)")
+        redis_graph.query("CREATE INDEX ON :A(v)")
+
+    def memory(self):
+        reply = redis_con.execute_command("GRAPH.MEMORY", GRAPH_ID)
+        return dict(zip(reply[0::2], reply[1::2]))
+
+    def test01_breakdown(self):
+        memory = self.memory()
+        for component in ["nodes", "edges", "node_properties", "edge_properties",
+                          "indexes", "cache", "adjacency"]:
+            self.env.assertGreater(memory[component], 0)
+
+        labels = dict(zip(memory["labels"][0::2], memory["labels"][1::2]))
+        relations = dict(zip(memory["relations"][0::2], memory["relations"][1::2]))
+        self.env.assertEquals(sorted(labels.keys()), ["A", "B"])
+        self.env.assertEquals(sorted(relations.keys()), ["R", "S"])
+        # a relation type holding more edges requires more memory
+        self.env.assertGreater(relations["R"], relations["S"])
+
+        # total sums up all components
+        total = sum(v for k, v in memory.items() if k not in ["labels", "relations", "total"])
+        total += sum(labels.values()) + sum(relations.values())
+        self.env.assertEquals(memory["total"], total)
+
+    def test02_properties(self):
+        before = self.memory()
+        redis_graph.query("MATCH (a:A) SET a.t = 'another long string property'")
+        after = self.memory()
+        self.env.assertGreater(after["node_properties"], before["node_properties"])
+        self.env.assertEquals(after["edge_properties"], before["edge_properties"])
+
+    def test03_missing_graph(self):
+        try:
+            redis_con.execute_command("GRAPH.MEMORY", "missing_graph")
+            self.env.assertTrue(False)
+        except:
+            pass
@@ -0,0 +1,112 @@
+import threading
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "metrics"
+redis_con = None
+redis_graph = None
+
+class testMetrics(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 100) AS x CREATE (:L {v: x})-[:R]->(:L {v: x})")
+        redis_graph.query("CREATE INDEX ON :L(v)")
+
+    # returns the module INFO field ending with 'name'
+    # redis prefixes module fields by the module name
+    def info_field(self, name):
+        info = redis_con.info("everything")
+        for key in info:
+            if key.endswith(name):
+                return info[key]
+        return None
+
+    def test01_latency(self):
+        before = self.info_field("latency_ro_query")["count"]
+        for i in range(10):
+            redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, "MATCH (n:L) WHERE n.v = %d RETURN n" % i)
+
+        latency = self.info_field("latency_ro_query")
+        self.env.assertEquals(latency["count"], before + 10)
+        self.env.assertLessEqual(float(latency["p50_ms"]), float(latency["p99_ms"]))
+        self.env.assertLessEqual(float(latency["p99_ms"]), float(latency["max_ms"]))
+
+        # per graph latency
+        latency = self.info_field(GRAPH_ID + "_latency_ro_query")
+        self.env.assertGreaterEqual(latency["count"], 10)
+
+    def test02_cache_counters(self):
+        hits = self.info_field("cache_hits")
+        misses = self.info_field("cache_misses")
+
+        q = "MATCH (n:L) RETURN count(n)"
+        redis_graph.query(q)
+        redis_graph.query(q)
+
+        self.env.assertEquals(self.info_field("cache_misses"), misses + 1)
+        self.env.assertEquals(self.info_field("cache_hits"), hits + 1)
+
+    def test03_queue(self):
+        max_queued = redis_con.execute_command("GRAPH.CONFIG", "GET", "MAX_QUEUED_QUERIES")[1]
+        self.env.assertEquals(self.info_field("max_queued_queries"), max_queued)
+        self.env.assertGreaterEqual(self.info_field("queued_queries"), 0)
+        self.env.assertEquals(self.info_field("rejected_queries"), 0)
+
+    def test04_timeout(self):
+        timed_out = self.info_field("timed_out_queries")
+        try:
+            redis_graph.query("UNWIND range(0, 100000000) AS x RETURN count(x)", timeout=1)
+            self.env.assertTrue(False)
+        except:
+            pass
+        self.env.assertEquals(self.info_field("timed_out_queries"), timed_out + 1)
+
+    def test05_memory(self):
+        graph = self.info_field(GRAPH_ID)
+        self.env.assertGreater(graph["memory_entities"], 0)
+        self.env.assertGreater(graph["memory_matrices"], 0)
+        self.env.assertGreater(graph["memory_indexes"], 0)
+        self.env.assertGreater(graph["memory_cache"], 0)
+
+        # module totals cover every graph
+        self.env.assertGreaterEqual(self.info_field("_memory_entities"),
+                                    graph["memory_entities"])
+
+    def test06_delete(self):
+        before = self.info_field("latency_delete")["count"]
+        Graph("metrics_tmp", redis_con).query("CREATE ()")
+        redis_con.execute_command("GRAPH.DELETE", "metrics_tmp")
+        self.env.assertEquals(self.info_field("latency_delete")["count"], before + 1)
+
+    def test07_lock_wait(self):
+        graph = self.info_field(GRAPH_ID)
+        before = [float(graph[f]) for f in ["read_lock_wait_ms", "write_lock_wait_ms", "writers_wait_ms"]]
+        gil_wait = float(self.info_field("gil_wait_time_ms"))
+        for v in before + [gil_wait]:
+            self.env.assertGreaterEqual(v, 0)
+
+        # concurrent writers contend for the graph's locks
+        def write(env):
+            con = env.getConnection()
+            for _ in range(10):
+                con.execute_command("GRAPH.QUERY", GRAPH_ID, "UNWIND range(1, 100) AS x CREATE (:W {v: x})")
+        threads = [threading.Thread(target=write, args=(self.env,)) for _ in range(4)]
+        for t in threads:
+            t.start()
+        for i in range(20):
+            redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, "MATCH (n:L) WHERE n.v = %d RETURN n" % i)
+        for t in threads:
+            t.join()
+
+        # wait times only accumulate
+        graph = self.info_field(GRAPH_ID)
+        after = [float(graph[f]) for f in ["read_lock_wait_ms", "write_lock_wait_ms", "writers_wait_ms"]]
+        for b, a in zip(before, after):
+            self.env.assertGreaterEqual(a, b)
+        self.env.assertGreaterEqual(float(self.info_field("gil_wait_time_ms")), gil_wait)
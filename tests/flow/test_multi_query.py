@@ -0,0 +1,60 @@
+from RLTest import Env
+from redis import ResponseError
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "multi_query"
+redis_con = None
+
+class testMultiQuery(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        graph.query("UNWIND range(0, 9) AS x CREATE (:L {v: x})")
+
+    def test01_batched_results(self):
+        queries = ["MATCH (n:L) WHERE n.v < 3 RETURN n.v ORDER BY n.v",
+                   "CYPHER v=5 MATCH (n:L {v: $v}) RETURN n.v",
+                   "MATCH (n:L) RETURN count(n)"]
+        res = redis_con.execute_command("GRAPH.MULTI_QUERY", GRAPH_ID, *queries)
+
+        # a result-set per query, in order
+        self.env.assertEquals(len(res), 3)
+        self.env.assertEquals(res[0][0], ["n.v"])
+        self.env.assertEquals(res[0][1], [[0], [1], [2]])
+        self.env.assertEquals(res[1][1], [[5]])
+        self.env.assertEquals(res[2][1], [[10]])
+
+        # results match those of individual queries
+        for q, r in zip(queries, res):
+            single = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q)
+            self.env.assertEquals(r[0:2], single[0:2])
+
+    def test02_per_query_errors(self):
+        queries = ["MATCH (n:L) RETURN count(n)",
+                   "CREATE (:L {v: 10})",
+                   "MATCH (n:L RETURN n",
+                   "RETURN 1"]
+        res = redis_con.execute_command("GRAPH.MULTI_QUERY", GRAPH_ID, *queries)
+
+        # failing queries don't affect the rest of the batch
+        self.env.assertEquals(len(res), 4)
+        self.env.assertEquals(res[0][1], [[10]])
+        self.env.assertTrue(isinstance(res[1], ResponseError))
+        self.env.assertContains("read-only", str(res[1]))
+        self.env.assertTrue(isinstance(res[2], ResponseError))
+        self.env.assertEquals(res[3][1], [[1]])
+
+        # the write query wasn't executed
+        res = redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, "MATCH (n:L) RETURN count(n)")
+        self.env.assertEquals(res[1], [[10]])
+
+    def test03_arity(self):
+        try:
+            redis_con.execute_command("GRAPH.MULTI_QUERY", GRAPH_ID)
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("wrong number of arguments", str(e))
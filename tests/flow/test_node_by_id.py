@@ -239,3 +239,38 @@ class testNodeByIDFlow(FlowTestsBase):
             resultset = redis_graph.query(query).result_set        
             self.env.assertEquals(len(resultset), 0)    # Expecting no results.
             self.env.assertIn("Node By Label and ID Scan", redis_graph.execution_plan(query))
+
+    # Fetch a list of entities by their IDs.
+    def test_id_list_seek(self):
+        query = """MATCH (n) WHERE ID(n) IN [7, 2, null, 2, 5, 999, -1] RETURN n.id ORDER BY n.id"""
+        plan = redis_graph.execution_plan(query)
+        self.env.assertIn("NodeByIdSeek", plan)
+        self.env.assertNotIn("All Node Scan", plan)
+        self.env.assertNotIn("Filter", plan)
+        resultset = redis_graph.query(query).result_set
+        self.env.assertEquals(resultset, [[2], [5], [7]])
+
+        # Listed IDs bounded by a range.
+        query = """MATCH (n) WHERE ID(n) IN [1, 3, 8] AND ID(n) > 2 RETURN n.id ORDER BY n.id"""
+        self.env.assertIn("NodeByIdSeek", redis_graph.execution_plan(query))
+        resultset = redis_graph.query(query).result_set
+        self.env.assertEquals(resultset, [[3], [8]])
+
+        # IDs supplied by a parameter.
+        query = """MATCH (n) WHERE ID(n) IN $ids RETURN n.id ORDER BY n.id"""
+        resultset = redis_graph.query(query, {'ids': [9, 0, 4]}).result_set
+        self.env.assertEquals(resultset, [[0], [4], [9]])
+        resultset = redis_graph.query(query, {'ids': []}).result_set
+        self.env.assertEquals(resultset, [])
+
+        # Label scans are bounded by the listed IDs.
+        query = """MATCH (n:person) WHERE ID(n) IN [6, 1, 3] RETURN n.id ORDER BY n.id"""
+        self.env.assertIn("Node By Label and ID Scan", redis_graph.execution_plan(query))
+        resultset = redis_graph.query(query).result_set
+        self.env.assertEquals(resultset, [[1], [3], [6]])
+
+        # List holding non integer values isn't reduced.
+        query = """MATCH (n) WHERE ID(n) IN [1, 'a'] RETURN n.id"""
+        self.env.assertNotIn("NodeByIdSeek", redis_graph.execution_plan(query))
+        resultset = redis_graph.query(query).result_set
+        self.env.assertEquals(resultset, [[1]])
@@ -0,0 +1,74 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+graph = None
+
+class testNodeSimilarity(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph("proc_node_similarity", redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # users a, b and c bought items x, y and z
+        # a->{x, y}, b->{x, y, z}, c->{z}
+        q = """CREATE (a:U {v: 'a'}), (b:U {v: 'b'}), (c:U {v: 'c'}),
+                      (x:I {v: 'x'}), (y:I {v: 'y'}), (z:I {v: 'z'}),
+                      (a)-[:B]->(x), (a)-[:B]->(y), (b)-[:B]->(x),
+                      (b)-[:B]->(y), (b)-[:B]->(z), (c)-[:B]->(z)"""
+        graph.query(q)
+
+    def _similarity(self, config):
+        q = """CALL algo.nodeSimilarity('U', 'B', %s)
+               YIELD node1, node2, similarity
+               RETURN node1.v, node2.v, similarity
+               ORDER BY node1.v, node2.v""" % config
+        return graph.query(q).result_set
+
+    def _validate(self, actual, expected):
+        self.env.assertEquals(len(actual), len(expected))
+        for row, expected_row in zip(actual, expected):
+            self.env.assertEquals(row[:2], expected_row[:2])
+            self.env.assertAlmostEqual(row[2], expected_row[2], 1e-6)
+
+    def test01_jaccard(self):
+        # a and c share no item
+        expected = [['a', 'b', 2 / 3], ['b', 'a', 2 / 3],
+                    ['b', 'c', 1 / 3], ['c', 'b', 1 / 3]]
+        self._validate(self._similarity('NULL'), expected)
+        self._validate(self._similarity("{metric: 'jaccard'}"), expected)
+
+    def test02_metrics(self):
+        expected = [['a', 'b', 1.0], ['b', 'a', 1.0],
+                    ['b', 'c', 1.0], ['c', 'b', 1.0]]
+        self._validate(self._similarity("{metric: 'overlap'}"), expected)
+
+        expected = [['a', 'b', 2 / 6 ** 0.5], ['b', 'a', 2 / 6 ** 0.5],
+                    ['b', 'c', 1 / 3 ** 0.5], ['c', 'b', 1 / 3 ** 0.5]]
+        self._validate(self._similarity("{metric: 'cosine'}"), expected)
+
+    def test03_top_k_and_cutoff(self):
+        expected = [['a', 'b', 2 / 3], ['b', 'a', 2 / 3], ['c', 'b', 1 / 3]]
+        self._validate(self._similarity("{topK: 1}"), expected)
+
+        expected = [['a', 'b', 2 / 3], ['b', 'a', 2 / 3]]
+        self._validate(self._similarity("{similarityCutoff: 0.5}"), expected)
+
+    def test04_invalid_config(self):
+        configs = ["{metric: 'euclidean'}", "{topK: 0}", "{similarityCutoff: 'a'}",
+                   "{k: 1}"]
+        for config in configs:
+            try:
+                self._similarity(config)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+    def test05_unknown_schema(self):
+        q = """CALL algo.nodeSimilarity('L', NULL) YIELD node1
+               RETURN count(node1)"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[0]])
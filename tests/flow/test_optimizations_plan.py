@@ -288,6 +288,8 @@ class testOptimizationsPlan(FlowTestsBase):
         query = """MATCH (p1), (p2), (p3), (p4) WHERE p1.val + p2.val = p3.val AND p3.val > 0 RETURN DISTINCT p3.name ORDER BY p3.name"""
         executionPlan = graph.execution_plan(query)
         self.env.assertEqual(2, executionPlan.count("Cartesian Product"))
+        # p1 and p2 are joined with p3 rather than filtered
+        self.env.assertIn("Value Hash Join", executionPlan)
         expected = [['Ailon'],
                     ['Alon'],
                     ['Boaz']]
@@ -374,7 +376,7 @@ class testOptimizationsPlan(FlowTestsBase):
         profile = [x[0:x.index(',')].strip() for x in profile]
 
         # make sure 'a' to 'b' traversal operation is aware of limit
-        self.env.assertIn("Conditional Traverse | (a)->(b) | Records produced: 1", profile)
+        self.env.assertIn("Conditional Traverse | (a)->(b) | Batch size: 1 | Records produced: 1", profile)
 
         # query with LIMIT 1
         query = """CYPHER l=1 MATCH (a), (b) WITH a AS a, b AS b
@@ -431,3 +433,299 @@ class testOptimizationsPlan(FlowTestsBase):
                     [0, 3],
                     [0, 3]]
         self.env.assertEqual(resultset, expected)
+
+    def test28_grouped_counts(self):
+        # count grouped by label
+        query = """MATCH (n) RETURN labels(n), count(n)"""
+        resultset = graph.query(query).result_set
+        executionPlan = graph.execution_plan(query)
+        self.env.assertIn("Unwind", executionPlan)
+        self.env.assertNotIn("All Node Scan", executionPlan)
+        self.env.assertNotIn("Aggregate", executionPlan)
+        self.env.assertEqual(resultset, [["person", 4]])
+
+        # count grouped by relationship type
+        query = """MATCH ()-[r]->() RETURN type(r) AS t, count(*) AS c"""
+        resultset = graph.query(query).result_set
+        executionPlan = graph.execution_plan(query)
+        self.env.assertIn("Unwind", executionPlan)
+        self.env.assertNotIn("Conditional Traverse", executionPlan)
+        self.env.assertNotIn("Aggregate", executionPlan)
+        self.env.assertEqual(sorted(resultset), [["know", 24], ["works_with", 12]])
+
+        # a labeled destination filters edges, count can't be reduced
+        query = """MATCH ()-[r]->(:person) RETURN type(r), count(r)"""
+        executionPlan = graph.execution_plan(query)
+        self.env.assertIn("Aggregate", executionPlan)
+
+    def test29_indexed_min_max(self):
+        graph.query("CREATE INDEX ON :person(val)")
+
+        query = """MATCH (n:person) RETURN min(n.val), max(n.val)"""
+        executionPlan = graph.execution_plan(query)
+        # two aggregations are computed by scanning
+        self.env.assertIn("Aggregate", executionPlan)
+
+        for func, expected in [("min", 0), ("max", 3)]:
+            query = """MATCH (n:person) RETURN %s(n.val)""" % func
+            resultset = graph.query(query).result_set
+            executionPlan = graph.execution_plan(query)
+            self.env.assertNotIn("Node By Label Scan", executionPlan)
+            self.env.assertNotIn("Aggregate", executionPlan)
+            self.env.assertEqual(resultset, [[expected]])
+
+        # a non numeric value isn't covered by the index
+        graph.query("MATCH (n:person {val: 0}) SET n.val = 'zero'")
+        query = """MATCH (n:person) RETURN min(n.val)"""
+        executionPlan = graph.execution_plan(query)
+        self.env.assertIn("Aggregate", executionPlan)
+
+        # restore
+        graph.query("MATCH (n:person {val: 'zero'}) SET n.val = 0")
+        graph.query("DROP INDEX ON :person(val)")
+
+    def test30_degree_aggregation(self):
+        # count grouped by a traversal's source is read from node degrees
+        query = """MATCH (n:person)-[:works_with]->() WITH n, count(*) AS d ORDER BY d DESC LIMIT 2 RETURN n.val, d"""
+        resultset = graph.query(query).result_set
+        executionPlan = graph.execution_plan(query)
+        self.env.assertNotIn("Conditional Traverse", executionPlan)
+        self.env.assertNotIn("Aggregate", executionPlan)
+        self.env.assertEqual(len(resultset), 2)
+        for row in resultset:
+            self.env.assertEqual(row[1], 3)
+
+        # incoming edges, counting every edge of multi-edge connections
+        query = """MATCH (n:person)<-[r:know]-() WITH n, count(r) AS d RETURN n.val, d ORDER BY n.val"""
+        resultset = graph.query(query).result_set
+        executionPlan = graph.execution_plan(query)
+        self.env.assertNotIn("Aggregate", executionPlan)
+        self.env.assertEqual(resultset, [[0, 6], [1, 6], [2, 6], [3, 6]])
+
+        # without an edge alias connected pairs are counted only once
+        query = """MATCH (n:person)-[:know]->() WITH n, count(*) AS d RETURN n.val, d ORDER BY n.val"""
+        resultset = graph.query(query).result_set
+        executionPlan = graph.execution_plan(query)
+        self.env.assertIn("Aggregate", executionPlan)
+        self.env.assertEqual(resultset, [[0, 3], [1, 3], [2, 3], [3, 3]])
+
+        # degrees are maintained by subsequent modifications
+        graph.query("MATCH (a:person {val: 0}), (b:person {val: 1}) CREATE (a)-[:works_with]->(b)")
+        query = """MATCH (n:person {val: 0}) RETURN outdegree(n, 'works_with'), indegree(n, 'works_with')"""
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(resultset, [[4, 3]])
+
+        graph.query("""MATCH (:person {val: 0})-[r:works_with]->(:person {val: 1}) WITH r LIMIT 1 DELETE r""")
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(resultset, [[3, 3]])
+
+    def test31_skip_limit_propagation(self):
+        graph_id = "limit-propagation"
+        graph = Graph(graph_id, redis_con)
+
+        # traversal is required to produce skipped records as well
+        query = """MATCH (a)-[]->(b) WITH b AS b MATCH (b)-[]->(c) RETURN c SKIP 2 LIMIT 1"""
+        profile = redis_con.execute_command("GRAPH.PROFILE", graph_id, query)
+        profile = [x[0:x.index(',')].strip() for x in profile]
+        self.env.assertIn("Conditional Traverse | (a)->(b) | Batch size: 3 | Records produced: 3", profile)
+
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(len(resultset), 1)
+
+        # sort consumes all of its input regardless of the limit
+        query = """MATCH (a)-[]->(b) RETURN b ORDER BY ID(b) SKIP 2 LIMIT 3"""
+        profile = redis_con.execute_command("GRAPH.PROFILE", graph_id, query)
+        profile = [x[0:x.index(',')].strip() for x in profile]
+        traverse = [x for x in profile if x.startswith("Conditional Traverse | (a)->(b)")]
+        self.env.assertEqual(len(traverse), 1)
+        self.env.assertTrue(traverse[0].endswith("Records produced: 130"))
+
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(len(resultset), 3)
+
+        # pattern predicates only require a single match
+        query = """MATCH (a) WHERE (a)-[]->() RETURN a SKIP 1 LIMIT 2"""
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(len(resultset), 2)
+
+        # variable length traversals stop once enough records were produced
+        query = """MATCH (a)-[*]->(b) RETURN b SKIP 10 LIMIT 5"""
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(len(resultset), 5)
+
+    def test32_cartesian_product_materialization(self):
+        # every branch but the last is consumed once
+        query = """MATCH (a:person), (b:person), (c:person) RETURN count(*)"""
+        profile = redis_con.execute_command("GRAPH.PROFILE", "g", query)
+        profile = [x[0:x.index(',')].strip() for x in profile]
+        scans = [x for x in profile if x.startswith("Node By Label Scan")]
+        self.env.assertEqual(len(scans), 3)
+        for scan in scans:
+            self.env.assertTrue(scan.endswith("Records produced: 4"))
+
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(resultset, [[64]])
+
+        # heap allocated values of materialized branches are emitted to every combination
+        query = """MATCH p=(a:person {name: 'Roi'})-[:know]->(), (b:person) RETURN b.name, length(p), nodes(p)[0].name ORDER BY b.name"""
+        resultset = graph.query(query).result_set
+        # Roi knows each of the 3 other people through 2 edges
+        expected = [[name, 1, 'Roi'] for name in sorted(people) for _ in range(6)]
+        self.env.assertEqual(resultset, expected)
+
+        # branches depending on their input are materialized for each input
+        query = """MATCH (x:person) OPTIONAL MATCH (a:person), (b:person) WHERE a.val = x.val RETURN x.name, count(b) ORDER BY x.name"""
+        resultset = graph.query(query).result_set
+        expected = [[name, 4] for name in sorted(people)]
+        self.env.assertEqual(resultset, expected)
+
+    def test33_stream_aggregates(self):
+        # records of each scanned node are consecutive, groups are emitted as they complete
+        query = """MATCH (a:person)-[]->(b) RETURN a.name, count(b) ORDER BY a.name"""
+        resultset = graph.query(query).result_set
+        expected = [[name, 6] for name in sorted(people)]
+        self.env.assertEqual(resultset, expected)
+
+        # null keys of distinct nodes form distinct groups
+        query = """MATCH (a:person)-[]->(b) RETURN id(a), a.missing, count(b)"""
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(len(resultset), len(people))
+        for row in resultset:
+            self.env.assertEqual(row[1:], [None, 6])
+
+        stream_graph = Graph("stream_aggregates", redis_con)
+        stream_graph.query("UNWIND range(0, 99) AS x CREATE (:S {v: x % 10})")
+        stream_graph.query("CREATE INDEX ON :S(v)")
+
+        # a single group is computed to satisfy the limit
+        query = """MATCH (s:S) RETURN s, count(*) LIMIT 1"""
+        profile = redis_con.execute_command("GRAPH.PROFILE", "stream_aggregates", query)
+        profile = [x[0:x.index(',')].strip() for x in profile]
+        self.env.assertIn("Node By Label Scan | (s:S) | Records produced: 2", profile)
+
+        # range index scans report nodes in the order of the grouping attribute
+        query = """MATCH (s:S) WHERE s.v > 0 RETURN s.v, count(*)"""
+        plan = stream_graph.execution_plan(query)
+        self.env.assertIn("Index Scan", plan)
+        resultset = stream_graph.query(query).result_set
+        expected = [[v, 10] for v in range(1, 10)]
+        self.env.assertEqual(resultset, expected)
+
+    def test34_semi_apply_decorrelation(self):
+        # past a number of bound nodes, the pattern predicate is evaluated once for all of them
+        semi_graph = Graph("semi_join", redis_con)
+        semi_graph.query("UNWIND range(0, 9) AS x CREATE (:L {cat: x % 2})")
+        semi_graph.query("UNWIND range(0, 199) AS x MATCH (l:L) WHERE id(l) = x % 10 AND x % 3 = 0 CREATE (:U {v: x})-[:R]->(l)")
+        semi_graph.query("UNWIND range(0, 99) AS x CREATE (:U {v: -1})")
+
+        # U nodes with v % 3 = 0 are connected to L nodes with cat = x % 2
+        query = """MATCH (u:U) WHERE (u)-[:R]->(:L {cat: $c}) RETURN count(u)"""
+        expected = len([x for x in range(200) if x % 3 == 0 and x % 2 == 1])
+        resultset = semi_graph.query(query, {'c': 1}).result_set
+        self.env.assertEqual(resultset[0][0], expected)
+
+        query = """MATCH (u:U) WHERE NOT (u)-[:R]->(:L {cat: $c}) RETURN count(u)"""
+        resultset = semi_graph.query(query, {'c': 1}).result_set
+        self.env.assertEqual(resultset[0][0], 300 - expected)
+
+        # unfiltered destinations
+        query = """MATCH (u:U) WHERE (u)-[:R]->() RETURN count(u)"""
+        resultset = semi_graph.query(query).result_set
+        self.env.assertEqual(resultset[0][0], len(range(0, 200, 3)))
+
+    def test35_edge_by_type_scan(self):
+        # relationship-only patterns scan the relation rather than every node
+        edge_graph = Graph("edge_scan", redis_con)
+        edge_graph.query("UNWIND range(0, 99) AS x CREATE (:N {v: x})")
+        edge_graph.query("MATCH (a:N), (b:N) WHERE b.v = a.v + 1 AND a.v % 10 = 0 CREATE (a)-[:R {x: a.v % 20}]->(b), (a)-[:R {x: 1}]->(b)")
+        edge_graph.query("MATCH (a:N {v: 5}), (b:N {v: 6}) CREATE (a)-[:S {x: 0}]->(b)")
+        edge_graph.query("MATCH (a:N {v: 7}) CREATE (a)-[:R {x: 1}]->(:M {v: 100})")
+
+        # each query is compared against its label scan counterpart, traversing from every N
+        queries = [("MATCH ()-[e:R]->() WHERE e.x = 1 RETURN count(e)",
+                    "MATCH (:N)-[e:R]->() WHERE e.x = 1 RETURN count(e)"),
+                   ("MATCH (a)-[e:R]->(b) RETURN a.v, e.x, b.v ORDER BY a.v, e.x, b.v",
+                    "MATCH (a:N)-[e:R]->(b) RETURN a.v, e.x, b.v ORDER BY a.v, e.x, b.v"),
+                   ("MATCH (b)<-[e:R]-(a) WHERE e.x = 0 RETURN a.v, b.v ORDER BY a.v",
+                    "MATCH (b)<-[e:R]-(a:N) WHERE e.x = 0 RETURN a.v, b.v ORDER BY a.v")]
+
+        for query, expected_query in queries:
+            plan = edge_graph.execution_plan(query)
+            self.env.assertIn("Edge By Type Scan", plan)
+            self.env.assertNotIn("All Node Scan", plan)
+            expected = edge_graph.query(expected_query).result_set
+            self.env.assertEqual(edge_graph.query(query).result_set, expected)
+
+        resultset = edge_graph.query(queries[0][0]).result_set
+        self.env.assertEqual(resultset, [[11]])
+
+        # unreferenced edges and multi-typed edges are traversed
+        for query in ["MATCH (a)-[:R]->(b) RETURN a.v, b.v",
+                      "MATCH (a)-[e:R|S]->(b) RETURN e"]:
+            plan = edge_graph.execution_plan(query)
+            self.env.assertNotIn("Edge By Type Scan", plan)
+
+    def test36_late_materialization(self):
+        # attributes other than sort keys are fetched once records were sorted and limited
+        query = """MATCH (n:person) RETURN n.name, n.val ORDER BY n.val DESC LIMIT 2"""
+        plan = graph.execution_plan(query)
+        self.env.assertEqual(plan.count("Project"), 2)
+        resultset = graph.query(query).result_set
+        self.env.assertEqual(resultset, [["Boaz", 3], ["Ailon", 2]])
+
+        query = """MATCH (n:person) RETURN n.name AS name, n, n.val ORDER BY n.val SKIP 1 LIMIT 2"""
+        resultset = graph.query(query).result_set
+        self.env.assertEqual([[row[0], row[1].properties["name"], row[2]] for row in resultset],
+                             [["Alon", "Alon", 1], ["Ailon", "Ailon", 2]])
+
+        # attributes sorted by and unlimited sorts are projected eagerly
+        for query in ["""MATCH (n:person) RETURN n.name AS name ORDER BY name LIMIT 2""",
+                      """MATCH (n:person) RETURN n.name ORDER BY n.val"""]:
+            plan = graph.execution_plan(query)
+            self.env.assertEqual(plan.count("Project"), 1)
+
+        resultset = graph.query("""MATCH (n:person) RETURN n.name AS name ORDER BY name LIMIT 2""").result_set
+        self.env.assertEqual(resultset, [["Ailon"], ["Alon"]])
+
+    def test37_edge_by_id_seek(self):
+        # edges filtered by ID are fetched by ID along with their endpoints
+        seek_graph = Graph("edge_seek", redis_con)
+        seek_graph.query("UNWIND range(0, 9) AS x CREATE (:N {v: x})")
+        seek_graph.query("MATCH (a:N), (b:N) WHERE b.v = a.v + 1 CREATE (a)-[:R {x: a.v}]->(b), (a)-[:S {x: a.v}]->(b)")
+        seek_graph.query("MATCH (a:N {v: 0}) CREATE (a)-[:R {x: 100}]->(:M {v: 100})")
+
+        ids = seek_graph.query("MATCH ()-[e]->() RETURN id(e) ORDER BY id(e)").result_set
+        ids = [row[0] for row in ids]
+        queries = ["MATCH (a)-[e]->(b) WHERE id(e) = $id RETURN a.v, type(e), e.x, b.v",
+                   "MATCH (b)<-[e]-(a) WHERE id(e) = $id RETURN a.v, type(e), e.x, b.v",
+                   "MATCH (a)-[e:S]->(b) WHERE id(e) = $id RETURN a.v, type(e), e.x, b.v",
+                   "MATCH (a)-[e]->(b:M) WHERE $id = id(e) RETURN a.v, type(e), e.x, b.v"]
+
+        for query in queries:
+            plan = seek_graph.execution_plan(query.replace("$id", str(ids[0])))
+            self.env.assertIn("Edge By Id Seek", plan)
+            self.env.assertNotIn("All Node Scan", plan)
+            self.env.assertNotIn("Filter", plan)
+
+            # compare against a scan filtering every edge
+            for id in ids + [ids[-1] + 1]:
+                expected = seek_graph.query(query.replace("id(e)", "toInteger(id(e))"), {'id': id}).result_set
+                actual = seek_graph.query(query, {'id': id}).result_set
+                self.env.assertEqual(actual, expected)
+
+        query = "MATCH (a)-[e]->(b) WHERE id(e) IN $ids RETURN id(e), a.v, b.v ORDER BY id(e)"
+        plan = seek_graph.execution_plan(query.replace("$ids", str([ids[3], ids[1]])))
+        self.env.assertIn("Edge By Id Seek", plan)
+        resultset = seek_graph.query(query, {'ids': [ids[3], ids[1], ids[3], -1]}).result_set
+        expected = seek_graph.query("MATCH (a)-[e]->(b) WHERE toInteger(id(e)) IN $ids RETURN id(e), a.v, b.v ORDER BY id(e)",
+                                    {'ids': [ids[3], ids[1]]}).result_set
+        self.env.assertEqual(resultset, expected)
+        self.env.assertEqual(len(resultset), 2)
+
+        # edges deleted by ID are removed by their record
+        result = seek_graph.query("MATCH ()-[e]->() WHERE id(e) = $id DELETE e", {'id': ids[0]})
+        self.env.assertEqual(result.relationships_deleted, 1)
+        resultset = seek_graph.query("MATCH ()-[e]->() WHERE id(e) = $id RETURN e", {'id': ids[0]}).result_set
+        self.env.assertEqual(resultset, [])
+        resultset = seek_graph.query("MATCH ()-[e]->() RETURN count(e)").result_set
+        self.env.assertEqual(resultset, [[len(ids) - 1]])
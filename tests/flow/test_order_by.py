@@ -35,3 +35,36 @@ class testOrderBy(FlowTestsBase):
         q = """MATCH (n:Person) RETURN n.id, n.name ORDER BY n.id DESC, n.name ASC LIMIT 10"""
         actual_result = redis_graph.query(q)
         self.env.assertEquals(actual_result.result_set, expected)
+
+    def test_large_order_by(self):
+        # large enough for sort keys to be radix sorted
+        values = [(x * 7919) % 5000 - 2500 for x in range(5000)]
+        q = "UNWIND $values AS x RETURN x ORDER BY x"
+        actual = redis_graph.query(q, {'values': values}).result_set
+        self.env.assertEquals(actual, [[x] for x in sorted(values)])
+
+        q = "UNWIND $values AS x RETURN x ORDER BY x DESC"
+        actual = redis_graph.query(q, {'values': values}).result_set
+        self.env.assertEquals(actual, [[x] for x in sorted(values, reverse=True)])
+
+        # doubles and integers are compared by value
+        q = "UNWIND range(0, 2999) AS x RETURN CASE x % 2 WHEN 0 THEN x ELSE x - 0.5 END AS v ORDER BY v"
+        actual = redis_graph.query(q).result_set
+        expected = sorted([x if x % 2 == 0 else x - 0.5 for x in range(3000)])
+        self.env.assertEquals(actual, [[x] for x in expected])
+
+        # strings sharing long prefixes, ties resolved by the next sort key
+        q = "UNWIND range(0, 2999) AS x RETURN 'prefix_' + toString(x % 300) AS s, x ORDER BY s, x DESC"
+        actual = redis_graph.query(q).result_set
+        expected = sorted([('prefix_' + str(x % 300), x) for x in range(3000)], key=lambda t: (t[0], -t[1]))
+        self.env.assertEquals(actual, [list(t) for t in expected])
+
+        # values of different types are ordered by type
+        q = "UNWIND range(0, 1999) AS x WITH CASE x % 4 WHEN 0 THEN toString(x) WHEN 1 THEN x WHEN 2 THEN NULL ELSE x % 2 = 1 END AS v RETURN v ORDER BY v"
+        actual = [r[0] for r in redis_graph.query(q).result_set]
+        strings = sorted([str(x) for x in range(0, 2000, 4)])
+        ints = list(range(1, 2000, 4))
+        self.env.assertEquals(actual[:500], strings)
+        self.env.assertEquals(actual[500:1000], [True] * 500)
+        self.env.assertEquals(actual[1000:1500], ints)
+        self.env.assertEquals(actual[1500:], [None] * 500)
@@ -110,3 +110,98 @@ class testPagerankFlow(FlowTestsBase):
             self.env.assertAlmostEqual(resultset[0][1], 0.777813196182251, 0.0001)
             self.env.assertEqual(resultset[1][0], 1)
             self.env.assertAlmostEqual(resultset[1][1], 0.22218681871891, 0.0001)
+
+    def test_pagerank_top_k(self):
+        self.env.cmd('flushall')
+        q = "CREATE (a {v:0})-[:R]->(b {v:1})-[:R]->(c {v:2}), (d {v:3})-[:R]->(b)"
+        redis_graph.query(q)
+        q = """CALL algo.pageRank(NULL, NULL) YIELD node, score RETURN node.v, score"""
+        expected = redis_graph.query(q).result_set
+
+        q = """CALL algo.pageRank(NULL, NULL, {topK: 2}) YIELD node, score RETURN node.v, score"""
+        resultset = redis_graph.query(q).result_set
+        self.env.assertEqual(resultset, expected[:2])
+
+        # topK exceeding the number of nodes reports all nodes
+        q = """CALL algo.pageRank(NULL, NULL, {topK: 10}) YIELD node, score RETURN node.v, score"""
+        resultset = redis_graph.query(q).result_set
+        self.env.assertEqual(resultset, expected)
+
+    def test_pagerank_personalized(self):
+        self.env.cmd('flushall')
+        q = "CREATE (a:L {v:0})-[:R]->(b:L {v:1}), (c:L {v:2})-[:R]->(d:L {v:3})"
+        redis_graph.query(q)
+
+        # random jumps land on 'a' only, 'c' and 'd' are never reached
+        q = """MATCH (a:L {v:0})
+               CALL algo.pageRank('L', 'R', {sourceNodes: [a]}) YIELD node, score
+               RETURN node.v, score ORDER BY node.v"""
+        resultset = redis_graph.query(q).result_set
+        self.env.assertEqual(len(resultset), 4)
+        self.env.assertGreater(resultset[0][1], 0)
+        self.env.assertGreater(resultset[1][1], 0)
+        self.env.assertEqual(resultset[2][1], 0)
+        self.env.assertEqual(resultset[3][1], 0)
+
+        # source nodes which aren't ranked are ignored
+        q = """MATCH (a:L {v:0})
+               CREATE (x:X)
+               WITH a, x
+               CALL algo.pageRank('L', 'R', {sourceNodes: [x]}) YIELD node
+               RETURN count(node)"""
+        resultset = redis_graph.query(q).result_set
+        self.env.assertEqual(resultset, [[0]])
+
+    def test_pagerank_warm_start(self):
+        self.env.cmd('flushall')
+        q = "CREATE (a {v:0})-[:R]->(b {v:1})-[:R]->(c {v:2})-[:R]->(a), (c)-[:R]->(b)"
+        redis_graph.query(q)
+        q = """CALL algo.pageRank(NULL, NULL) YIELD node, score RETURN node.v, score ORDER BY node.v"""
+        expected = redis_graph.query(q).result_set
+
+        # store scores, then resume from them
+        q = """CALL algo.pageRank(NULL, NULL) YIELD node, score SET node.rank = score"""
+        redis_graph.query(q)
+        q = """CALL algo.pageRank(NULL, NULL, {warmStart: 'rank'}) YIELD node, score
+               RETURN node.v, score ORDER BY node.v"""
+        resultset = redis_graph.query(q).result_set
+
+        self.env.assertEqual(len(resultset), len(expected))
+        for row, expected_row in zip(resultset, expected):
+            self.env.assertEqual(row[0], expected_row[0])
+            self.env.assertAlmostEqual(row[1], expected_row[1], 0.0001)
+
+    def test_pagerank_invalid_config(self):
+        queries = [
+            "CALL algo.pageRank(NULL, NULL, {fake: 1}) YIELD node RETURN node",
+            "CALL algo.pageRank(NULL, NULL, {topK: 0}) YIELD node RETURN node",
+            "CALL algo.pageRank(NULL, NULL, {sourceNodes: 1}) YIELD node RETURN node",
+        ]
+        for q in queries:
+            try:
+                redis_graph.query(q)
+                self.env.assertTrue(False)
+            except Exception as e:
+                self.env.assertIn("algo.pageRank", str(e))
+
+    def test_pagerank_spans_multiple_batches(self):
+        # a ring of nodes, every node ranks the same
+        # node count exceeds a single block of procedure output
+        self.env.cmd('flushall')
+        node_count = 2500
+        q = """UNWIND range(0, %d) AS i CREATE (:Ring {v: i})""" % (node_count - 1)
+        redis_graph.query(q)
+        q = """MATCH (a:Ring), (b:Ring) WHERE b.v = (a.v + 1) %% %d
+               CREATE (a)-[:NEXT]->(b)""" % node_count
+        redis_graph.query(q)
+
+        q = """CALL algo.pageRank('Ring', 'NEXT') YIELD node, score
+               RETURN count(node), count(DISTINCT node.v), min(score) = max(score)"""
+        resultset = redis_graph.query(q).result_set
+        self.env.assertEqual(resultset, [[node_count, node_count, True]])
+
+        # procedure is re-invoked for every input record
+        q = """UNWIND [1, 2] AS x CALL algo.pageRank('Ring', 'NEXT') YIELD node
+               RETURN x, count(node) ORDER BY x"""
+        resultset = redis_graph.query(q).result_set
+        self.env.assertEqual(resultset, [[1, node_count], [2, node_count]])
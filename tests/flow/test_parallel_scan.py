@@ -0,0 +1,69 @@
+import os
+import sys
+from RLTest import Env
+from redisgraph import Graph, Node, Edge
+
+from base import FlowTestsBase
+
+GRAPH_ID = "parallel_scan"
+redis_graph = None
+
+# large enough for scans to evaluate their filters in parallel
+NODE_COUNT = 70000
+
+class testParallelScan(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True, moduleArgs="OMP_THREAD_COUNT 4")
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        q = "UNWIND range(1, %d) AS x CREATE (:L {v: x, s: toString(x % 10)})" % NODE_COUNT
+        redis_graph.query(q)
+        # nodes lacking attribute 'v'
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE (:L {s: 'none'})")
+
+    def test01_label_scan(self):
+        q = "MATCH (n:L) WHERE n.v > %d RETURN count(n)" % (NODE_COUNT - 10)
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[10]])
+
+        q = "MATCH (n:L) WHERE n.v <= 5 OR n.s = 'none' RETURN count(n)"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[15]])
+
+        q = "MATCH (n:L) WHERE 100 > n.v AND n.s = '3' RETURN n.v ORDER BY n.v"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[x] for x in range(3, 100, 10)])
+
+    def test02_all_node_scan(self):
+        q = "MATCH (n) WHERE n.v >= %d RETURN count(n)" % (NODE_COUNT - 9)
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[10]])
+
+        q = "MATCH (n) WHERE n.s <> 'none' RETURN count(n)"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[NODE_COUNT]])
+
+    def test03_partially_applicable_filter(self):
+        # only 'n.v < 50' can be evaluated by the scan
+        # the remaining predicate is applied by the filter operation
+        q = "MATCH (n:L) WHERE n.v < 50 AND n.v % 7 = 0 RETURN count(n)"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[7]])
+
+    def test04_parameters(self):
+        q = "CYPHER lo=10 hi=20 MATCH (n:L) WHERE n.v >= $lo AND n.v < $hi RETURN count(n)"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[10]])
+
+        q = "CYPHER lo=30 hi=35 MATCH (n:L) WHERE n.v >= $lo AND n.v < $hi RETURN count(n)"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[5]])
+
+    def test05_missing_attribute(self):
+        q = "MATCH (n:L) WHERE n.missing = 1 RETURN count(n)"
+        actual = redis_graph.query(q).result_set
+        self.env.assertEquals(actual, [[0]])
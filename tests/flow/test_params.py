@@ -107,3 +107,30 @@ class testParams(FlowTestsBase):
         plan = redis_graph.execution_plan(query)
         self.env.assertIn('NodeByIdSeek', plan)
 
+
+    def test_literal_params(self):
+        # nested lists and maps of literals
+        rows = ["{id: %d, name: 'n\\'%d', tags: ['a', \"b\\\"c\", null], score: %d.5}" % (i, i, i)
+                for i in range(100)]
+        query = "CYPHER batch=[%s] UNWIND $batch AS row RETURN row.id, row.name, row.tags, row.score" % ", ".join(rows)
+        result = redis_graph.query(query).result_set
+        expected = [[i, "n'%d" % i, ['a', 'b"c', None], i + 0.5] for i in range(100)]
+        self.env.assertEquals(result, expected)
+
+        # raw prefixes covering escapes, exponents and whitespace
+        query = """CYPHER  a=-12  b = 1.5e3 c='x\\ty' d={k: [true, false, null], j: {}} e=[]
+        RETURN $a, $b, $c, $d, $e"""
+        result = redis_graph.query(query).result_set
+        self.env.assertEquals(result, [[-12, 1500.0, "x\ty", {'k': [True, False, None], 'j': {}}, []]])
+
+        # prefixes the literal parser declines are still handled
+        query = "CYPHER a=1+2 b=0x10 RETURN $a, $b"
+        result = redis_graph.query(query).result_set
+        self.env.assertEquals(result, [[3, 16]])
+
+        # duplicated parameters are reported
+        try:
+            redis_graph.query("CYPHER a=1 a=2 RETURN $a")
+            assert(False)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertIn("Duplicated parameter", str(e))
@@ -235,3 +235,44 @@ class testPath(FlowTestsBase):
         result = redis_graph.query(query)
         expected_result = [[1, 'new']]
         self.env.assertEqual(result.result_set, expected_result)
+
+    # Test paths carried through projections, aggregations and reversed traversals.
+    def test_projected_path(self):
+        node0 = Node(node_id=0, label="L1", properties={'value': 1})
+        node1 = Node(node_id=1, label="L1", properties={'value': 2})
+        node2 = Node(node_id=2, label="L1", properties={'value': 3})
+        edge01 = Edge(node0, "R1", node1, edge_id=0, properties={'value': 1})
+        edge12 = Edge(node1, "R1", node2, edge_id=1, properties={'value': 2})
+
+        redis_graph.add_node(node0)
+        redis_graph.add_node(node1)
+        redis_graph.add_node(node2)
+        redis_graph.add_edge(edge01)
+        redis_graph.add_edge(edge12)
+
+        redis_graph.flush()
+
+        # Rewrite the edges with IDs instead of node values to match how they are returned.
+        edge01 = Edge(0, "R1", 1, edge_id=0, properties={'value': 1})
+        edge12 = Edge(1, "R1", 2, edge_id=1, properties={'value': 2})
+        path012 = Path.new_empty_path().add_node(node0).add_edge(edge01).add_node(node1).add_edge(edge12).add_node(node2)
+
+        # Paths survive being collected and unwound.
+        query = """MATCH p=(:L1 {value: 1})-[*2]->() WITH collect(p) AS paths UNWIND paths AS p RETURN p"""
+        result = redis_graph.query(query)
+        self.env.assertEqual(result.result_set, [[path012]])
+
+        # Entities are retrieved from projected paths.
+        query = """MATCH p=(:L1 {value: 1})-[*2]->() WITH p, length(p) AS len
+                   RETURN len, [n IN nodes(p) | n.value], [e IN relationships(p) | e.value]"""
+        result = redis_graph.query(query)
+        self.env.assertEqual(result.result_set, [[2, [1, 2, 3], [1, 2]]])
+
+        # A path built against edge direction lists its entities in query order.
+        query = """MATCH p=(:L1 {value: 3})<-[*2]-() RETURN [n IN nodes(p) | n.value], [e IN relationships(p) | e.value], p"""
+        result = redis_graph.query(query)
+        # Reverse direction edges which are not part of the graph.
+        edge21 = Edge(2, "R1", 1, edge_id=1, properties={'value': 2})
+        edge10 = Edge(1, "R1", 0, edge_id=0, properties={'value': 1})
+        path210 = Path.new_empty_path().add_node(node2).add_edge(edge21).add_node(node1).add_edge(edge10).add_node(node0)
+        self.env.assertEqual(result.result_set, [[[3, 2, 1], [2, 1], path210]])
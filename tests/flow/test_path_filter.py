@@ -306,3 +306,40 @@ class testPathFilter(FlowTestsBase):
         # The plan should be identical to the one constructed previously.
         self.env.assertEqual(plan_1, plan_2)
 
+
+    def test15_repeated_bound_entities(self):
+        # Build a star, many 'a' nodes share a small number of 'b' hubs.
+        redis_graph.query("UNWIND range(0, 5) AS x CREATE (:H {v: x})")
+        redis_graph.query("""UNWIND range(0, 299) AS x
+                             MATCH (h:H {v: x % 6})
+                             CREATE (:A {v: x})-[:R]->(h)""")
+        # Only even hubs point at a target.
+        redis_graph.query("MATCH (h:H) WHERE h.v % 2 = 0 CREATE (h)-[:T]->(:X)")
+
+        # Path filter outcomes depend on 'h' alone, repeated for every 'a'.
+        query = "MATCH (a:A)-[:R]->(h:H) WHERE (h)-[:T]->() RETURN count(a)"
+        result_set = redis_graph.query(query)
+        self.env.assertEquals(result_set.result_set, [[150]])
+
+        query = "MATCH (a:A)-[:R]->(h:H) WHERE NOT (h)-[:T]->() RETURN count(a)"
+        result_set = redis_graph.query(query)
+        self.env.assertEquals(result_set.result_set, [[150]])
+
+        # Path filter depending on both bound nodes, checked by a matrix lookup.
+        query = "MATCH (a:A), (h:H) WHERE (a)-[:R]->(h) RETURN count(a)"
+        result_set = redis_graph.query(query)
+        self.env.assertEquals(result_set.result_set, [[300]])
+
+        query = "MATCH (a:A), (h:H) WHERE NOT (a)-[:R]->(h) RETURN count(a)"
+        result_set = redis_graph.query(query)
+        self.env.assertEquals(result_set.result_set, [[300 * 5]])
+
+        # Reversed direction.
+        query = "MATCH (a:A), (h:H) WHERE (h)<-[:R]-(a) AND h.v = 0 RETURN count(a)"
+        result_set = redis_graph.query(query)
+        self.env.assertEquals(result_set.result_set, [[50]])
+
+        # Path filter referencing a scalar property of a bound node.
+        query = "MATCH (a:A)-[:R]->(h:H) WHERE (h)-[:T]->() AND (a)-[:R]->(:H {v: a.v % 6}) RETURN count(a)"
+        result_set = redis_graph.query(query)
+        self.env.assertEquals(result_set.result_set, [[150]])
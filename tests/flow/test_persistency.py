@@ -195,3 +195,66 @@ class testGraphPersistency(FlowTestsBase):
             actual_result = g.query(q)
             self.env.assertEquals(actual_result.result_set, expected_result)
 
+
+    # Entities are packed with their properties, repeated strings are written once per pack
+    def test05_packed_entities(self):
+        graph_names = ["packed_entities", "{tag}_packed_entities"]
+        for graph_name in graph_names:
+            g = Graph(graph_name, redis_con)
+            long_str = "a string long enough to be interned " * 5
+            q = """UNWIND range(0, 3000) AS x
+                   CREATE (:L {v: -x, s: 'repeated', l: $long, a: [x, 'repeated', [x]], b: x % 2 = 0})-[:R {w: x * 0.5, p: point({latitude: 1.5, longitude: -2.5})}]->(:M)"""
+            g.query(q, {'long': long_str})
+            g.query("MATCH (n:L) WHERE n.v % 5 = 0 DELETE n")
+
+            queries = ["MATCH (n) RETURN ID(n), labels(n), properties(n) ORDER BY ID(n)",
+                       "MATCH (a)-[e]->(b) RETURN ID(e), ID(a), ID(b), properties(e) ORDER BY ID(e)"]
+            expected = [g.query(q).result_set for q in queries]
+
+            # Save RDB & Load from RDB
+            redis_con.execute_command("DEBUG", "RELOAD")
+
+            for q, e in zip(queries, expected):
+                self.env.assertEquals(g.query(q).result_set, e)
+
+    # Relation matrices are saved as is, connections are traversable in both directions after reload
+    def test06_relation_matrices(self):
+        graph_names = ["relation_matrices", "{tag}_relation_matrices"]
+        for graph_name in graph_names:
+            g = Graph(graph_name, redis_con)
+            g.query("UNWIND range(0, 500) AS x CREATE (a:A {v: x})-[:R {w: x}]->(b:B {v: x}), (b)-[:S]->(a)")
+            # multiple edges between the same pair of nodes
+            g.query("MATCH (a:A)-[:R]->(b:B) WHERE a.v % 3 = 0 CREATE (a)-[:R {w: -1}]->(b)")
+            g.query("MATCH ()-[e:S]->() WHERE ID(e) % 4 = 0 DELETE e")
+
+            queries = ["MATCH (a)-[e]->(b) RETURN ID(e), type(e), ID(a), ID(b), e.w ORDER BY ID(e)",
+                       "MATCH (b:B)<-[e:R]-(a) RETURN ID(b), count(e) ORDER BY ID(b)",
+                       "MATCH (a)-[]-(b) RETURN count(*)"]
+            expected = [g.query(q).result_set for q in queries]
+
+            # Save RDB & Load from RDB
+            redis_con.execute_command("DEBUG", "RELOAD")
+
+            for q, e in zip(queries, expected):
+                self.env.assertEquals(g.query(q).result_set, e)
+
+    # Numeric lists are stored packed, extending them with other types expands them
+    def test07_numeric_lists(self):
+        graph_names = ["numeric_lists", "{tag}_numeric_lists"]
+        for graph_name in graph_names:
+            g = Graph(graph_name, redis_con)
+            q = """UNWIND range(0, 100) AS x
+                   CREATE (:L {i: range(-x, x, 3), d: [y IN range(0, x) | y * -0.25], m: [x, x * 0.5], e: [],
+                   big: [9223372036854775807, -9223372036854775807 - 1]})"""
+            g.query(q)
+            g.query("MATCH (n:L) WHERE ID(n) % 7 = 0 SET n.i = n.i + 'str', n.d = n.d + [1]")
+
+            queries = ["MATCH (n) RETURN ID(n), n.i, n.d, n.m, n.e, n.big ORDER BY ID(n)",
+                       "MATCH (n) RETURN ID(n), size(n.i), 3 IN n.i, -3 IN n.i ORDER BY ID(n)"]
+            expected = [g.query(q).result_set for q in queries]
+
+            # Save RDB & Load from RDB
+            redis_con.execute_command("DEBUG", "RELOAD")
+
+            for q, e in zip(queries, expected):
+                self.env.assertEquals(g.query(q).result_set, e)
@@ -0,0 +1,82 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "plan_stats"
+redis_con = None
+redis_graph = None
+
+class testPlanStats(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE (:L {v: x})")
+
+    def __del__(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", 100)
+
+    # returns the statistics reported for 'query', None if missing
+    def plan_stats(self, query):
+        reply = redis_con.execute_command("GRAPH.PLANSTATS", GRAPH_ID)
+        for q, stats in reply:
+            if q == query:
+                return dict(zip(stats[0::2], stats[1::2]))
+        return None
+
+    def test01_every_execution_sampled(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", 1)
+        query = "MATCH (n:L) WHERE n.v > 5 RETURN n.v"
+        for i in range(3):
+            result = redis_graph.query(query)
+            self.env.assertEquals(len(result.result_set), 5)
+
+        stats = self.plan_stats(query)
+        self.env.assertEquals(stats["executions"], 3)
+        self.env.assertEquals(stats["samples"], 3)
+
+        # operations are reported depth first, indented by depth
+        ops = stats["operations"]
+        self.env.assertTrue(ops[0].startswith("Results | Records produced: 5.0"))
+        self.env.assertTrue(ops[1].startswith("    Project | Records produced: 5.0"))
+        self.env.assertIn("Node By Label Scan | (n:L) | Records produced: 10.0", ops[-1])
+        for op in ops:
+            self.env.assertIn("Execution time: ", op)
+            self.env.assertIn("Memory: ", op)
+
+    def test02_sample_rate(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", 4)
+        query = "MATCH (n:L) RETURN count(n)"
+        for i in range(10):
+            redis_graph.query(query)
+
+        # executions 1, 5 and 9 are sampled
+        stats = self.plan_stats(query)
+        self.env.assertEquals(stats["executions"], 10)
+        self.env.assertEquals(stats["samples"], 3)
+
+    def test03_sampling_disabled(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", 0)
+        query = "MATCH (n:L) RETURN n.v ORDER BY n.v LIMIT 1"
+        redis_graph.query(query)
+
+        stats = self.plan_stats(query)
+        self.env.assertEquals(stats["executions"], 1)
+        self.env.assertEquals(stats["samples"], 0)
+        self.env.assertEquals(stats["operations"], [])
+
+    def test04_invalid_usage(self):
+        try:
+            redis_con.execute_command("GRAPH.PLANSTATS")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
+
+        try:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", -1)
+            self.env.assertTrue(False)
+        except Exception:
+            pass
@@ -0,0 +1,100 @@
+import struct
+from RLTest import Env
+from redis import ResponseError
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "prepared"
+redis_con = None
+
+# parameters are encoded as bulk insert properties, see docs/bulk_spec.md
+def encode_long(v):
+    return b'\x04' + struct.pack('<q', v)
+
+def encode_string(s):
+    return b'\x03' + s.encode() + b'\x00'
+
+def encode_array(values):
+    return b'\x05' + struct.pack('<q', len(values)) + b''.join(values)
+
+class testPreparedStatements(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        graph.query("UNWIND range(0, 9) AS x CREATE (:L {v: x, name: 'n' + toString(x)})")
+
+    def test01_execute(self):
+        handle = redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID,
+                                           "MATCH (n:L) WHERE n.v = $v RETURN n.name")
+        self.env.assertGreater(handle, 0)
+
+        for v in [0, 3, 9]:
+            res = redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle, "v", encode_long(v))
+            self.env.assertEquals(res[1], [["n%d" % v]])
+
+        # statements accept any parameter type
+        handle = redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID,
+                                           "MATCH (n:L) WHERE n.name IN $names RETURN n.v ORDER BY n.v")
+        names = encode_array([encode_string("n1"), encode_string("n4")])
+        res = redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle, "names", names)
+        self.env.assertEquals(res[1], [[1], [4]])
+
+        # literals of the prepared query are kept
+        handle = redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID,
+                                           "MATCH (n:L) WHERE n.v > 7 RETURN count(n)")
+        res = redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle)
+        self.env.assertEquals(res[1], [[2]])
+
+    def test02_errors(self):
+        # write queries can't be prepared
+        try:
+            redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID, "CREATE (:L)")
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("read-only", str(e))
+
+        # unknown handle
+        try:
+            redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, 123456)
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("not found", str(e))
+
+        # malformed parameter value
+        handle = redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID,
+                                           "MATCH (n:L) WHERE n.v = $v RETURN n.name")
+        for value in [b'\x04\x01', b'\x03abc', b'\x09', b'']:
+            try:
+                redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle, "v", value)
+                self.env.assertTrue(False)
+            except ResponseError as e:
+                self.env.assertContains("decode", str(e))
+
+        # missing parameter
+        try:
+            redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle)
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("Missing parameters", str(e))
+
+    def test03_schema_change(self):
+        handle = redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID, "MATCH (n:L) RETURN count(n)")
+        res = redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle)
+        self.env.assertEquals(res[1], [[10]])
+
+        # introducing a label modifies the graph version
+        graph = Graph(GRAPH_ID, redis_con)
+        graph.query("CREATE (:M)")
+        try:
+            redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle)
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("out of date", str(e))
+
+        # statements are prepared against the current schema
+        handle = redis_con.execute_command("GRAPH.PREPARE", GRAPH_ID, "MATCH (n:L) RETURN count(n)")
+        res = redis_con.execute_command("GRAPH.EXECUTE", GRAPH_ID, handle)
+        self.env.assertEquals(res[1], [[10]])
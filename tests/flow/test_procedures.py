@@ -1,5 +1,6 @@
 import os
 import sys
+import time
 import redis
 from RLTest import Env
 from redisgraph import Graph, Node, Edge
@@ -363,3 +364,129 @@ class testProcedures(FlowTestsBase):
                             ["fruit"]]
         self.env.assertEquals(actual_resultset, expected_results)
 
+
+    def test12_procedure_fulltext_many_results(self):
+        # number of matches exceeds a single block of procedure output
+        node_count = 3000
+        redis_graph.query("UNWIND range(1, %d) AS i CREATE (:word {name: 'common', v: i})" % node_count)
+        redis_graph.call_procedure("db.idx.fulltext.createNodeIndex", 'word', 'name')
+
+        q = """CALL db.idx.fulltext.queryNodes('word', 'common') YIELD node, score
+               RETURN count(node), count(DISTINCT node.v), min(score) > 0"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[node_count, node_count, True]])
+
+    def test13_procedure_fulltext_limit(self):
+        redis_graph.query("UNWIND range(1, 20) AS i CREATE (:doc {text: CASE WHEN i % 4 = 0 THEN 'graph database' ELSE 'graph' END, v: i})")
+        redis_graph.call_procedure("db.idx.fulltext.createNodeIndex", 'doc', 'text')
+
+        # top scoring matches are reported first
+        q = """CALL db.idx.fulltext.queryNodes('doc', 'graph|database', {limit: 3}) YIELD node
+               RETURN node.v % 4, count(node)"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[0, 3]])
+
+        q = """CALL db.idx.fulltext.queryNodes('doc', 'graph', {limit: 10, skip: 3}) YIELD node, score
+               RETURN count(node), count(DISTINCT node.v)"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[10, 10]])
+
+        q = """CALL db.idx.fulltext.queryNodes('doc', 'graph', {skip: 18}) YIELD node
+               RETURN count(node)"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[2]])
+
+        # a query limit is honoured while matches are streamed
+        q = """CALL db.idx.fulltext.queryNodes('doc', 'graph') YIELD node
+               RETURN node LIMIT 5"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(len(actual_resultset), 5)
+
+        try:
+            redis_graph.query("CALL db.idx.fulltext.queryNodes('doc', 'graph', {top: 3})")
+            self.env.assertFalse(1)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertIn("unknown configuration key 'top'", str(e))
+
+    def test14_procedure_vector_query(self):
+        redis_graph.query("UNWIND range(0, 9) AS i CREATE (:item {v: i, embedding: [toFloat(i), 10.0 - i]})")
+        # values which aren't numeric arrays aren't indexed
+        redis_graph.query("CREATE (:item {v: -1, embedding: 'none'}), (:item {v: -2, embedding: [0, 0]})")
+        redis_graph.call_procedure("db.idx.vector.createNodeIndex", 'item', 'embedding')
+
+        # nearest nodes are reported first
+        q = """CALL db.idx.vector.query('item', 'embedding', 3, [1.0, 0.0]) YIELD node, score
+               RETURN node.v, score > 0.5"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[9, True], [8, True], [7, True]])
+
+        # k exceeding the number of indexed nodes
+        q = """CALL db.idx.vector.query('item', 'embedding', 100, [0.0, 1.0]) YIELD node
+               RETURN count(node), min(node.v)"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[10, 0]])
+
+        # index is maintained by updates and deletions
+        redis_graph.query("MATCH (n:item {v: 0}) SET n.embedding = [1.0, 0.0]")
+        redis_graph.query("MATCH (n:item {v: 9}) DELETE n")
+        q = """CALL db.idx.vector.query('item', 'embedding', 1, [1.0, 0.0]) YIELD node, score
+               RETURN node.v, score"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[0, 1.0]])
+
+        # query vector of a different dimension matches nothing
+        q = """CALL db.idx.vector.query('item', 'embedding', 3, [1.0, 0.0, 0.0]) YIELD node
+               RETURN count(node)"""
+        actual_resultset = redis_graph.query(q).result_set
+        self.env.assertEquals(actual_resultset, [[0]])
+
+        try:
+            redis_graph.query("CALL db.idx.vector.query('item', 'v', 3, [1.0, 0.0])")
+            self.env.assertFalse(1)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertIn("No vector index on :item(v)", str(e))
+
+        redis_graph.call_procedure("db.idx.vector.drop", 'item')
+        try:
+            redis_graph.query("CALL db.idx.vector.query('item', 'embedding', 3, [1.0, 0.0])")
+            self.env.assertFalse(1)
+        except redis.exceptions.ResponseError as e:
+            self.env.assertIn("No vector index", str(e))
+
+    def test15_procedure_fulltext_async(self):
+        redis_graph.query("UNWIND range(0, 99) AS x CREATE (:doc {v: x, text: 'draft'})")
+        redis_graph.call_procedure("db.idx.fulltext.createNodeIndex", 'doc', 'text')
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "FULLTEXT_ASYNC", "yes")
+
+        try:
+            # updates are queued, applied in the background
+            redis_graph.query("MATCH (n:doc) WHERE n.v < 10 SET n.text = 'final'")
+            redis_graph.query("MATCH (n:doc) WHERE n.v >= 90 DELETE n")
+
+            # wait for the index to catch up
+            version, applied = None, None
+            for _ in range(100):
+                version, applied = redis_graph.query("CALL db.idx.fulltext.status('doc')").result_set[0]
+                if version == applied:
+                    break
+                time.sleep(0.1)
+            self.env.assertEquals(version, applied)
+            self.env.assertEquals(version, 20)
+
+            q = """CALL db.idx.fulltext.queryNodes('doc', 'final', {version: %d}) YIELD node
+                   RETURN count(node)""" % version
+            self.env.assertEquals(redis_graph.query(q).result_set, [[10]])
+            q = """CALL db.idx.fulltext.queryNodes('doc', 'draft') YIELD node
+                   RETURN count(node)"""
+            self.env.assertEquals(redis_graph.query(q).result_set, [[80]])
+
+            # a version ahead of the index fails the query
+            try:
+                redis_graph.query("CALL db.idx.fulltext.queryNodes('doc', 'final', {version: %d})" %
+                                  (version + 1))
+                self.env.assertFalse(1)
+            except redis.exceptions.ResponseError as e:
+                self.env.assertIn("behind requested version", str(e))
+        finally:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "FULLTEXT_ASYNC", "no")
+            redis_graph.call_procedure("db.idx.fulltext.drop", 'doc')
@@ -0,0 +1,58 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "product_cache"
+redis_con = None
+redis_graph = None
+
+class testProductCache(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True, moduleArgs="PRODUCT_CACHE_CAPACITY 104857600")
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("""UNWIND range(1, 100) AS x
+                             CREATE (:A {v: x})-[:R]->(:B {v: x}), (:A {v: x})-[:R]->(:C {v: x})""")
+
+    def product_cache_memory(self):
+        reply = redis_con.execute_command("GRAPH.MEMORY", GRAPH_ID)
+        return dict(zip(reply[0::2], reply[1::2]))["product_cache"]
+
+    def test01_cached_product(self):
+        query = "MATCH (a:A)-[:R]->(b:B) RETURN count(b)"
+        self.env.assertEquals(self.product_cache_memory(), 0)
+
+        # the first query computes R * B, the second reuses it
+        for _ in range(2):
+            res = redis_graph.query(query)
+            self.env.assertEquals(res.result_set[0][0], 100)
+            self.env.assertGreater(self.product_cache_memory(), 0)
+
+        # a pattern differing by its aliases shares the product
+        res = redis_graph.query("MATCH (x:A)-[:R]->(y:B) WHERE x.v < 11 RETURN count(y)")
+        self.env.assertEquals(res.result_set[0][0], 10)
+
+    def test02_invalidation(self):
+        query = "MATCH (a:A)-[:R]->(b:B) RETURN count(b)"
+        res = redis_graph.query(query)
+        self.env.assertEquals(res.result_set[0][0], 100)
+
+        # modifications are visible to subsequent queries
+        redis_graph.query("MATCH (a:A {v: 1}), (b:B {v: 2}) CREATE (a)-[:R]->(b)")
+        res = redis_graph.query(query)
+        self.env.assertEquals(res.result_set[0][0], 101)
+
+        redis_graph.query("MATCH (:A)-[e:R]->(:B {v: 2}) DELETE e")
+        res = redis_graph.query(query)
+        self.env.assertEquals(res.result_set[0][0], 99)
+
+    def test03_disabled(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PRODUCT_CACHE_CAPACITY", 0)
+        res = redis_con.execute_command("GRAPH.CONFIG", "GET", "PRODUCT_CACHE_CAPACITY")
+        self.env.assertEquals(res, ["PRODUCT_CACHE_CAPACITY", 0])
+
+        res = redis_graph.query("MATCH (a:A)-[:R]->(c:C) RETURN count(c)")
+        self.env.assertEquals(res.result_set[0][0], 100)
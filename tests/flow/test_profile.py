@@ -35,3 +35,69 @@ class testProfile(FlowTestsBase):
         self.env.assertIn("Project | Records produced: 2", profile)
         self.env.assertIn("Filter | Records produced: 2", profile)
         self.env.assertIn("Node By Label Scan | (p:Person) | Records produced: 3", profile)
+
+    def test_profile_traversal_batch_size(self):
+        # create a node with a large fan-out
+        q = """CREATE (:Hub)"""
+        redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, q)
+        q = """MATCH (h:Hub) UNWIND range(1, 100) AS x CREATE (h)-[:R]->(:Leaf)"""
+        redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, q)
+
+        # 1-hop traversal from a single source
+        q = "MATCH (h:Hub)-[:R]->(l) RETURN count(l)"
+        profile = redis_con.execute_command("GRAPH.PROFILE", GRAPH_ID, q)
+        traverse = [x for x in profile if x.strip().startswith("Conditional Traverse")][0]
+
+        # the batch size chosen at runtime is reported by the traversal
+        self.env.assertIn("Batch size: 16 | Records produced: 100", traverse)
+
+        # many sparse traversals grow the batch size
+        q = "MATCH (l:Leaf)<-[:R]-(h) RETURN count(h)"
+        profile = redis_con.execute_command("GRAPH.PROFILE", GRAPH_ID, q)
+        traverse = [x for x in profile if x.strip().startswith("Conditional Traverse")][0]
+        self.env.assertIn("Batch size: 64", traverse)
+
+    def test_profile_phases(self):
+        q = "MATCH (p:Person) RETURN p"
+        profile = redis_con.execute_command("GRAPH.PROFILE", GRAPH_ID, q)
+
+        # the profiled operations are trailed by the query's phases
+        self.env.assertTrue(profile[-1].startswith("Query phases | parse: "))
+        for phase in ["cache", "queue", "lock", "sync", "execution", "gil"]:
+            self.env.assertIn(phase + ": ", profile[-1])
+        self.env.assertNotIn("reply", profile[-1])
+
+    def test_profile_phases_in_statistics(self):
+        q = "MATCH (p:Person) RETURN p"
+        result = redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, q)
+        self.env.assertFalse(any(s.startswith("Query phases: ") for s in result[-1]))
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "REPORT_QUERY_PHASES", "yes")
+        try:
+            result = redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, q)
+            phases = [s for s in result[-1] if s.startswith("Query phases: ")]
+            self.env.assertEquals(len(phases), 1)
+            self.env.assertIn("execution: ", phases[0])
+        finally:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "REPORT_QUERY_PHASES", "no")
+
+    def test_profile_estimates(self):
+        # a label scan is estimated to produce every node of its label
+        q = "MATCH (p:Person) RETURN p"
+        plan = redis_con.execute_command("GRAPH.EXPLAIN", GRAPH_ID, q)
+        scan = [x for x in plan if x.strip().startswith("Node By Label Scan")][0]
+        self.env.assertIn("(p:Person) | Estimated records: 3.0, Cost: ", scan)
+        for op in plan:
+            self.env.assertIn("Estimated records: ", op)
+
+        # profiled operations report estimates alongside actuals
+        profile = redis_con.execute_command("GRAPH.PROFILE", GRAPH_ID, q)
+        scan = [x for x in profile if x.strip().startswith("Node By Label Scan")][0]
+        self.env.assertIn("Records produced: 3", scan)
+        self.env.assertIn("Estimated records: 3.0", scan)
+
+        # a constant list is unwound into its elements
+        q = "UNWIND range(1, 10) AS x RETURN x"
+        plan = redis_con.execute_command("GRAPH.EXPLAIN", GRAPH_ID, q)
+        unwind = [x for x in plan if x.strip().startswith("Unwind")][0]
+        self.env.assertIn("Estimated records: 10.0", unwind)
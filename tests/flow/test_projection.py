@@ -0,0 +1,111 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "projection"
+graph = None
+redis_con = None
+
+class testProjection(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        global redis_con
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # two P components {a, b, c} and {d, e}
+        # Q nodes and S edges must be ignored by a projection over P and R
+        q = """CREATE (a:P {v: 'a'}), (b:P {v: 'b'}), (c:P {v: 'c'}),
+                      (d:P {v: 'd'}), (e:P {v: 'e'}), (q:Q {v: 'q'}),
+                      (a)-[:R]->(b), (b)-[:R]->(c), (c)-[:R]->(a),
+                      (d)-[:R]->(e), (a)-[:R]->(q), (c)-[:S]->(d)"""
+        graph.query(q)
+
+    def test01_project(self):
+        q = """CALL algo.project('p', 'P', 'R') YIELD name RETURN name"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [['p']])
+
+    def test02_algorithms_match_label_and_relation(self):
+        queries = [
+            ("""CALL algo.WCC({args}) YIELD node, componentId
+                RETURN node.v, componentId ORDER BY node.v"""),
+            ("""CALL algo.labelPropagation({args}) YIELD node, communityId
+                RETURN node.v, communityId ORDER BY node.v"""),
+            ("""CALL algo.triangleCount({args}) YIELD node, triangles
+                RETURN node.v, triangles ORDER BY node.v"""),
+            ("""CALL algo.pageRank({args}) YIELD node, score
+                RETURN node.v, round(score * 1000) ORDER BY node.v"""),
+            ("""CALL algo.closeness({args}) YIELD node, closeness
+                RETURN node.v, closeness ORDER BY node.v"""),
+        ]
+        for q in queries:
+            expected = graph.query(q.format(args="'P', 'R'")).result_set
+            actual = graph.query(q.format(args="NULL, NULL, {projection: 'p'}")).result_set
+            self.env.assertEquals(len(actual), 5)
+            self.env.assertEquals(actual, expected)
+
+        q = """CALL algo.betweenness({args}) YIELD node, centrality
+               RETURN node.v, centrality ORDER BY node.v"""
+        expected = graph.query(q.format(args="'P', 'R', NULL")).result_set
+        actual = graph.query(q.format(args="NULL, NULL, NULL, {projection: 'p'}")).result_set
+        self.env.assertEquals(actual, expected)
+
+    def test03_projection_follows_modifications(self):
+        q = """CALL algo.WCC(NULL, NULL, {projection: 'p'}) YIELD node
+               RETURN count(node)"""
+        self.env.assertEquals(graph.query(q).result_set, [[5]])
+
+        # connect a new node to the {d, e} component
+        graph.query("""MATCH (e:P {v: 'e'}) CREATE (e)-[:R]->(:P {v: 'f'})""")
+
+        q = """CALL algo.WCC(NULL, NULL, {projection: 'p'}) YIELD node, componentId
+               WITH componentId, count(node) AS size
+               RETURN size ORDER BY size"""
+        self.env.assertEquals(graph.query(q).result_set, [[3], [3]])
+
+    def test04_invalid_usage(self):
+        queries = [
+            # unknown projection
+            """CALL algo.WCC(NULL, NULL, {projection: 'missing'}) YIELD node RETURN node""",
+            # projection combined with a label
+            """CALL algo.WCC('P', NULL, {projection: 'p'}) YIELD node RETURN node""",
+            # unknown configuration key
+            """CALL algo.WCC(NULL, NULL, {unknown: 1}) YIELD node RETURN node""",
+            # unknown label
+            """CALL algo.project('x', 'Missing', NULL) YIELD name RETURN name""",
+        ]
+        for q in queries:
+            try:
+                graph.query(q)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+    def test05_read_only_query(self):
+        try:
+            redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID,
+                    "CALL algo.project('r', 'P', 'R') YIELD name RETURN name")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
+
+    def test06_drop_projection(self):
+        q = """CALL algo.dropProjection('p') YIELD name RETURN name"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [['p']])
+
+        # dropped projection can't be used nor dropped again
+        queries = [
+            """CALL algo.WCC(NULL, NULL, {projection: 'p'}) YIELD node RETURN node""",
+            """CALL algo.dropProjection('p') YIELD name RETURN name""",
+        ]
+        for q in queries:
+            try:
+                graph.query(q)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
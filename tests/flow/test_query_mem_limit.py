@@ -0,0 +1,53 @@
+from RLTest import Env
+from base import FlowTestsBase
+from redis import ResponseError
+from redisgraph import Graph
+
+GRAPH_ID = "mem_limit"
+redis_con = None
+redis_graph = None
+
+# consumes several megabytes by collecting a large list
+MEM_HOG_QUERY = "UNWIND range(1, 1000000) AS x RETURN size(collect(x))"
+
+class testQueryMemoryLimit(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+    def tearDown(self):
+        # restore unlimited memory capacity
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "QUERY_MEM_CAPACITY", 0)
+
+    def test01_unlimited_by_default(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "QUERY_MEM_CAPACITY")
+        self.env.assertEquals(response[1], 0)
+
+        result = redis_graph.query(MEM_HOG_QUERY)
+        self.env.assertEquals(result.result_set[0][0], 1000000)
+
+    def test02_query_exceeds_capacity(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "QUERY_MEM_CAPACITY", 1024 * 1024)
+
+        try:
+            redis_graph.query(MEM_HOG_QUERY)
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("Query's mem consumption exceeded capacity", str(e))
+
+        # small queries are unaffected
+        result = redis_graph.query("UNWIND range(1, 10) AS x RETURN size(collect(x))")
+        self.env.assertEquals(result.result_set[0][0], 10)
+
+    def test03_peak_memory_reported(self):
+        profile = redis_con.execute_command("GRAPH.PROFILE", GRAPH_ID, MEM_HOG_QUERY)
+        self.env.assertContains("Peak memory: ", profile[0])
+
+        slowlog = redis_con.execute_command("GRAPH.SLOWLOG", GRAPH_ID)
+        self.env.assertGreater(len(slowlog), 0)
+        for item in slowlog:
+            self.env.assertEquals(len(item), 7)
+            self.env.assertGreaterEqual(item[4], 0)
@@ -0,0 +1,89 @@
+from RLTest import Env
+from redisgraph import Graph, Node, Edge
+
+from base import FlowTestsBase
+
+GRAPH_ID = "query_parameterization"
+redis_con = None
+redis_graph = None
+
+class testQueryParameterization(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE (:L {id: x, name: 'n' + toString(x)})")
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PARAMETERIZE_QUERIES", "yes")
+
+    def __del__(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PARAMETERIZE_QUERIES", "no")
+
+    def cache_stats(self):
+        reply = redis_con.execute_command("GRAPH.CACHE", GRAPH_ID)
+        return dict(zip(reply[0::2], reply[1::2]))
+
+    def test01_literals_share_plan(self):
+        result = redis_graph.query("MATCH (n:L {id: 5}) RETURN n.name")
+        self.env.assertFalse(result.cached_execution)
+        self.env.assertEquals(result.result_set, [['n5']])
+
+        result = redis_graph.query("MATCH (n:L {id: 6}) RETURN n.name")
+        self.env.assertTrue(result.cached_execution)
+        self.env.assertEquals(result.result_set, [['n6']])
+
+        result = redis_graph.query("MATCH (n:L) WHERE n.name = 'n7' RETURN n.id")
+        self.env.assertFalse(result.cached_execution)
+        self.env.assertEquals(result.result_set, [[7]])
+
+        result = redis_graph.query("MATCH (n:L) WHERE n.name = 'n8' RETURN n.id")
+        self.env.assertTrue(result.cached_execution)
+        self.env.assertEquals(result.result_set, [[8]])
+
+    def test02_projected_literals_are_kept(self):
+        # column names are derived from projected literals
+        result = redis_graph.query("MATCH (n:L {id: 1}) RETURN 1, n.id + 2")
+        self.env.assertEquals(result.header[0][1], '1')
+        self.env.assertEquals(result.result_set, [[1, 3]])
+
+        result = redis_graph.query("MATCH (n:L {id: 2}) RETURN 2, n.id + 2")
+        self.env.assertFalse(result.cached_execution)
+        self.env.assertEquals(result.header[0][1], '2')
+        self.env.assertEquals(result.result_set, [[2, 4]])
+
+    def test03_user_parameters(self):
+        q = "CYPHER name='n3' MATCH (n:L) WHERE n.name = $name AND n.id < 5 RETURN n.id"
+        result = redis_graph.query(q)
+        self.env.assertEquals(result.result_set, [[3]])
+
+        q = "CYPHER name='n4' MATCH (n:L) WHERE n.name = $name AND n.id < 9 RETURN n.id"
+        result = redis_graph.query(q)
+        self.env.assertTrue(result.cached_execution)
+        self.env.assertEquals(result.result_set, [[4]])
+
+    def test04_skip_limit(self):
+        q = "MATCH (n:L) WHERE n.id > 2 RETURN n.id ORDER BY n.id SKIP 1 LIMIT 2"
+        result = redis_graph.query(q)
+        self.env.assertEquals(result.result_set, [[4], [5]])
+
+        q = "MATCH (n:L) WHERE n.id > 5 RETURN n.id ORDER BY n.id SKIP 2 LIMIT 1"
+        result = redis_graph.query(q)
+        self.env.assertTrue(result.cached_execution)
+        self.env.assertEquals(result.result_set, [[8]])
+
+    def test05_cache_stats(self):
+        before = self.cache_stats()
+        redis_graph.query("MATCH (n:L {id: 9}) RETURN n.name")
+        after = self.cache_stats()
+        self.env.assertEquals(after['hits'], before['hits'] + 1)
+        self.env.assertEquals(after['misses'], before['misses'])
+        self.env.assertEquals(after['size'], before['size'])
+        self.env.assertGreater(after['capacity'], 0)
+
+        # unknown graph
+        try:
+            redis_con.execute_command("GRAPH.CACHE", "no_such_graph")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
@@ -0,0 +1,78 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "query_stats"
+redis_con = None
+redis_graph = None
+
+class testQueryStats(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE (:L {v: x})")
+
+    # returns the statistics reported for normalized 'query', None if missing
+    def query_stats(self, query):
+        reply = redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID)
+        for item in reply:
+            stats = dict(zip(item[0::2], item[1::2]))
+            if stats["query"] == query:
+                return stats
+        return None
+
+    def test01_aggregate_by_fingerprint(self):
+        redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID, "RESET")
+
+        # queries differing only by their literals share a fingerprint
+        for v in [1, 2, 3, 3]:
+            redis_graph.query("MATCH (n:L) WHERE n.v <= %d RETURN n.v" % v)
+        redis_graph.query("MATCH (n:L) WHERE n.v <= 'a' RETURN n.v")
+
+        stats = self.query_stats("MATCH (n:L) WHERE n.v <= ? RETURN n.v")
+        self.env.assertEquals(stats["calls"], 5)
+        self.env.assertEquals(stats["rows"], 1 + 2 + 3 + 3)
+        # the last numeric query reused the plan cached by its predecessor
+        self.env.assertEquals(stats["cache_hits"], 1)
+
+        total = float(stats["total_ms"])
+        self.env.assertGreaterEqual(float(stats["max_ms"]), float(stats["min_ms"]))
+        self.env.assertGreaterEqual(total, float(stats["max_ms"]))
+        self.env.assertGreaterEqual(float(stats["max_ms"]), float(stats["p99_ms"]))
+        self.env.assertGreaterEqual(float(stats["lock_wait_ms"]), 0)
+
+    def test02_ordered_by_total_latency(self):
+        redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID, "RESET")
+        redis_graph.query("MATCH (n:L) RETURN count(n)")
+        redis_graph.query("UNWIND range(1, 100000) AS x RETURN count(x)")
+
+        reply = redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID)
+        self.env.assertEquals(len(reply), 2)
+        totals = [float(dict(zip(item[0::2], item[1::2]))["total_ms"]) for item in reply]
+        self.env.assertGreaterEqual(totals[0], totals[1])
+
+    def test03_reset(self):
+        redis_graph.query("MATCH (n:L) RETURN n LIMIT 1")
+        reply = redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID)
+        self.env.assertGreater(len(reply), 0)
+
+        self.env.assertEquals(redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID, "RESET"), "OK")
+        reply = redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID)
+        self.env.assertEquals(reply, [])
+
+    def test04_invalid_usage(self):
+        try:
+            redis_con.execute_command("GRAPH.QUERYSTATS")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
+
+        try:
+            redis_con.execute_command("GRAPH.QUERYSTATS", GRAPH_ID, "FLUSH")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
@@ -0,0 +1,110 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+graph = None
+
+class testRandomWalk(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph("proc_random_walk", redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # (a)-[:R]->(b), (a)-[:R]->(c), (a)-[:R]->(d)
+        # (b)-[:R]->(e), (c)-[:R]->(e), (d)-[:R]->(e)
+        # (e)-[:S]->(a), (f) is isolated
+        q = """CREATE (a:N {v: 'a'}), (b:N {v: 'b'}), (c:N {v: 'c'}),
+                      (d:N {v: 'd'}), (e:N {v: 'e'}), (f:N {v: 'f'}),
+                      (a)-[:R]->(b), (a)-[:R]->(c), (a)-[:R]->(d),
+                      (b)-[:R]->(e), (c)-[:R]->(e), (d)-[:R]->(e),
+                      (e)-[:S]->(a)"""
+        graph.query(q)
+
+    def test01_random_walk(self):
+        # every walk of R takes a, one of b, c, d and then e, where it ends
+        q = """MATCH (a {v: 'a'})
+               CALL algo.randomWalk(a, 5, 'R', 10) YIELD source, walk
+               RETURN source.v, [n IN walk | n.v]"""
+        result = graph.query(q)
+        self.env.assertEquals(len(result.result_set), 10)
+        for source, walk in result.result_set:
+            self.env.assertEquals(source, 'a')
+            self.env.assertEquals(len(walk), 3)
+            self.env.assertEquals(walk[0], 'a')
+            self.env.assertIn(walk[1], ['b', 'c', 'd'])
+            self.env.assertEquals(walk[2], 'e')
+
+        # edge type agnostic walks run their full length
+        q = """MATCH (a {v: 'a'})
+               CALL algo.randomWalk(a, 6, NULL) YIELD walk
+               RETURN [n IN walk | n.v]"""
+        walk = graph.query(q).result_set[0][0]
+        self.env.assertEquals(len(walk), 7)
+        self.env.assertEquals(walk[3], 'a')
+
+        # isolated nodes and walks of length 0 consist of their source
+        q = """MATCH (n:N) WHERE n.v IN ['a', 'f'] WITH collect(n) AS sources
+               CALL algo.randomWalk(sources, 0, 'R') YIELD walk
+               RETURN [n IN walk | n.v]"""
+        result = graph.query(q)
+        self.env.assertEquals(sorted(result.result_set), [[['a']], [['f']]])
+
+    def test02_random_walk_seed(self):
+        # the same seed reproduces the same walks
+        q = """MATCH (n:N) WITH collect(n) AS sources
+               CALL algo.randomWalk(sources, 4, NULL, 3, 42) YIELD walk
+               RETURN [n IN walk | n.v]"""
+        first = graph.query(q).result_set
+        second = graph.query(q).result_set
+        self.env.assertEquals(len(first), 18)
+        self.env.assertEquals(first, second)
+
+    def test03_sample_neighbors(self):
+        # a 2 hop neighborhood, sampling 2 of a's 3 neighbors
+        q = """MATCH (a {v: 'a'})
+               CALL algo.sampleNeighbors(a, [2, 5], 'R', 7) YIELD source, parent, node, hop
+               RETURN source.v, parent.v, node.v, hop"""
+        result = graph.query(q).result_set
+        self.env.assertEquals(len(result), 4)
+
+        first_hop = [r for r in result if r[3] == 1]
+        second_hop = [r for r in result if r[3] == 2]
+        self.env.assertEquals(len(first_hop), 2)
+        self.env.assertEquals(len(second_hop), 2)
+
+        # neighbors are drawn without replacement
+        sampled = [r[2] for r in first_hop]
+        self.env.assertEquals(len(set(sampled)), 2)
+        for source, parent, node, hop in first_hop:
+            self.env.assertEquals(source, 'a')
+            self.env.assertEquals(parent, 'a')
+            self.env.assertIn(node, ['b', 'c', 'd'])
+
+        # each node sampled at hop 1 is the parent of a hop 2 sample
+        for source, parent, node, hop in second_hop:
+            self.env.assertIn(parent, sampled)
+            self.env.assertEquals(node, 'e')
+
+        # the same seed reproduces the same samples
+        self.env.assertEquals(graph.query(q).result_set, result)
+
+    def test04_invalid_arguments(self):
+        queries = ["MATCH (a {v: 'a'}) CALL algo.randomWalk(a, -1, 'R') YIELD walk RETURN walk",
+                   "MATCH (a {v: 'a'}) CALL algo.randomWalk(a, 2, 'R', 0) YIELD walk RETURN walk",
+                   "MATCH (a {v: 'a'}) CALL algo.sampleNeighbors(a, [-1], 'R') YIELD node RETURN node",
+                   "MATCH (a {v: 'a'}) CALL algo.sampleNeighbors(a, 2, 'R') YIELD node RETURN node"]
+        for q in queries:
+            try:
+                graph.query(q)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+        # unknown relationship types yield nothing
+        q = """MATCH (a {v: 'a'})
+               CALL algo.sampleNeighbors(a, [2], 'NONE') YIELD node
+               RETURN node"""
+        self.env.assertEquals(graph.query(q).result_set, [])
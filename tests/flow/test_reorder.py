@@ -0,0 +1,108 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "reorder"
+redis_con = None
+redis_graph = None
+
+class testReorder(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+
+        # two chains, the second linked backwards, along isolated nodes
+        redis_graph.query("UNWIND range(0, 199) AS x CREATE (:N {v: x})")
+        redis_graph.query("MATCH (a:N), (b:N) WHERE b.v = a.v + 1 AND a.v <> 99 CREATE (a)-[:R {w: a.v}]->(b)")
+        redis_graph.query("UNWIND range(0, 9) AS x CREATE (:I {v: x})")
+        redis_graph.query("CREATE INDEX ON :N(v)")
+        redis_graph.query("CREATE CONSTRAINT ON (n:N) ASSERT n.v IS UNIQUE")
+
+    def reorder(self, *policy):
+        return redis_con.execute_command("GRAPH.REORDER", GRAPH_ID, *policy)
+
+    def validate(self):
+        result = redis_graph.query("MATCH (n) RETURN count(n), max(id(n))")
+        count = result.result_set[0][0]
+        # node IDs are dense
+        self.env.assertEquals(result.result_set, [[count, count - 1]])
+
+        result = redis_graph.query("MATCH (a:N)-[r:R]->(b:N) WHERE b.v <> a.v + 1 OR r.w <> a.v RETURN count(r)")
+        self.env.assertEquals(result.result_set, [[0]])
+        result = redis_graph.query("MATCH (a:N {v: 0})-[:R*]->(b) RETURN count(b)")
+        self.env.assertEquals(result.result_set, [[99]])
+
+        # indices and constraints follow their nodes
+        result = redis_graph.query("MATCH (n:N {v: 150}) RETURN n.v")
+        self.env.assertEquals(result.result_set, [[150]])
+        try:
+            redis_graph.query("CREATE (:N {v: 150})")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("uniqueness constraint", str(e))
+
+    def test01_policies(self):
+        for policy in [[], ["DEGREE"], ["rcm"], ["COMMUNITY"]]:
+            res = self.reorder(*policy)
+            self.env.assertIn("Graph reordered", res)
+            self.validate()
+
+    def test02_deleted_nodes(self):
+        redis_graph.query("MATCH (n:I) WHERE n.v % 2 = 0 DELETE n")
+        self.reorder("DEGREE")
+        self.validate()
+
+        # reordering an ordered graph relabels no node
+        self.reorder("DEGREE")
+        self.env.assertEquals(self.reorder("DEGREE"), "Graph reordered, 0 nodes relabeled")
+
+        result = redis_graph.query("MATCH (n:I) RETURN count(n)")
+        self.env.assertEquals(result.result_set, [[5]])
+
+    def test03_persistency(self):
+        self.reorder("COMMUNITY")
+        redis_con.execute_command("DEBUG", "RELOAD")
+        self.validate()
+
+    def test04_invalid(self):
+        try:
+            self.reorder("BOGUS")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("Unknown node order", str(e))
+
+    def test05_edges(self):
+        # relationships of another type, created interleaved with R's
+        redis_graph.query("MATCH (a:N)-[:R]->(b:N) CREATE (b)-[:S {w: a.v}]->(a), (a)-[:T]->(b)")
+        redis_graph.query("MATCH ()-[t:T]->() DELETE t")
+        redis_graph.query("MATCH ()-[s:S]->() WHERE s.w % 3 = 0 DELETE s")
+
+        res = self.reorder("EDGES")
+        self.env.assertIn("relationships relabeled", res)
+        self.validate()
+
+        # relationship IDs are dense
+        result = redis_graph.query("MATCH ()-[r]->() RETURN count(r), max(id(r))")
+        count = result.result_set[0][0]
+        self.env.assertEquals(result.result_set, [[count, count - 1]])
+
+        # the relationships of each type occupy a contiguous range of IDs
+        q = "MATCH ()-[r]->() RETURN type(r), count(r), min(id(r)), max(id(r)) ORDER BY type(r)"
+        for t, c, lo, hi in redis_graph.query(q).result_set:
+            self.env.assertEquals(hi - lo + 1, c)
+
+        result = redis_graph.query("MATCH (a:N)-[s:S]->(b:N) WHERE a.v <> b.v + 1 OR s.w <> b.v RETURN count(s)")
+        self.env.assertEquals(result.result_set, [[0]])
+        result = redis_graph.query("MATCH ()-[s:S]->() RETURN count(s)")
+        self.env.assertEquals(result.result_set, [[132]])
+
+        # clustering clustered relationships relabels none
+        self.env.assertEquals(self.reorder("edges"), "Graph reordered, 0 relationships relabeled")
+
+        redis_con.execute_command("DEBUG", "RELOAD")
+        self.validate()
+        result = redis_graph.query("MATCH ()-[r]->() RETURN count(r), max(id(r))")
+        self.env.assertEquals(result.result_set, [[count, count - 1]])
@@ -0,0 +1,77 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "replan"
+NODE_COUNT = 3000
+redis_con = None
+redis_graph = None
+
+class testReplan(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        # every node shares the same value, defying the equality estimate
+        redis_graph.query("UNWIND range(1, %d) AS x CREATE (:L {v: 1, w: x})" % NODE_COUNT)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", 1)
+
+    def __del__(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "PLAN_STATS_SAMPLE_RATE", 100)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "REPLAN_THRESHOLD", 0)
+
+    # returns the statistics reported for 'query', None if missing
+    def plan_stats(self, query):
+        reply = redis_con.execute_command("GRAPH.PLANSTATS", GRAPH_ID)
+        for q, stats in reply:
+            if q == query:
+                return dict(zip(stats[0::2], stats[1::2]))
+        return None
+
+    def test01_config(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "REPLAN_THRESHOLD")
+        self.env.assertEquals(response, ["REPLAN_THRESHOLD", 0])
+
+        for invalid in ["-1", "1"]:
+            try:
+                redis_con.execute_command("GRAPH.CONFIG", "SET", "REPLAN_THRESHOLD", invalid)
+                self.env.assertTrue(False)
+            except Exception:
+                pass
+
+    def test02_disabled(self):
+        query = "MATCH (n:L) WHERE n.v = 1 RETURN count(n)"
+        for _ in range(3):
+            result = redis_graph.query(query)
+            self.env.assertEquals(result.result_set, [[NODE_COUNT]])
+
+        stats = self.plan_stats(query)
+        self.env.assertEquals(stats["replanned"], 0)
+        self.env.assertEquals(stats["samples"], 3)
+
+    def test03_replan_misestimated(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "REPLAN_THRESHOLD", 5)
+        query = "MATCH (n:L) WHERE n.v = 1 AND n.w > 0 RETURN count(n)"
+        for _ in range(3):
+            result = redis_graph.query(query)
+            self.env.assertEquals(result.result_set, [[NODE_COUNT]])
+
+        # the first sampled execution produced far more records than estimated
+        # the query is re-planned once, its statistics restarted
+        stats = self.plan_stats(query)
+        self.env.assertEquals(stats["replanned"], 1)
+        self.env.assertEquals(stats["executions"], 3)
+        self.env.assertEquals(stats["samples"], 2)
+
+    def test04_accurate_estimate(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "REPLAN_THRESHOLD", 5)
+        # too few records for a misestimate to matter
+        query = "MATCH (n:L) WHERE n.w = 1 RETURN n.w"
+        for _ in range(3):
+            result = redis_graph.query(query)
+            self.env.assertEquals(result.result_set, [[1]])
+
+        stats = self.plan_stats(query)
+        self.env.assertEquals(stats["replanned"], 0)
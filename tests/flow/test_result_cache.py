@@ -0,0 +1,114 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "result_cache"
+redis_con = None
+redis_graph = None
+
+class testResultCache(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True, moduleArgs="RESULT_CACHE_CAPACITY 1048576")
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 100) AS x CREATE (:L {v: x})")
+
+    # returns the module INFO field ending with 'name'
+    def info_field(self, name):
+        info = redis_con.info("everything")
+        for key in info:
+            if key.endswith(name):
+                return info[key]
+        return None
+
+    def result_cache_memory(self):
+        reply = redis_con.execute_command("GRAPH.MEMORY", GRAPH_ID)
+        return dict(zip(reply[0::2], reply[1::2]))["result_cache"]
+
+    def test01_cached_reply(self):
+        query = "MATCH (n:L) WHERE n.v > 90 RETURN n.v ORDER BY n.v"
+        hits = self.info_field("result_cache_hits")
+        misses = self.info_field("result_cache_misses")
+
+        uncached = redis_graph.query(query)
+        self.env.assertGreater(self.result_cache_memory(), 0)
+        cached = redis_graph.query(query)
+
+        self.env.assertEquals(uncached.result_set, cached.result_set)
+        self.env.assertEquals(uncached.header, cached.header)
+        self.env.assertTrue(cached.cached_execution)
+        self.env.assertEquals(self.info_field("result_cache_misses"), misses + 1)
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits + 1)
+
+        # replies are cached per format
+        res = redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, query, "--compact")
+        self.env.assertEquals(len(res[1]), 10)
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits + 1)
+
+    def test02_parameters(self):
+        query = "MATCH (n:L) WHERE n.v = $v RETURN n.v"
+        res = redis_graph.query(query, {'v': 1})
+        self.env.assertEquals(res.result_set, [[1]])
+        res = redis_graph.query(query, {'v': 2})
+        self.env.assertEquals(res.result_set, [[2]])
+        res = redis_graph.query(query, {'v': 1})
+        self.env.assertEquals(res.result_set, [[1]])
+
+    def test03_invalidation(self):
+        query = "MATCH (n:L) RETURN count(n)"
+        res = redis_graph.query(query)
+        self.env.assertEquals(res.result_set[0][0], 100)
+
+        # modifications discard cached replies
+        redis_graph.query("CREATE (:L {v: 101})")
+        self.env.assertEquals(self.result_cache_memory(), 0)
+
+        hits = self.info_field("result_cache_hits")
+        res = redis_graph.query(query)
+        self.env.assertEquals(res.result_set[0][0], 101)
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits)
+
+    def test04_nondeterministic(self):
+        hits = self.info_field("result_cache_hits")
+        query = "MATCH (n:L) WHERE n.v = 1 RETURN rand()"
+        first = redis_graph.query(query)
+        second = redis_graph.query(query)
+        self.env.assertNotEqual(first.result_set, second.result_set)
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits)
+
+    def test05_no_cache_flag(self):
+        hits = self.info_field("result_cache_hits")
+        query = "MATCH (n:L) WHERE n.v < 5 RETURN n.v"
+        for _ in range(2):
+            redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, query, "--no-cache")
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits)
+
+    def test06_opt_in(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "RESULT_CACHE_OPT_IN", "yes")
+
+        hits = self.info_field("result_cache_hits")
+        query = "MATCH (n:L) WHERE n.v < 10 RETURN n.v"
+        for _ in range(2):
+            redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, query)
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits)
+
+        # queries issued with --cache are served by the cache
+        for _ in range(2):
+            redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, query, "--cache")
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits + 1)
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "RESULT_CACHE_OPT_IN", "no")
+
+    def test07_disabled(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "RESULT_CACHE_CAPACITY", 0)
+        res = redis_con.execute_command("GRAPH.CONFIG", "GET", "RESULT_CACHE_CAPACITY")
+        self.env.assertEquals(res, ["RESULT_CACHE_CAPACITY", 0])
+
+        hits = self.info_field("result_cache_hits")
+        query = "MATCH (n:L) WHERE n.v < 20 RETURN n.v"
+        for _ in range(2):
+            redis_graph.query(query)
+        self.env.assertEquals(self.info_field("result_cache_hits"), hits)
@@ -0,0 +1,82 @@
+from RLTest import Env
+from redis import ResponseError
+from base import FlowTestsBase
+
+GRAPH_ID = "sampled_scans"
+NODE_COUNT = 100000
+redis_con = None
+
+class testSampledScans(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        redis_con = self.env.getConnection()
+        self.populate_graph()
+
+    def populate_graph(self):
+        # spans about a hundred blocks of 1024 node IDs
+        q = "UNWIND range(1, %d) AS x CREATE (:N {v: x})" % NODE_COUNT
+        redis_con.execute_command("GRAPH.QUERY", GRAPH_ID, q)
+
+    def query(self, q, *flags):
+        return redis_con.execute_command("GRAPH.RO_QUERY", GRAPH_ID, q, "--compact", *flags)
+
+    def stat(self, stats, name):
+        for s in stats:
+            if s.startswith(name + ": "):
+                return float(s.split(": ")[1])
+        return None
+
+    def test01_full_sample(self):
+        # a sample rate of 1 scans the entire graph
+        for q in ["MATCH (n) RETURN count(n)", "MATCH (n:N) RETURN count(n)"]:
+            res = self.query(q, "sample", "1")
+            self.env.assertEquals(res[1][0][0][1], NODE_COUNT)
+            self.env.assertIsNone(self.stat(res[2], "Sample rate"))
+            self.env.assertIsNone(self.stat(res[2], "Sample margin of error"))
+
+    def test02_sampled_count(self):
+        # counts are scaled by the inverse of the sample rate
+        for q in ["MATCH (n) RETURN count(n)", "MATCH (n:N) RETURN count(n)"]:
+            res = self.query(q, "sample", "0.5")
+            count = res[1][0][0][1]
+            self.env.assertGreater(count, NODE_COUNT * 0.25)
+            self.env.assertLess(count, NODE_COUNT * 1.75)
+            self.env.assertEquals(self.stat(res[2], "Sample rate"), 0.5)
+            margin = self.stat(res[2], "Sample margin of error")
+            self.env.assertGreater(margin, 0)
+            self.env.assertLess(margin, 0.1)
+
+        # sums are scaled as well, distinct counts are not
+        res = self.query("MATCH (n:N) RETURN sum(1), count(DISTINCT n.v % 10)", "sample", "0.5")
+        self.env.assertGreater(res[1][0][0][1], NODE_COUNT * 0.25)
+        self.env.assertEquals(res[1][0][1][1], 10)
+
+    def test03_sampled_rows(self):
+        # rows are a subset of the graph's nodes
+        res = self.query("MATCH (n:N) RETURN n.v", "sample", "0.1")
+        values = [row[0][1] for row in res[1]]
+        self.env.assertLess(len(values), NODE_COUNT)
+        self.env.assertEquals(len(values), len(set(values)))
+        for v in values:
+            self.env.assertTrue(1 <= v <= NODE_COUNT)
+
+        # records emitted past a limit are not extrapolated
+        res = self.query("MATCH (n:N) WITH n LIMIT 10 RETURN count(n)", "sample", "0.5")
+        self.env.assertEquals(res[1][0][0][1], 10)
+
+    def test04_invalid_sample(self):
+        for rate in ["0", "-0.5", "1.5", "rate"]:
+            try:
+                self.query("MATCH (n) RETURN count(n)", "sample", rate)
+                self.env.assertTrue(False)
+            except ResponseError as e:
+                self.env.assertContains("Failed to parse query sample rate", str(e))
+
+        # write queries aren't sampled
+        try:
+            redis_con.execute_command("GRAPH.QUERY", GRAPH_ID,
+                    "MATCH (n:N) SET n.w = 1", "sample", "0.5")
+            self.env.assertTrue(False)
+        except ResponseError as e:
+            self.env.assertContains("SAMPLE is supported only for read-only queries", str(e))
@@ -41,3 +41,25 @@ class testSlowLog(FlowTestsBase):
         B = redis_con.execute_command("GRAPH.SLOWLOG " + GRAPH_ID)
 
         self.env.assertNotEqual(A, B)
+
+    def test_slowlog_queue_wait(self):
+        redis_graph.query("""MATCH (n) RETURN count(n)""")
+        slowlog = redis_con.execute_command("GRAPH.SLOWLOG " + GRAPH_ID)
+        for item in slowlog:
+            # timestamp, command, query, latency, memory, queue wait and phases
+            self.env.assertEquals(len(item), 7)
+            self.env.assertGreaterEqual(float(item[5]), 0)
+
+    def test_slowlog_phases(self):
+        redis_graph.query("""UNWIND range(1, 1000) AS x RETURN count(x)""")
+        slowlog = redis_con.execute_command("GRAPH.SLOWLOG " + GRAPH_ID)
+        for item in slowlog:
+            phases = dict(zip(item[6][0::2], item[6][1::2]))
+            self.env.assertEquals(list(phases.keys()), ["parse", "cache", "queue",
+                "lock", "sync", "execution", "gil", "reply"])
+            for t in phases.values():
+                self.env.assertGreaterEqual(float(t), 0)
+
+            # phases are accounted for within the query's latency
+            self.env.assertLessEqual(sum(float(t) for t in phases.values()) - float(phases["queue"]),
+                                     float(item[3]) * 1.01 + 0.01)
@@ -0,0 +1,111 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+graph = None
+
+class testSPPaths(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph("proc_sp_paths", redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # (a)-[:R {w: 10}]->(d)
+        # (a)-[:R {w: 1}]->(b)-[:R {w: 2}]->(c)-[:R {w: 3}]->(d)
+        # (d)-[:S {w: 1}]->(e)
+        # (e)-[:R]->(f), edge lacks a cost
+        q = """CREATE (a:N {v: 'a'}), (b:N {v: 'b'}), (c:N {v: 'c'}),
+                      (d:N {v: 'd'}), (e:N {v: 'e'}), (f:N {v: 'f'}),
+                      (a)-[:R {w: 10}]->(d),
+                      (a)-[:R {w: 1}]->(b)-[:R {w: 2}]->(c)-[:R {w: 3}]->(d),
+                      (d)-[:S {w: 1}]->(e), (e)-[:R]->(f)"""
+        graph.query(q)
+
+    def test01_cheapest_path(self):
+        # the cheapest path takes more hops than the direct edge
+        q = """MATCH (a {v: 'a'}), (d {v: 'd'})
+               CALL algo.SPpaths(a, d, 'R', 'w', NULL) YIELD path, cost
+               RETURN [n IN nodes(path) | n.v], cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[['a', 'b', 'c', 'd'], 6.0]])
+
+        # without costs the fewest hops win
+        q = """MATCH (a {v: 'a'}), (d {v: 'd'})
+               CALL algo.SPpaths(a, d, 'R', NULL, NULL) YIELD path, cost
+               RETURN [n IN nodes(path) | n.v], [e IN relationships(path) | e.w], cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[['a', 'd'], [10], 1.0]])
+
+    def test02_max_cost(self):
+        q = """MATCH (a {v: 'a'}), (d {v: 'd'})
+               CALL algo.SPpaths(a, d, 'R', 'w', 5) YIELD cost
+               RETURN cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [])
+
+        q = """MATCH (a {v: 'a'}), (d {v: 'd'})
+               CALL algo.SPpaths(a, d, 'R', 'w', 6) YIELD cost
+               RETURN cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[6.0]])
+
+    def test03_all_targets(self):
+        # edges of any type, (e)->(f) lacks a cost and isn't traversed
+        q = """MATCH (a {v: 'a'})
+               CALL algo.SPpaths(a, NULL, NULL, 'w', NULL) YIELD path, cost
+               RETURN last(nodes(path)).v, length(path), cost
+               ORDER BY cost"""
+        result = graph.query(q)
+        expected = [['b', 1, 1.0],
+                    ['c', 2, 3.0],
+                    ['d', 3, 6.0],
+                    ['e', 4, 7.0]]
+        self.env.assertEquals(result.result_set, expected)
+
+        # restricted to a single relationship type
+        q = """MATCH (d {v: 'd'})
+               CALL algo.SPpaths(d, NULL, 'R', 'w', NULL) YIELD cost
+               RETURN count(cost)"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[0]])
+
+    def test04_unreachable(self):
+        q = """MATCH (d {v: 'd'}), (a {v: 'a'})
+               CALL algo.SPpaths(d, a, NULL, 'w', NULL) YIELD cost
+               RETURN cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [])
+
+        # unknown relationship type and cost attribute
+        q = """MATCH (a {v: 'a'}), (d {v: 'd'})
+               CALL algo.SPpaths(a, d, 'FAKE', 'w', NULL) YIELD cost
+               RETURN cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [])
+
+        q = """MATCH (a {v: 'a'}), (d {v: 'd'})
+               CALL algo.SPpaths(a, d, 'R', 'fake', NULL) YIELD cost
+               RETURN cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [])
+
+    def test05_source_is_target(self):
+        q = """MATCH (a {v: 'a'})
+               CALL algo.SPpaths(a, a, 'R', 'w', NULL) YIELD path, cost
+               RETURN length(path), cost"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[0, 0.0]])
+
+    def test06_negative_cost(self):
+        graph.query("MATCH (a {v: 'a'}) CREATE (a)-[:NEG {w: -1}]->(:N {v: 'g'})")
+        try:
+            q = """MATCH (a {v: 'a'})
+                   CALL algo.SPpaths(a, NULL, 'NEG', 'w', NULL) YIELD cost
+                   RETURN cost"""
+            graph.query(q)
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("non-negative", str(e))
@@ -0,0 +1,95 @@
+import threading
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "split_writes"
+CLIENT_COUNT = 8         # Number of concurrent connections.
+QUERIES_PER_CLIENT = 25  # Write queries issued by each connection.
+redis_con = None
+redis_graph = None
+
+def issue_increments(env, client_id, results):
+    con = env.getConnection()
+    graph = Graph(GRAPH_ID, con)
+    ok = True
+    for i in range(QUERIES_PER_CLIENT):
+        # label scans are costly, their read phase runs on a reader thread
+        # the unwind prolongs the read phase, such that concurrent increments
+        # read the counter ahead of each other's commit
+        res = graph.query("""MATCH (c:Counter)
+                             UNWIND range(1, 20000) AS x
+                             WITH c, count(x) AS k
+                             SET c.v = c.v + 1""")
+        if res.properties_set != 1:
+            ok = False
+    results[client_id] = ok
+
+class testSplitWrites(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 100) AS x CREATE (:L {v: x})")
+
+    def tearDown(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "SPLIT_WRITE_QUERIES", "no")
+
+    def write_conflicts(self):
+        info = redis_con.execute_command("INFO", "graph_metrics")
+        return info["graph_write_conflicts"]
+
+    def test01_default(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "SPLIT_WRITE_QUERIES")
+        self.env.assertEquals(response[1], 0)
+
+    def test02_split_write(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "SPLIT_WRITE_QUERIES", "yes")
+
+        result = redis_graph.query("MATCH (n:L) WHERE n.v % 2 = 0 SET n.even = true RETURN count(n)")
+        self.env.assertEquals(result.properties_set, 50)
+        self.env.assertEquals(result.result_set, [[50]])
+
+        result = redis_graph.query("MATCH (n:L) WHERE n.even CREATE (:M {v: n.v})")
+        self.env.assertEquals(result.nodes_created, 50)
+
+        result = redis_graph.query("MATCH (n:M) WHERE n.v > 50 DELETE n")
+        self.env.assertEquals(result.nodes_deleted, 25)
+
+        result = redis_graph.query("MATCH (n:M) RETURN count(n), sum(n.v)")
+        self.env.assertEquals(result.result_set, [[25, 650]])
+
+        # a failing query holds no lock once it replied
+        try:
+            redis_graph.query("MATCH (n:L) SET n.v = n.v / 'a'")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
+        result = redis_graph.query("MATCH (n:L {v: 1}) SET n.v = 1")
+        self.env.assertEquals(result.properties_set, 1)
+
+    def test03_concurrent_split_writes(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "SPLIT_WRITE_QUERIES", "yes")
+        redis_graph.query("CREATE (:Counter {v: 0})")
+        conflicts = self.write_conflicts()
+
+        results = [False] * CLIENT_COUNT
+        threads = []
+        for i in range(CLIENT_COUNT):
+            t = threading.Thread(target=issue_increments, args=(self.env, i, results))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        self.env.assertEquals(results, [True] * CLIENT_COUNT)
+
+        # increments computed against a stale graph were executed anew
+        res = redis_graph.query("MATCH (c:Counter) RETURN c.v")
+        self.env.assertEquals(res.result_set[0][0], CLIENT_COUNT * QUERIES_PER_CLIENT)
+        # concurrent increments conflicted, at least one was executed anew
+        self.env.assertGreater(self.write_conflicts(), conflicts)
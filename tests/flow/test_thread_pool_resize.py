@@ -0,0 +1,92 @@
+import time
+import threading
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "thread_pool_resize"
+redis_con = None
+redis_graph = None
+
+def issue_queries(env, count):
+    con = env.getConnection()
+    graph = Graph(GRAPH_ID, con)
+    for i in range(count):
+        graph.query("UNWIND range(1, 200000) AS x RETURN count(x)")
+
+class testThreadPoolResize(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True, moduleArgs="THREAD_COUNT 2 MAX_THREAD_COUNT 6")
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("CREATE (:L {v: 1})")
+
+    def reader_threads(self):
+        info = redis_con.execute_command("INFO", "graph_metrics")
+        return info["graph_reader_threads"]
+
+    def wait_for_readers(self, predicate, timeout=10):
+        deadline = time.time() + timeout
+        while not predicate(self.reader_threads()) and time.time() < deadline:
+            time.sleep(0.1)
+        return self.reader_threads()
+
+    def test01_resize(self):
+        self.env.assertEquals(self.reader_threads(), 2)
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_COUNT", 5)
+        self.env.assertEquals(self.reader_threads(), 5)
+        result = redis_graph.query("MATCH (n:L) RETURN n.v")
+        self.env.assertEquals(result.result_set, [[1]])
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_COUNT", 1)
+        self.env.assertEquals(self.reader_threads(), 1)
+        result = redis_graph.query("MATCH (n:L) RETURN n.v")
+        self.env.assertEquals(result.result_set, [[1]])
+
+        # the pool can't grow beyond MAX_THREAD_COUNT
+        try:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_COUNT", 7)
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("Failed to set config value", str(e))
+        self.env.assertEquals(self.reader_threads(), 1)
+
+        # MAX_THREAD_COUNT is set on load
+        try:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "MAX_THREAD_COUNT", 10)
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("Field can not be re-configured", str(e))
+
+    def test02_autoscale(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_COUNT", 1)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "MIN_THREAD_COUNT", 1)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_AUTOSCALE", "yes")
+
+        # queries wait for the single reader, readers are added
+        threads = []
+        for i in range(8):
+            t = threading.Thread(target=issue_queries, args=(self.env, 20))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        readers = self.wait_for_readers(lambda n: n > 1)
+        self.env.assertGreater(readers, 1)
+        self.env.assertLessEqual(readers, 6)
+
+        for t in threads:
+            t.join()
+
+        # idle readers are removed
+        readers = self.wait_for_readers(lambda n: n == 1)
+        self.env.assertEquals(readers, 1)
+
+        # disabling autoscaling restores THREAD_COUNT
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_COUNT", 3)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "THREAD_AUTOSCALE", "no")
+        readers = self.wait_for_readers(lambda n: n == 3)
+        self.env.assertEquals(readers, 3)
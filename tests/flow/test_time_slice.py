@@ -0,0 +1,80 @@
+import threading
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_ID = "time_slice"
+NODE_COUNT = 100000
+redis_con = None
+redis_graph = None
+
+def run_query(env, query, results, key):
+    con = env.getConnection()
+    graph = Graph(GRAPH_ID, con)
+    results[key] = graph.query(query).result_set
+
+class testTimeSlice(FlowTestsBase):
+    def __init__(self):
+        # a single reader thread, forcing queries to share it
+        self.env = Env(decodeResponses=True, moduleArgs="THREAD_COUNT 1")
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, %d) AS x CREATE (:N {v: x})" % NODE_COUNT)
+
+    def tearDown(self):
+        # restore running queries to completion
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "QUERY_TIME_SLICE", 0)
+
+    def test01_default_time_slice(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "QUERY_TIME_SLICE")
+        self.env.assertEquals(response[1], 0)
+
+    def test02_sliced_queries_complete(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "QUERY_TIME_SLICE", 1)
+
+        long_query = "MATCH (n:N) RETURN n.v ORDER BY n.v"
+        short_query = "RETURN 1"
+        write_query = "CREATE (:M)"
+
+        results = {}
+        threads = []
+        for key, q in [("long", long_query), ("short_0", short_query),
+                       ("write", write_query), ("short_1", short_query)]:
+            t = threading.Thread(target=run_query, args=(self.env, q, results, key))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        # yielding doesn't affect results
+        self.env.assertEquals(results["short_0"], [[1]])
+        self.env.assertEquals(results["short_1"], [[1]])
+        self.env.assertEquals(len(results["long"]), NODE_COUNT)
+        self.env.assertEquals(results["long"][0], [1])
+        self.env.assertEquals(results["long"][-1], [NODE_COUNT])
+
+        res = redis_graph.query("MATCH (m:M) RETURN count(m)")
+        self.env.assertEquals(res.result_set[0][0], 1)
+
+    def test03_streaming_query_yields(self):
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "QUERY_TIME_SLICE", 1)
+
+        # a streaming query producing many records
+        q = "MATCH (n:N) RETURN n.v"
+        results = {}
+        threads = []
+        for i in range(4):
+            t = threading.Thread(target=run_query, args=(self.env, q, results, i))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        for i in range(4):
+            self.env.assertEquals(len(results[i]), NODE_COUNT)
@@ -52,7 +52,7 @@ class testQueryTimeout(FlowTestsBase):
             self.env.assertContains("Query timed out", str(error))
 
     def test03_write_query_ignore_timeout(self):
-        # Verify that the timeout argument is ignored by write queries
+        # Verify that the timeout is ignored by write queries once they began committing
         query = "CREATE (a:M) WITH a UNWIND range(1,10000) AS ctr SET a.v = ctr"
         try:
             # The query should complete successfully
@@ -63,3 +63,37 @@ class testQueryTimeout(FlowTestsBase):
             self.env.assertEquals(actual_result.properties_set, 10000)
         except ResponseError:
             assert(False)
+
+    def test04_write_query_timeout(self):
+        # create consumes all of its input before committing,
+        # a write query timing out beforehand commits no changes
+        query = "UNWIND range(1, 1000000) AS x CREATE (:T {v: x})"
+        try:
+            redis_graph.query(query, timeout=1)
+            assert(False)
+        except ResponseError as error:
+            self.env.assertContains("Query timed out", str(error))
+
+        result = redis_graph.query("MATCH (n:T) RETURN count(n)", timeout=1000)
+        self.env.assertEquals(result.result_set[0][0], 0)
+
+        # the write query succeeds given enough time
+        result = redis_graph.query("UNWIND range(1, 10) AS x CREATE (:T {v: x})", timeout=1000)
+        self.env.assertEquals(result.nodes_created, 10)
+
+    def test05_cost_budget_config(self):
+        for config_name, value in [("QUERY_COST_BUDGET", 1000), ("REJECT_OVER_BUDGET", "yes")]:
+            response = redis_con.execute_command("GRAPH.CONFIG", "SET", config_name, value)
+            self.env.assertEqual(response, "OK")
+        self.env.assertEqual(redis_con.execute_command("GRAPH.CONFIG", "GET", "QUERY_COST_BUDGET"),
+                             ["QUERY_COST_BUDGET", 1000])
+        self.env.assertEqual(redis_con.execute_command("GRAPH.CONFIG", "GET", "REJECT_OVER_BUDGET"),
+                             ["REJECT_OVER_BUDGET", 1])
+
+        # queries are admitted while readers are idle, regardless of their cost
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "timeout", 0)
+        result = redis_graph.query("MATCH (n) RETURN count(n)")
+        self.env.assertGreater(result.result_set[0][0], 0)
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "QUERY_COST_BUDGET", 0)
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "REJECT_OVER_BUDGET", "no")
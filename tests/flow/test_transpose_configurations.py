@@ -149,3 +149,38 @@ class testTransposeConfigurations(FlowTestsBase):
 
         # Validate that the output is the same with both configurations
         configured_env.assertEquals(configured_result.result_set, default_result.result_set)
+
+    # Test that transposes computed on demand reflect modifications.
+    def test04_transpose_cache_updates(self):
+        self.env.flush()
+        self.env.stop()
+
+        # Instantiate a new server without transposed matrices
+        configured_env = Env(decodeResponses=True, moduleArgs="MAINTAIN_TRANSPOSED_MATRICES no")
+        configured_graph = Graph(GRAPH_ID, configured_env.getConnection())
+        self.populate_graph(configured_graph)
+
+        # Traverse from destination to source, computing the transpose
+        query = """MATCH (a)<-[:E]-(b:L) RETURN a.val, b.val ORDER BY a.val, b.val"""
+        result = configured_graph.query(query)
+        expected_result = [['v2', 'v1'],
+                           ['v3', 'v1'],
+                           ['v3', 'v2']]
+        configured_env.assertEquals(result.result_set, expected_result)
+
+        # Introduce an edge, the cached transpose must reflect it
+        configured_graph.query("""MATCH (a {val: 'v3'}), (b {val: 'v1'}) CREATE (a)-[:E]->(b)""")
+        result = configured_graph.query(query)
+        expected_result = [['v1', 'v3'],
+                           ['v2', 'v1'],
+                           ['v3', 'v1'],
+                           ['v3', 'v2']]
+        configured_env.assertEquals(result.result_set, expected_result)
+
+        # Delete an edge, the cached transpose must be recomputed
+        configured_graph.query("""MATCH ({val: 'v1'})-[e:E]->({val: 'v2'}) DELETE e""")
+        result = configured_graph.query(query)
+        expected_result = [['v1', 'v3'],
+                           ['v3', 'v1'],
+                           ['v3', 'v2']]
+        configured_env.assertEquals(result.result_set, expected_result)
@@ -0,0 +1,51 @@
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+graph = None
+
+class testTriangleCount(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph("proc_triangle_count", redis_con)
+        self.populate_graph()
+
+    def populate_graph(self):
+        # (a)-(b)-(c) triangle, (c)-(d) edge, (b)-(d) of another type
+        q = """CREATE (a:P {v: 'a'}), (b:P {v: 'b'}), (c:P {v: 'c'}), (d:Q {v: 'd'}),
+                      (a)-[:R]->(b), (b)-[:R]->(c), (a)<-[:R]-(c), (c)-[:R]->(d),
+                      (d)-[:S]->(b), (a)-[:R]->(a)"""
+        graph.query(q)
+
+    def test01_per_node(self):
+        q = """CALL algo.triangleCount(NULL, 'R') YIELD node, triangles, coefficient
+               RETURN node.v, triangles, coefficient ORDER BY node.v"""
+        result = graph.query(q)
+        expected = [['a', 1, 1.0],
+                    ['b', 1, 1.0],
+                    ['c', 1, 1 / 3],
+                    ['d', 0, 0.0]]
+        self.env.assertEquals(len(result.result_set), len(expected))
+        for row, expected_row in zip(result.result_set, expected):
+            self.env.assertEquals(row[:2], expected_row[:2])
+            self.env.assertAlmostEqual(row[2], expected_row[2], 1e-6)
+
+    def test02_all_relationships(self):
+        # (b)-(c)-(d) forms a second triangle
+        q = """CALL algo.triangleCount(NULL, NULL) YIELD triangles
+               RETURN sum(triangles) / 3"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[2]])
+
+    def test03_label(self):
+        q = """CALL algo.triangleCount('P', NULL) YIELD node, triangles
+               RETURN node.v, triangles ORDER BY node.v"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [['a', 1], ['b', 1], ['c', 1]])
+
+        q = """CALL algo.triangleCount('FAKE', NULL) YIELD node
+               RETURN count(node)"""
+        result = graph.query(q)
+        self.env.assertEquals(result.result_set, [[0]])
@@ -119,3 +119,42 @@ class testUnion(FlowTestsBase):
 
         # The same results should be produced regardless of whether ALL is specified.
         self.env.assertEquals(union_result.result_set, union_all_result.result_set)
+
+    # Branches executed concurrently emit their records in the branches' order.
+    def test07_union_branch_parallelism(self):
+        redis_con = self.env.getConnection()
+        query = """UNWIND range(1, 100) AS x RETURN x
+                   UNION ALL
+                   MATCH (n:L) RETURN n.v AS x
+                   UNION ALL
+                   UNWIND range(101, 200) AS x RETURN x
+                   UNION ALL
+                   MATCH ()-[e]->() RETURN e.v AS x"""
+
+        results = []
+        for parallelism in [1, 4]:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "BRANCH_PARALLELISM", parallelism)
+            results.append(redis_graph.query(query).result_set)
+
+        expected = [[x] for x in range(1, 101)] + [["v1"], ["v2"], ["v3"]] + \
+                   [[x] for x in range(101, 201)] + [["v1_v2"], ["v2_v3"]]
+        self.env.assertEquals(results[0], expected)
+        self.env.assertEquals(results[1], expected)
+
+        # an error raised by any branch fails the query
+        try:
+            redis_graph.query("""RETURN 1 AS x
+                                 UNION ALL
+                                 UNWIND range(0, 1) AS y RETURN toUpper(y) AS x""")
+            self.env.assertTrue(False)
+        except redis.exceptions.ResponseError:
+            pass
+
+        # branches calling procedures execute sequentially
+        query = """CALL db.labels() YIELD label RETURN label
+                   UNION
+                   MATCH (n:L) RETURN n.v AS label"""
+        result = redis_graph.query(query)
+        self.env.assertEquals(result.result_set, [["L"], ["v1"], ["v2"], ["v3"]])
+
+        redis_con.execute_command("GRAPH.CONFIG", "SET", "BRANCH_PARALLELISM", 4)
@@ -0,0 +1,115 @@
+from RLTest import Env
+from redisgraph import Graph
+
+from base import FlowTestsBase
+
+GRAPH_ID = "unique_constraints"
+redis_con = None
+redis_graph = None
+
+class testUniqueConstraints(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True)
+        global redis_con
+        global redis_graph
+        redis_con = self.env.getConnection()
+        redis_graph = Graph(GRAPH_ID, redis_con)
+        redis_graph.query("UNWIND range(1, 10) AS x CREATE (:User {id: x})")
+
+    def expect_violation(self, query):
+        try:
+            redis_graph.query(query)
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("uniqueness constraint", str(e))
+
+    def user_count(self):
+        return redis_graph.query("MATCH (u:User) RETURN count(u)").result_set[0][0]
+
+    def test01_create_constraint(self):
+        result = redis_graph.query("CREATE CONSTRAINT ON (u:User) ASSERT u.id IS UNIQUE")
+        self.env.assertEquals(result.indices_created, 1)
+
+        # the property is already constrained
+        try:
+            redis_graph.query("CREATE CONSTRAINT ON (u:User) ASSERT u.id IS UNIQUE")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("Unable to create constraint", str(e))
+
+        # existing nodes hold duplicate values
+        redis_graph.query("CREATE (:Dup {v: 1}), (:Dup {v: 1})")
+        try:
+            redis_graph.query("CREATE CONSTRAINT ON (d:Dup) ASSERT d.v IS UNIQUE")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("Unable to create constraint", str(e))
+
+    def test02_create_violation(self):
+        self.expect_violation("CREATE (:User {id: 1})")
+        # numerics are compared by value
+        self.expect_violation("CREATE (:User {id: 2.0})")
+        # pending nodes collide with one another
+        self.expect_violation("CREATE (:User {id: 100}), (:User {id: 100})")
+        self.env.assertEquals(self.user_count(), 10)
+
+        # distinct and missing values are accepted
+        result = redis_graph.query("CREATE (:User {id: 11}), (:User {id: 'a'}), (:User)")
+        self.env.assertEquals(result.nodes_created, 3)
+
+    def test03_set_violation(self):
+        self.expect_violation("MATCH (u:User {id: 1}) SET u.id = 2")
+        self.expect_violation("MATCH (u:User) WHERE u.id IN [3, 4] SET u.id = 200")
+
+        # a node may keep its value, freed values can be taken
+        redis_graph.query("MATCH (u:User {id: 1}) SET u.id = 1")
+        redis_graph.query("MATCH (u:User {id: 1}) SET u.id = 300")
+        result = redis_graph.query("MATCH (u:User {id: 5}) SET u.id = 1")
+        self.env.assertEquals(result.properties_set, 1)
+
+        # deleted nodes release their value
+        redis_graph.query("MATCH (u:User {id: 300}) DELETE u")
+        result = redis_graph.query("CREATE (:User {id: 300})")
+        self.env.assertEquals(result.nodes_created, 1)
+
+    def test04_merge(self):
+        count = self.user_count()
+
+        # matched and created through the constraint
+        result = redis_graph.query("MERGE (u:User {id: 2}) RETURN u.id")
+        self.env.assertEquals(result.nodes_created, 0)
+        self.env.assertEquals(result.result_set, [[2]])
+
+        result = redis_graph.query("MERGE (u:User {id: 400}) RETURN u.id")
+        self.env.assertEquals(result.nodes_created, 1)
+        self.env.assertEquals(result.result_set, [[400]])
+
+        # bound records, repeated keys create a single node
+        result = redis_graph.query("UNWIND [2, 3, 401, 401] AS x MERGE (u:User {id: x}) "
+                                   "ON CREATE SET u.created = true RETURN u.id ORDER BY u.id")
+        self.env.assertEquals(result.nodes_created, 1)
+        self.env.assertEquals(result.result_set, [[2], [3], [401], [401]])
+        self.env.assertEquals(self.user_count(), count + 2)
+
+        # the key's other properties must match the constrained node
+        self.expect_violation("MERGE (u:User {id: 2, name: 'x'})")
+
+        # ON MATCH updates are constrained as well
+        self.expect_violation("MERGE (u:User {id: 2}) ON MATCH SET u.id = 3")
+
+    def test05_persistency(self):
+        redis_con.execute_command("DEBUG", "RELOAD")
+        self.expect_violation("CREATE (:User {id: 2})")
+
+    def test06_drop_constraint(self):
+        result = redis_graph.query("DROP CONSTRAINT ON (u:User) ASSERT u.id IS UNIQUE")
+        self.env.assertEquals(result.indices_deleted, 1)
+
+        result = redis_graph.query("CREATE (:User {id: 2})")
+        self.env.assertEquals(result.nodes_created, 1)
+
+        try:
+            redis_graph.query("DROP CONSTRAINT ON (u:User) ASSERT u.id IS UNIQUE")
+            self.env.assertTrue(False)
+        except Exception as e:
+            self.env.assertIn("no such constraint", str(e))
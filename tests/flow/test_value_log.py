@@ -0,0 +1,111 @@
+import os
+import sys
+import time
+from RLTest import Env
+from redisgraph import Graph
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+
+from base import FlowTestsBase
+
+GRAPH_ID = "value_log"
+THRESHOLD = 64
+redis_con = None
+graph = None
+
+# returns a string of 'length' characters, distinct per 'seed'
+def long_string(seed, length=1000):
+    prefix = "value %d " % seed
+    return prefix + "x" * (length - len(prefix))
+
+class testValueLog(FlowTestsBase):
+    def __init__(self):
+        # strings of at least THRESHOLD bytes are held by the value log
+        self.env = Env(decodeResponses=True, moduleArgs="VALUE_LOG_THRESHOLD %d" % THRESHOLD)
+        global redis_con
+        global graph
+        redis_con = self.env.getConnection()
+        graph = Graph(GRAPH_ID, redis_con)
+
+    def memory(self):
+        reply = redis_con.execute_command("GRAPH.MEMORY", GRAPH_ID)
+        return dict(zip(reply[0::2], reply[1::2]))
+
+    def maintenance_stats(self):
+        res = redis_con.execute_command("GRAPH.MAINTENANCE")
+        return dict(zip(res[0::2], res[1::2]))
+
+    def test01_config(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "VALUE_LOG_THRESHOLD")
+        self.env.assertEquals(response, ["VALUE_LOG_THRESHOLD", THRESHOLD])
+
+        # the value log is configured as the module loads
+        try:
+            redis_con.execute_command("GRAPH.CONFIG", "SET", "VALUE_LOG_THRESHOLD", "128")
+            self.env.assertTrue(False)
+        except Exception:
+            pass
+
+    def test02_logged_properties(self):
+        params = {"long": long_string(0), "short": "short"}
+        graph.query("CREATE (:L {id: 0, long: $long, short: $short})-[:R {long: $long}]->(:L {id: 1})", params)
+        self.env.assertGreater(self.memory()["value_log"], 0)
+
+        result = graph.query("MATCH (a:L {id: 0})-[e:R]->() RETURN a.long, a.short, e.long")
+        self.env.assertEquals(result.result_set, [[params["long"], "short", params["long"]]])
+
+        # logged strings are compared and manipulated as any other string
+        result = graph.query("MATCH (a:L) WHERE a.long = $long RETURN a.id, size(a.long), left(a.long, 7)", params)
+        self.env.assertEquals(result.result_set, [[0, 1000, "value 0"]])
+
+        # updating a logged property
+        params["long"] = long_string(1)
+        graph.query("MATCH (a:L {id: 0}) SET a.long = $long", params)
+        result = graph.query("MATCH (a:L {id: 0}) RETURN a.long")
+        self.env.assertEquals(result.result_set, [[params["long"]]])
+
+        # replacing a logged string by a short one, then removing it
+        graph.query("MATCH (a:L {id: 0}) SET a.long = 'short'")
+        result = graph.query("MATCH (a:L {id: 0}) RETURN a.long")
+        self.env.assertEquals(result.result_set, [["short"]])
+        graph.query("MATCH (a:L {id: 0}) SET a.long = NULL")
+        result = graph.query("MATCH (a:L {id: 0}) RETURN a.long")
+        self.env.assertEquals(result.result_set, [[None]])
+
+        # deleting entities holding logged strings
+        graph.query("MATCH ()-[e:R]->() DELETE e")
+        result = graph.query("MATCH ()-[e:R]->() RETURN count(e)")
+        self.env.assertEquals(result.result_set, [[0]])
+
+    def test03_persistence(self):
+        graph.query("UNWIND range(10, 19) AS x CREATE (:P {id: x, long: 'value ' + toString(x) + $pad})",
+                    {"pad": "x" * THRESHOLD})
+        query = "MATCH (p:P) RETURN p.id, p.long ORDER BY p.id"
+        expected = graph.query(query).result_set
+
+        redis_con.execute_command("DEBUG", "RELOAD")
+
+        # loaded strings are held by the value log
+        self.env.assertEquals(graph.query(query).result_set, expected)
+        self.env.assertGreater(self.memory()["value_log"], 0)
+
+    def test04_compaction(self):
+        graph.query("UNWIND range(0, 5999) AS x CREATE (:C {id: x, long: toString(x) + $pad})",
+                    {"pad": "a" * 1000})
+
+        # overwritten values are released, calling for compaction
+        # once their segment is sealed by the values appended next
+        runs = self.maintenance_stats()["values"]
+        graph.query("MATCH (c:C) SET c.long = toString(c.id) + $pad", {"pad": "b" * 1000})
+
+        deadline = time.time() + 10
+        while self.maintenance_stats()["values"] == runs and time.time() < deadline:
+            time.sleep(0.1)
+        self.env.assertGreater(self.maintenance_stats()["values"], runs)
+
+        # relocated values are intact
+        result = graph.query("MATCH (c:C) WHERE c.long <> toString(c.id) + $pad RETURN count(c)",
+                             {"pad": "b" * 1000})
+        self.env.assertEquals(result.result_set, [[0]])
+        result = graph.query("MATCH (c:C {id: 42}) RETURN c.long")
+        self.env.assertEquals(result.result_set, [["42" + "b" * 1000]])
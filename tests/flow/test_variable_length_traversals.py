@@ -164,3 +164,65 @@ class testVariableLengthTraversals(FlowTestsBase):
         actual_result = redis_graph.query(query)
         expected_result = [['B', 'D']]
         self.env.assertEquals(actual_result.result_set, expected_result)
+
+    # Distinct destinations are computed without enumerating paths
+    def test10_distinct_reachable_nodes(self):
+        g = Graph("reach", redis_con)
+        # a diamond leading into a cycle, reachable via multiple paths
+        g.query("""CREATE (a:R {v: 1}), (b:R {v: 2}), (c:R {v: 3}), (d:R {v: 4}), (e:R {v: 5}),
+                   (a)-[:E]->(b), (a)-[:E]->(c), (b)-[:E]->(d), (c)-[:E]->(d),
+                   (d)-[:E]->(e), (e)-[:E]->(d), (e)-[:E]->(a)""")
+
+        patterns = ["-[*]->", "-[*0..2]->", "-[*1..2]->", "-[*..3]->", "<-[*]-", "-[*1..3]-", "-[:E*]->"]
+        for pattern in patterns:
+            # named paths require path enumeration
+            q = "MATCH p = (s:R {v: 1})%s(t) RETURN DISTINCT t.v ORDER BY t.v" % pattern
+            expected = g.query(q).result_set
+            q = "MATCH (s:R {v: 1})%s(t) RETURN DISTINCT t.v ORDER BY t.v" % pattern
+            actual = g.query(q).result_set
+            self.env.assertEquals(actual, expected)
+
+            # multiple sources are traversed as a batch
+            q = "MATCH p = (s:R)%s(t) RETURN DISTINCT s.v, t.v ORDER BY s.v, t.v" % pattern
+            expected = g.query(q).result_set
+            q = "MATCH (s:R)%s(t) RETURN DISTINCT s.v, t.v ORDER BY s.v, t.v" % pattern
+            actual = g.query(q).result_set
+            self.env.assertEquals(actual, expected)
+
+        # without DISTINCT, a record is produced per path
+        res = g.query("MATCH (s:R {v: 1})-[*1..3]->(t:R {v: 4}) RETURN count(t)")
+        self.env.assertEquals(res.result_set[0][0], 2)
+
+        # existence checks
+        q = "MATCH (s:R), (t:R {v: 1}) WHERE (s)-[*]->(t) RETURN s.v ORDER BY s.v"
+        res = g.query(q)
+        self.env.assertEquals(res.result_set, [[1], [2], [3], [4], [5]])
+        q = "MATCH (s:R) WHERE NOT (s)-[*2..]->() RETURN s.v ORDER BY s.v"
+        res = g.query(q)
+        self.env.assertEquals(res.result_set, [])
+
+        g.delete()
+
+    # Dense frontiers are expanded by pulling rather than pushing
+    def test11_dense_reachable_nodes(self):
+        g = Graph("dense_reach", redis_con)
+        # a complete graph, the frontier covers every node after a single hop,
+        # and a tail only reachable from the complete graph
+        g.query("""UNWIND range(1, 20) AS i CREATE (:D {v: i})""")
+        g.query("""MATCH (a:D), (b:D) WHERE a <> b CREATE (a)-[:E]->(b)""")
+        g.query("""MATCH (a:D {v: 20}) CREATE (a)-[:E]->(:T {v: 21})-[:E]->(:T {v: 22})""")
+
+        # pattern, nodes reachable from v: 1, min and max over every source
+        cases = [("-[*]->", 22, 22, 22), ("-[*1..2]->", 21, 21, 22),
+                 ("<-[*]-", 20, 20, 20), ("-[*]-", 22, 22, 22)]
+        for pattern, expected, expected_min, expected_max in cases:
+            q = "MATCH (s:D {v: 1})%s(t) RETURN count(DISTINCT t)" % pattern
+            res = g.query(q)
+            self.env.assertEquals(res.result_set[0][0], expected)
+
+            # multiple sources are traversed as a batch
+            q = "MATCH (s:D)%s(t) WITH s, count(DISTINCT t) AS c RETURN min(c), max(c)" % pattern
+            res = g.query(q)
+            self.env.assertEquals(res.result_set[0], [expected_min, expected_max])
+
+        g.delete()
@@ -241,3 +241,26 @@ class testWithClause(FlowTestsBase):
         actual_result = redis_graph.query(query)
         expected = [['projected']] # The projected string should be returned
         self.env.assertTrue(re.search('Filter\s+Project', plan))
+
+    # Verify that filters sharing an expression with the preceding projection read its projected value.
+    def test11_filter_shared_projection(self):
+        query = """MATCH (a:label_a) WITH a, a.a_idx + 1 AS s WHERE a.a_idx + 1 > 3 RETURN s ORDER BY a.a_idx + 1"""
+        actual_result = redis_graph.query(query)
+        expected = [[4], [5], [6]]
+        self.env.assertEqual(actual_result.result_set, expected)
+        plan = redis_graph.execution_plan(query)
+        self.env.assertTrue(re.search('Filter\s+Project', plan))
+
+        # Filtered variables refer to the projection's output, not its input.
+        query = """MATCH (a:label_a), (b:label_b) WHERE a.a_idx = 0 AND b.b_idx = 2 WITH b AS a, a.a_idx + 1 AS s WHERE a.a_idx + 1 = s RETURN s"""
+        actual_result = redis_graph.query(query)
+        self.env.assertEqual(actual_result.result_set, [])
+
+        query = """MATCH (a:label_a), (b:label_b) WHERE a.a_idx = 0 AND b.b_idx = 0 WITH b AS a, a.a_idx + 1 AS s WHERE a.b_idx + 1 = s RETURN s"""
+        actual_result = redis_graph.query(query)
+        self.env.assertEqual(actual_result.result_set, [[1]])
+
+        # Identical nondeterministic expressions are evaluated separately.
+        query = """UNWIND range(1, 20) AS x WITH rand() AS a, rand() AS b WHERE a <> b RETURN count(1)"""
+        actual_result = redis_graph.query(query)
+        self.env.assertEqual(actual_result.result_set, [[20]])
@@ -0,0 +1,66 @@
+import threading
+from RLTest import Env
+from redisgraph import Graph
+from base import FlowTestsBase
+
+GRAPH_COUNT = 8         # Number of graphs, each written by its own connection.
+QUERIES_PER_GRAPH = 25  # Write queries issued against each graph.
+redis_con = None
+
+def issue_writes(env, graph_id, results):
+    con = env.getConnection()
+    graph = Graph(graph_id, con)
+    ok = True
+    for i in range(QUERIES_PER_GRAPH):
+        res = graph.query("CREATE (:N {i: %d})" % i)
+        if res.nodes_created != 1:
+            ok = False
+    # writes against a graph are executed in order
+    res = graph.query("MATCH (n:N) RETURN collect(n.i)")
+    if res.result_set[0][0] != list(range(QUERIES_PER_GRAPH)):
+        ok = False
+    results[graph_id] = ok
+
+class testWriterThreads(FlowTestsBase):
+    def __init__(self):
+        self.env = Env(decodeResponses=True, moduleArgs="WRITER_THREAD_COUNT 4")
+        global redis_con
+        redis_con = self.env.getConnection()
+
+    def test01_writer_thread_count(self):
+        response = redis_con.execute_command("GRAPH.CONFIG", "GET", "WRITER_THREAD_COUNT")
+        self.env.assertEquals(response[1], 4)
+
+    def test02_concurrent_writes_across_graphs(self):
+        graph_ids = ["writer_lane_%d" % i for i in range(GRAPH_COUNT)]
+        results = {}
+        threads = []
+        for graph_id in graph_ids:
+            t = threading.Thread(target=issue_writes, args=(self.env, graph_id, results))
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        for graph_id in graph_ids:
+            self.env.assertTrue(results[graph_id])
+
+    def test03_concurrent_writes_single_graph(self):
+        # independent connections writing to the same graph share a writer
+        graph_id = "writer_lane_shared"
+        threads = []
+        for i in range(GRAPH_COUNT):
+            con = self.env.getConnection()
+            graph = Graph(graph_id, con)
+            t = threading.Thread(target=lambda g=graph: [g.query("CREATE (:M)") for _ in range(QUERIES_PER_GRAPH)])
+            t.setDaemon(True)
+            threads.append(t)
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        res = Graph(graph_id, redis_con).query("MATCH (n:M) RETURN count(n)")
+        self.env.assertEquals(res.result_set[0][0], GRAPH_COUNT * QUERIES_PER_GRAPH)
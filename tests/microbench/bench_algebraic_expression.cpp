@@ -0,0 +1,106 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "../../src/util/rmalloc.h"
+#include "../../src/arithmetic/algebraic_expression.h"
+#include "../../deps/GraphBLAS/Include/GraphBLAS.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// average number of outgoing edges per node
+#define AVG_DEGREE 8
+
+// expressions over a label matrix 'L' and relation matrices 'R' and 'S'
+static const char *_expressions[] = {
+	"L*R",
+	"L*R*L",
+	"R*R",
+	"L*R*S*L",
+	"R+S",
+	"L*T(R)",
+};
+
+static void _setup() {
+	static bool initialized = false;
+	if(initialized) return;
+
+	// Use the malloc family for allocations
+	Alloc_Reset();
+	// Initialize GraphBLAS.
+	GrB_init(GrB_NONBLOCKING);
+	GxB_Global_Option_set(GxB_FORMAT, GxB_BY_COL); // all matrices in CSC format
+	GxB_Global_Option_set(GxB_HYPER_SWITCH, GxB_NEVER_HYPER); // matrices are never hypersparse
+	initialized = true;
+}
+
+// creates an n X n relation matrix with random entries
+static GrB_Matrix _relation_matrix(GrB_Index n, unsigned int seed) {
+	GrB_Matrix m;
+	GrB_Matrix_new(&m, GrB_BOOL, n, n);
+	srand(seed);
+	for(GrB_Index i = 0; i < n * AVG_DEGREE; i++) {
+		GrB_Matrix_setElement_BOOL(m, true, rand() % n, rand() % n);
+	}
+	GrB_Matrix_wait(&m);
+	return m;
+}
+
+// creates an n X n diagonal label matrix, holding every other node
+static GrB_Matrix _label_matrix(GrB_Index n) {
+	GrB_Matrix m;
+	GrB_Matrix_new(&m, GrB_BOOL, n, n);
+	for(GrB_Index i = 0; i < n; i += 2) GrB_Matrix_setElement_BOOL(m, true, i, i);
+	GrB_Matrix_wait(&m);
+	return m;
+}
+
+// evaluates an expression over a graph of range(1) nodes
+static void BM_AlgebraicExpressionEval(benchmark::State &state) {
+	_setup();
+	GrB_Index n = state.range(1);
+	state.SetLabel(_expressions[state.range(0)]);
+
+	GrB_Matrix L = _label_matrix(n);
+	GrB_Matrix R = _relation_matrix(n, 1);
+	GrB_Matrix S = _relation_matrix(n, 2);
+	rax *matrices = raxNew();
+	raxInsert(matrices, (unsigned char *)"L", 1, L, NULL);
+	raxInsert(matrices, (unsigned char *)"R", 1, R, NULL);
+	raxInsert(matrices, (unsigned char *)"S", 1, S, NULL);
+
+	AlgebraicExpression *exp = AlgebraicExpression_FromString(_expressions[state.range(0)], matrices);
+
+	GrB_Matrix res;
+	GrB_Matrix_new(&res, GrB_BOOL, n, n);
+
+	for(auto _ : state) {
+		AlgebraicExpression_Eval(exp, res);
+		GrB_Matrix_wait(&res);
+	}
+
+	GrB_Index nvals;
+	GrB_Matrix_nvals(&nvals, res);
+	state.counters["nvals"] = nvals;
+
+	AlgebraicExpression_Free(exp);
+	raxFree(matrices);
+	GrB_Matrix_free(&res);
+	GrB_Matrix_free(&L);
+	GrB_Matrix_free(&R);
+	GrB_Matrix_free(&S);
+}
+BENCHMARK(BM_AlgebraicExpressionEval)
+	->ArgsProduct({benchmark::CreateDenseRange(0, 5, 1), {1 << 10, 1 << 16}})
+	->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,100 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/value.h"
+#include "../../src/query_ctx.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/arithmetic/funcs.h"
+#include "../../src/execution_plan/record.h"
+#include "../../src/execution_plan/execution_plan.h"
+#include "../../src/arithmetic/arithmetic_expression.h"
+
+// Declaration of function in execution_plan.h
+AR_ExpNode **_BuildProjectionExpressions(const cypher_astnode_t *ret_clause, AST *ast);
+
+#ifdef __cplusplus
+}
+#endif
+
+// expressions evaluated against a record binding 'x', 'y' and 's'
+static const char *_queries[] = {
+	"WITH 1 AS x, 2 AS y, 's' AS s RETURN x * 2 + y - x / 3",
+	"WITH 1 AS x, 2 AS y, 's' AS s RETURN toUpper(s) + toString(x)",
+	"WITH 1 AS x, 2 AS y, 's' AS s RETURN CASE WHEN x > y THEN x WHEN y > 10 THEN y ELSE 0 END",
+	"WITH 1 AS x, 2 AS y, 's' AS s RETURN [i IN range(0, y) | i * x]",
+	"WITH 1 AS x, 2 AS y, 's' AS s RETURN x IN [1, 2, 3, 4, 5, 6, 7, 8] AND s STARTS WITH 'a'",
+};
+
+static const char *_labels[] = {"arithmetic", "functions", "case", "comprehension", "predicates"};
+
+static void _setup() {
+	static bool initialized = false;
+	if(initialized) return;
+
+	// Use the malloc family for allocations
+	Alloc_Reset();
+	// Prepare thread-local variables
+	QueryCtx_Init();
+	// Register functions
+	AR_RegisterFuncs();
+	initialized = true;
+}
+
+static AR_ExpNode *_exp_from_query(const char *query) {
+	cypher_parse_result_t *parse_result = cypher_parse(query, NULL, NULL, CYPHER_PARSE_ONLY_STATEMENTS);
+	AST *ast = AST_Build(parse_result);
+	ast->referenced_entities = raxNew();
+
+	const cypher_astnode_t *ret_clause = AST_GetClause(ast, CYPHER_AST_RETURN, NULL);
+	return _BuildProjectionExpressions(ret_clause, ast)[0];
+}
+
+static void BM_AR_EXP_Evaluate(benchmark::State &state) {
+	_setup();
+	AR_ExpNode *exp = _exp_from_query(_queries[state.range(0)]);
+	state.SetLabel(_labels[state.range(0)]);
+
+	rax *mapping = raxNew();
+	raxInsert(mapping, (unsigned char *)"x", 1, (void *)0, NULL);
+	raxInsert(mapping, (unsigned char *)"y", 1, (void *)1, NULL);
+	raxInsert(mapping, (unsigned char *)"s", 1, (void *)2, NULL);
+	AR_EXP_ResolveAliases(exp, mapping);
+
+	Record r = Record_New(mapping);
+	Record_AddScalar(r, 0, SI_LongVal(7));
+	Record_AddScalar(r, 1, SI_LongVal(3));
+	Record_AddScalar(r, 2, SI_ConstStringVal((char *)"abc"));
+
+	for(auto _ : state) {
+		SIValue v = AR_EXP_Evaluate(exp, r);
+		benchmark::DoNotOptimize(v);
+		SIValue_Free(v);
+	}
+
+	Record_Free(r);
+	raxFree(mapping);
+	AR_EXP_Free(exp);
+}
+BENCHMARK(BM_AR_EXP_Evaluate)->DenseRange(0, 4);
+
+// constant expressions are reduced when built, evaluation returns the constant
+static void BM_AR_EXP_EvaluateConstant(benchmark::State &state) {
+	_setup();
+	AR_ExpNode *exp = _exp_from_query("RETURN 1 + 2 * 3 - 4 / 2");
+
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(AR_EXP_Evaluate(exp, NULL));
+	}
+
+	AR_EXP_Free(exp);
+}
+BENCHMARK(BM_AR_EXP_EvaluateConstant);
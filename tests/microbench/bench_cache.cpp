@@ -0,0 +1,118 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include "../../src/util/rmalloc.h"
+#include "../../src/util/cache/cache.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#define KEY_COUNT 1024
+#define KEY_LEN 64
+
+static char _keys[KEY_COUNT][KEY_LEN];
+
+// cached values are plain integers
+static void *_value_copy(void *value) {
+	int64_t *copy = (int64_t *)rm_malloc(sizeof(int64_t));
+	*copy = *(int64_t *)value;
+	return copy;
+}
+
+static int64_t *_value_new(int64_t v) {
+	int64_t *value = (int64_t *)rm_malloc(sizeof(int64_t));
+	*value = v;
+	return value;
+}
+
+// keys resemble the queries they are cached under
+static void _setup() {
+	Alloc_Reset();
+	for(int i = 0; i < KEY_COUNT; i++) {
+		snprintf(_keys[i], KEY_LEN, "MATCH (n:L) WHERE n.v = $p RETURN n.v%d", i);
+	}
+}
+
+// repeated lookups of cached keys, by a single thread
+static void BM_CacheGetHit(benchmark::State &state) {
+	_setup();
+	uint cap = state.range(0);
+	Cache *cache = Cache_New(cap, rm_free, _value_copy);
+	for(uint i = 0; i < cap; i++) Cache_SetValue(cache, _keys[i], _value_new(i));
+
+	uint i = 0;
+	for(auto _ : state) {
+		void *value = Cache_GetValue(cache, _keys[i++ % cap]);
+		benchmark::DoNotOptimize(value);
+		rm_free(value);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	Cache_Free(cache);
+}
+BENCHMARK(BM_CacheGetHit)->Arg(25)->Arg(KEY_COUNT / 2);
+
+static void BM_CacheGetMiss(benchmark::State &state) {
+	_setup();
+	Cache *cache = Cache_New(25, rm_free, _value_copy);
+	for(uint i = 0; i < 25; i++) Cache_SetValue(cache, _keys[i], _value_new(i));
+
+	uint i = 0;
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(Cache_GetValue(cache, _keys[25 + (i++ % (KEY_COUNT - 25))]));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	Cache_Free(cache);
+}
+BENCHMARK(BM_CacheGetMiss);
+
+// inserts keys into a full cache, each insertion evicts an entry
+static void BM_CacheSetEvict(benchmark::State &state) {
+	_setup();
+	Cache *cache = Cache_New(25, rm_free, _value_copy);
+	for(uint i = 0; i < 25; i++) Cache_SetValue(cache, _keys[i], _value_new(i));
+
+	// cycling through more keys than the cache holds never hits a cached key
+	uint i = 25;
+	for(auto _ : state) {
+		Cache_SetValue(cache, _keys[i % KEY_COUNT], _value_new(i));
+		i++;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	Cache_Free(cache);
+}
+BENCHMARK(BM_CacheSetEvict);
+
+// concurrent lookups of a shared set of keys
+static void BM_CacheGetHitThreaded(benchmark::State &state) {
+	static Cache *cache;
+	if(state.thread_index() == 0) {
+		_setup();
+		cache = Cache_New(25, rm_free, _value_copy);
+		for(uint i = 0; i < 25; i++) Cache_SetValue(cache, _keys[i], _value_new(i));
+	}
+
+	uint i = state.thread_index();
+	for(auto _ : state) {
+		void *value = Cache_GetValue(cache, _keys[i++ % 25]);
+		benchmark::DoNotOptimize(value);
+		rm_free(value);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	if(state.thread_index() == 0) Cache_Free(cache);
+}
+BENCHMARK(BM_CacheGetHitThreaded)->ThreadRange(1, 8)->UseRealTime();
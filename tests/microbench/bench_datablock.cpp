@@ -0,0 +1,104 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/util/datablock/datablock.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// allocates 'n' items into an empty datablock
+static void BM_DataBlockAllocate(benchmark::State &state) {
+	Alloc_Reset();
+	uint64_t n = state.range(0);
+
+	for(auto _ : state) {
+		DataBlock *dataBlock = DataBlock_New(16384, sizeof(int64_t), NULL);
+		for(uint64_t i = 0; i < n; i++) {
+			int64_t *item = (int64_t *)DataBlock_AllocateItem(dataBlock, NULL);
+			*item = i;
+		}
+		DataBlock_Free(dataBlock);
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_DataBlockAllocate)->Range(1 << 10, 1 << 20);
+
+// reuses deleted slots, every other item is deleted prior to allocation
+static void BM_DataBlockReuseDeleted(benchmark::State &state) {
+	Alloc_Reset();
+	uint64_t n = state.range(0);
+	DataBlock *dataBlock = DataBlock_New(16384, sizeof(int64_t), NULL);
+	for(uint64_t i = 0; i < n; i++) DataBlock_AllocateItem(dataBlock, NULL);
+
+	for(auto _ : state) {
+		state.PauseTiming();
+		for(uint64_t i = 0; i < n; i += 2) DataBlock_DeleteItem(dataBlock, i);
+		state.ResumeTiming();
+		for(uint64_t i = 0; i < n; i += 2) DataBlock_AllocateItem(dataBlock, NULL);
+	}
+
+	state.SetItemsProcessed(state.iterations() * (n / 2));
+	DataBlock_Free(dataBlock);
+}
+BENCHMARK(BM_DataBlockReuseDeleted)->Range(1 << 10, 1 << 18);
+
+// scans a datablock, the fraction of deleted items is range(1) percent
+static void BM_DataBlockScan(benchmark::State &state) {
+	Alloc_Reset();
+	uint64_t n = state.range(0);
+	uint64_t deleted = state.range(1);
+	DataBlock *dataBlock = DataBlock_New(16384, sizeof(int64_t), NULL);
+	for(uint64_t i = 0; i < n; i++) {
+		int64_t *item = (int64_t *)DataBlock_AllocateItem(dataBlock, NULL);
+		*item = i;
+	}
+	for(uint64_t i = 0; i < n; i++) {
+		if(i % 100 < deleted) DataBlock_DeleteItem(dataBlock, i);
+	}
+
+	for(auto _ : state) {
+		int64_t sum = 0;
+		int64_t *item;
+		DataBlockIterator *it = DataBlock_Scan(dataBlock);
+		while((item = (int64_t *)DataBlockIterator_Next(it, NULL)) != NULL) {
+			sum += *item;
+		}
+		DataBlockIterator_Free(it);
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+	DataBlock_Free(dataBlock);
+}
+BENCHMARK(BM_DataBlockScan)->ArgsProduct({{1 << 12, 1 << 20}, {0, 50}});
+
+// random access by item id
+static void BM_DataBlockGetItem(benchmark::State &state) {
+	Alloc_Reset();
+	uint64_t n = state.range(0);
+	DataBlock *dataBlock = DataBlock_New(16384, sizeof(int64_t), NULL);
+	for(uint64_t i = 0; i < n; i++) DataBlock_AllocateItem(dataBlock, NULL);
+
+	uint64_t idx = 0;
+	for(auto _ : state) {
+		// stride by a large prime to defeat sequential prefetching
+		idx = (idx + 7919) % n;
+		benchmark::DoNotOptimize(DataBlock_GetItem(dataBlock, idx));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	DataBlock_Free(dataBlock);
+}
+BENCHMARK(BM_DataBlockGetItem)->Arg(1 << 20);
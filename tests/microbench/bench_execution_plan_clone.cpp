@@ -0,0 +1,86 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include "../../src/util/arr.h"
+#include "../../src/query_ctx.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/arithmetic/funcs.h"
+#include "../../src/procedures/procedure.h"
+#include "../../src/execution_plan/execution_plan_clone.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// plans of increasing size, cloned for every execution of a cached query
+static const char *_queries[] = {
+	"MATCH (n) RETURN n",
+	"MATCH (a:N)-[:E]->(b:N) WHERE a.val > 1 RETURN a, b ORDER BY a.val LIMIT 10",
+	"MATCH (a)-[:E*1..3]->(b) WITH a, count(b) AS c WHERE c > 1 RETURN a, c",
+	"UNWIND range(0, 10) AS x MERGE (a:N {val: x}) ON CREATE SET a.created = true RETURN a",
+	"MATCH (a:N) OPTIONAL MATCH (a)-[:E]->(b:N) WITH a, collect(b) AS bs UNWIND bs AS b MATCH (b)-[:E]->(c) RETURN a, b, c UNION MATCH (n) RETURN n AS a, n AS b, n AS c",
+};
+
+static const char *_labels[] = {"scan", "traverse", "aggregate", "merge", "union"};
+
+static void _fake_graph_context() {
+	GraphContext *gc = (GraphContext *)malloc(sizeof(GraphContext));
+
+	gc->g = Graph_New(16, 16);
+	gc->index_count = 0;
+	gc->graph_name = strdup("G");
+	gc->attributes = AttributeTable_New();
+	gc->node_schemas = (Schema **)array_new(Schema *, GRAPH_DEFAULT_LABEL_CAP);
+	gc->relation_schemas = (Schema **)array_new(Schema *, GRAPH_DEFAULT_RELATION_TYPE_CAP);
+	QueryCtx_SetGraphCtx(gc);
+}
+
+static void _setup() {
+	static bool initialized = false;
+	if(initialized) return;
+
+	// Use the malloc family for allocations
+	Alloc_Reset();
+	// Init query context.
+	QueryCtx_Init();
+	// Initialize GraphBLAS.
+	GrB_init(GrB_NONBLOCKING);
+	GxB_Global_Option_set(GxB_FORMAT, GxB_BY_COL); // all matrices in CSC format
+	GxB_Global_Option_set(GxB_HYPER_SWITCH, GxB_NEVER_HYPER); // matrices are never hypersparse
+	Proc_Register();         // Register procedures.
+	AR_RegisterFuncs();      // Register arithmetic functions.
+
+	// Create a graphcontext
+	_fake_graph_context();
+	initialized = true;
+}
+
+static void BM_ExecutionPlanClone(benchmark::State &state) {
+	_setup();
+	state.SetLabel(_labels[state.range(0)]);
+
+	cypher_parse_result_t *parse_result = cypher_parse(_queries[state.range(0)], NULL, NULL,
+			CYPHER_PARSE_ONLY_STATEMENTS);
+	AST *ast = AST_Build(parse_result);
+	ExecutionPlan *plan = NewExecutionPlan();
+
+	for(auto _ : state) {
+		ExecutionPlan *clone = ExecutionPlan_Clone(plan);
+		benchmark::DoNotOptimize(clone);
+		ExecutionPlan_Free(clone);
+	}
+
+	ExecutionPlan_Free(plan);
+	AST_Free(ast);
+}
+BENCHMARK(BM_ExecutionPlanClone)->DenseRange(0, 4)->Unit(benchmark::kMicrosecond);
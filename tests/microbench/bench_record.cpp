@@ -0,0 +1,76 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include "../../src/value.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/execution_plan/record.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// creates a mapping of 'n' aliases
+static rax *_build_mapping(uint n) {
+	char alias[16];
+	rax *mapping = raxNew();
+	for(uint i = 0; i < n; i++) {
+		int len = snprintf(alias, sizeof(alias), "a%u", i);
+		raxInsert(mapping, (unsigned char *)alias, len, (void *)(uintptr_t)i, NULL);
+	}
+	return mapping;
+}
+
+// clones a record of range(0) scalar entries
+static void BM_RecordClone(benchmark::State &state) {
+	Alloc_Reset();
+	uint n = state.range(0);
+	rax *mapping = _build_mapping(n);
+
+	Record r = Record_New(mapping);
+	for(uint i = 0; i < n; i++) {
+		// alternate between inlined and heap allocated values
+		SIValue v = (i % 2) ? SI_LongVal(i) : SI_DuplicateStringVal("value");
+		Record_AddScalar(r, i, v);
+	}
+	Record clone = Record_New(mapping);
+
+	for(auto _ : state) {
+		Record_Clone(r, clone);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+	Record_Free(clone);
+	Record_Free(r);
+	raxFree(mapping);
+}
+BENCHMARK(BM_RecordClone)->RangeMultiplier(4)->Range(4, 256);
+
+// hashes a record of range(0) scalar entries, as performed by DISTINCT
+static void BM_RecordHash64(benchmark::State &state) {
+	Alloc_Reset();
+	uint n = state.range(0);
+	rax *mapping = _build_mapping(n);
+
+	Record r = Record_New(mapping);
+	for(uint i = 0; i < n; i++) Record_AddScalar(r, i, SI_LongVal(i));
+
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(Record_Hash64(r));
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+	Record_Free(r);
+	raxFree(mapping);
+}
+BENCHMARK(BM_RecordHash64)->RangeMultiplier(4)->Range(4, 256);
@@ -0,0 +1,93 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include <benchmark/benchmark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/value.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/datatypes/array.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// value kinds exercised by the compare and hash benchmarks
+enum {
+	VALUE_LONG,
+	VALUE_DOUBLE,
+	VALUE_MIXED,   // integer against double
+	VALUE_STRING,
+	VALUE_ARRAY,
+};
+
+static const char *_value_names[] = {"long", "double", "mixed", "string", "array"};
+
+// builds a pair of distinct values of the requested kind
+static void _build_values(int kind, SIValue *a, SIValue *b) {
+	switch(kind) {
+	case VALUE_LONG:
+		*a = SI_LongVal(12345);
+		*b = SI_LongVal(12346);
+		break;
+	case VALUE_DOUBLE:
+		*a = SI_DoubleVal(12345.5);
+		*b = SI_DoubleVal(12346.5);
+		break;
+	case VALUE_MIXED:
+		*a = SI_LongVal(12345);
+		*b = SI_DoubleVal(12345.5);
+		break;
+	case VALUE_STRING:
+		*a = SI_DuplicateStringVal("the quick brown fox jumps over the lazy dog");
+		*b = SI_DuplicateStringVal("the quick brown fox jumps over the lazy cat");
+		break;
+	case VALUE_ARRAY:
+		*a = SI_Array(16);
+		*b = SI_Array(16);
+		for(int i = 0; i < 16; i++) {
+			SIArray_Append(a, SI_LongVal(i));
+			SIArray_Append(b, SI_LongVal((i == 15) ? 0 : i));
+		}
+		break;
+	}
+}
+
+static void BM_SIValueCompare(benchmark::State &state) {
+	Alloc_Reset();
+	SIValue a;
+	SIValue b;
+	_build_values(state.range(0), &a, &b);
+	state.SetLabel(_value_names[state.range(0)]);
+
+	int disjoint;
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(SIValue_Compare(a, b, &disjoint));
+	}
+
+	SIValue_Free(a);
+	SIValue_Free(b);
+}
+BENCHMARK(BM_SIValueCompare)->DenseRange(VALUE_LONG, VALUE_ARRAY);
+
+static void BM_SIValueHashCode(benchmark::State &state) {
+	Alloc_Reset();
+	SIValue a;
+	SIValue b;
+	_build_values(state.range(0), &a, &b);
+	state.SetLabel(_value_names[state.range(0)]);
+
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(SIValue_HashCode(a));
+	}
+
+	SIValue_Free(a);
+	SIValue_Free(b);
+}
+BENCHMARK(BM_SIValueHashCode)->DenseRange(VALUE_LONG, VALUE_ARRAY);
@@ -243,3 +243,61 @@ TEST_F(AggregateTest, StDevTest) {
 	AR_EXP_Free(stdevp);
 }
 
+
+// aggregate the integers [from, to] into exp
+static void _aggregate_range(AR_ExpNode *exp, int from, int to) {
+	for(int i = from; i <= to; i++) {
+		AR_EXP_Free(exp->op.children[0]);
+		exp->op.children[0] = AR_EXP_NewConstOperandNode(SI_LongVal(i));
+		AR_EXP_Aggregate(exp, NULL);
+	}
+}
+
+TEST_F(AggregateTest, MergeTest) {
+	const char *queries[] = {
+		"RETURN sum(1)", "RETURN avg(1)", "RETURN min(1)", "RETURN max(1)",
+		"RETURN count(1)", "RETURN collect(1)", "RETURN stDev(1)",
+		"RETURN stDevP(1)", "RETURN percentileDisc(1, 0.5)",
+		"RETURN percentileCont(1, 0.3)"
+	};
+
+	for(uint i = 0; i < sizeof(queries) / sizeof(queries[0]); i++) {
+		AR_ExpNode *whole = _exp_from_query(queries[i]);
+		AR_ExpNode *left = _exp_from_query(queries[i]);
+		AR_ExpNode *right = _exp_from_query(queries[i]);
+		AR_ExpNode *empty = _exp_from_query(queries[i]);
+		ASSERT_TRUE(AR_EXP_Mergeable(whole));
+
+		_aggregate_range(whole, 1, 10);
+		_aggregate_range(left, 1, 4);
+		_aggregate_range(right, 5, 10);
+
+		// merging an empty partial state is a NOP
+		AR_EXP_Merge(left, empty);
+		AR_EXP_Merge(left, right);
+
+		SIValue expected = AR_EXP_Finalize(whole, NULL);
+		SIValue actual = AR_EXP_Finalize(left, NULL);
+		ASSERT_EQ(SIValue_Compare(expected, actual, NULL), 0) << queries[i];
+
+		AR_EXP_Free(whole);
+		AR_EXP_Free(left);
+		AR_EXP_Free(right);
+		AR_EXP_Free(empty);
+	}
+
+	// merge into an empty partial state
+	AR_ExpNode *sum = _exp_from_query("RETURN sum(1)");
+	AR_ExpNode *partial = _exp_from_query("RETURN sum(1)");
+	_aggregate_range(partial, 1, 3);
+	AR_EXP_Merge(sum, partial);
+	SIValue result = AR_EXP_Finalize(sum, NULL);
+	ASSERT_EQ(result.doubleval, 6);
+	AR_EXP_Free(sum);
+	AR_EXP_Free(partial);
+
+	// distinct aggregations can't be merged
+	AR_ExpNode *distinct = _exp_from_query("RETURN count(DISTINCT 1)");
+	ASSERT_FALSE(AR_EXP_Mergeable(distinct));
+	AR_EXP_Free(distinct);
+}
@@ -99,9 +99,7 @@ class AlgebraicExpressionTest: public ::testing::Test {
 		gc->g = Graph_New(16, 16);
 		gc->index_count = 0;
 		gc->graph_name = strdup("G");
-		gc->attributes = raxNew();
-		pthread_rwlock_init(&gc->_attribute_rwlock, NULL);
-		gc->string_mapping = (char **)array_new(char *, 64);
+		gc->attributes = AttributeTable_New();
 		gc->node_schemas = (Schema **)array_new(Schema *, GRAPH_DEFAULT_LABEL_CAP);
 		gc->relation_schemas = (Schema **)array_new(Schema *, GRAPH_DEFAULT_RELATION_TYPE_CAP);
 
@@ -1705,3 +1703,135 @@ TEST_F(AlgebraicExpressionTest, LocateOperand) {
 	AlgebraicExpression_Free(r);
 }
 
+
+TEST_F(AlgebraicExpressionTest, MulChainOrder) {
+	// A * B * C, where C is a diagonal holding a single entry
+	// multiplying B * C first is cheapest
+	double rows[4]  = {100, 100, 100, 100};
+	double cols[4]  = {100, 100, 100, 100};
+	double nvals[4] = {1000, 1000, 1, 1000};
+	uint split[16];
+
+	_AlgebraicExpression_MulChainOrder(3, rows, cols, nvals, split);
+	ASSERT_EQ(split[0 * 3 + 2], 0);  // A * (B * C)
+	ASSERT_EQ(split[1 * 3 + 2], 1);  // B * C
+
+	// F * A * B * C, where F is a frontier of a single row
+	// multiplying left to right is cheapest
+	double frontier_rows[4]  = {1, 100, 100, 100};
+	double frontier_nvals[4] = {1, 1000, 1000, 1000};
+
+	_AlgebraicExpression_MulChainOrder(4, frontier_rows, cols, frontier_nvals, split);
+	ASSERT_EQ(split[0 * 4 + 3], 2);  // (F * A * B) * C
+	ASSERT_EQ(split[0 * 4 + 2], 1);  // (F * A) * B
+	ASSERT_EQ(split[0 * 4 + 1], 0);  // F * A
+
+	// equal costs are multiplied left to right
+	double uniform_nvals[4] = {1000, 1000, 1000, 1000};
+	_AlgebraicExpression_MulChainOrder(4, rows, cols, uniform_nvals, split);
+	ASSERT_EQ(split[0 * 4 + 3], 2);
+	ASSERT_EQ(split[0 * 4 + 2], 1);
+}
+
+TEST_F(AlgebraicExpressionTest, Exp_OP_MUL_Reordered) {
+	// Exp = A * B * C, where C is selective, evaluated as A * (B * C)
+	GrB_Index n = 8;
+	GrB_Matrix A;
+	GrB_Matrix B;
+	GrB_Matrix C;
+	GrB_Matrix res;
+	GrB_Matrix expected;
+
+	GrB_Matrix_new(&A, GrB_BOOL, n, n);
+	GrB_Matrix_new(&B, GrB_BOOL, n, n);
+	GrB_Matrix_new(&C, GrB_BOOL, n, n);
+	for(GrB_Index i = 0; i < n; i++) {
+		GrB_Matrix_setElement_BOOL(A, true, i, (i + 1) % n);
+		GrB_Matrix_setElement_BOOL(A, true, i, (i + 2) % n);
+		GrB_Matrix_setElement_BOOL(B, true, i, (i + 3) % n);
+		GrB_Matrix_setElement_BOOL(B, true, i, i);
+	}
+	GrB_Matrix_setElement_BOOL(C, true, 5, 5);
+
+	// expected = (A * B) * C
+	GrB_Matrix_new(&expected, GrB_BOOL, n, n);
+	GrB_mxm(expected, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, A, B, GrB_NULL);
+	GrB_mxm(expected, GrB_NULL, GrB_NULL, GxB_ANY_PAIR_BOOL, expected, C, GrB_NULL);
+
+	rax *matrices = raxNew();
+	raxInsert(matrices, (unsigned char *)"A", strlen("A"), A, NULL);
+	raxInsert(matrices, (unsigned char *)"B", strlen("B"), B, NULL);
+	raxInsert(matrices, (unsigned char *)"C", strlen("C"), C, NULL);
+	AlgebraicExpression *exp = AlgebraicExpression_FromString("A*B*C", matrices);
+
+	GrB_Matrix_new(&res, GrB_BOOL, n, n);
+	AlgebraicExpression_Eval(exp, res);
+	ASSERT_TRUE(_compare_matrices(res, expected));
+
+	// a chain whose product is empty
+	GrB_Matrix_clear(C);
+	GrB_Matrix_clear(expected);
+	AlgebraicExpression_Eval(exp, res);
+	ASSERT_TRUE(_compare_matrices(res, expected));
+
+	raxFree(matrices);
+	GrB_Matrix_free(&A);
+	GrB_Matrix_free(&B);
+	GrB_Matrix_free(&C);
+	GrB_Matrix_free(&res);
+	GrB_Matrix_free(&expected);
+	AlgebraicExpression_Free(exp);
+}
+
+TEST_F(AlgebraicExpressionTest, Exp_OP_MUL_Masked) {
+	// Exp = A * B, computing only the entries present in mask
+	GrB_Index n = 8;
+	GrB_Matrix A;
+	GrB_Matrix B;
+	GrB_Matrix mask;
+	GrB_Matrix res;
+	GrB_Matrix expected;
+
+	GrB_Matrix_new(&A, GrB_BOOL, n, n);
+	GrB_Matrix_new(&B, GrB_BOOL, n, n);
+	GrB_Matrix_new(&mask, GrB_BOOL, n, n);
+	for(GrB_Index i = 0; i < n; i++) {
+		GrB_Matrix_setElement_BOOL(A, true, i, (i + 1) % n);
+		GrB_Matrix_setElement_BOOL(B, true, i, (i + 1) % n);
+		GrB_Matrix_setElement_BOOL(B, true, i, i);
+	}
+	// A * B[0, 2] = A * B[3, 4] = true, A * B[5, 0] = false
+	GrB_Matrix_setElement_BOOL(mask, true, 0, 2);
+	GrB_Matrix_setElement_BOOL(mask, true, 3, 4);
+	GrB_Matrix_setElement_BOOL(mask, true, 5, 0);
+
+	GrB_Matrix_new(&expected, GrB_BOOL, n, n);
+	GrB_Matrix_setElement_BOOL(expected, true, 0, 2);
+	GrB_Matrix_setElement_BOOL(expected, true, 3, 4);
+
+	rax *matrices = raxNew();
+	raxInsert(matrices, (unsigned char *)"A", strlen("A"), A, NULL);
+	raxInsert(matrices, (unsigned char *)"B", strlen("B"), B, NULL);
+	AlgebraicExpression *exp = AlgebraicExpression_FromString("A*B", matrices);
+
+	// entries outside of the mask are discarded from res
+	GrB_Matrix_new(&res, GrB_BOOL, n, n);
+	GrB_Matrix_setElement_BOOL(res, true, 7, 7);
+	AlgebraicExpression_EvalMasked(exp, mask, res);
+	ASSERT_TRUE(_compare_matrices(res, expected));
+	AlgebraicExpression_Free(exp);
+
+	// a reordered chain, A * B * B[5, 0] = true
+	GrB_Matrix_setElement_BOOL(expected, true, 5, 0);
+	exp = AlgebraicExpression_FromString("A*B*B", matrices);
+	AlgebraicExpression_EvalMasked(exp, mask, res);
+	ASSERT_TRUE(_compare_matrices(res, expected));
+
+	raxFree(matrices);
+	GrB_Matrix_free(&A);
+	GrB_Matrix_free(&B);
+	GrB_Matrix_free(&mask);
+	GrB_Matrix_free(&res);
+	GrB_Matrix_free(&expected);
+	AlgebraicExpression_Free(exp);
+}
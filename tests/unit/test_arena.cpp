@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include "../../src/util/rmalloc.h"
+#include "../../src/util/arena/arena.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class ArenaTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+TEST_F(ArenaTest, Alloc) {
+	Arena *arena = Arena_New(256);
+
+	// Allocations are aligned and do not overlap.
+	uint64_t *items[100];
+	for(uint i = 0; i < 100; i++) {
+		items[i] = (uint64_t *)Arena_Alloc(arena, sizeof(uint64_t) + (i % 3));
+		ASSERT_EQ((uintptr_t)items[i] % 8, 0);
+		*items[i] = i;
+	}
+	for(uint i = 0; i < 100; i++) ASSERT_EQ(*items[i], i);
+
+	// Large allocations are served from a dedicated block.
+	char *large = (char *)Arena_Alloc(arena, 4096);
+	memset(large, 'x', 4096);
+	uint64_t *small = (uint64_t *)Arena_Alloc(arena, sizeof(uint64_t));
+	*small = 100;
+	ASSERT_EQ(arena->head->cap, 256);
+	for(uint i = 0; i < 100; i++) ASSERT_EQ(*items[i], i);
+
+	Arena_Free(arena);
+}
+
+TEST_F(ArenaTest, Strdup) {
+	Arena *arena = Arena_New(64);
+	const char *strings[3] = {"a", "arena allocated string", ""};
+	char *dups[3];
+	for(uint i = 0; i < 3; i++) dups[i] = Arena_Strdup(arena, strings[i]);
+	for(uint i = 0; i < 3; i++) {
+		ASSERT_STREQ(dups[i], strings[i]);
+		ASSERT_NE(dups[i], strings[i]);
+	}
+	Arena_Free(arena);
+}
+
+TEST_F(ArenaTest, Reset) {
+	Arena *arena = Arena_New(128);
+	for(uint i = 0; i < 64; i++) Arena_Alloc(arena, 16);
+	Arena_Alloc(arena, 1024);
+	ASSERT_TRUE(arena->head->next != NULL);
+
+	// Reset keeps a single empty block.
+	Arena_Reset(arena);
+	ASSERT_TRUE(arena->head->next == NULL);
+	ASSERT_EQ(arena->head->used, 0);
+
+	void *p = Arena_Alloc(arena, 16);
+	ASSERT_EQ(p, (void *)arena->head->data);
+
+	Arena_Free(arena);
+}
@@ -1519,3 +1519,120 @@ TEST_F(ArithmeticTest, CoalesceTest) {
 	ASSERT_EQ(0, SIValue_Compare(SI_LongVal(1), arExp->operand.constant, NULL));
 }
 
+
+TEST_F(ArithmeticTest, ResolveAliasesTest) {
+	rax *mapping = raxNew();
+	raxInsert(mapping, (unsigned char *)"x", 1, (void *)0, NULL);
+	raxInsert(mapping, (unsigned char *)"y", 1, (void *)1, NULL);
+
+	// x - y
+	AR_ExpNode *x = AR_EXP_NewVariableOperandNode("x");
+	AR_ExpNode *y = AR_EXP_NewVariableOperandNode("y");
+	AR_ExpNode *exp = AR_EXP_NewOpNode("sub", 2);
+	exp->op.children[0] = x;
+	exp->op.children[1] = y;
+
+	// aliases are resolved into their slots within the mapping
+	AR_EXP_ResolveAliases(exp, mapping);
+	ASSERT_EQ(0, x->operand.variadic.entity_alias_idx);
+	ASSERT_EQ(1, y->operand.variadic.entity_alias_idx);
+
+	Record r = Record_New(mapping);
+	Record_AddScalar(r, 0, SI_LongVal(5));
+	Record_AddScalar(r, 1, SI_LongVal(2));
+	SIValue res = AR_EXP_Evaluate(exp, r);
+	ASSERT_EQ(3, res.longval);
+
+	// records of a different mapping are resolved on evaluation
+	rax *swapped = raxNew();
+	raxInsert(swapped, (unsigned char *)"y", 1, (void *)0, NULL);
+	raxInsert(swapped, (unsigned char *)"x", 1, (void *)1, NULL);
+	Record s = Record_New(swapped);
+	Record_AddScalar(s, 0, SI_LongVal(2));
+	Record_AddScalar(s, 1, SI_LongVal(5));
+	res = AR_EXP_Evaluate(exp, s);
+	ASSERT_EQ(3, res.longval);
+	ASSERT_EQ(1, x->operand.variadic.entity_alias_idx);
+
+	AR_EXP_Free(exp);
+	Record_Free(r);
+	Record_Free(s);
+	raxFree(mapping);
+	raxFree(swapped);
+}
+
+TEST_F(ArithmeticTest, CompileTest) {
+	rax *mapping = raxNew();
+	raxInsert(mapping, (unsigned char *)"x", 1, (void *)0, NULL);
+
+	// x - 2
+	AR_ExpNode *exp = AR_EXP_NewOpNode("sub", 2);
+	exp->op.children[0] = AR_EXP_NewVariableOperandNode("x");
+	exp->op.children[1] = AR_EXP_NewConstOperandNode(SI_LongVal(2));
+
+	// the constant argument is validated once
+	AR_EXP_Compile(exp);
+	ASSERT_TRUE(exp->op.eval != NULL);
+	ASSERT_EQ(0x2, exp->op.static_args);
+
+	Record r = Record_New(mapping);
+	Record_AddScalar(r, 0, SI_LongVal(5));
+	SIValue res = AR_EXP_Evaluate(exp, r);
+	ASSERT_EQ(3, res.longval);
+
+	Record_AddScalar(r, 0, SI_DoubleVal(2.5));
+	res = AR_EXP_Evaluate(exp, r);
+	ASSERT_EQ(0.5, res.doubleval);
+
+	// clones share the compiled evaluation
+	AR_ExpNode *clone = AR_EXP_Clone(exp);
+	ASSERT_TRUE(clone->op.eval == exp->op.eval);
+	res = AR_EXP_Evaluate(clone, r);
+	ASSERT_EQ(0.5, res.doubleval);
+
+	AR_EXP_Free(exp);
+	AR_EXP_Free(clone);
+	Record_Free(r);
+	raxFree(mapping);
+}
+
+TEST_F(ArithmeticTest, EqualTest) {
+	// x + 1
+	AR_ExpNode *a = AR_EXP_NewOpNode("add", 2);
+	a->op.children[0] = AR_EXP_NewVariableOperandNode("x");
+	a->op.children[1] = AR_EXP_NewConstOperandNode(SI_LongVal(1));
+
+	// clones are identical to the original
+	AR_ExpNode *b = AR_EXP_Clone(a);
+	ASSERT_TRUE(AR_EXP_Equal(a, b));
+	ASSERT_TRUE(AR_EXP_Deterministic(a));
+
+	// x + 1.0 evaluates to a different type
+	AR_ExpNode *c = AR_EXP_NewOpNode("add", 2);
+	c->op.children[0] = AR_EXP_NewVariableOperandNode("x");
+	c->op.children[1] = AR_EXP_NewConstOperandNode(SI_DoubleVal(1));
+	ASSERT_FALSE(AR_EXP_Equal(a, c));
+
+	// y + 1
+	AR_ExpNode *d = AR_EXP_NewOpNode("add", 2);
+	d->op.children[0] = AR_EXP_NewVariableOperandNode("y");
+	d->op.children[1] = AR_EXP_NewConstOperandNode(SI_LongVal(1));
+	ASSERT_FALSE(AR_EXP_Equal(a, d));
+
+	// x - 1
+	AR_ExpNode *e = AR_EXP_NewOpNode("sub", 2);
+	e->op.children[0] = AR_EXP_NewVariableOperandNode("x");
+	e->op.children[1] = AR_EXP_NewConstOperandNode(SI_LongVal(1));
+	ASSERT_FALSE(AR_EXP_Equal(a, e));
+
+	// rand() differs from one call to another
+	AR_ExpNode *f = AR_EXP_NewOpNode("rand", 0);
+	ASSERT_FALSE(AR_EXP_Deterministic(f));
+
+	AR_EXP_Free(a);
+	AR_EXP_Free(b);
+	AR_EXP_Free(c);
+	AR_EXP_Free(d);
+	AR_EXP_Free(e);
+	AR_EXP_Free(f);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "../../src/util/rmalloc.h"
+#include "../../src/graph/attribute_table.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class AttributeTableTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+static int added_count = 0;
+
+static void _count_addition(void *ctx, const char *name) {
+	added_count++;
+}
+
+TEST_F(AttributeTableTest, FindOrAdd) {
+	AttributeTable *t = AttributeTable_New();
+	ASSERT_EQ(AttributeTable_Count(t), 0);
+	ASSERT_EQ(AttributeTable_Find(t, "name"), ATTRIBUTE_NOTFOUND);
+
+	// IDs are dense, assigned in order of addition
+	added_count = 0;
+	ASSERT_EQ(AttributeTable_FindOrAdd(t, "name", _count_addition, NULL), 0);
+	ASSERT_EQ(AttributeTable_FindOrAdd(t, "age", _count_addition, NULL), 1);
+	ASSERT_EQ(AttributeTable_FindOrAdd(t, "name", _count_addition, NULL), 0);
+	ASSERT_EQ(added_count, 2);
+	ASSERT_EQ(AttributeTable_Count(t), 2);
+
+	ASSERT_EQ(AttributeTable_Find(t, "age"), 1);
+	ASSERT_STREQ(AttributeTable_Name(t, 0), "name");
+	ASSERT_STREQ(AttributeTable_Name(t, 1), "age");
+
+	AttributeTable_Free(t);
+}
+
+TEST_F(AttributeTableTest, Growth) {
+	AttributeTable *t = AttributeTable_New();
+	char name[32];
+
+	// grow past several hash tables and ID chunks
+	for(int i = 0; i < 5000; i++) {
+		sprintf(name, "attr_%d", i);
+		ASSERT_EQ(AttributeTable_FindOrAdd(t, name, NULL, NULL), i);
+	}
+
+	for(int i = 0; i < 5000; i++) {
+		sprintf(name, "attr_%d", i);
+		ASSERT_EQ(AttributeTable_Find(t, name), i);
+		ASSERT_STREQ(AttributeTable_Name(t, i), name);
+	}
+	ASSERT_EQ(AttributeTable_Find(t, "attr_5000"), ATTRIBUTE_NOTFOUND);
+
+	AttributeTable_Free(t);
+}
+
+static void *_lookup(void *arg) {
+	AttributeTable *t = (AttributeTable *)arg;
+	char name[32];
+
+	// every attribute observed through the count is in place
+	for(int round = 0; round < 100; round++) {
+		uint count = AttributeTable_Count(t);
+		for(uint i = 0; i < count; i++) {
+			sprintf(name, "attr_%u", i);
+			if(AttributeTable_Find(t, name) != i) return (void *)1;
+			if(strcmp(AttributeTable_Name(t, i), name) != 0) return (void *)1;
+		}
+	}
+	return NULL;
+}
+
+TEST_F(AttributeTableTest, ConcurrentLookups) {
+	AttributeTable *t = AttributeTable_New();
+	char name[32];
+
+	pthread_t readers[4];
+	for(int i = 0; i < 4; i++) pthread_create(readers + i, NULL, _lookup, t);
+
+	for(int i = 0; i < 2000; i++) {
+		sprintf(name, "attr_%d", i);
+		AttributeTable_FindOrAdd(t, name, NULL, NULL);
+	}
+
+	for(int i = 0; i < 4; i++) {
+		void *res;
+		pthread_join(readers[i], &res);
+		ASSERT_EQ(res, (void *)NULL);
+	}
+
+	AttributeTable_Free(t);
+}
@@ -0,0 +1,95 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/util/arr.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/bidirectional_bfs.h"
+#ifdef __cplusplus
+}
+#endif
+
+class BidirectionalBFSTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+		ASSERT_EQ(GrB_init(GrB_NONBLOCKING), GrB_SUCCESS);
+		GxB_Global_Option_set(GxB_FORMAT, GxB_BY_ROW); // all matrices in CSR format
+	}
+
+	static void TearDownTestCase() {
+		GrB_finalize();
+	}
+
+	// 0 -> 1 -> 2 -> 3 -> 4
+	// 0 -> 5 -> 4
+	// 6 -> 0, 7 is isolated
+	static void BuildGraph(GrB_Matrix *R, GrB_Matrix *TR) {
+		GrB_Index edges[][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {0, 5}, {5, 4},
+			{6, 0}};
+		GrB_Matrix_new(R, GrB_BOOL, 8, 8);
+		for(uint i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+			GrB_Matrix_setElement_BOOL(*R, true, edges[i][0], edges[i][1]);
+		}
+		GrB_Matrix_new(TR, GrB_BOOL, 8, 8);
+		GrB_transpose(*TR, GrB_NULL, GrB_NULL, *R, GrB_NULL);
+	}
+
+	static void AssertPath(NodeID *path, const NodeID *expected, uint len) {
+		ASSERT_TRUE(path != NULL);
+		ASSERT_EQ(array_len(path), len);
+		for(uint i = 0; i < len; i++) ASSERT_EQ(path[i], expected[i]);
+		array_free(path);
+	}
+};
+
+TEST_F(BidirectionalBFSTest, ShortestPath) {
+	GrB_Matrix R;
+	GrB_Matrix TR;
+	BuildGraph(&R, &TR);
+
+	// search with and without a transposed matrix
+	GrB_Matrix transposes[2] = {TR, GrB_NULL};
+	for(int t = 0; t < 2; t++) {
+		NodeID *path;
+
+		// the shorter of two paths
+		NodeID expected[] = {6, 0, 5, 4};
+		path = BidirectionalBFS(R, transposes[t], 6, 4, BIDIRECTIONAL_BFS_UNBOUNDED);
+		AssertPath(path, expected, 4);
+
+		NodeID single[] = {1, 2};
+		path = BidirectionalBFS(R, transposes[t], 1, 2, BIDIRECTIONAL_BFS_UNBOUNDED);
+		AssertPath(path, single, 2);
+
+		NodeID self[] = {3};
+		path = BidirectionalBFS(R, transposes[t], 3, 3, BIDIRECTIONAL_BFS_UNBOUNDED);
+		AssertPath(path, self, 1);
+
+		// edges are directed
+		path = BidirectionalBFS(R, transposes[t], 4, 0, BIDIRECTIONAL_BFS_UNBOUNDED);
+		ASSERT_TRUE(path == NULL);
+
+		// unreachable
+		path = BidirectionalBFS(R, transposes[t], 0, 7, BIDIRECTIONAL_BFS_UNBOUNDED);
+		ASSERT_TRUE(path == NULL);
+
+		// bounded search
+		path = BidirectionalBFS(R, transposes[t], 6, 4, 2);
+		ASSERT_TRUE(path == NULL);
+		path = BidirectionalBFS(R, transposes[t], 6, 4, 3);
+		AssertPath(path, expected, 4);
+	}
+
+	GrB_Matrix_free(&R);
+	GrB_Matrix_free(&TR);
+}
+
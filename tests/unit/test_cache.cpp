@@ -4,6 +4,7 @@
 extern "C" {
 #endif
 #include "../../src/util/rmalloc.h"
+#include "../../src/util/arr.h"
 #include "../../src/util/cache/cache.h"
 #include "../../src/execution_plan/execution_plan.h"
 #ifdef __cplusplus
@@ -102,3 +103,127 @@ TEST_F(CacheTest, ExecutionPlanCache) {
 	ASSERT_EQ(free_count, 9);
 }
 
+
+TEST_F(CacheTest, CacheStats) {
+	Cache *cache = Cache_New(2, (CacheEntryFreeFunc)CacheObj_Free,
+			(CacheEntryCopyFunc)CacheObj_Dup);
+
+	CacheStats stats = Cache_GetStats(cache);
+	ASSERT_EQ(stats.size, 0);
+	ASSERT_EQ(stats.cap, 2);
+	ASSERT_EQ(stats.hits, 0);
+	ASSERT_EQ(stats.misses, 0);
+
+	const char *key = "MATCH (a) RETURN a";
+	ASSERT_FALSE(Cache_GetValue(cache, key));
+
+	Cache_SetValue(cache, key, CacheObj_New("1"));
+	for(int i = 0; i < 3; i++) {
+		CacheObj *from_cache = (CacheObj *)Cache_GetValue(cache, key);
+		ASSERT_TRUE(from_cache != NULL);
+		CacheObj_Free(from_cache);
+	}
+
+	stats = Cache_GetStats(cache);
+	ASSERT_EQ(stats.size, 1);
+	ASSERT_EQ(stats.hits, 3);
+	ASSERT_EQ(stats.misses, 1);
+
+	Cache_Free(cache);
+}
+
+TEST_F(CacheTest, ThreadLookupEviction) {
+	Cache *cache = Cache_New(1, (CacheEntryFreeFunc)CacheObj_Free,
+			(CacheEntryCopyFunc)CacheObj_Dup);
+
+	CacheObj *item1 = CacheObj_New("1");
+	CacheObj *item2 = CacheObj_New("2");
+
+	const char *key1 = "MATCH (a) RETURN a";
+	const char *key2 = "MATCH (b) RETURN b";
+
+	// first lookup goes through the cache lock, later ones skip it
+	Cache_SetValue(cache, key1, item1);
+	for(int i = 0; i < 3; i++) {
+		CacheObj *from_cache = (CacheObj *)Cache_GetValue(cache, key1);
+		ASSERT_TRUE(CacheObj_EQ(item1, from_cache));
+		CacheObj_Free(from_cache);
+	}
+
+	// evict key1, reusing its entry for key2
+	Cache_SetValue(cache, key2, item2);
+
+	// the thread's lookup of key1 must not resolve to key2's entry
+	ASSERT_TRUE(Cache_GetValue(cache, key1) == NULL);
+
+	CacheObj *from_cache = (CacheObj *)Cache_GetValue(cache, key2);
+	ASSERT_TRUE(CacheObj_EQ(item2, from_cache));
+	CacheObj_Free(from_cache);
+
+	CacheStats stats = Cache_GetStats(cache);
+	ASSERT_EQ(stats.hits, 4);
+	ASSERT_EQ(stats.misses, 1);
+
+	Cache_Free(cache);
+}
+
+static void CacheObj_Collect(const char *key, void *value, void *pdata) {
+	std::string *collected = (std::string *)pdata;
+	collected->append(key);
+	collected->append("=");
+	collected->append(((CacheObj *)value)->str);
+	collected->append(";");
+}
+
+TEST_F(CacheTest, ForEach) {
+	Cache *cache = Cache_New(2, (CacheEntryFreeFunc)CacheObj_Free,
+			(CacheEntryCopyFunc)CacheObj_Dup);
+
+	std::string collected;
+	Cache_ForEach(cache, CacheObj_Collect, &collected);
+	ASSERT_EQ(collected, "");
+
+	Cache_SetValue(cache, "a", CacheObj_New("1"));
+	Cache_SetValue(cache, "b", CacheObj_New("2"));
+	Cache_ForEach(cache, CacheObj_Collect, &collected);
+	ASSERT_EQ(collected, "a=1;b=2;");
+
+	// evicted entries are no longer visited
+	Cache_SetValue(cache, "c", CacheObj_New("3"));
+	collected.clear();
+	Cache_ForEach(cache, CacheObj_Collect, &collected);
+	ASSERT_EQ(collected, "c=3;b=2;");
+
+	Cache_Free(cache);
+}
+
+TEST_F(CacheTest, HotKeys) {
+	Cache *cache = Cache_New(3, (CacheEntryFreeFunc)CacheObj_Free,
+			(CacheEntryCopyFunc)CacheObj_Dup);
+
+	Cache_SetValue(cache, "a", CacheObj_New("1"));
+	Cache_SetValue(cache, "b", CacheObj_New("2"));
+	Cache_SetValue(cache, "c", CacheObj_New("3"));
+
+	// hit 'b' three times and 'c' once, 'a' is never hit
+	const char *lookups[4] = {"b", "c", "b", "b"};
+	for(int i = 0; i < 4; i++) {
+		CacheObj_Free((CacheObj *)Cache_GetValue(cache, lookups[i]));
+	}
+
+	char **keys = Cache_HotKeys(cache, 3);
+	ASSERT_EQ(array_len(keys), 2);
+	ASSERT_STREQ(keys[0], "b");
+	ASSERT_STREQ(keys[1], "c");
+	for(uint i = 0; i < array_len(keys); i++) rm_free(keys[i]);
+	array_free(keys);
+
+	// n limits the number of reported keys
+	keys = Cache_HotKeys(cache, 1);
+	ASSERT_EQ(array_len(keys), 1);
+	ASSERT_STREQ(keys[0], "b");
+	rm_free(keys[0]);
+	array_free(keys);
+
+	Cache_Free(cache);
+}
@@ -0,0 +1,114 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/centrality.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class CentralityTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+
+	/* A = [
+	    0 1 1 0 0
+	    0 0 0 1 0
+	    0 0 0 1 0
+	    0 0 0 0 1
+	    0 0 0 0 0 ] ;
+	   a diamond 0->{1, 2}->3 followed by 3->4
+	*/
+	static GrB_Matrix _graph() {
+		GrB_Matrix A;
+		GrB_Matrix_new(&A, GrB_BOOL, 5, 5);
+		GrB_Matrix_setElement_BOOL(A, true, 0, 1);
+		GrB_Matrix_setElement_BOOL(A, true, 0, 2);
+		GrB_Matrix_setElement_BOOL(A, true, 1, 3);
+		GrB_Matrix_setElement_BOOL(A, true, 2, 3);
+		GrB_Matrix_setElement_BOOL(A, true, 3, 4);
+		return A;
+	}
+};
+
+TEST_F(CentralityTest, Betweenness) {
+	GrB_Matrix A = _graph();
+	GrB_Index sources[5] = {0, 1, 2, 3, 4};
+
+	// 0->3 and 0->4 split between 1 and 2
+	// 0->4, 1->4 and 2->4 pass through 3
+	double expected[5] = {0, 1, 1, 3, 0};
+
+	double *centrality;
+	ASSERT_EQ(Betweenness(&centrality, A, sources, 5), GrB_SUCCESS);
+	for(int i = 0; i < 5; i++) ASSERT_DOUBLE_EQ(centrality[i], expected[i]);
+	rm_free(centrality);
+
+	// paths originating at 0 only
+	double expected_sampled[5] = {0, 1, 1, 1, 0};
+	ASSERT_EQ(Betweenness(&centrality, A, sources, 1), GrB_SUCCESS);
+	for(int i = 0; i < 5; i++) ASSERT_DOUBLE_EQ(centrality[i], expected_sampled[i]);
+	rm_free(centrality);
+
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(CentralityTest, BetweennessBatches) {
+	// a chain 0->1->...->n-1, spanning several batches of sources
+	const GrB_Index n = 2 * BETWEENNESS_BATCH_SIZE + 3;
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_BOOL, n, n);
+	GrB_Index *sources = (GrB_Index *)rm_malloc(sizeof(GrB_Index) * n);
+	for(GrB_Index i = 0; i < n; i++) {
+		sources[i] = i;
+		if(i + 1 < n) GrB_Matrix_setElement_BOOL(A, true, i, i + 1);
+	}
+
+	// node i lies on the paths from each of its i predecessors
+	// to each of its n - i - 1 successors
+	double *centrality;
+	ASSERT_EQ(Betweenness(&centrality, A, sources, n), GrB_SUCCESS);
+	for(GrB_Index i = 0; i < n; i++) {
+		ASSERT_DOUBLE_EQ(centrality[i], (double)i * (n - i - 1));
+	}
+
+	rm_free(centrality);
+	rm_free(sources);
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(CentralityTest, Closeness) {
+	GrB_Matrix A = _graph();
+	GrB_Index nodes[3] = {0, 3, 4};
+
+	double *closeness;
+	double *harmonic;
+	ASSERT_EQ(Closeness(&closeness, &harmonic, A, nodes, 3), GrB_SUCCESS);
+
+	// distances from 0: 1, 1, 2, 3
+	ASSERT_DOUBLE_EQ(closeness[0], 4.0 / 7);
+	ASSERT_DOUBLE_EQ(harmonic[0], (1 + 1 + 0.5 + 1.0 / 3) / 2);
+	// distances from 3: 1
+	ASSERT_DOUBLE_EQ(closeness[1], 1);
+	ASSERT_DOUBLE_EQ(harmonic[1], 0.5);
+	// 4 reaches no node
+	ASSERT_DOUBLE_EQ(closeness[2], 0);
+	ASSERT_DOUBLE_EQ(harmonic[2], 0);
+
+	rm_free(closeness);
+	rm_free(harmonic);
+	GrB_Matrix_free(&A);
+}
@@ -0,0 +1,148 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/util/arr.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/index/composite_index.h"
+#include <math.h>
+#ifdef __cplusplus
+}
+#endif
+
+class CompositeIndexTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+
+	static NumericRange _range(double min, bool include_min, double max,
+			bool include_max) {
+		NumericRange r;
+		r.min = min;
+		r.max = max;
+		r.include_min = include_min;
+		r.include_max = include_max;
+		r.valid = true;
+		return r;
+	}
+
+	static CompositeIndex *_index() {
+		Attribute_ID attributes[2] = {0, 1};
+		return CompositeIndex_New(attributes, 2);
+	}
+};
+
+TEST_F(CompositeIndexTest, Query) {
+	CompositeIndex *ci = _index();
+	// insert keys in reverse order, node i holds key (i % 10, i / 10)
+	for(int i = 99; i >= 0; i--) {
+		double keys[2] = {(double)(i % 10), (double)(99 - i) / 10};
+		CompositeIndex_Insert(ci, i, keys);
+	}
+	CompositeIndex_Flush(ci);
+	ASSERT_EQ(CompositeIndex_Count(ci), 100);
+	ASSERT_EQ(CompositeIndex_KeyPosition(ci, 1), 1);
+	ASSERT_EQ(CompositeIndex_KeyPosition(ci, 2), -1);
+
+	// prefix (3), ids are reported by ascending second key
+	double prefix[2] = {3, 0};
+	NodeID *ids = CompositeIndex_Query(ci, prefix, 1, NULL);
+	ASSERT_EQ(array_len(ids), 10);
+	for(uint i = 0; i < 10; i++) ASSERT_EQ(ids[i], 93 - i * 10);
+	array_free(ids);
+
+	// prefix (3), second key within [1, 4)
+	NumericRange r = _range(1, true, 4, false);
+	ids = CompositeIndex_Query(ci, prefix, 1, &r);
+	ASSERT_EQ(array_len(ids), 3);
+	ASSERT_EQ(ids[0], 83);
+	ASSERT_EQ(ids[1], 73);
+	ASSERT_EQ(ids[2], 63);
+	array_free(ids);
+
+	// full key
+	prefix[1] = 9.6;
+	ids = CompositeIndex_Query(ci, prefix, 2, NULL);
+	ASSERT_EQ(array_len(ids), 1);
+	ASSERT_EQ(ids[0], 3);
+	array_free(ids);
+
+	// first key within (7, inf)
+	r = _range(7, false, INFINITY, false);
+	ids = CompositeIndex_Query(ci, NULL, 0, &r);
+	ASSERT_EQ(array_len(ids), 20);
+	array_free(ids);
+
+	// missing prefix
+	prefix[0] = 10;
+	ids = CompositeIndex_Query(ci, prefix, 1, NULL);
+	ASSERT_EQ(array_len(ids), 0);
+	array_free(ids);
+
+	CompositeIndex_Free(ci);
+}
+
+TEST_F(CompositeIndexTest, Modifications) {
+	const uint n = 10000;
+	double values[n][2];
+	CompositeIndex *ci = _index();
+
+	for(uint i = 0; i < n; i++) {
+		values[i][0] = i % 10;
+		values[i][1] = i % 100;
+		CompositeIndex_Insert(ci, i, values[i]);
+	}
+	CompositeIndex_Flush(ci);
+
+	// mix updates, removals and insertions
+	// crossing the pending insertions threshold several times
+	srand(7);
+	for(uint i = 0; i < 5 * COMPOSITE_INDEX_DELTA_CAP; i++) {
+		NodeID id = rand() % n;
+		if(rand() % 3 == 0) {
+			values[id][0] = NAN;
+			CompositeIndex_Remove(ci, id);
+		} else {
+			values[id][0] = rand() % 10;
+			values[id][1] = rand() % 100;
+			CompositeIndex_Insert(ci, id, values[id]);
+		}
+
+		if(i % 1000 != 0) continue;
+
+		// compare against a full scan
+		double prefix = rand() % 10;
+		double min = rand() % 100;
+		double max = min + rand() % 20;
+		NumericRange r = _range(min, i % 2, max, i % 3);
+		NodeID *ids = CompositeIndex_Query(ci, &prefix, 1, &r);
+
+		uint matches = 0;
+		for(uint j = 0; j < n; j++) {
+			double *v = values[j];
+			if(isnan(v[0]) || v[0] != prefix) continue;
+			if(r.include_min ? v[1] < min : v[1] <= min) continue;
+			if(r.include_max ? v[1] > max : v[1] >= max) continue;
+			matches++;
+		}
+		ASSERT_EQ(matches, array_len(ids));
+
+		// reported in key order
+		for(uint j = 1; j < array_len(ids); j++) {
+			ASSERT_LE(values[ids[j - 1]][1], values[ids[j]][1]);
+		}
+		array_free(ids);
+	}
+
+	CompositeIndex_Free(ci);
+}
+
@@ -5,6 +5,7 @@
 */
 
 #include "gtest.h"
+#include <unistd.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -20,6 +21,13 @@ extern "C"
 
 int X = 1;
 
+// task recording its execution order
+typedef struct {
+	int *order;  // ids of executed tasks
+	int *next;   // number of executed tasks
+	int id;      // task id
+} OrderedTask;
+
 class CRONTest: public ::testing::Test {
   protected:
 	static void SetUpTestCase() {
@@ -42,6 +50,17 @@ class CRONTest: public ::testing::Test {
 		int *Y = (int*)pdata;
 		X *= *Y;
 	}
+
+	static void inc_task(void *pdata) {
+		int *Y = (int*)pdata;
+		(*Y)++;
+	}
+
+	// records the task's id in execution order
+	static void record_task(void *pdata) {
+		OrderedTask *t = (OrderedTask*)pdata;
+		t->order[(*t->next)++] = t->id;
+	}
 };
 
 TEST_F(CRONTest, CRONTaskExec) {
@@ -68,3 +87,37 @@ TEST_F(CRONTest, CRONTaskExec) {
 	ASSERT_EQ(X, 4);
 }
 
+
+TEST_F(CRONTest, CRONTaskAbort) {
+	int Y = 0;
+	int Z = 0;
+
+	// aborted before it is due, the task never runs
+	CronTaskHandle aborted = Cron_AddAbortableTask(100, inc_task, &Y);
+	CronTaskHandle executed = Cron_AddAbortableTask(10, inc_task, &Z);
+	ASSERT_TRUE(Cron_AbortTask(aborted));
+
+	usleep(300000);
+	ASSERT_EQ(Y, 0);
+	ASSERT_EQ(Z, 1);
+
+	// the task ran, its handle is released all the same
+	ASSERT_FALSE(Cron_AbortTask(executed));
+}
+
+TEST_F(CRONTest, CRONTaskCascade) {
+	int order[3] = {0, 0, 0};
+	int next = 0;
+	OrderedTask tasks[3] = {{order, &next, 1}, {order, &next, 2}, {order, &next, 3}};
+
+	// tasks beyond the lowest wheel are cascaded before they're due
+	Cron_AddTask(300, record_task, tasks + 2);
+	Cron_AddTask(5, record_task, tasks);
+	Cron_AddTask(100, record_task, tasks + 1);
+
+	usleep(500000);
+	ASSERT_EQ(next, 3);
+	ASSERT_EQ(order[0], 1);
+	ASSERT_EQ(order[1], 2);
+	ASSERT_EQ(order[2], 3);
+}
@@ -21,6 +21,11 @@ extern "C" {
 }
 #endif
 
+static uint64_t destructed = 0;
+static void _CountDestructor(void *item) {
+	destructed++;
+}
+
 class DataBlockTest: public ::testing::Test {
   protected:
 	static void SetUpTestCase() {
@@ -38,7 +43,7 @@ TEST_F(DataBlockTest, New) {
 
 	ASSERT_EQ(dataBlock->itemCount, 0);     // No items were added.
 	ASSERT_GE(dataBlock->itemCap, 1024);
-	ASSERT_EQ(dataBlock->itemSize, itemSize + ITEM_HEADER_SIZE);
+	ASSERT_EQ(dataBlock->itemSize, itemSize);
 	ASSERT_GE(dataBlock->blockCount, 1024 / DATABLOCK_BLOCK_CAP);
 
 	for(int i = 0; i < dataBlock->blockCount; i++) {
@@ -159,8 +164,8 @@ TEST_F(DataBlockTest, RemoveItem) {
 	DataBlock_DeleteItem(dataBlock, 0);
 	ASSERT_EQ(dataBlock->itemCount, itemCount - 1);
 	ASSERT_EQ(array_len(dataBlock->deletedIdx), 1);
-	DataBlockItemHeader *header = (DataBlockItemHeader *)dataBlock->blocks[0]->data;
-	ASSERT_TRUE(IS_ITEM_DELETED(header));
+	ASSERT_TRUE(DataBlock_ItemIsDeleted(dataBlock, 0));
+	ASSERT_FALSE(DataBlock_ItemIsDeleted(dataBlock, 1));
 
 	// Try to get item from deleted cell.
 	item = (int *)DataBlock_GetItem(dataBlock, 0);
@@ -180,7 +185,7 @@ TEST_F(DataBlockTest, RemoveItem) {
 	int *newItem = (int *)DataBlock_AllocateItem(dataBlock, NULL);
 	ASSERT_EQ(dataBlock->itemCount, itemCount);
 	ASSERT_EQ(array_len(dataBlock->deletedIdx), 0);
-	ASSERT_TRUE((void *)newItem == (void *)((dataBlock->blocks[0]->data) + ITEM_HEADER_SIZE));
+	ASSERT_TRUE((void *)newItem == (void *)dataBlock->blocks[0]->data);
 
 	it = DataBlock_Scan(dataBlock);
 	counter = 0;
@@ -239,3 +244,196 @@ TEST_F(DataBlockTest, OutOfOrderBuilding) {
 	DataBlock_Free(dataBlock);
 }
 
+
+TEST_F(DataBlockTest, SparseScan) {
+	DataBlock *dataBlock = DataBlock_New(1024, sizeof(int), NULL);
+	uint itemCount = DATABLOCK_BLOCK_CAP * 3;
+
+	for(uint i = 0; i < itemCount; i++) {
+		int *item = (int *)DataBlock_AllocateItem(dataBlock, NULL);
+		*item = i;
+	}
+
+	// Keep every 1000th item, leaving long runs of deleted items.
+	for(uint i = 0; i < itemCount; i++) {
+		if(i % 1000 != 0) DataBlock_DeleteItem(dataBlock, i);
+	}
+
+	uint64_t idx;
+	uint expected = 0;
+	int *item = NULL;
+	DataBlockIterator *it = DataBlock_Scan(dataBlock);
+	while((item = (int *)DataBlockIterator_Next(it, &idx))) {
+		ASSERT_EQ(idx, expected);
+		ASSERT_EQ(*item, expected);
+		expected += 1000;
+	}
+	ASSERT_GE(expected, itemCount);
+	DataBlockIterator_Free(it);
+
+	DataBlock_Free(dataBlock);
+}
+
+TEST_F(DataBlockTest, Compact) {
+	DataBlock *dataBlock = DataBlock_New(1024, sizeof(int), NULL);
+	uint itemCount = DATABLOCK_BLOCK_CAP * 4;
+
+	for(uint i = 0; i < itemCount; i++) {
+		int *item = (int *)DataBlock_AllocateItem(dataBlock, NULL);
+		*item = i;
+	}
+	uint blockCount = dataBlock->blockCount;
+
+	// Empty the second block entirely, along with the last two blocks
+	// but for a single item, and delete a few items of the first block.
+	for(uint i = DATABLOCK_BLOCK_CAP; i < itemCount; i++) {
+		if(i == DATABLOCK_BLOCK_CAP * 2 + 5) continue;
+		DataBlock_DeleteItem(dataBlock, i);
+	}
+	for(uint i = 10; i < 20; i++) DataBlock_DeleteItem(dataBlock, i);
+
+	ASSERT_GT(DataBlock_Compact(dataBlock), 0);
+
+	// Trailing blocks are released, the second block is released in place.
+	ASSERT_EQ(dataBlock->blockCount, 3);
+	ASSERT_LT(dataBlock->blockCount, blockCount);
+	ASSERT_TRUE(dataBlock->blocks[1] == NULL);
+	ASSERT_EQ(dataBlock->itemCount, DATABLOCK_BLOCK_CAP - 10 + 1);
+	ASSERT_EQ(dataBlock->blocks[0]->next, dataBlock->blocks[2]);
+
+	// Item indices are preserved.
+	ASSERT_EQ(*(int *)DataBlock_GetItem(dataBlock, 0), 0);
+	ASSERT_TRUE(DataBlock_GetItem(dataBlock, 15) == NULL);
+	ASSERT_TRUE(DataBlock_GetItem(dataBlock, DATABLOCK_BLOCK_CAP + 1) == NULL);
+	ASSERT_EQ(*(int *)DataBlock_GetItem(dataBlock, DATABLOCK_BLOCK_CAP * 2 + 5),
+			  DATABLOCK_BLOCK_CAP * 2 + 5);
+
+	uint count = 0;
+	DataBlockIterator *it = DataBlock_Scan(dataBlock);
+	while(DataBlockIterator_Next(it, NULL)) count++;
+	ASSERT_EQ(count, dataBlock->itemCount);
+	DataBlockIterator_Free(it);
+
+	// Deleted indices are reused lowest first.
+	uint64_t idx;
+	for(uint i = 10; i < 20; i++) {
+		DataBlock_AllocateItem(dataBlock, &idx);
+		ASSERT_EQ(idx, i);
+	}
+
+	// Allocating within a released block restores it.
+	int *item = (int *)DataBlock_AllocateItem(dataBlock, &idx);
+	ASSERT_EQ(idx, DATABLOCK_BLOCK_CAP);
+	*item = -1;
+	ASSERT_TRUE(dataBlock->blocks[1] != NULL);
+	ASSERT_EQ(*(int *)DataBlock_GetItem(dataBlock, DATABLOCK_BLOCK_CAP), -1);
+	ASSERT_TRUE(DataBlock_GetItem(dataBlock, DATABLOCK_BLOCK_CAP + 1) == NULL);
+
+	DataBlock_Free(dataBlock);
+}
+
+TEST_F(DataBlockTest, ForkActive) {
+	DataBlock *dataBlock = DataBlock_New(1024, sizeof(int), NULL);
+
+	uint64_t idx;
+	for(uint i = 0; i < 1024; i++) DataBlock_AllocateItem(dataBlock, NULL);
+	DataBlock_DeleteItem(dataBlock, 3);
+	DataBlock_DeleteItem(dataBlock, 7);
+
+	// While a fork is active deleted indices are not reused
+	// and compaction is postponed.
+	DataBlock_SetForkActive(true);
+	ASSERT_EQ(DataBlock_Compact(dataBlock), 0);
+	for(uint i = 0; i < DATABLOCK_BLOCK_CAP; i++) {
+		DataBlock_AllocateItem(dataBlock, &idx);
+		ASSERT_EQ(idx, 1024 + i);
+	}
+	ASSERT_EQ(DataBlock_DeletedItemsCount(dataBlock), 2);
+	ASSERT_GE(dataBlock->itemCap, 1024 + DATABLOCK_BLOCK_CAP);
+
+	// Once the fork is over deleted indices are reused.
+	DataBlock_SetForkActive(false);
+	DataBlock_AllocateItem(dataBlock, &idx);
+	ASSERT_TRUE(idx == 3 || idx == 7);
+	DataBlock_AllocateItem(dataBlock, &idx);
+	ASSERT_TRUE(idx == 3 || idx == 7);
+	ASSERT_EQ(DataBlock_DeletedItemsCount(dataBlock), 0);
+
+	DataBlock_Free(dataBlock);
+}
+
+TEST_F(DataBlockTest, FreeLastBlock) {
+	DataBlock *dataBlock = DataBlock_New(DATABLOCK_BLOCK_CAP * 3, sizeof(int),
+										 _CountDestructor);
+	for(uint i = 0; i < DATABLOCK_BLOCK_CAP * 2 + 10; i++) {
+		DataBlock_AllocateItem(dataBlock, NULL);
+	}
+	DataBlock_DeleteItem(dataBlock, DATABLOCK_BLOCK_CAP * 2);
+	ASSERT_EQ(destructed, 1);
+	destructed = 0;
+
+	// Blocks are released last to first, along with their items.
+	ASSERT_TRUE(DataBlock_FreeLastBlock(dataBlock));
+	ASSERT_EQ(destructed, 9);
+	ASSERT_EQ(dataBlock->blockCount, 2);
+	ASSERT_EQ(dataBlock->itemCount, DATABLOCK_BLOCK_CAP * 2);
+
+	while(DataBlock_FreeLastBlock(dataBlock));
+	ASSERT_EQ(destructed, DATABLOCK_BLOCK_CAP * 2 + 9);
+	ASSERT_EQ(dataBlock->blockCount, 0);
+	ASSERT_EQ(dataBlock->itemCount, 0);
+
+	DataBlock_Free(dataBlock);
+}
+
+TEST_F(DataBlockTest, BlockVersion) {
+	DataBlock *dataBlock = DataBlock_New(DATABLOCK_BLOCK_CAP * 2, sizeof(int), NULL);
+	for(uint i = 0; i < DATABLOCK_BLOCK_CAP + 10; i++) {
+		DataBlock_AllocateItem(dataBlock, NULL);
+	}
+
+	// Blocks are versioned independently, versions are never reused.
+	uint64_t first = DataBlock_BlockVersion(dataBlock, 0);
+	uint64_t second = DataBlock_BlockVersion(dataBlock, 1);
+	ASSERT_NE(first, 0);
+	ASSERT_NE(first, second);
+	ASSERT_EQ(DataBlock_BlockItemCount(dataBlock, 1), 10);
+
+	DataBlock_MarkModified(dataBlock, 5);
+	ASSERT_NE(DataBlock_BlockVersion(dataBlock, 0), first);
+	ASSERT_EQ(DataBlock_BlockVersion(dataBlock, 1), second);
+	first = DataBlock_BlockVersion(dataBlock, 0);
+
+	DataBlock_DeleteItem(dataBlock, DATABLOCK_BLOCK_CAP + 2);
+	ASSERT_EQ(DataBlock_BlockVersion(dataBlock, 0), first);
+	ASSERT_NE(DataBlock_BlockVersion(dataBlock, 1), second);
+	ASSERT_EQ(DataBlock_BlockItemCount(dataBlock, 1), 9);
+	second = DataBlock_BlockVersion(dataBlock, 1);
+
+	// Reusing a deleted position modifies its block.
+	uint64_t idx;
+	DataBlock_AllocateItem(dataBlock, &idx);
+	ASSERT_EQ(idx, DATABLOCK_BLOCK_CAP + 2);
+	ASSERT_EQ(DataBlock_BlockVersion(dataBlock, 0), first);
+	ASSERT_NE(DataBlock_BlockVersion(dataBlock, 1), second);
+
+	DataBlock_Free(dataBlock);
+}
+
+TEST_F(DataBlockTest, ItemAlignment) {
+	// Items are laid out back to back, retaining their natural alignment.
+	DataBlock *dataBlock = DataBlock_New(DATABLOCK_BLOCK_CAP, sizeof(uint64_t), NULL);
+	for(uint i = 0; i < 100; i++) {
+		uint64_t *item = (uint64_t *)DataBlock_AllocateItem(dataBlock, NULL);
+		ASSERT_EQ((uintptr_t)item % sizeof(uint64_t), 0);
+		*item = i;
+	}
+
+	for(uint64_t i = 0; i < 100; i++) {
+		uint64_t *item = (uint64_t *)DataBlock_GetItemSized(dataBlock, i, sizeof(uint64_t));
+		ASSERT_TRUE(item == DataBlock_GetItem(dataBlock, i));
+		ASSERT_EQ(*item, i);
+	}
+
+	DataBlock_Free(dataBlock);
+}
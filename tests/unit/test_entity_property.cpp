@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include "../../src/value.h"
+#include "../../src/query_ctx.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/datatypes/array.h"
+#include "../../src/graph/graphcontext.h"
+#include "../../src/graph/entities/graph_entity.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class EntityPropertyTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+
+		// Properties are stored on behalf of a graph without a string pool
+		ASSERT_TRUE(QueryCtx_Init());
+		GraphContext *gc = (GraphContext *)rm_calloc(1, sizeof(GraphContext));
+		QueryCtx_SetGraphCtx(gc);
+	}
+
+	static void TearDownTestCase() {
+		rm_free(QueryCtx_GetGraphCtx());
+		QueryCtx_Free();
+	}
+};
+
+TEST_F(EntityPropertyTest, InlineValues) {
+	ASSERT_EQ(sizeof(EntityProperty), 16);
+
+	SIValue values[6] = {
+		SI_LongVal(-42),
+		SI_LongVal(INT64_MAX),
+		SI_DoubleVal(3.5),
+		SI_BoolVal(true),
+		SI_BoolVal(false),
+		SI_Point(32.1, 34.8)
+	};
+
+	EntityProperty p;
+	for(int i = 0; i < 6; i++) {
+		EntityProperty_Set(&p, i, values[i]);
+		SIValue v = EntityProperty_Value(&p);
+		ASSERT_EQ(p.id, i);
+		ASSERT_EQ(SI_TYPE(v), SI_TYPE(values[i]));
+		ASSERT_EQ(v.allocation, M_NONE);
+		ASSERT_EQ(v.longval, values[i].longval);
+		EntityProperty_Free(&p);
+	}
+}
+
+TEST_F(EntityPropertyTest, Strings) {
+	EntityProperty p;
+
+	// Short strings are copied into the property.
+	char short_str[] = "abcdefghijkl";
+	ASSERT_EQ(strlen(short_str), PROPERTY_INLINE_STRLEN);
+	EntityProperty_Set(&p, 1, SI_ConstStringVal(short_str));
+	SIValue v = EntityProperty_Value(&p);
+	ASSERT_EQ(SI_TYPE(v), T_STRING);
+	ASSERT_STREQ(v.stringval, short_str);
+	ASSERT_EQ((void *)v.stringval, (void *)p.payload);
+	EntityProperty_Free(&p);
+
+	EntityProperty_Set(&p, 1, SI_DuplicateStringVal(""));
+	ASSERT_STREQ(EntityProperty_Value(&p).stringval, "");
+	EntityProperty_Free(&p);
+
+	// Long strings are owned by the property.
+	const char *long_str = "abcdefghijklm";
+	SIValue owned = SI_DuplicateStringVal(long_str);
+	EntityProperty_Set(&p, 2, owned);
+	v = EntityProperty_Value(&p);
+	ASSERT_EQ(v.stringval, owned.stringval);
+	ASSERT_EQ(v.allocation, M_CONST);
+	EntityProperty_Free(&p);
+
+	// Shared strings are duplicated.
+	char shared_str[] = "a string too long to be inlined";
+	EntityProperty_Set(&p, 3, SI_ConstStringVal(shared_str));
+	v = EntityProperty_Value(&p);
+	ASSERT_NE(v.stringval, shared_str);
+	ASSERT_STREQ(v.stringval, shared_str);
+	EntityProperty_Free(&p);
+}
+
+TEST_F(EntityPropertyTest, Arrays) {
+	SIValue arr = SI_Array(2);
+	SIArray_Append(&arr, SI_LongVal(1));
+	SIArray_Append(&arr, SI_ConstStringVal((char *)"two"));
+
+	EntityProperty p;
+	EntityProperty_Set(&p, 0, SI_ShareValue(arr));
+	SIValue v = EntityProperty_Value(&p);
+	ASSERT_EQ(SI_TYPE(v), T_ARRAY);
+	ASSERT_NE(v.array, arr.array);
+	ASSERT_EQ(SIValue_Compare(v, arr, NULL), 0);
+	EntityProperty_Free(&p);
+
+	// The property takes ownership over arrays it is handed.
+	EntityProperty_Set(&p, 0, arr);
+	v = EntityProperty_Value(&p);
+	ASSERT_EQ(v.array, arr.array);
+	EntityProperty_Free(&p);
+}
+
+TEST_F(EntityPropertyTest, SortedLayout) {
+	Entity en = {0};
+	GraphEntity ge = {&en, 0};
+
+	// Properties are kept sorted regardless of insertion order.
+	Attribute_ID ids[20];
+	for(int i = 0; i < 20; i++) ids[i] = (i * 7) % 20 * 3;
+	for(int i = 0; i < 20; i++) {
+		GraphEntity_AddProperty(&ge, ids[i], SI_LongVal(ids[i]));
+	}
+	ASSERT_EQ(en.prop_count, 20);
+	for(int i = 1; i < en.prop_count; i++) {
+		ASSERT_LT(en.properties[i - 1].id, en.properties[i].id);
+	}
+
+	for(int i = 0; i < 20; i++) {
+		SIValue v = GraphEntity_GetProperty(&ge, ids[i]);
+		ASSERT_EQ(v.longval, ids[i]);
+	}
+	// Missing attributes, sharing a mask bit with present ones or not.
+	ASSERT_EQ(SI_TYPE(GraphEntity_GetProperty(&ge, 1)), T_NULL);
+	ASSERT_EQ(SI_TYPE(GraphEntity_GetProperty(&ge, 64)), T_NULL);
+	ASSERT_EQ(SI_TYPE(GraphEntity_GetProperty(&ge, ATTRIBUTE_NOTFOUND)), T_NULL);
+
+	// Removal preserves order.
+	GraphEntity_SetProperty(&ge, 30, SI_NullVal());
+	GraphEntity_SetProperty(&ge, 0, SI_NullVal());
+	ASSERT_EQ(en.prop_count, 18);
+	ASSERT_EQ(SI_TYPE(GraphEntity_GetProperty(&ge, 30)), T_NULL);
+	ASSERT_EQ(SI_TYPE(GraphEntity_GetProperty(&ge, 0)), T_NULL);
+	for(int i = 1; i < en.prop_count; i++) {
+		ASSERT_LT(en.properties[i - 1].id, en.properties[i].id);
+	}
+
+	// Batched retrieval, ascending and out of order.
+	Attribute_ID request[6] = {3, 6, 7, 57, 9, 0};
+	SIValue values[6];
+	GraphEntity_GetProperties(&ge, request, 6, values);
+	ASSERT_EQ(values[0].longval, 3);
+	ASSERT_EQ(values[1].longval, 6);
+	ASSERT_EQ(SI_TYPE(values[2]), T_NULL);
+	ASSERT_EQ(values[3].longval, 57);
+	ASSERT_EQ(values[4].longval, 9);
+	ASSERT_EQ(SI_TYPE(values[5]), T_NULL);
+
+	FreeEntity(&en);
+}
+
+TEST_F(EntityPropertyTest, AdoptProperties) {
+	Entity en = {0};
+	GraphEntity ge = {&en, 0};
+
+	EntityProperty *properties = (EntityProperty *)rm_malloc(sizeof(EntityProperty) * 3);
+	EntityProperty_Set(properties, 5, SI_LongVal(5));
+	EntityProperty_Set(properties + 1, 2, SI_LongVal(2));
+	EntityProperty_Set(properties + 2, 40, SI_LongVal(40));
+	GraphEntity_AdoptProperties(&ge, properties, 3);
+
+	ASSERT_EQ(en.properties[0].id, 2);
+	ASSERT_EQ(en.properties[1].id, 5);
+	ASSERT_EQ(en.properties[2].id, 40);
+	ASSERT_EQ(GraphEntity_GetProperty(&ge, 40).longval, 40);
+	ASSERT_EQ(SI_TYPE(GraphEntity_GetProperty(&ge, 8)), T_NULL);
+
+	FreeEntity(&en);
+}
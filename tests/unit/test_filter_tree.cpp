@@ -44,8 +44,7 @@ class FilterTreeTest: public ::testing::Test {
 		 * accessible via thread local storage, as such we're creating a
 		 * fake graph context and placing it within thread local storage. */
 		GraphContext *gc = (GraphContext *)calloc(1, sizeof(GraphContext));
-		gc->attributes = raxNew();
-		pthread_rwlock_init(&gc->_attribute_rwlock, NULL);
+		gc->attributes = AttributeTable_New();
 
 		// No indicies.
 		gc->index_count = 0;
@@ -479,3 +478,86 @@ TEST_F(FilterTreeTest, FilterTree_Compact) {
 	FilterTree_Free(expected);
 }
 
+
+TEST_F(FilterTreeTest, ApplyFiltersBatch) {
+	rax *mapping = raxNew();
+	raxInsert(mapping, (unsigned char *)"x", 1, (void *)0, NULL);
+
+	// 3 < x AND x <= 40.5 OR x <> 7
+	FT_FilterNode *lower = FilterTree_CreatePredicateFilter(OP_LT,
+			AR_EXP_NewConstOperandNode(SI_LongVal(3)),
+			AR_EXP_NewVariableOperandNode("x"));
+	FT_FilterNode *upper = FilterTree_CreatePredicateFilter(OP_LE,
+			AR_EXP_NewVariableOperandNode("x"),
+			AR_EXP_NewConstOperandNode(SI_DoubleVal(40.5)));
+	FT_FilterNode *neq = FilterTree_CreatePredicateFilter(OP_NEQUAL,
+			AR_EXP_NewVariableOperandNode("x"),
+			AR_EXP_NewConstOperandNode(SI_LongVal(7)));
+	FT_FilterNode *range = FilterTree_CreateConditionFilter(OP_AND);
+	FilterTree_AppendLeftChild(range, lower);
+	FilterTree_AppendRightChild(range, upper);
+	FT_FilterNode *root = FilterTree_CreateConditionFilter(OP_OR);
+	FilterTree_AppendLeftChild(root, range);
+	FilterTree_AppendRightChild(root, neq);
+
+	// integers, doubles, nulls and strings
+	Record batch[64];
+	for(uint i = 0; i < 64; i++) {
+		batch[i] = Record_New(mapping);
+		SIValue v;
+		switch(i % 4) {
+			case 0: v = SI_LongVal(i); break;
+			case 1: v = SI_DoubleVal(i + 0.5); break;
+			case 2: v = SI_NullVal(); break;
+			default: v = SI_ConstStringVal((char *)"7"); break;
+		}
+		Record_AddScalar(batch[i], 0, v);
+	}
+
+	// every tree, evaluated as a batch, agrees with per record evaluation
+	uint sizes[5] = {0, 1, 13, 63, 64};
+	FT_FilterNode *trees[4] = {lower, upper, range, root};
+	for(uint t = 0; t < 4; t++) {
+		for(uint s = 0; s < 5; s++) {
+			uint n = sizes[s];
+			uint64_t selection = FilterTree_applyFiltersBatch(trees[t], batch, n);
+			for(uint i = 0; i < n; i++) {
+				bool pass = FilterTree_applyFilters(trees[t], batch[i]) == FILTER_PASS;
+				ASSERT_EQ(pass, (bool)(selection & (1ULL << i)));
+			}
+			if(n < 64) ASSERT_EQ(0, selection >> n);
+		}
+	}
+
+	for(uint i = 0; i < 64; i++) Record_Free(batch[i]);
+	FilterTree_Free(root);
+	raxFree(mapping);
+}
+
+TEST_F(FilterTreeTest, FilterTree_Reorder) {
+	// cheap comparison is hoisted ahead of the contains call
+	FT_FilterNode *tree = build_tree_from_query(
+			"MATCH (n) WHERE contains(n.bio, 'x') AND n.age > 30 RETURN n");
+	FilterTree_Reorder(tree);
+	ASSERT_EQ(FT_N_COND, tree->t);
+	ASSERT_EQ(FT_N_PRED, tree->cond.left->t);
+	ASSERT_EQ(OP_GT, tree->cond.left->pred.op);
+	FilterTree_Free(tree);
+
+	// fallible operands are never moved ahead of their guards
+	tree = build_tree_from_query(
+			"MATCH (n) WHERE n.x <> 0 AND 10 / n.x > 1 RETURN n");
+	FilterTree_Reorder(tree);
+	ASSERT_EQ(FT_N_COND, tree->t);
+	ASSERT_EQ(OP_NEQUAL, tree->cond.left->pred.op);
+	FilterTree_Free(tree);
+
+	// equality is visited ahead of a range, across the whole chain
+	tree = build_tree_from_query(
+			"MATCH (n) WHERE n.a > 1 AND n.b < 2 AND n.c = 3 RETURN n");
+	FilterTree_Reorder(tree);
+	FT_FilterNode *first = tree;
+	while(first->t == FT_N_COND) first = first->cond.left;
+	ASSERT_EQ(OP_EQUAL, first->pred.op);
+	FilterTree_Free(tree);
+}
@@ -14,6 +14,7 @@ extern "C"
 #include "../../src/config.h"
 #include "../../src/util/arr.h"
 #include "../../src/graph/graph.h"
+#include "../../src/graph/multi_edge_table.h"
 #include "../../src/util/rmalloc.h"
 #include "../../src/util/simple_timer.h"
 #include "../../deps/GraphBLAS/Include/GraphBLAS.h"
@@ -655,6 +656,17 @@ TEST_F(GraphTest, GetNode) {
 		ASSERT_TRUE(n.entity != NULL);
 	}
 
+	// Retrieve nodes in a batch, in reverse order.
+	NodeID ids[nodeCount];
+	Node nodes[nodeCount];
+	for(i = 0; i < nodeCount; i++) ids[i] = nodeCount - 1 - i;
+	Graph_GetNodes(g, ids, nodeCount, nodes);
+	for(i = 0; i < nodeCount; i++) {
+		Graph_GetNode(g, ids[i], &n);
+		ASSERT_EQ(nodes[i].id, ids[i]);
+		ASSERT_TRUE(nodes[i].entity == n.entity);
+	}
+
 	Graph_Free(g);
 }
 
@@ -886,3 +898,370 @@ TEST_F(GraphTest, BulkDelete) {
 	Graph_Free(g);
 }
 
+
+TEST_F(GraphTest, FlushAllPending) {
+	bool pending;
+	Node n;
+	Edge e;
+	GrB_Index nrows;
+	GrB_Index nvals;
+	Graph *g = Graph_New(32, 32);
+
+	// Introduce nodes and an edge under the write lock.
+	Graph_AcquireWriteLock(g);
+	int r = Graph_AddRelationType(g);
+	for(int i = 0; i < 4; i++) Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+	Graph_ConnectNodes(g, 0, 1, r, &e);
+
+	// Writer compacts matrices before releasing the lock.
+	Graph_FlushAllPending(g);
+	Graph_ReleaseLock(g);
+
+	// Matrices are expected to be synced, no pending work left for readers.
+	RG_Matrix M = g->relations[r];
+	ASSERT_FALSE(M->dirty);
+	GxB_Matrix_Pending(M->grb_matrix, &pending);
+	ASSERT_FALSE(pending);
+	GrB_Matrix_nrows(&nrows, M->grb_matrix);
+	ASSERT_EQ(nrows, Graph_RequiredMatrixDim(g));
+
+	GrB_Matrix_nvals(&nvals, Graph_GetRelationMatrix(g, r));
+	ASSERT_EQ(nvals, 1);
+
+	ASSERT_FALSE(g->adjacency_matrix->dirty);
+	GxB_Matrix_Pending(g->adjacency_matrix->grb_matrix, &pending);
+	ASSERT_FALSE(pending);
+
+	// Clean up.
+	Graph_Free(g);
+}
+
+TEST_F(GraphTest, ReservedMatrixDim) {
+	Node n;
+	GrB_Index nrows;
+	Graph *g = Graph_New(32, 32);
+
+	// delete a node, its ID is reused by the next creation
+	Graph_AcquireWriteLock(g);
+	int l = Graph_AddLabel(g);
+	for(int i = 0; i < 4; i++) Graph_CreateNode(g, l, &n);
+	Graph_DeleteNode(g, &n);
+	Graph_FlushAllPending(g);
+
+	// reserved nodes are created under the resize to capacity policy
+	Graph_SetMatrixPolicy(g, RESIZE_TO_CAPACITY);
+	Graph_AllocateNodes(g, 3);
+	for(int i = 0; i < 3; i++) Graph_CreateNode(g, l, &n);
+	Graph_SetMatrixPolicy(g, SYNC_AND_MINIMIZE_SPACE);
+
+	// label matrix was sized to fit the reserved nodes, not node capacity
+	ASSERT_EQ(Graph_RequiredMatrixDim(g), 6);
+	GrB_Matrix_nrows(&nrows, g->labels[l]->grb_matrix);
+	ASSERT_EQ(nrows, Graph_RequiredMatrixDim(g));
+
+	Graph_FlushAllPending(g);
+	Graph_ReleaseLock(g);
+
+	GrB_Matrix_nrows(&nrows, Graph_GetLabelMatrix(g, l));
+	ASSERT_EQ(nrows, 6);
+
+	// Clean up.
+	Graph_Free(g);
+}
+
+TEST_F(GraphTest, MatrixSparsity) {
+	Node n;
+	Edge e;
+	int sparsity;
+	GrB_Index node_count = 1024;
+	Graph *g = Graph_New(node_count, node_count);
+
+	Graph_AcquireWriteLock(g);
+	int r = Graph_AddRelationType(g);
+	for(GrB_Index i = 0; i < node_count; i++) Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+	Graph_ConnectNodes(g, 0, 1, r, &e);
+	Graph_ConnectNodes(g, 0, 2, r, &e);
+	Graph_FlushAllPending(g);
+	Graph_ReleaseLock(g);
+
+	// nearly empty relation is hypersparse
+	GrB_Matrix M = Graph_GetRelationMatrix(g, r);
+	GxB_Matrix_Option_get(M, GxB_SPARSITY_STATUS, &sparsity);
+	ASSERT_EQ(sparsity, GxB_HYPERSPARSE);
+
+	// hypersparse relations are iterated by row
+	Edge *edges = (Edge *)array_new(Edge, 2);
+	Graph_GetNode(g, 0, &n);
+	Graph_GetNodeEdges(g, &n, GRAPH_EDGE_DIR_OUTGOING, r, &edges);
+	ASSERT_EQ(array_len(edges), 2);
+	array_clear(edges);
+
+	Graph_GetNode(g, 1, &n);
+	Graph_GetNodeEdges(g, &n, GRAPH_EDGE_DIR_OUTGOING, r, &edges);
+	ASSERT_EQ(array_len(edges), 0);
+	array_free(edges);
+
+	// relation turns sparse once it holds an edge per node
+	Graph_AcquireWriteLock(g);
+	for(GrB_Index i = 1; i < node_count - 1; i++) Graph_ConnectNodes(g, i, i + 1, r, &e);
+	Graph_FlushAllPending(g);
+	Graph_ReleaseLock(g);
+
+	M = Graph_GetRelationMatrix(g, r);
+	GxB_Matrix_Option_get(M, GxB_SPARSITY_STATUS, &sparsity);
+	ASSERT_EQ(sparsity, GxB_SPARSE);
+
+	Graph_Free(g);
+}
+
+TEST_F(GraphTest, BulkFormConnections) {
+	Node n;
+	Edge e;
+	GrB_Index nvals;
+	Graph *g = Graph_New(8, 8);
+
+	Graph_AcquireWriteLock(g);
+	int r = Graph_AddRelationType(g);
+	for(int i = 0; i < 4; i++) Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+
+	// an existing connection, merged with the bulk connections
+	Graph_ConnectNodes(g, 0, 1, r, &e);
+
+	// 0->1 twice, 1->2, 2->3
+	GrB_Index src[4] = {0, 0, 1, 2};
+	GrB_Index dest[4] = {1, 1, 2, 3};
+	EdgeID ids[4];
+	for(int i = 0; i < 4; i++) {
+		Graph_CreateEdge(g, src[i], dest[i], r, &e);
+		ids[i] = e.id;
+	}
+
+	Graph_BulkFormConnections(g, r, src, dest, ids, 4);
+	Graph_BulkConnectAdjacency(g, src, dest, 4);
+	Graph_ReleaseLock(g);
+
+	GrB_Matrix_nvals(&nvals, Graph_GetRelationMatrix(g, r));
+	ASSERT_EQ(nvals, 3);
+	GrB_Matrix_nvals(&nvals, Graph_GetTransposedRelationMatrix(g, r));
+	ASSERT_EQ(nvals, 3);
+	GrB_Matrix_nvals(&nvals, Graph_GetAdjacencyMatrix(g));
+	ASSERT_EQ(nvals, 3);
+	GrB_Matrix_nvals(&nvals, Graph_GetTransposedAdjacencyMatrix(g));
+	ASSERT_EQ(nvals, 3);
+
+	// multi-edge entries hold both the existing and the bulk edges
+	Edge *edges = (Edge *)array_new(Edge, 4);
+	Graph_GetEdgesConnectingNodes(g, 0, 1, r, &edges);
+	ASSERT_EQ(array_len(edges), 3);
+	array_clear(edges);
+
+	Graph_GetEdgesConnectingNodes(g, 1, 2, r, &edges);
+	ASSERT_EQ(array_len(edges), 1);
+	ASSERT_EQ(edges[0].id, ids[2]);
+	array_clear(edges);
+
+	Graph_GetEdgesConnectingNodes(g, 1, 0, r, &edges);
+	ASSERT_EQ(array_len(edges), 0);
+
+	array_free(edges);
+	Graph_Free(g);
+}
+
+TEST_F(GraphTest, FreezeRelations) {
+	Node n;
+	Edge e;
+	GrB_Index nvals;
+	Graph *g = Graph_New(8, 8);
+
+	Graph_AcquireWriteLock(g);
+	int r = Graph_AddRelationType(g);
+	for(int i = 0; i < 4; i++) Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+
+	// 0->1 three times, 1->2, 1->3
+	EdgeID ids[5];
+	GrB_Index src[5] = {0, 0, 0, 1, 1};
+	GrB_Index dest[5] = {1, 1, 1, 2, 3};
+	for(int i = 0; i < 5; i++) {
+		Graph_ConnectNodes(g, src[i], dest[i], r, &e);
+		ids[i] = e.id;
+	}
+	Graph_FlushAllPending(g);
+	Graph_ReleaseLock(g);
+
+	Graph_FreezeRelations(g);
+	ASSERT_TRUE(Graph_RelationFrozen(g, r));
+	ASSERT_EQ(g->relations[r]->grb_matrix, (GrB_Matrix)NULL);
+	ASSERT_EQ(Graph_RelationEdgeCount(g, r), 3);
+
+	// neighbour lookups read the frozen relation
+	Edge *edges = (Edge *)array_new(Edge, 4);
+	Graph_GetEdgesConnectingNodes(g, 0, 1, r, &edges);
+	ASSERT_EQ(array_len(edges), 3);
+	for(int i = 0; i < 3; i++) ASSERT_EQ(edges[i].id, ids[i]);
+	array_clear(edges);
+
+	Graph_GetEdgesConnectingNodes(g, 1, 0, r, &edges);
+	ASSERT_EQ(array_len(edges), 0);
+
+	Graph_GetNode(g, 1, &n);
+	Graph_GetNodeEdges(g, &n, GRAPH_EDGE_DIR_OUTGOING, r, &edges);
+	ASSERT_EQ(array_len(edges), 2);
+	ASSERT_EQ(edges[0].destNodeID, 2);
+	ASSERT_EQ(edges[0].id, ids[3]);
+	ASSERT_EQ(edges[1].destNodeID, 3);
+	ASSERT_EQ(edges[1].id, ids[4]);
+	array_clear(edges);
+
+	Graph_GetEdge(g, ids[4], &e);
+	e.srcNodeID = 1;
+	e.destNodeID = 3;
+	ASSERT_EQ(Graph_GetEdgeRelation(g, &e), r);
+	ASSERT_TRUE(g->relations[r]->grb_matrix == NULL);
+
+	// readers thaw the relation, keeping its frozen copy
+	GrB_Matrix_nvals(&nvals, Graph_GetRelationMatrix(g, r));
+	ASSERT_EQ(nvals, 3);
+	ASSERT_TRUE(Graph_RelationFrozen(g, r));
+
+	// writers discard the frozen copy
+	Graph_AcquireWriteLock(g);
+	Graph_ConnectNodes(g, 3, 0, r, &e);
+	Graph_FlushAllPending(g);
+	Graph_ReleaseLock(g);
+	ASSERT_FALSE(Graph_RelationFrozen(g, r));
+
+	GrB_Matrix_nvals(&nvals, Graph_GetRelationMatrix(g, r));
+	ASSERT_EQ(nvals, 4);
+	Graph_GetEdgesConnectingNodes(g, 0, 1, r, &edges);
+	ASSERT_EQ(array_len(edges), 3);
+
+	// relations can be frozen again, and freed while frozen
+	Graph_FreezeRelations(g);
+	ASSERT_TRUE(Graph_RelationFrozen(g, r));
+	ASSERT_EQ(Graph_RelationEdgeCount(g, r), 4);
+
+	array_free(edges);
+	Graph_Free(g);
+}
+
+TEST_F(GraphTest, MultiEdgeRuns) {
+	Node n;
+	Edge e;
+	Graph *g = Graph_New(8, 8);
+	const uint edge_count = 100;
+	Edge edges_0_1[edge_count];
+
+	Graph_AcquireWriteLock(g);
+	int r = Graph_AddRelationType(g);
+	for(int i = 0; i < 3; i++) Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+
+	// many parallel edges 0->1, interleaved with a pair of edges 1->2
+	for(uint i = 0; i < edge_count; i++) {
+		Graph_ConnectNodes(g, 0, 1, r, edges_0_1 + i);
+		if(i < 2) Graph_ConnectNodes(g, 1, 2, r, &e);
+	}
+	Graph_FlushAllPending(g);
+
+	ASSERT_EQ(Graph_RelationEdgeCount(g, r), 2);
+	ASSERT_EQ(Graph_RelationEdgeTotal(g, r), edge_count + 2);
+	ASSERT_EQ(MultiEdgeTable_RunCount(g->relations[r]->multi_edges), 2);
+
+	// transposed matrix shares the relation's runs
+	EdgeID entry;
+	EdgeID t_entry;
+	GrB_Matrix_extractElement_UINT64(&entry, Graph_GetRelationMatrix(g, r), 0, 1);
+	GrB_Matrix_extractElement_UINT64(&t_entry, Graph_GetTransposedRelationMatrix(g, r), 1, 0);
+	ASSERT_FALSE(SINGLE_EDGE(entry));
+	ASSERT_EQ(entry, t_entry);
+
+	Edge *edges = (Edge *)array_new(Edge, edge_count);
+	Graph_GetEdgesConnectingNodes(g, 0, 1, r, &edges);
+	ASSERT_EQ(array_len(edges), edge_count);
+	for(uint i = 0; i < edge_count; i++) {
+		ASSERT_EQ(edges[i].id, edges_0_1[i].id);
+		ASSERT_EQ(edges[i].srcNodeID, 0);
+		ASSERT_EQ(edges[i].destNodeID, 1);
+		ASSERT_EQ(edges[i].relationID, r);
+	}
+	array_clear(edges);
+
+	// delete all but one of the parallel edges
+	Graph_DeleteEdge(g, edges_0_1);
+	uint node_deleted = 0;
+	uint edge_deleted = 0;
+	Graph_BulkDelete(g, NULL, 0, edges_0_1 + 1, edge_count - 2, &node_deleted, &edge_deleted);
+	Graph_FlushAllPending(g);
+
+	// remaining edge reverts back to a single edge entry
+	GrB_Matrix_extractElement_UINT64(&entry, Graph_GetRelationMatrix(g, r), 0, 1);
+	GrB_Matrix_extractElement_UINT64(&t_entry, Graph_GetTransposedRelationMatrix(g, r), 1, 0);
+	ASSERT_TRUE(SINGLE_EDGE(entry));
+	ASSERT_EQ(SINGLE_EDGE_ID(entry), edges_0_1[edge_count - 1].id);
+	ASSERT_EQ(entry, t_entry);
+	ASSERT_EQ(MultiEdgeTable_RunCount(g->relations[r]->multi_edges), 1);
+	ASSERT_EQ(Graph_RelationEdgeTotal(g, r), 3);
+
+	// deleting a node releases the runs of its edges
+	Graph_GetNode(g, 2, &n);
+	Graph_BulkDelete(g, &n, 1, NULL, 0, &node_deleted, &edge_deleted);
+	Graph_FlushAllPending(g);
+	ASSERT_EQ(MultiEdgeTable_RunCount(g->relations[r]->multi_edges), 0);
+	ASSERT_EQ(Graph_RelationEdgeTotal(g, r), 1);
+	Graph_ReleaseLock(g);
+
+	array_free(edges);
+	Graph_Free(g);
+}
+
+TEST_F(GraphTest, EdgeRecords) {
+	Node n;
+	Edge e;
+	Graph *g = Graph_New(8, 8);
+
+	Graph_AcquireWriteLock(g);
+	int r = Graph_AddRelationType(g);
+	int s = Graph_AddRelationType(g);
+	for(int i = 0; i < 3; i++) Graph_CreateNode(g, GRAPH_NO_LABEL, &n);
+
+	// 0-[r]->1, 1-[s]->2, 2-[r]->0
+	EdgeID ids[3];
+	GrB_Index src[3] = {0, 1, 2};
+	GrB_Index dest[3] = {1, 2, 0};
+	int rel[3] = {r, s, r};
+	for(int i = 0; i < 3; i++) {
+		Graph_ConnectNodes(g, src[i], dest[i], rel[i], &e);
+		ids[i] = e.id;
+	}
+
+	// edges are resolved by ID alone
+	for(int i = 0; i < 3; i++) {
+		Edge x = {0};
+		ASSERT_TRUE(Graph_GetEdge(g, ids[i], &x));
+		ASSERT_EQ(Edge_GetSrcNodeID(&x), src[i]);
+		ASSERT_EQ(Edge_GetDestNodeID(&x), dest[i]);
+		ASSERT_EQ(Edge_GetRelationID(&x), rel[i]);
+		ASSERT_EQ(Graph_GetEdgeRelation(g, &x), rel[i]);
+	}
+
+	// relabeling nodes rewrites edge endpoints, node 2 becomes node 0
+	NodeID order[3] = {2, 0, 1};
+	Graph_PermuteNodes(g, order);
+	ASSERT_TRUE(Graph_GetEdge(g, ids[0], &e));
+	ASSERT_EQ(Edge_GetSrcNodeID(&e), 1);
+	ASSERT_EQ(Edge_GetDestNodeID(&e), 2);
+	ASSERT_TRUE(Graph_GetEdge(g, ids[2], &e));
+	ASSERT_EQ(Edge_GetSrcNodeID(&e), 0);
+	ASSERT_EQ(Edge_GetDestNodeID(&e), 1);
+
+	// deleting an edge located by its ID only
+	Edge x = {0};
+	x.id = ids[1];
+	x.entity = (Entity *)DataBlock_GetItem(g->edges, ids[1]);
+	ASSERT_EQ(Graph_DeleteEdge(g, &x), 1);
+	ASSERT_EQ(Graph_EdgeCount(g), 2);
+	ASSERT_FALSE(Graph_GetEdge(g, ids[1], &e));
+	ASSERT_FALSE(Graph_EdgeExists(g, 2, 0, s));
+
+	Graph_ReleaseLock(g);
+	Graph_Free(g);
+}
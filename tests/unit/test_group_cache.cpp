@@ -0,0 +1,79 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/value.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/grouping/group_cache.h"
+#ifdef __cplusplus
+}
+#endif
+
+class GroupCacheTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+
+	static Group *_newGroup(SIValue a, SIValue b) {
+		SIValue *keys = (SIValue *)rm_malloc(sizeof(SIValue) * 2);
+		keys[0] = SI_CloneValue(a);
+		keys[1] = SI_CloneValue(b);
+		return NewGroup(keys, 2, NULL, 0, NULL);
+	}
+};
+
+TEST_F(GroupCacheTest, AddGet) {
+	const int n = 10000;
+	CacheGroup *groups = CacheGroupNew();
+
+	for(int i = 0; i < n; i++) {
+		SIValue keys[2] = {SI_LongVal(i % 100), SI_LongVal(i / 100)};
+		XXH64_hash_t hash = CacheGroupHash(keys, 2);
+		ASSERT_TRUE(CacheGroupGet(groups, hash, keys, 2) == NULL);
+		CacheGroupAdd(groups, hash, _newGroup(keys[0], keys[1]));
+	}
+	ASSERT_EQ(CacheGroupCount(groups), n);
+
+	for(int i = 0; i < n; i++) {
+		SIValue keys[2] = {SI_LongVal(i % 100), SI_LongVal(i / 100)};
+		XXH64_hash_t hash = CacheGroupHash(keys, 2);
+		Group *g = CacheGroupGet(groups, hash, keys, 2);
+		ASSERT_TRUE(g != NULL);
+		ASSERT_EQ(g->keys[0].longval, i % 100);
+		ASSERT_EQ(g->keys[1].longval, i / 100);
+	}
+
+	// integers and equal doubles share a group
+	SIValue keys[2] = {SI_DoubleVal(5), SI_LongVal(7)};
+	XXH64_hash_t hash = CacheGroupHash(keys, 2);
+	ASSERT_TRUE(CacheGroupGet(groups, hash, keys, 2) != NULL);
+
+	// strings and integers do not
+	char *str = (char *)"5";
+	keys[0] = SI_ConstStringVal(str);
+	hash = CacheGroupHash(keys, 2);
+	ASSERT_TRUE(CacheGroupGet(groups, hash, keys, 2) == NULL);
+
+	// groups are iterated in creation order
+	int i = 0;
+	Group *g;
+	CacheGroupIterator *it = CacheGroupIter(groups);
+	while(CacheGroupIterNext(it, &g)) {
+		ASSERT_EQ(g->keys[0].longval, i % 100);
+		ASSERT_EQ(g->keys[1].longval, i / 100);
+		i++;
+	}
+	ASSERT_EQ(i, n);
+	CacheGroupIterator_Free(it);
+
+	FreeGroupCache(groups);
+}
@@ -43,9 +43,7 @@ class IndexTest: public ::testing::Test {
 		gc->g = _build_test_graph();
 		gc->index_count = 0;
 		gc->graph_name = strdup("G");
-		gc->attributes = raxNew();
-		pthread_rwlock_init(&gc->_attribute_rwlock, NULL);
-		gc->string_mapping = (char **)array_new(char *, 64);
+		gc->attributes = AttributeTable_New();
 		gc->node_schemas = (Schema **)array_new(Schema *, GRAPH_DEFAULT_LABEL_CAP);
 		gc->relation_schemas = (Schema **)array_new(Schema *, GRAPH_DEFAULT_RELATION_TYPE_CAP);
 
@@ -73,7 +71,7 @@ class IndexTest: public ::testing::Test {
 TEST_F(IndexTest, Index_New) {
 	GraphContext *gc = QueryCtx_GetGraphCtx();
 	const char *l = "Person";
-	Index *idx = Index_New(l, IDX_EXACT_MATCH);
+	Index *idx = Index_New(l, IDX_EXACT_MATCH, GETYPE_NODE);
 
 	// Return indexed label.
 	const char *label = Index_GetLabel(idx);
@@ -0,0 +1,78 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/undirected.h"
+#include "../../src/algorithms/label_propagation.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class LabelPropagationTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+};
+
+TEST_F(LabelPropagationTest, Cliques) {
+	// two 4-cliques {0, 1, 2, 3} and {4, 5, 6, 7} bridged by 3->4
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_BOOL, 8, 8);
+	for(GrB_Index c = 0; c < 8; c += 4) {
+		for(GrB_Index i = c; i < c + 4; i++) {
+			for(GrB_Index j = i + 1; j < c + 4; j++) {
+				GrB_Matrix_setElement_BOOL(A, true, i, j);
+			}
+		}
+	}
+	GrB_Matrix_setElement_BOOL(A, true, 3, 4);
+
+	GrB_Matrix S;
+	GrB_Index *mapping;
+	ASSERT_EQ(Undirected(&S, &mapping, A, GrB_NULL), GrB_SUCCESS);
+
+	int iters;
+	GrB_Index *communities;
+	ASSERT_EQ(LabelPropagation(&communities, S, 20, &iters), GrB_SUCCESS);
+	ASSERT_LT(iters, 20);
+
+	for(int i = 1; i < 4; i++) ASSERT_EQ(communities[i], communities[0]);
+	for(int i = 5; i < 8; i++) ASSERT_EQ(communities[i], communities[4]);
+	ASSERT_NE(communities[0], communities[4]);
+
+	rm_free(communities);
+	GrB_Matrix_free(&S);
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(LabelPropagationTest, Isolated) {
+	// isolated nodes keep their own community
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_BOOL, 3, 3);
+
+	GrB_Matrix S;
+	GrB_Index *mapping;
+	ASSERT_EQ(Undirected(&S, &mapping, A, GrB_NULL), GrB_SUCCESS);
+
+	int iters;
+	GrB_Index *communities;
+	ASSERT_EQ(LabelPropagation(&communities, S, 20, &iters), GrB_SUCCESS);
+	ASSERT_EQ(iters, 1);
+	for(GrB_Index i = 0; i < 3; i++) ASSERT_EQ(communities[i], i);
+
+	rm_free(communities);
+	GrB_Matrix_free(&S);
+	GrB_Matrix_free(&A);
+}
@@ -155,6 +155,52 @@ TEST_F(MapTest, map_remove) {
 	Map_Free(map);
 }
 
+TEST_F(MapTest, map_sorted) {
+	SIValue map = Map_New(2);
+	uint n = MAP_SORTED_MIN_KEYS * 4;
+	char keys[n][16];
+
+	// add keys in descending order, map switches to sorted layout once large
+	for(int i = n - 1; i >= 0; i--) {
+		sprintf(keys[i], "key%03d", i);
+		Map_Add(&map, SI_ConstStringVal(keys[i]), SI_LongVal(i));
+	}
+	ASSERT_EQ(n, Map_KeyCount(map));
+	for(uint i = 1; i < n; i++) {
+		ASSERT_LT(strcmp(map.map[i - 1].key.stringval, map.map[i].key.stringval), 0);
+	}
+
+	// replace value
+	Map_Add(&map, SI_ConstStringVal(keys[7]), SI_LongVal(-7));
+	ASSERT_EQ(n, Map_KeyCount(map));
+
+	for(uint i = 0; i < n; i++) {
+		SIValue v;
+		ASSERT_TRUE(Map_Get(map, SI_ConstStringVal(keys[i]), &v));
+		ASSERT_EQ((i == 7) ? -7 : (int64_t)i, v.longval);
+	}
+	SIValue v;
+	ASSERT_FALSE(Map_Get(map, SI_ConstStringVal("key"), &v));
+	ASSERT_FALSE(Map_Get(map, SI_ConstStringVal("key999"), &v));
+
+	// remove every other key, order is maintained
+	for(uint i = 0; i < n; i += 2) Map_Remove(map, SI_ConstStringVal(keys[i]));
+	ASSERT_EQ(n / 2, Map_KeyCount(map));
+	for(uint i = 0; i < n; i++) {
+		ASSERT_EQ(i % 2 == 1, Map_Contains(map, SI_ConstStringVal(keys[i])));
+	}
+
+	// clones retain the sorted layout
+	SIValue clone = Map_Clone(map);
+	for(uint i = 1; i < n / 2; i++) {
+		ASSERT_LT(strcmp(clone.map[i - 1].key.stringval, clone.map[i].key.stringval), 0);
+	}
+	ASSERT_EQ(0, Map_Compare(map, clone, NULL));
+
+	Map_Free(clone);
+	Map_Free(map);
+}
+
 TEST_F(MapTest, map_tostring) {
 	SIValue  k;
 	SIValue  v;
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/graph/multi_edge_table.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class MultiEdgeTableTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+TEST_F(MultiEdgeTableTest, Runs) {
+	MultiEdgeTable *t = MultiEdgeTable_New();
+
+	EdgeID a_ids[2] = {1, 2};
+	EdgeID b_ids[3] = {10, 11, 12};
+	uint64_t a = MultiEdgeTable_NewRun(t, a_ids, 2);
+	uint64_t b = MultiEdgeTable_NewRun(t, b_ids, 3);
+	ASSERT_NE(a, b);
+	ASSERT_EQ(MultiEdgeTable_RunCount(t), 2);
+	ASSERT_EQ(t->edge_count, 5);
+
+	// grow run 'a' past its capacity, relocating it
+	for(EdgeID id = 3; id <= 100; id++) MultiEdgeTable_Append(t, a, id);
+
+	uint32_t count;
+	const EdgeID *ids = MultiEdgeTable_Run(t, a, &count);
+	ASSERT_EQ(count, 100);
+	for(uint32_t i = 0; i < count; i++) ASSERT_EQ(ids[i], i + 1);
+
+	// run 'b' is unaffected
+	ids = MultiEdgeTable_Run(t, b, &count);
+	ASSERT_EQ(count, 3);
+	for(uint32_t i = 0; i < count; i++) ASSERT_EQ(ids[i], b_ids[i]);
+
+	// removal migrates the last edge ID into the vacated slot
+	ASSERT_EQ(MultiEdgeTable_Remove(t, b, 10), 2);
+	ids = MultiEdgeTable_Run(t, b, &count);
+	ASSERT_EQ(ids[0], 12);
+	ASSERT_EQ(ids[1], 11);
+
+	// released run IDs are reused
+	MultiEdgeTable_ReleaseRun(t, b);
+	ASSERT_EQ(MultiEdgeTable_RunCount(t), 1);
+	ASSERT_EQ(t->edge_count, 100);
+	ASSERT_EQ(MultiEdgeTable_NewRun(t, b_ids, 2), b);
+
+	MultiEdgeTable_Clear(t);
+	ASSERT_EQ(MultiEdgeTable_RunCount(t), 0);
+	ASSERT_EQ(t->edge_count, 0);
+
+	MultiEdgeTable_Free(t);
+}
+
+TEST_F(MultiEdgeTableTest, Compaction) {
+	MultiEdgeTable *t = MultiEdgeTable_New();
+
+	// interleave the growth of many runs, leaving garbage behind
+	const uint run_count = 64;
+	uint64_t runs[run_count];
+	for(uint i = 0; i < run_count; i++) {
+		EdgeID ids[2] = {i * 1000, i * 1000 + 1};
+		runs[i] = MultiEdgeTable_NewRun(t, ids, 2);
+	}
+
+	for(uint j = 2; j < 50; j++) {
+		for(uint i = 0; i < run_count; i++) {
+			MultiEdgeTable_Append(t, runs[i], i * 1000 + j);
+		}
+	}
+
+	for(uint i = 0; i < run_count; i++) {
+		uint32_t count;
+		const EdgeID *ids = MultiEdgeTable_Run(t, runs[i], &count);
+		ASSERT_EQ(count, 50);
+		for(uint32_t j = 0; j < count; j++) ASSERT_EQ(ids[j], i * 1000 + j);
+	}
+
+	MultiEdgeTable_Free(t);
+}
+
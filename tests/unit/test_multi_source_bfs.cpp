@@ -0,0 +1,92 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/multi_source_bfs.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class MultiSourceBFSTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+
+	// a chain 0->1->2->3 and a star 4->{5, 6, 7}
+	static GrB_Matrix _graph() {
+		GrB_Matrix A;
+		GrB_Matrix_new(&A, GrB_BOOL, 8, 8);
+		GrB_Matrix_setElement_BOOL(A, true, 0, 1);
+		GrB_Matrix_setElement_BOOL(A, true, 1, 2);
+		GrB_Matrix_setElement_BOOL(A, true, 2, 3);
+		GrB_Matrix_setElement_BOOL(A, true, 4, 5);
+		GrB_Matrix_setElement_BOOL(A, true, 4, 6);
+		GrB_Matrix_setElement_BOOL(A, true, 4, 7);
+		return A;
+	}
+
+	// returns the level of node i, -1 if unreached
+	static int64_t _level(GrB_Vector v, GrB_Index i) {
+		uint64_t level;
+		if(GrB_Vector_extractElement_UINT64(&level, v, i) != GrB_SUCCESS) {
+			return -1;
+		}
+		return level;
+	}
+};
+
+TEST_F(MultiSourceBFSTest, Levels) {
+	GrB_Matrix A = _graph();
+	GrB_Vector levels;
+	GrB_Vector parents;
+	GrB_Index sources[2] = {1, 4};
+
+	ASSERT_EQ(MultiSourceBFS(&levels, &parents, A, sources, 2, 0, 0),
+			  GrB_SUCCESS);
+	int64_t expected[8] = {-1, 0, 1, 2, 0, 1, 1, 1};
+	for(GrB_Index i = 0; i < 8; i++) ASSERT_EQ(_level(levels, i), expected[i]);
+
+	// sources have no parent
+	int64_t expected_parents[8] = {-1, -1, 1, 2, -1, 4, 4, 4};
+	for(GrB_Index i = 0; i < 8; i++) {
+		ASSERT_EQ(_level(parents, i), expected_parents[i]);
+	}
+
+	GrB_Vector_free(&levels);
+	GrB_Vector_free(&parents);
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(MultiSourceBFSTest, MaxLevelAndCap) {
+	GrB_Matrix A = _graph();
+	GrB_Vector levels;
+	GrB_Index sources[2] = {0, 4};
+
+	// a single level
+	ASSERT_EQ(MultiSourceBFS(&levels, NULL, A, sources, 2, 1, 0), GrB_SUCCESS);
+	int64_t expected[8] = {0, 1, -1, -1, 0, 1, 1, 1};
+	for(GrB_Index i = 0; i < 8; i++) ASSERT_EQ(_level(levels, i), expected[i]);
+	GrB_Vector_free(&levels);
+
+	// at most two nodes per level, smallest IDs first
+	ASSERT_EQ(MultiSourceBFS(&levels, NULL, A, sources, 2, 0, 2), GrB_SUCCESS);
+	int64_t expected_capped[8] = {0, 1, 2, 3, 0, 1, -1, -1};
+	for(GrB_Index i = 0; i < 8; i++) {
+		ASSERT_EQ(_level(levels, i), expected_capped[i]);
+	}
+	GrB_Vector_free(&levels);
+
+	GrB_Matrix_free(&A);
+}
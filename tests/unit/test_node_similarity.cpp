@@ -0,0 +1,121 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/arr.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/node_similarity.h"
+#include <math.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+class NodeSimilarityTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+
+	// users 0, 1 and 2 bought items 3, 4 and 5
+	// 0->{3, 4}, 1->{3, 4, 5}, 2->{5}
+	static GrB_Matrix _graph() {
+		GrB_Matrix A;
+		GrB_Matrix_new(&A, GrB_BOOL, 6, 6);
+		GrB_Matrix_setElement_BOOL(A, true, 0, 3);
+		GrB_Matrix_setElement_BOOL(A, true, 0, 4);
+		GrB_Matrix_setElement_BOOL(A, true, 1, 3);
+		GrB_Matrix_setElement_BOOL(A, true, 1, 4);
+		GrB_Matrix_setElement_BOOL(A, true, 1, 5);
+		GrB_Matrix_setElement_BOOL(A, true, 2, 5);
+		return A;
+	}
+
+	static void _validate(SimilarityPair *pairs, const SimilarityPair *expected,
+						  uint count) {
+		ASSERT_EQ(array_len(pairs), count);
+		for(uint i = 0; i < count; i++) {
+			ASSERT_EQ(pairs[i].src, expected[i].src);
+			ASSERT_EQ(pairs[i].dest, expected[i].dest);
+			ASSERT_DOUBLE_EQ(pairs[i].similarity, expected[i].similarity);
+		}
+	}
+};
+
+TEST_F(NodeSimilarityTest, Metrics) {
+	GrB_Matrix A = _graph();
+	SimilarityPair *pairs;
+
+	// 0 and 2 share no item and aren't reported
+	SimilarityPair jaccard[4] = {{0, 1, 2.0 / 3}, {1, 0, 2.0 / 3}, {1, 2, 1.0 / 3},
+		{2, 1, 1.0 / 3}};
+	ASSERT_EQ(NodeSimilarity(&pairs, A, SIMILARITY_JACCARD, 0, 0), GrB_SUCCESS);
+	_validate(pairs, jaccard, 4);
+	array_free(pairs);
+
+	// ties are ordered by node
+	SimilarityPair overlap[4] = {{0, 1, 1}, {1, 0, 1}, {1, 2, 1}, {2, 1, 1}};
+	ASSERT_EQ(NodeSimilarity(&pairs, A, SIMILARITY_OVERLAP, 0, 0), GrB_SUCCESS);
+	_validate(pairs, overlap, 4);
+	array_free(pairs);
+
+	SimilarityPair cosine[4] = {{0, 1, 2 / sqrt(6)}, {1, 0, 2 / sqrt(6)},
+		{1, 2, 1 / sqrt(3)}, {2, 1, 1 / sqrt(3)}};
+	ASSERT_EQ(NodeSimilarity(&pairs, A, SIMILARITY_COSINE, 0, 0), GrB_SUCCESS);
+	_validate(pairs, cosine, 4);
+	array_free(pairs);
+
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(NodeSimilarityTest, TopKAndCutoff) {
+	GrB_Matrix A = _graph();
+	SimilarityPair *pairs;
+
+	// only the most similar node of each node
+	SimilarityPair top[3] = {{0, 1, 2.0 / 3}, {1, 0, 2.0 / 3}, {2, 1, 1.0 / 3}};
+	ASSERT_EQ(NodeSimilarity(&pairs, A, SIMILARITY_JACCARD, 1, 0), GrB_SUCCESS);
+	_validate(pairs, top, 3);
+	array_free(pairs);
+
+	SimilarityPair cutoff[2] = {{0, 1, 2.0 / 3}, {1, 0, 2.0 / 3}};
+	ASSERT_EQ(NodeSimilarity(&pairs, A, SIMILARITY_JACCARD, 0, 0.5), GrB_SUCCESS);
+	_validate(pairs, cutoff, 2);
+	array_free(pairs);
+
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(NodeSimilarityTest, Blocks) {
+	// nodes 2k - 1 and 2k share item k, pairs straddle blocks of rows
+	const GrB_Index n = 2 * NODE_SIMILARITY_BLOCK_SIZE + 3;
+	const GrB_Index dim = n + (n + 1) / 2;
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_BOOL, dim, dim);
+	for(GrB_Index i = 0; i < n; i++) {
+		GrB_Matrix_setElement_BOOL(A, true, i, n + (i + 1) / 2);
+	}
+
+	// node 0 has no similar node
+	SimilarityPair *pairs;
+	ASSERT_EQ(NodeSimilarity(&pairs, A, SIMILARITY_JACCARD, 0, 0), GrB_SUCCESS);
+	ASSERT_EQ(array_len(pairs), n - 1);
+	for(GrB_Index i = 0; i < n - 1; i++) {
+		GrB_Index src = i + 1;
+		ASSERT_EQ(pairs[i].src, src);
+		ASSERT_EQ(pairs[i].dest, (src % 2) ? src + 1 : src - 1);
+		ASSERT_DOUBLE_EQ(pairs[i].similarity, 1);
+	}
+	array_free(pairs);
+
+	GrB_Matrix_free(&A);
+}
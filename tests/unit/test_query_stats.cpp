@@ -0,0 +1,69 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/util/rmalloc.h"
+#include "../../src/slow_log/query_stats.h"
+#ifdef __cplusplus
+}
+#endif
+
+class QueryStatsTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+
+	static void _expectNormalized(const char *query, const char *expected) {
+		char *normalized = QueryStats_Normalize(query);
+		ASSERT_STREQ(normalized, expected);
+		rm_free(normalized);
+	}
+};
+
+TEST_F(QueryStatsTest, Normalize) {
+	_expectNormalized("MATCH (n) RETURN n", "MATCH (n) RETURN n");
+	// whitespace is collapsed
+	_expectNormalized("  MATCH   (n)\n\tRETURN n ", "MATCH (n) RETURN n");
+	// numeric literals
+	_expectNormalized("MATCH (n) WHERE n.v = 12 AND n.w > 1.5e-3 RETURN n LIMIT 10",
+					  "MATCH (n) WHERE n.v = ? AND n.w > ? RETURN n LIMIT ?");
+	// string literals, including escaped quotes
+	_expectNormalized("CREATE (:L {a: 'it\\'s', b: \"x\"})", "CREATE (:L {a: ?, b: ?})");
+	// digits within identifiers are kept
+	_expectNormalized("MATCH (n1:L2) RETURN n1.v3", "MATCH (n1:L2) RETURN n1.v3");
+	// escaped identifiers are kept
+	_expectNormalized("MATCH (`a 1`) RETURN `a 1`", "MATCH (`a 1`) RETURN `a 1`");
+}
+
+TEST_F(QueryStatsTest, Aggregate) {
+	QueryStats *stats = QueryStats_New();
+
+	QueryStats_Add(stats, "MATCH (n {v: 1}) RETURN n", 2, 1, false, 0);
+	QueryStats_Add(stats, "MATCH (n {v: 2}) RETURN n", 4, 3, true, 1);
+	ASSERT_EQ(QueryStats_Count(stats), 1);
+
+	QueryStats_Add(stats, "MATCH (n) RETURN n", 1, 0, false, 0);
+	ASSERT_EQ(QueryStats_Count(stats), 2);
+
+	// registry is bounded
+	char query[64];
+	for(int i = 0; i < QUERY_STATS_SIZE + 10; i++) {
+		snprintf(query, sizeof(query), "MATCH (n:L%d) RETURN n", i);
+		QueryStats_Add(stats, query, 1, 0, false, 0);
+	}
+	ASSERT_EQ(QueryStats_Count(stats), QUERY_STATS_SIZE);
+
+	QueryStats_Reset(stats);
+	ASSERT_EQ(QueryStats_Count(stats), 0);
+
+	QueryStats_Free(stats);
+}
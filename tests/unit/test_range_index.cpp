@@ -0,0 +1,257 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/util/arr.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/index/range_index.h"
+#include <math.h>
+#ifdef __cplusplus
+}
+#endif
+
+class RangeIndexTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+
+	static NumericRange _range(double min, bool include_min, double max,
+			bool include_max) {
+		NumericRange r;
+		r.min = min;
+		r.max = max;
+		r.include_min = include_min;
+		r.include_max = include_max;
+		r.valid = true;
+		return r;
+	}
+};
+
+TEST_F(RangeIndexTest, Query) {
+	RangeIndex *ri = RangeIndex_New();
+	// insert keys in reverse order, node i holds key i % 10
+	for(int i = 99; i >= 0; i--) RangeIndex_Insert(ri, i, i % 10);
+	RangeIndex_Flush(ri);
+	ASSERT_EQ(RangeIndex_Count(ri), 100);
+
+	// [3, 3]
+	NumericRange r = _range(3, true, 3, true);
+	NodeID *ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), 10);
+	// ids are reported in ascending order
+	for(uint i = 0; i < 10; i++) ASSERT_EQ(ids[i], i * 10 + 3);
+	array_free(ids);
+
+	// (3, 5)
+	r = _range(3, false, 5, false);
+	ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), 10);
+	for(uint i = 0; i < 10; i++) ASSERT_EQ(ids[i], i * 10 + 4);
+	array_free(ids);
+
+	// (-inf, 1]
+	r = _range(-INFINITY, false, 1, true);
+	ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), 20);
+	array_free(ids);
+
+	// (8, inf)
+	r = _range(8, false, INFINITY, false);
+	ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), 10);
+	array_free(ids);
+
+	// (5, 5) is empty
+	r = _range(5, false, 5, false);
+	ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), 0);
+	array_free(ids);
+
+	RangeIndex_Free(ri);
+}
+
+TEST_F(RangeIndexTest, Modifications) {
+	const uint n = 10000;
+	double values[n];
+	RangeIndex *ri = RangeIndex_New();
+
+	for(uint i = 0; i < n; i++) {
+		values[i] = i % 100;
+		RangeIndex_Insert(ri, i, values[i]);
+	}
+	RangeIndex_Flush(ri);
+
+	// mix updates, removals and insertions
+	// crossing the pending insertions threshold several times
+	srand(7);
+	for(uint i = 0; i < 5 * RANGE_INDEX_DELTA_CAP; i++) {
+		NodeID id = rand() % n;
+		if(rand() % 3 == 0) {
+			values[id] = NAN;
+			RangeIndex_Remove(ri, id);
+		} else {
+			values[id] = rand() % 100;
+			RangeIndex_Insert(ri, id, values[id]);
+		}
+
+		if(i % 1000 != 0) continue;
+
+		// compare against a full scan
+		double min = rand() % 100;
+		double max = min + rand() % 20;
+		NumericRange r = _range(min, i % 2, max, i % 3);
+		NodeID *ids = RangeIndex_Query(ri, &r);
+
+		uint matches = 0;
+		for(uint j = 0; j < n; j++) {
+			double v = values[j];
+			if(isnan(v)) continue;
+			if(r.include_min ? v < min : v <= min) continue;
+			if(r.include_max ? v > max : v >= max) continue;
+			ASSERT_LT(matches, array_len(ids));
+			ASSERT_EQ(ids[matches], j);
+			matches++;
+		}
+		ASSERT_EQ(matches, array_len(ids));
+		array_free(ids);
+	}
+
+	RangeIndex_Free(ri);
+}
+TEST_F(RangeIndexTest, DeferredMerges) {
+	const uint n = 3 * RANGE_INDEX_DELTA_CAP;
+	RangeIndex *ri = RangeIndex_New();
+
+	// merges are deferred throughout the initial loading phase
+	RangeIndex_DeferMerges(ri);
+	RangeIndex_Insert(ri, 0, 0);
+	RangeIndex_ResumeMerges(ri);
+	ASSERT_TRUE(ri->loading);
+	RangeIndex_Flush(ri);
+
+	// a batch of insertions is merged once
+	RangeIndex_DeferMerges(ri);
+	for(uint i = 1; i < n; i++) RangeIndex_Insert(ri, i, i % 7);
+	ASSERT_EQ(array_len(ri->run), 1);
+	ASSERT_EQ(array_len(ri->delta), n - 1);
+
+	// pending insertions are reported
+	NumericRange r = _range(3, true, 3, true);
+	NodeID *ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), n / 7);
+	array_free(ids);
+
+	RangeIndex_ResumeMerges(ri);
+	ASSERT_FALSE(ri->loading);
+	ASSERT_EQ(array_len(ri->run), n);
+	ASSERT_EQ(array_len(ri->delta), 0);
+
+	// a small batch remains pending
+	RangeIndex_DeferMerges(ri);
+	RangeIndex_Insert(ri, n, 3);
+	RangeIndex_ResumeMerges(ri);
+	ASSERT_EQ(array_len(ri->delta), 1);
+
+	ids = RangeIndex_Query(ri, &r);
+	ASSERT_EQ(array_len(ids), n / 7 + 1);
+	ASSERT_EQ(ids[array_len(ids) - 1], n);
+	array_free(ids);
+
+	RangeIndex_Free(ri);
+}
+
+
+TEST_F(RangeIndexTest, Extremes) {
+	RangeIndex *ri = RangeIndex_New();
+	NodeID id;
+	ASSERT_FALSE(RangeIndex_Extreme(ri, false, &id));
+
+	for(uint i = 0; i < 100; i++) RangeIndex_Insert(ri, i, (double)i - 50);
+	RangeIndex_Flush(ri);
+
+	// pending insertions take part
+	RangeIndex_Insert(ri, 100, 75);
+	ASSERT_TRUE(RangeIndex_Extreme(ri, false, &id));
+	ASSERT_EQ(id, 0);
+	ASSERT_TRUE(RangeIndex_Extreme(ri, true, &id));
+	ASSERT_EQ(id, 100);
+
+	// removed entries are skipped
+	RangeIndex_Remove(ri, 0);
+	RangeIndex_Remove(ri, 100);
+	ASSERT_TRUE(RangeIndex_Extreme(ri, false, &id));
+	ASSERT_EQ(id, 1);
+	ASSERT_TRUE(RangeIndex_Extreme(ri, true, &id));
+	ASSERT_EQ(id, 99);
+
+	// excluded nodes are tracked until they're indexed or removed
+	RangeIndex_Exclude(ri, 1);
+	RangeIndex_Insert(ri, 2, NAN);
+	ASSERT_EQ(RangeIndex_ExcludedCount(ri), 2);
+	ASSERT_EQ(RangeIndex_Count(ri), 97);
+	ASSERT_TRUE(RangeIndex_Extreme(ri, false, &id));
+	ASSERT_EQ(id, 3);
+
+	RangeIndex_Insert(ri, 1, -100);
+	RangeIndex_Remove(ri, 2);
+	ASSERT_EQ(RangeIndex_ExcludedCount(ri), 0);
+	ASSERT_TRUE(RangeIndex_Extreme(ri, false, &id));
+	ASSERT_EQ(id, 1);
+
+	RangeIndex_Free(ri);
+}
+
+TEST_F(RangeIndexTest, OrderedQuery) {
+	RangeIndex *ri = RangeIndex_New();
+	// node i holds key i % 10
+	for(uint i = 0; i < 100; i++) RangeIndex_Insert(ri, i, i % 10);
+	RangeIndex_Flush(ri);
+
+	// pending insertions and removed entries take part
+	RangeIndex_Insert(ri, 100, 4.5);
+	RangeIndex_Insert(ri, 101, 2);
+	RangeIndex_Remove(ri, 13);
+
+	// expected (key, id) order within [2, 5)
+	NodeID expected[100];
+	uint n = 0;
+	for(uint k = 2; k < 5; k++) {
+		for(uint i = 0; i < 102; i++) {
+			if(i == 13) continue;
+			double key = (i == 100) ? 4.5 : (i == 101) ? 2 : i % 10;
+			if(key == k || (k == 4 && key == 4.5)) expected[n++] = i;
+		}
+	}
+	// 4.5 follows every node holding 4
+	ASSERT_EQ(expected[n - 1], 100);
+
+	NumericRange r = _range(2, true, 5, false);
+	for(int desc = 0; desc < 2; desc++) {
+		// consume range in pages of 7 nodes
+		uint count = 0;
+		NodeID *page = RangeIndex_QueryOrdered(ri, &r, desc, NULL, 7);
+		while(array_len(page) > 0) {
+			for(uint i = 0; i < array_len(page); i++) {
+				NodeID e = desc ? expected[n - 1 - count] : expected[count];
+				ASSERT_EQ(page[i], e);
+				count++;
+			}
+			NodeID last = page[array_len(page) - 1];
+			array_free(page);
+			page = RangeIndex_QueryOrdered(ri, &r, desc, &last, 7);
+		}
+		array_free(page);
+		ASSERT_EQ(count, n);
+	}
+
+	RangeIndex_Free(ri);
+}
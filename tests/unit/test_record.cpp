@@ -12,6 +12,7 @@ extern "C" {
 
 #include <stdio.h>
 #include "../../src/execution_plan/record.h"
+#include "../../src/execution_plan/record_pool.h"
 #include "../../src/util/rmalloc.h"
 #include "../../src/value.h"
 
@@ -59,3 +60,96 @@ TEST_F(RecordTest, RecordToString) {
 	Record_Free(r);
 }
 
+
+TEST_F(RecordTest, RecordPool) {
+	rax *_rax = raxNew();
+	for(int i = 0; i < 3; i++) {
+		char buf[2] = {(char)('a' + i), '\0'};
+		raxInsert(_rax, (unsigned char *)buf, 2, NULL, NULL);
+	}
+
+	RecordPool *pool = RecordPool_New(_rax);
+	int owner;
+
+	// Records span slabs, start on a cache line and come out empty.
+	uint count = RECORD_POOL_SLAB_CAP + 10;
+	Record records[count];
+	for(uint i = 0; i < count; i++) {
+		Record r = RecordPool_Borrow(pool, &owner);
+		ASSERT_EQ((uintptr_t)r % RECORD_POOL_ALIGNMENT, 0);
+		ASSERT_EQ(r->owner, &owner);
+		ASSERT_EQ(r->mapping, _rax);
+		for(uint j = 0; j < 3; j++) ASSERT_FALSE(Record_ContainsEntry(r, j));
+		Record_AddScalar(r, 0, SI_LongVal(i));
+		Record_AddScalar(r, 2, SI_DuplicateStringVal("value"));
+		records[i] = r;
+	}
+
+	// Records do not overlap.
+	for(uint i = 0; i < count; i++) {
+		ASSERT_EQ(Record_Get(records[i], 0).longval, i);
+	}
+
+	// Returned records are cleared and reused.
+	Record returned = records[5];
+	RecordPool_Return(pool, returned);
+	Record r = RecordPool_Borrow(pool, &owner);
+	ASSERT_EQ(r, returned);
+	for(uint j = 0; j < 3; j++) ASSERT_FALSE(Record_ContainsEntry(r, j));
+	records[5] = r;
+
+	for(uint i = 0; i < count; i++) RecordPool_Return(pool, records[i]);
+	RecordPool_Free(pool);
+	raxFree(_rax);
+}
+
+TEST_F(RecordTest, RecordShare) {
+	rax *_rax = raxNew();
+	for(int i = 0; i < 3; i++) {
+		char buf[2] = {(char)('a' + i), '\0'};
+		raxInsert(_rax, (unsigned char *)buf, 2, NULL, NULL);
+	}
+
+	RecordPool *pool = RecordPool_New(_rax);
+	int owner;
+
+	Record parent = RecordPool_Borrow(pool, &owner);
+	Record_AddScalar(parent, 0, SI_DuplicateStringVal("shared"));
+	Record_AddScalar(parent, 1, SI_LongVal(1));
+
+	// Shared entries are read from the parent.
+	Record shared = RecordPool_Borrow(pool, &owner);
+	Record_Share(parent, shared);
+	ASSERT_TRUE(Record_ContainsEntry(shared, 0));
+	ASSERT_FALSE(Record_ContainsEntry(shared, 2));
+	SIValue v = Record_Get(shared, 0);
+	ASSERT_EQ(strcmp(v.stringval, "shared"), 0);
+	ASSERT_EQ(v.allocation, M_VOLATILE);
+
+	// Writes don't modify the parent.
+	Record_AddScalar(shared, 1, SI_LongVal(2));
+	Record_AddScalar(shared, 2, SI_LongVal(3));
+	Record_Remove(shared, 0);
+	ASSERT_FALSE(Record_ContainsEntry(shared, 0));
+	ASSERT_EQ(Record_Get(shared, 1).longval, 2);
+	ASSERT_TRUE(Record_ContainsEntry(parent, 0));
+	ASSERT_EQ(Record_Get(parent, 1).longval, 1);
+	ASSERT_FALSE(Record_ContainsEntry(parent, 2));
+
+	// Clones don't share the parent.
+	Record clone = RecordPool_Borrow(pool, &owner);
+	Record_Clone(shared, clone);
+	ASSERT_EQ(clone->parent, (Record)NULL);
+	ASSERT_FALSE(Record_ContainsEntry(clone, 0));
+	ASSERT_EQ(Record_Get(clone, 2).longval, 3);
+	RecordPool_Return(pool, clone);
+
+	// The parent is kept alive by the record sharing it.
+	RecordPool_Return(pool, parent);
+	ASSERT_EQ(strcmp(Record_Get(parent, 0).stringval, "shared"), 0);
+	RecordPool_Return(pool, shared);
+	ASSERT_FALSE(Record_ContainsEntry(parent, 0));
+
+	RecordPool_Free(pool);
+	raxFree(_rax);
+}
@@ -0,0 +1,158 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/util/rmalloc.h"
+#include "../../src/util/sketch/hll.h"
+#include "../../src/util/sketch/tdigest.h"
+#include "../../src/util/sketch/histogram.h"
+#include <math.h>
+#ifdef __cplusplus
+}
+#endif
+
+class SketchTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+
+	// splitmix64 finalizer, spreads consecutive integers over 64 bits
+	static uint64_t _hash(uint64_t x) {
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+};
+
+TEST_F(SketchTest, HLLCount) {
+	HLL *hll = HLL_New();
+	ASSERT_EQ(HLL_Count(hll), 0);
+
+	// duplicates don't contribute
+	for(int i = 0; i < 3; i++) {
+		for(uint64_t j = 0; j < 100; j++) HLL_Add(hll, _hash(j));
+	}
+	// small cardinalities are estimated through linear counting
+	ASSERT_NEAR(HLL_Count(hll), 100, 1);
+
+	// switches to dense registers
+	for(uint64_t j = 100; j < 1000000; j++) HLL_Add(hll, _hash(j));
+	double err = fabs((double)HLL_Count(hll) - 1000000) / 1000000;
+	ASSERT_LT(err, 0.03);
+
+	HLL_Free(hll);
+}
+
+TEST_F(SketchTest, HLLMerge) {
+	HLL *a = HLL_New();
+	HLL *b = HLL_New();
+	HLL *sparse = HLL_New();
+
+	// overlapping ranges [0, 60000) and [40000, 100000)
+	for(uint64_t i = 0; i < 60000; i++) HLL_Add(a, _hash(i));
+	for(uint64_t i = 40000; i < 100000; i++) HLL_Add(b, _hash(i));
+	for(uint64_t i = 0; i < 10; i++) HLL_Add(sparse, _hash(i + 1000000));
+
+	HLL_Merge(a, b);
+	HLL_Merge(a, sparse);
+	double err = fabs((double)HLL_Count(a) - 100010) / 100010;
+	ASSERT_LT(err, 0.03);
+
+	// dense into sparse
+	HLL_Merge(sparse, b);
+	err = fabs((double)HLL_Count(sparse) - 60010) / 60010;
+	ASSERT_LT(err, 0.03);
+
+	HLL_Free(a);
+	HLL_Free(b);
+	HLL_Free(sparse);
+}
+
+TEST_F(SketchTest, TDigestQuantile) {
+	TDigest *td = TDigest_New();
+	ASSERT_TRUE(isnan(TDigest_Quantile(td, 0.5)));
+
+	// exact while every value is a centroid of its own
+	for(int i = 1; i <= 10; i++) TDigest_Add(td, i);
+	ASSERT_EQ(TDigest_Quantile(td, 0.5), 5.5);
+	ASSERT_EQ(TDigest_Quantile(td, 0), 1);
+	ASSERT_EQ(TDigest_Quantile(td, 1), 10);
+	TDigest_Free(td);
+
+	// uniform distribution
+	td = TDigest_New();
+	int n = 100000;
+	for(int i = 0; i < n; i++) TDigest_Add(td, (_hash(i) % n));
+	ASSERT_EQ(TDigest_Count(td), n);
+
+	double qs[] = {0.001, 0.01, 0.25, 0.5, 0.75, 0.99, 0.999};
+	for(uint i = 0; i < sizeof(qs) / sizeof(qs[0]); i++) {
+		double q = TDigest_Quantile(td, qs[i]);
+		ASSERT_NEAR(q / n, qs[i], 0.01);
+	}
+
+	TDigest_Free(td);
+}
+
+TEST_F(SketchTest, TDigestMerge) {
+	TDigest *a = TDigest_New();
+	TDigest *b = TDigest_New();
+
+	int n = 50000;
+	for(int i = 0; i < n; i++) TDigest_Add(a, i);
+	for(int i = n; i < 2 * n; i++) TDigest_Add(b, i);
+
+	TDigest_Merge(a, b);
+	ASSERT_EQ(TDigest_Count(a), 2 * n);
+	ASSERT_NEAR(TDigest_Quantile(a, 0.5) / (2 * n), 0.5, 0.01);
+	ASSERT_NEAR(TDigest_Quantile(a, 0.9) / (2 * n), 0.9, 0.01);
+	ASSERT_EQ(TDigest_Quantile(a, 0), 0);
+	ASSERT_EQ(TDigest_Quantile(a, 1), 2 * n - 1);
+
+	TDigest_Free(a);
+	TDigest_Free(b);
+}
+
+TEST_F(SketchTest, HistogramQuantile) {
+	Histogram *h = Histogram_New();
+	ASSERT_EQ(Histogram_Count(h), 0);
+	ASSERT_EQ(Histogram_Quantile(h, 0.5), 0);
+
+	// small values are counted exactly
+	for(uint64_t v = 0; v < HISTOGRAM_SUB_BUCKETS; v++) Histogram_Record(h, v);
+	ASSERT_EQ(Histogram_Quantile(h, 0), 0);
+	ASSERT_EQ(Histogram_Quantile(h, 1), HISTOGRAM_SUB_BUCKETS - 1);
+	Histogram_Reset(h);
+
+	const uint64_t n = 100000;
+	for(uint64_t v = 1; v <= n; v++) Histogram_Record(h, v);
+	ASSERT_EQ(Histogram_Count(h), n);
+	ASSERT_EQ(Histogram_Sum(h), n * (n + 1) / 2);
+	ASSERT_EQ(Histogram_Max(h), n);
+
+	// quantiles are within a bucket's relative width
+	double qs[4] = {0.5, 0.9, 0.99, 0.999};
+	for(int i = 0; i < 4; i++) {
+		double expected = qs[i] * n;
+		double error = fabs((double)Histogram_Quantile(h, qs[i]) - expected) / expected;
+		ASSERT_LE(error, 1.0 / HISTOGRAM_SUB_BUCKETS);
+	}
+	ASSERT_EQ(Histogram_Quantile(h, 1), n);
+
+	// values beyond the tracked range land in the last bucket
+	Histogram_Record(h, UINT64_MAX);
+	ASSERT_EQ(Histogram_Max(h), UINT64_MAX);
+	ASSERT_GT(Histogram_Quantile(h, 1), 1ULL << (HISTOGRAM_MAX_BITS - 1));
+
+	Histogram_Free(h);
+}
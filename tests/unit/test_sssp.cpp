@@ -0,0 +1,120 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <math.h>
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/sssp.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class SSSPTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+
+	/* W = [
+	    0 1 5 0 0
+	    0 0 1 6 0
+	    0 0 0 1 0
+	    0 0 0 0 0
+	    0 0 0 0 0 ] ;
+	   node 4 is unreachable
+	*/
+	static GrB_Matrix _costs() {
+		GrB_Matrix W;
+		GrB_Matrix_new(&W, GrB_FP64, 5, 5);
+		GrB_Matrix_setElement_FP64(W, 1, 0, 1);
+		GrB_Matrix_setElement_FP64(W, 5, 0, 2);
+		GrB_Matrix_setElement_FP64(W, 1, 1, 2);
+		GrB_Matrix_setElement_FP64(W, 6, 1, 3);
+		GrB_Matrix_setElement_FP64(W, 1, 2, 3);
+		return W;
+	}
+};
+
+TEST_F(SSSPTest, AllNodes) {
+	GrB_Vector cost;
+	GrB_Vector level;
+	GrB_Matrix W = _costs();
+
+	GrB_Info info = SSSP(&cost, &level, W, 0, GxB_INDEX_MAX, INFINITY);
+	ASSERT_EQ(info, GrB_SUCCESS);
+
+	GrB_Index nvals;
+	GrB_Vector_nvals(&nvals, cost);
+	ASSERT_EQ(nvals, 4);
+
+	// cheapest paths: 0, 0->1, 0->1->2, 0->1->2->3
+	double expected_cost[4] = {0, 1, 2, 3};
+	uint64_t expected_level[4] = {0, 1, 2, 3};
+	for(GrB_Index i = 0; i < 4; i++) {
+		double c;
+		uint64_t l;
+		ASSERT_EQ(GrB_Vector_extractElement_FP64(&c, cost, i), GrB_SUCCESS);
+		ASSERT_EQ(GrB_Vector_extractElement_UINT64(&l, level, i), GrB_SUCCESS);
+		ASSERT_EQ(c, expected_cost[i]);
+		ASSERT_EQ(l, expected_level[i]);
+	}
+
+	double c;
+	ASSERT_EQ(GrB_Vector_extractElement_FP64(&c, cost, 4), GrB_NO_VALUE);
+
+	GrB_Vector_free(&cost);
+	GrB_Vector_free(&level);
+	GrB_Matrix_free(&W);
+}
+
+TEST_F(SSSPTest, MaxCost) {
+	GrB_Vector cost;
+	GrB_Vector level;
+	GrB_Matrix W = _costs();
+
+	GrB_Info info = SSSP(&cost, &level, W, 0, GxB_INDEX_MAX, 2);
+	ASSERT_EQ(info, GrB_SUCCESS);
+
+	// node 3 costs 3
+	GrB_Index nvals;
+	GrB_Vector_nvals(&nvals, cost);
+	ASSERT_EQ(nvals, 3);
+
+	double c;
+	ASSERT_EQ(GrB_Vector_extractElement_FP64(&c, cost, 2), GrB_SUCCESS);
+	ASSERT_EQ(c, 2);
+	ASSERT_EQ(GrB_Vector_extractElement_FP64(&c, cost, 3), GrB_NO_VALUE);
+
+	GrB_Vector_free(&cost);
+	GrB_Vector_free(&level);
+	GrB_Matrix_free(&W);
+}
+
+TEST_F(SSSPTest, Target) {
+	GrB_Vector cost;
+	GrB_Vector level;
+	GrB_Matrix W = _costs();
+
+	GrB_Info info = SSSP(&cost, &level, W, 1, 3, INFINITY);
+	ASSERT_EQ(info, GrB_SUCCESS);
+
+	double c;
+	ASSERT_EQ(GrB_Vector_extractElement_FP64(&c, cost, 3), GrB_SUCCESS);
+	ASSERT_EQ(c, 2);
+	// node 0 isn't reachable from 1
+	ASSERT_EQ(GrB_Vector_extractElement_FP64(&c, cost, 0), GrB_NO_VALUE);
+
+	GrB_Vector_free(&cost);
+	GrB_Vector_free(&level);
+	GrB_Matrix_free(&W);
+}
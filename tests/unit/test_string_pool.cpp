@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include "../../src/value.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/util/string_pool/string_pool.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class StringPoolTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+TEST_F(StringPoolTest, Intern) {
+	StringPool *pool = StringPool_New();
+	char buf[] = "country";
+
+	// Equal strings share a single copy.
+	char *a = StringPool_Intern(pool, "country");
+	char *b = StringPool_Intern(pool, buf);
+	char *c = StringPool_Intern(pool, "city");
+	ASSERT_EQ(a, b);
+	ASSERT_NE(a, c);
+	ASSERT_NE(a, buf);
+	ASSERT_STREQ(a, "country");
+	ASSERT_STREQ(c, "city");
+	ASSERT_EQ(StringPool_Count(pool), 2);
+
+	// A string is freed once its last reference is released.
+	StringPool_Release(a);
+	ASSERT_EQ(StringPool_Count(pool), 2);
+	StringPool_Release(b);
+	ASSERT_EQ(StringPool_Count(pool), 1);
+
+	char *d = StringPool_Retain(c);
+	ASSERT_EQ(c, d);
+	StringPool_Release(c);
+	ASSERT_EQ(StringPool_Count(pool), 1);
+	StringPool_Release(d);
+	ASSERT_EQ(StringPool_Count(pool), 0);
+
+	// The empty string can be interned.
+	char *e = StringPool_Intern(pool, "");
+	ASSERT_STREQ(e, "");
+	StringPool_Release(e);
+
+	StringPool_Free(pool);
+}
+
+TEST_F(StringPoolTest, InternedSIValue) {
+	StringPool *pool = StringPool_New();
+
+	SIValue a = SI_InternedStringVal(StringPool_Intern(pool, "value"));
+	SIValue b = SI_InternedStringVal(StringPool_Intern(pool, "value"));
+	SIValue c = SI_ConstStringVal((char *)"value");
+	ASSERT_EQ(a.stringval, b.stringval);
+	ASSERT_EQ(SIValue_Compare(a, b, NULL), 0);
+	ASSERT_EQ(SIValue_Compare(a, c, NULL), 0);
+
+	// Shared copies do not hold a reference.
+	SIValue shared = SI_ShareValue(a);
+	ASSERT_EQ(shared.stringval, a.stringval);
+	SIValue_Free(shared);
+	ASSERT_EQ(StringPool_Count(pool), 1);
+
+	// Clones own a private copy of the string.
+	SIValue clone = SI_CloneValue(a);
+	ASSERT_NE(clone.stringval, a.stringval);
+	ASSERT_STREQ(clone.stringval, "value");
+	SIValue_Free(clone);
+
+	// Freeing an interned value releases its reference.
+	SIValue_Free(a);
+	ASSERT_EQ(StringPool_Count(pool), 1);
+	SIValue_Free(b);
+	ASSERT_EQ(StringPool_Count(pool), 0);
+
+	StringPool_Free(pool);
+}
+
+TEST_F(StringPoolTest, MemoryUsage) {
+	StringPool *pool = StringPool_New();
+	uint64_t empty = StringPool_MemoryUsage(pool);
+
+	// Duplicates don't consume additional memory.
+	char *a = StringPool_Intern(pool, "country");
+	uint64_t usage = StringPool_MemoryUsage(pool);
+	ASSERT_EQ(usage, empty + sizeof(InternedString) + strlen("country") + 1);
+	char *b = StringPool_Intern(pool, "country");
+	ASSERT_EQ(StringPool_MemoryUsage(pool), usage);
+
+	StringPool_Release(a);
+	ASSERT_EQ(StringPool_MemoryUsage(pool), usage);
+	StringPool_Release(b);
+	ASSERT_EQ(StringPool_MemoryUsage(pool), empty);
+
+	StringPool_Free(pool);
+}
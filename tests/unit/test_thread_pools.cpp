@@ -29,7 +29,7 @@ class ThreadPoolsTest: public ::testing::Test {
 	static void SetUpTestCase() {
 		Alloc_Reset();
 		Config_Init(NULL, NULL, 0);
-		ThreadPools_CreatePools(READER_COUNT, WRITER_COUNT, BULK_COUNT);
+		ThreadPools_CreatePools(READER_COUNT, READER_COUNT, WRITER_COUNT, BULK_COUNT);
 	}
 
 	static void get_thread_friendly_id(void *arg) {
@@ -60,7 +60,7 @@ TEST_F(ThreadPoolsTest, ThreadPools_ThreadID) {
 		int offset = i + READER_COUNT + 1;
 		ASSERT_EQ(0,
 				ThreadPools_AddWorkWriter(get_thread_friendly_id,
-					thread_ids + offset));
+					thread_ids + offset, "graph"));
 	}
 
 	// wait for all threads
@@ -85,3 +85,80 @@ TEST_F(ThreadPoolsTest, ThreadPools_ThreadID) {
 	}
 }
 
+TEST_F(ThreadPoolsTest, ThreadPools_OpenMPBudget) {
+	ThreadPools_SetOpenMPBudget(8);
+
+	// a single execution is allotted the entire budget
+	ASSERT_EQ(8, ThreadPools_AcquireOpenMPThreads());
+
+	// concurrent executions split the budget
+	ASSERT_EQ(4, ThreadPools_AcquireOpenMPThreads());
+	ASSERT_EQ(2, ThreadPools_AcquireOpenMPThreads());
+	ThreadPools_ReleaseOpenMPThreads();
+	ThreadPools_ReleaseOpenMPThreads();
+
+	// each execution is allotted at least a single thread
+	ThreadPools_SetOpenMPBudget(1);
+	ASSERT_EQ(1, ThreadPools_AcquireOpenMPThreads());
+	ThreadPools_ReleaseOpenMPThreads();
+	ThreadPools_ReleaseOpenMPThreads();
+}
+
+static threadpool _local_pool = NULL;
+static int _local_jobs_done = 0;
+
+static void local_job(void *arg) {
+	__atomic_add_fetch(&_local_jobs_done, 1, __ATOMIC_RELAXED);
+}
+
+static void spawning_job(void *arg) {
+	// spawned jobs are pushed onto this thread's deque, others steal them
+	for(int i = 0; i < 64; i++) {
+		ASSERT_EQ(0, thpool_add_local_work(_local_pool, local_job, NULL));
+	}
+	__atomic_add_fetch(&_local_jobs_done, 1, __ATOMIC_RELAXED);
+}
+
+TEST_F(ThreadPoolsTest, ThreadPools_LocalWork) {
+	_local_pool = thpool_init(4, "local");
+	ASSERT_TRUE(_local_pool != NULL);
+
+	for(int i = 0; i < 100; i++) {
+		ASSERT_EQ(0, thpool_add_work(_local_pool, spawning_job, NULL));
+	}
+	// callers outside of the pool add local work to its queue
+	ASSERT_EQ(0, thpool_add_local_work(_local_pool, local_job, NULL));
+
+	thpool_wait(_local_pool);
+	ASSERT_EQ(100 * 64 + 100 + 1, _local_jobs_done);
+	ASSERT_EQ(0, thpool_queue_size(_local_pool));
+}
+
+static bool _blocked = true;
+
+static void blocking_job(void *arg) {
+	while(__atomic_load_n(&_blocked, __ATOMIC_ACQUIRE));
+}
+
+TEST_F(ThreadPoolsTest, ThreadPools_PriorityQueueSize) {
+	threadpool pool = thpool_init(1, "priority");
+	ASSERT_TRUE(pool != NULL);
+
+	// occupy the pool's only thread, queueing the jobs that follow
+	ASSERT_EQ(0, thpool_add_work(pool, blocking_job, NULL));
+	while(thpool_queue_size(pool) > 0);
+
+	for(int i = 0; i < 2; i++) ASSERT_EQ(0, thpool_add_work(pool, local_job, NULL));
+	for(int i = 0; i < 3; i++) {
+		ASSERT_EQ(0, thpool_add_low_priority_work(pool, local_job, NULL));
+	}
+
+	// low priority jobs are queued, but not counted as priority jobs
+	ASSERT_EQ(5, thpool_queue_size(pool));
+	ASSERT_EQ(2, thpool_priority_queue_size(pool));
+
+	__atomic_store_n(&_blocked, false, __ATOMIC_RELEASE);
+	thpool_wait(pool);
+	ASSERT_EQ(0, thpool_queue_size(pool));
+	thpool_destroy(pool);
+}
@@ -40,8 +40,7 @@ class TraversalOrderingTest: public ::testing::Test {
 		 * accessible via thread local storage, as such we're creating a
 		 * fake graph context and placing it within thread local storage. */
 		GraphContext *gc = (GraphContext *)calloc(1, sizeof(GraphContext));
-		gc->attributes = raxNew();
-		pthread_rwlock_init(&gc->_attribute_rwlock, NULL);
+		gc->attributes = AttributeTable_New();
 
 		// Prepare thread-local variables
 		ASSERT_TRUE(QueryCtx_Init());
@@ -321,3 +320,44 @@ TEST_F(TraversalOrderingTest, OptimalStartingPoint) {
 	QueryGraph_Free(qg);
 }
 
+
+TEST_F(TraversalOrderingTest, LongPattern) {
+	/* Given a chain of 16 algebraic expressions, in reverse order:
+	 * (N0)->(N1)->...->(N16)
+	 * ordering must complete quickly (without enumerating all 16!
+	 * permutations) and produce an arrangement in which the source of
+	 * every expression is resolved by a previous expression. */
+
+	const uint exp_count = 16;
+	char aliases[exp_count + 1][8];
+	char edge_aliases[exp_count][8];
+	QGNode *nodes[exp_count + 1];
+	AlgebraicExpression *exps[exp_count];
+	AlgebraicExpression *set[exp_count];
+
+	QueryGraph *qg = QueryGraph_New(exp_count + 1, exp_count);
+	for(uint i = 0; i <= exp_count; i++) {
+		snprintf(aliases[i], sizeof(aliases[i]), "N%u", i);
+		nodes[i] = QGNode_New(aliases[i]);
+		QueryGraph_AddNode(qg, nodes[i]);
+	}
+	for(uint i = 0; i < exp_count; i++) {
+		snprintf(edge_aliases[i], sizeof(edge_aliases[i]), "E%u", i);
+		QGEdge *e = QGEdge_New(nodes[i], nodes[i + 1], "E", edge_aliases[i]);
+		QueryGraph_ConnectNodes(qg, nodes[i], nodes[i + 1], e);
+		exps[i] = AlgebraicExpression_NewOperand(GrB_NULL, false, aliases[i],
+				aliases[i + 1], NULL, NULL);
+		set[exp_count - 1 - i] = exps[i];
+	}
+
+	orderExpressions(qg, set, exp_count, NULL, NULL);
+
+	// no transposes are required, the chain is traversed from N0
+	for(uint i = 0; i < exp_count; i++) {
+		ASSERT_EQ(set[i], exps[i]);
+	}
+
+	// Clean up.
+	for(uint i = 0; i < exp_count; i++) AlgebraicExpression_Free(exps[i]);
+	QueryGraph_Free(qg);
+}
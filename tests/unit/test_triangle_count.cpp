@@ -0,0 +1,69 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/undirected.h"
+#include "../../src/algorithms/triangle_count.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class TriangleCountTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+};
+
+TEST_F(TriangleCountTest, TriangleCount) {
+	// 4-clique {0, 1, 2, 3} holding 4 triangles
+	// node 4 connected to 0 and 1, forming a 5th triangle
+	// node 5 connected to 4 only
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_BOOL, 6, 6);
+	for(GrB_Index i = 0; i < 4; i++) {
+		for(GrB_Index j = i + 1; j < 4; j++) {
+			GrB_Matrix_setElement_BOOL(A, true, i, j);
+		}
+	}
+	GrB_Matrix_setElement_BOOL(A, true, 4, 0);
+	GrB_Matrix_setElement_BOOL(A, true, 1, 4);
+	GrB_Matrix_setElement_BOOL(A, true, 5, 4);
+	// reversed duplicate and self loop are ignored
+	GrB_Matrix_setElement_BOOL(A, true, 1, 0);
+	GrB_Matrix_setElement_BOOL(A, true, 5, 5);
+
+	GrB_Matrix S;
+	GrB_Index *mapping;
+	ASSERT_EQ(Undirected(&S, &mapping, A, GrB_NULL), GrB_SUCCESS);
+
+	uint64_t total;
+	uint64_t *triangles;
+	double *coefficients;
+	ASSERT_EQ(TriangleCount(&triangles, &coefficients, &total, S), GrB_SUCCESS);
+	ASSERT_EQ(total, 5);
+
+	uint64_t expected_triangles[6] = {4, 4, 3, 3, 1, 0};
+	// degrees: 4, 4, 3, 3, 3, 1
+	double expected_coefficients[6] = {4.0 / 6, 4.0 / 6, 1, 1, 1.0 / 3, 0};
+	for(int i = 0; i < 6; i++) {
+		ASSERT_EQ(triangles[i], expected_triangles[i]);
+		ASSERT_DOUBLE_EQ(coefficients[i], expected_coefficients[i]);
+	}
+
+	rm_free(triangles);
+	rm_free(coefficients);
+	GrB_Matrix_free(&S);
+	GrB_Matrix_free(&A);
+}
@@ -526,3 +526,156 @@ TEST_F(TuplesTest, IteratorRange) {
 	ASSERT_TRUE(depleted);
 }
 
+TEST_F(TuplesTest, HypersparseIterator) {
+	bool depleted;
+	GrB_Info info;
+	GrB_Index row;
+	GrB_Index col;
+	int sparsity;
+
+	// Matrix is 1024X1024, populated with the following indices.
+	GrB_Index indices[4][2] = {
+		{3, 7},
+		{3, 9},
+		{500, 1},
+		{1000, 1023}
+	};
+
+	GrB_Index n = 1024;
+	GrB_Matrix A = CreateSquareNByNEmptyMatrix(n);
+	GxB_Matrix_Option_set(A, GxB_SPARSITY_CONTROL, GxB_HYPERSPARSE);
+	for(int i = 0; i < 4; i++) {
+		GrB_Matrix_setElement_BOOL(A, true, indices[i][0], indices[i][1]);
+	}
+
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, A);
+
+	// Iterator doesn't convert the matrix.
+	GxB_Matrix_Option_get(A, GxB_SPARSITY_STATUS, &sparsity);
+	ASSERT_EQ(GxB_HYPERSPARSE, sparsity);
+
+	// Scan entire matrix.
+	for(int i = 0; i < 4; i++) {
+		info = GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+		ASSERT_EQ(GrB_SUCCESS, info);
+		ASSERT_FALSE(depleted);
+		ASSERT_EQ(indices[i][0], row);
+		ASSERT_EQ(indices[i][1], col);
+	}
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_TRUE(depleted);
+
+	// Iterate a populated row.
+	info = GxB_MatrixTupleIter_iterate_row(iter, 500);
+	ASSERT_EQ(GrB_SUCCESS, info);
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_FALSE(depleted);
+	ASSERT_EQ(500, row);
+	ASSERT_EQ(1, col);
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_TRUE(depleted);
+
+	// Iterate an empty row.
+	info = GxB_MatrixTupleIter_iterate_row(iter, 4);
+	ASSERT_EQ(GrB_SUCCESS, info);
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_TRUE(depleted);
+
+	// Jump to an empty row, iteration resumes at the next populated row.
+	info = GxB_MatrixTupleIter_jump_to_row(iter, 4);
+	ASSERT_EQ(GrB_SUCCESS, info);
+	for(int i = 2; i < 4; i++) {
+		GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+		ASSERT_FALSE(depleted);
+		ASSERT_EQ(indices[i][0], row);
+		ASSERT_EQ(indices[i][1], col);
+	}
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_TRUE(depleted);
+
+	// Iterate a range bounded by empty rows.
+	info = GxB_MatrixTupleIter_iterate_range(iter, 2, 999);
+	ASSERT_EQ(GrB_SUCCESS, info);
+	for(int i = 0; i < 3; i++) {
+		GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+		ASSERT_FALSE(depleted);
+		ASSERT_EQ(indices[i][0], row);
+		ASSERT_EQ(indices[i][1], col);
+	}
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_TRUE(depleted);
+
+	GxB_MatrixTupleIter_free(iter);
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(TuplesTest, RowSliceIterator) {
+	bool depleted;
+	GrB_Info info;
+	GrB_Index row;
+	GrB_Index col;
+	GrB_Index count;
+	const GrB_Index *cols;
+	const void *vals;
+
+	// Matrix is 6X6, populated with the following indices.
+	GrB_Index indices[6][2] = {
+		{0, 2},
+		{2, 1},
+		{2, 3},
+		{3, 0},
+		{3, 4},
+		{5, 5}
+	};
+
+	GrB_Index n = 6;
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_UINT64, n, n);
+	for(int i = 0; i < 6; i++) {
+		GrB_Matrix_setElement_UINT64(A, i, indices[i][0], indices[i][1]);
+	}
+
+	GxB_MatrixTupleIter *iter;
+	GxB_MatrixTupleIter_new(&iter, A);
+
+	// Each row is returned as a single slice, empty rows are skipped.
+	GrB_Index rows[4] = {0, 2, 3, 5};
+	GrB_Index counts[4] = {1, 2, 2, 1};
+	int entry = 0;
+	for(int i = 0; i < 4; i++) {
+		info = GxB_MatrixTupleIter_next_row(iter, &row, &cols, &vals, &count, &depleted);
+		ASSERT_EQ(GrB_SUCCESS, info);
+		ASSERT_FALSE(depleted);
+		ASSERT_EQ(rows[i], row);
+		ASSERT_EQ(counts[i], count);
+		for(GrB_Index j = 0; j < count; j++, entry++) {
+			ASSERT_EQ(indices[entry][1], cols[j]);
+			ASSERT_EQ(entry, ((const uint64_t *)vals)[j]);
+		}
+	}
+	GxB_MatrixTupleIter_next_row(iter, &row, &cols, &vals, &count, &depleted);
+	ASSERT_TRUE(depleted);
+
+	// A partially consumed row resumes at its first unconsumed entry.
+	GxB_MatrixTupleIter_iterate_range(iter, 2, 3);
+	GxB_MatrixTupleIter_next(iter, &row, &col, &depleted);
+	ASSERT_EQ(2, row);
+	ASSERT_EQ(1, col);
+	GxB_MatrixTupleIter_next_row(iter, &row, &cols, NULL, &count, &depleted);
+	ASSERT_FALSE(depleted);
+	ASSERT_EQ(2, row);
+	ASSERT_EQ(1, count);
+	ASSERT_EQ(3, cols[0]);
+
+	// Slices are bounded by the iterated range.
+	GxB_MatrixTupleIter_next_row(iter, &row, &cols, NULL, &count, &depleted);
+	ASSERT_FALSE(depleted);
+	ASSERT_EQ(3, row);
+	ASSERT_EQ(2, count);
+	GxB_MatrixTupleIter_next_row(iter, &row, &cols, NULL, &count, &depleted);
+	ASSERT_TRUE(depleted);
+
+	GxB_MatrixTupleIter_free(iter);
+	GrB_Matrix_free(&A);
+}
@@ -0,0 +1,95 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/value.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/index/unique_constraint.h"
+#include <math.h>
+#ifdef __cplusplus
+}
+#endif
+
+class UniqueConstraintTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+TEST_F(UniqueConstraintTest, Lookup) {
+	UniqueConstraint *uc = UniqueConstraint_New(0);
+	for(NodeID i = 0; i < 100; i++) UniqueConstraint_Insert(uc, i, SI_LongVal(i));
+	ASSERT_EQ(UniqueConstraint_Count(uc), 100);
+
+	for(NodeID i = 0; i < 100; i++) {
+		ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_LongVal(i)), i);
+	}
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_LongVal(100)), INVALID_ENTITY_ID);
+
+	// numerics compare by value, other types never collide with them
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_DoubleVal(7.0)), 7);
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_DoubleVal(7.5)), INVALID_ENTITY_ID);
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_BoolVal(true)), INVALID_ENTITY_ID);
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_ConstStringVal((char *)"7")), INVALID_ENTITY_ID);
+
+	UniqueConstraint_Free(uc);
+}
+
+TEST_F(UniqueConstraintTest, Update) {
+	UniqueConstraint *uc = UniqueConstraint_New(0);
+	UniqueConstraint_Insert(uc, 1, SI_ConstStringVal((char *)"a"));
+	ASSERT_FALSE(UniqueConstraint_Accepts(uc, 2, SI_ConstStringVal((char *)"a")));
+	ASSERT_TRUE(UniqueConstraint_Accepts(uc, 1, SI_ConstStringVal((char *)"a")));
+
+	// replacing a node's value releases its previous value
+	UniqueConstraint_Insert(uc, 1, SI_ConstStringVal((char *)"b"));
+	ASSERT_EQ(UniqueConstraint_Count(uc), 1);
+	ASSERT_TRUE(UniqueConstraint_Accepts(uc, 2, SI_ConstStringVal((char *)"a")));
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_ConstStringVal((char *)"b")), 1);
+
+	// unconstrained values release the node's value
+	UniqueConstraint_Insert(uc, 1, SI_NullVal());
+	ASSERT_EQ(UniqueConstraint_Count(uc), 0);
+
+	UniqueConstraint_Insert(uc, 1, SI_LongVal(5));
+	UniqueConstraint_Remove(uc, 1);
+	ASSERT_EQ(UniqueConstraint_Lookup(uc, SI_LongVal(5)), INVALID_ENTITY_ID);
+	// removing an unconstrained node is a NOP
+	UniqueConstraint_Remove(uc, 1);
+
+	// NULL and NaN are never duplicates
+	ASSERT_TRUE(UniqueConstraint_Accepts(uc, 3, SI_NullVal()));
+	ASSERT_TRUE(UniqueConstraint_Accepts(uc, 3, SI_DoubleVal(NAN)));
+
+	UniqueConstraint_Free(uc);
+}
+
+TEST_F(UniqueConstraintTest, Claim) {
+	UniqueConstraint *a = UniqueConstraint_New(0);
+	UniqueConstraint *b = UniqueConstraint_New(0);
+	UniqueConstraint_Insert(a, 1, SI_LongVal(1));
+
+	rax *claims = raxNew();
+	// held values can't be claimed
+	ASSERT_FALSE(UniqueConstraint_Claim(a, claims, SI_LongVal(1)));
+	// values are claimed once per constraint
+	ASSERT_TRUE(UniqueConstraint_Claim(a, claims, SI_LongVal(2)));
+	ASSERT_FALSE(UniqueConstraint_Claim(a, claims, SI_DoubleVal(2.0)));
+	ASSERT_TRUE(UniqueConstraint_Claim(b, claims, SI_LongVal(2)));
+	// unconstrained values are always claimed
+	ASSERT_TRUE(UniqueConstraint_Claim(a, claims, SI_NullVal()));
+	ASSERT_TRUE(UniqueConstraint_Claim(a, claims, SI_NullVal()));
+	raxFree(claims);
+
+	UniqueConstraint_Free(a);
+	UniqueConstraint_Free(b);
+}
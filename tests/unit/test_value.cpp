@@ -205,6 +205,62 @@ TEST_F(ValueTest, TestArray) {
 	ASSERT_EQ(origHashCode, otherHashCode);
 }
 
+TEST_F(ValueTest, TestPackedArray) {
+	// lists of a single numeric type are packed
+	SIValue longs = SI_Array(2);
+	for(int64_t i = 0; i < 10; i++) SIArray_Append(&longs, SI_LongVal(i));
+	ASSERT_TRUE(SIArray_Longs(longs) != NULL);
+	ASSERT_TRUE(SIArray_Doubles(longs) == NULL);
+	ASSERT_EQ(SIArray_Length(longs), 10);
+	for(uint i = 0; i < 10; i++) ASSERT_EQ(SIArray_Longs(longs)[i], i);
+
+	SIValue doubles = SI_EmptyArray();
+	SIArray_Append(&doubles, SI_DoubleVal(0.5));
+	SIArray_Append(&doubles, SI_DoubleVal(1.5));
+	ASSERT_TRUE(SIArray_Doubles(doubles) != NULL);
+	ASSERT_EQ(SIArray_Doubles(doubles)[1], 1.5);
+
+	// clones retain the packed representation
+	SIValue clone = SI_CloneValue(longs);
+	ASSERT_TRUE(SIArray_Longs(clone) != NULL);
+	ASSERT_EQ(SIValue_Compare(clone, longs, NULL), 0);
+	ASSERT_EQ(SIValue_HashCode(clone), SIValue_HashCode(longs));
+	SIValue_Free(clone);
+
+	// a value of another type expands the list
+	SIArray_Append(&longs, SI_DoubleVal(10.5));
+	SIArray_Append(&longs, SI_ConstStringVal((char *)"str"));
+	ASSERT_TRUE(SIArray_Longs(longs) == NULL);
+	ASSERT_TRUE(SIArray_Doubles(longs) == NULL);
+	ASSERT_EQ(SIArray_Length(longs), 12);
+	for(uint i = 0; i < 10; i++) {
+		SIValue v = SIArray_Get(longs, i);
+		ASSERT_EQ(SI_TYPE(v), T_INT64);
+		ASSERT_EQ(v.longval, i);
+	}
+	ASSERT_EQ(SIArray_Get(longs, 10).doubleval, 10.5);
+	ASSERT_STREQ(SIArray_Get(longs, 11).stringval, "str");
+
+	// packed and unpacked lists of equal values hash the same
+	SIValue mixed = SI_EmptyArray();
+	SIArray_Append(&mixed, SI_ConstStringVal((char *)"str"));
+	SIValue packed = SI_EmptyArray();
+	for(int64_t i = 0; i < 10; i++) {
+		SIArray_Append(&mixed, SI_LongVal(i));
+		SIArray_Append(&packed, SI_LongVal(i));
+	}
+	SIValue sub = SI_EmptyArray();
+	for(uint i = 1; i < 11; i++) SIArray_Append(&sub, SIArray_Get(mixed, i));
+	ASSERT_TRUE(SIArray_Longs(sub) != NULL);
+	ASSERT_EQ(SIValue_HashCode(sub), SIValue_HashCode(packed));
+
+	SIValue_Free(sub);
+	SIValue_Free(mixed);
+	SIValue_Free(packed);
+	SIValue_Free(longs);
+	SIValue_Free(doubles);
+}
+
 /* Test for difference in hash code for the same binary representation
  * for different types. The value boolean "true" and the integer value "1"
  * have the same binary representation. Given that, their types are different,
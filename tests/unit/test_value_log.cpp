@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018-2021 Redis Labs Ltd. and Contributors
+ *
+ * This file is available under the Redis Labs Source Available License Agreement
+ */
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include "../../src/util/arr.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/util/value_log/value_log.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class ValueLogTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+TEST_F(ValueLogTest, Append) {
+	ValueLog *log = ValueLog_New(16);
+	char buf[] = "a long string property value";
+
+	// Values are copied into the log.
+	char *a = ValueLog_Append(log, buf);
+	char *b = ValueLog_Append(log, buf);
+	ASSERT_TRUE(a != NULL && b != NULL);
+	ASSERT_NE(a, buf);
+	ASSERT_NE(a, b);
+	ASSERT_STREQ(a, buf);
+	ASSERT_STREQ(b, buf);
+	ASSERT_GT(ValueLog_MappedBytes(log), 0);
+	ASSERT_GE(ValueLog_LiveBytes(log), 2 * (strlen(buf) + 1));
+
+	// Released values no longer count as live.
+	uint64_t live = ValueLog_LiveBytes(log);
+	ValueLog_Release(a);
+	ASSERT_LT(ValueLog_LiveBytes(log), live);
+	ASSERT_STREQ(b, buf);
+	ValueLog_Release(b);
+	ASSERT_EQ(ValueLog_LiveBytes(log), 0);
+
+	ValueLog_Free(log);
+}
+
+TEST_F(ValueLogTest, ReleaseSegment) {
+	ValueLog *log = ValueLog_New(16);
+
+	char *a = ValueLog_Append(log, "a long string property value");
+	uint64_t mapped = ValueLog_MappedBytes(log);
+
+	// A value larger than a segment is appended to a segment of its own.
+	size_t len = mapped + 1;
+	char *large = (char *)rm_malloc(len + 1);
+	memset(large, 'x', len);
+	large[len] = '\0';
+	char *b = ValueLog_Append(log, large);
+	ASSERT_TRUE(b != NULL);
+	ASSERT_EQ(strlen(b), len);
+	ASSERT_GT(ValueLog_MappedBytes(log), mapped);
+
+	// A sealed segment is unmapped once its last value is released.
+	uint64_t both = ValueLog_MappedBytes(log);
+	ValueLog_Release(a);
+	ASSERT_EQ(ValueLog_MappedBytes(log), both - mapped);
+
+	// The segment appended to remains mapped.
+	ValueLog_Release(b);
+	ASSERT_EQ(ValueLog_MappedBytes(log), both - mapped);
+
+	rm_free(large);
+	ValueLog_Free(log);
+}
+
+TEST_F(ValueLogTest, Compaction) {
+	ValueLog *log = ValueLog_New(16);
+	char value[1024];
+	memset(value, 'v', sizeof(value) - 1);
+	value[sizeof(value) - 1] = '\0';
+
+	// Fill the first segment, until values are appended to a second one.
+	char **values = array_new(char *, 0);
+	char *v = ValueLog_Append(log, value);
+	uint64_t segment = ValueLog_MappedBytes(log);
+	while(ValueLog_MappedBytes(log) == segment) {
+		values = array_append(values, v);
+		v = ValueLog_Append(log, value);
+	}
+	ASSERT_FALSE(ValueLog_CompactionDue(log));
+
+	// Release three of every four values of the first segment.
+	uint count = array_len(values);
+	for(uint i = 0; i < count; i++) {
+		if(i % 4 == 0) continue;
+		ValueLog_Release(values[i]);
+		values[i] = NULL;
+	}
+	ASSERT_TRUE(ValueLog_CompactionDue(log));
+
+	// Live values are relocated out of the first segment, which is unmapped.
+	uint64_t live = ValueLog_LiveBytes(log);
+	ValueLog_BeginCompaction(log);
+	for(uint i = 0; i < count; i += 4) {
+		char *relocated = ValueLog_Relocate(values[i]);
+		ASSERT_NE(relocated, values[i]);
+		ASSERT_STREQ(relocated, value);
+		values[i] = relocated;
+	}
+
+	// Values outside of compacted segments remain in place.
+	ASSERT_EQ(ValueLog_Relocate(v), v);
+	ValueLog_EndCompaction(log);
+
+	ASSERT_EQ(ValueLog_LiveBytes(log), live);
+	ASSERT_EQ(ValueLog_MappedBytes(log), segment);
+	ASSERT_FALSE(ValueLog_CompactionDue(log));
+
+	for(uint i = 0; i < count; i += 4) ValueLog_Release(values[i]);
+	ValueLog_Release(v);
+	ASSERT_EQ(ValueLog_LiveBytes(log), 0);
+
+	array_free(values);
+	ValueLog_Free(log);
+}
@@ -0,0 +1,110 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../src/util/arr.h"
+#include "../../src/util/rmalloc.h"
+#include "../../src/index/vector_index.h"
+#include <math.h>
+#ifdef __cplusplus
+}
+#endif
+
+class VectorIndexTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {
+		// Use the malloc family for allocations
+		Alloc_Reset();
+	}
+};
+
+TEST_F(VectorIndexTest, Query) {
+	VectorIndex *vi = VectorIndex_New();
+	// node i is at angle i degrees
+	for(int i = 0; i < 90; i++) {
+		double a = i * M_PI / 180;
+		float v[2] = {(float)(cos(a) * (i + 1)), (float)(sin(a) * (i + 1))};
+		ASSERT_TRUE(VectorIndex_Insert(vi, i, v, 2));
+	}
+	ASSERT_EQ(VectorIndex_Count(vi), 90);
+
+	// nearest to 45 degrees, in descending similarity
+	float q[2] = {1, 1};
+	VectorIndexMatch *matches = VectorIndex_Query(vi, q, 2, 3);
+	ASSERT_EQ(array_len(matches), 3);
+	ASSERT_EQ(matches[0].id, 45);
+	ASSERT_NEAR(matches[0].similarity, 1.0, 1e-6);
+	ASSERT_TRUE(matches[1].id == 44 || matches[1].id == 46);
+	ASSERT_TRUE(matches[2].id == 44 || matches[2].id == 46);
+	ASSERT_NE(matches[1].id, matches[2].id);
+	ASSERT_GE(matches[0].similarity, matches[1].similarity);
+	ASSERT_GE(matches[1].similarity, matches[2].similarity);
+	array_free(matches);
+
+	// k exceeding the number of indexed nodes
+	matches = VectorIndex_Query(vi, q, 2, 1000);
+	ASSERT_EQ(array_len(matches), 90);
+	for(uint i = 1; i < 90; i++) {
+		ASSERT_GE(matches[i - 1].similarity, matches[i].similarity);
+	}
+	array_free(matches);
+
+	// dimension mismatch
+	float q3[3] = {1, 1, 1};
+	matches = VectorIndex_Query(vi, q3, 3, 3);
+	ASSERT_EQ(array_len(matches), 0);
+	array_free(matches);
+
+	VectorIndex_Free(vi);
+}
+
+TEST_F(VectorIndexTest, Update) {
+	VectorIndex *vi = VectorIndex_New();
+	float x[2] = {1, 0};
+	float y[2] = {0, 1};
+	float zero[2] = {0, 0};
+	float z[3] = {0, 0, 1};
+
+	ASSERT_TRUE(VectorIndex_Insert(vi, 0, x, 2));
+	ASSERT_TRUE(VectorIndex_Insert(vi, 1, x, 2));
+	ASSERT_TRUE(VectorIndex_Insert(vi, 2, y, 2));
+
+	// vectors of a different dimension or of length 0 aren't indexed
+	ASSERT_FALSE(VectorIndex_Insert(vi, 3, z, 3));
+	ASSERT_FALSE(VectorIndex_Insert(vi, 4, zero, 2));
+	ASSERT_EQ(VectorIndex_Count(vi), 3);
+
+	// replace node 1 vector
+	ASSERT_TRUE(VectorIndex_Insert(vi, 1, y, 2));
+	ASSERT_EQ(VectorIndex_Count(vi), 3);
+
+	VectorIndexMatch *matches = VectorIndex_Query(vi, x, 2, 1);
+	ASSERT_EQ(array_len(matches), 1);
+	ASSERT_EQ(matches[0].id, 0);
+	array_free(matches);
+
+	// removing node 0 moves node 2 into its slot
+	VectorIndex_Remove(vi, 0);
+	VectorIndex_Remove(vi, 0);
+	ASSERT_EQ(VectorIndex_Count(vi), 2);
+
+	matches = VectorIndex_Query(vi, y, 2, 10);
+	ASSERT_EQ(array_len(matches), 2);
+	ASSERT_TRUE(matches[0].id == 1 || matches[0].id == 2);
+	ASSERT_TRUE(matches[1].id == 1 || matches[1].id == 2);
+	ASSERT_NEAR(matches[1].similarity, 1.0, 1e-6);
+	array_free(matches);
+
+	// a non indexable vector removes the node
+	ASSERT_FALSE(VectorIndex_Insert(vi, 2, zero, 2));
+	ASSERT_EQ(VectorIndex_Count(vi), 1);
+
+	VectorIndex_Free(vi);
+}
@@ -0,0 +1,103 @@
+/*
+* Copyright 2018-2021 Redis Labs Ltd. and Contributors
+*
+* This file is available under the Redis Labs Source Available License Agreement
+*/
+
+#include "gtest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../src/util/rmalloc.h"
+#include "../../src/algorithms/wcc.h"
+#include "../../src/algorithms/undirected.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class WCCTest: public ::testing::Test {
+  protected:
+	static void SetUpTestCase() {// Use the malloc family for allocations
+		Alloc_Reset();
+		GrB_init(GrB_NONBLOCKING);
+	}
+};
+
+TEST_F(WCCTest, Components) {
+	// directed edges: 4->0, 0->2, 3->1, 5->3, 6->6
+	// components: {0, 2, 4}, {1, 3, 5}, {6}, {7}
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_UINT64, 8, 8);
+	GrB_Matrix_setElement_UINT64(A, 0, 4, 0);
+	GrB_Matrix_setElement_UINT64(A, 1, 0, 2);
+	GrB_Matrix_setElement_UINT64(A, 2, 3, 1);
+	GrB_Matrix_setElement_UINT64(A, 3, 5, 3);
+	GrB_Matrix_setElement_UINT64(A, 4, 6, 6);
+
+	GrB_Matrix S;
+	GrB_Index *mapping;
+	ASSERT_EQ(Undirected(&S, &mapping, A, GrB_NULL), GrB_SUCCESS);
+	ASSERT_TRUE(mapping == NULL);
+
+	// symmetric, self loop discarded
+	GrB_Index nvals;
+	GrB_Matrix_nvals(&nvals, S);
+	ASSERT_EQ(nvals, 8);
+
+	GrB_Index *components;
+	ASSERT_EQ(WCC(&components, S), GrB_SUCCESS);
+
+	GrB_Index expected[8] = {0, 1, 0, 1, 0, 1, 6, 7};
+	for(int i = 0; i < 8; i++) ASSERT_EQ(components[i], expected[i]);
+
+	rm_free(components);
+	GrB_Matrix_free(&S);
+
+	// restrict to nodes 0, 2, 3, 5
+	GrB_Matrix L;
+	GrB_Matrix_new(&L, GrB_BOOL, 8, 8);
+	GrB_Matrix_setElement_BOOL(L, true, 0, 0);
+	GrB_Matrix_setElement_BOOL(L, true, 2, 2);
+	GrB_Matrix_setElement_BOOL(L, true, 3, 3);
+	GrB_Matrix_setElement_BOOL(L, true, 5, 5);
+
+	ASSERT_EQ(Undirected(&S, &mapping, A, L), GrB_SUCCESS);
+	ASSERT_EQ(WCC(&components, S), GrB_SUCCESS);
+
+	// rows of S map to nodes 0, 2, 3, 5
+	GrB_Index expected_mapping[4] = {0, 2, 3, 5};
+	GrB_Index expected_components[4] = {0, 0, 2, 2};
+	for(int i = 0; i < 4; i++) {
+		ASSERT_EQ(mapping[i], expected_mapping[i]);
+		ASSERT_EQ(components[i], expected_components[i]);
+	}
+
+	rm_free(mapping);
+	rm_free(components);
+	GrB_Matrix_free(&S);
+	GrB_Matrix_free(&L);
+	GrB_Matrix_free(&A);
+}
+
+TEST_F(WCCTest, Chain) {
+	// a long, reversed chain n-1 -> n-2 -> ... -> 0
+	const GrB_Index n = 1000;
+	GrB_Matrix A;
+	GrB_Matrix_new(&A, GrB_BOOL, n, n);
+	for(GrB_Index i = 1; i < n; i++) GrB_Matrix_setElement_BOOL(A, true, i, i - 1);
+
+	GrB_Matrix S;
+	GrB_Index *mapping;
+	ASSERT_EQ(Undirected(&S, &mapping, A, GrB_NULL), GrB_SUCCESS);
+
+	GrB_Index *components;
+	ASSERT_EQ(WCC(&components, S), GrB_SUCCESS);
+	for(GrB_Index i = 0; i < n; i++) ASSERT_EQ(components[i], 0);
+
+	rm_free(components);
+	GrB_Matrix_free(&S);
+	GrB_Matrix_free(&A);
+}